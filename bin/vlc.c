@@ -197,6 +197,10 @@ int main(int argc, const char *argv[])
      * block SIGCHLD in all threads, and dequeue it below. */
     sigaddset (&set, SIGCHLD);
 
+    /* SIGUSR1 prints the allocation statistics (see libvlc_alloc_stats_print)
+     * and does not stop VLC. */
+    sigaddset (&set, SIGUSR1);
+
     /* Block all these signals */
     pthread_t self = pthread_self ();
     pthread_sigmask (SIG_SETMASK, &set, NULL);
@@ -259,7 +263,8 @@ int main(int argc, const char *argv[])
     sigdelset (&set, SIGPIPE);
 
     int signum;
-    sigwait (&set, &signum);
+    while (sigwait (&set, &signum) == 0 && signum == SIGUSR1)
+        libvlc_alloc_stats_print (stderr);
 
     /* Restore default signal behaviour after 3 seconds */
     sigemptyset (&set);
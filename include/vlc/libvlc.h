@@ -478,6 +478,18 @@ LIBVLC_API void libvlc_log_set( libvlc_instance_t *p_instance,
  */
 LIBVLC_API void libvlc_log_set_file( libvlc_instance_t *p_instance, FILE *stream );
 
+/**
+ * Prints the block and picture allocation statistics, by call site.
+ *
+ * The statistics are only collected if the VLC_ALLOC_STATS environment
+ * variable was set to a positive number before LibVLC was loaded. Otherwise
+ * this function does nothing. This is meant for debugging memory usage.
+ *
+ * \param stream FILE pointer opened for writing
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API void libvlc_alloc_stats_print( FILE *stream );
+
 /** @} */
 
 /**
@@ -138,8 +138,38 @@ typedef struct libvlc_media_stats_t
     int         i_sent_packets;
     int         i_sent_bytes;
     float       f_send_bitrate;
+
+    /* Clock */
+    float       f_clock_drift; /**< system against stream clock, in ppm */
+    int         i_clock_jitter; /**< master clock jitter, in microseconds */
 } libvlc_media_stats_t;
 
+/** Decoder pipeline latency measured by libvlc_media_get_latency_stats() */
+typedef enum libvlc_media_latency_t
+{
+    libvlc_media_latency_video_queue,   /**< block arrival to video decoding */
+    libvlc_media_latency_video_decode,  /**< video block decoding */
+    libvlc_media_latency_video_display, /**< picture queued to display date */
+    libvlc_media_latency_audio_queue,   /**< block arrival to audio decoding */
+    libvlc_media_latency_audio_decode,  /**< audio block decoding */
+    libvlc_media_latency_audio_play,    /**< audio decoding start to output */
+    libvlc_media_latency_video_total,   /**< block arrival to display date */
+} libvlc_media_latency_t;
+
+/** Number of buckets of libvlc_media_latency_stats_t */
+#define LIBVLC_MEDIA_LATENCY_BUCKETS 24
+
+typedef struct libvlc_media_latency_stats_t
+{
+    int64_t     i_samples;
+    int64_t     i_total_us; /**< sum of the samples, in microseconds */
+    int64_t     i_max_us;
+    /** Histogram: the bucket i counts the samples from 2^i (included) to
+     * 2^(i+1) (excluded) microseconds, the last bucket counts the larger
+     * ones, the first one the samples below 2 microseconds */
+    int64_t     pi_buckets[LIBVLC_MEDIA_LATENCY_BUCKETS];
+} libvlc_media_latency_stats_t;
+
 typedef struct libvlc_audio_track_t
 {
     unsigned    i_channels;
@@ -622,6 +652,25 @@ LIBVLC_API libvlc_state_t libvlc_media_get_state(
 LIBVLC_API bool libvlc_media_get_stats(libvlc_media_t *p_md,
                                        libvlc_media_stats_t *p_stats);
 
+/**
+ * Get the cumulated latencies of a decoder pipeline stage of the media
+ *
+ * The latencies of all the elementary streams of the same kind (audio or
+ * video) are cumulated. They are measured only if the "stats" option is
+ * enabled.
+ *
+ * \param p_md: media descriptor object
+ * \param type: pipeline stage
+ * \param p_stats: structure that contain the latencies
+ *                 (this structure must be allocated by the caller)
+ * \retval true statistics are available
+ * \retval false otherwise
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API bool libvlc_media_get_latency_stats(libvlc_media_t *p_md,
+                                               libvlc_media_latency_t type,
+                                               libvlc_media_latency_stats_t *p_stats);
+
 /* The following method uses libvlc_media_list_t, however, media_list usage is optionnal
  * and this is here for convenience */
 #define VLC_FORWARD_DECLARE_OBJECT(a) struct a
@@ -695,6 +744,30 @@ libvlc_media_parse_with_options( libvlc_media_t *p_md,
                                  libvlc_media_parse_flag_t parse_flag,
                                  int timeout );
 
+/**
+ * Parse several media asynchronously with options.
+ *
+ * This is equivalent to calling libvlc_media_parse_with_options() on each
+ * media, but much faster for large collections: the media are queued at once
+ * and probed in parallel by the preparser threads (see the
+ * "preparse-threads" option), the media stored in a same place one after the
+ * other.
+ *
+ * Media that were already parsed or are being parsed are ignored, and each
+ * media can be stopped individually with libvlc_media_parse_stop().
+ *
+ * \param pp_md media descriptor objects, all from the same instance
+ * \param count number of media descriptor objects
+ * \param parse_flag parse options, as for libvlc_media_parse_with_options()
+ * \param timeout maximum time allowed to preparse each media, as for
+ * libvlc_media_parse_with_options()
+ * \return the number of media queued for parsing, or -1 on error
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API int
+libvlc_media_parse_batch( libvlc_media_t *const *pp_md, size_t count,
+                          libvlc_media_parse_flag_t parse_flag, int timeout );
+
 /**
  * Stop the parsing of the media
  *
@@ -369,7 +369,7 @@ typedef void (*libvlc_video_unlock_cb)(void *opaque, void *picture,
  *
  * \param opaque private pointer as passed to libvlc_video_set_callbacks() [IN]
  * \param picture private pointer returned from the @ref libvlc_video_lock_cb
- *                callback [IN]
+ *                or @ref libvlc_video_alloc_cb callback [IN]
  */
 typedef void (*libvlc_video_display_cb)(void *opaque, void *picture);
 
@@ -448,7 +448,8 @@ typedef void (*libvlc_video_cleanup_cb)(void *opaque);
  *   application buffers (between lock and unlock callbacks).
  *
  * \param mp the media player
- * \param lock callback to lock video memory (must not be NULL)
+ * \param lock callback to lock video memory (must not be NULL, unless
+ *             libvlc_video_set_buffer_callbacks() is used)
  * \param unlock callback to unlock video memory (or NULL if not needed)
  * \param display callback to display video (or NULL if not needed)
  * \param opaque private pointer for the three callbacks (as first parameter)
@@ -496,6 +497,58 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+/**
+ * Callback prototype to allocate a picture buffer for direct rendering.
+ *
+ * When the video output starts, this callback is invoked once for each
+ * picture buffer of the pool. Depending on the video chroma, one or three
+ * pixel planes must be returned via the second parameter, with the pitches
+ * and lines defined by the @ref libvlc_video_format_cb callback (or by
+ * libvlc_video_set_format()). Those planes must be aligned on 32-bytes
+ * boundaries.
+ *
+ * \param opaque private pointer as passed to libvlc_video_set_callbacks() [IN]
+ * \param planes start address of the pixel planes (LibVLC allocates the array
+ *             of void pointers, this callback must initialize the array) [OUT]
+ * \return a private pointer for the display and free callbacks to identify
+ *         the picture buffer, or NULL if no more buffers can be allocated
+ * \version LibVLC 4.0.0 or later
+ */
+typedef void *(*libvlc_video_alloc_cb)(void *opaque, void **planes);
+
+/**
+ * Callback prototype to release a picture buffer.
+ *
+ * \param opaque private pointer as passed to libvlc_video_set_callbacks() [IN]
+ * \param picture private pointer returned from the @ref libvlc_video_alloc_cb
+ *                callback [IN]
+ * \version LibVLC 4.0.0 or later
+ */
+typedef void (*libvlc_video_free_cb)(void *opaque, void *picture);
+
+/**
+ * Set application-owned picture buffers.
+ * This only works in combination with libvlc_video_set_callbacks().
+ *
+ * The decoder writes directly into the application buffers, no copy
+ * occurs between the lock and unlock callbacks. The display callback receives
+ * the private pointer of the buffer holding the picture to show; its content
+ * must not be modified and remains valid until the next display callback.
+ *
+ * If the pictures need to be converted (chroma conversion, scaling, etc.),
+ * LibVLC falls back to the lock and unlock callbacks, which are optional
+ * otherwise.
+ *
+ * \param mp the media player
+ * \param alloc callback to allocate a picture buffer (or NULL to disable)
+ * \param free callback to release a picture buffer (or NULL if not needed)
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_buffer_callbacks( libvlc_media_player_t *mp,
+                                        libvlc_video_alloc_cb alloc,
+                                        libvlc_video_free_cb free );
+
 
 /**
  * Callback prototype called to initialize user data.
@@ -1104,6 +1157,128 @@ LIBVLC_API
 void libvlc_audio_set_format( libvlc_media_player_t *mp, const char *format,
                               unsigned rate, unsigned channels );
 
+/**
+ * Opaque handle to a compressed elementary stream packet.
+ *
+ * \version LibVLC 4.0.0 or later
+ */
+typedef struct libvlc_es_packet_t libvlc_es_packet_t;
+
+/**
+ * Callback prototype for a new elementary stream.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_media_player_set_es_callbacks() [IN]
+ * \param track description of the elementary stream, only valid
+ *              during the call [IN]
+ * \param extra codec specific initialization data (or NULL) [IN]
+ * \param extra_size size of the initialization data in bytes [IN]
+ * \return a private pointer for the packet and delete callbacks to identify
+ *         the elementary stream, or NULL to ignore it
+ */
+typedef void *(*libvlc_es_add_cb)(void *opaque,
+                                  const libvlc_media_track_t *track,
+                                  const void *extra, size_t extra_size);
+
+/**
+ * Callback prototype for a compressed packet.
+ *
+ * The callback takes ownership of the packet, and must release it with
+ * libvlc_es_packet_release(), possibly from another thread, once done with
+ * the data. Blocking in this callback pauses the demuxer: this can be used
+ * to apply back-pressure.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_media_player_set_es_callbacks() [IN]
+ * \param es private pointer returned from the @ref libvlc_es_add_cb [IN]
+ * \param packet the packet [IN]
+ */
+typedef void (*libvlc_es_packet_cb)(void *opaque, void *es,
+                                    libvlc_es_packet_t *packet);
+
+/**
+ * Callback prototype for the end of an elementary stream.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_media_player_set_es_callbacks() [IN]
+ * \param es private pointer returned from the @ref libvlc_es_add_cb [IN]
+ */
+typedef void (*libvlc_es_del_cb)(void *opaque, void *es);
+
+/**
+ * Receives the demuxed elementary stream packets instead of playing them.
+ *
+ * The packets are delivered without decoding, and without copying, as
+ * soon as they are demuxed and packetized: as fast as the packet callback
+ * returns for local files, in real time for live sources. This replaces
+ * the audio and video outputs, and takes effect when the next media is
+ * started.
+ *
+ * \param mp the media player
+ * \param add callback for new elementary streams (or NULL to disable)
+ * \param packet callback for the compressed packets
+ * \param del callback for the end of elementary streams (or NULL)
+ * \param opaque private pointer for the three callbacks (as first parameter)
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_media_player_set_es_callbacks( libvlc_media_player_t *mp,
+                                           libvlc_es_add_cb add,
+                                           libvlc_es_packet_cb packet,
+                                           libvlc_es_del_cb del,
+                                           void *opaque );
+
+/**
+ * Gets the payload of an elementary stream packet.
+ *
+ * \param packet the packet
+ * \param size where to store the payload size in bytes [OUT]
+ * \return the payload, valid until the packet is released
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+const void *libvlc_es_packet_get_data( const libvlc_es_packet_t *packet,
+                                       size_t *size );
+
+/**
+ * Gets the presentation timestamp of an elementary stream packet.
+ *
+ * \param packet the packet
+ * \return the timestamp (in microseconds), or -1 if unknown
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+int64_t libvlc_es_packet_get_pts( const libvlc_es_packet_t *packet );
+
+/**
+ * Gets the decoding timestamp of an elementary stream packet.
+ *
+ * \param packet the packet
+ * \return the timestamp (in microseconds), or -1 if unknown
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+int64_t libvlc_es_packet_get_dts( const libvlc_es_packet_t *packet );
+
+/**
+ * Checks whether an elementary stream packet can be decoded on its own.
+ *
+ * \param packet the packet
+ * \return true for key frames, false otherwise
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+bool libvlc_es_packet_is_keyframe( const libvlc_es_packet_t *packet );
+
+/**
+ * Releases an elementary stream packet.
+ *
+ * \param packet the packet
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_es_packet_release( libvlc_es_packet_t *packet );
+
 /** \bug This might go away ... to be replaced by a broader system */
 
 /**
@@ -1464,6 +1639,22 @@ LIBVLC_API
 int libvlc_video_get_cursor( libvlc_media_player_t *p_mi, unsigned num,
                              int *px, int *py );
 
+/**
+ * Create the video output of a media player ahead of playback.
+ *
+ * The video output and its window are created immediately instead of when
+ * the first video track starts, which reduces the start-up latency, e.g. for
+ * players that are set up in advance and started on demand.
+ *
+ * \note The drawable (see libvlc_media_player_set_xwindow() and friends) or
+ * the output callbacks must be set before calling this function.
+ *
+ * \param p_mi the media player
+ * \return 0 on success, -1 on error
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API int libvlc_video_prepare_output( libvlc_media_player_t *p_mi );
+
 /**
  * Get the current video scaling factor.
  * See also libvlc_video_set_scale().
@@ -1950,6 +2141,49 @@ LIBVLC_API float libvlc_video_get_adjust_float( libvlc_media_player_t *p_mi,
 LIBVLC_API void libvlc_video_set_adjust_float( libvlc_media_player_t *p_mi,
                                                    unsigned option, float value );
 
+/**
+ * Hardware decoding priorities.
+ *
+ * \version LibVLC 4.0.0 and later.
+ *
+ * See \ref libvlc_video_set_decode_priority()
+ */
+typedef enum libvlc_video_decode_priority_t {
+    libvlc_video_decode_priority_low = 0, /**< Hidden or thumbnail video */
+    libvlc_video_decode_priority_normal,
+    libvlc_video_decode_priority_high, /**< Visible or large video */
+} libvlc_video_decode_priority_t;
+
+/**
+ * Set the hardware decoding priority.
+ *
+ * When the number of concurrent hardware decoders is limited (see the
+ * "avcodec-hw-concurrency" option), decoders of higher priority players
+ * submit their work first. This is meant for applications playing many
+ * videos at once, such as video walls.
+ *
+ * The priority is applied immediately to the current media, if any.
+ *
+ * \version LibVLC 4.0.0 and later.
+ *
+ * \param p_mi libvlc media player instance
+ * \param priority the decoding priority
+ *                 (\ref libvlc_video_decode_priority_t)
+ * \return 0 on success, -1 on error
+ */
+LIBVLC_API int libvlc_video_set_decode_priority( libvlc_media_player_t *p_mi,
+                                                 unsigned priority );
+
+/**
+ * Get the hardware decoding priority.
+ *
+ * \version LibVLC 4.0.0 and later.
+ *
+ * \param p_mi libvlc media player instance
+ * \return the decoding priority (\ref libvlc_video_decode_priority_t)
+ */
+LIBVLC_API int libvlc_video_get_decode_priority( libvlc_media_player_t *p_mi );
+
 /** @} video */
 
 /** \defgroup libvlc_audio LibVLC audio controls
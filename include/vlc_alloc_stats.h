@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * vlc_alloc_stats.h: block and picture allocation statistics
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_ALLOC_STATS_H
+#define VLC_ALLOC_STATS_H 1
+
+#include <stdio.h>
+
+/**
+ * \defgroup alloc_stats Allocation statistics
+ * \ingroup os
+ *
+ * When the VLC_ALLOC_STATS environment variable is set to a positive number
+ * at start-up, every block_Alloc(), picture_New(), picture_NewFromFormat()
+ * and picture_NewFromResource() call is accounted for by call site: number
+ * of allocations, live objects, live and peak bytes.
+ *
+ * Tracked blocks bypass the block recycling pool, so that each allocation
+ * is attributed to its real call site.
+ * @{
+ */
+
+/**
+ * Prints the allocation statistics.
+ *
+ * Call sites are sorted by decreasing live bytes, and resolved to a shared
+ * object (core or plugin) and symbol where the platform allows.
+ * Nothing is printed if the accounting is disabled.
+ */
+VLC_API void vlc_alloc_stats_Print(FILE *stream);
+
+/** @} */
+#endif
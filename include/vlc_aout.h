@@ -479,6 +479,75 @@ static inline void aout_PauseDefault(audio_output_t *aout, bool paused,
     (void) date;
 }
 
+/* Pull mode audio output helpers */
+
+/**
+ * Sample FIFO for callback-driven audio outputs
+ *
+ * Some devices request samples from a real-time thread or callback, at their
+ * own pace, rather than having the samples pushed to them. The FIFO stands
+ * between the decoder thread, which queues samples with aout_PullPlay(), and
+ * the device thread, which fetches them with aout_PullRender().
+ *
+ * aout_PullRender() never locks nor waits, and only copies samples.
+ * The other functions must be called from the audio output callbacks,
+ * which are serialized by the core.
+ *
+ * The FIFO is only meant for linear formats.
+ */
+typedef struct aout_pull aout_pull_t;
+
+/**
+ * Creates a sample FIFO
+ *
+ * \param fmt format of the samples, as returned by the start() callback
+ * \param length duration of samples the FIFO can hold; it bounds the
+ * latency added on top of the one of the device
+ * \return a FIFO or NULL on error
+ */
+VLC_API aout_pull_t *aout_PullNew(audio_output_t *,
+                                  const audio_sample_format_t *fmt,
+                                  vlc_tick_t length) VLC_USED;
+VLC_API void aout_PullDelete(aout_pull_t *);
+
+/**
+ * Queues samples, from the play() callback
+ *
+ * This waits for the device to consume samples if the FIFO is full.
+ */
+VLC_API void aout_PullPlay(aout_pull_t *, block_t *block, vlc_tick_t date);
+
+/**
+ * Pauses or resumes, from the pause() callback
+ *
+ * While paused, aout_PullRender() renders silence and retains the samples.
+ */
+VLC_API void aout_PullPause(aout_pull_t *, bool paused);
+
+/**
+ * Discards the queued samples, from the flush() callback
+ */
+VLC_API void aout_PullFlush(aout_pull_t *);
+
+/**
+ * Implements the time_get() callback
+ */
+VLC_API int aout_PullTimeGet(aout_pull_t *, vlc_tick_t *restrict delay);
+
+/**
+ * Fetches samples for the device
+ *
+ * The buffer is padded with silence if there are not enough samples queued,
+ * or if the first queued sample is due later than the rendered ones.
+ *
+ * \param buf buffer to fill with frames
+ * \param frames number of frames requested by the device
+ * \param date system date when the first frame of the buffer will be heard
+ * \return the number of frames copied from the FIFO
+ */
+VLC_API size_t aout_PullRender(aout_pull_t *, void *buf, size_t frames,
+                               vlc_tick_t date);
+
 /* Audio output filters */
 
 /**
@@ -396,17 +396,44 @@ static inline uint64_t DictHash( const char *psz_string, int hashsize )
     return i_hash % hashsize;
 }
 
+/* Full width hash used to index the dictionaries (one-at-a-time hash) */
+static inline uint32_t vlc_dictionary_hash_( const char *psz_string )
+{
+    uint32_t i_hash = 0;
+    while( *psz_string )
+    {
+        i_hash += (unsigned char)*psz_string++;
+        i_hash += i_hash << 10;
+        i_hash ^= i_hash >> 6;
+    }
+    i_hash += i_hash << 3;
+    i_hash ^= i_hash >> 11;
+    i_hash += i_hash << 15;
+    return i_hash;
+}
+
 typedef struct vlc_dictionary_entry_t
 {
-    char *   psz_key;
+    char *   psz_key; /* NULL if the slot is free */
     void *   p_value;
-    struct vlc_dictionary_entry_t * p_next;
+    uint32_t i_hash;
 } vlc_dictionary_entry_t;
 
+/**
+ * String keyed hash table
+ *
+ * The entries are stored in a single array of slots, with open addressing
+ * and linear probing. The array size is a power of 2 and grows as needed to
+ * keep its load factor below 3/4.
+ *
+ * A key can be inserted several times: the last inserted value is returned
+ * until it is removed.
+ */
 typedef struct vlc_dictionary_t
 {
-    int i_size;
-    vlc_dictionary_entry_t ** p_entries;
+    int i_size; /* number of slots, 0 or a power of 2 */
+    int i_count; /* number of entries */
+    vlc_dictionary_entry_t * p_entries;
 } vlc_dictionary_t;
 
 static void * const kVLCDictionaryNotFound = NULL;
@@ -414,12 +441,18 @@ static void * const kVLCDictionaryNotFound = NULL;
 static inline void vlc_dictionary_init( vlc_dictionary_t * p_dict, int i_size )
 {
     p_dict->p_entries = NULL;
+    p_dict->i_count = 0;
 
     if( i_size > 0 )
     {
-        p_dict->p_entries = (vlc_dictionary_entry_t **)calloc( i_size, sizeof(*p_dict->p_entries) );
+        int i_slots = 8;
+        while( i_slots / 4 * 3 < i_size )
+            i_slots <<= 1;
+
+        p_dict->p_entries = (vlc_dictionary_entry_t *)calloc( i_slots, sizeof(*p_dict->p_entries) );
         if( !p_dict->p_entries )
-            i_size = 0;
+            i_slots = 0;
+        i_size = i_slots;
     }
     p_dict->i_size = i_size;
 }
@@ -428,201 +461,213 @@ static inline void vlc_dictionary_clear( vlc_dictionary_t * p_dict,
                                          void ( * pf_free )( void * p_data, void * p_obj ),
                                          void * p_obj )
 {
-    if( p_dict->p_entries )
+    for( int i = 0; i < p_dict->i_size; i++ )
     {
-        for( int i = 0; i < p_dict->i_size; i++ )
-        {
-            vlc_dictionary_entry_t * p_current, * p_next;
-            p_current = p_dict->p_entries[i];
-            while( p_current )
-            {
-                p_next = p_current->p_next;
-                if( pf_free != NULL )
-                    ( * pf_free )( p_current->p_value, p_obj );
-                free( p_current->psz_key );
-                free( p_current );
-                p_current = p_next;
-            }
-        }
-        free( p_dict->p_entries );
-        p_dict->p_entries = NULL;
+        vlc_dictionary_entry_t * p_entry = &p_dict->p_entries[i];
+        if( p_entry->psz_key == NULL )
+            continue;
+        if( pf_free != NULL )
+            ( * pf_free )( p_entry->p_value, p_obj );
+        free( p_entry->psz_key );
     }
+    free( p_dict->p_entries );
+    p_dict->p_entries = NULL;
     p_dict->i_size = 0;
+    p_dict->i_count = 0;
 }
 
+/* Returns the slot index of the last value inserted for the key, or -1 */
 static inline int
-vlc_dictionary_has_key( const vlc_dictionary_t * p_dict, const char * psz_key )
+vlc_dictionary_lookup_( const vlc_dictionary_t * p_dict, const char * psz_key )
 {
-    if( !p_dict->p_entries )
-        return 0;
+    if( p_dict->i_count == 0 )
+        return -1;
+
+    const uint32_t i_hash = vlc_dictionary_hash_( psz_key );
+    const int i_mask = p_dict->i_size - 1;
 
-    int i_pos = DictHash( psz_key, p_dict->i_size );
-    const vlc_dictionary_entry_t * p_entry = p_dict->p_entries[i_pos];
-    for( ; p_entry != NULL; p_entry = p_entry->p_next )
+    /* The table is never full, the probing ends on a free slot */
+    for( int i = i_hash & i_mask; p_dict->p_entries[i].psz_key != NULL;
+         i = ( i + 1 ) & i_mask )
     {
-        if( !strcmp( psz_key, p_entry->psz_key ) )
-            break;
+        const vlc_dictionary_entry_t * p_entry = &p_dict->p_entries[i];
+        if( p_entry->i_hash == i_hash && !strcmp( psz_key, p_entry->psz_key ) )
+            return i;
     }
-    return p_entry != NULL;
+    return -1;
+}
+
+static inline int
+vlc_dictionary_has_key( const vlc_dictionary_t * p_dict, const char * psz_key )
+{
+    return vlc_dictionary_lookup_( p_dict, psz_key ) >= 0;
 }
 
 static inline void *
 vlc_dictionary_value_for_key( const vlc_dictionary_t * p_dict, const char * psz_key )
 {
-    if( !p_dict->p_entries )
-        return kVLCDictionaryNotFound;
-
-    int i_pos = DictHash( psz_key, p_dict->i_size );
-    vlc_dictionary_entry_t * p_entry = p_dict->p_entries[i_pos];
-
-    if( !p_entry )
-        return kVLCDictionaryNotFound;
-
-    /* Make sure we return the right item. (Hash collision) */
-    do {
-        if( !strcmp( psz_key, p_entry->psz_key ) )
-            return p_entry->p_value;
-        p_entry = p_entry->p_next;
-    } while( p_entry );
-
-    return kVLCDictionaryNotFound;
+    int i = vlc_dictionary_lookup_( p_dict, psz_key );
+    return i >= 0 ? p_dict->p_entries[i].p_value : kVLCDictionaryNotFound;
 }
 
 static inline int
 vlc_dictionary_keys_count( const vlc_dictionary_t * p_dict )
 {
-    vlc_dictionary_entry_t * p_entry;
-    int i, count = 0;
-
-    if( !p_dict->p_entries )
-        return 0;
-
-    for( i = 0; i < p_dict->i_size; i++ )
-    {
-        for( p_entry = p_dict->p_entries[i]; p_entry; p_entry = p_entry->p_next ) count++;
-    }
-    return count;
+    return p_dict->i_count;
 }
 
 static inline bool
 vlc_dictionary_is_empty( const vlc_dictionary_t * p_dict )
 {
-    if( p_dict->p_entries )
-        for( int i = 0; i < p_dict->i_size; i++ )
-            if( p_dict->p_entries[i] )
-                return false;
-    return true;
+    return p_dict->i_count == 0;
 }
 
+/* Returns the entry following p_entry (or the first one if NULL) */
+static inline vlc_dictionary_entry_t *
+vlc_dictionary_next_( const vlc_dictionary_t * p_dict,
+                      const vlc_dictionary_entry_t * p_entry )
+{
+    int i = p_entry != NULL ? ( p_entry - p_dict->p_entries ) + 1 : 0;
+    for( ; i < p_dict->i_size; i++ )
+        if( p_dict->p_entries[i].psz_key != NULL )
+            return &p_dict->p_entries[i];
+    return NULL;
+}
+
+/**
+ * Iterate over all the entries of a dictionary
+ *
+ * The dictionary must not be modified during the iteration.
+ *
+ * \param p_entry a (const) vlc_dictionary_entry_t pointer, set to each entry
+ * \param p_dict the dictionary
+ */
+#define vlc_dictionary_foreach( p_entry, p_dict ) \
+    for( (p_entry) = vlc_dictionary_next_( p_dict, NULL ); (p_entry) != NULL; \
+         (p_entry) = vlc_dictionary_next_( p_dict, p_entry ) )
+
 static inline char **
 vlc_dictionary_all_keys( const vlc_dictionary_t * p_dict )
 {
-    vlc_dictionary_entry_t * p_entry;
+    const vlc_dictionary_entry_t * p_entry;
     char ** ppsz_ret;
-    int i, count = vlc_dictionary_keys_count( p_dict );
+    int count = 0;
 
-    ppsz_ret = (char**)malloc(sizeof(char *) * (count + 1));
+    ppsz_ret = (char**)malloc(sizeof(char *) * (p_dict->i_count + 1));
     if( unlikely(!ppsz_ret) )
         return NULL;
 
-    count = 0;
-    for( i = 0; i < p_dict->i_size; i++ )
-    {
-        for( p_entry = p_dict->p_entries[i]; p_entry; p_entry = p_entry->p_next )
-            ppsz_ret[count++] = strdup( p_entry->psz_key );
-    }
+    vlc_dictionary_foreach( p_entry, p_dict )
+        ppsz_ret[count++] = strdup( p_entry->psz_key );
     ppsz_ret[count] = NULL;
     return ppsz_ret;
 }
 
+/* Stores an entry in the first free slot of its probe sequence. If shadow is
+ * set, a previous entry of the same key is moved further, so that the new one
+ * is found first. */
 static inline void
-vlc_dictionary_insert_impl_( vlc_dictionary_t * p_dict, const char * psz_key,
-                             void * p_value, bool rebuild )
+vlc_dictionary_place_( vlc_dictionary_t * p_dict, vlc_dictionary_entry_t entry,
+                       bool shadow )
 {
-    if( !p_dict->p_entries )
-        vlc_dictionary_init( p_dict, 1 );
+    const int i_mask = p_dict->i_size - 1;
+    int i = entry.i_hash & i_mask;
 
-    int i_pos = DictHash( psz_key, p_dict->i_size );
-    vlc_dictionary_entry_t * p_entry;
-
-    p_entry = (vlc_dictionary_entry_t *)malloc(sizeof(*p_entry));
-    p_entry->psz_key = strdup( psz_key );
-    p_entry->p_value = p_value;
-    p_entry->p_next = p_dict->p_entries[i_pos];
-    p_dict->p_entries[i_pos] = p_entry;
-    if( rebuild )
+    for( ; p_dict->p_entries[i].psz_key != NULL; i = ( i + 1 ) & i_mask )
     {
-        /* Count how many items there was */
-        int count;
-        for( count = 1; p_entry->p_next; count++ )
-            p_entry = p_entry->p_next;
-        if( count > 3 ) /* XXX: this need tuning */
+        vlc_dictionary_entry_t * p_entry = &p_dict->p_entries[i];
+        if( shadow && p_entry->i_hash == entry.i_hash
+         && !strcmp( p_entry->psz_key, entry.psz_key ) )
         {
-            /* Here it starts to be not good, rebuild a bigger dictionary */
-            struct vlc_dictionary_t new_dict;
-            int i_new_size = ( (p_dict->i_size+2) * 3) / 2; /* XXX: this need tuning */
-            int i;
-            vlc_dictionary_init( &new_dict, i_new_size );
-            for( i = 0; i < p_dict->i_size; i++ )
-            {
-                p_entry = p_dict->p_entries[i];
-                while( p_entry )
-                {
-                    vlc_dictionary_insert_impl_( &new_dict, p_entry->psz_key,
-                                             p_entry->p_value,
-                                             false /* To avoid multiple rebuild loop */);
-                    p_entry = p_entry->p_next;
-                }
-            }
-
-            vlc_dictionary_clear( p_dict, NULL, NULL );
-            p_dict->i_size = new_dict.i_size;
-            p_dict->p_entries = new_dict.p_entries;
+            vlc_dictionary_entry_t older = *p_entry;
+            *p_entry = entry;
+            entry = older;
         }
     }
+    p_dict->p_entries[i] = entry;
+}
+
+static inline bool
+vlc_dictionary_resize_( vlc_dictionary_t * p_dict, int i_size )
+{
+    vlc_dictionary_entry_t * p_old = p_dict->p_entries;
+    const int i_old_size = p_dict->i_size;
+
+    vlc_dictionary_entry_t * p_new =
+        (vlc_dictionary_entry_t *)calloc( i_size, sizeof(*p_new) );
+    if( unlikely(p_new == NULL) )
+        return false;
+    p_dict->p_entries = p_new;
+    p_dict->i_size = i_size;
+
+    if( p_old == NULL )
+        return true;
+
+    /* Start after a free slot, so that the entries of a probe sequence are
+     * moved in order and the last inserted values remain the first found */
+    int i_start = 0;
+    while( p_old[i_start].psz_key != NULL )
+        i_start++;
+
+    for( int i = 1; i <= i_old_size; i++ )
+    {
+        const vlc_dictionary_entry_t * p_entry =
+            &p_old[( i_start + i ) & ( i_old_size - 1 )];
+        if( p_entry->psz_key != NULL )
+            vlc_dictionary_place_( p_dict, *p_entry, false );
+    }
+    free( p_old );
+    return true;
 }
 
 static inline void
 vlc_dictionary_insert( vlc_dictionary_t * p_dict, const char * psz_key, void * p_value )
 {
-    vlc_dictionary_insert_impl_( p_dict, psz_key, p_value, true );
+    if( ( p_dict->i_count + 1 ) > p_dict->i_size / 4 * 3
+     && !vlc_dictionary_resize_( p_dict, p_dict->i_size > 0 ? p_dict->i_size * 2 : 8 ) )
+        return;
+
+    vlc_dictionary_entry_t entry;
+    entry.psz_key = strdup( psz_key );
+    if( unlikely(entry.psz_key == NULL) )
+        return;
+    entry.p_value = p_value;
+    entry.i_hash = vlc_dictionary_hash_( psz_key );
+
+    vlc_dictionary_place_( p_dict, entry, true );
+    p_dict->i_count++;
 }
 
 static inline void
-vlc_dictionary_remove_value_for_key( const vlc_dictionary_t * p_dict, const char * psz_key,
+vlc_dictionary_remove_value_for_key( vlc_dictionary_t * p_dict, const char * psz_key,
                                      void ( * pf_free )( void * p_data, void * p_obj ),
                                      void * p_obj )
 {
-    if( !p_dict->p_entries )
-        return;
+    int i = vlc_dictionary_lookup_( p_dict, psz_key );
+    if( i < 0 )
+        return; /* Not found, nothing to do */
 
-    int i_pos = DictHash( psz_key, p_dict->i_size );
-    vlc_dictionary_entry_t * p_entry = p_dict->p_entries[i_pos];
-    vlc_dictionary_entry_t * p_prev;
+    vlc_dictionary_entry_t * p_entries = p_dict->p_entries;
+    const int i_mask = p_dict->i_size - 1;
 
-    if( !p_entry )
-        return; /* Not found, nothing to do */
+    if( pf_free != NULL )
+        ( * pf_free )( p_entries[i].p_value, p_obj );
+    free( p_entries[i].psz_key );
 
-    /* Hash collision */
-    p_prev = NULL;
-    do {
-        if( !strcmp( psz_key, p_entry->psz_key ) )
+    /* Shift back the following entries of the probe sequence that can be
+     * found from the freed slot, no tombstone is needed */
+    for( int j = ( i + 1 ) & i_mask; p_entries[j].psz_key != NULL;
+         j = ( j + 1 ) & i_mask )
+    {
+        const int i_home = p_entries[j].i_hash & i_mask;
+        if( ( ( j - i_home ) & i_mask ) >= ( ( j - i ) & i_mask ) )
         {
-            if( pf_free != NULL )
-                ( * pf_free )( p_entry->p_value, p_obj );
-            if( !p_prev )
-                p_dict->p_entries[i_pos] = p_entry->p_next;
-            else
-                p_prev->p_next = p_entry->p_next;
-            free( p_entry->psz_key );
-            free( p_entry );
-            return;
+            p_entries[i] = p_entries[j];
+            i = j;
         }
-        p_prev = p_entry;
-        p_entry = p_entry->p_next;
-    } while( p_entry );
-
-    /* No key was found */
+    }
+    p_entries[i].psz_key = NULL;
+    p_dict->i_count--;
 }
 
 #ifdef __cplusplus
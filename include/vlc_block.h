@@ -92,6 +92,9 @@
 #define BLOCK_FLAG_BOTTOM_FIELD_FIRST 0x2000
 /** This block contains a single field from interlaced picture. */
 #define BLOCK_FLAG_SINGLE_FIELD  0x4000
+/** No other frame is predicted from this block: it can be skipped when it is
+ *  not displayed */
+#define BLOCK_FLAG_NON_REFERENCE 0x8000
 
 /** This block contains an interlaced picture */
 #define BLOCK_FLAG_INTERLACED_MASK \
@@ -202,6 +205,28 @@ VLC_API block_t *block_Realloc(block_t *, ssize_t pre, size_t body) VLC_USED;
  */
 VLC_API void block_Release(block_t *block);
 
+/**
+ * Block allocator statistics.
+ *
+ * Counters of the recycling pool behind block_Alloc(). Counters are
+ * accumulated per thread and published to the process-wide totals lazily,
+ * so they may lag behind the actual activity of other running threads.
+ */
+struct block_pool_stats
+{
+    uint64_t hits; /**< Allocations served from recycled blocks */
+    uint64_t misses; /**< Allocations that had to use the heap */
+    uint64_t recycled; /**< Releases kept for later reuse */
+    uint64_t freed; /**< Recycled blocks returned to the heap (pool full) */
+};
+
+/**
+ * Retrieves the block allocator statistics.
+ *
+ * @param stats structure to fill with the process-wide counters [OUT]
+ */
+VLC_API void block_PoolStats(struct block_pool_stats *stats);
+
 static inline void block_CopyProperties( block_t *dst, const block_t *src )
 {
     dst->i_flags   = src->i_flags;
@@ -231,6 +256,76 @@ static inline block_t *block_Duplicate( const block_t *p_block )
     return p_dup;
 }
 
+/**
+ * Slices a block.
+ *
+ * Creates a new block referencing part of the payload of the given one,
+ * without copying it. As long as the payload is shared, it must not be
+ * modified in place: see block_MakeWritable(). Growing any of the blocks with
+ * block_Realloc() or block_TryRealloc() moves it to a buffer of its own.
+ *
+ * The new block has the properties (flags, timestamps...) of the given one.
+ *
+ * @param offset offset of the slice in the payload
+ * @param length length of the slice (offset + length <= i_buffer)
+ * @return the new block on success, NULL on error.
+ */
+VLC_API block_t *block_Slice(block_t *, size_t offset, size_t length) VLC_USED;
+
+/**
+ * Shares a block.
+ *
+ * Creates a new block referencing the whole payload of the given one: this
+ * is a cheap replacement for block_Duplicate() for readers.
+ *
+ * @see block_Slice()
+ * @return the new block on success, NULL on error.
+ */
+VLC_USED
+static inline block_t *block_Share( block_t *p_block )
+{
+    return block_Slice( p_block, 0, p_block->i_buffer );
+}
+
+/**
+ * Joins slices of a block.
+ *
+ * If the blocks of the chain are slices of the same payload, in order and
+ * without gaps, replaces them with a single slice covering them all, without
+ * copying. The joined block has the properties of the first one, and the total
+ * length.
+ *
+ * @see block_Slice()
+ * @return the joined block, or NULL if the chain cannot be joined or on error
+ * (in which case the chain is left untouched).
+ */
+VLC_API block_t *block_ChainJoin(block_t *) VLC_USED;
+
+/**
+ * Checks if the payload of a block is shared with other blocks.
+ */
+VLC_API bool block_IsShared(const block_t *) VLC_USED;
+
+/**
+ * Makes a block writable.
+ *
+ * If the payload of the block is shared, replaces the block with a private
+ * copy, otherwise returns the block as is.
+ *
+ * @return a block with a writable payload, or NULL on error (in which case
+ * the block is released).
+ */
+VLC_USED
+static inline block_t *block_MakeWritable( block_t *p_block )
+{
+    if( !block_IsShared( p_block ) )
+        return p_block;
+
+    block_t *p_dup = block_Duplicate( p_block );
+    block_Release( p_block );
+    return p_dup;
+}
+
 /**
  * Wraps heap in a block.
  *
@@ -414,6 +509,10 @@ static inline block_t *block_ChainGather( block_t *p_list )
     if( p_list->p_next == NULL )
         return p_list;  /* Already gathered */
 
+    g = block_ChainJoin( p_list );
+    if( g != NULL )
+        return g; /* Adjoining slices, nothing to copy */
+
     block_ChainProperties( p_list, NULL, &i_total, &i_length );
 
     g = block_Alloc( i_total );
@@ -579,6 +678,28 @@ VLC_API void vlc_fifo_QueueUnlocked(vlc_fifo_t *, block_t *);
  */
 VLC_API block_t *vlc_fifo_DequeueUnlocked(vlc_fifo_t *) VLC_USED;
 
+/**
+ * Dequeues a batch of blocks from a locked FIFO.
+ *
+ * This dequeues blocks from the head of the FIFO until either limit would be
+ * exceeded, and returns them as a linked-list. The first block is always
+ * dequeued if the FIFO is not empty, even if it is larger than the byte limit.
+ *
+ * This is meant for consumers that can process several blocks per lock
+ * cycle, while still bounding the amount of data taken at once.
+ *
+ * @note This function is not a cancellation point.
+ *
+ * @warning The FIFO must be locked by the calling thread using
+ * vlc_fifo_Lock(). Otherwise behaviour is undefined.
+ *
+ * @param max_count maximum number of blocks to dequeue (must be positive)
+ * @param max_bytes maximum total number of payload bytes to dequeue
+ * @return a linked-list of blocks (or NULL if the FIFO is empty)
+ */
+VLC_API block_t *vlc_fifo_DequeueBatchUnlocked(vlc_fifo_t *, size_t max_count,
+                                               size_t max_bytes) VLC_USED;
+
 /**
  * Dequeues the all blocks from a locked FIFO.
  *
@@ -64,12 +64,19 @@ VLC_USED static inline const char *IsUTF8(const char *str)
     size_t n;
     uint32_t cp;
 
-    while ((n = vlc_towc(str, &cp)) != 0)
-        if (likely(n != (size_t)-1))
-            str += n;
-        else
+    for (;;)
+    {
+        /* Skip ASCII without calling vlc_towc() */
+        while ((unsigned char)(*str - 1) < 0x7F)
+            str++;
+        if (*str == '\0')
+            return str;
+
+        n = vlc_towc(str, &cp);
+        if (unlikely(n == (size_t)-1))
             return NULL;
-    return str;
+        str += n;
+    }
 }
 
 /**
@@ -117,7 +124,14 @@ static inline char *EnsureUTF8(char *str)
     size_t n;
     uint32_t cp;
 
-    while ((n = vlc_towc(str, &cp)) != 0)
+    for (;;)
+    {
+        while ((unsigned char)(*str - 1) < 0x7F)
+            str++;
+        if (*str == '\0')
+            return ret;
+
+        n = vlc_towc(str, &cp);
         if (likely(n != (size_t)-1))
             str += n;
         else
@@ -125,7 +139,7 @@ static inline char *EnsureUTF8(char *str)
             *str++ = '?';
             ret = NULL;
         }
-    return ret;
+    }
 }
 
 /* iconv wrappers (defined in src/extras/libc.c) */
@@ -115,6 +115,10 @@ struct decoder_t
     /* Tell the decoder if it is allowed to drop frames */
     bool                b_frame_drop_allowed;
 
+    /* Tell the packetizer that its output is only remuxed: it can then skip
+     * parsing anything not needed to delimit and time the access units */
+    bool                b_remux;
+
     /**
      * Number of extra (ie in addition to the DPB) picture buffers
      * needed for decoding.
@@ -20,7 +20,7 @@
 
 /**
  * \file
- * This file provides CPU features detection.
+ * This file provides CPU features detection and the decoders CPU budget.
  */
 
 #ifndef VLC_CPU_H
@@ -28,6 +28,36 @@
 
 VLC_API unsigned vlc_CPU(void);
 
+/**
+ * Reserves a share of the CPU budget.
+ *
+ * The threads budget of the LibVLC instance ("cpu-budget", one per CPU by
+ * default) is split evenly between its current users, so that concurrent
+ * decoders do not each start as many threads as there are CPUs.
+ *
+ * \param obj object of the caller
+ * eturn number of threads the caller should use (at least one)
+ * 
+ote Each call must be paired with vlc_CPUBudgetRelease().
+ */
+VLC_API unsigned vlc_CPUBudgetAcquire(vlc_object_t *obj);
+#define vlc_CPUBudgetAcquire(o) vlc_CPUBudgetAcquire(VLC_OBJECT(o))
+
+/**
+ * Returns the current share of a user of the CPU budget.
+ *
+ * This changes as other users come and go. Callers able to resize their
+ * thread pool can poll it, e.g. when flushing.
+ */
+VLC_API unsigned vlc_CPUBudgetShare(vlc_object_t *obj);
+#define vlc_CPUBudgetShare(o) vlc_CPUBudgetShare(VLC_OBJECT(o))
+
+/**
+ * Gives back a share acquired with vlc_CPUBudgetAcquire().
+ */
+VLC_API void vlc_CPUBudgetRelease(vlc_object_t *obj);
+#define vlc_CPUBudgetRelease(o) vlc_CPUBudgetRelease(VLC_OBJECT(o))
+
 # if defined (__i386__) || defined (__x86_64__)
 #  define HAVE_FPU 1
 #  define VLC_CPU_MMX    0x00000008
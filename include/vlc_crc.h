@@ -0,0 +1,55 @@
+/*****************************************************************************
+ * vlc_crc.h: cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_CRC_H
+#define VLC_CRC_H 1
+
+/**
+ * \defgroup crc Cyclic redundancy checks
+ * \ingroup strings
+ *
+ * These functions compute the non-reflected (most significant bit first)
+ * CRCs found in multimedia bitstreams. They do not apply any initial or
+ * final inversion: the initial value is passed by the caller, and the CRC of
+ * a buffer split in several parts can be computed by passing the result of
+ * each call to the next one.
+ * @{
+ */
+
+/**
+ * Computes a CRC-8 with polynomial x^8 + x^2 + x + 1 (0x07),
+ * as used by FLAC frame headers.
+ */
+VLC_API uint8_t vlc_crc8(uint8_t crc, const void *buf, size_t len) VLC_USED;
+
+/**
+ * Computes a CRC-16 with polynomial x^16 + x^15 + x^2 + 1 (0x8005),
+ * as used by FLAC frames.
+ */
+VLC_API uint16_t vlc_crc16(uint16_t crc, const void *buf, size_t len) VLC_USED;
+
+/**
+ * Computes a CRC-32 with polynomial 0x04C11DB7, as used by MPEG systems
+ * sections (with an initial value of 0xFFFFFFFF).
+ */
+VLC_API uint32_t vlc_crc32(uint32_t crc, const void *buf, size_t len) VLC_USED;
+
+/** @} */
+#endif
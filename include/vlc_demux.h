@@ -195,6 +195,8 @@ enum demux_query_e
     /* DEMUX_SET_GROUP_* / DEMUX_SET_ES is only a hint for demuxer (mainly DVB)
      * to avoid parsing everything (you should not use this to call
      * es_out_Control()).
+     * DEMUX_SET_ES_LIST with an empty list notifies that an ES was unselected,
+     * the current state can be queried with ES_OUT_GET_ES_STATE.
      * If you don't know what to do with it, just IGNORE it: it is safe(r). */
     DEMUX_SET_GROUP_DEFAULT,
     DEMUX_SET_GROUP_ALL,
@@ -0,0 +1,127 @@
+/*****************************************************************************
+ * vlc_executor.h: shared thread pool for background jobs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_EXECUTOR_H
+#define VLC_EXECUTOR_H 1
+
+#include <vlc_list.h>
+
+/**
+ * \defgroup executor Executor
+ * \ingroup threads
+ * Thread pool for background jobs
+ *
+ * An executor runs jobs on a bounded set of worker threads, which are started
+ * on demand and shared by all its users. Jobs are taken by priority. Jobs
+ * submitted from a worker thread are queued on that worker first, and idle
+ * workers steal them from the busy ones.
+ *
+ * Each LibVLC instance has an executor, see vlc_object_executor().
+ * @{
+ */
+
+typedef struct vlc_executor vlc_executor_t;
+
+enum vlc_executor_priority
+{
+    VLC_EXECUTOR_PRIORITY_LOW,
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    VLC_EXECUTOR_PRIORITY_HIGH,
+};
+
+/**
+ * A job to be run by an executor.
+ *
+ * The runnable is also the cancellation token of the job: see
+ * vlc_executor_Cancel() and vlc_executor_IsCanceled().
+ */
+struct vlc_runnable
+{
+    /**
+     * Runs the job.
+     *
+     * The executor does not access the runnable once this returns, so the
+     * callback may free it.
+     */
+    void (*run)(void *userdata);
+    void *userdata;
+
+    /* Private, owned by the executor */
+    struct vlc_list node;
+    bool queued;
+    bool canceled;
+};
+
+/**
+ * Creates an executor.
+ *
+ * \param max_threads maximum number of worker threads (0 for automatic)
+ * \return the executor, or NULL on error
+ */
+VLC_API vlc_executor_t *vlc_executor_New(unsigned max_threads) VLC_USED;
+
+/**
+ * Deletes an executor.
+ *
+ * Waits for the running jobs to finish. Jobs still queued are not run.
+ */
+VLC_API void vlc_executor_Delete(vlc_executor_t *);
+
+/**
+ * Queues a job.
+ *
+ * \param runnable job (must remain valid until it has run or was canceled)
+ * \param priority one of \ref vlc_executor_priority
+ * \retval VLC_SUCCESS the job is queued
+ * \retval VLC_EGENERIC no worker thread could be started
+ */
+VLC_API int vlc_executor_Submit(vlc_executor_t *,
+                                struct vlc_runnable *runnable, int priority);
+
+/**
+ * Cancels a job.
+ *
+ * If the job has not started yet, it is removed from the queue and will not
+ * run. Otherwise, it is flagged so that it can stop early by checking
+ * vlc_executor_IsCanceled().
+ *
+ * \warning This must not be called after the job has completed.
+ *
+ * \retval true if the job was removed before it started
+ * \retval false if the job is running
+ */
+VLC_API bool vlc_executor_Cancel(vlc_executor_t *,
+                                 struct vlc_runnable *runnable);
+
+/**
+ * Checks if a (running) job was canceled.
+ */
+VLC_API bool vlc_executor_IsCanceled(vlc_executor_t *,
+                                     const struct vlc_runnable *runnable)
+VLC_USED;
+
+/**
+ * Gets the executor of the LibVLC instance of an object.
+ */
+VLC_API vlc_executor_t *vlc_object_executor(vlc_object_t *obj) VLC_USED;
+#define vlc_object_executor(o) vlc_object_executor(VLC_OBJECT(o))
+
+/** @} */
+#endif
@@ -27,6 +27,7 @@
 
 #include <vlc_es.h>
 #include <vlc_picture.h>
+#include <vlc_block.h>
 
 /**
  * \defgroup filter Filters
@@ -203,6 +204,39 @@ static inline block_t *filter_DrainAudio( filter_t *p_filter )
         return NULL;
 }
 
+/**
+ * This function will return an output block for an audio filter changing
+ * the size of the samples (format or channels count).
+ *
+ * The input block is returned if it has room for the output samples, so
+ * that the filter can process in place. The filter must then not overwrite
+ * input samples before reading them, i.e. process from the end if the output
+ * samples are larger. Otherwise, a new block is allocated, with the
+ * properties of the input block; the input block is not released.
+ *
+ * In both cases, the filter must set i_buffer to the output size.
+ *
+ * \param p_filter filter_t object
+ * \param p_in input block
+ * \param i_size size of the output samples in bytes
+ * \return output block on success or NULL on failure
+ */
+static inline block_t *filter_NewAudioBuffer( filter_t *p_filter,
+                                              block_t *p_in, size_t i_size )
+{
+    if( (size_t)(p_in->p_start + p_in->i_size - p_in->p_buffer) >= i_size )
+        return p_in;
+
+    block_t *p_out = block_Alloc( i_size );
+    if( p_out == NULL )
+    {
+        msg_Warn( p_filter, "can't get output buffer" );
+        return NULL;
+    }
+    block_CopyProperties( p_out, p_in );
+    return p_out;
+}
+
 /**
  * This function will return a new subpicture usable by p_filter as an output
  * buffer. You have to release it using subpicture_Delete or by returning it to
@@ -258,6 +292,23 @@ VLC_API void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 # define filter_DelProxyCallbacks(a, b, c) \
     filter_DelProxyCallbacks(VLC_OBJECT(a), b, c)
 
+/**
+ * Processes lines [0, lines) in bands, concurrently on the LibVLC thread
+ * pool shared by filters (see the filter-threads option).
+ *
+ * The callback is invoked for each band, from the calling thread or from
+ * the pool, and must only write the lines of its band. This function
+ * returns once every band has been processed.
+ *
+ * \param align band height alignment in lines (e.g. 2 for 4:2:0 chroma)
+ * \param cb callback processing lines [start, end)
+ */
+VLC_API void filter_RunSlices( filter_t *filter, unsigned lines,
+                               unsigned align,
+                               void (*cb)( void *opaque, unsigned start,
+                                           unsigned end ),
+                               void *opaque );
+
 typedef filter_t vlc_blender_t;
 
 /**
@@ -141,6 +141,9 @@ VLC_API httpd_stream_t * httpd_StreamNew( httpd_host_t *, const char *psz_url, c
 VLC_API void httpd_StreamDelete( httpd_stream_t * );
 VLC_API int httpd_StreamHeader( httpd_stream_t *, uint8_t *p_data, int i_data );
 VLC_API int httpd_StreamSend( httpd_stream_t *, const block_t *p_block );
+/* Same as httpd_StreamSend() without copying the data: the stream takes
+ * ownership of the block, and shares it with the clients */
+VLC_API int httpd_StreamSendBlock( httpd_stream_t *, block_t *p_block );
 VLC_API int httpd_StreamSetHTTPHeaders(httpd_stream_t *, const httpd_header *, size_t);
 
 /* Msg functions facilities */
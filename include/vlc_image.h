@@ -74,6 +74,30 @@ VLC_API vlc_fourcc_t image_Type2Fourcc( const char *psz_name );
 VLC_API vlc_fourcc_t image_Ext2Fourcc( const char *psz_name );
 VLC_API vlc_fourcc_t image_Mime2Fourcc( const char *psz_mime );
 
+/**
+ * Gets a thumbnail of an artwork.
+ *
+ * The artwork is decoded once, scaled down to fit into the requested box,
+ * keeping its aspect ratio, and stored as JPEG in the art cache directory.
+ * Subsequent calls with the same size return the cached thumbnail, unless
+ * the artwork is a local file modified since.
+ *
+ * This function may block (decoding, network access). It should not be
+ * called from a UI thread.
+ *
+ * \param obj parent object
+ * \param psz_arturl URL of the artwork (typically the vlc_meta_ArtworkURL)
+ * \param i_max_width maximum thumbnail width (0 for unlimited)
+ * \param i_max_height maximum thumbnail height (0 for unlimited)
+ * \return the URL of the thumbnail (to be freed with free()), which is a copy
+ * of psz_arturl if the artwork is already small enough, or NULL on error
+ */
+VLC_API char *vlc_art_GetThumbnail( vlc_object_t *obj, const char *psz_arturl,
+                                    unsigned i_max_width,
+                                    unsigned i_max_height ) VLC_USED;
+#define vlc_art_GetThumbnail( a, b, c, d ) \
+        vlc_art_GetThumbnail( VLC_OBJECT(a), b, c, d )
+
 # ifdef __cplusplus
 }
 # endif
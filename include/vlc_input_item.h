@@ -85,7 +85,9 @@ struct input_item_t
     input_item_opaque_t *opaques;    /**< List of opaque pointer values */
 
     vlc_tick_t i_duration;           /**< Duration in vlc ticks */
-
+    int64_t    i_file_size;          /**< File size in bytes, or -1 */
+    int64_t    i_file_mtime;         /**< File modification time as epoch
+                                          time, or -1 */
 
     int        i_categories;         /**< Number of info categories */
     info_category_t **pp_categories; /**< Pointer to the first info category */
@@ -491,6 +493,11 @@ VLC_API int libvlc_MetadataRequest( libvlc_int_t *, input_item_t *,
                                     const input_preparser_callbacks_t *cbs,
                                     void *cbs_userdata,
                                     int, void * );
+VLC_API int libvlc_MetadataRequestBatch( libvlc_int_t *,
+                                         input_item_t *const *, size_t,
+                                         input_item_meta_request_option_t,
+                                         const input_preparser_callbacks_t *cbs,
+                                         void *const *cbs_userdata, int );
 VLC_API int libvlc_ArtRequest(libvlc_int_t *, input_item_t *,
                               input_item_meta_request_option_t,
                               const input_fetcher_callbacks_t *cbs,
@@ -500,6 +507,32 @@ VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
 /******************
  * Input stats
  ******************/
+
+/** Decoder pipeline latencies */
+enum input_latency_e
+{
+    INPUT_LATENCY_VIDEO_QUEUE,   /**< block arrival to video decoding */
+    INPUT_LATENCY_VIDEO_DECODE,  /**< video block decoding */
+    INPUT_LATENCY_VIDEO_DISPLAY, /**< picture queued to display date */
+    INPUT_LATENCY_AUDIO_QUEUE,   /**< block arrival to audio decoding */
+    INPUT_LATENCY_AUDIO_DECODE,  /**< audio block decoding */
+    INPUT_LATENCY_AUDIO_PLAY,    /**< audio decoding start to aout play */
+    INPUT_LATENCY_VIDEO_TOTAL,   /**< block arrival to picture display date */
+};
+#define INPUT_LATENCY_COUNT (INPUT_LATENCY_VIDEO_TOTAL + 1)
+
+/** Buckets of the latency histograms, the bucket i counts the samples
+ * within [2^i, 2^(i+1)[ microseconds, the first and last ones are open */
+#define INPUT_LATENCY_BUCKETS 24
+
+typedef struct input_latency_t
+{
+    int64_t i_samples;
+    vlc_tick_t i_total;
+    vlc_tick_t i_max;
+    int64_t pi_buckets[INPUT_LATENCY_BUCKETS];
+} input_latency_t;
+
 struct input_stats_t
 {
     /* Input */
@@ -525,6 +558,13 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Decoder pipeline latencies (cumulated) */
+    input_latency_t latency[INPUT_LATENCY_COUNT];
+
+    /* Clock */
+    float f_clock_drift; /* system against stream clock, in ppm */
+    vlc_tick_t i_clock_jitter; /* master clock updates jitter */
 };
 
 /**
@@ -578,10 +618,13 @@ VLC_API void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_
  *        be valid.
  * \param i_type see \ref input_item_type_e
  * \param i_net see \ref input_item_net_type
+ * \param pp_item if not NULL, set to the new item (or to NULL if the entry is
+ *        ignored), so that the caller can fill its file size and date
  */
 VLC_API int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
                                        const char *psz_uri, const char *psz_flatpath,
                                        const char *psz_filename,
-                                       int i_type, int i_net);
+                                       int i_type, int i_net,
+                                       input_item_t **pp_item);
 
 #endif
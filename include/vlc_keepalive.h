@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * vlc_keepalive.h: store for idle reusable resources
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_KEEPALIVE_H
+#define VLC_KEEPALIVE_H 1
+
+/**
+ * \defgroup keepalive Keep-alive store
+ * \ingroup misc
+ * Idle resources kept for reuse
+ *
+ * A keep-alive store holds idle resources, such as network connections, for
+ * a limited time, so that they can be reused by later users instead of being
+ * set up again. Resources are identified by a key, e.g. the origin of a
+ * connection.
+ *
+ * Stored resources are released when they expire, when they are evicted to
+ * make room for newer ones, or with the store. The release callback may thus
+ * be invoked from any thread.
+ *
+ * Each LibVLC instance has a store, see vlc_object_keepalive(). It outlives
+ * all objects and modules of the instance.
+ * @{
+ */
+
+typedef struct vlc_keepalive vlc_keepalive_t;
+
+/**
+ * Creates a keep-alive store.
+ *
+ * \param max maximum number of stored resources
+ * \return the store, or NULL on error
+ */
+VLC_API vlc_keepalive_t *vlc_keepalive_New(size_t max) VLC_USED;
+
+/**
+ * Deletes a keep-alive store.
+ *
+ * All stored resources are released.
+ */
+VLC_API void vlc_keepalive_Delete(vlc_keepalive_t *);
+
+/**
+ * Stores an idle resource.
+ *
+ * The store takes ownership of the resource in any case. If there are
+ * already max_per_key resources with the same key, or if the store is full,
+ * the oldest ones are released.
+ *
+ * \param key key of the resource (nul-terminated, copied)
+ * \param data resource
+ * \param release callback to release the resource
+ * \param timeout how long to keep the resource at most
+ * \param max_per_key maximum number of resources with the same key
+ * \retval VLC_SUCCESS the resource is stored
+ * \retval VLC_ENOMEM the resource was released immediately
+ */
+VLC_API int vlc_keepalive_Put(vlc_keepalive_t *, const char *key, void *data,
+                              void (*release)(void *), vlc_tick_t timeout,
+                              unsigned max_per_key);
+
+/**
+ * Takes an idle resource.
+ *
+ * Removes the most recently stored resource with a given key from the
+ * store, and returns it. The caller becomes responsible for it.
+ *
+ * \return the resource, or NULL if there is none
+ */
+VLC_API void *vlc_keepalive_Take(vlc_keepalive_t *, const char *key) VLC_USED;
+
+/**
+ * Gets the keep-alive store of the LibVLC instance of an object.
+ *
+ * \return the store, or NULL if it could not be created
+ */
+VLC_API vlc_keepalive_t *vlc_object_keepalive(vlc_object_t *obj) VLC_USED;
+#define vlc_object_keepalive(o) vlc_object_keepalive(VLC_OBJECT(o))
+
+/** @} */
+#endif
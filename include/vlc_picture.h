@@ -71,6 +71,41 @@ typedef struct picture_context_t
     struct picture_context_t *(*copy)(struct picture_context_t *);
 } picture_context_t;
 
+/**
+ * AV1 film grain synthesis parameters
+ *
+ * Decoders can attach these to the pictures and leave the grain synthesis
+ * to the video output (see the AV1 specification, film_grain_params()).
+ * The values are the syntax elements of the bitstream.
+ */
+typedef struct vlc_film_grain_t
+{
+    uint16_t random_seed;
+    uint8_t  num_y_points;
+    uint8_t  y_points[14][2]; /**< value and scaling pairs */
+    bool     chroma_scaling_from_luma;
+    uint8_t  num_uv_points[2]; /**< Cb, Cr */
+    uint8_t  uv_points[2][10][2];
+    uint8_t  scaling_shift; /**< grain_scaling_minus_8 + 8 */
+    uint8_t  ar_coeff_lag;
+    int8_t   ar_coeffs_y[24]; /**< ar_coeffs_y_plus_128 - 128 */
+    int8_t   ar_coeffs_uv[2][25];
+    uint8_t  ar_coeff_shift; /**< ar_coeff_shift_minus_6 + 6 */
+    uint8_t  grain_scale_shift;
+    int16_t  uv_mult[2];
+    int16_t  uv_mult_luma[2];
+    int16_t  uv_offset[2];
+    bool     overlap;
+    bool     clip_to_restricted_range;
+} vlc_film_grain_t;
+
+/**
+ * Allocates zeroed film grain parameters, with a reference count of one.
+ */
+VLC_API vlc_film_grain_t *vlc_film_grain_New(void) VLC_USED;
+VLC_API vlc_film_grain_t *vlc_film_grain_Hold(vlc_film_grain_t *);
+VLC_API void vlc_film_grain_Release(vlc_film_grain_t *);
+
 typedef struct picture_buffer_t
 {
     int fd;
@@ -115,6 +150,7 @@ struct picture_t
     bool            b_top_field_first;             /**< which field is first */
     unsigned int    i_nb_fields;                  /**< number of displayed fields */
     picture_context_t *context;      /**< video format-specific data pointer */
+    vlc_film_grain_t *film_grain; /**< grain left to synthesize (or NULL) */
     /**@}*/
 
     /** Private data - the video output plugin might want to put stuff here to
@@ -431,6 +431,22 @@ vlc_player_HoldCurrentMedia(vlc_player_t *player)
 VLC_API void
 vlc_player_InvalidateNextMedia(vlc_player_t *player);
 
+/**
+ * Preload the next media
+ *
+ * Open the media returned by the vlc_player_media_provider.get_next callback
+ * while the current one is playing. Its input is started paused and fills its
+ * buffers, so that the transition to this media is gapless and does not wait
+ * for the access, demux and decoders to open.
+ *
+ * The preloaded input is discarded if the next media is invalidated.
+ *
+ * @param player locked player instance
+ * @return VLC_SUCCESS on success, VLC_EGENERIC if there is no next media
+ */
+VLC_API int
+vlc_player_PreloadNextMedia(vlc_player_t *player);
+
 /**
  * Start the playback of the current media.
  *
@@ -670,6 +686,43 @@ vlc_player_GetTime(vlc_player_t *player);
 VLC_API float
 vlc_player_GetPosition(vlc_player_t *player);
 
+/**
+ * Get the clock reference of the current media
+ *
+ * The reference is a point converting stream timestamps into system dates
+ * (vlc_tick_now() time base). Players presenting the same media can exchange
+ * it to render it in sync, see vlc_player_SetClockReference().
+ *
+ * @param player locked player instance
+ * @param system pointer to the system date of the reference
+ * @param ts pointer to the stream timestamp of the reference
+ * @return VLC_SUCCESS or VLC_EGENERIC if the clock has no reference (no media,
+ * buffering, paused)
+ */
+VLC_API int
+vlc_player_GetClockReference(vlc_player_t *player, vlc_tick_t *system,
+                             vlc_tick_t *ts);
+
+/**
+ * Drive the clock of the current media from an external reference
+ *
+ * The stream timestamp ts will be presented at the system date system, and
+ * the other ones accordingly. This lets a network master, or a PTP/NTP
+ * disciplined source converted to the local time base, drive the playback.
+ *
+ * @note The reference is only used when no elementary stream drives the
+ * clock, i.e. with the "clock-master" option set to "monotonic". It is
+ * dropped on seek, so it should be sent periodically.
+ *
+ * @param player locked player instance
+ * @param system a system date, in the vlc_tick_now() time base
+ * @param ts a stream timestamp of the current media
+ * @return VLC_SUCCESS or VLC_EGENERIC if there is no media or program
+ */
+VLC_API int
+vlc_player_SetClockReference(vlc_player_t *player, vlc_tick_t system,
+                             vlc_tick_t ts);
+
 /**
  * Seek the current media by position
  *
@@ -2095,6 +2148,17 @@ vlc_player_SetRenderer(vlc_player_t *player, vlc_renderer_item_t *renderer);
 VLC_API vlc_renderer_item_t *
 vlc_player_GetRenderer(vlc_player_t *player);
 
+/**
+ * Set the stream output chain
+ *
+ * Valid for the media started after this call, and all future ones.
+ *
+ * @param player locked player instance
+ * @param chain stream output chain (e.g. "#std{...}") or NULL to disable it
+ */
+VLC_API void
+vlc_player_SetStreamOutput(vlc_player_t *player, const char *chain);
+
 /** @} vlc_player__renderer */
 
 /**
@@ -2393,6 +2457,22 @@ vlc_player_vout_Hold(vlc_player_t *player);
 VLC_API vout_thread_t **
 vlc_player_vout_HoldAll(vlc_player_t *player, size_t *count);
 
+/**
+ * Create the main video output ahead of playback
+ *
+ * The video output and its window are created right away (if there is none
+ * yet) and reused by the first video track, instead of being created when
+ * the track starts. This reduces the start-up latency of the video.
+ *
+ * @note Window related variables (drawable, etc.) must be set before calling
+ * this function.
+ *
+ * @param player player instance
+ * @return VLC_SUCCESS or a VLC error code
+ */
+VLC_API int
+vlc_player_vout_Prepare(vlc_player_t *player);
+
 /**
  * Add a listener callback for video output events
  *
@@ -641,6 +641,30 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
                   const struct vlc_playlist_sort_criterion criteria[],
                   size_t count);
 
+/**
+ * Insert a list of media in a sorted playlist, at their sorted positions.
+ *
+ * The playlist must already be sorted by the same criteria (typically by
+ * vlc_playlist_Sort()). Only the new media are sorted, and the items are
+ * merged in a single pass, so that adding items to a large sorted playlist
+ * does not require to sort it again.
+ *
+ * The new items are notified by slices of contiguous items, in increasing
+ * order of index.
+ *
+ * \param playlist       the playlist, locked
+ * \param criteria       the sort criteria (in order)
+ * \param criteria_count the number of criteria
+ * \param media          the array of media to insert
+ * \param count          the number of media to insert
+ * eturn VLC_SUCCESS on success, another value on error
+ */
+VLC_API int
+vlc_playlist_InsertSorted(vlc_playlist_t *playlist,
+                          const struct vlc_playlist_sort_criterion criteria[],
+                          size_t criteria_count,
+                          input_item_t *const media[], size_t count);
+
 /**
  * Return the index of a given item.
  *
@@ -48,6 +48,7 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_PROBE_HINTS,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -307,6 +308,15 @@ VLC_METADATA_EXPORTS
      || vlc_module_set (VLC_MODULE_SCORE, (int)(score))) \
         goto error;
 
+/**
+ * Declares what a module is likely to handle, as a comma-separated list of
+ * lower case tokens (file extensions, MIME types, FourCCs...). Candidates
+ * whose hints match the token of a request are probed first.
+ */
+#define set_probe_hints( hints ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_HINTS, (const char *)(hints))) \
+        goto error;
+
 #define set_callback(activate) \
     if (vlc_module_set(VLC_MODULE_CB_OPEN, #activate, (void *)(activate))) \
         goto error;
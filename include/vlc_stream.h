@@ -168,6 +168,9 @@ enum stream_query_e
     STREAM_GET_CONTENT_TYPE,    /**< arg1= char **         res=can fail */
     STREAM_GET_SIGNAL,      /**< arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
     STREAM_GET_TAGS,        /**< arg1=const block_t ** res=can fail */
+    STREAM_GET_VALIDATOR,   /**< arg1= char ** res=can fail
+                                 (opaque string identifying this version of
+                                 the content, e.g. an HTTP entity tag) */
 
     STREAM_SET_PAUSE_STATE = 0x200, /**< arg1= bool        res=can fail */
     STREAM_SET_TITLE,       /**< arg1= int          res=can fail */
@@ -104,6 +104,16 @@ struct vlc_spu_highlight_t
  */
 VLC_API subpicture_region_t * subpicture_region_New( const video_format_t *p_fmt );
 
+/**
+ * This function will create a new subpicture region sharing an existing
+ * picture, such as one previously drawn and left unchanged.
+ *
+ * A reference to the picture is held by the region.
+ * You must use subpicture_region_Delete to destroy it.
+ */
+VLC_API subpicture_region_t * subpicture_region_ForPicture( const video_format_t *p_fmt,
+                                                            picture_t *p_picture );
+
 /**
  * This function will destroy a subpicture region allocated by
  * subpicture_region_New.
@@ -43,6 +43,19 @@ typedef struct vlc_thumbnailer_request_t vlc_thumbnailer_request_t;
  */
 typedef void(*vlc_thumbnailer_cb)( void* data, picture_t* thumbnail );
 
+/**
+ * \brief vlc_thumbnailer_batch_cb defines a callback invoked for each
+ * thumbnail of a batch request
+ *
+ * \param data Is the opaque pointer passed as vlc_thumbnailer_RequestBatch
+ * last parameter
+ * \param index The index of the requested time
+ * \param thumbnail The generated thumbnail, or NULL in case of failure or
+ * timeout, with the same ownership as for vlc_thumbnailer_cb
+ */
+typedef void(*vlc_thumbnailer_batch_cb)( void* data, size_t index,
+                                         picture_t* thumbnail );
+
 
 /**
  * \brief vlc_thumbnailer_Create Creates a thumbnailer object
@@ -112,6 +125,87 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               input_item_t *input_item, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief vlc_thumbnailer_RequestBatch Requests thumbnails at several times
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken
+ * \param count The number of times
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for the whole batch, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cb A user callback to be called once per time, in order
+ * \param user_data An opaque value, provided as cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * This is meant for many thumbnails of the same item, such as seek bar
+ * previews: the item is opened once, each time is reached with a fast seek,
+ * and only the key frame found there is decoded.
+ *
+ * If this function returns a valid request object, the callback is guaranteed
+ * to be called for each time, even in case of later failure, unless the
+ * request is cancelled. The returned request object must not be used after
+ * the last callback has been invoked.
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_batch_cb cb, void* user_data );
+
+/**
+ * Sprite sheet layout
+ */
+struct vlc_thumbnailer_sheet_params
+{
+    vlc_tick_t interval; /**< time between two tiles */
+    unsigned tile_width; /**< tile width in pixels */
+    unsigned tile_height; /**< tile height in pixels */
+    unsigned columns; /**< tiles per row */
+    unsigned segments; /**< inputs decoding in parallel, 0 for automatic */
+};
+
+/**
+ * \brief vlc_thumbnailer_sheet_cb defines a callback invoked when a sprite
+ * sheet is complete
+ *
+ * \param data Is the opaque pointer passed as vlc_thumbnailer_RequestSheet
+ * last parameter
+ * \param sheet The RGBA sprite sheet, or NULL in case of failure. It is owned
+ * by the thumbnailer, and must be acquired with picture_Hold to be used
+ * after the callback returns.
+ * \param index The WebVTT index of the tiles, with one "#xywh=" media
+ * fragment per cue, relative to the sheet image
+ */
+typedef void(*vlc_thumbnailer_sheet_cb)( void* data, picture_t* sheet,
+                                         const char* index );
+
+/**
+ * \brief vlc_thumbnailer_RequestSheet Requests a sprite sheet of an item
+ * \param thumbnailer A thumbnailer object
+ * \param input_item The input item, with a known duration
+ * \param params The sheet layout
+ * \param timeout A timeout value for each segment, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cb A user callback to be called on completion
+ * \param user_data An opaque value, provided as cb's first parameter
+ * \return VLC_SUCCESS if the sheet was requested, an error code otherwise
+ *
+ * One tile is taken at every interval from the start of the item, with key
+ * frame seeking. The tiles are split in segments, which are decoded by
+ * separate inputs in parallel, up to the "thumbnailer-threads" option.
+ * Tiles that cannot be taken are left transparent.
+ *
+ * On success, the callback is guaranteed to be called exactly once. Sheet
+ * requests cannot be cancelled, but releasing the thumbnailer completes
+ * them early.
+ */
+VLC_API int
+vlc_thumbnailer_RequestSheet( vlc_thumbnailer_t *thumbnailer,
+                              input_item_t *input_item,
+                              const struct vlc_thumbnailer_sheet_params *params,
+                              vlc_tick_t timeout,
+                              vlc_thumbnailer_sheet_cb cb, void* user_data );
+
 /**
  * \brief vlc_thumbnailer_Cancel Cancel a thumbnail request
  * \param thumbnailer A thumbnailer object
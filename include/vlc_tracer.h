@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * vlc_tracer.h: tracing interface
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TRACER_H
+#define VLC_TRACER_H
+
+/**
+ * \defgroup tracer Tracer
+ * \ingroup os
+ * Timeline traces of the pipeline.
+ *
+ * Spans are recorded around the processing steps of the pipeline (demux
+ * calls, decoding, display, ...) and written by a "tracer" module, selected
+ * with the --tracer option. Without tracer, recording a span costs a single
+ * check. Tracing can also be removed at build time (--disable-tracer).
+ * @{
+ */
+
+enum vlc_tracer_phase
+{
+    VLC_TRACER_BEGIN, /**< Start of a span */
+    VLC_TRACER_END, /**< End of the last span of the thread */
+    VLC_TRACER_INSTANT, /**< Instantaneous event */
+};
+
+struct vlc_tracer_event
+{
+    enum vlc_tracer_phase phase;
+    const char *category; /**< Pipeline stage, e.g. "decoder" */
+    const char *name; /**< Span name, e.g. the module name */
+    vlc_tick_t date; /**< Monotonic date of the event */
+    unsigned long thread; /**< Identifier of the calling thread */
+};
+
+/**
+ * Tracer module operations
+ *
+ * The trace callback can be invoked from any thread, concurrently.
+ * The strings of the event are only valid for the duration of the call.
+ */
+struct vlc_tracer_operations
+{
+    void (*trace)(void *opaque, const struct vlc_tracer_event *);
+    void (*destroy)(void *opaque);
+};
+
+struct vlc_tracer;
+
+/**
+ * Gets the tracer of an object.
+ *
+ * \return the tracer of the LibVLC instance, or NULL if tracing is disabled
+ */
+VLC_API struct vlc_tracer *vlc_object_get_tracer(vlc_object_t *obj);
+#ifndef VLC_TRACER_DISABLED
+# define vlc_object_get_tracer(o) vlc_object_get_tracer(VLC_OBJECT(o))
+#else
+# define vlc_object_get_tracer(o) ((void)(o), (struct vlc_tracer *)NULL)
+#endif
+
+/**
+ * Records an event.
+ *
+ * \param tracer tracer (cannot be NULL)
+ */
+VLC_API void vlc_tracer_TraceEvent(struct vlc_tracer *tracer,
+                                   enum vlc_tracer_phase phase,
+                                   const char *category, const char *name);
+
+#ifndef VLC_TRACER_DISABLED
+static inline void vlc_tracer_Begin(struct vlc_tracer *tracer,
+                                    const char *category, const char *name)
+{
+    if (tracer != NULL)
+        vlc_tracer_TraceEvent(tracer, VLC_TRACER_BEGIN, category, name);
+}
+
+static inline void vlc_tracer_End(struct vlc_tracer *tracer,
+                                  const char *category, const char *name)
+{
+    if (tracer != NULL)
+        vlc_tracer_TraceEvent(tracer, VLC_TRACER_END, category, name);
+}
+
+static inline void vlc_tracer_Instant(struct vlc_tracer *tracer,
+                                      const char *category, const char *name)
+{
+    if (tracer != NULL)
+        vlc_tracer_TraceEvent(tracer, VLC_TRACER_INSTANT, category, name);
+}
+#else
+# define vlc_tracer_Begin(t, c, n) ((void)(t), (void)(c), (void)(n))
+# define vlc_tracer_End(t, c, n) ((void)(t), (void)(c), (void)(n))
+# define vlc_tracer_Instant(t, c, n) ((void)(t), (void)(c), (void)(n))
+#endif
+
+/** @} */
+#endif
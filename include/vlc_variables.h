@@ -179,6 +179,39 @@ VLC_API int var_Get(vlc_object_t *obj, const char *name, vlc_value_t *valp);
 VLC_API int var_SetChecked( vlc_object_t *, const char *, int, vlc_value_t );
 VLC_API int var_GetChecked( vlc_object_t *, const char *, int, vlc_value_t * );
 
+/**
+ * Looks a variable up once, for repeated accesses.
+ *
+ * Getting and setting a variable by handle skips the look-up by name. The
+ * handle holds a reference to the variable, as var_Create() would, so it
+ * remains valid until var_ReleaseHandle() or the destruction of the object.
+ *
+ * \param obj object holding the variable
+ * \param name variable name
+ * \return a variable handle, or NULL if the variable does not exist
+ */
+VLC_API struct variable_t *var_AcquireHandle(vlc_object_t *obj,
+                                             const char *name) VLC_USED;
+
+/**
+ * Releases a variable handle.
+ *
+ * The variable is destroyed if this was the last reference to it.
+ */
+VLC_API void var_ReleaseHandle(vlc_object_t *obj, struct variable_t *var);
+
+/**
+ * Sets a variable value by handle, as var_SetChecked().
+ */
+VLC_API int var_SetHandle(vlc_object_t *obj, struct variable_t *var,
+                          int type, vlc_value_t val);
+
+/**
+ * Gets a variable value by handle, as var_GetChecked().
+ */
+VLC_API int var_GetHandle(vlc_object_t *obj, struct variable_t *var,
+                          int type, vlc_value_t *valp);
+
 /**
  * Perform an atomic read-modify-write of a variable.
  *
@@ -311,6 +344,40 @@ static inline int var_SetBool( vlc_object_t *p_obj, const char *psz_name, bool b
     return var_SetChecked( p_obj, psz_name, VLC_VAR_BOOL, val );
 }
 
+static inline int var_SetHandleBool( vlc_object_t *obj,
+                                     struct variable_t *var, bool b )
+{
+    vlc_value_t val;
+    val.b_bool = b;
+    return var_SetHandle( obj, var, VLC_VAR_BOOL, val );
+}
+
+static inline int var_SetHandleInteger( vlc_object_t *obj,
+                                        struct variable_t *var, int64_t i )
+{
+    vlc_value_t val;
+    val.i_int = i;
+    return var_SetHandle( obj, var, VLC_VAR_INTEGER, val );
+}
+
+static inline int var_SetHandleFloat( vlc_object_t *obj,
+                                      struct variable_t *var, float f )
+{
+    vlc_value_t val;
+    val.f_float = f;
+    return var_SetHandle( obj, var, VLC_VAR_FLOAT, val );
+}
+
+static inline int var_SetHandleCoords( vlc_object_t *obj,
+                                       struct variable_t *var,
+                                       int32_t x, int32_t y )
+{
+    vlc_value_t val;
+    val.coords.x = x;
+    val.coords.y = y;
+    return var_SetHandle( obj, var, VLC_VAR_COORDS, val );
+}
+
 static inline int var_SetCoords( vlc_object_t *obj, const char *name,
                                  int32_t x, int32_t y )
 {
@@ -396,6 +463,40 @@ static inline bool var_GetBool( vlc_object_t *p_obj, const char *psz_name )
         return false;
 }
 
+static inline bool var_GetHandleBool( vlc_object_t *obj,
+                                      struct variable_t *var )
+{
+    vlc_value_t val;
+    var_GetHandle( obj, var, VLC_VAR_BOOL, &val );
+    return val.b_bool;
+}
+
+static inline int64_t var_GetHandleInteger( vlc_object_t *obj,
+                                            struct variable_t *var )
+{
+    vlc_value_t val;
+    var_GetHandle( obj, var, VLC_VAR_INTEGER, &val );
+    return val.i_int;
+}
+
+static inline float var_GetHandleFloat( vlc_object_t *obj,
+                                        struct variable_t *var )
+{
+    vlc_value_t val;
+    var_GetHandle( obj, var, VLC_VAR_FLOAT, &val );
+    return val.f_float;
+}
+
+static inline void var_GetHandleCoords( vlc_object_t *obj,
+                                        struct variable_t *var,
+                                        int32_t *px, int32_t *py )
+{
+    vlc_value_t val;
+    var_GetHandle( obj, var, VLC_VAR_COORDS, &val );
+    *px = val.coords.x;
+    *py = val.coords.y;
+}
+
 static inline void var_GetCoords( vlc_object_t *obj, const char *name,
                                   int32_t *px, int32_t *py )
 {
@@ -793,6 +894,19 @@ VLC_API int var_LocationParse(vlc_object_t *, const char *mrl, const char *prefi
 
 #define var_GetCoords(o,n,x,y) var_GetCoords(VLC_OBJECT(o), n, x, y)
 
+#define var_AcquireHandle(o,n) var_AcquireHandle(VLC_OBJECT(o), n)
+#define var_ReleaseHandle(o,v) var_ReleaseHandle(VLC_OBJECT(o), v)
+#define var_SetHandle(o,v,t,x) var_SetHandle(VLC_OBJECT(o), v, t, x)
+#define var_GetHandle(o,v,t,x) var_GetHandle(VLC_OBJECT(o), v, t, x)
+#define var_SetHandleBool(o,v,b) var_SetHandleBool(VLC_OBJECT(o), v, b)
+#define var_SetHandleInteger(o,v,i) var_SetHandleInteger(VLC_OBJECT(o), v, i)
+#define var_SetHandleFloat(o,v,f) var_SetHandleFloat(VLC_OBJECT(o), v, f)
+#define var_SetHandleCoords(o,v,x,y) var_SetHandleCoords(VLC_OBJECT(o), v, x, y)
+#define var_GetHandleBool(o,v) var_GetHandleBool(VLC_OBJECT(o), v)
+#define var_GetHandleInteger(o,v) var_GetHandleInteger(VLC_OBJECT(o), v)
+#define var_GetHandleFloat(o,v) var_GetHandleFloat(VLC_OBJECT(o), v)
+#define var_GetHandleCoords(o,v,x,y) var_GetHandleCoords(VLC_OBJECT(o), v, x, y)
+
 #define var_IncInteger(a,b) var_IncInteger(VLC_OBJECT(a), b)
 #define var_DecInteger(a,b) var_DecInteger(VLC_OBJECT(a), b)
 #define var_OrInteger(a,b,c) var_OrInteger(VLC_OBJECT(a), b, c)
@@ -189,6 +189,15 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+
+    /* Presentation feedback: the picture expected at the given date was
+     * actually shown at the presented date, on a display refreshing every
+     * refresh ticks (0 if unknown).
+     *
+     * It must be sent from the vout_display_t display or prepare callbacks.
+     */
+    void (*presented)(void *sys, vlc_tick_t expected, vlc_tick_t presented,
+                      vlc_tick_t refresh);
 };
 
 /**
@@ -386,6 +395,22 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+/**
+ * Reports when a picture was actually shown on screen
+ *
+ * \param expected date passed to the prepare callback for the picture
+ * \param presented date the picture was shown at
+ * \param refresh display refresh period, or 0 if unknown
+ */
+static inline void vout_display_SendEventPresented(vout_display_t *vd,
+                                                   vlc_tick_t expected,
+                                                   vlc_tick_t presented,
+                                                   vlc_tick_t refresh)
+{
+    if (vd->owner.presented)
+        vd->owner.presented(vd->owner.sys, expected, presented, refresh);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
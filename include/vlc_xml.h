@@ -81,11 +81,25 @@ VLC_API xml_reader_t * xml_ReaderCreate(vlc_object_t *, stream_t *) VLC_USED;
 #define xml_ReaderCreate( a, s ) xml_ReaderCreate(VLC_OBJECT(a), s)
 VLC_API void xml_ReaderDelete(xml_reader_t *);
 
+/**
+ * Reads the next node.
+ *
+ * \param pval pointer to the element name or the text content [OUT],
+ *             valid until the next call (do not free)
+ * \return XML_READER_* node type, XML_READER_NONE at the end of the stream
+ */
 static inline int xml_ReaderNextNode( xml_reader_t *reader, const char **pval )
 {
     return reader->pf_next_node( reader, pval );
 }
 
+/**
+ * Reads the next attribute of the current element.
+ *
+ * The name and value remain valid until the next node is read.
+ *
+ * \return the attribute name, or NULL if there are no more attributes
+ */
 static inline const char *xml_ReaderNextAttr( xml_reader_t *reader,
                                               const char **pval )
 {
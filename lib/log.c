@@ -30,6 +30,7 @@
 #include "libvlc_internal.h"
 #include <vlc_common.h>
 #include <vlc_interface.h>
+#include <vlc_alloc_stats.h>
 
 /*** Logging core dispatcher ***/
 
@@ -110,3 +111,8 @@ void libvlc_log_set_file (libvlc_instance_t *inst, FILE *stream)
 {
     libvlc_log_set (inst, libvlc_log_file, stream);
 }
+
+void libvlc_alloc_stats_print (FILE *stream)
+{
+    vlc_alloc_stats_Print (stream);
+}
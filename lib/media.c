@@ -734,6 +734,43 @@ bool libvlc_media_get_stats(libvlc_media_t *p_md,
     p_stats->i_sent_bytes = 0;
     p_stats->f_send_bitrate = 0.;
 
+    p_stats->f_clock_drift = p_itm_stats->f_clock_drift;
+    p_stats->i_clock_jitter = US_FROM_VLC_TICK(p_itm_stats->i_clock_jitter);
+
+    vlc_mutex_unlock( &item->lock );
+    return true;
+}
+
+static_assert(LIBVLC_MEDIA_LATENCY_BUCKETS == INPUT_LATENCY_BUCKETS,
+              "latency buckets mismatch");
+static_assert((int)libvlc_media_latency_video_total == (int)INPUT_LATENCY_VIDEO_TOTAL,
+              "latency types mismatch");
+
+bool libvlc_media_get_latency_stats(libvlc_media_t *p_md,
+                                    libvlc_media_latency_t type,
+                                    libvlc_media_latency_stats_t *p_stats)
+{
+    input_item_t *item = p_md->p_input_item;
+
+    if( !p_md->p_input_item || (unsigned)type >= INPUT_LATENCY_COUNT )
+        return false;
+
+    vlc_mutex_lock( &item->lock );
+
+    input_stats_t *p_itm_stats = p_md->p_input_item->p_stats;
+    if( p_itm_stats == NULL )
+    {
+        vlc_mutex_unlock( &item->lock );
+        return false;
+    }
+
+    const input_latency_t *p_latency = &p_itm_stats->latency[type];
+    p_stats->i_samples = p_latency->i_samples;
+    p_stats->i_total_us = US_FROM_VLC_TICK(p_latency->i_total);
+    p_stats->i_max_us = US_FROM_VLC_TICK(p_latency->i_max);
+    for( size_t i = 0; i < LIBVLC_MEDIA_LATENCY_BUCKETS; i++ )
+        p_stats->pi_buckets[i] = p_latency->pi_buckets[i];
+
     vlc_mutex_unlock( &item->lock );
     return true;
 }
@@ -774,8 +811,24 @@ static const input_preparser_callbacks_t input_preparser_callbacks = {
     .on_subtree_added = input_item_subtree_added,
 };
 
-static int media_parse(libvlc_media_t *media, bool b_async,
-                       libvlc_media_parse_flag_t parse_flag, int timeout)
+static input_item_meta_request_option_t
+media_parse_scope(libvlc_media_parse_flag_t parse_flag)
+{
+    input_item_meta_request_option_t parse_scope = META_REQUEST_OPTION_SCOPE_LOCAL;
+
+    if (parse_flag & libvlc_media_parse_network)
+        parse_scope |= META_REQUEST_OPTION_SCOPE_NETWORK;
+    if (parse_flag & libvlc_media_fetch_local)
+        parse_scope |= META_REQUEST_OPTION_FETCH_LOCAL;
+    if (parse_flag & libvlc_media_fetch_network)
+        parse_scope |= META_REQUEST_OPTION_FETCH_NETWORK;
+    if (parse_flag & libvlc_media_do_interact)
+        parse_scope |= META_REQUEST_OPTION_DO_INTERACT;
+    return parse_scope;
+}
+
+/* Returns true if the media was not asked to be parsed yet */
+static bool media_parse_needed(libvlc_media_t *media)
 {
     bool needed;
 
@@ -785,23 +838,20 @@ static int media_parse(libvlc_media_t *media, bool b_async,
     if (needed)
         media->is_parsed = false;
     vlc_mutex_unlock(&media->parsed_lock);
+    return needed;
+}
 
-    if (needed)
+static int media_parse(libvlc_media_t *media, bool b_async,
+                       libvlc_media_parse_flag_t parse_flag, int timeout)
+{
+    if (media_parse_needed(media))
     {
         libvlc_int_t *libvlc = media->p_libvlc_instance->p_libvlc_int;
         input_item_t *item = media->p_input_item;
-        input_item_meta_request_option_t parse_scope = META_REQUEST_OPTION_SCOPE_LOCAL;
+        input_item_meta_request_option_t parse_scope =
+            media_parse_scope(parse_flag);
         int ret;
 
-        if (parse_flag & libvlc_media_parse_network)
-            parse_scope |= META_REQUEST_OPTION_SCOPE_NETWORK;
-        if (parse_flag & libvlc_media_fetch_local)
-            parse_scope |= META_REQUEST_OPTION_FETCH_LOCAL;
-        if (parse_flag & libvlc_media_fetch_network)
-            parse_scope |= META_REQUEST_OPTION_FETCH_NETWORK;
-        if (parse_flag & libvlc_media_do_interact)
-            parse_scope |= META_REQUEST_OPTION_DO_INTERACT;
-
         ret = libvlc_MetadataRequest(libvlc, item, parse_scope,
                                      &input_preparser_callbacks, media,
                                      timeout, media);
@@ -850,6 +900,55 @@ libvlc_media_parse_with_options( libvlc_media_t *media,
     return media_parse( media, true, parse_flag, timeout ) == VLC_SUCCESS ? 0 : -1;
 }
 
+int
+libvlc_media_parse_batch( libvlc_media_t *const *medias, size_t count,
+                          libvlc_media_parse_flag_t parse_flag, int timeout )
+{
+    if( count == 0 )
+        return 0;
+
+    input_item_t **items = vlc_alloc( count, sizeof (*items) );
+    void **opaques = vlc_alloc( count, sizeof (*opaques) );
+    if( unlikely(items == NULL || opaques == NULL) )
+    {
+        free( opaques );
+        free( items );
+        libvlc_printerr( "Not enough memory" );
+        return -1;
+    }
+
+    libvlc_instance_t *instance = medias[0]->p_libvlc_instance;
+    size_t n = 0;
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        libvlc_media_t *media = medias[i];
+
+        assert( media->p_libvlc_instance == instance );
+        if( !media_parse_needed( media ) )
+            continue;
+        items[n] = media->p_input_item;
+        opaques[n] = media;
+        n++;
+    }
+
+    int ret = 0;
+    if( n > 0 )
+    {
+        if( libvlc_MetadataRequestBatch( instance->p_libvlc_int, items, n,
+                                         media_parse_scope( parse_flag ),
+                                         &input_preparser_callbacks, opaques,
+                                         timeout ) == VLC_SUCCESS )
+            ret = n;
+        else
+            ret = -1;
+    }
+
+    free( opaques );
+    free( items );
+    return ret;
+}
+
 void
 libvlc_media_parse_stop( libvlc_media_t *media )
 {
@@ -904,6 +1003,80 @@ libvlc_media_get_user_data( libvlc_media_t * p_md )
     return p_md->p_user_data;
 }
 
+libvlc_media_track_t *
+libvlc_media_track_create( const es_format_t *p_es )
+{
+    libvlc_media_track_t *p_mes = calloc( 1, sizeof(*p_mes) );
+    if ( unlikely(p_mes == NULL) )
+        return NULL;
+
+    p_mes->audio = malloc( __MAX(__MAX(sizeof(*p_mes->audio),
+                                       sizeof(*p_mes->video)),
+                                       sizeof(*p_mes->subtitle)) );
+    if ( unlikely(p_mes->audio == NULL) )
+    {
+        free( p_mes );
+        return NULL;
+    }
+
+    p_mes->i_codec = p_es->i_codec;
+    p_mes->i_original_fourcc = p_es->i_original_fourcc;
+    p_mes->i_id = p_es->i_id;
+
+    p_mes->i_profile = p_es->i_profile;
+    p_mes->i_level = p_es->i_level;
+
+    p_mes->i_bitrate = p_es->i_bitrate;
+    p_mes->psz_language = p_es->psz_language != NULL ? strdup(p_es->psz_language) : NULL;
+    p_mes->psz_description = p_es->psz_description != NULL ? strdup(p_es->psz_description) : NULL;
+
+    switch(p_es->i_cat)
+    {
+    case UNKNOWN_ES:
+    default:
+        p_mes->i_type = libvlc_track_unknown;
+        break;
+    case VIDEO_ES:
+        p_mes->i_type = libvlc_track_video;
+        p_mes->video->i_height = p_es->video.i_visible_height;
+        p_mes->video->i_width = p_es->video.i_visible_width;
+        p_mes->video->i_sar_num = p_es->video.i_sar_num;
+        p_mes->video->i_sar_den = p_es->video.i_sar_den;
+        p_mes->video->i_frame_rate_num = p_es->video.i_frame_rate;
+        p_mes->video->i_frame_rate_den = p_es->video.i_frame_rate_base;
+
+        assert( p_es->video.orientation >= ORIENT_TOP_LEFT &&
+                p_es->video.orientation <= ORIENT_RIGHT_BOTTOM );
+        p_mes->video->i_orientation = (int) p_es->video.orientation;
+
+        assert( ( p_es->video.projection_mode >= PROJECTION_MODE_RECTANGULAR &&
+                p_es->video.projection_mode <= PROJECTION_MODE_EQUIRECTANGULAR ) ||
+                ( p_es->video.projection_mode == PROJECTION_MODE_CUBEMAP_LAYOUT_STANDARD ) );
+        p_mes->video->i_projection = (int) p_es->video.projection_mode;
+
+        p_mes->video->pose.f_yaw = p_es->video.pose.yaw;
+        p_mes->video->pose.f_pitch = p_es->video.pose.pitch;
+        p_mes->video->pose.f_roll = p_es->video.pose.roll;
+        p_mes->video->pose.f_field_of_view = p_es->video.pose.fov;
+
+        assert( p_es->video.multiview_mode >= MULTIVIEW_2D &&
+                p_es->video.multiview_mode <= MULTIVIEW_STEREO_CHECKERBOARD );
+        p_mes->video->i_multiview = (int) p_es->video.multiview_mode;
+        break;
+    case AUDIO_ES:
+        p_mes->i_type = libvlc_track_audio;
+        p_mes->audio->i_channels = p_es->audio.i_channels;
+        p_mes->audio->i_rate = p_es->audio.i_rate;
+        break;
+    case SPU_ES:
+        p_mes->i_type = libvlc_track_text;
+        p_mes->subtitle->psz_encoding = p_es->subs.psz_encoding != NULL ?
+                                        strdup(p_es->subs.psz_encoding) : NULL;
+        break;
+    }
+    return p_mes;
+}
+
 unsigned
 libvlc_media_tracks_get( libvlc_media_t *p_md, libvlc_media_track_t *** pp_es )
 {
@@ -924,80 +1097,16 @@ libvlc_media_tracks_get( libvlc_media_t *p_md, libvlc_media_track_t *** pp_es )
     /* Fill array */
     for( int i = 0; i < i_es; i++ )
     {
-        libvlc_media_track_t *p_mes = calloc( 1, sizeof(*p_mes) );
-        if ( p_mes )
-        {
-            p_mes->audio = malloc( __MAX(__MAX(sizeof(*p_mes->audio),
-                                               sizeof(*p_mes->video)),
-                                               sizeof(*p_mes->subtitle)) );
-        }
-        if ( !p_mes || !p_mes->audio )
+        libvlc_media_track_t *p_mes =
+            libvlc_media_track_create( p_input_item->es[i] );
+        if ( !p_mes )
         {
             libvlc_media_tracks_release( *pp_es, i_es );
             *pp_es = NULL;
-            free( p_mes );
             vlc_mutex_unlock( &p_input_item->lock );
             return 0;
         }
         (*pp_es)[i] = p_mes;
-
-        const es_format_t *p_es = p_input_item->es[i];
-
-        p_mes->i_codec = p_es->i_codec;
-        p_mes->i_original_fourcc = p_es->i_original_fourcc;
-        p_mes->i_id = p_es->i_id;
-
-        p_mes->i_profile = p_es->i_profile;
-        p_mes->i_level = p_es->i_level;
-
-        p_mes->i_bitrate = p_es->i_bitrate;
-        p_mes->psz_language = p_es->psz_language != NULL ? strdup(p_es->psz_language) : NULL;
-        p_mes->psz_description = p_es->psz_description != NULL ? strdup(p_es->psz_description) : NULL;
-
-        switch(p_es->i_cat)
-        {
-        case UNKNOWN_ES:
-        default:
-            p_mes->i_type = libvlc_track_unknown;
-            break;
-        case VIDEO_ES:
-            p_mes->i_type = libvlc_track_video;
-            p_mes->video->i_height = p_es->video.i_visible_height;
-            p_mes->video->i_width = p_es->video.i_visible_width;
-            p_mes->video->i_sar_num = p_es->video.i_sar_num;
-            p_mes->video->i_sar_den = p_es->video.i_sar_den;
-            p_mes->video->i_frame_rate_num = p_es->video.i_frame_rate;
-            p_mes->video->i_frame_rate_den = p_es->video.i_frame_rate_base;
-
-            assert( p_es->video.orientation >= ORIENT_TOP_LEFT &&
-                    p_es->video.orientation <= ORIENT_RIGHT_BOTTOM );
-            p_mes->video->i_orientation = (int) p_es->video.orientation;
-
-            assert( ( p_es->video.projection_mode >= PROJECTION_MODE_RECTANGULAR &&
-                    p_es->video.projection_mode <= PROJECTION_MODE_EQUIRECTANGULAR ) ||
-                    ( p_es->video.projection_mode == PROJECTION_MODE_CUBEMAP_LAYOUT_STANDARD ) );
-            p_mes->video->i_projection = (int) p_es->video.projection_mode;
-
-            p_mes->video->pose.f_yaw = p_es->video.pose.yaw;
-            p_mes->video->pose.f_pitch = p_es->video.pose.pitch;
-            p_mes->video->pose.f_roll = p_es->video.pose.roll;
-            p_mes->video->pose.f_field_of_view = p_es->video.pose.fov;
-
-            assert( p_es->video.multiview_mode >= MULTIVIEW_2D &&
-                    p_es->video.multiview_mode <= MULTIVIEW_STEREO_CHECKERBOARD );
-            p_mes->video->i_multiview = (int) p_es->video.multiview_mode;
-            break;
-        case AUDIO_ES:
-            p_mes->i_type = libvlc_track_audio;
-            p_mes->audio->i_channels = p_es->audio.i_channels;
-            p_mes->audio->i_rate = p_es->audio.i_rate;
-            break;
-        case SPU_ES:
-            p_mes->i_type = libvlc_track_text;
-            p_mes->subtitle->psz_encoding = p_es->subs.psz_encoding != NULL ?
-                                            strdup(p_es->subs.psz_encoding) : NULL;
-            break;
-        }
     }
 
     vlc_mutex_unlock( &p_input_item->lock );
@@ -1028,29 +1137,34 @@ libvlc_media_get_codec_description( libvlc_track_type_t i_type,
 /**************************************************************************
  * Release media descriptor's elementary streams description array
  **************************************************************************/
+void libvlc_media_track_delete( libvlc_media_track_t *p_track )
+{
+    free( p_track->psz_language );
+    free( p_track->psz_description );
+    switch( p_track->i_type )
+    {
+    case libvlc_track_audio:
+        break;
+    case libvlc_track_video:
+        break;
+    case libvlc_track_text:
+        free( p_track->subtitle->psz_encoding );
+        break;
+    case libvlc_track_unknown:
+    default:
+        break;
+    }
+    free( p_track->audio );
+    free( p_track );
+}
+
 void libvlc_media_tracks_release( libvlc_media_track_t **p_tracks, unsigned i_count )
 {
     for( unsigned i = 0; i < i_count; ++i )
     {
         if ( !p_tracks[i] )
             continue;
-        free( p_tracks[i]->psz_language );
-        free( p_tracks[i]->psz_description );
-        switch( p_tracks[i]->i_type )
-        {
-        case libvlc_track_audio:
-            break;
-        case libvlc_track_video:
-            break;
-        case libvlc_track_text:
-            free( p_tracks[i]->subtitle->psz_encoding );
-            break;
-        case libvlc_track_unknown:
-        default:
-            break;
-        }
-        free( p_tracks[i]->audio );
-        free( p_tracks[i] );
+        libvlc_media_track_delete( p_tracks[i] );
     }
     free( p_tracks );
 }
@@ -54,6 +54,10 @@ libvlc_media_t * libvlc_media_new_from_input_item(
         libvlc_instance_t *, input_item_t * );
 
 void libvlc_media_set_state( libvlc_media_t *, libvlc_state_t );
+
+/* Track description from an ES format, and its release */
+libvlc_media_track_t *libvlc_media_track_create( const es_format_t * );
+void libvlc_media_track_delete( libvlc_media_track_t * );
 void libvlc_media_add_subtree(libvlc_media_t *, input_item_node_t *);
 
 #endif
@@ -588,6 +588,12 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-data", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-setup", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-cleanup", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-alloc", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-free", VLC_VAR_ADDRESS);
+    var_Create (mp, "emem-add", VLC_VAR_ADDRESS);
+    var_Create (mp, "emem-send", VLC_VAR_ADDRESS);
+    var_Create (mp, "emem-del", VLC_VAR_ADDRESS);
+    var_Create (mp, "emem-data", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-chroma", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
@@ -605,6 +611,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
 
     var_Create (mp, "dec-dev", VLC_VAR_STRING);
     var_Create (mp, "avcodec-hw", VLC_VAR_STRING);
+    var_Create (mp, "avcodec-hw-priority", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "drawable-xid", VLC_VAR_INTEGER);
 #if defined (_WIN32) || defined (__OS2__)
     var_Create (mp, "drawable-hwnd", VLC_VAR_INTEGER);
@@ -702,6 +709,10 @@ libvlc_media_player_new( libvlc_instance_t *instance )
 
     mp->p_md = NULL;
     mp->p_libvlc_instance = instance;
+    mp->es.add = NULL;
+    mp->es.packet = NULL;
+    mp->es.del = NULL;
+    mp->es.opaque = NULL;
     /* use a reentrant lock to allow calling libvlc functions from callbacks */
     mp->player = vlc_player_New(VLC_OBJECT(mp), VLC_PLAYER_LOCK_REENTRANT,
                                 NULL, NULL);
@@ -1021,6 +1032,106 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
     var_SetAddress( mp, "vmem-cleanup", cleanup );
 }
 
+void libvlc_video_set_buffer_callbacks( libvlc_media_player_t *mp,
+                                        void *(*alloc_cb) (void *, void **),
+                                        void (*free_cb) (void *, void *) )
+{
+    var_SetAddress( mp, "vmem-alloc", alloc_cb );
+    var_SetAddress( mp, "vmem-free", free_cb );
+}
+
+/* NOTE: the callback prototypes must match those of the emem module */
+static void *es_add( void *opaque, const es_format_t *fmt )
+{
+    libvlc_media_player_t *mp = opaque;
+
+    if( mp->es.add == NULL )
+        return mp; /* any non-NULL identifier */
+
+    libvlc_media_track_t *track = libvlc_media_track_create( fmt );
+    if( unlikely(track == NULL) )
+        return NULL;
+
+    void *es = mp->es.add( mp->es.opaque, track, fmt->p_extra,
+                           fmt->i_extra );
+    libvlc_media_track_delete( track );
+    return es;
+}
+
+static void es_send( void *opaque, void *es, block_t *block )
+{
+    libvlc_media_player_t *mp = opaque;
+
+    mp->es.packet( mp->es.opaque, es, (libvlc_es_packet_t *)block );
+}
+
+static void es_del( void *opaque, void *es )
+{
+    libvlc_media_player_t *mp = opaque;
+
+    if( mp->es.del != NULL )
+        mp->es.del( mp->es.opaque, es );
+}
+
+void libvlc_media_player_set_es_callbacks( libvlc_media_player_t *mp,
+                                           libvlc_es_add_cb add,
+                                           libvlc_es_packet_cb packet,
+                                           libvlc_es_del_cb del,
+                                           void *opaque )
+{
+    vlc_player_Lock( mp->player );
+    mp->es.add = add;
+    mp->es.packet = packet;
+    mp->es.del = del;
+    mp->es.opaque = opaque;
+
+    var_SetAddress( mp, "emem-add", es_add );
+    var_SetAddress( mp, "emem-send", es_send );
+    var_SetAddress( mp, "emem-del", es_del );
+    var_SetAddress( mp, "emem-data", mp );
+    vlc_player_SetStreamOutput( mp->player, packet != NULL ? "#emem" : NULL );
+    vlc_player_Unlock( mp->player );
+}
+
+const void *libvlc_es_packet_get_data( const libvlc_es_packet_t *packet,
+                                       size_t *size )
+{
+    const block_t *block = (const block_t *)packet;
+
+    *size = block->i_buffer;
+    return block->p_buffer;
+}
+
+int64_t libvlc_es_packet_get_pts( const libvlc_es_packet_t *packet )
+{
+    const block_t *block = (const block_t *)packet;
+
+    if( block->i_pts == VLC_TICK_INVALID )
+        return -1;
+    return US_FROM_VLC_TICK( block->i_pts - VLC_TICK_0 );
+}
+
+int64_t libvlc_es_packet_get_dts( const libvlc_es_packet_t *packet )
+{
+    const block_t *block = (const block_t *)packet;
+
+    if( block->i_dts == VLC_TICK_INVALID )
+        return -1;
+    return US_FROM_VLC_TICK( block->i_dts - VLC_TICK_0 );
+}
+
+bool libvlc_es_packet_is_keyframe( const libvlc_es_packet_t *packet )
+{
+    const block_t *block = (const block_t *)packet;
+
+    return (block->i_flags & BLOCK_FLAG_TYPE_I) != 0;
+}
+
+void libvlc_es_packet_release( libvlc_es_packet_t *packet )
+{
+    block_Release( (block_t *)packet );
+}
+
 void libvlc_video_set_format( libvlc_media_player_t *mp, const char *chroma,
                               unsigned width, unsigned height, unsigned pitch )
 {
@@ -49,6 +49,14 @@ struct libvlc_media_player_t
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
     libvlc_media_t * p_md; /* current media descriptor */
     libvlc_event_manager_t event_manager;
+
+    struct
+    {
+        libvlc_es_add_cb add;
+        libvlc_es_packet_cb packet;
+        libvlc_es_del_cb del;
+        void *opaque;
+    } es; /* elementary stream packet callbacks */
 };
 
 libvlc_track_description_t * libvlc_get_track_description(
@@ -207,6 +207,16 @@ float libvlc_video_get_scale( libvlc_media_player_t *mp )
     return f_scale;
 }
 
+int libvlc_video_prepare_output( libvlc_media_player_t *p_mi )
+{
+    if (vlc_player_vout_Prepare(p_mi->player) != VLC_SUCCESS)
+    {
+        libvlc_printerr ("Video output creation failed");
+        return -1;
+    }
+    return 0;
+}
+
 void libvlc_video_set_scale( libvlc_media_player_t *p_mp, float f_scale )
 {
     if (isfinite(f_scale) && f_scale != 0.f)
@@ -903,3 +913,22 @@ float libvlc_video_get_adjust_float( libvlc_media_player_t *p_mi,
 {
     return get_float( p_mi, "adjust", adjust_option_bynumber(option) );
 }
+
+
+int libvlc_video_set_decode_priority( libvlc_media_player_t *p_mi,
+                                      unsigned priority )
+{
+    if( priority > libvlc_video_decode_priority_high )
+    {
+        libvlc_printerr( "Unknown decoding priority" );
+        return -1;
+    }
+    var_SetInteger( p_mi, "avcodec-hw-priority", priority );
+    return 0;
+}
+
+
+int libvlc_video_get_decode_priority( libvlc_media_player_t *p_mi )
+{
+    return var_GetInteger( p_mi, "avcodec-hw-priority" );
+}
@@ -28,6 +28,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
+#include <vlc_interrupt.h>
 
 struct access_entry
 {
@@ -46,8 +47,62 @@ typedef struct
     bool can_control_pace;
     uint64_t size;
     vlc_tick_t caching;
+
+    /* Next location being opened in the background */
+    vlc_interrupt_t *prefetch_intr;
+    vlc_thread_t prefetch_thread;
+    const struct access_entry *prefetch_entry;
+    stream_t *prefetched;
 } access_sys_t;
 
+static void *PrefetchThread(void *data)
+{
+    stream_t *access = data;
+    access_sys_t *sys = access->p_sys;
+
+    vlc_interrupt_set(sys->prefetch_intr);
+    sys->prefetched = vlc_access_NewMRL(VLC_OBJECT(access),
+                                        sys->prefetch_entry->mrl);
+    return NULL;
+}
+
+static void PrefetchStart(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    assert(sys->prefetch_entry == NULL);
+    if (sys->prefetch_intr == NULL || sys->next == NULL)
+        return;
+
+    sys->prefetch_entry = sys->next;
+    sys->prefetched = NULL;
+    if (vlc_clone(&sys->prefetch_thread, PrefetchThread, access,
+                  VLC_THREAD_PRIORITY_LOW))
+        sys->prefetch_entry = NULL;
+}
+
+/* Waits for the background opening, and returns its access if it was
+ * for the given entry */
+static stream_t *PrefetchEnd(stream_t *access, const struct access_entry *e)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->prefetch_entry == NULL)
+        return NULL;
+
+    vlc_join(sys->prefetch_thread, NULL);
+
+    stream_t *a = sys->prefetched;
+    if (a != NULL && sys->prefetch_entry != e)
+    {
+        vlc_stream_Delete(a);
+        a = NULL;
+    }
+    sys->prefetch_entry = NULL;
+    sys->prefetched = NULL;
+    return a;
+}
+
 static stream_t *GetAccess(stream_t *access)
 {
     access_sys_t *sys = access->p_sys;
@@ -65,12 +120,18 @@ static stream_t *GetAccess(stream_t *access)
     if (sys->next == NULL)
         return NULL;
 
-    a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
+    a = PrefetchEnd(access, sys->next);
+    if (a == NULL)
+        a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
     if (a == NULL)
         return NULL;
 
     sys->access = a;
     sys->next = sys->next->next;
+
+    /* Open the following location while this one is read, so that
+     * switching does not stall on the access opening */
+    PrefetchStart(access);
     return a;
 }
 
@@ -206,6 +267,9 @@ static int Open(vlc_object_t *obj)
     sys->can_control_pace = true;
     sys->size = 0;
     sys->caching = 0;
+    sys->prefetch_intr = NULL;
+    sys->prefetch_entry = NULL;
+    sys->prefetched = NULL;
 
     struct access_entry **pp = &sys->first;
 
@@ -274,6 +338,9 @@ static int Open(vlc_object_t *obj)
     *pp = NULL;
     sys->next = sys->first;
 
+    if (var_InheritBool(access, "concat-prefetch"))
+        sys->prefetch_intr = vlc_interrupt_create();
+
     access->pf_read = read_cb ? Read : NULL;
     access->pf_block = read_cb ? NULL : Block;
     access->pf_seek = Seek;
@@ -288,6 +355,16 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    if (sys->prefetch_intr != NULL)
+    {
+        if (sys->prefetch_entry != NULL)
+        {
+            vlc_interrupt_kill(sys->prefetch_intr);
+            PrefetchEnd(access, NULL);
+        }
+        vlc_interrupt_destroy(sys->prefetch_intr);
+    }
+
     if (sys->access != NULL)
         vlc_stream_Delete(sys->access);
 
@@ -303,6 +380,10 @@ static void Close(vlc_object_t *obj)
 #define INPUT_LIST_TEXT N_("Inputs list")
 #define INPUT_LIST_LONGTEXT N_( \
     "Comma-separated list of input URLs to concatenate.")
+#define PREFETCH_TEXT N_("Open next input in advance")
+#define PREFETCH_LONGTEXT N_( \
+    "Open the next input in the background while the current one is read, " \
+    "so that there is no pause when switching inputs.")
 
 vlc_module_begin()
     set_shortname(N_("Concatenation"))
@@ -310,6 +391,7 @@ vlc_module_begin()
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_ACCESS)
     add_string("concat-list", NULL, INPUT_LIST_TEXT, INPUT_LIST_LONGTEXT, true)
+    add_bool("concat-prefetch", true, PREFETCH_TEXT, PREFETCH_LONGTEXT, true)
     set_capability("access", 0)
     set_callbacks(Open, Close)
     add_shortcut("concast", "list")
@@ -242,18 +242,19 @@ public:
     DeckLinkCaptureDelegate(demux_t *demux) : demux_(demux)
     {
         m_ref_.store(1);
+        lent_.store(0);
     }
 
     virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID *) { return E_NOINTERFACE; }
 
     virtual ULONG STDMETHODCALLTYPE AddRef(void)
     {
-        return m_ref_.fetch_add(1);
+        return m_ref_.fetch_add(1) + 1;
     }
 
     virtual ULONG STDMETHODCALLTYPE Release(void)
     {
-        uintptr_t new_ref = m_ref_.fetch_sub(1);
+        uintptr_t new_ref = m_ref_.fetch_sub(1) - 1;
         if (new_ref == 0)
             delete this;
         return new_ref;
@@ -308,11 +309,63 @@ public:
 
     virtual HRESULT STDMETHODCALLTYPE VideoInputFrameArrived(IDeckLinkVideoInputFrame*, IDeckLinkAudioInputPacket*);
 
+    /* Frames wrapped into blocks, not yet released */
+    std::atomic_uint lent_;
+
 private:
     std::atomic_uint m_ref_;
     demux_t *demux_;
 };
 
+/*
+ * Blocks wrapping the SDK frame buffers, when no conversion is needed.
+ * The SDK only has a few frames in flight, so this is bounded: past that,
+ * frames are copied so as not to starve the capture.
+ */
+#define DECKLINK_MAX_LENT 4
+
+struct decklink_frame_block
+{
+    block_t self;
+    IDeckLinkVideoInputFrame *frame;
+    DeckLinkCaptureDelegate *delegate;
+};
+
+static void ReleaseFrameBlock(block_t *block)
+{
+    decklink_frame_block *fb = container_of(block, decklink_frame_block, self);
+
+    fb->frame->Release();
+    fb->delegate->lent_.fetch_sub(1);
+    fb->delegate->Release();
+    free(fb);
+}
+
+static const struct vlc_block_callbacks decklink_frame_cbs =
+{
+    ReleaseFrameBlock,
+};
+
+static block_t *WrapFrame(DeckLinkCaptureDelegate *delegate,
+                          IDeckLinkVideoInputFrame *frame, void *bytes,
+                          size_t length)
+{
+    if (delegate->lent_.load() >= DECKLINK_MAX_LENT)
+        return NULL;
+
+    decklink_frame_block *fb =
+        static_cast<decklink_frame_block *>(malloc(sizeof (*fb)));
+    if (unlikely(fb == NULL))
+        return NULL;
+
+    frame->AddRef();
+    delegate->AddRef();
+    delegate->lent_.fetch_add(1);
+    fb->frame = frame;
+    fb->delegate = delegate;
+    return block_Init(&fb->self, &decklink_frame_cbs, bytes, length);
+}
+
 } // namespace
 
 HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
@@ -340,13 +393,22 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 bpp = 2;
                 break;
         };
-        block_t *video_frame = block_Alloc(width * height * bpp);
-        if (!video_frame)
-            return S_OK;
-
         const uint32_t *frame_bytes;
         videoFrame->GetBytes((void**)&frame_bytes);
 
+        /* Packed formats without padding can be used as is */
+        block_t *video_frame = NULL;
+        const bool packed = sys->video_fmt.i_codec != VLC_CODEC_I422_10L
+                         && stride == width * bpp;
+        if (packed)
+            video_frame = WrapFrame(this, videoFrame, (void *)frame_bytes,
+                                    width * height * bpp);
+        const bool wrapped = video_frame != NULL;
+        if (!wrapped)
+            video_frame = block_Alloc(width * height * bpp);
+        if (!video_frame)
+            return S_OK;
+
         BMDTimeValue stream_time, frame_duration;
         videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
         video_frame->i_flags = BLOCK_FLAG_TYPE_I | sys->dominance_flags;
@@ -385,6 +447,8 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 }
                 vanc->Release();
             }
+        } else if (wrapped) {
+            /* zero copy */
         } else if (sys->video_fmt.i_codec == VLC_CODEC_UYVY) {
             for (int y = 0; y < height; ++y) {
                 const uint8_t *src = (const uint8_t *)frame_bytes + stride * y;
@@ -182,9 +182,16 @@ int DirRead (stream_t *access, input_item_node_t *node)
             ret = VLC_ENOMEM;
             break;
         }
+        input_item_t *item;
         ret = vlc_readdir_helper_additem(&rdh, uri, NULL, entry, type,
-                                         ITEM_NET_UNKNOWN);
+                                         ITEM_NET_UNKNOWN, &item);
         free(uri);
+
+        if (item != NULL && type == ITEM_TYPE_FILE)
+        {
+            item->i_file_size = st.st_size;
+            item->i_file_mtime = st.st_mtime;
+        }
     }
 
     vlc_readdir_helper_finish(&rdh, ret == VLC_SUCCESS);
@@ -51,6 +51,10 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_LIBURING
+#   include <poll.h>
+#   include <liburing.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -62,11 +66,39 @@
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
 
+#ifdef HAVE_LIBURING
+/* Reads queued ahead, and their size (a multiple of the O_DIRECT alignment) */
+#define URING_EXTENTS   4
+#define URING_EXTENT    (512 << 10)
+#define URING_ALIGN     4096
+
+struct uring_extent
+{
+    char    *buf;
+    uint64_t offset;
+    ssize_t  length; /* bytes read, or minus the error number */
+    bool     pending;
+};
+
+struct uring
+{
+    struct io_uring ring;
+    struct uring_extent extents[URING_EXTENTS];
+    unsigned head; /* extent being read */
+    size_t   pos; /* read position in the head extent */
+    uint64_t next; /* offset of the next extent to queue */
+    unsigned pending;
+};
+#endif
+
 typedef struct
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_LIBURING
+    struct uring *uring;
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -124,11 +156,188 @@ static bool IsRemote (const char *path)
 #ifndef HAVE_POSIX_FADVISE
 # define posix_fadvise(fd, off, len, adv)
 #endif
+/* Data to fetch ahead after seeking */
+#define FILE_SEEK_READAHEAD (1 << 20)
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
 
+#ifdef HAVE_LIBURING
+/*
+ * Asynchronous reads: a few extents are always queued ahead of the read
+ * position, so that the input thread only waits if the storage is slower
+ * than the demuxer.
+ */
+static void UringQueue (access_sys_t *sys, struct uring_extent *ext)
+{
+    struct uring *u = sys->uring;
+    struct io_uring_sqe *sqe = io_uring_get_sqe (&u->ring);
+
+    /* The ring has as many entries as extents */
+    assert (sqe != NULL);
+    ext->offset = u->next;
+    ext->pending = true;
+    u->next += URING_EXTENT;
+    u->pending++;
+    io_uring_prep_read (sqe, sys->fd, ext->buf, URING_EXTENT, ext->offset);
+    io_uring_sqe_set_data (sqe, ext);
+}
+
+static void UringComplete (struct uring *u, struct io_uring_cqe *cqe)
+{
+    struct uring_extent *ext = io_uring_cqe_get_data (cqe);
+
+    ext->length = cqe->res;
+    ext->pending = false;
+    u->pending--;
+    io_uring_cqe_seen (&u->ring, cqe);
+}
+
+/* Waits for all queued reads, without interruption (buffers are in use) */
+static void UringDrain (struct uring *u)
+{
+    struct io_uring_cqe *cqe;
+
+    while (u->pending > 0)
+        if (io_uring_wait_cqe (&u->ring, &cqe) == 0)
+            UringComplete (u, cqe);
+}
+
+/* Restarts reading ahead from a given offset */
+static void UringRestart (access_sys_t *sys, uint64_t offset)
+{
+    struct uring *u = sys->uring;
+
+    UringDrain (u);
+    /* O_DIRECT requires aligned offsets */
+    u->next = offset & ~(uint64_t)(URING_ALIGN - 1);
+    u->pos = offset - u->next;
+    u->head = 0;
+    for (unsigned i = 0; i < URING_EXTENTS; i++)
+        UringQueue (sys, &u->extents[i]);
+    io_uring_submit (&u->ring);
+}
+
+static ssize_t UringRead (stream_t *p_access, void *p_buffer, size_t i_len)
+{
+    access_sys_t *sys = p_access->p_sys;
+    struct uring *u = sys->uring;
+    struct uring_extent *ext = &u->extents[u->head];
+
+    while (ext->pending)
+    {
+        struct io_uring_cqe *cqe;
+
+        if (io_uring_peek_cqe (&u->ring, &cqe) == 0)
+        {
+            UringComplete (u, cqe);
+            continue;
+        }
+
+        /* The ring file descriptor is readable once a read completed */
+        struct pollfd ufd = { .fd = u->ring.ring_fd, .events = POLLIN };
+        if (vlc_poll_i11e (&ufd, 1, -1) < 0)
+            return -1;
+    }
+
+    if (ext->length < 0)
+    {
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(-ext->length));
+        UringRestart (sys, ext->offset + u->pos);
+        return 0;
+    }
+
+    if ((size_t)ext->length <= u->pos)
+    {   /* End of file: restart from here, in case the file grows */
+        UringRestart (sys, ext->offset + u->pos);
+        return 0;
+    }
+
+    size_t copy = ext->length - u->pos;
+    if (copy > i_len)
+        copy = i_len;
+    memcpy (p_buffer, ext->buf + u->pos, copy);
+    u->pos += copy;
+
+    if (u->pos == URING_EXTENT)
+    {   /* Extent consumed: queue it again, ahead of the others */
+        UringQueue (sys, ext);
+        io_uring_submit (&u->ring);
+        u->head = (u->head + 1) % URING_EXTENTS;
+        u->pos = 0;
+    }
+    else if (u->pos == (size_t)ext->length)
+        /* Short read: the next extents do not follow, restart from here */
+        UringRestart (sys, ext->offset + u->pos);
+    return copy;
+}
+
+static int UringSeek (access_sys_t *sys, uint64_t i_pos)
+{
+    struct uring *u = sys->uring;
+    struct uring_extent *ext = &u->extents[u->head];
+
+    /* Seeking within the extent being read (e.g. demuxer probing) */
+    if (!ext->pending && i_pos >= ext->offset
+     && i_pos - ext->offset < (uint64_t)__MAX(ext->length, 0))
+    {
+        u->pos = i_pos - ext->offset;
+        return VLC_SUCCESS;
+    }
+
+    UringRestart (sys, i_pos);
+    return VLC_SUCCESS;
+}
+
+static void UringDelete (struct uring *u)
+{
+    UringDrain (u);
+    io_uring_queue_exit (&u->ring);
+    for (unsigned i = 0; i < URING_EXTENTS; i++)
+        aligned_free (u->extents[i].buf);
+    free (u);
+}
+
+static struct uring *UringNew (stream_t *p_access, int fd)
+{
+    struct uring *u = malloc (sizeof (*u));
+    if (unlikely(u == NULL))
+        return NULL;
+
+    for (unsigned i = 0; i < URING_EXTENTS; i++)
+    {
+        u->extents[i].buf = aligned_alloc (URING_ALIGN, URING_EXTENT);
+        u->extents[i].pending = false;
+        if (unlikely(u->extents[i].buf == NULL))
+        {
+            while (i > 0)
+                aligned_free (u->extents[--i].buf);
+            free (u);
+            return NULL;
+        }
+    }
+
+    int val = io_uring_queue_init (URING_EXTENTS, &u->ring, 0);
+    if (val < 0)
+    {   /* Not supported by the kernel, or forbidden */
+        msg_Dbg (p_access, "io_uring not available: %s",
+                 vlc_strerror_c(-val));
+        for (unsigned i = 0; i < URING_EXTENTS; i++)
+            aligned_free (u->extents[i].buf);
+        free (u);
+        return NULL;
+    }
+    u->pending = 0;
+
+    if (var_InheritBool (p_access, "file-direct")
+     && fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_DIRECT))
+        msg_Warn (p_access, "cannot bypass the page cache: %s",
+                  vlc_strerror_c(errno));
+    return u;
+}
+#endif
+
 /*****************************************************************************
  * FileOpen: open the file
  *****************************************************************************/
@@ -210,6 +419,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_LIBURING
+    p_sys->uring = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -228,6 +440,14 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_LIBURING
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-uring"))
+        {
+            p_sys->uring = UringNew (p_access, fd);
+            if (p_sys->uring != NULL)
+                UringRestart (p_sys, lseek (fd, 0, SEEK_CUR));
+        }
 #endif
     }
     else
@@ -258,6 +478,10 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_LIBURING
+    if (p_sys->uring != NULL)
+        UringDelete (p_sys->uring);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -267,6 +491,11 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     access_sys_t *p_sys = p_access->p_sys;
     int fd = p_sys->fd;
 
+#ifdef HAVE_LIBURING
+    if (p_sys->uring != NULL)
+        return UringRead (p_access, p_buffer, i_len);
+#endif
+
     ssize_t val = vlc_read_i11e (fd, p_buffer, i_len);
     if (val < 0)
     {
@@ -291,8 +520,14 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
 {
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_LIBURING
+    if (sys->uring != NULL)
+        return UringSeek (sys, i_pos);
+#endif
     if (lseek(sys->fd, i_pos, SEEK_SET) == (off_t)-1)
         return VLC_EGENERIC;
+    /* The kernel read-ahead restarts from scratch after a seek. */
+    posix_fadvise (sys->fd, i_pos, FILE_SEEK_READAHEAD, POSIX_FADV_WILLNEED);
     return VLC_SUCCESS;
 }
 
@@ -39,6 +39,14 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+#ifdef HAVE_LIBURING
+    add_bool( "file-uring", true, N_("Asynchronous reads"),
+              N_("Queue reads ahead of the demuxer with io_uring."), true )
+    add_bool( "file-direct", false, N_("Bypass the page cache"),
+              N_("Read directly from the storage (O_DIRECT). This can "
+                 "help with large sequential streams that are read once."),
+              true )
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
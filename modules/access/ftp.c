@@ -967,7 +967,7 @@ static int DirRead (stream_t *p_access, input_item_node_t *p_current_node)
                       psz_filename ) != -1 )
         {
             i_ret = vlc_readdir_helper_additem( &rdh, psz_uri, NULL, psz_file,
-                                                type, ITEM_NET );
+                                                type, ITEM_NET, NULL );
             free( psz_uri );
         }
         free( psz_filename );
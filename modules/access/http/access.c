@@ -40,18 +40,25 @@
 #include "resource.h"
 #include "file.h"
 #include "live.h"
+#include "parallel.h"
+
+/* Bytes count per range request in parallel mode */
+#define PARALLEL_CHUNK (1 << 20)
 
 typedef struct
 {
     struct vlc_http_mgr *manager;
     struct vlc_http_resource *resource;
+    struct vlc_http_parallel *parallel;
 } access_sys_t;
 
 static block_t *FileRead(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
 
-    block_t *b = vlc_http_file_read(sys->resource);
+    block_t *b = (sys->parallel != NULL)
+        ? vlc_http_parallel_read(sys->parallel)
+        : vlc_http_file_read(sys->resource);
     if (b == NULL)
         *eof = true;
     return b;
@@ -61,7 +68,9 @@ static int FileSeek(stream_t *access, uint64_t pos)
 {
     access_sys_t *sys = access->p_sys;
 
-    if (vlc_http_file_seek(sys->resource, pos))
+    if ((sys->parallel != NULL)
+            ? vlc_http_parallel_seek(sys->parallel, pos)
+            : vlc_http_file_seek(sys->resource, pos))
         return VLC_EGENERIC;
     return VLC_SUCCESS;
 }
@@ -104,6 +113,15 @@ static int FileControl(stream_t *access, int query, va_list args)
             *va_arg(args, char **) = vlc_http_file_get_type(sys->resource);
             break;
 
+        case STREAM_GET_VALIDATOR:
+        {
+            char *str = vlc_http_file_get_validator(sys->resource);
+            if (str == NULL)
+                return VLC_EGENERIC;
+            *va_arg(args, char **) = str;
+            break;
+        }
+
         case STREAM_SET_PAUSE_STATE:
             break;
 
@@ -162,6 +180,7 @@ static int Open(vlc_object_t *obj)
 
     sys->manager = NULL;
     sys->resource = NULL;
+    sys->parallel = NULL;
 
     void *jar = NULL;
     if (var_InheritBool(obj, "http-forward-cookies"))
@@ -251,6 +270,15 @@ static int Open(vlc_object_t *obj)
     }
     else
     {
+        unsigned streams = var_InheritInteger(obj, "http-parallel");
+
+        if (streams > 0)
+        {
+            sys->parallel = vlc_http_parallel_create(obj, sys->resource,
+                                                     streams, PARALLEL_CHUNK);
+            if (sys->parallel != NULL)
+                msg_Dbg(access, "reading over %u more connections", streams);
+        }
         access->pf_block = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -275,6 +303,8 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    if (sys->parallel != NULL)
+        vlc_http_parallel_destroy(sys->parallel);
     vlc_http_res_destroy(sys->resource);
     vlc_http_mgr_destroy(sys->manager);
     free(sys);
@@ -292,6 +322,13 @@ vlc_module_begin()
     add_bool("http-continuous", false, N_("Continuous stream"),
              N_("Keep reading a resource that keeps being updated."), true)
         change_volatile()
+    add_integer_with_range("http-parallel", 0, 0, 16,
+                           N_("Parallel connections"),
+                           N_("Download seekable files faster over that many "
+                              "additional connections, each fetching a range "
+                              "ahead of the read position. This helps where "
+                              "a single connection cannot use the full "
+                              "bandwidth, e.g. over long distances."), true)
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."), true)
     add_string("http-referrer", NULL, N_("Referrer"),
@@ -99,7 +99,7 @@ static block_t *vlc_chunked_read(struct vlc_http_stream *stream)
     /* Read chunk data */
     if (s->chunk_length > 0)
     {
-        size_t size = 1536; /* arbitrary */
+        size_t size = VLC_H1_READ_SIZE;
         if (size > s->chunk_length)
             size = s->chunk_length;
 
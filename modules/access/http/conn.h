@@ -61,6 +61,15 @@ void vlc_http_dbg(void *, const char *msg, ...) VLC_FORMAT(2, 3);
  * \defgroup http1 HTTP/1.x
  * @{
  */
+
+/**
+ * Maximum size of HTTP/1.x payload reads.
+ *
+ * This is the largest TLS record payload, so that one read usually returns a
+ * whole record, without splitting it over several blocks.
+ */
+#define VLC_H1_READ_SIZE 16384
+
 struct vlc_http_conn *vlc_h1_conn_create(void *ctx, struct vlc_tls *,
                                          bool proxy);
 struct vlc_http_stream *vlc_chunked_open(struct vlc_http_stream *,
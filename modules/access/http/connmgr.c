@@ -24,6 +24,8 @@
 
 #include <assert.h>
 #include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_keepalive.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
@@ -96,22 +98,157 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/* How long and how many idle connections are kept for later inputs */
+#define VLC_HTTP_IDLE_TIMEOUT VLC_TICK_FROM_SEC(15)
+#define VLC_HTTP_IDLE_PER_ORIGIN 4
+
+/**
+ * Shared TLS credentials.
+ *
+ * TLS sessions use the credentials they were created with, so those must
+ * live as long as the connections, including while they are kept idle.
+ */
+struct vlc_http_creds
+{
+    vlc_tls_client_t *client;
+    vlc_atomic_rc_t rc;
+};
+
+static struct vlc_http_creds *vlc_http_creds_create(vlc_object_t *obj)
+{
+    struct vlc_http_creds *creds = malloc(sizeof (*creds));
+    if (unlikely(creds == NULL))
+        return NULL;
+
+    /* Not on the object, as idle connections can outlive it */
+    creds->client = vlc_tls_ClientCreate(VLC_OBJECT(vlc_object_instance(obj)));
+    if (creds->client == NULL)
+    {
+        free(creds);
+        return NULL;
+    }
+    vlc_atomic_rc_init(&creds->rc);
+    return creds;
+}
+
+static struct vlc_http_creds *vlc_http_creds_hold(struct vlc_http_creds *c)
+{
+    if (c != NULL)
+        vlc_atomic_rc_inc(&c->rc);
+    return c;
+}
+
+static void vlc_http_creds_release(struct vlc_http_creds *creds)
+{
+    if (creds != NULL && vlc_atomic_rc_dec(&creds->rc))
+    {
+        vlc_tls_ClientDelete(creds->client);
+        free(creds);
+    }
+}
+
+/** Idle connection, waiting in the keep-alive store */
+struct vlc_http_idle
+{
+    struct vlc_http_conn *conn;
+    struct vlc_http_creds *creds; /**< credentials of the connection */
+};
+
+static void vlc_http_idle_release(void *data)
+{
+    struct vlc_http_idle *idle = data;
+
+    vlc_http_conn_release(idle->conn);
+    vlc_http_creds_release(idle->creds);
+    free(idle);
+}
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
     vlc_object_t *obj;
-    vlc_tls_client_t *creds;
+    vlc_keepalive_t *pool;
+    struct vlc_http_creds *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    struct vlc_http_creds *conn_creds;
+    char origin[8 + 256 + 8]; /**< of the current connection */
 };
 
+static void vlc_http_origin(char *buf, size_t len, bool secure,
+                            const char *host, unsigned port)
+{
+    if (port == 0)
+        port = secure ? 443 : 80;
+    snprintf(buf, len, "http%s://%s:%u", secure ? "s" : "", host, port);
+}
+
+/* Puts the current connection aside for later reuse */
+static void vlc_http_mgr_park(struct vlc_http_mgr *mgr)
+{
+    struct vlc_http_conn *conn = mgr->conn;
+    struct vlc_http_creds *creds = mgr->conn_creds;
+
+    assert(conn != NULL);
+    mgr->conn = NULL;
+    mgr->conn_creds = NULL;
+
+    struct vlc_http_idle *idle = NULL;
+
+    if (mgr->pool != NULL)
+        idle = malloc(sizeof (*idle));
+    if (idle == NULL)
+    {
+        vlc_http_conn_release(conn);
+        vlc_http_creds_release(creds);
+        return;
+    }
+
+    idle->conn = conn;
+    idle->creds = creds;
+    vlc_keepalive_Put(mgr->pool, mgr->origin, idle, vlc_http_idle_release,
+                      VLC_HTTP_IDLE_TIMEOUT, VLC_HTTP_IDLE_PER_ORIGIN);
+}
+
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
+                                               bool secure,
                                                const char *host, unsigned port)
 {
-    (void) host; (void) port;
+    char origin[sizeof (mgr->origin)];
+
+    vlc_http_origin(origin, sizeof (origin), secure, host, port);
+
+    if (mgr->conn != NULL)
+    {
+        if (strcmp(mgr->origin, origin) == 0)
+            return mgr->conn;
+        vlc_http_mgr_park(mgr); /* e.g. redirected to another server */
+    }
+
+    if (mgr->pool == NULL)
+        return NULL;
+
+    struct vlc_http_idle *idle = vlc_keepalive_Take(mgr->pool, origin);
+    if (idle == NULL)
+        return NULL;
+
+    mgr->conn = idle->conn;
+    mgr->conn_creds = idle->creds;
+    strcpy(mgr->origin, origin);
+    free(idle);
     return mgr->conn;
 }
 
+static void vlc_http_mgr_set(struct vlc_http_mgr *mgr,
+                             struct vlc_http_conn *conn, bool secure,
+                             const char *host, unsigned port)
+{
+    assert(mgr->conn == NULL);
+    mgr->conn = conn;
+    mgr->conn_creds = secure ? vlc_http_creds_hold(mgr->creds) : NULL;
+    vlc_http_origin(mgr->origin, sizeof (mgr->origin), secure, host, port);
+}
+
 static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
                                  struct vlc_http_conn *conn)
 {
@@ -119,14 +256,16 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
     mgr->conn = NULL;
 
     vlc_http_conn_release(conn);
+    vlc_http_creds_release(mgr->conn_creds);
+    mgr->conn_creds = NULL;
 }
 
 static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr, bool secure,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
+    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, secure, host, port);
     if (conn == NULL)
         return NULL;
 
@@ -154,30 +293,29 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
+    /* TODO? non-idempotent request support */
+    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, true, host, port, req);
+    if (resp != NULL)
+        return resp; /* existing connection reused */
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
-        mgr->creds = vlc_tls_ClientCreate(mgr->obj);
+        mgr->creds = vlc_http_creds_create(mgr->obj);
         if (mgr->creds == NULL)
             return NULL;
     }
 
-    /* TODO? non-idempotent request support */
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp; /* existing connection reused */
+    vlc_tls_client_t *client = mgr->creds->client;
 
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
     {
-        tls = vlc_https_connect_proxy(mgr->creds, mgr->creds,
-                                      host, port, &http2, proxy);
+        tls = vlc_https_connect_proxy(client, client, host, port, &http2,
+                                      proxy);
         free(proxy);
     }
     else
-        tls = vlc_https_connect(mgr->creds, host, port, &http2);
+        tls = vlc_https_connect(client, host, port, &http2);
 
     if (tls == NULL)
         return NULL;
@@ -202,19 +340,16 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    mgr->conn = conn;
-
-    return vlc_http_mgr_reuse(mgr, host, port, req);
+    vlc_http_mgr_set(mgr, conn, true, host, port);
+    return vlc_http_mgr_reuse(mgr, true, host, port, req);
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const char *host, unsigned port,
                                              const struct vlc_http_msg *req)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
-
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
+    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, false, host, port,
+                                                   req);
     if (resp != NULL)
         return resp;
 
@@ -252,7 +387,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    mgr->conn = conn;
+    vlc_http_mgr_set(mgr, conn, false, host, port);
     return resp;
 }
 
@@ -280,17 +415,18 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
 
     mgr->logger = obj->logger;
     mgr->obj = obj;
+    mgr->pool = vlc_object_keepalive(obj);
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->conn_creds = NULL;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
     if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-    if (mgr->creds != NULL)
-        vlc_tls_ClientDelete(mgr->creds);
+        vlc_http_mgr_park(mgr);
+    vlc_http_creds_release(mgr->creds);
     free(mgr);
 }
@@ -193,6 +193,26 @@ uintmax_t vlc_http_file_get_size(struct vlc_http_resource *res)
     return vlc_http_msg_get_size(res->response);
 }
 
+char *vlc_http_file_get_validator(struct vlc_http_resource *res)
+{
+    int status = vlc_http_res_get_status(res);
+    if (status < 200 || status >= 300)
+        return NULL;
+
+    const char *str = vlc_http_msg_get_header(res->response, "ETag");
+    if (str != NULL)
+        return memcmp(str, "W/", 2) ? strdup(str) : NULL;
+
+    time_t mtime = vlc_http_msg_get_mtime(res->response);
+    if (mtime == -1)
+        return NULL;
+
+    char *ret;
+    if (asprintf(&ret, "mtime=%" PRIdMAX, (intmax_t)mtime) < 0)
+        ret = NULL;
+    return ret;
+}
+
 bool vlc_http_file_can_seek(struct vlc_http_resource *res)
 {   /* See IETF RFC7233 */
     int status = vlc_http_res_get_status(res);
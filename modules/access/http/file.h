@@ -55,6 +55,18 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
  */
 uintmax_t vlc_http_file_get_size(struct vlc_http_resource *);
 
+/**
+ * Gets the file validator.
+ *
+ * Returns a string identifying the current version of the file, as given by
+ * the strong entity tag or else the last modification time of the response.
+ * Weak entity tags are ignored, as they do not guarantee byte-wise identity.
+ *
+ * @return a heap-allocated string (to be freed by the caller), or NULL if the
+ * server provided no usable validator
+ */
+char *vlc_http_file_get_validator(struct vlc_http_resource *);
+
 /**
  * Checks seeking support.
  *
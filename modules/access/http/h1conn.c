@@ -231,7 +231,7 @@ static struct vlc_http_msg *vlc_h1_stream_wait(struct vlc_http_stream *stream)
 static block_t *vlc_h1_stream_read(struct vlc_http_stream *stream)
 {
     struct vlc_h1_conn *conn = vlc_h1_stream_conn(stream);
-    size_t size = 2048;
+    size_t size = VLC_H1_READ_SIZE;
 
     assert(conn->active);
 
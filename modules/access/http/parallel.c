@@ -0,0 +1,517 @@
+/*****************************************************************************
+ * parallel.c: HTTP file download over parallel range requests
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_interrupt.h>
+#include "message.h"
+#include "resource.h"
+#include "connmgr.h"
+#include "file.h"
+#include "parallel.h"
+
+#pragma GCC visibility push(default)
+
+/*
+ * Chunk 0 starts at the read offset after opening or seeking, and is read
+ * from the file itself. Workers fetch the next chunks within a window ahead
+ * of the reader; chunk k goes to slot (k - 1) modulo the window size.
+ */
+
+struct vlc_http_range
+{
+    uintmax_t start;
+    uintmax_t end; /**< inclusive */
+    const struct vlc_http_parallel *owner;
+};
+
+struct vlc_http_chunk
+{
+    uintmax_t start; /**< UINTMAX_MAX if the slot is free */
+    uintmax_t length;
+    uintmax_t received;
+    block_t *data; /**< received and not yet read */
+    block_t **tailp;
+    bool done;
+};
+
+struct vlc_http_worker
+{
+    struct vlc_http_parallel *owner;
+    struct vlc_http_mgr *manager;
+    struct vlc_http_resource *resource;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+};
+
+struct vlc_http_parallel
+{
+    struct vlc_http_resource *file;
+    char *etag; /**< validator of the file, or NULL */
+    time_t mtime; /**< modification time of the file, or -1 */
+    uintmax_t size;
+    uintmax_t chunk;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< signaled on received data */
+    vlc_cond_t work; /**< signaled on free slot or exit */
+    uintmax_t origin; /**< start of chunk 0 */
+    uintmax_t offset; /**< read offset */
+    unsigned generation; /**< incremented on seek */
+    bool active; /**< false after falling back to the file */
+    bool interrupted;
+    bool quit;
+
+    unsigned window;
+    struct vlc_http_chunk *chunks;
+    unsigned streams;
+    struct vlc_http_worker workers[];
+};
+
+static int vlc_http_range_req(const struct vlc_http_resource *res,
+                              struct vlc_http_msg *req, void *opaque)
+{
+    const struct vlc_http_range *range = opaque;
+    const struct vlc_http_parallel *p = range->owner;
+
+    /* Do not mix chunks of different versions of the file */
+    if (p->etag != NULL)
+        vlc_http_msg_add_header(req, "If-Match", "%s", p->etag);
+    else if (p->mtime != -1)
+        vlc_http_msg_add_time(req, "If-Unmodified-Since", &p->mtime);
+
+    (void) res;
+    return vlc_http_msg_add_header(req, "Range",
+                                   "bytes=%" PRIuMAX "-%" PRIuMAX,
+                                   range->start, range->end);
+}
+
+static int vlc_http_range_resp(const struct vlc_http_resource *res,
+                               const struct vlc_http_msg *resp, void *opaque)
+{
+    const struct vlc_http_range *range = opaque;
+    uintmax_t start, end;
+
+    (void) res;
+
+    /* Anything but the exact range is useless here */
+    if (vlc_http_msg_get_status(resp) != 206)
+        return -1;
+
+    const char *str = vlc_http_msg_get_header(resp, "Content-Range");
+    if (str == NULL
+     || sscanf(str, "bytes %" SCNuMAX "-%" SCNuMAX, &start, &end) != 2
+     || start != range->start || end < start)
+        return -1;
+    return 0;
+}
+
+static const struct vlc_http_resource_cbs vlc_http_range_callbacks =
+{
+    vlc_http_range_req,
+    vlc_http_range_resp,
+};
+
+static void vlc_http_chunk_reset(struct vlc_http_chunk *c)
+{
+    block_ChainRelease(c->data);
+    c->start = UINTMAX_MAX;
+    c->length = 0;
+    c->received = 0;
+    c->data = NULL;
+    c->tailp = &c->data;
+    c->done = false;
+}
+
+static struct vlc_http_chunk *vlc_http_parallel_slot(struct vlc_http_parallel *p,
+                                                     uintmax_t k)
+{
+    assert(k > 0);
+    return &p->chunks[(k - 1) % p->window];
+}
+
+/* Picks the next chunk to fetch, with the lock held */
+static uintmax_t vlc_http_parallel_claim(struct vlc_http_parallel *p,
+                                         struct vlc_http_range *range)
+{
+    uintmax_t first = (p->offset - p->origin) / p->chunk;
+
+    if (first == 0)
+        first = 1;
+
+    for (uintmax_t k = first; k < first + p->window; k++)
+    {
+        uintmax_t start = p->origin + k * p->chunk;
+        if (start >= p->size)
+            break;
+
+        struct vlc_http_chunk *c = vlc_http_parallel_slot(p, k);
+        if (c->start != UINTMAX_MAX)
+            continue; /* being fetched, or not read yet */
+
+        c->start = start;
+        c->length = __MIN(p->chunk, p->size - start);
+        range->start = c->start;
+        range->end = c->start + c->length - 1;
+        range->owner = p;
+        return k;
+    }
+    return 0;
+}
+
+static void vlc_http_worker_fetch(struct vlc_http_worker *w, uintmax_t k,
+                                  struct vlc_http_range *range,
+                                  unsigned generation)
+{
+    struct vlc_http_parallel *p = w->owner;
+    struct vlc_http_chunk *c = vlc_http_parallel_slot(p, k);
+    struct vlc_http_resource *res = w->resource;
+
+    if (res->response != NULL)
+    {
+        vlc_http_msg_destroy(res->response);
+        res->response = NULL;
+    }
+
+    /* The slot is only valid while the generation is unchanged */
+    res->response = vlc_http_res_open(res, range);
+
+    block_t *block = NULL;
+    bool done;
+
+    do
+    {
+        if (res->response != NULL)
+        {
+            block = vlc_http_res_read(res);
+            if (block == vlc_http_error)
+                block = NULL;
+        }
+
+        vlc_mutex_lock(&p->lock);
+        if (p->generation != generation)
+        {   /* Seeked away meanwhile */
+            vlc_mutex_unlock(&p->lock);
+            if (block != NULL)
+                block_Release(block);
+            return;
+        }
+
+        if (block != NULL)
+        {
+            if (block->i_buffer > c->length - c->received)
+                block->i_buffer = c->length - c->received;
+            c->received += block->i_buffer;
+            block_ChainLastAppend(&c->tailp, block);
+        }
+        /* Done, or failed if anything is missing */
+        done = c->done = block == NULL || c->received == c->length;
+        vlc_cond_signal(&p->wait);
+        vlc_mutex_unlock(&p->lock);
+    }
+    while (!done);
+}
+
+static void *vlc_http_worker_thread(void *data)
+{
+    struct vlc_http_worker *w = data;
+    struct vlc_http_parallel *p = w->owner;
+
+    vlc_interrupt_set(w->interrupt);
+
+    vlc_mutex_lock(&p->lock);
+    while (!p->quit)
+    {
+        struct vlc_http_range range;
+        uintmax_t k = p->active ? vlc_http_parallel_claim(p, &range) : 0;
+        if (k == 0)
+        {
+            vlc_cond_wait(&p->work, &p->lock);
+            continue;
+        }
+
+        unsigned generation = p->generation;
+
+        vlc_mutex_unlock(&p->lock);
+        vlc_http_worker_fetch(w, k, &range, generation);
+        vlc_mutex_lock(&p->lock);
+    }
+    vlc_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static void vlc_http_parallel_wake_up(void *data)
+{
+    struct vlc_http_parallel *p = data;
+
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = true;
+    vlc_cond_signal(&p->wait);
+    vlc_mutex_unlock(&p->lock);
+}
+
+/* Drops all chunks and restarts from the file offset, with the lock held */
+static void vlc_http_parallel_reset(struct vlc_http_parallel *p,
+                                    uintmax_t offset)
+{
+    p->generation++;
+    for (unsigned i = 0; i < p->window; i++)
+        vlc_http_chunk_reset(&p->chunks[i]);
+    p->origin = p->offset = offset;
+    vlc_cond_broadcast(&p->work);
+}
+
+block_t *vlc_http_parallel_read(struct vlc_http_parallel *p)
+{
+    /* The reader is the only writer of the offset: no need to lock for
+     * reading it */
+    if (!p->active || p->offset - p->origin < p->chunk)
+    {
+        block_t *block = vlc_http_file_read(p->file);
+        if (block == NULL || !p->active)
+            return block;
+
+        uintmax_t left = p->chunk - (p->offset - p->origin);
+        if (block->i_buffer > left)
+            block->i_buffer = left; /* duplicated in the next chunk */
+
+        vlc_mutex_lock(&p->lock);
+        p->offset += block->i_buffer;
+        vlc_mutex_unlock(&p->lock);
+        return block;
+    }
+
+    if (p->offset >= p->size)
+        return NULL;
+
+    uintmax_t k = (p->offset - p->origin) / p->chunk;
+    struct vlc_http_chunk *c = vlc_http_parallel_slot(p, k);
+    block_t *block = NULL;
+
+    p->interrupted = false;
+    vlc_interrupt_register(vlc_http_parallel_wake_up, p);
+    vlc_mutex_lock(&p->lock);
+
+    while (c->data == NULL && !c->done && !p->interrupted)
+        vlc_cond_wait(&p->wait, &p->lock);
+
+    if (c->data != NULL)
+    {
+        block = c->data;
+        c->data = block->p_next;
+        block->p_next = NULL;
+        if (c->data == NULL)
+            c->tailp = &c->data;
+        p->offset += block->i_buffer;
+
+        if (c->done && c->data == NULL && c->received == c->length)
+        {   /* Chunk fully read, the slot can be reused */
+            vlc_http_chunk_reset(c);
+            vlc_cond_broadcast(&p->work);
+        }
+    }
+    else if (c->done)
+    {   /* The range request failed: fall back to the file only */
+        uintmax_t offset = p->offset;
+
+        vlc_http_parallel_reset(p, offset);
+        p->active = false;
+        vlc_mutex_unlock(&p->lock);
+        vlc_interrupt_unregister();
+
+        if (vlc_http_file_seek(p->file, offset))
+            return NULL;
+        return vlc_http_file_read(p->file);
+    }
+
+    vlc_mutex_unlock(&p->lock);
+    vlc_interrupt_unregister();
+    return block;
+}
+
+int vlc_http_parallel_seek(struct vlc_http_parallel *p, uintmax_t offset)
+{
+    if (vlc_http_file_seek(p->file, offset))
+        return -1;
+
+    vlc_mutex_lock(&p->lock);
+    vlc_http_parallel_reset(p, offset);
+    vlc_mutex_unlock(&p->lock);
+    return 0;
+}
+
+static char *vlc_http_res_get_uri(const struct vlc_http_resource *res)
+{
+    char *uri;
+
+    if (asprintf(&uri, "http%s://%s%s", res->secure ? "s" : "",
+                 res->authority, res->path) < 0)
+        uri = NULL;
+    return uri;
+}
+
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+                                             struct vlc_http_resource *file,
+                                             unsigned streams, size_t chunk)
+{
+    if (streams == 0 || chunk == 0 || !vlc_http_file_can_seek(file))
+        return NULL;
+
+    uintmax_t size = vlc_http_file_get_size(file);
+    if (size == (uintmax_t)-1 || size / 2 < chunk)
+        return NULL; /* unknown size, or not worth it */
+
+    struct vlc_http_parallel *p = malloc(sizeof (*p)
+                                         + streams * sizeof (p->workers[0]));
+    if (unlikely(p == NULL))
+        return NULL;
+
+    p->file = file;
+    p->size = size;
+    p->chunk = chunk;
+    p->mtime = -1;
+    p->etag = NULL;
+
+    const char *etag = vlc_http_msg_get_header(file->response, "ETag");
+    if (etag != NULL)
+    {
+        if (!memcmp(etag, "W/", 2))
+            etag += 2; /* skip weak mark, as vlc_http_file_req() */
+        p->etag = strdup(etag);
+    }
+    else
+        p->mtime = vlc_http_msg_get_mtime(file->response);
+
+    p->window = 2 * streams;
+    p->chunks = malloc(p->window * sizeof (*p->chunks));
+    if (unlikely(p->chunks == NULL))
+    {
+        free(p->etag);
+        free(p);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < p->window; i++)
+    {
+        p->chunks[i].data = NULL;
+        vlc_http_chunk_reset(&p->chunks[i]);
+    }
+
+    vlc_mutex_init(&p->lock);
+    vlc_cond_init(&p->wait);
+    vlc_cond_init(&p->work);
+    p->origin = p->offset = 0;
+    p->generation = 0;
+    p->active = true;
+    p->interrupted = false;
+    p->quit = false;
+    p->streams = 0;
+
+    /* The read offset is zero, as the file has not been read nor seeked */
+    char *uri = vlc_http_res_get_uri(file);
+    if (unlikely(uri == NULL))
+        goto error;
+
+    for (unsigned i = 0; i < streams; i++)
+    {
+        struct vlc_http_worker *w = &p->workers[i];
+
+        w->owner = p;
+        w->interrupt = vlc_interrupt_create();
+        if (unlikely(w->interrupt == NULL))
+            break;
+
+        /* Separate connections, to get separate TCP windows */
+        w->manager = vlc_http_mgr_create(obj,
+                                         vlc_http_mgr_get_jar(file->manager));
+        if (unlikely(w->manager == NULL))
+        {
+            vlc_interrupt_destroy(w->interrupt);
+            break;
+        }
+
+        w->resource = malloc(sizeof (*w->resource));
+        if (unlikely(w->resource == NULL)
+         || vlc_http_res_init(w->resource, &vlc_http_range_callbacks,
+                              w->manager, uri, file->agent, file->referrer))
+        {
+            free(w->resource);
+            vlc_http_mgr_destroy(w->manager);
+            vlc_interrupt_destroy(w->interrupt);
+            break;
+        }
+        vlc_http_res_set_login(w->resource, file->username, file->password);
+
+        if (vlc_clone(&w->thread, vlc_http_worker_thread, w,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_http_res_destroy(w->resource);
+            vlc_http_mgr_destroy(w->manager);
+            vlc_interrupt_destroy(w->interrupt);
+            break;
+        }
+        p->streams++;
+    }
+    free(uri);
+
+    if (p->streams > 0)
+        return p;
+error:
+    vlc_http_parallel_destroy(p);
+    return NULL;
+}
+
+void vlc_http_parallel_destroy(struct vlc_http_parallel *p)
+{
+    vlc_mutex_lock(&p->lock);
+    p->quit = true;
+    vlc_cond_broadcast(&p->work);
+    vlc_mutex_unlock(&p->lock);
+
+    for (unsigned i = 0; i < p->streams; i++)
+    {
+        struct vlc_http_worker *w = &p->workers[i];
+
+        vlc_interrupt_kill(w->interrupt);
+        vlc_join(w->thread, NULL);
+        vlc_http_res_destroy(w->resource);
+        vlc_http_mgr_destroy(w->manager);
+        vlc_interrupt_destroy(w->interrupt);
+    }
+
+    for (unsigned i = 0; i < p->window; i++)
+        block_ChainRelease(p->chunks[i].data);
+    free(p->chunks);
+    vlc_cond_destroy(&p->work);
+    vlc_cond_destroy(&p->wait);
+    vlc_mutex_destroy(&p->lock);
+    free(p->etag);
+    free(p);
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * parallel.h: HTTP file download over parallel range requests
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include <stdint.h>
+
+/**
+ * \defgroup http_parallel Parallel files
+ * HTTP read-only files fetched over several connections
+ * \ingroup http_file
+ *
+ * The file is split in fixed-size chunks, fetched ahead of the read offset
+ * with Range requests by worker threads, each with its own connection.
+ * The chunks are reordered and returned sequentially. The data at the read
+ * offset is always read from the underlying file, so that reading can start
+ * immediately after opening or seeking.
+ *
+ * This only helps where a single connection cannot use the full bandwidth,
+ * typically because of the TCP window on high-latency links.
+ * @{
+ */
+
+struct vlc_http_parallel;
+struct vlc_http_resource;
+struct block_t;
+
+/**
+ * Creates a parallel reader for an HTTP file.
+ *
+ * @param obj object to create the connections from
+ * @param file opened HTTP file (must remain valid until destroyed)
+ * @param streams number of parallel connections, besides the file's own
+ * @param chunk bytes count per range request
+ *
+ * @return a parallel reader, or NULL if the file does not qualify (unknown
+ * size, no seek support, too small) or on error
+ */
+struct vlc_http_parallel *vlc_http_parallel_create(vlc_object_t *obj,
+                                             struct vlc_http_resource *file,
+                                             unsigned streams, size_t chunk);
+
+/**
+ * Destroys a parallel reader.
+ *
+ * Stops and joins the workers. The file is not destroyed.
+ */
+void vlc_http_parallel_destroy(struct vlc_http_parallel *);
+
+/**
+ * Reads data.
+ *
+ * Reads the data at the current offset, waiting for it as needed.
+ * If a range request fails, the reader falls back to the underlying file.
+ *
+ * @return a block of data, or NULL on end of file, error or interruption
+ */
+struct block_t *vlc_http_parallel_read(struct vlc_http_parallel *);
+
+/**
+ * Sets the read offset.
+ *
+ * Drops the fetched chunks, and seeks the underlying file.
+ *
+ * @param offset byte offset of next read
+ * @retval 0 if seek succeeded
+ * @retval -1 if seek failed
+ */
+int vlc_http_parallel_seek(struct vlc_http_parallel *, uintmax_t offset);
+
+/** @} */
@@ -191,7 +191,7 @@ vlc_tls_t *vlc_https_connect_proxy(void *ctx, vlc_tls_client_t *creds,
     }
 
     psock->tls.ops = &vlc_tls_proxy_ops;
-    psock->tls.p = NULL;
+    psock->tls.p = sock;
     psock->sock = sock;
 
     struct vlc_http_conn *conn = /*ptwo ? vlc_h2_conn_create(ctx, &psock->tls)
@@ -64,6 +64,23 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 vlc_module_end()
 
+/* Several reads are kept outstanding, as a single one at a time is bound by the
+ * round-trip time on high latency links. */
+#define NFS_READ_DEPTH 4
+#define NFS_READ_MIN (32 * 1024)
+#define NFS_READ_MAX (1024 * 1024)
+
+struct nfs_chunk
+{
+    stream_t *              p_access;
+    uint8_t *               p_buf;
+    size_t                  i_capacity;
+    size_t                  i_size; /* requested */
+    size_t                  i_len; /* received */
+    size_t                  i_pos; /* returned */
+    bool                    b_pending;
+};
+
 typedef struct
 {
     struct rpc_context *    p_mount; /* used to to get exports mount point */
@@ -79,21 +96,20 @@ typedef struct
     bool                    b_error;
     bool                    b_auto_guid;
 
+    struct nfs_chunk        chunks[NFS_READ_DEPTH]; /* in offset order */
+    unsigned                i_chunk_first;
+    unsigned                i_chunk_count;
+    uint64_t                i_read_offset; /* next returned byte */
+    uint64_t                i_ahead_offset; /* next requested byte */
+    size_t                  i_read_size;
+    size_t                  i_read_max;
+
     union {
         struct
         {
             char **         ppsz_names;
             int             i_count;
         } exports;
-        struct
-        {
-            uint8_t *p_buf;
-            size_t i_len;
-        } read;
-        struct
-        {
-            bool b_done;
-        } seek;
     } res;
 } access_sys_t;
 
@@ -178,71 +194,148 @@ nfs_read_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
             void *p_private_data)
 {
     VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
+    struct nfs_chunk *p_chunk = p_private_data;
+    stream_t *p_access = p_chunk->p_access;
     access_sys_t *p_sys = p_access->p_sys;
     assert(p_sys->p_nfs == p_nfs);
+
+    p_chunk->b_pending = false;
     if (NFS_CHECK_STATUS(p_access, i_status, p_data))
         return;
 
-    if (i_status == 0)
-        p_sys->b_eof = true;
-    else
-    {
-        p_sys->res.read.i_len = i_status;
-        memcpy(p_sys->res.read.p_buf, p_data, i_status);
-    }
+    /* 0 at end of file */
+    p_chunk->i_len = __MIN((size_t) i_status, p_chunk->i_size);
+    memcpy(p_chunk->p_buf, p_data, p_chunk->i_len);
 }
 
 static bool
 nfs_read_finished_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.read.i_len > 0 || p_sys->b_eof;
+    return !p_sys->chunks[p_sys->i_chunk_first].b_pending;
 }
 
-static ssize_t
-FileRead(stream_t *p_access, void *p_buf, size_t i_len)
+static bool
+nfs_read_flushed_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    if (p_sys->b_eof)
-        return 0;
+    for (unsigned i = 0; i < NFS_READ_DEPTH; i++)
+        if (p_sys->chunks[i].b_pending)
+            return false;
+    return true;
+}
 
-    p_sys->res.read.i_len = 0;
-    p_sys->res.read.p_buf = p_buf;
-    if (nfs_read_async(p_sys->p_nfs, p_sys->p_nfsfh, i_len, nfs_read_cb,
-                       p_access) < 0)
+/* Issues reads until the window is full */
+static int
+FileReadAhead(stream_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    while (p_sys->i_chunk_count < NFS_READ_DEPTH)
     {
-        msg_Err(p_access, "nfs_read_async failed");
-        return -1;
-    }
+        /* Past the known size, only look for a grown file one read at a time */
+        if (p_sys->i_ahead_offset >= p_sys->stat.nfs_size
+         && p_sys->i_chunk_count > 0)
+            break;
 
-    if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
-        return -1;
+        struct nfs_chunk *p_chunk = &p_sys->chunks[(p_sys->i_chunk_first
+                                    + p_sys->i_chunk_count) % NFS_READ_DEPTH];
+        size_t i_size = p_sys->i_read_size;
 
-    return p_sys->res.read.i_len;
+        if (p_sys->i_ahead_offset < p_sys->stat.nfs_size
+         && i_size > p_sys->stat.nfs_size - p_sys->i_ahead_offset)
+            i_size = p_sys->stat.nfs_size - p_sys->i_ahead_offset;
+
+        if (p_chunk->i_capacity < i_size)
+        {
+            uint8_t *p_buf = realloc(p_chunk->p_buf, i_size);
+            if (p_buf == NULL)
+                return p_sys->i_chunk_count > 0 ? 0 : -1;
+            p_chunk->p_buf = p_buf;
+            p_chunk->i_capacity = i_size;
+        }
+
+        p_chunk->p_access = p_access;
+        p_chunk->i_size = i_size;
+        p_chunk->i_len = p_chunk->i_pos = 0;
+        p_chunk->b_pending = true;
+        if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh,
+                            p_sys->i_ahead_offset, i_size, nfs_read_cb,
+                            p_chunk) < 0)
+        {
+            p_chunk->b_pending = false;
+            msg_Err(p_access, "nfs_pread_async failed");
+            return -1;
+        }
+        p_sys->i_ahead_offset += i_size;
+        p_sys->i_chunk_count++;
+    }
+    return 0;
 }
 
-static void
-nfs_seek_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
-            void *p_private_data)
+/* Waits for the outstanding reads, so that their data is not mistaken for
+ * that of later requests */
+static int
+FileReadFlush(stream_t *p_access)
 {
-    VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
     access_sys_t *p_sys = p_access->p_sys;
-    assert(p_sys->p_nfs == p_nfs);
-    (void) p_data;
-    if (NFS_CHECK_STATUS(p_access, i_status, p_data))
-        return;
 
-    p_sys->res.seek.b_done = true;
+    if (vlc_nfs_mainloop(p_access, nfs_read_flushed_cb) < 0)
+        return -1;
+
+    p_sys->i_chunk_count = 0;
+    p_sys->i_ahead_offset = p_sys->i_read_offset;
+    return 0;
 }
 
-static bool
-nfs_seek_finished_cb(stream_t *p_access)
+static ssize_t
+FileRead(stream_t *p_access, void *p_buf, size_t i_len)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.seek.b_done;
+
+    if (p_sys->b_eof)
+        return 0;
+
+    for (;;)
+    {
+        if (FileReadAhead(p_access) < 0)
+            return -1;
+
+        if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
+            return -1;
+
+        struct nfs_chunk *p_chunk = &p_sys->chunks[p_sys->i_chunk_first];
+        if (p_chunk->i_pos < p_chunk->i_len)
+        {
+            if (i_len > p_chunk->i_len - p_chunk->i_pos)
+                i_len = p_chunk->i_len - p_chunk->i_pos;
+            memcpy(p_buf, p_chunk->p_buf + p_chunk->i_pos, i_len);
+            p_chunk->i_pos += i_len;
+            p_sys->i_read_offset += i_len;
+            return i_len;
+        }
+
+        if (p_chunk->i_len == 0)
+        {
+            p_sys->b_eof = true;
+            return 0;
+        }
+
+        /* Fully returned */
+        p_sys->i_chunk_first = (p_sys->i_chunk_first + 1) % NFS_READ_DEPTH;
+        p_sys->i_chunk_count--;
+
+        if (p_chunk->i_len < p_chunk->i_size)
+        {   /* Short read: the following requests are misaligned */
+            if (FileReadFlush(p_access) < 0)
+                return -1;
+        }
+        else if (p_sys->i_read_size < p_sys->i_read_max)
+            /* Sequential reading: grow the requests */
+            p_sys->i_read_size = __MIN(p_sys->i_read_size * 2,
+                                       p_sys->i_read_max);
+    }
 }
 
 static int
@@ -250,17 +343,11 @@ FileSeek(stream_t *p_access, uint64_t i_pos)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    p_sys->res.seek.b_done = false;
-    if (nfs_lseek_async(p_sys->p_nfs, p_sys->p_nfsfh, i_pos, SEEK_SET,
-                        nfs_seek_cb, p_access) < 0)
-    {
-        msg_Err(p_access, "nfs_seek_async failed");
-        return VLC_EGENERIC;
-    }
-
-    if (vlc_nfs_mainloop(p_access, nfs_seek_finished_cb) < 0)
+    if (FileReadFlush(p_access) < 0)
         return VLC_EGENERIC;
 
+    p_sys->i_read_offset = p_sys->i_ahead_offset = i_pos;
+    p_sys->i_read_size = __MIN(NFS_READ_MIN, p_sys->i_read_max);
     p_sys->b_eof = false;
 
     return VLC_SUCCESS;
@@ -363,9 +450,16 @@ DirRead(stream_t *p_access, input_item_node_t *p_node)
         default:
             i_type = ITEM_TYPE_UNKNOWN;
         }
+        input_item_t *p_item;
         i_ret = vlc_readdir_helper_additem(&rdh, psz_url, NULL, p_nfsdirent->name,
-                                           i_type, ITEM_NET);
+                                           i_type, ITEM_NET, &p_item);
         free(psz_url);
+
+        if (p_item != NULL && i_type == ITEM_TYPE_FILE)
+        {
+            p_item->i_file_size = p_nfsdirent->size;
+            p_item->i_file_mtime = p_nfsdirent->mtime.tv_sec;
+        }
     }
 
     vlc_readdir_helper_finish(&rdh, i_ret == VLC_SUCCESS);
@@ -394,7 +488,7 @@ MountRead(stream_t *p_access, input_item_node_t *p_node)
             break;
         }
         i_ret = vlc_readdir_helper_additem(&rdh, psz_url, NULL, psz_name,
-                                            ITEM_TYPE_DIRECTORY, ITEM_NET);
+                                            ITEM_TYPE_DIRECTORY, ITEM_NET, NULL);
         free(psz_url);
     }
 
@@ -692,6 +786,13 @@ Open(vlc_object_t *p_obj)
 
         if (p_sys->p_nfsfh != NULL)
         {
+            p_sys->i_read_max = nfs_get_readmax(p_sys->p_nfs);
+            if (p_sys->i_read_max == 0 || p_sys->i_read_max > NFS_READ_MAX)
+                p_sys->i_read_max = NFS_READ_MAX;
+            p_sys->i_read_size = __MIN(NFS_READ_MIN, p_sys->i_read_max);
+            msg_Dbg(p_access, "reading up to %zu bytes per request",
+                    p_sys->i_read_max);
+
             p_access->pf_read = FileRead;
             p_access->pf_seek = FileSeek;
             p_access->pf_control = FileControl;
@@ -758,6 +859,10 @@ Close(vlc_object_t *p_obj)
     if (p_sys->p_nfs != NULL)
         nfs_destroy_context(p_sys->p_nfs);
 
+    /* Only after the context, as outstanding reads complete into them */
+    for (unsigned i = 0; i < NFS_READ_DEPTH; i++)
+        free(p_sys->chunks[i].p_buf);
+
     if (p_sys->p_mount != NULL)
     {
         for (int i = 0; i < p_sys->res.exports.i_count; ++i)
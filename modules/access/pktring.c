@@ -0,0 +1,614 @@
+/*****************************************************************************
+ * pktring.c: UDP input through a Linux packet capture ring
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The kernel writes the captured packets into a ring of blocks (TPACKET_V3)
+ * shared with user space. The UDP payloads are handed out as blocks pointing
+ * directly into the ring, without any copy nor system call per packet. A ring
+ * block is given back to the kernel once all its packets are released.
+ *
+ * A regular UDP socket is still opened to join the multicast group, but it
+ * is never read from.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_access.h>
+#include <vlc_network.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_interrupt.h>
+
+/* Ring block size: packets are retired to user space a block at a time */
+#define RING_BLOCK_SIZE (1u << 20)
+/* How long the kernel fills a block before retiring it anyway (ms) */
+#define RING_BLOCK_TIMEOUT 8
+#define RING_FRAME_SIZE 2048
+
+typedef struct pktring pktring_t;
+
+struct pktring_slot
+{
+    struct tpacket_block_desc *desc;
+    pktring_t *ring;
+    atomic_uint refs; /**< reader and packets in use */
+    atomic_bool busy; /**< not given back to the kernel yet */
+};
+
+/* Outlives the access if packets are still in use after it is closed */
+struct pktring
+{
+    atomic_uint refs; /**< access and slots in use */
+    int fd;
+    void *map;
+    size_t map_size;
+    unsigned count;
+    struct pktring_slot slots[];
+};
+
+struct pktring_block
+{
+    block_t self;
+    struct pktring_slot *slot;
+};
+
+typedef struct
+{
+    pktring_t *ring;
+    struct pktring_slot *slot; /**< slot being read or NULL */
+    unsigned next_slot;
+    const uint8_t *next_pkt;
+    uint32_t pkt_left;
+    vlc_tick_t stats_date;
+
+    int join_fd;
+    int family;
+    uint16_t port;
+    bool has_group;
+    bool has_source;
+    uint8_t group[16];
+    uint8_t source[16];
+} access_sys_t;
+
+static void RingRelease(pktring_t *ring)
+{
+    if (atomic_fetch_sub_explicit(&ring->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    munmap(ring->map, ring->map_size);
+    vlc_close(ring->fd);
+    free(ring);
+}
+
+static void SlotRelease(struct pktring_slot *slot)
+{
+    if (atomic_fetch_sub_explicit(&slot->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    pktring_t *ring = slot->ring;
+
+    slot->desc->hdr.bh1.block_status = TP_STATUS_KERNEL;
+    atomic_store_explicit(&slot->busy, false, memory_order_release);
+    RingRelease(ring);
+}
+
+static void PacketRelease(block_t *block)
+{
+    struct pktring_block *pb = container_of(block, struct pktring_block, self);
+
+    SlotRelease(pb->slot);
+    free(pb);
+}
+
+static const struct vlc_block_callbacks pktring_cbs =
+{
+    PacketRelease,
+};
+
+static int Control(stream_t *access, int query, va_list args)
+{
+    switch (query) {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = false;
+            break;
+
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) =
+                VLC_TICK_FROM_MS(var_InheritInteger(access, "network-caching"));
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+/**
+ * Checks that a captured IP packet is a datagram of the flow, and locates
+ * its UDP payload.
+ */
+static bool Match(const access_sys_t *sys, const uint8_t *ip,
+                  size_t *restrict offset, size_t *restrict len)
+{
+    size_t hlen;
+
+    if (sys->family == AF_INET) {
+        if (*len < 20 || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP)
+            return false;
+        hlen = 4 * (ip[0] & 0xf);
+        if (hlen < 20 || (GetWBE(ip + 6) & 0x3fff)) /* fragments */
+            return false;
+        if (sys->has_group && memcmp(ip + 16, sys->group, 4))
+            return false;
+        if (sys->has_source && memcmp(ip + 12, sys->source, 4))
+            return false;
+    } else {
+        /* Extension headers are not supported */
+        if (*len < 40 || (ip[0] >> 4) != 6 || ip[6] != IPPROTO_UDP)
+            return false;
+        hlen = 40;
+        if (sys->has_group && memcmp(ip + 24, sys->group, 16))
+            return false;
+        if (sys->has_source && memcmp(ip + 8, sys->source, 16))
+            return false;
+    }
+
+    if (*len < hlen + 8)
+        return false;
+
+    const uint8_t *udp = ip + hlen;
+    size_t ulen = GetWBE(udp + 4);
+
+    if (GetWBE(udp + 2) != sys->port || ulen < 8 || hlen + ulen > *len)
+        return false; /* other port, or truncated */
+
+    *offset = hlen + 8;
+    *len = ulen - 8;
+    return true;
+}
+
+/**
+ * Attaches a kernel filter, so that other traffic does not fill the ring.
+ * Packets are still checked by Match(), this is only an optimization.
+ */
+static void FilterAttach(stream_t *access, int fd)
+{
+    access_sys_t *sys = access->p_sys;
+    struct sock_filter code[16];
+    unsigned n = 0;
+
+#define DROP 0xff
+#define INSN(c, t, f, k) code[n++] = (struct sock_filter){ (c), (t), (f), (k) }
+    /* Offsets are relative to the network header */
+    if (sys->family == AF_INET) {
+        INSN(BPF_LD|BPF_B|BPF_ABS, 0, 0, 9);
+        INSN(BPF_JMP|BPF_JEQ|BPF_K, 0, DROP, IPPROTO_UDP);
+        INSN(BPF_LD|BPF_H|BPF_ABS, 0, 0, 6);
+        INSN(BPF_JMP|BPF_JSET|BPF_K, DROP, 0, 0x3fff);
+        if (sys->has_group) {
+            INSN(BPF_LD|BPF_W|BPF_ABS, 0, 0, 16);
+            INSN(BPF_JMP|BPF_JEQ|BPF_K, 0, DROP, GetDWBE(sys->group));
+        }
+        INSN(BPF_LDX|BPF_B|BPF_MSH, 0, 0, 0);
+        INSN(BPF_LD|BPF_H|BPF_IND, 0, 0, 2);
+    } else {
+        INSN(BPF_LD|BPF_B|BPF_ABS, 0, 0, 6);
+        INSN(BPF_JMP|BPF_JEQ|BPF_K, 0, DROP, IPPROTO_UDP);
+        if (sys->has_group)
+            for (unsigned i = 0; i < 4; i++) {
+                INSN(BPF_LD|BPF_W|BPF_ABS, 0, 0, 24 + 4 * i);
+                INSN(BPF_JMP|BPF_JEQ|BPF_K, 0, DROP,
+                     GetDWBE(sys->group + 4 * i));
+            }
+        INSN(BPF_LD|BPF_H|BPF_ABS, 0, 0, 40 + 2);
+    }
+    INSN(BPF_JMP|BPF_JEQ|BPF_K, 0, DROP, sys->port);
+    INSN(BPF_RET|BPF_K, 0, 0, UINT32_MAX);
+    INSN(BPF_RET|BPF_K, 0, 0, 0);
+#undef INSN
+
+    for (unsigned i = 0; i < n; i++) {
+        if (code[i].jt == DROP)
+            code[i].jt = n - 2 - i;
+        if (code[i].jf == DROP)
+            code[i].jf = n - 2 - i;
+    }
+#undef DROP
+
+    struct sock_fprog prog = { .len = n, .filter = code };
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof (prog)))
+        msg_Warn(access, "cannot attach packet filter: %s",
+                 vlc_strerror_c(errno));
+}
+
+static void Stats(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    vlc_tick_t now = vlc_tick_now();
+
+    if (now < sys->stats_date)
+        return;
+
+    struct tpacket_stats_v3 stats;
+    socklen_t len = sizeof (stats);
+
+    /* The counters are reset by reading them */
+    if (getsockopt(sys->ring->fd, SOL_PACKET, PACKET_STATISTICS, &stats,
+                   &len) == 0 && stats.tp_drops > 0)
+        msg_Warn(access, "%u of %u packets dropped by the ring", stats.tp_drops,
+                 stats.tp_packets);
+    sys->stats_date = now + VLC_TICK_FROM_SEC(1);
+}
+
+static block_t *Block(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    pktring_t *ring = sys->ring;
+
+    (void) eof;
+    for (;;) {
+        if (sys->pkt_left == 0) {
+            if (sys->slot != NULL) {
+                SlotRelease(sys->slot);
+                sys->slot = NULL;
+                sys->next_slot = (sys->next_slot + 1) % ring->count;
+                Stats(access);
+            }
+
+            struct pktring_slot *slot = &ring->slots[sys->next_slot];
+
+            if (atomic_load_explicit(&slot->busy, memory_order_acquire)) {
+                /* The ring wrapped around packets still in use: wait for
+                 * them to be released, nothing else can be received. */
+                if (vlc_poll_i11e(NULL, 0, 10) < 0)
+                    return NULL;
+                continue;
+            }
+
+            volatile uint32_t *status = &slot->desc->hdr.bh1.block_status;
+            if (!(*status & TP_STATUS_USER)) {
+                struct pollfd ufd[1];
+
+                ufd[0].fd = ring->fd;
+                ufd[0].events = POLLIN | POLLERR;
+
+                if (vlc_poll_i11e(ufd, 1, -1) < 0)
+                    return NULL;
+                continue;
+            }
+            atomic_thread_fence(memory_order_acquire);
+
+            atomic_store_explicit(&slot->busy, true, memory_order_relaxed);
+            atomic_init(&slot->refs, 1);
+            atomic_fetch_add_explicit(&ring->refs, 1, memory_order_relaxed);
+            sys->slot = slot;
+            sys->next_pkt = (const uint8_t *)slot->desc
+                          + slot->desc->hdr.bh1.offset_to_first_pkt;
+            sys->pkt_left = slot->desc->hdr.bh1.num_pkts;
+            continue;
+        }
+
+        const struct tpacket3_hdr *hdr = (const void *)sys->next_pkt;
+        const struct sockaddr_ll *sll = (const void *)(sys->next_pkt
+                                        + TPACKET_ALIGN(sizeof (*hdr)));
+        const uint8_t *ip = sys->next_pkt + hdr->tp_net;
+        size_t offset, len = hdr->tp_snaplen - (hdr->tp_net - hdr->tp_mac);
+
+        sys->next_pkt += hdr->tp_next_offset;
+        sys->pkt_left--;
+
+        if (sll->sll_pkttype == PACKET_OUTGOING || !Match(sys, ip, &offset, &len))
+            continue;
+
+        struct pktring_block *pb = malloc(sizeof (*pb));
+        if (unlikely(pb == NULL))
+            continue;
+
+        atomic_fetch_add_explicit(&sys->slot->refs, 1, memory_order_relaxed);
+        pb->slot = sys->slot;
+        return block_Init(&pb->self, &pktring_cbs, (uint8_t *)ip + offset, len);
+    }
+}
+
+static pktring_t *RingOpen(stream_t *access, const char *iface, unsigned blocks)
+{
+    access_sys_t *sys = access->p_sys;
+    int proto = htons(sys->family == AF_INET ? ETH_P_IP : ETH_P_IPV6);
+    unsigned ifindex = 0;
+
+    if (iface != NULL) {
+        ifindex = if_nametoindex(iface);
+        if (ifindex == 0) {
+            msg_Err(access, "unknown interface %s", iface);
+            return NULL;
+        }
+    }
+
+    /* No protocol until bound, so that nothing is captured unfiltered */
+    int fd = vlc_socket(AF_PACKET, SOCK_DGRAM, 0, false);
+    if (fd == -1) {
+        msg_Err(access, "cannot create packet socket: %s (CAP_NET_RAW is "
+                "needed)", vlc_strerror_c(errno));
+        return NULL;
+    }
+
+    int version = TPACKET_V3;
+    struct tpacket_req3 req = {
+        .tp_block_size = RING_BLOCK_SIZE,
+        .tp_block_nr = blocks,
+        .tp_frame_size = RING_FRAME_SIZE,
+        .tp_frame_nr = (RING_BLOCK_SIZE / RING_FRAME_SIZE) * blocks,
+        .tp_retire_blk_tov = RING_BLOCK_TIMEOUT,
+    };
+
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof (version))
+     || setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof (req))) {
+        msg_Err(access, "cannot set up packet ring: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    FilterAttach(access, fd);
+
+    pktring_t *ring = malloc(sizeof (*ring) + blocks * sizeof (ring->slots[0]));
+    if (unlikely(ring == NULL))
+        goto error;
+
+    ring->map_size = (size_t)RING_BLOCK_SIZE * blocks;
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_LOCKED, fd, 0);
+    if (ring->map == MAP_FAILED) /* locking may exceed RLIMIT_MEMLOCK */
+        ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    if (ring->map == MAP_FAILED) {
+        msg_Err(access, "cannot map packet ring: %s", vlc_strerror_c(errno));
+        free(ring);
+        goto error;
+    }
+
+    atomic_init(&ring->refs, 1);
+    ring->fd = fd;
+    ring->count = blocks;
+    for (unsigned i = 0; i < blocks; i++) {
+        struct pktring_slot *slot = &ring->slots[i];
+
+        slot->desc = (void *)((uint8_t *)ring->map
+                              + (size_t)i * RING_BLOCK_SIZE);
+        slot->ring = ring;
+        atomic_init(&slot->refs, 0);
+        atomic_init(&slot->busy, false);
+    }
+
+    struct sockaddr_ll addr = {
+        .sll_family = AF_PACKET,
+        .sll_protocol = proto,
+        .sll_ifindex = ifindex,
+    };
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof (addr))) {
+        msg_Err(access, "cannot bind packet socket: %s", vlc_strerror_c(errno));
+        RingRelease(ring);
+        return NULL;
+    }
+
+    msg_Dbg(access, "capturing on %s with a %u MiB ring",
+            iface != NULL ? iface : "all interfaces",
+            (unsigned)(ring->map_size >> 20));
+    return ring;
+
+error:
+    vlc_close(fd);
+    return NULL;
+}
+
+/* Numeric address to filter on, or NULL/empty for any */
+static int ParseAddress(stream_t *access, const char *str, int *family,
+                        uint8_t *addr, bool *restrict has)
+{
+    *has = false;
+    if (str == NULL || *str == '\0')
+        return VLC_SUCCESS;
+
+    char buf[INET6_ADDRSTRLEN + 2];
+    size_t len = strlen(str);
+
+    if (str[0] == '[' && len >= 2 && len - 2 < sizeof (buf)) {
+        memcpy(buf, str + 1, len - 2); /* bracket'd IPv6 address */
+        buf[len - 2] = '\0';
+        str = buf;
+    }
+
+    if (inet_pton(AF_INET, str, addr) == 1)
+        *family = AF_INET;
+    else if (inet_pton(AF_INET6, str, addr) == 1)
+        *family = AF_INET6;
+    else {
+        msg_Err(access, "invalid address %s (only numerical addresses are "
+                "supported)", str);
+        return VLC_EGENERIC;
+    }
+    *has = true;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *);
+
+/*****************************************************************************
+ * Open: join the group and map the capture ring
+ *****************************************************************************/
+static int Open(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+
+    if (access->b_preparsing)
+        return VLC_EGENERIC;
+
+    access_sys_t *sys = vlc_obj_calloc(obj, 1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    access->p_sys = sys;
+
+    char *psz_name = strdup(access->psz_location);
+    char *psz_parser;
+    const char *psz_server_addr, *psz_bind_addr = "";
+    int  i_bind_port = 1234, i_server_port = 0;
+
+    if (unlikely(psz_name == NULL))
+        return VLC_ENOMEM;
+
+    /* Same syntax as the UDP input:
+     * [serveraddr[:serverport]][@[bindaddr]:[bindport]] */
+    psz_parser = strchr(psz_name, '@');
+    if (psz_parser != NULL) {
+        *psz_parser++ = '\0';
+        psz_bind_addr = psz_parser;
+
+        if (psz_bind_addr[0] == '[')
+            psz_parser = strchr(psz_parser, ']');
+
+        if (psz_parser != NULL) {
+            psz_parser = strchr(psz_parser, ':');
+            if (psz_parser != NULL) {
+                *psz_parser++ = '\0';
+                i_bind_port = atoi(psz_parser);
+            }
+        }
+    }
+
+    psz_server_addr = psz_name;
+    psz_parser = (psz_server_addr[0] == '[') ? strchr(psz_name, ']')
+                                              : psz_name;
+    if (psz_parser != NULL) {
+        psz_parser = strchr(psz_parser, ':');
+        if (psz_parser != NULL) {
+            *psz_parser++ = '\0';
+            i_server_port = atoi(psz_parser);
+        }
+    }
+
+    int source_family = AF_INET;
+
+    sys->family = AF_INET;
+    sys->port = i_bind_port;
+    sys->join_fd = -1;
+    if (ParseAddress(access, psz_bind_addr, &sys->family, sys->group,
+                     &sys->has_group)
+     || ParseAddress(access, psz_server_addr, &source_family, sys->source,
+                     &sys->has_source))
+        goto error;
+    if (sys->has_group && sys->has_source && source_family != sys->family) {
+        msg_Err(access, "mismatched address families");
+        goto error;
+    }
+    if (!sys->has_group && sys->has_source)
+        sys->family = source_family;
+
+    /* Joins the group (if multicast). The socket is never read, so keep
+     * as little as possible queued on it. */
+    sys->join_fd = net_OpenDgram(access, psz_bind_addr, i_bind_port,
+                                 psz_server_addr, i_server_port, IPPROTO_UDP);
+    if (sys->join_fd == -1) {
+        msg_Err(access, "cannot open socket");
+        goto error;
+    }
+    setsockopt(sys->join_fd, SOL_SOCKET, SO_RCVBUF, &(int){ 1 }, sizeof (int));
+
+    char *iface = var_InheritString(access, "pktring-iface");
+    unsigned blocks = var_InheritInteger(access, "pktring-size");
+
+    sys->ring = RingOpen(access, iface, blocks);
+    free(iface);
+    if (sys->ring == NULL)
+        goto error;
+    free(psz_name);
+
+    access->pf_read = NULL;
+    access->pf_block = Block;
+    access->pf_control = Control;
+    access->pf_seek = NULL;
+    return VLC_SUCCESS;
+
+error:
+    free(psz_name);
+    Close(obj);
+    return VLC_EGENERIC;
+}
+
+/*****************************************************************************
+ * Close: release the ring (once its packets are released)
+ *****************************************************************************/
+static void Close(vlc_object_t *obj)
+{
+    stream_t *access = (stream_t *)obj;
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->slot != NULL)
+        SlotRelease(sys->slot);
+    if (sys->ring != NULL)
+        RingRelease(sys->ring);
+    if (sys->join_fd != -1)
+        net_Close(sys->join_fd);
+}
+
+#define IFACE_TEXT N_("Capture interface")
+#define IFACE_LONGTEXT N_("Network interface to capture the packets on. " \
+    "By default, packets are captured on all interfaces.")
+#define SIZE_TEXT N_("Capture ring size (MiB)")
+#define SIZE_LONGTEXT N_("Memory shared with the kernel to store the " \
+    "captured packets. Larger rings absorb longer stalls of the decoding " \
+    "chain without dropping packets.")
+
+vlc_module_begin()
+    set_shortname(N_("Packet ring"))
+    set_description(N_("UDP input through a packet capture ring"))
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_ACCESS)
+
+    add_string("pktring-iface", NULL, IFACE_TEXT, IFACE_LONGTEXT, true)
+    add_integer_with_range("pktring-size", 64, 4, 1024, SIZE_TEXT,
+                           SIZE_LONGTEXT, true)
+
+    set_capability("access", 0)
+    add_shortcut("pktring")
+
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -60,6 +60,12 @@
 #define NACK_INTERVAL 5 /*ms*/
 /* Calculate and print stats once per second */
 #define STATS_INTERVAL 1000 /*ms*/
+/* The max number of bonded links */
+#define RIST_MAX_LINKS 4
+/* The number of SMPTE 2022-1 FEC packets kept for recovery */
+#define RIST_FEC_QUEUE 64
+/* The SMPTE 2022-1 FEC header size */
+#define FEC_HEADER_SIZE 16
 
 static const int nack_type[] = {
     0, 1,
@@ -74,10 +80,54 @@ enum NACK_TYPE {
     NACK_FMT_BITMASK
 };
 
+static const int bonding_mode[] = {
+    0, 1,
+};
+
+static const char *const bonding_mode_names[] = {
+    N_("Redundant"), N_("Load balanced"),
+};
+
+enum BONDING_MODE {
+    BONDING_REDUNDANT = 0, /* every link carries every packet */
+    BONDING_BALANCED /* packets are spread over the links */
+};
+
+/* A path from the sender, with its own sockets and peer */
+struct rist_link
+{
+    int              fd_in;
+    int              fd_nack;
+    int              fd_rtcp_m;
+    int              fd_fec[2]; /* column and row FEC */
+    bool             b_ismulticast;
+    bool             b_sendnacks;
+    char             cname[MAX_CNAME];
+    char             sender_name[MAX_CNAME];
+    struct sockaddr_storage peer_sockaddr;
+    socklen_t        peer_socklen;
+};
+
+/* A SMPTE 2022-1 FEC packet, protecting na packets offset apart */
+struct rist_fec
+{
+    block_t          *buffer;
+    uint16_t         snbase;
+    uint8_t          offset;
+    uint8_t          na;
+    bool             b_row;
+};
+
 typedef struct
 {
     struct rist_flow *flow;
-    char             sender_name[MAX_CNAME];
+    struct rist_link links[RIST_MAX_LINKS];
+    int              i_links;
+    int              i_nack_link; /* next link for balanced NACKs */
+    enum BONDING_MODE bonding;
+    bool             b_fec;
+    struct rist_fec  fec[RIST_FEC_QUEUE];
+    unsigned         i_fec_next;
     enum NACK_TYPE   nack_type;
     uint64_t         last_data_rx;
     uint64_t         last_nack_tx;
@@ -85,8 +135,6 @@ typedef struct
     int              i_max_packet_size;
     int              i_poll_timeout;
     int              i_poll_timeout_current;
-    bool             b_ismulticast;
-    bool             b_sendnacks;
     bool             b_sendblindnacks;
     bool             b_disablenacks;
     bool             b_flag_discontinuity;
@@ -98,6 +146,8 @@ typedef struct
     uint32_t         i_poll_timeout_zero_count;
     uint32_t         i_poll_timeout_nonzero_count;
     uint64_t         i_last_stat;
+    uint32_t         i_duplicate_packets;
+    uint32_t         i_fec_packets;
     float            vbr_ratio;
     uint16_t         vbr_ratio_count;
     uint32_t         i_lost_packets;
@@ -159,63 +209,84 @@ static void rist_WriteTo_i11e_Locked(vlc_mutex_t lock, int fd, const void *buf,
     vlc_mutex_unlock( &lock );
 }
 
-static struct rist_flow *rist_udp_receiver(stream_t *p_access, vlc_url_t *parsed_url, bool b_ismulticast)
+static void rist_link_close(struct rist_link *link)
+{
+    if (link->fd_in != -1)
+        net_Close(link->fd_in);
+    if (link->fd_nack != -1)
+        net_Close(link->fd_nack);
+    if (link->fd_rtcp_m != -1)
+        net_Close(link->fd_rtcp_m);
+    for (int i = 0; i < 2; i++)
+        if (link->fd_fec[i] != -1)
+            net_Close(link->fd_fec[i]);
+}
+
+static int rist_udp_receiver(stream_t *p_access, struct rist_link *link,
+                             char *psz_host, int i_port)
 {
     stream_sys_t *p_sys = p_access->p_sys;
     msg_Info( p_access, "Opening Rist Flow Receiver at %s:%d and %s:%d",
-             parsed_url->psz_host, parsed_url->i_port,
-             parsed_url->psz_host, parsed_url->i_port+1);
+             psz_host, i_port, psz_host, i_port+1);
 
-    p_sys->flow = rist_init_rx();
-    if (!p_sys->flow)
-        return NULL;
+    link->fd_in = link->fd_nack = link->fd_rtcp_m = -1;
+    link->fd_fec[0] = link->fd_fec[1] = -1;
+    link->b_ismulticast = is_multicast_address(psz_host);
 
-    p_sys->flow->fd_in = net_OpenDgram(p_access, parsed_url->psz_host, parsed_url->i_port, NULL,
+    link->fd_in = net_OpenDgram(p_access, psz_host, i_port, NULL,
                 0, IPPROTO_UDP);
-    if (p_sys->flow->fd_in < 0)
+    if (link->fd_in < 0)
     {
         msg_Err( p_access, "cannot open input socket" );
         goto fail;
     }
 
-    if (b_ismulticast)
+    if (link->b_ismulticast)
     {
-        p_sys->flow->fd_rtcp_m = net_OpenDgram(p_access, parsed_url->psz_host, parsed_url->i_port + 1,
+        link->fd_rtcp_m = net_OpenDgram(p_access, psz_host, i_port + 1,
             NULL, 0, IPPROTO_UDP);
-        if (p_sys->flow->fd_rtcp_m < 0)
+        if (link->fd_rtcp_m < 0)
         {
             msg_Err( p_access, "cannot open multicast nack socket" );
             goto fail;
         }
-        p_sys->flow->fd_nack = net_ConnectDgram(p_access, parsed_url->psz_host,
-            parsed_url->i_port + 1, -1, IPPROTO_UDP );
+        link->fd_nack = net_ConnectDgram(p_access, psz_host,
+            i_port + 1, -1, IPPROTO_UDP );
     }
     else
     {
-        p_sys->flow->fd_nack = net_OpenDgram(p_access, parsed_url->psz_host, parsed_url->i_port + 1,
+        link->fd_nack = net_OpenDgram(p_access, psz_host, i_port + 1,
             NULL, 0, IPPROTO_UDP);
     }
-    if (p_sys->flow->fd_nack < 0)
+    if (link->fd_nack < 0)
     {
         msg_Err( p_access, "cannot open nack socket" );
         goto fail;
     }
 
-    populate_cname(p_sys->flow->fd_nack, p_sys->flow->cname);
-    msg_Info(p_access, "our cname is %s", p_sys->flow->cname);
+    if (p_sys->b_fec)
+    {
+        /* SMPTE 2022-1: column FEC on port + 2, row FEC on port + 4 */
+        for (int i = 0; i < 2; i++)
+        {
+            link->fd_fec[i] = net_OpenDgram(p_access, psz_host, i_port + 2 + 2 * i,
+                NULL, 0, IPPROTO_UDP);
+            if (link->fd_fec[i] < 0)
+            {
+                msg_Err( p_access, "cannot open %s FEC socket", i ? "row" : "column" );
+                goto fail;
+            }
+        }
+    }
+
+    populate_cname(link->fd_nack, link->cname);
+    msg_Info(p_access, "our cname is %s", link->cname);
 
-    return  p_sys->flow;
+    return VLC_SUCCESS;
 
 fail:
-    if (p_sys->flow->fd_in != -1)
-        vlc_close(p_sys->flow->fd_in);
-    if (p_sys->flow->fd_nack != -1)
-        vlc_close(p_sys->flow->fd_nack);
-    if (p_sys->flow->fd_rtcp_m != -1)
-        vlc_close(p_sys->flow->fd_rtcp_m);
-    free(p_sys->flow->buffer);
-    free(p_sys->flow);
-    return NULL;
+    rist_link_close(link);
+    return VLC_EGENERIC;
 }
 
 static int is_index_in_range(struct rist_flow *flow, uint16_t idx)
@@ -227,10 +298,10 @@ static int is_index_in_range(struct rist_flow *flow, uint16_t idx)
     }
 }
 
-static void send_rtcp_feedback(stream_t *p_access, struct rist_flow *flow)
+static void send_rtcp_feedback(stream_t *p_access, struct rist_link *link)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    int namelen = strlen(flow->cname) + 1;
+    int namelen = strlen(link->cname) + 1;
 
     /* we need to make sure it is a multiple of 4, pad if necessary */
     if ((namelen - 2) & 0x3)
@@ -255,21 +326,20 @@ static void send_rtcp_feedback(stream_t *p_access, struct rist_flow *flow)
     rtcp_sdes_set_pt(p_sdes);
     rtcp_set_length(p_sdes, (namelen >> 2) + 2);
     rtcp_sdes_set_cname(p_sdes, 1);
-    rtcp_sdes_set_name_length(p_sdes, strlen(flow->cname));
+    rtcp_sdes_set_name_length(p_sdes, strlen(link->cname));
     uint8_t *p_sdes_name = (buf + RTCP_EMPTY_RR_SIZE + RTCP_SDES_SIZE);
-    strlcpy((char *)p_sdes_name, flow->cname, namelen);
+    strlcpy((char *)p_sdes_name, link->cname, namelen);
 
     /* Write to Socket */
-    rist_WriteTo_i11e_Locked(p_sys->lock, flow->fd_nack, buf, rtcp_feedback_size,
-        (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
+    rist_WriteTo_i11e_Locked(p_sys->lock, link->fd_nack, buf, rtcp_feedback_size,
+        (struct sockaddr *)&link->peer_sockaddr, link->peer_socklen);
     free(buf);
     buf = NULL;
 }
 
-static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uint16_t nack_count)
+static void send_bbnack(stream_t *p_access, struct rist_link *link, block_t *pkt_nacks, uint16_t nack_count)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    struct rist_flow *flow = p_sys->flow;
     int len = 0;
 
     int bbnack_bufsize = RTCP_FB_HEADER_SIZE +
@@ -298,17 +368,15 @@ static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
 
     /* Write to Socket */
-    if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
-        rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
-            (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
+    rist_WriteTo_i11e_Locked(p_sys->lock, link->fd_nack, buf, len,
+        (struct sockaddr *)&link->peer_sockaddr, link->peer_socklen);
     free(buf);
     buf = NULL;
 }
 
-static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uint16_t nack_count)
+static void send_rbnack(stream_t *p_access, struct rist_link *link, block_t *pkt_nacks, uint16_t nack_count)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    struct rist_flow *flow = p_sys->flow;
     int len = 0;
 
     int rbnack_bufsize = RTCP_FB_HEADER_SIZE +
@@ -338,9 +406,8 @@ static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
 
     /* Write to Socket */
-    if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
-        rist_WriteTo_i11e_Locked(p_sys->lock, fd_nack, buf, len,
-            (struct sockaddr *)&flow->peer_sockaddr, flow->peer_socklen);
+    rist_WriteTo_i11e_Locked(p_sys->lock, link->fd_nack, buf, len,
+        (struct sockaddr *)&link->peer_sockaddr, link->peer_socklen);
     free(buf);
     buf = NULL;
 }
@@ -474,8 +541,8 @@ static void print_sockaddr_info(stream_t *p_access, struct sockaddr *x)
     }
 }
 
-static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_in, size_t len,
-    struct sockaddr *peer, socklen_t slen)
+static void rtcp_input(stream_t *p_access, struct rist_flow *flow, struct rist_link *link,
+    uint8_t *buf_in, size_t len, struct sockaddr *peer, socklen_t slen)
 {
     stream_sys_t *p_sys = p_access->p_sys;
     uint8_t  ptype;
@@ -523,9 +590,9 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
 
             case RTCP_PT_SDES:
                 {
-                    if (p_sys->b_sendnacks == false)
-                        p_sys->b_sendnacks = true;
-                    if (p_sys->b_ismulticast)
+                    if (link->b_sendnacks == false)
+                        link->b_sendnacks = true;
+                    if (link->b_ismulticast)
                         return;
                     /* Check for changes in source IP address or port */
                     int8_t name_length = rtcp_sdes_get_name_length(buf);
@@ -538,17 +605,17 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
                         return;
                     }
                     bool ip_port_changed = false;
-                    if (sockaddr_cmp((struct sockaddr *)&flow->peer_sockaddr, peer) != 0)
+                    if (sockaddr_cmp((struct sockaddr *)&link->peer_sockaddr, peer) != 0)
                     {
                         ip_port_changed = true;
-                        if(flow->peer_socklen > 0)
+                        if(link->peer_socklen > 0)
                             print_sockaddr_info_change(p_access,
-                                (struct sockaddr *)&flow->peer_sockaddr, peer);
+                                (struct sockaddr *)&link->peer_sockaddr, peer);
                         else
                             print_sockaddr_info(p_access, peer);
                         vlc_mutex_lock( &p_sys->lock );
-                        memcpy(&flow->peer_sockaddr, peer, sizeof(struct sockaddr_storage));
-                        flow->peer_socklen = slen;
+                        memcpy(&link->peer_sockaddr, peer, sizeof(struct sockaddr_storage));
+                        link->peer_socklen = slen;
                         vlc_mutex_unlock( &p_sys->lock );
                     }
 
@@ -556,16 +623,16 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
                     bool peer_name_changed = false;
                     memset(new_sender_name, 0, MAX_CNAME);
                     memcpy(new_sender_name, buf + RTCP_SDES_SIZE, name_length);
-                    if (memcmp(new_sender_name, p_sys->sender_name, name_length) != 0)
+                    if (memcmp(new_sender_name, link->sender_name, name_length) != 0)
                     {
                         peer_name_changed = true;
-                        if (strcmp(p_sys->sender_name, "") == 0)
+                        if (strcmp(link->sender_name, "") == 0)
                             msg_Info(p_access, "Peer Name: %s", new_sender_name);
                         else
                             msg_Info(p_access, "Peer Name change detected: old Name: %s, new " \
-                                "Name: %s", p_sys->sender_name, new_sender_name);
-                        memset(p_sys->sender_name, 0, MAX_CNAME);
-                        memcpy(p_sys->sender_name, buf + RTCP_SDES_SIZE, name_length);
+                                "Name: %s", link->sender_name, new_sender_name);
+                        memset(link->sender_name, 0, MAX_CNAME);
+                        memcpy(link->sender_name, buf + RTCP_SDES_SIZE, name_length);
                     }
 
                     /* Reset the buffer as the source must have been restarted */
@@ -578,9 +645,9 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
                 break;
 
             case RTCP_PT_SR:
-                if (p_sys->b_sendnacks == false)
-                    p_sys->b_sendnacks = true;
-                if (p_sys->b_ismulticast)
+                if (link->b_sendnacks == false)
+                    link->b_sendnacks = true;
+                if (link->b_ismulticast)
                         return;
                 break;
 
@@ -591,6 +658,35 @@ static void rtcp_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf_
     }
 }
 
+static void rist_store(stream_t *p_access, struct rist_flow *flow, uint16_t idx,
+    block_t *block, uint32_t pkt_ts)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+
+    /* Always replace the existing one with the new one */
+    struct rtp_pkt *pkt;
+    pkt = &(flow->buffer[idx]);
+    if (pkt->buffer)
+        block_Release(pkt->buffer);
+    pkt->buffer = block;
+    pkt->rtp_ts = pkt_ts;
+    p_sys->last_data_rx = vlc_tick_now();
+    /* Reset the try counter regardless of wether it was a retransmit or not */
+    flow->nacks_retries[idx] = 0;
+}
+
+static void fec_flush(stream_sys_t *p_sys)
+{
+    for (int i = 0; i < RIST_FEC_QUEUE; i++)
+    {
+        if (p_sys->fec[i].buffer)
+        {
+            block_Release(p_sys->fec[i].buffer);
+            p_sys->fec[i].buffer = NULL;
+        }
+    }
+}
+
 static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf, size_t len)
 {
     stream_sys_t *p_sys = p_access->p_sys;
@@ -624,6 +720,23 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
         flow->ri = idx;
         flow->reset = 0;
         p_sys->b_flag_discontinuity = true;
+        fec_flush(p_sys);
+    }
+    else if (is_index_in_range(flow, idx))
+    {
+        if (flow->buffer[idx].buffer != NULL && flow->buffer[idx].rtp_ts == pkt_ts)
+        {
+            /* Already received, typically over another bonded link */
+            p_sys->i_duplicate_packets++;
+            return false;
+        }
+    }
+    else if ((uint16_t)(flow->ri - idx) < RIST_QUEUE_SIZE / 2 &&
+        (uint32_t)(flow->hi_timestamp - pkt_ts) <= 2 * flow->rtp_latency)
+    {
+        /* Already delivered or given up on, e.g. received over a slower link */
+        p_sys->i_duplicate_packets++;
+        return false;
     }
 
     /* Check to see if this is a retransmission or a regular packet */
@@ -658,24 +771,11 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
         }
     }
 
-    /* Always replace the existing one with the new one */
-    struct rtp_pkt *pkt;
-    pkt = &(flow->buffer[idx]);
-    if (pkt->buffer && pkt->buffer->i_buffer > 0)
-    {
-        block_Release(pkt->buffer);
-        pkt->buffer = NULL;
-    }
-    pkt->buffer = block_Alloc(len);
-    if (!pkt->buffer)
+    block_t *block = block_Alloc(len);
+    if (!block)
         return false;
-
-    pkt->buffer->i_buffer = len;
-    memcpy(pkt->buffer->p_buffer, buf, len);
-    pkt->rtp_ts = pkt_ts;
-    p_sys->last_data_rx = vlc_tick_now();
-    /* Reset the try counter regardless of wether it was a retransmit or not */
-    flow->nacks_retries[idx] = 0;
+    memcpy(block->p_buffer, buf, len);
+    rist_store(p_access, flow, idx, block, pkt_ts);
 
     if (retrasnmitted)
         return success;
@@ -709,6 +809,163 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
     return success;
 }
 
+static void fec_input(stream_t *p_access, uint8_t *buf, size_t len)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+
+    if (len < RTP_HEADER_SIZE + FEC_HEADER_SIZE || !rtp_check_hdr(buf))
+    {
+        msg_Err(p_access, "Malformed FEC packet of %zu bytes, ignoring.", len);
+        return;
+    }
+
+    /* SNBase low bits, length recovery, E/PT recovery/mask, TS recovery,
+     * N/D/type/index, offset, NA, SNBase ext bits */
+    const uint8_t *hdr = buf + RTP_HEADER_SIZE;
+    uint16_t snbase = GetWBE(hdr);
+    bool b_row = (hdr[12] & 0x40) != 0;
+    uint8_t offset = hdr[13];
+    uint8_t na = hdr[14];
+    if (offset == 0 || na == 0)
+    {
+        msg_Err(p_access, "Invalid FEC packet (offset %u, NA %u), ignoring.", offset, na);
+        return;
+    }
+
+    for (int i = 0; i < RIST_FEC_QUEUE; i++)
+    {
+        struct rist_fec *fec = &p_sys->fec[i];
+        /* Bonded links deliver the same FEC packets */
+        if (fec->buffer && fec->snbase == snbase && fec->b_row == b_row)
+            return;
+    }
+
+    struct rist_fec *fec = &p_sys->fec[p_sys->i_fec_next++ % RIST_FEC_QUEUE];
+    if (fec->buffer)
+        block_Release(fec->buffer);
+    fec->buffer = block_Alloc(len);
+    if (!fec->buffer)
+        return;
+    memcpy(fec->buffer->p_buffer, buf, len);
+    fec->snbase = snbase;
+    fec->offset = offset;
+    fec->na = na;
+    fec->b_row = b_row;
+}
+
+/* Returns whether the FEC packet is of no further use. It recovers the
+ * protected packet if it is the only one missing. */
+static bool fec_process(stream_t *p_access, struct rist_flow *flow,
+    const struct rist_fec *fec, bool *recovered)
+{
+    const block_t *known = NULL;
+    unsigned missing = fec->na;
+    uint16_t missing_idx = 0;
+
+    *recovered = false;
+    for (unsigned i = 0; i < fec->na; i++)
+    {
+        uint16_t idx = fec->snbase + i * fec->offset;
+        if (!is_index_in_range(flow, idx))
+            /* Expired if already delivered, otherwise not received yet */
+            return (uint16_t)(flow->ri - idx) < RIST_QUEUE_SIZE / 2;
+
+        if (flow->buffer[idx].buffer == NULL)
+        {
+            if (missing != fec->na)
+                return false; /* at least two missing, maybe later */
+            missing = i;
+            missing_idx = idx;
+        }
+        else if (known == NULL)
+            known = flow->buffer[idx].buffer;
+    }
+    if (missing == fec->na)
+        return true;
+
+    /* XOR the FEC payload and recovery fields with the received packets */
+    const uint8_t *hdr = fec->buffer->p_buffer + RTP_HEADER_SIZE;
+    size_t size = fec->buffer->i_buffer - RTP_HEADER_SIZE - FEC_HEADER_SIZE;
+    uint16_t length = GetWBE(hdr + 2);
+    uint8_t ptype = hdr[4] & 0x7f;
+    uint32_t ts = GetDWBE(hdr + 8);
+
+    block_t *block = block_Alloc(RTP_HEADER_SIZE + size);
+    if (!block)
+        return false;
+    uint8_t *payload = block->p_buffer + RTP_HEADER_SIZE;
+    memcpy(payload, hdr + FEC_HEADER_SIZE, size);
+
+    for (unsigned i = 0; i < fec->na; i++)
+    {
+        if (i == missing)
+            continue;
+        const block_t *pkt = flow->buffer[(uint16_t)(fec->snbase + i * fec->offset)].buffer;
+        size_t pkt_len = pkt->i_buffer - RTP_HEADER_SIZE;
+        length ^= pkt_len;
+        ptype ^= rtp_get_type(pkt->p_buffer);
+        ts ^= rtp_get_timestamp(pkt->p_buffer);
+        for (size_t j = 0; j < __MIN(pkt_len, size); j++)
+            payload[j] ^= pkt->p_buffer[RTP_HEADER_SIZE + j];
+    }
+    if (length > size)
+    {
+        msg_Err(p_access, "FEC recovery of packet %u failed, inconsistent length %u",
+            missing_idx, length);
+        block_Release(block);
+        return true;
+    }
+
+    uint8_t *rtp = block->p_buffer;
+    rtp_set_hdr(rtp);
+    rtp_set_type(rtp, ptype);
+    rtp_set_seqnum(rtp, missing_idx);
+    rtp_set_timestamp(rtp, ts);
+    if (known)
+        memcpy(rtp + 8, known->p_buffer + 8, 4);
+    else
+        memset(rtp + 8, 0, 4);
+    rtp[11] &= ~(1 << 0); /* not a retransmission */
+    block->i_buffer = RTP_HEADER_SIZE + length;
+
+    rist_store(p_access, flow, missing_idx, block, ts);
+    *recovered = true;
+    return true;
+}
+
+static void fec_recover(stream_t *p_access, struct rist_flow *flow)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+    bool progress = true;
+
+    if (flow->reset > 0 || flow->ri == flow->wi)
+        return;
+
+    /* A recovered packet can complete another row or column */
+    while (progress)
+    {
+        progress = false;
+        for (int i = 0; i < RIST_FEC_QUEUE; i++)
+        {
+            struct rist_fec *fec = &p_sys->fec[i];
+            bool recovered;
+
+            if (fec->buffer == NULL || !fec_process(p_access, flow, fec, &recovered))
+                continue;
+            if (recovered)
+            {
+                msg_Dbg(p_access, "Packet RECOVERED by %s FEC, Window: [%d:%d-->%d]",
+                    fec->b_row ? "row" : "column", flow->ri, flow->wi,
+                    (uint16_t)(flow->wi-flow->ri));
+                p_sys->i_fec_packets++;
+                progress = true;
+            }
+            block_Release(fec->buffer);
+            fec->buffer = NULL;
+        }
+    }
+}
+
 static block_t *rist_dequeue(stream_t *p_access, struct rist_flow *flow)
 {
     stream_sys_t *p_sys = p_access->p_sys;
@@ -784,13 +1041,33 @@ static void *rist_thread(void *data)
 
         /* there are two bytes per nack */
         uint16_t nack_count = (uint16_t)pkt_nacks->i_buffer/2;
-        switch(p_sys->nack_type) {
-            case NACK_FMT_BITMASK:
-                send_bbnack(p_access, p_sys->flow->fd_nack, pkt_nacks, nack_count);
-                break;
 
-            default:
-                send_rbnack(p_access, p_sys->flow->fd_nack, pkt_nacks, nack_count);
+        /* Redundant links may all have lost the packet: ask on each of them.
+         * Balanced links share the load, so take turns. */
+        for (int i = 0; i < p_sys->i_links && p_sys->b_disablenacks == false; i++)
+        {
+            struct rist_link *link;
+            if (p_sys->bonding == BONDING_BALANCED)
+                link = &p_sys->links[(p_sys->i_nack_link + i) % p_sys->i_links];
+            else
+                link = &p_sys->links[i];
+            if (!link->b_sendnacks)
+                continue;
+
+            switch(p_sys->nack_type) {
+                case NACK_FMT_BITMASK:
+                    send_bbnack(p_access, link, pkt_nacks, nack_count);
+                    break;
+
+                default:
+                    send_rbnack(p_access, link, pkt_nacks, nack_count);
+            }
+
+            if (p_sys->bonding == BONDING_BALANCED)
+            {
+                p_sys->i_nack_link = (link - p_sys->links + 1) % p_sys->i_links;
+                break;
+            }
         }
 
         if (nack_count > 1)
@@ -803,13 +1080,22 @@ static void *rist_thread(void *data)
     return NULL;
 }
 
+enum {
+    RIST_SOCKET_DATA,
+    RIST_SOCKET_RTCP,
+    RIST_SOCKET_RTCP_M,
+    RIST_SOCKET_FEC,
+};
+
 static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
 {
     stream_sys_t *p_sys = p_access->p_sys;
     uint64_t now;
     *eof = false;
     block_t *pktout = NULL;
-    struct pollfd pfd[3];
+    struct pollfd pfd[RIST_MAX_LINKS * 5];
+    struct rist_link *pfd_link[RIST_MAX_LINKS * 5];
+    int pfd_type[RIST_MAX_LINKS * 5];
     int ret;
     ssize_t r;
     struct sockaddr_storage peer;
@@ -822,16 +1108,25 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
         return NULL;
     }
 
-    int poll_sockets = 2;
-    pfd[0].fd = flow->fd_in;
-    pfd[0].events = POLLIN;
-    pfd[1].fd = flow->fd_nack;
-    pfd[1].events = POLLIN;
-    if (p_sys->b_ismulticast)
+    int poll_sockets = 0;
+    for (int i = 0; i < p_sys->i_links; i++)
     {
-        pfd[2].fd = flow->fd_rtcp_m;
-        pfd[2].events = POLLIN;
-        poll_sockets++;
+        struct rist_link *link = &p_sys->links[i];
+        int fds[5] = { link->fd_nack, link->fd_rtcp_m, link->fd_in,
+                       link->fd_fec[0], link->fd_fec[1] };
+        int types[5] = { RIST_SOCKET_RTCP, RIST_SOCKET_RTCP_M, RIST_SOCKET_DATA,
+                         RIST_SOCKET_FEC, RIST_SOCKET_FEC };
+
+        for (int j = 0; j < 5; j++)
+        {
+            if (fds[j] == -1)
+                continue;
+            pfd[poll_sockets].fd = fds[j];
+            pfd[poll_sockets].events = POLLIN;
+            pfd_link[poll_sockets] = link;
+            pfd_type[poll_sockets] = types[j];
+            poll_sockets++;
+        }
     }
 
     /* The protocol uses a fifo buffer with a fixed time delay.
@@ -864,54 +1159,61 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
         uint8_t *buf = malloc(p_sys->i_max_packet_size);
         if ( unlikely( buf == NULL ) )
             return NULL;
+        bool b_queued = false;
 
-        /* Process rctp incoming data */
-        if (pfd[1].revents & POLLIN)
-        {
-            r = rist_ReadFrom_i11e(flow->fd_nack, buf, p_sys->i_max_packet_size,
-                (struct sockaddr *)&peer, &slen);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "socket %d error: %s\n", flow->fd_nack, gai_strerror(errno));
-            }
-            else {
-                if (p_sys->b_ismulticast == false)
-                    rtcp_input(p_access, flow, buf, r, (struct sockaddr *)&peer, slen);
-            }
-        }
-        if (p_sys->b_ismulticast && pfd[2].revents & POLLIN)
+        for (int i = 0; i < poll_sockets; i++)
         {
-            r = rist_ReadFrom_i11e(flow->fd_rtcp_m, buf, p_sys->i_max_packet_size,
-                (struct sockaddr *)&peer, &slen);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "mcast socket %d error: %s\n",flow->fd_rtcp_m, gai_strerror(errno));
-            }
-            else {
-                rtcp_input(p_access, flow, buf, r, (struct sockaddr *)&peer, slen);
+            if (!(pfd[i].revents & POLLIN))
+                continue;
+
+            struct rist_link *link = pfd_link[i];
+            switch (pfd_type[i])
+            {
+                /* Process rctp incoming data */
+                case RIST_SOCKET_RTCP:
+                case RIST_SOCKET_RTCP_M:
+                    slen = sizeof(struct sockaddr_storage);
+                    r = rist_ReadFrom_i11e(pfd[i].fd, buf, p_sys->i_max_packet_size,
+                        (struct sockaddr *)&peer, &slen);
+                    if (unlikely(r == -1)) {
+                        msg_Err(p_access, "socket %d error: %s\n", pfd[i].fd, gai_strerror(errno));
+                    }
+                    else if (pfd_type[i] == RIST_SOCKET_RTCP_M || link->b_ismulticast == false)
+                        rtcp_input(p_access, flow, link, buf, r, (struct sockaddr *)&peer, slen);
+                    break;
+
+                /* Process regular incoming data */
+                case RIST_SOCKET_DATA:
+                    r = rist_Read_i11e(pfd[i].fd, buf, p_sys->i_max_packet_size);
+                    if (unlikely(r == -1)) {
+                        msg_Err(p_access, "socket %d error: %s\n", pfd[i].fd, gai_strerror(errno));
+                    }
+                    /* rist_input will process and queue the pkt */
+                    else if (rist_input(p_access, flow, buf, r))
+                        b_queued = true;
+                    break;
+
+                case RIST_SOCKET_FEC:
+                    r = rist_Read_i11e(pfd[i].fd, buf, p_sys->i_max_packet_size);
+                    if (unlikely(r == -1)) {
+                        msg_Err(p_access, "socket %d error: %s\n", pfd[i].fd, gai_strerror(errno));
+                    }
+                    else
+                        fec_input(p_access, buf, r);
+                    break;
             }
         }
 
-        /* Process regular incoming data */
-        if (pfd[0].revents & POLLIN)
+        if (b_queued)
         {
-            r = rist_Read_i11e(flow->fd_in, buf, p_sys->i_max_packet_size);
-            if (unlikely(r == -1)) {
-                msg_Err(p_access, "socket %d error: %s\n", flow->fd_in, gai_strerror(errno));
-            }
-            else
-            {
-                /* rist_input will process and queue the pkt */
-                if (rist_input(p_access, flow, buf, r))
-                {
-                    /* Check the queue for the next packet that needs to be delivered */
-                    pktout = rist_dequeue(p_access, flow);
-                    if (pktout) {
-                        p_sys->i_poll_timeout_current = 0;
-                        p_sys->i_poll_timeout_zero_count++;
-                    } else {
-                        p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
-                        p_sys->i_poll_timeout_nonzero_count++;
-                    }
-                }
+            /* Check the queue for the next packet that needs to be delivered */
+            pktout = rist_dequeue(p_access, flow);
+            if (pktout) {
+                p_sys->i_poll_timeout_current = 0;
+                p_sys->i_poll_timeout_zero_count++;
+            } else {
+                p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
+                p_sys->i_poll_timeout_nonzero_count++;
             }
         }
 
@@ -953,11 +1255,12 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
         float quality = 100;
         if (p_sys->i_total_packets > 0)
             quality -= (float)100*(float)(p_sys->i_lost_packets + p_sys->i_recovered_packets +
-                p_sys->i_reordered_packets)/(float)p_sys->i_total_packets;
+                p_sys->i_fec_packets + p_sys->i_reordered_packets)/(float)p_sys->i_total_packets;
         if (quality != 100)
-            msg_Info(p_access, "STATS: Total %u, Recovered %u/%u, Reordered %u, Lost %u, VBR " \
-                "Score %.2f, Link Quality %.2f%%", p_sys->i_total_packets,
-                p_sys->i_recovered_packets, p_sys->i_nack_packets, p_sys->i_reordered_packets,
+            msg_Info(p_access, "STATS: Total %u, Recovered %u/%u, FEC %u, Duplicates %u, " \
+                "Reordered %u, Lost %u, VBR Score %.2f, Link Quality %.2f%%",
+                p_sys->i_total_packets, p_sys->i_recovered_packets, p_sys->i_nack_packets,
+                p_sys->i_fec_packets, p_sys->i_duplicate_packets, p_sys->i_reordered_packets,
                 p_sys->i_lost_packets, ratio, quality);
         p_sys->i_last_stat = now;
         p_sys->vbr_ratio = 0;
@@ -967,6 +1270,8 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
         p_sys->i_recovered_packets = 0;
         p_sys->i_reordered_packets = 0;
         p_sys->i_total_packets = 0;
+        p_sys->i_duplicate_packets = 0;
+        p_sys->i_fec_packets = 0;
     }
 
     /* Send rtcp feedback every RTCP_INTERVAL */
@@ -975,7 +1280,8 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
     {
         /* msg_Dbg(p_access, "Calling RTCP Feedback %lu<%d ms using timer", interval,
         VLC_TICK_FROM_MS(RTCP_INTERVAL)); */
-        send_rtcp_feedback(p_access, flow);
+        for (int i = 0; i < p_sys->i_links; i++)
+            send_rtcp_feedback(p_access, &p_sys->links[i]);
         flow->feedback_time = now;
     }
 
@@ -983,6 +1289,9 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
     interval = (now - p_sys->last_nack_tx);
     if ( interval > VLC_TICK_FROM_MS(NACK_INTERVAL) )
     {
+        /* FEC first, as it does not need a round trip */
+        if (p_sys->b_fec)
+            fec_recover(p_access, p_sys->flow);
         send_nacks(p_access, p_sys->flow);
         p_sys->last_nack_tx = now;
     }
@@ -1017,14 +1326,12 @@ static void Clean( stream_t *p_access )
     if( likely(p_sys->p_fifo != NULL) )
         block_FifoRelease( p_sys->p_fifo );
 
+    for (int i = 0; i < p_sys->i_links; i++)
+        rist_link_close(&p_sys->links[i]);
+    fec_flush(p_sys);
+
     if (p_sys->flow)
     {
-        if (p_sys->flow->fd_in >= 0)
-            net_Close (p_sys->flow->fd_in);
-        if (p_sys->flow->fd_nack >= 0)
-            net_Close (p_sys->flow->fd_nack);
-        if (p_sys->flow->fd_rtcp_m >= 0)
-            net_Close (p_sys->flow->fd_rtcp_m);
         for (int i=0; i<RIST_QUEUE_SIZE; i++) {
             struct rtp_pkt *pkt = &(p_sys->flow->buffer[i]);
             if (pkt->buffer && pkt->buffer->i_buffer > 0) {
@@ -1050,11 +1357,36 @@ static void Close(vlc_object_t *p_this)
     Clean( p_access );
 }
 
+static int rist_add_link(stream_t *p_access, const char *psz_url)
+{
+    stream_sys_t *p_sys = p_access->p_sys;
+    vlc_url_t     parsed_url;
+    int           ret = VLC_EGENERIC;
+
+    if (p_sys->i_links >= RIST_MAX_LINKS)
+    {
+        msg_Err( p_access, "Too many links, ignoring %s", psz_url );
+        return VLC_EGENERIC;
+    }
+
+    if ( vlc_UrlParse( &parsed_url, psz_url ) == -1 || parsed_url.psz_host == NULL )
+        msg_Err( p_access, "Failed to parse input URL (%s)", psz_url );
+    else
+        ret = rist_udp_receiver(p_access, &p_sys->links[p_sys->i_links],
+                                parsed_url.psz_host, parsed_url.i_port);
+    vlc_UrlClean( &parsed_url );
+
+    if (ret == VLC_SUCCESS)
+        p_sys->i_links++;
+    else
+        msg_Err( p_access, "Failed to open rist flow (%s)", psz_url );
+    return ret;
+}
+
 static int Open(vlc_object_t *p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
     stream_sys_t *p_sys = NULL;
-    vlc_url_t     parsed_url = { 0 };
 
     p_sys = vlc_obj_calloc( p_this, 1, sizeof( *p_sys ) );
     if( unlikely( p_sys == NULL ) )
@@ -1064,31 +1396,47 @@ static int Open(vlc_object_t *p_this)
 
     vlc_mutex_init( &p_sys->lock );
 
-    if ( vlc_UrlParse( &parsed_url, p_access->psz_url ) == -1 )
-    {
-        msg_Err( p_access, "Failed to parse input URL (%s)",
-            p_access->psz_url );
-        goto failed;
-    }
-
     /* Initialize rist flow */
-    p_sys->b_ismulticast = is_multicast_address(parsed_url.psz_host);
-    p_sys->flow = rist_udp_receiver(p_access, &parsed_url, p_sys->b_ismulticast);
-    vlc_UrlClean( &parsed_url );
+    p_sys->flow = rist_init_rx();
     if (!p_sys->flow)
-    {
-        msg_Err( p_access, "Failed to open rist flow (%s)",
-            p_access->psz_url );
         goto failed;
+
+    p_sys->b_fec = var_InheritBool( p_access, "enable-fec" );
+    p_sys->bonding = var_InheritInteger( p_access, "bonding-mode" );
+
+    if (rist_add_link(p_access, p_access->psz_url))
+        goto failed;
+
+    /* Bonded links to the same sender, e.g. "rist://@:5000,rist://@:6000" */
+    char *psz_links = var_InheritString( p_access, "bonding-links" );
+    if (psz_links)
+    {
+        char *psz_save;
+        for (char *psz = strtok_r(psz_links, ",", &psz_save); psz != NULL;
+             psz = strtok_r(NULL, ",", &psz_save))
+        {
+            if (rist_add_link(p_access, psz))
+            {
+                free(psz_links);
+                goto failed;
+            }
+        }
+        free(psz_links);
     }
+    if (p_sys->i_links > 1)
+        msg_Info(p_access, "Bonding %d links in %s mode", p_sys->i_links,
+            p_sys->bonding == BONDING_BALANCED ? "load balanced" : "redundant");
 
     p_sys->b_flag_discontinuity = false;
     p_sys->b_disablenacks = var_InheritBool( p_access, "disable-nacks" );
     p_sys->b_sendblindnacks = var_InheritBool( p_access, "mcast-blind-nacks" );
-    if (p_sys->b_sendblindnacks && p_sys->b_disablenacks == false)
-        p_sys->b_sendnacks = true;
-    else
-        p_sys->b_sendnacks = false;
+    for (int i = 0; i < p_sys->i_links; i++)
+    {
+        if (p_sys->b_sendblindnacks && p_sys->b_disablenacks == false)
+            p_sys->links[i].b_sendnacks = true;
+        else
+            p_sys->links[i].b_sendnacks = false;
+    }
     p_sys->nack_type = var_InheritInteger( p_access, "nack-type" );
     p_sys->i_max_packet_size = var_InheritInteger( p_access, "packet-size" );
     p_sys->i_poll_timeout = var_InheritInteger( p_access, "maximum-jitter" );
@@ -1155,6 +1503,17 @@ vlc_module_begin ()
     add_bool( "mcast-blind-nacks", false, "Do not check for a valid rtcp message from the encoder",
         "Send nack messages even when we have not confirmed that the encoder is on our local " \
         "network.", true )
+    add_string( "bonding-links", NULL, N_("RIST bonded links"),
+        N_("Comma-separated list of additional rist:// URLs to receive the same flow from, for "
+            "instance over other networks. Duplicate packets are dropped."), true )
+    add_integer( "bonding-mode", BONDING_REDUNDANT, N_("RIST bonding mode"),
+        N_("Redundant links each carry all the packets, so NACKs are sent on all of them. "
+            "Load balanced links each carry a share of the packets, so NACKs are sent on one "
+            "link at a time."), true )
+        change_integer_list( bonding_mode, bonding_mode_names )
+    add_bool( "enable-fec", false, N_("SMPTE 2022-1 FEC"),
+        N_("Receive column and row FEC packets on the media port plus 2 and 4, and recover "
+            "lost packets from them before requesting retransmissions."), true )
 
     set_capability( "access", 0 )
     add_shortcut( "rist", "tr06" )
@@ -46,6 +46,18 @@
 
 #define DEFAULT_MRU (1500u - (20 + 8))
 
+#ifdef HAVE_RECVMMSG
+/* Maximum number of datagrams received per system call */
+# define BATCH_MAX 32u
+
+struct rtp_batch
+{
+    block_t *slots[BATCH_MAX];
+    struct iovec iovecs[BATCH_MAX];
+    struct mmsghdr msgs[BATCH_MAX];
+};
+#endif
+
 /**
  * Processes a packet received from the RTP socket.
  */
@@ -100,6 +112,92 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+#ifdef HAVE_RECVMMSG
+/**
+ * Receives as many datagrams as are pending, up to the batch size, with a
+ * single system call, and processes them.
+ *
+ * @return false if no buffer could be allocated at all
+ */
+static bool rtp_recv_batch (demux_t *demux, int fd, struct rtp_batch *batch,
+                            size_t *restrict mru, int trunc_flag)
+{
+    unsigned count = 0;
+
+    /* Receive buffers are recycled until handed out */
+    while (count < BATCH_MAX)
+    {
+        block_t *block = batch->slots[count];
+
+        if (block != NULL && block->i_buffer != *mru)
+        {
+            block_Release (block);
+            block = NULL;
+        }
+        if (block == NULL)
+        {
+            block = block_Alloc (*mru);
+            if (unlikely(block == NULL))
+                break;
+        }
+        batch->slots[count] = block;
+        batch->iovecs[count].iov_base = block->p_buffer;
+        batch->iovecs[count].iov_len = block->i_buffer;
+        batch->msgs[count].msg_hdr = (struct msghdr) {
+            .msg_iov = &batch->iovecs[count],
+            .msg_iovlen = 1,
+        };
+        count++;
+    }
+
+    if (unlikely(count == 0))
+    {
+        if (*mru == DEFAULT_MRU)
+            return false; /* we are totallly screwed */
+        *mru = DEFAULT_MRU; /* retry with shrunk MRU */
+        return true;
+    }
+
+    int n = recvmmsg (fd, batch->msgs, count, MSG_DONTWAIT | trunc_flag,
+                      NULL);
+    if (n == -1)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            msg_Warn (demux, "RTP network error: %s", vlc_strerror_c(errno));
+        return true;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        block_t *block = batch->slots[i];
+        size_t len = batch->msgs[i].msg_len;
+
+        batch->slots[i] = NULL;
+        if (batch->msgs[i].msg_hdr.msg_flags & trunc_flag)
+        {
+            msg_Err(demux, "%zu bytes packet truncated (MRU was %zu)",
+                    len, block->i_buffer);
+            block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            *mru = len;
+        }
+        else
+            block->i_buffer = len;
+
+        rtp_process (demux, block);
+    }
+    return true;
+}
+
+static void rtp_batch_cleanup (void *data)
+{
+    struct rtp_batch *batch = data;
+
+    for (unsigned i = 0; i < BATCH_MAX; i++)
+        if (batch->slots[i] != NULL)
+            block_Release (batch->slots[i]);
+}
+#endif
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -115,6 +213,10 @@ void *rtp_dgram_thread (void *opaque)
     const int trunc_flag = 0;
 #endif
 
+#ifdef HAVE_RECVMMSG
+    struct rtp_batch batch = { .slots = { NULL } };
+    size_t mru = DEFAULT_MRU;
+#else
     struct iovec iov =
     {
         .iov_len = DEFAULT_MRU,
@@ -124,11 +226,15 @@ void *rtp_dgram_thread (void *opaque)
         .msg_iov = &iov,
         .msg_iovlen = 1,
     };
+#endif
 
     struct pollfd ufd[1];
     ufd[0].fd = rtp_fd;
     ufd[0].events = POLLIN;
 
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_push (rtp_batch_cleanup, &batch);
+#endif
     for (;;)
     {
         int n = poll (ufd, 1, rtp_timeout (deadline));
@@ -145,6 +251,10 @@ void *rtp_dgram_thread (void *opaque)
             if (unlikely(ufd[0].revents & POLLHUP))
                 break; /* RTP socket dead (DCCP only) */
 
+#ifdef HAVE_RECVMMSG
+            if (!rtp_recv_batch (demux, rtp_fd, &batch, &mru, trunc_flag))
+                break;
+#else
             block_t *block = block_Alloc (iov.iov_len);
             if (unlikely(block == NULL))
             {
@@ -178,6 +288,7 @@ void *rtp_dgram_thread (void *opaque)
                           vlc_strerror_c(errno));
                 block_Release (block);
             }
+#endif
         }
 
     dequeue:
@@ -185,6 +296,10 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_pop ();
+    rtp_batch_cleanup (&batch);
+#endif
     return NULL;
 }
 
@@ -75,6 +75,15 @@
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_MIN_DELAY_TEXT N_("Minimum re-ordering wait (ms)")
+#define RTP_MIN_DELAY_LONGTEXT N_( \
+    "How long to wait at least for a missing RTP packet before skipping it.")
+
+#define RTP_MAX_DELAY_TEXT N_("Maximum re-ordering wait (ms)")
+#define RTP_MAX_DELAY_LONGTEXT N_( \
+    "How long to wait at most for a missing RTP packet. The wait adapts to " \
+    "the measured jitter and to late packets within these bounds." )
+
 #define RTP_DYNAMIC_PT_TEXT N_("RTP payload format assumed for dynamic " \
                                "payloads")
 #define RTP_DYNAMIC_PT_LONGTEXT N_( \
@@ -122,6 +131,12 @@ vlc_module_begin ()
     add_integer ("rtp-max-misorder", 100, RTP_MAX_MISORDER_TEXT,
                  RTP_MAX_MISORDER_LONGTEXT, true)
         change_integer_range (0, 32767)
+    add_integer ("rtp-min-delay", 25, RTP_MIN_DELAY_TEXT,
+                 RTP_MIN_DELAY_LONGTEXT, true)
+        change_integer_range (0, 10000)
+    add_integer ("rtp-max-delay", 1000, RTP_MAX_DELAY_TEXT,
+                 RTP_MAX_DELAY_LONGTEXT, true)
+        change_integer_range (0, 10000)
     add_string ("rtp-dynamic-pt", NULL, RTP_DYNAMIC_PT_TEXT,
                 RTP_DYNAMIC_PT_LONGTEXT, true)
         change_string_list (dynamic_pt_list, dynamic_pt_list_text)
@@ -266,6 +281,10 @@ static int Open (vlc_object_t *obj)
     p_sys->timeout      = vlc_tick_from_sec( var_CreateGetInteger (obj, "rtp-timeout") );
     p_sys->max_dropout  = var_CreateGetInteger (obj, "rtp-max-dropout");
     p_sys->max_misorder = var_CreateGetInteger (obj, "rtp-max-misorder");
+    p_sys->min_delay    = VLC_TICK_FROM_MS( var_CreateGetInteger (obj, "rtp-min-delay") );
+    p_sys->max_delay    = VLC_TICK_FROM_MS( var_CreateGetInteger (obj, "rtp-max-delay") );
+    if (p_sys->max_delay < p_sys->min_delay)
+        p_sys->max_delay = p_sys->min_delay;
     p_sys->thread_ready = false;
     p_sys->autodetect   = true;
 
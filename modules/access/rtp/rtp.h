@@ -76,6 +76,8 @@ typedef struct
     vlc_tick_t    timeout;
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
+    vlc_tick_t    min_delay; /**< Min wait for missing packets */
+    vlc_tick_t    max_delay; /**< Max wait for missing packets */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
     bool          thread_ready;
     bool          autodetect; /**< Payload type autodetection pending */
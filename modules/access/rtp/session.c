@@ -150,6 +150,12 @@ struct rtp_source_t
 
     uint16_t last_seq; /* sequence of the next dequeued packet */
     block_t *blocks; /* re-ordered blocks queue */
+
+    vlc_tick_t extra_delay; /* learnt extra wait for missing packets */
+    vlc_tick_t extra_decay; /* next decay of the extra wait */
+    vlc_tick_t skip_date; /* when missing packets were last given up on */
+    uint16_t skip_first; /* first given up sequence */
+    uint16_t skip_last; /* last given up sequence */
     void    *opaque[]; /* Per-source private payload data */
 };
 
@@ -173,6 +179,9 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
     source->blocks = NULL;
+    source->extra_delay = 0;
+    source->extra_decay = VLC_TICK_INVALID;
+    source->skip_date = VLC_TICK_INVALID;
 
     /* Initializes all payload */
     for (unsigned i = 0; i < session->ptc; i++)
@@ -393,6 +402,7 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                   vlc_tick_t *restrict deadlinep)
 {
+    demux_sys_t *p_sys = demux->p_sys;
     vlc_tick_t now = vlc_tick_now ();
     bool pending = false;
 
@@ -403,6 +413,13 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
         rtp_source_t *src = session->srcv[i];
         block_t *block;
 
+        /* Forget about late packets progressively */
+        if (now >= src->extra_decay)
+        {
+            src->extra_delay -= src->extra_delay / 8;
+            src->extra_decay = now + VLC_TICK_FROM_SEC(1);
+        }
+
         /* Because of IP packet delay variation (IPDV), we need to guesstimate
          * how long to wait for a missing packet in the RTP sequence
          * (see RFC3393 for background on IPDV).
@@ -437,9 +454,15 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             else
                 deadline = 0; /* no jitter estimate with no frequency :( */
 
-            /* Make sure we wait at least for 25 msec */
-            if (deadline < VLC_TICK_FROM_MS(25))
-                deadline = VLC_TICK_FROM_MS(25);
+            /* Jitter is not gaussian on every network: also wait for as long
+             * as packets recently turned out to be late (see rtp_decode()). */
+            deadline += src->extra_delay;
+
+            /* Stay within the configured bounds */
+            if (deadline < p_sys->min_delay)
+                deadline = p_sys->min_delay;
+            if (deadline > p_sys->max_delay)
+                deadline = p_sys->max_delay;
 
             /* Additionnaly, we implicitly wait for the packetization time
              * multiplied by the number of missing packets. block is the first
@@ -449,6 +472,9 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             deadline += block->i_pts;
             if (now >= deadline)
             {
+                src->skip_date = now;
+                src->skip_first = src->last_seq + 1;
+                src->skip_last = rtp_seq (block) - 1;
                 rtp_decode (demux, session, src);
                 continue;
             }
@@ -477,6 +503,32 @@ void rtp_dequeue_force (demux_t *demux, const rtp_session_t *session)
     }
 }
 
+/**
+ * Learns from a packet that arrived after it was given up on: the wait for
+ * missing packets is increased by as much as it was late.
+ */
+static void rtp_late (demux_t *demux, rtp_source_t *src, const block_t *block)
+{
+    demux_sys_t *p_sys = demux->p_sys;
+    uint16_t seq = rtp_seq (block);
+
+    if (src->skip_date == VLC_TICK_INVALID
+     || (uint16_t)(seq - src->skip_first)
+            > (uint16_t)(src->skip_last - src->skip_first))
+        return; /* not given up on, i.e. duplicate */
+
+    /* block->i_pts is the reception time */
+    vlc_tick_t extra = src->extra_delay + (block->i_pts - src->skip_date);
+    if (extra > p_sys->max_delay)
+        extra = p_sys->max_delay;
+    if (extra > src->extra_delay)
+    {
+        msg_Dbg (demux, "re-ordering wait increased to %"PRId64" ms",
+                 MS_FROM_VLC_TICK(extra));
+        src->extra_delay = extra;
+    }
+}
+
 /**
  * Decodes one RTP packet.
  */
@@ -497,6 +549,7 @@ rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
         {   /* Trash too late packets (and PIM Assert duplicates) */
             msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")",
                       rtp_seq (block));
+            rtp_late (demux, src, block);
             goto drop;
         }
         msg_Warn (demux, "%"PRIu16" packet(s) lost", delta_seq);
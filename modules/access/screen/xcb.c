@@ -32,6 +32,9 @@
 # include <sys/shm.h>
 # include <xcb/shm.h>
 #endif
+#ifdef HAVE_XCB_DAMAGE
+# include <xcb/damage.h>
+#endif
 #include <vlc_common.h>
 #include <vlc_demux.h>
 #include <vlc_plugin.h>
@@ -116,6 +119,12 @@ typedef struct
     bool              shm; /**< Whether to use MIT-SHM */
     bool              follow_mouse;
     uint16_t          cur_w, cur_h; /**< Actual capture pixel dimensions */
+#ifdef HAVE_XCB_DAMAGE
+    xcb_damage_damage_t damage; /**< Damage XID, or 0 if unsupported */
+    uint8_t           damage_event; /**< DamageNotify event code */
+    block_t          *last; /**< Last captured frame (shared payload) */
+    int16_t           last_x, last_y; /**< Last capture coordinates */
+#endif
     /* Timer does not use this, only input thread: */
     vlc_timer_t       timer;
 } demux_sys_t;
@@ -136,6 +145,56 @@ static bool CheckSHM (xcb_connection_t *conn)
 #endif
 }
 
+#ifdef HAVE_XCB_DAMAGE
+/**
+ * Starts tracking the changes of a window contents.
+ * \return the Damage XID, or 0 if the extension is not supported
+ */
+static xcb_damage_damage_t CheckDamage (xcb_connection_t *conn,
+                                        xcb_window_t window,
+                                        uint8_t *restrict event)
+{
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data (conn, &xcb_damage_id);
+    if (ext == NULL || !ext->present)
+        return 0;
+
+    xcb_damage_query_version_reply_t *r =
+        xcb_damage_query_version_reply (conn,
+            xcb_damage_query_version (conn, 1, 1), NULL);
+    if (r == NULL)
+        return 0;
+    free (r);
+
+    xcb_damage_damage_t damage = xcb_generate_id (conn);
+    xcb_damage_create (conn, damage, window,
+                       XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    *event = ext->first_event + XCB_DAMAGE_NOTIFY;
+    return damage;
+}
+
+/**
+ * Checks whether the window contents changed since the last call.
+ */
+static bool IsDamaged (demux_sys_t *sys)
+{
+    xcb_generic_event_t *ev;
+    bool damaged = false;
+
+    while ((ev = xcb_poll_for_event (sys->conn)) != NULL)
+    {
+        if ((ev->response_type & 0x7F) == sys->damage_event)
+            damaged = true;
+        free (ev);
+    }
+
+    /* Changes from now on are reported by the next notification */
+    if (damaged || sys->last == NULL)
+        xcb_damage_subtract (sys->conn, sys->damage, XCB_NONE, XCB_NONE);
+    return damaged;
+}
+#endif
+
 /**
  * Probes and initializes.
  */
@@ -220,6 +279,12 @@ static int Open (vlc_object_t *obj)
     p_sys->pixmap = xcb_generate_id (conn);
     p_sys->segment = xcb_generate_id (conn);
     p_sys->shm = CheckSHM (conn);
+#ifdef HAVE_XCB_DAMAGE
+    p_sys->damage = CheckDamage (conn, p_sys->window, &p_sys->damage_event);
+    p_sys->last = NULL;
+    if (p_sys->damage != 0)
+        msg_Dbg (obj, "using Damage extension");
+#endif
     p_sys->w = var_InheritInteger (obj, "screen-width");
     p_sys->h = var_InheritInteger (obj, "screen-height");
     if (p_sys->w != 0 || p_sys->h != 0)
@@ -270,6 +335,10 @@ static void Close (vlc_object_t *obj)
     demux_sys_t *p_sys = demux->p_sys;
 
     vlc_timer_destroy (p_sys->timer);
+#ifdef HAVE_XCB_DAMAGE
+    if (p_sys->last != NULL)
+        block_Release (p_sys->last);
+#endif
     xcb_disconnect (p_sys->conn);
     free (p_sys);
 }
@@ -408,6 +477,13 @@ discard:
     {
         if (sys->es != NULL)
             es_out_Del (demux->out, sys->es);
+#ifdef HAVE_XCB_DAMAGE
+        if (sys->last != NULL)
+        {
+            block_Release (sys->last);
+            sys->last = NULL;
+        }
+#endif
 
         /* Update composite pixmap */
         if (sys->window != geo->root)
@@ -433,6 +509,15 @@ discard:
     free (geo);
 
     block_t *block = NULL;
+#ifdef HAVE_XCB_DAMAGE
+    if (sys->damage != 0 && !IsDamaged (sys) && sys->last != NULL
+     && x == sys->last_x && y == sys->last_y)
+    {   /* Unchanged contents: repeat the last frame without capturing */
+        block = block_Slice (sys->last, 0, sys->last->i_buffer);
+        if (likely(block != NULL))
+            goto send;
+    }
+#endif
 #if HAVE_SYS_SHM_H
     if (sys->shm)
     {   /* Capture screen through shared memory */
@@ -498,6 +583,17 @@ noshm:
         block->i_buffer = datalen;
     }
 
+#ifdef HAVE_XCB_DAMAGE
+    if (sys->damage != 0)
+    {
+        if (sys->last != NULL)
+            block_Release (sys->last);
+        sys->last = block_Slice (block, 0, block->i_buffer);
+        sys->last_x = x;
+        sys->last_y = y;
+    }
+send:
+#endif
     /* Send block - zero copy */
     if (sys->es != NULL)
     {
@@ -670,9 +670,18 @@ static int DirRead (stream_t *p_access, input_item_node_t *p_current_node)
         free( psz_uri );
 
         int i_type = LIBSSH2_SFTP_S_ISDIR( attrs.permissions ) ? ITEM_TYPE_DIRECTORY : ITEM_TYPE_FILE;
+        input_item_t *p_item;
         i_ret = vlc_readdir_helper_additem( &rdh, psz_full_uri, NULL, psz_file,
-                                            i_type, ITEM_NET );
+                                            i_type, ITEM_NET, &p_item );
         free( psz_full_uri );
+
+        if( p_item != NULL && i_type == ITEM_TYPE_FILE )
+        {
+            if( attrs.flags & LIBSSH2_SFTP_ATTR_SIZE )
+                p_item->i_file_size = attrs.filesize;
+            if( attrs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME )
+                p_item->i_file_mtime = attrs.mtime;
+        }
     }
 
     vlc_readdir_helper_finish( &rdh, i_ret == VLC_SUCCESS );
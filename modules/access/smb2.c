@@ -75,6 +75,24 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 vlc_module_end()
 
+/* Several reads are kept outstanding, as a single one at a time is bound by the
+ * round-trip time on high latency links. */
+#define SMB2_READ_DEPTH 4
+#define SMB2_READ_MIN (64 * 1024)
+#define SMB2_READ_MAX (8 * 1024 * 1024)
+
+struct smb2_chunk
+{
+    stream_t *access;
+    uint8_t *buf;
+    size_t capacity;
+    uint64_t offset;
+    size_t size; /* requested */
+    size_t len; /* received */
+    size_t pos; /* returned */
+    bool pending;
+};
+
 struct access_sys
 {
     struct smb2_context *   smb2;
@@ -88,12 +106,14 @@ struct access_sys
     int                     error_status;
 
     bool res_done;
-    union {
-        struct
-        {
-            size_t len;
-        } read;
-    } res;
+
+    struct smb2_chunk       chunks[SMB2_READ_DEPTH]; /* in offset order */
+    unsigned                chunk_first;
+    unsigned                chunk_count;
+    uint64_t                read_offset; /* next returned byte */
+    uint64_t                ahead_offset; /* next requested byte */
+    size_t                  read_size;
+    size_t                  read_max;
 };
 
 static int
@@ -211,12 +231,76 @@ smb2_read_cb(struct smb2_context *smb2, int status, void *data,
              void *private_data)
 {
     VLC_UNUSED(data);
+    struct smb2_chunk *chunk = private_data;
+
+    chunk->pending = false;
+    private_data = chunk->access;
     VLC_SMB2_GENERIC_CB();
 
-    if (status == 0)
-        sys->eof = true;
-    else
-        sys->res.read.len = status;
+    chunk->len = status; /* 0 at end of file */
+}
+
+/* Issues reads until the window is full */
+static int
+FileReadAhead(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+
+    while (sys->chunk_count < SMB2_READ_DEPTH)
+    {
+        /* Past the known size, only look for a grown file one read at a time */
+        if (sys->ahead_offset >= sys->smb2_size && sys->chunk_count > 0)
+            break;
+
+        struct smb2_chunk *chunk = &sys->chunks[(sys->chunk_first
+                                   + sys->chunk_count) % SMB2_READ_DEPTH];
+        size_t size = sys->read_size;
+
+        if (sys->ahead_offset < sys->smb2_size
+         && size > sys->smb2_size - sys->ahead_offset)
+            size = sys->smb2_size - sys->ahead_offset;
+
+        if (chunk->capacity < size)
+        {
+            uint8_t *buf = realloc(chunk->buf, size);
+            if (buf == NULL)
+                return sys->chunk_count > 0 ? 0 : -1;
+            chunk->buf = buf;
+            chunk->capacity = size;
+        }
+
+        chunk->access = access;
+        chunk->offset = sys->ahead_offset;
+        chunk->size = size;
+        chunk->len = chunk->pos = 0;
+        chunk->pending = true;
+        if (smb2_pread_async(sys->smb2, sys->smb2fh, chunk->buf, size,
+                             chunk->offset, smb2_read_cb, chunk) < 0)
+        {
+            chunk->pending = false;
+            VLC_SMB2_SET_GENERIC_ERROR(access, "smb2_pread_async");
+            return -1;
+        }
+        sys->ahead_offset += size;
+        sys->chunk_count++;
+    }
+    return 0;
+}
+
+/* Waits for the outstanding reads, whose buffers cannot be reused before */
+static int
+FileReadFlush(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+
+    for (unsigned i = 0; i < SMB2_READ_DEPTH; i++)
+        while (sys->chunks[i].pending)
+            if (vlc_smb2_mainloop(access, false) < 0)
+                return -1;
+
+    sys->chunk_count = 0;
+    sys->ahead_offset = sys->read_offset;
+    return 0;
 }
 
 static ssize_t
@@ -230,18 +314,45 @@ FileRead(stream_t *access, void *buf, size_t len)
     if (sys->eof)
         return 0;
 
-    sys->res.read.len = 0;
-    if (smb2_read_async(sys->smb2, sys->smb2fh, buf, len,
-                        smb2_read_cb, access) < 0)
+    for (;;)
     {
-        VLC_SMB2_SET_GENERIC_ERROR(access, "smb2_read_async");
-        return -1;
-    }
+        if (FileReadAhead(access) < 0)
+            return -1;
 
-    if (vlc_smb2_mainloop(access, false) < 0)
-        return -1;
+        struct smb2_chunk *chunk = &sys->chunks[sys->chunk_first];
+        while (chunk->pending)
+            if (vlc_smb2_mainloop(access, false) < 0)
+                return -1;
+
+        if (chunk->pos < chunk->len)
+        {
+            if (len > chunk->len - chunk->pos)
+                len = chunk->len - chunk->pos;
+            memcpy(buf, chunk->buf + chunk->pos, len);
+            chunk->pos += len;
+            sys->read_offset += len;
+            return len;
+        }
 
-    return sys->res.read.len;
+        if (chunk->len == 0)
+        {
+            sys->eof = true;
+            return 0;
+        }
+
+        /* Fully returned */
+        sys->chunk_first = (sys->chunk_first + 1) % SMB2_READ_DEPTH;
+        sys->chunk_count--;
+
+        if (chunk->len < chunk->size)
+        {   /* Short read: the following requests are misaligned */
+            if (FileReadFlush(access) < 0)
+                return -1;
+        }
+        else if (sys->read_size < sys->read_max)
+            /* Sequential reading: grow the requests */
+            sys->read_size = __MIN(sys->read_size * 2, sys->read_max);
+    }
 }
 
 static int
@@ -252,11 +363,11 @@ FileSeek(stream_t *access, uint64_t i_pos)
     if (sys->error_status != 0)
         return VLC_EGENERIC;
 
-    if (smb2_lseek(sys->smb2, sys->smb2fh, i_pos, SEEK_SET, NULL) < 0)
-    {
-        VLC_SMB2_SET_GENERIC_ERROR(access, "smb2_seek_async");
+    if (FileReadFlush(access) < 0)
         return VLC_EGENERIC;
-    }
+
+    sys->read_offset = sys->ahead_offset = i_pos;
+    sys->read_size = __MIN(SMB2_READ_MIN, sys->read_max);
     sys->eof = false;
 
     return VLC_SUCCESS;
@@ -320,7 +431,7 @@ vlc_smb2_get_url(vlc_url_t *url, const char *file)
 }
 
 static int AddItem(stream_t *access, struct vlc_readdir_helper *rdh,
-                   const char *name, int i_type)
+                   const char *name, int i_type, input_item_t **item)
 {
     struct access_sys *sys = access->p_sys;
     char *name_encoded = vlc_uri_encode(name);
@@ -333,7 +444,7 @@ static int AddItem(stream_t *access, struct vlc_readdir_helper *rdh,
         return VLC_ENOMEM;
 
     int ret = vlc_readdir_helper_additem(rdh, url, NULL, name, i_type,
-                                         ITEM_NET);
+                                         ITEM_NET, item);
     free(url);
     return ret;
 }
@@ -365,7 +476,13 @@ DirRead(stream_t *access, input_item_node_t *p_node)
             i_type = ITEM_TYPE_UNKNOWN;
             break;
         }
-        ret = AddItem(access, &rdh, smb2dirent->name, i_type);
+        input_item_t *item;
+        ret = AddItem(access, &rdh, smb2dirent->name, i_type, &item);
+        if (item != NULL && i_type == ITEM_TYPE_FILE)
+        {
+            item->i_file_size = smb2dirent->st.smb2_size;
+            item->i_file_mtime = smb2dirent->st.smb2_mtime;
+        }
     }
 
     vlc_readdir_helper_finish(&rdh, ret == VLC_SUCCESS);
@@ -393,7 +510,8 @@ ShareEnum(stream_t *access, input_item_node_t *p_node)
        switch (info->type & 0x3)
        {
            case SHARE_TYPE_DISKTREE:
-               ret = AddItem(access, &rdh, info->name, ITEM_TYPE_DIRECTORY);
+               ret = AddItem(access, &rdh, info->name, ITEM_TYPE_DIRECTORY,
+                             NULL);
                break;
        }
     }
@@ -685,6 +803,12 @@ Open(vlc_object_t *p_obj)
 
     if (sys->smb2fh != NULL)
     {
+        sys->read_max = smb2_get_max_read_size(sys->smb2);
+        if (sys->read_max == 0 || sys->read_max > SMB2_READ_MAX)
+            sys->read_max = SMB2_READ_MAX;
+        sys->read_size = __MIN(SMB2_READ_MIN, sys->read_max);
+        msg_Dbg(access, "reading up to %zu bytes per request", sys->read_max);
+
         access->pf_read = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -739,5 +863,9 @@ Close(vlc_object_t *p_obj)
     vlc_smb2_disconnect_share(access);
     smb2_destroy_context(sys->smb2);
 
+    /* Only after the context, as outstanding reads write to them */
+    for (unsigned i = 0; i < SMB2_READ_DEPTH; i++)
+        free(sys->chunks[i].buf);
+
     vlc_UrlClean(&sys->encoded_url);
 }
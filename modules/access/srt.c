@@ -30,8 +30,14 @@
 
 #include <vlc_network.h>
 #include <vlc_url.h>
+#include <vlc_input_item.h>
 
+/* Received data is sliced out of a larger buffer, reused once all the
+ * slices are released, rather than allocated for every read. */
+#define SRT_ARENA_CHUNKS (4 * SRT_MAX_CHUNKS_TRYREAD)
 
+/* How often the connection statistics are published */
+#define SRT_STATS_INTERVAL VLC_TICK_FROM_SEC(1)
 
 typedef struct
 {
@@ -42,6 +48,9 @@ typedef struct
     char       *psz_host;
     int         i_port;
     int         i_chunks; /* Number of chunks to allocate in the next read */
+    block_t    *p_arena; /* Receive buffer, or NULL */
+    size_t      i_arena_used; /* Bytes of the receive buffer handed out */
+    vlc_tick_t  i_stats_date; /* Next statistics update */
 } stream_sys_t;
 
 
@@ -89,6 +98,63 @@ static int Control(stream_t *p_stream, int i_query, va_list args)
     return i_ret;
 }
 
+static void srt_update_stats(stream_t *p_stream)
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+    input_item_t *p_item = p_stream->p_input_item;
+    SRT_TRACEBSTATS perf;
+    vlc_tick_t now = vlc_tick_now();
+
+    if ( p_item == NULL || now < p_sys->i_stats_date
+      || srt_bstats( p_sys->sock, &perf, 0 ) == SRT_ERROR )
+        return;
+    p_sys->i_stats_date = now + SRT_STATS_INTERVAL;
+
+    const char *cat = _("SRT");
+
+    input_item_AddInfo( p_item, cat, _("Round-trip time"), "%.1f ms",
+                        perf.msRTT );
+    input_item_AddInfo( p_item, cat, _("Receive rate"), "%.2f Mb/s",
+                        perf.mbpsRecvRate );
+    input_item_AddInfo( p_item, cat, _("Receive buffer"), "%d ms",
+                        perf.msRcvBuf );
+    input_item_AddInfo( p_item, cat, _("Lost packets"), "%d",
+                        perf.pktRcvLossTotal );
+    input_item_AddInfo( p_item, cat, _("Dropped packets"), "%d",
+                        perf.pktRcvDropTotal );
+}
+
+/* Gets room to receive at least i_size bytes in the receive buffer */
+static uint8_t *srt_arena_get(stream_sys_t *p_sys, size_t i_size,
+                              size_t i_chunk_size)
+{
+    block_t *p_arena = p_sys->p_arena;
+
+    if ( p_arena != NULL )
+    {
+        if ( !block_IsShared( p_arena ) )
+            p_sys->i_arena_used = 0; /* every slice is gone: recycle */
+        else if ( p_arena->i_buffer - p_sys->i_arena_used < i_size )
+        {   /* The slices keep the payload alive as long as needed */
+            block_Release( p_arena );
+            p_arena = NULL;
+        }
+    }
+
+    if ( p_arena == NULL || p_arena->i_buffer < i_size )
+    {
+        if ( p_arena != NULL )
+            block_Release( p_arena );
+        p_arena = block_Alloc( __MAX( i_size,
+                                      SRT_ARENA_CHUNKS * i_chunk_size ) );
+        p_sys->i_arena_used = 0;
+    }
+
+    p_sys->p_arena = p_arena;
+    return ( p_arena != NULL )
+        ? p_arena->p_buffer + p_sys->i_arena_used : NULL;
+}
+
 static bool srt_schedule_reconnect(stream_t *p_stream)
 {
     vlc_object_t *strm_obj = (vlc_object_t *) p_stream;
@@ -237,8 +303,10 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
     size_t i_chunk_size_actual = ( i_chunk_size > 0 )
         ? i_chunk_size : SRT_DEFAULT_CHUNK_SIZE;
     size_t bufsize = i_chunk_size_actual * p_sys->i_chunks;
-    block_t *pkt = block_Alloc( bufsize );
-    if ( unlikely( pkt == NULL ) )
+    uint8_t *buf = srt_arena_get( p_sys, bufsize, i_chunk_size_actual );
+    size_t i_received = 0;
+    block_t *pkt = NULL;
+    if ( unlikely( buf == NULL ) )
     {
         return NULL;
     }
@@ -281,30 +349,26 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
          * grow until it reads fast enough to keep the library empty after
          * each iteration.
          */
-        pkt->i_buffer = 0;
-        while ( ( bufsize - pkt->i_buffer ) >= i_chunk_size_actual )
+        i_received = 0;
+        while ( ( bufsize - i_received ) >= i_chunk_size_actual )
         {
             int stat = srt_recvmsg( p_sys->sock,
-                (char *)( pkt->p_buffer + pkt->i_buffer ),
-                bufsize - pkt->i_buffer );
+                (char *)( buf + i_received ), bufsize - i_received );
             if ( stat <= 0 )
             {
                 break;
             }
-            pkt->i_buffer += (size_t)stat;
+            i_received += (size_t)stat;
         }
 
-        msg_Dbg ( p_stream, "Read %zu bytes out of a max of %zu"
-            " (%d chunks of %zu bytes)", pkt->i_buffer,
-            p_sys->i_chunks * i_chunk_size_actual, p_sys->i_chunks,
-                 i_chunk_size_actual );
+        srt_update_stats( p_stream );
 
 
         /* Gradually adjust number of chunks we read at a time
         * up to a predefined maximum. The actual number we might
         * settle on depends on stream's bit rate.
         */
-        size_t rem = bufsize - pkt->i_buffer;
+        size_t rem = bufsize - i_received;
         if ( rem < i_chunk_size_actual )
         {
             if ( p_sys->i_chunks < SRT_MAX_CHUNKS_TRYREAD )
@@ -319,12 +383,14 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
     /* if the poll reports errors for any reason at all,
      * including a timeout, we skip the turn.
      */
-    pkt->i_buffer = 0;
+    i_received = 0;
 
 out:
-    if (pkt->i_buffer == 0) {
-      block_Release(pkt);
-      pkt = NULL;
+    if ( i_received > 0 )
+    {
+        pkt = block_Slice( p_sys->p_arena, p_sys->i_arena_used, i_received );
+        if ( likely( pkt != NULL ) )
+            p_sys->i_arena_used += i_received;
     }
 
     vlc_interrupt_unregister();
@@ -405,6 +471,9 @@ static void Close(vlc_object_t *p_this)
 
     vlc_mutex_destroy( &p_sys->lock );
 
+    if ( p_sys->p_arena != NULL )
+        block_Release( p_sys->p_arena );
+
     srt_epoll_remove_usock( p_sys->i_poll_id, p_sys->sock );
     srt_close( p_sys->sock );
     srt_epoll_release( p_sys->i_poll_id );
@@ -53,9 +53,26 @@
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Maximum number of datagrams received per system call */
+# define BATCH_MAX 256u
+
+struct udp_batch {
+    unsigned count;
+    block_t *queue;
+    block_t **queue_last;
+    block_t *slots[BATCH_MAX];
+    struct mmsghdr msgs[BATCH_MAX];
+    struct iovec iovecs[BATCH_MAX];
+};
+#endif
+
 typedef struct {
     int fd;
     int timeout;
+#ifdef HAVE_RECVMMSG
+    struct udp_batch *batch;
+#endif
 
     size_t length;
     char *offset;
@@ -132,6 +149,112 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
     return val;
 }
 
+#ifdef HAVE_RECVMMSG
+/**
+ * Receives as many datagrams as are pending, up to the batch size, with a
+ * single system call, and appends them to the batch queue.
+ */
+static void BatchReceive(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    struct udp_batch *batch = sys->batch;
+    block_t *block;
+    struct pollfd ufd[1];
+
+    ufd[0].fd = sys->fd;
+    ufd[0].events = POLLIN;
+
+    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+        case 0:
+            msg_Err(access, "receive time-out");
+            *eof = true;
+            return;
+        case -1:
+            return;
+    }
+
+    /* Receive buffers are recycled until handed out to the caller */
+    unsigned count = 0;
+
+    while (count < batch->count) {
+        if (batch->slots[count] == NULL) {
+            batch->slots[count] = block_Alloc(MRU);
+            if (unlikely(batch->slots[count] == NULL))
+                break;
+        }
+
+        batch->iovecs[count].iov_base = batch->slots[count]->p_buffer;
+        batch->iovecs[count].iov_len = MRU;
+        batch->msgs[count].msg_hdr = (struct msghdr) {
+            .msg_iov = &batch->iovecs[count],
+            .msg_iovlen = 1,
+        };
+        count++;
+    }
+
+    if (unlikely(count == 0))
+        return;
+
+    int val = recvmmsg(sys->fd, batch->msgs, count, MSG_DONTWAIT, NULL);
+    if (val <= 0)
+        return;
+
+    for (int i = 0; i < val; i++) {
+        size_t len = batch->msgs[i].msg_len;
+
+        if (len == 0) /* empty payload does *not* mean EOF here */
+            continue;
+
+        if (len < MRU / 4) {
+            /* Small datagram (typical): copy it out so that the large
+             * receive buffer can be reused for the next batch. */
+            block = block_Alloc(len);
+            if (unlikely(block == NULL))
+                break;
+            memcpy(block->p_buffer, batch->slots[i]->p_buffer, len);
+        } else {
+            block = batch->slots[i];
+            batch->slots[i] = NULL;
+            block->i_buffer = len;
+        }
+
+        *batch->queue_last = block;
+        batch->queue_last = &block->p_next;
+    }
+}
+
+/**
+ * Returns the received datagrams one at a time.
+ */
+static block_t *BlockBatch(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    struct udp_batch *batch = sys->batch;
+
+    if (batch->queue == NULL)
+        BatchReceive(access, eof);
+
+    block_t *block = batch->queue;
+    if (block == NULL)
+        return NULL;
+
+    batch->queue = block->p_next;
+    if (batch->queue == NULL)
+        batch->queue_last = &batch->queue;
+    block->p_next = NULL;
+    return block;
+}
+
+static void BatchDestroy(struct udp_batch *batch)
+{
+    block_ChainRelease(batch->queue);
+    for (unsigned i = 0; i < batch->count; i++)
+        if (batch->slots[i] != NULL)
+            block_Release(batch->slots[i]);
+    free(batch);
+}
+#endif
+
 /*****************************************************************************
  * Open: open the socket
  *****************************************************************************/
@@ -217,6 +340,25 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch = NULL;
+
+    int64_t i_batch = var_InheritInteger( p_access, "udp-batch" );
+    if( i_batch > 1 )
+    {
+        sys->batch = calloc( 1, sizeof( *sys->batch ) );
+        if( likely(sys->batch != NULL) )
+        {
+            sys->batch->count = __MIN( (uint64_t)i_batch, BATCH_MAX );
+            sys->batch->queue_last = &sys->batch->queue;
+            p_access->pf_read = NULL;
+            p_access->pf_block = BlockBatch;
+            msg_Dbg( p_access, "receiving up to %u datagrams per call",
+                     sys->batch->count );
+        }
+    }
+#endif
+
     return VLC_SUCCESS;
 }
 
@@ -229,9 +371,17 @@ static void Close( vlc_object_t *p_this )
     access_sys_t *sys = p_access->p_sys;
 
     net_Close( sys->fd );
+#ifdef HAVE_RECVMMSG
+    if( sys->batch != NULL )
+        BatchDestroy( sys->batch );
+#endif
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Receive batch size")
+#define BATCH_LONGTEXT N_("Maximum number of datagrams received with a " \
+    "single system call. This reduces the CPU overhead of high bit rate " \
+    "streams. Values of 1 or less disable batching.")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -242,6 +392,10 @@ vlc_module_begin()
     add_obsolete_integer("server-port") /* since 2.0.0 */
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL, true)
+#ifdef HAVE_RECVMMSG
+    add_integer("udp-batch", 0, BATCH_TEXT, BATCH_LONGTEXT, true)
+        change_integer_range(0, BATCH_MAX)
+#endif
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
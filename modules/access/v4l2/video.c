@@ -34,6 +34,7 @@
 #include <sys/mman.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 
 #include "v4l2.h"
@@ -577,11 +578,83 @@ vlc_tick_t GetBufferPTS (const struct v4l2_buffer *buf)
     return pts;
 }
 
+/*
+ * Memory-mapped buffers
+ *
+ * Dequeued buffers are handed over as blocks, without copying. The buffer is
+ * queued back to the driver when the block is released. The mappings remain
+ * until the last block is released, even after the streaming is stopped.
+ *
+ * If the driver is about to run out of buffers, because the blocks are held
+ * downstream, frames are copied as a fallback to avoid stalling the capture.
+ */
+#define MMAP_MIN_QUEUED 2
+
+struct buffer_t
+{
+    block_t block; /* the block, while the buffer is dequeued */
+    void *  start;
+    size_t  length;
+    struct vlc_v4l2_buffers *owner;
+    uint32_t index;
+};
+
+struct vlc_v4l2_buffers
+{
+    vlc_mutex_t lock; /* serializes queuing against StopMmap() */
+    int fd;
+    bool streaming;
+    atomic_uint queued; /* buffers owned by the driver */
+    vlc_atomic_rc_t rc; /* owner and dequeued buffers */
+    uint32_t count;
+    struct buffer_t bufv[];
+};
+
+static void ReleaseBuffers (struct vlc_v4l2_buffers *bufs)
+{
+    if (!vlc_atomic_rc_dec (&bufs->rc))
+        return;
+
+    for (uint32_t i = 0; i < bufs->count; i++)
+        v4l2_munmap (bufs->bufv[i].start, bufs->bufv[i].length);
+    free (bufs);
+}
+
+static int QueueBuffer (struct vlc_v4l2_buffers *bufs, uint32_t index)
+{
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+        .index = index,
+    };
+
+    if (v4l2_ioctl (bufs->fd, VIDIOC_QBUF, &buf) < 0)
+        return -1;
+    atomic_fetch_add_explicit (&bufs->queued, 1, memory_order_relaxed);
+    return 0;
+}
+
+static void BufferRelease (block_t *block)
+{
+    struct buffer_t *buffer = container_of (block, struct buffer_t, block);
+    struct vlc_v4l2_buffers *bufs = buffer->owner;
+
+    vlc_mutex_lock (&bufs->lock);
+    if (bufs->streaming)
+        QueueBuffer (bufs, buffer->index);
+    vlc_mutex_unlock (&bufs->lock);
+    ReleaseBuffers (bufs);
+}
+
+static const struct vlc_block_callbacks buffer_cbs =
+{
+    BufferRelease,
+};
+
 /*****************************************************************************
  * GrabVideo: Grab a video frame
  *****************************************************************************/
-block_t *GrabVideo (vlc_object_t *demux, int fd,
-                    const struct buffer_t *restrict bufv)
+block_t *GrabVideo (vlc_object_t *demux, struct vlc_v4l2_buffers *bufs)
 {
     struct v4l2_buffer buf = {
         .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
@@ -589,7 +662,7 @@ block_t *GrabVideo (vlc_object_t *demux, int fd,
     };
 
     /* Wait for next frame */
-    if (v4l2_ioctl (fd, VIDIOC_DQBUF, &buf) < 0)
+    if (v4l2_ioctl (bufs->fd, VIDIOC_DQBUF, &buf) < 0)
     {
         switch (errno)
         {
@@ -604,18 +677,37 @@ block_t *GrabVideo (vlc_object_t *demux, int fd,
         }
     }
 
+    unsigned queued = atomic_fetch_sub_explicit (&bufs->queued, 1,
+                                                 memory_order_relaxed) - 1;
+    struct buffer_t *buffer = &bufs->bufv[buf.index];
+    block_t *block;
+
+    assert (buf.index < bufs->count);
+
+    if (queued >= MMAP_MIN_QUEUED)
+    {   /* Lend the buffer */
+        vlc_atomic_rc_inc (&bufs->rc);
+        block = block_Init (&buffer->block, &buffer_cbs, buffer->start,
+                            buffer->length);
+        block->i_buffer = buf.bytesused;
+        block->i_pts = block->i_dts = GetBufferPTS (&buf);
+        return block;
+    }
+
     /* Copy frame */
-    block_t *block = block_Alloc (buf.bytesused);
-    if (unlikely(block == NULL))
-        return NULL;
-    block->i_pts = block->i_dts = GetBufferPTS (&buf);
-    memcpy (block->p_buffer, bufv[buf.index].start, buf.bytesused);
+    block = block_Alloc (buf.bytesused);
+    if (likely(block != NULL))
+    {
+        block->i_pts = block->i_dts = GetBufferPTS (&buf);
+        memcpy (block->p_buffer, buffer->start, buf.bytesused);
+    }
 
     /* Unlock */
-    if (v4l2_ioctl (fd, VIDIOC_QBUF, &buf) < 0)
+    if (QueueBuffer (bufs, buf.index))
     {
         msg_Err (demux, "queue error: %s", vlc_strerror_c(errno));
-        block_Release (block);
+        if (block != NULL)
+            block_Release (block);
         return NULL;
     }
     return block;
@@ -649,9 +741,10 @@ int StartUserPtr (vlc_object_t *obj, int fd)
 /**
  * Allocates memory-mapped buffers, queues them and start streaming.
  * @param n requested buffers count [IN], allocated buffers count [OUT]
- * @return array of allocated buffers (use free()), or NULL on error.
+ * @return buffers (use StopMmap()), or NULL on error.
  */
-struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
+struct vlc_v4l2_buffers *StartMmap (vlc_object_t *obj, int fd,
+                                    uint32_t *restrict n)
 {
     struct v4l2_requestbuffers req = {
         .count = *n,
@@ -671,13 +764,21 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
         return NULL;
     }
 
-    struct buffer_t *bufv = vlc_alloc (req.count, sizeof (*bufv));
-    if (unlikely(bufv == NULL))
+    struct vlc_v4l2_buffers *bufs = malloc (sizeof (*bufs)
+                                            + req.count * sizeof (bufs->bufv[0]));
+    if (unlikely(bufs == NULL))
         return NULL;
 
-    uint32_t bufc = 0;
-    while (bufc < req.count)
+    vlc_mutex_init (&bufs->lock);
+    bufs->fd = fd;
+    bufs->streaming = true;
+    atomic_init (&bufs->queued, 0);
+    vlc_atomic_rc_init (&bufs->rc);
+    bufs->count = 0;
+
+    while (bufs->count < req.count)
     {
+        uint32_t bufc = bufs->count;
         struct v4l2_buffer buf = {
             .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
             .memory = V4L2_MEMORY_MMAP,
@@ -691,19 +792,23 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
             goto error;
         }
 
-        bufv[bufc].start = v4l2_mmap (NULL, buf.length, PROT_READ | PROT_WRITE,
-                                      MAP_SHARED, fd, buf.m.offset);
-        if (bufv[bufc].start == MAP_FAILED)
+        struct buffer_t *buffer = &bufs->bufv[bufc];
+
+        buffer->start = v4l2_mmap (NULL, buf.length, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED, fd, buf.m.offset);
+        if (buffer->start == MAP_FAILED)
         {
             msg_Err (obj, "cannot map buffer %"PRIu32": %s", bufc,
                      vlc_strerror_c(errno));
             goto error;
         }
-        bufv[bufc].length = buf.length;
-        bufc++;
+        buffer->length = buf.length;
+        buffer->owner = bufs;
+        buffer->index = bufc;
+        bufs->count++;
 
         /* Some drivers refuse to queue buffers before they are mapped. Bug? */
-        if (v4l2_ioctl (fd, VIDIOC_QBUF, &buf) < 0)
+        if (QueueBuffer (bufs, bufc))
         {
             msg_Err (obj, "cannot queue buffer %"PRIu32": %s", bufc,
                      vlc_strerror_c(errno));
@@ -717,20 +822,22 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
         msg_Err (obj, "cannot start streaming: %s", vlc_strerror_c(errno));
         goto error;
     }
-    *n = bufc;
-    return bufv;
+    *n = bufs->count;
+    return bufs;
 error:
-    StopMmap (fd, bufv, bufc);
+    StopMmap (bufs);
     return NULL;
 }
 
-void StopMmap (int fd, struct buffer_t *bufv, uint32_t bufc)
+void StopMmap (struct vlc_v4l2_buffers *bufs)
 {
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
-    /* STREAMOFF implicitly dequeues all buffers */
-    v4l2_ioctl (fd, VIDIOC_STREAMOFF, &type);
-    for (uint32_t i = 0; i < bufc; i++)
-        v4l2_munmap (bufv[i].start, bufv[i].length);
-    free (bufv);
+    /* STREAMOFF implicitly dequeues all buffers. Buffers still lent out are
+     * unmapped when their blocks are released, not queued anymore. */
+    vlc_mutex_lock (&bufs->lock);
+    bufs->streaming = false;
+    v4l2_ioctl (bufs->fd, VIDIOC_STREAMOFF, &type);
+    vlc_mutex_unlock (&bufs->lock);
+    ReleaseBuffers (bufs);
 }
@@ -58,14 +58,50 @@
 
 #define SOUT_CFG_PREFIX "sout-file-"
 
+/* Maximum number of blocks coalesced into a single vectored write */
+#define WRITE_IOV_MAX 64
+/* Disk space reserved ahead of the write offset by the writer thread */
+#define PREALLOC_SIZE (INT64_C(32) << 20)
+
+typedef struct
+{
+    int fd;
+
+    /* Asynchronous writer (regular files and block devices only) */
+    bool async;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data; /**< signaled to the writer thread */
+    vlc_cond_t wait_space; /**< signaled to the muxer */
+    block_t *queue;
+    block_t **queue_last;
+    size_t queue_size; /**< bytes queued, including the batch being written */
+    size_t queue_max;
+    size_t queue_peak;
+    unsigned stalls;
+    bool writing;
+    bool closing;
+    int error;
+
+#if defined (__linux__) && defined (FALLOC_FL_KEEP_SIZE)
+    off_t prealloc_end;
+#endif
+} sout_access_out_sys_t;
+
+static int Drain(sout_access_out_sys_t *);
+
 /*****************************************************************************
  * Read: standard read on a file descriptor.
  *****************************************************************************/
 static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
     ssize_t val;
 
+    if (p_sys->async && Drain(p_sys) != 0)
+        return -1;
+
     do
         val = read(fd, p_buffer->p_buffer, p_buffer->i_buffer);
     while (val == -1 && errno == EINTR);
@@ -77,7 +113,8 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
  *****************************************************************************/
 static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
     size_t i_write = 0;
 
     while( p_buffer )
@@ -110,7 +147,8 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
 static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 {
-    int *fdp = access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *sys = access->p_sys;
+    int fd = sys->fd;
     ssize_t total = 0;
 
     while (block != NULL)
@@ -149,7 +187,8 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 #ifdef S_ISSOCK
 static ssize_t Send(sout_access_out_t *access, block_t *block)
 {
-    int *fdp = access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *sys = access->p_sys;
+    int fd = sys->fd;
     size_t total = 0;
 
     while (block != NULL)
@@ -183,12 +222,256 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
 }
 #endif
 
+/*****************************************************************************
+ * Asynchronous writer: the muxer only queues blocks, up to a memory limit,
+ * while a dedicated thread writes them to the file. This keeps slow disks
+ * from stalling the stream output chain.
+ *****************************************************************************/
+static void Preallocate(sout_access_out_sys_t *sys, size_t size)
+{
+#if defined (__linux__) && defined (FALLOC_FL_KEEP_SIZE)
+    if (sys->prealloc_end < 0)
+        return; /* not supported */
+
+    off_t pos = lseek(sys->fd, 0, SEEK_CUR);
+    if (pos == -1 || pos + (off_t)size <= sys->prealloc_end)
+        return;
+
+    /* Reserve large extents ahead of time, so that the file system does not
+     * allocate (and fragment) the file one small write at a time. */
+    off_t len = PREALLOC_SIZE + size;
+    if (fallocate(sys->fd, FALLOC_FL_KEEP_SIZE, pos, len) == 0)
+        sys->prealloc_end = pos + len;
+    else
+        sys->prealloc_end = -1;
+#else
+    VLC_UNUSED(sys); VLC_UNUSED(size);
+#endif
+}
+
+static int WriteBlocks(sout_access_out_t *access, block_t *block)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+
+    while (block != NULL)
+    {
+        struct iovec iov[WRITE_IOV_MAX];
+        size_t total = 0;
+        int count = 0;
+
+        for (block_t *b = block; b != NULL && count < WRITE_IOV_MAX;
+             b = b->p_next)
+        {
+            iov[count].iov_base = b->p_buffer;
+            iov[count].iov_len = b->i_buffer;
+            total += b->i_buffer;
+            count++;
+        }
+
+        Preallocate(sys, total);
+
+        ssize_t val = vlc_writev(sys->fd, iov, count);
+        if (val < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            int err = errno;
+            block_ChainRelease(block);
+            msg_Err(access, "cannot write: %s", vlc_strerror_c(err));
+            return err;
+        }
+
+        size_t done = val;
+        assert(done <= total);
+
+        while (block != NULL && block->i_buffer <= done)
+        {
+            block_t *next = block->p_next;
+
+            done -= block->i_buffer;
+            block_Release(block);
+            block = next;
+        }
+
+        if (done > 0)
+        {
+            block->p_buffer += done;
+            block->i_buffer -= done;
+        }
+
+        vlc_mutex_lock(&sys->lock);
+        sys->queue_size -= val;
+        vlc_cond_signal(&sys->wait_space);
+        vlc_mutex_unlock(&sys->lock);
+    }
+    return 0;
+}
+
+static void *WriterThread(void *data)
+{
+    sout_access_out_t *access = data;
+    sout_access_out_sys_t *sys = access->p_sys;
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;)
+    {
+        while (sys->queue == NULL && !sys->closing)
+            vlc_cond_wait(&sys->wait_data, &sys->lock);
+
+        block_t *block = sys->queue;
+        if (block == NULL)
+            break; /* closing, and everything was written */
+
+        /* Take the whole queue, so that it is written in as few system calls
+         * as possible. */
+        sys->queue = NULL;
+        sys->queue_last = &sys->queue;
+        sys->writing = true;
+        vlc_mutex_unlock(&sys->lock);
+
+        int err = WriteBlocks(access, block);
+
+        vlc_mutex_lock(&sys->lock);
+        sys->writing = false;
+        if (err != 0)
+        {
+            /* Fail all pending and further writes */
+            block_ChainRelease(sys->queue);
+            sys->queue = NULL;
+            sys->queue_last = &sys->queue;
+            sys->queue_size = 0;
+            sys->error = err;
+        }
+        vlc_cond_signal(&sys->wait_space);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static ssize_t WriteAsync(sout_access_out_t *access, block_t *block)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+    block_t *last = block;
+    size_t size = 0;
+
+    if (block == NULL)
+        return 0;
+
+    for (block_t *b = block; b != NULL; b = b->p_next)
+    {
+        size += b->i_buffer;
+        last = b;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    /* A chain larger than the limit is accepted if the queue is empty. */
+    if (sys->error == 0 && sys->queue_size > 0
+     && sys->queue_size + size > sys->queue_max)
+    {
+        sys->stalls++;
+        do
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+        while (sys->error == 0 && sys->queue_size > 0
+            && sys->queue_size + size > sys->queue_max);
+    }
+
+    if (sys->error != 0)
+    {   /* The error was already reported by the writer thread. */
+        vlc_mutex_unlock(&sys->lock);
+        block_ChainRelease(block);
+        return -1;
+    }
+
+    *sys->queue_last = block;
+    sys->queue_last = &last->p_next;
+    sys->queue_size += size;
+    if (sys->queue_size > sys->queue_peak)
+        sys->queue_peak = sys->queue_size;
+    vlc_cond_signal(&sys->wait_data);
+    vlc_mutex_unlock(&sys->lock);
+    return size;
+}
+
+/**
+ * Waits for all queued data to be written.
+ * \return 0 on success, or the error code of the failed write
+ */
+static int Drain(sout_access_out_sys_t *sys)
+{
+    vlc_mutex_lock(&sys->lock);
+    while (sys->error == 0 && (sys->queue != NULL || sys->writing))
+        vlc_cond_wait(&sys->wait_space, &sys->lock);
+    int err = sys->error;
+    vlc_mutex_unlock(&sys->lock);
+    return err;
+}
+
+static int StartWriter(sout_access_out_t *access, size_t queue_max,
+                       bool prealloc)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait_data);
+    vlc_cond_init(&sys->wait_space);
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queue_size = 0;
+    sys->queue_max = queue_max;
+    sys->queue_peak = 0;
+    sys->stalls = 0;
+    sys->writing = false;
+    sys->closing = false;
+    sys->error = 0;
+#if defined (__linux__) && defined (FALLOC_FL_KEEP_SIZE)
+    sys->prealloc_end = prealloc ? 0 : -1;
+#else
+    VLC_UNUSED(prealloc);
+#endif
+
+    if (vlc_clone(&sys->thread, WriterThread, access,
+                  VLC_THREAD_PRIORITY_OUTPUT))
+        return VLC_EGENERIC;
+
+    sys->async = true;
+    return VLC_SUCCESS;
+}
+
+static void StopWriter(sout_access_out_t *access)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->closing = true;
+    vlc_cond_signal(&sys->wait_data);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+#if defined (__linux__) && defined (FALLOC_FL_PUNCH_HOLE)
+    /* Release the reserved space past the end of the file */
+    struct stat st;
+
+    if (sys->prealloc_end > 0 && fstat(sys->fd, &st) == 0
+     && st.st_size < sys->prealloc_end)
+        fallocate(sys->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  st.st_size, sys->prealloc_end - st.st_size);
+#endif
+
+    msg_Dbg(access, "write queue peak: %zu of %zu bytes, %u stall(s)",
+            sys->queue_peak, sys->queue_max, sys->stalls);
+}
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
 static int Seek( sout_access_out_t *p_access, off_t i_pos )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
+
+    if (p_sys->async && Drain(p_sys) != 0)
+        return -1;
 
     return lseek(fd, i_pos, SEEK_SET);
 }
@@ -221,6 +504,7 @@ static const char *const ppsz_sout_options[] = {
     "append",
     "format",
     "overwrite",
+    "queue",
 #ifdef O_SYNC
     "sync",
 #endif
@@ -234,9 +518,9 @@ static int Open( vlc_object_t *p_this )
 {
     sout_access_out_t   *p_access = (sout_access_out_t*)p_this;
     int fd;
-    int *fdp = vlc_obj_malloc(p_this, sizeof (*fdp));
+    sout_access_out_sys_t *p_sys = vlc_obj_malloc(p_this, sizeof (*p_sys));
 
-    if (unlikely(fdp == NULL))
+    if (unlikely(p_sys == NULL))
         return VLC_ENOMEM;
 
     config_ChainParse( p_access, SOUT_CFG_PREFIX, ppsz_sout_options, p_access->p_cfg );
@@ -321,8 +605,9 @@ static int Open( vlc_object_t *p_this )
             return VLC_EGENERIC;
     }
 
-    *fdp = fd;
-    p_access->p_sys = fdp;
+    p_sys->fd = fd;
+    p_sys->async = false;
+    p_access->p_sys = p_sys;
 
     struct stat st;
 
@@ -358,6 +643,11 @@ static int Open( vlc_object_t *p_this )
     if (append)
         lseek (fd, 0, SEEK_END);
 
+    int64_t queue = var_GetInteger (p_access, SOUT_CFG_PREFIX"queue");
+    if (p_access->pf_write == Write && queue > 0
+     && StartWriter (p_access, queue << 10, S_ISREG(st.st_mode)) == 0)
+        p_access->pf_write = WriteAsync;
+
     return VLC_SUCCESS;
 }
 
@@ -367,8 +657,11 @@ static int Open( vlc_object_t *p_this )
 static void Close( vlc_object_t * p_this )
 {
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    int fd = p_sys->fd;
 
+    if (p_sys->async)
+        StopWriter(p_access);
     vlc_close(fd);
     msg_Dbg( p_access, "file access output closed" );
 }
@@ -382,6 +675,10 @@ static void Close( vlc_object_t * p_this )
 #define FORMAT_TEXT N_("Format time and date")
 #define FORMAT_LONGTEXT N_("Perform ISO C time and date formatting " \
     "on the file path")
+#define QUEUE_TEXT N_("Write queue size (kiB)")
+#define QUEUE_LONGTEXT N_( \
+    "Maximum amount of data waiting to be written to the file by a " \
+    "background thread. 0 disables asynchronous writing.")
 #define SYNC_TEXT N_("Synchronous writing")
 #define SYNC_LONGTEXT N_( "Open the file with synchronous writing.")
 
@@ -398,6 +695,9 @@ vlc_module_begin ()
               true )
     add_bool( SOUT_CFG_PREFIX "format", false, FORMAT_TEXT, FORMAT_LONGTEXT,
               true )
+    add_integer( SOUT_CFG_PREFIX "queue", 8192, QUEUE_TEXT, QUEUE_LONGTEXT,
+                 true )
+        change_integer_range( 0, 1 << 20 )
 #ifdef O_SYNC
     add_bool( SOUT_CFG_PREFIX "sync", false, SYNC_TEXT,SYNC_LONGTEXT,
               false )
@@ -43,6 +43,8 @@
 #include <vlc_fs.h>
 #include <vlc_strings.h>
 #include <vlc_charset.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
 
 #include <gcrypt.h>
 #include <vlc_gcrypt.h>
@@ -102,6 +104,29 @@ static void Close( vlc_object_t * );
 #define RANDOMIV_TEXT N_("Use randomized IV for encryption")
 #define RANDOMIV_LONGTEXT N_("Generate IV instead using segment-number as IV")
 
+#define INITSEG_TEXT N_("Initialization segment")
+#define INITSEG_LONGTEXT N_("Path to the file where the header of fragmented "\
+                            "MP4 streams is written. Segments then only hold "\
+                            "the fragments, as CMAF expects.")
+
+#define INITURL_TEXT N_("Initialization segment URL")
+#define INITURL_LONGTEXT N_("URL of the initialization segment to put in the "\
+                            "index file, if different from its path")
+
+#define PARTS_TEXT N_("Publish partial segments")
+#define PARTS_LONGTEXT N_("List each keyframe group (or fragment for MP4) in "\
+                          "the index as soon as it is written, as a byte "\
+                          "range of the segment, for low latency players.")
+
+#define MEMORY_TEXT N_("Serve from memory")
+#define MEMORY_LONGTEXT N_("Keep the index and the last segments in memory "\
+                           "and serve them with the built-in HTTP server "\
+                           "(see http-host and http-port), instead of "\
+                           "writing files. The index path is used as URL.")
+
+#define SPILL_TEXT N_("Also write to disk")
+#define SPILL_LONGTEXT N_("Write the files too when serving from memory.")
+
 #define INTITIAL_SEG_TEXT N_("Number of first segment")
 #define INITIAL_SEG_LONGTEXT N_("The number of the first segment generated")
 
@@ -135,6 +160,16 @@ vlc_module_begin ()
                  KEYFILE_TEXT, KEYFILE_LONGTEXT)
     add_loadfile(SOUT_CFG_PREFIX "key-loadfile", NULL,
                  KEYLOADFILE_TEXT, KEYLOADFILE_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "init-segment", NULL,
+                INITSEG_TEXT, INITSEG_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "init-url", NULL,
+                INITURL_TEXT, INITURL_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "parts", false,
+              PARTS_TEXT, PARTS_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "memory", false,
+              MEMORY_TEXT, MEMORY_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "spill", false,
+              SPILL_TEXT, SPILL_LONGTEXT, true )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -156,12 +191,24 @@ static const char *const ppsz_sout_options[] = {
     "key-loadfile",
     "generate-iv",
     "initial-segment-number",
+    "init-segment",
+    "init-url",
+    "parts",
+    "memory",
+    "spill",
     NULL
 };
 
 static ssize_t Write( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
+typedef struct output_part
+{
+    size_t i_offset;
+    size_t i_size;
+    float f_duration;
+} output_part_t;
+
 typedef struct output_segment
 {
     char *psz_filename;
@@ -171,6 +218,12 @@ typedef struct output_segment
     float f_seglength;
     uint32_t i_segment_number;
     uint8_t aes_ivs[16];
+    output_part_t *p_parts;
+    size_t i_parts;
+    uint8_t *p_data;
+    size_t i_data;
+    size_t i_data_alloc;
+    httpd_file_t *p_file;
 } output_segment_t;
 
 typedef struct
@@ -179,8 +232,11 @@ typedef struct
     char *psz_indexPath;
     char *psz_indexUrl;
     char *psz_keyfile;
+    char *psz_initPath;
+    char *psz_initUrl;
     vlc_tick_t i_keyfile_modification;
     vlc_tick_t i_opendts;
+    vlc_tick_t i_lastdts;
     vlc_tick_t  i_seglenm;
     uint32_t i_segment;
     size_t  i_seglen;
@@ -198,6 +254,22 @@ typedef struct
     bool b_caching;
     bool b_generate_iv;
     bool b_segment_has_data;
+    bool b_probed;
+    bool b_fmp4;
+    bool b_init_written;
+    bool b_parts;
+    size_t i_part_offset;
+    float f_part_target;
+    bool b_segment_open;
+    bool b_memory;
+    bool b_spill;
+    httpd_host_t *p_host;
+    httpd_file_t *p_index_file;
+    httpd_file_t *p_init_file;
+    block_t *p_init;
+    vlc_mutex_t index_lock;
+    char *psz_index;
+    size_t i_index;
     uint8_t aes_ivs[16];
     gcry_cipher_hd_t aes_ctx;
     char *key_uri;
@@ -210,7 +282,57 @@ static int LoadCryptFile( sout_access_out_t *p_access);
 static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
 static ssize_t writeSegment( sout_access_out_t *p_access );
+static ssize_t writePart( sout_access_out_t *p_access );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
+static int IndexCallback( httpd_file_sys_t *, httpd_file_t *,
+                          uint8_t *, uint8_t **, int * );
+static httpd_file_t *httpFileNew( sout_access_out_sys_t *, const char *,
+                                  const char *, httpd_file_callback_t, void * );
+
+#define MEMORY_DEFAULT_SEGS 5
+
+/*****************************************************************************
+ * OpenHttp: Set up serving from memory
+ *****************************************************************************/
+static int OpenHttp( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys )
+{
+    if( !p_sys->psz_indexPath )
+    {
+        msg_Err( p_access, "an index is needed to serve from memory" );
+        return VLC_EGENERIC;
+    }
+
+    /* Memory holds a ring of the last segments */
+    if( p_sys->i_numsegs == 0 )
+    {
+        msg_Warn( p_access, "keeping the last %d segments in memory",
+                  MEMORY_DEFAULT_SEGS );
+        p_sys->i_numsegs = MEMORY_DEFAULT_SEGS;
+    }
+    p_sys->b_delsegs = true;
+
+    if( p_sys->b_parts )
+    {
+        msg_Warn( p_access, "partial segments need byte ranges, "
+                  "which the HTTP server does not serve" );
+        p_sys->b_parts = false;
+    }
+
+    p_sys->p_host = vlc_http_HostNew( VLC_OBJECT(p_access) );
+    if( !p_sys->p_host )
+        return VLC_EGENERIC;
+
+    p_sys->p_index_file = httpFileNew( p_sys, p_sys->psz_indexPath,
+                                       "application/vnd.apple.mpegurl",
+                                       IndexCallback, p_sys );
+    if( !p_sys->p_index_file )
+    {
+        msg_Err( p_access, "cannot serve %s", p_sys->psz_indexPath );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Open: open the file
  *****************************************************************************/
@@ -298,6 +420,47 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_handle = -1;
     p_sys->i_segment = p_sys->i_initial_segment-1;
     p_sys->psz_cursegPath = NULL;
+    p_sys->i_lastdts = VLC_TICK_INVALID;
+
+    char *psz_init = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "init-segment" );
+    if( psz_init )
+    {
+        p_sys->psz_initPath = vlc_strftime( psz_init );
+        free( psz_init );
+        p_sys->psz_initUrl = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "init-url" );
+        if( !p_sys->psz_initUrl && p_sys->psz_initPath )
+            p_sys->psz_initUrl = strdup( p_sys->psz_initPath );
+    }
+
+    p_sys->b_parts = var_GetBool( p_access, SOUT_CFG_PREFIX "parts" );
+    if( p_sys->b_parts && ( p_sys->key_uri || p_sys->psz_keyfile ) )
+    {
+        /* CBC runs over the whole segment: parts could not be decrypted alone */
+        msg_Warn( p_access, "partial segments are not supported with encryption" );
+        p_sys->b_parts = false;
+    }
+
+    p_sys->b_memory = var_GetBool( p_access, SOUT_CFG_PREFIX "memory" );
+    p_sys->b_spill = var_GetBool( p_access, SOUT_CFG_PREFIX "spill" );
+    vlc_mutex_init( &p_sys->index_lock );
+    if( p_sys->b_memory && OpenHttp( p_access, p_sys ) )
+    {
+        if( p_sys->p_host )
+            httpd_HostDelete( p_sys->p_host );
+        vlc_mutex_destroy( &p_sys->index_lock );
+        if( p_sys->key_uri )
+        {
+            gcry_cipher_close( p_sys->aes_ctx );
+            free( p_sys->key_uri );
+        }
+        free( p_sys->psz_initUrl );
+        free( p_sys->psz_initPath );
+        free( p_sys->psz_keyfile );
+        free( p_sys->psz_indexUrl );
+        free( p_sys->psz_indexPath );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
 
     p_access->pf_write = Write;
     p_access->pf_control = Control;
@@ -504,6 +667,10 @@ static char *formatSegmentPath( char *psz_path, uint32_t i_seg )
 
 static void destroySegment( output_segment_t *segment )
 {
+    if( segment->p_file )
+        httpd_FileDelete( segment->p_file );
+    free( segment->p_data );
+    free( segment->p_parts );
     free( segment->psz_filename );
     free( segment->psz_duration );
     free( segment->psz_uri );
@@ -553,6 +720,47 @@ static bool isFirstItemRemovable( sout_access_out_sys_t *p_sys, uint32_t i_first
     return duration >= (first->f_seglength + (float)(p_sys->i_numsegs * p_sys->i_seglen));
 }
 
+/************************************************************************
+ * writeIndexFile: Atomically replace the index file
+ ************************************************************************/
+static int writeIndexFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                           const char *psz_index, size_t i_index )
+{
+    char *psz_idxTmp;
+    if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
+        return -1;
+
+    FILE *fp = vlc_fopen( psz_idxTmp, "wt");
+    if ( !fp )
+    {
+        msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
+        free( psz_idxTmp );
+        return -1;
+    }
+
+    size_t i_written = fwrite( psz_index, 1, i_index, fp );
+    if ( fclose( fp ) || i_written != i_index )
+    {
+        vlc_unlink( psz_idxTmp );
+        free( psz_idxTmp );
+        msg_Err( p_access, "Error writing LiveHttp index file" );
+        return -1;
+    }
+
+    int val = vlc_rename ( psz_idxTmp, p_sys->psz_indexPath);
+
+    if ( val < 0 )
+    {
+        vlc_unlink( psz_idxTmp );
+        msg_Err( p_access, "Error moving LiveHttp index file" );
+    }
+    else
+        msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
+
+    free( psz_idxTmp );
+    return val;
+}
+
 /************************************************************************
  * updateIndexAndDel: If necessary, update index file & delete old segments
  ************************************************************************/
@@ -577,35 +785,39 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
     // First update index
     if ( p_sys->psz_indexPath )
     {
-        int val;
-        FILE *fp;
-        char *psz_idxTmp;
-        if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
+        struct vlc_memstream ms;
+        if ( vlc_memstream_open( &ms ) )
             return -1;
 
-        fp = vlc_fopen( psz_idxTmp, "wt");
-        if ( !fp )
-        {
-            msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
-            free( psz_idxTmp );
-            return -1;
-        }
+        /* EXT-X-MAP needs version 6, and so do byte ranges without it */
+        bool b_map = p_sys->psz_initUrl && p_sys->b_init_written;
+        vlc_memstream_printf( &ms, "#EXTM3U\n#EXT-X-TARGETDURATION:%zu\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
+                              "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", p_sys->i_seglen,
+                              ( b_map || p_sys->b_parts ) ? 6 : 3,
+                              p_sys->b_caching ? "YES" : "NO",
+                              p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
+                              i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : "" );
+
+        if( b_map )
+            vlc_memstream_printf( &ms, "#EXT-X-MAP:URI=\"%s\"\n", p_sys->psz_initUrl );
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%zu\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
-                          "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", p_sys->i_seglen,
-                          p_sys->b_caching ? "YES" : "NO",
-                          p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
-                          i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
-                          ) < 0 )
+        bool b_error = false;
+        if( p_sys->f_part_target > 0.f )
         {
-            free( psz_idxTmp );
-            fclose( fp );
-            return -1;
+            char *psz_partinf;
+            if( us_asprintf( &psz_partinf, "#EXT-X-PART-INF:PART-TARGET=%.3f\n"
+                             "#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=%.3f\n",
+                             p_sys->f_part_target, 3 * p_sys->f_part_target ) < 0 )
+                b_error = true;
+            else
+            {
+                vlc_memstream_puts( &ms, psz_partinf );
+                free( psz_partinf );
+            }
         }
-        char *psz_current_uri=NULL;
+        const char *psz_current_uri = NULL;
 
-
-        for ( uint32_t i = i_firstseg; i <= p_sys->i_segment; i++ )
+        for ( uint32_t i = i_firstseg; !b_error && i <= p_sys->i_segment; i++ )
         {
             //scale to i_index_offset..numsegs + i_index_offset
             uint32_t index = i - i_firstseg + i_index_offset;
@@ -615,9 +827,7 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 ( !psz_current_uri ||  strcmp( psz_current_uri, segment->psz_key_uri ) )
               )
             {
-                int ret = 0;
-                free( psz_current_uri );
-                psz_current_uri = strdup( segment->psz_key_uri );
+                psz_current_uri = segment->psz_key_uri;
                 if( p_sys->b_generate_iv )
                 {
                     unsigned long long iv_hi = segment->aes_ivs[0];
@@ -629,55 +839,61 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                         iv_lo <<= 8;
                         iv_lo |= segment->aes_ivs[8+j] & 0xff;
                     }
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
-                                   segment->psz_key_uri, iv_hi, iv_lo );
+                    vlc_memstream_printf( &ms, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
+                                          segment->psz_key_uri, iv_hi, iv_lo );
 
                 } else {
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
-                }
-                if( ret < 0 )
-                {
-                    free( psz_current_uri );
-                    free( psz_idxTmp );
-                    fclose( fp );
-                    return -1;
+                    vlc_memstream_printf( &ms, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
                 }
             }
 
-            val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
-            if ( val < 0 )
+            /* Parts are only listed for the last segments, close to the live edge */
+            for( size_t j = 0; i + 3 > p_sys->i_segment && j < segment->i_parts; j++ )
             {
-                free( psz_current_uri );
-                free( psz_idxTmp );
-                fclose( fp );
-                return -1;
+                const output_part_t *part = &segment->p_parts[j];
+                char *psz_part;
+                if( us_asprintf( &psz_part, "#EXT-X-PART:DURATION=%.3f,URI=\"%s\","
+                                 "BYTERANGE=\"%zu@%zu\"%s\n", part->f_duration,
+                                 segment->psz_uri, part->i_size, part->i_offset,
+                                 ( p_sys->b_fmp4 || p_sys->b_splitanywhere ) ? "" : ",INDEPENDENT=YES" ) < 0 )
+                {
+                    b_error = true;
+                    break;
+                }
+                vlc_memstream_puts( &ms, psz_part );
+                free( psz_part );
             }
+
+            /* The segment being written only has its parts */
+            if ( segment->psz_duration )
+                vlc_memstream_printf( &ms, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
         }
-        free( psz_current_uri );
 
         if ( b_isend )
-        {
-            if ( fputs ( STR_ENDLIST, fp ) < 0)
-            {
-                free( psz_idxTmp );
-                fclose( fp ) ;
-                return -1;
-            }
+            vlc_memstream_puts( &ms, STR_ENDLIST );
 
+        if ( vlc_memstream_close( &ms ) )
+            return -1;
+        if ( b_error )
+        {
+            free( ms.ptr );
+            return -1;
         }
-        fclose( fp );
 
-        val = vlc_rename ( psz_idxTmp, p_sys->psz_indexPath);
+        if ( !p_sys->b_memory || p_sys->b_spill )
+            writeIndexFile( p_access, p_sys, ms.ptr, ms.length );
 
-        if ( val < 0 )
+        if ( p_sys->b_memory )
         {
-            vlc_unlink( psz_idxTmp );
-            msg_Err( p_access, "Error moving LiveHttp index file" );
+            /* Handed over to the HTTP server thread */
+            vlc_mutex_lock( &p_sys->index_lock );
+            free( p_sys->psz_index );
+            p_sys->psz_index = ms.ptr;
+            p_sys->i_index = ms.length;
+            vlc_mutex_unlock( &p_sys->index_lock );
         }
         else
-            msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
-
-        free( psz_idxTmp );
+            free( ms.ptr );
     }
 
     // Then take care of deletion
@@ -703,12 +919,152 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
     return 0;
 }
 
+/*****************************************************************************
+ * segmentWrite: Write to the current segment file and/or memory
+ *****************************************************************************/
+static ssize_t segmentWrite( sout_access_out_t *p_access, const uint8_t *p_data, size_t i_data )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_sys->i_handle >= 0 )
+    {
+        ssize_t val = vlc_write( p_sys->i_handle, p_data, i_data );
+        if( val < 0 )
+            return val;
+        i_data = val;
+    }
+
+    if( p_sys->b_memory )
+    {
+        output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t,
+                                        vlc_array_count( &p_sys->segments_t ) - 1 );
+        if( segment->i_data + i_data > segment->i_data_alloc )
+        {
+            size_t i_alloc = __MAX( 2 * segment->i_data_alloc, segment->i_data + i_data );
+            uint8_t *p_buf = realloc( segment->p_data, i_alloc );
+            if( unlikely( p_buf == NULL ) )
+            {
+                errno = ENOMEM;
+                return -1;
+            }
+            segment->p_data = p_buf;
+            segment->i_data_alloc = i_alloc;
+        }
+        memcpy( &segment->p_data[segment->i_data], p_data, i_data );
+        segment->i_data += i_data;
+    }
+    return i_data;
+}
+
+/*****************************************************************************
+ * HTTP callbacks, called with the HTTP host lock held
+ *****************************************************************************/
+static int HttpCopy( const uint8_t *p_src, size_t i_src,
+                     uint8_t **pp_data, int *pi_data )
+{
+    *pp_data = malloc( i_src );
+    if( unlikely( *pp_data == NULL && i_src > 0 ) )
+    {
+        *pi_data = 0;
+        return VLC_ENOMEM;
+    }
+    if( i_src > 0 )
+        memcpy( *pp_data, p_src, i_src );
+    *pi_data = i_src;
+    return VLC_SUCCESS;
+}
+
+static int SegmentCallback( httpd_file_sys_t *p_args, httpd_file_t *f,
+                            uint8_t *p_request, uint8_t **pp_data, int *pi_data )
+{
+    VLC_UNUSED(f); VLC_UNUSED(p_request);
+    /* Published segments are not modified, and httpd_FileDelete() cannot
+     * return while this runs, so no lock is needed */
+    const output_segment_t *segment = (const output_segment_t *)p_args;
+
+    return HttpCopy( segment->p_data, segment->i_data, pp_data, pi_data );
+}
+
+static int InitCallback( httpd_file_sys_t *p_args, httpd_file_t *f,
+                         uint8_t *p_request, uint8_t **pp_data, int *pi_data )
+{
+    VLC_UNUSED(f); VLC_UNUSED(p_request);
+    sout_access_out_sys_t *p_sys = (sout_access_out_sys_t *)p_args;
+    int ret;
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    ret = HttpCopy( p_sys->p_init->p_buffer, p_sys->p_init->i_buffer,
+                    pp_data, pi_data );
+    vlc_mutex_unlock( &p_sys->index_lock );
+    return ret;
+}
+
+static int IndexCallback( httpd_file_sys_t *p_args, httpd_file_t *f,
+                          uint8_t *p_request, uint8_t **pp_data, int *pi_data )
+{
+    VLC_UNUSED(f); VLC_UNUSED(p_request);
+    sout_access_out_sys_t *p_sys = (sout_access_out_sys_t *)p_args;
+    int ret;
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    ret = HttpCopy( (const uint8_t *)p_sys->psz_index, p_sys->i_index,
+                    pp_data, pi_data );
+    vlc_mutex_unlock( &p_sys->index_lock );
+    return ret;
+}
+
+/* The HTTP server wants paths, the index may have relative or full URLs */
+static char *httpPath( const char *psz_uri )
+{
+    const char *psz_scheme = strstr( psz_uri, "://" );
+    if( psz_scheme )
+    {
+        const char *psz_path = strchr( psz_scheme + 3, '/' );
+        return strdup( psz_path ? psz_path : "/" );
+    }
+
+    char *psz_path;
+    if( asprintf( &psz_path, "%s%s", psz_uri[0] == '/' ? "" : "/", psz_uri ) < 0 )
+        return NULL;
+    return psz_path;
+}
+
+static httpd_file_t *httpFileNew( sout_access_out_sys_t *p_sys, const char *psz_uri,
+                                  const char *psz_mime, httpd_file_callback_t pf_fill,
+                                  void *p_args )
+{
+    char *psz_path = httpPath( psz_uri );
+    if( unlikely( psz_path == NULL ) )
+        return NULL;
+
+    httpd_file_t *p_file = httpd_FileNew( p_sys->p_host, psz_path, psz_mime,
+                                          NULL, NULL, pf_fill, p_args );
+    free( psz_path );
+    return p_file;
+}
+
+/*****************************************************************************
+ * publishSegment: Serve a complete segment over HTTP
+ *****************************************************************************/
+static void publishSegment( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                            output_segment_t *segment )
+{
+    if( unlikely( segment->psz_uri == NULL ) )
+        return;
+
+    segment->p_file = httpFileNew( p_sys, segment->psz_uri,
+                                   p_sys->b_fmp4 ? "video/mp4" : "video/MP2T",
+                                   SegmentCallback, segment );
+    if( segment->p_file == NULL )
+        msg_Err( p_access, "cannot serve segment %s", segment->psz_uri );
+}
+
 /*****************************************************************************
  * closeCurrentSegment: Close the segment file
  *****************************************************************************/
 static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys, bool b_isend )
 {
-    if ( p_sys->i_handle >= 0 )
+    if ( p_sys->b_segment_open )
     {
         output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, vlc_array_count( &p_sys->segments_t ) - 1 );
 
@@ -722,7 +1078,7 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
                msg_Err( p_access, "Couldn't encrypt 16 bytes: %s", gpg_strerror(err) );
             } else {
 
-            int ret = vlc_write( p_sys->i_handle, p_sys->stuffing_bytes, 16 );
+            int ret = segmentWrite( p_access, p_sys->stuffing_bytes, 16 );
             if( ret != 16 )
                 msg_Err( p_access, "Couldn't write 16 bytes" );
             }
@@ -730,8 +1086,10 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
         }
 
 
-        vlc_close( p_sys->i_handle );
+        if( p_sys->i_handle >= 0 )
+            vlc_close( p_sys->i_handle );
         p_sys->i_handle = -1;
+        p_sys->b_segment_open = false;
 
         if( ! ( us_asprintf( &segment->psz_duration, "%.2f", p_sys->f_seglen ) ) )
         {
@@ -742,6 +1100,9 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
 
         segment->i_segment_number = p_sys->i_segment;
 
+        if( p_sys->b_memory )
+            publishSegment( p_access, p_sys, segment );
+
         if ( p_sys->psz_cursegPath )
         {
             msg_Dbg( p_access, "LiveHttpSegmentComplete: %s (%"PRIu32")" , p_sys->psz_cursegPath, p_sys->i_segment );
@@ -784,7 +1145,7 @@ static void Close( vlc_object_t * p_this )
         p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
     }
 
-    ssize_t writevalue = writeSegment( p_access );
+    ssize_t writevalue = writePart( p_access );
     msg_Dbg( p_access, "Writing.. %zd", writevalue );
     if( unlikely( writevalue < 0 ) )
     {
@@ -815,6 +1176,24 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    if( p_sys->b_delsegs && p_sys->i_numsegs && p_sys->b_init_written &&
+        ( !p_sys->b_memory || p_sys->b_spill ) )
+        vlc_unlink( p_sys->psz_initPath );
+
+    if( p_sys->b_memory )
+    {
+        if( p_sys->p_init_file )
+            httpd_FileDelete( p_sys->p_init_file );
+        httpd_FileDelete( p_sys->p_index_file );
+        httpd_HostDelete( p_sys->p_host );
+        if( p_sys->p_init )
+            block_Release( p_sys->p_init );
+        free( p_sys->psz_index );
+    }
+    vlc_mutex_destroy( &p_sys->index_lock );
+
+    free( p_sys->psz_initUrl );
+    free( p_sys->psz_initPath );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -861,21 +1240,30 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     char *psz_idxFormat = p_sys->psz_indexUrl ? p_sys->psz_indexUrl : p_access->psz_path;
     segment->psz_uri = formatSegmentPath( psz_idxFormat , i_newseg );
 
-    if ( unlikely( !segment->psz_filename ) )
+    if ( unlikely( !segment->psz_filename || !segment->psz_uri ) )
     {
         msg_Err( p_access, "Format segmentpath failed");
         destroySegment( segment );
         return -1;
     }
 
-    fd = vlc_open( segment->psz_filename, O_WRONLY | O_CREAT | O_LARGEFILE |
-                     O_TRUNC, 0666 );
-    if ( fd == -1 )
+    if ( p_sys->b_memory && !p_sys->b_spill )
     {
-        msg_Err( p_access, "cannot open `%s' (%s)", segment->psz_filename,
-                 vlc_strerror_c(errno) );
-        destroySegment( segment );
-        return -1;
+        /* Nothing to delete from the disk afterwards */
+        FREENULL( segment->psz_filename );
+        fd = -1;
+    }
+    else
+    {
+        fd = vlc_open( segment->psz_filename, O_WRONLY | O_CREAT | O_LARGEFILE |
+                         O_TRUNC, 0666 );
+        if ( fd == -1 )
+        {
+            msg_Err( p_access, "cannot open `%s' (%s)", segment->psz_filename,
+                     vlc_strerror_c(errno) );
+            destroySegment( segment );
+            return -1;
+        }
     }
 
     vlc_array_append_or_abort( &p_sys->segments_t, segment );
@@ -892,13 +1280,17 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
         if( p_sys->b_generate_iv )
             memcpy( segment->aes_ivs, p_sys->aes_ivs, sizeof(uint8_t)*16 );
     }
-    msg_Dbg( p_access, "Successfully opened livehttp file: %s (%"PRIu32")" , segment->psz_filename, i_newseg );
+    p_sys->psz_cursegPath = strdup( segment->psz_filename ? segment->psz_filename
+                                                          : segment->psz_uri );
+    msg_Dbg( p_access, "Successfully opened livehttp file: %s (%"PRIu32")" , p_sys->psz_cursegPath, i_newseg );
 
-    p_sys->psz_cursegPath = strdup(segment->psz_filename);
+    p_sys->b_segment_open = true;
     p_sys->i_handle = fd;
     p_sys->i_segment = i_newseg;
     p_sys->b_segment_has_data = false;
-    return fd;
+    p_sys->i_part_offset = 0;
+    p_sys->f_seglen = 0.f;
+    return __MAX( fd, 0 );
 }
 /*****************************************************************************
  * CheckSegmentChange: Check if segment needs to be closed and new opened
@@ -908,10 +1300,10 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     ssize_t writevalue = 0;
 
-    if( p_sys->i_handle > 0 && p_sys->b_segment_has_data &&
+    if( p_sys->b_segment_open && p_sys->b_segment_has_data &&
        (( p_buffer->i_length + p_buffer->i_dts - p_sys->i_opendts ) >= p_sys->i_seglenm ) )
     {
-        writevalue = writeSegment( p_access );
+        writevalue = writePart( p_access );
         if( unlikely( writevalue < 0 ) )
         {
             block_ChainRelease ( p_buffer );
@@ -921,7 +1313,7 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
         return writevalue;
     }
 
-    if ( unlikely( p_sys->i_handle < 0 ) )
+    if ( unlikely( !p_sys->b_segment_open ) )
     {
         p_sys->i_opendts = p_buffer->i_dts;
 
@@ -990,7 +1382,7 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
 
         }
 
-        ssize_t val = vlc_write( p_sys->i_handle, output->p_buffer, output->i_buffer );
+        ssize_t val = segmentWrite( p_access, output->p_buffer, output->i_buffer );
         if ( val == -1 )
         {
            if ( errno == EINTR )
@@ -1018,6 +1410,104 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     return i_write;
 }
 
+/*****************************************************************************
+ * writePart: Write the full segments, and remember them as a partial segment
+ *****************************************************************************/
+static ssize_t writePart( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    float f_start = p_sys->f_seglen;
+
+    ssize_t i_write = writeSegment( p_access );
+    if( i_write <= 0 || !p_sys->b_parts || !p_sys->b_segment_open )
+        return i_write;
+
+    output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t,
+                                    vlc_array_count( &p_sys->segments_t ) - 1 );
+    output_part_t *parts = realloc( segment->p_parts,
+                                    ( segment->i_parts + 1 ) * sizeof( *parts ) );
+    if( likely( parts ) )
+    {
+        output_part_t *part = &parts[segment->i_parts++];
+        part->i_offset = p_sys->i_part_offset;
+        part->i_size = i_write;
+        part->f_duration = __MAX( p_sys->f_seglen - f_start, 0.f );
+        segment->p_parts = parts;
+
+        if( part->f_duration > p_sys->f_part_target )
+            p_sys->f_part_target = part->f_duration;
+    }
+    p_sys->i_part_offset += i_write;
+    return i_write;
+}
+
+/*****************************************************************************
+ * writeInitSegment: Write the header of fragmented MP4 in its own file
+ *****************************************************************************/
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_block )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t i_left = 0;
+
+    if( !p_sys->b_memory || p_sys->b_spill )
+    {
+        int fd = vlc_open( p_sys->psz_initPath, O_WRONLY | O_CREAT | O_LARGEFILE |
+                           O_TRUNC, 0666 );
+        if( fd == -1 )
+        {
+            msg_Err( p_access, "cannot open `%s' (%s)", p_sys->psz_initPath,
+                     vlc_strerror_c(errno) );
+            block_Release( p_block );
+            return -1;
+        }
+
+        const uint8_t *p_data = p_block->p_buffer;
+        i_left = p_block->i_buffer;
+        while( i_left > 0 )
+        {
+            ssize_t val = vlc_write( fd, p_data, i_left );
+            if( val == -1 )
+            {
+                if( errno == EINTR )
+                    continue;
+                msg_Err( p_access, "cannot write `%s' (%s)", p_sys->psz_initPath,
+                         vlc_strerror_c(errno) );
+                break;
+            }
+            p_data += val;
+            i_left -= val;
+        }
+        vlc_close( fd );
+    }
+
+    if( p_sys->b_memory )
+    {
+        vlc_mutex_lock( &p_sys->index_lock );
+        block_t *p_old = p_sys->p_init;
+        p_sys->p_init = p_block;
+        vlc_mutex_unlock( &p_sys->index_lock );
+        if( p_old )
+            block_Release( p_old );
+
+        if( !p_sys->p_init_file )
+            p_sys->p_init_file = httpFileNew( p_sys, p_sys->psz_initUrl, "video/mp4",
+                                              InitCallback, p_sys );
+        if( !p_sys->p_init_file )
+        {
+            msg_Err( p_access, "cannot serve %s", p_sys->psz_initUrl );
+            return -1;
+        }
+    }
+    else
+        block_Release( p_block );
+
+    if( i_left > 0 )
+        return -1;
+    msg_Dbg( p_access, "Wrote initialization segment %s", p_sys->psz_initPath );
+    p_sys->b_init_written = true;
+    return 0;
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -1027,10 +1517,51 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     while( p_buffer )
     {
+        if( !p_sys->b_probed )
+        {
+            p_sys->b_probed = true;
+            p_sys->b_fmp4 = p_buffer->i_buffer >= 8 &&
+                            !memcmp( &p_buffer->p_buffer[4], "ftyp", 4 );
+            if( p_sys->b_fmp4 )
+                msg_Dbg( p_access, "Fragmented MP4 stream" );
+            else if( p_sys->psz_initPath )
+                msg_Warn( p_access, "Initialization segment is only used with fragmented MP4" );
+        }
+
+        if( p_sys->b_fmp4 )
+        {
+            if( p_sys->psz_initPath && ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) )
+            {
+                block_t *p_temp = p_buffer->p_next;
+                p_buffer->p_next = NULL;
+                if( writeInitSegment( p_access, p_buffer ) < 0 )
+                {
+                    if( p_temp )
+                        block_ChainRelease( p_temp );
+                    return -1;
+                }
+                p_buffer = p_temp;
+                continue;
+            }
+
+            /* Boxes carry no timestamps: date them at the end of the
+             * previous samples, so that fragments can start segments */
+            if( p_buffer->i_dts == VLC_TICK_INVALID )
+                p_buffer->i_dts = p_sys->i_lastdts;
+            else
+            {
+                if( p_sys->b_segment_open && p_sys->i_opendts == VLC_TICK_INVALID )
+                    p_sys->i_opendts = p_buffer->i_dts;
+                if( p_buffer->i_dts + p_buffer->i_length > p_sys->i_lastdts )
+                    p_sys->i_lastdts = p_buffer->i_dts + p_buffer->i_length;
+            }
+        }
+
         /* Check if current block is already past segment-length
             and we want to write gathered blocks into segment
             and update playlist */
-        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) ) )
+        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) ||
+                                        ( p_sys->b_fmp4 && ( p_buffer->i_flags & BLOCK_FLAG_TYPE_I ) ) ) )
         {
             msg_Dbg( p_access, "Moving ongoing segment to full segments-queue" );
             block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
@@ -1047,6 +1578,20 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
         }
         i_write += ret;
 
+        /* Publish the gathered blocks without waiting for the segment end */
+        if( p_sys->b_parts && p_sys->b_segment_open && p_sys->full_segments )
+        {
+            ret = writePart( p_access );
+            if( ret < 0 )
+            {
+                msg_Err( p_access, "Error writing partial segment" );
+                block_ChainRelease( p_buffer );
+                return ret;
+            }
+            i_write += ret;
+            updateIndexAndDel( p_access, p_sys, false );
+        }
+
         block_t *p_temp = p_buffer->p_next;
         p_buffer->p_next = NULL;
         block_ChainLastAppend( &p_sys->ongoing_segment_end, p_buffer );
@@ -45,6 +45,11 @@
 #elif defined (HAVE_SYS_SOCKET_H)
 #   include <sys/socket.h>
 #endif
+#ifdef HAVE_SENDMMSG
+#   include <sys/uio.h>
+#   include <netinet/in.h>
+#   include <netinet/udp.h>
+#endif
 
 #include <vlc_network.h>
 
@@ -70,6 +75,14 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define WINDOW_TEXT N_("Batching window (ms)")
+#define WINDOW_LONGTEXT N_("Packets whose send time falls within this " \
+                           "window are sent together with a single system " \
+                           "call (segmentation offload is used if " \
+                           "available). This reduces the CPU load of many " \
+                           "concurrent streams, at the cost of up to this " \
+                           "much extra jitter. 0 disables batching." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -78,6 +91,11 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+#ifdef HAVE_SENDMMSG
+    add_integer( SOUT_CFG_PREFIX "window", 0, WINDOW_TEXT, WINDOW_LONGTEXT,
+                 true )
+        change_integer_range( 0, 100 )
+#endif
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -91,6 +109,9 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+#ifdef HAVE_SENDMMSG
+    "window",
+#endif
     NULL
 };
 
@@ -106,6 +127,12 @@ static ssize_t Write   ( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
+#ifdef HAVE_SENDMMSG
+static void* ThreadWriteBatch( void * );
+
+/* Maximum number of packets sent at once (also the kernel GSO limit) */
+#define BATCH_MAX 64
+#endif
 
 typedef struct
 {
@@ -118,6 +145,9 @@ typedef struct
     block_t      *p_buffer;
 
     vlc_thread_t  thread;
+#ifdef HAVE_SENDMMSG
+    vlc_tick_t    i_window;
+#endif
 } sout_access_out_sys_t;
 
 #define DEFAULT_PORT 1234
@@ -209,7 +239,15 @@ static int Open( vlc_object_t *p_this )
     p_sys->p_fifo = block_FifoNew();
     p_sys->p_buffer = NULL;
 
-    if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
+    void *(*entry)( void * ) = ThreadWrite;
+#ifdef HAVE_SENDMMSG
+    p_sys->i_window = VLC_TICK_FROM_MS(
+                     var_GetInteger( p_access, SOUT_CFG_PREFIX "window" ) );
+    if( p_sys->i_window > 0 )
+        entry = ThreadWriteBatch;
+#endif
+
+    if( vlc_clone( &p_sys->thread, entry, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
@@ -419,3 +457,216 @@ static void* ThreadWrite( void *data )
     }
     return NULL;
 }
+
+#ifdef HAVE_SENDMMSG
+struct udp_batch
+{
+    block_t *pkts[BATCH_MAX];
+    unsigned count;
+    block_t *pending; /* first packet of the next batch */
+    bool b_gso;
+    struct iovec iov[BATCH_MAX];
+    struct mmsghdr msgs[BATCH_MAX];
+};
+
+static void BatchRelease( void *data )
+{
+    struct udp_batch *batch = data;
+
+    for( unsigned i = 0; i < batch->count; i++ )
+        block_Release( batch->pkts[i] );
+    batch->count = 0;
+}
+
+static void BatchCleanup( void *data )
+{
+    struct udp_batch *batch = data;
+
+    BatchRelease( batch );
+    if( batch->pending != NULL )
+        block_Release( batch->pending );
+}
+
+#ifdef UDP_SEGMENT
+/**
+ * Sends the whole batch as one buffer segmented by the kernel (or the NIC).
+ * This requires all datagrams but the last one to have the same size.
+ *
+ * \return true if sent, false if segmentation offload cannot be used.
+ */
+static bool BatchSendGSO( sout_access_out_t *p_access, struct udp_batch *batch )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    const size_t i_seg = batch->pkts[0]->i_buffer;
+    size_t i_total = 0;
+
+    if( batch->count < 2 || i_seg == 0 )
+        return false;
+
+    for( unsigned i = 0; i < batch->count; i++ )
+    {
+        block_t *p_pk = batch->pkts[i];
+
+        if( p_pk->i_buffer > i_seg
+         || (p_pk->i_buffer < i_seg && i + 1 < batch->count) )
+            return false;
+        batch->iov[i].iov_base = p_pk->p_buffer;
+        batch->iov[i].iov_len = p_pk->i_buffer;
+        i_total += p_pk->i_buffer;
+    }
+
+    if( i_total > 65507 )
+        return false;
+
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = batch->iov,
+        .msg_iovlen = batch->count,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+    uint16_t i_gso = i_seg;
+
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (i_gso));
+    memcpy( CMSG_DATA(cmsg), &i_gso, sizeof (i_gso) );
+
+    if( sendmsg( p_sys->i_handle, &msg, 0 ) >= 0 )
+        return true;
+
+    if( errno == EINVAL || errno == EIO || errno == ENOPROTOOPT
+     || errno == EOPNOTSUPP )
+    {   /* Not supported by this kernel or device: do not try again */
+        msg_Dbg( p_access, "segmentation offload unavailable: %s",
+                 vlc_strerror_c(errno) );
+        batch->b_gso = false;
+        return false;
+    }
+
+    msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    return true;
+}
+#endif
+
+static void BatchSend( sout_access_out_t *p_access, struct udp_batch *batch )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+#ifdef UDP_SEGMENT
+    if( batch->b_gso && BatchSendGSO( p_access, batch ) )
+    {
+        BatchRelease( batch );
+        return;
+    }
+#endif
+
+    for( unsigned i = 0; i < batch->count; i++ )
+    {
+        batch->iov[i].iov_base = batch->pkts[i]->p_buffer;
+        batch->iov[i].iov_len = batch->pkts[i]->i_buffer;
+        batch->msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &batch->iov[i],
+            .msg_iovlen = 1,
+        };
+    }
+
+    for( unsigned i = 0; i < batch->count; )
+    {
+        int val = sendmmsg( p_sys->i_handle, batch->msgs + i,
+                            batch->count - i, 0 );
+        if( val <= 0 )
+        {
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            break;
+        }
+        i += val;
+    }
+
+    BatchRelease( batch );
+}
+
+/*****************************************************************************
+ * ThreadWriteBatch: Write packets on the network by batches.
+ *****************************************************************************
+ * Packets are dequeued as they become available, and those whose send
+ * deadlines fall within the batching window of the first one are sent
+ * together at the first deadline.
+ *****************************************************************************/
+static void* ThreadWriteBatch( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct udp_batch batch = { .count = 0, .pending = NULL, .b_gso = true };
+    vlc_tick_t i_date_last = -1;
+    unsigned i_dropped_packets = 0;
+
+    vlc_cleanup_push( BatchCleanup, &batch );
+
+    for (;;)
+    {
+        block_t *p_pk = batch.pending;
+
+        batch.pending = NULL;
+        if( p_pk == NULL )
+            p_pk = block_FifoGet( p_sys->p_fifo );
+
+        vlc_tick_t i_deadline = p_sys->i_caching + p_pk->i_dts;
+
+        /* Collect the packets within the window */
+        vlc_fifo_Lock( p_sys->p_fifo );
+        while( p_pk != NULL )
+        {
+            vlc_tick_t i_date = p_sys->i_caching + p_pk->i_dts;
+
+            if( i_date_last > 0 && i_date - i_date_last > VLC_TICK_FROM_SEC(2) )
+            {
+                if( !i_dropped_packets )
+                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                             i_date - i_date_last );
+                block_Release( p_pk );
+                i_dropped_packets++;
+                if( batch.count == 0 )
+                    i_deadline = i_date;
+            }
+            else if( batch.count > 0 && i_date - i_deadline > p_sys->i_window )
+            {
+                batch.pending = p_pk;
+                break;
+            }
+            else
+                batch.pkts[batch.count++] = p_pk;
+
+            i_date_last = i_date;
+            if( batch.count >= BATCH_MAX )
+                break;
+            p_pk = vlc_fifo_DequeueUnlocked( p_sys->p_fifo );
+        }
+        vlc_fifo_Unlock( p_sys->p_fifo );
+
+        if( batch.count == 0 )
+            continue;
+
+        if( i_dropped_packets )
+        {
+            msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
+            i_dropped_packets = 0;
+        }
+
+        vlc_tick_wait( i_deadline );
+        BatchSend( p_access, &batch );
+
+        vlc_tick_t i_late = vlc_tick_now() - i_deadline;
+        if( i_late > VLC_TICK_FROM_MS(20) )
+            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                     i_late );
+    }
+
+    vlc_cleanup_pop();
+    vlc_assert_unreachable();
+}
+#endif
@@ -165,6 +165,8 @@ static inline uint32_t CanonicaliseChannels( uint32_t i_physical_channels )
 /*****************************************************************************
  * Remap*: do remapping
  *****************************************************************************/
+/* The output may overlap the input: frames are handled from the end when they
+ * are larger in output, and each input frame is read before it is written. */
 #define DEFINE_REMAP( name, type ) \
 static void RemapCopy##name( filter_t *p_filter, \
                     const void *p_srcorig, void *p_destorig, \
@@ -172,21 +174,24 @@ static void RemapCopy##name( filter_t *p_filter, \
                     unsigned i_nb_in_channels, unsigned i_nb_out_channels ) \
 { \
     filter_sys_t *p_sys = ( filter_sys_t * )p_filter->p_sys; \
-    const type *p_src = p_srcorig; \
-    type *p_dest = p_destorig; \
+    const bool b_backward = i_nb_out_channels > i_nb_in_channels; \
  \
     for( int i = 0; i < i_nb_samples; i++ ) \
     { \
+        const int i_frame = b_backward ? i_nb_samples - 1 - i : i; \
+        const type *p_src = (const type *)p_srcorig \
+                          + i_frame * i_nb_in_channels; \
+        type *p_dest = (type *)p_destorig + i_frame * i_nb_out_channels; \
+        type p_in[AOUT_CHAN_MAX]; \
+ \
+        memcpy( p_in, p_src, i_nb_in_channels * sizeof( type ) ); \
+        memset( p_dest, 0, i_nb_out_channels * sizeof( type ) ); \
         for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
         { \
             int8_t out_ch = p_sys->map_ch[ in_ch ]; \
             if (out_ch < 0) continue; \
-            memcpy( p_dest + out_ch, \
-                    p_src  + in_ch, \
-                    sizeof( type ) ); \
+            p_dest[ out_ch ] = p_in[ in_ch ]; \
         } \
-        p_src  += i_nb_in_channels; \
-        p_dest += i_nb_out_channels; \
     } \
 } \
  \
@@ -196,22 +201,27 @@ static void RemapAdd##name( filter_t *p_filter, \
                     unsigned i_nb_in_channels, unsigned i_nb_out_channels ) \
 { \
     filter_sys_t *p_sys = ( filter_sys_t * )p_filter->p_sys; \
-    const type *p_src = p_srcorig; \
-    type *p_dest = p_destorig; \
+    const bool b_backward = i_nb_out_channels > i_nb_in_channels; \
  \
     for( int i = 0; i < i_nb_samples; i++ ) \
     { \
+        const int i_frame = b_backward ? i_nb_samples - 1 - i : i; \
+        const type *p_src = (const type *)p_srcorig \
+                          + i_frame * i_nb_in_channels; \
+        type *p_dest = (type *)p_destorig + i_frame * i_nb_out_channels; \
+        type p_in[AOUT_CHAN_MAX]; \
+ \
+        memcpy( p_in, p_src, i_nb_in_channels * sizeof( type ) ); \
+        memset( p_dest, 0, i_nb_out_channels * sizeof( type ) ); \
         for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
         { \
             int8_t out_ch = p_sys->map_ch[ in_ch ]; \
             if (out_ch < 0) continue; \
             if( p_sys->b_normalize ) \
-                p_dest[ out_ch ] += p_src[ in_ch ] / p_sys->nb_in_ch[ out_ch ]; \
+                p_dest[ out_ch ] += p_in[ in_ch ] / p_sys->nb_in_ch[ out_ch ]; \
             else \
-                p_dest[ out_ch ] += p_src[ in_ch ]; \
+                p_dest[ out_ch ] += p_in[ in_ch ]; \
         } \
-        p_src  += i_nb_in_channels; \
-        p_dest += i_nb_out_channels; \
     } \
 }
 
@@ -401,27 +411,22 @@ static block_t *Remap( filter_t *p_filter, block_t *p_block )
     size_t i_out_size = p_block->i_nb_samples *
         p_filter->fmt_out.audio.i_bytes_per_frame;
 
-    block_t *p_out = block_Alloc( i_out_size );
+    block_t *p_out = filter_NewAudioBuffer( p_filter, p_block, i_out_size );
     if( !p_out )
     {
-        msg_Warn( p_filter, "can't get output buffer" );
         block_Release( p_block );
         return NULL;
     }
-    p_out->i_nb_samples = p_block->i_nb_samples;
-    p_out->i_dts = p_block->i_dts;
-    p_out->i_pts = p_block->i_pts;
-    p_out->i_length = p_block->i_length;
-
-    memset( p_out->p_buffer, 0, i_out_size );
 
     p_sys->pf_remap( p_filter,
                 (const void *)p_block->p_buffer, (void *)p_out->p_buffer,
                 p_block->i_nb_samples,
                 p_filter->fmt_in.audio.i_channels,
                 p_filter->fmt_out.audio.i_channels );
+    p_out->i_buffer = i_out_size;
 
-    block_Release( p_block );
+    if( p_out != p_block )
+        block_Release( p_block );
 
     return p_out;
 }
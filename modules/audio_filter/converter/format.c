@@ -32,12 +32,16 @@
 #endif
 #include <math.h>
 #include <assert.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -85,69 +89,77 @@ static int Open(vlc_object_t *object)
 /*** from U8 ***/
 static block_t *U8toS16(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t count = bsrc->i_buffer;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    int16_t *dst = (int16_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 8) - 0x8000;
+    /* Backward, as the output samples may overwrite the input ones */
+    uint8_t *src = (uint8_t *)bsrc->p_buffer + count;
+    int16_t *dst = (int16_t *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = ((*--src) << 8) - 0x8000;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
 static block_t *U8toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t count = bsrc->i_buffer;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((float)((*src++) - 128)) / 128.f;
+    /* Backward, as the output samples may overwrite the input ones */
+    uint8_t *src = (uint8_t *)bsrc->p_buffer + count;
+    float *dst = (float *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = ((float)(*--src - 128)) / 128.f;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
 static block_t *U8toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t count = bsrc->i_buffer;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 24) - 0x80000000;
+    /* Backward, as the output samples may overwrite the input ones */
+    uint8_t *src = (uint8_t *)bsrc->p_buffer + count;
+    int32_t *dst = (int32_t *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = ((*--src) << 24) - 0x80000000;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
 static block_t *U8toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 8);
+    const size_t count = bsrc->i_buffer;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 8);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((double)((*src++) - 128)) / 128.;
+    /* Backward, as the output samples may overwrite the input ones */
+    uint8_t *src = (uint8_t *)bsrc->p_buffer + count;
+    double *dst = (double *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = ((double)(*--src - 128)) / 128.;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
@@ -167,63 +179,69 @@ static block_t *S16toU8(filter_t *filter, block_t *b)
 
 static block_t *S16toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t count = bsrc->i_buffer / 2;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
+    /* Backward, as the output samples may overwrite the input ones */
+    int16_t *src = (int16_t *)bsrc->p_buffer + count;
+    float   *dst = (float *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
 #if 0
         /* Slow version */
-        *dst++ = (float)*src++ / 32768.f;
+        *--dst = (float)*--src / 32768.f;
 #else
     {   /* This is Walken's trick based on IEEE float format. On my PIII
          * this takes 16 seconds to perform one billion conversions, instead
          * of 19 seconds for the above division. */
         union { float f; int32_t i; } u;
-        u.i = *src++ + 0x43c00000;
-        *dst++ = u.f - 384.f;
+        u.i = *--src + 0x43c00000;
+        *--dst = u.f - 384.f;
     }
 #endif
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
 static block_t *S16toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t count = bsrc->i_buffer / 2;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (int i = bsrc->i_buffer / 2; i--;)
-        *dst++ = *src++ << 16;
+    /* Backward, as the output samples may overwrite the input ones */
+    int16_t *src = (int16_t *)bsrc->p_buffer + count;
+    int32_t *dst = (int32_t *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = *--src << 16;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
 static block_t *S16toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t count = bsrc->i_buffer / 2;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 4);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
-        *dst++ = (double)*src++ / 32768.;
+    /* Backward, as the output samples may overwrite the input ones */
+    int16_t *src = (int16_t *)bsrc->p_buffer + count;
+    double *dst = (double *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = (double)*--src / 32768.;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
@@ -298,18 +316,20 @@ static block_t *Fl32toS32(filter_t *filter, block_t *b)
 
 static block_t *Fl32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t count = bsrc->i_buffer / 4;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    float  *src = (float *)bsrc->p_buffer;
-    double *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *(dst++) = *(src++);
+    /* Backward, as the output samples may overwrite the input ones */
+    float *src = (float *)bsrc->p_buffer + count;
+    double *dst = (double *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = *--src;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    block_Release(bsrc);
-    VLC_UNUSED(filter);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
@@ -351,18 +371,20 @@ static block_t *S32toFl32(filter_t *filter, block_t *b)
 
 static block_t *S32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t count = bsrc->i_buffer / 4;
+    block_t *bdst = filter_NewAudioBuffer(filter, bsrc, bsrc->i_buffer * 2);
     if (unlikely(bdst == NULL))
         goto out;
 
-    block_CopyProperties(bdst, bsrc);
-    int32_t *src = (int32_t*)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *dst++ = (double)(*src++) / 2147483648.;
+    /* Backward, as the output samples may overwrite the input ones */
+    int32_t *src = (int32_t *)bsrc->p_buffer + count;
+    double *dst = (double *)bdst->p_buffer + count;
+    for (size_t i = count; i--;)
+        *--dst = (double)*--src / 2147483648.;
+    bdst->i_buffer = count * sizeof (*dst);
 out:
-    VLC_UNUSED(filter);
-    block_Release(bsrc);
+    if (bdst != bsrc)
+        block_Release(bsrc);
     return bdst;
 }
 
@@ -438,6 +460,88 @@ static block_t *Fl64toS32(filter_t *filter, block_t *b)
 }
 
 
+#ifdef HAVE_AVX2_INTRINSICS
+/*** AVX2, with the same results as the C versions ***/
+__attribute__ ((__target__ ("avx2")))
+static block_t *S16toFl32_AVX2(filter_t *filter, block_t *bsrc)
+{
+    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    if (unlikely(bdst == NULL))
+        goto out;
+
+    block_CopyProperties(bdst, bsrc);
+    const int16_t *src = (const int16_t *)bsrc->p_buffer;
+    float *dst = (float *)bdst->p_buffer;
+    const __m256 scale = _mm256_set1_ps(1.f / 32768.f);
+    size_t i = bsrc->i_buffer / 2;
+
+    for (; i >= 8; i -= 8, src += 8, dst += 8) {
+        __m256i s = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)src));
+        _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+    }
+    for (; i > 0; i--)
+        *dst++ = (float)*src++ / 32768.f;
+out:
+    block_Release(bsrc);
+    VLC_UNUSED(filter);
+    return bdst;
+}
+
+__attribute__ ((__target__ ("avx2")))
+static block_t *Fl32toS16_AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const float *src = (const float *)b->p_buffer;
+    int16_t *dst = (int16_t *)b->p_buffer;
+    const __m256 scale = _mm256_set1_ps(32768.f);
+    const __m256 max = _mm256_set1_ps(32767.f);
+    const __m256 min = _mm256_set1_ps(-32768.f);
+    size_t i = b->i_buffer / 4;
+
+    /* In place: each store is below the samples already loaded */
+    for (; i >= 16; i -= 16, src += 16, dst += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+        __m256 c = _mm256_mul_ps(_mm256_loadu_ps(src + 8), scale);
+        a = _mm256_max_ps(_mm256_min_ps(a, max), min);
+        c = _mm256_max_ps(_mm256_min_ps(c, max), min);
+        __m256i s = _mm256_packs_epi32(_mm256_cvtps_epi32(a),
+                                       _mm256_cvtps_epi32(c));
+        s = _mm256_permute4x64_epi64(s, 0xd8);
+        _mm256_storeu_si256((__m256i *)dst, s);
+    }
+    for (; i > 0; i--) {
+        union { float f; int32_t i; } u;
+        u.f = *src++ + 384.f;
+        if (u.i > 0x43c07fff)
+            *dst++ = 32767;
+        else if (u.i < 0x43bf8000)
+            *dst++ = -32768;
+        else
+            *dst++ = u.i - 0x43c00000;
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
+__attribute__ ((__target__ ("avx2")))
+static block_t *S32toFl32_AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    int32_t *src = (int32_t*)b->p_buffer;
+    float   *dst = (float *)src;
+    const __m256 scale = _mm256_set1_ps(1.f / 2147483648.f);
+    size_t i = b->i_buffer / 4;
+
+    for (; i >= 8; i -= 8, src += 8, dst += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)src);
+        _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+    }
+    for (; i > 0; i--)
+        *dst++ = (float)(*src++) / 2147483648.f;
+    return b;
+}
+#endif
+
 /* */
 /* */
 static const struct {
@@ -473,8 +577,30 @@ static const struct {
     { 0, 0, NULL }
 };
 
+#ifdef HAVE_AVX2_INTRINSICS
+static const struct {
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    cvt_t convert;
+} cvt_directs_avx2[] = {
+    { VLC_CODEC_S16N, VLC_CODEC_FL32, S16toFl32_AVX2 },
+    { VLC_CODEC_FL32, VLC_CODEC_S16N, Fl32toS16_AVX2 },
+    { VLC_CODEC_S32N, VLC_CODEC_FL32, S32toFl32_AVX2 },
+
+    { 0, 0, NULL }
+};
+#endif
+
 static cvt_t FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst)
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        for (int i = 0; cvt_directs_avx2[i].convert; i++) {
+            if (cvt_directs_avx2[i].src == src &&
+                cvt_directs_avx2[i].dst == dst)
+                return cvt_directs_avx2[i].convert;
+        }
+#endif
     for (int i = 0; cvt_directs[i].convert; i++) {
         if (cvt_directs[i].src == src &&
             cvt_directs[i].dst == dst)
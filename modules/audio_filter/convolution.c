@@ -0,0 +1,311 @@
+/*****************************************************************************
+ * convolution.c : uniformly partitioned FFT convolution
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Overlap-save with a frequency domain delay line: the spectrum of the last
+ * two input blocks is computed once per block, kept for as many blocks as
+ * there are partitions, and multiplied with the spectrum of the matching
+ * partition of the response. The second half of the inverse transform of the
+ * sum is the output block.
+ *
+ * Signals are real, so N = 2 * block point transforms are computed with a
+ * block point complex FFT on the even and odd samples, and only the
+ * block + 1 non-redundant bins are stored and multiplied.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+
+#include "convolution.h"
+
+struct convolver
+{
+    unsigned block;     /* samples per block, M = N / 2 */
+    unsigned bins;      /* block + 1 */
+    size_t   parts;     /* number of response partitions */
+    size_t   current;   /* delay line slot of the newest spectrum */
+
+    unsigned *bitrev;   /* M point bit reversal permutation */
+    float *cos_m, *sin_m; /* M point FFT twiddles, M / 2 each */
+    float *cos_n, *sin_n; /* N point twiddles for the real split, M + 1 */
+
+    float *input;       /* last N input samples */
+    float *output;      /* N samples, inverse transform */
+    float *work_re, *work_im; /* M complex scratch */
+    float *acc_re, *acc_im;   /* bins */
+    float *h_re, *h_im;       /* parts * bins, scaled by 1 / N */
+    float *x_re, *x_im;       /* parts * bins, delay line */
+};
+
+/* In-place radix-2 complex FFT, without normalization */
+static void FFT(const convolver_t *conv, float *restrict re,
+                float *restrict im, bool inverse)
+{
+    const unsigned m = conv->block;
+    const float sign = inverse ? 1.f : -1.f;
+
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned j = conv->bitrev[i];
+        if (j > i)
+        {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (unsigned len = 2; len <= m; len <<= 1)
+    {
+        const unsigned half = len / 2, step = m / len;
+
+        for (unsigned i = 0; i < m; i += len)
+            for (unsigned j = 0; j < half; j++)
+            {
+                const float wr = conv->cos_m[j * step];
+                const float wi = sign * conv->sin_m[j * step];
+                float *ar = re + i + j, *ai = im + i + j;
+                float *br = ar + half, *bi = ai + half;
+                const float tr = *br * wr - *bi * wi;
+                const float ti = *br * wi + *bi * wr;
+
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+    }
+}
+
+/* Spectrum of N real samples, bins 0 to M */
+static void RealForward(const convolver_t *conv, const float *in,
+                        float *restrict re, float *restrict im)
+{
+    const unsigned m = conv->block;
+    float *zr = conv->work_re, *zi = conv->work_im;
+
+    for (unsigned n = 0; n < m; n++)
+    {
+        zr[n] = in[2 * n];
+        zi[n] = in[2 * n + 1];
+    }
+    FFT(conv, zr, zi, false);
+
+    for (unsigned k = 0; k <= m; k++)
+    {
+        const unsigned a = k % m, b = (m - k) % m;
+        /* Even and odd sample spectra */
+        const float er = .5f * (zr[a] + zr[b]), ei = .5f * (zi[a] - zi[b]);
+        const float odr = .5f * (zi[a] + zi[b]), odi = -.5f * (zr[a] - zr[b]);
+        const float wr = conv->cos_n[k], wi = -conv->sin_n[k];
+
+        re[k] = er + odr * wr - odi * wi;
+        im[k] = ei + odr * wi + odi * wr;
+    }
+}
+
+/* N real samples, times N, from bins 0 to M */
+static void RealInverse(const convolver_t *conv, const float *re,
+                        const float *im, float *out)
+{
+    const unsigned m = conv->block;
+    float *zr = conv->work_re, *zi = conv->work_im;
+
+    for (unsigned k = 0; k < m; k++)
+    {
+        /* Twice the even and odd spectra */
+        const float er = re[k] + re[m - k], ei = im[k] - im[m - k];
+        const float dr = re[k] - re[m - k], di = im[k] + im[m - k];
+        const float wr = conv->cos_n[k], wi = conv->sin_n[k];
+        const float odr = dr * wr - di * wi, odi = dr * wi + di * wr;
+
+        zr[k] = er - odi;
+        zi[k] = ei + odr;
+    }
+    FFT(conv, zr, zi, true);
+
+    for (unsigned n = 0; n < m; n++)
+    {
+        out[2 * n] = zr[n];
+        out[2 * n + 1] = zi[n];
+    }
+}
+
+convolver_t *Convolver_New(const float *ir, size_t len, unsigned block)
+{
+    if (block < 4 || (block & (block - 1)) || len == 0)
+        return NULL;
+
+    convolver_t *conv = calloc(1, sizeof (*conv));
+    if (unlikely(conv == NULL))
+        return NULL;
+
+    const unsigned m = block, n = 2 * block;
+    conv->block = m;
+    conv->bins = m + 1;
+    conv->parts = (len + m - 1) / m;
+
+    const size_t spectra = conv->parts * conv->bins;
+    conv->bitrev = vlc_alloc(m, sizeof (*conv->bitrev));
+    conv->cos_m = vlc_alloc(m / 2, sizeof (float));
+    conv->sin_m = vlc_alloc(m / 2, sizeof (float));
+    conv->cos_n = vlc_alloc(m + 1, sizeof (float));
+    conv->sin_n = vlc_alloc(m + 1, sizeof (float));
+    conv->input = vlc_alloc(n, sizeof (float));
+    conv->output = vlc_alloc(n, sizeof (float));
+    conv->work_re = vlc_alloc(m, sizeof (float));
+    conv->work_im = vlc_alloc(m, sizeof (float));
+    conv->acc_re = vlc_alloc(conv->bins, sizeof (float));
+    conv->acc_im = vlc_alloc(conv->bins, sizeof (float));
+    conv->h_re = vlc_alloc(spectra, sizeof (float));
+    conv->h_im = vlc_alloc(spectra, sizeof (float));
+    conv->x_re = vlc_alloc(spectra, sizeof (float));
+    conv->x_im = vlc_alloc(spectra, sizeof (float));
+    if (conv->bitrev == NULL || conv->cos_m == NULL || conv->sin_m == NULL
+     || conv->cos_n == NULL || conv->sin_n == NULL || conv->input == NULL
+     || conv->output == NULL || conv->work_re == NULL || conv->work_im == NULL
+     || conv->acc_re == NULL || conv->acc_im == NULL
+     || conv->h_re == NULL || conv->h_im == NULL
+     || conv->x_re == NULL || conv->x_im == NULL)
+    {
+        Convolver_Delete(conv);
+        return NULL;
+    }
+
+    unsigned bits = 0;
+    while ((1u << bits) < m)
+        bits++;
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        conv->bitrev[i] = r;
+    }
+    for (unsigned i = 0; i < m / 2; i++)
+    {
+        conv->cos_m[i] = cos(2. * M_PI * i / m);
+        conv->sin_m[i] = sin(2. * M_PI * i / m);
+    }
+    for (unsigned i = 0; i <= m; i++)
+    {
+        conv->cos_n[i] = cos(2. * M_PI * i / n);
+        conv->sin_n[i] = sin(2. * M_PI * i / n);
+    }
+
+    /* Partition spectra, with the 1 / N of the inverse transform */
+    for (size_t p = 0; p < conv->parts; p++)
+    {
+        const size_t off = p * m;
+        const size_t count = len - off < m ? len - off : m;
+        float *re = conv->h_re + p * conv->bins;
+        float *im = conv->h_im + p * conv->bins;
+
+        memset(conv->input, 0, n * sizeof (float));
+        for (size_t i = 0; i < count; i++)
+            conv->input[i] = ir[off + i] / n;
+        RealForward(conv, conv->input, re, im);
+    }
+
+    Convolver_Reset(conv);
+    return conv;
+}
+
+void Convolver_Delete(convolver_t *conv)
+{
+    free(conv->x_im);
+    free(conv->x_re);
+    free(conv->h_im);
+    free(conv->h_re);
+    free(conv->acc_im);
+    free(conv->acc_re);
+    free(conv->work_im);
+    free(conv->work_re);
+    free(conv->output);
+    free(conv->input);
+    free(conv->sin_n);
+    free(conv->cos_n);
+    free(conv->sin_m);
+    free(conv->cos_m);
+    free(conv->bitrev);
+    free(conv);
+}
+
+void Convolver_Reset(convolver_t *conv)
+{
+    const size_t spectra = conv->parts * conv->bins;
+
+    memset(conv->input, 0, 2 * conv->block * sizeof (float));
+    memset(conv->x_re, 0, spectra * sizeof (float));
+    memset(conv->x_im, 0, spectra * sizeof (float));
+    conv->current = 0;
+}
+
+/* Complex multiply-accumulate of one partition, split so that it vectorizes */
+static void MulAdd(float *restrict acc_re, float *restrict acc_im,
+                   const float *restrict xr, const float *restrict xi,
+                   const float *restrict hr, const float *restrict hi,
+                   unsigned bins)
+{
+    for (unsigned k = 0; k < bins; k++)
+    {
+        acc_re[k] += xr[k] * hr[k] - xi[k] * hi[k];
+        acc_im[k] += xr[k] * hi[k] + xi[k] * hr[k];
+    }
+}
+
+void Convolver_Process(convolver_t *conv, const float *in, float *out)
+{
+    const unsigned m = conv->block, bins = conv->bins;
+
+    /* Slide the input by one block */
+    memmove(conv->input, conv->input + m, m * sizeof (float));
+    memcpy(conv->input + m, in, m * sizeof (float));
+
+    RealForward(conv, conv->input, conv->x_re + conv->current * bins,
+                conv->x_im + conv->current * bins);
+
+    memset(conv->acc_re, 0, bins * sizeof (float));
+    memset(conv->acc_im, 0, bins * sizeof (float));
+
+    /* Partition p applies to the spectrum of p blocks ago */
+    size_t slot = conv->current;
+    for (size_t p = 0; p < conv->parts; p++)
+    {
+        MulAdd(conv->acc_re, conv->acc_im,
+               conv->x_re + slot * bins, conv->x_im + slot * bins,
+               conv->h_re + p * bins, conv->h_im + p * bins, bins);
+        slot = (slot ? slot : conv->parts) - 1;
+    }
+
+    if (++conv->current == conv->parts)
+        conv->current = 0;
+
+    /* Only the second half is free of circular aliasing */
+    RealInverse(conv, conv->acc_re, conv->acc_im, conv->output);
+    memcpy(out, conv->output + m, m * sizeof (float));
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * convolution.h : uniformly partitioned FFT convolution
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_CONVOLUTION_H
+#define VLC_AUDIO_FILTER_CONVOLUTION_H 1
+
+#include <stddef.h>
+
+/**
+ * Convolves a single channel with a finite impulse response, one block of
+ * samples at a time.
+ *
+ * The response is cut into partitions of the block size, and each input
+ * block is multiplied with all the partitions in the frequency domain, so
+ * that the cost per sample grows with the logarithm of the block size and
+ * linearly with the number of partitions, instead of the response length.
+ * Each output block is exact, without added latency, but the caller has to
+ * gather whole blocks of input first.
+ */
+typedef struct convolver convolver_t;
+
+/**
+ * Creates a convolver.
+ *
+ * \param ir impulse response (copied)
+ * \param len number of samples of the impulse response
+ * \param block block size in samples, a power of two
+ * \return the convolver, or NULL on error
+ */
+convolver_t *Convolver_New(const float *ir, size_t len, unsigned block);
+
+void Convolver_Delete(convolver_t *);
+
+/**
+ * Forgets the past input, as on a discontinuity.
+ */
+void Convolver_Reset(convolver_t *);
+
+/**
+ * Filters one block.
+ *
+ * \param in block size input samples
+ * \param out block size output samples (can be the same as in)
+ */
+void Convolver_Process(convolver_t *, const float *in, float *out);
+
+#endif
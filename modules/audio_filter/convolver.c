@@ -0,0 +1,341 @@
+/*****************************************************************************
+ * convolver.c : impulse response convolution filter
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Applies a FIR response read from a WAV file, such as a room correction or
+ * a speaker or headphone equalization, to every channel. A mono response is
+ * shared by all channels; otherwise the file must have one response per
+ * channel, in the order of the audio output.
+ *
+ * Samples go through a per channel ring of one block, so blocks of any size
+ * are filtered in place, at the cost of one block of latency.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_fs.h>
+#include <vlc_plugin.h>
+
+#include "convolution.h"
+
+#define CONVOLVER_BLOCK   256
+#define CONVOLVER_MAX_LEN (10 * 192000) /* 10 seconds at 192 kHz */
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+#define FILE_TEXT N_("Impulse response file")
+#define FILE_LONGTEXT N_("WAV file with the impulse response to apply, " \
+    "either mono for all channels, or with one response per channel. " \
+    "16, 24 and 32-bit integer and 32-bit float samples are supported.")
+#define GAIN_TEXT N_("Gain")
+#define GAIN_LONGTEXT N_("Gain in dB applied to the impulse response.")
+
+vlc_module_begin ()
+    set_shortname( N_("Convolver") )
+    set_description( N_("Impulse response convolution") )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+    set_capability( "audio filter", 0 )
+    set_callbacks( Open, Close )
+
+    add_loadfile( "convolver-file", NULL, FILE_TEXT, FILE_LONGTEXT )
+    add_float_with_range( "convolver-gain", 0., -40., 20.,
+                          GAIN_TEXT, GAIN_LONGTEXT, true )
+vlc_module_end ()
+
+typedef struct
+{
+    unsigned      channels;
+    unsigned      fill;   /* samples in the current block */
+    convolver_t **conv;   /* one per channel */
+    float        *in;     /* channels * CONVOLVER_BLOCK, planar */
+    float        *out;    /* filtered previous block, planar */
+} filter_sys_t;
+
+/*****************************************************************************
+ * WAV impulse response
+ *****************************************************************************/
+typedef struct
+{
+    float   *samples;  /* planar */
+    size_t   length;   /* samples per channel */
+    unsigned channels;
+    unsigned rate;
+} impulse_t;
+
+static float ReadSample( const uint8_t *p, unsigned tag, unsigned bits )
+{
+    if( tag == 3 ) /* IEEE float */
+    {
+        union { uint32_t u; float f; } v = { .u = GetDWLE( p ) };
+        return v.f;
+    }
+
+    switch( bits )
+    {
+        case 16:
+            return (int16_t)GetWLE( p ) / 32768.f;
+        case 24:
+            return (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16)
+                             | ((uint32_t)p[0] << 8)) / 2147483648.f;
+        default:
+            return (int32_t)GetDWLE( p ) / 2147483648.f;
+    }
+}
+
+static int LoadImpulse( filter_t *p_filter, const char *path, impulse_t *ir )
+{
+    FILE *file = vlc_fopen( path, "rb" );
+    if( file == NULL )
+    {
+        msg_Err( p_filter, "cannot open %s: %s", path, vlc_strerror_c(errno) );
+        return VLC_EGENERIC;
+    }
+
+    uint8_t hdr[12];
+    unsigned tag = 0, bits = 0;
+    uint8_t *data = NULL;
+    size_t size = 0;
+    int ret = VLC_EGENERIC;
+
+    if( fread( hdr, 1, 12, file ) != 12
+     || memcmp( hdr, "RIFF", 4 ) || memcmp( hdr + 8, "WAVE", 4 ) )
+    {
+        msg_Err( p_filter, "%s is not a WAV file", path );
+        goto out;
+    }
+
+    ir->channels = 0;
+    /* Walk the chunks up to the data */
+    while( fread( hdr, 1, 8, file ) == 8 )
+    {
+        uint32_t chunk = GetDWLE( hdr + 4 );
+
+        if( !memcmp( hdr, "fmt ", 4 ) && chunk >= 16 && chunk <= 40 )
+        {
+            uint8_t fmt[40];
+            if( fread( fmt, 1, chunk, file ) != chunk )
+                break;
+            tag = GetWLE( fmt );
+            ir->channels = GetWLE( fmt + 2 );
+            ir->rate = GetDWLE( fmt + 4 );
+            bits = GetWLE( fmt + 14 );
+            if( tag == 0xFFFE && chunk >= 26 ) /* WAVE_FORMAT_EXTENSIBLE */
+                tag = GetWLE( fmt + 24 );
+        }
+        else if( !memcmp( hdr, "data", 4 ) )
+        {
+            if( ir->channels == 0 || chunk > CONVOLVER_MAX_LEN * 4 * 8 )
+                break;
+            data = malloc( chunk );
+            if( data == NULL )
+            {
+                ret = VLC_ENOMEM;
+                goto out;
+            }
+            size = fread( data, 1, chunk, file );
+            break;
+        }
+        else if( fseek( file, chunk + (chunk & 1), SEEK_CUR ) )
+            break;
+    }
+
+    if( data == NULL || ir->channels == 0 || ir->channels > AOUT_CHAN_MAX
+     || !((tag == 1 && (bits == 16 || bits == 24 || bits == 32))
+       || (tag == 3 && bits == 32)) )
+    {
+        msg_Err( p_filter, "unsupported impulse response in %s", path );
+        goto out;
+    }
+
+    const unsigned bytes = bits / 8;
+    ir->length = size / (bytes * ir->channels);
+    if( ir->length == 0 || ir->length > CONVOLVER_MAX_LEN )
+    {
+        msg_Err( p_filter, "invalid impulse response length in %s", path );
+        goto out;
+    }
+
+    ir->samples = vlc_alloc( ir->length * ir->channels, sizeof (float) );
+    if( ir->samples == NULL )
+    {
+        ret = VLC_ENOMEM;
+        goto out;
+    }
+    for( size_t i = 0; i < ir->length; i++ )
+        for( unsigned c = 0; c < ir->channels; c++ )
+            ir->samples[c * ir->length + i] =
+                ReadSample( data + (i * ir->channels + c) * bytes, tag, bits );
+    ret = VLC_SUCCESS;
+out:
+    free( data );
+    fclose( file );
+    return ret;
+}
+
+/*****************************************************************************
+ * Filter
+ *****************************************************************************/
+static block_t *Filter( filter_t *p_filter, block_t *p_block )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned channels = p_sys->channels;
+    float *p = (float *)p_block->p_buffer;
+
+    for( unsigned i = 0; i < p_block->i_nb_samples; i++ )
+    {
+        const unsigned fill = p_sys->fill;
+
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            p_sys->in[c * CONVOLVER_BLOCK + fill] = p[c];
+            p[c] = p_sys->out[c * CONVOLVER_BLOCK + fill];
+        }
+        p += channels;
+
+        if( ++p_sys->fill == CONVOLVER_BLOCK )
+        {
+            for( unsigned c = 0; c < channels; c++ )
+                Convolver_Process( p_sys->conv[c],
+                                   p_sys->in + c * CONVOLVER_BLOCK,
+                                   p_sys->out + c * CONVOLVER_BLOCK );
+            p_sys->fill = 0;
+        }
+    }
+    return p_block;
+}
+
+static void Flush( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    for( unsigned c = 0; c < p_sys->channels; c++ )
+        Convolver_Reset( p_sys->conv[c] );
+    memset( p_sys->out, 0,
+            p_sys->channels * CONVOLVER_BLOCK * sizeof (float) );
+    p_sys->fill = 0;
+}
+
+/*****************************************************************************
+ * Open
+ *****************************************************************************/
+static int Open( vlc_object_t *obj )
+{
+    filter_t *p_filter = (filter_t *)obj;
+
+    if( p_filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || !AOUT_FMTS_IDENTICAL( &p_filter->fmt_in.audio,
+                              &p_filter->fmt_out.audio ) )
+        return VLC_EGENERIC;
+
+    char *path = var_InheritString( obj, "convolver-file" );
+    if( path == NULL )
+    {
+        msg_Err( p_filter, "no impulse response file" );
+        return VLC_EGENERIC;
+    }
+
+    impulse_t ir;
+    int ret = LoadImpulse( p_filter, path, &ir );
+    free( path );
+    if( ret != VLC_SUCCESS )
+        return ret;
+
+    const unsigned channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    if( ir.channels != 1 && ir.channels != channels )
+    {
+        msg_Err( p_filter, "%u channels impulse response for %u channels",
+                 ir.channels, channels );
+        free( ir.samples );
+        return VLC_EGENERIC;
+    }
+    if( ir.rate != p_filter->fmt_in.audio.i_rate )
+        msg_Warn( p_filter, "impulse response at %u Hz applied at %u Hz",
+                  ir.rate, p_filter->fmt_in.audio.i_rate );
+
+    const float gain = powf( 10.f,
+                             var_InheritFloat( obj, "convolver-gain" ) / 20.f );
+    for( size_t i = 0; i < ir.length * ir.channels; i++ )
+        ir.samples[i] *= gain;
+
+    filter_sys_t *p_sys = calloc( 1, sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+    {
+        free( ir.samples );
+        return VLC_ENOMEM;
+    }
+    p_filter->p_sys = p_sys;
+    p_sys->conv = calloc( channels, sizeof (*p_sys->conv) );
+    p_sys->in = vlc_alloc( channels * CONVOLVER_BLOCK, sizeof (float) );
+    p_sys->out = calloc( channels * CONVOLVER_BLOCK, sizeof (float) );
+    if( p_sys->conv == NULL || p_sys->in == NULL || p_sys->out == NULL )
+    {
+        free( ir.samples );
+        Close( obj );
+        return VLC_ENOMEM;
+    }
+
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        const float *h = ir.samples + (ir.channels > 1 ? c * ir.length : 0);
+
+        p_sys->conv[c] = Convolver_New( h, ir.length, CONVOLVER_BLOCK );
+        if( p_sys->conv[c] == NULL )
+        {
+            free( ir.samples );
+            Close( obj );
+            return VLC_ENOMEM;
+        }
+        p_sys->channels = c + 1;
+    }
+    free( ir.samples );
+
+    msg_Dbg( p_filter, "%zu samples impulse response, %u channels",
+             ir.length, ir.channels );
+
+    p_filter->pf_audio_filter = Filter;
+    p_filter->pf_flush = Flush;
+    return VLC_SUCCESS;
+}
+
+static void Close( vlc_object_t *obj )
+{
+    filter_t *p_filter = (filter_t *)obj;
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    for( unsigned c = 0; c < p_sys->channels; c++ )
+        Convolver_Delete( p_sys->conv[c] );
+    free( p_sys->conv );
+    free( p_sys->out );
+    free( p_sys->in );
+    free( p_sys );
+}
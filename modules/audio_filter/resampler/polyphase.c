@@ -0,0 +1,483 @@
+/*****************************************************************************
+ * polyphase.c : polyphase windowed sinc resampler
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each output sample is the dot product of the input samples around its
+ * position with a Kaiser windowed sinc. The filter is precomputed for
+ * POLYPHASE_PHASES fractional positions, and linearly interpolated in
+ * between, so that any ratio is supported, including the slowly varying
+ * ones of the audio output drift compensation, without redesigning the
+ * filter. Samples are kept planar so that the dot products are contiguous.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef HAVE_SSE2_INTRINSICS
+# include <emmintrin.h>
+#endif
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+#include <vlc_cpu.h>
+
+#define TAPS_TEXT N_("Filter length")
+#define TAPS_LONGTEXT N_( \
+    "Number of input samples per output sample. Longer filters have a " \
+    "steeper cut-off, and more latency and CPU usage.")
+
+#define LOWLAT_TEXT N_("Low latency rate tuning")
+#define LOWLAT_LONGTEXT N_( \
+    "Use a short filter for the small rate adjustments of the audio " \
+    "output clock synchronization.")
+
+static int Open (vlc_object_t *);
+static int OpenResampler (vlc_object_t *);
+static void Close (vlc_object_t *);
+
+vlc_module_begin ()
+    set_shortname (N_("Polyphase"))
+    set_description (N_("Polyphase audio resampler"))
+    set_category (CAT_AUDIO)
+    set_subcategory (SUBCAT_AUDIO_RESAMPLER)
+    add_integer_with_range ("polyphase-taps", 32, 8, 64,
+                            TAPS_TEXT, TAPS_LONGTEXT, true)
+    add_bool ("polyphase-low-latency", true,
+              LOWLAT_TEXT, LOWLAT_LONGTEXT, true)
+    set_capability ("audio converter", 40)
+    set_callbacks (Open, Close)
+
+    add_submodule ()
+    set_capability ("audio resampler", 40)
+    set_callbacks (OpenResampler, Close)
+    add_shortcut ("polyphase")
+vlc_module_end ()
+
+#define POLYPHASE_PHASES_BITS 7
+#define POLYPHASE_PHASES (1 << POLYPHASE_PHASES_BITS)
+#define LOWLAT_TAPS 16
+#define KAISER_BETA 8.
+
+typedef struct
+{
+    void (*interpolate)(float *, const float *, const float *, float,
+                        unsigned);
+    float (*dot)(const float *, const float *, unsigned);
+} polyphase_ops_t;
+
+typedef struct
+{
+    unsigned taps;
+    unsigned channels;
+    double cutoff; /**< of the current bank, relative to the input Nyquist */
+    float *bank;   /**< (POLYPHASE_PHASES + 1) rows of taps coefficients */
+    float *coefs;
+
+    float *hist;   /**< planar input, hist_cap samples per channel */
+    size_t hist_cap;
+    size_t hist_len;
+    uint64_t pos;  /**< 32.32 position of the next output filter start */
+
+    polyphase_ops_t ops;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+static void InterpolateC (float *dst, const float *a, const float *b,
+                          float t, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        dst[i] = a[i] + t * (b[i] - a[i]);
+}
+
+static float DotC (const float *x, const float *c, unsigned n)
+{
+    float s0 = 0.f, s1 = 0.f, s2 = 0.f, s3 = 0.f;
+
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        s0 += x[i] * c[i];
+        s1 += x[i + 1] * c[i + 1];
+        s2 += x[i + 2] * c[i + 2];
+        s3 += x[i + 3] * c[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static void InterpolateSSE (float *dst, const float *a, const float *b,
+                            float t, unsigned n)
+{
+    const __m128 vt = _mm_set1_ps (t);
+
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        __m128 va = _mm_loadu_ps (a + i);
+        __m128 vb = _mm_loadu_ps (b + i);
+        _mm_storeu_ps (dst + i,
+                       _mm_add_ps (va, _mm_mul_ps (vt, _mm_sub_ps (vb, va))));
+    }
+}
+
+VLC_SSE
+static float DotSSE (const float *x, const float *c, unsigned n)
+{
+    __m128 s0 = _mm_setzero_ps (), s1 = _mm_setzero_ps ();
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = _mm_add_ps (s0, _mm_mul_ps (_mm_loadu_ps (x + i),
+                                         _mm_loadu_ps (c + i)));
+        s1 = _mm_add_ps (s1, _mm_mul_ps (_mm_loadu_ps (x + i + 4),
+                                         _mm_loadu_ps (c + i + 4)));
+    }
+    s0 = _mm_add_ps (s0, s1);
+    s0 = _mm_add_ps (s0, _mm_movehl_ps (s0, s0));
+    s0 = _mm_add_ss (s0, _mm_shuffle_ps (s0, s0, 1));
+    return _mm_cvtss_f32 (s0);
+}
+#endif
+
+#ifdef __ARM_NEON
+static void InterpolateNEON (float *dst, const float *a, const float *b,
+                             float t, unsigned n)
+{
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        float32x4_t va = vld1q_f32 (a + i);
+        float32x4_t vb = vld1q_f32 (b + i);
+        vst1q_f32 (dst + i, vmlaq_n_f32 (va, vsubq_f32 (vb, va), t));
+    }
+}
+
+static float DotNEON (const float *x, const float *c, unsigned n)
+{
+    float32x4_t s0 = vdupq_n_f32 (0.f), s1 = vdupq_n_f32 (0.f);
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = vmlaq_f32 (s0, vld1q_f32 (x + i), vld1q_f32 (c + i));
+        s1 = vmlaq_f32 (s1, vld1q_f32 (x + i + 4), vld1q_f32 (c + i + 4));
+    }
+    s0 = vaddq_f32 (s0, s1);
+    float32x2_t s = vadd_f32 (vget_low_f32 (s0), vget_high_f32 (s0));
+    return vget_lane_f32 (vpadd_f32 (s, s), 0);
+}
+#endif
+
+/*****************************************************************************
+ * Filter design
+ *****************************************************************************/
+static double BesselI0 (double x)
+{
+    double sum = 1., term = 1.;
+
+    for (unsigned k = 1; term > sum * 1e-12; k++)
+    {
+        term *= (x / (2. * k)) * (x / (2. * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static double Cutoff (unsigned irate, unsigned orate)
+{
+    /* Leave some room for the transition band below the lowest Nyquist */
+    return (orate < irate ? (double)orate / irate : 1.) * 0.95;
+}
+
+static void DesignBank (filter_sys_t *sys, double cutoff)
+{
+    const unsigned taps = sys->taps;
+    const double half = taps / 2.;
+    const double norm = BesselI0 (KAISER_BETA);
+
+    for (unsigned p = 0; p <= POLYPHASE_PHASES; p++)
+    {
+        float *row = &sys->bank[p * taps];
+        const double frac = (double)p / POLYPHASE_PHASES;
+        double sum = 0.;
+
+        for (unsigned k = 0; k < taps; k++)
+        {
+            /* Distance from the output position, in input samples */
+            const double x = k - (half - 1.) - frac;
+            const double r = x / half;
+            double h = cutoff;
+
+            if (x != 0.)
+                h = sin (M_PI * cutoff * x) / (M_PI * x);
+            h *= (r > -1. && r < 1.)
+                 ? BesselI0 (KAISER_BETA * sqrt (1. - r * r)) / norm : 0.;
+            row[k] = h;
+            sum += h;
+        }
+
+        /* Unity gain at DC for every phase */
+        for (unsigned k = 0; k < taps; k++)
+            row[k] /= sum;
+    }
+    sys->cutoff = cutoff;
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+static int Append (filter_sys_t *sys, const float *in, size_t frames)
+{
+    const unsigned channels = sys->channels;
+
+    if (sys->hist_len + frames > sys->hist_cap)
+    {
+        size_t cap = (sys->hist_len + frames) * 2;
+        float *hist = vlc_alloc (cap * channels, sizeof (*hist));
+        if (unlikely(hist == NULL))
+            return VLC_ENOMEM;
+
+        for (unsigned c = 0; c < channels; c++)
+            memcpy (&hist[c * cap], &sys->hist[c * sys->hist_cap],
+                    sys->hist_len * sizeof (*hist));
+        free (sys->hist);
+        sys->hist = hist;
+        sys->hist_cap = cap;
+    }
+
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float *dst = &sys->hist[c * sys->hist_cap + sys->hist_len];
+
+        if (in != NULL)
+            for (size_t i = 0; i < frames; i++)
+                dst[i] = in[i * channels + c];
+        else
+            memset (dst, 0, frames * sizeof (*dst));
+    }
+    sys->hist_len += frames;
+    return VLC_SUCCESS;
+}
+
+/* Produces all the output samples the buffered input allows */
+static block_t *Process (filter_t *filter, vlc_tick_t pts)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned irate = filter->fmt_in.audio.i_rate;
+    const unsigned orate = filter->fmt_out.audio.i_rate;
+    const unsigned taps = sys->taps;
+    const unsigned channels = sys->channels;
+
+    /* The playback rate changes the input rate: redesign the filter if the
+     * cut-off moved noticeably (but not for the drift compensation). */
+    const double cutoff = Cutoff (irate, orate);
+    if (fabs (cutoff - sys->cutoff) > sys->cutoff * 0.02)
+        DesignBank (sys, cutoff);
+
+    const uint64_t step = ((uint64_t)irate << 32) / orate;
+    if (sys->hist_len < taps)
+        return NULL;
+    const uint64_t end = (uint64_t)(sys->hist_len - taps + 1) << 32;
+    if (sys->pos >= end)
+        return NULL;
+
+    const size_t count = (end - sys->pos + step - 1) / step;
+    block_t *out = block_Alloc (count * channels * sizeof (float));
+    if (unlikely(out == NULL))
+        return NULL;
+
+    float *dst = (float *)out->p_buffer;
+    uint64_t pos = sys->pos;
+
+    for (size_t n = 0; n < count; n++, pos += step)
+    {
+        const size_t start = pos >> 32;
+        const uint32_t frac = pos;
+        const unsigned phase = frac >> (32 - POLYPHASE_PHASES_BITS);
+        const float t = (frac & ((UINT32_C(1) << (32 - POLYPHASE_PHASES_BITS)) - 1))
+                      * (1.f / (UINT32_C(1) << (32 - POLYPHASE_PHASES_BITS)));
+
+        sys->ops.interpolate (sys->coefs, &sys->bank[phase * taps],
+                              &sys->bank[(phase + 1) * taps], t, taps);
+        for (unsigned c = 0; c < channels; c++)
+            *(dst++) = sys->ops.dot (&sys->hist[c * sys->hist_cap + start],
+                                     sys->coefs, taps);
+    }
+
+    /* Drop the input samples that are not needed anymore */
+    const size_t drop = pos >> 32;
+    for (unsigned c = 0; c < channels; c++)
+        memmove (&sys->hist[c * sys->hist_cap],
+                 &sys->hist[c * sys->hist_cap + drop],
+                 (sys->hist_len - drop) * sizeof (float));
+    sys->hist_len -= drop;
+    sys->pos = pos - ((uint64_t)drop << 32);
+
+    out->i_nb_samples = count;
+    out->i_pts = pts;
+    out->i_length = vlc_tick_from_samples (count, orate);
+    return out;
+}
+
+static void Reset (filter_sys_t *sys)
+{
+    /* Center the first output sample on the first input sample */
+    sys->hist_len = 0;
+    sys->pos = 0;
+    Append (sys, NULL, sys->taps / 2 - 1);
+}
+
+static block_t *Resample (filter_t *filter, block_t *in)
+{
+    filter_sys_t *sys = filter->p_sys;
+    vlc_tick_t pts = VLC_TICK_INVALID;
+
+    if (in->i_pts != VLC_TICK_INVALID)
+    {
+        /* Input time of the next output sample, relative to this block */
+        const double center = (double)(sys->pos >> 32) + sys->taps / 2 - 1
+                            + (uint32_t)sys->pos * 0x1.p-32 - sys->hist_len;
+        pts = in->i_pts + llround (center * CLOCK_FREQ
+                                   / filter->fmt_in.audio.i_rate);
+    }
+
+    block_t *out = NULL;
+    if (Append (sys, (const float *)in->p_buffer, in->i_nb_samples)
+            == VLC_SUCCESS)
+        out = Process (filter, pts);
+    block_Release (in);
+    return out;
+}
+
+static block_t *Drain (filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    /* Push the last input samples out of the filter */
+    if (Append (sys, NULL, sys->taps / 2) != VLC_SUCCESS)
+        return NULL;
+
+    block_t *out = Process (filter, VLC_TICK_INVALID);
+    Reset (sys);
+    return out;
+}
+
+static void Flush (filter_t *filter)
+{
+    Reset (filter->p_sys);
+}
+
+/*****************************************************************************
+ * Module
+ *****************************************************************************/
+static int Create (filter_t *filter, unsigned taps)
+{
+    const audio_format_t *in = &filter->fmt_in.audio;
+    const audio_format_t *out = &filter->fmt_out.audio;
+
+    if (in->i_format != VLC_CODEC_FL32 || out->i_format != VLC_CODEC_FL32
+     || in->i_channels != out->i_channels || in->i_physical_channels == 0
+     || in->i_rate == 0 || out->i_rate == 0)
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = malloc (sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    /* Multiple of 8 for the SIMD dot products */
+    taps = (taps + 7) & ~7u;
+    sys->taps = taps;
+    sys->channels = in->i_channels;
+    sys->bank = vlc_alloc ((POLYPHASE_PHASES + 1) * taps, sizeof (float));
+    sys->coefs = vlc_alloc (taps, sizeof (float));
+    sys->hist = NULL;
+    sys->hist_cap = 0;
+    if (unlikely(sys->bank == NULL || sys->coefs == NULL))
+    {
+        free (sys->coefs);
+        free (sys->bank);
+        free (sys);
+        return VLC_ENOMEM;
+    }
+
+    sys->ops.interpolate = InterpolateC;
+    sys->ops.dot = DotC;
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2 ())
+    {
+        sys->ops.interpolate = InterpolateSSE;
+        sys->ops.dot = DotSSE;
+    }
+#endif
+#ifdef __ARM_NEON
+    sys->ops.interpolate = InterpolateNEON;
+    sys->ops.dot = DotNEON;
+#endif
+
+    DesignBank (sys, Cutoff (in->i_rate, out->i_rate));
+    filter->p_sys = sys;
+    Reset (sys);
+
+    msg_Dbg (filter, "%u taps, %u Hz to %u Hz", taps, in->i_rate,
+             out->i_rate);
+    filter->pf_audio_filter = Resample;
+    filter->pf_audio_drain = Drain;
+    filter->pf_flush = Flush;
+    return VLC_SUCCESS;
+}
+
+static int Open (vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if (filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate)
+        return VLC_EGENERIC;
+    return Create (filter, var_InheritInteger (obj, "polyphase-taps"));
+}
+
+static int OpenResampler (vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    unsigned taps = var_InheritInteger (obj, "polyphase-taps");
+
+    if (var_InheritBool (obj, "polyphase-low-latency"))
+        taps = __MIN (taps, LOWLAT_TAPS);
+    return Create (filter, taps);
+}
+
+static void Close (vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    filter_sys_t *sys = filter->p_sys;
+
+    free (sys->hist);
+    free (sys->coefs);
+    free (sys->bank);
+    free (sys);
+}
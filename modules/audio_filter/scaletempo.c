@@ -31,11 +31,20 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_atomic.h>
+#include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#elif defined( HAVE_SSE2_INTRINSICS )
+# include <emmintrin.h>
+#endif
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -129,6 +138,7 @@ typedef struct
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    float   (*dot)( const float *, const float *, unsigned );
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
@@ -136,6 +146,78 @@ typedef struct
 #endif
 } filter_sys_t;
 
+/*****************************************************************************
+ * dot: correlation of the windowed overlap with one search position
+ *****************************************************************************
+ * Frames are interleaved, so the correlation over all the channels of a
+ * candidate offset is one contiguous dot product.
+ *****************************************************************************/
+static float dot_c( const float *a, const float *b, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static float dot_sse( const float *a, const float *b, unsigned n )
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    unsigned i;
+
+    for( i = 0; i + 8 <= n; i += 8 ) {
+        s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_loadu_ps( a + i ),
+                                         _mm_loadu_ps( b + i ) ) );
+        s1 = _mm_add_ps( s1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ),
+                                         _mm_loadu_ps( b + i + 4 ) ) );
+    }
+    s0 = _mm_add_ps( s0, s1 );
+    s0 = _mm_add_ps( s0, _mm_movehl_ps( s0, s0 ) );
+    s0 = _mm_add_ss( s0, _mm_shuffle_ps( s0, s0, 1 ) );
+    return _mm_cvtss_f32( s0 ) + dot_c( a + i, b + i, n - i );
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx")))
+static float dot_avx( const float *a, const float *b, unsigned n )
+{
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    unsigned i;
+
+    for( i = 0; i + 16 <= n; i += 16 ) {
+        s0 = _mm256_add_ps( s0, _mm256_mul_ps( _mm256_loadu_ps( a + i ),
+                                               _mm256_loadu_ps( b + i ) ) );
+        s1 = _mm256_add_ps( s1, _mm256_mul_ps( _mm256_loadu_ps( a + i + 8 ),
+                                               _mm256_loadu_ps( b + i + 8 ) ) );
+    }
+    s0 = _mm256_add_ps( s0, s1 );
+    __m128 s = _mm_add_ps( _mm256_castps256_ps128( s0 ),
+                           _mm256_extractf128_ps( s0, 1 ) );
+    s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+    s = _mm_add_ss( s, _mm_shuffle_ps( s, s, 1 ) );
+    return _mm_cvtss_f32( s ) + dot_c( a + i, b + i, n - i );
+}
+#endif
+
+#ifdef __ARM_NEON
+static float dot_neon( const float *a, const float *b, unsigned n )
+{
+    float32x4_t s0 = vdupq_n_f32( 0.f ), s1 = vdupq_n_f32( 0.f );
+    unsigned i;
+
+    for( i = 0; i + 8 <= n; i += 8 ) {
+        s0 = vmlaq_f32( s0, vld1q_f32( a + i ), vld1q_f32( b + i ) );
+        s1 = vmlaq_f32( s1, vld1q_f32( a + i + 4 ), vld1q_f32( b + i + 4 ) );
+    }
+    s0 = vaddq_f32( s0, s1 );
+    float32x2_t s = vadd_f32( vget_low_f32( s0 ), vget_high_f32( s0 ) );
+    return vget_lane_f32( vpadd_f32( s, s ), 0 ) + dot_c( a + i, b + i, n - i );
+}
+#endif
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
@@ -146,23 +228,19 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     float best_corr = INT_MIN;
     unsigned best_off = 0;
     unsigned i, off;
+    const unsigned samples_corr = p->samples_overlap - p->samples_per_frame;
 
     pw  = p->table_window;
     po  = p->buf_overlap;
     po += p->samples_per_frame;
     ppc = p->buf_pre_corr;
-    for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
+    for( i = 0; i < samples_corr; i++ ) {
       *ppc++ = *pw++ * *po++;
     }
 
     search_start = (float *)p->buf_queue + p->samples_per_frame;
     for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+      float corr = p->dot( p->buf_pre_corr, search_start, samples_corr );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
@@ -352,6 +430,18 @@ static int reinit_buffers( filter_t *p_filter )
                 *pw++ = v;
         }
         p->best_overlap_offset = best_overlap_offset_float;
+        p->dot = dot_c;
+#ifdef HAVE_SSE2_INTRINSICS
+        if( vlc_CPU_SSE2() )
+            p->dot = dot_sse;
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        if( vlc_CPU_AVX() )
+            p->dot = dot_avx;
+#endif
+#ifdef __ARM_NEON
+        p->dot = dot_neon;
+#endif
     }
 
     unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
@@ -29,10 +29,14 @@
 #endif
 
 #include <stddef.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -66,6 +70,57 @@ static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx")))
+static void FilterFL32_AVX( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+
+    for( ; i >= 16; i -= 16, p += 16 )
+    {
+        __m256 a = _mm256_mul_ps( _mm256_loadu_ps( p ), mult );
+        __m256 b = _mm256_mul_ps( _mm256_loadu_ps( p + 8 ), mult );
+        _mm256_storeu_ps( p, a );
+        _mm256_storeu_ps( p + 8, b );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+
+__attribute__ ((__target__ ("avx")))
+static void FilterFL64_AVX( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    double mult = f_multiplier;
+    if( mult == 1. )
+        return; /* nothing to do */
+
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m256d vmult = _mm256_set1_pd( mult );
+
+    for( ; i >= 8; i -= 8, p += 8 )
+    {
+        __m256d a = _mm256_mul_pd( _mm256_loadu_pd( p ), vmult );
+        __m256d b = _mm256_mul_pd( _mm256_loadu_pd( p + 4 ), vmult );
+        _mm256_storeu_pd( p, a );
+        _mm256_storeu_pd( p + 4, b );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= mult;
+
+    (void) p_volume;
+}
+#endif
+
 static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
                         float f_multiplier )
 {
@@ -91,9 +146,17 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( vlc_CPU_AVX() )
+                p_volume->amplify = FilterFL32_AVX;
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( vlc_CPU_AVX() )
+                p_volume->amplify = FilterFL64_AVX;
+#endif
             break;
         default:
             return -1;
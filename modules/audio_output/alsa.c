@@ -35,6 +35,7 @@
 #include <vlc_dialog.h>
 #include <vlc_aout.h>
 #include <vlc_cpu.h>
+#include <vlc_atomic.h>
 
 #include <alsa/asoundlib.h>
 #include <alsa/version.h>
@@ -51,6 +52,14 @@ typedef struct
     bool soft_mute;
     float soft_gain;
     char *device;
+
+    /* Pull mode (low latency) */
+    vlc_tick_t latency; /**< Buffer duration, 0 in push mode */
+    aout_pull_t *pull; /**< FIFO to the device thread */
+    vlc_thread_t thread;
+    atomic_bool running;
+    snd_pcm_uframes_t period; /**< Frames per write */
+    void *period_buf;
 } aout_sys_t;
 
 enum {
@@ -83,6 +92,11 @@ static const char *const channels_text[] = {
     N_("Surround 5.0"), N_("Surround 5.1"), N_("Surround 7.1"),
 };
 
+#define LATENCY_TEXT N_("Low latency buffer (ms)")
+#define LATENCY_LONGTEXT N_("If non-zero, the device is fed from a " \
+    "dedicated thread with short periods, and at most this duration of " \
+    "audio is buffered for the device. Zero uses large buffers.")
+
 #define PASSTHROUGH_TEXT N_("Audio passthrough mode")
 static const int passthrough_modes[] = {
     PASSTHROUGH_NONE, PASSTHROUGH_SPDIF, PASSTHROUGH_HDMI,
@@ -104,6 +118,8 @@ vlc_module_begin ()
     add_integer("alsa-passthrough", PASSTHROUGH_NONE, PASSTHROUGH_TEXT,
                 PASSTHROUGH_TEXT, false)
         change_integer_list(passthrough_modes, passthrough_modes_text)
+    add_integer_with_range("alsa-latency", 0, 0, 1000, LATENCY_TEXT,
+                           LATENCY_LONGTEXT, true)
     add_sw_gain ()
     set_capability( "audio output", 150 )
     set_callbacks( Open, Close )
@@ -295,6 +311,11 @@ static void Pause (audio_output_t *, bool, vlc_tick_t);
 static void PauseDummy (audio_output_t *, bool, vlc_tick_t);
 static void Flush (audio_output_t *);
 static void Drain (audio_output_t *);
+static int PullTimeGet (audio_output_t *, vlc_tick_t *);
+static void PullPlay (audio_output_t *, block_t *, vlc_tick_t);
+static void PullPause (audio_output_t *, bool, vlc_tick_t);
+static void PullFlush (audio_output_t *);
+static void *PullThread (void *);
 
 /** Initializes an ALSA playback stream */
 static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
@@ -522,22 +543,50 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
-#if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
-    param = AOUT_MIN_PREPARE_TIME;
-    val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
-    if (val)
+    sys->latency = 0;
+    if (passthrough == PASSTHROUGH_NONE)
+        sys->latency = VLC_TICK_FROM_MS(var_InheritInteger (aout,
+                                                            "alsa-latency"));
+    if (sys->latency > 0)
     {
-        msg_Err (aout, "cannot set period: %s", snd_strerror (val));
-        goto error;
+        /* Short periods, so that the device thread requests samples often */
+        param = US_FROM_VLC_TICK(sys->latency) / 4;
+        val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
+        if (val)
+        {
+            msg_Err (aout, "cannot set period: %s", snd_strerror (val));
+            goto error;
+        }
+
+        param = US_FROM_VLC_TICK(sys->latency);
+        val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
+        if (val)
+        {
+            msg_Err (aout, "cannot set buffer duration: %s",
+                     snd_strerror (val));
+            goto error;
+        }
     }
-#endif
-    /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
-    val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
-    if (val)
+    else
     {
-        msg_Err (aout, "cannot set buffer duration: %s", snd_strerror (val));
-        goto error;
+#if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
+        param = AOUT_MIN_PREPARE_TIME;
+        val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
+        if (val)
+        {
+            msg_Err (aout, "cannot set period: %s", snd_strerror (val));
+            goto error;
+        }
+#endif
+        /* Set buffer size */
+        param = AOUT_MAX_ADVANCE_TIME;
+        val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
+        if (val)
+        {
+            msg_Err (aout, "cannot set buffer duration: %s",
+                     snd_strerror (val));
+            goto error;
+        }
     }
 #if 0
     val = snd_pcm_hw_params_get_buffer_time (hw, &param, NULL);
@@ -611,6 +660,36 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
     sys->format = fmt->i_format;
 
+    if (sys->latency > 0)
+    {
+        /* The device thread keeps rendering (silence) while paused */
+        aout_FormatPrepare (fmt);
+        snd_pcm_hw_params_get_period_size (hw, &sys->period, NULL);
+        sys->period_buf = malloc (snd_pcm_frames_to_bytes (pcm, sys->period));
+        sys->pull = aout_PullNew (aout, fmt, sys->latency);
+        if (sys->period_buf == NULL || sys->pull == NULL)
+            goto error_pull;
+
+        atomic_init (&sys->running, true);
+        if (vlc_clone (&sys->thread, PullThread, aout,
+                       VLC_THREAD_PRIORITY_OUTPUT))
+            goto error_pull;
+
+        msg_Dbg (aout, "pull mode, %lu frames per period",
+                 (unsigned long)sys->period);
+        aout->time_get = PullTimeGet;
+        aout->play = PullPlay;
+        aout->pause = PullPause;
+        aout->flush = PullFlush;
+        aout->drain = NULL;
+        aout_SoftVolumeStart (aout);
+        return 0;
+    }
+
+    aout->time_get = TimeGet;
+    aout->play = Play;
+    aout->flush = Flush;
+    aout->drain = Drain;
     if (snd_pcm_hw_params_can_pause (hw))
         aout->pause = Pause;
     else
@@ -621,6 +700,11 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     aout_SoftVolumeStart (aout);
     return 0;
 
+error_pull:
+    if (sys->pull != NULL)
+        aout_PullDelete (sys->pull);
+    free (sys->period_buf);
+
 error:
     snd_pcm_close (pcm);
     return VLC_EGENERIC;
@@ -735,6 +819,87 @@ static void Drain (audio_output_t *aout)
     snd_pcm_prepare (pcm);
 }
 
+static int PullTimeGet (audio_output_t *aout, vlc_tick_t *restrict delay)
+{
+    aout_sys_t *sys = aout->sys;
+
+    return aout_PullTimeGet (sys->pull, delay);
+}
+
+static void PullPlay (audio_output_t *aout, block_t *block, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+
+    if (sys->chans_to_reorder != 0)
+        aout_ChannelReorder(block->p_buffer, block->i_buffer,
+                           sys->chans_to_reorder, sys->chans_table, sys->format);
+
+    aout_PullPlay (sys->pull, block, date);
+}
+
+static void PullPause (audio_output_t *aout, bool pause, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+
+    aout_PullPause (sys->pull, pause);
+    (void) date;
+}
+
+static void PullFlush (audio_output_t *aout)
+{
+    aout_sys_t *sys = aout->sys;
+
+    aout_PullFlush (sys->pull);
+}
+
+/**
+ * Feeds the device with one period at a time, in pull mode.
+ */
+static void *PullThread (void *data)
+{
+    audio_output_t *aout = data;
+    aout_sys_t *sys = aout->sys;
+    snd_pcm_t *pcm = sys->pcm;
+
+    while (atomic_load_explicit (&sys->running, memory_order_relaxed))
+    {
+        snd_pcm_sframes_t delay;
+
+        if (snd_pcm_delay (pcm, &delay) || delay < 0)
+            delay = 0;
+        aout_PullRender (sys->pull, sys->period_buf, sys->period,
+                         vlc_tick_now () + vlc_tick_from_samples (delay,
+                                                                  sys->rate));
+
+        /* Blocks until there is room for the period in the device buffer */
+        uint8_t *buf = sys->period_buf;
+        snd_pcm_uframes_t frames = sys->period;
+        while (frames > 0)
+        {
+            snd_pcm_sframes_t val = snd_pcm_writei (pcm, buf, frames);
+            if (val >= 0)
+            {
+                frames -= val;
+                buf += snd_pcm_frames_to_bytes (pcm, val);
+            }
+            else
+            {
+                int err = snd_pcm_recover (pcm, val, 1);
+                if (err)
+                {
+                    msg_Err (aout, "cannot recover playback stream: %s",
+                             snd_strerror (err));
+                    DumpDeviceStatus (aout, pcm);
+                    return NULL;
+                }
+                msg_Warn (aout, "cannot write samples: %s",
+                          snd_strerror (val));
+            }
+        }
+    }
+    return NULL;
+}
+
 /**
  * Releases the audio output.
  */
@@ -743,6 +908,15 @@ static void Stop (audio_output_t *aout)
     aout_sys_t *sys = aout->sys;
     snd_pcm_t *pcm = sys->pcm;
 
+    if (sys->latency > 0)
+    {
+        /* The device thread wakes up at least once per period */
+        atomic_store_explicit (&sys->running, false, memory_order_relaxed);
+        vlc_join (sys->thread, NULL);
+        aout_PullDelete (sys->pull);
+        free (sys->period_buf);
+    }
+
     snd_pcm_drop (pcm);
     snd_pcm_close (pcm);
 }
@@ -856,11 +1030,6 @@ static int Open(vlc_object_t *obj)
         free (ids);
     }
 
-    aout->time_get = TimeGet;
-    aout->play = Play;
-    aout->flush = Flush;
-    aout->drain = Drain;
-
     return VLC_SUCCESS;
 error:
     free (sys);
@@ -52,6 +52,10 @@ static const int  nloopf_list[] = { 0, 1, 2, 3, 4 };
 static const char *const nloopf_list_text[] =
   { N_("None"), N_("Non-ref"), N_("Bidir"), N_("Non-key"), N_("All") };
 
+static const int  hw_priority_list[] = { 0, 1, 2 };
+static const char *const hw_priority_list_text[] =
+  { N_("Low"), N_("Normal"), N_("High") };
+
 #ifdef ENABLE_SOUT
 static const char *const enc_hq_list[] = { "rd", "bits", "simple" };
 static const char *const enc_hq_list_text[] = {
@@ -132,6 +136,12 @@ vlc_module_begin ()
     add_string( "avcodec-codec", NULL, CODEC_TEXT, CODEC_LONGTEXT, true )
     add_obsolete_bool( "ffmpeg-hw" ) /* removed since 2.1.0 */
     add_module("avcodec-hw", "hw decoder", "any", HW_TEXT, HW_LONGTEXT)
+    add_integer( "avcodec-hw-concurrency", 0, HW_CONCURRENCY_TEXT,
+                 HW_CONCURRENCY_LONGTEXT, true )
+        change_integer_range( 0, 64 )
+    add_integer( "avcodec-hw-priority", 1, HW_PRIORITY_TEXT,
+                 HW_PRIORITY_LONGTEXT, true )
+        change_integer_list( hw_priority_list, hw_priority_list_text )
 #if defined(FF_THREAD_FRAME)
     add_obsolete_integer( "ffmpeg-threads" ) /* removed since 2.1.0 */
     add_integer( "avcodec-threads", 0, THREADS_TEXT, THREADS_LONGTEXT, true );
@@ -234,6 +244,8 @@ vlc_module_begin ()
                 ENC_PROFILE_TEXT, ENC_PROFILE_LONGTEXT, true )
 
     add_string( ENC_CFG_PREFIX "options", NULL, AV_OPTIONS_TEXT, AV_OPTIONS_LONGTEXT, true )
+    add_string( ENC_CFG_PREFIX "hw-device", NULL, ENC_HW_DEVICE_TEXT,
+                ENC_HW_DEVICE_LONGTEXT, true )
 #endif /* ENABLE_SOUT */
 
 #ifdef MERGE_FFMPEG
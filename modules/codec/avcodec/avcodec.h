@@ -112,6 +112,17 @@ int ffmpeg_OpenCodec( decoder_t *p_dec, AVCodecContext *, const AVCodec * );
 #define HW_TEXT N_("Hardware decoding")
 #define HW_LONGTEXT N_("This allows hardware decoding when available.")
 
+#define HW_CONCURRENCY_TEXT N_("Concurrent hardware decoders")
+#define HW_CONCURRENCY_LONGTEXT N_( \
+    "Maximum number of decoders submitting work to the hardware at the " \
+    "same time, 0 meaning unlimited. Limiting it evens out the latency " \
+    "when many streams are decoded at once." )
+
+#define HW_PRIORITY_TEXT N_("Hardware decoding priority")
+#define HW_PRIORITY_LONGTEXT N_( \
+    "Priority of this decoder when the concurrent hardware decoders " \
+    "are limited." )
+
 #define THREADS_TEXT N_( "Threads" )
 #define THREADS_LONGTEXT N_( "Number of threads used for decoding, 0 meaning auto" )
 
@@ -226,6 +237,11 @@ int ffmpeg_OpenCodec( decoder_t *p_dec, AVCodecContext *, const AVCodec * );
   "the PSNR isn't much changed (default: 0.0). The H264 specification " \
   "recommends 7." )
 
+#define ENC_HW_DEVICE_TEXT N_( "Hardware encoding device" )
+#define ENC_HW_DEVICE_LONGTEXT N_( "Device used by the hardware encoders " \
+  "taking GPU frames, such as h264_vaapi (e.g. /dev/dri/renderD128). " \
+  "The pictures are uploaded to the GPU before encoding." )
+
 #define ENC_PROFILE_TEXT N_( "Specify AAC audio profile to use" )
 #define ENC_PROFILE_LONGTEXT N_( "Specify the AAC audio profile to use " \
    "for encoding the audio bitstream. It takes the following options: " \
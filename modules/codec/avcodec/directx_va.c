@@ -282,6 +282,53 @@ char *directx_va_GetDecoderName(const GUID *guid)
     return psz_name;
 }
 
+/* Maximum number of reference/reordered pictures allowed by the stream level
+ * for its picture size (H.264 Table A-1, HEVC A.4.2), 16 if unknown */
+static unsigned GetMaxDpbFrames(const AVCodecContext *avctx)
+{
+    if (avctx->level <= 0)
+        return 16;
+
+    if (avctx->codec_id == AV_CODEC_ID_H264)
+    {
+        static const struct { int level; unsigned max_dpb_mbs; } limits[] = {
+            { 10, 396 }, { 11, 900 }, { 12, 2376 }, { 13, 2376 },
+            { 20, 2376 }, { 21, 4752 }, { 22, 8100 }, { 30, 8100 },
+            { 31, 18000 }, { 32, 20480 }, { 40, 32768 }, { 41, 32768 },
+            { 42, 34816 }, { 50, 110400 }, { 51, 184320 }, { 52, 184320 },
+            { 60, 696320 }, { 61, 696320 }, { 62, 696320 },
+        };
+        const unsigned mbs = ((avctx->coded_width + 15) / 16) *
+                             ((avctx->coded_height + 15) / 16);
+        for (size_t i = 0; i < ARRAY_SIZE(limits) && mbs > 0; i++)
+            if (limits[i].level >= avctx->level)
+                return __MIN(limits[i].max_dpb_mbs / mbs, 16);
+    }
+    else if (avctx->codec_id == AV_CODEC_ID_HEVC)
+    {
+        static const struct { int level; uint64_t max_luma_ps; } limits[] = {
+            { 30, 36864 }, { 60, 122880 }, { 63, 245760 }, { 90, 552960 },
+            { 93, 983040 }, { 123, 2228224 }, { 156, 8912896 }, { 186, 35651584 },
+        };
+        const uint64_t pic_size = (uint64_t)avctx->coded_width * avctx->coded_height;
+        const unsigned max_dpb_pic_buf = 6;
+        for (size_t i = 0; i < ARRAY_SIZE(limits); i++)
+        {
+            if (limits[i].level < avctx->level)
+                continue;
+            const uint64_t max_luma_ps = limits[i].max_luma_ps;
+            if (pic_size <= max_luma_ps >> 2)
+                return __MIN(4 * max_dpb_pic_buf, 16);
+            if (pic_size <= max_luma_ps >> 1)
+                return __MIN(2 * max_dpb_pic_buf, 16);
+            if (pic_size <= (3 * max_luma_ps) >> 2)
+                return __MIN((4 * max_dpb_pic_buf) / 3, 16);
+            return max_dpb_pic_buf;
+        }
+    }
+    return 16;
+}
+
 /* */
 int directx_va_Setup(vlc_va_t *va, const directx_sys_t *dx_sys, const AVCodecContext *avctx,
                      const es_format_t *fmt, int flag_xbox,
@@ -307,10 +354,12 @@ int directx_va_Setup(vlc_va_t *va, const directx_sys_t *dx_sys, const AVCodecCon
             surface_alignment = 16;
         else
             surface_alignment = 128;
-        surface_count += 16;
-        break;
+        /* fallthrough */
     case AV_CODEC_ID_H264:
-        surface_count += 16;
+        /* only allocate what the level allows for the picture size, plus
+         * the picture being decoded: a 4K decode needs about a third of
+         * the worst case */
+        surface_count += __MIN(GetMaxDpbFrames(avctx) + 1, 16);
         break;
     case AV_CODEC_ID_VP9:
         surface_count += 4;
@@ -43,6 +43,8 @@
 
 #include <libavcodec/avcodec.h>
 #include <libavutil/channel_layout.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
 
 #include "avcodec.h"
 #include "avcommon.h"
@@ -143,6 +145,10 @@ typedef struct
     int        i_aac_profile; /* AAC profile to use.*/
 
     AVFrame    *frame;
+
+    /* Hardware encoders: pictures are uploaded to frames of the device */
+    AVBufferRef *hw_frames;
+    AVFrame    *hw_frame;
 } encoder_sys_t;
 
 
@@ -190,7 +196,7 @@ static const char *const ppsz_enc_options[] = {
     "interlace", "interlace-me", "i-quant-factor", "noise-reduction", "mpeg4-matrix",
     "trellis", "qscale", "strict", "lumi-masking", "dark-masking",
     "p-masking", "border-masking",
-    "aac-profile", "options",
+    "aac-profile", "options", "hw-device",
     NULL
 };
 
@@ -288,6 +294,53 @@ static void add_av_option_float( encoder_t *p_enc, AVDictionary** pp_dict, const
         msg_Warn( p_enc, "Failed to set encoder option %s", psz_name );
 }
 
+static int OpenHwFrames( encoder_t *p_enc, encoder_sys_t *p_sys,
+                         enum AVHWDeviceType type )
+{
+    AVCodecContext *p_context = p_sys->p_context;
+    AVBufferRef *device;
+    char *psz_device = var_InheritString( p_enc, ENC_CFG_PREFIX "hw-device" );
+    int ret = av_hwdevice_ctx_create( &device, type, psz_device, NULL, 0 );
+
+    free( psz_device );
+    if( ret < 0 )
+    {
+        msg_Err( p_enc, "cannot open the %s device",
+                 av_hwdevice_get_type_name( type ) );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->hw_frames = av_hwframe_ctx_alloc( device );
+    av_buffer_unref( &device );
+    if( p_sys->hw_frames == NULL )
+        return VLC_ENOMEM;
+
+    AVHWFramesContext *frames = (AVHWFramesContext *)p_sys->hw_frames->data;
+    frames->format = p_context->pix_fmt;
+    frames->sw_format = AV_PIX_FMT_NV12;
+    frames->width = p_context->width;
+    frames->height = p_context->height;
+    frames->initial_pool_size = 20;
+
+    if( av_hwframe_ctx_init( p_sys->hw_frames ) < 0 )
+    {
+        msg_Err( p_enc, "cannot allocate the %s frames",
+                 av_hwdevice_get_type_name( type ) );
+        av_buffer_unref( &p_sys->hw_frames );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->hw_frame = av_frame_alloc();
+    if( p_sys->hw_frame == NULL )
+    {
+        av_buffer_unref( &p_sys->hw_frames );
+        return VLC_ENOMEM;
+    }
+    msg_Dbg( p_enc, "encoding from %s frames",
+             av_hwdevice_get_type_name( type ) );
+    return VLC_SUCCESS;
+}
+
 int InitVideoEnc( vlc_object_t *p_this )
 {
     encoder_t *p_enc = (encoder_t *)p_this;
@@ -567,7 +620,14 @@ int InitVideoEnc( vlc_object_t *p_this )
                 }
             }
             if (!found) p_context->pix_fmt = p_codec->pix_fmts[0];
-            GetVlcChroma( &p_enc->fmt_in.video, p_context->pix_fmt );
+
+            const AVPixFmtDescriptor *dsc =
+                av_pix_fmt_desc_get( p_context->pix_fmt );
+            if( dsc != NULL && (dsc->flags & AV_PIX_FMT_FLAG_HWACCEL) )
+                /* Uploaded to hardware frames when encoding */
+                p_enc->fmt_in.video.i_chroma = VLC_CODEC_NV12;
+            else
+                GetVlcChroma( &p_enc->fmt_in.video, p_context->pix_fmt );
             p_enc->fmt_in.i_codec = p_enc->fmt_in.video.i_chroma;
         }
 
@@ -867,6 +927,15 @@ int InitVideoEnc( vlc_object_t *p_this )
     else
         p_context->thread_count = vlc_GetCPUCount();
 
+    if( p_enc->fmt_in.i_cat == VIDEO_ES && p_context->pix_fmt == AV_PIX_FMT_VAAPI )
+    {
+        if( OpenHwFrames( p_enc, p_sys, AV_HWDEVICE_TYPE_VAAPI ) )
+            goto error;
+        p_context->hw_frames_ctx = av_buffer_ref( p_sys->hw_frames );
+        if( p_context->hw_frames_ctx == NULL )
+            goto error;
+    }
+
     int ret;
     char *psz_opts = var_InheritString(p_enc, ENC_CFG_PREFIX "options");
     if (psz_opts) {
@@ -1055,6 +1124,8 @@ error:
     free( p_enc->fmt_out.p_extra );
     av_free( p_sys->p_buffer );
     av_free( p_sys->p_interleave_buf );
+    av_frame_free( &p_sys->hw_frame );
+    av_buffer_unref( &p_sys->hw_frames );
     avcodec_free_context( &p_context );
     free( p_sys );
     return VLC_ENOMEM;
@@ -1236,6 +1307,22 @@ static block_t *EncodeVideo( encoder_t *p_enc, picture_t *p_pict )
         }
 
         frame->quality = p_sys->i_quality;
+
+        if( p_sys->hw_frames != NULL )
+        {   /* Upload the picture to a frame of the encoding device */
+            AVFrame *hw_frame = p_sys->hw_frame;
+
+            av_frame_unref( hw_frame );
+            frame->format = AV_PIX_FMT_NV12;
+            if( av_hwframe_get_buffer( p_sys->hw_frames, hw_frame, 0 ) < 0 ||
+                av_hwframe_transfer_data( hw_frame, frame, 0 ) < 0 ||
+                av_frame_copy_props( hw_frame, frame ) < 0 )
+            {
+                msg_Err( p_enc, "cannot upload the picture" );
+                return NULL;
+            }
+            frame = hw_frame;
+        }
     }
 
     block_t *p_block = encode_avframe( p_enc, p_sys, frame );
@@ -1468,11 +1555,13 @@ void EndVideoEnc( vlc_object_t *p_this )
     encoder_sys_t *p_sys = p_enc->p_sys;
 
     av_frame_free( &p_sys->frame );
+    av_frame_free( &p_sys->hw_frame );
 
     vlc_avcodec_lock();
     avcodec_close( p_sys->p_context );
     vlc_avcodec_unlock();
     avcodec_free_context( &p_sys->p_context );
+    av_buffer_unref( &p_sys->hw_frames );
 
 
     av_free( p_sys->p_interleave_buf );
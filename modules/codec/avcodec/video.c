@@ -100,9 +100,11 @@ typedef struct
 
     /* */
     bool palette_sent;
+    bool cpu_budget; /* holds a share of the CPU budget */
 
     /* VA API */
     vlc_va_t *p_va; /* Protected by lock */
+    unsigned i_hw_concurrency;
     enum PixelFormat pix_fmt;
     int profile;
     int level;
@@ -112,6 +114,76 @@ typedef struct
     vlc_mutex_t lock;
 } decoder_sys_t;
 
+/*****************************************************************************
+ * Hardware decoding submission metering
+ *****************************************************************************
+ * With many streams decoding at once (video walls), every decoder thread
+ * submits to the same hardware decode engine. Bound the number of decoders
+ * submitting at a time, and let the higher priority ones go first. A waiter
+ * only yields to higher priorities for a bounded time, so that low priority
+ * streams keep decoding.
+ *****************************************************************************/
+#define HW_PRIORITY_COUNT 3
+#define HW_PRIORITY_MAX_DELAY VLC_TICK_FROM_MS(50)
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    unsigned    i_active;
+    unsigned    i_waiting[HW_PRIORITY_COUNT];
+} hw_sched = { VLC_STATIC_MUTEX, VLC_STATIC_COND, 0, { 0 } };
+
+static bool HwSchedHigherWaiting( unsigned i_priority )
+{
+    for( unsigned i = i_priority + 1; i < HW_PRIORITY_COUNT; i++ )
+        if( hw_sched.i_waiting[i] > 0 )
+            return true;
+    return false;
+}
+
+static bool HwSchedAcquire( decoder_t *p_dec )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    if( p_sys->p_va == NULL || p_sys->i_hw_concurrency == 0 )
+        return false;
+
+    int64_t i_priority = var_InheritInteger( p_dec, "avcodec-hw-priority" );
+    if( i_priority < 0 )
+        i_priority = 0;
+    else if( i_priority >= HW_PRIORITY_COUNT )
+        i_priority = HW_PRIORITY_COUNT - 1;
+
+    const vlc_tick_t i_deadline = vlc_tick_now() + HW_PRIORITY_MAX_DELAY;
+    bool b_late = false;
+
+    vlc_mutex_lock( &hw_sched.lock );
+    hw_sched.i_waiting[i_priority]++;
+    while( hw_sched.i_active >= p_sys->i_hw_concurrency
+        || ( !b_late && HwSchedHigherWaiting( i_priority ) ) )
+    {
+        if( b_late )
+            vlc_cond_wait( &hw_sched.wait, &hw_sched.lock );
+        else if( vlc_cond_timedwait( &hw_sched.wait, &hw_sched.lock,
+                                     i_deadline ) )
+            b_late = true;
+    }
+    hw_sched.i_waiting[i_priority]--;
+    hw_sched.i_active++;
+    vlc_mutex_unlock( &hw_sched.lock );
+    return true;
+}
+
+static void HwSchedRelease( void )
+{
+    vlc_mutex_lock( &hw_sched.lock );
+    assert( hw_sched.i_active > 0 );
+    hw_sched.i_active--;
+    vlc_cond_broadcast( &hw_sched.wait );
+    vlc_mutex_unlock( &hw_sched.lock );
+}
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -159,6 +231,21 @@ static int lavc_GetVideoFormat(decoder_t *dec, video_format_t *restrict fmt,
             fmt->i_chroma = VLC_CODEC_RGB32;
 
         avcodec_align_dimensions2(ctx, &width, &height, aligns);
+
+        /* Pad the lines so that the pitch of every plane matches the
+         * libavcodec alignment, otherwise direct rendering would fail and
+         * each frame would be copied. The alignments are powers of 2. */
+        const vlc_chroma_description_t *dsc =
+            vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+        if (dsc != NULL)
+        {
+            unsigned modulo = 1;
+
+            for (unsigned i = 0; i < dsc->plane_count; i++)
+                modulo = __MAX(modulo, (unsigned)aligns[i] * dsc->p[i].w.den
+                                                           / dsc->p[i].w.num);
+            width = (width + modulo - 1) / modulo * modulo;
+        }
     }
     else /* hardware decoding */
         fmt->i_chroma = vlc_va_GetChroma(pix_fmt, sw_pix_fmt);
@@ -482,6 +569,11 @@ static int OpenVideoCodec( decoder_t *p_dec )
     if( ret < 0 )
         return ret;
 
+    /* With direct rendering, each frame thread holds pictures from the
+     * output pool: enlarge it accordingly */
+    if( ctx->active_thread_type & FF_THREAD_FRAME )
+        p_dec->i_extra_picture_buffers += 2 * ctx->thread_count;
+
     switch( ctx->active_thread_type )
     {
         case FF_THREAD_FRAME:
@@ -563,6 +655,7 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** libavcodec frame skipping ***** */
     p_sys->b_hurry_up = var_CreateGetBool( p_dec, "avcodec-hurry-up" );
     p_sys->b_show_corrupted = var_CreateGetBool( p_dec, "avcodec-corrupted" );
+    p_sys->i_hw_concurrency = var_InheritInteger( p_dec, "avcodec-hw-concurrency" );
 
     i_val = var_CreateGetInteger( p_dec, "avcodec-skip-frame" );
     if( i_val >= 4 ) p_sys->i_skip_frame = AVDISCARD_ALL;
@@ -604,9 +697,11 @@ int InitVideoDec( vlc_object_t *obj )
     p_context->reordered_opaque = 0;
 
     int i_thread_count = var_InheritInteger( p_dec, "avcodec-threads" );
-    if( i_thread_count <= 0 )
+    p_sys->cpu_budget = i_thread_count <= 0;
+    if( p_sys->cpu_budget )
     {
-        i_thread_count = vlc_GetCPUCount();
+        /* Share the CPUs with the other decoders */
+        i_thread_count = vlc_CPUBudgetAcquire( p_dec );
         if( i_thread_count > 1 )
             i_thread_count++;
 
@@ -642,9 +737,6 @@ int InitVideoDec( vlc_object_t *obj )
             break;
     }
 
-    if( p_context->thread_type & FF_THREAD_FRAME )
-        p_dec->i_extra_picture_buffers = 2 * p_context->thread_count;
-
     /* ***** misc init ***** */
     date_Init(&p_sys->pts, 1, 30001);
     p_sys->b_first_frame = true;
@@ -677,6 +769,8 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** Open the codec ***** */
     if( OpenVideoCodec( p_dec ) < 0 )
     {
+        if( p_sys->cpu_budget )
+            vlc_CPUBudgetRelease( p_dec );
         vlc_mutex_destroy( &p_sys->lock );
         free( p_sys );
         avcodec_free_context( &p_context );
@@ -1097,7 +1191,10 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
                 p_block->i_dts = VLC_TICK_INVALID;
             }
 
+            bool b_metered = HwSchedAcquire( p_dec );
             int ret = avcodec_send_packet(p_context, &pkt);
+            if( b_metered )
+                HwSchedRelease();
             if( ret != 0 && ret != AVERROR(EAGAIN) )
             {
                 if (ret == AVERROR(ENOMEM) || ret == AVERROR(EINVAL))
@@ -1131,7 +1228,10 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             break;
         }
 
+        bool b_metered = HwSchedAcquire( p_dec );
         int ret = avcodec_receive_frame(p_context, frame);
+        if( b_metered )
+            HwSchedRelease();
         if( ret != 0 && ret != AVERROR(EAGAIN) )
         {
             if (ret == AVERROR(ENOMEM) || ret == AVERROR(EINVAL))
@@ -1375,6 +1475,9 @@ void EndVideoDec( vlc_object_t *obj )
     if( p_sys->p_va )
         vlc_va_Delete( p_sys->p_va );
 
+    if( p_sys->cpu_budget )
+        vlc_CPUBudgetRelease( p_dec );
+
     vlc_mutex_destroy( &p_sys->lock );
     free( p_sys );
 }
@@ -32,6 +32,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
+#include <vlc_cpu.h>
 #include <vlc_timestamp_helper.h>
 
 #include <errno.h>
@@ -53,6 +54,10 @@ static void CloseDecoder(vlc_object_t *);
 #define THREAD_FRAMES_LONGTEXT N_( "Max number of threads used for frame decoding, default 0=auto" )
 #define THREAD_TILES_TEXT N_("Tiles Threads")
 #define THREAD_TILES_LONGTEXT N_( "Max number of threads used for tile decoding, default 0=auto" )
+#define EXPORT_GRAIN_TEXT N_("Export film grain")
+#define EXPORT_GRAIN_LONGTEXT N_( \
+    "Leave the film grain synthesis to the video output instead of the " \
+    "decoder. Only enable with a video output supporting it (Vulkan).")
 
 
 vlc_module_begin ()
@@ -67,6 +72,8 @@ vlc_module_begin ()
                 THREAD_FRAMES_TEXT, THREAD_FRAMES_LONGTEXT, false)
     add_integer("dav1d-thread-tiles", 0,
                 THREAD_TILES_TEXT, THREAD_TILES_LONGTEXT, false)
+    add_bool("dav1d-export-grain", false,
+             EXPORT_GRAIN_TEXT, EXPORT_GRAIN_LONGTEXT, true)
 vlc_module_end ()
 
 /*****************************************************************************
@@ -76,6 +83,7 @@ typedef struct
 {
     Dav1dSettings s;
     Dav1dContext *c;
+    bool cpu_budget; /* holds a share of the CPU budget */
 } decoder_sys_t;
 
 static const struct
@@ -160,6 +168,40 @@ static int NewPicture(Dav1dPicture *img, void *cookie)
     return -1;
 }
 
+static vlc_film_grain_t *ExportFilmGrain(const Dav1dPicture *img)
+{
+    if (img->frame_hdr == NULL || !img->frame_hdr->film_grain.present)
+        return NULL;
+
+    const Dav1dFilmGrainData *d = &img->frame_hdr->film_grain.data;
+    vlc_film_grain_t *fg = vlc_film_grain_New();
+    if (unlikely(fg == NULL))
+        return NULL;
+
+    fg->random_seed = d->seed;
+    fg->num_y_points = d->num_y_points;
+    memcpy(fg->y_points, d->y_points, sizeof (fg->y_points));
+    fg->chroma_scaling_from_luma = d->chroma_scaling_from_luma;
+    for (int i = 0; i < 2; i++)
+    {
+        fg->num_uv_points[i] = d->num_uv_points[i];
+        memcpy(fg->uv_points[i], d->uv_points[i], sizeof (fg->uv_points[i]));
+        memcpy(fg->ar_coeffs_uv[i], d->ar_coeffs_uv[i],
+               sizeof (fg->ar_coeffs_uv[i]));
+        fg->uv_mult[i] = d->uv_mult[i];
+        fg->uv_mult_luma[i] = d->uv_luma_mult[i];
+        fg->uv_offset[i] = d->uv_offset[i];
+    }
+    fg->scaling_shift = d->scaling_shift;
+    fg->ar_coeff_lag = d->ar_coeff_lag;
+    memcpy(fg->ar_coeffs_y, d->ar_coeffs_y, sizeof (fg->ar_coeffs_y));
+    fg->ar_coeff_shift = d->ar_coeff_shift;
+    fg->grain_scale_shift = d->grain_scale_shift;
+    fg->overlap = d->overlap_flag;
+    fg->clip_to_restricted_range = d->clip_to_restricted_range;
+    return fg;
+}
+
 static void FreePicture(Dav1dPicture *data, void *cookie)
 {
     picture_t *pic = data->allocator_data;
@@ -246,6 +288,8 @@ static int Decode(decoder_t *dec, block_t *block)
             }
             pic->b_progressive = true; /* codec does not support interlacing */
             pic->date = img.m.timestamp;
+            if (!p_sys->s.apply_grain)
+                pic->film_grain = ExportFilmGrain(&img);
             /* TODO udpate the color primaries and such */
             decoder_QueueVideo(dec, pic);
             dav1d_picture_unref(&img);
@@ -285,11 +329,22 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     dav1d_default_settings(&p_sys->s);
     p_sys->s.n_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
-    if (p_sys->s.n_tile_threads == 0)
-        p_sys->s.n_tile_threads = VLC_CLIP(vlc_GetCPUCount(), 1, 4);
     p_sys->s.n_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
-    if (p_sys->s.n_frame_threads == 0)
-        p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+    p_sys->cpu_budget = p_sys->s.n_tile_threads == 0
+                     || p_sys->s.n_frame_threads == 0;
+    if (p_sys->cpu_budget)
+    {
+        /* Share the CPUs with the other decoders */
+        unsigned threads = vlc_CPUBudgetAcquire(p_this);
+
+        if (p_sys->s.n_tile_threads == 0)
+            p_sys->s.n_tile_threads = VLC_CLIP(threads, 1, 4);
+        if (p_sys->s.n_frame_threads == 0)
+            p_sys->s.n_frame_threads = threads;
+    }
+    /* The pictures are decoded in place in the output pool either way, but
+     * the grain is applied to a second picture when done by dav1d */
+    p_sys->s.apply_grain = !var_InheritBool(p_this, "dav1d-export-grain");
     p_sys->s.allocator.cookie = dec;
     p_sys->s.allocator.alloc_picture_callback = NewPicture;
     p_sys->s.allocator.release_picture_callback = FreePicture;
@@ -297,6 +352,8 @@ static int OpenDecoder(vlc_object_t *p_this)
     if (dav1d_open(&p_sys->c, &p_sys->s) < 0)
     {
         msg_Err(p_this, "Could not open the Dav1d decoder");
+        if (p_sys->cpu_budget)
+            vlc_CPUBudgetRelease(p_this);
         return VLC_EGENERIC;
     }
 
@@ -336,5 +393,8 @@ static void CloseDecoder(vlc_object_t *p_this)
     FlushDecoder(dec);
 
     dav1d_close(&p_sys->c);
+
+    if (p_sys->cpu_budget)
+        vlc_CPUBudgetRelease(p_this);
 }
 
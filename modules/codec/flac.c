@@ -177,20 +177,56 @@ vlc_module_end ()
 /*****************************************************************************
  * Interleave: helper function to interleave channels
  *****************************************************************************/
+static inline int32_t ScaleSample( int32_t i_sample, unsigned shift )
+{
+    union { int32_t i; uint32_t u; } spl;
+
+    spl.u = ((uint32_t)i_sample) << shift;
+    return spl.i;
+}
+
 static void Interleave( int32_t *p_out, const int32_t * const *pp_in,
                         const uint8_t *restrict pi_index, unsigned i_nb_channels,
                         unsigned i_samples, unsigned bits )
 {
     unsigned shift = 32 - bits;
+    const int32_t *pp_src[FLAC__MAX_CHANNELS];
 
-    for( unsigned j = 0; j < i_samples; j++ )
-        for( unsigned i = 0; i < i_nb_channels; i++ )
-        {
-            union { int32_t i; uint32_t u; } spl;
+    for( unsigned i = 0; i < i_nb_channels; i++ )
+        pp_src[i] = pp_in[pi_index[i]];
 
-            spl.u = ((uint32_t)pp_in[pi_index[i]][j]) << shift;
-            p_out[j * i_nb_channels + i] = spl.i;
+    /* Mono and stereo streams get simple loops the compiler can
+     * vectorize, other layouts are written one channel at a time */
+    switch( i_nb_channels )
+    {
+        case 1:
+        {
+            const int32_t *restrict p_src = pp_src[0];
+            for( unsigned j = 0; j < i_samples; j++ )
+                p_out[j] = ScaleSample( p_src[j], shift );
+            break;
+        }
+        case 2:
+        {
+            const int32_t *restrict p_left = pp_src[0];
+            const int32_t *restrict p_right = pp_src[1];
+            for( unsigned j = 0; j < i_samples; j++ )
+            {
+                p_out[2 * j]     = ScaleSample( p_left[j], shift );
+                p_out[2 * j + 1] = ScaleSample( p_right[j], shift );
+            }
+            break;
         }
+        default:
+            for( unsigned i = 0; i < i_nb_channels; i++ )
+            {
+                const int32_t *restrict p_src = pp_src[i];
+                int32_t *p_dst = &p_out[i];
+                for( unsigned j = 0; j < i_samples; j++ )
+                    p_dst[j * i_nb_channels] = ScaleSample( p_src[j], shift );
+            }
+            break;
+    }
 }
 
 /*****************************************************************************
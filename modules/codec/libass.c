@@ -101,6 +101,16 @@ static void SubpictureUpdate( subpicture_t *,
                               vlc_tick_t );
 static void SubpictureDestroy( subpicture_t * );
 
+typedef struct
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} rectangle_t;
+
+#define MAX_REGIONS 4
+
 typedef struct
 {
     decoder_sys_t *p_dec_sys;
@@ -109,18 +119,22 @@ typedef struct
     vlc_tick_t    i_pts;
 
     ASS_Image     *p_img;
-} libass_spu_updater_sys_t;
 
-typedef struct
-{
-    int x0;
-    int y0;
-    int x1;
-    int y1;
-} rectangle_t;
+    /* Regions drawn by the last update, reused while their content
+     * does not change (karaoke only updates a few glyphs) */
+    struct libass_region
+    {
+        rectangle_t rect;
+        uint64_t    i_hash;
+        picture_t   *p_picture;
+    } regions[MAX_REGIONS];
+    int           i_regions;
+} libass_spu_updater_sys_t;
 
 static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_img_list, int i_width, int i_height );
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img );
+static uint64_t RegionHash( const rectangle_t *p_rect, const ASS_Image *p_img );
+static void RegionsClear( libass_spu_updater_sys_t *p_spusys );
 
 //#define DEBUG_REGION
 
@@ -373,6 +387,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     }
 
     p_spu_sys->p_img = NULL;
+    p_spu_sys->i_regions = 0;
     p_spu_sys->p_dec_sys = p_sys;
     p_spu_sys->i_subs_len = p_block->i_buffer;
     p_spu_sys->p_subs_data = malloc( p_block->i_buffer );
@@ -477,18 +492,20 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
      * reinstanciate a lot the scaler, and as we do not support subpel blending
      * it looks ugly (text unaligned).
      */
-    const int i_max_region = 4;
-    rectangle_t region[i_max_region];
-    const int i_region = BuildRegions( region, i_max_region, p_img, fmt.i_width, fmt.i_height );
+    rectangle_t region[MAX_REGIONS];
+    const int i_region = BuildRegions( region, MAX_REGIONS, p_img, fmt.i_width, fmt.i_height );
 
     if( i_region <= 0 )
     {
+        RegionsClear( p_spusys );
         vlc_mutex_unlock( &p_sys->lock );
         return;
     }
 
     /* Allocate the regions and draw them */
     subpicture_region_t **pp_region_last = &p_subpic->p_region;
+    struct libass_region drawn[MAX_REGIONS];
+    int i_drawn = 0;
 
     for( int i = 0; i < i_region; i++ )
     {
@@ -502,7 +519,25 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         fmt_region.i_height =
         fmt_region.i_visible_height = region[i].y1 - region[i].y0;
 
-        r = subpicture_region_New( &fmt_region );
+        /* Share the previous picture if the same images land in it */
+        const uint64_t i_hash = RegionHash( &region[i], p_img );
+        picture_t *p_reuse = NULL;
+        for( int j = 0; j < p_spusys->i_regions; j++ )
+        {
+            const rectangle_t *p_prev = &p_spusys->regions[j].rect;
+            if( p_spusys->regions[j].i_hash == i_hash &&
+                p_prev->x0 == region[i].x0 && p_prev->y0 == region[i].y0 &&
+                p_prev->x1 == region[i].x1 && p_prev->y1 == region[i].y1 )
+            {
+                p_reuse = p_spusys->regions[j].p_picture;
+                break;
+            }
+        }
+
+        if( p_reuse )
+            r = subpicture_region_ForPicture( &fmt_region, p_reuse );
+        else
+            r = subpicture_region_New( &fmt_region );
         if( !r )
             break;
         r->i_x = region[i].x0;
@@ -510,12 +545,21 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         r->i_align = SUBPICTURE_ALIGN_TOP | SUBPICTURE_ALIGN_LEFT;
 
         /* */
-        RegionDraw( r, p_img );
+        if( !p_reuse )
+            RegionDraw( r, p_img );
+
+        drawn[i_drawn].rect = region[i];
+        drawn[i_drawn].i_hash = i_hash;
+        drawn[i_drawn].p_picture = picture_Hold( r->p_picture );
+        i_drawn++;
 
         /* */
         *pp_region_last = r;
         pp_region_last = &r->p_next;
     }
+    RegionsClear( p_spusys );
+    memcpy( p_spusys->regions, drawn, i_drawn * sizeof(*drawn) );
+    p_spusys->i_regions = i_drawn;
     vlc_mutex_unlock( &p_sys->lock );
 
 }
@@ -523,6 +567,7 @@ static void SubpictureDestroy( subpicture_t *p_subpic )
 {
     libass_spu_updater_sys_t *p_spusys = p_subpic->updater.p_sys;
 
+    RegionsClear( p_spusys );
     DecSysRelease( p_spusys->p_dec_sys );
     free( p_spusys->p_subs_data );
     free( p_spusys );
@@ -682,6 +727,41 @@ static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_i
     return i_region;
 }
 
+static void RegionsClear( libass_spu_updater_sys_t *p_spusys )
+{
+    for( int i = 0; i < p_spusys->i_regions; i++ )
+        picture_Release( p_spusys->regions[i].p_picture );
+    p_spusys->i_regions = 0;
+}
+
+/* FNV-1a over the images RegionDraw would blend into the rectangle */
+static uint64_t RegionHash( const rectangle_t *p_rect, const ASS_Image *p_img )
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+#define HASH(v) do { h ^= (uint64_t)(v); h *= UINT64_C(0x100000001b3); } while(0)
+    for( ; p_img != NULL; p_img = p_img->next )
+    {
+        if( p_img->w <= 0 || p_img->h <= 0 ||
+            p_img->dst_x < p_rect->x0 || p_img->dst_x + p_img->w > p_rect->x1 ||
+            p_img->dst_y < p_rect->y0 || p_img->dst_y + p_img->h > p_rect->y1 )
+            continue;
+
+        HASH( p_img->dst_x );
+        HASH( p_img->dst_y );
+        HASH( p_img->w );
+        HASH( p_img->h );
+        HASH( p_img->color );
+        for( int y = 0; y < p_img->h; y++ )
+        {
+            const unsigned char *p_line = &p_img->bitmap[y * p_img->stride];
+            for( int x = 0; x < p_img->w; x++ )
+                HASH( p_line[x] );
+        }
+    }
+#undef HASH
+    return h;
+}
+
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
 {
     const plane_t *p = &p_region->p_picture->p[0];
@@ -106,6 +106,12 @@ typedef struct
 {
     int                     i_align;
     struct ttml_in_pes_ctx  pes;
+    struct
+    {
+        uint8_t   *p_bytes; /* raw <head> element of the last document */
+        size_t     i_bytes;
+        tt_node_t *p_node;  /* parsed <head>, NULL while owned by a tree */
+    } head;
 } decoder_sys_t;
 
 enum
@@ -124,6 +130,7 @@ enum
  * style, and sets from parent node.
  */
 static tt_node_t *ParseTTML( decoder_t *, const uint8_t *, size_t );
+static void ReleaseTTML( decoder_t *, tt_node_t * );
 
 static void ttml_style_Delete( ttml_style_t* p_ttml_style )
 {
@@ -570,26 +577,23 @@ static void FillTTMLStyle( const char *psz_attr, const char *psz_val,
 static void DictionaryMerge( const vlc_dictionary_t *p_src, vlc_dictionary_t *p_dst,
                              bool b_override )
 {
-    for( int i = 0; i < p_src->i_size; ++i )
+    const vlc_dictionary_entry_t *p_entry;
+    vlc_dictionary_foreach( p_entry, p_src )
     {
-        for ( const vlc_dictionary_entry_t* p_entry = p_src->p_entries[i];
-                                            p_entry != NULL; p_entry = p_entry->p_next )
+        if( !strncmp( "tts:", p_entry->psz_key, 4 ) ||
+            !strncmp( "ttp:", p_entry->psz_key, 4 ) ||
+            !strcmp( "xml:space", p_entry->psz_key ) )
         {
-            if( !strncmp( "tts:", p_entry->psz_key, 4 ) ||
-                !strncmp( "ttp:", p_entry->psz_key, 4 ) ||
-                !strcmp( "xml:space", p_entry->psz_key ) )
+            if( vlc_dictionary_has_key( p_dst, p_entry->psz_key ) )
             {
-                if( vlc_dictionary_has_key( p_dst, p_entry->psz_key ) )
+                if( b_override )
                 {
-                    if( b_override )
-                    {
-                        vlc_dictionary_remove_value_for_key( p_dst, p_entry->psz_key, NULL, NULL );
-                        vlc_dictionary_insert( p_dst, p_entry->psz_key, p_entry->p_value );
-                    }
-                }
-                else
+                    vlc_dictionary_remove_value_for_key( p_dst, p_entry->psz_key, NULL, NULL );
                     vlc_dictionary_insert( p_dst, p_entry->psz_key, p_entry->p_value );
+                }
             }
+            else
+                vlc_dictionary_insert( p_dst, p_entry->psz_key, p_entry->p_value );
         }
     }
 }
@@ -663,14 +667,9 @@ static void DictMergeWithRegionID( ttml_context_t *p_ctx, const char *psz_id,
 static void DictToTTMLStyle( ttml_context_t *p_ctx, const vlc_dictionary_t *p_dict,
                              ttml_style_t *p_ttml_style )
 {
-    for( int i = 0; i < p_dict->i_size; ++i )
-    {
-        for ( vlc_dictionary_entry_t* p_entry = p_dict->p_entries[i];
-              p_entry != NULL; p_entry = p_entry->p_next )
-        {
-            FillTTMLStyle( p_entry->psz_key, p_entry->p_value, p_ttml_style );
-        }
-    }
+    const vlc_dictionary_entry_t *p_entry;
+    vlc_dictionary_foreach( p_entry, p_dict )
+        FillTTMLStyle( p_entry->psz_key, p_entry->p_value, p_ttml_style );
     ComputeTTMLStyles( p_ctx, p_dict, p_ttml_style );
 }
 
@@ -807,15 +806,10 @@ static ttml_region_t *GetTTMLRegion( ttml_context_t *p_ctx, const char *psz_regi
             if( (p_region = ttml_region_New( false )) )
             {
                 /* Fill from its own attributes */
-                for( int i = 0; i < merged.i_size; ++i )
-                {
-                    for ( vlc_dictionary_entry_t* p_entry = merged.p_entries[i];
-                          p_entry != NULL; p_entry = p_entry->p_next )
-                    {
-                        FillRegionStyle( p_ctx, p_entry->psz_key, p_entry->p_value,
-                                         p_region );
-                    }
-                }
+                const vlc_dictionary_entry_t *p_entry;
+                vlc_dictionary_foreach( p_entry, &merged )
+                    FillRegionStyle( p_ctx, p_entry->psz_key, p_entry->p_value,
+                                     p_region );
             }
             vlc_dictionary_clear( &merged, NULL, NULL );
 
@@ -1017,7 +1011,7 @@ static void ConvertNodesToRegionContent( ttml_context_t *p_ctx, const tt_node_t
         ttml_style_Delete( p_set_styles );
 }
 
-static tt_node_t *ParseTTML( decoder_t *p_dec, const uint8_t *p_buffer, size_t i_buffer )
+static tt_node_t *ParseTTMLBuffer( decoder_t *p_dec, const uint8_t *p_buffer, size_t i_buffer )
 {
     stream_t*       p_sub;
     xml_reader_t*   p_xml_reader;
@@ -1047,6 +1041,179 @@ static tt_node_t *ParseTTML( decoder_t *p_dec, const uint8_t *p_buffer, size_t i
     return p_rootnode;
 }
 
+/* Locates the <head> element, which holds the styling and layout, so that
+ * documents repeating the same one (live segments) can reuse it.
+ * Self-closing or missing heads are not worth caching. */
+static bool FindHeadElement( const uint8_t *p_buffer, size_t i_buffer,
+                             size_t *pi_start, size_t *pi_end, size_t *pi_name )
+{
+    for( const uint8_t *p = p_buffer;
+         (p = memchr( p, '<', i_buffer - (p - p_buffer) )) != NULL; p++ )
+    {
+        const uint8_t *p_end = p_buffer + i_buffer;
+        const uint8_t *n = p + 1;
+        const uint8_t *p_local = n;
+        while( n < p_end && (isalnum( *n ) || *n == '_' || *n == '-' || *n == '.') )
+            n++;
+        if( n < p_end && *n == ':' )
+        {
+            p_local = ++n;
+            while( n < p_end && (isalnum( *n ) || *n == '_' || *n == '-' || *n == '.') )
+                n++;
+        }
+        if( n - p_local != 4 || memcmp( p_local, "head", 4 ) || n == p_end ||
+            (*n != '>' && !isspace( *n )) )
+            continue;
+
+        const size_t i_name = n - (p + 1);
+        const uint8_t *p_gt = memchr( n, '>', p_end - n );
+        if( p_gt == NULL || p_gt[-1] == '/' )
+            return false;
+
+        /* matching end tag */
+        for( const uint8_t *e = p_gt;
+             (e = memchr( e, '<', p_end - e )) != NULL; e++ )
+        {
+            if( (size_t)(p_end - e) >= i_name + 3 && e[1] == '/' &&
+                !memcmp( &e[2], p + 1, i_name ) && e[2 + i_name] == '>' )
+            {
+                *pi_start = p - p_buffer;
+                *pi_end = &e[3 + i_name] - p_buffer;
+                *pi_name = i_name;
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+static tt_node_t *FindHeadChild( tt_node_t *p_rootnode, tt_basenode_t ***ppp_link )
+{
+    for( tt_basenode_t **pp = &p_rootnode->p_child; *pp; pp = &(*pp)->p_next )
+    {
+        if( (*pp)->i_type == TT_NODE_TYPE_ELEMENT &&
+            !tt_node_NameCompare( ((tt_node_t *) *pp)->psz_node_name, "head" ) )
+        {
+            if( ppp_link )
+                *ppp_link = pp;
+            return (tt_node_t *) *pp;
+        }
+    }
+    return NULL;
+}
+
+static void ClearHeadCache( decoder_sys_t *p_sys )
+{
+    if( p_sys->head.p_node )
+        tt_node_RecursiveDelete( p_sys->head.p_node );
+    free( p_sys->head.p_bytes );
+    p_sys->head.p_node = NULL;
+    p_sys->head.p_bytes = NULL;
+    p_sys->head.i_bytes = 0;
+}
+
+/* Parses the document with its unchanged <head> stubbed out,
+ * then grafts the previously parsed one in place */
+static tt_node_t *ParseTTMLCachedHead( decoder_t *p_dec, const uint8_t *p_buffer,
+                                       size_t i_buffer, size_t i_start,
+                                       size_t i_end, size_t i_name )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+    const size_t i_stub = i_start + i_name + 3 + (i_buffer - i_end);
+
+    uint8_t *p_stub = malloc( i_stub );
+    if( unlikely( p_stub == NULL ) )
+        return NULL;
+
+    memcpy( p_stub, p_buffer, i_start + 1 + i_name );
+    memcpy( &p_stub[i_start + 1 + i_name], "/>", 2 );
+    memcpy( &p_stub[i_start + i_name + 3], &p_buffer[i_end], i_buffer - i_end );
+
+    tt_node_t *p_rootnode = ParseTTMLBuffer( p_dec, p_stub, i_stub );
+    free( p_stub );
+    if( p_rootnode == NULL )
+        return NULL;
+
+    tt_basenode_t **pp_link;
+    tt_node_t *p_stubhead = FindHeadChild( p_rootnode, &pp_link );
+    if( p_stubhead == NULL || p_stubhead->p_child != NULL )
+    {
+        /* matched something else than the actual head */
+        tt_node_RecursiveDelete( p_rootnode );
+        return NULL;
+    }
+
+    tt_node_t *p_head = p_sys->head.p_node;
+    p_head->p_parent = p_rootnode;
+    p_head->p_next = p_stubhead->p_next;
+    *pp_link = (tt_basenode_t *) p_head;
+    p_sys->head.p_node = NULL;
+
+    p_stubhead->p_next = NULL;
+    tt_node_RecursiveDelete( p_stubhead );
+
+    return p_rootnode;
+}
+
+static tt_node_t *ParseTTML( decoder_t *p_dec, const uint8_t *p_buffer, size_t i_buffer )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+    size_t i_start, i_end, i_name;
+
+    if( !FindHeadElement( p_buffer, i_buffer, &i_start, &i_end, &i_name ) )
+    {
+        ClearHeadCache( p_sys );
+        return ParseTTMLBuffer( p_dec, p_buffer, i_buffer );
+    }
+
+    const uint8_t *p_head = &p_buffer[i_start];
+    const size_t i_head = i_end - i_start;
+
+    if( p_sys->head.p_node && p_sys->head.i_bytes == i_head &&
+        !memcmp( p_sys->head.p_bytes, p_head, i_head ) )
+    {
+        tt_node_t *p_rootnode = ParseTTMLCachedHead( p_dec, p_buffer, i_buffer,
+                                                     i_start, i_end, i_name );
+        if( p_rootnode )
+            return p_rootnode;
+    }
+
+    /* (re)fill the cache from this document */
+    ClearHeadCache( p_sys );
+    p_sys->head.p_bytes = malloc( i_head );
+    if( likely( p_sys->head.p_bytes ) )
+    {
+        memcpy( p_sys->head.p_bytes, p_head, i_head );
+        p_sys->head.i_bytes = i_head;
+    }
+
+    tt_node_t *p_rootnode = ParseTTMLBuffer( p_dec, p_buffer, i_buffer );
+    if( p_rootnode == NULL )
+        ClearHeadCache( p_sys );
+    return p_rootnode;
+}
+
+static void ReleaseTTML( decoder_t *p_dec, tt_node_t *p_rootnode )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+    tt_basenode_t **pp_link;
+    tt_node_t *p_head;
+
+    /* keep the head of the tree for the next document */
+    if( p_sys->head.p_bytes && p_sys->head.p_node == NULL &&
+        (p_head = FindHeadChild( p_rootnode, &pp_link )) )
+    {
+        *pp_link = p_head->p_next;
+        p_head->p_next = NULL;
+        p_head->p_parent = NULL;
+        tt_node_ResetTimings( p_head );
+        p_sys->head.p_node = p_head;
+    }
+
+    tt_node_RecursiveDelete( p_rootnode );
+}
+
 static void InitTTMLContext( tt_node_t *p_rootnode, ttml_context_t *p_ctx )
 {
     p_ctx->p_rootnode = p_rootnode;
@@ -1095,14 +1262,11 @@ static ttml_region_t *GenerateRegions( tt_node_t *p_rootnode, tt_time_t playback
             vlc_dictionary_init( &context.regions, 1 );
             ConvertNodesToRegionContent( &context, p_bodynode, NULL, NULL, playbacktime );
 
-            for( int i = 0; i < context.regions.i_size; ++i )
+            const vlc_dictionary_entry_t *p_entry;
+            vlc_dictionary_foreach( p_entry, &context.regions )
             {
-                for ( const vlc_dictionary_entry_t* p_entry = context.regions.p_entries[i];
-                                                    p_entry != NULL; p_entry = p_entry->p_next )
-                {
-                    *pp_region_last = (ttml_region_t *) p_entry->p_value;
-                    pp_region_last = (ttml_region_t **) &(*pp_region_last)->updt.p_next;
-                }
+                *pp_region_last = (ttml_region_t *) p_entry->p_value;
+                pp_region_last = (ttml_region_t **) &(*pp_region_last)->updt.p_next;
             }
 
             vlc_dictionary_clear( &context.regions, NULL, NULL );
@@ -1320,7 +1484,7 @@ static int ParseBlock( decoder_t *p_dec, const block_t *p_block )
             decoder_QueueSub( p_dec, p_spu );
     }
 
-    tt_node_RecursiveDelete( p_rootnode );
+    ReleaseTTML( p_dec, p_rootnode );
 
     free( p_timings_array );
 
@@ -1399,5 +1563,6 @@ void tt_CloseDecoder( vlc_object_t *p_this )
     decoder_t *p_dec = (decoder_t *)p_this;
     decoder_sys_t *p_sys = p_dec->p_sys;
 
+    ClearHeadCache( p_sys );
     free( p_sys );
 }
@@ -206,6 +206,20 @@ static tt_textnode_t *tt_textnode_New( tt_node_t *p_parent, const char *psz_text
     return p_node;
 }
 
+static void tt_node_ParseTiming( tt_node_t *p_node, const char *psz_key,
+                                 const char *psz_val )
+{
+    if( !strcasecmp( psz_key, "begin" ) )
+        p_node->timings.begin = tt_ParseTime( psz_val );
+    else if( ! strcasecmp( psz_key, "end" ) )
+        p_node->timings.end = tt_ParseTime( psz_val );
+    else if( ! strcasecmp( psz_key, "dur" ) )
+        p_node->timings.dur = tt_ParseTime( psz_val );
+    else if( ! strcasecmp( psz_key, "timeContainer" ) )
+        p_node->timings.i_type = strcmp( psz_val, "seq" ) ? TT_TIMINGS_PARALLEL
+                                                          : TT_TIMINGS_SEQUENTIAL;
+}
+
 tt_node_t * tt_node_New( xml_reader_t* reader, tt_node_t* p_parent, const char* psz_node_name )
 {
     tt_node_t *p_node = calloc( 1, sizeof( *p_node ) );
@@ -236,20 +250,29 @@ tt_node_t * tt_node_New( xml_reader_t* reader, tt_node_t* p_parent, const char*
         if( psz_val )
         {
             vlc_dictionary_insert( &p_node->attr_dict, psz_key, psz_val );
-
-            if( !strcasecmp( psz_key, "begin" ) )
-                p_node->timings.begin = tt_ParseTime( psz_val );
-            else if( ! strcasecmp( psz_key, "end" ) )
-                p_node->timings.end = tt_ParseTime( psz_val );
-            else if( ! strcasecmp( psz_key, "dur" ) )
-                p_node->timings.dur = tt_ParseTime( psz_val );
-            else if( ! strcasecmp( psz_key, "timeContainer" ) )
-                p_node->timings.i_type = strcmp( psz_val, "seq" ) ? TT_TIMINGS_PARALLEL
-                                                                  : TT_TIMINGS_SEQUENTIAL;
+            tt_node_ParseTiming( p_node, psz_key, psz_val );
         }
     }
     return p_node;
 }
+
+void tt_node_ResetTimings( tt_node_t *p_node )
+{
+    p_node->timings.i_type = TT_TIMINGS_UNSPEC;
+    tt_time_Init( &p_node->timings.begin );
+    tt_time_Init( &p_node->timings.end );
+    tt_time_Init( &p_node->timings.dur );
+
+    const vlc_dictionary_entry_t *p_entry;
+    vlc_dictionary_foreach( p_entry, &p_node->attr_dict )
+        tt_node_ParseTiming( p_node, p_entry->psz_key, p_entry->p_value );
+
+    for( tt_basenode_t *p_child = p_node->p_child; p_child; p_child = p_child->p_next )
+    {
+        if( p_child->i_type == TT_NODE_TYPE_ELEMENT )
+            tt_node_ResetTimings( (tt_node_t *) p_child );
+    }
+}
 #if 0
 static int tt_node_Skip( xml_reader_t *p_reader, const char *psz_skipped )
 {
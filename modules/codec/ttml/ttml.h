@@ -90,6 +90,8 @@ typedef struct
 
 tt_node_t * tt_node_New( xml_reader_t* reader, tt_node_t* p_parent, const char* psz_node_name );
 void tt_node_RecursiveDelete( tt_node_t *p_node );
+/* Restores the timings as read from the attributes, undoing tt_timings_Resolve */
+void tt_node_ResetTimings( tt_node_t *p_node );
 int  tt_node_NameCompare( const char* psz_tagname, const char* psz_pattern );
 bool tt_node_HasChild( const tt_node_t *p_node );
 
@@ -0,0 +1,781 @@
+/*****************************************************************************
+ * v4l2m2m.c: Video4Linux2 memory-to-memory hardware video decoder
+ *****************************************************************************
+ * Copyright (C) 2019 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_fs.h>
+
+#include "hxxx_helper.h"
+
+#ifndef V4L2_PIX_FMT_HEVC
+# define V4L2_PIX_FMT_HEVC v4l2_fourcc('H', 'E', 'V', 'C')
+#endif
+#ifndef V4L2_PIX_FMT_VP9
+# define V4L2_PIX_FMT_VP9 v4l2_fourcc('V', 'P', '9', '0')
+#endif
+
+/****************************************************************************
+ * Local prototypes
+ ****************************************************************************/
+static int  OpenDecoder(vlc_object_t *);
+static void CloseDecoder(vlc_object_t *);
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+#define DEV_TEXT N_("Device")
+#define DEV_LONGTEXT N_("Video4Linux2 memory-to-memory decoder device node. " \
+    "By default, the first device supporting the codec is used.")
+
+vlc_module_begin ()
+    set_shortname("V4L2 M2M")
+    set_description(N_("Video4Linux2 memory-to-memory video decoder"))
+    set_capability("video decoder", 700)
+    set_callbacks(OpenDecoder, CloseDecoder)
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+    add_shortcut("v4l2m2m")
+
+    add_loadfile("v4l2m2m-dev", NULL, DEV_TEXT, DEV_LONGTEXT)
+vlc_module_end ()
+
+/*****************************************************************************
+ * decoder_sys_t
+ *****************************************************************************/
+#define OUTPUT_BUFFERS   8
+#define OUTPUT_SIZE      (2 << 20)
+#define CAPTURE_MAX      32
+#define DEVICES_MAX      64
+#define POLL_TIMEOUT     1000 /* ms */
+
+struct m2m_buffer
+{
+    void  *p_map[VIDEO_MAX_PLANES];
+    size_t i_length[VIDEO_MAX_PLANES];
+    bool   b_queued;
+};
+
+typedef struct
+{
+    int fd;
+
+    /* Compressed input */
+    struct m2m_buffer output[OUTPUT_BUFFERS];
+    unsigned i_output;
+
+    /* Decoded pictures */
+    struct m2m_buffer capture[CAPTURE_MAX];
+    unsigned i_capture;
+    unsigned i_capture_planes;
+    struct v4l2_pix_format_mplane capture_fmt;
+    bool b_capture_on;
+
+    struct hxxx_helper hh;
+    bool b_hxxx;
+    block_t *p_config; /* AnnexB parameter sets to send first */
+} decoder_sys_t;
+
+static const struct
+{
+    vlc_fourcc_t i_codec;
+    uint32_t     i_pixfmt;
+} codecs[] = {
+    { VLC_CODEC_H264, V4L2_PIX_FMT_H264 },
+    { VLC_CODEC_HEVC, V4L2_PIX_FMT_HEVC },
+    { VLC_CODEC_MPGV, V4L2_PIX_FMT_MPEG2 },
+    { VLC_CODEC_VP8,  V4L2_PIX_FMT_VP8 },
+    { VLC_CODEC_VP9,  V4L2_PIX_FMT_VP9 },
+};
+
+static int xioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+    do
+        ret = ioctl(fd, request, arg);
+    while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+/*****************************************************************************
+ * Device probing
+ *****************************************************************************/
+static bool DeviceSupports(vlc_object_t *obj, int fd, uint32_t i_pixfmt)
+{
+    struct v4l2_capability cap;
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap))
+        return false;
+
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS)
+                  ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_M2M_MPLANE) || !(caps & V4L2_CAP_STREAMING))
+        return false;
+
+    struct v4l2_fmtdesc desc = { .type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE };
+    for (desc.index = 0; xioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; desc.index++)
+        if (desc.pixelformat == i_pixfmt)
+        {
+            msg_Dbg(obj, "using %s (%s)", cap.card, cap.driver);
+            return true;
+        }
+    return false;
+}
+
+static int OpenDevice(vlc_object_t *obj, uint32_t i_pixfmt)
+{
+    char *psz_dev = var_InheritString(obj, "v4l2m2m-dev");
+    if (psz_dev != NULL)
+    {
+        int fd = vlc_open(psz_dev, O_RDWR | O_NONBLOCK);
+        if (fd == -1)
+            msg_Err(obj, "cannot open %s: %s", psz_dev, vlc_strerror_c(errno));
+        else if (!DeviceSupports(obj, fd, i_pixfmt))
+        {
+            vlc_close(fd);
+            fd = -1;
+        }
+        free(psz_dev);
+        return fd;
+    }
+
+    for (unsigned i = 0; i < DEVICES_MAX; i++)
+    {
+        char path[sizeof("/dev/video") + 3];
+        snprintf(path, sizeof (path), "/dev/video%u", i);
+
+        int fd = vlc_open(path, O_RDWR | O_NONBLOCK);
+        if (fd == -1)
+            continue;
+        if (DeviceSupports(obj, fd, i_pixfmt))
+            return fd;
+        vlc_close(fd);
+    }
+    return -1;
+}
+
+/*****************************************************************************
+ * Buffers
+ *****************************************************************************/
+static int MapBuffers(decoder_t *dec, enum v4l2_buf_type type,
+                      struct m2m_buffer *bufs, unsigned *pi_count,
+                      unsigned i_planes)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    struct v4l2_requestbuffers req = {
+        .count = *pi_count,
+        .type = type,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    if (xioctl(p_sys->fd, VIDIOC_REQBUFS, &req) || req.count == 0)
+    {
+        msg_Err(dec, "cannot allocate buffers: %s", vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+    if (req.count < *pi_count)
+        *pi_count = req.count;
+
+    for (unsigned i = 0; i < *pi_count; i++)
+    {
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+        struct v4l2_buffer buf = {
+            .type = type,
+            .memory = V4L2_MEMORY_MMAP,
+            .index = i,
+            .length = i_planes,
+            .m.planes = planes,
+        };
+        if (xioctl(p_sys->fd, VIDIOC_QUERYBUF, &buf))
+            return VLC_EGENERIC;
+
+        for (unsigned j = 0; j < i_planes; j++)
+        {
+            bufs[i].i_length[j] = planes[j].length;
+            bufs[i].p_map[j] = mmap(NULL, planes[j].length,
+                                    PROT_READ | PROT_WRITE, MAP_SHARED,
+                                    p_sys->fd, planes[j].m.mem_offset);
+            if (bufs[i].p_map[j] == MAP_FAILED)
+            {
+                bufs[i].p_map[j] = NULL;
+                msg_Err(dec, "cannot map buffer: %s", vlc_strerror_c(errno));
+                return VLC_EGENERIC;
+            }
+        }
+        bufs[i].b_queued = false;
+    }
+    return VLC_SUCCESS;
+}
+
+static void UnmapBuffers(decoder_t *dec, enum v4l2_buf_type type,
+                         struct m2m_buffer *bufs, unsigned *pi_count)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    for (unsigned i = 0; i < *pi_count; i++)
+        for (unsigned j = 0; j < VIDEO_MAX_PLANES; j++)
+            if (bufs[i].p_map[j] != NULL)
+            {
+                munmap(bufs[i].p_map[j], bufs[i].i_length[j]);
+                bufs[i].p_map[j] = NULL;
+            }
+    *pi_count = 0;
+
+    struct v4l2_requestbuffers req = {
+        .type = type,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    xioctl(p_sys->fd, VIDIOC_REQBUFS, &req);
+}
+
+static int QueueCapture(decoder_t *dec, unsigned i)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    struct v4l2_plane planes[VIDEO_MAX_PLANES] = { 0 };
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE,
+        .memory = V4L2_MEMORY_MMAP,
+        .index = i,
+        .length = p_sys->i_capture_planes,
+        .m.planes = planes,
+    };
+    if (xioctl(p_sys->fd, VIDIOC_QBUF, &buf))
+    {
+        msg_Err(dec, "cannot queue picture buffer: %s", vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+    p_sys->capture[i].b_queued = true;
+    return VLC_SUCCESS;
+}
+
+static void StopCapture(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    if (p_sys->b_capture_on)
+    {
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        xioctl(p_sys->fd, VIDIOC_STREAMOFF, &type);
+        p_sys->b_capture_on = false;
+    }
+    UnmapBuffers(dec, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, p_sys->capture,
+                 &p_sys->i_capture);
+}
+
+/* Sets up the decoded pictures queue, once the stream headers are parsed */
+static int StartCapture(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    StopCapture(dec);
+
+    struct v4l2_format fmt = { .type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE };
+    if (xioctl(p_sys->fd, VIDIOC_G_FMT, &fmt))
+        return VLC_EGENERIC;
+
+    if (fmt.fmt.pix_mp.pixelformat != V4L2_PIX_FMT_NV12
+     && fmt.fmt.pix_mp.pixelformat != V4L2_PIX_FMT_NV12M)
+    {
+        fmt.fmt.pix_mp.pixelformat = V4L2_PIX_FMT_NV12;
+        if (xioctl(p_sys->fd, VIDIOC_S_FMT, &fmt)
+         || (fmt.fmt.pix_mp.pixelformat != V4L2_PIX_FMT_NV12
+          && fmt.fmt.pix_mp.pixelformat != V4L2_PIX_FMT_NV12M))
+        {
+            msg_Err(dec, "no supported picture format");
+            return VLC_EGENERIC;
+        }
+    }
+    p_sys->capture_fmt = fmt.fmt.pix_mp;
+    p_sys->i_capture_planes = fmt.fmt.pix_mp.num_planes;
+
+    /* Visible area */
+    unsigned i_visible_width = fmt.fmt.pix_mp.width;
+    unsigned i_visible_height = fmt.fmt.pix_mp.height;
+    struct v4l2_selection sel = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .target = V4L2_SEL_TGT_COMPOSE,
+    };
+    if (xioctl(p_sys->fd, VIDIOC_G_SELECTION, &sel) == 0
+     && sel.r.width > 0 && sel.r.height > 0)
+    {
+        i_visible_width = sel.r.width;
+        i_visible_height = sel.r.height;
+    }
+
+    struct v4l2_control ctrl = { .id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE };
+    unsigned i_count = 4;
+    if (xioctl(p_sys->fd, VIDIOC_G_CTRL, &ctrl) == 0 && ctrl.value > 0)
+        i_count = ctrl.value + 2;
+    if (i_count > CAPTURE_MAX)
+        i_count = CAPTURE_MAX;
+
+    p_sys->i_capture = i_count;
+    if (MapBuffers(dec, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, p_sys->capture,
+                   &p_sys->i_capture, p_sys->i_capture_planes))
+        return VLC_EGENERIC;
+
+    for (unsigned i = 0; i < p_sys->i_capture; i++)
+        if (QueueCapture(dec, i))
+            return VLC_EGENERIC;
+
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    if (xioctl(p_sys->fd, VIDIOC_STREAMON, &type))
+        return VLC_EGENERIC;
+    p_sys->b_capture_on = true;
+
+    dec->fmt_out.i_codec = dec->fmt_out.video.i_chroma = VLC_CODEC_NV12;
+    dec->fmt_out.video.i_width = fmt.fmt.pix_mp.width;
+    dec->fmt_out.video.i_height = fmt.fmt.pix_mp.height;
+    dec->fmt_out.video.i_x_offset = 0;
+    dec->fmt_out.video.i_y_offset = 0;
+    dec->fmt_out.video.i_visible_width = i_visible_width;
+    dec->fmt_out.video.i_visible_height = i_visible_height;
+
+    msg_Dbg(dec, "decoding to %ux%u (%ux%u visible), %u buffers",
+            fmt.fmt.pix_mp.width, fmt.fmt.pix_mp.height,
+            i_visible_width, i_visible_height, p_sys->i_capture);
+
+    return decoder_UpdateVideoFormat(dec) ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Decoding
+ *****************************************************************************/
+static picture_t *CopyCapture(decoder_t *dec, const struct v4l2_buffer *buf)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    const struct v4l2_pix_format_mplane *fmt = &p_sys->capture_fmt;
+    const struct m2m_buffer *cbuf = &p_sys->capture[buf->index];
+
+    picture_t *pic = decoder_NewPicture(dec);
+    if (pic == NULL)
+        return NULL;
+
+    /* NV12 has both planes in one buffer, NV12M in two */
+    for (int i = 0; i < 2 && i < pic->i_planes; i++)
+    {
+        const unsigned i_pitch = fmt->plane_fmt[fmt->num_planes > 1 ? i : 0].bytesperline;
+        const unsigned i_lines = i ? (fmt->height + 1) / 2 : fmt->height;
+        const uint8_t *p_src = cbuf->p_map[fmt->num_planes > 1 ? i : 0];
+        if (i > 0 && fmt->num_planes == 1)
+            p_src += i_pitch * fmt->height;
+
+        plane_t src = {
+            .p_pixels = (uint8_t *) p_src,
+            .i_lines = i_lines,
+            .i_pitch = i_pitch,
+            .i_pixel_pitch = pic->p[i].i_pixel_pitch,
+            .i_visible_lines = i_lines,
+            .i_visible_pitch = i_pitch,
+        };
+        plane_CopyPixels(&pic->p[i], &src);
+    }
+
+    pic->date = vlc_tick_from_sec(buf->timestamp.tv_sec)
+              + VLC_TICK_FROM_US(buf->timestamp.tv_usec);
+    pic->b_progressive = true;
+    return pic;
+}
+
+static void HandleEvents(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    struct v4l2_event ev;
+
+    while (xioctl(p_sys->fd, VIDIOC_DQEVENT, &ev) == 0)
+    {
+        if (ev.type == V4L2_EVENT_SOURCE_CHANGE
+         && StartCapture(dec) != VLC_SUCCESS)
+            msg_Err(dec, "cannot set up decoded pictures");
+    }
+}
+
+/* Returns the pictures decoded so far, true if the last one was seen */
+static bool DequeueCapture(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    while (p_sys->b_capture_on)
+    {
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+        struct v4l2_buffer buf = {
+            .type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE,
+            .memory = V4L2_MEMORY_MMAP,
+            .length = p_sys->i_capture_planes,
+            .m.planes = planes,
+        };
+        if (xioctl(p_sys->fd, VIDIOC_DQBUF, &buf))
+            return errno == EPIPE;
+        p_sys->capture[buf.index].b_queued = false;
+
+        const bool b_last = (buf.flags & V4L2_BUF_FLAG_LAST) != 0;
+        if (planes[0].bytesused > 0 && !(buf.flags & V4L2_BUF_FLAG_ERROR))
+        {
+            picture_t *pic = CopyCapture(dec, &buf);
+            if (pic != NULL)
+                decoder_QueueVideo(dec, pic);
+        }
+
+        if (b_last)
+            return true;
+        QueueCapture(dec, buf.index);
+    }
+    return false;
+}
+
+static void DequeueOutput(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    for (;;)
+    {
+        struct v4l2_plane planes[1];
+        struct v4l2_buffer buf = {
+            .type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE,
+            .memory = V4L2_MEMORY_MMAP,
+            .length = 1,
+            .m.planes = planes,
+        };
+        if (xioctl(p_sys->fd, VIDIOC_DQBUF, &buf))
+            break;
+        p_sys->output[buf.index].b_queued = false;
+    }
+}
+
+static int FindFreeOutput(decoder_sys_t *p_sys)
+{
+    for (unsigned i = 0; i < p_sys->i_output; i++)
+        if (!p_sys->output[i].b_queued)
+            return i;
+    return -1;
+}
+
+/* Waits for room in the input queue, returning the decoded pictures and
+ * handling the events meanwhile */
+static int WaitOutput(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    int i_free;
+
+    for (;;)
+    {
+        DequeueOutput(dec);
+        HandleEvents(dec);
+        DequeueCapture(dec);
+
+        i_free = FindFreeOutput(p_sys);
+        if (i_free >= 0)
+            return i_free;
+
+        struct pollfd ufd = {
+            .fd = p_sys->fd,
+            .events = POLLIN | POLLOUT | POLLPRI,
+        };
+        if (poll(&ufd, 1, POLL_TIMEOUT) <= 0)
+        {
+            msg_Err(dec, "decoder is stuck");
+            return -1;
+        }
+    }
+}
+
+static int SendData(decoder_t *dec, const uint8_t *p_data, size_t i_data,
+                    vlc_tick_t i_date)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    int i = WaitOutput(dec);
+    if (i < 0)
+        return VLC_EGENERIC;
+
+    struct m2m_buffer *obuf = &p_sys->output[i];
+    if (i_data > obuf->i_length[0])
+    {
+        msg_Warn(dec, "truncating %zu bytes frame", i_data);
+        i_data = obuf->i_length[0];
+    }
+    memcpy(obuf->p_map[0], p_data, i_data);
+
+    struct v4l2_plane planes[1] = { { .bytesused = i_data } };
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE,
+        .memory = V4L2_MEMORY_MMAP,
+        .index = i,
+        .length = 1,
+        .m.planes = planes,
+    };
+    if (i_date != VLC_TICK_INVALID)
+    {
+        buf.timestamp.tv_sec = SEC_FROM_VLC_TICK(i_date);
+        buf.timestamp.tv_usec = US_FROM_VLC_TICK(i_date % CLOCK_FREQ);
+    }
+
+    if (xioctl(p_sys->fd, VIDIOC_QBUF, &buf))
+    {
+        msg_Err(dec, "cannot queue data: %s", vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+    obuf->b_queued = true;
+    return VLC_SUCCESS;
+}
+
+static void Drain(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    struct v4l2_decoder_cmd cmd = { .cmd = V4L2_DEC_CMD_STOP };
+    if (!p_sys->b_capture_on || xioctl(p_sys->fd, VIDIOC_DECODER_CMD, &cmd))
+        return;
+
+    for (;;)
+    {
+        HandleEvents(dec);
+        if (DequeueCapture(dec))
+            break;
+
+        struct pollfd ufd = { .fd = p_sys->fd, .events = POLLIN | POLLPRI };
+        if (poll(&ufd, 1, POLL_TIMEOUT) <= 0)
+            break;
+    }
+
+    /* Resume for the next stream */
+    cmd.cmd = V4L2_DEC_CMD_START;
+    xioctl(p_sys->fd, VIDIOC_DECODER_CMD, &cmd);
+    for (unsigned i = 0; i < p_sys->i_capture; i++)
+        if (!p_sys->capture[i].b_queued)
+            QueueCapture(dec, i);
+}
+
+static int Decode(decoder_t *dec, block_t *block)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    if (block == NULL)
+    {
+        Drain(dec);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (block->i_flags & BLOCK_FLAG_CORRUPTED)
+    {
+        block_Release(block);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (p_sys->b_hxxx)
+    {
+        block = p_sys->hh.pf_process_block(&p_sys->hh, block, NULL);
+        if (block == NULL)
+            return VLCDEC_SUCCESS;
+    }
+
+    if (p_sys->p_config != NULL)
+    {
+        block_t *config = p_sys->p_config;
+        p_sys->p_config = NULL;
+        int ret = SendData(dec, config->p_buffer, config->i_buffer,
+                           VLC_TICK_INVALID);
+        block_Release(config);
+        if (ret != VLC_SUCCESS)
+        {
+            block_Release(block);
+            return VLCDEC_ECRITICAL;
+        }
+    }
+
+    vlc_tick_t i_date = block->i_pts != VLC_TICK_INVALID ? block->i_pts
+                                                         : block->i_dts;
+    int ret = SendData(dec, block->p_buffer, block->i_buffer, i_date);
+    block_Release(block);
+    if (ret != VLC_SUCCESS)
+        return VLCDEC_ECRITICAL;
+
+    HandleEvents(dec);
+    DequeueCapture(dec);
+    return VLCDEC_SUCCESS;
+}
+
+static void Flush(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    /* Stopping a queue gives all its buffers back */
+    int type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    xioctl(p_sys->fd, VIDIOC_STREAMOFF, &type);
+    for (unsigned i = 0; i < p_sys->i_output; i++)
+        p_sys->output[i].b_queued = false;
+    xioctl(p_sys->fd, VIDIOC_STREAMON, &type);
+
+    if (p_sys->b_capture_on)
+    {
+        type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        xioctl(p_sys->fd, VIDIOC_STREAMOFF, &type);
+        for (unsigned i = 0; i < p_sys->i_capture; i++)
+        {
+            p_sys->capture[i].b_queued = false;
+            QueueCapture(dec, i);
+        }
+        xioctl(p_sys->fd, VIDIOC_STREAMON, &type);
+    }
+}
+
+/*****************************************************************************
+ * OpenDecoder: probe the decoder
+ *****************************************************************************/
+static int SetupHxxx(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    struct hxxx_helper *hh = &p_sys->hh;
+
+    /* The kernel wants AnnexB */
+    hxxx_helper_init(hh, VLC_OBJECT(dec), dec->fmt_in.i_codec, false);
+    p_sys->b_hxxx = true;
+
+    if (hxxx_helper_set_extra(hh, dec->fmt_in.p_extra, dec->fmt_in.i_extra))
+        return VLC_EGENERIC;
+
+    block_t *config = dec->fmt_in.i_codec == VLC_CODEC_H264
+                    ? h264_helper_get_annexb_config(hh)
+                    : hevc_helper_get_annexb_config(hh);
+    if (config != NULL)
+        p_sys->p_config = block_ChainGather(config);
+    return VLC_SUCCESS;
+}
+
+static int OpenDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+    uint32_t i_pixfmt = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(codecs); i++)
+        if (codecs[i].i_codec == dec->fmt_in.i_codec)
+            i_pixfmt = codecs[i].i_pixfmt;
+    if (i_pixfmt == 0)
+        return VLC_EGENERIC;
+
+    int fd = OpenDevice(obj, i_pixfmt);
+    if (fd == -1)
+        return VLC_EGENERIC;
+
+    decoder_sys_t *p_sys = calloc(1, sizeof(*p_sys));
+    if (unlikely(p_sys == NULL))
+    {
+        vlc_close(fd);
+        return VLC_ENOMEM;
+    }
+    p_sys->fd = fd;
+    dec->p_sys = p_sys;
+
+    if ((dec->fmt_in.i_codec == VLC_CODEC_H264
+      || dec->fmt_in.i_codec == VLC_CODEC_HEVC) && SetupHxxx(dec))
+        goto error;
+
+    struct v4l2_format fmt = {
+        .type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE,
+        .fmt.pix_mp = {
+            .width = dec->fmt_in.video.i_width,
+            .height = dec->fmt_in.video.i_height,
+            .pixelformat = i_pixfmt,
+            .num_planes = 1,
+            .plane_fmt[0].sizeimage = OUTPUT_SIZE,
+        },
+    };
+    if (xioctl(fd, VIDIOC_S_FMT, &fmt))
+    {
+        msg_Err(dec, "cannot set the coded format: %s", vlc_strerror_c(errno));
+        goto error;
+    }
+
+    p_sys->i_output = OUTPUT_BUFFERS;
+    if (MapBuffers(dec, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, p_sys->output,
+                   &p_sys->i_output, 1))
+        goto error;
+
+    struct v4l2_event_subscription sub = { .type = V4L2_EVENT_SOURCE_CHANGE };
+    if (xioctl(fd, VIDIOC_SUBSCRIBE_EVENT, &sub))
+    {
+        msg_Err(dec, "cannot subscribe to resolution changes");
+        goto error;
+    }
+
+    int type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type))
+        goto error;
+
+    dec->pf_decode = Decode;
+    dec->pf_flush = Flush;
+
+    dec->fmt_out.i_codec = VLC_CODEC_NV12;
+    dec->fmt_out.video.i_chroma = VLC_CODEC_NV12;
+    dec->fmt_out.video.i_width = dec->fmt_in.video.i_width;
+    dec->fmt_out.video.i_height = dec->fmt_in.video.i_height;
+    if (dec->fmt_in.video.i_sar_num > 0 && dec->fmt_in.video.i_sar_den > 0)
+    {
+        dec->fmt_out.video.i_sar_num = dec->fmt_in.video.i_sar_num;
+        dec->fmt_out.video.i_sar_den = dec->fmt_in.video.i_sar_den;
+    }
+    dec->fmt_out.video.primaries   = dec->fmt_in.video.primaries;
+    dec->fmt_out.video.transfer    = dec->fmt_in.video.transfer;
+    dec->fmt_out.video.space       = dec->fmt_in.video.space;
+    dec->fmt_out.video.color_range = dec->fmt_in.video.color_range;
+
+    return VLC_SUCCESS;
+
+error:
+    CloseDecoder(obj);
+    return VLC_EGENERIC;
+}
+
+/*****************************************************************************
+ * CloseDecoder: decoder destruction
+ *****************************************************************************/
+static void CloseDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    int type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    xioctl(p_sys->fd, VIDIOC_STREAMOFF, &type);
+    StopCapture(dec);
+    UnmapBuffers(dec, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, p_sys->output,
+                 &p_sys->i_output);
+
+    if (p_sys->p_config != NULL)
+        block_Release(p_sys->p_config);
+    if (p_sys->b_hxxx)
+        hxxx_helper_clean(&p_sys->hh);
+
+    vlc_close(p_sys->fd);
+    free(p_sys);
+}
@@ -33,7 +33,8 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_interface.h>
-#include <vlc_playlist_legacy.h>
+#include <vlc_player.h>
+#include <vlc_playlist.h>
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -45,6 +46,10 @@
 
 #define NETSYNC_PORT 9875
 
+/* Corrections smaller than this are not applied, to avoid chasing the
+ * round trip jitter */
+#define NETSYNC_TOLERANCE VLC_TICK_FROM_US(500)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -54,7 +59,8 @@ static void Close(vlc_object_t *);
 #define NETSYNC_TEXT N_("Network master clock")
 #define NETSYNC_LONGTEXT N_("When set, " \
   "this VLC instance will act as the master clock for synchronization " \
-  "for clients listening")
+  "for clients listening. Clients should play the same media, with the " \
+  "monotonic clock master.")
 
 #define MIP_TEXT N_("Master server IP address")
 #define MIP_LONGTEXT N_("The IP address of " \
@@ -88,15 +94,13 @@ struct intf_sys_t {
     int            fd;
     int            timeout;
     bool           is_master;
-    playlist_t     *playlist;
+    vlc_player_t   *player;
 
-    /* */
-    input_thread_t *input;
     vlc_thread_t   thread;
 };
 
-static int PlaylistEvent(vlc_object_t *, char const *cmd,
-                         vlc_value_t oldval, vlc_value_t newval, void *data);
+static void *Master(void *);
+static void *Slave(void *);
 
 /*****************************************************************************
  * Activate: initialize and create stuff
@@ -135,10 +139,14 @@ static int Open(vlc_object_t *object)
     sys->timeout = var_InheritInteger(intf, "netsync-timeout");
     if (sys->timeout < 500)
         sys->timeout = 500;
-    sys->playlist = pl_Get(intf);
-    sys->input = NULL;
+    sys->player = vlc_playlist_GetPlayer(vlc_intf_GetMainPlaylist(intf));
 
-    var_AddCallback(sys->playlist, "input-current", PlaylistEvent, intf);
+    if (vlc_clone(&sys->thread, sys->is_master ? Master : Slave, intf,
+                  VLC_THREAD_PRIORITY_INPUT)) {
+        net_Close(fd);
+        free(sys);
+        return VLC_EGENERIC;
+    }
     return VLC_SUCCESS;
 }
 
@@ -150,27 +158,22 @@ void Close(vlc_object_t *object)
     intf_thread_t *intf = (intf_thread_t*)object;
     intf_sys_t *sys = intf->p_sys;
 
-    var_DelCallback(sys->playlist, "input-current", PlaylistEvent, intf);
-
-    if (sys->input != NULL) {
-        vlc_cancel(sys->thread);
-        vlc_join(sys->thread, NULL);
-    }
+    vlc_cancel(sys->thread);
+    vlc_join(sys->thread, NULL);
 
     net_Close(sys->fd);
     free(sys);
 }
 
-static vlc_tick_t GetPcrSystem(input_thread_t *input)
+static int GetReference(intf_sys_t *sys, vlc_tick_t *system, vlc_tick_t *ts)
 {
     int canc = vlc_savecancel();
-    /* TODO use the delay */
-    vlc_tick_t system;
-    if (input_GetPcrSystem(input, &system, NULL))
-        system = -1;
+    vlc_player_Lock(sys->player);
+    int ret = vlc_player_GetClockReference(sys->player, system, ts);
+    vlc_player_Unlock(sys->player);
     vlc_restorecancel(canc);
 
-    return system;
+    return ret;
 }
 
 static void *Master(void *handle)
@@ -179,7 +182,7 @@ static void *Master(void *handle)
     intf_sys_t *sys = intf->p_sys;
     for (;;) {
         struct pollfd ufd = { .fd = sys->fd, .events = POLLIN, };
-        uint64_t data[2];
+        uint64_t data[3];
 
         if (poll(&ufd, 1, -1) < 0)
             continue;
@@ -192,25 +195,17 @@ static void *Master(void *handle)
                      (struct sockaddr *)&from, &fromlen) < 8)
             continue;
 
-        vlc_tick_t master_system = GetPcrSystem(sys->input);
-        if (master_system < 0)
+        vlc_tick_t master_system, master_ts;
+        if (GetReference(sys, &master_system, &master_ts))
             continue;
 
         data[0] = hton64(vlc_tick_now());
         data[1] = hton64(master_system);
+        data[2] = hton64(master_ts);
 
         /* Reply to the sender */
-        sendto(sys->fd, data, 16, 0,
+        sendto(sys->fd, data, 24, 0,
                (struct sockaddr *)&from, fromlen);
-#if 0
-        /* not sure we need the client information to sync,
-           since we are the master anyway */
-        vlc_tick_t client_system = ntoh64(data[0]);
-        msg_Dbg(intf, "Master clockref: %"PRId64" -> %"PRId64", from %s "
-                 "(date: %"PRId64")", client_system, master_system,
-                 (from.ss_family == AF_INET) ? inet_ntoa(((struct sockaddr_in *)&from)->sin_addr)
-                 : "non-IPv4", /*date*/ 0);
-#endif
     }
     return NULL;
 }
@@ -222,16 +217,12 @@ static void *Slave(void *handle)
 
     for (;;) {
         struct pollfd ufd = { .fd = sys->fd, .events = POLLIN, };
-        uint64_t data[2];
-
-        vlc_tick_t system = GetPcrSystem(sys->input);
-        if (system < 0)
-            goto wait;
+        uint64_t data[3];
 
         /* Send clock request to the master */
         const vlc_tick_t send_date = vlc_tick_now();
 
-        data[0] = hton64(system);
+        data[0] = hton64(send_date);
         send(sys->fd, data, 8, 0);
 
         /* Don't block */
@@ -239,61 +230,33 @@ static void *Slave(void *handle)
             continue;
 
         const vlc_tick_t receive_date = vlc_tick_now();
-        if (recv(sys->fd, data, 16, 0) < 16)
+        if (recv(sys->fd, data, 24, 0) < 24)
             goto wait;
 
         const vlc_tick_t master_date   = ntoh64(data[0]);
         const vlc_tick_t master_system = ntoh64(data[1]);
+        const vlc_tick_t master_ts     = ntoh64(data[2]);
+        /* Offset of our clock from the master one, assuming a symmetric
+         * round trip */
         const vlc_tick_t diff_date = receive_date -
                                   ((receive_date - send_date) / 2 + master_date);
+        const vlc_tick_t system = master_system + diff_date;
 
-        if (master_system > 0) {
-            int canc = vlc_savecancel();
-
-            vlc_tick_t client_system;
-            if (!input_GetPcrSystem(sys->input, &client_system, NULL)) {
-                const vlc_tick_t diff_system = client_system - master_system - diff_date;
-                if (diff_system != 0) {
-                    input_ModifyPcrSystem(sys->input, true, master_system - diff_date);
-#if 0
-                    msg_Dbg(intf, "Slave clockref: %"PRId64" -> %"PRId64" -> %"PRId64","
-                             " clock diff: %"PRId64", diff: %"PRId64"",
-                             system, master_system, client_system,
-                             diff_system, diff_date);
-#endif
-                }
-            }
-            vlc_restorecancel(canc);
-        }
-    wait:
-        vlc_tick_sleep(INTF_IDLE_SLEEP);
-    }
-    return NULL;
-}
-
-static int PlaylistEvent(vlc_object_t *object, char const *cmd,
-                         vlc_value_t oldval, vlc_value_t newval, void *data)
-{
-    VLC_UNUSED(cmd); VLC_UNUSED(object);
-    intf_thread_t  *intf = data;
-    intf_sys_t     *sys = intf->p_sys;
-    input_thread_t *input = newval.p_address;
-
-    if (sys->input != NULL) {
-        msg_Err(intf, "InputEvent DEAD");
-        assert(oldval.p_address == sys->input);
+        int canc = vlc_savecancel();
+        vlc_player_Lock(sys->player);
 
-        vlc_cancel(sys->thread);
-        vlc_join(sys->thread, NULL);
-    }
+        vlc_tick_t client_system, client_ts, diff_system = INT64_MAX;
+        if (vlc_player_GetClockReference(sys->player, &client_system,
+                                         &client_ts) == VLC_SUCCESS)
+            diff_system = client_system + (master_ts - client_ts) - system;
 
-    sys->input = input;
+        if (diff_system > NETSYNC_TOLERANCE || diff_system < -NETSYNC_TOLERANCE)
+            vlc_player_SetClockReference(sys->player, system, master_ts);
 
-    if (input != NULL) {
-        if (vlc_clone(&sys->thread, sys->is_master ? Master : Slave, intf,
-                      VLC_THREAD_PRIORITY_INPUT))
-            sys->input = NULL;
+        vlc_player_Unlock(sys->player);
+        vlc_restorecancel(canc);
+    wait:
+        vlc_tick_sleep(INTF_IDLE_SLEEP);
     }
-    return VLC_SUCCESS;
+    return NULL;
 }
-
@@ -1230,6 +1230,15 @@ static void Statistics(intf_thread_t *intf)
                   item->p_stats->i_lost_abuffers);
         msg_print(intf, "|");
 
+        /* Clock */
+        msg_print(intf, "%s", _("+-[Clock]"));
+        msg_print(intf, _("| drift            :  %7.1f ppm"),
+                  item->p_stats->f_clock_drift);
+        msg_print(intf, _("| jitter           :   %6.1f ms"),
+                  (float)item->p_stats->i_clock_jitter
+                      / (float)VLC_TICK_FROM_MS(1));
+        msg_print(intf, "|");
+
         vlc_mutex_unlock(&item->lock);
         msg_print(intf,  "+----[ end of statistical info ]" );
     }
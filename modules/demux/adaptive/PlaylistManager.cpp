@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/BufferBasedAdaptationLogic.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_stream.h>
 #include <vlc_demux.h>
@@ -154,6 +155,8 @@ bool PlaylistManager::init()
       )
         return false;
 
+    playlist->setLowLatency(var_InheritBool(p_demux, "adaptive-lowlatency"));
+
     if(!setupPeriod())
         return false;
 
@@ -599,7 +602,8 @@ int PlaylistManager::doControl(int i_query, va_list args)
         }
 
         case DEMUX_GET_PTS_DELAY:
-            *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
+            *va_arg (args, vlc_tick_t *) = playlist->isLowLatency() ? VLC_TICK_FROM_MS(300)
+                                                                    : VLC_TICK_FROM_SEC(1);
             break;
 
         default:
@@ -811,6 +815,15 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = noplogic;
             break;
         }
+        case AbstractAdaptationLogic::BufferBased:
+        {
+            BufferBasedAdaptationLogic *bufferlogic =
+                    new (std::nothrow) BufferBasedAdaptationLogic(obj);
+            if(bufferlogic)
+                conn->setDownloadRateObserver(bufferlogic);
+            logic = bufferlogic;
+            break;
+        }
         case AbstractAdaptationLogic::Predictive:
         {
             AbstractAdaptationLogic *predictivelogic =
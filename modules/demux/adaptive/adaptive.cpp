@@ -73,6 +73,27 @@ static void Close   (vlc_object_t *);
 
 #define ADAPT_LOGIC_TEXT N_("Adaptive Logic")
 
+#define ADAPT_DL_THREADS_TEXT N_("Concurrent segment downloads")
+#define ADAPT_DL_THREADS_LONGTEXT N_("Number of segments downloaded in parallel, " \
+                                     "each over its own connection")
+
+#define ADAPT_LOWLATENCY_TEXT N_("Low latency live")
+#define ADAPT_LOWLATENCY_LONGTEXT N_("Play live streams close to the live edge, " \
+                                     "with minimal buffering, for chunked low " \
+                                     "latency (CMAF) presentations")
+
+#define ADAPT_HTTP2_TEXT N_("Use HTTP/2 when available")
+#define ADAPT_HTTP2_LONGTEXT N_("Multiplex segment and playlist requests to a " \
+                                "same HTTPS server over a single HTTP/2 session")
+
+#define ADAPT_CACHE_TEXT N_("Shared segment cache size (MiB)")
+#define ADAPT_CACHE_LONGTEXT N_("Memory used to share downloaded segments between " \
+                                "all adaptive streams of the process. 0 disables it.")
+
+#define ADAPT_TELEMETRY_TEXT N_("Log adaptation decisions")
+#define ADAPT_TELEMETRY_LONGTEXT N_("Log buffer level, bitrate and measured " \
+                                    "throughput on each representation switch")
+
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
@@ -80,6 +101,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
                                 AbstractAdaptationLogic::NearOptimal,
+                                AbstractAdaptationLogic::BufferBased,
                                 AbstractAdaptationLogic::RateBased,
                                 AbstractAdaptationLogic::FixedRate,
                                 AbstractAdaptationLogic::AlwaysLowest,
@@ -89,6 +111,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "buffer",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -97,6 +120,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Buffer Based"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -122,6 +146,16 @@ vlc_module_begin ()
                      ADAPT_HEIGHT_TEXT, ADAPT_HEIGHT_TEXT, false )
         add_integer( "adaptive-bw",     250, ADAPT_BW_TEXT,     ADAPT_BW_LONGTEXT,     false )
         add_bool   ( "adaptive-use-access", false, ADAPT_ACCESS_TEXT, ADAPT_ACCESS_LONGTEXT, true );
+        add_bool   ( "adaptive-lowlatency", false, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT, true )
+        add_bool   ( "adaptive-http2", false, ADAPT_HTTP2_TEXT, ADAPT_HTTP2_LONGTEXT, true )
+        add_integer( "adaptive-download-threads", 2,
+                     ADAPT_DL_THREADS_TEXT, ADAPT_DL_THREADS_LONGTEXT, true )
+            change_integer_range( 1, 8 )
+        add_integer( "adaptive-cache-size", 0,
+                     ADAPT_CACHE_TEXT, ADAPT_CACHE_LONGTEXT, true )
+            change_integer_range( 0, 1024 )
+        add_bool   ( "adaptive-telemetry", false,
+                     ADAPT_TELEMETRY_TEXT, ADAPT_TELEMETRY_LONGTEXT, true )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -27,6 +27,7 @@
 #include "../SharedResources.hpp"
 
 #include <vlc_common.h>
+#include <vlc_block.h>
 
 #ifdef HAVE_GCRYPT
  #include <gcrypt.h>
@@ -142,3 +143,85 @@ size_t CommonEncryptionSession::decrypt(void *inputdata, size_t inputbytes, bool
 
     return inputbytes;
 }
+
+CommonEncryption::Method CommonEncryptionSession::getMethod() const
+{
+    return encryption.method;
+}
+
+CommonEncryptionFilter::CommonEncryptionFilter(CommonEncryptionSession *s)
+{
+    session = s;
+    pendingsize = 0;
+    closed = false;
+}
+
+CommonEncryptionFilter::~CommonEncryptionFilter()
+{
+    delete session;
+}
+
+block_t * CommonEncryptionFilter::process(block_t *p_block, bool b_last)
+{
+    if(closed)
+    {
+        if(p_block)
+            p_block->i_buffer = 0;
+        return p_block;
+    }
+
+    if(session->getMethod() != CommonEncryption::Method::AES_128)
+    {
+        /* not a chained cipher, no need to realign */
+        if(p_block)
+            p_block->i_buffer = session->decrypt(p_block->p_buffer,
+                                                 p_block->i_buffer, b_last);
+        return p_block;
+    }
+
+    /* prepend the cipher text held back from the previous chunk */
+    if(pendingsize)
+    {
+        if(p_block)
+            p_block = block_Realloc(p_block, pendingsize,
+                                    pendingsize + p_block->i_buffer);
+        else
+            p_block = block_Alloc(pendingsize);
+        if(!p_block)
+        {
+            pendingsize = 0;
+            return NULL;
+        }
+        memcpy(p_block->p_buffer, pending, pendingsize);
+        pendingsize = 0;
+    }
+
+    if(!p_block)
+    {
+        if(b_last)
+        {
+            session->close();
+            closed = true;
+        }
+        return NULL;
+    }
+
+    size_t total = p_block->i_buffer;
+    if(!b_last)
+    {
+        pendingsize = total % BLOCK_SIZE;
+        if(total - pendingsize >= BLOCK_SIZE)
+            pendingsize += BLOCK_SIZE;
+        memcpy(pending, &p_block->p_buffer[total - pendingsize], pendingsize);
+        total -= pendingsize;
+    }
+
+    p_block->i_buffer = total ? session->decrypt(p_block->p_buffer, total, b_last) : 0;
+
+    if(b_last)
+    {
+        session->close();
+        closed = true;
+    }
+    return p_block;
+}
@@ -20,6 +20,8 @@
 #ifndef COMMONENCRYPTION_H
 #define COMMONENCRYPTION_H
 
+#include "../http/Chunk.h"
+
 #include <vector>
 #include <string>
 
@@ -53,12 +55,32 @@ namespace adaptive
                 bool start(SharedResources *, const CommonEncryption &);
                 void close();
                 size_t decrypt(void *, size_t, bool);
+                CommonEncryption::Method getMethod() const;
 
             private:
                 std::vector<unsigned char> key;
                 CommonEncryption encryption;
                 void *ctx;
         };
+
+        /* Decrypts a segment as it is downloaded, whatever the size of the
+         * received chunks. Owns the session. */
+        class CommonEncryptionFilter : public http::ChunkFilter
+        {
+            public:
+                CommonEncryptionFilter(CommonEncryptionSession *);
+                virtual ~CommonEncryptionFilter();
+                virtual block_t * process(block_t *, bool); /* impl */
+
+            private:
+                static const size_t BLOCK_SIZE = 16;
+                CommonEncryptionSession *session;
+                /* trailing cipher text not decrypted yet: the partial block,
+                 * and the last complete one, which holds the padding */
+                unsigned char pending[2 * BLOCK_SIZE];
+                size_t pendingsize;
+                bool closed;
+        };
     }
 }
 
@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "HTTPConnectionManager.h"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -266,13 +267,10 @@ bool HTTPChunkSource::prepare()
         {
             if(requeststatus == RequestStatus::Redirection)
             {
-                HTTPConnection *httpconn = dynamic_cast<HTTPConnection *>(connection);
-                if(httpconn)
-                    connparams = httpconn->getRedirection();
+                connparams = connection->getRedirection();
                 connection->setUsed(false);
                 connection = NULL;
-                if(httpconn)
-                    continue;
+                continue;
             }
             break;
         }
@@ -304,6 +302,11 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     eof = false;
     held = false;
     downloadstart = 0;
+    p_cachehead = NULL;
+    pp_cachetail = &p_cachehead;
+    fromcache = false;
+    filter = NULL;
+    filtered = 0;
 }
 
 HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
@@ -323,8 +326,11 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
         pp_tail = &p_head;
     }
     buffered = 0;
+    if(p_cachehead)
+        block_ChainRelease(p_cachehead);
     vlc_mutex_unlock(&lock);
 
+    delete filter;
     vlc_cond_destroy(&avail);
 }
 
@@ -347,9 +353,84 @@ void HTTPChunkBufferedSource::release()
     vlc_cond_signal(&avail);
 }
 
+void HTTPChunkBufferedSource::setFilter(ChunkFilter *f)
+{
+    /* must be set before the download is scheduled */
+    delete filter;
+    filter = f;
+}
+
+block_t * HTTPChunkBufferedSource::filterBlock(block_t *p_block, bool b_last)
+{
+    if(!filter)
+        return p_block;
+
+    size_t insize = p_block ? p_block->i_buffer : 0;
+    p_block = filter->process(p_block, b_last);
+    size_t outsize = p_block ? p_block->i_buffer : 0;
+    filtered = filtered + insize - outsize;
+
+    if(p_block && p_block->i_buffer == 0)
+    {
+        /* empty blocks are reserved for the end of stream */
+        block_Release(p_block);
+        p_block = NULL;
+    }
+    return p_block;
+}
+
+bool HTTPChunkBufferedSource::prepareFromCache()
+{
+    SegmentCache *cache = connManager->getSegmentCache();
+    if(!cache)
+        return false;
+
+    block_t *p_block = cache->get(params.getUrl(), bytesRange, &cachedtype);
+    if(!p_block)
+        return false;
+
+    prepared = true;
+    fromcache = true;
+    done = true;
+    contentLength = p_block->i_buffer;
+    p_block = filterBlock(p_block, true);
+    if(p_block)
+    {
+        buffered += p_block->i_buffer;
+        block_ChainLastAppend(&pp_tail, p_block);
+    }
+    return true;
+}
+
+void HTTPChunkBufferedSource::storeToCache(bool b_complete)
+{
+    SegmentCache *cache = connManager->getSegmentCache();
+    if(cache && p_cachehead && b_complete &&
+       requeststatus == RequestStatus::Success)
+    {
+        size_t size;
+        block_ChainProperties(p_cachehead, NULL, &size, NULL);
+        /* never keep truncated segments */
+        if(!contentLength || size == contentLength)
+            cache->put(params.getUrl(), bytesRange,
+                       connection->getContentType(), p_cachehead);
+    }
+    if(p_cachehead)
+        block_ChainRelease(p_cachehead);
+    p_cachehead = NULL;
+    pp_cachetail = &p_cachehead;
+}
+
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     vlc_mutex_lock(&lock);
+    if(!prepared && prepareFromCache())
+    {
+        vlc_cond_signal(&avail);
+        vlc_mutex_unlock(&lock);
+        return;
+    }
+
     if(!prepare())
     {
         done = true;
@@ -384,25 +465,49 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     if(ret <= 0)
     {
         block_Release(p_block);
-        p_block = NULL;
+        /* flush what the filter held back */
+        p_block = filterBlock(NULL, true);
         vlc_mutex_locker locker( &lock );
+        if(p_block)
+        {
+            buffered += p_block->i_buffer;
+            block_ChainLastAppend(&pp_tail, p_block);
+        }
         done = true;
-        rate.size = buffered + consumed;
+        rate.size = buffered + consumed + filtered;
         rate.time = vlc_tick_now() - downloadstart;
         downloadstart = 0;
+        storeToCache(ret == 0);
     }
     else
     {
         p_block->i_buffer = (size_t) ret;
+        bool b_last = (size_t) ret < readsize;
+        if(contentLength)
+        {
+            vlc_mutex_locker locker( &lock );
+            b_last |= buffered + consumed + filtered + ret >= contentLength;
+        }
+        block_t *p_copy = NULL;
+        if(connManager->getSegmentCache())
+            p_copy = block_Duplicate(p_block);
+        /* filter on this thread, outside of the lock */
+        p_block = filterBlock(p_block, b_last);
         vlc_mutex_locker locker( &lock );
-        buffered += p_block->i_buffer;
-        block_ChainLastAppend(&pp_tail, p_block);
+        if(p_copy)
+            block_ChainLastAppend(&pp_cachetail, p_copy);
+        if(p_block)
+        {
+            buffered += p_block->i_buffer;
+            block_ChainLastAppend(&pp_tail, p_block);
+        }
         if((size_t) ret < readsize)
         {
             done = true;
-            rate.size = buffered + consumed;
+            rate.size = buffered + consumed + filtered;
             rate.time = vlc_tick_now() - downloadstart;
             downloadstart = 0;
+            storeToCache(true);
         }
     }
 
@@ -424,6 +529,16 @@ bool HTTPChunkBufferedSource::prepare()
     return true;
 }
 
+std::string HTTPChunkBufferedSource::getContentType() const
+{
+    {
+        vlc_mutex_locker locker( &lock );
+        if(fromcache)
+            return cachedtype;
+    }
+    return HTTPChunkSource::getContentType();
+}
+
 bool HTTPChunkBufferedSource::hasMoreData() const
 {
     vlc_mutex_locker locker( &lock );
@@ -42,6 +42,16 @@ namespace adaptive
         class AbstractConnectionManager;
         class AbstractChunk;
 
+        class ChunkFilter
+        {
+            public:
+                virtual ~ChunkFilter() {}
+                /* Transforms the downloaded data, in order. Data can be held
+                 * back until a later call, and must all be returned when
+                 * b_last is set. The input block can be NULL. */
+                virtual block_t *   process         (block_t *, bool b_last) = 0;
+        };
+
         class AbstractChunkSource
         {
             public:
@@ -109,10 +119,10 @@ namespace adaptive
                 bool                prepared;
                 bool                eof;
                 ID                  sourceid;
+                ConnectionParams    params;
 
             private:
                 bool init(const std::string &);
-                ConnectionParams    params;
         };
 
         class HTTPChunkBufferedSource : public HTTPChunkSource
@@ -126,13 +136,18 @@ namespace adaptive
                 virtual block_t *  readBlock       (); /* reimpl */
                 virtual block_t *  read            (size_t); /* reimpl */
                 virtual bool       hasMoreData     () const; /* impl */
+                virtual std::string getContentType () const; /* reimpl */
                 void               hold();
                 void               release();
+                void               setFilter(ChunkFilter *);
 
             protected:
                 virtual bool       prepare(); /* reimpl */
                 void               bufferize(size_t);
                 bool               isDone() const;
+                bool               prepareFromCache();
+                void               storeToCache(bool);
+                block_t *          filterBlock(block_t *, bool);
 
             private:
                 block_t            *p_head; /* read cache buffer */
@@ -143,6 +158,12 @@ namespace adaptive
                 vlc_tick_t          downloadstart;
                 vlc_cond_t          avail;
                 bool                held;
+                block_t            *p_cachehead; /* copy for the segment cache */
+                block_t           **pp_cachetail;
+                bool                fromcache;
+                std::string         cachedtype;
+                ChunkFilter        *filter; /* applied on the downloader thread */
+                size_t              filtered; /* bytes held back or dropped by the filter */
         };
 
         class HTTPChunk : public AbstractChunk
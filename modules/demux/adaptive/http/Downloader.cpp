@@ -29,37 +29,41 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&waitcond);
+    vlc_cond_init(&updatedcond);
     killed = false;
-    thread_handle_valid = false;
+    maxthreads = workers ? workers : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(threads.size() < maxthreads)
     {
-        return false;
+        vlc_thread_t thread_handle;
+        if(vlc_clone(&thread_handle, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        threads.push_back(thread_handle);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     vlc_mutex_lock( &lock );
     killed = true;
-    vlc_cond_signal(&waitcond);
+    vlc_cond_broadcast(&waitcond);
     vlc_mutex_unlock( &lock );
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, NULL);
+    std::vector<vlc_thread_t>::iterator it;
+    for(it = threads.begin(); it != threads.end(); ++it)
+        vlc_join(*it, NULL);
     vlc_mutex_destroy(&lock);
     vlc_cond_destroy(&waitcond);
+    vlc_cond_destroy(&updatedcond);
 }
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
@@ -73,6 +77,9 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
+    /* wait for the worker to finish its current read on it */
+    while(isDownloading(source))
+        vlc_cond_wait(&updatedcond, &lock);
     source->release();
     chunks.remove(source);
     vlc_mutex_unlock(&lock);
@@ -93,27 +100,50 @@ void Downloader::DownloadSource(HTTPChunkBufferedSource *source)
         source->bufferize(HTTPChunkSource::CHUNK_SIZE);
 }
 
+bool Downloader::isDownloading(HTTPChunkBufferedSource *source) const
+{
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = downloading.begin(); it != downloading.end(); ++it)
+        if(*it == source)
+            return true;
+    return false;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    /* Oldest scheduled first, so each stream's segments start in order */
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+        if(!isDownloading(*it))
+            return *it;
+    return NULL;
+}
+
 void Downloader::Run()
 {
     vlc_mutex_lock(&lock);
     while(1)
     {
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source;
+        while(!(source = getNextSource()) && !killed)
             vlc_cond_wait(&waitcond, &lock);
 
         if(killed)
             break;
 
-        if(!chunks.empty())
+        downloading.push_back(source);
+        vlc_mutex_unlock(&lock);
+
+        DownloadSource(source);
+
+        vlc_mutex_lock(&lock);
+        downloading.remove(source);
+        if(source->isDone())
         {
-            HTTPChunkBufferedSource *source = chunks.front();
-            DownloadSource(source);
-            if(source->isDone())
-            {
-                chunks.pop_front();
-                source->release();
-            }
+            chunks.remove(source);
+            source->release();
         }
+        vlc_cond_broadcast(&updatedcond);
     }
     vlc_mutex_unlock(&lock);
 }
@@ -24,6 +24,7 @@
 
 #include <vlc_common.h>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -34,7 +35,7 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
@@ -44,12 +45,16 @@ namespace adaptive
                 static void * downloaderThread(void *);
                 void Run();
                 void DownloadSource(HTTPChunkBufferedSource *);
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextSource() const;
+                bool isDownloading(HTTPChunkBufferedSource *) const;
+                std::vector<vlc_thread_t> threads;
+                unsigned     maxthreads;
                 vlc_mutex_t  lock;
                 vlc_cond_t   waitcond;
-                bool         thread_handle_valid;
+                vlc_cond_t   updatedcond;
                 bool         killed;
                 std::list<HTTPChunkBufferedSource *> chunks;
+                std::list<HTTPChunkBufferedSource *> downloading;
         };
 
     }
@@ -31,6 +31,14 @@
 #include <sstream>
 #include <vlc_stream.h>
 
+extern "C"
+{
+    #include "../../../access/http/message.h"
+    #include "../../../access/http/resource.h"
+    #include "../../../access/http/file.h"
+    #include "../../../access/http/connmgr.h"
+}
+
 using namespace adaptive::http;
 
 AbstractConnection::AbstractConnection(vlc_object_t *p_object_)
@@ -55,6 +63,11 @@ bool AbstractConnection::prepare(const ConnectionParams &params_)
     return true;
 }
 
+const ConnectionParams & AbstractConnection::getRedirection() const
+{
+    return locationparams;
+}
+
 size_t AbstractConnection::getContentLength() const
 {
     return contentLength;
@@ -458,10 +471,6 @@ std::string HTTPConnection::extraRequestHeaders() const
     return ss.str();
 }
 
-const ConnectionParams & HTTPConnection::getRedirection() const
-{
-    return locationparams;
-}
 
 StreamUrlConnection::StreamUrlConnection(vlc_object_t *p_object)
     : AbstractConnection(p_object)
@@ -574,6 +583,249 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           struct vlc_http_mgr *mgr, vlc_mutex_t *mgrlock)
+    : AbstractConnection(p_object_)
+{
+    http_mgr = mgr;
+    http_lock = mgrlock;
+    resource = NULL;
+    p_pending = NULL;
+    char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
+    if(psz_useragent)
+        useragent = std::string(psz_useragent);
+    free(psz_useragent);
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_pending)
+        block_Release(p_pending);
+    p_pending = NULL;
+    if(resource)
+    {
+        vlc_mutex_locker locker(http_lock);
+        vlc_http_file_destroy(resource);
+    }
+    resource = NULL;
+    bytesRead = 0;
+    contentLength = 0;
+    contentType = std::string();
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    return available && !params_.usesAccess() &&
+           params.getScheme() == params_.getScheme() &&
+           params.getHostname() == params_.getHostname() &&
+           params.getPort() == params_.getPort();
+}
+
+enum RequestStatus
+    LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+    locationparams = ConnectionParams();
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    vlc_mutex_locker locker(http_lock);
+
+    resource = vlc_http_file_create(http_mgr, params.getUrl().c_str(),
+                                    useragent.empty() ? NULL : useragent.c_str(),
+                                    NULL);
+    if(!resource)
+        return RequestStatus::GenericError;
+
+    /* Range end can't be requested, reading just stops there */
+    if(range.isValid() && range.getStartByte() > 0 &&
+       vlc_http_file_seek(resource, range.getStartByte()))
+        return RequestStatus::GenericError;
+
+    int status = vlc_http_file_get_status(resource);
+    if(status < 0)
+        return RequestStatus::GenericError;
+
+    if(status / 100 == 3)
+    {
+        char *psz_redirect = vlc_http_file_get_redirect(resource);
+        if(!psz_redirect)
+            return RequestStatus::GenericError;
+        locationparams = ConnectionParams(psz_redirect);
+        free(psz_redirect);
+        return RequestStatus::Redirection;
+    }
+    else if(status == 401 || status == 407)
+        return RequestStatus::Unauthorized;
+    else if(status == 404)
+        return RequestStatus::NotFound;
+    else if(status / 100 != 2)
+        return RequestStatus::GenericError;
+
+    char *psz_type = vlc_http_file_get_type(resource);
+    if(psz_type)
+    {
+        contentType = std::string(psz_type);
+        free(psz_type);
+    }
+
+    bytesRange = range;
+    if(range.isValid() && range.getEndByte() > 0)
+    {
+        contentLength = range.getEndByte() - range.getStartByte() + 1;
+    }
+    else
+    {
+        uintmax_t size = vlc_http_file_get_size(resource);
+        if(size != UINTMAX_MAX)
+        {
+            const size_t start = range.isValid() ? range.getStartByte() : 0;
+            contentLength = (size > start) ? size - start : 0;
+        }
+    }
+
+    return RequestStatus::Success;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if( !resource )
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    uint8_t *p_dst = static_cast<uint8_t *>(p_buffer);
+    size_t copied = 0;
+    bool b_error = false;
+    while(copied < len)
+    {
+        if(!p_pending)
+        {
+            /* Response is already open, so reading does not go through
+             * the shared manager and can run without its lock */
+            block_t *p_block = vlc_http_res_read(resource);
+            if(p_block == vlc_http_error)
+                b_error = true;
+            if(p_block == NULL || p_block == vlc_http_error)
+                break;
+            p_pending = p_block;
+        }
+
+        size_t i_copy = __MIN(len - copied, p_pending->i_buffer);
+        memcpy(&p_dst[copied], p_pending->p_buffer, i_copy);
+        copied += i_copy;
+        p_pending->p_buffer += i_copy;
+        p_pending->i_buffer -= i_copy;
+        if(p_pending->i_buffer == 0)
+        {
+            block_Release(p_pending);
+            p_pending = NULL;
+        }
+    }
+
+    bytesRead += copied;
+
+    if(b_error && copied == 0)
+    {
+        reset();
+        return VLC_EGENERIC;
+    }
+
+    if(copied < len || contentLength == bytesRead) /* set EOF */
+        reset();
+
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    if(available)
+        reset();
+}
+
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory()
+    : AbstractConnectionFactory()
+{
+    vlc_mutex_init(&lock);
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    std::map<std::string, Origin *>::iterator it;
+    for(it = origins.begin(); it != origins.end(); ++it)
+    {
+        Origin *origin = (*it).second;
+        vlc_http_mgr_destroy(origin->mgr);
+        vlc_mutex_destroy(&origin->lock);
+        delete origin;
+    }
+    vlc_mutex_destroy(&lock);
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    /* HTTP/2 is only negotiated over TLS */
+    if(params.getScheme() != "https" || params.getHostname().empty())
+        return NULL;
+
+    std::stringstream ss;
+    ss.imbue(std::locale("C"));
+    ss << params.getHostname() << ":" << params.getPort();
+
+    Origin *origin = NULL;
+    vlc_mutex_lock(&lock);
+    std::map<std::string, Origin *>::iterator it = origins.find(ss.str());
+    if(it != origins.end())
+    {
+        origin = (*it).second;
+    }
+    else
+    {
+        struct vlc_http_cookie_jar_t *jar = NULL;
+        if(var_InheritBool(p_object, "http-forward-cookies"))
+            jar = static_cast<struct vlc_http_cookie_jar_t *>
+                    (var_InheritAddress(p_object, "http-cookies"));
+        struct vlc_http_mgr *mgr = vlc_http_mgr_create(p_object, jar);
+        if(mgr)
+        {
+            origin = new (std::nothrow) Origin;
+            if(origin)
+            {
+                origin->mgr = mgr;
+                vlc_mutex_init(&origin->lock);
+                origins.insert(std::pair<std::string, Origin *>(ss.str(), origin));
+            }
+            else vlc_http_mgr_destroy(mgr);
+        }
+    }
+    vlc_mutex_unlock(&lock);
+
+    if(!origin)
+        return NULL;
+
+    return new (std::nothrow) LibVLCHTTPConnection(p_object, origin->mgr, &origin->lock);
+}
+
 NativeConnectionFactory::NativeConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
@@ -635,12 +887,14 @@ ConnectionFactory::ConnectionFactory( AuthStorage *authstorage )
 {
     native = new NativeConnectionFactory( authstorage );
     streamurl = new StreamUrlConnectionFactory();
+    libvlchttp = new LibVLCHTTPConnectionFactory();
 }
 
 ConnectionFactory::~ConnectionFactory()
 {
     delete native;
     delete streamurl;
+    delete libvlchttp;
 }
 
 AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
@@ -649,6 +903,12 @@ AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
     bool b_streamurl = var_InheritBool(p_object, "adaptive-use-access");
     if(!b_streamurl && !params.usesAccess())
     {
+        if(params.getScheme() == "https" && var_InheritBool(p_object, "adaptive-http2"))
+        {
+            AbstractConnection *conn = libvlchttp->createConnection(p_object, params);
+            if(conn)
+                return conn;
+        }
         return native->createConnection(p_object, params);
     }
     else
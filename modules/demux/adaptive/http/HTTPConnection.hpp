@@ -29,6 +29,10 @@
 #include "BytesRange.hpp"
 #include <vlc_common.h>
 #include <string>
+#include <map>
+
+struct vlc_http_mgr;
+struct vlc_http_resource;
 
 namespace adaptive
 {
@@ -53,10 +57,12 @@ namespace adaptive
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
                 virtual void    setUsed( bool ) = 0;
+                const ConnectionParams &getRedirection() const;
 
             protected:
                 vlc_object_t      *p_object;
                 ConnectionParams   params;
+                ConnectionParams   locationparams;
                 bool               available;
                 size_t             contentLength;
                 std::string        contentType;
@@ -77,7 +83,6 @@ namespace adaptive
                 virtual ssize_t read        (void *p_buffer, size_t len);
 
                 void setUsed( bool );
-                const ConnectionParams &getRedirection() const;
                 static const unsigned MAX_REDIRECTS = 3;
 
             protected:
@@ -98,7 +103,6 @@ namespace adaptive
                 std::string useragent;
 
                 AuthStorage        *authStorage;
-                ConnectionParams    locationparams;
                 ConnectionParams    proxyparams;
                 bool                connectionClose;
                 bool                chunked;
@@ -131,6 +135,31 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* Uses the vlc_http stack from the https access, which negotiates
+        * HTTP/2 and multiplexes concurrent requests over a single session */
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, struct vlc_http_mgr *, vlc_mutex_t *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual enum RequestStatus
+                                request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                struct vlc_http_mgr      *http_mgr;
+                vlc_mutex_t              *http_lock; /* serializes manager use */
+                struct vlc_http_resource *resource;
+                block_t                  *p_pending;
+                std::string               useragent;
+       };
+
        class AbstractConnectionFactory
        {
            public:
@@ -157,6 +186,23 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
        };
 
+       class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory();
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
+           private:
+               /* a vlc_http manager holds a single connection, so keep one per origin */
+               struct Origin
+               {
+                   struct vlc_http_mgr *mgr;
+                   vlc_mutex_t lock;
+               };
+               std::map<std::string, Origin *> origins;
+               vlc_mutex_t lock;
+       };
+
        class ConnectionFactory : public AbstractConnectionFactory
        {
            public:
@@ -166,6 +212,7 @@ namespace adaptive
            private:
                NativeConnectionFactory *native;
                StreamUrlConnectionFactory *streamurl;
+               LibVLCHTTPConnectionFactory *libvlchttp;
        };
     }
 }
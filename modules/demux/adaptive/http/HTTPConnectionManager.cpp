@@ -30,6 +30,7 @@
 #include "ConnectionParams.hpp"
 #include "Transport.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
 
@@ -40,19 +41,27 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = NULL;
+    vlc_mutex_init(&ratelock);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    vlc_mutex_destroy(&ratelock);
 }
 
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size, vlc_tick_t time)
 {
+    /* Reported from concurrent download workers */
+    vlc_mutex_locker locker(&ratelock);
     if(rateObserver)
         rateObserver->updateDownloadRate(sourceid, size, time);
 }
 
+SegmentCache * AbstractConnectionManager::getSegmentCache() const
+{
+    return NULL;
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
@@ -63,14 +72,20 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AuthSt
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
+    unsigned workers = var_InheritInteger(p_object, "adaptive-download-threads");
+    downloader = new (std::nothrow) Downloader(workers);
     downloader->start();
     factory = new ConnectionFactory(storage);
+    /* shared with all other adaptive instances of the process */
+    int64_t cachesize = var_InheritInteger(p_object, "adaptive-cache-size");
+    cache = SegmentCache::acquire(cachesize > 0 ? (size_t)cachesize << 20 : 0);
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
+    if(cache)
+        cache->release();
     delete factory;
     this->closeAllConnections();
     vlc_mutex_destroy(&lock);
@@ -146,3 +161,8 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
     if(src)
         downloader->cancel(src);
 }
+
+SegmentCache * HTTPConnectionManager::getSegmentCache() const
+{
+    return cache;
+}
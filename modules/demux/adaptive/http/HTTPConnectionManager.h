@@ -42,6 +42,7 @@ namespace adaptive
         class AuthStorage;
         class Downloader;
         class AbstractChunkSource;
+        class SegmentCache;
 
         class AbstractConnectionManager : public IDownloadRateObserver
         {
@@ -52,6 +53,7 @@ namespace adaptive
                 virtual AbstractConnection * getConnection(ConnectionParams &) = 0;
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
+                virtual SegmentCache * getSegmentCache() const;
 
                 virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t); /* impl */
                 void setDownloadRateObserver(IDownloadRateObserver *);
@@ -61,6 +63,7 @@ namespace adaptive
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                vlc_mutex_t                                         ratelock;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
@@ -74,10 +77,12 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *) /* impl */;
                 virtual void cancel(AbstractChunkSource *) /* impl */;
+                virtual SegmentCache * getSegmentCache() const /* reimpl */;
 
             private:
                 void    releaseAllConnections ();
                 Downloader                                         *downloader;
+                SegmentCache                                       *cache;
                 vlc_mutex_t                                         lock;
                 std::vector<AbstractConnection *>                   connectionPool;
                 AbstractConnectionFactory                          *factory;
@@ -0,0 +1,172 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2015 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+
+#include <vlc_block.h>
+
+#include <sstream>
+
+using namespace adaptive::http;
+
+static vlc_mutex_t instance_lock = VLC_STATIC_MUTEX;
+static SegmentCache *instance = NULL;
+
+SegmentCache::Entry::Entry(const std::string &key_, block_t *data_,
+                           const std::string &type)
+{
+    key = key_;
+    data = data_;
+    contentType = type;
+}
+
+SegmentCache::Entry::~Entry()
+{
+    block_Release(data);
+}
+
+SegmentCache::SegmentCache()
+{
+    maxsize = 0;
+    cursize = 0;
+    refs = 0;
+    vlc_mutex_init(&lock);
+}
+
+SegmentCache::~SegmentCache()
+{
+    vlc_delete_all(lru);
+    vlc_mutex_destroy(&lock);
+}
+
+SegmentCache * SegmentCache::acquire(size_t size)
+{
+    if(size == 0)
+        return NULL;
+
+    vlc_mutex_lock(&instance_lock);
+    if(!instance)
+        instance = new (std::nothrow) SegmentCache();
+    if(instance)
+    {
+        instance->refs++;
+        vlc_mutex_lock(&instance->lock);
+        /* largest request wins, as instances can be configured differently */
+        if(size > instance->maxsize)
+            instance->maxsize = size;
+        vlc_mutex_unlock(&instance->lock);
+    }
+    SegmentCache *ret = instance;
+    vlc_mutex_unlock(&instance_lock);
+    return ret;
+}
+
+void SegmentCache::release()
+{
+    vlc_mutex_lock(&instance_lock);
+    if(--refs == 0)
+    {
+        instance = NULL;
+        delete this;
+    }
+    vlc_mutex_unlock(&instance_lock);
+}
+
+std::string SegmentCache::makeKey(const std::string &url, const BytesRange &range)
+{
+    if(!range.isValid())
+        return url;
+    std::stringstream ss;
+    ss << url << '@' << range.getStartByte() << '-' << range.getEndByte();
+    return ss.str();
+}
+
+block_t * SegmentCache::get(const std::string &url, const BytesRange &range,
+                            std::string *type)
+{
+    const std::string key = makeKey(url, range);
+
+    vlc_mutex_locker locker(&lock);
+    std::map<std::string, EntryList::iterator>::iterator it = index.find(key);
+    if(it == index.end())
+        return NULL;
+
+    /* move to front */
+    lru.splice(lru.begin(), lru, it->second);
+    const Entry *entry = *it->second;
+    if(type)
+        *type = entry->contentType;
+    return block_Duplicate(entry->data);
+}
+
+void SegmentCache::put(const std::string &url, const BytesRange &range,
+                       const std::string &type, const block_t *p_chain)
+{
+    size_t size;
+    block_ChainProperties(const_cast<block_t *>(p_chain), NULL, &size, NULL);
+    if(size == 0)
+        return;
+
+    vlc_mutex_locker locker(&lock);
+    /* don't let a single entry flush most of the cache */
+    if(size > maxsize / 4)
+        return;
+
+    const std::string key = makeKey(url, range);
+    if(index.find(key) != index.end())
+        return;
+
+    block_t *data = block_Alloc(size);
+    if(!data)
+        return;
+    size_t offset = 0;
+    for(const block_t *b = p_chain; b; b = b->p_next)
+    {
+        memcpy(&data->p_buffer[offset], b->p_buffer, b->i_buffer);
+        offset += b->i_buffer;
+    }
+
+    Entry *entry = new (std::nothrow) Entry(key, data, type);
+    if(!entry)
+    {
+        block_Release(data);
+        return;
+    }
+
+    evict(size);
+    lru.push_front(entry);
+    index[key] = lru.begin();
+    cursize += size;
+}
+
+void SegmentCache::evict(size_t needed)
+{
+    while(!lru.empty() && cursize + needed > maxsize)
+    {
+        Entry *entry = lru.back();
+        cursize -= entry->data->i_buffer;
+        index.erase(entry->key);
+        lru.pop_back();
+        delete entry;
+    }
+}
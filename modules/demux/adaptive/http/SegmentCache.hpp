@@ -0,0 +1,75 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2015 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "BytesRange.hpp"
+
+#include <vlc_common.h>
+#include <list>
+#include <map>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Process wide cache of downloaded segments, shared by all
+         * adaptive demuxers so that identical requests are only
+         * fetched once. Entries are evicted in LRU order. */
+        class SegmentCache
+        {
+            public:
+                static SegmentCache * acquire(size_t);
+                void release();
+
+                block_t * get(const std::string &, const BytesRange &,
+                              std::string *);
+                void put(const std::string &, const BytesRange &,
+                         const std::string &, const block_t *);
+
+            private:
+                SegmentCache();
+                ~SegmentCache();
+                static std::string makeKey(const std::string &, const BytesRange &);
+                void evict(size_t);
+
+                class Entry
+                {
+                    public:
+                        Entry(const std::string &, block_t *, const std::string &);
+                        ~Entry();
+                        std::string key;
+                        block_t *data;
+                        std::string contentType;
+                };
+
+                typedef std::list<Entry *> EntryList;
+                EntryList lru; /* most recently used first */
+                std::map<std::string, EntryList::iterator> index;
+                size_t maxsize;
+                size_t cursize;
+                unsigned refs;
+                vlc_mutex_t lock;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
@@ -26,6 +26,8 @@
 #endif
 
 #include "AbstractAdaptationLogic.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../ID.hpp"
 
 #include <limits>
 
@@ -36,6 +38,7 @@ AbstractAdaptationLogic::AbstractAdaptationLogic    (vlc_object_t *obj)
     p_obj = obj;
     maxwidth = std::numeric_limits<int>::max();
     maxheight = std::numeric_limits<int>::max();
+    b_telemetry = var_InheritBool(obj, "adaptive-telemetry");
 }
 
 AbstractAdaptationLogic::~AbstractAdaptationLogic   ()
@@ -51,3 +54,18 @@ void AbstractAdaptationLogic::setMaxDeviceResolution (int w, int h)
     maxwidth = (w > 0) ? w : std::numeric_limits<int>::max();
     maxheight = (h > 0) ? h : std::numeric_limits<int>::max();
 }
+
+void AbstractAdaptationLogic::reportSwitch(const adaptive::ID &id,
+                                           const BaseRepresentation *prev,
+                                           const BaseRepresentation *next,
+                                           vlc_tick_t buffering, unsigned bps) const
+{
+    if(!b_telemetry || !next || prev == next)
+        return;
+
+    /* Single line key=value records, easy to grep out of the log */
+    msg_Info(p_obj, "adaptive telemetry: stream=%s buffer_ms=%" PRId64
+             " from_bps=%" PRIu64 " to_bps=%" PRIu64 " throughput_bps=%u",
+             id.str().c_str(), MS_FROM_VLC_TICK(buffering),
+             prev ? prev->getBandwidth() : 0, next->getBandwidth(), bps);
+}
@@ -61,12 +61,18 @@ namespace adaptive
                     FixedRate,
                     Predictive,
                     NearOptimal,
+                    BufferBased,
                 };
 
             protected:
+                void                        reportSwitch(const ID &,
+                                                         const BaseRepresentation *,
+                                                         const BaseRepresentation *,
+                                                         vlc_tick_t, unsigned) const;
                 vlc_object_t *p_obj;
                 int maxwidth;
                 int maxheight;
+                bool b_telemetry;
         };
     }
 }
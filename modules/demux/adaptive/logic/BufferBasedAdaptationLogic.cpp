@@ -0,0 +1,203 @@
+/*
+ * BufferBasedAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2019 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BufferBasedAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+
+#include <algorithm>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Buffer based approach (BBA-0), rate only depends on buffer occupancy
+ * A Buffer-Based Approach to Rate Adaptation, Huang et al., SIGCOMM 2014
+ *
+ *  rate
+ *   ^        reservoir   cushion      upper reservoir
+ *   | Rmax  ..........|..........____|______
+ *   |                 |     ____/    |
+ *   | Rmin  __________|____/         |
+ *   +-----------------+--------------+------> buffer level
+ */
+
+#define reservoirRatio  0.10f
+#define cushionRatio    0.90f
+
+BufferBasedContext::BufferBasedContext()
+    : buffering_min( 0 )
+    , buffering_level( 0 )
+    , buffering_target( 0 )
+    , last_download_rate( 0 )
+{ }
+
+BufferBasedAdaptationLogic::BufferBasedAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+{
+    vlc_mutex_init(&lock);
+}
+
+BufferBasedAdaptationLogic::~BufferBasedAdaptationLogic()
+{
+    vlc_mutex_destroy(&lock);
+}
+
+uint64_t BufferBasedAdaptationLogic::getRateFromBuffer(const BufferBasedContext &ctx,
+                                                       uint64_t rmin, uint64_t rmax) const
+{
+    if(ctx.buffering_target <= 0)
+        return rmin;
+
+    const vlc_tick_t reservoir = std::max(ctx.buffering_min,
+                                          (vlc_tick_t)(ctx.buffering_target * reservoirRatio));
+    const vlc_tick_t cushion = ctx.buffering_target * cushionRatio;
+
+    if(ctx.buffering_level <= reservoir || cushion <= reservoir)
+        return rmin;
+    if(ctx.buffering_level >= cushion)
+        return rmax;
+
+    return rmin + (rmax - rmin) * (ctx.buffering_level - reservoir) / (cushion - reservoir);
+}
+
+BaseRepresentation *BufferBasedAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(!lowest || !highest)
+        return NULL;
+
+    vlc_mutex_lock(&lock);
+    std::map<ID, BufferBasedContext>::const_iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        return lowest;
+    }
+    const BufferBasedContext ctx = (*it).second;
+    vlc_mutex_unlock(&lock);
+
+    BaseRepresentation *rep;
+    if(prevRep == NULL)
+    {
+        /* No buffer yet, only throughput can tell */
+        rep = ctx.last_download_rate ? selector.select(adaptSet, ctx.last_download_rate)
+                                     : lowest;
+    }
+    else
+    {
+        const uint64_t rate = getRateFromBuffer(ctx, lowest->getBandwidth(),
+                                                highest->getBandwidth());
+        BaseRepresentation *up = selector.higher(adaptSet, prevRep);
+        BaseRepresentation *down = selector.lower(adaptSet, prevRep);
+
+        /* Only move on crossing neighbours bitrates, which
+         * avoids oscillating around a representation boundary */
+        if(up && up != prevRep && rate >= up->getBandwidth())
+        {
+            rep = selector.select(adaptSet, rate + 1);
+        }
+        else if(down && down != prevRep && rate <= down->getBandwidth())
+        {
+            rep = selector.select(adaptSet, rate);
+            if(rep->getBandwidth() < rate)
+            {
+                BaseRepresentation *next = selector.higher(adaptSet, rep);
+                if(next && next->getBandwidth() < prevRep->getBandwidth())
+                    rep = next;
+            }
+        }
+        else rep = prevRep;
+    }
+
+    reportSwitch(adaptSet->getID(), prevRep, rep, ctx.buffering_level,
+                 ctx.last_download_rate);
+
+    return rep;
+}
+
+void BufferBasedAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time)
+{
+    if(unlikely(time == 0))
+        return;
+
+    vlc_mutex_lock(&lock);
+    std::map<ID, BufferBasedContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        BufferBasedContext &ctx = (*it).second;
+        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 / time);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void BufferBasedAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
+{
+    switch(event.type)
+    {
+    case SegmentTrackerEvent::BUFFERING_STATE:
+        {
+            const ID &id = *event.u.buffering.id;
+            vlc_mutex_lock(&lock);
+            if(event.u.buffering.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    BufferBasedContext ctx;
+                    streams.insert(std::pair<ID, BufferBasedContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, BufferBasedContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+        {
+            const ID &id = *event.u.buffering_level.id;
+            vlc_mutex_lock(&lock);
+            std::map<ID, BufferBasedContext>::iterator it = streams.find(id);
+            if(it != streams.end())
+            {
+                BufferBasedContext &ctx = (*it).second;
+                ctx.buffering_min = event.u.buffering_level.minimum;
+                ctx.buffering_level = event.u.buffering_level.current;
+                ctx.buffering_target = event.u.buffering_level.target;
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * BufferBasedAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2019 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef BUFFERBASEDADAPTATIONLOGIC_HPP
+#define BUFFERBASEDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include "../tools/MovingAverage.hpp"
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class BufferBasedContext
+        {
+            friend class BufferBasedAdaptationLogic;
+
+            public:
+                BufferBasedContext();
+
+            private:
+                vlc_tick_t buffering_min;
+                vlc_tick_t buffering_level;
+                vlc_tick_t buffering_target;
+                unsigned last_download_rate;
+                MovingAverage<unsigned> average;
+        };
+
+        class BufferBasedAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                BufferBasedAdaptationLogic(vlc_object_t *);
+                virtual ~BufferBasedAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
+                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t); /* reimpl */
+                virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
+
+            private:
+                uint64_t                    getRateFromBuffer(const BufferBasedContext &,
+                                                              uint64_t, uint64_t) const;
+                std::map<adaptive::ID, BufferBasedContext> streams;
+                vlc_mutex_t                 lock;
+        };
+    }
+}
+
+#endif // BUFFERBASEDADAPTATIONLOGIC_HPP
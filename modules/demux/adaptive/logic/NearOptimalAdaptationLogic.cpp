@@ -140,6 +140,8 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     BwDebug( msg_Info(p_obj, "buffering level %.2f% rep %ld kBps %zu kBps",
              (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target, m->getBandwidth()/8000, bps / 8000); );
 
+    reportSwitch(adaptSet->getID(), prevRep, m, ctxcopy.buffering_level, bps);
+
     return m;
 }
 
@@ -144,6 +144,9 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
                     msg_Info(p_obj, "Stream %s new bandwidth usage %zu KiB/s",
                          adaptSet->getID().str().c_str(), rep->getBandwidth() / 8000); );
 
+        reportSwitch(adaptSet->getID(), prevRep, rep,
+                     stats.buffering_level, stats.last_download_rate);
+
         stats.segments_count++;
     }
 
@@ -47,6 +47,7 @@ AbstractPlaylist::AbstractPlaylist (vlc_object_t *p_object_) :
     timeShiftBufferDepth.Set( 0 );
     suggestedPresentationDelay.Set( 0 );
     b_needsUpdates = true;
+    b_lowlatency = false;
 }
 
 AbstractPlaylist::~AbstractPlaylist()
@@ -87,15 +88,31 @@ void AbstractPlaylist::setMinBuffering( vlc_tick_t min )
 
 vlc_tick_t AbstractPlaylist::getMinBuffering() const
 {
+    /* Low latency live: just enough to absorb a chunk boundary */
+    if(isLowLatency())
+        return std::min(std::max(minBufferTime, VLC_TICK_FROM_MS(500)),
+                        VLC_TICK_FROM_SEC(1));
     return std::max(minBufferTime, VLC_TICK_FROM_SEC(6));
 }
 
 vlc_tick_t AbstractPlaylist::getMaxBuffering() const
 {
     const vlc_tick_t minbuf = getMinBuffering();
+    if(isLowLatency())
+        return std::max(minbuf, VLC_TICK_FROM_SEC(2));
     return std::max(minbuf, VLC_TICK_FROM_SEC(60));
 }
 
+void AbstractPlaylist::setLowLatency( bool b )
+{
+    b_lowlatency = b;
+}
+
+bool AbstractPlaylist::isLowLatency() const
+{
+    return b_lowlatency && isLive();
+}
+
 Url AbstractPlaylist::getUrlSegment() const
 {
     Url ret;
@@ -45,6 +45,8 @@ namespace adaptive
                 void                            setMinBuffering( vlc_tick_t );
                 vlc_tick_t                      getMinBuffering() const;
                 vlc_tick_t                      getMaxBuffering() const;
+                void                            setLowLatency( bool );
+                bool                            isLowLatency() const;
                 virtual void                    debug() = 0;
 
                 void    addPeriod               (BasePeriod *period);
@@ -78,6 +80,7 @@ namespace adaptive
                 std::string                         type;
                 vlc_tick_t                          minBufferTime;
                 bool                                b_needsUpdates;
+                bool                                b_lowlatency;
         };
     }
 }
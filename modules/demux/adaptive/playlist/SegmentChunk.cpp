@@ -29,6 +29,7 @@
 #include <vlc_block.h>
 
 #include <cassert>
+#include <new>
 
 using namespace adaptive::playlist;
 using namespace adaptive::encryption;
@@ -78,5 +79,19 @@ StreamFormat SegmentChunk::getStreamFormat() const
 void SegmentChunk::setEncryptionSession(CommonEncryptionSession *s)
 {
     delete encryptionSession;
+    encryptionSession = NULL;
+
+    /* Decrypt buffered sources on the downloader thread, as the data
+     * arrives, rather than in the demuxer read path */
+    HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
+    if(s && src)
+    {
+        CommonEncryptionFilter *filter = new (std::nothrow) CommonEncryptionFilter(s);
+        if(filter)
+        {
+            src->setFilter(filter);
+            return;
+        }
+    }
     encryptionSession = s;
 }
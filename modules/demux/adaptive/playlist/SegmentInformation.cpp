@@ -180,11 +180,14 @@ uint64_t SegmentInformation::getLiveSegmentNumberByTime(uint64_t def, vlc_tick_t
 
 uint64_t SegmentInformation::getLiveStartSegmentNumber(uint64_t def) const
 {
+    const bool b_lowlatency = getPlaylist()->isLowLatency();
     const vlc_tick_t i_max_buffering = getPlaylist()->getMaxBuffering() +
-                                    /* FIXME: add dynamic pts-delay */ VLC_TICK_FROM_SEC(1);
+                                    /* FIXME: add dynamic pts-delay */
+                                    (b_lowlatency ? VLC_TICK_FROM_MS(300) : VLC_TICK_FROM_SEC(1));
 
-    /* Try to never buffer up to really end */
-    const uint64_t OFFSET_FROM_END = 3;
+    /* Try to never buffer up to really end, unless we want to stay
+     * as close as possible to the live edge */
+    const uint64_t OFFSET_FROM_END = b_lowlatency ? 1 : 3;
 
     if( mediaSegmentTemplate )
     {
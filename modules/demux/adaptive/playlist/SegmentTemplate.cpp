@@ -54,6 +54,7 @@ MediaSegmentTemplate::MediaSegmentTemplate( SegmentInformation *parent ) :
     classId = Segment::CLASSID_SEGMENT;
     startNumber = std::numeric_limits<uint64_t>::max();
     segmentTimeline = NULL;
+    availabilityTimeOffset.Set( 0 );
     initialisationSegment.Set( NULL );
     templated = true;
     parentSegmentInformation = parent;
@@ -135,6 +136,19 @@ stime_t MediaSegmentTemplate::inheritDuration() const
     return 0;
 }
 
+vlc_tick_t MediaSegmentTemplate::inheritAvailabilityTimeOffset() const
+{
+    const SegmentInformation *ulevel = parentSegmentInformation ? parentSegmentInformation
+                                                                : NULL;
+    for( ; ulevel ; ulevel = ulevel->parent )
+    {
+        if( ulevel->mediaSegmentTemplate &&
+            ulevel->mediaSegmentTemplate->availabilityTimeOffset.Get() > 0 )
+            return ulevel->mediaSegmentTemplate->availabilityTimeOffset.Get();
+    }
+    return 0;
+}
+
 SegmentTimeline * MediaSegmentTemplate::inheritSegmentTimeline() const
 {
     const SegmentInformation *ulevel = parentSegmentInformation ? parentSegmentInformation
@@ -157,8 +171,12 @@ uint64_t MediaSegmentTemplate::getLiveTemplateNumber(vlc_tick_t playbacktime) co
     {
         /* compute, based on current time */
         const Timescale timescale = inheritTimescale();
-        time_t streamstart = parentSegmentInformation->getPlaylist()->availabilityStartTime.Get();
+        const AbstractPlaylist *playlist = parentSegmentInformation->getPlaylist();
+        time_t streamstart = playlist->availabilityStartTime.Get();
         streamstart += parentSegmentInformation->getPeriodStart();
+        /* Chunked segments are announced available before being complete */
+        if(playlist->isLowLatency())
+            playbacktime += inheritAvailabilityTimeOffset();
         stime_t elapsed = timescale.ToScaled(playbacktime - vlc_tick_from_sec(streamstart));
         number += elapsed / dur;
     }
@@ -62,9 +62,12 @@ namespace adaptive
                 virtual Timescale inheritTimescale() const; /* reimpl */
                 virtual uint64_t inheritStartNumber() const;
                 stime_t inheritDuration() const;
+                vlc_tick_t inheritAvailabilityTimeOffset() const;
                 SegmentTimeline * inheritSegmentTimeline() const;
                 virtual void debug(vlc_object_t *, int = 0) const; /* reimpl */
 
+                Property<vlc_tick_t> availabilityTimeOffset;
+
             protected:
                 uint64_t startNumber;
                 SegmentTimeline *segmentTimeline;
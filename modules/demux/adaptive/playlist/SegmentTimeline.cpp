@@ -26,6 +26,7 @@
 #include "SegmentTimeline.h"
 
 #include <algorithm>
+#include <limits>
 
 using namespace adaptive::playlist;
 
@@ -51,14 +52,23 @@ SegmentTimeline::~SegmentTimeline()
 
 void SegmentTimeline::addElement(uint64_t number, stime_t d, uint64_t r, stime_t t)
 {
-    Element *element = new (std::nothrow) Element(number, d, r, t);
-    if(element)
+    if(!elements.empty())
     {
-        if(!elements.empty() && !t)
+        Element *el = elements.back();
+        if(!t)
+            t = el->t + (el->d * (el->r + 1));
+        /* Live manifests often list each S with explicit t, so keep
+         * them as a single run when contiguous */
+        if(el->appendRepeats(number, d, r, t))
         {
-            const Element *el = elements.back();
-            element->t = el->t + (el->d * (el->r + 1));
+            totalLength += (d * (r + 1));
+            return;
         }
+    }
+
+    Element *element = new (std::nothrow) Element(number, d, r, t);
+    if(element)
+    {
         elements.push_back(element);
         totalLength += (d * (r + 1));
     }
@@ -238,8 +248,13 @@ void SegmentTimeline::updateWith(SegmentTimeline &other)
         else /* Did not exist in previous list */
         {
             totalLength += (el->d * (el->r + 1));
-            elements.push_back(el);
             el->number = last->number + last->r + 1;
+            if(last->appendRepeats(el->number, el->d, el->r, el->t))
+            {
+                delete el;
+                continue;
+            }
+            elements.push_back(el);
             last = el;
         }
     }
@@ -264,6 +279,18 @@ SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, sti
     r = r_;
 }
 
+bool SegmentTimeline::Element::appendRepeats(uint64_t number_, stime_t d_,
+                                             uint64_t r_, stime_t t_)
+{
+    /* Open ended repeats (r < 0 in manifest) are never merged */
+    const uint64_t maxrepeat = std::numeric_limits<unsigned>::max();
+    if(d_ != d || r >= maxrepeat || r_ >= maxrepeat ||
+       number_ != number + r + 1 || t_ != t + d * (r + 1))
+        return false;
+    r += r_ + 1;
+    return true;
+}
+
 bool SegmentTimeline::Element::contains(stime_t time) const
 {
     if(time >= t && time < t + (stime_t)(r + 1) * d)
@@ -62,6 +62,7 @@ namespace adaptive
                         Element(uint64_t, stime_t, uint64_t, stime_t);
                         void debug(vlc_object_t *, int = 0) const;
                         bool contains(stime_t) const;
+                        bool appendRepeats(uint64_t, stime_t, uint64_t, stime_t);
                         stime_t  t;
                         stime_t  d;
                         uint64_t r;
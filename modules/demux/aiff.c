@@ -47,6 +47,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("AIFF demuxer" ) )
     set_capability( "demux", 10 )
+    set_probe_hints( "aif,aiff,aifc,audio/aiff,audio/x-aiff" )
     set_callback( Open )
     add_shortcut( "aiff" )
 vlc_module_end ()
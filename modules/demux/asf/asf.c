@@ -60,6 +60,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("ASF/WMV demuxer") )
     set_capability( "demux", 200 )
+    set_probe_hints( "asf,wmv,wma,video/x-ms-asf,video/x-ms-wmv,audio/x-ms-wma" )
     set_callbacks( Open, Close )
     add_shortcut( "asf", "wmv" )
 vlc_module_end ()
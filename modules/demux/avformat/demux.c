@@ -93,6 +93,7 @@ static int IORead( void *opaque, uint8_t *buf, int buf_size );
 static int64_t IOSeek( void *opaque, int64_t offset, int whence );
 
 static block_t *BuildSsaFrame( const AVPacket *p_pkt, unsigned i_order );
+static block_t *BuildFrame( const AVPacket *p_pkt );
 static void UpdateSeekPoint( demux_t *p_demux, vlc_tick_t i_time );
 static void ResetTime( demux_t *p_demux, int64_t i_time );
 
@@ -847,12 +848,11 @@ static int Demux( demux_t *p_demux )
     }
     else
     {
-        if( ( p_frame = block_Alloc( pkt.size ) ) == NULL )
+        if( ( p_frame = BuildFrame( &pkt ) ) == NULL )
         {
             av_packet_unref( &pkt );
             return 0;
         }
-        memcpy( p_frame->p_buffer, pkt.data, pkt.size );
     }
 
     if( pkt.flags & AV_PKT_FLAG_KEY )
@@ -999,6 +999,52 @@ static void ResetTime( demux_t *p_demux, int64_t i_time )
     }
 }
 
+typedef struct
+{
+    block_t self;
+    AVBufferRef *buf;
+} vlc_av_buffer_block_t;
+
+static void vlc_av_buffer_block_Release( block_t *p_block )
+{
+    vlc_av_buffer_block_t *b = container_of( p_block, vlc_av_buffer_block_t,
+                                             self );
+
+    av_buffer_unref( &b->buf );
+    free( b );
+}
+
+static const struct vlc_block_callbacks vlc_av_buffer_block_cbs =
+{
+    vlc_av_buffer_block_Release,
+};
+
+static block_t *BuildFrame( const AVPacket *p_pkt )
+{
+    /* Blocks can be modified in place downstream, only share the packet
+     * buffer if nobody else references it */
+    if( p_pkt->buf != NULL && av_buffer_is_writable( p_pkt->buf ) )
+    {
+        vlc_av_buffer_block_t *b = malloc( sizeof( *b ) );
+        if( unlikely(b == NULL) )
+            return NULL;
+
+        b->buf = av_buffer_ref( p_pkt->buf );
+        if( unlikely(b->buf == NULL) )
+        {
+            free( b );
+            return NULL;
+        }
+        return block_Init( &b->self, &vlc_av_buffer_block_cbs,
+                           p_pkt->data, p_pkt->size );
+    }
+
+    block_t *p_frame = block_Alloc( p_pkt->size );
+    if( likely(p_frame != NULL) )
+        memcpy( p_frame->p_buffer, p_pkt->data, p_pkt->size );
+    return p_frame;
+}
+
 static block_t *BuildSsaFrame( const AVPacket *p_pkt, unsigned i_order )
 {
     if( p_pkt->size <= 0 )
@@ -71,6 +71,7 @@ vlc_module_begin ()
     set_shortname( "AVI" )
     set_description( N_("AVI demuxer") )
     set_capability( "demux", 212 )
+    set_probe_hints( "avi,divx,video/avi,video/x-msvideo" )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
 
@@ -118,7 +119,6 @@ typedef struct
 
 typedef struct
 {
-    vlc_fourcc_t i_id;
     uint32_t     i_flags;
     uint64_t     i_pos;
     uint32_t     i_length;
@@ -126,16 +126,47 @@ typedef struct
 
 } avi_entry_t;
 
+/* Index entries are stored by blocks of AVI_INDEX_BLOCK, with the position
+ * and cumulated length relative to the first entry of the block. A block
+ * whose deltas do not fit in 32 bits is kept unpacked. */
+#define AVI_INDEX_BLOCK 1024
+#define AVI_INDEX_KEY   0x80000000
+
+typedef struct
+{
+    uint32_t     i_pos;
+    uint32_t     i_lengthtotal;
+    uint32_t     i_length; /* AVI_INDEX_KEY is set for key frames */
+
+} avi_packed_entry_t;
+
 typedef struct
 {
-    uint32_t        i_size;
-    uint32_t        i_max;
-    avi_entry_t     *p_entry;
+    uint64_t            i_pos;
+    uint64_t            i_lengthtotal;
+    avi_packed_entry_t  *p_packed;
+    avi_entry_t         *p_entry;
+
+} avi_index_block_t;
+
+typedef struct
+{
+    uint32_t            i_size;
+    uint32_t            i_max;
+    avi_index_block_t   *p_block;
+
+    /* OpenDML super index, standard indexes are loaded on demand */
+    indx_super_entry_t  *p_super;
+    uint32_t            i_super;
+    uint32_t            i_super_next;
+    uint64_t            i_pending_duration;
 
 } avi_index_t;
 static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
+static avi_entry_t avi_index_Get( const avi_index_t *, uint32_t );
+static uint64_t avi_index_Bytes( const avi_index_t * );
 
 typedef struct
 {
@@ -219,6 +250,9 @@ static int AVI_PacketSearch   ( demux_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static void AVI_IndexLoadPending  ( demux_t *, avi_index_t *,
+                                    uint32_t i_entry, uint64_t i_byte );
+static void AVI_IndexLoadRemaining( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -714,8 +748,9 @@ aviindex:
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
-            i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
+        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.i_size )
+            i_idx_totalframes = __MAX(i_idx_totalframes,
+                                      tk->idx.i_size + tk->idx.i_pending_duration);
     }
     if( i_idx_totalframes != p_avih->i_totalframes &&
         p_sys->i_length < VLC_TICK_FROM_US( p_avih->i_totalframes *
@@ -788,9 +823,8 @@ aviindex:
             p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
             tk->i_rate == p_auds->p_wf->nSamplesPerSec )
         {
-            int64_t i_track_length =
-                tk->idx.p_entry[tk->idx.i_size-1].i_length +
-                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
+            AVI_IndexLoadPending( p_demux, &tk->idx, UINT32_MAX, UINT64_MAX );
+            int64_t i_track_length = avi_index_Bytes( &tk->idx );
             vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
                                                     p_avih->i_microsecperframe );
 
@@ -1028,9 +1062,10 @@ static int Demux_Seekable( demux_t *p_demux )
         avi_track_t *tk = p_sys->track[i_track];
 
         toread[i_track].b_ok = tk->b_activated && !tk->b_eof;
+        AVI_IndexLoadPending( p_demux, &tk->idx, tk->i_idxposc, 0 );
         if( tk->i_idxposc < tk->idx.i_size )
         {
-            toread[i_track].i_posf = tk->idx.p_entry[tk->i_idxposc].i_pos;
+            toread[i_track].i_posf = avi_index_Get( &tk->idx, tk->i_idxposc ).i_pos;
            if( tk->i_idxposb > 0 )
            {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1113,6 +1148,7 @@ static int Demux_Seekable( demux_t *p_demux )
 
             /* no valid index, we will parse directly the stream
              * in case we fail we will disable all finished stream */
+            AVI_IndexLoadRemaining( p_demux );
             if( p_sys->b_seekable && p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
             {
                 if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
@@ -1160,7 +1196,6 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk->fmt.i_codec, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
@@ -1211,13 +1246,13 @@ static int Demux_Seekable( demux_t *p_demux )
                     i_toread = __MAX( i_toread, 100 );
                 }
             }
-            i_size = __MIN( tk->idx.p_entry[tk->i_idxposc].i_length -
+            i_size = __MIN( avi_index_Get( &tk->idx, tk->i_idxposc ).i_length -
                                 tk->i_idxposb,
                             (size_t) i_toread );
         }
         else
         {
-            i_size = tk->idx.p_entry[tk->i_idxposc].i_length;
+            i_size = avi_index_Get( &tk->idx, tk->i_idxposc ).i_length;
         }
 
         if( tk->i_idxposb == 0 )
@@ -1235,7 +1270,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
 
         p_frame->i_pts = VLC_TICK_0 + AVI_GetPTS( tk );
-        if( tk->idx.p_entry[tk->i_idxposc].i_flags&AVIIF_KEYFRAME )
+        if( avi_index_Get( &tk->idx, tk->i_idxposc ).i_flags&AVIIF_KEYFRAME )
         {
             p_frame->i_flags = BLOCK_FLAG_TYPE_I;
         }
@@ -1254,7 +1289,7 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread -= i_size;
             tk->i_idxposb += i_size;
             if( tk->i_idxposb >=
-                    tk->idx.p_entry[tk->i_idxposc].i_length )
+                    avi_index_Get( &tk->idx, tk->i_idxposc ).i_length )
             {
                 tk->i_idxposb = 0;
                 tk->i_idxposc++;
@@ -1262,7 +1297,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
         else
         {
-            int i_length = tk->idx.p_entry[tk->i_idxposc].i_length;
+            int i_length = avi_index_Get( &tk->idx, tk->i_idxposc ).i_length;
 
             tk->i_idxposc++;
             if( tk->fmt.i_cat == AUDIO_ES )
@@ -1272,10 +1307,11 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread--;
         }
 
+        AVI_IndexLoadPending( p_demux, &tk->idx, tk->i_idxposc, 0 );
         if( tk->i_idxposc < tk->idx.i_size)
         {
             toread[i_track].i_posf =
-                tk->idx.p_entry[tk->i_idxposc].i_pos;
+                avi_index_Get( &tk->idx, tk->i_idxposc ).i_pos;
             if( tk->i_idxposb > 0 )
             {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1520,8 +1556,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
                 goto failandresetpos;
             }
 
-            while( i_pos >= p_stream->idx.p_entry[p_stream->i_idxposc].i_pos +
-               p_stream->idx.p_entry[p_stream->i_idxposc].i_length + 8 )
+            while( i_pos >= avi_index_Get( &p_stream->idx, p_stream->i_idxposc ).i_pos +
+               avi_index_Get( &p_stream->idx, p_stream->i_idxposc ).i_length + 8 )
             {
                 /* search after i_idxposc */
                 if( AVI_StreamChunkSet( p_demux,
@@ -1787,12 +1823,12 @@ static vlc_tick_t AVI_GetPTS( avi_track_t *tk )
         {
             /* use the last entry */
             idx = tk->idx.i_size - 1;
-            i_count = tk->idx.p_entry[idx].i_lengthtotal
-                    + tk->idx.p_entry[idx].i_length;
+            i_count = avi_index_Get( &tk->idx, idx ).i_lengthtotal
+                    + avi_index_Get( &tk->idx, idx ).i_length;
         }
         else
         {
-            i_count = tk->idx.p_entry[idx].i_lengthtotal;
+            i_count = avi_index_Get( &tk->idx, idx ).i_lengthtotal;
         }
         return AVI_GetDPTS( tk, i_count + tk->i_idxposb );
     }
@@ -1810,6 +1846,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     unsigned short i_loop_count = 0;
 
     /* find first chunk of i_stream that isn't in index */
+    AVI_IndexLoadRemaining( p_demux );
 
     if( p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
     {
@@ -1850,7 +1887,6 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk->fmt.i_codec, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
@@ -1880,6 +1916,7 @@ static int AVI_StreamChunkSet( demux_t *p_demux, unsigned int i_stream,
     p_stream->i_idxposc = i_ck;
     p_stream->i_idxposb = 0;
 
+    AVI_IndexLoadPending( p_demux, &p_stream->idx, i_ck, 0 );
     if(  i_ck >= p_stream->idx.i_size )
     {
         p_stream->i_idxposc = p_stream->idx.i_size - 1;
@@ -1905,9 +1942,9 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
     demux_sys_t *p_sys = p_demux->p_sys;
     avi_track_t *p_stream = p_sys->track[i_stream];
 
+    AVI_IndexLoadPending( p_demux, &p_stream->idx, 0, i_byte );
     if( ( p_stream->idx.i_size > 0 )
-        &&( i_byte < p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
-                p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) )
+        &&( i_byte < avi_index_Bytes( &p_stream->idx ) ) )
     {
         /* index is valid to find the ck */
         /* uses dichototmie to be fast enougth */
@@ -1916,15 +1953,15 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
         int i_idxmin  = 0;
         for( ;; )
         {
-            if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal > i_byte )
+            avi_entry_t entry = avi_index_Get( &p_stream->idx, i_idxposc );
+            if( entry.i_lengthtotal > i_byte )
             {
                 i_idxmax  = i_idxposc ;
                 i_idxposc = ( i_idxmin + i_idxposc ) / 2 ;
             }
             else
             {
-                if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal +
-                        p_stream->idx.p_entry[i_idxposc].i_length <= i_byte)
+                if( entry.i_lengthtotal + entry.i_length <= i_byte)
                 {
                     i_idxmin  = i_idxposc ;
                     i_idxposc = (i_idxmax + i_idxposc ) / 2 ;
@@ -1932,8 +1969,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 else
                 {
                     p_stream->i_idxposc = i_idxposc;
-                    p_stream->i_idxposb = i_byte -
-                            p_stream->idx.p_entry[i_idxposc].i_lengthtotal;
+                    p_stream->i_idxposb = i_byte - entry.i_lengthtotal;
                     return VLC_SUCCESS;
                 }
             }
@@ -1952,11 +1988,10 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 return VLC_EGENERIC;
             }
 
-        } while( p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal +
-                    p_stream->idx.p_entry[p_stream->i_idxposc].i_length <= i_byte );
+        } while( avi_index_Bytes( &p_stream->idx ) <= i_byte );
 
         p_stream->i_idxposb = i_byte -
-                       p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal;
+                       avi_index_Get( &p_stream->idx, p_stream->i_idxposc ).i_lengthtotal;
         return VLC_SUCCESS;
     }
 }
@@ -1990,7 +2025,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             {
                 if( tk->i_blocksize > 0 )
                 {
-                    tk->i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
+                    tk->i_blockno += ( avi_index_Get( &tk->idx, i ).i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
                 }
                 else
                 {
@@ -2011,7 +2046,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             //if( i_date < i_oldpts || 1 )
             {
                 while( p_stream->i_idxposc > 0 &&
-                   !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
+                   !( avi_index_Get( &p_stream->idx, p_stream->i_idxposc ).i_flags &
                                                                 AVIIF_KEYFRAME ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
@@ -2026,7 +2061,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             else
             {
                 while( p_stream->i_idxposc < p_stream->idx.i_size &&
-                        !( p_stream->idx.p_entry[p_stream->i_idxposc].i_flags &
+                        !( avi_index_Get( &p_stream->idx, p_stream->i_idxposc ).i_flags &
                                                                 AVIIF_KEYFRAME ) )
                 {
                     if( AVI_StreamChunkSet( p_demux,
@@ -2263,11 +2298,77 @@ static void avi_index_Init( avi_index_t *p_index )
 {
     p_index->i_size  = 0;
     p_index->i_max   = 0;
-    p_index->p_entry = NULL;
+    p_index->p_block = NULL;
+    p_index->p_super = NULL;
+    p_index->i_super = 0;
+    p_index->i_super_next = 0;
+    p_index->i_pending_duration = 0;
 }
 static void avi_index_Clean( avi_index_t *p_index )
 {
-    free( p_index->p_entry );
+    for( uint32_t i = 0; i < p_index->i_max; i++ )
+    {
+        free( p_index->p_block[i].p_packed );
+        free( p_index->p_block[i].p_entry );
+    }
+    free( p_index->p_block );
+    free( p_index->p_super );
+}
+static avi_entry_t avi_index_Get( const avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+
+    if( p_block->p_entry )
+        return p_block->p_entry[i % AVI_INDEX_BLOCK];
+
+    const avi_packed_entry_t *p_packed = &p_block->p_packed[i % AVI_INDEX_BLOCK];
+    avi_entry_t entry = {
+        .i_flags  = ( p_packed->i_length & AVI_INDEX_KEY ) ? AVIIF_KEYFRAME : 0,
+        .i_pos    = p_block->i_pos + p_packed->i_pos,
+        .i_length = p_packed->i_length & ~AVI_INDEX_KEY,
+        .i_lengthtotal = p_block->i_lengthtotal + p_packed->i_lengthtotal,
+    };
+    return entry;
+}
+static void avi_index_SetKeyFrame( avi_index_t *p_index, uint32_t i )
+{
+    avi_index_block_t *p_block = &p_index->p_block[i / AVI_INDEX_BLOCK];
+
+    if( p_block->p_entry )
+        p_block->p_entry[i % AVI_INDEX_BLOCK].i_flags |= AVIIF_KEYFRAME;
+    else
+        p_block->p_packed[i % AVI_INDEX_BLOCK].i_length |= AVI_INDEX_KEY;
+}
+/* Total length of the indexed chunks */
+static uint64_t avi_index_Bytes( const avi_index_t *p_index )
+{
+    if( p_index->i_size == 0 )
+        return 0;
+    avi_entry_t last = avi_index_Get( p_index, p_index->i_size - 1 );
+    return last.i_lengthtotal + last.i_length;
+}
+static bool avi_index_Pending( const avi_index_t *p_index )
+{
+    return p_index->i_super_next < p_index->i_super;
+}
+static int avi_index_Unpack( avi_index_block_t *p_block, uint32_t i_count )
+{
+    avi_entry_t *p_entry = vlc_alloc( AVI_INDEX_BLOCK, sizeof( *p_entry ) );
+    if( !p_entry )
+        return VLC_ENOMEM;
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        const avi_packed_entry_t *p_packed = &p_block->p_packed[i];
+        p_entry[i].i_flags  = ( p_packed->i_length & AVI_INDEX_KEY ) ? AVIIF_KEYFRAME : 0;
+        p_entry[i].i_pos    = p_block->i_pos + p_packed->i_pos;
+        p_entry[i].i_length = p_packed->i_length & ~AVI_INDEX_KEY;
+        p_entry[i].i_lengthtotal = p_block->i_lengthtotal + p_packed->i_lengthtotal;
+    }
+    free( p_block->p_packed );
+    p_block->p_packed = NULL;
+    p_block->p_entry  = p_entry;
+    return VLC_SUCCESS;
 }
 static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
                               avi_entry_t *p_entry )
@@ -2276,28 +2377,68 @@ static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     if( *pi_last_pos < p_entry->i_pos )
          *pi_last_pos = p_entry->i_pos;
 
-    /* add the entry */
-    if( p_index->i_size >= p_index->i_max )
-    {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
-            return;
-    }
     /* calculate cumulate length */
-    if( p_index->i_size > 0 )
-    {
-        p_entry->i_lengthtotal =
-            p_index->p_entry[p_index->i_size - 1].i_length +
-                p_index->p_entry[p_index->i_size - 1].i_lengthtotal;
-    }
-    else
+    p_entry->i_lengthtotal = avi_index_Bytes( p_index );
+
+    const uint32_t i_block = p_index->i_size / AVI_INDEX_BLOCK;
+    const uint32_t i_slot  = p_index->i_size % AVI_INDEX_BLOCK;
+
+    /* start a new block */
+    if( i_slot == 0 )
     {
-        p_entry->i_lengthtotal = 0;
+        if( i_block >= p_index->i_max )
+        {
+            avi_index_block_t *p_block =
+                realloc( p_index->p_block,
+                         ( p_index->i_max + 16 ) * sizeof( *p_block ) );
+            if( !p_block )
+                return;
+            for( uint32_t i = p_index->i_max; i < p_index->i_max + 16; i++ )
+            {
+                p_block[i].p_packed = NULL;
+                p_block[i].p_entry  = NULL;
+            }
+            p_index->p_block = p_block;
+            p_index->i_max += 16;
+        }
+
+        avi_index_block_t *p_block = &p_index->p_block[i_block];
+        free( p_block->p_entry );
+        p_block->p_entry = NULL;
+        if( !p_block->p_packed )
+        {
+            p_block->p_packed = vlc_alloc( AVI_INDEX_BLOCK,
+                                           sizeof( *p_block->p_packed ) );
+            if( !p_block->p_packed )
+                return;
+        }
+        p_block->i_pos = p_entry->i_pos;
+        p_block->i_lengthtotal = p_entry->i_lengthtotal;
     }
 
-    p_index->p_entry[p_index->i_size++] = *p_entry;
+    /* add the entry */
+    avi_index_block_t *p_block = &p_index->p_block[i_block];
+    if( !p_block->p_entry )
+    {
+        if( p_entry->i_pos >= p_block->i_pos &&
+            p_entry->i_pos - p_block->i_pos <= UINT32_MAX &&
+            p_entry->i_lengthtotal - p_block->i_lengthtotal <= UINT32_MAX &&
+            !( p_entry->i_length & AVI_INDEX_KEY ) )
+        {
+            avi_packed_entry_t *p_packed = &p_block->p_packed[i_slot];
+            p_packed->i_pos = p_entry->i_pos - p_block->i_pos;
+            p_packed->i_lengthtotal = p_entry->i_lengthtotal - p_block->i_lengthtotal;
+            p_packed->i_length = p_entry->i_length;
+            if( p_entry->i_flags & AVIIF_KEYFRAME )
+                p_packed->i_length |= AVI_INDEX_KEY;
+            p_index->i_size++;
+            return;
+        }
+        if( avi_index_Unpack( p_block, i_slot ) )
+            return;
+    }
+    p_block->p_entry[i_slot] = *p_entry;
+    p_index->i_size++;
 }
 
 static int AVI_IndexFind_idx1( demux_t *p_demux,
@@ -2389,7 +2530,6 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
@@ -2408,14 +2548,14 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             if( p_sys->track[i_index]->i_samplesize )
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index],
-                                        p_index[i_index].p_entry[i].i_lengthtotal );
+                                        avi_index_Get( &p_index[i_index], i ).i_lengthtotal );
             }
             else
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index], i );
             }
             msg_Dbg( p_demux, "index stream %d @%ld time %ld", i_index,
-                     p_index[i_index].p_entry[i].i_pos, i_length );
+                     avi_index_Get( &p_index[i_index], i ).i_pos, i_length );
         }
     }
 #endif
@@ -2435,7 +2575,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
             index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
@@ -2448,7 +2587,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
             index.i_length = p_indx->idx.field[i].i_size;
@@ -2463,6 +2601,52 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     }
 }
 
+/* Reads the OpenDML standard indexes not loaded yet, until the entry i_entry
+ * and the byte i_byte are indexed or the index is complete */
+static void AVI_IndexLoadPending( demux_t *p_demux, avi_index_t *p_index,
+                                  uint32_t i_entry, uint64_t i_byte )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !avi_index_Pending( p_index ) ||
+        ( i_entry < p_index->i_size && i_byte < avi_index_Bytes( p_index ) ) )
+        return;
+
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    while( avi_index_Pending( p_index ) &&
+           ( i_entry >= p_index->i_size || i_byte >= avi_index_Bytes( p_index ) ) )
+    {
+        const indx_super_entry_t *p_super = &p_index->p_super[p_index->i_super_next++];
+        avi_chunk_t ck_sub;
+
+        p_index->i_pending_duration -= p_super->i_duration;
+        if( vlc_stream_Seek( p_demux->s, p_super->i_offset ) ||
+            AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
+        {
+            msg_Warn( p_demux, "cannot read subindex at %"PRIu64,
+                      p_super->i_offset );
+            p_index->i_super_next = p_index->i_super;
+            p_index->i_pending_duration = 0;
+            break;
+        }
+        if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
+            __Parse_indx( p_demux, p_index, &p_sys->i_movi_lastchunk_pos, &ck_sub.indx );
+        AVI_ChunkClean( p_demux->s, &ck_sub );
+    }
+    vlc_stream_Seek( p_demux->s, i_pos );
+}
+
+/* Completes the indexes of all the tracks, before looking for chunks past
+ * them in the stream */
+static void AVI_IndexLoadRemaining( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        AVI_IndexLoadPending( p_demux, &p_sys->track[i]->idx,
+                              UINT32_MAX, UINT64_MAX );
+}
+
 static void AVI_IndexLoad_indx( demux_t *p_demux,
                                 avi_index_t p_index[], uint64_t *pi_last_offset )
 {
@@ -2499,19 +2683,30 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
         {
             if ( !p_sys->b_seekable )
                 return;
-            avi_chunk_t    ck_sub;
-            for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
+            avi_index_t *p_idx = &p_index[i_stream];
+            p_idx->p_super = vlc_alloc( p_indx->i_entriesinuse,
+                                        sizeof( *p_idx->p_super ) );
+            if( !p_idx->p_super )
+                continue;
+            memcpy( p_idx->p_super, p_indx->idx.super,
+                    p_indx->i_entriesinuse * sizeof( *p_idx->p_super ) );
+            p_idx->i_super = p_indx->i_entriesinuse;
+
+            /* Only the first standard index is read now when the durations
+             * of the others give the stream length */
+            bool b_lazy = p_sys->b_odml;
+            for( unsigned i = 0; i < p_idx->i_super; i++ )
             {
-                if( vlc_stream_Seek( p_demux->s,
-                                     p_indx->idx.super[i].i_offset ) ||
-                    AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
-                {
-                    break;
-                }
-                if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
-                    __Parse_indx( p_demux, &p_index[i_stream], pi_last_offset, &ck_sub.indx );
-                AVI_ChunkClean( p_demux->s, &ck_sub );
+                p_idx->i_pending_duration += p_idx->p_super[i].i_duration;
+                if( p_idx->p_super[i].i_duration == 0 )
+                    b_lazy = false;
             }
+            if( b_lazy )
+                AVI_IndexLoadPending( p_demux, p_idx, 0, 0 );
+            else
+                AVI_IndexLoadPending( p_demux, p_idx, UINT32_MAX, UINT64_MAX );
+            if( *pi_last_offset < p_sys->i_movi_lastchunk_pos )
+                *pi_last_offset = p_sys->i_movi_lastchunk_pos;
         }
         else
         {
@@ -2544,15 +2739,18 @@ static void AVI_IndexLoad( demux_t *p_demux )
     /* Select the longest index */
     for( unsigned i = 0; i < p_sys->i_track; i++ )
     {
-        if( p_idx_indx[i].i_size > p_idx_idx1[i].i_size )
+        if( p_idx_indx[i].i_size + p_idx_indx[i].i_pending_duration >
+            p_idx_idx1[i].i_size )
         {
             msg_Dbg( p_demux, "selected ODML index for stream[%u]", i );
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_indx[i];
             avi_index_Clean( &p_idx_idx1[i] );
         }
         else
         {
             msg_Dbg( p_demux, "selected standard index for stream[%u]", i );
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_idx1[i];
             avi_index_Clean( &p_idx_indx[i] );
         }
@@ -2566,17 +2764,17 @@ static void AVI_IndexLoad( demux_t *p_demux )
         /* Fix key flag */
         bool b_key = false;
         for( unsigned j = 0; !b_key && j < p_index->i_size; j++ )
-            b_key = p_index->p_entry[j].i_flags & AVIIF_KEYFRAME;
+            b_key = avi_index_Get( p_index, j ).i_flags & AVIIF_KEYFRAME;
         if( !b_key )
         {
             msg_Err( p_demux, "no key frame set for track %u", i );
             for( unsigned j = 0; j < p_index->i_size; j++ )
-                p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+                avi_index_SetKeyFrame( p_index, j );
         }
 
         /* */
-        msg_Dbg( p_demux, "stream[%d] created %d index entries",
-                 i, p_index->i_size );
+        msg_Dbg( p_demux, "stream[%d] created %d index entries (%u/%u subindexes)",
+                 i, p_index->i_size, p_index->i_super_next, p_index->i_super );
     }
 }
 
@@ -2603,7 +2801,10 @@ static void AVI_IndexCreate( demux_t *p_demux )
     }
 
     for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    {
+        avi_index_Clean( &p_sys->track[i_stream]->idx );
         avi_index_Init( &p_sys->track[i_stream]->idx );
+    }
 
     i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
                         stream_Size( p_demux->s ) );
@@ -2649,7 +2850,6 @@ static void AVI_IndexCreate( demux_t *p_demux )
             avi_track_t *tk = p_sys->track[pk.i_stream];
 
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
             index.i_flags   = AVI_GetKeyFlag(tk->fmt.i_codec, pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
@@ -2971,7 +3171,7 @@ static int AVI_TrackStopFinishedStreams( demux_t *p_demux )
     for( i = 0; i < p_sys->i_track; i++ )
     {
         avi_track_t *tk = p_sys->track[i];
-        if( tk->i_idxposc >= tk->idx.i_size )
+        if( tk->i_idxposc >= tk->idx.i_size && !avi_index_Pending( &tk->idx ) )
         {
             tk->b_eof = true;
         }
@@ -2998,20 +3198,20 @@ static vlc_tick_t  AVI_MovieGetLength( demux_t *p_demux )
         vlc_tick_t i_length;
 
         /* fix length for each stream */
-        if( tk->idx.i_size < 1 || !tk->idx.p_entry )
+        if( tk->idx.i_size < 1 )
         {
             continue;
         }
 
         if( tk->i_samplesize )
         {
-            i_length = AVI_GetDPTS( tk,
-                                    tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal +
-                                        tk->idx.p_entry[tk->idx.i_size-1].i_length );
+            i_length = AVI_GetDPTS( tk, avi_index_Bytes( &tk->idx ) +
+                                        tk->idx.i_pending_duration * tk->i_samplesize );
         }
         else
         {
-            i_length = AVI_GetDPTS( tk, tk->idx.i_size );
+            i_length = AVI_GetDPTS( tk, tk->idx.i_size +
+                                        tk->idx.i_pending_duration );
         }
 
         msg_Dbg( p_demux,
@@ -51,6 +51,7 @@ set_category( CAT_INPUT )
 set_subcategory( SUBCAT_INPUT_DEMUX )
 set_description( N_( "CAF demuxer" ))
 set_capability( "demux", 140 )
+set_probe_hints( "caf,audio/x-caf" )
 set_callbacks( Open, Close )
 add_shortcut( "caf" )
 vlc_module_end ()
@@ -44,7 +44,9 @@
 #include "../../adaptive/tools/Debug.hpp"
 #include "../../adaptive/tools/Conversions.hpp"
 #include <vlc_stream.h>
+#include <vlc_charset.h>
 #include <cstdio>
+#include <cmath>
 #include <limits>
 
 using namespace dash::mpd;
@@ -182,6 +184,14 @@ size_t IsoffMainParser::parseSegmentTemplate(Node *templateNode, SegmentInformat
     if(templateNode->hasAttribute("duration"))
         mediaTemplate->duration.Set(Integer<stime_t>(templateNode->getAttributeValue("duration")));
 
+    if(templateNode->hasAttribute("availabilityTimeOffset"))
+    {
+        /* seconds, or INF which has no meaning for live edge computation */
+        double ato = us_strtod(templateNode->getAttributeValue("availabilityTimeOffset").c_str(), NULL);
+        if(std::isfinite(ato) && ato > 0)
+            mediaTemplate->availabilityTimeOffset.Set(vlc_tick_from_sec(ato));
+    }
+
     InitSegmentTemplate *initTemplate = NULL;
 
     if(templateNode->hasAttribute("initialization"))
@@ -49,6 +49,7 @@ static void Close ( vlc_object_t * );
 vlc_module_begin ()
     set_description( N_("FLAC demuxer") )
     set_capability( "demux", 155 )
+    set_probe_hints( "flac,audio/flac,audio/x-flac" )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_callbacks( Open, Close )
@@ -48,21 +48,29 @@ namespace {
     EbmlId         const* p_ebmlid;
     std::type_info const* p_typeid;
     EbmlProcessor         callback;
+    uint64_t              key;
 
     EbmlProcessorEntry (EbmlId const& id, std::type_info const* ti, EbmlProcessor cb)
-      : p_ebmlid (&id), p_typeid (ti), callback (cb)
+      : p_ebmlid (&id), p_typeid (ti), callback (cb), key (make_key (id))
     { }
 
+    // --------------------------------------------------------------
+    // EBML IDs are at most 4 bytes long, so that the length and the
+    // value fit in a single integer ordered like the former pair.
+    // --------------------------------------------------------------
+
+    static uint64_t make_key (EbmlId const& id) {
+      return ( uint64_t( id.GetLength() ) << 32 ) | uint32_t( id.GetValue() );
+    }
+
+    static bool key_less (EbmlProcessorEntry const& entry, uint64_t key) {
+      return entry.key < key;
+    }
   };
 
   bool operator<( EbmlProcessorEntry const& lhs, EbmlProcessorEntry const& rhs )
   {
-      EbmlId const& lid = *lhs.p_ebmlid;
-      EbmlId const& rid = *rhs.p_ebmlid;
-
-      return lid.GetLength() < rid.GetLength() || (
-        !( rid.GetLength() < lid.GetLength() ) && lid.GetValue() < rid.GetValue()
-      );
+      return lhs.key < rhs.key;
   }
 
   class EbmlTypeDispatcher : public Dispatcher<EbmlTypeDispatcher, EbmlProcessorEntry::EbmlProcessor> {
@@ -83,40 +91,35 @@ namespace {
         if ( element == nullptr )
             return false;
 
-        EbmlProcessorEntry eb = EbmlProcessorEntry (
-          static_cast<EbmlId const&> (*element), NULL, NULL
+        uint64_t const key = EbmlProcessorEntry::make_key (
+          static_cast<EbmlId const&> (*element)
         );
 
         // --------------------------------------------------------------
-        // Find the appropriate callback for the received EbmlElement
+        // Find the appropriate callback for the received EbmlElement,
+        // the entries are sorted by key when the dispatcher is created
         // --------------------------------------------------------------
 
         ProcessorContainer::const_iterator cit_end = _processors.end();
         ProcessorContainer::const_iterator cit     = std::lower_bound (
-            _processors.begin(), cit_end, eb
+            _processors.begin(), cit_end, key, EbmlProcessorEntry::key_less
         );
 
-        if (cit != cit_end)
+        if (cit != cit_end && cit->key == key)
         {
+          std::type_info const& ti = typeid (*element);
+
           // --------------------------------------------------------------
-          // normally we only need to compare the addresses of the EbmlId
-          // since libebml returns a reference to a _static_ instance.
+          // even though the EbmlId are equivalent, we still need to make
+          // sure that the typeid also matches. The type_info objects are
+          // normally unique, so comparing their addresses is enough.
           // --------------------------------------------------------------
 
-          while (cit != cit_end && (cit->p_ebmlid == eb.p_ebmlid || (*cit->p_ebmlid == *eb.p_ebmlid))) {
-            std::type_info const& ti = typeid (*element);
-
-            // --------------------------------------------------------------
-            // even though the EbmlId are equivalent, we still need to make
-            // sure that the typeid also matches.
-            // --------------------------------------------------------------
-
-            if (*(cit->p_typeid) == ti) {
+          for (; cit != cit_end && cit->key == key; ++cit) {
+            if (cit->p_typeid == &ti || *(cit->p_typeid) == ti) {
               cit->callback (element, payload);
               return true;
             }
-
-            ++cit;
           }
         }
 
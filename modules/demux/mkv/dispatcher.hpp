@@ -59,14 +59,10 @@ namespace {
   template<class T, class DispatcherType>
   class DispatchContainer {
     public:    static DispatcherType dispatcher;
-    protected: static vlc_mutex_t   _dispatcher_lock;
   };
 
   template<class T, class DT>
   DT DispatchContainer<T, DT>::dispatcher;
-
-  template<class T, class DT>
-  vlc_mutex_t DispatchContainer<T, DT>::_dispatcher_lock = VLC_STATIC_MUTEX;
 }
 
 // ----------------------------------------------------------------------------
@@ -99,19 +95,18 @@ namespace {
 // ----------------------------------------------------------------------------
 //   * `Dispatcher` is a static function used to access the dispatcher in a
 //      thread-safe manner. We only want _one_ thread to actually construct
-//      and initialize it, hence the lock.
+//      and initialize it, which the initialization of a local static
+//      guarantees, without taking a lock on every later lookup.
 // ----------------------------------------------------------------------------
 
 #define MKV_SWITCH_INIT()                     \
+  static handler_t * CreateHandler () {       \
+      static handler_t handler;               \
+      handler.dispatcher.on_create ();        \
+      return &handler;                        \
+  }                                           \
   static dispatch_t& Dispatcher () {          \
-      static handler_t * p_handler = NULL;    \
-      vlc_mutex_lock( &_dispatcher_lock );    \
-      if (unlikely( p_handler == NULL) ) {    \
-          static handler_t handler;           \
-          p_handler = &handler;               \
-          p_handler->dispatcher.on_create (); \
-      }                                       \
-      vlc_mutex_unlock( &_dispatcher_lock );  \
+      static handler_t * const p_handler = CreateHandler (); \
       return p_handler->dispatcher;           \
   } struct PleaseAddSemicolon {}
 
@@ -27,6 +27,10 @@
 #include "util.hpp"
 #include "Ebml_parser.hpp"
 #include "Ebml_dispatcher.hpp"
+#include "stream_io_callback.hpp"
+
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
 
 #include <new>
 #include <iterator>
@@ -62,11 +66,14 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,i_seekindex_size(0)
 {
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    SaveSeekIndex();
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -682,6 +689,8 @@ bool matroska_segment_c::Preload( )
 
     ComputeTrackPriority();
 
+    LoadSeekIndex();
+
     b_preloaded = true;
 
     if( cluster )
@@ -690,6 +699,56 @@ bool matroska_segment_c::Preload( )
     return true;
 }
 
+/* Cue-less segments of the main input keep their seek index across plays */
+void matroska_segment_c::LoadSeekIndex()
+{
+    if( b_cues || !sys.b_seekable || !sys.demuxer.psz_url ||
+        !var_InheritBool( &sys.demuxer, "mkv-seek-index" ) )
+        return;
+
+    vlc_stream_io_callback *io_callback = dynamic_cast<vlc_stream_io_callback *>( &es.I_O() );
+    if( io_callback == NULL || io_callback->GetStream() != sys.demuxer.s ||
+        vlc_stream_GetSize( sys.demuxer.s, &i_seekindex_size ) || i_seekindex_size == 0 )
+        return;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, sys.demuxer.psz_url, strlen( sys.demuxer.psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path;
+    if( psz_hash &&
+        asprintf( &psz_path, "%s" DIR_SEP "mkv-index" DIR_SEP "%s-%" PRIu64 ".idx",
+                  psz_cachedir, psz_hash, segment->GetElementPosition() ) != -1 )
+    {
+        seekindex_path = psz_path;
+        free( psz_path );
+    }
+    free( psz_hash );
+    free( psz_cachedir );
+
+    if( !seekindex_path.empty() &&
+        _seeker.load_index( seekindex_path.c_str(), i_seekindex_size,
+                            segment->GetElementPosition() ) )
+        msg_Dbg( &sys.demuxer, "loaded seek index with %zu clusters",
+                 _seeker._cluster_positions.size() );
+}
+
+void matroska_segment_c::SaveSeekIndex()
+{
+    if( seekindex_path.empty() || !segment || !_seeker._dirty )
+        return;
+
+    if( !_seeker.save_index( seekindex_path.c_str(), i_seekindex_size,
+                             segment->GetElementPosition() ) )
+        msg_Warn( &sys.demuxer, "can't store seek index to %s", seekindex_path.c_str() );
+}
+
 /* Here we try to load elements that were found in Seek Heads, but not yet parsed */
 bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position )
 {
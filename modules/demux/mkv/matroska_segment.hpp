@@ -172,8 +172,12 @@ private:
     bool TrackInit( mkv_track_t * p_tk );
     void ComputeTrackPriority();
     void EnsureDuration();
+    void LoadSeekIndex();
+    void SaveSeekIndex();
 
     SegmentSeeker _seeker;
+    std::string   seekindex_path;
+    uint64_t      i_seekindex_size;
 
     friend SegmentSeeker;
 };
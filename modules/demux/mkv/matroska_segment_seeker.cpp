@@ -28,8 +28,12 @@
 #include "util.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_fs.h>
+
 #include <sstream>
 #include <limits>
+#include <cerrno>
+#include <cstdio>
 
 namespace { 
     template<class It, class T>
@@ -46,6 +50,48 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    // persisted index, all values big endian
+
+    char const   index_magic[8]    = { 'V', 'L', 'C', 'M', 'K', 'I', 'X', '1' };
+    uint32_t const index_max_items = 1 << 22;
+
+    bool write_u32( FILE * file, uint32_t value )
+    {
+        uint8_t buf[4];
+        SetDWBE( buf, value );
+        return fwrite( buf, sizeof( buf ), 1, file ) == 1;
+    }
+
+    bool write_u64( FILE * file, uint64_t value )
+    {
+        uint8_t buf[8];
+        SetQWBE( buf, value );
+        return fwrite( buf, sizeof( buf ), 1, file ) == 1;
+    }
+
+    bool read_u32( FILE * file, uint32_t& value )
+    {
+        uint8_t buf[4];
+        if( fread( buf, sizeof( buf ), 1, file ) != 1 )
+            return false;
+        value = GetDWBE( buf );
+        return true;
+    }
+
+    bool read_u64( FILE * file, uint64_t& value )
+    {
+        uint8_t buf[8];
+        if( fread( buf, sizeof( buf ), 1, file ) != 1 )
+            return false;
+        value = GetQWBE( buf );
+        return true;
+    }
+
+    bool read_count( FILE * file, uint32_t& count )
+    {
+        return read_u32( file, count ) && count <= index_max_items;
+    }
 }
 
 namespace mkv {
@@ -85,6 +131,7 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
     else
     {
         it = _clusters.insert( cluster_map_t::value_type( cinfo.pts, cinfo ) ).first;
+        _dirty = true;
     }
 
     // ------------------------------------------------------------------
@@ -129,6 +176,7 @@ SegmentSeeker::add_seekpoint( track_id_t track_id, Seekpoint sp )
     {
         seekpoints.insert( it, sp );
     }
+    _dirty = true;
 }
 
 SegmentSeeker::tracks_seekpoint_t
@@ -419,6 +467,7 @@ SegmentSeeker::mark_range_as_searched( Range data )
 
         _ranges_searched = merged;
     }
+    _dirty = true;
 }
 
 
@@ -519,4 +568,179 @@ SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
         ms.es.I_O().setFilePointer( fpos );
 }
 
+bool
+SegmentSeeker::load_index( char const * path, uint64_t file_size, fptr_t segment_pos )
+{
+    FILE * file = vlc_fopen( path, "rb" );
+    if( file == NULL )
+        return false;
+
+    char magic[sizeof( index_magic )];
+    uint64_t stored_size, stored_pos;
+    uint32_t count;
+
+    bool b_ok = fread( magic, sizeof( magic ), 1, file ) == 1 &&
+                !memcmp( magic, index_magic, sizeof( magic ) ) &&
+                read_u64( file, stored_size ) && stored_size == file_size &&
+                read_u64( file, stored_pos ) && stored_pos == segment_pos;
+
+    /* read everything before merging, a truncated file is ignored */
+    ranges_t            ranges;
+    cluster_positions_t positions;
+    std::vector<Cluster> clusters;
+    tracks_seekpoints_t tracks;
+
+    if( b_ok && ( b_ok = read_count( file, count ) ) )
+    {
+        for( uint32_t i = 0; i < count && b_ok; ++i )
+        {
+            uint64_t start, end;
+            b_ok = read_u64( file, start ) && read_u64( file, end );
+            if( b_ok && start <= end && end <= file_size )
+                ranges.push_back( Range( start, end ) );
+        }
+    }
+
+    if( b_ok && ( b_ok = read_count( file, count ) ) )
+    {
+        for( uint32_t i = 0; i < count && b_ok; ++i )
+        {
+            uint64_t fpos;
+            b_ok = read_u64( file, fpos ) && fpos < file_size;
+            if( b_ok )
+                positions.push_back( fpos );
+        }
+    }
+
+    if( b_ok && ( b_ok = read_count( file, count ) ) )
+    {
+        for( uint32_t i = 0; i < count && b_ok; ++i )
+        {
+            uint64_t fpos, pts, duration, size;
+            b_ok = read_u64( file, fpos ) && read_u64( file, pts ) &&
+                   read_u64( file, duration ) && read_u64( file, size ) &&
+                   fpos < file_size;
+            if( b_ok )
+            {
+                Cluster cinfo = { fpos, vlc_tick_t( pts ), vlc_tick_t( duration ), size };
+                clusters.push_back( cinfo );
+            }
+        }
+    }
+
+    if( b_ok && ( b_ok = read_count( file, count ) ) )
+    {
+        for( uint32_t i = 0; i < count && b_ok; ++i )
+        {
+            uint32_t track_id, points;
+            b_ok = read_u32( file, track_id ) && read_count( file, points );
+
+            for( uint32_t j = 0; j < points && b_ok; ++j )
+            {
+                uint64_t fpos, pts;
+                uint32_t trust;
+                b_ok = read_u64( file, fpos ) && read_u64( file, pts ) &&
+                       read_u32( file, trust ) && fpos < file_size &&
+                       ( trust == Seekpoint::TRUSTED || trust == Seekpoint::QUESTIONABLE );
+                if( b_ok )
+                    tracks[ track_id ].push_back( Seekpoint( fpos, vlc_tick_t( pts ),
+                                                  Seekpoint::TrustLevel( trust ) ) );
+            }
+        }
+    }
+
+    fclose( file );
+    if( !b_ok )
+        return false;
+
+    for( ranges_t::const_iterator it = ranges.begin(); it != ranges.end(); ++it )
+        mark_range_as_searched( *it );
+
+    for( cluster_positions_t::const_iterator it = positions.begin(); it != positions.end(); ++it )
+    {
+        if( !std::binary_search( _cluster_positions.begin(), _cluster_positions.end(), *it ) )
+            add_cluster_position( *it );
+    }
+
+    for( std::vector<Cluster>::const_iterator it = clusters.begin(); it != clusters.end(); ++it )
+        _clusters.insert( cluster_map_t::value_type( it->pts, *it ) );
+
+    for( tracks_seekpoints_t::const_iterator it = tracks.begin(); it != tracks.end(); ++it )
+    {
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+            add_seekpoint( it->first, *sp );
+    }
+
+    _dirty = false;
+    return true;
+}
+
+bool
+SegmentSeeker::save_index( char const * path, uint64_t file_size, fptr_t segment_pos ) const
+{
+    /* Create the mkv-index cache directory if needed */
+    char const * sep = strrchr( path, DIR_SEP_CHAR );
+    if( sep )
+    {
+        std::string dir( path, sep - path );
+        std::string::size_type parent = dir.rfind( DIR_SEP_CHAR );
+        if( parent != std::string::npos )
+            vlc_mkdir( dir.substr( 0, parent ).c_str(), 0700 );
+        if( vlc_mkdir( dir.c_str(), 0700 ) && errno != EEXIST )
+            return false;
+    }
+
+    std::string tmp = std::string( path ) + ".part";
+    FILE * file = vlc_fopen( tmp.c_str(), "wb" );
+    if( file == NULL )
+        return false;
+
+    bool b_ok = fwrite( index_magic, sizeof( index_magic ), 1, file ) == 1 &&
+                write_u64( file, file_size ) && write_u64( file, segment_pos );
+
+    b_ok = b_ok && write_u32( file, _ranges_searched.size() );
+    for( ranges_t::const_iterator it = _ranges_searched.begin(); b_ok && it != _ranges_searched.end(); ++it )
+        b_ok = write_u64( file, it->start ) && write_u64( file, it->end );
+
+    b_ok = b_ok && write_u32( file, _cluster_positions.size() );
+    for( cluster_positions_t::const_iterator it = _cluster_positions.begin(); b_ok && it != _cluster_positions.end(); ++it )
+        b_ok = write_u64( file, *it );
+
+    b_ok = b_ok && write_u32( file, _clusters.size() );
+    for( cluster_map_t::const_iterator it = _clusters.begin(); b_ok && it != _clusters.end(); ++it )
+        b_ok = write_u64( file, it->second.fpos ) && write_u64( file, it->second.pts ) &&
+               write_u64( file, it->second.duration ) && write_u64( file, it->second.size );
+
+    uint32_t tracks = 0;
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+        tracks += !it->second.empty();
+
+    b_ok = b_ok && write_u32( file, tracks );
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); b_ok && it != _tracks_seekpoints.end(); ++it )
+    {
+        if( it->second.empty() )
+            continue;
+
+        uint32_t points = 0;
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+            points += sp->trust_level > Seekpoint::DISABLED;
+
+        b_ok = write_u32( file, it->first ) && write_u32( file, points );
+        for( seekpoints_t::const_iterator sp = it->second.begin(); b_ok && sp != it->second.end(); ++sp )
+        {
+            if( sp->trust_level > Seekpoint::DISABLED )
+                b_ok = write_u64( file, sp->fpos ) && write_u64( file, sp->pts ) &&
+                       write_u32( file, sp->trust_level );
+        }
+    }
+
+    b_ok = ( fclose( file ) == 0 ) && b_ok;
+    if( !b_ok || vlc_rename( tmp.c_str(), path ) )
+    {
+        vlc_unlink( tmp.c_str() );
+        return false;
+    }
+    return true;
+}
+
 } // namespace
@@ -99,6 +99,10 @@ class SegmentSeeker
 
         typedef std::pair<Seekpoint, Seekpoint> seekpoint_pair_t;
 
+        SegmentSeeker()
+            : _dirty( false )
+        { }
+
         void add_seekpoint( track_id_t, Seekpoint );
 
         seekpoint_pair_t get_seekpoints_around( vlc_tick_t, seekpoints_t const& );
@@ -119,11 +123,15 @@ class SegmentSeeker
         void mark_range_as_searched( Range );
         ranges_t get_search_areas( fptr_t start, fptr_t end ) const;
 
+        bool load_index( char const * path, uint64_t file_size, fptr_t segment_pos );
+        bool save_index( char const * path, uint64_t file_size, fptr_t segment_pos ) const;
+
     public:
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+        bool                _dirty; /* changed since loaded from the index file */
 };
 
 } // namespace
@@ -52,6 +52,7 @@ vlc_module_begin ()
     set_shortname( "Matroska" )
     set_description( N_("Matroska stream demuxer" ) )
     set_capability( "demux", 50 )
+    set_probe_hints( "mkv,mka,mk3d,webm,video/x-matroska,audio/x-matroska,video/webm,audio/webm" )
     set_callbacks( Open, Close )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
@@ -80,6 +81,11 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback"), true );
 
+    add_bool( "mkv-seek-index", false,
+            N_("Keep seek index"),
+            N_("Store the cluster and keyframe index of files without Cues in the cache directory, "
+               "and reuse it to seek instantly when the same file is played again."), true );
+
     add_shortcut( "mka", "mkv" )
 vlc_module_end ()
 
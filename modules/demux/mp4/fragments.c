@@ -22,7 +22,18 @@
 #endif
 
 #include "fragments.h"
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
+
+#include <errno.h>
 #include <limits.h>
+#include <stdio.h>
+
+#define FRAGINDEX_MAGIC       "VLCMP4F1"
+#define FRAGINDEX_HEADER_SIZE (8 + 8 + 4 + 4 + 4 + 8)
+#define FRAGINDEX_MAX_ENTRIES (1 << 22)
+#define FRAGINDEX_MAX_TRACKS  256
 
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
 {
@@ -58,12 +69,19 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    /* first fragment at or after i_moof_pos */
+    size_t lo = 0, hi = p_index->i_entries;
+    while( lo < hi )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_index->pi_pos[mid] < i_moof_pos )
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    return 0;
+    if( lo == p_index->i_entries )
+        return 0;
+    return p_index->p_times[lo * p_index->i_tracks + i_track_index];
 }
 
 stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i )
@@ -78,19 +96,173 @@ bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_tim
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    /* first fragment starting after *pi_time, we want the one before */
+    size_t lo = 1, hi = p_index->i_entries;
+    while( lo < hi )
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_index->p_times[mid * p_index->i_tracks + i_track_index] > *pi_time )
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    *pi_time = p_index->p_times[(lo - 1) * p_index->i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[lo - 1];
+    return true;
+}
+
+char * MP4_Fragments_Index_GetCachePath( const char *psz_url )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return NULL;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_url, strlen( psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path;
+    if( !psz_hash ||
+        asprintf( &psz_path, "%s" DIR_SEP "mp4-index" DIR_SEP "%s.idx",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+
+    free( psz_hash );
+    free( psz_cachedir );
+    return psz_path;
+}
+
+mp4_fragments_index_t * MP4_Fragments_Index_Load( const char *psz_path, uint64_t i_size,
+                                                  uint32_t i_timescale, unsigned i_tracks )
+{
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    if( !p_file )
+        return NULL;
+
+    uint8_t header[FRAGINDEX_HEADER_SIZE];
+    if( fread( header, sizeof(header), 1, p_file ) != 1 ||
+        memcmp( header, FRAGINDEX_MAGIC, 8 ) ||
+        GetQWBE( &header[8] ) != i_size ||
+        GetDWBE( &header[16] ) != i_timescale ||
+        GetDWBE( &header[20] ) != i_tracks ||
+        i_tracks > FRAGINDEX_MAX_TRACKS )
+    {
+        fclose( p_file );
+        return NULL;
+    }
+
+    uint32_t i_entries = GetDWBE( &header[24] );
+    if( i_entries > FRAGINDEX_MAX_ENTRIES )
+    {
+        fclose( p_file );
+        return NULL;
+    }
+
+    mp4_fragments_index_t *p_index = MP4_Fragments_Index_New( i_tracks, i_entries );
+    if( !p_index )
+    {
+        fclose( p_file );
+        return NULL;
+    }
+    p_index->i_last_time = GetQWBE( &header[28] );
+
+    for( uint32_t i = 0; i < i_entries; i++ )
+    {
+        uint8_t entry[8 + 8 * FRAGINDEX_MAX_TRACKS];
+        if( fread( entry, 8 + 8 * i_tracks, 1, p_file ) != 1 )
+            goto error;
+        p_index->pi_pos[i] = GetQWBE( &entry[0] );
+        /* positions must be sorted for lookups */
+        if( p_index->pi_pos[i] >= i_size ||
+            ( i > 0 && p_index->pi_pos[i] <= p_index->pi_pos[i - 1] ) )
+            goto error;
+        for( unsigned j = 0; j < i_tracks; j++ )
+            p_index->p_times[(size_t)i * i_tracks + j] = GetQWBE( &entry[8 + 8 * j] );
+    }
+    fclose( p_file );
+    return p_index;
+
+error:
+    MP4_Fragments_Index_Delete( p_index );
+    fclose( p_file );
+    return NULL;
+}
+
+int MP4_Fragments_Index_Save( const mp4_fragments_index_t *p_index, const char *psz_path,
+                              uint64_t i_size, uint32_t i_timescale )
+{
+    if( p_index->i_entries == 0 || p_index->i_entries > FRAGINDEX_MAX_ENTRIES ||
+        p_index->i_tracks > FRAGINDEX_MAX_TRACKS )
+        return VLC_EGENERIC;
+
+    /* Create the mp4-index cache directory if needed */
+    const char *psz_sep = strrchr( psz_path, DIR_SEP_CHAR );
+    if( psz_sep )
+    {
+        char *psz_dir = strndup( psz_path, psz_sep - psz_path );
+        if( !psz_dir )
+            return VLC_ENOMEM;
+        const char *psz_parent = strrchr( psz_dir, DIR_SEP_CHAR );
+        if( psz_parent )
+        {
+            char *psz_cachedir = strndup( psz_dir, psz_parent - psz_dir );
+            if( psz_cachedir )
+                vlc_mkdir( psz_cachedir, 0700 );
+            free( psz_cachedir );
+        }
+        if( vlc_mkdir( psz_dir, 0700 ) && errno != EEXIST )
+        {
+            free( psz_dir );
+            return VLC_EGENERIC;
+        }
+        free( psz_dir );
+    }
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.part", psz_path ) == -1 )
+        return VLC_ENOMEM;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( !p_file )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+
+    bool b_error = false;
+    uint8_t header[FRAGINDEX_HEADER_SIZE];
+    memcpy( header, FRAGINDEX_MAGIC, 8 );
+    SetQWBE( &header[8], i_size );
+    SetDWBE( &header[16], i_timescale );
+    SetDWBE( &header[20], p_index->i_tracks );
+    SetDWBE( &header[24], p_index->i_entries );
+    SetQWBE( &header[28], p_index->i_last_time );
+    b_error |= fwrite( header, sizeof(header), 1, p_file ) != 1;
+
+    for( size_t i = 0; i < p_index->i_entries && !b_error; i++ )
+    {
+        uint8_t entry[8];
+        SetQWBE( entry, p_index->pi_pos[i] );
+        b_error |= fwrite( entry, sizeof(entry), 1, p_file ) != 1;
+        for( unsigned j = 0; j < p_index->i_tracks && !b_error; j++ )
         {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
+            SetQWBE( entry, p_index->p_times[i * p_index->i_tracks + j] );
+            b_error |= fwrite( entry, sizeof(entry), 1, p_file ) != 1;
         }
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
-    return true;
+    b_error |= fclose( p_file ) != 0;
+    if( b_error || vlc_rename( psz_tmp, psz_path ) )
+    {
+        vlc_unlink( psz_tmp );
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+    free( psz_tmp );
+    return VLC_SUCCESS;
 }
 
 #ifdef MP4_VERBOSE
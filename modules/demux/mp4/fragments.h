@@ -42,6 +42,13 @@ stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, uns
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
                                  stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
 
+/* Persistent index, keyed by url and validated against the file size */
+char * MP4_Fragments_Index_GetCachePath( const char *psz_url );
+mp4_fragments_index_t * MP4_Fragments_Index_Load( const char *psz_path, uint64_t i_size,
+                                                  uint32_t i_timescale, unsigned i_tracks );
+int MP4_Fragments_Index_Save( const mp4_fragments_index_t *p_index, const char *psz_path,
+                              uint64_t i_size, uint32_t i_timescale );
+
 #ifdef MP4_VERBOSE
 void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
                                 uint32_t i_movie_timescale );
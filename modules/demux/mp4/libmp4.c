@@ -42,6 +42,130 @@
  * The input method HAS to be seekable
  */
 
+/*****************************************************************************
+ * Box arena: boxes and their payload structures are bump allocated from
+ * blocks shared by a whole tree. Payload arrays referenced by the box
+ * specific free handlers still come from malloc.
+ * The arena counts its live boxes and goes away with the last one, so
+ * a fragment and all its children are freed at once.
+ *****************************************************************************/
+#define MP4_ARENA_BLOCK_SIZE (16 * 1024)
+
+typedef struct mp4_box_arena_block_t
+{
+    struct mp4_box_arena_block_t *p_next;
+    size_t i_size;
+    size_t i_used;
+    max_align_t p_data[];
+} mp4_box_arena_block_t;
+
+struct mp4_box_arena_t
+{
+    mp4_box_arena_block_t *p_blocks; /* first is the current one */
+    unsigned i_boxes;
+};
+
+static mp4_box_arena_t *mp4_arena_New( void )
+{
+    mp4_box_arena_t *p_arena = malloc( sizeof(*p_arena) );
+    if( likely(p_arena) )
+    {
+        p_arena->p_blocks = NULL;
+        p_arena->i_boxes = 0;
+    }
+    return p_arena;
+}
+
+static void mp4_arena_Delete( mp4_box_arena_t *p_arena )
+{
+    for( mp4_box_arena_block_t *p_block = p_arena->p_blocks; p_block; )
+    {
+        mp4_box_arena_block_t *p_next = p_block->p_next;
+        free( p_block );
+        p_block = p_next;
+    }
+    free( p_arena );
+}
+
+/* zeroed, max_align_t aligned */
+static void *mp4_arena_Alloc( mp4_box_arena_t *p_arena, size_t i_size )
+{
+    const size_t i_align = sizeof(max_align_t);
+    if( unlikely(i_size > SIZE_MAX / 2) )
+        return NULL;
+    i_size = (i_size + i_align - 1) & ~(i_align - 1);
+
+    mp4_box_arena_block_t *p_block = p_arena->p_blocks;
+    if( !p_block || p_block->i_size - p_block->i_used < i_size )
+    {
+        const size_t i_blocksize = __MAX( i_size, MP4_ARENA_BLOCK_SIZE );
+        mp4_box_arena_block_t *p_new = malloc( sizeof(*p_new) + i_blocksize );
+        if( unlikely(!p_new) )
+            return NULL;
+        p_new->i_size = i_blocksize;
+        p_new->i_used = 0;
+        if( p_block && i_size > MP4_ARENA_BLOCK_SIZE / 2 )
+        {
+            /* oversized, keep bumping into the current block */
+            p_new->p_next = p_block->p_next;
+            p_block->p_next = p_new;
+        }
+        else
+        {
+            p_new->p_next = p_block;
+            p_arena->p_blocks = p_new;
+        }
+        p_block = p_new;
+    }
+
+    void *p = (uint8_t *) p_block->p_data + p_block->i_used;
+    p_block->i_used += i_size;
+    memset( p, 0, i_size );
+    return p;
+}
+
+/* Allocates a zeroed box from its father arena, or the heap */
+static MP4_Box_t *MP4_BoxAlloc( MP4_Box_t *p_father )
+{
+    mp4_box_arena_t *p_arena = p_father ? p_father->p_arena : NULL;
+    MP4_Box_t *p_box;
+    if( p_arena )
+    {
+        p_box = mp4_arena_Alloc( p_arena, sizeof(*p_box) );
+        if( likely(p_box) )
+        {
+            p_box->p_arena = p_arena;
+            p_arena->i_boxes++;
+        }
+    }
+    else p_box = calloc( 1, sizeof(*p_box) );
+    return p_box;
+}
+
+/* Releases the box storage only */
+static void MP4_BoxRelease( MP4_Box_t *p_box )
+{
+    mp4_box_arena_t *p_arena = p_box->p_arena;
+    if( p_arena )
+    {
+        assert( p_arena->i_boxes > 0 );
+        if( --p_arena->i_boxes == 0 )
+            mp4_arena_Delete( p_arena );
+    }
+    else
+    {
+        free( p_box->data.p_payload );
+        free( p_box );
+    }
+}
+
+static void *MP4_BoxPayloadAlloc( MP4_Box_t *p_box, size_t i_size )
+{
+    if( p_box->p_arena )
+        return mp4_arena_Alloc( p_box->p_arena, i_size );
+    return calloc( 1, i_size );
+}
+
 /* convert 16.16 fixed point to floating point */
 static double conv_fx( int32_t fx ) {
     double fp = fx;
@@ -168,11 +292,10 @@ static uint8_t *mp4_readbox_enter_common( stream_t *s, MP4_Box_t *box,
         goto error;
     }
 
-    box->data.p_payload = malloc( typesize );
+    box->data.p_payload = MP4_BoxPayloadAlloc( box, typesize );
     if( unlikely(box->data.p_payload == NULL) )
         goto error;
 
-    memset( box->data.p_payload, 0, typesize );
     box->pf_free = release;
     return buf;
 error:
@@ -416,9 +539,10 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
     }
 
     /* Everything seems OK */
-    MP4_Box_t *p_box = (MP4_Box_t *) malloc( sizeof(MP4_Box_t) );
+    MP4_Box_t *p_box = MP4_BoxAlloc( p_father );
     if( !p_box )
         return NULL;
+    peekbox.p_arena = p_box->p_arena;
     *p_box = peekbox;
 
     const uint64_t i_next = p_box->i_pos + p_box->i_size;
@@ -3294,7 +3418,7 @@ static int MP4_ReadBox_cmov( stream_t *p_stream, MP4_Box_t *p_box )
     int i_result;
 #endif
 
-    if( !( p_box->data.p_cmov = calloc(1, sizeof( MP4_Box_data_cmov_t ) ) ) )
+    if( !( p_box->data.p_cmov = MP4_BoxPayloadAlloc( p_box, sizeof( MP4_Box_data_cmov_t ) ) ) )
         return 0;
 
     if( !p_box->p_father ||
@@ -5205,14 +5329,14 @@ static int MP4_Box_Read_Specific( stream_t *p_stream, MP4_Box_t *p_box, MP4_Box_
 
 static MP4_Box_t *MP4_ReadBoxAllocateCheck( stream_t *p_stream, MP4_Box_t *p_father )
 {
-    MP4_Box_t *p_box = calloc( 1, sizeof( MP4_Box_t ) ); /* Needed to ensure simple on error handler */
+    MP4_Box_t *p_box = MP4_BoxAlloc( p_father ); /* Needed to ensure simple on error handler */
     if( p_box == NULL )
         return NULL;
 
     if( !MP4_PeekBoxHeader( p_stream, p_box ) )
     {
         msg_Warn( p_stream, "cannot read one box" );
-        free( p_box );
+        MP4_BoxRelease( p_box );
         return NULL;
     }
 
@@ -5220,14 +5344,14 @@ static MP4_Box_t *MP4_ReadBoxAllocateCheck( stream_t *p_stream, MP4_Box_t *p_fat
         p_father->i_pos + p_father->i_size < p_box->i_pos + p_box->i_size )
     {
         msg_Dbg( p_stream, "out of bound child" );
-        free( p_box );
+        MP4_BoxRelease( p_box );
         return NULL;
     }
 
     if( !p_box->i_size )
     {
         msg_Dbg( p_stream, "found an empty box (null size)" );
-        free( p_box );
+        MP4_BoxRelease( p_box );
         return NULL;
     }
     p_box->p_father = p_father;
@@ -5288,6 +5412,24 @@ MP4_Box_t * MP4_BoxNew( uint32_t i_type )
     return p_box;
 }
 
+MP4_Box_t * MP4_BoxNewRoot( uint32_t i_type )
+{
+    mp4_box_arena_t *p_arena = mp4_arena_New();
+    if( unlikely( p_arena == NULL ) )
+        return NULL;
+
+    MP4_Box_t *p_box = mp4_arena_Alloc( p_arena, sizeof( MP4_Box_t ) );
+    if( unlikely( p_box == NULL ) )
+    {
+        mp4_arena_Delete( p_arena );
+        return NULL;
+    }
+    p_box->i_type = i_type;
+    p_box->p_arena = p_arena;
+    p_arena->i_boxes = 1;
+    return p_box;
+}
+
 /*****************************************************************************
  * MP4_FreeBox : free memory after read with MP4_ReadBox and all
  * the children
@@ -5311,8 +5453,7 @@ void MP4_BoxFree( MP4_Box_t *p_box )
     if( p_box->pf_free )
         p_box->pf_free( p_box );
 
-    free( p_box->data.p_payload );
-    free( p_box );
+    MP4_BoxRelease( p_box );
 }
 
 MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
@@ -5321,7 +5462,7 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
     MP4_Box_t *p_fakeroot;
     MP4_Box_t *p_tmp_box;
 
-    p_fakeroot = MP4_BoxNew( ATOM_root );
+    p_fakeroot = MP4_BoxNewRoot( ATOM_root );
     if( unlikely( p_fakeroot == NULL ) )
         return NULL;
     p_fakeroot->i_shortsize = 1;
@@ -5354,7 +5495,7 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
 {
     int i_result;
 
-    MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+    MP4_Box_t *p_vroot = MP4_BoxNewRoot( ATOM_root );
     if( p_vroot == NULL )
         return NULL;
 
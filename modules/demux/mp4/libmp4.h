@@ -1828,6 +1828,7 @@ typedef union MP4_Box_data_s
 #define BOXDATA(type) type->data.type
 
 typedef struct MP4_Box_s MP4_Box_t;
+typedef struct mp4_box_arena_t mp4_box_arena_t;
 /* the most basic structure */
 struct MP4_Box_s
 {
@@ -1854,6 +1855,7 @@ struct MP4_Box_s
     MP4_Box_t *p_next;   /* pointer on the next boxes at the same level */
 
     void (*pf_free)( MP4_Box_t *p_box ); /* pointer to free function for this box */
+    mp4_box_arena_t *p_arena; /* box and payload storage, NULL if malloc'ed */
 
     MP4_Box_data_t   data;   /* union of pointers on extended data depending
                                 on i_type (or i_usertype) */
@@ -1916,11 +1918,21 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t * );
  *****************************************************************************/
 MP4_Box_t * MP4_BoxNew( uint32_t i_type );
 
+/*****************************************************************************
+ * MP4_BoxNewRoot : Allocates a new MP4 Box owning an arena
+ *****************************************************************************
+ *  All boxes read below it are allocated from that arena, which is
+ *  released once the last of them is freed. Boxes can still be extracted
+ *  and freed individually.
+ *  returns NULL on failure
+ *****************************************************************************/
+MP4_Box_t * MP4_BoxNewRoot( uint32_t i_type );
+
 /*****************************************************************************
  * MP4_FreeBox : free memory allocated after read with MP4_ReadBox
  *               or MP4_BoxGetRoot, this means also children boxes
- * XXX : all children have to be allocated by a malloc !! and
- *         p_box is freed
+ * XXX : all children have to be allocated by a malloc or from an arena
+ *         !! and p_box is freed
  *****************************************************************************/
 void MP4_BoxFree( MP4_Box_t *p_box );
 
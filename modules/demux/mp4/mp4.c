@@ -35,8 +35,15 @@
 #include <vlc_plugin.h>
 #include <vlc_dialog.h>
 #include <vlc_url.h>
+#include <vlc_fs.h>
 #include <assert.h>
 #include <limits.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
 #include "../../codec/cc.h"
 #include "heif.h"
 #include "../av1_unpack.h"
@@ -52,6 +59,16 @@ static void Close( vlc_object_t * );
 #define MP4_M4A_TEXT     N_("M4A audio only")
 #define MP4_M4A_LONGTEXT N_("Ignore non audio tracks from iTunes audio files")
 
+#define MP4_MMAP_TEXT     N_("Map samples from local files")
+#define MP4_MMAP_LONGTEXT N_("Read large samples of local files through " \
+    "memory mapping instead of copying them. The file must not be " \
+    "truncated while playing.")
+
+#define MP4_FRAGINDEX_TEXT     N_("Keep fragments index")
+#define MP4_FRAGINDEX_LONGTEXT N_("Store the fragments index built when " \
+    "seeking in fragmented files without index in the cache directory, " \
+    "and reuse it when the same file is played again.")
+
 #define HEIF_DURATION_TEXT N_("Duration in seconds")
 #define HEIF_DURATION_LONGTEXT N_( \
     "Duration in seconds before simulating an end of file. " \
@@ -63,10 +80,13 @@ vlc_module_begin ()
     set_description( N_("MP4 stream demuxer") )
     set_shortname( N_("MP4") )
     set_capability( "demux", 240 )
+    set_probe_hints( "mp4,m4a,m4v,m4b,mov,qt,3gp,3g2,f4v,video/mp4,audio/mp4,video/quicktime" )
     set_callbacks( Open, Close )
 
     add_category_hint("Hacks", NULL)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT, true )
+    add_bool( CFG_PREFIX"mmap", false, MP4_MMAP_TEXT, MP4_MMAP_LONGTEXT, true )
+    add_bool( CFG_PREFIX"fragments-index", false, MP4_FRAGINDEX_TEXT, MP4_FRAGINDEX_LONGTEXT, true )
 
     add_submodule()
         set_category( CAT_INPUT )
@@ -74,6 +94,7 @@ vlc_module_begin ()
         set_description( N_("HEIF demuxer") )
         set_shortname( "heif" )
         set_capability( "demux", 239 )
+        set_probe_hints( "heic,heif,avif,image/heic,image/heif,image/avif" )
         set_callbacks( OpenHEIF, CloseHEIF )
         set_section( N_("HEIF demuxer"), NULL )
         add_float( "heif-image-duration", HEIF_DEFAULT_DURATION,
@@ -139,8 +160,25 @@ typedef struct
     } hacks;
 
     mp4_fragments_index_t *p_fragsindex;
+
+    /* zero copy reads from local files */
+    struct
+    {
+        int      fd;
+        uint64_t i_size;
+        size_t   i_pagesize;
+    } mmap;
+
+    /* memory shared by the tracks read windows, or 0 if disabled */
+    size_t i_read_window;
 } demux_sys_t;
 
+/* Below that, the mapping costs more than the copy */
+#define MP4_MMAP_MIN_SAMPLE (256 * 1024)
+
+/* Read windows memory cap, split between the selected tracks */
+#define MP4_READ_WINDOW (8 * 1024 * 1024)
+
 #define DEMUX_INCREMENT VLC_TICK_FROM_MS(250) /* How far the pcr will go, each round */
 #define DEMUX_TRACK_MAX_PRELOAD VLC_TICK_FROM_SEC(15) /* maximum preloading, to deal with interleaving */
 
@@ -342,6 +380,40 @@ static es_out_id_t * MP4_AddTrackES( es_out_t *out, mp4_track_t *p_track )
     return p_es;
 }
 
+static inline uint32_t MP4_ChunkEntryCount( const mp4_chunk_xtts_t *x,
+                                            const uint32_t *p_count, uint32_t i )
+{
+    if( i + 1 == x->i_entries )
+        return x->i_last;
+    if( i == 0 )
+        return x->i_first;
+    return p_count[x->i_index + i];
+}
+
+static inline uint32_t MP4_ChunkDTSCount( const mp4_track_t *p_track,
+                                          const mp4_chunk_t *ck, uint32_t i )
+{
+    return MP4_ChunkEntryCount( &ck->dts, p_track->p_stts_count, i );
+}
+
+static inline uint32_t MP4_ChunkDTSDelta( const mp4_track_t *p_track,
+                                          const mp4_chunk_t *ck, uint32_t i )
+{
+    return p_track->p_stts_delta[ck->dts.i_index + i];
+}
+
+static inline uint32_t MP4_ChunkPTSCount( const mp4_track_t *p_track,
+                                          const mp4_chunk_t *ck, uint32_t i )
+{
+    return MP4_ChunkEntryCount( &ck->pts, p_track->p_ctts_count, i );
+}
+
+static inline int32_t MP4_ChunkPTSOffset( const mp4_track_t *p_track,
+                                          const mp4_chunk_t *ck, uint32_t i )
+{
+    return p_track->p_ctts_offset[ck->pts.i_index + i] + p_track->i_cts_shift;
+}
+
 /* Return time in microsecond of a track */
 static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
 {
@@ -352,18 +424,18 @@ static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track
     unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
     int64_t sdts = p_chunk->i_first_dts;
 
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_sample > 0 && i_index < p_chunk->dts.i_entries )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        if( i_sample > MP4_ChunkDTSCount( p_track, p_chunk, i_index ) )
         {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
+            sdts += MP4_ChunkDTSCount( p_track, p_chunk, i_index ) *
+                MP4_ChunkDTSDelta( p_track, p_chunk, i_index );
+            i_sample -= MP4_ChunkDTSCount( p_track, p_chunk, i_index );
             i_index++;
         }
         else
         {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += i_sample * MP4_ChunkDTSDelta( p_track, p_chunk, i_index );
             break;
         }
     }
@@ -401,19 +473,19 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
     unsigned int i_index = 0;
     unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
 
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    if( p_track->p_ctts_count == NULL )
         return false;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
+    for( i_index = 0; i_index < ck->pts.i_entries ; i_index++ )
     {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
+        if( i_sample < MP4_ChunkPTSCount( p_track, ck, i_index ) )
         {
-            *pi_delta = MP4_rescale_mtime( ck->p_sample_offset_pts[i_index],
+            *pi_delta = MP4_rescale_mtime( MP4_ChunkPTSOffset( p_track, ck, i_index ),
                                            p_track->i_timescale );
             return true;
         }
 
-        i_sample -= ck->p_sample_count_pts[i_index];
+        i_sample -= MP4_ChunkPTSCount( p_track, ck, i_index );
     }
     return false;
 }
@@ -430,11 +502,11 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     unsigned i_index = 0;
     unsigned i_remain = 0;
     for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
+         i<p_track->i_sample && i_index < p_chunk->dts.i_entries; )
     {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
+        if( p_track->i_sample - i >= MP4_ChunkDTSCount( p_track, p_chunk, i_index ) )
         {
-            i += p_chunk->p_sample_count_dts[i_index];
+            i += MP4_ChunkDTSCount( p_track, p_chunk, i_index );
             i_index++;
         }
         else
@@ -445,19 +517,19 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     }
 
     /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_nb_samples > 0 && i_index < p_chunk->dts.i_entries )
     {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        if( i_nb_samples >= MP4_ChunkDTSCount( p_track, p_chunk, i_index ) - i_remain )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
+            i_duration += (MP4_ChunkDTSCount( p_track, p_chunk, i_index ) - i_remain) *
+                          (int64_t) MP4_ChunkDTSDelta( p_track, p_chunk, i_index );
+            i_nb_samples -= (MP4_ChunkDTSCount( p_track, p_chunk, i_index ) - i_remain);
             i_index++;
             i_remain = 0;
         }
         else
         {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
+            i_duration += i_nb_samples * MP4_ChunkDTSDelta( p_track, p_chunk, i_index );
             break;
         }
     }
@@ -737,6 +809,153 @@ void CloseHEIF( vlc_object_t * );
 /*****************************************************************************
  * Open: check file and initializes MP4 structures
  *****************************************************************************/
+static void MP4_MmapOpen( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->mmap.fd = -1;
+#ifdef HAVE_MMAP
+    if( !p_demux->psz_filepath || !p_sys->b_fastseekable ||
+        !var_InheritBool( p_demux, CFG_PREFIX"mmap" ) )
+        return;
+
+    int fd = vlc_open( p_demux->psz_filepath, O_RDONLY );
+    if( fd == -1 )
+        return;
+
+    /* Stream filters could have altered the content (tags skipping,
+     * decompression...), so only map if the stream is the file */
+    struct stat st;
+    uint64_t i_size;
+    uint8_t buf[16];
+    const uint8_t *p_peek;
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    if( fstat( fd, &st ) || !S_ISREG( st.st_mode ) ||
+        vlc_stream_GetSize( p_demux->s, &i_size ) ||
+        i_size != (uint64_t) st.st_size ||
+        vlc_stream_Peek( p_demux->s, &p_peek, sizeof(buf) ) < (ssize_t) sizeof(buf) ||
+        pread( fd, buf, sizeof(buf), i_pos ) != sizeof(buf) ||
+        memcmp( buf, p_peek, sizeof(buf) ) )
+    {
+        vlc_close( fd );
+        return;
+    }
+
+    p_sys->mmap.fd = fd;
+    p_sys->mmap.i_size = i_size;
+    p_sys->mmap.i_pagesize = sysconf( _SC_PAGESIZE );
+    msg_Dbg( p_demux, "using memory mapped sample reads" );
+#endif
+}
+
+static void MP4_MmapClose( demux_sys_t *p_sys )
+{
+    if( p_sys->mmap.fd != -1 )
+        vlc_close( p_sys->mmap.fd );
+}
+
+/* Reads a sample at the current stream position */
+static block_t * MP4_ReadSample( demux_t *p_demux, uint32_t i_size )
+{
+#ifdef HAVE_MMAP
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->mmap.fd != -1 && i_size >= MP4_MMAP_MIN_SAMPLE )
+    {
+        const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+        if( i_pos + i_size <= p_sys->mmap.i_size )
+        {
+            const uint64_t i_mapstart = i_pos & ~(uint64_t)(p_sys->mmap.i_pagesize - 1);
+            const size_t i_offset = i_pos - i_mapstart;
+
+            /* private and writable, as packetizers can rewrite in place */
+            uint8_t *p_map = mmap( NULL, i_offset + i_size, PROT_READ|PROT_WRITE,
+                                   MAP_PRIVATE, p_sys->mmap.fd, i_mapstart );
+            if( p_map != MAP_FAILED )
+            {
+                block_t *p_block = block_mmap_Alloc( p_map + i_offset, i_size );
+                if( p_block == NULL )
+                    return NULL;
+                if( vlc_stream_Seek( p_demux->s, i_pos + i_size ) != VLC_SUCCESS )
+                {
+                    block_Release( p_block );
+                    return NULL;
+                }
+                return p_block;
+            }
+        }
+    }
+#endif
+    return vlc_stream_Block( p_demux->s, i_size );
+}
+
+/* Copies a sample from any track read window, or returns NULL */
+static block_t * MP4_WindowReadSample( demux_sys_t *p_sys,
+                                       uint64_t i_pos, uint32_t i_size )
+{
+    for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+    {
+        const mp4_track_t *tk = &p_sys->track[i];
+        const block_t *p_window = tk->window.p_block;
+
+        if( p_window == NULL || i_pos < tk->window.i_pos ||
+            i_pos - tk->window.i_pos + i_size > p_window->i_buffer )
+            continue;
+
+        block_t *p_block = block_Alloc( i_size );
+        if( p_block )
+            memcpy( p_block->p_buffer,
+                    &p_window->p_buffer[i_pos - tk->window.i_pos], i_size );
+        return p_block;
+    }
+    return NULL;
+}
+
+static void MP4_TrackWindowRelease( mp4_track_t *tk )
+{
+    if( tk->window.p_block )
+    {
+        block_Release( tk->window.p_block );
+        tk->window.p_block = NULL;
+    }
+}
+
+/* Reads the track window at the current stream position, so that the
+ * following samples of the track are not read with one seek each */
+static bool MP4_TrackWindowFill( demux_t *p_demux, mp4_track_t *tk,
+                                 uint32_t i_size )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    unsigned i_selected = 0;
+
+    if( p_sys->i_read_window == 0 )
+        return false;
+
+    for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+        if( p_sys->track[i].b_ok && p_sys->track[i].b_selected )
+            i_selected++;
+
+    const size_t i_window = p_sys->i_read_window / __MAX(i_selected, 1);
+    if( i_size > i_window / 2 )
+        return false; /* not worth it, read directly */
+
+    MP4_TrackWindowRelease( tk );
+
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+    block_t *p_window = vlc_stream_Block( p_demux->s, i_window );
+    if( p_window == NULL || p_window->i_buffer < i_size )
+    {
+        if( p_window )
+            block_Release( p_window );
+        MP4_Seek( p_demux->s, i_pos );
+        return false;
+    }
+
+    tk->window.p_block = p_window;
+    tk->window.i_pos = i_pos;
+    return true;
+}
+
 static int Open( vlc_object_t * p_this )
 {
     demux_t  *p_demux = (demux_t *)p_this;
@@ -808,6 +1027,8 @@ static int Open( vlc_object_t * p_this )
 
     p_demux->p_sys = p_sys;
 
+    MP4_MmapOpen( p_demux );
+
     if( LoadInitFrag( p_demux ) != VLC_SUCCESS )
         goto error;
 
@@ -1144,6 +1365,9 @@ static int Open( vlc_object_t * p_this )
             msg_Warn( p_demux, "that media doesn't look interleaved, will need to seek");
         else if( i_max_continuity > DEMUX_TRACK_MAX_PRELOAD )
             msg_Warn( p_demux, "that media doesn't look properly interleaved, will need to seek");
+
+        if( b_flat || i_max_continuity > DEMUX_TRACK_MAX_PRELOAD )
+            p_sys->i_read_window = MP4_READ_WINDOW;
     }
 
     /* */
@@ -1365,7 +1589,11 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
             block_t *p_block;
             vlc_tick_t i_delta;
 
-            if( vlc_stream_Tell( p_demux->s ) != i_readpos )
+            i_samplessize = OverflowCheck( p_demux, tk, i_readpos, i_samplessize );
+
+            p_block = MP4_WindowReadSample( p_sys, i_readpos, i_samplessize );
+
+            if( p_block == NULL && vlc_stream_Tell( p_demux->s ) != i_readpos )
             {
                 if( MP4_Seek( p_demux->s, i_readpos ) != VLC_SUCCESS )
                 {
@@ -1375,12 +1603,16 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
                     MP4_TrackSelect( p_demux, tk, false );
                     goto end;
                 }
-            }
 
-            i_samplessize = OverflowCheck( p_demux, tk, i_readpos, i_samplessize );
+                /* turn the next reads of this track into a sequential one */
+                if( MP4_TrackWindowFill( p_demux, tk, i_samplessize ) )
+                    p_block = MP4_WindowReadSample( p_sys, i_readpos,
+                                                    i_samplessize );
+            }
 
             /* now read pes */
-            if( !(p_block = vlc_stream_Block( p_demux->s, i_samplessize )) )
+            if( p_block == NULL &&
+               !(p_block = MP4_ReadSample( p_demux, i_samplessize )) )
             {
                 msg_Warn( p_demux, "track[0x%x] will be disabled (eof?)"
                                    ": Failed to read %d bytes sample at %"PRIu64,
@@ -2298,6 +2530,8 @@ static void Close ( vlc_object_t * p_this )
 
     MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
 
+    MP4_MmapClose( p_sys );
+
     for( i_track = 0; i_track < p_sys->i_tracks; i_track++ )
         MP4_TrackClean( p_demux->out, &p_sys->track[i_track] );
     free( p_sys->track );
@@ -2484,12 +2718,8 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
+        ck->dts.i_entries = 0;
+        ck->pts.i_entries = 0;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2599,6 +2829,55 @@ static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
     return VLC_SUCCESS;
 }
 
+/* Computes the range of the xtts table covering a chunk's samples,
+ * and moves the table position to the next chunk */
+static int xTTS_IndexChunk( demux_t *p_demux, mp4_chunk_xtts_t *p_xtts,
+                            uint32_t *pi_index, uint32_t *pi_index_samples_left,
+                            uint32_t i_sample_count,
+                            const uint32_t *pi_index_sample_count,
+                            uint32_t i_index_samples_count )
+{
+    p_xtts->i_entries = 0;
+    p_xtts->i_first = 0;
+    p_xtts->i_last = 0;
+
+    int i_ret = xTTS_CountEntries( p_demux, &p_xtts->i_entries, *pi_index,
+                                   *pi_index_samples_left, i_sample_count,
+                                   pi_index_sample_count, i_index_samples_count );
+    if( i_ret != VLC_SUCCESS )
+        return i_ret;
+
+    p_xtts->i_index = *pi_index;
+
+    for( uint32_t i = 0; i < p_xtts->i_entries; i++ )
+    {
+        const uint32_t i_available = *pi_index_samples_left
+                                   ? *pi_index_samples_left
+                                   : pi_index_sample_count[*pi_index];
+        uint32_t i_count;
+        if( i_available > i_sample_count )
+        {
+            /* chunk ends within this entry, keep building from it */
+            i_count = i_sample_count;
+            *pi_index_samples_left = i_available - i_sample_count;
+            i_sample_count = 0;
+        }
+        else
+        {
+            i_count = i_available;
+            i_sample_count -= i_available;
+            *pi_index_samples_left = 0;
+            *pi_index += 1;
+        }
+
+        if( i == 0 )
+            p_xtts->i_first = i_count;
+        p_xtts->i_last = i_count;
+    }
+
+    return VLC_SUCCESS;
+}
+
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2636,18 +2915,11 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, use the box table */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
+        if( p_demux_track->p_sample_size == NULL && p_demux_track->i_sample_count )
+            return VLC_EGENERIC;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2661,13 +2933,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
 
     /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     * The box table is not expanded: each chunk only references the
+     * range of entries covering its samples, so memory stays bounded
+     * even with one chunk per sample */
 
     int64_t i_next_dts = 0;
     /* Find stts
@@ -2685,6 +2953,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
+        p_demux_track->p_stts_count = stts->pi_sample_count;
+        p_demux_track->p_stts_delta = stts->pi_sample_delta;
+
         /* Create sample -> dts table per chunk */
         uint32_t i_index = 0;
         uint32_t i_current_index_samples_left = 0;
@@ -2692,89 +2963,22 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
+            int i_ret = xTTS_IndexChunk( p_demux, &ck->dts, &i_index,
+                                         &i_current_index_samples_left,
+                                         ck->i_sample_count,
+                                         stts->pi_sample_count,
+                                         stts->i_entry_count );
+            if ( i_ret != VLC_SUCCESS )
                 return i_ret;
 
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            for( uint32_t i = 0; i < ck->dts.i_entries; i++ )
+                i_next_dts += (int64_t) MP4_ChunkDTSCount( p_demux_track, ck, i ) *
+                                        MP4_ChunkDTSDelta( p_demux_track, ck, i );
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
     }
 
@@ -2789,10 +2993,10 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
+        p_demux_track->i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
 
         /* Create pts-dts table per chunk */
         uint32_t i_index = 0;
@@ -2801,79 +3005,18 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
 
-
-            }
+            int i_ret = xTTS_IndexChunk( p_demux, &ck->pts, &i_index,
+                                         &i_current_index_samples_left,
+                                         ck->i_sample_count,
+                                         ctts->pi_sample_count,
+                                         ctts->i_entry_count );
+            if ( i_ret != VLC_SUCCESS )
+                return i_ret;
         }
+
+        p_demux_track->p_ctts_count = ctts->pi_sample_count;
+        p_demux_track->p_ctts_offset = ctts->pi_sample_offset;
     }
 
     msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
@@ -3197,28 +3340,28 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     i_dts    = p_track->chunk[i_chunk].i_first_dts;
 
     for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
+         i_index < p_track->chunk[i_chunk].dts.i_entries &&
          i_sample < p_track->chunk[i_chunk].i_sample_count;
          i_index++ )
     {
         if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+            MP4_ChunkDTSCount( p_track, &p_track->chunk[i_chunk], i_index ) *
+            MP4_ChunkDTSDelta( p_track, &p_track->chunk[i_chunk], i_index ) < (uint64_t)i_start )
         {
             i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+                MP4_ChunkDTSCount( p_track, &p_track->chunk[i_chunk], i_index ) *
+                MP4_ChunkDTSDelta( p_track, &p_track->chunk[i_chunk], i_index );
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            i_sample += MP4_ChunkDTSCount( p_track, &p_track->chunk[i_chunk], i_index );
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+            if( MP4_ChunkDTSDelta( p_track, &p_track->chunk[i_chunk], i_index ) <= 0 )
             {
                 break;
             }
             i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+                MP4_ChunkDTSDelta( p_track, &p_track->chunk[i_chunk], i_index );
             break;
         }
     }
@@ -3639,15 +3782,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3660,15 +3794,9 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
+    MP4_TrackWindowRelease( p_track );
 
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
@@ -3701,6 +3829,9 @@ static void MP4_TrackSelect( demux_t *p_demux, mp4_track_t *p_track, bool b_sele
                         p_track->p_es, false );
     }
 
+    if( !b_select )
+        MP4_TrackWindowRelease( p_track );
+
     p_track->b_selected = b_select;
 }
 
@@ -4290,89 +4421,154 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
-static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+static char * GetFragmentsIndexPath( demux_t *p_demux, uint64_t *pi_size )
+{
+    if( !p_demux->psz_url ||
+        !var_InheritBool( p_demux, CFG_PREFIX"fragments-index" ) ||
+        vlc_stream_GetSize( p_demux->s, pi_size ) != VLC_SUCCESS || *pi_size == 0 )
+        return NULL;
+    return MP4_Fragments_Index_GetCachePath( p_demux->psz_url );
+}
+
+static int LoadFragmentsIndex( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size;
 
-    msg_Dbg( p_demux, "probing fragments from %"PRId64, vlc_stream_Tell( p_demux->s ) );
+    if( p_sys->p_fragsindex )
+        return VLC_SUCCESS;
 
-    assert( p_sys->p_root );
+    char *psz_path = GetFragmentsIndexPath( p_demux, &i_size );
+    if( !psz_path )
+        return VLC_EGENERIC;
 
-    MP4_Box_t *p_vroot = MP4_BoxNew(ATOM_root);
-    if( !p_vroot )
+    p_sys->p_fragsindex = MP4_Fragments_Index_Load( psz_path, i_size, p_sys->i_timescale,
+                                                    p_sys->i_tracks );
+    free( psz_path );
+    if( !p_sys->p_fragsindex )
         return VLC_EGENERIC;
 
-    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    msg_Dbg( p_demux, "loaded fragments index with %u entries",
+             p_sys->p_fragsindex->i_entries );
+    return VLC_SUCCESS;
+}
+
+static void SaveFragmentsIndex( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size;
+
+    char *psz_path = GetFragmentsIndexPath( p_demux, &i_size );
+    if( !psz_path )
+        return;
+
+    if( MP4_Fragments_Index_Save( p_sys->p_fragsindex, psz_path,
+                                  i_size, p_sys->i_timescale ) != VLC_SUCCESS )
+        msg_Warn( p_demux, "can't store fragments index to %s", psz_path );
+    free( psz_path );
+}
+
+static int BuildFragmentsIndex( demux_t *p_demux, MP4_Box_t *p_vroot, unsigned i_moof )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
+    if( !p_sys->p_fragsindex )
+        return VLC_EGENERIC;
+
+    stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+    if( !pi_track_times )
     {
-        MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
-        p_sys->b_fragments_probed = true;
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = NULL;
+        return VLC_EGENERIC;
+    }
+
+    unsigned index = 0;
 
-        const unsigned i_moof = MP4_BoxCount( p_vroot, "/moof" );
-        if( i_moof )
+    for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
+    {
+        if( p_moof->i_type != ATOM_moof )
+            continue;
+
+        for( unsigned i=0; i<p_sys->i_tracks; i++ )
         {
-            *pb_fragmented = true;
-            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
-            if( !p_sys->p_fragsindex )
+            MP4_Box_t *p_tfdt = NULL;
+            MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+            if( p_traf )
+                p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+
+            if( p_tfdt && BOXDATA(p_tfdt) )
             {
-                MP4_BoxFree( p_vroot );
-                return VLC_EGENERIC;
+                pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
             }
-
-            stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
-            if( !pi_track_times )
+            else if( index == 0 ) /* Set first fragment time offset from moov */
             {
-                MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
-                p_sys->p_fragsindex = NULL;
-                MP4_BoxFree( p_vroot );
-                return VLC_EGENERIC;
+                stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+                pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
             }
 
-            unsigned index = 0;
+            stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+            p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
 
-            for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
-            {
-                if( p_moof->i_type != ATOM_moof )
-                    continue;
+            stime_t i_duration = 0;
+            if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+                pi_track_times[i] += i_duration;
+        }
 
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+        p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
+    }
 
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+        if( p_sys->p_fragsindex->i_last_time < i_movietime )
+            p_sys->p_fragsindex->i_last_time = i_movietime;
+    }
 
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
+    free( pi_track_times );
+#ifdef MP4_VERBOSE
+    MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+#endif
+    return VLC_SUCCESS;
+}
 
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
+static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
-            }
+    msg_Dbg( p_demux, "probing fragments from %"PRId64, vlc_stream_Tell( p_demux->s ) );
+
+    assert( p_sys->p_root );
+
+    MP4_Box_t *p_vroot = MP4_BoxNewRoot(ATOM_root);
+    if( !p_vroot )
+        return VLC_EGENERIC;
 
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    {
+        p_sys->b_fragments_probed = true;
+
+        /* A stored index spares reading the whole file again */
+        if( LoadFragmentsIndex( p_demux ) == VLC_SUCCESS )
+        {
+            *pb_fragmented = true;
+        }
+        else
+        {
+            MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
+
+            const unsigned i_moof = MP4_BoxCount( p_vroot, "/moof" );
+            if( i_moof )
             {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                *pb_fragmented = true;
+                if( BuildFragmentsIndex( p_demux, p_vroot, i_moof ) != VLC_SUCCESS )
+                {
+                    MP4_BoxFree( p_vroot );
+                    return VLC_EGENERIC;
+                }
+                SaveFragmentsIndex( p_demux );
             }
-
-            free( pi_track_times );
-#ifdef MP4_VERBOSE
-            MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
-#endif
         }
     }
     else
@@ -4405,7 +4601,7 @@ static int ProbeFragmentsChecked( demux_t *p_demux )
     if( p_sys->b_fragments_probed )
         return VLC_SUCCESS;
 
-    if( !p_sys->b_fastseekable )
+    if( !p_sys->b_fastseekable && LoadFragmentsIndex( p_demux ) != VLC_SUCCESS )
     {
         const char *psz_msg = _(
             "Because this file index is broken or missing, "
@@ -4517,7 +4713,7 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
 
         len = OverflowCheck( p_demux, p_track, vlc_stream_Tell(p_demux->s), len );
 
-        block_t *p_block = vlc_stream_Block( p_demux->s, len );
+        block_t *p_block = MP4_ReadSample( p_demux, len );
         uint32_t i_read = ( p_block ) ? p_block->i_buffer : 0;
         p_track->context.i_trun_sample_pos += i_read;
         if( i_read < len || p_block == NULL )
@@ -31,6 +31,17 @@
 #include "../asf/asfpacket.h"
 
 /* Contain all information about a chunk */
+/* Range of a stts/ctts table covered by a chunk. Entries are looked up
+ * in the box tables, only the partially covered first and last ones
+ * need their count stored */
+typedef struct
+{
+    uint32_t     i_entries; /* number of table entries for this chunk */
+    uint32_t     i_index;   /* first table entry */
+    uint32_t     i_first;   /* samples count from the first entry */
+    uint32_t     i_last;    /* samples count from the last entry */
+} mp4_chunk_xtts_t;
+
 typedef struct
 {
     uint64_t     i_offset; /* absolute position of this chunk in the file */
@@ -47,17 +58,8 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    mp4_chunk_xtts_t dts; /* stts */
+    mp4_chunk_xtts_t pts; /* ctts */
 
 } mp4_chunk_t;
 
@@ -129,8 +131,14 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz table */
+
+    /* timing tables, owned by the stts/ctts boxes */
+    const uint32_t   *p_stts_count;
+    const int32_t    *p_stts_delta;
+    const uint32_t   *p_ctts_count;  /* NULL if no ctts */
+    const int32_t    *p_ctts_offset;
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -182,6 +190,14 @@ typedef struct
     vlc_tick_t       i_dts_backup;
     vlc_tick_t       i_pts_backup;
     asf_track_info_t asfinfo;
+
+    /* Contiguous file data read ahead of the track samples, for badly
+     * interleaved files on slow seeking streams */
+    struct
+    {
+        block_t  *p_block;
+        uint64_t  i_pos; /* file offset of p_block->p_buffer */
+    } window;
 } mp4_track_t;
 
 int SetupVideoES( demux_t *p_demux, mp4_track_t *p_track, MP4_Box_t *p_sample );
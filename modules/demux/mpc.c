@@ -55,6 +55,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("MusePack demuxer") )
     set_capability( "demux", 145 )
+    set_probe_hints( "mpc,mp+,mpp" )
 
     set_callbacks( Open, Close )
     add_shortcut( "mpc" )
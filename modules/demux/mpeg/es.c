@@ -59,6 +59,7 @@ vlc_module_begin ()
     set_description( N_("MPEG-I/II/4 / A52 / DTS / MLP audio" ) )
     set_shortname( N_("Audio ES") )
     set_capability( "demux", 155 )
+    set_probe_hints( "mp1,mp2,mp3,mpa,mpga,aac,adts,ac3,a52,eac3,dts,mlp,thd,audio/mpeg,audio/aac,audio/ac3" )
     set_callbacks( OpenAudio, Close )
 
     add_shortcut( "mpga", "mp3",
@@ -163,6 +164,8 @@ typedef struct
         int i_bytes;
         int i_bitrate_avg;
         int i_frame_samples;
+        uint8_t rgi_toc[100];
+        bool b_toc;
         lame_extra_t lame;
         bool b_lame;
     } xing;
@@ -427,6 +430,31 @@ static void Close( vlc_object_t * p_this )
 /*****************************************************************************
  * Time seek:
  *****************************************************************************/
+static vlc_tick_t MpgaXingGetLength( const demux_sys_t *p_sys )
+{
+    const unsigned i_rate = p_sys->p_packetizer->fmt_out.audio.i_rate;
+    if( p_sys->xing.i_frames <= 0 || p_sys->xing.i_frame_samples <= 0 || i_rate == 0 )
+        return 0;
+    return vlc_tick_from_samples( (int64_t) p_sys->xing.i_frames *
+                                  p_sys->xing.i_frame_samples, i_rate );
+}
+
+/* Interpolates the byte position from the Xing TOC, which stores
+ * for each percent of the duration the position in 1/256 of the size */
+static uint64_t MpgaXingSeekByToc( const demux_sys_t *p_sys,
+                                   vlc_tick_t i_time, vlc_tick_t i_length )
+{
+    double f_percent = 100.0 * i_time / i_length;
+    f_percent = VLC_CLIP( f_percent, 0.0, 100.0 );
+
+    unsigned i_index = __MIN( (unsigned) f_percent, 99 );
+    double fa = p_sys->xing.rgi_toc[i_index];
+    double fb = i_index < 99 ? p_sys->xing.rgi_toc[i_index + 1] : 256.0;
+    double fx = fa + (fb - fa) * (f_percent - i_index);
+
+    return fx / 256.0 * p_sys->xing.i_bytes;
+}
+
 static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
 {
     demux_sys_t *p_sys  = p_demux->p_sys;
@@ -500,6 +528,16 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 uint64_t i_pos = SeekByMlltTable( p_demux, &i_time );
                 return MovetoTimePos( p_demux, i_time, i_pos );
             }
+            if( p_sys->xing.b_toc && p_sys->xing.i_bytes > 0 )
+            {
+                vlc_tick_t i_length = MpgaXingGetLength( p_sys );
+                if( i_length > 0 )
+                {
+                    vlc_tick_t i_time = va_arg(args, vlc_tick_t);
+                    uint64_t i_pos = MpgaXingSeekByToc( p_sys, i_time, i_length );
+                    return MovetoTimePos( p_demux, i_time, i_pos );
+                }
+            }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
@@ -1173,7 +1211,23 @@ static int MpgaInit( demux_t *p_demux )
     if( !MpgaCheckSync( p_peek ) )
         return VLC_SUCCESS;
 
-    /* Xing header */
+    /* VBRI header, always located 32 bytes after the frame header */
+    if( i_peek >= 36 + 18 && !memcmp( &p_peek[36], "VBRI", 4 ) )
+    {
+        p_sys->xing.i_bytes = GetDWBE( &p_peek[36 + 10] );
+        p_sys->xing.i_frames = GetDWBE( &p_peek[36 + 14] );
+        if( p_sys->xing.i_frames > 0 && p_sys->xing.i_bytes > 0 )
+        {
+            p_sys->xing.i_frame_samples = MpgaGetFrameSamples( header );
+            msg_Dbg( p_demux, "vbri frames&bytes value present "
+                     "(%d bytes, %d frames, %d samples/frame)",
+                     p_sys->xing.i_bytes, p_sys->xing.i_frames,
+                     p_sys->xing.i_frame_samples );
+        }
+        return VLC_SUCCESS;
+    }
+
+    /* Xing header, or Info for CBR */
     const uint8_t *p_xing = p_peek;
     int i_xing = i_peek;
     int i_skip;
@@ -1183,7 +1237,8 @@ static int MpgaInit( demux_t *p_demux )
     else
         i_skip = MPGA_MODE( header ) != 3 ? 21 : 13;
 
-    if( i_skip + 8 >= i_xing || memcmp( &p_xing[i_skip], "Xing", 4 ) )
+    if( i_skip + 8 >= i_xing || ( memcmp( &p_xing[i_skip], "Xing", 4 ) &&
+                                  memcmp( &p_xing[i_skip], "Info", 4 ) ) )
         return VLC_SUCCESS;
 
     const uint32_t i_flags = GetDWBE( &p_xing[i_skip+4] );
@@ -1194,8 +1249,15 @@ static int MpgaInit( demux_t *p_demux )
         p_sys->xing.i_frames = MpgaXingGetDWBE( &p_xing, &i_xing, 0 );
     if( i_flags&0x02 )
         p_sys->xing.i_bytes = MpgaXingGetDWBE( &p_xing, &i_xing, 0 );
-    if( i_flags&0x04 ) /* TODO Support XING TOC to improve seeking accuracy */
+    if( i_flags&0x04 )
+    {
+        if( i_xing >= 100 )
+        {
+            memcpy( p_sys->xing.rgi_toc, p_xing, 100 );
+            p_sys->xing.b_toc = true;
+        }
         MpgaXingSkip( &p_xing, &i_xing, 100 );
+    }
     if( i_flags&0x08 )
     {
         /* FIXME: doesn't return the right bitrage average, at least
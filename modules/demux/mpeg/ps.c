@@ -73,6 +73,7 @@ vlc_module_begin ()
     add_submodule ()
     set_description( N_("MPEG-PS demuxer") )
     set_capability( "demux", 8 )
+    set_probe_hints( "mpg,mpeg,vob,vro,evo,video/mpeg,video/mp2p" )
     set_callbacks( Open, Close )
     add_shortcut( "ps" )
 vlc_module_end ()
@@ -353,7 +354,8 @@ static bool FindLength( demux_t *p_demux )
 
         /* Check end */
         i_size = stream_Size( p_demux->s );
-        i_end = VLC_CLIP( i_size, 0, 200000 );
+        /* Preparsing only needs a few timestamps, keep the read small */
+        i_end = VLC_CLIP( i_size, 0, p_demux->b_preparsing ? 65536 : 200000 );
         if( vlc_stream_Seek( p_demux->s, i_size - i_end ) == VLC_SUCCESS )
         {
             i = 0;
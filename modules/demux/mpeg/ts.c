@@ -45,6 +45,7 @@
 #include "ts_hotfixes.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
+#include "ts_fanout.h"
 #include "sections.h"
 #include "pes.h"
 #include "timestamps.h"
@@ -118,6 +119,23 @@ static void Close ( vlc_object_t * );
 #define TS_SKIP_GHOST_PROGRAM_TEXT "Only create ES on program sending data"
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 
+#define SEEK_INDEX_TEXT N_("Keep a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Record PCR to byte offset points while playing seekable files and " \
+    "store them in the cache directory, for faster seeking on next opens." )
+
+#define EPG_SELECTED_TEXT N_("Only decode EPG of the selected programs")
+#define EPG_SELECTED_LONGTEXT N_( \
+    "Ignore the event information tables of the programs not being played. " \
+    "This saves processing on transponders carrying many services, but " \
+    "the program guide of the other services is not available." )
+
+#define FANOUT_TEXT N_("Per program outputs")
+#define FANOUT_LONGTEXT N_( \
+    "Write the packets of programs to separate transport streams, while " \
+    "demuxing, as <program>{dst=<path>[,access=<access>]}[:...]. " \
+    "This allows recording several services of a multiplex at once." )
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -155,7 +173,11 @@ vlc_module_begin ()
 
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
+    add_bool( "ts-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT, true )
     add_bool( "ts-cc-check", true, CC_CHECK_TEXT, CC_CHECK_LONGTEXT, true )
+    add_bool( "ts-epg-selected", false, EPG_SELECTED_TEXT,
+              EPG_SELECTED_LONGTEXT, true )
+    add_string( "ts-fanout", NULL, FANOUT_TEXT, FANOUT_LONGTEXT, true )
     add_bool( "ts-pmtfix-waitdata", true, TS_SKIP_GHOST_PROGRAM_TEXT, NULL, true )
     add_bool( "ts-patfix", true, TS_PATFIX_TEXT, NULL, true )
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL, true )
@@ -163,6 +185,7 @@ vlc_module_begin ()
     add_obsolete_bool( "ts-silent" );
 
     set_capability( "demux", 10 )
+    set_probe_hints( "ts,m2t,m2ts,mts,tp,trp,video/mp2t" )
     set_callbacks( Open, Close )
     add_shortcut( "ts" )
 vlc_module_end ()
@@ -192,6 +215,7 @@ static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void ReadAheadTSPackets( demux_t *p_demux, unsigned i_max );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -206,6 +230,9 @@ static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 #define PROBE_CHUNK_COUNT 500
 #define PROBE_MAX         (PROBE_CHUNK_COUNT * 10)
 
+/* Max packets pulled at once from the stream by the demux loop */
+#define TS_READAHEAD_MAX  32
+
 #define BLOCK_FLAG_SOURCE_RANDOM_ACCESS (1 << BLOCK_FLAG_PRIVATE_SHIFT)
 #define GENERATED_PCR_DPB_OFFSET VLC_TICK_FROM_MS(120)
 
@@ -403,6 +430,12 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->readahead.p_head = NULL;
+    p_sys->readahead.pp_last = &p_sys->readahead.p_head;
+    p_sys->readahead.i_count = 0;
+    ts_seekindex_Init( &p_sys->seekindex.index, TO_SCALE_NZ(VLC_TICK_FROM_SEC(1)) );
+    p_sys->seekindex.psz_path = NULL;
+    p_sys->seekindex.i_size = 0;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -438,6 +471,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_es_id_pid = var_CreateGetBool( p_demux, "ts-es-id-pid" );
     p_sys->i_next_extraid = 1;
 
+    char *psz_fanout = var_InheritString( p_demux, "ts-fanout" );
+    p_sys->fanout = ts_fanout_New( p_demux, psz_fanout );
+    free( psz_fanout );
+
     p_sys->b_trust_pcr = var_CreateGetBool( p_demux, "ts-trust-pcr" );
     p_sys->b_check_pcr_offset = p_sys->b_trust_pcr && var_CreateGetBool(p_demux, "ts-pcr-offsetfix" );
 
@@ -501,6 +538,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_canfastseek = false;
     p_sys->b_ignore_time_for_positions = var_InheritBool( p_demux, "ts-seek-percent" );
     p_sys->b_cc_check = var_InheritBool( p_demux, "ts-cc-check" );
+    p_sys->b_epg_selected_only = var_InheritBool( p_demux, "ts-epg-selected" );
 
     p_sys->standard = TS_STANDARD_AUTO;
     char *psz_standard = var_InheritString( p_demux, "ts-standard" );
@@ -529,6 +567,22 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    if( p_sys->b_canseek && !p_sys->b_access_control && p_demux->psz_url &&
+        var_InheritBool( p_demux, "ts-seek-index" ) )
+    {
+        int64_t i_size = stream_Size( p_sys->stream );
+        if( i_size > 0 )
+        {
+            p_sys->seekindex.i_size = i_size;
+            p_sys->seekindex.psz_path = ts_seekindex_GetCachePath( p_demux->psz_url );
+        }
+        if( p_sys->seekindex.psz_path &&
+            ts_seekindex_Load( &p_sys->seekindex.index, p_sys->seekindex.psz_path,
+                               p_sys->seekindex.i_size, p_sys->i_packet_size ) == VLC_SUCCESS )
+            msg_Dbg( p_demux, "loaded %zu seek index points for program %d",
+                     p_sys->seekindex.index.i_count, p_sys->seekindex.index.i_program );
+    }
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
@@ -561,6 +615,9 @@ static void Close( vlc_object_t *p_this )
 
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
+    if( p_sys->fanout )
+        ts_fanout_Delete( p_sys->fanout );
+
     vlc_mutex_lock( &p_sys->csa_lock );
     if( p_sys->csa )
     {
@@ -572,6 +629,18 @@ static void Close( vlc_object_t *p_this )
 
     ARRAY_RESET( p_sys->programs );
 
+    block_ChainRelease( p_sys->readahead.p_head );
+
+    if( p_sys->seekindex.psz_path )
+    {
+        if( p_sys->seekindex.index.b_dirty &&
+            ts_seekindex_Save( &p_sys->seekindex.index, p_sys->seekindex.psz_path,
+                               p_sys->seekindex.i_size, p_sys->i_packet_size ) )
+            msg_Warn( p_demux, "can't save seek index to %s", p_sys->seekindex.psz_path );
+        free( p_sys->seekindex.psz_path );
+    }
+    ts_seekindex_Clean( &p_sys->seekindex.index );
+
 #ifdef HAVE_ARIBB24
     if ( p_sys->arib.p_instance )
         arib_instance_destroy( p_sys->arib.p_instance );
@@ -638,6 +707,8 @@ static int Demux( demux_t *p_demux )
         bool         b_frame = false;
         int          i_header = 0;
         block_t     *p_pkt;
+        if( p_sys->readahead.i_count == 0 )
+            ReadAheadTSPackets( p_demux, p_sys->i_ts_read - i_pkt );
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
             return VLC_DEMUXER_EOF;
@@ -678,6 +749,10 @@ static int Demux( demux_t *p_demux )
                 p_sys->b_valid_scrambling = true;
         }
 
+        /* Pass the raw packet to the per program outputs */
+        if( p_sys->fanout && (p_pid->i_fanout || p_pid->type == TYPE_PAT) )
+            ts_fanout_Packet( p_sys->fanout, p_pid, p_pkt->p_buffer );
+
         /* Drop duplicates and invalid (DOES NOT drop corrupted) */
         p_pkt = ProcessTSPacket( p_demux, p_pid, p_pkt, &i_header );
         if( !p_pkt )
@@ -827,9 +902,14 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
         ts_pmt_t *p_pmt = p_pmt_pid->u.p_pmt;
 
         p_pmt_pid->i_flags &= ~FLAG_FILTERED;
+        p_pmt_pid->i_fanout = 0;
         for( int j=0; j< p_pmt->e_streams.i_size; j++ )
+        {
             p_pmt->e_streams.p_elems[j]->i_flags &= ~FLAG_FILTERED;
+            p_pmt->e_streams.p_elems[j]->i_fanout = 0;
+        }
         GetPID(p_sys, p_pmt->i_pid_pcr)->i_flags &= ~FLAG_FILTERED;
+        GetPID(p_sys, p_pmt->i_pid_pcr)->i_fanout = 0;
     }
 
     /* set selection flag on selected pmt referenced pid with active es */
@@ -843,6 +923,19 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
         else
              p_pmt->b_selected = ProgramIsSelected( p_sys, p_pmt->i_number );
 
+        /* fanned out programs always receive all their pids */
+        const uint32_t i_fanout = ts_fanout_ProgramMask( p_sys->fanout,
+                                                         p_pmt->i_number );
+        if( i_fanout )
+        {
+            ts_fanout_SetPMTPID( p_sys->fanout, p_pmt->i_number, p_pmt_pid->i_pid );
+            p_pmt_pid->i_fanout |= i_fanout;
+            for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+                p_pmt->e_streams.p_elems[j]->i_fanout |= i_fanout;
+            if( p_pmt->i_pid_pcr > 0 )
+                GetPID(p_sys, p_pmt->i_pid_pcr)->i_fanout |= i_fanout;
+        }
+
         if( p_pmt->b_selected )
         {
             p_pmt_pid->i_flags |= FLAG_FILTERED;
@@ -953,7 +1046,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TsStreamTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1000,7 +1093,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            TsStreamSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1793,20 +1886,119 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
     return b_ret;
 }
 
+uint64_t TsStreamTell( demux_sys_t *p_sys )
+{
+    /* Read ahead packets are still ahead of the demuxer position */
+    return vlc_stream_Tell( p_sys->stream ) -
+           (uint64_t) p_sys->readahead.i_count * p_sys->i_packet_size;
+}
+
+int TsStreamSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    int i_ret = vlc_stream_Seek( p_sys->stream, i_pos );
+    if( i_ret == VLC_SUCCESS )
+    {
+        block_ChainRelease( p_sys->readahead.p_head );
+        p_sys->readahead.p_head = NULL;
+        p_sys->readahead.pp_last = &p_sys->readahead.p_head;
+        p_sys->readahead.i_count = 0;
+    }
+    return i_ret;
+}
+
+/* Number of leading packets of the buffer carrying a sync byte */
+static unsigned CountSyncedTSPackets( const uint8_t *p_peek, unsigned i_count,
+                                      unsigned i_packet_size )
+{
+    unsigned i = 0;
+    while( i < i_count && p_peek[(size_t)i * i_packet_size] == 0x47 )
+        i++;
+    return i;
+}
+
+/* Pulls up to i_max packets with a single stream read when the stream is
+ * in sync, so that the per packet calls to the stream layer are avoided.
+ * Anything not validated is left to ReadTSPacket() and its resync logic. */
+static void ReadAheadTSPackets( demux_t *p_demux, unsigned i_max )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint8_t *p_peek;
+
+    i_max = __MIN( i_max, TS_READAHEAD_MAX );
+    if( i_max < 2 )
+        return;
+
+    ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                                      (size_t)i_max * p_sys->i_packet_size );
+    if( i_peek < (ssize_t) (2 * p_sys->i_packet_size) )
+        return;
+
+    unsigned i_count = CountSyncedTSPackets( &p_peek[p_sys->i_packet_header_size],
+                                             i_peek / p_sys->i_packet_size,
+                                             p_sys->i_packet_size );
+    if( i_count < 2 )
+        return;
+
+    uint8_t *pp_pkts[TS_READAHEAD_MAX];
+    unsigned i_done = 0;
+    for( ; i_done < i_count; i_done++ )
+    {
+        const size_t i_payload = p_sys->i_packet_size - p_sys->i_packet_header_size;
+        block_t *p_pkt = block_Alloc( i_payload );
+        if( unlikely(!p_pkt) )
+            break;
+        memcpy( p_pkt->p_buffer,
+                &p_peek[(size_t)i_done * p_sys->i_packet_size + p_sys->i_packet_header_size],
+                i_payload );
+        block_ChainLastAppend( &p_sys->readahead.pp_last, p_pkt );
+        pp_pkts[i_done] = p_pkt->p_buffer;
+    }
+
+    /* The peek buffer is no longer used past this point */
+    const size_t i_read = (size_t)i_done * p_sys->i_packet_size;
+    if( vlc_stream_Read( p_sys->stream, NULL, i_read ) != (ssize_t) i_read )
+    {
+        block_ChainRelease( p_sys->readahead.p_head );
+        p_sys->readahead.p_head = NULL;
+        p_sys->readahead.pp_last = &p_sys->readahead.p_head;
+        i_done = 0;
+    }
+    p_sys->readahead.i_count = i_done;
+
+    /* Descramble the whole batch at once, ProcessTSPacket() will see the
+     * packets as clear */
+    if( p_sys->csa && i_done > 0 )
+    {
+        vlc_mutex_lock( &p_sys->csa_lock );
+        csa_DecryptBatch( p_sys->csa, pp_pkts, i_done, p_sys->i_csa_pkt_size );
+        vlc_mutex_unlock( &p_sys->csa_lock );
+    }
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     block_t     *p_pkt;
 
+    if( p_sys->readahead.i_count )
+    {
+        p_pkt = p_sys->readahead.p_head;
+        p_sys->readahead.p_head = p_pkt->p_next;
+        if( --p_sys->readahead.i_count == 0 )
+            p_sys->readahead.pp_last = &p_sys->readahead.p_head;
+        p_pkt->p_next = NULL;
+        return p_pkt;
+    }
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
         int64_t size = stream_Size( p_sys->stream );
-        if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
-            msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
+        if( size >= 0 && (uint64_t)size == TsStreamTell( p_sys ) )
+            msg_Dbg( p_demux, "EOF at %"PRIu64, TsStreamTell( p_sys ) );
         else
-            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
+            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, TsStreamTell( p_sys ) );
         return NULL;
     }
 
@@ -1971,23 +2163,62 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
+static bool SeekIndexUsable( const demux_sys_t *p_sys, const ts_pmt_t *p_pmt )
+{
+    const ts_seekindex_t *p_index = &p_sys->seekindex.index;
+    return p_sys->seekindex.psz_path && p_index->i_count &&
+           p_index->i_program == p_pmt->i_number &&
+           p_index->i_first_pcr == p_pmt->pcr.i_first;
+}
+
+static void SeekIndexUpdate( demux_sys_t *p_sys, const ts_pmt_t *p_pmt, stime_t i_pcr )
+{
+    ts_seekindex_t *p_index = &p_sys->seekindex.index;
+    if( !p_sys->seekindex.psz_path || p_pmt->pcr.i_first == -1 )
+        return;
+
+    if( p_index->i_program == -1 )
+    {
+        p_index->i_program = p_pmt->i_number;
+        p_index->i_first_pcr = p_pmt->pcr.i_first;
+    }
+    else if( p_index->i_program != p_pmt->i_number ||
+             p_index->i_first_pcr != p_pmt->pcr.i_first )
+        return;
+
+    ts_seekindex_Add( p_index, TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr ),
+                      TsStreamTell( p_sys ) );
+}
+
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TsStreamSeek( p_sys, 0 );
+
+    /* Indexed position close enough, no need to search */
+    const ts_seekpoint_t *p_before = NULL, *p_after = NULL;
+    if( SeekIndexUsable( p_sys, p_pmt ) &&
+        ts_seekindex_Find( &p_sys->seekindex.index, i_scaledtime, &p_before, &p_after ) &&
+        i_scaledtime - p_before->i_time < TO_SCALE(VLC_TICK_0 + VLC_TICK_FROM_MS(500)) )
+        return TsStreamSeek( p_sys, p_before->i_pos );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
 
-    /* Find the time position by using binary search algorithm. */
+    /* Find the time position by using binary search algorithm,
+     * within the indexed bounds if any. */
     uint64_t i_head_pos = 0;
     uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+    if( p_before )
+        i_head_pos = p_before->i_pos;
+    if( p_after && p_after->i_pos < i_tail_pos )
+        i_tail_pos = p_after->i_pos;
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -1999,7 +2230,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TsStreamSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -2013,7 +2244,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TsStreamTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -2067,10 +2298,13 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
             i_tail_pos = (i_splitpos >= p_sys->i_packet_size) ? i_splitpos - p_sys->i_packet_size : 0;
     }
 
+    if( !b_found && p_before && TsStreamSeek( p_sys, p_before->i_pos ) == VLC_SUCCESS )
+        return VLC_SUCCESS;
+
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+        if( TsStreamSeek( p_sys, i_initial_pos ) != VLC_SUCCESS )
             msg_Err( p_demux, "Can't seek back to %" PRIu64, i_initial_pos );
         return VLC_EGENERIC;
     }
@@ -2152,7 +2386,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, stime_t *pi_
                         if( b_end )
                         {
                             p_pmt->i_last_dts = *pi_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2180,7 +2414,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, stime_t *pi_
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2193,7 +2427,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, false, &i_pcr, &b_found );
@@ -2203,7 +2437,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2212,7 +2446,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = PROBE_CHUNK_COUNT;
@@ -2225,7 +2459,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, true, &i_pcr, &b_found );
@@ -2235,7 +2469,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2281,19 +2515,22 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         p_pmt->pcr.i_first = i_pcr; // now seen
     }
 
+    if( p_sys->b_canseek && !p_sys->b_access_control )
+        SeekIndexUpdate( p_sys, p_pmt, i_pcr );
+
     if ( p_sys->i_pmt_es )
     {
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TsStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
             }
         }
     }
@@ -2644,40 +2881,21 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
     return p_pkt;
 }
 
-/* Avoids largest memcpy */
+/* The tail references the payload of the head, no copy */
 static bool block_Split( block_t **pp_block, block_t **pp_remain, size_t i_offset )
 {
     block_t *p_block = *pp_block;
     block_t *p_split = NULL;
-    *pp_remain = NULL;
 
-    size_t i_tocopy = p_block->i_buffer - i_offset;
-    if( i_tocopy > i_offset ) /* make new block for head */
-    {
-        if( i_offset > 0 )
-        {
-            p_split = block_Alloc( i_offset );
-            if( p_split == NULL )
-                return false;
-            memcpy( p_split->p_buffer, p_block->p_buffer, i_offset );
-            p_block->p_buffer += i_offset;
-            p_block->i_buffer -= i_offset;
-        }
-        *pp_remain = p_block;
-        *pp_block = p_split;
-    }
-    else /* other gets the tail of our split */
+    assert( i_offset <= p_block->i_buffer );
+    if( i_offset < p_block->i_buffer )
     {
-        if( i_tocopy > 0 )
-        {
-            p_split = block_Alloc( i_tocopy );
-            if( p_split == NULL )
-                return false;
-            memcpy( p_split->p_buffer, &p_block->p_buffer[i_offset], i_tocopy );
-            p_block->i_buffer -= i_tocopy;
-        }
-        *pp_remain = p_split;
+        p_split = block_Slice( p_block, i_offset, p_block->i_buffer - i_offset );
+        if( p_split == NULL )
+            return false;
+        p_block->i_buffer = i_offset;
     }
+    *pp_remain = p_split;
     return true;
 }
 
@@ -20,6 +20,10 @@
 #ifndef VLC_TS_H
 #define VLC_TS_H
 
+#include "ts_seekindex.h"
+
+typedef struct ts_fanout_t ts_fanout_t;
+
 #ifdef HAVE_ARIBB24
     typedef struct arib_instance_t arib_instance_t;
 #endif
@@ -70,8 +74,25 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* Packets already pulled from the stream in one go, but not yet demuxed */
+    struct
+    {
+        block_t    *p_head;
+        block_t   **pp_last;
+        unsigned    i_count;
+    } readahead;
+
+    /* Time to byte offset index, kept across sessions in the cache dir */
+    struct
+    {
+        ts_seekindex_t index;
+        char          *psz_path; /* NULL if disabled */
+        uint64_t       i_size;
+    } seekindex;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
+    bool        b_epg_selected_only;
 
     ts_standards_e standard;
 
@@ -140,6 +161,9 @@ struct demux_sys_t
 
     /* */
     bool        b_start_record;
+
+    /* per program sub-TS outputs */
+    ts_fanout_t *fanout;
 };
 
 void TsChangeStandard( demux_sys_t *, ts_standards_e );
@@ -148,6 +172,9 @@ bool ProgramIsSelected( demux_sys_t *, uint16_t i_pgrm );
 
 void UpdatePESFilters( demux_t *p_demux, bool b_all );
 
+uint64_t TsStreamTell( demux_sys_t * );
+int TsStreamSeek( demux_sys_t *, uint64_t i_pos );
+
 int ProbeStart( demux_t *p_demux, int i_program );
 int ProbeEnd( demux_t *p_demux, int i_program );
 
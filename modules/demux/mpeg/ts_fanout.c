@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * ts_fanout.c: TS Demux per program sub-TS outputs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+
+#include "ts_pid.h"
+#include "ts_streams_private.h"
+#include "ts_fanout.h"
+
+/* Packets gathered before each write to the access output */
+#define FANOUT_PACKETS 64
+
+typedef struct
+{
+    uint16_t           i_program;
+    uint16_t           i_pmt_pid; /* 0 until seen in the PAT */
+    uint8_t            i_pat_cc;
+    sout_access_out_t *p_access;
+    block_t           *p_pending;
+} ts_fanout_output_t;
+
+struct ts_fanout_t
+{
+    demux_t           *p_demux;
+    unsigned           i_outputs;
+    ts_fanout_output_t outputs[TS_FANOUT_MAX];
+};
+
+static uint32_t CRC32( const uint8_t *p, size_t i_size )
+{
+    uint32_t i_crc = 0xffffffff;
+
+    /* MPEG-2 CRC: polynomial 0x04c11db7, no reflection */
+    while( i_size-- )
+    {
+        i_crc ^= (uint32_t)*p++ << 24;
+        for( int i = 0; i < 8; i++ )
+            i_crc = (i_crc << 1) ^ ((i_crc & 0x80000000) ? 0x04c11db7 : 0);
+    }
+    return i_crc;
+}
+
+static void OutputFlush( ts_fanout_output_t *p_out )
+{
+    if( p_out->p_pending && p_out->p_pending->i_buffer > 0 )
+    {
+        sout_AccessOutWrite( p_out->p_access, p_out->p_pending );
+        p_out->p_pending = NULL;
+    }
+}
+
+static void OutputWrite( ts_fanout_output_t *p_out, const uint8_t *p_pkt )
+{
+    if( p_out->p_pending == NULL )
+    {
+        p_out->p_pending = block_Alloc( FANOUT_PACKETS * 188 );
+        if( unlikely(p_out->p_pending == NULL) )
+            return;
+        p_out->p_pending->i_buffer = 0;
+    }
+
+    block_t *p_block = p_out->p_pending;
+    memcpy( &p_block->p_buffer[p_block->i_buffer], p_pkt, 188 );
+    p_block->i_buffer += 188;
+
+    if( p_block->i_buffer == FANOUT_PACKETS * 188 )
+        OutputFlush( p_out );
+}
+
+static void OutputWritePAT( ts_fanout_output_t *p_out, const ts_pat_t *p_pat )
+{
+    uint8_t pkt[188];
+
+    pkt[0] = 0x47;
+    pkt[1] = 0x40; /* payload unit start, PID 0 */
+    pkt[2] = 0x00;
+    pkt[3] = 0x10 | p_out->i_pat_cc;
+    p_out->i_pat_cc = (p_out->i_pat_cc + 1) & 0x0f;
+    pkt[4] = 0x00; /* pointer field */
+
+    uint8_t *p_section = &pkt[5];
+    p_section[0] = 0x00; /* table id */
+    p_section[1] = 0xb0; /* syntax indicator, section length = 13 */
+    p_section[2] = 13;
+    SetWBE( &p_section[3], p_pat->i_ts_id );
+    p_section[5] = 0xc1 | ((p_pat->i_version & 0x1f) << 1);
+    p_section[6] = 0x00; /* section number */
+    p_section[7] = 0x00; /* last section number */
+    SetWBE( &p_section[8], p_out->i_program );
+    SetWBE( &p_section[10], 0xe000 | p_out->i_pmt_pid );
+    SetDWBE( &p_section[12], CRC32( p_section, 12 ) );
+
+    memset( &p_section[16], 0xff, sizeof(pkt) - 5 - 16 );
+    OutputWrite( p_out, pkt );
+}
+
+ts_fanout_t *ts_fanout_New( demux_t *p_demux, const char *psz_config )
+{
+    if( psz_config == NULL || *psz_config == '\0' )
+        return NULL;
+
+    ts_fanout_t *p_fanout = malloc( sizeof(*p_fanout) );
+    if( unlikely(p_fanout == NULL) )
+        return NULL;
+    p_fanout->p_demux = p_demux;
+    p_fanout->i_outputs = 0;
+
+    char *psz_buf = NULL;
+    const char *psz_str = psz_config;
+    while( psz_str != NULL && *psz_str != '\0' )
+    {
+        config_chain_t *p_cfg;
+        char *psz_name;
+        char *psz_next = config_ChainCreate( &psz_name, &p_cfg, psz_str );
+
+        free( psz_buf );
+        psz_str = psz_buf = psz_next;
+
+        const char *psz_dst = NULL, *psz_access = "file";
+        for( const config_chain_t *p = p_cfg; p != NULL; p = p->p_next )
+        {
+            if( !strcmp( p->psz_name, "dst" ) )
+                psz_dst = p->psz_value;
+            else if( !strcmp( p->psz_name, "access" ) )
+                psz_access = p->psz_value;
+        }
+
+        unsigned long i_program = psz_name ? strtoul( psz_name, NULL, 0 ) : 0;
+        if( i_program == 0 || i_program > UINT16_MAX || psz_dst == NULL )
+            msg_Err( p_demux, "invalid fan-out output %s", psz_name );
+        else if( p_fanout->i_outputs == TS_FANOUT_MAX )
+            msg_Err( p_demux, "too many fan-out outputs" );
+        else
+        {
+            sout_access_out_t *p_access =
+                sout_AccessOutNew( p_demux, psz_access, psz_dst );
+            if( p_access == NULL )
+                msg_Err( p_demux, "cannot create fan-out output %s://%s",
+                         psz_access, psz_dst );
+            else
+            {
+                ts_fanout_output_t *p_out =
+                    &p_fanout->outputs[p_fanout->i_outputs++];
+                p_out->i_program = i_program;
+                p_out->i_pmt_pid = 0;
+                p_out->i_pat_cc = 0;
+                p_out->p_access = p_access;
+                p_out->p_pending = NULL;
+                msg_Dbg( p_demux, "program %lu sent to %s://%s",
+                         i_program, psz_access, psz_dst );
+            }
+        }
+
+        config_ChainDestroy( p_cfg );
+        free( psz_name );
+    }
+    free( psz_buf );
+
+    if( p_fanout->i_outputs == 0 )
+    {
+        free( p_fanout );
+        return NULL;
+    }
+    return p_fanout;
+}
+
+void ts_fanout_Delete( ts_fanout_t *p_fanout )
+{
+    for( unsigned i = 0; i < p_fanout->i_outputs; i++ )
+    {
+        ts_fanout_output_t *p_out = &p_fanout->outputs[i];
+
+        OutputFlush( p_out );
+        if( p_out->p_pending )
+            block_Release( p_out->p_pending );
+        sout_AccessOutDelete( p_out->p_access );
+    }
+    free( p_fanout );
+}
+
+uint32_t ts_fanout_ProgramMask( const ts_fanout_t *p_fanout,
+                                uint16_t i_program )
+{
+    uint32_t i_mask = 0;
+
+    if( p_fanout == NULL )
+        return 0;
+
+    for( unsigned i = 0; i < p_fanout->i_outputs; i++ )
+        if( p_fanout->outputs[i].i_program == i_program )
+            i_mask |= UINT32_C(1) << i;
+    return i_mask;
+}
+
+void ts_fanout_SetPMTPID( ts_fanout_t *p_fanout, uint16_t i_program,
+                          uint16_t i_pid )
+{
+    for( unsigned i = 0; i < p_fanout->i_outputs; i++ )
+        if( p_fanout->outputs[i].i_program == i_program )
+            p_fanout->outputs[i].i_pmt_pid = i_pid;
+}
+
+void ts_fanout_Packet( ts_fanout_t *p_fanout, const ts_pid_t *p_pid,
+                       const uint8_t *p_pkt )
+{
+    if( p_pid->type == TYPE_PAT )
+    {
+        /* Only rewrite the first packet of a PAT, as its sections are */
+        if( (p_pkt[1] & 0x40) == 0 || p_pid->u.p_pat == NULL )
+            return;
+
+        for( unsigned i = 0; i < p_fanout->i_outputs; i++ )
+            if( p_fanout->outputs[i].i_pmt_pid != 0 )
+                OutputWritePAT( &p_fanout->outputs[i], p_pid->u.p_pat );
+        return;
+    }
+
+    uint32_t i_mask = p_pid->i_fanout;
+    while( i_mask )
+    {
+        unsigned i = ctz( i_mask );
+        OutputWrite( &p_fanout->outputs[i], p_pkt );
+        i_mask &= i_mask - 1;
+    }
+}
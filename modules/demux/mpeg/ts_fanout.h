@@ -0,0 +1,57 @@
+/*****************************************************************************
+ * ts_fanout.h: TS Demux per program sub-TS outputs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_FANOUT_H
+#define VLC_TS_FANOUT_H
+
+/* Each output is a bit of ts_pid_t.i_fanout */
+#define TS_FANOUT_MAX 32
+
+typedef struct ts_fanout_t ts_fanout_t;
+
+/**
+ * Creates the outputs described by the "ts-fanout" option, as a chain of
+ *   <program number>{dst=<path>[,access=<access output>]}
+ * separated by ':'.
+ *
+ * \return NULL if the option is empty or no output could be created
+ */
+ts_fanout_t *ts_fanout_New( demux_t *, const char *psz_config );
+
+/** Flushes and closes the outputs */
+void ts_fanout_Delete( ts_fanout_t * );
+
+/**
+ * Returns the mask of the outputs of a program, to be set on the PMT, PCR
+ * and elementary streams PIDs of this program (0 if not fanned out).
+ */
+uint32_t ts_fanout_ProgramMask( const ts_fanout_t *, uint16_t i_program );
+
+/** Records the PMT PID of a program, as announced by the PAT */
+void ts_fanout_SetPMTPID( ts_fanout_t *, uint16_t i_program, uint16_t i_pid );
+
+/**
+ * Forwards a 188 bytes TS packet to the outputs of its PID.
+ *
+ * PAT packets are replaced, for each output, by a PAT only announcing its
+ * program.
+ */
+void ts_fanout_Packet( ts_fanout_t *, const ts_pid_t *, const uint8_t *p_pkt );
+
+#endif
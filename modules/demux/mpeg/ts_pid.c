@@ -42,8 +42,10 @@ void ts_pid_list_Init( ts_pid_list_t *p_list )
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+    memset( p_list->index, 0, sizeof(p_list->index) );
+    p_list->index[0] = &p_list->pat;
+    p_list->index[0x1FFB] = &p_list->base_si;
+    p_list->index[0x1FFF] = &p_list->dummy;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
@@ -80,22 +82,15 @@ static int ts_bsearch_searchkey_Compare( const void *key, const void *other )
 
 ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
 {
-    switch( i_pid )
-    {
-        case 0:
-            return &p_list->pat;
-        case 0x1FFB:
-            return &p_list->base_si;
-        case 0x1FFF:
-            return &p_list->dummy;
-        default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
-        break;
-    }
+    if( unlikely(i_pid >= TS_PID_COUNT) )
+        return &p_list->dummy;
+
+    ts_pid_t *p_pid = p_list->index[i_pid];
+    if( likely(p_pid) )
+        return p_pid;
 
+    /* Not seen yet: create and insert into the sorted list */
     size_t i_index = 0;
-    ts_pid_t *p_pid = NULL;
 
     if( p_list->pp_all )
     {
@@ -105,55 +100,49 @@ ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
 
         ts_pid_t **pp_pidk = bsearch( &pidkey, p_list->pp_all, p_list->i_all,
                                       sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
-        if ( pp_pidk )
-            p_pid = *pp_pidk;
-        else
-            i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
+        assert( pp_pidk == NULL );
+        VLC_UNUSED( pp_pidk );
+        i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
     }
 
-    if( p_pid == NULL )
+    if( p_list->i_all >= p_list->i_all_alloc )
     {
-        if( p_list->i_all >= p_list->i_all_alloc )
-        {
-            ts_pid_t **p_realloc = realloc( p_list->pp_all,
-                                            (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
-            if( !p_realloc )
-            {
-                abort();
-                //return NULL;
-            }
-            p_list->pp_all = p_realloc;
-            p_list->i_all_alloc += PID_ALLOC_CHUNK;
-        }
-
-        p_pid = calloc( 1, sizeof(*p_pid) );
-        if( !p_pid )
+        ts_pid_t **p_realloc = realloc( p_list->pp_all,
+                                        (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
+        if( !p_realloc )
         {
             abort();
             //return NULL;
         }
+        p_list->pp_all = p_realloc;
+        p_list->i_all_alloc += PID_ALLOC_CHUNK;
+    }
 
-        p_pid->i_cc  = 0xff;
-        p_pid->i_pid = i_pid;
-
-        /* Do insertion based on last bsearch mid point */
-        if( p_list->i_all )
-        {
-            if( p_list->pp_all[i_index]->i_pid < i_pid )
-                i_index++;
+    p_pid = calloc( 1, sizeof(*p_pid) );
+    if( !p_pid )
+    {
+        abort();
+        //return NULL;
+    }
 
-            memmove( &p_list->pp_all[i_index + 1],
-                    &p_list->pp_all[i_index],
-                    (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
-        }
+    p_pid->i_cc  = 0xff;
+    p_pid->i_pid = i_pid;
 
-        p_list->pp_all[i_index] = p_pid;
-        p_list->i_all++;
+    /* Do insertion based on last bsearch mid point */
+    if( p_list->i_all )
+    {
+        if( p_list->pp_all[i_index]->i_pid < i_pid )
+            i_index++;
 
+        memmove( &p_list->pp_all[i_index + 1],
+                &p_list->pp_all[i_index],
+                (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
     }
 
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
+    p_list->pp_all[i_index] = p_pid;
+    p_list->i_all++;
+
+    p_list->index[i_pid] = p_pid;
 
     return p_pid;
 }
@@ -307,6 +296,7 @@ void PIDRelease( demux_t *p_demux, ts_pid_t *pid )
             break;
         }
 
+        pid->i_fanout = 0;
         SetPIDFilter( p_demux->p_sys, pid, false );
         PIDReset( pid );
     }
@@ -318,7 +308,8 @@ int UpdateHWFilter( demux_sys_t *p_sys, ts_pid_t *p_pid )
         return VLC_EGENERIC;
 
     return vlc_stream_Control( p_sys->stream, STREAM_SET_PRIVATE_ID_STATE,
-                           p_pid->i_pid, !!(p_pid->i_flags & FLAG_FILTERED) );
+                           p_pid->i_pid,
+                           (p_pid->i_flags & FLAG_FILTERED) || p_pid->i_fanout );
 }
 
 int SetPIDFilter( demux_sys_t *p_sys, ts_pid_t *p_pid, bool b_selected )
@@ -63,6 +63,8 @@ struct ts_pid_t
 
     uint16_t    i_refcount;
 
+    uint32_t    i_fanout; /* mask of the ts_fanout_t outputs receiving it */
+
     /* */
     union
     {
@@ -84,19 +86,19 @@ struct ts_pid_t
 
 };
 
+#define TS_PID_COUNT 8192
+
 struct ts_pid_list_t
 {
     ts_pid_t   pat;
     ts_pid_t   dummy;
     ts_pid_t   base_si;
-    /* all non commons ones, dynamically allocated */
+    /* all non commons ones, dynamically allocated, sorted by pid */
     ts_pid_t **pp_all;
     int        i_all;
     int        i_all_alloc;
-    /* last recently used */
-    uint16_t   i_last_pid;
-    ts_pid_t  *p_last;
-
+    /* direct lookup for all 13 bits pids, including commons ones */
+    ts_pid_t  *index[TS_PID_COUNT];
 };
 
 /* opacified pid list */
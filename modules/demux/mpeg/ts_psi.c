@@ -55,6 +55,7 @@
 #include "ts_si.h"
 #include "ts_metadata.h"
 #include "ts_descriptions.h"
+#include "ts_fanout.h"
 
 #include "../../access/dtv/en50221_capmt.h"
 
@@ -199,6 +200,16 @@ static void PATCallBack( void *data, dvbpsi_pat_t *p_dvbpsipat )
             if ( p_sys->es_creation == DELAY_ES )
                 p_sys->es_creation = CREATE_ES;
         }
+
+        /* Fanned out programs need their PMT, even unselected */
+        const uint32_t i_fanout = ts_fanout_ProgramMask( p_sys->fanout,
+                                                         p_program->i_number );
+        if( i_fanout )
+        {
+            ts_fanout_SetPMTPID( p_sys->fanout, p_program->i_number, pmtpid->i_pid );
+            pmtpid->i_fanout |= i_fanout;
+            UpdateHWFilter( p_sys, pmtpid );
+        }
     }
     p_pat->i_version = p_dvbpsipat->i_version;
     p_pat->i_ts_id = p_dvbpsipat->i_ts_id;
@@ -2055,6 +2066,8 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
                 en50221_capmt_Delete( p_en );
                 if ( p_sys->standard == TS_STANDARD_ARIB && !p_sys->arib.b25stream )
                 {
+                    /* Give back read ahead packets so they go through the filter */
+                    TsStreamSeek( p_sys, TsStreamTell( p_sys ) );
                     p_sys->arib.b25stream = vlc_stream_FilterNew( p_demux->s, "aribcam" );
                     p_sys->stream = ( p_sys->arib.b25stream ) ? p_sys->arib.b25stream : p_demux->s;
                 }
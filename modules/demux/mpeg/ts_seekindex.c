@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * ts_seekindex.c: TS Demux persistent time to byte offset index
+ *****************************************************************************
+ * Copyright (C) 2004-2016 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
+
+#include "ts_seekindex.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SEEKINDEX_MAGIC       "VLCTSIX1"
+#define SEEKINDEX_HEADER_SIZE (8 + 8 + 4 + 4 + 8 + 4)
+#define SEEKINDEX_POINT_SIZE  (8 + 8)
+#define SEEKINDEX_MAX_POINTS  (1 << 22)
+
+void ts_seekindex_Init( ts_seekindex_t *p_index, stime_t i_interval )
+{
+    p_index->p_points = NULL;
+    p_index->i_count = 0;
+    p_index->i_alloc = 0;
+    p_index->i_program = -1;
+    p_index->i_first_pcr = -1;
+    p_index->i_interval = i_interval;
+    p_index->b_dirty = false;
+}
+
+void ts_seekindex_Clean( ts_seekindex_t *p_index )
+{
+    free( p_index->p_points );
+    ts_seekindex_Init( p_index, p_index->i_interval );
+}
+
+/* index of the first point with position above i_pos */
+static size_t FindPos( const ts_seekindex_t *p_index, uint64_t i_pos )
+{
+    size_t lo = 0, hi = p_index->i_count;
+    while( lo < hi )
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_index->p_points[mid].i_pos <= i_pos )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* index of the first point with time above i_time */
+static size_t FindTime( const ts_seekindex_t *p_index, stime_t i_time )
+{
+    size_t lo = 0, hi = p_index->i_count;
+    while( lo < hi )
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if( p_index->p_points[mid].i_time <= i_time )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void ts_seekindex_Add( ts_seekindex_t *p_index, stime_t i_time, uint64_t i_pos )
+{
+    size_t i = FindPos( p_index, i_pos );
+
+    if( i > 0 )
+    {
+        const ts_seekpoint_t *p_prev = &p_index->p_points[i - 1];
+        if( p_prev->i_pos == i_pos || p_prev->i_time >= i_time ||
+            i_time - p_prev->i_time < p_index->i_interval )
+            return;
+    }
+    if( i < p_index->i_count )
+    {
+        const ts_seekpoint_t *p_next = &p_index->p_points[i];
+        if( p_next->i_time <= i_time ||
+            p_next->i_time - i_time < p_index->i_interval )
+            return;
+    }
+
+    if( p_index->i_count >= SEEKINDEX_MAX_POINTS )
+        return;
+
+    if( p_index->i_count == p_index->i_alloc )
+    {
+        size_t i_alloc = p_index->i_alloc ? p_index->i_alloc * 2 : 256;
+        ts_seekpoint_t *p_realloc = realloc( p_index->p_points,
+                                             i_alloc * sizeof(*p_realloc) );
+        if( !p_realloc )
+            return;
+        p_index->p_points = p_realloc;
+        p_index->i_alloc = i_alloc;
+    }
+
+    memmove( &p_index->p_points[i + 1], &p_index->p_points[i],
+             (p_index->i_count - i) * sizeof(*p_index->p_points) );
+    p_index->p_points[i].i_time = i_time;
+    p_index->p_points[i].i_pos = i_pos;
+    p_index->i_count++;
+    p_index->b_dirty = true;
+}
+
+bool ts_seekindex_Find( const ts_seekindex_t *p_index, stime_t i_time,
+                        const ts_seekpoint_t **pp_before,
+                        const ts_seekpoint_t **pp_after )
+{
+    size_t i = FindTime( p_index, i_time );
+    if( i == 0 )
+        return false;
+
+    *pp_before = &p_index->p_points[i - 1];
+    *pp_after = ( i < p_index->i_count ) ? &p_index->p_points[i] : NULL;
+    return true;
+}
+
+char * ts_seekindex_GetCachePath( const char *psz_url )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return NULL;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_url, strlen( psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path;
+    if( !psz_hash ||
+        asprintf( &psz_path, "%s" DIR_SEP "ts-index" DIR_SEP "%s.idx",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+
+    free( psz_hash );
+    free( psz_cachedir );
+    return psz_path;
+}
+
+int ts_seekindex_Load( ts_seekindex_t *p_index, const char *psz_path,
+                       uint64_t i_size, unsigned i_packet_size )
+{
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    if( !p_file )
+        return VLC_EGENERIC;
+
+    uint8_t header[SEEKINDEX_HEADER_SIZE];
+    if( fread( header, sizeof(header), 1, p_file ) != 1 ||
+        memcmp( header, SEEKINDEX_MAGIC, 8 ) ||
+        GetQWBE( &header[8] ) != i_size ||
+        GetDWBE( &header[16] ) != i_packet_size )
+    {
+        fclose( p_file );
+        return VLC_EGENERIC;
+    }
+
+    uint32_t i_count = GetDWBE( &header[32] );
+    if( i_count == 0 || i_count > SEEKINDEX_MAX_POINTS )
+    {
+        fclose( p_file );
+        return VLC_EGENERIC;
+    }
+
+    ts_seekpoint_t *p_points = vlc_alloc( i_count, sizeof(*p_points) );
+    if( !p_points )
+    {
+        fclose( p_file );
+        return VLC_ENOMEM;
+    }
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        uint8_t point[SEEKINDEX_POINT_SIZE];
+        if( fread( point, sizeof(point), 1, p_file ) != 1 )
+            goto error;
+        p_points[i].i_time = GetQWBE( &point[0] );
+        p_points[i].i_pos = GetQWBE( &point[8] );
+        /* must stay sorted on both keys */
+        if( p_points[i].i_pos > i_size ||
+            ( i > 0 && ( p_points[i].i_time <= p_points[i - 1].i_time ||
+                         p_points[i].i_pos <= p_points[i - 1].i_pos ) ) )
+            goto error;
+    }
+    fclose( p_file );
+
+    free( p_index->p_points );
+    p_index->p_points = p_points;
+    p_index->i_count = p_index->i_alloc = i_count;
+    p_index->i_program = GetDWBE( &header[20] );
+    p_index->i_first_pcr = GetQWBE( &header[24] );
+    p_index->b_dirty = false;
+    return VLC_SUCCESS;
+
+error:
+    free( p_points );
+    fclose( p_file );
+    return VLC_EGENERIC;
+}
+
+int ts_seekindex_Save( const ts_seekindex_t *p_index, const char *psz_path,
+                       uint64_t i_size, unsigned i_packet_size )
+{
+    if( p_index->i_count == 0 || p_index->i_program < 0 )
+        return VLC_EGENERIC;
+
+    /* Create the ts-index cache directory if needed */
+    const char *psz_sep = strrchr( psz_path, DIR_SEP_CHAR );
+    if( psz_sep )
+    {
+        char *psz_dir = strndup( psz_path, psz_sep - psz_path );
+        if( !psz_dir )
+            return VLC_ENOMEM;
+        const char *psz_parent = strrchr( psz_dir, DIR_SEP_CHAR );
+        if( psz_parent )
+        {
+            char *psz_cachedir = strndup( psz_dir, psz_parent - psz_dir );
+            if( psz_cachedir )
+                vlc_mkdir( psz_cachedir, 0700 );
+            free( psz_cachedir );
+        }
+        if( vlc_mkdir( psz_dir, 0700 ) && errno != EEXIST )
+        {
+            free( psz_dir );
+            return VLC_EGENERIC;
+        }
+        free( psz_dir );
+    }
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.part", psz_path ) == -1 )
+        return VLC_ENOMEM;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( !p_file )
+    {
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+
+    bool b_error = false;
+    uint8_t header[SEEKINDEX_HEADER_SIZE];
+    memcpy( header, SEEKINDEX_MAGIC, 8 );
+    SetQWBE( &header[8], i_size );
+    SetDWBE( &header[16], i_packet_size );
+    SetDWBE( &header[20], p_index->i_program );
+    SetQWBE( &header[24], p_index->i_first_pcr );
+    SetDWBE( &header[32], p_index->i_count );
+    b_error |= fwrite( header, sizeof(header), 1, p_file ) != 1;
+
+    for( size_t i = 0; i < p_index->i_count && !b_error; i++ )
+    {
+        uint8_t point[SEEKINDEX_POINT_SIZE];
+        SetQWBE( &point[0], p_index->p_points[i].i_time );
+        SetQWBE( &point[8], p_index->p_points[i].i_pos );
+        b_error |= fwrite( point, sizeof(point), 1, p_file ) != 1;
+    }
+
+    b_error |= fclose( p_file ) != 0;
+    if( b_error || vlc_rename( psz_tmp, psz_path ) )
+    {
+        vlc_unlink( psz_tmp );
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+    free( psz_tmp );
+    return VLC_SUCCESS;
+}
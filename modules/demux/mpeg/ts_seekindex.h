@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * ts_seekindex.h: TS Demux persistent time to byte offset index
+ *****************************************************************************
+ * Copyright (C) 2004-2016 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+#ifndef VLC_TS_SEEKINDEX_H
+#define VLC_TS_SEEKINDEX_H
+
+#include "timestamps.h"
+
+typedef struct
+{
+    stime_t  i_time;  /* PCR, unwrapped against the program first PCR */
+    uint64_t i_pos;   /* byte offset of the packet following the PCR */
+} ts_seekpoint_t;
+
+typedef struct
+{
+    ts_seekpoint_t *p_points; /* sorted by both time and position */
+    size_t          i_count;
+    size_t          i_alloc;
+
+    int             i_program;  /* -1 until bound to a program */
+    stime_t         i_first_pcr;
+    stime_t         i_interval; /* minimum time distance between points */
+    bool            b_dirty;
+} ts_seekindex_t;
+
+void ts_seekindex_Init( ts_seekindex_t *, stime_t i_interval );
+void ts_seekindex_Clean( ts_seekindex_t * );
+
+/* Records a point, unless too close to an existing one or inconsistent
+ * with its neighbours (PCR discontinuity) */
+void ts_seekindex_Add( ts_seekindex_t *, stime_t i_time, uint64_t i_pos );
+
+/* Returns the byte range enclosing i_time, false if outside of the index */
+bool ts_seekindex_Find( const ts_seekindex_t *, stime_t i_time,
+                        const ts_seekpoint_t **pp_before,
+                        const ts_seekpoint_t **pp_after );
+
+/* Cache file handling, keyed by the stream URL and size */
+char * ts_seekindex_GetCachePath( const char *psz_url );
+int ts_seekindex_Load( ts_seekindex_t *, const char *psz_path,
+                       uint64_t i_size, unsigned i_packet_size );
+int ts_seekindex_Save( const ts_seekindex_t *, const char *psz_path,
+                       uint64_t i_size, unsigned i_packet_size );
+
+#endif
@@ -491,12 +491,29 @@ static void EITCallBack( demux_t *p_demux, dvbpsi_eit_t *p_eit )
     vlc_epg_t *p_epg;
 
     msg_Dbg( p_demux, "EITCallBack called" );
-    if( !p_eit->b_current_next )
+    if( !p_eit->b_current_next ||
+        ( p_sys->b_epg_selected_only &&
+          !ProgramIsSelected( p_sys, p_eit->i_extension ) ) )
     {
         dvbpsi_eit_delete( p_eit );
         return;
     }
 
+    /* Schedule tables are repeated every few seconds and span up to 256
+     * sections: do not decode them again until their version changes */
+    ts_pat_t *p_pat = ts_pid_Get(&p_sys->pids, 0)->u.p_pat;
+    ts_pmt_t *p_pmt = ts_pat_Get_pmt(p_pat, p_eit->i_extension);
+    int *pi_schedule_version = NULL;
+    if( p_pmt && p_eit->i_table_id >= 0x50 && p_eit->i_table_id <= 0x5f )
+    {
+        pi_schedule_version = &p_pmt->eit.i_schedule_version[p_eit->i_table_id - 0x50];
+        if( *pi_schedule_version == p_eit->i_version )
+        {
+            dvbpsi_eit_delete( p_eit );
+            return;
+        }
+    }
+
     msg_Dbg( p_demux, "new EIT service_id=%"PRIu16" version=%"PRIu8" current_next=%d "
              "ts_id=%"PRIu16" network_id=%"PRIu16" segment_last_section_number=%"PRIu8" "
              "last_table_id=%"PRIu8,
@@ -675,21 +692,19 @@ static void EITCallBack( demux_t *p_demux, dvbpsi_eit_t *p_eit )
 
     if( p_epg->i_event > 0 )
     {
-        if( p_epg->b_present && p_epg->p_current )
+        if( p_epg->b_present && p_epg->p_current && p_pmt )
         {
-            ts_pat_t *p_pat = ts_pid_Get(&p_sys->pids, 0)->u.p_pat;
-            ts_pmt_t *p_pmt = ts_pat_Get_pmt(p_pat, p_eit->i_extension);
-            if(p_pmt)
-            {
-                p_pmt->eit.i_event_start = p_epg->p_current->i_start;
-                p_pmt->eit.i_event_length = p_epg->p_current->i_duration;
-            }
+            p_pmt->eit.i_event_start = p_epg->p_current->i_start;
+            p_pmt->eit.i_event_length = p_epg->p_current->i_duration;
         }
         p_epg->b_present = (p_eit->i_table_id == 0x4e);
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_EPG, p_eit->i_extension, p_epg );
     }
     vlc_epg_Delete( p_epg );
 
+    if( pi_schedule_version )
+        *pi_schedule_version = p_eit->i_version;
+
     dvbpsi_eit_delete( p_eit );
 }
 
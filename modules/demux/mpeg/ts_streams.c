@@ -137,6 +137,8 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
 
     pmt->eit.i_event_length = 0;
     pmt->eit.i_event_start = 0;
+    for( size_t i = 0; i < ARRAY_SIZE(pmt->eit.i_schedule_version); i++ )
+        pmt->eit.i_schedule_version[i] = -1;
 
     pmt->arib.i_download_id = -1;
     pmt->arib.i_logo_id = -1;
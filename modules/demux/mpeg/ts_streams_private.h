@@ -71,6 +71,8 @@ struct ts_pmt_t
     {
         time_t i_event_start;
         time_t i_event_length;
+        /* last decoded version of the schedule tables 0x50-0x5f, or -1 */
+        int i_schedule_version[16];
     } eit;
 
     stime_t i_last_dts;
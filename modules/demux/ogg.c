@@ -56,14 +56,21 @@
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
+#define SEEK_INDEX_TEXT N_("Keep a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Record time to page offset points while playing seekable files and " \
+    "store them in the cache directory, for faster seeking on next opens." )
+
 vlc_module_begin ()
     set_shortname ( "OGG" )
     set_description( N_("OGG demuxer" ) )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 50 )
+    set_probe_hints( "ogg,ogv,oga,ogx,ogm,opus,spx,audio/ogg,video/ogg,application/ogg" )
     set_callbacks( Open, Close )
     add_shortcut( "ogg" )
+    add_bool( "ogg-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT, true )
 vlc_module_end ()
 
 
@@ -248,6 +255,20 @@ static int Open( vlc_object_t * p_this )
     /* */
     TAB_INIT( p_sys->i_seekpoints, p_sys->pp_seekpoints );
 
+    p_sys->i_page_pos = -1;
+    bool b_canseek;
+    if( p_demux->psz_url && !p_demux->b_preparsing &&
+        var_InheritBool( p_demux, "ogg-seek-index" ) &&
+        vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek ) == VLC_SUCCESS &&
+        b_canseek )
+    {
+        int64_t i_size = stream_Size( p_demux->s );
+        if( i_size > 0 )
+        {
+            p_sys->seekindex.i_size = i_size;
+            p_sys->seekindex.psz_path = OggSeek_IndexGetCachePath( p_demux->psz_url );
+        }
+    }
 
     while ( !p_sys->b_preparsing_done && p_demux->pf_demux( p_demux ) > 0 )
     {}
@@ -268,6 +289,9 @@ static void Close( vlc_object_t *p_this )
     /* Cleanup the bitstream parser */
     ogg_sync_clear( &p_sys->oy );
 
+    OggSeek_IndexSave( p_demux );
+    free( p_sys->seekindex.psz_path );
+
     Ogg_EndOfStream( p_demux );
 
     if( p_sys->p_old_stream )
@@ -404,6 +428,11 @@ static int Demux( demux_t * p_demux )
                 TAB_CLEAN( p_sys->i_streams, p_sys->pp_stream );
             }
 
+            /* The index only covers the first group */
+            OggSeek_IndexSave( p_demux );
+            free( p_sys->seekindex.psz_path );
+            p_sys->seekindex.psz_path = NULL;
+
             Ogg_EndOfStream( p_demux );
             p_sys->b_chained_boundary = true;
 
@@ -427,6 +456,8 @@ static int Demux( demux_t * p_demux )
             vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek );
             if ( b_canseek )
                 Oggseek_ProbeEnd( p_demux );
+
+            OggSeek_IndexLoad( p_demux );
         }
         else
         {
@@ -458,6 +489,11 @@ static int Demux( demux_t * p_demux )
          */
         if( Ogg_ReadPage( p_demux, &p_sys->current_page ) != VLC_SUCCESS )
             return VLC_DEMUXER_EOF; /* EOF */
+        if( p_sys->seekindex.psz_path )
+            p_sys->i_page_pos = vlc_stream_Tell( p_demux->s )
+                              - ( p_sys->oy.fill - p_sys->oy.returned )
+                              - p_sys->current_page.header_len
+                              - p_sys->current_page.body_len;
         /* Test for End of Stream */
         if( ogg_page_eos( &p_sys->current_page ) )
         {
@@ -510,6 +546,10 @@ static int Demux( demux_t * p_demux )
             {
                 continue;
             }
+
+            if( p_sys->seekindex.psz_path )
+                OggSeek_IndexPage( p_demux, p_stream, &p_sys->current_page,
+                                   p_sys->i_page_pos );
         }
 
         /* clear the finished flag if pages after eos (ex: after a seek) */
@@ -224,6 +224,17 @@ typedef struct
 
     bool b_slave;
 
+    /* position of current_page */
+    int64_t i_page_pos;
+
+    /* persisted seek index */
+    struct
+    {
+        char    *psz_path;
+        uint64_t i_size;
+        bool     b_dirty;
+    } seekindex;
+
 } demux_sys_t;
 
 
@@ -36,11 +36,16 @@
 
 #include <vlc_common.h>
 #include <vlc_demux.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
 
 #include <ogg/ogg.h>
 #include <limits.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <stdio.h>
 
 #include "ogg.h"
 #include "oggseek.h"
@@ -48,6 +53,10 @@
 
 #define SEGMENT_NOT_FOUND -1
 
+#define SEEKINDEX_MAGIC       "VLCOGIX1"
+#define SEEKINDEX_INTERVAL    VLC_TICK_FROM_SEC(1)
+#define SEEKINDEX_MAX_POINTS  (1 << 22)
+
 #define MAX_PAGE_SIZE 65307
 typedef struct packetStartCoordinates
 {
@@ -171,6 +180,216 @@ static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestam
     return false;
 }
 
+/* Records a page met while playing: time of the last packet ending in it
+ * to page start. Only pages starting with a packet are used, and for streams
+ * with keyframes, pages ending with one, so that decoding can start there */
+void OggSeek_IndexPage( demux_t *p_demux, logical_stream_t *p_stream,
+                        const ogg_page *p_page, int64_t i_pagepos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if ( p_sys->seekindex.psz_path == NULL || p_sys->i_nzpcr_offset != 0 ||
+         i_pagepos < p_stream->i_data_start || p_stream->i_secondary_header_packets ||
+         ( p_stream->fmt.i_cat != AUDIO_ES && p_stream->fmt.i_cat != VIDEO_ES ) ||
+         ogg_page_continued( p_page ) )
+        return;
+
+    int64_t i_granule = ogg_page_granulepos( p_page );
+    if ( !Ogg_GranuleIsValid( p_stream, i_granule ) ||
+         Ogg_GetKeyframeGranule( p_stream, i_granule ) != i_granule )
+        return;
+
+    vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, i_granule, false, false );
+    if ( i_time == VLC_TICK_INVALID )
+        return;
+
+    /* Keep points at least an interval apart, and both keys sorted */
+    const demux_index_entry_t *idx = p_stream->idx, *prev = NULL;
+    while ( idx != NULL && idx->i_pagepos <= i_pagepos )
+    {
+        prev = idx;
+        idx = idx->p_next;
+    }
+    if ( prev && ( prev->i_pagepos == i_pagepos ||
+                   i_time - prev->i_value < SEEKINDEX_INTERVAL ) )
+        return;
+    if ( idx && idx->i_value - i_time < SEEKINDEX_INTERVAL )
+        return;
+
+    if ( OggSeek_IndexAdd( p_stream, i_time, i_pagepos ) )
+        p_sys->seekindex.b_dirty = true;
+}
+
+char * OggSeek_IndexGetCachePath( const char *psz_url )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return NULL;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_url, strlen( psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path;
+    if( !psz_hash ||
+        asprintf( &psz_path, "%s" DIR_SEP "ogg-index" DIR_SEP "%s.idx",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+
+    free( psz_hash );
+    free( psz_cachedir );
+    return psz_path;
+}
+
+/* File layout, big endian: magic, file size (8), streams count (4), then for
+ * each stream its serial number (4), points count (4) and points as
+ * time (8), page position (8) */
+void OggSeek_IndexLoad( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if ( p_sys->seekindex.psz_path == NULL )
+        return;
+
+    FILE *p_file = vlc_fopen( p_sys->seekindex.psz_path, "rb" );
+    if ( !p_file )
+        return;
+
+    uint8_t header[8 + 8 + 4];
+    if ( fread( header, sizeof(header), 1, p_file ) != 1 ||
+         memcmp( header, SEEKINDEX_MAGIC, 8 ) ||
+         GetQWBE( &header[8] ) != p_sys->seekindex.i_size )
+    {
+        fclose( p_file );
+        return;
+    }
+
+    size_t i_loaded = 0;
+    for ( uint32_t i_streams = GetDWBE( &header[16] ); i_streams > 0; i_streams-- )
+    {
+        uint8_t stream[4 + 4];
+        if ( fread( stream, sizeof(stream), 1, p_file ) != 1 )
+            break;
+
+        const uint32_t i_serial = GetDWBE( &stream[0] );
+        const uint32_t i_count = GetDWBE( &stream[4] );
+        if ( i_count > SEEKINDEX_MAX_POINTS )
+            break;
+
+        logical_stream_t *p_stream = NULL;
+        for ( int i = 0; i < p_sys->i_streams; i++ )
+            if ( (uint32_t) p_sys->pp_stream[i]->i_serial_no == i_serial )
+                p_stream = p_sys->pp_stream[i];
+
+        bool b_error = false;
+        for ( uint32_t i = 0; i < i_count && !b_error; i++ )
+        {
+            uint8_t point[8 + 8];
+            if ( fread( point, sizeof(point), 1, p_file ) != 1 )
+            {
+                b_error = true;
+                break;
+            }
+            vlc_tick_t i_time = GetQWBE( &point[0] );
+            int64_t i_pagepos = GetQWBE( &point[8] );
+            if ( i_pagepos < 1 || (uint64_t) i_pagepos >= p_sys->seekindex.i_size )
+                b_error = true;
+            else if ( p_stream && OggSeek_IndexAdd( p_stream, i_time, i_pagepos ) )
+                i_loaded++;
+        }
+        if ( b_error )
+            break;
+    }
+    fclose( p_file );
+
+    msg_Dbg( p_demux, "loaded %zu seek index points", i_loaded );
+}
+
+void OggSeek_IndexSave( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const char *psz_path = p_sys->seekindex.psz_path;
+
+    if ( psz_path == NULL || !p_sys->seekindex.b_dirty )
+        return;
+    p_sys->seekindex.b_dirty = false;
+
+    /* Create the ogg-index cache directory if needed */
+    const char *psz_sep = strrchr( psz_path, DIR_SEP_CHAR );
+    if( psz_sep )
+    {
+        char *psz_dir = strndup( psz_path, psz_sep - psz_path );
+        if( !psz_dir )
+            return;
+        const char *psz_parent = strrchr( psz_dir, DIR_SEP_CHAR );
+        if( psz_parent )
+        {
+            char *psz_cachedir = strndup( psz_dir, psz_parent - psz_dir );
+            if( psz_cachedir )
+                vlc_mkdir( psz_cachedir, 0700 );
+            free( psz_cachedir );
+        }
+        if( vlc_mkdir( psz_dir, 0700 ) && errno != EEXIST )
+        {
+            free( psz_dir );
+            return;
+        }
+        free( psz_dir );
+    }
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.part", psz_path ) == -1 )
+        return;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( !p_file )
+    {
+        free( psz_tmp );
+        return;
+    }
+
+    bool b_error = false;
+    uint8_t header[8 + 8 + 4];
+    memcpy( header, SEEKINDEX_MAGIC, 8 );
+    SetQWBE( &header[8], p_sys->seekindex.i_size );
+    SetDWBE( &header[16], p_sys->i_streams );
+    b_error |= fwrite( header, sizeof(header), 1, p_file ) != 1;
+
+    for ( int i = 0; i < p_sys->i_streams && !b_error; i++ )
+    {
+        const logical_stream_t *p_stream = p_sys->pp_stream[i];
+
+        uint32_t i_count = 0;
+        for ( const demux_index_entry_t *idx = p_stream->idx; idx; idx = idx->p_next )
+            i_count++;
+        i_count = __MIN( i_count, SEEKINDEX_MAX_POINTS );
+
+        uint8_t stream[4 + 4];
+        SetDWBE( &stream[0], p_stream->i_serial_no );
+        SetDWBE( &stream[4], i_count );
+        b_error |= fwrite( stream, sizeof(stream), 1, p_file ) != 1;
+
+        const demux_index_entry_t *idx = p_stream->idx;
+        for ( uint32_t j = 0; j < i_count && !b_error; j++, idx = idx->p_next )
+        {
+            uint8_t point[8 + 8];
+            SetQWBE( &point[0], idx->i_value );
+            SetQWBE( &point[8], idx->i_pagepos );
+            b_error |= fwrite( point, sizeof(point), 1, p_file ) != 1;
+        }
+    }
+
+    b_error |= fclose( p_file ) != 0;
+    if( b_error || vlc_rename( psz_tmp, psz_path ) )
+    {
+        msg_Warn( p_demux, "can't store seek index to %s", psz_path );
+        vlc_unlink( psz_tmp );
+    }
+    free( psz_tmp );
+}
+
 /*********************************************************************
  * private functions
  **********************************************************************/
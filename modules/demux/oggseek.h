@@ -64,6 +64,12 @@ int     Oggseek_SeektoAbsolutetime ( demux_t *, logical_stream_t *, vlc_tick_t )
 const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *, vlc_tick_t, int64_t );
 void    Oggseek_ProbeEnd( demux_t * );
 
+/* Persisted index, built from pages met while playing */
+void    OggSeek_IndexPage( demux_t *, logical_stream_t *, const ogg_page *, int64_t );
+char *  OggSeek_IndexGetCachePath( const char *psz_url );
+void    OggSeek_IndexLoad( demux_t * );
+void    OggSeek_IndexSave( demux_t * );
+
 void oggseek_index_entries_free ( demux_index_entry_t * );
 
 int64_t oggseek_read_page ( demux_t * );
@@ -108,16 +108,20 @@ typedef struct
 {
     size_t  i_line_count;
     size_t  i_line;
+    size_t  i_line_max;
     char    **line;
+    stream_t *s;
 } text_t;
 
 static int  TextLoad( text_t *, stream_t *s );
 static void TextUnload( text_t * );
+static void TextRelease( text_t * );
 
 typedef struct
 {
     vlc_tick_t i_start;
     vlc_tick_t i_stop;
+    vlc_tick_t i_stop_max; /* latest end of this and the previous subtitles */
 
     char    *psz_text;
 } subtitle_t;
@@ -234,6 +238,7 @@ static int Demux( demux_t * );
 static int Control( demux_t *, int, va_list );
 
 static void Fix( demux_t * );
+static void Index( demux_t * );
 static char * get_language_from_filename( const char * );
 
 /*****************************************************************************
@@ -633,16 +638,20 @@ static int Open ( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
-    /* Load the whole file */
+    /* Read the file line by line */
     text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
+    if( TextLoad( &txtlines, p_demux->s ) )
+    {
+        Close( p_this );
+        return VLC_ENOMEM;
+    }
 
     /* Parse it */
-    for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
+    for( size_t i_max = 0; i_max < SIZE_MAX / 2 / sizeof(subtitle_t); )
     {
         if( p_sys->subtitles.i_count >= i_max )
         {
-            i_max += 500;
+            i_max = __MAX( 2 * i_max, 500 );
             subtitle_t *p_realloc = realloc( p_sys->subtitles.p_array, sizeof(subtitle_t) * i_max );
             if( p_realloc == NULL )
             {
@@ -659,6 +668,7 @@ static int Open ( vlc_object_t *p_this )
             break;
 
         p_sys->subtitles.i_count++;
+        TextRelease( &txtlines );
     }
     /* Unload */
     TextUnload( &txtlines );
@@ -681,10 +691,12 @@ static int Open ( vlc_object_t *p_this )
     else
         es_format_Init( &fmt, SPU_ES, VLC_CODEC_SUBT );
 
+    Index( p_demux );
+
     p_sys->subtitles.i_current = 0;
     p_sys->i_length = 0;
     if( p_sys->subtitles.i_count > 0 )
-        p_sys->i_length = p_sys->subtitles.p_array[p_sys->subtitles.i_count-1].i_stop;
+        p_sys->i_length = p_sys->subtitles.p_array[p_sys->subtitles.i_count-1].i_stop_max;
 
     /* Stupid language detection in the filename */
     char * psz_language = get_language_from_filename( p_demux->psz_filepath );
@@ -738,13 +750,34 @@ static void
 ResetCurrentIndex( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
+    const subtitle_t *p_array = p_sys->subtitles.p_array;
+    const vlc_tick_t i_date = p_sys->i_next_demux_date;
+
+    /* Last subtitle starting before the date (or the first one) */
+    size_t i_min = 1, i_max = p_sys->subtitles.i_count;
+    while( i_min < i_max )
     {
-        if( p_sys->subtitles.p_array[i].i_start * p_sys->f_rate >
-            p_sys->i_next_demux_date && i > 0 )
-            break;
-        p_sys->subtitles.i_current = i;
+        size_t i = i_min + ( i_max - i_min ) / 2;
+        if( p_array[i].i_start * p_sys->f_rate > i_date )
+            i_max = i;
+        else
+            i_min = i + 1;
     }
+    const size_t i_last = i_min - 1;
+
+    /* Restart from the first one still displayed at that date, so that
+     * overlapping subtitles are not lost */
+    i_min = 0;
+    i_max = i_last;
+    while( i_min < i_max )
+    {
+        size_t i = i_min + ( i_max - i_min ) / 2;
+        if( p_array[i].i_stop_max * p_sys->f_rate > i_date )
+            i_max = i;
+        else
+            i_min = i + 1;
+    }
+    p_sys->subtitles.i_current = i_min;
 }
 
 /*****************************************************************************
@@ -903,61 +936,107 @@ static void Fix( demux_t *p_demux )
     qsort( p_sys->subtitles.p_array, p_sys->subtitles.i_count, sizeof( p_sys->subtitles.p_array[0] ), subtitle_cmp);
 }
 
-static int TextLoad( text_t *txt, stream_t *s )
+/*****************************************************************************
+ * Index: sort the subtitles by start time if needed, and record the running
+ * maximum of their end times, for seeking in O(log n)
+ *****************************************************************************/
+static void Index( demux_t *p_demux )
 {
-    size_t i_line_max;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    subtitle_t *p_array = p_sys->subtitles.p_array;
+
+    for( size_t i = 1; i < p_sys->subtitles.i_count; i++ )
+    {
+        if( p_array[i].i_start < p_array[i - 1].i_start )
+        {
+            msg_Dbg( p_demux, "subtitles are not sorted" );
+            Fix( p_demux );
+            break;
+        }
+    }
 
+    vlc_tick_t i_stop_max = INT64_MIN;
+    for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
+    {
+        vlc_tick_t i_stop = __MAX( p_array[i].i_start, p_array[i].i_stop );
+        i_stop_max = __MAX( i_stop_max, i_stop );
+        p_array[i].i_stop_max = i_stop_max;
+    }
+}
+
+/* Lines are read from the stream as the parser asks for them, and released
+ * once parsed, so that huge files are not held in memory twice */
+static int TextLoad( text_t *txt, stream_t *s )
+{
     /* init txt */
-    i_line_max          = 500;
+    txt->i_line_max     = 16;
     txt->i_line_count   = 0;
     txt->i_line         = 0;
-    txt->line           = calloc( i_line_max, sizeof( char * ) );
+    txt->s              = s;
+    txt->line           = calloc( txt->i_line_max, sizeof( char * ) );
     if( !txt->line )
         return VLC_ENOMEM;
 
-    /* load the complete file */
-    for( ;; )
-    {
-        char *psz = vlc_stream_ReadLine( s );
+    return VLC_SUCCESS;
+}
+static void TextUnload( text_t *txt )
+{
+    for( size_t i = 0; i < txt->i_line_count; i++ )
+        free( txt->line[i] );
+    free( txt->line );
+    txt->line         = NULL;
+    txt->i_line       = 0;
+    txt->i_line_count = 0;
+}
 
-        if( psz == NULL )
-            break;
+static int TextReadLine( text_t *txt )
+{
+    if( txt->s == NULL || txt->line == NULL )
+        return VLC_EGENERIC;
 
-        txt->line[txt->i_line_count] = psz;
-        if( txt->i_line_count + 1 >= i_line_max )
-        {
-            i_line_max += 100;
-            char **p_realloc = realloc( txt->line, i_line_max * sizeof( char * ) );
-            if( p_realloc == NULL )
-                return VLC_ENOMEM;
-            txt->line = p_realloc;
-        }
-        txt->i_line_count++;
+    if( txt->i_line_count >= txt->i_line_max )
+    {
+        char **p_realloc = realloc( txt->line, 2 * txt->i_line_max * sizeof( char * ) );
+        if( p_realloc == NULL )
+            return VLC_ENOMEM;
+        txt->line = p_realloc;
+        txt->i_line_max *= 2;
     }
 
-    if( txt->i_line_count == 0 )
+    char *psz = vlc_stream_ReadLine( txt->s );
+    if( psz == NULL )
     {
-        free( txt->line );
+        txt->s = NULL; /* end of file */
         return VLC_EGENERIC;
     }
-
+    txt->line[txt->i_line_count++] = psz;
     return VLC_SUCCESS;
 }
-static void TextUnload( text_t *txt )
+
+/* Frees the lines already parsed, but the last two ones as parsers may step
+ * back one line or still point into the current one */
+static void TextRelease( text_t *txt )
 {
-    if( txt->i_line_count )
-    {
-        for( size_t i = 0; i < txt->i_line_count; i++ )
-            free( txt->line[i] );
-        free( txt->line );
-    }
-    txt->i_line       = 0;
-    txt->i_line_count = 0;
+    if( txt->i_line <= 2 )
+        return;
+
+    const size_t i_drop = txt->i_line - 2;
+    for( size_t i = 0; i < i_drop; i++ )
+        free( txt->line[i] );
+    memmove( txt->line, &txt->line[i_drop],
+             ( txt->i_line_count - i_drop ) * sizeof( char * ) );
+    txt->i_line       -= i_drop;
+    txt->i_line_count -= i_drop;
+}
+
+static bool TextIsEnd( text_t *txt )
+{
+    return txt->i_line >= txt->i_line_count && TextReadLine( txt );
 }
 
 static char *TextGetLine( text_t *txt )
 {
-    if( txt->i_line >= txt->i_line_count )
+    if( TextIsEnd( txt ) )
         return( NULL );
 
     return txt->line[txt->i_line++];
@@ -1622,7 +1701,7 @@ static int ParseAQT(vlc_object_t *p_obj, subs_properties_t *p_props, text_t *txt
                  return VLC_ENOMEM;
             strcat( psz_text, s );
             strcat( psz_text, "\n" );
-            if( txt->i_line == txt->i_line_count )
+            if( TextIsEnd( txt ) )
                 break;
         }
     }
@@ -46,6 +46,7 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 145 )
+    set_probe_hints( "tta" )
 
     set_callbacks( Open, Close )
     add_shortcut( "tta" )
@@ -109,37 +109,34 @@ static void tt_node_AttributesToText( struct vlc_memstream *p_stream, const tt_n
 {
     bool b_timed_node = false;
     const vlc_dictionary_t* p_attr_dict = &p_node->attr_dict;
-    for( int i = 0; i < p_attr_dict->i_size; ++i )
+    const vlc_dictionary_entry_t *p_entry;
+    vlc_dictionary_foreach( p_entry, p_attr_dict )
     {
-        for ( vlc_dictionary_entry_t* p_entry = p_attr_dict->p_entries[i];
-                                      p_entry != NULL; p_entry = p_entry->p_next )
-        {
-            const char *psz_value = NULL;
+        const char *psz_value = NULL;
 
-            if( !strcmp(p_entry->psz_key, "begin") ||
-                !strcmp(p_entry->psz_key, "end") ||
-                !strcmp(p_entry->psz_key, "dur") )
-            {
-                b_timed_node = true;
-                /* will remove duration */
-                continue;
-            }
-            else if( !strcmp(p_entry->psz_key, "timeContainer") )
-            {
-                /* also remove sequential timings info (all abs now) */
-                continue;
-            }
-            else
-            {
-                psz_value = (char const*)p_entry->p_value;
-            }
+        if( !strcmp(p_entry->psz_key, "begin") ||
+            !strcmp(p_entry->psz_key, "end") ||
+            !strcmp(p_entry->psz_key, "dur") )
+        {
+            b_timed_node = true;
+            /* will remove duration */
+            continue;
+        }
+        else if( !strcmp(p_entry->psz_key, "timeContainer") )
+        {
+            /* also remove sequential timings info (all abs now) */
+            continue;
+        }
+        else
+        {
+            psz_value = (char const*)p_entry->p_value;
+        }
 
-            if( psz_value == NULL )
-                continue;
+        if( psz_value == NULL )
+            continue;
 
-            vlc_memstream_printf( p_stream, " %s=\"%s\"",
-                                  p_entry->psz_key, psz_value );
-        }
+        vlc_memstream_printf( p_stream, " %s=\"%s\"",
+                              p_entry->psz_key, psz_value );
     }
 
     if( b_timed_node )
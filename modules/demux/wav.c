@@ -52,6 +52,7 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
+    set_probe_hints( "wav,wave,audio/wav,audio/x-wav" )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -41,9 +41,13 @@ using PlaylistItemPtr = vlc_shared_data_ptr_type(vlc_playlist_item_t,
 /**
  * Playlist item wrapper.
  *
- * It contains both the PlaylistItemPtr and cached data saved while the playlist
+ * It contains both the PlaylistItemPtr and cached data saved while the media
  * is locked, so that the fields may be read without synchronization or race
  * conditions.
+ *
+ * The cached data are read from the media on first access rather than on
+ * creation, so that wrapping a huge playlist only costs the rows actually
+ * displayed.
  */
 class PlaylistItem
 {
@@ -80,10 +84,13 @@ public:
     void sync();
 
 private:
+    void ensureSynced() const;
+
     struct Data : public QSharedData {
         PlaylistItemPtr item;
 
         bool selected = false;
+        bool synced = false;
 
         /* cached values */
         QString title;
@@ -34,6 +34,7 @@ static QVector<PlaylistItem> toVec(vlc_playlist_item_t *const items[],
                                    size_t len)
 {
     QVector<PlaylistItem> vec;
+    vec.reserve(len);
     for (size_t i = 0; i < len; ++i)
         vec.push_back(items[i]);
     return vec;
@@ -115,10 +116,7 @@ on_playlist_items_updated(vlc_playlist_t *playlist, size_t index,
     that->callAsync([=](){
         if (that->m_playlist != playlist)
             return;
-        int count = updated.size();
-        for (int i = 0; i < count; ++i)
-            that->m_items[index + i] = updated[i]; /* sync metadata */
-        that->notifyItemsChanged(index, count);
+        that->onItemsUpdated(updated, index);
     });
 }
 
@@ -175,6 +173,8 @@ PlaylistListModelPrivate::~PlaylistListModelPrivate()
 void PlaylistListModelPrivate::onItemsReset(const QVector<PlaylistItem>& newContent)
 {
     Q_Q(PlaylistListModel);
+    /* all the rows are refreshed anyway */
+    m_changedFirst = m_changedLast = -1;
     q->beginResetModel();
     m_items = newContent;
     q->endResetModel();
@@ -186,6 +186,7 @@ void PlaylistListModelPrivate::onItemsAdded(const QVector<PlaylistItem>& added,
 {
     Q_Q(PlaylistListModel);
     int count = added.size();
+    flushItemsChanged();
     q->beginInsertRows({}, index, index + count - 1);
     m_items.insert(index, count, nullptr);
     std::move(added.cbegin(), added.cend(), m_items.begin() + index);
@@ -204,6 +205,7 @@ void PlaylistListModelPrivate::onItemsMoved(size_t index, size_t count, size_t t
        * the slice _after_ the move. */
         qtTarget += count;
 
+    flushItemsChanged();
     q->beginMoveRows({}, index, index + count - 1, {}, qtTarget);
     if (index < target)
         std::rotate(m_items.begin() + index,
@@ -219,6 +221,7 @@ void PlaylistListModelPrivate::onItemsMoved(size_t index, size_t count, size_t t
 void PlaylistListModelPrivate::onItemsRemoved(size_t index, size_t count)
 {
     Q_Q(PlaylistListModel);
+    flushItemsChanged();
     q->beginRemoveRows({}, index, index + count - 1);
     m_items.remove(index, count);
     q->endRemoveRows();
@@ -226,6 +229,31 @@ void PlaylistListModelPrivate::onItemsRemoved(size_t index, size_t count)
     emit q->countChanged(m_items.size());
 }
 
+void PlaylistListModelPrivate::onItemsUpdated(const QVector<PlaylistItem>& updated,
+                                              size_t index)
+{
+    int count = updated.size();
+    for (int i = 0; i < count; ++i)
+    {
+        /* the metadata will be read again on the next access */
+        bool selected = m_items[index + i].isSelected();
+        m_items[index + i] = updated[i];
+        m_items[index + i].setSelected(selected);
+    }
+
+    bool pending = m_changedFirst != -1;
+    int last = index + count - 1;
+    if (!pending || (int) index < m_changedFirst)
+        m_changedFirst = index;
+    if (!pending || last > m_changedLast)
+        m_changedLast = last;
+
+    /* the updates of a batch are queued together, notify after all of them
+     * have been applied */
+    if (!pending)
+        callAsync([this]() { flushItemsChanged(); });
+}
+
 
 void
 PlaylistListModelPrivate::notifyItemsChanged(int idx, int count, const QVector<int> &roles)
@@ -236,6 +264,16 @@ PlaylistListModelPrivate::notifyItemsChanged(int idx, int count, const QVector<i
     emit q->dataChanged(first, last, roles);
 }
 
+void PlaylistListModelPrivate::flushItemsChanged()
+{
+    if (m_changedFirst == -1)
+        return;
+    int first = m_changedFirst;
+    int count = m_changedLast - m_changedFirst + 1;
+    m_changedFirst = m_changedLast = -1;
+    notifyItemsChanged(first, count);
+}
+
 // public API
 
 PlaylistListModel::PlaylistListModel(QObject *parent)
@@ -53,9 +53,11 @@ public:
     void onItemsAdded(const QVector<PlaylistItem>& added, size_t index);
     void onItemsMoved(size_t index, size_t count, size_t target);
     void onItemsRemoved(size_t index, size_t count);
+    void onItemsUpdated(const QVector<PlaylistItem>& updated, size_t index);
 
     void notifyItemsChanged(int index, int count,
                             const QVector<int> &roles = {});
+    void flushItemsChanged();
 
     vlc_playlist_t* m_playlist = nullptr;
     vlc_playlist_listener_id *m_listener = nullptr;
@@ -63,6 +65,11 @@ public:
     /* access only from the UI thread */
     QVector<PlaylistItem> m_items;
     ssize_t m_current = -1;
+
+    /* rows updated but not notified yet, merged into a single range so that
+     * a batch of updates results in one dataChanged() */
+    int m_changedFirst = -1;
+    int m_changedLast = -1;
 };
 
 } //namespace playlist
@@ -344,7 +344,8 @@ int D3D9OpenConverter( vlc_object_t *obj )
     if (!p_sys)
          return VLC_ENOMEM;
 
-    if (CopyInitCache(&p_sys->cache, p_filter->fmt_in.video.i_width * pixel_bytes))
+    if (CopyInitCacheFilter(&p_sys->cache, p_filter->fmt_in.video.i_width * pixel_bytes,
+                            p_filter))
     {
         free(p_sys);
         return VLC_ENOMEM;
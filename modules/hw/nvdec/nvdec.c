@@ -382,9 +382,14 @@ static int CUDAAPI HandlePictureDisplay(void *p_opaque, CUVIDPARSERDISPINFO *p_d
         picctx->nvdecDevice.cuCtx = p_sys->cuCtx;
         picctx->nvdecDevice.cudaFunctions = p_sys->cudaFunctions;
 
+        const unsigned i_height = __MIN(picctx->bufferHeight, p_dec->fmt_out.video.i_y_offset + p_dec->fmt_out.video.i_visible_height);
+        /* When the mapped frame has the same layout as our buffer, copy both
+         * planes at once, the chroma plane follows the luma rows in both */
+        const bool b_single_copy = i_pitch == picctx->bufferPitch &&
+                                   i_height == picctx->bufferHeight;
         size_t srcY = 0;
         size_t dstY = 0;
-        for (int i_plane = 0; i_plane < 2; i_plane++) {
+        for (int i_plane = 0; i_plane < (b_single_copy ? 1 : 2); i_plane++) {
             CUDA_MEMCPY2D cu_cpy = {
                 .srcMemoryType  = CU_MEMORYTYPE_DEVICE,
                 .srcDevice      = frameDevicePtr,
@@ -395,9 +400,11 @@ static int CUDAAPI HandlePictureDisplay(void *p_opaque, CUVIDPARSERDISPINFO *p_d
                 .dstPitch       = picctx->bufferPitch,
                 .dstY           = dstY,
                 .WidthInBytes   = i_pitch,
-                .Height         = __MIN(picctx->bufferHeight, p_dec->fmt_out.video.i_y_offset + p_dec->fmt_out.video.i_visible_height),
+                .Height         = i_height,
             };
-            if (i_plane == 1)
+            if (b_single_copy)
+                cu_cpy.Height += i_height >> 1;
+            else if (i_plane == 1)
                 cu_cpy.Height >>= 1;
             result = CALL_CUDA_DEC(cuMemcpy2DAsync, &cu_cpy, 0);
             if (unlikely(result != VLC_SUCCESS))
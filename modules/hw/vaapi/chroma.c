@@ -374,8 +374,8 @@ vlc_vaapi_OpenChroma(vlc_object_t *obj)
         filter_sys->dest_pics = NULL;
     }
 
-    if (CopyInitCache(&filter_sys->cache, filter->fmt_in.video.i_width
-                      * pixel_bytes))
+    if (CopyInitCacheFilter(&filter_sys->cache, filter->fmt_in.video.i_width
+                            * pixel_bytes, filter))
     {
         if (is_upload)
         {
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * chrome_trace.c: Chrome trace event format tracer
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+
+/*
+ * The output is a JSON array of trace events, as loaded by chrome://tracing
+ * and the Perfetto UI. Both accept an array without the closing bracket, so
+ * the trace remains usable if VLC does not exit cleanly.
+ */
+typedef struct
+{
+    vlc_mutex_t lock;
+    FILE *stream;
+    bool first;
+    long pid;
+} vlc_tracer_sys_t;
+
+#define TRACE_FILENAME "vlc-trace.json"
+
+static void PrintString(FILE *stream, const char *str)
+{
+    putc_unlocked('"', stream);
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+            putc_unlocked('\\', stream);
+        if (c < 0x20)
+            fprintf(stream, "\\u%04x", c);
+        else
+            putc_unlocked(c, stream);
+    }
+    putc_unlocked('"', stream);
+}
+
+static void Trace(void *opaque, const struct vlc_tracer_event *ev)
+{
+    static const char phase[] = { 'B', 'E', 'i' };
+    vlc_tracer_sys_t *sys = opaque;
+    FILE *stream = sys->stream;
+
+    vlc_mutex_lock(&sys->lock);
+    flockfile(stream);
+    fputs(sys->first ? "[\n" : ",\n", stream);
+    sys->first = false;
+    fputs("{\"name\":", stream);
+    PrintString(stream, ev->name != NULL ? ev->name : "");
+    fputs(",\"cat\":", stream);
+    PrintString(stream, ev->category != NULL ? ev->category : "");
+    fprintf(stream, ",\"ph\":\"%c\",\"ts\":%"PRId64",\"pid\":%ld,\"tid\":%lu",
+            phase[ev->phase], US_FROM_VLC_TICK(ev->date), sys->pid,
+            ev->thread);
+    if (ev->phase == VLC_TRACER_INSTANT)
+        fputs(",\"s\":\"t\"", stream);
+    putc_unlocked('}', stream);
+    funlockfile(stream);
+    vlc_mutex_unlock(&sys->lock);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    fputs(sys->first ? "[]\n" : "\n]\n", sys->stream);
+    fclose(sys->stream);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations chrome_trace_ops =
+{
+    Trace,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                                void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    char *path = var_InheritString(obj, "chrome-trace-file");
+    const char *filename = (path != NULL) ? path : TRACE_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wt");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    vlc_mutex_init(&sys->lock);
+    sys->first = true;
+    sys->pid = getpid();
+
+    *sysp = sys;
+    return &chrome_trace_ops;
+}
+
+#define FILENAME_TEXT N_("Trace filename")
+#define FILENAME_LONGTEXT N_("Specify the file to write the trace events to.")
+
+vlc_module_begin()
+    set_shortname(N_("Chrome trace"))
+    set_description(N_("Chrome trace event format tracer"))
+    set_category(CAT_ADVANCED)
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    add_shortcut("chrome-trace", "chrome_trace")
+    set_callback(Open)
+
+    add_savefile("chrome-trace-file", TRACE_FILENAME,
+                 FILENAME_TEXT, FILENAME_LONGTEXT)
+vlc_module_end()
@@ -625,6 +625,8 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_INT( lost_pictures )
         STATS_INT( played_abuffers )
         STATS_INT( lost_abuffers )
+        STATS_FLOAT( clock_drift )
+        STATS_INT( clock_jitter )
 #undef STATS_INT
 #undef STATS_FLOAT
     }
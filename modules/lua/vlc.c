@@ -39,6 +39,7 @@
 #include <vlc_arrays.h>
 #include <vlc_charset.h>
 #include <vlc_fs.h>
+#include <vlc_memstream.h>
 #include <vlc_services_discovery.h>
 #include <vlc_stream.h>
 
@@ -652,17 +653,139 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
+/*****************************************************************************
+ * Compiled scripts cache
+ *
+ * The scripts are loaded again for every probe: all the playlist scripts are
+ * tried against each opened stream. Keep the compiled chunks of the local
+ * scripts, until the files are modified.
+ *****************************************************************************/
+#define VLCLUA_CHUNKS_MAX_SIZE (4 << 20)
+
+struct vlclua_chunk
+{
+    struct vlclua_chunk *next;
+    char *path;
+    time_t mtime;
+    off_t size;
+    size_t length;
+    char code[];
+};
+
+static vlc_mutex_t chunks_lock = VLC_STATIC_MUTEX;
+static struct vlclua_chunk *chunks = NULL;
+static size_t chunks_size = 0;
+
+static int vlclua_chunk_write( lua_State *L, const void *p, size_t len,
+                               void *opaque )
+{
+    vlc_memstream_write( opaque, p, len );
+    (void) L;
+    return 0;
+}
+
+/* Returns the cached chunk of a file, and removes it if it is stale */
+static struct vlclua_chunk *vlclua_chunk_find( const char *path,
+                                               const struct stat *st )
+{
+    for( struct vlclua_chunk **pp = &chunks, *c; (c = *pp) != NULL;
+         pp = &c->next )
+    {
+        if( strcmp( c->path, path ) )
+            continue;
+        if( c->mtime == st->st_mtime && c->size == st->st_size )
+            return c;
+
+        *pp = c->next;
+        chunks_size -= c->length;
+        free( c->path );
+        free( c );
+        break;
+    }
+    return NULL;
+}
+
+static void vlclua_chunk_add( lua_State *L, const char *path,
+                              const struct stat *st )
+{
+    struct vlc_memstream code;
+
+    vlc_memstream_open( &code );
+#if LUA_VERSION_NUM >= 503
+    lua_dump( L, vlclua_chunk_write, &code, 0 );
+#else
+    lua_dump( L, vlclua_chunk_write, &code );
+#endif
+    if( vlc_memstream_close( &code ) )
+        return;
+
+    vlc_mutex_lock( &chunks_lock );
+    if( chunks_size + code.length <= VLCLUA_CHUNKS_MAX_SIZE
+     && vlclua_chunk_find( path, st ) == NULL )
+    {
+        struct vlclua_chunk *c = malloc( sizeof (*c) + code.length );
+        if( likely(c != NULL) && (c->path = strdup( path )) != NULL )
+        {
+            c->mtime = st->st_mtime;
+            c->size = st->st_size;
+            c->length = code.length;
+            memcpy( c->code, code.ptr, code.length );
+            c->next = chunks;
+            chunks = c;
+            chunks_size += code.length;
+        }
+        else
+            free( c );
+    }
+    vlc_mutex_unlock( &chunks_lock );
+    free( code.ptr );
+}
+
+/* Replacement for luaL_loadfile, using the compiled scripts cache */
+static int vlclua_loadfile( lua_State *L, const char *path,
+                            const char *locale_path )
+{
+    struct stat st;
+    int ret;
+
+    if( vlc_stat( path, &st ) )
+        return luaL_loadfile( L, locale_path );
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *c = vlclua_chunk_find( path, &st );
+    if( c != NULL )
+    {
+        /* The chunk keeps its debug information, including its source */
+        ret = luaL_loadbuffer( L, c->code, c->length, locale_path );
+        vlc_mutex_unlock( &chunks_lock );
+        return ret;
+    }
+    vlc_mutex_unlock( &chunks_lock );
+
+    ret = luaL_loadfile( L, locale_path );
+    if( ret == 0 )
+        vlclua_chunk_add( L, path, &st );
+    return ret;
+}
+
 /** Replacement for luaL_dofile, using VLC's input capabilities */
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
     char *uri = ToLocaleDup( curi );
+    const char *path = NULL, *locale_path = uri;
+
     if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
-        free( uri );
-        return ret;
+        path = curi;
+        locale_path = uri;
+    }
+    else if( !strncasecmp( uri, "file://", 7 ) ) {
+        path = curi + 7;
+        locale_path = uri + 7;
     }
-    if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
+    if( path != NULL ) {
+        int ret = vlclua_loadfile( L, path, locale_path );
+        if( ret == 0 )
+            ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
         free( uri );
         return ret;
     }
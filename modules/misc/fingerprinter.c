@@ -165,16 +165,18 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
 
     input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
     free( psz_sout_option );
-    if ( fp->i_duration )
+
+    /* Only the beginning of the track is fingerprinted, with some margin */
+    unsigned i_stop = var_InheritInteger( p_fingerprinter, "duration" ) + 1;
+    if ( fp->i_duration && fp->i_duration < i_stop )
+        i_stop = fp->i_duration;
+    if ( asprintf( &psz_sout_option, "stop-time=%u", i_stop ) == -1 )
     {
-        if ( asprintf( &psz_sout_option, "stop-time=%u", fp->i_duration ) == -1 )
-        {
-            input_item_Release( p_item );
-            return;
-        }
-        input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
-        free( psz_sout_option );
+        input_item_Release( p_item );
+        return;
     }
+    input_item_AddOption( p_item, psz_sout_option, VLC_INPUT_OPTION_TRUSTED );
+    free( psz_sout_option );
     input_item_SetURI( p_item, psz_uri ) ;
 
     chromaprint_fingerprint_t chroma_fingerprint;
@@ -193,7 +195,6 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
     int ret = vlc_player_SetCurrentMedia(player, p_item);
     if (ret == VLC_SUCCESS)
         ret = vlc_player_Start(player);
-    input_item_Release(p_item);
 
     if (ret == VLC_SUCCESS)
     {
@@ -203,10 +204,18 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
 
         fp->psz_fingerprint = chroma_fingerprint.psz_fingerprint;
         if( !fp->i_duration ) /* had not given hint */
-            fp->i_duration = chroma_fingerprint.i_duration;
+        {
+            /* The decoding stopped early, prefer the demuxer length */
+            vlc_tick_t i_length = input_item_GetDuration( p_item );
+            if( i_length > 0 )
+                fp->i_duration = SEC_FROM_VLC_TICK( i_length );
+            else
+                fp->i_duration = chroma_fingerprint.i_duration;
+        }
     }
 
     vlc_player_Unlock(player);
+    input_item_Release(p_item);
 }
 
 /*****************************************************************************
@@ -24,9 +24,10 @@
 
 #include "medialibrary.h"
 
+#include <algorithm>
+
 MetadataExtractor::MetadataExtractor( vlc_object_t* parent )
-    : m_currentCtx( nullptr )
-    , m_obj( parent )
+    : m_obj( parent )
 {
 }
 
@@ -37,7 +38,7 @@ void MetadataExtractor::onParserEnded( ParseContext& ctx, int status )
     // We need to probe the item now, but not from the input thread
     ctx.success = status == VLC_SUCCESS;
     ctx.needsProbing = true;
-    ctx.mde->m_cond.signal();
+    ctx.cond.signal();
 }
 
 void MetadataExtractor::populateItem( medialibrary::parser::IItem& item, input_item_t* inputItem )
@@ -151,25 +152,22 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
         &MetadataExtractor::onParserEnded,
         &MetadataExtractor::onParserSubtreeAdded,
     };
-    m_currentCtx = &ctx;
     ctx.inputItem->i_preparse_depth = 1;
-    ctx.inputParser = {
-        input_item_Parse( ctx.inputItem.get(), m_obj, &cbs,
-                          std::addressof( ctx ) ),
-        &input_item_parser_id_Release
-    };
-    if ( ctx.inputParser == nullptr )
-    {
-        m_currentCtx = nullptr;
-        return medialibrary::parser::Status::Fatal;
-    }
-
     {
         vlc::threads::mutex_locker lock( m_mutex );
+        ctx.inputParser = {
+            input_item_Parse( ctx.inputItem.get(), m_obj, &cbs,
+                              std::addressof( ctx ) ),
+            &input_item_parser_id_Release
+        };
+        if ( ctx.inputParser == nullptr )
+            return medialibrary::parser::Status::Fatal;
+        m_contexts.push_back( &ctx );
+
         auto deadline = vlc_tick_now() + VLC_TICK_FROM_SEC( 5 );
-        while ( ctx.needsProbing == false && ctx.inputParser != nullptr )
+        while ( ctx.needsProbing == false )
         {
-            auto res = m_cond.timedwait( m_mutex, deadline );
+            auto res = ctx.cond.timedwait( m_mutex, deadline );
             if ( res != 0 )
             {
                 msg_Dbg( m_obj, "Timed out while extracting %s metadata",
@@ -177,7 +175,8 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
                 break;
             }
         }
-        m_currentCtx = nullptr;
+        m_contexts.erase( std::find( begin( m_contexts ), end( m_contexts ),
+                                     &ctx ) );
     }
 
     if ( !ctx.success || ctx.inputParser == nullptr )
@@ -214,6 +213,6 @@ void MetadataExtractor::onRestarted()
 void MetadataExtractor::stop()
 {
     vlc::threads::mutex_locker lock{ m_mutex };
-    if ( m_currentCtx != nullptr )
-        input_item_parser_id_Interrupt( m_currentCtx->inputParser.get() );
+    for ( auto ctx : m_contexts )
+        input_item_parser_id_Interrupt( ctx->inputParser.get() );
 }
@@ -28,16 +28,161 @@
 #include <vlc_fs.h>
 #include <vlc_block.h>
 #include <vlc_url.h>
+#include <vlc_md5.h>
+#include <vlc_stream.h>
+#include <vlc_configuration.h>
 #include <vlc_cxx_helpers.hpp>
 
+#include <algorithm>
+#include <new>
+#include <sys/stat.h>
+
+/* Amount of data hashed at the beginning and at the end of the files */
+#define CACHE_HASH_SIZE (64 * 1024)
+
 Thumbnailer::Thumbnailer( vlc_medialibrary_module_t* ml )
     : m_ml( ml )
+    , m_cacheMaxSize( 0 )
     , m_currentContext( nullptr )
     , m_thumbnailer( nullptr, &vlc_thumbnailer_Release )
 {
     m_thumbnailer.reset( vlc_thumbnailer_Create( VLC_OBJECT( ml ) ) );
     if ( unlikely( m_thumbnailer == nullptr ) )
         throw std::runtime_error( "Failed to instantiate a vlc_thumbnailer_t" );
+
+    auto cacheSize = var_InheritInteger( ml, "ml-thumbnail-cache-size" );
+    auto cacheDir = vlc::wrap_cptr( config_GetUserDir( VLC_CACHE_DIR ) );
+    if ( cacheSize > 0 && cacheDir != nullptr )
+    {
+        m_cacheDir = std::string{ cacheDir.get() } + DIR_SEP "thumbnails";
+        m_cacheMaxSize = static_cast<uint64_t>( cacheSize ) << 20;
+        vlc_mkdir( cacheDir.get(), 0700 );
+        vlc_mkdir( m_cacheDir.c_str(), 0700 );
+    }
+}
+
+/* The cache key identifies the content rather than the location, so that the
+ * copies of a file on several devices share the same thumbnail */
+std::string Thumbnailer::cacheKey( const std::string& mrl, uint32_t desiredWidth,
+                                   uint32_t desiredHeight, float position )
+{
+    if ( m_cacheMaxSize == 0 )
+        return {};
+
+    auto stream = vlc::wrap_cptr( vlc_stream_NewURL( m_ml, mrl.c_str() ),
+                                  &vlc_stream_Delete );
+    uint64_t size;
+    if ( stream == nullptr || vlc_stream_GetSize( stream.get(), &size ) != 0 )
+        return {};
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, &size, sizeof( size ) );
+    AddMD5( &md5, &desiredWidth, sizeof( desiredWidth ) );
+    AddMD5( &md5, &desiredHeight, sizeof( desiredHeight ) );
+    AddMD5( &md5, &position, sizeof( position ) );
+
+    std::unique_ptr<uint8_t[]> buf{ new (std::nothrow) uint8_t[CACHE_HASH_SIZE] };
+    if ( buf == nullptr )
+        return {};
+
+    auto len = vlc_stream_Read( stream.get(), buf.get(), CACHE_HASH_SIZE );
+    if ( len <= 0 )
+        return {};
+    AddMD5( &md5, buf.get(), len );
+
+    if ( size > 2 * CACHE_HASH_SIZE )
+    {
+        if ( vlc_stream_Seek( stream.get(), size - CACHE_HASH_SIZE ) != 0 )
+            return {};
+        len = vlc_stream_Read( stream.get(), buf.get(), CACHE_HASH_SIZE );
+        if ( len <= 0 )
+            return {};
+        AddMD5( &md5, buf.get(), len );
+    }
+    EndMD5( &md5 );
+
+    auto hash = vlc::wrap_cptr( psz_md5_hash( &md5 ) );
+    if ( hash == nullptr )
+        return {};
+    return m_cacheDir + DIR_SEP + hash.get() + ".jpg";
+}
+
+bool Thumbnailer::loadFromCache( const std::string& key, const std::string& dest )
+{
+    auto in = vlc::wrap_cptr( vlc_fopen( key.c_str(), "rb" ), &fclose );
+    if ( in == nullptr )
+        return false;
+    auto out = vlc::wrap_cptr( vlc_fopen( dest.c_str(), "wb" ), &fclose );
+    if ( out == nullptr )
+        return false;
+
+    char buf[4096];
+    size_t len;
+    while ( ( len = fread( buf, 1, sizeof( buf ), in.get() ) ) > 0 )
+    {
+        if ( fwrite( buf, len, 1, out.get() ) != 1 )
+            return false;
+    }
+    return ferror( in.get() ) == 0;
+}
+
+void Thumbnailer::storeInCache( const std::string& key, const block_t* block )
+{
+    auto f = vlc::wrap_cptr( vlc_fopen( key.c_str(), "wb" ), &fclose );
+    if ( f == nullptr )
+        return;
+    if ( fwrite( block->p_buffer, block->i_buffer, 1, f.get() ) != 1 )
+    {
+        f.reset();
+        vlc_unlink( key.c_str() );
+        return;
+    }
+    f.reset();
+    evictCache();
+}
+
+/* Remove the oldest thumbnails until the cache fits its maximum size */
+void Thumbnailer::evictCache()
+{
+    struct Entry
+    {
+        std::string path;
+        time_t mtime;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    auto dir = vlc::wrap_cptr( vlc_opendir( m_cacheDir.c_str() ), &closedir );
+    if ( dir == nullptr )
+        return;
+
+    const char* name;
+    while ( ( name = vlc_readdir( dir.get() ) ) != nullptr )
+    {
+        std::string path = m_cacheDir + DIR_SEP + name;
+        struct stat st;
+        if ( vlc_stat( path.c_str(), &st ) != 0 || !S_ISREG( st.st_mode ) )
+            continue;
+        entries.push_back( Entry{ std::move( path ), st.st_mtime,
+                                  static_cast<uint64_t>( st.st_size ) } );
+        total += st.st_size;
+    }
+    if ( total <= m_cacheMaxSize )
+        return;
+
+    std::sort( begin( entries ), end( entries ),
+               []( const Entry& a, const Entry& b ) {
+                   return a.mtime < b.mtime;
+               });
+    for ( const auto& e : entries )
+    {
+        if ( total <= m_cacheMaxSize )
+            break;
+        if ( vlc_unlink( e.path.c_str() ) == 0 )
+            total -= e.size;
+    }
 }
 
 void Thumbnailer::onThumbnailComplete( void* data, picture_t* thumbnail )
@@ -63,6 +208,10 @@ bool Thumbnailer::generate( const std::string& mrl, uint32_t desiredWidth,
     if ( unlikely( item == nullptr ) )
         return false;
 
+    auto key = cacheKey( mrl, desiredWidth, desiredHeight, position );
+    if ( !key.empty() && loadFromCache( key, dest ) )
+        return true;
+
     input_item_AddOption( item.get(), "no-hwdec", VLC_INPUT_OPTION_TRUSTED );
     ctx.done = false;
     ctx.thumbnailer = this;
@@ -92,6 +241,9 @@ bool Thumbnailer::generate( const std::string& mrl, uint32_t desiredWidth,
         return false;
     if ( fwrite( block->p_buffer, block->i_buffer, 1, f.get() ) != 1 )
         return false;
+
+    if ( !key.empty() )
+        storeInCache( key, block );
     return true;
 }
 
@@ -200,7 +200,9 @@ SDDirectory::read() const
         if (type == ITEM_TYPE_DIRECTORY)
             m_dirs.push_back(std::make_shared<SDDirectory>(mrl, m_fs));
         else if (type == ITEM_TYPE_FILE)
-            m_files.push_back(std::make_shared<SDFile>(mrl));
+            /* Let the media library skip the unchanged files on rescan */
+            m_files.push_back(std::make_shared<SDFile>(mrl, m->i_file_size,
+                                                       m->i_file_mtime));
     }
 
     m_read_done = true;
@@ -28,10 +28,13 @@
 namespace vlc {
   namespace medialibrary {
 
-SDFile::SDFile(const std::string &mrl)
+SDFile::SDFile(const std::string &mrl, int64_t size,
+               int64_t lastModificationDate)
     : m_mrl(mrl)
     , m_name(utils::fileName(mrl))
     , m_extension(utils::extension(mrl))
+    , m_size(size)
+    , m_lastModificationDate(lastModificationDate)
 {
 }
 
@@ -56,13 +59,14 @@ SDFile::extension() const
 unsigned int
 SDFile::lastModificationDate() const
 {
-    return 0;
+    /* 0 if unknown: the file is never considered as modified */
+    return m_lastModificationDate > 0 ? m_lastModificationDate : 0;
 }
 
 unsigned int
 SDFile::size() const
 {
-    return 0;
+    return m_size > 0 ? m_size : 0;
 }
 
   } /* namespace medialibrary */
@@ -21,6 +21,7 @@
 #ifndef SD_FILE_H
 #define SD_FILE_H
 
+#include <cstdint>
 #include <medialibrary/filesystem/IFile.h>
 
 namespace vlc {
@@ -31,7 +32,8 @@ using namespace ::medialibrary::fs;
 class SDFile : public IFile
 {
 public:
-    explicit SDFile(const std::string &mrl);
+    explicit SDFile(const std::string &mrl, int64_t size = -1,
+                    int64_t lastModificationDate = -1);
     virtual ~SDFile() = default;
     const std::string& mrl() const override;
     const std::string& name() const override;
@@ -44,6 +46,8 @@ private:
     std::string m_mrl;
     std::string m_name;
     std::string m_extension;
+    int64_t m_size;
+    int64_t m_lastModificationDate;
 };
 
   } /* namespace medialibrary */
@@ -1583,6 +1583,11 @@ static void Close( vlc_object_t* obj )
 #define ML_FOLDER_LONGTEXT _( "Semicolon separated list of folders to discover " \
                               "media from" )
 
+#define ML_THUMBNAIL_CACHE_TEXT _( "Thumbnail cache size (MiB)" )
+#define ML_THUMBNAIL_CACHE_LONGTEXT _( "Maximum size of the cache of the " \
+    "thumbnails, indexed by the content of the media so that identical " \
+    "files are only thumbnailed once. 0 disables the cache." )
+
 vlc_module_begin()
     set_shortname(N_("media library"))
     set_description(N_( "Organize your media" ))
@@ -1591,4 +1596,6 @@ vlc_module_begin()
     set_capability("medialibrary", 100)
     set_callbacks(Open, Close)
     add_string( "ml-folders", nullptr, ML_FOLDER_TEXT, ML_FOLDER_LONGTEXT, false )
+    add_integer( "ml-thumbnail-cache-size", 64, ML_THUMBNAIL_CACHE_TEXT,
+                 ML_THUMBNAIL_CACHE_LONGTEXT, true )
 vlc_module_end()
@@ -36,6 +36,7 @@
 #include <vlc_cxx_helpers.hpp>
 
 #include <cstdarg>
+#include <vector>
 
 struct vlc_event_t;
 struct vlc_object_t;
@@ -61,6 +62,7 @@ private:
 
         bool needsProbing;
         bool success;
+        vlc::threads::condition_variable cond;
         MetadataExtractor* mde;
         medialibrary::parser::IItem& item;
         std::unique_ptr<input_item_t, decltype(&input_item_Release)> inputItem;
@@ -93,9 +95,9 @@ private:
                                       void *user_data );
 
 private:
-    vlc::threads::condition_variable m_cond;
     vlc::threads::mutex m_mutex;
-    ParseContext* m_currentCtx;
+    // Items being parsed, run() can be called from several parser threads
+    std::vector<ParseContext*> m_contexts;
     vlc_object_t* m_obj;
 };
 
@@ -123,8 +125,16 @@ public:
 private:
     static void onThumbnailComplete( void* data, picture_t* thumbnail );
 
+    std::string cacheKey( const std::string& mrl, uint32_t desiredWidth,
+                          uint32_t desiredHeight, float position );
+    bool loadFromCache( const std::string& key, const std::string& dest );
+    void storeInCache( const std::string& key, const block_t* block );
+    void evictCache();
+
 private:
     vlc_medialibrary_module_t* m_ml;
+    std::string m_cacheDir;
+    uint64_t m_cacheMaxSize;
     vlc::threads::mutex m_mutex;
     vlc::threads::condition_variable m_cond;
     ThumbnailerCtx* m_currentContext;
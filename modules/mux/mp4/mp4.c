@@ -53,6 +53,23 @@
     "Create \"Fast Start\" files. " \
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
+#define MOOVRESERVE_TEXT N_("Space reserved for the moov header (KiB)")
+#define MOOVRESERVE_LONGTEXT N_(\
+    "When creating \"Fast Start\" files, reserve that much space at the " \
+    "start of the file for the moov header, so that it can be written in " \
+    "place instead of moving all the media data when closing. Plan about " \
+    "10 bytes per sample. The data is only moved if the header does not " \
+    "fit. 0 disables the reservation.")
+#define FRAGDURATION_TEXT N_("Fragment duration (ms)")
+#define FRAGDURATION_LONGTEXT N_(\
+    "Target duration of each moof/mdat fragment when muxing fragmented " \
+    "or streamed MP4. Fragments are written out as soon as that much " \
+    "media has been received, so that memory use stays bounded.")
+#define MFRA_TEXT N_("Write fragment random access index")
+#define MFRA_LONGTEXT N_(\
+    "Append a \"mfra\" box indexing the keyframes of each track at the end " \
+    "of fragmented MP4 files. The index grows with the duration of the " \
+    "recording. This has no effect when streaming.")
 
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
@@ -69,6 +86,14 @@ vlc_module_begin ()
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT,
               true)
+    add_integer(SOUT_CFG_PREFIX "moov-reserve", 0,
+                MOOVRESERVE_TEXT, MOOVRESERVE_LONGTEXT, true)
+        change_integer_range(0, 65536)
+    add_integer(SOUT_CFG_PREFIX "frag-duration", 1500,
+                FRAGDURATION_TEXT, FRAGDURATION_LONGTEXT, true)
+        change_integer_range(100, 60000)
+    add_bool(SOUT_CFG_PREFIX "mfra", true,
+              MFRA_TEXT, MFRA_LONGTEXT, true)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -88,7 +113,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "moov-reserve", "frag-duration", "mfra", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -158,6 +183,8 @@ typedef struct
     mp4mux_handle_t *muxh;
     bool b_3gp;
     bool b_fast_start;
+    uint32_t i_moov_reserve;
+    uint64_t i_moov_reserve_pos;
 
     /* global */
     bool     b_header_sent;
@@ -172,6 +199,8 @@ typedef struct
 
 
     /* mp4frag */
+    vlc_tick_t     i_frag_duration;
+    bool           b_mfra;
     vlc_tick_t     i_written_duration;
     uint32_t       i_mfhd_sequence;
 } sout_mux_sys_t;
@@ -241,6 +270,22 @@ static int WriteSlowStartHeader(sout_mux_t *p_mux)
         box_send(p_mux, box);
     }
 
+    /* Reserve room for the final moov as a free box */
+    if (p_sys->b_fast_start && p_sys->i_moov_reserve)
+    {
+        block_t *p_free = block_Alloc(p_sys->i_moov_reserve);
+        if (!p_free)
+            return VLC_ENOMEM;
+        memset(p_free->p_buffer, 0, p_free->i_buffer);
+        SetDWBE(p_free->p_buffer, p_free->i_buffer);
+        memcpy(&p_free->p_buffer[4], "free", 4);
+
+        p_sys->i_moov_reserve_pos = p_sys->i_pos;
+        p_sys->i_pos += p_free->i_buffer;
+        p_sys->i_mdat_pos = p_sys->i_pos;
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+    }
+
     /* Now add mdat header */
     box = box_new("mdat");
     if(!box)
@@ -287,11 +332,19 @@ static int Open(vlc_object_t *p_this)
     p_sys->pp_streams   = NULL;
     p_sys->i_mdat_pos   = 0;
     p_sys->b_header_sent = false;
+    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
+    p_sys->i_moov_reserve = 1024 * var_GetInteger(p_this, SOUT_CFG_PREFIX "moov-reserve");
+    p_sys->i_moov_reserve_pos = 0;
 
     p_sys->i_read_duration   = 0;
     p_sys->i_written_duration= 0;
     p_sys->i_start_dts = VLC_TICK_INVALID;
     p_sys->i_mfhd_sequence = 1;
+    p_sys->i_frag_duration = VLC_TICK_FROM_MS(
+                var_GetInteger(p_mux, SOUT_CFG_PREFIX "frag-duration"));
+    /* mfra refers to moof by absolute position, so only for files */
+    p_sys->b_mfra = p_mux->psz_mux && !strcmp(p_mux->psz_mux, "mp4frag") &&
+                    var_GetBool(p_mux, SOUT_CFG_PREFIX "mfra");
 
     p_mux->p_sys        = p_sys;
     p_mux->pf_control   = Control;
@@ -349,8 +402,38 @@ static void Close(vlc_object_t *p_this)
     uint64_t i_moov_pos = p_sys->i_pos;
     bo_t *moov = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
 
+    /* Write in the reserved space if the moov fits, leaving
+     * a free box over the remainder */
+    if (p_sys->b_fast_start && p_sys->i_moov_reserve && moov && moov->b)
+    {
+        const uint64_t i_moov_size = bo_size(moov);
+        const uint32_t i_reserve = p_sys->i_moov_reserve;
+        if (i_moov_size == i_reserve || i_moov_size + 8 <= i_reserve)
+        {
+            block_t *p_free = NULL;
+            if (i_moov_size < i_reserve && (p_free = block_Alloc(8)))
+            {
+                SetDWBE(p_free->p_buffer, i_reserve - i_moov_size);
+                memcpy(&p_free->p_buffer[4], "free", 4);
+                sout_AccessOutSeek(p_mux->p_access,
+                                   p_sys->i_moov_reserve_pos + i_moov_size);
+                sout_AccessOutWrite(p_mux->p_access, p_free);
+            }
+            /* otherwise fall back to moving the data */
+            if (i_moov_size == i_reserve || p_free)
+            {
+                i_moov_pos = p_sys->i_moov_reserve_pos;
+                p_sys->b_fast_start = false;
+            }
+        }
+        else
+        {
+            msg_Dbg(p_this, "moov (%"PRIu64" bytes) does not fit in the %"PRIu32
+                    " reserved bytes", i_moov_size, i_reserve);
+        }
+    }
+
     /* Check we need to create "fast start" files */
-    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
     while (p_sys->b_fast_start && moov && moov->b)
     {
         /* Move data to the end of the file so we can fit the moov header
@@ -620,12 +703,17 @@ static block_t * BlockDequeue(sout_input_t *p_input, mp4_stream_t *p_stream)
 
     switch(mp4mux_track_GetFmt(p_stream->tinfo)->i_codec)
     {
+        /* Both rewrite the sample in place */
         case VLC_CODEC_AV1:
-            p_block = AV1_Pack_Sample(p_block);
+            p_block = block_MakeWritable(p_block);
+            if(p_block)
+                p_block = AV1_Pack_Sample(p_block);
             break;
         case VLC_CODEC_H264:
         case VLC_CODEC_HEVC:
-            p_block = hxxx_AnnexB_to_xVC(p_block, 4);
+            p_block = block_MakeWritable(p_block);
+            if(p_block)
+                p_block = hxxx_AnnexB_to_xVC(p_block, 4);
             break;
         case VLC_CODEC_SUBT:
             p_block = ConvertSUBT(p_block);
@@ -893,8 +981,6 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
-#define FRAGMENT_LENGTH  VLC_TICK_FROM_MS(1500)
-
 #define ENQUEUE_ENTRY(object, entry) \
     do {\
         if (object.p_last)\
@@ -1139,7 +1225,8 @@ static bo_t *GetMoofBox(sout_mux_t *p_mux, size_t *pi_mdat_total_size,
                 i_sample++;
 
                 /* Add keyframe entry if needed */
-                if (p_stream->b_hasiframes && (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
+                if (p_sys->b_mfra &&
+                    p_stream->b_hasiframes && (p_entry->p_block->i_flags & BLOCK_FLAG_TYPE_I) &&
                     (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == VIDEO_ES ||
                      mp4mux_track_GetFmt(p_stream->tinfo)->i_cat == AUDIO_ES))
                 {
@@ -1222,7 +1309,13 @@ static bo_t *GetMfraBox(sout_mux_t *p_mux)
         mp4_stream_t *p_stream = p_sys->pp_streams[i];
         if (p_stream->i_indexentries)
         {
-            bo_t *tfra = box_full_new("tfra", 0, 0x0);
+            const uint32_t i_timescale = mp4mux_track_GetTimescale(p_stream->tinfo);
+            const mp4_fragindex_t *p_lastentry =
+                    &p_stream->p_indexentries[p_stream->i_indexentries - 1];
+            /* Long recordings need 64 bits time and offsets */
+            const bool b_64 = p_lastentry->i_moofoffset > UINT32_MAX ||
+                    samples_from_vlc_tick(p_lastentry->i_time, i_timescale) > UINT32_MAX;
+            bo_t *tfra = box_full_new("tfra", b_64 ? 1 : 0, 0x0);
             if (!tfra) continue;
             bo_add_32be(tfra, mp4mux_track_GetID(p_stream->tinfo));
             bo_add_32be(tfra, 0x3); // reserved + lengths (1,1,4)=>(0,0,3)
@@ -1230,8 +1323,18 @@ static bo_t *GetMfraBox(sout_mux_t *p_mux)
             for(uint32_t i_index=0; i_index<p_stream->i_indexentries; i_index++)
             {
                 const mp4_fragindex_t *p_indexentry = &p_stream->p_indexentries[i_index];
-                bo_add_32be(tfra, p_indexentry->i_time);
-                bo_add_32be(tfra, p_indexentry->i_moofoffset);
+                const uint64_t i_time = samples_from_vlc_tick(p_indexentry->i_time,
+                                                              i_timescale);
+                if (b_64)
+                {
+                    bo_add_64be(tfra, i_time);
+                    bo_add_64be(tfra, p_indexentry->i_moofoffset);
+                }
+                else
+                {
+                    bo_add_32be(tfra, i_time);
+                    bo_add_32be(tfra, p_indexentry->i_moofoffset);
+                }
                 assert(sizeof(p_indexentry->i_traf)==1); /* guard against sys changes */
                 assert(sizeof(p_indexentry->i_trun)==1);
                 assert(sizeof(p_indexentry->i_sample)==4);
@@ -1280,7 +1383,7 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    vlc_tick_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    vlc_tick_t i_barrier_time = p_sys->i_written_duration + p_sys->i_frag_duration;
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
 
@@ -1398,7 +1501,7 @@ static void CloseFrag(vlc_object_t *p_this)
 
     /* Write indexes, but only for non streamed content
        as they refer to moof by absolute position */
-    if (!strcmp(p_mux->psz_mux, "mp4frag"))
+    if (p_sys->b_mfra)
     {
         bo_t *mfra = GetMfraBox(p_mux);
         if (mfra)
@@ -1468,7 +1571,7 @@ static int MuxFrag(sout_mux_t *p_mux)
         p_stream->p_held_entry = NULL;
 
         if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < FRAGMENT_LENGTH)
+            mp4mux_track_GetDuration(p_stream->tinfo) - p_sys->i_written_duration < p_sys->i_frag_duration)
         {
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
@@ -1508,8 +1611,10 @@ static int MuxFrag(sout_mux_t *p_mux)
     for (unsigned int i=0; i<p_sys->i_nb_streams; i++)
     {
         const mp4_stream_t *p_s = p_sys->pp_streams[i];
-        if (mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != VIDEO_ES &&
-            mp4mux_track_GetFmt(p_stream->tinfo)->i_cat != AUDIO_ES)
+        /* sparse tracks must not hold back fragments, and their
+           queues from growing unbounded */
+        if (mp4mux_track_GetFmt(p_s->tinfo)->i_cat != VIDEO_ES &&
+            mp4mux_track_GetFmt(p_s->tinfo)->i_cat != AUDIO_ES)
             continue;
         if (mp4mux_track_GetDuration(p_s->tinfo) < i_min_read_duration)
             i_min_read_duration = mp4mux_track_GetDuration(p_s->tinfo);
@@ -1521,7 +1626,7 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= p_sys->i_frag_duration)
         WriteFragments(p_mux, false);
 
     return VLC_SUCCESS;
@@ -30,6 +30,13 @@
 
 #include "csa.h"
 
+/* packets processed at once by the bitsliced stream cypher */
+#define CSA_BATCH       64
+/* below this, the per packet implementation is faster */
+#define CSA_BATCH_MIN    8
+/* key stream blocks needed for a 188 bytes packet, past the first one */
+#define CSA_MAX_BLOCKS  (184/8)
+
 struct csa_t
 {
     /* odd and even keys */
@@ -47,6 +54,9 @@ struct csa_t
     int     p, q, r;
 
     bool    use_odd;
+
+    /* batch key stream */
+    uint8_t ks[CSA_BATCH][CSA_MAX_BLOCKS][8];
 };
 
 static void csa_ComputeKey( uint8_t kk[57], uint8_t ck[8] );
@@ -610,3 +620,430 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+
+/*****************************************************************************
+ * Batch (de)scrambling
+ *****************************************************************************
+ * The stream cypher depends on bits scattered among the nibble registers,
+ * which makes it very slow when computed one packet at a time. In batch mode,
+ * it is bitsliced: bit b of register R of packet l is bit l of word R[b], so
+ * that each boolean operation runs the cypher of CSA_BATCH packets at once.
+ * The block cypher is table driven and stays per packet.
+ *****************************************************************************/
+typedef uint64_t csa_word_t;
+
+struct csa_bs_t
+{
+    csa_word_t A[11][4];
+    csa_word_t B[11][4];
+    csa_word_t X[4], Y[4], Z[4];
+    csa_word_t D[4], E[4], F[4];
+    csa_word_t p, q, r;
+};
+
+/* s-box inputs, most significant first: { register A index, bit } */
+static const uint8_t sbox_in[7][5][2] =
+{
+    { {4,0}, {1,2}, {6,1}, {7,3}, {9,0} },
+    { {2,1}, {3,2}, {6,3}, {7,0}, {9,1} },
+    { {1,3}, {2,0}, {5,1}, {5,3}, {6,2} },
+    { {3,3}, {1,1}, {2,3}, {4,2}, {8,0} },
+    { {5,2}, {4,3}, {6,0}, {8,1}, {9,2} },
+    { {3,1}, {4,1}, {5,0}, {7,2}, {9,3} },
+    { {2,2}, {3,0}, {7,1}, {8,2}, {8,3} },
+};
+
+static const int *const sbox[7] =
+{
+    sbox1, sbox2, sbox3, sbox4, sbox5, sbox6, sbox7
+};
+
+static inline csa_word_t csa_bs_Mux( csa_word_t a, csa_word_t b, csa_word_t s )
+{
+    return a ^ ( ( a ^ b ) & s );
+}
+
+/* Evaluates a 5 to 2 bits s-box as a tree of multiplexers */
+static void csa_bs_SBox( const int tbl[0x20], const csa_word_t in[5],
+                         csa_word_t out[2] )
+{
+    for( int b = 0; b < 2; b++ )
+    {
+        csa_word_t v[16];
+
+        for( int m = 0; m < 16; m++ )
+        {
+            const csa_word_t c0 = -(csa_word_t)( ( tbl[2*m+0] >> b )&1 );
+            const csa_word_t c1 = -(csa_word_t)( ( tbl[2*m+1] >> b )&1 );
+
+            v[m] = c0 ^ ( ( c0 ^ c1 ) & in[0] );
+        }
+        for( int level = 1, n = 8; n > 0; level++, n /= 2 )
+            for( int m = 0; m < n; m++ )
+                v[m] = csa_bs_Mux( v[2*m], v[2*m+1], in[level] );
+        out[b] = v[0];
+    }
+}
+
+static void csa_bs_Init( struct csa_bs_t *s, const uint8_t ck[8] )
+{
+    memset( s, 0, sizeof( *s ) );
+
+    /* same key for all packets: the words are all zeroes or all ones */
+    for( int i = 0; i < 4; i++ )
+        for( int b = 0; b < 4; b++ )
+        {
+            s->A[1+2*i+0][b] = -(csa_word_t)( ( ck[i] >> (4+b) )&1 );
+            s->A[1+2*i+1][b] = -(csa_word_t)( ( ck[i] >> b )&1 );
+            s->B[1+2*i+0][b] = -(csa_word_t)( ( ck[4+i] >> (4+b) )&1 );
+            s->B[1+2*i+1][b] = -(csa_word_t)( ( ck[4+i] >> b )&1 );
+        }
+}
+
+/* Runs the stream cypher for 8 bytes. sb is the bitsliced input of the
+ * initialisation, NULL for generation, cb receives the bitsliced output. */
+static void csa_bs_StreamCypher( struct csa_bs_t *s,
+                                 const csa_word_t sb[8][8],
+                                 csa_word_t cb[8][8] )
+{
+    for( int i = 0; i < 8; i++ )
+    {
+        for( int j = 0; j < 4; j++ )
+        {
+            csa_word_t so[7][2];
+            csa_word_t extra_B[4], next_A1[4], next_B1[4];
+
+            for( int k = 0; k < 7; k++ )
+            {
+                csa_word_t in[5];
+
+                for( int n = 0; n < 5; n++ )
+                    in[4-n] = s->A[sbox_in[k][n][0]][sbox_in[k][n][1]];
+                csa_bs_SBox( sbox[k], in, so[k] );
+            }
+
+            extra_B[3] = s->B[3][0] ^ s->B[6][1] ^ s->B[7][2] ^ s->B[9][3];
+            extra_B[2] = s->B[6][0] ^ s->B[8][1] ^ s->B[3][3] ^ s->B[4][2];
+            extra_B[1] = s->B[5][3] ^ s->B[8][2] ^ s->B[4][0] ^ s->B[5][1];
+            extra_B[0] = s->B[9][2] ^ s->B[6][3] ^ s->B[3][1] ^ s->B[8][0];
+
+            for( int b = 0; b < 4; b++ )
+            {
+                next_A1[b] = s->A[10][b] ^ s->X[b];
+                next_B1[b] = s->B[7][b] ^ s->B[10][b] ^ s->Y[b];
+            }
+            if( sb )
+            {
+                /* in1 is the high nibble, in2 the low one */
+                const csa_word_t *in1 = &sb[i][4], *in2 = &sb[i][0];
+
+                for( int b = 0; b < 4; b++ )
+                {
+                    next_A1[b] ^= s->D[b] ^ ( ( j % 2 ) ? in2[b] : in1[b] );
+                    next_B1[b] ^= ( j % 2 ) ? in1[b] : in2[b];
+                }
+            }
+
+            /* if p=1, rotate left */
+            const csa_word_t b3 = next_B1[3];
+            next_B1[3] = csa_bs_Mux( next_B1[3], next_B1[2], s->p );
+            next_B1[2] = csa_bs_Mux( next_B1[2], next_B1[1], s->p );
+            next_B1[1] = csa_bs_Mux( next_B1[1], next_B1[0], s->p );
+            next_B1[0] = csa_bs_Mux( next_B1[0], b3, s->p );
+
+            /* F = q ? Z + E + r (r is the carry) : E */
+            csa_word_t carry = s->r;
+            for( int b = 0; b < 4; b++ )
+            {
+                const csa_word_t z = s->Z[b], e = s->E[b];
+                const csa_word_t sum = z ^ e ^ carry;
+
+                carry = ( z & e ) | ( carry & ( z ^ e ) );
+                s->D[b] = e ^ z ^ extra_B[b];
+
+                const csa_word_t next_E = s->F[b];
+                s->F[b] = csa_bs_Mux( e, sum, s->q );
+                s->E[b] = next_E;
+            }
+            s->r = csa_bs_Mux( s->r, carry, s->q );
+
+            memmove( s->A[2], s->A[1], 9 * sizeof( s->A[1] ) );
+            memmove( s->B[2], s->B[1], 9 * sizeof( s->B[1] ) );
+            memcpy( s->A[1], next_A1, sizeof( next_A1 ) );
+            memcpy( s->B[1], next_B1, sizeof( next_B1 ) );
+
+            s->X[3] = so[3][0]; s->X[2] = so[2][0];
+            s->X[1] = so[1][1]; s->X[0] = so[0][1];
+            s->Y[3] = so[5][0]; s->Y[2] = so[4][0];
+            s->Y[1] = so[3][1]; s->Y[0] = so[2][1];
+            s->Z[3] = so[1][0]; s->Z[2] = so[0][0];
+            s->Z[1] = so[5][1]; s->Z[0] = so[4][1];
+            s->p = so[6][1];
+            s->q = so[6][0];
+
+            /* 2 output bits are a function of the 4 bits of D */
+            cb[i][7-2*j] = s->D[2] ^ s->D[3];
+            cb[i][6-2*j] = s->D[0] ^ s->D[1];
+        }
+    }
+}
+
+/* Transposes a 8x8 bits matrix, stored row by row */
+static inline uint64_t csa_Transpose8( uint64_t x )
+{
+    uint64_t t;
+
+    t = ( x ^ ( x >> 7 ) ) & UINT64_C(0x00AA00AA00AA00AA);
+    x ^= t ^ ( t << 7 );
+    t = ( x ^ ( x >> 14 ) ) & UINT64_C(0x0000CCCC0000CCCC);
+    x ^= t ^ ( t << 14 );
+    t = ( x ^ ( x >> 28 ) ) & UINT64_C(0x00000000F0F0F0F0);
+    x ^= t ^ ( t << 28 );
+    return x;
+}
+
+/* Computes the key stream of up to CSA_BATCH packets, initialised with the
+ * 8 bytes pointed by sb[], past the initialisation */
+static void csa_bs_KeyStream( const uint8_t ck[8], uint8_t *const sb[],
+                              unsigned i_count, unsigned i_blocks,
+                              uint8_t (*ks)[CSA_MAX_BLOCKS][8] )
+{
+    struct csa_bs_t s;
+    csa_word_t in[8][8], w[8][8];
+
+    memset( in, 0, sizeof( in ) );
+    for( unsigned g = 0; g < CSA_BATCH / 8; g++ )
+        for( int i = 0; i < 8; i++ )
+        {
+            uint64_t x = 0;
+            for( unsigned c = 0; c < 8 && 8*g + c < i_count; c++ )
+                x |= (uint64_t)sb[8*g+c][i] << (8*c);
+            x = csa_Transpose8( x );
+            for( int b = 0; b < 8; b++ )
+                in[i][b] |= (csa_word_t)( ( x >> (8*b) )&0xff ) << (8*g);
+        }
+
+    csa_bs_Init( &s, ck );
+    csa_bs_StreamCypher( &s, in, w );
+
+    for( unsigned k = 0; k < i_blocks; k++ )
+    {
+        csa_bs_StreamCypher( &s, NULL, w );
+        for( unsigned g = 0; 8*g < i_count; g++ )
+            for( int i = 0; i < 8; i++ )
+            {
+                uint64_t x = 0;
+                for( int b = 0; b < 8; b++ )
+                    x |= ( ( w[i][b] >> (8*g) )&0xff ) << (8*b);
+                x = csa_Transpose8( x );
+                for( unsigned c = 0; c < 8 && 8*g + c < i_count; c++ )
+                    ks[8*g+c][k][i] = x >> (8*c);
+            }
+    }
+}
+
+static int csa_PayloadOffset( const uint8_t *pkt )
+{
+    int i_hdr = 4;
+    if( pkt[3]&0x20 )
+        /* skip adaption field */
+        i_hdr += pkt[4] + 1;
+    return i_hdr;
+}
+
+/* Number of key stream blocks used past the initialisation */
+static unsigned csa_KeyStreamBlocks( int i_pkt_size, int i_hdr )
+{
+    int n = (i_pkt_size - i_hdr) / 8;
+    int i_residue = (i_pkt_size - i_hdr) % 8;
+
+    return ( n > 1 ? n - 1 : 0 ) + ( i_residue > 0 ? 1 : 0 );
+}
+
+static void csa_DecryptGroup( csa_t *c, uint8_t *const pkts[], unsigned i_count,
+                              int i_pkt_size, const uint8_t *ck,
+                              const uint8_t *kk )
+{
+    uint8_t *sb[CSA_BATCH];
+    unsigned i_blocks = 0;
+
+    for( unsigned l = 0; l < i_count; l++ )
+    {
+        uint8_t *pkt = pkts[l];
+        int i_hdr = csa_PayloadOffset( pkt );
+
+        sb[l] = &pkt[i_hdr];
+        i_blocks = __MAX( i_blocks, csa_KeyStreamBlocks( i_pkt_size, i_hdr ) );
+    }
+
+    csa_bs_KeyStream( ck, sb, i_count, i_blocks, c->ks );
+
+    for( unsigned l = 0; l < i_count; l++ )
+    {
+        uint8_t *pkt = pkts[l];
+        uint8_t (*ks)[8] = c->ks[l];
+        int i_hdr = csa_PayloadOffset( pkt );
+        int n = (i_pkt_size - i_hdr) / 8;
+        int i_residue = (i_pkt_size - i_hdr) % 8;
+        uint8_t ib[8], block[8];
+
+        memcpy( ib, &pkt[i_hdr], 8 );
+        for( int i = 1; i < n + 1; i++ )
+        {
+            csa_BlockDecypher( (uint8_t *)kk, ib, block );
+            for( int j = 0; j < 8; j++ )
+            {
+                ib[j] = ( i != n ) ? pkt[i_hdr+8*i+j] ^ (*ks)[j] : 0;
+                pkt[i_hdr+8*(i-1)+j] = ib[j] ^ block[j];
+            }
+            if( i != n )
+                ks++;
+        }
+        if( i_residue > 0 )
+            for( int j = 0; j < i_residue; j++ )
+                pkt[i_pkt_size - i_residue + j] ^= (*ks)[j];
+    }
+}
+
+/*****************************************************************************
+ * csa_DecryptBatch:
+ *****************************************************************************/
+void csa_DecryptBatch( csa_t *c, uint8_t *const pkts[], unsigned i_count,
+                       int i_pkt_size )
+{
+    uint8_t *odd[CSA_BATCH], *even[CSA_BATCH];
+    unsigned i_odd = 0, i_even = 0;
+
+    if( i_count < CSA_BATCH_MIN )
+    {
+        for( unsigned i = 0; i < i_count; i++ )
+            csa_Decrypt( c, pkts[i], i_pkt_size );
+        return;
+    }
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pkts[i];
+
+        /* transport scrambling control */
+        if( (pkt[3]&0x80) == 0 )
+            continue;
+
+        const bool b_odd = pkt[3]&0x40;
+        pkt[3] &= 0x3f;
+        if( 188 - csa_PayloadOffset( pkt ) < 8 )
+            continue;
+
+        if( b_odd )
+            odd[i_odd++] = pkt;
+        else
+            even[i_even++] = pkt;
+
+        if( i_odd == CSA_BATCH )
+        {
+            csa_DecryptGroup( c, odd, i_odd, i_pkt_size, c->o_ck, c->o_kk );
+            i_odd = 0;
+        }
+        if( i_even == CSA_BATCH )
+        {
+            csa_DecryptGroup( c, even, i_even, i_pkt_size, c->e_ck, c->e_kk );
+            i_even = 0;
+        }
+    }
+    if( i_odd > 0 )
+        csa_DecryptGroup( c, odd, i_odd, i_pkt_size, c->o_ck, c->o_kk );
+    if( i_even > 0 )
+        csa_DecryptGroup( c, even, i_even, i_pkt_size, c->e_ck, c->e_kk );
+}
+
+static void csa_EncryptGroup( csa_t *c, uint8_t *const pkts[], unsigned i_count,
+                              int i_pkt_size, const uint8_t *ck,
+                              const uint8_t *kk )
+{
+    uint8_t *sb[CSA_BATCH];
+    unsigned i_blocks = 0;
+
+    for( unsigned l = 0; l < i_count; l++ )
+    {
+        uint8_t *pkt = pkts[l];
+        int i_hdr = csa_PayloadOffset( pkt );
+        int n = (i_pkt_size - i_hdr) / 8;
+        uint8_t ib[8] = { 0 }, block[8];
+
+        /* the block cypher runs backwards, its output replaces each block,
+         * as the plain text is not needed anymore */
+        for( int i = n; i > 0; i-- )
+        {
+            uint8_t *p = &pkt[i_hdr+8*(i-1)];
+
+            for( int j = 0; j < 8; j++ )
+                block[j] = p[j] ^ ib[j];
+            csa_BlockCypher( (uint8_t *)kk, block, ib );
+            memcpy( p, ib, 8 );
+        }
+
+        sb[l] = &pkt[i_hdr];
+        i_blocks = __MAX( i_blocks, csa_KeyStreamBlocks( i_pkt_size, i_hdr ) );
+    }
+
+    csa_bs_KeyStream( ck, sb, i_count, i_blocks, c->ks );
+
+    for( unsigned l = 0; l < i_count; l++ )
+    {
+        uint8_t *pkt = pkts[l];
+        uint8_t (*ks)[8] = c->ks[l];
+        int i_hdr = csa_PayloadOffset( pkt );
+        int n = (i_pkt_size - i_hdr) / 8;
+        int i_residue = (i_pkt_size - i_hdr) % 8;
+
+        for( int i = 2; i < n + 1; i++, ks++ )
+            for( int j = 0; j < 8; j++ )
+                pkt[i_hdr+8*(i-1)+j] ^= (*ks)[j];
+        if( i_residue > 0 )
+            for( int j = 0; j < i_residue; j++ )
+                pkt[i_pkt_size - i_residue + j] ^= (*ks)[j];
+    }
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch:
+ *****************************************************************************/
+void csa_EncryptBatch( csa_t *c, uint8_t *const pkts[], unsigned i_count,
+                       int i_pkt_size )
+{
+    uint8_t *group[CSA_BATCH];
+    unsigned i_group = 0;
+
+    if( i_count < CSA_BATCH_MIN )
+    {
+        for( unsigned i = 0; i < i_count; i++ )
+            csa_Encrypt( c, pkts[i], i_pkt_size );
+        return;
+    }
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pkts[i];
+
+        /* set transport scrambling control */
+        pkt[3] |= c->use_odd ? 0xc0 : 0x80;
+        if( (i_pkt_size - csa_PayloadOffset( pkt )) / 8 <= 0 )
+        {
+            pkt[3] &= 0x3f;
+            continue;
+        }
+
+        group[i_group++] = pkt;
+        if( i_group == CSA_BATCH )
+        {
+            csa_EncryptGroup( c, group, i_group, i_pkt_size,
+                              c->use_odd ? c->o_ck : c->e_ck,
+                              c->use_odd ? c->o_kk : c->e_kk );
+            i_group = 0;
+        }
+    }
+    if( i_group > 0 )
+        csa_EncryptGroup( c, group, i_group, i_pkt_size,
+                          c->use_odd ? c->o_ck : c->e_ck,
+                          c->use_odd ? c->o_kk : c->e_kk );
+}
@@ -159,6 +159,17 @@ static const char *const ts_standards_list_text[] =
 #define BMAX_TEXT N_( "Maximum B (deprecated)")
 #define BMAX_LONGTEXT N_( "This setting is deprecated and not used anymore")
 
+#define MUXRATE_TEXT N_("Constant mux rate (bits/s)")
+#define MUXRATE_LONGTEXT N_("Output a constant bitrate stream at the given " \
+  "rate, stuffed with null packets, as needed by broadcast modulators. " \
+  "The PCRs then exactly match the position of their packet. " \
+  "0 outputs a variable bitrate stream.")
+
+#define PCRCHECK_TEXT N_("Check PCR accuracy")
+#define PCRCHECK_LONGTEXT N_("Verify the PCR interval and, with a " \
+  "constant mux rate, the PCR accuracy of the output, and warn about " \
+  "any violation.")
+
 #define DTS_TEXT N_("DTS delay (ms)")
 #define DTS_LONGTEXT N_("Delay the DTS (decoding time " \
   "stamps) and PTS (presentation timestamps) of the data in the " \
@@ -188,6 +199,8 @@ static const char *const ts_standards_list_text[] =
     "encrypting." )
 
 #define SOUT_CFG_PREFIX "sout-ts-"
+#define TS_BATCH_MAX 7   /* TS packets per output block, as in a typical UDP datagram */
+#define TS_CSA_BATCH 64  /* TS packets scrambled at once */
 #define MAX_PMT 64       /* Maximum number of programs. FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #define MAX_PMT_PID 64       /* Maximum pids in each pmt.  FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #if MAX_SDT_DESC < MAX_PMT
@@ -229,6 +242,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "bmin", 0, BMIN_TEXT, BMIN_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "bmax", 0, BMAX_TEXT, BMAX_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT, true)
+    add_integer( SOUT_CFG_PREFIX "muxrate", 0, MUXRATE_TEXT, MUXRATE_LONGTEXT, true)
+    add_bool( SOUT_CFG_PREFIX "pcr-check", false, PCRCHECK_TEXT, PCRCHECK_LONGTEXT, true)
 
     add_bool( SOUT_CFG_PREFIX "crypt-audio", true, ACRYPT_TEXT, ACRYPT_LONGTEXT, true)
     add_bool( SOUT_CFG_PREFIX "crypt-video", true, VCRYPT_TEXT, VCRYPT_LONGTEXT, true)
@@ -248,7 +263,7 @@ static const char *const ppsz_sout_options[] = {
     "pid-video", "pid-audio", "pid-spu", "pid-pmt", "tsid",
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "bmin", "bmax", "use-key-frames",
-    "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
+    "dts-delay", "muxrate", "pcr-check", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
     "muxpmt", "program-pmt", "alignment",
     NULL
 };
@@ -333,11 +348,20 @@ typedef struct
 
 } pes_state_t;
 
+/* Transport buffer (TB) of the T-STD model, see ISO/IEC 13818-1 2.4.2 */
+typedef struct
+{
+    uint64_t        i_rate;     /* leak rate Rx in bits/s, 0 if unconstrained */
+    uint64_t        i_fill;     /* occupancy, in bits scaled by the mux rate */
+    uint64_t        i_slot;     /* packet slot of the last update */
+} tstd_buffer_t;
+
 typedef struct
 {
     tsmux_stream_t  ts;
     pesmux_stream_t pes;
     pes_state_t  state;
+    tstd_buffer_t   tb;
 } sout_input_sys_t;
 
 typedef struct
@@ -385,6 +409,32 @@ typedef struct
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
     bool            b_crypt_video;
+
+    /* PAT/PMT/SDT packets, built only when the tables change */
+    sout_buffer_chain_t psi;
+
+    /* TS packets per output block */
+    unsigned        i_batch;
+
+    /* Constant bitrate output */
+    uint64_t        i_muxrate;  /* bits/s, 0 for variable bitrate */
+    struct
+    {
+        vlc_tick_t      i_start; /* date of the first packet slot */
+        uint64_t        i_slot;  /* next packet slot */
+        bool            b_overflow;
+        tstd_buffer_t   **pp_tb; /* transport buffers, by PID */
+    } cbr;
+
+    /* PCR self-check */
+    bool            b_pcr_check;
+    struct
+    {
+        uint64_t        i_bytes;      /* bytes output so far */
+        uint64_t        i_pcr_bytes;  /* i_bytes at the last PCR */
+        int64_t         i_pcr;        /* last PCR (27 MHz), -1 if none */
+        int64_t         i_max_error;  /* worst accuracy seen (27 MHz) */
+    } pcr_check;
 } sout_mux_sys_t;
 
 
@@ -479,9 +529,13 @@ static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
 static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
+static void GetPSI( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static void TSDateCBR   ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                          vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
+static void TSOutput    ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts );
+static void TSSetPCR( block_t *p_ts, int64_t i_pcr );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -740,6 +794,30 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    BufferChainInit( &p_sys->psi );
+
+    /* Output as many packets at once as fit in a datagram */
+    int64_t i_mtu = var_InheritInteger( p_mux, "mtu" );
+    p_sys->i_batch = VLC_CLIP( i_mtu / 188, 1, TS_BATCH_MAX );
+
+    int64_t i_muxrate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "muxrate" );
+    if( i_muxrate > 0 )
+    {
+        p_sys->cbr.pp_tb = calloc( 8192, sizeof( *p_sys->cbr.pp_tb ) );
+        if( unlikely(p_sys->cbr.pp_tb == NULL) )
+        {
+            dvbpsi_delete( p_sys->p_dvbpsi );
+            free( p_sys );
+            return VLC_ENOMEM;
+        }
+        p_sys->i_muxrate = i_muxrate;
+        p_sys->cbr.i_start = VLC_TICK_INVALID;
+        msg_Dbg( p_mux, "constant mux rate %"PRId64" bits/s", i_muxrate );
+    }
+
+    p_sys->b_pcr_check = var_GetBool( p_mux, SOUT_CFG_PREFIX "pcr-check" );
+    p_sys->pcr_check.i_pcr = -1;
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -778,6 +856,13 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    BufferChainClean( &p_sys->psi );
+
+    if( p_sys->b_pcr_check && p_sys->i_muxrate > 0 )
+        msg_Dbg( p_mux, "worst PCR accuracy %"PRId64" ns",
+                 p_sys->pcr_check.i_max_error * 1000 / 27 );
+    free( p_sys->cbr.pp_tb );
+
     free( p_sys );
 }
 
@@ -978,8 +1063,23 @@ static int AddStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* Init pes chain */
     BufferChainInit( &p_stream->state.chain_pes );
 
+    if( p_sys->cbr.pp_tb )
+    {
+        /* Rx is 2 Mbit/s for MPEG audio (but never below what the stream
+         * needs), 1.2 Rmax for video; leave video and any other stream
+         * unconstrained when their rate is unknown */
+        const uint64_t i_rate = (uint64_t)p_input->p_fmt->i_bitrate * 6 / 5;
+        if( p_input->p_fmt->i_cat == AUDIO_ES )
+            p_stream->tb.i_rate = __MAX( i_rate, 2000000 );
+        else if( p_input->p_fmt->i_cat == VIDEO_ES )
+            p_stream->tb.i_rate = i_rate;
+        p_stream->tb.i_slot = p_sys->cbr.i_slot;
+        p_sys->cbr.pp_tb[p_stream->ts.i_pid] = &p_stream->tb;
+    }
+
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number = ( p_sys->i_pmt_version_number + 1 )%32;
+    BufferChainClean( &p_sys->psi );
 
     /* Update pcr_pid */
     SelectPCRStream( p_mux, NULL );
@@ -1015,6 +1115,9 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* Empty all data in chain_pes */
     BufferChainClean( &p_stream->state.chain_pes );
 
+    if( p_sys->cbr.pp_tb && p_sys->cbr.pp_tb[p_stream->ts.i_pid] == &p_stream->tb )
+        p_sys->cbr.pp_tb[p_stream->ts.i_pid] = NULL;
+
     pid = var_GetInteger( p_mux, SOUT_CFG_PREFIX "pid-video" );
     if ( pid > 0 && pid == p_stream->ts.i_pid )
     {
@@ -1040,6 +1143,7 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     /* We only change PMT version (PAT isn't changed) */
     p_sys->i_pmt_version_number++;
     p_sys->i_pmt_version_number %= 32;
+    BufferChainClean( &p_sys->psi );
 }
 
 static void SetHeader( sout_buffer_chain_t *c,
@@ -1494,8 +1598,7 @@ static bool MuxStreams(sout_mux_t *p_mux )
     BufferChainInit( &chain_ts );
     /* append PAT/PMT  -> FIXME with big pcr delay it won't have enough pat/pmt */
     bool pat_was_previous = true; //This is to prevent unnecessary double PAT/PMT insertions
-    GetPAT( p_mux, &chain_ts );
-    GetPMT( p_mux, &chain_ts );
+    GetPSI( p_mux, &chain_ts );
     int i_packet_pos = 0;
     i_packet_count += chain_ts.i_depth;
     /* msg_Dbg( p_mux, "estimated pck=%d", i_packet_count ); */
@@ -1561,8 +1664,7 @@ static bool MuxStreams(sout_mux_t *p_mux )
             if( likely( !pat_was_previous ) )
             {
                 int startcount = chain_ts.i_depth;
-                GetPAT( p_mux, &chain_ts );
-                GetPMT( p_mux, &chain_ts );
+                GetPSI( p_mux, &chain_ts );
                 SetHeader( &chain_ts, startcount );
                 i_packet_count += (chain_ts.i_depth - startcount );
             } else {
@@ -1576,7 +1678,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    if( p_sys->i_muxrate > 0 )
+        TSDateCBR( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    else
+        TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
     return false;
 }
 
@@ -1793,9 +1898,9 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    for (int i = 0; i < i_packet_count; i++ )
+    int i = 0;
+    for( block_t *p_ts = p_chain_ts->p_first; p_ts; p_ts = p_ts->p_next, i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
         p_ts->i_dts    = i_new_dts;
@@ -1804,19 +1909,293 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts, TO_SCALE_NZ(p_ts->i_dts - p_sys->first_dts) * 300 );
         }
-        if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+
+        /* latency */
+        p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+    }
+
+    TSOutput( p_mux, p_chain_ts );
+}
+
+/* Date of a constant bitrate packet slot, and its PCR (27 MHz) */
+static int64_t CBRSlotPCR( const sout_mux_sys_t *p_sys, uint64_t i_slot )
+{
+    /* 188 * 8 * 27 MHz / muxrate, without overflowing */
+    const uint64_t i_num = UINT64_C(188 * 8 * 27000000);
+    const uint64_t i_rate = p_sys->i_muxrate;
+    return (i_slot / i_rate) * i_num + (i_slot % i_rate) * i_num / i_rate;
+}
+
+static vlc_tick_t CBRSlotDate( const sout_mux_sys_t *p_sys, uint64_t i_slot )
+{
+    return p_sys->cbr.i_start + CBRSlotPCR( p_sys, i_slot ) / 27;
+}
+
+static tstd_buffer_t *CBRBuffer( const sout_mux_sys_t *p_sys, const block_t *p_ts )
+{
+    tstd_buffer_t *p_tb = p_sys->cbr.pp_tb[((p_ts->p_buffer[1] & 0x1f) << 8) |
+                                           p_ts->p_buffer[2]];
+    return ( p_tb && p_tb->i_rate ) ? p_tb : NULL;
+}
+
+/* Leaks the transport buffer up to the given slot, and tells if a packet
+ * would fit in it. Sizes are in bits scaled by the mux rate, so that the
+ * leak per slot is exactly 188 * 8 * Rx. */
+static bool CBRBufferFits( const sout_mux_sys_t *p_sys, tstd_buffer_t *p_tb,
+                           uint64_t i_slot )
+{
+    const uint64_t i_leak = (i_slot - p_tb->i_slot) * 188 * 8 * p_tb->i_rate;
+    p_tb->i_fill = p_tb->i_fill > i_leak ? p_tb->i_fill - i_leak : 0;
+    p_tb->i_slot = i_slot;
+    return p_tb->i_fill + 188 * 8 * p_sys->i_muxrate <= 512 * 8 * p_sys->i_muxrate;
+}
+
+/* Picks the packet to send in a slot: the first one in a small window whose
+ * transport buffer has room, keeping the order of the packets of each PID */
+static block_t *CBRPick( sout_mux_sys_t *p_sys, sout_buffer_chain_t *c,
+                         uint64_t i_slot )
+{
+    uint16_t pi_skipped[16];
+    unsigned i_skipped = 0;
+
+    for( block_t **pp = &c->p_first; *pp && i_skipped < ARRAY_SIZE(pi_skipped);
+         pp = &(*pp)->p_next )
+    {
+        block_t *p_ts = *pp;
+        const uint16_t i_pid = ((p_ts->p_buffer[1] & 0x1f) << 8) | p_ts->p_buffer[2];
+
+        bool b_blocked = false;
+        for( unsigned i = 0; i < i_skipped && !b_blocked; i++ )
+            b_blocked = pi_skipped[i] == i_pid;
+
+        tstd_buffer_t *p_tb = CBRBuffer( p_sys, p_ts );
+        if( b_blocked || ( p_tb && !CBRBufferFits( p_sys, p_tb, i_slot ) ) )
         {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
+            pi_skipped[i_skipped++] = i_pid;
+            continue;
         }
 
+        /* Unlink */
+        *pp = p_ts->p_next;
+        if( *pp == NULL )
+            c->pp_last = pp;
+        c->i_depth--;
+        p_ts->p_next = NULL;
+
+        if( p_tb )
+            p_tb->i_fill += 188 * 8 * p_sys->i_muxrate;
+        return p_ts;
+    }
+    return NULL;
+}
+
+static block_t *TSNewNull( void )
+{
+    block_t *p_ts = block_Alloc( 188 );
+    if( likely(p_ts) )
+    {
+        p_ts->p_buffer[0] = 0x47;
+        p_ts->p_buffer[1] = 0x1f;
+        p_ts->p_buffer[2] = 0xff;
+        p_ts->p_buffer[3] = 0x10;
+        memset( &p_ts->p_buffer[4], 0xff, 184 );
+    }
+    return p_ts;
+}
+
+/* Constant bitrate scheduling: every packet gets the next fixed-duration slot,
+ * null packets filling the slots up to the end of the period */
+static void TSDateCBR( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                       vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    const vlc_tick_t i_end = i_pcr_dts + i_pcr_length;
+
+    if( p_sys->cbr.i_start == VLC_TICK_INVALID )
+    {
+        p_sys->cbr.i_start = i_pcr_dts;
+    }
+    else if( CBRSlotDate( p_sys, p_sys->cbr.i_slot ) + VLC_TICK_FROM_SEC(1) < i_pcr_dts )
+    {
+        /* Gap in the input: stuffing it would only burst null packets */
+        msg_Warn( p_mux, "input gap of %"PRId64" us, restarting the output clock",
+                  i_pcr_dts - CBRSlotDate( p_sys, p_sys->cbr.i_slot ) );
+        p_sys->cbr.i_start = i_pcr_dts -
+                             (vlc_tick_t)( CBRSlotPCR( p_sys, p_sys->cbr.i_slot ) / 27 );
+    }
+
+    sout_buffer_chain_t out;
+    BufferChainInit( &out );
+
+    while( p_chain_ts->i_depth > 0 ||
+           CBRSlotDate( p_sys, p_sys->cbr.i_slot ) < i_end )
+    {
+        const uint64_t i_slot = p_sys->cbr.i_slot++;
+
+        block_t *p_ts = CBRPick( p_sys, p_chain_ts, i_slot );
+        if( p_ts == NULL )
+        {
+            p_ts = TSNewNull();
+            if( unlikely(p_ts == NULL) )
+                break;
+        }
+
+        p_ts->i_dts = CBRSlotDate( p_sys, i_slot );
+        p_ts->i_length = CBRSlotDate( p_sys, i_slot + 1 ) - p_ts->i_dts;
+
+        if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+            TSSetPCR( p_ts, (p_sys->cbr.i_start - p_sys->first_dts) * 27 +
+                            CBRSlotPCR( p_sys, i_slot ) );
+
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
 
-        sout_AccessOutWrite( p_mux->p_access, p_ts );
+        BufferChainAppend( &out, p_ts );
+    }
+
+    const bool b_overflow = CBRSlotDate( p_sys, p_sys->cbr.i_slot ) > i_end;
+    if( b_overflow && !p_sys->cbr.b_overflow )
+        msg_Warn( p_mux, "mux rate %"PRIu64" bits/s exceeded, output is late",
+                  p_sys->i_muxrate );
+    p_sys->cbr.b_overflow = b_overflow;
+
+    /* Release whatever could not be scheduled on allocation failure */
+    BufferChainClean( p_chain_ts );
+
+    TSOutput( p_mux, &out );
+}
+
+static int64_t TSGetPCR( const block_t *p_ts )
+{
+    const uint8_t *p = p_ts->p_buffer;
+    if( (p[3] & 0x20) == 0 || p[4] < 7 || (p[5] & 0x10) == 0 )
+        return -1;
+
+    int64_t i_base = ((int64_t)p[6] << 25) | (p[7] << 17) | (p[8] << 9) |
+                     (p[9] << 1) | (p[10] >> 7);
+    return i_base * 300 + (((p[10] & 0x01) << 8) | p[11]);
+}
+
+/* Verifies the interval of the PCRs and, at constant bitrate, that they match
+ * the position of their packet in the stream within 500 ns */
+static void CheckPCR( sout_mux_t *p_mux, const block_t *p_ts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    const int64_t i_wrap = INT64_C(1) << 33;
+
+    p_sys->pcr_check.i_bytes += 188;
+
+    int64_t i_pcr = TSGetPCR( p_ts );
+    if( i_pcr < 0 )
+        return;
+
+    if( p_sys->pcr_check.i_pcr >= 0 )
+    {
+        int64_t i_delta = (i_pcr - p_sys->pcr_check.i_pcr + i_wrap * 300) % (i_wrap * 300);
+        if( i_delta > 27000 * 100 )
+            msg_Warn( p_mux, "PCR interval of %"PRId64" ms", i_delta / 27000 );
+
+        if( p_sys->i_muxrate > 0 )
+        {
+            uint64_t i_bits = (p_sys->pcr_check.i_bytes -
+                               p_sys->pcr_check.i_pcr_bytes) * 8;
+            int64_t i_expected = (i_bits / p_sys->i_muxrate) * 27000000 +
+                                 (i_bits % p_sys->i_muxrate) * 27000000 / p_sys->i_muxrate;
+            int64_t i_error = i_delta - i_expected;
+            if( i_error < 0 )
+                i_error = -i_error;
+            if( i_error > p_sys->pcr_check.i_max_error )
+                p_sys->pcr_check.i_max_error = i_error;
+            if( i_error * 1000 > 500 * 27 )
+                msg_Warn( p_mux, "PCR inaccuracy of %"PRId64" ns",
+                          i_error * 1000 / 27 );
+        }
+    }
+    p_sys->pcr_check.i_pcr = i_pcr;
+    p_sys->pcr_check.i_pcr_bytes = p_sys->pcr_check.i_bytes;
+}
+
+static void TSScramble( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    uint8_t *pp_pkts[TS_CSA_BATCH];
+    unsigned i_pkts = 0;
+
+    /* Scramble the whole chain in large batches, which is much faster than
+     * packet by packet */
+    vlc_mutex_lock( &p_sys->csa_lock );
+    for( block_t *p_ts = p_chain_ts->p_first; p_ts; p_ts = p_ts->p_next )
+    {
+        if( !(p_ts->i_flags & BLOCK_FLAG_SCRAMBLED) )
+            continue;
+        pp_pkts[i_pkts++] = p_ts->p_buffer;
+        if( i_pkts == TS_CSA_BATCH )
+        {
+            csa_EncryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+            i_pkts = 0;
+        }
+    }
+    if( i_pkts > 0 )
+        csa_EncryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+    vlc_mutex_unlock( &p_sys->csa_lock );
+}
+
+static void TSOutput( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    if( p_sys->csa )
+        TSScramble( p_mux, p_chain_ts );
+
+    while( p_chain_ts->i_depth > 0 )
+    {
+        /* Gather up to i_batch packets in a single output block. Headers
+         * and keyframes start a new block, and headers are kept alone, as
+         * access outputs look for them at block granularity. */
+        unsigned i_batch = 0;
+        block_t *pp_batch[TS_BATCH_MAX];
+
+        while( p_chain_ts->i_depth > 0 && i_batch < p_sys->i_batch )
+        {
+            block_t *p_ts = BufferChainPeek( p_chain_ts );
+            if( i_batch > 0 &&
+                ( p_ts->i_flags & (BLOCK_FLAG_HEADER|BLOCK_FLAG_TYPE_I) ||
+                  pp_batch[0]->i_flags & BLOCK_FLAG_HEADER ) )
+                break;
+            p_ts = BufferChainGet( p_chain_ts );
+
+            if( p_sys->b_pcr_check )
+                CheckPCR( p_mux, p_ts );
+
+            pp_batch[i_batch++] = p_ts;
+        }
+
+        block_t *p_out = NULL;
+        if( i_batch > 1 )
+            p_out = block_Alloc( i_batch * 188 );
+
+        if( p_out == NULL )
+        {
+            /* Single packet, or no memory to gather: write as is */
+            for( unsigned j = 0; j < i_batch; j++ )
+                sout_AccessOutWrite( p_mux->p_access, pp_batch[j] );
+            continue;
+        }
+
+        p_out->i_dts = pp_batch[0]->i_dts;
+        p_out->i_flags = pp_batch[0]->i_flags & ~BLOCK_FLAG_SCRAMBLED;
+        p_out->i_length = 0;
+        for( unsigned j = 0; j < i_batch; j++ )
+        {
+            memcpy( &p_out->p_buffer[188 * j], pp_batch[j]->p_buffer, 188 );
+            p_out->i_flags |= pp_batch[j]->i_flags & BLOCK_FLAG_CLOCK;
+            p_out->i_length += pp_batch[j]->i_length;
+            block_Release( pp_batch[j] );
+        }
+
+        sout_AccessOutWrite( p_mux->p_access, p_out );
     }
 }
 
@@ -1923,17 +2302,18 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
     return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+/* Writes a 27 MHz PCR, as 90 kHz base and extension */
+static void TSSetPCR( block_t *p_ts, int64_t i_pcr )
 {
-    int64_t i_pcr = TO_SCALE_NZ(i_dts);
-
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    int64_t i_base = i_pcr / 300;
+    int i_ext = i_pcr % 300;
+
+    p_ts->p_buffer[6]  = ( i_base >> 25 )&0xff;
+    p_ts->p_buffer[7]  = ( i_base >> 17 )&0xff;
+    p_ts->p_buffer[8]  = ( i_base >> 9  )&0xff;
+    p_ts->p_buffer[9]  = ( i_base >> 1  )&0xff;
+    p_ts->p_buffer[10] = ( ( i_base << 7 )&0x80 ) | 0x7e | ( ( i_ext >> 8 )&0x01 );
+    p_ts->p_buffer[11] = i_ext & 0xff;
 }
 
 void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
@@ -1947,6 +2327,59 @@ void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
               p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
 }
 
+static uint8_t *GetPSIContinuityCounter( sout_mux_sys_t *p_sys, uint16_t i_pid )
+{
+    if( i_pid == p_sys->pat.i_pid )
+        return &p_sys->pat.i_continuity_counter;
+    if( i_pid == p_sys->sdt.ts.i_pid )
+        return &p_sys->sdt.ts.i_continuity_counter;
+    for( unsigned i = 0; i < p_sys->i_num_pmt; i++ )
+        if( i_pid == p_sys->pmt[i].i_pid )
+            return &p_sys->pmt[i].i_continuity_counter;
+    return NULL;
+}
+
+static void GetPSI( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    /* The tables only change with the set of streams, so build them once,
+     * then replay the packets with the current continuity counters */
+    if( p_sys->psi.p_first == NULL )
+    {
+        uint8_t i_pat_cc = p_sys->pat.i_continuity_counter;
+        uint8_t i_sdt_cc = p_sys->sdt.ts.i_continuity_counter;
+        uint8_t pi_pmt_cc[MAX_PMT];
+        for( unsigned i = 0; i < p_sys->i_num_pmt; i++ )
+            pi_pmt_cc[i] = p_sys->pmt[i].i_continuity_counter;
+
+        GetPAT( p_mux, &p_sys->psi );
+        GetPMT( p_mux, &p_sys->psi );
+
+        p_sys->pat.i_continuity_counter = i_pat_cc;
+        p_sys->sdt.ts.i_continuity_counter = i_sdt_cc;
+        for( unsigned i = 0; i < p_sys->i_num_pmt; i++ )
+            p_sys->pmt[i].i_continuity_counter = pi_pmt_cc[i];
+    }
+
+    for( const block_t *p_psi = p_sys->psi.p_first; p_psi; p_psi = p_psi->p_next )
+    {
+        block_t *p_ts = block_Alloc( 188 );
+        if( unlikely(p_ts == NULL) )
+            break;
+        memcpy( p_ts->p_buffer, p_psi->p_buffer, 188 );
+
+        uint8_t *pi_cc = GetPSIContinuityCounter( p_sys,
+                            ((p_ts->p_buffer[1] & 0x1f) << 8) | p_ts->p_buffer[2] );
+        if( pi_cc )
+        {
+            p_ts->p_buffer[3] = (p_ts->p_buffer[3] & 0xf0) | *pi_cc;
+            *pi_cc = (*pi_cc + 1) % 16;
+        }
+        BufferChainAppend( c, p_ts );
+    }
+}
+
 static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
@@ -151,7 +151,8 @@ static block_t *ParseNALBlock( decoder_t *, bool *pb_ts_used, block_t * );
 static block_t *OutputPicture( decoder_t *p_dec );
 static void PutSPS( decoder_t *p_dec, block_t *p_frag );
 static void PutPPS( decoder_t *p_dec, block_t *p_frag );
-static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slice_t *p_slice );
+static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, bool b_full,
+                              h264_slice_t *p_slice );
 static bool ParseSeiCallback( const hxxx_sei_data_t *, void * );
 
 
@@ -458,7 +459,8 @@ static int Open( vlc_object_t *p_this )
     }
 
     /* CC are the same for H264/AVC in T35 sections (ETSI TS 101 154)  */
-    p_dec->pf_get_cc = GetCc;
+    if( !p_dec->b_remux )
+        p_dec->pf_get_cc = GetCc;
     p_dec->pf_flush = PacketizeFlush;
 
     return VLC_SUCCESS;
@@ -642,22 +644,37 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                 p_sys->i_recoveryfnum = UINT_MAX;
             }
 
-            if( ParseSliceHeader( p_dec, p_frag, &newslice ) )
+            /* When remuxing, only the first slice of a picture is fully
+             * parsed, as all of its slices share the same reference marking */
+            if( ParseSliceHeader( p_dec, p_frag, !p_dec->b_remux, &newslice ) )
             {
                 /* Only IDR carries the id, to be propagated */
                 if( newslice.i_idr_pic_id == -1 )
                     newslice.i_idr_pic_id = p_sys->slice.i_idr_pic_id;
 
                 bool b_new_picture = IsFirstVCLNALUnit( &p_sys->slice, &newslice );
+                if( p_dec->b_remux )
+                {
+                    h264_slice_t fullslice;
+                    if( !b_new_picture )
+                        newslice.has_mmco5 = p_sys->slice.has_mmco5;
+                    else if( newslice.i_nal_type != H264_NAL_SLICE_IDR &&
+                             newslice.i_nal_ref_idc != 0 &&
+                             ParseSliceHeader( p_dec, p_frag, true, &fullslice ) )
+                        newslice.has_mmco5 = fullslice.has_mmco5;
+                }
+
                 if( b_new_picture )
                 {
                     /* Parse SEI for that frame now we should have matched SPS/PPS */
+                    const unsigned i_sei_flags = p_dec->b_remux ? HXXX_SEI_SKIP_USER_DATA : 0;
                     for( block_t *p_sei = p_sys->leading.p_head; p_sei; p_sei = p_sei->p_next )
                     {
                         if( (p_sei->i_flags & BLOCK_FLAG_PRIVATE_SEI) == 0 )
                             continue;
-                        HxxxParse_AnnexB_SEI( p_sei->p_buffer, p_sei->i_buffer,
-                                              1 /* nal header */, ParseSeiCallback, p_dec );
+                        HxxxParse_AnnexB_SEI_Ext( p_sei->p_buffer, p_sei->i_buffer,
+                                                  1 /* nal header */, i_sei_flags,
+                                                  ParseSeiCallback, p_dec );
                     }
 
                     if( p_sys->b_slice )
@@ -1045,6 +1062,9 @@ static block_t *OutputPicture( decoder_t *p_dec )
             break;
     }
 
+    if( p_sys->slice.i_nal_ref_idc == 0 )
+        p_pic->i_flags |= BLOCK_FLAG_NON_REFERENCE;
+
     if( !p_sys->b_recovered )
     {
         if( p_sys->i_recoveryfnum != UINT_MAX ) /* recovering from SEI */
@@ -1089,7 +1109,16 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
     if( !p_sys->sps[p_sps->i_id].p_sps )
         msg_Dbg( p_dec, "found NAL_SPS (sps_id=%d)", p_sps->i_id );
 
-    StoreSPS( p_sys, p_sps->i_id, p_frag, p_sps );
+    /* Keep a private copy, rather than a reference to the input payload */
+    block_t *p_copy = block_Duplicate( p_frag );
+    block_Release( p_frag );
+    if( p_copy == NULL )
+    {
+        h264_release_sps( p_sps );
+        return;
+    }
+
+    StoreSPS( p_sys, p_sps->i_id, p_copy, p_sps );
 }
 
 static void PutPPS( decoder_t *p_dec, block_t *p_frag )
@@ -1116,7 +1145,16 @@ static void PutPPS( decoder_t *p_dec, block_t *p_frag )
     if( !p_sys->pps[p_pps->i_id].p_pps )
         msg_Dbg( p_dec, "found NAL_PPS (pps_id=%d sps_id=%d)", p_pps->i_id, p_pps->i_sps_id );
 
-    StorePPS( p_sys, p_pps->i_id, p_frag, p_pps );
+    /* Keep a private copy, rather than a reference to the input payload */
+    block_t *p_copy = block_Duplicate( p_frag );
+    block_Release( p_frag );
+    if( p_copy == NULL )
+    {
+        h264_release_pps( p_pps );
+        return;
+    }
+
+    StorePPS( p_sys, p_pps->i_id, p_copy, p_pps );
 }
 
 static void GetSPSPPS( uint8_t i_pps_id, void *priv,
@@ -1132,7 +1170,8 @@ static void GetSPSPPS( uint8_t i_pps_id, void *priv,
         *pp_sps = p_sys->sps[(*pp_pps)->i_sps_id].p_sps;
 }
 
-static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slice_t *p_slice )
+static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, bool b_full,
+                              h264_slice_t *p_slice )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
 
@@ -1142,7 +1181,8 @@ static bool ParseSliceHeader( decoder_t *p_dec, const block_t *p_frag, h264_slic
     if( !hxxx_strip_AnnexB_startcode( &p_stripped, &i_stripped ) || i_stripped < 2 )
         return false;
 
-    if( !h264_decode_slice( p_stripped, i_stripped, GetSPSPPS, p_sys, p_slice ) )
+    if( b_full ? !h264_decode_slice( p_stripped, i_stripped, GetSPSPPS, p_sys, p_slice )
+               : !h264_decode_slice_header( p_stripped, i_stripped, GetSPSPPS, p_sys, p_slice ) )
         return false;
 
     const h264_sequence_parameter_set_t *p_sps;
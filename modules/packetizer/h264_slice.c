@@ -29,11 +29,11 @@
 #include "hxxx_nal.h"
 #include "hxxx_ep3b.h"
 
-bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
-                        void (* get_sps_pps)(uint8_t, void *,
-                                             const h264_sequence_parameter_set_t **,
-                                             const h264_picture_parameter_set_t ** ),
-                        void *priv, h264_slice_t *p_slice )
+static bool h264_decode_slice_int( const uint8_t *p_buffer, size_t i_buffer,
+                                   void (* get_sps_pps)(uint8_t, void *,
+                                                        const h264_sequence_parameter_set_t **,
+                                                        const h264_picture_parameter_set_t ** ),
+                                   void *priv, bool b_ref_marking, h264_slice_t *p_slice )
 {
     int i_slice_type;
     h264_slice_init( p_slice );
@@ -101,6 +101,10 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
     if( p_pps->i_redundant_pic_present_flag )
         bs_read_ue( &s ); /* redudant_pic_count */
 
+    /* Everything needed to delimit and order the pictures has been read */
+    if( !b_ref_marking )
+        return true;
+
     unsigned num_ref_idx_l01_active_minus1[2] = {0 , 0};
 
     if( i_slice_type == 1 || i_slice_type == 6 ) /* B slices */
@@ -213,6 +217,24 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
     return true;
 }
 
+bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
+                        void (* get_sps_pps)(uint8_t, void *,
+                                             const h264_sequence_parameter_set_t **,
+                                             const h264_picture_parameter_set_t ** ),
+                        void *priv, h264_slice_t *p_slice )
+{
+    return h264_decode_slice_int( p_buffer, i_buffer, get_sps_pps, priv, true, p_slice );
+}
+
+bool h264_decode_slice_header( const uint8_t *p_buffer, size_t i_buffer,
+                               void (* get_sps_pps)(uint8_t, void *,
+                                                    const h264_sequence_parameter_set_t **,
+                                                    const h264_picture_parameter_set_t ** ),
+                               void *priv, h264_slice_t *p_slice )
+{
+    return h264_decode_slice_int( p_buffer, i_buffer, get_sps_pps, priv, false, p_slice );
+}
+
 
 void h264_compute_poc( const h264_sequence_parameter_set_t *p_sps,
                        const h264_slice_t *p_slice, h264_poc_context_t *p_ctx,
@@ -78,6 +78,15 @@ bool h264_decode_slice( const uint8_t *p_buffer, size_t i_buffer,
                                              const h264_picture_parameter_set_t ** ),
                         void *, h264_slice_t *p_slice );
 
+/* Same as h264_decode_slice, but stops after the picture order count fields.
+ * This is enough to tell which slice starts a picture, but has_mmco5 is
+ * always reported unset. */
+bool h264_decode_slice_header( const uint8_t *p_buffer, size_t i_buffer,
+                               void (* get_sps_pps)(uint8_t pps_id, void *,
+                                                    const h264_sequence_parameter_set_t **,
+                                                    const h264_picture_parameter_set_t ** ),
+                               void *, h264_slice_t *p_slice );
+
 typedef struct
 {
     struct
@@ -257,7 +257,8 @@ static int Open(vlc_object_t *p_this)
         p_dec->pf_packetize = PacketizeAnnexB;
     }
     p_dec->pf_flush = PacketizeFlush;
-    p_dec->pf_get_cc = GetCc;
+    if( !p_dec->b_remux )
+        p_dec->pf_get_cc = GetCc;
 
     if(p_dec->fmt_out.i_extra)
     {
@@ -652,6 +653,12 @@ static void GetXPSSet(uint8_t i_pps_id, void *priv,
             *pp_vps = p_sys->rg_vps[hevc_get_sps_vps_id(*pp_sps)].p_decoded;
 }
 
+/* Closed captions are of no use when remuxing */
+static unsigned SEIParseFlags( const decoder_t *p_dec )
+{
+    return p_dec->b_remux ? HXXX_SEI_SKIP_USER_DATA : 0;
+}
+
 static void ParseStoredSEI( decoder_t *p_dec )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -664,8 +671,9 @@ static void ParseStoredSEI( decoder_t *p_dec )
 
         if( hevc_getNALType(&p_nal->p_buffer[4]) == HEVC_NAL_PREF_SEI )
         {
-            HxxxParse_AnnexB_SEI( p_nal->p_buffer, p_nal->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+            HxxxParse_AnnexB_SEI_Ext( p_nal->p_buffer, p_nal->i_buffer,
+                                      2 /* nal header */, SEIParseFlags( p_dec ),
+                                      ParseSEICallback, p_dec );
         }
     }
 }
@@ -745,6 +753,14 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
             break;
         }
 
+        /* Sub-layer non-reference pictures of the highest sub-layer are not
+         * used to predict any other picture */
+        if(i_layer == 0 && i_nal_type <= HEVC_NAL_RSV_VCL_N14 &&
+           (i_nal_type & 1) == 0 && p_sys->p_active_sps &&
+           hevc_getNALTemporalId(p_buffer) ==
+           hevc_get_highest_temporal_id(p_sys->p_active_sps))
+            p_frag->i_flags |= BLOCK_FLAG_NON_REFERENCE;
+
         if(p_sli)
             hevc_rbsp_release_slice_header(p_sli);
     }
@@ -829,8 +845,9 @@ static block_t * ParseAUTail(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
             break;
 
         case HEVC_NAL_SUFF_SEI:
-            HxxxParse_AnnexB_SEI( p_nalb->p_buffer, p_nalb->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+            HxxxParse_AnnexB_SEI_Ext( p_nalb->p_buffer, p_nalb->i_buffer,
+                                      2 /* nal header */, SEIParseFlags( p_dec ),
+                                      ParseSEICallback, p_dec );
             break;
     }
 
@@ -1113,6 +1113,11 @@ uint8_t hevc_get_max_num_reorder( const hevc_video_parameter_set_t *p_vps )
     return p_vps->vps_max[p_vps->vps_max_sub_layers_minus1/* HighestTid */].num_reorder_pics;
 }
 
+uint8_t hevc_get_highest_temporal_id( const hevc_sequence_parameter_set_t *p_sps )
+{
+    return p_sps->sps_max_sub_layers_minus1;
+}
+
 static inline uint8_t vlc_ceil_log2( uint32_t val )
 {
     uint8_t n = 31 - clz(val);
@@ -246,6 +246,11 @@ static inline uint8_t hevc_getNALLayer( const uint8_t *p_buf )
     return ((p_buf[0] & 0x01) << 6) | (p_buf[1] >> 3);
 }
 
+static inline uint8_t hevc_getNALTemporalId( const uint8_t *p_buf )
+{
+    return (p_buf[1] & 0x07) - 1;
+}
+
 /* NAL decoding */
 typedef struct hevc_video_parameter_set_t hevc_video_parameter_set_t;
 typedef struct hevc_sequence_parameter_set_t hevc_sequence_parameter_set_t;
@@ -294,6 +299,7 @@ bool hevc_get_colorimetry( const hevc_sequence_parameter_set_t *p_sps,
                            video_color_space_t *p_colorspace,
                            video_color_range_t *p_full_range );
 uint8_t hevc_get_max_num_reorder( const hevc_video_parameter_set_t *p_vps );
+uint8_t hevc_get_highest_temporal_id( const hevc_sequence_parameter_set_t *p_sps );
 bool hevc_get_slice_type( const hevc_slice_segment_header_t *, enum hevc_slice_type_e * );
 
 /* Get level and Profile from DecoderConfigurationRecord */
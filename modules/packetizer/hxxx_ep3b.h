@@ -19,6 +19,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <vlc_bits.h>
+#include "startcode_helper.h"
 
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
@@ -88,6 +89,19 @@ static size_t hxxx_ep3b_total_size( const uint8_t *p, const uint8_t *p_end )
     size_t i = 0;
     while( p < p_end )
     {
+        if( (i_prev & 1) == 0 )
+        {
+            /* The current byte is not zero, so that no escape can happen
+             * before the next 0x00 0x00 0x03 sequence: skip to it. */
+            const uint8_t *q = startcode_FindEP3B( p + 1, p_end );
+            if( q == NULL )
+                return i + (p_end - p);
+            i += q - p;
+            i_prev = ((q - 1 > p) ? !q[-1] << 1 : 0) | 1;
+            p = q;
+            continue;
+        }
+
         uint8_t *n = hxxx_ep3b_to_rbsp( (uint8_t *)p, (uint8_t *)p_end, &i_prev, 1 );
         if( n > p )
             ++i;
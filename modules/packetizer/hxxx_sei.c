@@ -31,13 +31,27 @@
 
 void HxxxParse_AnnexB_SEI(const uint8_t *p_buf, size_t i_buf,
                           uint8_t i_header, pf_hxxx_sei_callback cb, void *cbdata)
+{
+    HxxxParse_AnnexB_SEI_Ext(p_buf, i_buf, i_header, 0, cb, cbdata);
+}
+
+void HxxxParse_AnnexB_SEI_Ext(const uint8_t *p_buf, size_t i_buf,
+                              uint8_t i_header, unsigned i_flags,
+                              pf_hxxx_sei_callback cb, void *cbdata)
 {
     if( hxxx_strip_AnnexB_startcode( &p_buf, &i_buf ) )
-        HxxxParseSEI(p_buf, i_buf, i_header, cb, cbdata);
+        HxxxParseSEI_Ext(p_buf, i_buf, i_header, i_flags, cb, cbdata);
 }
 
 void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
                   uint8_t i_header, pf_hxxx_sei_callback pf_callback, void *cbdata)
+{
+    HxxxParseSEI_Ext(p_buf, i_buf, i_header, 0, pf_callback, cbdata);
+}
+
+void HxxxParseSEI_Ext(const uint8_t *p_buf, size_t i_buf,
+                      uint8_t i_header, unsigned i_flags,
+                      pf_hxxx_sei_callback pf_callback, void *cbdata)
 {
     bs_t s;
     bool b_continue = true;
@@ -94,6 +108,9 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
             /* Look for user_data_registered_itu_t_t35 */
             case HXXX_SEI_USER_DATA_REGISTERED_ITU_T_T35:
             {
+                if( i_flags & HXXX_SEI_SKIP_USER_DATA )
+                    break;
+
                 size_t i_t35;
                 uint8_t *p_t35 = malloc( i_size );
                 if( !p_t35 )
@@ -92,8 +92,15 @@ typedef struct
     };
 } hxxx_sei_data_t;
 
+/* Parsing flags */
+#define HXXX_SEI_SKIP_USER_DATA  0x01 /* do not extract registered user data (CC) */
+
 typedef bool (*pf_hxxx_sei_callback)(const hxxx_sei_data_t *, void *);
 void HxxxParseSEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
 void HxxxParse_AnnexB_SEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
+void HxxxParseSEI_Ext(const uint8_t *, size_t, uint8_t, unsigned,
+                      pf_hxxx_sei_callback, void *);
+void HxxxParse_AnnexB_SEI_Ext(const uint8_t *, size_t, uint8_t, unsigned,
+                              pf_hxxx_sei_callback, void *);
 
 #endif
@@ -403,7 +403,8 @@ static block_t *OutputFrame( decoder_t *p_dec )
         p_pic->i_flags |= BLOCK_FLAG_TYPE_P;
         break;
     case 0x03:
-        p_pic->i_flags |= BLOCK_FLAG_TYPE_B;
+        /* B pictures are never used as references */
+        p_pic->i_flags |= BLOCK_FLAG_TYPE_B | BLOCK_FLAG_NON_REFERENCE;
         break;
     }
 
@@ -180,7 +180,36 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            const size_t i_block_offset = p_pack->bytestream.i_block_offset;
+
+            /* Reference the input payload if the fragment is contiguous in
+             * it, and already preceded by the prepended bytes (such as the
+             * zero_byte of a 4 bytes AnnexB startcode), so that adjoining
+             * fragments can later be gathered without copying */
+            if( p_block_bytestream->i_buffer - i_block_offset >= p_pack->i_offset &&
+                i_block_offset >= (size_t)p_pack->i_au_prepend &&
+                ( p_pack->i_au_prepend == 0 ||
+                  !memcmp( &p_block_bytestream->p_buffer[i_block_offset - p_pack->i_au_prepend],
+                           p_pack->p_au_prepend, p_pack->i_au_prepend ) ) &&
+                (p_pic = block_Slice( p_block_bytestream,
+                                      i_block_offset - p_pack->i_au_prepend,
+                                      p_pack->i_offset + p_pack->i_au_prepend )) )
+            {
+                p_pic->i_flags = 0;
+                p_pic->i_nb_samples = 0;
+                p_pic->i_length = 0;
+                block_SkipBytes( &p_pack->bytestream, p_pack->i_offset );
+            }
+            else
+            {
+                p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+                if( unlikely(p_pic == NULL) )
+                    return NULL;
+                block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
+                                p_pic->i_buffer - p_pack->i_au_prepend );
+                if( p_pack->i_au_prepend > 0 )
+                    memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
+            }
             p_pic->i_pts = p_block_bytestream->i_pts;
             p_pic->i_dts = p_block_bytestream->i_dts;
 
@@ -191,11 +220,6 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
                 p_pic->i_flags |= BLOCK_FLAG_AU_END;
             }
 
-            block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
-                            p_pic->i_buffer - p_pack->i_au_prepend );
-            if( p_pack->i_au_prepend > 0 )
-                memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
-
             p_pack->i_offset = 0;
 
             /* Parse the NAL */
@@ -25,21 +25,29 @@
 #if !defined(CAN_COMPILE_SSE2) && defined(HAVE_SSE2_INTRINSICS)
    #include <emmintrin.h>
 #endif
+#ifdef HAVE_AVX2_INTRINSICS
+   #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+   #include <arm_neon.h>
+   #define HAVE_STARTCODE_NEON 1
+#endif
 
-/* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
- * by using a 4 times faster trick than single byte lookup. */
+/* Looks up efficiently for a 0x00 0x00 <c> sequence, such as an AnnexB
+ * startcode 0x00 0x00 0x01, by using a 4 times faster trick than single byte
+ * lookup. */
 
-#define TRY_MATCH(p,a) {\
+#define TRY_MATCH(p,a,c) {\
      if (p[a+1] == 0) {\
-            if (p[a+0] == 0 && p[a+2] == 1)\
+            if (p[a+0] == 0 && p[a+2] == c)\
                 return a+p;\
-            if (p[a+2] == 0 && p[a+3] == 1)\
+            if (p[a+2] == 0 && p[a+3] == c)\
                 return a+p+1;\
         }\
         if (p[a+3] == 0) {\
-            if (p[a+2] == 0 && p[a+4] == 1)\
+            if (p[a+2] == 0 && p[a+4] == c)\
                 return a+p+2;\
-            if (p[a+4] == 0 && p[a+5] == 1)\
+            if (p[a+4] == 0 && p[a+5] == c)\
                 return a+p+3;\
         }\
     }
@@ -47,19 +55,17 @@
 #if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
 
 __attribute__ ((__target__ ("sse2")))
-static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const uint8_t *end )
+static inline const uint8_t * startcode_Find_SSE2( const uint8_t *p, const uint8_t *end,
+                                                   uint8_t c )
 {
     /* First align to 16 */
     /* Skipping this step and doing unaligned loads isn't faster */
     const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
     for (end -= 3; p < alignedend && p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
-    if( p == end )
-        return NULL;
-
     alignedend = end - ((intptr_t) end & 15);
     if( alignedend > p )
     {
@@ -89,18 +95,96 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             match = _mm_movemask_epi8( res ); /* mask will be in reversed match order */
 #endif
             if( match & 0x000F )
-                TRY_MATCH(p, 0);
+                TRY_MATCH(p, 0, c);
             if( match & 0x00F0 )
-                TRY_MATCH(p, 4);
+                TRY_MATCH(p, 4, c);
             if( match & 0x0F00 )
-                TRY_MATCH(p, 8);
+                TRY_MATCH(p, 8, c);
             if( match & 0xF000 )
-                TRY_MATCH(p, 12);
+                TRY_MATCH(p, 12, c);
         }
     }
 
     for (; p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_Find_AVX2( const uint8_t *p, const uint8_t *end,
+                                                   uint8_t c )
+{
+    /* Same as SSE2, with 32 bytes per iteration */
+    const uint8_t *alignedend = p + 32 - ((intptr_t)p & 31);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    alignedend = end - ((intptr_t) end & 31);
+    if( alignedend > p )
+    {
+        const __m256i zeros = _mm256_setzero_si256();
+
+        for( ; p < alignedend; p += 32)
+        {
+            __m256i v = _mm256_load_si256((const __m256i *)p);
+            uint32_t match = _mm256_movemask_epi8( _mm256_cmpeq_epi8( zeros, v ) );
+
+            for( unsigned a = 0; match != 0; a += 4, match >>= 4 )
+                if( match & 0xF )
+                    TRY_MATCH(p, a, c);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef HAVE_STARTCODE_NEON
+
+static inline const uint8_t * startcode_Find_NEON( const uint8_t *p, const uint8_t *end,
+                                                   uint8_t c )
+{
+    const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
+            return p;
+    }
+
+    alignedend = end - ((intptr_t) end & 15);
+    for( ; p < alignedend; p += 16)
+    {
+        uint8x16_t res = vceqq_u8( vld1q_u8( p ), vdupq_n_u8( 0 ) );
+        /* Narrow to 4 bits per byte, as there is no movemask */
+        uint64_t match = vget_lane_u64( vreinterpret_u64_u8(
+                             vshrn_n_u16( vreinterpretq_u16_u8( res ), 4 ) ), 0 );
+
+        if( match & 0x000000000000FFFF )
+            TRY_MATCH(p, 0, c);
+        if( match & 0x00000000FFFF0000 )
+            TRY_MATCH(p, 4, c);
+        if( match & 0x0000FFFF00000000 )
+            TRY_MATCH(p, 8, c);
+        if( match & 0xFFFF000000000000 )
+            TRY_MATCH(p, 12, c);
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -113,12 +197,13 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
  */
-static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const uint8_t *end )
+static inline const uint8_t * startcode_Find_Bits( const uint8_t *p, const uint8_t *end,
+                                                   uint8_t c )
 {
     const uint8_t *a = p + 4 - ((intptr_t)p & 3);
 
     for (end -= 3; p < a && p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -127,12 +212,12 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
         if ((x - 0x01010101) & (~x) & 0x80808080)
         {
             /* matching DW isn't faster */
-            TRY_MATCH(p, 0);
+            TRY_MATCH(p, 0, c);
         }
     }
 
     for (end += 3; p <= end; p++) {
-        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+        if (p[0] == 0 && p[1] == 0 && p[2] == c)
             return p;
     }
 
@@ -140,16 +225,39 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
+static inline const uint8_t * startcode_Find( const uint8_t *p, const uint8_t *end,
+                                              uint8_t c )
+{
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_Find_AVX2(p, end, c);
+#endif
 #if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    if (vlc_CPU_SSE2())
+        return startcode_Find_SSE2(p, end, c);
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    if (vlc_CPU_ARM_NEON())
+        return startcode_Find_NEON(p, end, c);
+#endif
+    return startcode_Find_Bits(p, end, c);
+}
+
+static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find_Bits(p, end, 0x01);
+}
+
+/* Looks up an AnnexB startcode 0x00 0x00 0x01 */
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
-    if (vlc_CPU_SSE2())
-        return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
+    return startcode_Find(p, end, 0x01);
+}
+
+/* Looks up an emulation prevention sequence 0x00 0x00 0x03 */
+static inline const uint8_t * startcode_FindEP3B( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find(p, end, 0x03);
 }
-#else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
-#endif
 
 #endif
@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <algorithm>
+#include <deque>
 #include <set>
 #include <string>
 
@@ -52,6 +53,15 @@ const char* CONTENT_DIRECTORY_SERVICE_TYPE = "urn:schemas-upnp-org:service:Conte
 const char* SATIP_SERVER_DEVICE_TYPE = "urn:ses-com:device:SatIPServer:1";
 
 #define UPNP_SEARCH_TIMEOUT_SECONDS 15
+
+/* Number of objects requested per Browse action, and Browse actions sent
+ * concurrently, to list large containers */
+#define BROWSE_PAGE_SIZE        500
+#define BROWSE_MAX_PENDING      4
+
+/* Lifetime and maximum number of cached container listings */
+#define BROWSE_CACHE_TTL        VLC_TICK_FROM_SEC(300)
+#define BROWSE_CACHE_SIZE       32
 #define SATIP_CHANNEL_LIST N_("SAT>IP channel list")
 #define SATIP_CHANNEL_LIST_URL N_("Custom SAT>IP channel list URL")
 
@@ -183,19 +193,11 @@ vlc_module_begin()
 vlc_module_end()
 
 /*
- * Extracts the result document from a SOAP response
+ * Parses the DIDL document from the Result of a SOAP Browse response
  */
-IXML_Document* parseBrowseResult( IXML_Document* p_doc )
+IXML_Document* parseBrowseResult( const char* psz_raw_didl )
 {
-    assert( p_doc );
-
-    // ixml*_getElementsByTagName will ultimately only case the pointer to a Node
-    // pointer, and pass it to a private function. Don't bother have a IXML_Document
-    // version of getChildElementValue
-    const char* psz_raw_didl = xml_getChildElementValue( (IXML_Element*)p_doc, "Result" );
-
-    if( !psz_raw_didl )
-        return NULL;
+    assert( psz_raw_didl );
 
     /* First, try parsing the buffer as is */
     IXML_Document* p_result_doc = ixmlParseBuffer( psz_raw_didl );
@@ -1174,18 +1176,18 @@ int MediaServer::sendActionCb( Upnp_EventType eventType,
 IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
                                            const char* psz_browser_flag_,
                                            const char* psz_filter_,
-                                           const char* psz_requested_count_,
+                                           unsigned i_starting_index_,
+                                           unsigned i_requested_count_,
                                            const char* psz_sort_criteria_ )
 {
     IXML_Document* p_action = NULL;
-    IXML_Document* p_response = NULL;
-    Upnp_i11e_cb *i11eCb = NULL;
-    access_sys_t *sys = (access_sys_t *)m_access->p_sys;
-
+    char psz_starting_index[11], psz_requested_count[11];
     int i_res;
 
-    if ( vlc_killed() )
-        return NULL;
+    snprintf( psz_starting_index, sizeof( psz_starting_index ), "%u",
+              i_starting_index_ );
+    snprintf( psz_requested_count, sizeof( psz_requested_count ), "%u",
+              i_requested_count_ );
 
     i_res = UpnpAddToAction( &p_action, "Browse",
             CONTENT_DIRECTORY_SERVICE_TYPE, "ObjectID", psz_object_id_ ? psz_object_id_ : "0" );
@@ -1194,7 +1196,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'ObjectID' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1204,7 +1206,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'BrowseFlag' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1214,26 +1216,26 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'Filter' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
-            CONTENT_DIRECTORY_SERVICE_TYPE, "StartingIndex", "0" );
+            CONTENT_DIRECTORY_SERVICE_TYPE, "StartingIndex", psz_starting_index );
     if ( i_res != UPNP_E_SUCCESS )
     {
         msg_Dbg( m_access, "AddToAction 'StartingIndex' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
-            CONTENT_DIRECTORY_SERVICE_TYPE, "RequestedCount", psz_requested_count_ );
+            CONTENT_DIRECTORY_SERVICE_TYPE, "RequestedCount", psz_requested_count );
 
     if ( i_res != UPNP_E_SUCCESS )
     {
         msg_Dbg( m_access, "AddToAction 'RequestedCount' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
@@ -1243,13 +1245,34 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Dbg( m_access, "AddToAction 'SortCriteria' failed: %s",
                 UpnpGetErrorMessage( i_res ) );
-        goto browseActionCleanup;
+        goto browseActionError;
     }
 
+    return p_action;
+
+browseActionError:
+    ixmlDocument_free( p_action );
+    return NULL;
+}
+
+/*
+ * Sends an action without waiting for the response. The returned callback
+ * must be waited for with waitAndRelease(), then *pp_response is set if the
+ * action succeeded.
+ */
+Upnp_i11e_cb* MediaServer::_sendActionAsync( IXML_Document* p_action,
+                                             IXML_Document** pp_response )
+{
+    access_sys_t *sys = (access_sys_t *)m_access->p_sys;
+
+    *pp_response = NULL;
+    if ( vlc_killed() )
+        return NULL;
+
     /* Setup an interruptible callback that will call sendActionCb if not
      * interrupted by vlc_interrupt_kill */
-    i11eCb = new Upnp_i11e_cb( sendActionCb, &p_response );
-    i_res = UpnpSendActionAsync( sys->p_upnp->handle(),
+    Upnp_i11e_cb *i11eCb = new Upnp_i11e_cb( sendActionCb, pp_response );
+    int i_res = UpnpSendActionAsync( sys->p_upnp->handle(),
               m_psz_root,
               CONTENT_DIRECTORY_SERVICE_TYPE,
               NULL, /* ignored in SDK, must be NULL */
@@ -1260,36 +1283,55 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Err( m_access, "%s when trying the send() action with URL: %s",
                 UpnpGetErrorMessage( i_res ), m_access->psz_location );
+        /* The callback will never be called */
+        delete i11eCb;
+        return NULL;
     }
-    /* Wait for the callback to fill p_response or wait for an interrupt */
-    i11eCb->waitAndRelease();
+    return i11eCb;
+}
 
-browseActionCleanup:
-    ixmlDocument_free( p_action );
+IXML_Document* MediaServer::_sendAction( IXML_Document* p_action )
+{
+    IXML_Document* p_response;
+    Upnp_i11e_cb *i11eCb = _sendActionAsync( p_action, &p_response );
+
+    /* Wait for the callback to fill p_response or wait for an interrupt */
+    if ( i11eCb )
+        i11eCb->waitAndRelease();
     return p_response;
 }
 
 /*
- * Fetches and parses the UPNP response
+ * Returns the SystemUpdateID of the server, which changes whenever any of
+ * its containers changes, or an empty string if not available
  */
-bool MediaServer::fetchContents()
+std::string MediaServer::getSystemUpdateId()
 {
-    IXML_Document* p_response = _browseAction( m_psz_objectId,
-                                      "BrowseDirectChildren",
-                                      "*",
-                                      // Some servers don't understand "0" as "no-limit"
-                                      "5000", /* RequestedCount */
-                                      "" /* SortCriteria */
-                                      );
-    if ( !p_response )
+    std::string id;
+    IXML_Document* p_action = UpnpMakeAction( "GetSystemUpdateID",
+                                    CONTENT_DIRECTORY_SERVICE_TYPE, 0, NULL );
+    if ( !p_action )
+        return id;
+
+    IXML_Document* p_response = _sendAction( p_action );
+    ixmlDocument_free( p_action );
+    if ( p_response )
     {
-        msg_Err( m_access, "No response from browse() action" );
-        return false;
+        const char* psz_id = xml_getChildElementValue( (IXML_Element*)p_response,
+                                                       "Id" );
+        if ( psz_id )
+            id = psz_id;
+        ixmlDocument_free( p_response );
     }
+    return id;
+}
 
-    IXML_Document* p_result = parseBrowseResult( p_response );
-
-    ixmlDocument_free( p_response );
+/*
+ * Adds the containers and items of a DIDL document to the node
+ */
+bool MediaServer::addResults( const char* psz_raw_didl )
+{
+    IXML_Document* p_result = parseBrowseResult( psz_raw_didl );
 
     if ( !p_result )
     {
@@ -1323,6 +1365,213 @@ bool MediaServer::fetchContents()
     return true;
 }
 
+/*
+ * Reads a Browse response, adds its objects to the node and keeps its DIDL
+ * document for the cache.
+ *
+ * \return the number of objects returned, or -1 on error
+ */
+int MediaServer::processPage( IXML_Document* p_response, unsigned* pi_total )
+{
+    IXML_Element* p_elem = (IXML_Element*)p_response;
+    const char* psz_raw_didl = xml_getChildElementValue( p_elem, "Result" );
+    const char* psz_returned = xml_getChildElementValue( p_elem, "NumberReturned" );
+    const char* psz_total = xml_getChildElementValue( p_elem, "TotalMatches" );
+
+    if ( !psz_raw_didl || !addResults( psz_raw_didl ) )
+        return -1;
+    m_pages.push_back( psz_raw_didl );
+
+    /* Servers not reporting counts are assumed to send everything at once */
+    int i_returned = psz_returned ? atoi( psz_returned ) : 0;
+    if ( psz_total && pi_total )
+        *pi_total = strtoul( psz_total, NULL, 10 );
+    return i_returned;
+}
+
+namespace
+{
+    struct PendingBrowse
+    {
+        unsigned i_start;
+        IXML_Document* p_response;
+        Upnp_i11e_cb* i11eCb;
+    };
+}
+
+/*
+ * Fetches and parses the UPNP response
+ */
+bool MediaServer::fetchContents()
+{
+    std::string key = std::string( m_psz_root ) + '\n' +
+                      ( m_psz_objectId ? m_psz_objectId : "0" );
+    std::string updateId = getSystemUpdateId();
+
+    if ( s_cache.get( key, updateId, m_pages ) )
+    {
+        msg_Dbg( m_access, "Using cached listing of %s", key.c_str() );
+        for ( const std::string& page : m_pages )
+            addResults( page.c_str() );
+        return true;
+    }
+
+    /* The first page gives the size of the container and of the pages */
+    IXML_Document* p_action = _browseAction( m_psz_objectId,
+                                      "BrowseDirectChildren",
+                                      "*",
+                                      0, /* StartingIndex */
+                                      BROWSE_PAGE_SIZE, /* RequestedCount */
+                                      "" /* SortCriteria */
+                                      );
+    if ( !p_action )
+        return false;
+
+    IXML_Document* p_response = _sendAction( p_action );
+    ixmlDocument_free( p_action );
+    if ( !p_response )
+    {
+        msg_Err( m_access, "No response from browse() action" );
+        return false;
+    }
+
+    unsigned i_total = 0;
+    int i_page = processPage( p_response, &i_total );
+    ixmlDocument_free( p_response );
+    if ( i_page < 0 )
+        return false;
+
+    /* Request the next pages concurrently, but add them in order */
+    std::deque<PendingBrowse*> pending;
+    unsigned i_done = i_page, i_next = i_page;
+    bool b_complete = i_page == 0 || i_done >= i_total;
+
+    while ( !b_complete )
+    {
+        while ( pending.size() < BROWSE_MAX_PENDING && i_next < i_total )
+        {
+            p_action = _browseAction( m_psz_objectId, "BrowseDirectChildren",
+                                      "*", i_next, i_page, "" );
+            if ( !p_action )
+                break;
+
+            PendingBrowse* p_browse = new PendingBrowse;
+            p_browse->i_start = i_next;
+            p_browse->i11eCb = _sendActionAsync( p_action, &p_browse->p_response );
+            ixmlDocument_free( p_action );
+            if ( !p_browse->i11eCb )
+            {
+                delete p_browse;
+                break;
+            }
+            pending.push_back( p_browse );
+            i_next += i_page;
+        }
+        if ( pending.empty() )
+            break;
+
+        PendingBrowse* p_browse = pending.front();
+        pending.pop_front();
+        p_browse->i11eCb->waitAndRelease();
+        p_response = p_browse->p_response;
+        delete p_browse;
+        if ( !p_response )
+            break;
+
+        int i_returned = processPage( p_response, NULL );
+        ixmlDocument_free( p_response );
+        if ( i_returned <= 0 )
+            break;
+
+        i_done += i_returned;
+        b_complete = i_done >= i_total;
+        if ( i_returned < i_page && !b_complete )
+        {
+            /* Short page: the pending requests start at the wrong index */
+            while ( !pending.empty() )
+            {
+                p_browse = pending.front();
+                pending.pop_front();
+                p_browse->i11eCb->waitAndRelease();
+                if ( p_browse->p_response )
+                    ixmlDocument_free( p_browse->p_response );
+                delete p_browse;
+            }
+            i_next = i_done;
+            i_page = i_returned;
+        }
+    }
+
+    while ( !pending.empty() )
+    {
+        PendingBrowse* p_browse = pending.front();
+        pending.pop_front();
+        p_browse->i11eCb->waitAndRelease();
+        if ( p_browse->p_response )
+            ixmlDocument_free( p_browse->p_response );
+        delete p_browse;
+    }
+
+    if ( !b_complete )
+    {
+        msg_Warn( m_access, "Incomplete listing: %u of %u objects", i_done,
+                  i_total );
+        return true;
+    }
+    s_cache.put( key, updateId, std::move( m_pages ) );
+    return true;
+}
+
+MediaServer::BrowseCache MediaServer::s_cache;
+
+bool MediaServer::BrowseCache::get( const std::string& key,
+                                    const std::string& updateId,
+                                    std::vector<std::string>& pages )
+{
+    vlc::threads::mutex_locker lock( m_lock );
+    auto it = m_entries.find( key );
+    if ( it == m_entries.end() )
+        return false;
+    if ( it->second.updateId != updateId ||
+         vlc_tick_now() - it->second.date > BROWSE_CACHE_TTL )
+    {
+        m_entries.erase( it );
+        return false;
+    }
+    pages = it->second.pages;
+    return true;
+}
+
+void MediaServer::BrowseCache::put( const std::string& key,
+                                    const std::string& updateId,
+                                    std::vector<std::string> pages )
+{
+    vlc::threads::mutex_locker lock( m_lock );
+    vlc_tick_t now = vlc_tick_now();
+
+    /* Make room by dropping expired listings, then the oldest one */
+    for ( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if ( now - it->second.date > BROWSE_CACHE_TTL )
+            it = m_entries.erase( it );
+        else
+            ++it;
+    }
+    if ( m_entries.size() >= BROWSE_CACHE_SIZE && !m_entries.count( key ) )
+    {
+        auto oldest = std::min_element( m_entries.begin(), m_entries.end(),
+            []( const Entries::value_type& a, const Entries::value_type& b ) {
+                return a.second.date < b.second.date;
+            } );
+        m_entries.erase( oldest );
+    }
+
+    Entry& entry = m_entries[key];
+    entry.date = now;
+    entry.updateId = updateId;
+    entry.pages = std::move( pages );
+}
+
 static int ReadDirectory( stream_t *p_access, input_item_node_t* p_node )
 {
     MediaServer server( p_access, p_node );
@@ -24,6 +24,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -112,15 +113,48 @@ private:
     bool addContainer( IXML_Element* containerElement );
     bool addItem( IXML_Element* itemElement );
 
+    bool addResults( const char* psz_raw_didl );
+    int processPage( IXML_Document* p_response, unsigned* pi_total );
+
     IXML_Document* _browseAction(const char*, const char*,
-            const char*, const char*, const char* );
+            const char*, unsigned, unsigned, const char* );
+    Upnp_i11e_cb* _sendActionAsync( IXML_Document* p_action,
+                                    IXML_Document** pp_response );
+    IXML_Document* _sendAction( IXML_Document* p_action );
+    std::string getSystemUpdateId();
     static int sendActionCb( Upnp_EventType, UpnpEventPtr, void *);
 
+    /* Container listings (DIDL documents of each page), shared by all the
+     * access instances so that browsing a node again needs no request */
+    class BrowseCache
+    {
+    public:
+        bool get( const std::string& key, const std::string& updateId,
+                  std::vector<std::string>& pages );
+        void put( const std::string& key, const std::string& updateId,
+                  std::vector<std::string> pages );
+
+    private:
+        struct Entry
+        {
+            vlc_tick_t date;
+            std::string updateId;
+            std::vector<std::string> pages;
+        };
+        typedef std::map<std::string, Entry> Entries;
+
+        vlc::threads::mutex m_lock;
+        Entries m_entries;
+    };
+
 private:
     char* m_psz_root;
     char* m_psz_objectId;
     stream_t* m_access;
     input_item_node_t* m_node;
+    std::vector<std::string> m_pages;
+
+    static BrowseCache s_cache;
 };
 
 }
@@ -61,9 +61,27 @@ vlc_module_begin()
 vlc_module_end()
 
 typedef struct libarchive_callback_t libarchive_callback_t;
+typedef struct archive_checkpoint_t archive_checkpoint_t;
 typedef struct private_sys_t private_sys_t;
 typedef struct archive libarchive_t;
 
+/* Compressed entries cannot be seeked into: the decompressor state has to
+ * be rebuilt by decoding from the start of the entry. Instead of discarding
+ * the libarchive handle on backward seeks, it is parked as a checkpoint, so
+ * that later seeks resume decoding from the closest handle before the
+ * target. Each handle holds a decompressor state (up to the dictionary size
+ * for LZMA), hence the small count. */
+#define ARCHIVE_CHECKPOINTS 4
+
+struct archive_checkpoint_t
+{
+    libarchive_t* p_archive;
+    libarchive_callback_t* p_callback_data;
+    uint64_t i_offset;
+    uint64_t i_used;
+    bool b_eof;
+};
+
 struct private_sys_t
 {
     libarchive_t* p_archive;
@@ -76,18 +94,25 @@ struct private_sys_t
 
     uint64_t i_offset;
 
-    uint8_t buffer[ 8192 ];
     bool b_seekable_source;
     bool b_seekable_archive;
 
     libarchive_callback_t** pp_callback_data;
     size_t i_callback_data;
+
+    archive_checkpoint_t checkpoints[ ARCHIVE_CHECKPOINTS ];
+    uint64_t i_checkpoint_clock;
 };
 
 struct libarchive_callback_t {
     private_sys_t* p_sys;
     stream_t* p_source;
     char* psz_url;
+
+    /* position of this handle in p_source, which is shared by the
+     * checkpoints */
+    uint64_t i_position;
+    uint8_t buffer[ 8192 ];
 };
 
 /* ------------------------------------------------------------------------- */
@@ -102,6 +127,8 @@ static int libarchive_exit_cb( libarchive_t* p_arc, void* p_obj )
     {  /* DO NOT CLOSE OUR MOTHER STREAM */
         if( !p_cb->p_sys->b_dead && vlc_stream_Seek( p_cb->p_source, 0 ) )
             return ARCHIVE_FATAL;
+
+        p_cb->i_position = 0;
     }
     else if( p_cb->p_source )
     {
@@ -122,8 +149,11 @@ static int libarchive_jump_cb( libarchive_t* p_arc, void* p_obj_current,
         return ARCHIVE_FATAL;
 
     if( p_next->p_source == NULL )
+    {
         p_next->p_source = vlc_stream_NewURL( p_next->p_sys->p_obj,
                                               p_next->psz_url );
+        p_next->i_position = 0;
+    }
 
     return p_next->p_source ? ARCHIVE_OK : ARCHIVE_FATAL;
 }
@@ -143,14 +173,19 @@ static la_int64_t libarchive_skip_cb( libarchive_t* p_arc, void* p_obj,
 
     if( p_sys->b_seekable_source )
     {
-        if( vlc_stream_Seek( p_source, vlc_stream_Tell( p_source ) + i_request ) )
+        if( vlc_stream_Seek( p_source, p_cb->i_position + i_request ) )
             return ARCHIVE_FATAL;
 
+        p_cb->i_position += i_request;
         return i_request;
     }
 
     ssize_t i_read = vlc_stream_Read( p_source, NULL, i_request );
-    return  i_read >= 0 ? i_read : ARCHIVE_FATAL;
+    if( i_read < 0 )
+        return ARCHIVE_FATAL;
+
+    p_cb->i_position += i_read;
+    return i_read;
 }
 
 static la_int64_t libarchive_seek_cb( libarchive_t* p_arc, void* p_obj,
@@ -165,8 +200,8 @@ static la_int64_t libarchive_seek_cb( libarchive_t* p_arc, void* p_obj,
 
     switch( whence )
     {
-        case SEEK_SET: whence_pos = 0;                           break;
-        case SEEK_CUR: whence_pos = vlc_stream_Tell( p_source ); break;
+        case SEEK_SET: whence_pos = 0;                    break;
+        case SEEK_CUR: whence_pos = p_cb->i_position;     break;
         case SEEK_END: whence_pos = stream_Size( p_source ); break;
               default: vlc_assert_unreachable();
 
@@ -175,36 +210,75 @@ static la_int64_t libarchive_seek_cb( libarchive_t* p_arc, void* p_obj,
     if( whence_pos < 0 || vlc_stream_Seek( p_source, whence_pos + offset ) )
         return ARCHIVE_FATAL;
 
-    return vlc_stream_Tell( p_source );
+    p_cb->i_position = vlc_stream_Tell( p_source );
+    return p_cb->i_position;
 }
 
 static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
   const void** pp_dst )
 {
-    VLC_UNUSED( p_arc );
-
     libarchive_callback_t* p_cb = (libarchive_callback_t*)p_obj;
 
     stream_t*  p_source = p_cb->p_source;
-    private_sys_t* p_sys = p_cb->p_sys;
 
-    ssize_t i_ret = vlc_stream_Read( p_source, &p_sys->buffer,
-      sizeof( p_sys->buffer ) );
+    /* another handle may have moved the shared source stream */
+    if( vlc_stream_Tell( p_source ) != p_cb->i_position
+     && vlc_stream_Seek( p_source, p_cb->i_position ) )
+    {
+        archive_set_error( p_arc, ARCHIVE_FATAL,
+          "libarchive_read_cb failed to seek to %"PRIu64, p_cb->i_position );
+
+        return ARCHIVE_FATAL;
+    }
+
+    ssize_t i_ret = vlc_stream_Read( p_source, &p_cb->buffer,
+      sizeof( p_cb->buffer ) );
 
     if( i_ret < 0 )
     {
-        archive_set_error( p_sys->p_archive, ARCHIVE_FATAL,
+        archive_set_error( p_arc, ARCHIVE_FATAL,
           "libarchive_read_cb failed = %zd", i_ret );
 
         return ARCHIVE_FATAL;
     }
 
-    *pp_dst = &p_sys->buffer;
+    p_cb->i_position += i_ret;
+    *pp_dst = &p_cb->buffer;
     return i_ret;
 }
 
 /* ------------------------------------------------------------------------- */
 
+static libarchive_callback_t* archive_callback_new( private_sys_t* p_sys,
+  stream_t* p_source, char const* psz_url )
+{
+    libarchive_callback_t* p_callback_data;
+
+    p_callback_data = malloc( sizeof( *p_callback_data ) );
+
+    if( unlikely( !p_callback_data ) )
+        return NULL;
+
+    p_callback_data->psz_url  = psz_url ? strdup( psz_url ) : NULL;
+    p_callback_data->p_source = p_source;
+    p_callback_data->p_sys    = p_sys;
+    p_callback_data->i_position = 0;
+
+    if( unlikely( !p_callback_data->psz_url && psz_url ) )
+    {
+        free( p_callback_data );
+        return NULL;
+    }
+
+    return p_callback_data;
+}
+
+static void archive_callback_free( libarchive_callback_t* p_callback_data )
+{
+    free( p_callback_data->psz_url );
+    free( p_callback_data );
+}
+
 static int archive_push_resource( private_sys_t* p_sys,
   stream_t* p_source, char const* psz_url )
 {
@@ -219,25 +293,13 @@ static int archive_push_resource( private_sys_t* p_sys,
     if( unlikely( !pp_callback_data ) )
         goto error;
 
-    /* CREATE NEW NODE */
+    /* CREATE NEW NODE AND APPEND */
 
-    p_callback_data = malloc( sizeof( *p_callback_data ) );
+    p_callback_data = archive_callback_new( p_sys, p_source, psz_url );
 
     if( unlikely( !p_callback_data ) )
         goto error;
 
-    /* INITIALIZE AND APPEND */
-
-    p_callback_data->psz_url  = psz_url ? strdup( psz_url ) : NULL;
-    p_callback_data->p_source = p_source;
-    p_callback_data->p_sys    = p_sys;
-
-    if( unlikely( !p_callback_data->psz_url && psz_url ) )
-    {
-        free( p_callback_data );
-        goto error;
-    }
-
     pp_callback_data[ p_sys->i_callback_data++ ] = p_callback_data;
     p_sys->pp_callback_data = pp_callback_data;
 
@@ -297,8 +359,12 @@ static int archive_init( private_sys_t* p_sys, stream_t* source )
 
     for( size_t i = 0; i < p_sys->i_callback_data; ++i )
     {
-        if( archive_read_append_callback_data( p_sys->p_archive,
-            p_sys->pp_callback_data[i] ) )
+        libarchive_callback_t* p_cb = p_sys->pp_callback_data[i];
+
+        p_cb->i_position = p_cb->p_source ? vlc_stream_Tell( p_cb->p_source )
+                                          : 0;
+
+        if( archive_read_append_callback_data( p_sys->p_archive, p_cb ) )
         {
             return VLC_EGENERIC;
         }
@@ -403,6 +469,109 @@ static int archive_extractor_reset( stream_extractor_t* p_extractor )
     return VLC_SUCCESS;
 }
 
+static bool archive_checkpoints_enabled( private_sys_t* p_sys )
+{
+    /* the handles of a multi-volume archive would each need their own
+     * volume streams */
+    return p_sys->b_seekable_source && p_sys->i_callback_data == 1;
+}
+
+static void archive_checkpoint_swap( private_sys_t* p_sys,
+  archive_checkpoint_t* p_cp )
+{
+    archive_checkpoint_t cur = {
+        .p_archive = p_sys->p_archive,
+        .p_callback_data = p_sys->pp_callback_data[0],
+        .i_offset = p_sys->i_offset,
+        .i_used = ++p_sys->i_checkpoint_clock,
+        .b_eof = p_sys->b_eof,
+    };
+
+    p_sys->p_archive = p_cp->p_archive;
+    p_sys->pp_callback_data[0] = p_cp->p_callback_data;
+    p_sys->i_offset = p_cp->i_offset;
+    p_sys->b_eof = p_cp->b_eof;
+
+    *p_cp = cur;
+}
+
+static void archive_checkpoint_clean( archive_checkpoint_t* p_cp )
+{
+    if( p_cp->p_archive == NULL )
+        return;
+
+    archive_read_free( p_cp->p_archive );
+    archive_callback_free( p_cp->p_callback_data );
+    p_cp->p_archive = NULL;
+    p_cp->p_callback_data = NULL;
+}
+
+/**
+ * Moves the extractor to the handle that can reach the requested offset
+ * by decoding the least data: the current handle, a checkpoint, or a new
+ * handle decoding from the start of the entry. The current handle is kept
+ * as a checkpoint unless it is dead.
+ */
+static int archive_checkpoint_restore( stream_extractor_t* p_extractor,
+  uint64_t i_req )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    archive_checkpoint_t* p_best = NULL;
+    archive_checkpoint_t* p_victim = &p_sys->checkpoints[0];
+
+    for( size_t i = 0; i < ARCHIVE_CHECKPOINTS; ++i )
+    {
+        archive_checkpoint_t* p_cp = &p_sys->checkpoints[i];
+
+        if( p_cp->p_archive == NULL )
+        {
+            if( p_victim->p_archive != NULL )
+                p_victim = p_cp;
+            continue;
+        }
+
+        if( p_cp->i_offset <= i_req
+         && ( p_best == NULL || p_cp->i_offset > p_best->i_offset ) )
+            p_best = p_cp;
+
+        if( p_victim->p_archive != NULL && p_cp->i_used < p_victim->i_used )
+            p_victim = p_cp;
+    }
+
+    if( !p_sys->b_dead && p_sys->i_offset <= i_req
+     && ( p_best == NULL || p_best->i_offset <= p_sys->i_offset ) )
+        return VLC_SUCCESS; /* keep decoding forward */
+
+    if( p_best != NULL )
+    {
+        msg_Dbg( p_extractor, "resuming from checkpoint at %"PRIu64,
+                 p_best->i_offset );
+        archive_checkpoint_swap( p_sys, p_best );
+
+        if( p_sys->b_dead )
+        {
+            archive_checkpoint_clean( p_best );
+            p_sys->b_dead = false;
+        }
+        return VLC_SUCCESS;
+    }
+
+    if( !p_sys->b_dead && p_sys->p_archive != NULL )
+    {
+        libarchive_callback_t* p_cb = archive_callback_new( p_sys,
+                                                            p_sys->source,
+                                                            NULL );
+        if( likely( p_cb != NULL ) )
+        {
+            archive_checkpoint_clean( p_victim );
+            archive_checkpoint_swap( p_sys, p_victim );
+            p_sys->pp_callback_data[0] = p_cb;
+        }
+    }
+
+    return archive_extractor_reset( p_extractor );
+}
+
 /* ------------------------------------------------------------------------- */
 
 static private_sys_t* setup( vlc_object_t* obj, stream_t* source )
@@ -545,7 +714,7 @@ static int ReadDir( stream_directory_t* p_directory, input_item_node_t* p_node )
             break;
 
         if( vlc_readdir_helper_additem( &rdh, mrl, path, NULL, ITEM_TYPE_FILE,
-                                        ITEM_LOCAL ) )
+                                        ITEM_LOCAL, NULL ) )
         {
             free( mrl );
             break;
@@ -643,22 +812,28 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
             "intrinsic seek failed: '%s' (falling back to dumb seek)",
             archive_error_string( p_sys->p_archive ) );
 
-        uint64_t i_skip = i_req - p_sys->i_offset;
-
-        /* RECREATE LIBARCHIVE HANDLE IF WE ARE SEEKING BACKWARDS */
+        if( archive_checkpoints_enabled( p_sys ) )
+        {
+            /* RESUME FROM THE CLOSEST HANDLE BEFORE THE TARGET */
 
-        if( i_req < p_sys->i_offset )
+            if( archive_checkpoint_restore( p_extractor, i_req ) )
+            {
+                msg_Err( p_extractor, "unable to reset libarchive handle" );
+                return VLC_EGENERIC;
+            }
+        }
+        else if( i_req < p_sys->i_offset )
         {
+            /* RECREATE LIBARCHIVE HANDLE IF WE ARE SEEKING BACKWARDS */
+
             if( archive_extractor_reset( p_extractor ) )
             {
                 msg_Err( p_extractor, "unable to reset libarchive handle" );
                 return VLC_EGENERIC;
             }
-
-            i_skip = i_req;
         }
 
-        if( archive_skip_decompressed( p_extractor, i_skip ) )
+        if( archive_skip_decompressed( p_extractor, i_req - p_sys->i_offset ) )
             msg_Dbg( p_extractor, "failed to skip to seek position" );
     }
 
@@ -670,6 +845,10 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
 static void CommonClose( private_sys_t* p_sys )
 {
     p_sys->b_dead = true;
+
+    for( size_t i = 0; i < ARCHIVE_CHECKPOINTS; ++i )
+        archive_checkpoint_clean( &p_sys->checkpoints[i] );
+
     archive_clean( p_sys );
 
     for( size_t i = 0; i < p_sys->i_callback_data; ++i )
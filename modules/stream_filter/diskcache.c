@@ -0,0 +1,490 @@
+/*****************************************************************************
+ * diskcache.c: persistent on-disk byte range cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
+
+/*
+ * Each cached resource is stored as two files named after a digest of its
+ * URL, size and validator (entity tag or modification time), so that a new
+ * version of the content never hits stale data:
+ *  - <digest>.data is a sparse copy of the content,
+ *  - <digest>.map is a header followed by one bit per cached block.
+ * Blocks are written to the data file before being marked in the map.
+ * Entries are evicted least recently used first when the total size exceeds
+ * the configured bound.
+ */
+#define DISKCACHE_BLOCK (256 * 1024)
+#define DISKCACHE_MAGIC "VLCDC001"
+#define DISKCACHE_HEADER 16
+
+typedef struct
+{
+    uint64_t size;
+    uint64_t offset; /* returned offset */
+    uint64_t source_offset; /* underlying stream offset */
+
+    int data_fd;
+    int map_fd;
+    uint8_t *map;
+    size_t blocks;
+
+    uint8_t *buf; /* last fetched block */
+    uint64_t buf_start;
+    size_t buf_len;
+
+    char *name;
+    char *dir;
+    uint64_t max_bytes;
+} stream_sys_t;
+
+static bool BlockCached(const stream_sys_t *sys, size_t blk)
+{
+    return (sys->map[blk / 8] >> (blk % 8)) & 1;
+}
+
+static void BlockSetCached(stream_sys_t *sys, size_t blk, bool cached)
+{
+    if (cached)
+        sys->map[blk / 8] |= 1 << (blk % 8);
+    else
+        sys->map[blk / 8] &= ~(1 << (blk % 8));
+
+    if (pwrite(sys->map_fd, &sys->map[blk / 8], 1,
+               DISKCACHE_HEADER + blk / 8) != 1)
+        sys->map[blk / 8] &= ~(1 << (blk % 8));
+}
+
+/* Fetches a block from the underlying stream, and stores it if complete */
+static int Fetch(stream_t *s, size_t blk)
+{
+    stream_sys_t *sys = s->p_sys;
+    uint64_t start = (uint64_t)blk * DISKCACHE_BLOCK;
+    size_t len = __MIN(DISKCACHE_BLOCK, sys->size - start);
+    size_t got = 0;
+
+    sys->buf_len = 0;
+
+    if (sys->source_offset != start)
+    {
+        if (vlc_stream_Seek(s->s, start))
+            return -1;
+        sys->source_offset = start;
+    }
+
+    while (got < len)
+    {
+        ssize_t val = vlc_stream_Read(s->s, sys->buf + got, len - got);
+        if (val <= 0)
+            break;
+        got += val;
+    }
+
+    sys->source_offset += got;
+    sys->buf_start = start;
+    sys->buf_len = got;
+
+    if (got < len)
+    {   /* Interrupted or truncated: do not store the partial block */
+        msg_Dbg(s, "block %zu incomplete (%zu of %zu bytes)", blk, got, len);
+        return got > 0 ? 0 : -1;
+    }
+
+    if (pwrite(sys->data_fd, sys->buf, len, start) == (ssize_t)len)
+        BlockSetCached(sys, blk, true);
+    else
+        msg_Warn(s, "cannot store block %zu: %s", blk, vlc_strerror_c(errno));
+    return 0;
+}
+
+static ssize_t Read(stream_t *s, void *buf, size_t len)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    if (sys->offset >= sys->size)
+        return 0;
+
+    size_t blk = sys->offset / DISKCACHE_BLOCK;
+    uint64_t end = __MIN((uint64_t)(blk + 1) * DISKCACHE_BLOCK, sys->size);
+
+    if (len > end - sys->offset)
+        len = end - sys->offset;
+
+    if (sys->buf_len == 0 || sys->buf_start != (uint64_t)blk * DISKCACHE_BLOCK)
+    {
+        if (BlockCached(sys, blk))
+        {
+            ssize_t val = pread(sys->data_fd, buf, len, sys->offset);
+            if (val == (ssize_t)len)
+            {
+                sys->offset += len;
+                return len;
+            }
+            msg_Warn(s, "cannot load block %zu", blk);
+            BlockSetCached(sys, blk, false);
+        }
+
+        if (Fetch(s, blk))
+            return -1;
+    }
+
+    uint64_t pos = sys->offset - sys->buf_start;
+    if (pos >= sys->buf_len)
+        return 0; /* truncated block */
+
+    if (len > sys->buf_len - pos)
+        len = sys->buf_len - pos;
+    memcpy(buf, sys->buf + pos, len);
+    sys->offset += len;
+    return len;
+}
+
+static int Seek(stream_t *s, uint64_t offset)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    /* The underlying stream is only sought on cache miss */
+    sys->offset = offset;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *s, int query, va_list args)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    switch (query)
+    {
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = sys->size;
+            return VLC_SUCCESS;
+    }
+
+    return vlc_stream_vaControl(s->s, query, args);
+}
+
+struct diskcache_entry
+{
+    char *name;
+    time_t mtime;
+    uint64_t bytes;
+};
+
+static int EntryCmp(const void *a, const void *b)
+{
+    const struct diskcache_entry *ea = a, *eb = b;
+
+    return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+static void Unlink(const char *dir, const char *name, const char *ext)
+{
+    char *path;
+
+    if (asprintf(&path, "%s"DIR_SEP"%s.%s", dir, name, ext) >= 0)
+    {
+        vlc_unlink(path);
+        free(path);
+    }
+}
+
+/* Evicts the least recently used entries, other than the given one, until the
+ * cache fits in the size bound */
+static void Trim(vlc_object_t *obj, const char *dir, const char *keep,
+                 uint64_t max_bytes)
+{
+    DIR *dh = vlc_opendir(dir);
+    if (dh == NULL)
+        return;
+
+    struct diskcache_entry *entries = NULL;
+    size_t count = 0;
+    uint64_t total = 0;
+    const char *filename;
+
+    while ((filename = vlc_readdir(dh)) != NULL)
+    {
+        const char *ext = strrchr(filename, '.');
+        if (ext == NULL || strcmp(ext, ".data"))
+            continue;
+
+        char *path;
+        struct stat st;
+
+        if (asprintf(&path, "%s"DIR_SEP"%s", dir, filename) < 0)
+            continue;
+        if (vlc_stat(path, &st))
+        {
+            free(path);
+            continue;
+        }
+        free(path);
+
+        uint64_t bytes = (uint64_t)st.st_blocks * 512;
+        total += bytes;
+
+        if (!strncmp(filename, keep, ext - filename)
+         && keep[ext - filename] == '\0')
+            continue;
+
+        struct diskcache_entry *tab = realloc(entries,
+                                              (count + 1) * sizeof (*tab));
+        if (unlikely(tab == NULL))
+            break;
+        entries = tab;
+        entries[count].name = strndup(filename, ext - filename);
+        if (unlikely(entries[count].name == NULL))
+            break;
+        entries[count].mtime = st.st_mtime;
+        entries[count].bytes = bytes;
+        count++;
+    }
+    closedir(dh);
+
+    qsort(entries, count, sizeof (*entries), EntryCmp);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (total > max_bytes)
+        {
+            msg_Dbg(obj, "evicting %s (%"PRIu64" bytes)", entries[i].name,
+                    entries[i].bytes);
+            Unlink(dir, entries[i].name, "data");
+            Unlink(dir, entries[i].name, "map");
+            total -= entries[i].bytes;
+        }
+        free(entries[i].name);
+    }
+    free(entries);
+}
+
+static char *GetName(const char *url, const char *validator, uint64_t size)
+{
+    struct md5_s md5;
+    uint8_t le[8];
+
+    SetQWLE(le, size);
+    InitMD5(&md5);
+    AddMD5(&md5, url, strlen(url) + 1);
+    AddMD5(&md5, validator, strlen(validator) + 1);
+    AddMD5(&md5, le, sizeof (le));
+    EndMD5(&md5);
+    return psz_md5_hash(&md5);
+}
+
+static int OpenFile(const char *dir, const char *name, const char *ext)
+{
+    char *path;
+
+    if (asprintf(&path, "%s"DIR_SEP"%s.%s", dir, name, ext) < 0)
+        return -1;
+
+    int fd = vlc_open(path, O_RDWR | O_CREAT, 0600);
+    free(path);
+    return fd;
+}
+
+/* Loads or initializes the blocks map */
+static int LoadMap(stream_t *s)
+{
+    stream_sys_t *sys = s->p_sys;
+    size_t len = (sys->blocks + 7) / 8;
+    uint8_t hdr[DISKCACHE_HEADER];
+
+    sys->map = calloc(1, len);
+    if (unlikely(sys->map == NULL))
+        return -1;
+
+    if (pread(sys->map_fd, hdr, sizeof (hdr), 0) == sizeof (hdr)
+     && !memcmp(hdr, DISKCACHE_MAGIC, 8) && GetQWLE(hdr + 8) == sys->size
+     && pread(sys->map_fd, sys->map, len, DISKCACHE_HEADER) == (ssize_t)len)
+    {
+        size_t cached = 0;
+
+        for (size_t i = 0; i < sys->blocks; i++)
+            cached += BlockCached(sys, i);
+        msg_Dbg(s, "%zu of %zu blocks cached", cached, sys->blocks);
+        return 0;
+    }
+
+    /* New or invalid entry */
+    memcpy(hdr, DISKCACHE_MAGIC, 8);
+    SetQWLE(hdr + 8, sys->size);
+    if (ftruncate(sys->data_fd, 0) || ftruncate(sys->map_fd, 0)
+     || pwrite(sys->map_fd, hdr, sizeof (hdr), 0) != sizeof (hdr)
+     || pwrite(sys->map_fd, sys->map, len, DISKCACHE_HEADER) != (ssize_t)len)
+    {
+        msg_Err(s, "cannot initialize cache entry: %s",
+                vlc_strerror_c(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+    stream_sys_t *sys = s->p_sys;
+
+    if (sys->map_fd != -1)
+        vlc_close(sys->map_fd);
+    if (sys->data_fd != -1)
+    {
+        vlc_close(sys->data_fd);
+        Trim(obj, sys->dir, sys->name, sys->max_bytes);
+    }
+    free(sys->map);
+    free(sys->buf);
+    free(sys->name);
+    free(sys->dir);
+    free(sys);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *s = (stream_t *)obj;
+
+    if (s->s->pf_read == NULL || s->psz_url == NULL)
+        return VLC_EGENERIC;
+
+    bool can_seek;
+    uint64_t size;
+    char *validator;
+
+    if (vlc_stream_Control(s->s, STREAM_CAN_SEEK, &can_seek) || !can_seek
+     || vlc_stream_GetSize(s->s, &size) || size == 0)
+        return VLC_EGENERIC;
+
+    if (vlc_stream_Control(s->s, STREAM_GET_VALIDATOR, &validator))
+    {
+        msg_Dbg(s, "no content validator, not caching");
+        return VLC_EGENERIC;
+    }
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+    {
+        free(validator);
+        return VLC_ENOMEM;
+    }
+
+    s->p_sys = sys;
+    sys->size = size;
+    sys->offset = 0;
+    sys->source_offset = vlc_stream_Tell(s->s);
+    sys->data_fd = sys->map_fd = -1;
+    sys->map = NULL;
+    sys->blocks = (size + DISKCACHE_BLOCK - 1) / DISKCACHE_BLOCK;
+    sys->buf = malloc(DISKCACHE_BLOCK);
+    sys->buf_start = 0;
+    sys->buf_len = 0;
+    sys->name = GetName(s->psz_url, validator, size);
+    sys->dir = var_InheritString(s, "diskcache-dir");
+    sys->max_bytes = (uint64_t)var_InheritInteger(s, "diskcache-size") << 20;
+    free(validator);
+
+    if (sys->dir == NULL)
+    {
+        char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+        if (cachedir != NULL)
+        {
+            vlc_mkdir(cachedir, 0700);
+            if (asprintf(&sys->dir, "%s"DIR_SEP"diskcache", cachedir) < 0)
+                sys->dir = NULL;
+            free(cachedir);
+        }
+    }
+
+    if (unlikely(sys->buf == NULL || sys->name == NULL || sys->dir == NULL))
+        goto error;
+
+    if (vlc_mkdir(sys->dir, 0700) && errno != EEXIST)
+    {
+        msg_Err(s, "cannot create %s: %s", sys->dir, vlc_strerror_c(errno));
+        goto error;
+    }
+
+    sys->data_fd = OpenFile(sys->dir, sys->name, "data");
+    sys->map_fd = OpenFile(sys->dir, sys->name, "map");
+    if (sys->data_fd == -1 || sys->map_fd == -1)
+    {
+        msg_Err(s, "cannot open cache entry %s: %s", sys->name,
+                vlc_strerror_c(errno));
+        goto error;
+    }
+
+    if (LoadMap(s))
+        goto error;
+
+    /* Mark as recently used */
+    futimens(sys->data_fd, NULL);
+    Trim(obj, sys->dir, sys->name, sys->max_bytes);
+
+    msg_Dbg(s, "caching %s as %s"DIR_SEP"%s", s->psz_url, sys->dir,
+            sys->name);
+    s->pf_read = Read;
+    s->pf_seek = Seek;
+    s->pf_control = Control;
+    return VLC_SUCCESS;
+
+error:
+    if (sys->data_fd != -1)
+    {
+        vlc_close(sys->data_fd);
+        sys->data_fd = -1;
+    }
+    Close(obj);
+    return VLC_EGENERIC;
+}
+
+#define DIR_TEXT N_("Cache directory")
+#define DIR_LONGTEXT N_("Directory where the cached content is stored " \
+    "(by default, in the user cache directory).")
+#define SIZE_TEXT N_("Cache size (MiB)")
+#define SIZE_LONGTEXT N_("Maximum size of the disk cache. Least recently " \
+    "used content is evicted first.")
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 0)
+    add_shortcut("diskcache")
+
+    set_description(N_("Persistent disk cache"))
+    add_directory("diskcache-dir", NULL, DIR_TEXT, DIR_LONGTEXT)
+    add_integer_with_range("diskcache-size", 4096, 16, 1048576,
+                           SIZE_TEXT, SIZE_LONGTEXT, true)
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -35,6 +35,12 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* Initial buffer size, when the configured size is only an upper bound */
+#define PREFETCH_BUFFER_MIN   (256 << 10)
+/* Data to read ahead, in latencies and at least */
+#define PREFETCH_LATENCIES    8
+#define PREFETCH_HORIZON_MIN  VLC_TICK_FROM_SEC(1)
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -72,9 +78,16 @@ typedef struct
     uint64_t     stream_offset;
     size_t       buffer_length;
     size_t       buffer_size;
+    size_t       buffer_max;
     char        *buffer;
     size_t       seek_threshold;
 
+    /* Consumption rate and upstream latency estimates */
+    vlc_tick_t   rate_date;
+    uint64_t     rate_bytes; /**< bytes read since rate_date */
+    uint64_t     rate; /**< bytes per second */
+    vlc_tick_t   latency;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -86,13 +99,82 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     vlc_mutex_unlock(&sys->lock);
     assert(length > 0);
 
+    vlc_tick_t start = vlc_tick_now();
     ssize_t val = vlc_stream_ReadPartial(stream->s, buf, length);
+    vlc_tick_t latency = vlc_tick_now() - start;
 
     vlc_mutex_lock(&sys->lock);
     vlc_restorecancel(canc);
+
+    if (val > 0) /* Moving average */
+        sys->latency = (7 * sys->latency + latency) / 8;
     return val;
 }
 
+/**
+ * Resizes the circular buffer, keeping the buffered data.
+ */
+static int BufferResize(stream_sys_t *sys, size_t size)
+{
+    char *buffer = malloc(size);
+    if (unlikely(buffer == NULL))
+        return -1;
+
+    uint64_t offset = sys->buffer_offset;
+    uint64_t end = offset + sys->buffer_length;
+
+    assert(size >= sys->buffer_length);
+
+    while (offset < end)
+    {   /* Copy up to the nearest edge of either buffer */
+        size_t from = offset % sys->buffer_size, to = offset % size;
+        size_t len = end - offset;
+
+        if (len > sys->buffer_size - from)
+            len = sys->buffer_size - from;
+        if (len > size - to)
+            len = size - to;
+        memcpy(buffer + to, sys->buffer + from, len);
+        offset += len;
+    }
+
+    free(sys->buffer);
+    sys->buffer = buffer;
+    sys->buffer_size = size;
+    return 0;
+}
+
+/**
+ * Grows the buffer if it cannot hold the data consumed while waiting for
+ * a few upstream reads.
+ */
+static void BufferAdapt(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->buffer_size >= sys->buffer_max)
+        return;
+
+    vlc_tick_t horizon = PREFETCH_LATENCIES * sys->latency;
+    if (horizon < PREFETCH_HORIZON_MIN)
+        horizon = PREFETCH_HORIZON_MIN;
+
+    uint64_t want = sys->rate * horizon / CLOCK_FREQ;
+    if (want <= sys->buffer_size)
+        return;
+
+    size_t size = sys->buffer_size;
+    while (size < want && size < sys->buffer_max)
+        size *= 2;
+    if (size > sys->buffer_max)
+        size = sys->buffer_max;
+
+    if (BufferResize(sys, size) == 0)
+        msg_Dbg(stream, "using %zu bytes buffer (%"PRIu64" bytes/s, "
+                "%"PRId64" us latency)", size, sys->rate,
+                US_FROM_VLC_TICK(sys->latency));
+}
+
 static int ThreadSeek(stream_t *stream, uint64_t seek_offset)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -225,6 +307,7 @@ static void *Thread(void *data)
             continue;
         }
 
+        BufferAdapt(stream);
         assert(sys->buffer_size >= sys->buffer_length);
 
         size_t len = sys->buffer_size - sys->buffer_length;
@@ -341,6 +424,21 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+
+    /* Measure the consumption rate, over at least one second */
+    vlc_tick_t now = vlc_tick_now();
+    sys->rate_bytes += copy;
+    if (now - sys->rate_date >= VLC_TICK_FROM_SEC(1))
+    {
+        uint64_t rate = sys->rate_bytes * CLOCK_FREQ / (now - sys->rate_date);
+
+        if (rate > sys->rate)
+            sys->rate = rate;
+        else /* Moving average */
+            sys->rate = (3 * sys->rate + rate) / 4;
+        sys->rate_date = now;
+        sys->rate_bytes = 0;
+    }
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -466,17 +564,27 @@ static int Open(vlc_object_t *obj)
     sys->buffer_offset = 0;
     sys->stream_offset = 0;
     sys->buffer_length = 0;
-    sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
+    sys->buffer_max = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
     sys->controls = NULL;
+    sys->rate_date = vlc_tick_now();
+    sys->rate_bytes = 0;
+    sys->rate = 0;
+    sys->latency = 0;
 
     uint64_t size = stream_Size(stream->s);
     if (size > 0)
     {   /* No point allocating a buffer larger than the source stream */
-        if (sys->buffer_size > size)
-            sys->buffer_size = size;
+        if (sys->buffer_max > size)
+            sys->buffer_max = size;
     }
 
+    /* Start small, and grow as the bit rate and latency require */
+    sys->buffer_size = sys->buffer_max;
+    if (var_InheritBool(obj, "prefetch-adaptive")
+     && sys->buffer_size > PREFETCH_BUFFER_MIN)
+        sys->buffer_size = PREFETCH_BUFFER_MIN;
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -552,6 +660,10 @@ vlc_module_begin()
     add_integer("prefetch-buffer-size", 1 << 14, N_("Buffer size"),
                 N_("Prefetch buffer size (KiB)"), false)
         change_integer_range(4, 1 << 20)
+    add_bool("prefetch-adaptive", true, N_("Adaptive buffer size"),
+             N_("Start with a small buffer, and grow it up to the buffer "
+                "size as the consumption rate and the access latency "
+                "require."), true)
     add_obsolete_integer("prefetch-read-size") /* since 4.0.0 */
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"), true)
@@ -39,6 +39,9 @@
 #include <vlc_modules.h>
 #include <vlc_httpd.h>
 
+#include "../../packetizer/h264_nal.h"
+#include "../../packetizer/hevc_nal.h"
+
 #include <cassert>
 
 #define TRANSCODING_NONE 0x0
@@ -116,7 +119,7 @@ struct sout_stream_sys_t
         vlc_mutex_destroy(&lock);
     }
 
-    bool canDecodeVideo( vlc_fourcc_t i_codec ) const;
+    bool canDecodeVideo( const es_format_t *p_fmt ) const;
     bool canDecodeAudio( sout_stream_t* p_stream, vlc_fourcc_t i_codec,
                          const audio_format_t* p_fmt ) const;
     bool startSoutChain(sout_stream_t* p_stream,
@@ -402,7 +405,8 @@ void sout_access_out_sys_t::putCopy(block_t *p_block)
         m_copy_last = &m_copy_chain;
     }
     block_ChainLastAppend(&m_copy_last, p_block);
-    m_copy_size += p_block->i_buffer;
+    for (; p_block != NULL; p_block = p_block->p_next)
+        m_copy_size += p_block->i_buffer;
 }
 
 void sout_access_out_sys_t::restoreCopy()
@@ -475,6 +479,7 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         vlc_fifo_Wait(m_fifo);
 
     block_t *p_block = NULL;
+    size_t i_total_size = 0;
     if (m_client && vlc_fifo_GetBytes(m_fifo) > 0)
     {
         /* if less data is available, then we must be EOF */
@@ -486,12 +491,12 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         block_t *p_first = vlc_fifo_DequeueUnlocked(m_fifo);
 
         assert(p_first);
-        size_t i_total_size = p_first->i_buffer;
-        block_t *p_next = NULL, *p_cur = p_first;
+        i_total_size = p_first->i_buffer;
+        block_t *p_cur = p_first;
 
         while (i_total_size < i_min_buffer)
         {
-            p_next = vlc_fifo_DequeueUnlocked(m_fifo);
+            block_t *p_next = vlc_fifo_DequeueUnlocked(m_fifo);
             assert(p_next);
             i_total_size += p_next->i_buffer;
             p_cur->p_next = p_next;
@@ -499,15 +504,8 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         }
         assert(i_total_size >= i_min_buffer);
 
-        if (p_next != NULL)
-        {
-            p_block = block_Alloc(i_total_size);
-            if (p_block)
-                block_ChainExtract(p_first, p_block->p_buffer, p_block->i_buffer);
-            block_ChainRelease(p_first);
-        }
-        else
-            p_block = p_first;
+        /* Keep the chain, it is only copied once into the answer body */
+        p_block = p_first;
 
         if (vlc_fifo_GetBytes(m_fifo) < HTTPD_BUFFER_PACE)
             m_intf->setPacing(false);
@@ -528,7 +526,7 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
         }
 
         const bool send_header = answer->i_body_offset == 0 && m_header != NULL;
-        size_t i_answer_size = p_block->i_buffer;
+        size_t i_answer_size = i_total_size;
         if (send_header)
             i_answer_size += m_header->i_buffer;
 
@@ -543,7 +541,8 @@ int sout_access_out_sys_t::url_cb(httpd_client_t *cl, httpd_message_t *answer,
                 memcpy(answer->p_body, m_header->p_buffer, m_header->i_buffer);
                 i_block_offset = m_header->i_buffer;
             }
-            memcpy(&answer->p_body[i_block_offset], p_block->p_buffer, p_block->i_buffer);
+            block_ChainExtract(p_block, &answer->p_body[i_block_offset],
+                               i_total_size);
         }
 
         putCopy(p_block);
@@ -757,12 +756,38 @@ static void Del(sout_stream_t *p_stream, void *_id)
  * Supported formats: https://developers.google.com/cast/docs/media
  */
 
-bool sout_stream_sys_t::canDecodeVideo( vlc_fourcc_t i_codec ) const
+bool sout_stream_sys_t::canDecodeVideo( const es_format_t *p_fmt ) const
 {
     if( transcoding_state & TRANSCODING_VIDEO )
         return false;
-    return i_codec == VLC_CODEC_H264 || i_codec == VLC_CODEC_HEVC
-        || i_codec == VLC_CODEC_VP8 || i_codec == VLC_CODEC_VP9;
+
+    /* The profile is -1 if unknown, let the device try in that case */
+    switch( p_fmt->i_codec )
+    {
+        case VLC_CODEC_H264:
+            /* 8 bits 4:2:0 only */
+            switch( p_fmt->i_profile )
+            {
+                case -1:
+                case PROFILE_H264_BASELINE:
+                case PROFILE_H264_MAIN:
+                case PROFILE_H264_HIGH:
+                    return true;
+                default:
+                    return false;
+            }
+        case VLC_CODEC_HEVC:
+            return p_fmt->i_profile == -1
+                || p_fmt->i_profile == HEVC_PROFILE_IDC_MAIN
+                || p_fmt->i_profile == HEVC_PROFILE_IDC_MAIN_10;
+        case VLC_CODEC_VP8:
+            return true;
+        case VLC_CODEC_VP9:
+            /* profiles 1 and 3 are not 4:2:0 */
+            return p_fmt->i_profile != 1 && p_fmt->i_profile != 3;
+        default:
+            return false;
+    }
 }
 
 bool sout_stream_sys_t::canDecodeAudio( sout_stream_t *p_stream,
@@ -965,7 +990,7 @@ bool sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
         {
             if (p_es->i_cat == VIDEO_ES && p_original_video == NULL)
             {
-                if (!canDecodeVideo( p_es->i_codec ))
+                if (!canDecodeVideo( p_es ))
                 {
                     msg_Dbg( p_stream, "can't remux video track %d codec %4.4s",
                              p_es->i_id, (const char*)&p_es->i_codec );
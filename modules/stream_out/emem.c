@@ -0,0 +1,119 @@
+/*****************************************************************************
+ * emem.c: elementary stream output to memory callbacks
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+
+static int  Open(vlc_object_t *);
+static void Close(vlc_object_t *);
+
+vlc_module_begin()
+    set_shortname(N_("Emem"))
+    set_description(N_("Elementary stream output to memory"))
+    set_capability("sout stream", 0)
+    add_shortcut("emem")
+    set_category(CAT_SOUT)
+    set_subcategory(SUBCAT_SOUT_STREAM)
+    set_callbacks(Open, Close)
+vlc_module_end()
+
+/* NOTE: the callback prototypes must match those of LibVLC */
+typedef struct
+{
+    void *opaque;
+    void *(*add)(void *opaque, const es_format_t *fmt);
+    void (*send)(void *opaque, void *id, block_t *block);
+    void (*del)(void *opaque, void *id);
+} sout_stream_sys_t;
+
+static void *Add(sout_stream_t *stream, const es_format_t *fmt)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    return sys->add(sys->opaque, fmt);
+}
+
+static void Del(sout_stream_t *stream, void *id)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    sys->del(sys->opaque, id);
+}
+
+static int Send(sout_stream_t *stream, void *id, block_t *block)
+{
+    sout_stream_sys_t *sys = stream->p_sys;
+
+    /* Hand the blocks over one by one, the application owns them */
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        block->p_next = NULL;
+        sys->send(sys->opaque, id, block);
+        block = next;
+    }
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+
+    free(stream->p_sys);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    sout_stream_t *stream = (sout_stream_t *)obj;
+    sout_stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->add = var_InheritAddress(obj, "emem-add");
+    sys->send = var_InheritAddress(obj, "emem-send");
+    sys->del = var_InheritAddress(obj, "emem-del");
+    sys->opaque = var_InheritAddress(obj, "emem-data");
+
+    if (sys->add == NULL || sys->send == NULL || sys->del == NULL)
+    {
+        msg_Err(stream, "missing callbacks");
+        free(sys);
+        return VLC_EGENERIC;
+    }
+
+    stream->p_sys = sys;
+    stream->pf_add = Add;
+    stream->pf_del = Del;
+    stream->pf_send = Send;
+    /* Run as fast as the application consumes the packets */
+    stream->pace_nocontrol = true;
+    return VLC_SUCCESS;
+}
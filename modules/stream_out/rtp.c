@@ -52,6 +52,10 @@
 
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef HAVE_SENDMMSG
+#   include <sys/socket.h>
+#   include <sys/uio.h>
+#endif
 #ifdef HAVE_ARPA_INET_H
 #   include <arpa/inet.h>
 #endif
@@ -1389,52 +1393,179 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
+#define RTP_BATCH_MAX 32
+
+struct rtp_batch
+{
+    block_t *pkts[RTP_BATCH_MAX];
+    unsigned count;
+    block_t *pending; /* first packet of the next batch */
+};
+
+static void RtpBatchRelease( struct rtp_batch *batch )
+{
+    for( unsigned i = 0; i < batch->count; i++ )
+        block_Release( batch->pkts[i] );
+    batch->count = 0;
+}
+
+static void RtpBatchCleanup( void *data )
+{
+    struct rtp_batch *batch = data;
+
+    RtpBatchRelease( batch );
+    if( batch->pending != NULL )
+        block_Release( batch->pending );
+}
+
+#ifdef HAVE_SRTP
+static void RtpBatchEncrypt( sout_stream_id_sys_t *id, struct rtp_batch *batch )
+{
+    unsigned count = 0;
+
+    for( unsigned i = 0; i < batch->count; i++ )
+    {
+        block_t *out = batch->pkts[i];
+        /* Usually fits in the block padding, without copying */
+        size_t len = out->i_buffer;
+        out = block_Realloc( out, 0, len + 10 );
+        if( unlikely(out == NULL) )
+            continue;
+        out->i_buffer = len;
+
+        int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+        if( val )
+        {
+            msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                     vlc_strerror_c(val) );
+            block_Release( out );
+            continue;
+        }
+        out->i_buffer = len;
+        batch->pkts[count++] = out;
+    }
+    batch->count = count;
+}
+#endif
+
+/* Handles a failed send, returns false if the socket is broken */
+static bool RtpSendError( int fd, const block_t *out )
 {
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+    if( net_errno == EAGAIN || net_errno == EWOULDBLOCK
+     || net_errno == ENOBUFS || net_errno == ENOMEM )
+        return true;
+
+    int type;
+    getsockopt( fd, SOL_SOCKET, SO_TYPE, &type, &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        return false;
+
+    /* ICMP soft error: ignore and retry */
+    send( fd, out->p_buffer, out->i_buffer, 0 );
+    return true;
+}
+
+/* Sends a batch to one sink, returns false if the socket is broken */
+static bool RtpSinkSend( int fd, const struct rtp_batch *batch )
+{
+#ifdef HAVE_SENDMMSG
+    struct iovec iov[RTP_BATCH_MAX];
+    struct mmsghdr msgs[RTP_BATCH_MAX];
+
+    for( unsigned i = 0; i < batch->count; i++ )
+    {
+        iov[i].iov_base = batch->pkts[i]->p_buffer;
+        iov[i].iov_len = batch->pkts[i]->i_buffer;
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+        };
+    }
+
+    for( unsigned i = 0; i < batch->count; )
+    {
+        int val = sendmmsg( fd, msgs + i, batch->count - i, 0 );
+        if( val > 0 )
+        {
+            i += val;
+            continue;
+        }
+        if( !RtpSendError( fd, batch->pkts[i] ) )
+            return false;
+        i++; /* give up on this packet */
+    }
+#else
+    for( unsigned i = 0; i < batch->count; i++ )
+    {
+        const block_t *out = batch->pkts[i];
+
+        if( send( fd, out->p_buffer, out->i_buffer, 0 ) == -1
+         && !RtpSendError( fd, out ) )
+            return false;
+    }
+#endif
+    return true;
+}
+
+/*****************************************************************************
+ * ThreadSend: send the packets of an ES to all its sinks
+ *****************************************************************************
+ * Packets due at the same time, such as those of a video frame, or those
+ * already late, are encrypted and sent to each sink together.
+ *****************************************************************************/
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     vlc_tick_t i_caching = id->i_caching;
+    struct rtp_batch batch = { .count = 0, .pending = NULL };
+
+    vlc_cleanup_push( RtpBatchCleanup, &batch );
 
     for (;;)
     {
-        block_t *out = block_FifoGet( id->p_fifo );
-        block_cleanup_push (out);
+        block_t *out = batch.pending;
+
+        batch.pending = NULL;
+        if( out == NULL )
+            out = block_FifoGet( id->p_fifo );
+
+        vlc_tick_t i_deadline = out->i_dts + i_caching;
+        vlc_tick_t i_limit = __MAX( i_deadline, vlc_tick_now() );
+
+        vlc_fifo_Lock( id->p_fifo );
+        for (;;)
+        {
+            batch.pkts[batch.count++] = out;
+            if( batch.count >= RTP_BATCH_MAX )
+                break;
+            out = vlc_fifo_DequeueUnlocked( id->p_fifo );
+            if( out == NULL )
+                break;
+            if( out->i_dts + i_caching > i_limit )
+            {
+                batch.pending = out;
+                break;
+            }
+        }
+        vlc_fifo_Unlock( id->p_fifo );
 
 #ifdef HAVE_SRTP
         if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
+        {
             int canc = vlc_savecancel ();
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+            RtpBatchEncrypt( id, &batch );
             vlc_restorecancel (canc);
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                out = NULL;
-            }
-            else
-                out->i_buffer = len;
+            if( batch.count == 0 )
+                continue;
         }
-        if (out)
-            vlc_tick_wait (out->i_dts + i_caching);
-        vlc_cleanup_pop ();
-        if (out == NULL)
-            continue;
-#else
-        vlc_tick_wait (out->i_dts + i_caching);
-        vlc_cleanup_pop ();
 #endif
+        vlc_tick_wait( i_deadline );
 
-        ssize_t len = out->i_buffer;
         int canc = vlc_savecancel ();
 
         vlc_mutex_lock( &id->lock_sink );
@@ -1446,26 +1577,17 @@ static void* ThreadSend( void *data )
 #ifdef HAVE_SRTP
             if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < batch.count; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, batch.pkts[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( !RtpSinkSend( id->sinkv[i].rtp_fd, &batch ) )
+                /* Broken connection */
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
+        out = batch.pkts[batch.count - 1];
         id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        RtpBatchRelease( &batch );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
@@ -1474,7 +1596,9 @@ static void* ThreadSend( void *data )
         }
         vlc_restorecancel (canc);
     }
-    return NULL;
+
+    vlc_cleanup_pop ();
+    vlc_assert_unreachable ();
 }
 
 
@@ -48,7 +48,7 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
     {
         if( p_enc->p_encoder->fmt_in.i_cat == VIDEO_ES )
         {
-            block_ChainRelease( p_enc->p_buffers );
+            block_FifoRelease( p_enc->p_buffers );
             picture_fifo_Delete( p_enc->pp_pics );
             vlc_mutex_destroy( &p_enc->lock_out );
         }
@@ -97,8 +97,13 @@ transcode_encoder_t * transcode_encoder_new( vlc_object_t *p_obj,
     {
         case VIDEO_ES:
             p_enc->pp_pics = picture_fifo_New();
-            if( !p_enc->pp_pics )
+            p_enc->p_buffers = block_FifoNew();
+            if( !p_enc->pp_pics || !p_enc->p_buffers )
             {
+                if( p_enc->pp_pics )
+                    picture_fifo_Delete( p_enc->pp_pics );
+                if( p_enc->p_buffers )
+                    block_FifoRelease( p_enc->p_buffers );
                 es_format_Clean( &p_enc->p_encoder->fmt_in );
                 es_format_Clean( &p_enc->p_encoder->fmt_out );
                 vlc_object_delete(p_enc->p_encoder);
@@ -159,10 +164,11 @@ block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
 
 block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
 {
-    vlc_mutex_lock( &p_enc->lock_out );
-    block_t *p_data = p_enc->p_buffers;
-    p_enc->p_buffers = NULL;
-    vlc_mutex_unlock( &p_enc->lock_out );
+    /* Only the output queue lock is taken, so that the encoder thread is
+     * not held up while output blocks are collected. */
+    vlc_fifo_Lock( p_enc->p_buffers );
+    block_t *p_data = vlc_fifo_DequeueAllUnlocked( p_enc->p_buffers );
+    vlc_fifo_Unlock( p_enc->p_buffers );
     return p_data;
 }
 
@@ -44,6 +44,7 @@ typedef struct
                 unsigned int i_count;
                 int          i_priority;
                 uint32_t     pool_size;
+                bool         b_pipeline; /* encode on a separate thread */
             } threads;
         } video;
         struct
@@ -29,7 +29,7 @@ struct transcode_encoder_t
     vlc_cond_t      cond;
 
     /* output buffers */
-    block_t         *p_buffers;
+    block_fifo_t    *p_buffers;
     bool b_threaded;
 };
 
@@ -75,6 +75,12 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define RENDITIONS_TEXT N_("Video renditions")
+#define RENDITIONS_LONGTEXT N_( \
+    "Additional encodings of each video stream, sharing its decoding and " \
+    "filtering, as a comma-separated list of WIDTHxHEIGHT:BITRATE " \
+    "(eg: 960x540:1500,640x360:800). Each one is output as another " \
+    "stream and is encoded on its own thread." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -128,7 +134,12 @@
     "VIDEO." )
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
-    "between decoder/encoder threads when threads > 0" )
+    "between decoder/encoder threads" )
+#define PIPELINE_TEXT N_("Encode on a separate thread")
+#define PIPELINE_LONGTEXT N_( \
+    "Run the video encoder on its own thread, so that decoding and " \
+    "filtering the next pictures overlaps with encoding. This is always " \
+    "the case when the number of threads is set." )
 
 
 static const char *const ppsz_deinterlace_type[] =
@@ -175,6 +186,8 @@ vlc_module_begin ()
                  MAXWIDTH_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "maxheight", 0, MAXHEIGHT_TEXT,
                  MAXHEIGHT_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "renditions", NULL, RENDITIONS_TEXT,
+                RENDITIONS_LONGTEXT, true )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
 
@@ -213,6 +226,8 @@ vlc_module_begin ()
         change_integer_range( 0, 32 )
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT, true )
         change_integer_range( 1, 1000 )
+    add_bool( SOUT_CFG_PREFIX "pipeline", true, PIPELINE_TEXT,
+              PIPELINE_LONGTEXT, true )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT,
               true )
 
@@ -224,7 +239,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "renditions", "pipeline", NULL
 };
 
 /*****************************************************************************
@@ -325,6 +340,8 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
 
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->video.threads.b_pipeline = p_cfg->video.threads.i_count > 0 ||
+        var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
 
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_OUTPUT;
@@ -332,6 +349,39 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoRenditions( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "renditions" );
+    if( !psz_string )
+        return;
+
+    char *psz_save;
+    for( char *psz = strtok_r( psz_string, ",", &psz_save ); psz;
+         psz = strtok_r( NULL, ",", &psz_save ) )
+    {
+        transcode_rendition_config_t cfg;
+        if( sscanf( psz, "%ux%u:%u", &cfg.i_width, &cfg.i_height,
+                    &cfg.i_bitrate ) != 3 || !cfg.i_width || !cfg.i_height )
+        {
+            msg_Warn( p_stream, "invalid rendition `%s'", psz );
+            continue;
+        }
+        if( cfg.i_bitrate < 16000 )
+            cfg.i_bitrate *= 1000;
+
+        transcode_rendition_config_t *p_renditions =
+            realloc( p_sys->p_renditions,
+                     (p_sys->i_renditions + 1) * sizeof(*p_renditions) );
+        if( !p_renditions )
+            break;
+        p_renditions[p_sys->i_renditions++] = cfg;
+        p_sys->p_renditions = p_renditions;
+        msg_Dbg( p_stream, "video rendition %ux%u %ukb/s",
+                 cfg.i_width, cfg.i_height, cfg.i_bitrate / 1000 );
+    }
+    free( psz_string );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -424,6 +474,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoRenditions( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -488,6 +539,7 @@ static void Close( vlc_object_t * p_this )
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
+    free( p_sys->p_renditions );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
     sout_filters_config_clean( &p_sys->afilters_cfg );
@@ -1,4 +1,5 @@
 #include <vlc_picture_fifo.h>
+#include <vlc_picture_pool.h>
 #include <vlc_filter.h>
 #include <vlc_codec.h>
 #include "encoder/encoder.h"
@@ -41,6 +42,22 @@ void sout_filters_config_clean( sout_filters_config_t *p_cfg )
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
 
+/* Extra video encoding of the same pictures, at another size and bitrate */
+typedef struct
+{
+    unsigned int i_width;
+    unsigned int i_height;
+    unsigned int i_bitrate;
+} transcode_rendition_config_t;
+
+typedef struct
+{
+    transcode_encoder_config_t cfg; /* shares the strings of the main one */
+    transcode_encoder_t *encoder;
+    filter_chain_t *p_conv; /**< Scaling from the main encoder input */
+    void *downstream_id;
+} transcode_rendition_t;
+
 typedef struct
 {
     bool                  b_soverlay;
@@ -52,6 +69,8 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    transcode_rendition_config_t *p_renditions;
+    size_t i_renditions;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -129,6 +148,9 @@ struct sout_stream_id_sys_t
              vlc_blender_t   *p_spu_blender;
              spu_t           *p_spu;
              video_format_t  fmt_input_video;
+             picture_pool_t  *p_dec_pool; /**< Recycled decoder pictures */
+             transcode_rendition_t *p_renditions;
+             size_t          i_renditions;
          };
          struct
          {
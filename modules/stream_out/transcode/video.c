@@ -40,6 +40,9 @@
 
 #include <math.h>
 
+/* Decoded pictures recycled instead of allocated for each frame */
+#define TRANSCODE_DEC_POOL_SIZE 8
+
 static const video_format_t* filtered_video_format( sout_stream_id_sys_t *id,
                                                   picture_t *p_pic )
 {
@@ -113,6 +116,43 @@ static int video_update_format_decoder( decoder_t *p_dec )
     return chain_works;
 }
 
+static picture_t *video_new_buffer_decoder( decoder_t *p_dec )
+{
+    sout_stream_id_sys_t *id = dec_get_owner( p_dec )->id;
+    picture_t *p_pic = NULL;
+
+    p_dec->fmt_out.video.i_chroma = p_dec->fmt_out.i_codec;
+
+    /* The decoder may ask buffers from several threads */
+    vlc_mutex_lock( &id->fifo.lock );
+    if( id->p_dec_pool != NULL )
+    {
+        picture_t *p_ref = picture_pool_Get( id->p_dec_pool );
+        if( p_ref == NULL ||
+            video_format_IsSimilar( &p_ref->format, &p_dec->fmt_out.video ) )
+            p_pic = p_ref;
+        else
+        {   /* The pictures of the old format are released once unused */
+            picture_Release( p_ref );
+            picture_pool_Release( id->p_dec_pool );
+            id->p_dec_pool = NULL;
+        }
+    }
+    if( id->p_dec_pool == NULL )
+    {
+        id->p_dec_pool = picture_pool_NewFromFormat( &p_dec->fmt_out.video,
+                                                     TRANSCODE_DEC_POOL_SIZE );
+        if( id->p_dec_pool != NULL )
+            p_pic = picture_pool_Get( id->p_dec_pool );
+    }
+    vlc_mutex_unlock( &id->fifo.lock );
+
+    /* Pool exhausted, held by the decoder references and the encoder */
+    if( p_pic == NULL )
+        p_pic = picture_NewFromFormat( &p_dec->fmt_out.video );
+    return p_pic;
+}
+
 static picture_t *video_new_buffer_encoder( transcode_encoder_t *p_enc )
 {
     return picture_NewFromFormat( &transcode_encoder_format_in( p_enc )->video );
@@ -147,6 +187,199 @@ static picture_t *transcode_dequeue_all_pics( sout_stream_id_sys_t *id )
     return p_pics;
 }
 
+static const struct filter_video_callbacks transcode_filter_video_cbs =
+{
+    transcode_video_filter_buffer_new,
+};
+
+static void tag_last_block_with_flag( block_t **out, int i_flag )
+{
+    block_t *p_last = *out;
+    if( p_last )
+    {
+        while( p_last->p_next )
+            p_last = p_last->p_next;
+        p_last->i_flags |= i_flag;
+    }
+}
+
+/* Prepares the encoders of the renditions, they are opened with the main one */
+static void transcode_video_renditions_init( sout_stream_t *p_stream,
+                                             sout_stream_id_sys_t *id )
+{
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    id->p_renditions = NULL;
+    id->i_renditions = 0;
+    if( p_sys->i_renditions == 0 )
+        return;
+
+    id->p_renditions = calloc( p_sys->i_renditions, sizeof(*id->p_renditions) );
+    if( !id->p_renditions )
+        return;
+
+    for( size_t i = 0; i < p_sys->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[id->i_renditions];
+
+        r->cfg = *id->p_enccfg;
+        r->cfg.video.i_width = p_sys->p_renditions[i].i_width;
+        r->cfg.video.i_height = p_sys->p_renditions[i].i_height;
+        r->cfg.video.i_bitrate = p_sys->p_renditions[i].i_bitrate;
+        r->cfg.video.f_scale = 0;
+        r->cfg.video.i_maxwidth = r->cfg.video.i_maxheight = 0;
+        /* Each rendition is encoded on its own thread */
+        r->cfg.video.threads.b_pipeline = true;
+
+        es_format_t fmt_in;
+        es_format_Init( &fmt_in, VIDEO_ES, 0 );
+        if( transcode_encoder_test( VLC_OBJECT(p_stream), &r->cfg,
+                                    &id->p_decoder->fmt_in,
+                                    id->p_decoder->fmt_out.i_codec,
+                                    &fmt_in ) == VLC_SUCCESS )
+            r->encoder = transcode_encoder_new( VLC_OBJECT(p_stream), &fmt_in );
+        if( r->encoder )
+        {
+            transcode_encoder_update_format_in( r->encoder, &fmt_in );
+            id->i_renditions++;
+        }
+        else
+            msg_Warn( p_stream, "cannot encode the %ux%u rendition",
+                      r->cfg.video.i_width, r->cfg.video.i_height );
+        es_format_Clean( &fmt_in );
+    }
+}
+
+/* Opens the renditions missing an encoder or a scaler */
+static void transcode_video_renditions_start( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id )
+{
+    const es_format_t *p_src = transcode_encoder_format_in( id->encoder );
+    filter_owner_t owner = {
+        .video = &transcode_filter_video_cbs,
+        .sys = id,
+    };
+
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+
+        if( !transcode_encoder_opened( r->encoder ) )
+        {
+            transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                               &id->p_decoder->fmt_out.video,
+                                               &r->cfg, &p_src->video,
+                                               r->encoder );
+            if( transcode_encoder_open( r->encoder, &r->cfg ) != VLC_SUCCESS )
+            {
+                msg_Err( p_stream, "cannot open the %ux%u rendition encoder",
+                         r->cfg.video.i_width, r->cfg.video.i_height );
+                continue;
+            }
+            transcode_remove_filters( &r->p_conv );
+        }
+
+        if( !r->downstream_id )
+            r->downstream_id =
+                id->pf_transcode_downstream_add( p_stream,
+                                                 &id->p_decoder->fmt_in,
+                                                 transcode_encoder_format_out( r->encoder ) );
+
+        const es_format_t *p_dst = transcode_encoder_format_in( r->encoder );
+        if( r->p_conv || video_format_IsSimilar( &p_src->video, &p_dst->video ) )
+            continue;
+
+        r->p_conv = filter_chain_NewVideo( p_stream, false, &owner );
+        if( r->p_conv )
+        {
+            filter_chain_Reset( r->p_conv, p_src, p_dst );
+            if( filter_chain_AppendConverter( r->p_conv, p_src, p_dst ) != VLC_SUCCESS )
+            {
+                msg_Err( p_stream, "cannot scale the %ux%u rendition",
+                         r->cfg.video.i_width, r->cfg.video.i_height );
+                transcode_remove_filters( &r->p_conv );
+                transcode_encoder_close( r->encoder );
+            }
+        }
+    }
+}
+
+static void transcode_video_renditions_send( sout_stream_t *p_stream,
+                                             transcode_rendition_t *r,
+                                             block_t *p_blocks )
+{
+    if( r->cfg.video.threads.b_pipeline )
+        block_ChainAppend( &p_blocks, transcode_encoder_get_output_async( r->encoder ) );
+    if( !p_blocks )
+        return;
+    if( r->downstream_id )
+        sout_StreamIdSend( p_stream->p_next, r->downstream_id, p_blocks );
+    else
+        block_ChainRelease( p_blocks );
+}
+
+/* Encodes a picture of the main encoder format for every rendition */
+static void transcode_video_renditions_encode( sout_stream_t *p_stream,
+                                               sout_stream_id_sys_t *id,
+                                               picture_t *p_pic )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        if( !transcode_encoder_opened( r->encoder ) )
+            continue;
+
+        /* The picture is shared with the main encoder when not scaled */
+        picture_t *p_in = picture_Hold( p_pic );
+        if( r->p_conv )
+            p_in = filter_chain_VideoFilter( r->p_conv, p_in );
+        if( !p_in )
+            continue;
+
+        block_t *p_blocks = transcode_encoder_encode( r->encoder, p_in );
+        picture_Release( p_in );
+        transcode_video_renditions_send( p_stream, r, p_blocks );
+    }
+}
+
+static void transcode_video_renditions_drain( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id,
+                                              bool b_close )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+        block_t *p_blocks = NULL;
+
+        if( transcode_encoder_drain( r->encoder, &p_blocks ) != VLC_SUCCESS )
+            continue;
+        if( b_close )
+        {
+            tag_last_block_with_flag( &p_blocks, BLOCK_FLAG_END_OF_SEQUENCE );
+            transcode_encoder_close( r->encoder );
+        }
+        transcode_video_renditions_send( p_stream, r, p_blocks );
+    }
+}
+
+static void transcode_video_renditions_clean( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        transcode_rendition_t *r = &id->p_renditions[i];
+
+        transcode_encoder_close( r->encoder );
+        transcode_encoder_delete( r->encoder );
+        transcode_remove_filters( &r->p_conv );
+        if( r->downstream_id )
+            sout_StreamIdDel( p_stream->p_next, r->downstream_id );
+    }
+    free( id->p_renditions );
+    id->p_renditions = NULL;
+    id->i_renditions = 0;
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -158,6 +391,7 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     id->fifo.pic.last = &id->fifo.pic.first;
     id->b_transcode = true;
     es_format_Init( &id->decoder_out, VIDEO_ES, 0 );
+    id->p_dec_pool = NULL;
 
     /* Open decoder
      */
@@ -167,6 +401,7 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     {
         .video = {
             .format_update = video_update_format_decoder,
+            .buffer_new = video_new_buffer_decoder,
             .queue = decoder_queue_video,
         },
     };
@@ -211,6 +446,8 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     {
         module_unneed( id->p_decoder, id->p_decoder->p_module );
         id->p_decoder->p_module = NULL;
+        if( id->p_dec_pool )
+            picture_pool_Release( id->p_dec_pool );
         video_format_Clean( &id->fmt_input_video );
         es_format_Clean( &id->decoder_out );
         es_format_Clean( &encoder_tested_fmt_in );
@@ -222,6 +459,8 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     {
         module_unneed( id->p_decoder, id->p_decoder->p_module );
         id->p_decoder->p_module = NULL;
+        if( id->p_dec_pool )
+            picture_pool_Release( id->p_dec_pool );
         video_format_Clean( &id->fmt_input_video );
         es_format_Clean( &encoder_tested_fmt_in );
         es_format_Clean( &id->decoder_out );
@@ -232,14 +471,11 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
 
     es_format_Clean( &encoder_tested_fmt_in );
 
+    transcode_video_renditions_init( p_stream, id );
+
     return VLC_SUCCESS;
 }
 
-static const struct filter_video_callbacks transcode_filter_video_cbs =
-{
-    transcode_video_filter_buffer_new,
-};
-
 /* Take care of the scaling and chroma conversions. */
 static int transcode_video_set_conversions( sout_stream_t *p_stream,
                                             sout_stream_id_sys_t *id,
@@ -374,14 +610,16 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
 void transcode_video_clean( sout_stream_t *p_stream,
                                    sout_stream_id_sys_t *id )
 {
-    VLC_UNUSED(p_stream);
 
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
+    transcode_video_renditions_clean( p_stream, id );
 
     video_format_Clean( &id->fmt_input_video );
     es_format_Clean( &id->decoder_out );
+    if( id->p_dec_pool )
+        picture_pool_Release( id->p_dec_pool );
 
     /* Close filters */
     transcode_remove_filters( &id->p_f_chain );
@@ -475,17 +713,6 @@ static picture_t * RenderSubpictures( sout_stream_t *p_stream, sout_stream_id_sy
     return p_pic;
 }
 
-static void tag_last_block_with_flag( block_t **out, int i_flag )
-{
-    block_t *p_last = *out;
-    if( p_last )
-    {
-        while( p_last->p_next )
-            p_last = p_last->p_next;
-        p_last->i_flags |= i_flag;
-    }
-}
-
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -539,6 +766,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                 transcode_remove_filters( &id->p_conv_static );
                 transcode_remove_filters( &id->p_uf_chain );
                 transcode_remove_filters( &id->p_final_conv_static );
+                for( size_t i = 0; i < id->i_renditions; i++ )
+                    transcode_remove_filters( &id->p_renditions[i].p_conv );
                 if( id->p_spu_blender )
                     filter_DeleteBlend( id->p_spu_blender );
                 id->p_spu_blender = NULL;
@@ -588,6 +817,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
+
+            transcode_video_renditions_start( p_stream, id );
         }
 
         /* Run the filter and output chains; first with the picture,
@@ -630,6 +861,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
                 if( p_in )
                 {
+                    transcode_video_renditions_encode( p_stream, id, p_in );
+
                     block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
                     if( p_encoded )
                         block_ChainAppend( out, p_encoded );
@@ -644,6 +877,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
             transcode_encoder_close( id->encoder );
+            transcode_video_renditions_drain( p_stream, id, true );
             if( b_eos )
                 tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
         }
@@ -655,7 +889,7 @@ error:
         id->b_error = true;
     } while( p_pics );
 
-    if( id->p_enccfg->video.threads.i_count >= 1 )
+    if( id->p_enccfg->video.threads.b_pipeline )
     {
         /* Pick up any return data the encoder thread wants to output. */
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
@@ -669,6 +903,7 @@ error:
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
+        transcode_video_renditions_drain( p_stream, id, false );
     }
 
     if( b_eos )
@@ -69,6 +69,7 @@
 #include "platform_fonts.h"
 #include "freetype.h"
 #include "text_layout.h"
+#include "glyph_cache.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -114,6 +115,10 @@ static void Destroy( vlc_object_t * );
 #define YUVP_LONGTEXT N_("This renders the font using \"paletized YUV\". " \
   "This option is only needed if you want to encode into DVB subtitles" )
 
+#define CACHE_SIZE_TEXT N_("Glyph cache size (kB)")
+#define CACHE_SIZE_LONGTEXT N_("Memory used to keep shaped text runs and " \
+  "loaded glyphs across renderings of the same text. 0 disables the cache." )
+
 static const int pi_color_values[] = {
   0x00000000, 0x00808080, 0x00C0C0C0, 0x00FFFFFF, 0x00800000,
   0x00FF0000, 0x00FF00FF, 0x00FFFF00, 0x00808000, 0x00008000, 0x00008080,
@@ -211,6 +216,9 @@ vlc_module_begin ()
     add_bool( "freetype-yuvp", false, YUVP_TEXT,
               YUVP_LONGTEXT, true )
 
+    add_integer_with_range( "freetype-cache-size", 1024, 0, 65536,
+                            CACHE_SIZE_TEXT, CACHE_SIZE_LONGTEXT, true )
+
 #ifdef HAVE_FRIBIDI
     add_integer_with_range( "freetype-text-direction", 0, 0, 2, TEXT_DIRECTION_TEXT,
                             TEXT_DIRECTION_LONGTEXT, false )
@@ -1461,6 +1469,10 @@ static int Create( vlc_object_t *p_this )
     p_sys->f_shadow_vector_x   = f_shadow_distance * cosf((float)(2. * M_PI) * f_shadow_angle / 360);
     p_sys->f_shadow_vector_y   = f_shadow_distance * sinf((float)(2. * M_PI) * f_shadow_angle / 360);
 
+    const int64_t i_cache_size = var_InheritInteger( p_filter, "freetype-cache-size" );
+    if( i_cache_size > 0 )
+        p_sys->p_glyph_cache = GlyphCache_New( i_cache_size * 1024 );
+
     if( LoadFontsFromAttachments( p_filter ) == VLC_ENOMEM )
         goto error;
 
@@ -1557,6 +1569,16 @@ static void Destroy( vlc_object_t *p_this )
     text_style_Delete( p_sys->p_default_style );
     text_style_Delete( p_sys->p_forced_style );
 
+    /* Glyph cache, referencing faces */
+    if( p_sys->p_glyph_cache )
+    {
+        uint64_t i_hits, i_misses;
+        GlyphCache_GetStats( p_sys->p_glyph_cache, &i_hits, &i_misses );
+        msg_Dbg( p_filter, "glyph cache: %"PRIu64" hits, %"PRIu64" misses",
+                 i_hits, i_misses );
+        GlyphCache_Delete( p_sys->p_glyph_cache );
+    }
+
     /* Fonts dicts */
     vlc_dictionary_clear( &p_sys->fallback_map, FreeFamilies, p_filter );
     vlc_dictionary_clear( &p_sys->face_map, FreeFace, p_filter );
@@ -0,0 +1,367 @@
+/*****************************************************************************
+ * glyph_cache.c : Glyph and shaped run cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+
+#include "freetype.h"
+#include "glyph_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* The cache is only used by the renderer, which is not reentrant:
+ * no locking is needed. */
+
+#define GLYPH_CACHE_BUCKETS 1024
+
+typedef struct
+{
+    FT_Face      p_face;
+    unsigned int i_glyph_index;
+    int          i_style_flags;
+    int          i_outline_radius;
+} glyph_key_t;
+
+typedef struct
+{
+    FT_Face      p_face;
+    int          i_direction;
+    unsigned int i_script;
+    size_t       i_text;
+    /* followed by the code points */
+} run_key_t;
+
+typedef struct glyph_cache_entry_t glyph_cache_entry_t;
+struct glyph_cache_entry_t
+{
+    struct vlc_list      node;   /**< LRU order, most recent first */
+    glyph_cache_entry_t *p_next; /**< hash bucket chain */
+    uint32_t             i_hash;
+    size_t               i_size; /**< accounted memory */
+    bool                 b_run;
+
+    union
+    {
+        struct
+        {
+            FT_Glyph  p_glyph;
+            FT_Glyph  p_outline;
+            FT_Vector advance;
+        } glyph;
+        struct
+        {
+            shaped_glyph_t *p_glyphs;
+            unsigned int    i_count;
+        } run;
+    };
+
+    size_t               i_key;
+    uint8_t              key[];
+};
+
+struct glyph_cache_t
+{
+    struct vlc_list      lru;
+    glyph_cache_entry_t *buckets[GLYPH_CACHE_BUCKETS];
+    size_t               i_size;
+    size_t               i_max_size;
+    uint64_t             i_hits;
+    uint64_t             i_misses;
+};
+
+static uint32_t Hash( const uint8_t *p_key, size_t i_key )
+{
+    /* FNV-1a */
+    uint32_t i_hash = 2166136261u;
+    for( size_t i = 0; i < i_key; i++ )
+    {
+        i_hash ^= p_key[i];
+        i_hash *= 16777619u;
+    }
+    return i_hash;
+}
+
+static size_t GlyphSize( FT_Glyph p_glyph )
+{
+    if( !p_glyph )
+        return 0;
+
+    switch( p_glyph->format )
+    {
+        case FT_GLYPH_FORMAT_OUTLINE:
+        {
+            const FT_Outline *p_outline = &((FT_OutlineGlyph) p_glyph)->outline;
+            return sizeof( FT_OutlineGlyphRec )
+                 + p_outline->n_points * ( sizeof( FT_Vector ) + 1 )
+                 + p_outline->n_contours * sizeof( short );
+        }
+        case FT_GLYPH_FORMAT_BITMAP:
+        {
+            const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph) p_glyph)->bitmap;
+            return sizeof( FT_BitmapGlyphRec )
+                 + (size_t) abs( p_bitmap->pitch ) * p_bitmap->rows;
+        }
+        default:
+            return sizeof( FT_GlyphRec );
+    }
+}
+
+static void EntryDelete( glyph_cache_entry_t *p_entry )
+{
+    if( p_entry->b_run )
+        free( p_entry->run.p_glyphs );
+    else
+    {
+        FT_Done_Glyph( p_entry->glyph.p_glyph );
+        if( p_entry->glyph.p_outline )
+            FT_Done_Glyph( p_entry->glyph.p_outline );
+    }
+    free( p_entry );
+}
+
+static void Remove( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    glyph_cache_entry_t **pp =
+        &p_cache->buckets[ p_entry->i_hash % GLYPH_CACHE_BUCKETS ];
+    while( *pp != p_entry )
+        pp = &(*pp)->p_next;
+    *pp = p_entry->p_next;
+
+    vlc_list_remove( &p_entry->node );
+    p_cache->i_size -= p_entry->i_size;
+    EntryDelete( p_entry );
+}
+
+static glyph_cache_entry_t *Lookup( glyph_cache_t *p_cache,
+                                    const uint8_t *p_key, size_t i_key )
+{
+    const uint32_t i_hash = Hash( p_key, i_key );
+    glyph_cache_entry_t *p_entry = p_cache->buckets[ i_hash % GLYPH_CACHE_BUCKETS ];
+    for( ; p_entry; p_entry = p_entry->p_next )
+    {
+        if( p_entry->i_hash == i_hash && p_entry->i_key == i_key
+         && !memcmp( p_entry->key, p_key, i_key ) )
+        {
+            vlc_list_remove( &p_entry->node );
+            vlc_list_prepend( &p_entry->node, &p_cache->lru );
+            p_cache->i_hits++;
+            return p_entry;
+        }
+    }
+    p_cache->i_misses++;
+    return NULL;
+}
+
+static glyph_cache_entry_t *EntryNew( const uint8_t *p_key, size_t i_key )
+{
+    glyph_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) + i_key );
+    if( !p_entry )
+        return NULL;
+    p_entry->i_hash = Hash( p_key, i_key );
+    p_entry->i_key = i_key;
+    memcpy( p_entry->key, p_key, i_key );
+    return p_entry;
+}
+
+static void Insert( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    p_entry->i_size += sizeof( *p_entry ) + p_entry->i_key;
+    if( p_entry->i_size > p_cache->i_max_size )
+    {
+        EntryDelete( p_entry );
+        return;
+    }
+
+    /* Evict the least recently used entries */
+    while( p_cache->i_size + p_entry->i_size > p_cache->i_max_size )
+        Remove( p_cache, vlc_list_last_entry_or_null( &p_cache->lru,
+                                                      glyph_cache_entry_t,
+                                                      node ) );
+
+    glyph_cache_entry_t **pp_bucket =
+        &p_cache->buckets[ p_entry->i_hash % GLYPH_CACHE_BUCKETS ];
+    p_entry->p_next = *pp_bucket;
+    *pp_bucket = p_entry;
+    vlc_list_prepend( &p_entry->node, &p_cache->lru );
+    p_cache->i_size += p_entry->i_size;
+}
+
+glyph_cache_t *GlyphCache_New( size_t i_max_size )
+{
+    glyph_cache_t *p_cache = calloc( 1, sizeof( *p_cache ) );
+    if( !p_cache )
+        return NULL;
+    vlc_list_init( &p_cache->lru );
+    p_cache->i_max_size = i_max_size;
+    return p_cache;
+}
+
+void GlyphCache_Delete( glyph_cache_t *p_cache )
+{
+    glyph_cache_entry_t *p_entry;
+    vlc_list_foreach( p_entry, &p_cache->lru, node )
+        EntryDelete( p_entry );
+    free( p_cache );
+}
+
+static void GlyphKey( glyph_key_t *p_key, FT_Face p_face,
+                      unsigned int i_glyph_index, int i_style_flags,
+                      int i_outline_radius )
+{
+    memset( p_key, 0, sizeof( *p_key ) );
+    p_key->p_face = p_face;
+    p_key->i_glyph_index = i_glyph_index;
+    p_key->i_style_flags = i_style_flags;
+    p_key->i_outline_radius = i_outline_radius;
+}
+
+bool GlyphCache_GetGlyph( glyph_cache_t *p_cache, FT_Face p_face,
+                          unsigned int i_glyph_index, int i_style_flags,
+                          int i_outline_radius, FT_Glyph *pp_glyph,
+                          FT_Glyph *pp_outline, FT_Vector *p_advance )
+{
+    glyph_key_t key;
+    GlyphKey( &key, p_face, i_glyph_index, i_style_flags, i_outline_radius );
+
+    glyph_cache_entry_t *p_entry =
+        Lookup( p_cache, (const uint8_t *) &key, sizeof( key ) );
+    if( !p_entry )
+        return false;
+
+    if( FT_Glyph_Copy( p_entry->glyph.p_glyph, pp_glyph ) )
+        return false;
+    *pp_outline = NULL;
+    if( p_entry->glyph.p_outline
+     && FT_Glyph_Copy( p_entry->glyph.p_outline, pp_outline ) )
+        *pp_outline = NULL;
+    *p_advance = p_entry->glyph.advance;
+    return true;
+}
+
+void GlyphCache_PutGlyph( glyph_cache_t *p_cache, FT_Face p_face,
+                          unsigned int i_glyph_index, int i_style_flags,
+                          int i_outline_radius, FT_Glyph p_glyph,
+                          FT_Glyph p_outline, const FT_Vector *p_advance )
+{
+    glyph_key_t key;
+    GlyphKey( &key, p_face, i_glyph_index, i_style_flags, i_outline_radius );
+
+    glyph_cache_entry_t *p_entry = EntryNew( (const uint8_t *) &key, sizeof( key ) );
+    if( !p_entry )
+        return;
+    p_entry->b_run = false;
+    p_entry->glyph.p_outline = NULL;
+    if( FT_Glyph_Copy( p_glyph, &p_entry->glyph.p_glyph ) )
+    {
+        free( p_entry );
+        return;
+    }
+    if( p_outline && FT_Glyph_Copy( p_outline, &p_entry->glyph.p_outline ) )
+        p_entry->glyph.p_outline = NULL;
+    p_entry->glyph.advance = *p_advance;
+    p_entry->i_size = GlyphSize( p_entry->glyph.p_glyph )
+                    + GlyphSize( p_entry->glyph.p_outline );
+
+    Insert( p_cache, p_entry );
+}
+
+static uint8_t *RunKey( size_t *pi_key, FT_Face p_face, int i_direction,
+                        unsigned int i_script,
+                        const uni_char_t *p_text, size_t i_text )
+{
+    const size_t i_key = sizeof( run_key_t ) + i_text * sizeof( *p_text );
+    uint8_t *p_key = malloc( i_key );
+    if( !p_key )
+        return NULL;
+
+    run_key_t header;
+    memset( &header, 0, sizeof( header ) );
+    header.p_face = p_face;
+    header.i_direction = i_direction;
+    header.i_script = i_script;
+    header.i_text = i_text;
+    memcpy( p_key, &header, sizeof( header ) );
+    memcpy( p_key + sizeof( header ), p_text, i_text * sizeof( *p_text ) );
+
+    *pi_key = i_key;
+    return p_key;
+}
+
+const shaped_glyph_t *GlyphCache_GetRun( glyph_cache_t *p_cache, FT_Face p_face,
+                                         int i_direction, unsigned int i_script,
+                                         const uni_char_t *p_text, size_t i_text,
+                                         unsigned int *pi_count )
+{
+    size_t i_key;
+    uint8_t *p_key = RunKey( &i_key, p_face, i_direction, i_script,
+                             p_text, i_text );
+    if( !p_key )
+        return NULL;
+
+    glyph_cache_entry_t *p_entry = Lookup( p_cache, p_key, i_key );
+    free( p_key );
+    if( !p_entry )
+        return NULL;
+
+    *pi_count = p_entry->run.i_count;
+    return p_entry->run.p_glyphs;
+}
+
+void GlyphCache_PutRun( glyph_cache_t *p_cache, FT_Face p_face,
+                        int i_direction, unsigned int i_script,
+                        const uni_char_t *p_text, size_t i_text,
+                        const shaped_glyph_t *p_glyphs, unsigned int i_count )
+{
+    size_t i_key;
+    uint8_t *p_key = RunKey( &i_key, p_face, i_direction, i_script,
+                             p_text, i_text );
+    if( !p_key )
+        return;
+
+    glyph_cache_entry_t *p_entry = EntryNew( p_key, i_key );
+    free( p_key );
+    if( !p_entry )
+        return;
+
+    p_entry->b_run = true;
+    p_entry->run.p_glyphs = vlc_alloc( i_count, sizeof( *p_glyphs ) );
+    if( !p_entry->run.p_glyphs )
+    {
+        free( p_entry );
+        return;
+    }
+    memcpy( p_entry->run.p_glyphs, p_glyphs, i_count * sizeof( *p_glyphs ) );
+    p_entry->run.i_count = i_count;
+    p_entry->i_size = i_count * sizeof( *p_glyphs );
+
+    Insert( p_cache, p_entry );
+}
+
+void GlyphCache_GetStats( const glyph_cache_t *p_cache,
+                          uint64_t *pi_hits, uint64_t *pi_misses )
+{
+    *pi_hits = p_cache->i_hits;
+    *pi_misses = p_cache->i_misses;
+}
@@ -0,0 +1,109 @@
+/*****************************************************************************
+ * glyph_cache.h : Glyph and shaped run cache
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FREETYPE_GLYPH_CACHE_H
+#define VLC_FREETYPE_GLYPH_CACHE_H
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Least recently used cache of loaded glyphs and shaped runs
+ *
+ * Glyphs are cached once loaded and styled (faux bold/italic, stroked
+ * outline), before they get rasterized at their pen position. Shaped runs
+ * hold the HarfBuzz output for a run of code points. Faces are sized, so
+ * the face is enough to tell the font size apart.
+ */
+
+typedef struct glyph_cache_t glyph_cache_t;
+
+/**
+ * Shaped glyph, mirroring the HarfBuzz info and position. Offsets and
+ * advances are 26.6 values
+ */
+typedef struct
+{
+    unsigned int i_glyph_index;
+    unsigned int i_cluster;
+    int          i_x_offset;
+    int          i_y_offset;
+    int          i_x_advance;
+    int          i_y_advance;
+} shaped_glyph_t;
+
+/**
+ * Creates a cache
+ *
+ * \param i_max_size memory cap in bytes
+ */
+glyph_cache_t *GlyphCache_New( size_t i_max_size );
+void GlyphCache_Delete( glyph_cache_t *p_cache );
+
+/**
+ * Looks up a glyph
+ *
+ * On success, \p pp_glyph and \p pp_outline receive copies owned by
+ * the caller (\p pp_outline may be set to NULL).
+ *
+ * \param i_style_flags STYLE_BOLD, STYLE_ITALIC and STYLE_OUTLINE flags
+ *                      applied to the glyph
+ * \param i_outline_radius stroker radius (26.6) for outlined glyphs
+ */
+bool GlyphCache_GetGlyph( glyph_cache_t *p_cache, FT_Face p_face,
+                          unsigned int i_glyph_index, int i_style_flags,
+                          int i_outline_radius, FT_Glyph *pp_glyph,
+                          FT_Glyph *pp_outline, FT_Vector *p_advance );
+
+/**
+ * Stores copies of a glyph and its outline (may be NULL)
+ */
+void GlyphCache_PutGlyph( glyph_cache_t *p_cache, FT_Face p_face,
+                          unsigned int i_glyph_index, int i_style_flags,
+                          int i_outline_radius, FT_Glyph p_glyph,
+                          FT_Glyph p_outline, const FT_Vector *p_advance );
+
+/**
+ * Looks up a shaped run
+ *
+ * \return cached glyphs, valid until the next call storing into the
+ *         cache, or NULL
+ */
+const shaped_glyph_t *GlyphCache_GetRun( glyph_cache_t *p_cache, FT_Face p_face,
+                                         int i_direction, unsigned int i_script,
+                                         const uni_char_t *p_text, size_t i_text,
+                                         unsigned int *pi_count );
+
+/**
+ * Stores a copy of a shaped run
+ */
+void GlyphCache_PutRun( glyph_cache_t *p_cache, FT_Face p_face,
+                        int i_direction, unsigned int i_script,
+                        const uni_char_t *p_text, size_t i_text,
+                        const shaped_glyph_t *p_glyphs, unsigned int i_count );
+
+/**
+ * Counts of cache hits and misses since creation
+ */
+void GlyphCache_GetStats( const glyph_cache_t *p_cache,
+                          uint64_t *pi_hits, uint64_t *pi_misses );
+
+/** @} */
+
+#endif
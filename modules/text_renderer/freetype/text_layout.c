@@ -64,6 +64,7 @@
 #include "freetype.h"
 #include "text_layout.h"
 #include "platform_fonts.h"
+#include "glyph_cache.h"
 
 #include <stdlib.h>
 
@@ -717,6 +718,35 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
 }
 
 #ifdef HAVE_HARFBUZZ
+static void CacheShapedRun( glyph_cache_t *p_cache, FT_Face p_face,
+                            const run_desc_t *p_run,
+                            const uni_char_t *p_text, int i_text )
+{
+    unsigned int i_count;
+    const hb_glyph_info_t *p_infos =
+        hb_buffer_get_glyph_infos( p_run->p_buffer, &i_count );
+    const hb_glyph_position_t *p_positions =
+        hb_buffer_get_glyph_positions( p_run->p_buffer, &i_count );
+    if( i_count == 0 )
+        return;
+
+    shaped_glyph_t *p_glyphs = vlc_alloc( i_count, sizeof( *p_glyphs ) );
+    if( !p_glyphs )
+        return;
+    for( unsigned int i = 0; i < i_count; ++i )
+    {
+        p_glyphs[ i ].i_glyph_index = p_infos[ i ].codepoint;
+        p_glyphs[ i ].i_cluster = p_infos[ i ].cluster;
+        p_glyphs[ i ].i_x_offset = p_positions[ i ].x_offset;
+        p_glyphs[ i ].i_y_offset = p_positions[ i ].y_offset;
+        p_glyphs[ i ].i_x_advance = p_positions[ i ].x_advance;
+        p_glyphs[ i ].i_y_advance = p_positions[ i ].y_advance;
+    }
+    GlyphCache_PutRun( p_cache, p_face, p_run->direction, p_run->script,
+                       p_text, i_text, p_glyphs, i_count );
+    free( p_glyphs );
+}
+
 /**
  * Shape an itemized paragraph using HarfBuzz.
  * This is where the glyphs of complex scripts get their positions
@@ -770,14 +800,6 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
         else
             p_face = p_run->p_face;
 
-        p_run->p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_run->p_hb_font )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
-            goto error;
-        }
-
         p_run->p_buffer = hb_buffer_create();
         if( !p_run->p_buffer )
         {
@@ -788,18 +810,56 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 
         hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
         hb_buffer_set_script( p_run->p_buffer, p_run->script );
+
+        const uni_char_t *p_text =
+            p_paragraph->p_code_points + p_run->i_start_offset;
+        const int i_text = p_run->i_end_offset - p_run->i_start_offset;
+
+        /* Reuse the shaping of identical runs */
+        unsigned int i_cached_count = 0;
+        const shaped_glyph_t *p_cached = p_sys->p_glyph_cache
+            ? GlyphCache_GetRun( p_sys->p_glyph_cache, p_face,
+                                 p_run->direction, p_run->script,
+                                 p_text, i_text, &i_cached_count )
+            : NULL;
+        if( p_cached && hb_buffer_set_length( p_run->p_buffer, i_cached_count ) )
+        {
+            hb_glyph_info_t *p_infos =
+                hb_buffer_get_glyph_infos( p_run->p_buffer, NULL );
+            hb_glyph_position_t *p_positions =
+                hb_buffer_get_glyph_positions( p_run->p_buffer, NULL );
+            for( unsigned int j = 0; j < i_cached_count; ++j )
+            {
+                p_infos[ j ].codepoint = p_cached[ j ].i_glyph_index;
+                p_infos[ j ].cluster = p_cached[ j ].i_cluster;
+                p_positions[ j ].x_offset = p_cached[ j ].i_x_offset;
+                p_positions[ j ].y_offset = p_cached[ j ].i_y_offset;
+                p_positions[ j ].x_advance = p_cached[ j ].i_x_advance;
+                p_positions[ j ].y_advance = p_cached[ j ].i_y_advance;
+            }
+        }
+        else
+        {
+            p_run->p_hb_font = hb_ft_font_create( p_face, 0 );
+            if( !p_run->p_hb_font )
+            {
+                msg_Err( p_filter,
+                         "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+                goto error;
+            }
+
 #ifdef __OS2__
-        hb_buffer_add_utf16( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
+            hb_buffer_add_utf16( p_run->p_buffer, p_text, i_text, 0, i_text );
 #else
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
+            hb_buffer_add_utf32( p_run->p_buffer, p_text, i_text, 0, i_text );
 #endif
-        hb_shape( p_run->p_hb_font, p_run->p_buffer, 0, 0 );
+            hb_shape( p_run->p_hb_font, p_run->p_buffer, 0, 0 );
+
+            if( p_sys->p_glyph_cache )
+                CacheShapedRun( p_sys->p_glyph_cache, p_face, p_run,
+                                p_text, i_text );
+        }
+
         p_run->p_glyph_infos =
             hb_buffer_get_glyph_infos( p_run->p_buffer, &p_run->i_glyph_count );
         p_run->p_glyph_positions =
@@ -1039,12 +1099,13 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         else
             p_face = p_run->p_face;
 
+        int i_radius = 0;
         if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
         {
             double f_outline_thickness =
                 var_InheritInteger( p_filter, "freetype-outline-thickness" ) / 100.0;
             f_outline_thickness = VLC_CLIP( f_outline_thickness, 0.0, 0.5 );
-            int i_radius = ( i_live_size << 6 ) * f_outline_thickness;
+            i_radius = ( i_live_size << 6 ) * f_outline_thickness;
             FT_Stroker_Set( p_sys->p_stroker,
                             i_radius,
                             FT_STROKER_LINECAP_ROUND,
@@ -1101,6 +1162,16 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     SKIP_GLYPH( p_bitmaps )
             }
 
+            const int i_cache_flags = p_style->i_style_flags
+                & ( STYLE_BOLD | STYLE_ITALIC | ( i_radius ? STYLE_OUTLINE : 0 ) );
+            FT_Vector advance;
+            if( p_sys->p_glyph_cache
+             && GlyphCache_GetGlyph( p_sys->p_glyph_cache, p_face, i_glyph_index,
+                                     i_cache_flags, i_radius,
+                                     &p_bitmaps->p_glyph, &p_bitmaps->p_outline,
+                                     &advance ) )
+                goto loaded;
+
             if( FT_Load_Glyph( p_face, i_glyph_index,
                                FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
              && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
@@ -1126,14 +1197,23 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     p_bitmaps->p_outline = 0;
             }
 
+            advance = p_face->glyph->advance;
+            if( p_sys->p_glyph_cache )
+                GlyphCache_PutGlyph( p_sys->p_glyph_cache, p_face, i_glyph_index,
+                                     i_cache_flags, i_radius,
+                                     p_bitmaps->p_glyph, p_bitmaps->p_outline,
+                                     &advance );
+
+loaded:
+
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
                 p_bitmaps->p_shadow = p_bitmaps->p_outline ?
                                       p_bitmaps->p_outline : p_bitmaps->p_glyph;
 
             if( b_overwrite_advance )
             {
-                p_bitmaps->i_x_advance = p_face->glyph->advance.x;
-                p_bitmaps->i_y_advance = p_face->glyph->advance.y;
+                p_bitmaps->i_x_advance = advance.x;
+                p_bitmaps->i_y_advance = advance.y;
             }
 
             unsigned i_x_advance = FT_FLOOR( abs( p_bitmaps->i_x_advance ) );
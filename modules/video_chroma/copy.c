@@ -31,8 +31,12 @@
 
 #include <vlc_common.h>
 #include <vlc_picture.h>
+#include <vlc_filter.h>
 #include <vlc_cpu.h>
 #include <assert.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 #include "copy.h"
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
@@ -51,19 +55,25 @@ static void CopyPlane(uint8_t *dst, size_t dst_pitch,
 #define ASSERT_3PLANES ASSERT_2PLANES; \
     ASSERT_PLANE(2)
 
-int CopyInitCache(copy_cache_t *cache, unsigned width)
+int CopyInitCacheFilter(copy_cache_t *cache, unsigned width, filter_t *filter)
 {
 #ifdef CAN_COMPILE_SSE2
     cache->size = __MAX((width + 0x3f) & ~ 0x3f, 16384);
     cache->buffer = aligned_alloc(64, cache->size);
     if (!cache->buffer)
         return VLC_EGENERIC;
+    cache->filter = filter;
 #else
-    (void) cache; (void) width;
+    (void) cache; (void) width; (void) filter;
 #endif
     return VLC_SUCCESS;
 }
 
+int CopyInitCache(copy_cache_t *cache, unsigned width)
+{
+    return CopyInitCacheFilter(cache, width, NULL);
+}
+
 void CopyCleanCache(copy_cache_t *cache)
 {
 #ifdef CAN_COMPILE_SSE2
@@ -131,6 +141,10 @@ void CopyCleanCache(copy_cache_t *cache)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
 #endif
+#if defined(COPY_TEST_NOOPTIM) || defined(COPY_TEST_NOAVX2)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+#endif
 
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
  * as used by some video surface.
@@ -460,15 +474,101 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
 #undef LOAD64
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* Streams lines from USWC memory straight to the destination, with
+ * non-temporal stores when it is aligned, so that large planes do not go
+ * through the bounce buffer nor evict the caches. */
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    const __m128i rshift = _mm_cvtsi32_si128(bitshift > 0 ? bitshift : 0);
+    const __m128i lshift = _mm_cvtsi32_si128(bitshift < 0 ? -bitshift : 0);
+
+    _mm_mfence();
+    for (unsigned y = 0; y < height; y++) {
+        /* Stream loads need 32 bytes aligned sources */
+        unsigned x = __MIN((-(uintptr_t)src) & 0x1f, width);
+        if (x > 0)
+            CopyPlane(dst, x, src, x, 1, bitshift);
+
+        const bool aligned = (((uintptr_t)&dst[x]) & 0x1f) == 0;
+        for (; x + 127 < width; x += 128) {
+            __m256i r[4];
+            for (unsigned i = 0; i < 4; i++) {
+                r[i] = _mm256_stream_load_si256((__m256i *)&src[x + 32 * i]);
+                r[i] = _mm256_sll_epi16(_mm256_srl_epi16(r[i], rshift), lshift);
+            }
+            if (aligned)
+                for (unsigned i = 0; i < 4; i++)
+                    _mm256_stream_si256((__m256i *)&dst[x + 32 * i], r[i]);
+            else
+                for (unsigned i = 0; i < 4; i++)
+                    _mm256_storeu_si256((__m256i *)&dst[x + 32 * i], r[i]);
+        }
+
+        if (x < width)
+            CopyPlane(&dst[x], width - x, &src[x], width - x, 1, bitshift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_sfence();
+}
+
+struct avx2_copy_slice
+{
+    uint8_t *dst;
+    size_t dst_pitch;
+    const uint8_t *src;
+    size_t src_pitch;
+    unsigned width;
+    int bitshift;
+};
+
+static void AVX2_CopySlice(void *opaque, unsigned start, unsigned end)
+{
+    const struct avx2_copy_slice *s = opaque;
+
+    AVX2_CopyFromUswc(&s->dst[start * s->dst_pitch], s->dst_pitch,
+                      &s->src[start * s->src_pitch], s->src_pitch,
+                      s->width, end - start, s->bitshift);
+}
+
+static void AVX2_CopyPlane(uint8_t *dst, size_t dst_pitch,
+                           const uint8_t *src, size_t src_pitch,
+                           const copy_cache_t *cache,
+                           unsigned height, int bitshift)
+{
+    struct avx2_copy_slice slice = {
+        .dst = dst, .dst_pitch = dst_pitch,
+        .src = src, .src_pitch = src_pitch,
+        .width = __MIN(src_pitch, dst_pitch),
+        .bitshift = bitshift,
+    };
+
+    if (cache->filter != NULL)
+        filter_RunSlices(cache->filter, height, 1, AVX2_CopySlice, &slice);
+    else
+        AVX2_CopySlice(&slice, 0, height);
+}
+#endif
+
 static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
                           const uint8_t *src, size_t src_pitch,
-                          uint8_t *cache, size_t cache_size,
+                          const copy_cache_t *cache,
                           unsigned height, int bitshift)
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return AVX2_CopyPlane(dst, dst_pitch, src, src_pitch, cache,
+                              height, bitshift);
+#endif
+
     const size_t copy_pitch = __MIN(src_pitch, dst_pitch);
     const unsigned w16 = (copy_pitch+15) & ~15;
-    const unsigned hstep = cache_size / w16;
-    const unsigned cache_width = __MIN(src_pitch, cache_size);
+    const unsigned hstep = cache->size / w16;
+    const unsigned cache_width = __MIN(src_pitch, cache->size);
     assert(hstep > 0);
 
     /* If SSE4.1: CopyFromUswc is faster than memcpy */
@@ -479,10 +579,11 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
         const unsigned hblock =  __MIN(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
+        CopyFromUswc(cache->buffer, w16, src, src_pitch, cache_width, hblock,
+                     bitshift);
 
         /* Copy from our cache to the destination */
-        Copy2d(dst, dst_pitch, cache, w16, copy_pitch, hblock);
+        Copy2d(dst, dst_pitch, cache->buffer, w16, copy_pitch, hblock);
 
         /* */
         src += src_pitch * hblock;
@@ -562,9 +663,7 @@ static void SSE_Copy420_P_to_P(picture_t *dst, const uint8_t *src[static 3],
     for (unsigned n = 0; n < 3; n++) {
         const unsigned d = n > 0 ? 2 : 1;
         SSE_CopyPlane(dst->p[n].p_pixels, dst->p[n].i_pitch,
-                      src[n], src_pitch[n],
-                      cache->buffer, cache->size,
-                      (height+d-1)/d, 0);
+                      src[n], src_pitch[n], cache, (height+d-1)/d, 0);
     }
     asm volatile ("emms");
 }
@@ -575,9 +674,9 @@ static void SSE_Copy420_SP_to_SP(picture_t *dst, const uint8_t *src[static 2],
                                  const copy_cache_t *cache)
 {
     SSE_CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch, src[0], src_pitch[0],
-                  cache->buffer, cache->size, height, 0);
+                  cache, height, 0);
     SSE_CopyPlane(dst->p[1].p_pixels, dst->p[1].i_pitch, src[1], src_pitch[1],
-                  cache->buffer, cache->size, (height+1) / 2, 0);
+                  cache, (height+1) / 2, 0);
     asm volatile ("emms");
 }
 
@@ -587,7 +686,7 @@ SSE_Copy420_SP_to_P(picture_t *dest, const uint8_t *src[static 2],
                     uint8_t pixel_size, int bitshift, const copy_cache_t *cache)
 {
     SSE_CopyPlane(dest->p[0].p_pixels, dest->p[0].i_pitch,
-                  src[0], src_pitch[0], cache->buffer, cache->size, height, bitshift);
+                  src[0], src_pitch[0], cache, height, bitshift);
 
     SSE_SplitPlanes(dest->p[1].p_pixels, dest->p[1].i_pitch,
                     dest->p[2].p_pixels, dest->p[2].i_pitch,
@@ -602,7 +701,7 @@ static void SSE_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
                                 int bitshift, const copy_cache_t *cache)
 {
     SSE_CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch, src[0], src_pitch[0],
-                  cache->buffer, cache->size, height, bitshift);
+                  cache, height, bitshift);
     SSE_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
                          src[U_PLANE], src_pitch[U_PLANE],
                          src[V_PLANE], src_pitch[V_PLANE],
@@ -654,7 +753,7 @@ void CopyPacked(picture_t *dst, const uint8_t *src, const size_t src_pitch,
 #ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE4_1())
         return SSE_CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch, src, src_pitch,
-                             cache->buffer, cache->size, height, 0);
+                             cache, height, 0);
 #else
     (void) cache;
 #endif
@@ -1167,6 +1266,7 @@ int main(void)
                         size->i_visible_width, size->i_visible_height,
                         (const char *) &src->format.i_chroma,
                         (const char *) &dst->format.i_chroma);
+                vlc_tick_t start = vlc_tick_now();
                 if (test_dst->bitshift == 0)
                     test_dst->conv(dst, src_planes, src_pitches,
                                    src->format.i_visible_height, &cache);
@@ -1174,7 +1274,15 @@ int main(void)
                     test_dst->conv16(dst, src_planes, src_pitches,
                                    src->format.i_visible_height, test_dst->bitshift,
                                    &cache);
+                vlc_tick_t elapsed = vlc_tick_now() - start;
                 piccheck(dst, dst_dsc, false);
+
+                size_t bytes = 0;
+                for (int p = 0; p < src->i_planes; p++)
+                    bytes += (size_t)src->p[p].i_pitch * src->p[p].i_lines;
+                if (elapsed > 0)
+                    fprintf(stderr, "  %.1f MB/s\n", (double)bytes
+                            / US_FROM_VLC_TICK(elapsed));
                 picture_Release(dst);
             }
             picture_Release(src);
@@ -29,12 +29,16 @@ typedef struct {
 # ifdef CAN_COMPILE_SSE2
     uint8_t *buffer;
     size_t  size;
+    filter_t *filter;
 # else
     char dummy;
 # endif
 } copy_cache_t;
 
 int  CopyInitCache(copy_cache_t *cache, unsigned width);
+/* Same as CopyInitCache(), but large plane copies may be split across the
+ * slice threads of the filter */
+int  CopyInitCacheFilter(copy_cache_t *cache, unsigned width, filter_t *filter);
 void CopyCleanCache(copy_cache_t *cache);
 
 /* YUVY/RGB copies */
@@ -0,0 +1,567 @@
+/*****************************************************************************
+ * yuv_rgb_avx2.c : AVX2 YUV 4:2:0 to RGB32 conversions
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+/* Fixed point precision of the coefficients */
+#define PRECISION 13
+
+/**
+ * Conversion parameters, for one input chroma, matrix and range
+ */
+typedef struct
+{
+    /* Coefficients, scaled to 8-bit output */
+    int32_t  coef_y, coef_rv, coef_gu, coef_gv, coef_bu;
+    int32_t  y_offset, uv_offset;
+    int      shift;    /**< PRECISION plus the extra input bits */
+    int      in_shift; /**< right shift of the MSB aligned samples (P010) */
+
+    unsigned pixel_size; /**< bytes per input sample */
+    bool     semiplanar;
+    bool     swap_uv;
+
+    /* Output pixel layout */
+    int      r_shift, g_shift, b_shift;
+    uint32_t alpha;
+} yuv_rgb_t;
+
+typedef struct
+{
+    yuv_rgb_t conv;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Setup
+ *****************************************************************************/
+static int SetupInput(yuv_rgb_t *conv, vlc_fourcc_t chroma,
+                      video_color_space_t space, video_color_range_t range)
+{
+    unsigned bits;
+
+    conv->semiplanar = false;
+    conv->swap_uv = false;
+    conv->in_shift = 0;
+    switch (chroma)
+    {
+        case VLC_CODEC_I420:
+            bits = 8;
+            break;
+        case VLC_CODEC_YV12:
+            bits = 8;
+            conv->swap_uv = true;
+            break;
+        case VLC_CODEC_NV12:
+            bits = 8;
+            conv->semiplanar = true;
+            break;
+        case VLC_CODEC_NV21:
+            bits = 8;
+            conv->semiplanar = true;
+            conv->swap_uv = true;
+            break;
+        case VLC_CODEC_I420_10L:
+            bits = 10;
+            break;
+        case VLC_CODEC_P010:
+            bits = 10;
+            conv->semiplanar = true;
+            conv->in_shift = 6;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    conv->pixel_size = bits > 8 ? 2 : 1;
+
+    /* Luma weights of the red and blue primaries */
+    double kr, kb;
+    switch (space)
+    {
+        case COLOR_SPACE_BT601:
+            kr = 0.299;  kb = 0.114;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627; kb = 0.0593;
+            break;
+        default:
+            kr = 0.2126; kb = 0.0722;
+            break;
+    }
+    const double kg = 1. - kr - kb;
+
+    double y_scale = 1., uv_scale = 1.;
+    conv->y_offset = 0;
+    if (range != COLOR_RANGE_FULL)
+    {
+        y_scale = 255. / 219.;
+        uv_scale = 255. / 224.;
+        conv->y_offset = 16 << (bits - 8);
+    }
+    conv->uv_offset = 128 << (bits - 8);
+    conv->shift = PRECISION + bits - 8;
+
+    const double one = 1 << PRECISION;
+    conv->coef_y  = lround(y_scale * one);
+    conv->coef_rv = lround(uv_scale * 2. * (1. - kr) * one);
+    conv->coef_gu = lround(-uv_scale * 2. * kb * (1. - kb) / kg * one);
+    conv->coef_gv = lround(-uv_scale * 2. * kr * (1. - kr) / kg * one);
+    conv->coef_bu = lround(uv_scale * 2. * (1. - kb) * one);
+    return VLC_SUCCESS;
+}
+
+static int SetupOutput(yuv_rgb_t *conv, const video_format_t *fmt)
+{
+    /* Byte positions of the components in memory */
+    int r, g, b;
+    switch (fmt->i_chroma)
+    {
+        case VLC_CODEC_RGBA: r = 0; g = 1; b = 2; break;
+        case VLC_CODEC_BGRA: r = 2; g = 1; b = 0; break;
+        case VLC_CODEC_ARGB: r = 1; g = 2; b = 3; break;
+        case VLC_CODEC_RGB32:
+        {
+            /* Native endian masks */
+            const uint32_t masks[3] = { fmt->i_rmask, fmt->i_gmask,
+                                        fmt->i_bmask };
+            int shifts[3];
+            for (int i = 0; i < 3; i++)
+            {
+                if (masks[i] == 0 || masks[i] != (0xffu << ctz(masks[i])))
+                    return VLC_EGENERIC;
+                shifts[i] = ctz(masks[i]);
+            }
+            conv->r_shift = shifts[0];
+            conv->g_shift = shifts[1];
+            conv->b_shift = shifts[2];
+            conv->alpha = ~(masks[0] | masks[1] | masks[2]);
+            return VLC_SUCCESS;
+        }
+        default:
+            return VLC_EGENERIC;
+    }
+
+#ifdef WORDS_BIGENDIAN
+# define BYTE_SHIFT(pos) (24 - 8 * (pos))
+#else
+# define BYTE_SHIFT(pos) (8 * (pos))
+#endif
+    conv->r_shift = BYTE_SHIFT(r);
+    conv->g_shift = BYTE_SHIFT(g);
+    conv->b_shift = BYTE_SHIFT(b);
+    conv->alpha = ~((0xffu << conv->r_shift) | (0xffu << conv->g_shift)
+                  | (0xffu << conv->b_shift));
+    return VLC_SUCCESS;
+#undef BYTE_SHIFT
+}
+
+/*****************************************************************************
+ * Line conversions
+ *****************************************************************************/
+static inline unsigned GetSample(const yuv_rgb_t *conv, const uint8_t *p,
+                                 unsigned i)
+{
+    if (conv->pixel_size == 1)
+        return p[i];
+    return ((const uint16_t *)p)[i] >> conv->in_shift;
+}
+
+static inline int Clip8(int v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+/* Converts pixels [x, width) of a line, x being even */
+static void ConvertLineC(const yuv_rgb_t *conv, uint32_t *dst,
+                         const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                         unsigned x, unsigned width)
+{
+    const int round = 1 << (conv->shift - 1);
+
+    for (; x < width; x++)
+    {
+        int U, V;
+        if (conv->semiplanar)
+        {
+            U = GetSample(conv, u, (x & ~1u) + conv->swap_uv);
+            V = GetSample(conv, u, (x & ~1u) + !conv->swap_uv);
+        }
+        else
+        {
+            U = GetSample(conv, u, x >> 1);
+            V = GetSample(conv, v, x >> 1);
+        }
+        U -= conv->uv_offset;
+        V -= conv->uv_offset;
+
+        const int Y = ((int)GetSample(conv, y, x) - conv->y_offset)
+                    * conv->coef_y + round;
+        const int r = Clip8((Y + conv->coef_rv * V) >> conv->shift);
+        const int g = Clip8((Y + conv->coef_gu * U + conv->coef_gv * V)
+                            >> conv->shift);
+        const int b = Clip8((Y + conv->coef_bu * U) >> conv->shift);
+
+        dst[x] = ((uint32_t)r << conv->r_shift) | ((uint32_t)g << conv->g_shift)
+               | ((uint32_t)b << conv->b_shift) | conv->alpha;
+    }
+}
+
+/* Eight pixels at a time, in 32-bit lanes, chroma being upsampled by
+ * duplication like in the C version */
+__attribute__ ((__target__ ("avx2")))
+static void ConvertLineAVX2(const yuv_rgb_t *conv, uint32_t *dst,
+                            const uint8_t *y, const uint8_t *u,
+                            const uint8_t *v, unsigned width)
+{
+    const __m128i shift = _mm_cvtsi32_si128(conv->shift);
+    const __m128i in_shift = _mm_cvtsi32_si128(conv->in_shift);
+    const __m128i r_shift = _mm_cvtsi32_si128(conv->r_shift);
+    const __m128i g_shift = _mm_cvtsi32_si128(conv->g_shift);
+    const __m128i b_shift = _mm_cvtsi32_si128(conv->b_shift);
+    const __m256i coef_y  = _mm256_set1_epi32(conv->coef_y);
+    const __m256i coef_rv = _mm256_set1_epi32(conv->coef_rv);
+    const __m256i coef_gu = _mm256_set1_epi32(conv->coef_gu);
+    const __m256i coef_gv = _mm256_set1_epi32(conv->coef_gv);
+    const __m256i coef_bu = _mm256_set1_epi32(conv->coef_bu);
+    const __m256i y_offset = _mm256_set1_epi32(conv->y_offset);
+    const __m256i uv_offset = _mm256_set1_epi32(conv->uv_offset);
+    const __m256i round = _mm256_set1_epi32(1 << (conv->shift - 1));
+    const __m256i alpha = _mm256_set1_epi32(conv->alpha);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32(255);
+    const __m256i dup = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i even = _mm256_setr_epi32(0, 0, 2, 2, 4, 4, 6, 6);
+    const __m256i odd = _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 7, 7);
+    const bool wide = conv->pixel_size == 2;
+    unsigned x;
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256i Y, U, V;
+
+        if (wide)
+            Y = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128((const __m128i *)&((const uint16_t *)y)[x]));
+        else
+            Y = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&y[x]));
+
+        if (conv->semiplanar)
+        {
+            /* U0 V0 U1 V1 U2 V2 U3 V3 */
+            __m256i uv;
+            if (wide)
+                uv = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128((const __m128i *)&((const uint16_t *)u)[x]));
+            else
+                uv = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64((const __m128i *)&u[x]));
+            U = _mm256_permutevar8x32_epi32(uv, conv->swap_uv ? odd : even);
+            V = _mm256_permutevar8x32_epi32(uv, conv->swap_uv ? even : odd);
+        }
+        else if (wide)
+        {
+            U = _mm256_cvtepu16_epi32(
+                _mm_loadl_epi64((const __m128i *)&((const uint16_t *)u)[x / 2]));
+            V = _mm256_cvtepu16_epi32(
+                _mm_loadl_epi64((const __m128i *)&((const uint16_t *)v)[x / 2]));
+            U = _mm256_permutevar8x32_epi32(U, dup);
+            V = _mm256_permutevar8x32_epi32(V, dup);
+        }
+        else
+        {
+            uint32_t u4, v4;
+            memcpy(&u4, &u[x / 2], 4);
+            memcpy(&v4, &v[x / 2], 4);
+            U = _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(u4));
+            V = _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(v4));
+            U = _mm256_permutevar8x32_epi32(U, dup);
+            V = _mm256_permutevar8x32_epi32(V, dup);
+        }
+
+        Y = _mm256_srl_epi32(Y, in_shift);
+        U = _mm256_sub_epi32(_mm256_srl_epi32(U, in_shift), uv_offset);
+        V = _mm256_sub_epi32(_mm256_srl_epi32(V, in_shift), uv_offset);
+        Y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(Y, y_offset),
+                                                coef_y), round);
+
+        __m256i r = _mm256_add_epi32(Y, _mm256_mullo_epi32(V, coef_rv));
+        __m256i g = _mm256_add_epi32(Y, _mm256_add_epi32(
+                        _mm256_mullo_epi32(U, coef_gu),
+                        _mm256_mullo_epi32(V, coef_gv)));
+        __m256i b = _mm256_add_epi32(Y, _mm256_mullo_epi32(U, coef_bu));
+
+        r = _mm256_min_epi32(_mm256_max_epi32(_mm256_sra_epi32(r, shift), zero), max);
+        g = _mm256_min_epi32(_mm256_max_epi32(_mm256_sra_epi32(g, shift), zero), max);
+        b = _mm256_min_epi32(_mm256_max_epi32(_mm256_sra_epi32(b, shift), zero), max);
+
+        __m256i out = _mm256_or_si256(_mm256_or_si256(
+                          _mm256_sll_epi32(r, r_shift),
+                          _mm256_sll_epi32(g, g_shift)),
+                      _mm256_or_si256(_mm256_sll_epi32(b, b_shift), alpha));
+        _mm256_storeu_si256((__m256i *)&dst[x], out);
+    }
+
+    ConvertLineC(conv, dst, y, u, v, x, width);
+}
+
+#ifndef YUV_RGB_TEST
+/*****************************************************************************
+ * Picture conversion
+ *****************************************************************************/
+typedef struct
+{
+    const yuv_rgb_t *conv;
+    const picture_t *src;
+    picture_t *dst;
+    unsigned width;
+    void (*line)(const yuv_rgb_t *, uint32_t *, const uint8_t *,
+                 const uint8_t *, const uint8_t *, unsigned);
+} convert_slice_t;
+
+static void ConvertSlice(void *opaque, unsigned start, unsigned end)
+{
+    const convert_slice_t *s = opaque;
+    const plane_t *y = &s->src->p[Y_PLANE];
+    const plane_t *u = &s->src->p[U_PLANE];
+    const plane_t *v = &s->src->p[s->conv->semiplanar ? U_PLANE : V_PLANE];
+    const plane_t *d = &s->dst->p[0];
+
+    for (unsigned j = start; j < end; j++)
+        s->line(s->conv, (uint32_t *)&d->p_pixels[j * d->i_pitch],
+                &y->p_pixels[j * y->i_pitch],
+                &u->p_pixels[(j / 2) * u->i_pitch],
+                &v->p_pixels[(j / 2) * v->i_pitch], s->width);
+}
+
+static void Convert(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const yuv_rgb_t *conv = &sys->conv;
+
+    /* YV12 has the V plane first */
+    picture_t swapped;
+    if (conv->swap_uv && !conv->semiplanar)
+    {
+        swapped = *src;
+        swapped.p[U_PLANE] = src->p[V_PLANE];
+        swapped.p[V_PLANE] = src->p[U_PLANE];
+        src = &swapped;
+    }
+
+    convert_slice_t slice = {
+        .conv = conv,
+        .src = src,
+        .dst = dst,
+        .width = __MIN(src->p[Y_PLANE].i_visible_pitch / conv->pixel_size,
+                       (unsigned)dst->p[0].i_visible_pitch / 4),
+        .line = ConvertLineAVX2,
+    };
+    unsigned height = __MIN(src->p[Y_PLANE].i_visible_lines,
+                            dst->p[0].i_visible_lines);
+
+    filter_RunSlices(filter, height, 2, ConvertSlice, &slice);
+}
+
+VIDEO_FILTER_WRAPPER(Convert)
+
+/*****************************************************************************
+ * Module
+ *****************************************************************************/
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    if (!vlc_CPU_AVX2())
+        return VLC_EGENERIC;
+
+    if (((in->i_width | in->i_height) & 1)
+     || in->i_width != out->i_width || in->i_height != out->i_height
+     || in->i_visible_width != out->i_visible_width
+     || in->i_visible_height != out->i_visible_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    yuv_rgb_t conv;
+    if (SetupInput(&conv, in->i_chroma, in->space, in->color_range)
+     || SetupOutput(&conv, out))
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+    sys->conv = conv;
+
+    msg_Dbg(filter, "%4.4s to %4.4s, %s matrix, %s range",
+            (const char *)&in->i_chroma, (const char *)&out->i_chroma,
+            in->space == COLOR_SPACE_BT601 ? "BT.601" :
+            in->space == COLOR_SPACE_BT2020 ? "BT.2020" : "BT.709",
+            in->color_range == COLOR_RANGE_FULL ? "full" : "limited");
+
+    filter->p_sys = sys;
+    filter->pf_video_filter = Convert_Filter;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    free(filter->p_sys);
+}
+
+vlc_module_begin ()
+    set_description(N_("AVX2 I420,YV12,NV12,NV21,I420_10L,P010 to "
+                       "RV32,RGBA,BGRA,ARGB conversions"))
+    set_capability("video converter", 160)
+    set_callbacks(Open, Close)
+vlc_module_end ()
+#endif
+
+#ifdef YUV_RGB_TEST
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/*
+ * Checks the AVX2 lines against the C ones for every input chroma, matrix
+ * and range, then prints the 1080p frame conversion time of each.
+ */
+
+#define WIDTH  1920
+#define HEIGHT 1080
+
+static const vlc_fourcc_t chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_NV12, VLC_CODEC_NV21,
+    VLC_CODEC_I420_10L, VLC_CODEC_P010,
+};
+
+static void Fill(uint8_t *p, size_t size, const yuv_rgb_t *conv)
+{
+    for (size_t i = 0; i < size / conv->pixel_size; i++)
+    {
+        unsigned v = rand();
+        if (conv->pixel_size == 1)
+            p[i] = v;
+        else
+            ((uint16_t *)p)[i] = (v & 0x3ff) << conv->in_shift;
+    }
+}
+
+static void ConvertFrame(const yuv_rgb_t *conv, uint32_t *dst, uint8_t *y,
+                         uint8_t *u, uint8_t *v, bool avx2)
+{
+    const size_t pitch = WIDTH * conv->pixel_size;
+    const size_t cpitch = conv->semiplanar ? pitch : pitch / 2;
+
+    for (unsigned j = 0; j < HEIGHT; j++)
+    {
+        uint32_t *line = &dst[j * WIDTH];
+        const uint8_t *yl = &y[j * pitch];
+        const uint8_t *ul = &u[(j / 2) * cpitch];
+        const uint8_t *vl = &v[(j / 2) * cpitch];
+
+        if (avx2)
+            ConvertLineAVX2(conv, line, yl, ul, vl, WIDTH - 2 * (j % 8));
+        else
+            ConvertLineC(conv, line, yl, ul, vl, 0, WIDTH - 2 * (j % 8));
+    }
+}
+
+int main(void)
+{
+    if (!vlc_CPU_AVX2())
+    {
+        fprintf(stderr, "WARNING: could not test AVX2\n");
+        return 77;
+    }
+
+    const video_color_space_t spaces[] = {
+        COLOR_SPACE_BT601, COLOR_SPACE_BT709, COLOR_SPACE_BT2020,
+    };
+    const video_color_range_t ranges[] = {
+        COLOR_RANGE_LIMITED, COLOR_RANGE_FULL,
+    };
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_BGRA);
+
+    const size_t luma = WIDTH * HEIGHT * 2;
+    uint8_t *y = malloc(luma);
+    uint8_t *u = malloc(luma / 2); /* room for semi-planar too */
+    uint8_t *v = malloc(luma / 2);
+    uint32_t *ref = malloc(WIDTH * HEIGHT * 4);
+    uint32_t *out = malloc(WIDTH * HEIGHT * 4);
+    assert(y && u && v && ref && out);
+
+    for (size_t c = 0; c < ARRAY_SIZE(chromas); c++)
+        for (size_t s = 0; s < ARRAY_SIZE(spaces); s++)
+            for (size_t r = 0; r < ARRAY_SIZE(ranges); r++)
+            {
+                yuv_rgb_t conv;
+                int ret = SetupInput(&conv, chromas[c], spaces[s], ranges[r]);
+                assert(ret == VLC_SUCCESS);
+                ret = SetupOutput(&conv, &fmt);
+                assert(ret == VLC_SUCCESS);
+
+                Fill(y, luma, &conv);
+                Fill(u, luma / 2, &conv);
+                Fill(v, luma / 2, &conv);
+                memset(ref, 0, WIDTH * HEIGHT * 4);
+                memset(out, 0, WIDTH * HEIGHT * 4);
+
+                vlc_tick_t start = vlc_tick_now();
+                ConvertFrame(&conv, ref, y, u, v, false);
+                vlc_tick_t c_time = vlc_tick_now() - start;
+
+                start = vlc_tick_now();
+                ConvertFrame(&conv, out, y, u, v, true);
+                vlc_tick_t avx2_time = vlc_tick_now() - start;
+
+                assert(memcmp(ref, out, WIDTH * HEIGHT * 4) == 0);
+
+                printf("{\"chroma\":\"%4.4s\",\"matrix\":%d,\"range\":\"%s\","
+                       "\"c_us\":%"PRId64",\"avx2_us\":%"PRId64"}\n",
+                       (const char *)&chromas[c], spaces[s],
+                       ranges[r] == COLOR_RANGE_FULL ? "full" : "limited",
+                       US_FROM_VLC_TICK(c_time), US_FROM_VLC_TICK(avx2_time));
+            }
+
+    free(out);
+    free(ref);
+    free(v);
+    free(u);
+    free(y);
+    return 0;
+}
+
+#endif
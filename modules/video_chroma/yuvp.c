@@ -110,6 +110,16 @@ static void Convert( filter_t *p_filter, picture_t *p_source,
 
     if( p_filter->fmt_out.video.i_chroma == VLC_CODEC_YUVA )
     {
+        /* Split the palette per plane, with out of range indexes
+         * mapped to transparent entries, so that each pixel is a plain
+         * lookup */
+        uint8_t lut[4][256];
+
+        memset( lut, 0, sizeof(lut) );
+        for( int i = 0; i < p_yuvp->i_entries; i++ )
+            for( int c = 0; c < 4; c++ )
+                lut[c][i] = p_yuvp->palette[i][c];
+
         for( unsigned int y = 0; y < p_filter->fmt_in.video.i_height; y++ )
         {
             const uint8_t *p_line = &p_source->p->p_pixels[y*p_source->p->i_pitch];
@@ -120,15 +130,12 @@ static void Convert( filter_t *p_filter, picture_t *p_source,
 
             for( unsigned int x = 0; x < p_filter->fmt_in.video.i_width; x++ )
             {
-                const int v = p_line[x];
+                const uint8_t v = p_line[x];
 
-                if( v > p_yuvp->i_entries )  /* maybe assert ? */
-                    continue;
-
-                p_y[x] = p_yuvp->palette[v][0];
-                p_u[x] = p_yuvp->palette[v][1];
-                p_v[x] = p_yuvp->palette[v][2];
-                p_a[x] = p_yuvp->palette[v][3];
+                p_y[x] = lut[0][v];
+                p_u[x] = lut[1][v];
+                p_v[x] = lut[2][v];
+                p_a[x] = lut[3][v];
             }
         }
     }
@@ -159,23 +166,21 @@ static void Convert( filter_t *p_filter, picture_t *p_source,
             rgbp.palette[i][a] = p_yuvp->palette[i][3];
         }
 
+        /* Expand each pixel with a single 32-bits store, out of range
+         * indexes being transparent */
+        uint32_t lut[256];
+
+        memset( lut, 0, sizeof(lut) );
+        for( int i = 0; i < rgbp.i_entries; i++ )
+            memcpy( &lut[i], rgbp.palette[i], 4 );
+
         for( unsigned int y = 0; y < p_filter->fmt_in.video.i_height; y++ )
         {
             const uint8_t *p_line = &p_source->p->p_pixels[y*p_source->p->i_pitch];
-            uint8_t *p_pixels = &p_dest->p->p_pixels[y*p_dest->p->i_pitch];
+            uint32_t *p_pixels = (uint32_t *)&p_dest->p->p_pixels[y*p_dest->p->i_pitch];
 
             for( unsigned int x = 0; x < p_filter->fmt_in.video.i_width; x++ )
-            {
-                const int v = p_line[x];
-
-                if( v >= rgbp.i_entries )  /* maybe assert ? */
-                    continue;
-
-                p_pixels[4*x+0] = rgbp.palette[v][0];
-                p_pixels[4*x+1] = rgbp.palette[v][1];
-                p_pixels[4*x+2] = rgbp.palette[v][2];
-                p_pixels[4*x+3] = rgbp.palette[v][3];
-            }
+                p_pixels[x] = lut[p_line[x]];
         }
 
     }
@@ -31,8 +31,14 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if defined(CAN_COMPILE_SSE4_1) && defined(HAVE_SSE2_INTRINSICS)
+# include <smmintrin.h>
+# define BLEND_SSE4_1
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -84,6 +90,18 @@ public:
     {
         return true;
     }
+    const picture_t *getPicture() const
+    {
+        return picture;
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
 
 protected:
     template <unsigned ry>
@@ -561,6 +579,157 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+#ifdef BLEND_SSE4_1
+/* SSE4.1 kernels for YUVA onto 8 bits 4:2:0, the most common subpicture
+ * blending. They give the same results as the generic Blend() above.
+ * All intermediate values fit in unsigned 16 bits: alpha * a <= 255 * 255,
+ * and so does the blended value, as both factors add up to 255. */
+
+#define BLEND_SSE4 __attribute__((__target__("sse4.1")))
+
+BLEND_SSE4
+static inline __m128i div255_sse(__m128i v)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(v, 8), v),
+                                        one), 8);
+}
+
+/* Blends 8 16-bits samples */
+BLEND_SSE4
+static inline __m128i merge_sse(__m128i dst, __m128i src, __m128i a)
+{
+    const __m128i c255 = _mm_set1_epi16(255);
+    return div255_sse(_mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(c255, a), dst),
+                                    _mm_mullo_epi16(src, a)));
+}
+
+BLEND_SSE4
+static inline __m128i alpha_sse(__m128i src_a, __m128i alpha)
+{
+    return div255_sse(_mm_mullo_epi16(src_a, alpha));
+}
+
+/* Blends a line of a full resolution plane */
+BLEND_SSE4
+static void BlendLineSSE4(uint8_t *dst, const uint8_t *src, const uint8_t *src_a,
+                          unsigned width, int alpha)
+{
+    const __m128i valpha = _mm_set1_epi16(alpha);
+    unsigned x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i s = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&src[x]));
+        __m128i a = alpha_sse(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&src_a[x])),
+                              valpha);
+        __m128i d = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&dst[x]));
+        d = merge_sse(d, s, a);
+        _mm_storel_epi64((__m128i *)&dst[x], _mm_packus_epi16(d, d));
+    }
+    for (; x < width; x++) {
+        unsigned a = div255(alpha * src_a[x]);
+        if (a > 0)
+            ::merge(&dst[x], src[x], a);
+    }
+}
+
+/* Blends the chroma of a line onto a half horizontal resolution plane,
+ * from the even (relative to the destination) source samples. dst points
+ * to the chroma of the first full source sample, x_first. */
+BLEND_SSE4
+static void BlendLineChromaSSE4(uint8_t *dst_u, uint8_t *dst_v, bool packed,
+                                const uint8_t *src_u, const uint8_t *src_v,
+                                const uint8_t *src_a, unsigned x_first,
+                                unsigned width, int alpha)
+{
+    const __m128i valpha = _mm_set1_epi16(alpha);
+    const __m128i even = _mm_set1_epi16(0x00ff);
+    const unsigned step = packed ? 2 : 1;
+    unsigned x = x_first;
+    unsigned c = 0;
+    for (; x + 16 <= width; x += 16, c += 8) {
+        __m128i su = _mm_and_si128(_mm_loadu_si128((const __m128i *)&src_u[x]), even);
+        __m128i sv = _mm_and_si128(_mm_loadu_si128((const __m128i *)&src_v[x]), even);
+        __m128i a  = alpha_sse(_mm_and_si128(_mm_loadu_si128((const __m128i *)&src_a[x]),
+                                             even), valpha);
+        if (packed) {
+            /* dst_v is dst_u + 1 or dst_u - 1 */
+            uint8_t *uv = __MIN(dst_u, dst_v) + 2 * c;
+            __m128i d = _mm_loadu_si128((const __m128i *)uv);
+            __m128i lo = _mm_and_si128(d, even);
+            __m128i hi = _mm_srli_epi16(d, 8);
+            if (dst_u < dst_v) {
+                lo = merge_sse(lo, su, a);
+                hi = merge_sse(hi, sv, a);
+            } else {
+                lo = merge_sse(lo, sv, a);
+                hi = merge_sse(hi, su, a);
+            }
+            _mm_storeu_si128((__m128i *)uv, _mm_or_si128(lo, _mm_slli_epi16(hi, 8)));
+        } else {
+            __m128i du = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&dst_u[c]));
+            __m128i dv = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&dst_v[c]));
+            du = merge_sse(du, su, a);
+            dv = merge_sse(dv, sv, a);
+            _mm_storel_epi64((__m128i *)&dst_u[c], _mm_packus_epi16(du, du));
+            _mm_storel_epi64((__m128i *)&dst_v[c], _mm_packus_epi16(dv, dv));
+        }
+    }
+    for (; x < width; x += 2, c++) {
+        unsigned a = div255(alpha * src_a[x]);
+        if (a > 0) {
+            ::merge(&dst_u[c * step], src_u[x], a);
+            ::merge(&dst_v[c * step], src_v[x], a);
+        }
+    }
+}
+
+/* YUVA onto I420 (swap_uv: YV12), or NV12 (swap_uv: NV21) if packed */
+template <bool packed, bool swap_uv>
+BLEND_SSE4
+void BlendYuvaTo420SSE4(const CPicture &dst_data, const CPicture &src_data,
+                        unsigned width, unsigned height, int alpha)
+{
+    const picture_t *src = src_data.getPicture();
+    const picture_t *dst = dst_data.getPicture();
+    const unsigned src_x = src_data.getX();
+    const unsigned dst_x = dst_data.getX();
+
+    /* First source sample on a full chroma destination sample */
+    const unsigned x_first = dst_x % 2;
+    const unsigned c_first = (dst_x + x_first) / 2;
+
+    for (unsigned y = 0; y < height; y++) {
+        const unsigned sy = src_data.getY() + y;
+        const unsigned dy = dst_data.getY() + y;
+
+        const uint8_t *src_y = &src->p[0].p_pixels[sy * src->p[0].i_pitch + src_x];
+        const uint8_t *src_u = &src->p[1].p_pixels[sy * src->p[1].i_pitch + src_x];
+        const uint8_t *src_v = &src->p[2].p_pixels[sy * src->p[2].i_pitch + src_x];
+        const uint8_t *src_a = &src->p[3].p_pixels[sy * src->p[3].i_pitch + src_x];
+
+        BlendLineSSE4(&dst->p[0].p_pixels[dy * dst->p[0].i_pitch + dst_x],
+                      src_y, src_a, width, alpha);
+
+        if (dy % 2)
+            continue;
+
+        uint8_t *dst_u, *dst_v;
+        if (packed) {
+            uint8_t *uv = &dst->p[1].p_pixels[dy / 2 * dst->p[1].i_pitch + 2 * c_first];
+            dst_u = &uv[ swap_uv];
+            dst_v = &uv[!swap_uv];
+        } else {
+            const plane_t *pu = &dst->p[swap_uv ? 2 : 1];
+            const plane_t *pv = &dst->p[swap_uv ? 1 : 2];
+            dst_u = &pu->p_pixels[dy / 2 * pu->i_pitch + c_first];
+            dst_v = &pv->p_pixels[dy / 2 * pv->i_pitch + c_first];
+        }
+        BlendLineChromaSSE4(dst_u, dst_v, packed, src_u, src_v, src_a,
+                            x_first, width, alpha);
+    }
+}
+#endif
+
 namespace {
 
 static const struct {
@@ -692,6 +861,26 @@ static int Open(vlc_object_t *object)
             sys->blend = blends[i].blend;
     }
 
+#ifdef BLEND_SSE4_1
+    if (vlc_CPU_SSE4_1() && src == VLC_CODEC_YUVA) {
+        switch (dst) {
+            case VLC_CODEC_I420:
+            case VLC_CODEC_J420:
+                sys->blend = BlendYuvaTo420SSE4<false, false>;
+                break;
+            case VLC_CODEC_YV12:
+                sys->blend = BlendYuvaTo420SSE4<false, true>;
+                break;
+            case VLC_CODEC_NV12:
+                sys->blend = BlendYuvaTo420SSE4<true, false>;
+                break;
+            case VLC_CODEC_NV21:
+                sys->blend = BlendYuvaTo420SSE4<true, true>;
+                break;
+        }
+    }
+#endif
+
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
                (char *)&src, (char *)&dst);
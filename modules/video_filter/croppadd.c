@@ -120,6 +120,7 @@ typedef struct
     int i_paddbottom;
     int i_paddleft;
     int i_paddright;
+    bool b_crop_only; /* output references the input pixels */
 } filter_sys_t;
 
 /*****************************************************************************
@@ -185,6 +186,9 @@ static int OpenFilter( vlc_object_t *p_this )
         - p_sys->i_cropleft - p_sys->i_cropright
         + p_sys->i_paddleft + p_sys->i_paddright;
 
+    p_sys->b_crop_only = p_sys->i_paddtop == 0 && p_sys->i_paddbottom == 0 &&
+                         p_sys->i_paddleft == 0 && p_sys->i_paddright == 0;
+
     p_filter->pf_video_filter = Filter;
 
     msg_Dbg( p_filter, "Crop: Top: %d, Bottom: %d, Left: %d, Right: %d",
@@ -214,6 +218,54 @@ static void CloseFilter( vlc_object_t *p_this )
 /****************************************************************************
  * Filter: the whole thing
  ****************************************************************************/
+/*****************************************************************************
+ * Crop: crops without copying
+ *****************************************************************************
+ * Without padding, the output picture is a clone of the input one, whose
+ * planes start at the cropped area: only the first line and the visible
+ * sizes change, the pitches are kept.
+ *****************************************************************************/
+static picture_t *Crop( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    picture_t *p_outpic = picture_Clone( p_pic );
+    if( !p_outpic )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    for( int i_plane = 0; i_plane < p_outpic->i_planes; i_plane++ )
+    {
+        const plane_t *p_plane = p_pic->p+i_plane;
+        plane_t *p_outplane = p_outpic->p+i_plane;
+
+        /* Same geometry as in Filter() */
+        int i_width =  ( ( p_filter->fmt_in.video.i_visible_width
+                           - p_sys->i_cropleft - p_sys->i_cropright )
+                         * p_plane->i_visible_pitch )
+                       / p_pic->p->i_visible_pitch;
+        int i_height = ( ( p_filter->fmt_in.video.i_visible_height
+                           - p_sys->i_croptop - p_sys->i_cropbottom )
+                         * p_plane->i_visible_lines )
+                       / p_pic->p->i_visible_lines;
+        int i_xcrop =  ( p_sys->i_cropleft * p_plane->i_visible_pitch)
+                       / p_pic->p->i_visible_pitch;
+        int i_ycrop =  ( p_sys->i_croptop * p_plane->i_visible_lines)
+                       / p_pic->p->i_visible_lines;
+
+        p_outplane->p_pixels += i_ycrop * p_plane->i_pitch
+                              + i_xcrop * p_plane->i_pixel_pitch;
+        p_outplane->i_lines -= i_ycrop;
+        p_outplane->i_visible_lines = i_height;
+        p_outplane->i_visible_pitch = i_width * p_plane->i_pixel_pitch;
+    }
+    p_outpic->format = p_filter->fmt_out.video;
+
+    return CopyInfoAndRelease( p_outpic, p_pic );
+}
+
 static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -225,6 +277,9 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
 
     if( !p_pic ) return NULL;
 
+    if( p_sys->b_crop_only )
+        return Crop( p_filter, p_pic );
+
     /* Request output picture */
     p_outpic = filter_NewPicture( p_filter );
     if( !p_outpic )
@@ -46,6 +46,34 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+yadif_line_t GetYadifLineFilter( unsigned i_pixel_size )
+{
+    if( i_pixel_size == 2 )
+    {
+#if defined(HAVE_AVX2_INTRINSICS)
+        if( vlc_CPU_AVX2() )
+            return yadif_filter_line_16bit_avx2;
+#endif
+        return yadif_filter_line_c_16bit;
+    }
+
+#if defined(HAVE_AVX2_INTRINSICS)
+    if( vlc_CPU_AVX2() )
+        return yadif_filter_line_avx2;
+#endif
+#if defined(HAVE_X86ASM)
+    if( vlc_CPU_SSSE3() )
+        return vlcpriv_yadif_filter_line_ssse3;
+    if( vlc_CPU_SSE2() )
+        return vlcpriv_yadif_filter_line_sse2;
+#if defined(__i386__)
+    if( vlc_CPU_MMXEXT() )
+        return vlcpriv_yadif_filter_line_mmxext;
+#endif
+#endif
+    return yadif_filter_line_c;
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -108,27 +136,8 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
-
-#if defined(HAVE_X86ASM)
-        if( vlc_CPU_SSSE3() )
-            filter = vlcpriv_yadif_filter_line_ssse3;
-        else
-        if( vlc_CPU_SSE2() )
-            filter = vlcpriv_yadif_filter_line_sse2;
-        else
-#if defined(__i386__)
-        if( vlc_CPU_MMXEXT() )
-            filter = vlcpriv_yadif_filter_line_mmxext;
-        else
-#endif
-#endif
-            filter = yadif_filter_line_c;
-
-        if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
+        const yadif_line_t filter = p_sys->pf_yadif_line;
+        const int i_pixel_size = p_sys->chroma->pixel_size;
 
         for( int n = 0; n < p_dst->i_planes; n++ )
         {
@@ -155,7 +164,7 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                             &prevp->p_pixels[y * prevp->i_pitch],
                             &curp->p_pixels[y * curp->i_pitch],
                             &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
+                            dstp->i_visible_pitch / i_pixel_size,
                             y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
                             y  - 1  ?  -curp->i_pitch : curp->i_pitch,
                             yadif_parity,
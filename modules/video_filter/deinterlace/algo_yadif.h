@@ -38,6 +38,23 @@ struct picture_t;
  * Functions
  *****************************************************************************/
 
+/**
+ * Yadif line filter, see yadif.h.
+ *
+ * The width w is in pixels, while the prefs and mrefs line offsets
+ * are in bytes.
+ */
+typedef void (*yadif_line_t)( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                              uint8_t *next, int w, int prefs, int mrefs,
+                              int parity, int mode );
+
+/**
+ * Selects the fastest Yadif line filter supported by the CPU.
+ *
+ * @param i_pixel_size Bytes per pixel: 1 or 2 for high bit depth.
+ */
+yadif_line_t GetYadifLineFilter( unsigned i_pixel_size );
+
 /**
  * Yadif (Yet Another DeInterlacing Filter) from FFmpeg.
  * One field is copied as-is (i_field), the other is interpolated.
@@ -534,6 +534,7 @@ notsupp:
                        p_filter->p_cfg );
     char *psz_mode = var_InheritString( p_filter, FILTER_CFG_PREFIX "mode" );
     SetFilterMethod( p_filter, psz_mode, packed );
+    p_sys->pf_yadif_line = GetYadifLineFilter( chroma->pixel_size );
 
     IVTCClearState( p_filter );
 
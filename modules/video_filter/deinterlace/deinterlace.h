@@ -75,6 +75,9 @@ typedef struct
     void (*pf_end_merge) ( void );
 #endif
 
+    /** Yadif line filter: C, SSE2, SSSE3, AVX2, ... */
+    yadif_line_t pf_yadif_line;
+
     struct deinterlace_ctx   context;
 
     /* Algorithm-specific substructures */
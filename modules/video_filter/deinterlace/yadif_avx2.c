@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * yadif_avx2.c : AVX2 Yadif line filters
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+
+#include <vlc_common.h>
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+
+#include "common.h"      /* FFMIN3 et al. */
+#include "yadif.h"
+
+/* Same computation as the FILTER macro of yadif.h, on 16 (8-bit pixels in
+ * 16-bit lanes) or 8 (16-bit pixels in 32-bit lanes) pixels at once. The
+ * lanes are wide enough for the sums not to overflow. */
+#define YADIF_AVX2(LOAD, EPI) \
+    const __m256i one = _mm256_set1_##EPI(1); \
+    const __m256i zero = _mm256_setzero_si256(); \
+    __m256i c  = LOAD(&cur[mrefs]); \
+    __m256i e  = LOAD(&cur[prefs]); \
+    __m256i p2 = LOAD(prev2); \
+    __m256i n2 = LOAD(next2); \
+    __m256i d  = _mm256_srai_##EPI(_mm256_add_##EPI(p2, n2), 1); \
+    __m256i temporal_diff0 = _mm256_abs_##EPI(_mm256_sub_##EPI(p2, n2)); \
+    __m256i temporal_diff1 = _mm256_srai_##EPI(_mm256_add_##EPI( \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&prev[mrefs]), c)), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&prev[prefs]), e))), 1); \
+    __m256i temporal_diff2 = _mm256_srai_##EPI(_mm256_add_##EPI( \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&next[mrefs]), c)), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&next[prefs]), e))), 1); \
+    __m256i diff = _mm256_max_##EPI(_mm256_max_##EPI( \
+        _mm256_srai_##EPI(temporal_diff0, 1), temporal_diff1), temporal_diff2); \
+    __m256i spatial_pred = _mm256_srai_##EPI(_mm256_add_##EPI(c, e), 1); \
+    __m256i spatial_score = _mm256_sub_##EPI(_mm256_add_##EPI(_mm256_add_##EPI( \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&cur[mrefs-1]), LOAD(&cur[prefs-1]))), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(c, e))), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&cur[mrefs+1]), LOAD(&cur[prefs+1])))), \
+        one); \
+    __m256i mask = _mm256_set1_##EPI(-1); \
+    for (int j = -1; j >= -2; j--) YADIF_AVX2_CHECK(LOAD, EPI, j) \
+    mask = _mm256_set1_##EPI(-1); \
+    for (int j = 1; j <= 2; j++) YADIF_AVX2_CHECK(LOAD, EPI, j) \
+ \
+    if (mode < 2) { \
+        __m256i b = _mm256_srai_##EPI(_mm256_add_##EPI(LOAD(&prev2[2*mrefs]), \
+                                                       LOAD(&next2[2*mrefs])), 1); \
+        __m256i f = _mm256_srai_##EPI(_mm256_add_##EPI(LOAD(&prev2[2*prefs]), \
+                                                       LOAD(&next2[2*prefs])), 1); \
+        __m256i de = _mm256_sub_##EPI(d, e); \
+        __m256i dc = _mm256_sub_##EPI(d, c); \
+        __m256i bc = _mm256_sub_##EPI(b, c); \
+        __m256i fe = _mm256_sub_##EPI(f, e); \
+        __m256i max = _mm256_max_##EPI(_mm256_max_##EPI(de, dc), \
+                                       _mm256_min_##EPI(bc, fe)); \
+        __m256i min = _mm256_min_##EPI(_mm256_min_##EPI(de, dc), \
+                                       _mm256_max_##EPI(bc, fe)); \
+        diff = _mm256_max_##EPI(_mm256_max_##EPI(diff, min), \
+                                _mm256_sub_##EPI(zero, max)); \
+    } \
+ \
+    /* diff is positive: clamping is the same as the two comparisons */ \
+    spatial_pred = _mm256_min_##EPI(spatial_pred, _mm256_add_##EPI(d, diff)); \
+    spatial_pred = _mm256_max_##EPI(spatial_pred, _mm256_sub_##EPI(d, diff));
+
+/* The CHECK(-2) and CHECK(2) of FILTER only run if CHECK(-1), respectively
+ * CHECK(1), improved the score: the mask tracks that per pixel. */
+#define YADIF_AVX2_CHECK(LOAD, EPI, j) { \
+    __m256i score = _mm256_add_##EPI(_mm256_add_##EPI( \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&cur[mrefs-1+(j)]), \
+                                          LOAD(&cur[prefs-1-(j)]))), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&cur[mrefs  +(j)]), \
+                                          LOAD(&cur[prefs  -(j)])))), \
+        _mm256_abs_##EPI(_mm256_sub_##EPI(LOAD(&cur[mrefs+1+(j)]), \
+                                          LOAD(&cur[prefs+1-(j)])))); \
+    mask = _mm256_and_si256(mask, _mm256_cmpgt_##EPI(spatial_score, score)); \
+    spatial_score = _mm256_blendv_epi8(spatial_score, score, mask); \
+    spatial_pred = _mm256_blendv_epi8(spatial_pred, _mm256_srai_##EPI( \
+        _mm256_add_##EPI(LOAD(&cur[mrefs+(j)]), LOAD(&cur[prefs-(j)])), 1), \
+        mask); \
+}
+
+#define LOAD8(p)  _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define LOAD16(p) _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(p)))
+
+__attribute__ ((__target__ ("avx2")))
+void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                            uint8_t *next, int w, int prefs, int mrefs,
+                            int parity, int mode)
+{
+    uint8_t *prev2 = parity ? prev : cur ;
+    uint8_t *next2 = parity ? cur  : next;
+    int x;
+
+    for (x = 0; x + 16 <= w; x += 16)
+    {
+        YADIF_AVX2(LOAD8, epi16)
+
+        /* Pack to bytes, then gather the low quadword of each lane */
+        __m256i out = _mm256_packus_epi16(spatial_pred, spatial_pred);
+        out = _mm256_permute4x64_epi64(out, 0x08);
+        _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(out));
+
+        dst += 16; cur += 16; prev += 16; next += 16; prev2 += 16; next2 += 16;
+    }
+
+    if (x < w)
+        yadif_filter_line_c(dst, prev, cur, next, w - x, prefs, mrefs,
+                            parity, mode);
+}
+
+__attribute__ ((__target__ ("avx2")))
+void yadif_filter_line_16bit_avx2(uint8_t *dst8, uint8_t *prev8, uint8_t *cur8,
+                                  uint8_t *next8, int w, int prefs, int mrefs,
+                                  int parity, int mode)
+{
+    uint16_t *dst = (uint16_t *)dst8;
+    uint16_t *prev = (uint16_t *)prev8;
+    uint16_t *cur = (uint16_t *)cur8;
+    uint16_t *next = (uint16_t *)next8;
+    uint16_t *prev2 = parity ? prev : cur ;
+    uint16_t *next2 = parity ? cur  : next;
+    const int prefs8 = prefs, mrefs8 = mrefs;
+    int x;
+
+    mrefs /= 2;
+    prefs /= 2;
+    for (x = 0; x + 8 <= w; x += 8)
+    {
+        YADIF_AVX2(LOAD16, epi32)
+
+        __m256i out = _mm256_packus_epi32(spatial_pred, spatial_pred);
+        out = _mm256_permute4x64_epi64(out, 0x08);
+        _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(out));
+
+        dst += 8; cur += 8; prev += 8; next += 8; prev2 += 8; next2 += 8;
+    }
+
+    if (x < w)
+        yadif_filter_line_c_16bit((uint8_t *)dst, (uint8_t *)prev,
+                                  (uint8_t *)cur, (uint8_t *)next, w - x,
+                                  prefs8, mrefs8, parity, mode);
+}
+#endif
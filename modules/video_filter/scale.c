@@ -83,6 +83,73 @@ static int OpenFilter( vlc_object_t *p_this )
     return VLC_SUCCESS;
 }
 
+#define SHIFT_SIZE 16
+
+/****************************************************************************
+ * ScalePlane: nearest neighbour scaling of one plane
+ ****************************************************************************
+ * The source column of each destination pixel is computed once per plane,
+ * and destination lines mapping to the same source line (upscaling) are
+ * copied from the previous one instead of being resampled again.
+ ****************************************************************************/
+static int ScalePlane( plane_t *p_dst_plane, const plane_t *p_src_plane,
+                       int i_src_width, int i_src_height,
+                       int i_dst_width, int i_dst_height, int i_pixel_size )
+{
+    const int i_src_pitch = p_src_plane->i_pitch;
+    const int i_dst_pitch = p_dst_plane->i_pitch;
+    const int i_dst_visible_lines = p_dst_plane->i_visible_lines;
+    const int i_dst_visible_pitch = p_dst_plane->i_visible_pitch;
+    const int i_dst_pixels = i_dst_visible_pitch / i_pixel_size;
+    const int i_height_coef  = ( i_src_height << SHIFT_SIZE ) / i_dst_height;
+    const int i_width_coef   = ( i_src_width << SHIFT_SIZE ) / i_dst_width;
+    const int i_src_height_1 = i_src_height - 1;
+    const int i_src_width_1  = i_src_width - 1;
+
+    const int i_shift_height = i_dst_height / i_src_height;
+    const int i_shift_width = i_dst_width / i_src_width;
+
+    unsigned *p_columns = vlc_alloc( i_dst_pixels, sizeof(*p_columns) );
+    if( unlikely(p_columns == NULL) )
+        return VLC_ENOMEM;
+
+    int k = 1<<(SHIFT_SIZE-i_shift_width);
+    for( int x = 0; x < i_dst_pixels; x++, k += i_width_coef )
+        p_columns[x] = __MIN( i_src_width_1, k >> SHIFT_SIZE );
+
+    int l = 1<<(SHIFT_SIZE-i_shift_height);
+    int i_prev_line = -1;
+    for( int y = 0; y < i_dst_visible_lines; y++, l += i_height_coef )
+    {
+        const int i_src_line = __MIN( i_src_height_1, l >> SHIFT_SIZE );
+        uint8_t *p_dst = &p_dst_plane->p_pixels[y * i_dst_pitch];
+
+        if( i_src_line == i_prev_line )
+        {
+            memcpy( p_dst, p_dst - i_dst_pitch, i_dst_visible_pitch );
+            continue;
+        }
+        i_prev_line = i_src_line;
+
+        const uint8_t *p_srcl = &p_src_plane->p_pixels[i_src_line * i_src_pitch];
+        if( i_pixel_size == 4 )
+        {
+            const uint32_t *p_src32 = (const uint32_t *)p_srcl;
+            uint32_t *p_dst32 = (uint32_t *)p_dst;
+            for( int x = 0; x < i_dst_pixels; x++ )
+                p_dst32[x] = p_src32[p_columns[x]];
+        }
+        else
+        {
+            for( int x = 0; x < i_dst_pixels; x++ )
+                p_dst[x] = p_srcl[p_columns[x]];
+        }
+    }
+
+    free( p_columns );
+    return VLC_SUCCESS;
+}
+
 /****************************************************************************
  * Filter: the whole thing
  ****************************************************************************/
@@ -103,97 +170,24 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         return NULL;
     }
 
-    if( p_filter->fmt_in.video.i_chroma != VLC_CODEC_RGBA &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_ARGB &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_BGRA &&
-        p_filter->fmt_in.video.i_chroma != VLC_CODEC_RGB32 )
-    {
-        for( int i_plane = 0; i_plane < p_pic_dst->i_planes; i_plane++ )
-        {
-            const int i_src_pitch    = p_pic->p[i_plane].i_pitch;
-            const int i_dst_pitch    = p_pic_dst->p[i_plane].i_pitch;
-            const int i_src_height   = p_filter->fmt_in.video.i_height;
-            const int i_src_width    = p_filter->fmt_in.video.i_width;
-            const int i_dst_height   = p_filter->fmt_out.video.i_height;
-            const int i_dst_width    = p_filter->fmt_out.video.i_width;
-            const int i_dst_visible_lines =
-                                       p_pic_dst->p[i_plane].i_visible_lines;
-            const int i_dst_visible_pitch =
-                                       p_pic_dst->p[i_plane].i_visible_pitch;
-            const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-#define SHIFT_SIZE 16
-            const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                       / i_dst_height;
-            const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                       / i_dst_width;
-            const int i_src_height_1 = i_src_height - 1;
-            const int i_src_width_1  = i_src_width - 1;
-
-            uint8_t *p_src = p_pic->p[i_plane].p_pixels;
-            uint8_t *p_dst = p_pic_dst->p[i_plane].p_pixels;
-            uint8_t *p_dstendline = p_dst + i_dst_visible_pitch;
-            const uint8_t *p_dstend = p_dst + i_dst_visible_lines*i_dst_pitch;
-
-            const int i_shift_height = i_dst_height / i_src_height;
-            const int i_shift_width = i_dst_width / i_src_width;
-
-            int l = 1<<(SHIFT_SIZE-i_shift_height);
-            for( ; p_dst < p_dstend;
-                 p_dst += i_dst_hidden_pitch,
-                 p_dstendline += i_dst_pitch, l += i_height_coef )
-            {
-                int k = 1<<(SHIFT_SIZE-i_shift_width);
-                uint8_t *p_srcl = p_src
-                       + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*i_src_pitch);
-
-                for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-                {
-                    *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-                }
-            }
-        }
-    }
-    else /* RGBA */
+    const bool b_rgba = p_filter->fmt_in.video.i_chroma == VLC_CODEC_RGBA ||
+                        p_filter->fmt_in.video.i_chroma == VLC_CODEC_ARGB ||
+                        p_filter->fmt_in.video.i_chroma == VLC_CODEC_BGRA ||
+                        p_filter->fmt_in.video.i_chroma == VLC_CODEC_RGB32;
+    const int i_planes = b_rgba ? 1 : p_pic_dst->i_planes;
+
+    for( int i_plane = 0; i_plane < i_planes; i_plane++ )
     {
-        const int i_src_pitch = p_pic->p->i_pitch;
-        const int i_dst_pitch = p_pic_dst->p->i_pitch;
-        const int i_src_height   = p_filter->fmt_in.video.i_height;
-        const int i_src_width    = p_filter->fmt_in.video.i_width;
-        const int i_dst_height   = p_filter->fmt_out.video.i_height;
-        const int i_dst_width    = p_filter->fmt_out.video.i_width;
-        const int i_dst_visible_lines =
-                                   p_pic_dst->p->i_visible_lines;
-        const int i_dst_visible_pitch =
-                                   p_pic_dst->p->i_visible_pitch;
-        const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-        const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                   / i_dst_height;
-        const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                   / i_dst_width;
-        const int i_src_height_1 = i_src_height - 1;
-        const int i_src_width_1  = i_src_width - 1;
-
-        uint32_t *p_src = (uint32_t*)p_pic->p->p_pixels;
-        uint32_t *p_dst = (uint32_t*)p_pic_dst->p->p_pixels;
-        uint32_t *p_dstendline = p_dst + (i_dst_visible_pitch>>2);
-        const uint32_t *p_dstend = p_dst + i_dst_visible_lines*(i_dst_pitch>>2);
-
-        const int i_shift_height = i_dst_height / i_src_height;
-        const int i_shift_width = i_dst_width / i_src_width;
-
-        int l = 1<<(SHIFT_SIZE-i_shift_height);
-        for( ; p_dst < p_dstend;
-             p_dst += (i_dst_hidden_pitch>>2),
-             p_dstendline += (i_dst_pitch>>2),
-             l += i_height_coef )
+        if( ScalePlane( &p_pic_dst->p[i_plane], &p_pic->p[i_plane],
+                        p_filter->fmt_in.video.i_width,
+                        p_filter->fmt_in.video.i_height,
+                        p_filter->fmt_out.video.i_width,
+                        p_filter->fmt_out.video.i_height,
+                        b_rgba ? 4 : 1 ) )
         {
-            int k = 1<<(SHIFT_SIZE-i_shift_width);
-            uint32_t *p_srcl = p_src
-                    + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*(i_src_pitch>>2));
-            for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-            {
-                *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-            }
+            picture_Release( p_pic_dst );
+            picture_Release( p_pic );
+            return NULL;
         }
     }
 
@@ -31,7 +31,9 @@
 #endif
 
 #include <vlc_fixups.h>
+#include <atomic>
 #include <cinttypes>
+#include <new>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -631,6 +633,70 @@ error:
 /*****************************************************************************
  * Video
  *****************************************************************************/
+namespace {
+
+/* Scheduled 8-bit frame using the picture memory, to avoid a copy */
+class PictureVideoFrame : public IDeckLinkVideoFrame
+{
+public:
+    PictureVideoFrame(picture_t *pic, long width, long height)
+        : pic_(picture_Hold(pic)), width_(width), height_(height)
+    {
+        ref_.store(1);
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID *) { return E_NOINTERFACE; }
+
+    virtual ULONG STDMETHODCALLTYPE AddRef(void)
+    {
+        return ref_.fetch_add(1) + 1;
+    }
+
+    virtual ULONG STDMETHODCALLTYPE Release(void)
+    {
+        ULONG new_ref = ref_.fetch_sub(1) - 1;
+        if (new_ref == 0)
+            delete this;
+        return new_ref;
+    }
+
+    virtual long STDMETHODCALLTYPE GetWidth(void) { return width_; }
+    virtual long STDMETHODCALLTYPE GetHeight(void) { return height_; }
+    virtual long STDMETHODCALLTYPE GetRowBytes(void) { return pic_->p[0].i_pitch; }
+    virtual BMDPixelFormat STDMETHODCALLTYPE GetPixelFormat(void) { return bmdFormat8BitYUV; }
+    virtual BMDFrameFlags STDMETHODCALLTYPE GetFlags(void) { return bmdFrameFlagDefault; }
+
+    virtual HRESULT STDMETHODCALLTYPE GetBytes(void **buffer)
+    {
+        *buffer = pic_->p[0].p_pixels;
+        return S_OK;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE GetTimecode(BMDTimecodeFormat, IDeckLinkTimecode **timecode)
+    {
+        *timecode = NULL;
+        return S_FALSE;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE GetAncillaryData(IDeckLinkVideoFrameAncillary **ancillary)
+    {
+        *ancillary = NULL;
+        return S_FALSE;
+    }
+
+private:
+    virtual ~PictureVideoFrame()
+    {
+        picture_Release(pic_);
+    }
+
+    std::atomic<ULONG> ref_;
+    picture_t *pic_;
+    long width_, height_;
+};
+
+} // namespace
+
 static void PrepareVideo(vout_display_t *vd, picture_t *picture, subpicture_t *,
                          vlc_tick_t date)
 {
@@ -671,20 +737,30 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, subpicture_t *,
     w = vd->fmt.i_width;
     h = vd->fmt.i_height;
 
-    IDeckLinkMutableVideoFrame *pDLVideoFrame;
+    IDeckLinkVideoFrame *pDLVideoFrame;
+    IDeckLinkMutableVideoFrame *pDLMutableFrame;
+
+    /* 8-bit pictures with the row alignment of the card are sent as is */
+    if (!sys->video.tenbits && picture->p[0].i_pitch == w * 2) {
+        pDLVideoFrame = new (std::nothrow) PictureVideoFrame(picture, w, h);
+        if (pDLVideoFrame != NULL)
+            goto schedule;
+    }
+
     result = sys->p_output->CreateVideoFrame(w, h, w*3,
         sys->video.tenbits ? bmdFormat10BitYUV : bmdFormat8BitYUV,
-        bmdFrameFlagDefault, &pDLVideoFrame);
+        bmdFrameFlagDefault, &pDLMutableFrame);
 
     if (result != S_OK) {
         msg_Err(vd, "Failed to create video frame: 0x%X", result);
         pDLVideoFrame = NULL;
         goto end;
     }
+    pDLVideoFrame = pDLMutableFrame;
 
     void *frame_bytes;
-    pDLVideoFrame->GetBytes((void**)&frame_bytes);
-    stride = pDLVideoFrame->GetRowBytes();
+    pDLMutableFrame->GetBytes((void**)&frame_bytes);
+    stride = pDLMutableFrame->GetRowBytes();
 
     if (sys->video.tenbits) {
         IDeckLinkVideoFrameAncillary *vanc;
@@ -710,7 +786,7 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, subpicture_t *,
 
         sdi::V210::Convert(picture, stride, frame_bytes);
 
-        result = pDLVideoFrame->SetAncillaryData(vanc);
+        result = pDLMutableFrame->SetAncillaryData(vanc);
         vanc->Release();
         if (result != S_OK) {
             msg_Err(vd, "Failed to set vanc: %d", result);
@@ -724,6 +800,7 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, subpicture_t *,
         memcpy(dst, src, w * 2 /* bpp */);
     }
 
+schedule:
 
     // compute frame duration in CLOCK_FREQ units
     length = (sys->frameduration * CLOCK_FREQ) / sys->timescale;
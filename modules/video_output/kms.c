@@ -44,6 +44,11 @@
 #include <vlc_picture_pool.h>
 #include <vlc_fs.h>
 
+#ifdef HAVE_KMS_VAAPI
+# include <va/va_drmcommon.h>
+# include "../hw/vaapi/vlc_vaapi.h"
+#endif
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -59,6 +64,10 @@
 #define DRM_CHROMA_TEXT "Image format used by DRM"
 #define DRM_CHROMA_LONGTEXT "Chroma fourcc override for DRM framebuffer format selection"
 
+#define VAAPI_TEXT "Direct VA-API scanout"
+#define VAAPI_LONGTEXT "Display VA-API decoded surfaces directly on a DRM " \
+    "plane, without copying them"
+
 /*
  * how many hw buffers are allocated for page flipping. I think
  * 3 is enough so we shouldn't get unexpected stall from kernel.
@@ -100,6 +109,18 @@ struct vout_display_sys_t {
  * other generic stuff
  */
     int             drm_fd;
+
+#ifdef HAVE_KMS_VAAPI
+/*
+ * VA-API surfaces imported as framebuffers, one per surface of the pool
+ */
+    VADisplay       vadpy;
+    vlc_decoder_device *dec_device;
+    VASurfaceID     *va_surface_ids;
+    uint32_t        *va_fbs;
+    unsigned        va_count;
+    picture_t       *va_displayed;
+#endif
 };
 
 typedef struct {
@@ -656,6 +677,122 @@ static picture_pool_t *Pool(vout_display_t *vd, unsigned count)
 }
 
 
+#ifdef HAVE_KMS_VAAPI
+static picture_pool_t *PoolVaapi(vout_display_t *vd, unsigned count)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    if (sys->pool)
+        return sys->pool;
+
+    sys->va_fbs = calloc(count, sizeof(*sys->va_fbs));
+    if (sys->va_fbs == NULL)
+        return NULL;
+
+    sys->pool = vlc_vaapi_PoolNew(VLC_OBJECT(vd), sys->dec_device, sys->vadpy,
+                                  count, &sys->va_surface_ids, &vd->fmt, true);
+    if (sys->pool == NULL) {
+        free(sys->va_fbs);
+        sys->va_fbs = NULL;
+        return NULL;
+    }
+    sys->va_count = count;
+    return sys->pool;
+}
+
+/*
+ * Wraps the DRM PRIME buffer of a decoded surface into a framebuffer, so that
+ * the plane scans it out directly.
+ */
+static uint32_t ImportVaapiFB(vout_display_t *vd, VASurfaceID surface)
+{
+    vout_display_sys_t *sys = vd->sys;
+    vlc_object_t *o = VLC_OBJECT(vd);
+    uint32_t fb = 0;
+
+    VAImage va_image;
+    if (vlc_vaapi_DeriveImage(o, sys->vadpy, surface, &va_image))
+        return 0;
+
+    VABufferInfo va_buffer_info = {
+        .mem_type = VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME
+    };
+    if (vlc_vaapi_AcquireBufferHandle(o, sys->vadpy, va_image.buf,
+                                      &va_buffer_info))
+        goto end;
+
+    uint32_t handle;
+    if (drmPrimeFDToHandle(sys->drm_fd, va_buffer_info.handle, &handle)) {
+        msg_Err(vd, "Cannot import DRM PRIME buffer");
+        goto release;
+    }
+
+    uint32_t handles[4] = {0,0,0,0}, pitches[4] = {0,0,0,0},
+             offsets[4] = {0,0,0,0};
+    for (unsigned i = 0; i < va_image.num_planes && i < 4; i++) {
+        handles[i] = handle;
+        pitches[i] = va_image.pitches[i];
+        offsets[i] = va_image.offsets[i];
+    }
+
+    if (drmModeAddFB2(sys->drm_fd, va_image.width, va_image.height,
+                      sys->drm_fourcc, handles, pitches, offsets, &fb, 0)) {
+        msg_Err(vd, "Cannot create frame buffer from VA surface %u",
+                (unsigned) surface);
+        fb = 0;
+    }
+
+    /* The framebuffer keeps its own reference on the buffer object */
+    struct drm_gem_close close_req = { .handle = handle };
+    drmIoctl(sys->drm_fd, DRM_IOCTL_GEM_CLOSE, &close_req);
+
+release:
+    vlc_vaapi_ReleaseBufferHandle(o, sys->vadpy, va_image.buf);
+end:
+    vlc_vaapi_DestroyImage(o, sys->vadpy, va_image.image_id);
+    return fb;
+}
+
+static void DisplayVaapi(vout_display_t *vd, picture_t *picture)
+{
+    vout_display_sys_t *sys = vd->sys;
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(picture);
+    unsigned idx;
+
+    for (idx = 0; idx < sys->va_count; idx++)
+        if (sys->va_surface_ids[idx] == surface)
+            break;
+    if (idx == sys->va_count) {
+        msg_Warn(vd, "VA surface %u not from our pool", (unsigned) surface);
+        return;
+    }
+
+    if (sys->va_fbs[idx] == 0) {
+        sys->va_fbs[idx] = ImportVaapiFB(vd, surface);
+        if (sys->va_fbs[idx] == 0)
+            return;
+    }
+
+    const video_format_t *fmt = &picture->format;
+    if (drmModeSetPlane(sys->drm_fd, sys->plane_id, sys->crtc,
+                        sys->va_fbs[idx], 0,
+                        0, 0, sys->width, sys->height,
+                        fmt->i_x_offset << 16, fmt->i_y_offset << 16,
+                        fmt->i_visible_width << 16,
+                        fmt->i_visible_height << 16)) {
+        msg_Err(vd, "Cannot do set plane for plane id %u, fb %x",
+                sys->plane_id, sys->va_fbs[idx]);
+        return;
+    }
+
+    /* Keep the scanned out surface away from the decoder until it is
+     * replaced on the plane */
+    if (sys->va_displayed != NULL)
+        picture_Release(sys->va_displayed);
+    sys->va_displayed = picture_Hold(picture);
+}
+#endif
+
 static void Display(vout_display_t *vd, picture_t *picture)
 {
     VLC_UNUSED(picture);
@@ -687,11 +824,35 @@ static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
 
+#ifdef HAVE_KMS_VAAPI
+    if (sys->vadpy != NULL) {
+        if (sys->va_displayed != NULL)
+            picture_Release(sys->va_displayed);
+        for (unsigned i = 0; i < sys->va_count; i++)
+            if (sys->va_fbs[i] != 0)
+                drmModeRmFB(sys->drm_fd, sys->va_fbs[i]);
+        free(sys->va_fbs);
+
+        /* The dumb buffers are not owned by any picture in this mode */
+        if (sys->drm_fd) {
+            for (int c = 0; c < MAXHWBUF; c++)
+                DestroyFB(sys, c);
+            drmSetClientCap(sys->drm_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 0);
+        }
+    }
+#endif
+
     if (sys->pool)
         picture_pool_Release(sys->pool);
 
     if (sys->drm_fd)
         drmDropMaster(sys->drm_fd);
+#ifdef HAVE_KMS_VAAPI
+    if (sys->vadpy != NULL && sys->drm_fd) {
+        vlc_close(sys->drm_fd);
+        sys->drm_fd = 0;
+    }
+#endif
 }
 
 /**
@@ -752,21 +913,62 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
         chroma = NULL;
     }
 
+#ifdef HAVE_KMS_VAAPI
+    /*
+     * Scan VA-API decoded surfaces out directly from an overlay plane: no
+     * copy to a dumb buffer, and the plane does the scaling.
+     */
+    if (context != NULL && context->device != NULL
+     && context->device->type == VLC_DECODER_DEVICE_VAAPI
+     && vlc_vaapi_IsChromaOpaque(fmtp->i_chroma)
+     && var_InheritBool(vd, "kms-vaapi")) {
+        uint32_t va_drm_fourcc = 0;
+        switch (fmtp->i_chroma) {
+            case VLC_CODEC_VAAPI_420:
+                va_drm_fourcc = DRM_FORMAT_NV12;
+                break;
+#ifdef DRM_FORMAT_P010
+            case VLC_CODEC_VAAPI_420_10BPP:
+                va_drm_fourcc = DRM_FORMAT_P010;
+                break;
+#endif
+        }
+        if (va_drm_fourcc != 0) {
+            sys->forced_drm_fourcc = true;
+            sys->drm_fourcc = va_drm_fourcc;
+            sys->vadpy = context->device->opaque;
+            sys->dec_device = context->device;
+        }
+    }
+#endif
+
     if (OpenDisplay(vd) != VLC_SUCCESS) {
         Close(vd);
         return VLC_EGENERIC;
     }
 
-    video_format_ApplyRotation(&fmt, fmtp);
+    vd->pool    = Pool;
+    vd->display = Display;
 
-    fmt.i_width = fmt.i_visible_width  = sys->width;
-    fmt.i_height = fmt.i_visible_height = sys->height;
-    fmt.i_chroma = sys->vlc_fourcc;
-    *fmtp = fmt;
+#ifdef HAVE_KMS_VAAPI
+    if (sys->vadpy != NULL) {
+        msg_Dbg(vd, "Scanning out VA-API surfaces on plane %u",
+                sys->plane_id);
+        vd->pool    = PoolVaapi;
+        vd->display = DisplayVaapi;
+    }
+    else
+#endif
+    {
+        video_format_ApplyRotation(&fmt, fmtp);
+
+        fmt.i_width = fmt.i_visible_width  = sys->width;
+        fmt.i_height = fmt.i_visible_height = sys->height;
+        fmt.i_chroma = sys->vlc_fourcc;
+        *fmtp = fmt;
+    }
 
-    vd->pool    = Pool;
     vd->prepare = NULL;
-    vd->display = Display;
     vd->control = Control;
     vd->close = Close;
 
@@ -788,6 +990,9 @@ vlc_module_begin ()
                 true)
     add_string( "kms-drm-chroma", NULL, DRM_CHROMA_TEXT, DRM_CHROMA_LONGTEXT,
                 true)
+#ifdef HAVE_KMS_VAAPI
+    add_bool( "kms-vaapi", true, VAAPI_TEXT, VAAPI_LONGTEXT, true)
+#endif
     set_description("Linux kernel mode setting video output")
     set_callback_display(Open, 30)
 vlc_module_end ()
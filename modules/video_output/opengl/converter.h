@@ -128,6 +128,11 @@ typedef void (APIENTRY *PFNGLVIEWPORTPROC) (GLint x, GLint y, GLsizei width, GLs
 #   define PFNGLBUFFERSUBDATAPROC            typeof(glBufferSubData)*
 #   define PFNGLDELETEBUFFERSPROC            typeof(glDeleteBuffers)*
 #   define PFNGLGETFRAMEBUFFERATTACHMENTPARAMETERIVPROC typeof(glGetFramebufferAttachmentParameteriv)*
+#   define PFNGLGENFRAMEBUFFERSPROC          typeof(glGenFramebuffers)*
+#   define PFNGLBINDFRAMEBUFFERPROC          typeof(glBindFramebuffer)*
+#   define PFNGLFRAMEBUFFERTEXTURE2DPROC     typeof(glFramebufferTexture2D)*
+#   define PFNGLCHECKFRAMEBUFFERSTATUSPROC   typeof(glCheckFramebufferStatus)*
+#   define PFNGLDELETEFRAMEBUFFERSPROC       typeof(glDeleteFramebuffers)*
 #if defined(__APPLE__)
 #   import <CoreFoundation/CoreFoundation.h>
 #endif
@@ -228,6 +233,11 @@ typedef struct {
 
     /* Framebuffers commands */
     PFNGLGETFRAMEBUFFERATTACHMENTPARAMETERIVPROC GetFramebufferAttachmentParameteriv;
+    PFNGLGENFRAMEBUFFERSPROC        GenFramebuffers; /* can be NULL */
+    PFNGLBINDFRAMEBUFFERPROC        BindFramebuffer; /* can be NULL */
+    PFNGLFRAMEBUFFERTEXTURE2DPROC   FramebufferTexture2D; /* can be NULL */
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus; /* can be NULL */
+    PFNGLDELETEFRAMEBUFFERSPROC     DeleteFramebuffers; /* can be NULL */
 
     /* Commands used for PBO and/or Persistent mapping */
     PFNGLBUFFERSUBDATAPROC          BufferSubData; /* can be NULL */
@@ -323,6 +333,7 @@ struct opengl_tex_converter_t
         GLint Coefficients;
         GLint FillColor;
         GLint *pl_vars; /* for pl_sh_res */
+        GLint Lut;
     } uloc;
     bool yuv_color;
     GLfloat yuv_coefficients[16];
@@ -330,6 +341,12 @@ struct opengl_tex_converter_t
     struct pl_shader *pl_sh;
     const struct pl_shader_res *pl_sh_res;
 
+    /* 3D LUT of the colour mapping, laid out as lut_size slices of
+     * lut_size x lut_size texels side by side in a GL_TEXTURE_2D. If not 0,
+     * it replaces the colour mapping of pl_sh_res. */
+    GLuint lut_texture;
+    unsigned lut_size;
+
     /* Private context */
     void *priv;
 
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include <vlc_common.h>
+#include <vlc_picture_pool.h>
 #include "internal.h"
 
 #ifndef GL_UNPACK_ROW_LENGTH
@@ -39,13 +40,38 @@
 #ifndef GL_DYNAMIC_DRAW
 # define GL_DYNAMIC_DRAW 0x88E8
 #endif
+#ifndef GL_MAP_WRITE_BIT
+# define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+# define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+# define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+# define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+# define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+# define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+# define GL_CONDITION_SATISFIED 0x911C
+#endif
 
 #define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PERSISTENT_PICS_MAX 64 /* Bits of the in-use mask */
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLDELETESYNCPROC DeleteSync;
     GLuint      buffers[PICTURE_PLANE_MAX];
     size_t      bytes[PICTURE_PLANE_MAX];
+    GLsync      fence;
+    unsigned    index;
 } picture_sys_t;
 
 struct priv
@@ -57,6 +83,13 @@ struct priv
         picture_t *display_pics[PBO_DISPLAY_COUNT];
         size_t display_idx;
     } pbo;
+    struct {
+        /* Pictures of the pool, and the ones held while being uploaded */
+        picture_sys_t *sys[PERSISTENT_PICS_MAX];
+        picture_t *held[PERSISTENT_PICS_MAX];
+        unsigned count;
+        uint64_t held_mask;
+    } persistent;
 };
 
 static void
@@ -64,6 +97,8 @@ pbo_picture_destroy(picture_t *pic)
 {
     picture_sys_t *picsys = pic->p_sys;
 
+    if (picsys->fence != NULL)
+        picsys->DeleteSync(picsys->fence);
     picsys->DeleteBuffers(pic->i_planes, picsys->buffers);
 
     free(picsys);
@@ -89,6 +124,7 @@ pbo_picture_create(const opengl_tex_converter_t *tc)
 
     tc->vt->GenBuffers(pic->i_planes, picsys->buffers);
     picsys->DeleteBuffers = tc->vt->DeleteBuffers;
+    picsys->DeleteSync = tc->vt->DeleteSync;
 
     /* XXX: needed since picture_NewFromResource override pic planes */
     if (picture_Setup(pic, &tc->fmt))
@@ -198,6 +234,182 @@ tc_pbo_update(const opengl_tex_converter_t *tc, GLuint *textures,
     return VLC_SUCCESS;
 }
 
+static int
+persistent_map(const opengl_tex_converter_t *tc, picture_t *pic)
+{
+    picture_sys_t *picsys = pic->p_sys;
+
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                              GL_MAP_COHERENT_BIT;
+    for (int i = 0; i < pic->i_planes; ++i)
+    {
+        tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, picsys->buffers[i]);
+        tc->vt->BufferStorage(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i], NULL,
+                              access);
+
+        pic->p[i].p_pixels =
+            tc->vt->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, picsys->bytes[i],
+                                   access);
+
+        if (pic->p[i].p_pixels == NULL)
+        {
+            msg_Err(tc->gl, "could not map PBO buffers");
+            for (i = i - 1; i >= 0; --i)
+            {
+                tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                                   picsys->buffers[i]);
+                tc->vt->UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+            tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return VLC_EGENERIC;
+        }
+    }
+    tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return VLC_SUCCESS;
+}
+
+/* Gives back to the decoder the pictures the GPU is done reading from */
+static void
+persistent_release_gpupics(const opengl_tex_converter_t *tc, bool force)
+{
+    struct priv *priv = tc->priv;
+
+    uint64_t mask = priv->persistent.held_mask;
+    while (mask != 0)
+    {
+        const unsigned i = ctz(mask);
+        mask &= ~(UINT64_C(1) << i);
+
+        picture_t *pic = priv->persistent.held[i];
+        picture_sys_t *picsys = pic->p_sys;
+
+        assert(picsys->fence != NULL);
+        GLenum wait = tc->vt->ClientWaitSync(picsys->fence,
+                                             force ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                             force ? UINT64_MAX : 0);
+        if (force || wait == GL_ALREADY_SIGNALED
+         || wait == GL_CONDITION_SATISFIED)
+        {
+            tc->vt->DeleteSync(picsys->fence);
+            picsys->fence = NULL;
+
+            priv->persistent.held_mask &= ~(UINT64_C(1) << i);
+            priv->persistent.held[i] = NULL;
+            picture_Release(pic);
+        }
+    }
+}
+
+static int
+tc_common_update(const opengl_tex_converter_t *tc, GLuint *textures,
+                 const GLsizei *tex_width, const GLsizei *tex_height,
+                 picture_t *pic, const size_t *plane_offset);
+
+static int
+tc_persistent_update(const opengl_tex_converter_t *tc, GLuint *textures,
+                     const GLsizei *tex_width, const GLsizei *tex_height,
+                     picture_t *pic, const size_t *plane_offset)
+{
+    (void) plane_offset; assert(plane_offset == NULL);
+    struct priv *priv = tc->priv;
+    picture_sys_t *picsys = NULL;
+
+    for (unsigned i = 0; i < priv->persistent.count; i++)
+        if (priv->persistent.sys[i] == pic->p_sys)
+        {
+            picsys = pic->p_sys;
+            break;
+        }
+
+    if (picsys == NULL)
+    {
+        /* Not decoded into our pool (filtered or converted picture) */
+        return tc_common_update(tc, textures, tex_width, tex_height, pic, NULL);
+    }
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, picsys->buffers[i]);
+
+        tc->vt->ActiveTexture(GL_TEXTURE0 + i);
+        tc->vt->BindTexture(tc->tex_target, textures[i]);
+
+        tc->vt->PixelStorei(GL_UNPACK_ROW_LENGTH, pic->p[i].i_pitch
+            * tex_width[i] / (pic->p[i].i_visible_pitch ? pic->p[i].i_visible_pitch : 1));
+
+        tc->vt->TexSubImage2D(tc->tex_target, 0, 0, 0, tex_width[i], tex_height[i],
+                              tc->texs[i].format, tc->texs[i].type, NULL);
+    }
+
+    /* turn off pbo */
+    tc->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    /* Hold the picture until the GPU is done with the transfer, so that the
+     * decoder does not overwrite the buffers while they are read */
+    const unsigned index = picsys->index;
+    if (picsys->fence != NULL)
+        tc->vt->DeleteSync(picsys->fence);
+    picsys->fence = tc->vt->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    if (priv->persistent.held[index] != NULL)
+        picture_Release(priv->persistent.held[index]);
+    priv->persistent.held[index] = picture_Hold(pic);
+    priv->persistent.held_mask |= UINT64_C(1) << index;
+
+    persistent_release_gpupics(tc, false);
+
+    return VLC_SUCCESS;
+}
+
+static picture_pool_t *
+tc_persistent_get_pool(const opengl_tex_converter_t *tc, unsigned requested_count)
+{
+    struct priv *priv = tc->priv;
+    picture_t *pictures[PERSISTENT_PICS_MAX];
+    unsigned count;
+
+    /* Held pictures are not given back to the pool, ask for spares */
+    requested_count *= 2;
+    if (requested_count > PERSISTENT_PICS_MAX)
+        requested_count = PERSISTENT_PICS_MAX;
+
+    for (count = 0; count < requested_count; count++)
+    {
+        picture_t *pic = pbo_picture_create(tc);
+        if (pic == NULL)
+            break;
+        if (persistent_map(tc, pic) != VLC_SUCCESS)
+        {
+            picture_Release(pic);
+            break;
+        }
+
+        picture_sys_t *picsys = pic->p_sys;
+        picsys->index = count;
+        priv->persistent.sys[count] = picsys;
+        pictures[count] = pic;
+    }
+
+    if (count == 0)
+        goto error;
+
+    picture_pool_t *pool = picture_pool_New(count, pictures);
+    if (!pool)
+        goto error;
+
+    priv->persistent.count = count;
+    msg_Dbg(tc->gl, "persistent mapped pool of %u pictures", count);
+    return pool;
+
+error:
+    for (unsigned i = 0; i < count; i++)
+    {
+        picture_Release(pictures[i]);
+        priv->persistent.sys[i] = NULL;
+    }
+    return NULL;
+}
+
 static int
 tc_common_allocate_textures(const opengl_tex_converter_t *tc, GLuint *textures,
                             const GLsizei *tex_width, const GLsizei *tex_height)
@@ -373,9 +585,23 @@ opengl_tex_converter_generic_init(opengl_tex_converter_t *tc, bool allow_dr)
             (vlc_gl_StrHasToken(tc->glexts, "GL_ARB_pixel_buffer_object") ||
              vlc_gl_StrHasToken(tc->glexts, "GL_EXT_pixel_buffer_object"));
 
+        const bool has_bs = has_pbo &&
+            (vlc_gl_StrHasToken(tc->glexts, "GL_ARB_buffer_storage") ||
+             vlc_gl_StrHasToken(tc->glexts, "GL_EXT_buffer_storage"));
+
+        const bool supports_persistent = has_bs && tc->vt->BufferStorage
+            && tc->vt->MapBufferRange && tc->vt->UnmapBuffer
+            && tc->vt->FenceSync && tc->vt->DeleteSync
+            && tc->vt->ClientWaitSync;
         const bool supports_pbo = has_pbo && tc->vt->BufferData
             && tc->vt->BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(tc) == VLC_SUCCESS)
+        if (supports_persistent)
+        {
+            tc->pf_get_pool = tc_persistent_get_pool;
+            tc->pf_update   = tc_persistent_update;
+            msg_Dbg(tc->gl, "Persistent mapped buffers enabled");
+        }
+        else if (supports_pbo && pbo_pics_alloc(tc) == VLC_SUCCESS)
         {
             tc->pf_update  = tc_pbo_update;
             msg_Dbg(tc->gl, "PBO support enabled");
@@ -391,6 +617,7 @@ void
 opengl_tex_converter_generic_deinit(opengl_tex_converter_t *tc)
 {
     struct priv *priv = tc->priv;
+    persistent_release_gpupics(tc, true);
     for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
         picture_Release(priv->pbo.display_pics[i]);
     free(priv->texture_temp_buf);
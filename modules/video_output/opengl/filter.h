@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * filter.h: OpenGL filters API
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_OPENGL_FILTER_H
+#define VLC_OPENGL_FILTER_H
+
+#include "converter.h"
+
+/*
+ * An "opengl filter" module provides a fragment shader, which the OpenGL
+ * video output runs on the decoded picture before displaying it, so that
+ * hardware decoded pictures can be processed without leaving the GPU.
+ *
+ * The picture is first converted to an RGBA texture, with the size of the
+ * visible area of the picture and the top row first. Each filter then renders
+ * a quad covering its whole output (same size as the input), reading the
+ * output of the previous filter.
+ *
+ * The chain prepends the following to the fragment shader of the module:
+ *
+ *   #version <glsl_version>
+ *   <glsl_precision_header>
+ *   uniform sampler2D Texture;   // input texture, linear filtering
+ *   uniform vec2 TexelSize;      // size of one input pixel in Texture space
+ *   varying vec2 TexCoord;       // center of the output pixel
+ *
+ * and the module shall define main(), writing gl_FragColor.
+ */
+
+/**
+ * Properties of the picture being filtered
+ */
+struct vlc_gl_filter_input
+{
+    unsigned width;
+    unsigned height;
+    bool progressive;
+};
+
+struct vlc_gl_filter
+{
+    struct vlc_object_t obj;
+    module_t *module;
+
+    /* Set by the caller */
+    const opengl_vtable_t *vt;
+    unsigned glsl_version;
+    const char *glsl_precision_header;
+    const config_chain_t *config;
+
+    /* Set by the module */
+
+    /** Fragment shader code, see above (must be valid until close) */
+    const char *shader;
+
+    /**
+     * Called once the program is linked, to fetch the uniform locations of
+     * the module (can be NULL).
+     */
+    int (*fetch_locations)(struct vlc_gl_filter *, GLuint program);
+
+    /**
+     * Called before each draw, with the program in use, to set the uniforms
+     * of the module (can be NULL).
+     *
+     * \return false to skip the filter for this picture
+     */
+    bool (*prepare)(struct vlc_gl_filter *,
+                    const struct vlc_gl_filter_input *);
+
+    /** Called on destruction (can be NULL) */
+    void (*close)(struct vlc_gl_filter *);
+
+    void *sys;
+};
+
+/** Probe function of "opengl filter" modules */
+typedef int (*vlc_gl_filter_open_fn)(struct vlc_gl_filter *);
+
+#endif
@@ -0,0 +1,272 @@
+/*****************************************************************************
+ * filter_basic.c: basic OpenGL filters
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include "filter.h"
+
+static int OpenAdjust(struct vlc_gl_filter *);
+static int OpenSharpen(struct vlc_gl_filter *);
+static int OpenDeinterlace(struct vlc_gl_filter *);
+
+#define ADJUST_PREFIX "gladjust-"
+#define SHARPEN_PREFIX "glsharpen-"
+
+static const char *const adjust_options[] = {
+    "contrast", "brightness", "hue", "saturation", "gamma", NULL
+};
+
+static const char *const sharpen_options[] = {
+    "sigma", NULL
+};
+
+vlc_module_begin()
+    set_shortname(N_("OpenGL filters"))
+    set_description(N_("Basic OpenGL video filters"))
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+    set_capability("opengl filter", 0)
+    set_callback(OpenAdjust)
+    add_shortcut("adjust")
+
+    add_float_with_range(ADJUST_PREFIX "contrast", 1.0, 0.0, 2.0,
+                         N_("Image contrast (0-2)"),
+                         N_("Set the image contrast, between 0 and 2. "
+                            "Defaults to 1."), false)
+    add_float_with_range(ADJUST_PREFIX "brightness", 1.0, 0.0, 2.0,
+                         N_("Image brightness (0-2)"),
+                         N_("Set the image brightness, between 0 and 2. "
+                            "Defaults to 1."), false)
+    add_float_with_range(ADJUST_PREFIX "hue", 0, -180., +180.,
+                         N_("Image hue (-180..180)"),
+                         N_("Set the image hue, between -180 and 180. "
+                            "Defaults to 0."), false)
+    add_float_with_range(ADJUST_PREFIX "saturation", 1.0, 0.0, 3.0,
+                         N_("Image saturation (0-3)"),
+                         N_("Set the image saturation, between 0 and 3. "
+                            "Defaults to 1."), false)
+    add_float_with_range(ADJUST_PREFIX "gamma", 1.0, 0.01, 10.0,
+                         N_("Image gamma (0-10)"),
+                         N_("Set the image gamma, between 0.01 and 10. "
+                            "Defaults to 1."), false)
+
+    add_submodule()
+        set_description(N_("OpenGL sharpen filter"))
+        set_capability("opengl filter", 0)
+        set_callback(OpenSharpen)
+        add_shortcut("sharpen")
+        add_float_with_range(SHARPEN_PREFIX "sigma", 0.05, 0.0, 2.0,
+                             N_("Sharpen strength (0-2)"),
+                             N_("Set the Sharpen strength, between 0 and 2. "
+                                "Defaults to 0.05."), false)
+
+    add_submodule()
+        set_description(N_("OpenGL blend deinterlacing filter"))
+        set_capability("opengl filter", 0)
+        set_callback(OpenDeinterlace)
+        add_shortcut("deinterlace")
+vlc_module_end()
+
+/*****************************************************************************
+ * Adjust
+ *****************************************************************************/
+struct adjust_sys
+{
+    float contrast;
+    float brightness;
+    float hue;
+    float saturation;
+    float gamma;
+
+    struct {
+        GLint Contrast;
+        GLint Brightness;
+        GLint HueSaturation;
+        GLint Gamma;
+    } uloc;
+};
+
+/* Same computation as the "adjust" video filter, on BT.601 full range YUV */
+static const char adjust_shader[] =
+    "uniform float Contrast;\n"
+    "uniform float Brightness;\n"
+    "uniform mat2 HueSaturation;\n"
+    "uniform float Gamma;\n"
+    "void main() {\n"
+    "  vec4 rgba = texture2D(Texture, TexCoord);\n"
+    "  float y = dot(rgba.rgb, vec3(0.299, 0.587, 0.114));\n"
+    "  vec2 uv = vec2(dot(rgba.rgb, vec3(-0.168736, -0.331264, 0.5)),\n"
+    "                 dot(rgba.rgb, vec3(0.5, -0.418688, -0.081312)));\n"
+    "  y = clamp((y - 0.5) * Contrast + 0.5 + Brightness - 1.0, 0.0, 1.0);\n"
+    "  y = pow(y, 1.0 / Gamma);\n"
+    "  uv = HueSaturation * uv;\n"
+    "  vec3 rgb = vec3(y + 1.402 * uv.y,\n"
+    "                  y - 0.344136 * uv.x - 0.714136 * uv.y,\n"
+    "                  y + 1.772 * uv.x);\n"
+    "  gl_FragColor = vec4(clamp(rgb, 0.0, 1.0), rgba.a);\n"
+    "}\n";
+
+static int AdjustFetchLocations(struct vlc_gl_filter *filter, GLuint program)
+{
+    struct adjust_sys *sys = filter->sys;
+    const opengl_vtable_t *vt = filter->vt;
+
+#define GET_ULOC(x) do { \
+    sys->uloc.x = vt->GetUniformLocation(program, #x); \
+    if (sys->uloc.x == -1) \
+        return VLC_EGENERIC; \
+} while (0)
+    GET_ULOC(Contrast);
+    GET_ULOC(Brightness);
+    GET_ULOC(HueSaturation);
+    GET_ULOC(Gamma);
+#undef GET_ULOC
+    return VLC_SUCCESS;
+}
+
+static bool AdjustPrepare(struct vlc_gl_filter *filter,
+                          const struct vlc_gl_filter_input *input)
+{
+    struct adjust_sys *sys = filter->sys;
+    const opengl_vtable_t *vt = filter->vt;
+    float hue = sys->hue * (float) M_PI / 180.f;
+    float c = cosf(hue) * sys->saturation;
+    float s = sinf(hue) * sys->saturation;
+    /* Column major rotation of the chroma plane, scaled by the saturation */
+    const GLfloat hue_saturation[] = { c, -s, s, c };
+
+    vt->Uniform1f(sys->uloc.Contrast, sys->contrast);
+    vt->Uniform1f(sys->uloc.Brightness, sys->brightness);
+    vt->UniformMatrix2fv(sys->uloc.HueSaturation, 1, GL_FALSE,
+                         hue_saturation);
+    vt->Uniform1f(sys->uloc.Gamma, sys->gamma);
+    (void) input;
+    return true;
+}
+
+static int OpenAdjust(struct vlc_gl_filter *filter)
+{
+    struct adjust_sys *sys = vlc_obj_malloc(VLC_OBJECT(filter), sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    config_ChainParse(filter, ADJUST_PREFIX, adjust_options, filter->config);
+    sys->contrast = var_CreateGetFloat(filter, ADJUST_PREFIX "contrast");
+    sys->brightness = var_CreateGetFloat(filter, ADJUST_PREFIX "brightness");
+    sys->hue = var_CreateGetFloat(filter, ADJUST_PREFIX "hue");
+    sys->saturation = var_CreateGetFloat(filter, ADJUST_PREFIX "saturation");
+    sys->gamma = var_CreateGetFloat(filter, ADJUST_PREFIX "gamma");
+
+    filter->sys = sys;
+    filter->shader = adjust_shader;
+    filter->fetch_locations = AdjustFetchLocations;
+    filter->prepare = AdjustPrepare;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Sharpen
+ *****************************************************************************/
+struct sharpen_sys
+{
+    float sigma;
+    GLint Sigma;
+};
+
+/* Same kernel as the "sharpen" video filter, on the RGB components */
+static const char sharpen_shader[] =
+    "uniform float Sigma;\n"
+    "void main() {\n"
+    "  vec4 c = texture2D(Texture, TexCoord);\n"
+    "  vec3 sum = vec3(0.0);\n"
+    "  for (int y = -1; y <= 1; y++)\n"
+    "    for (int x = -1; x <= 1; x++)\n"
+    "      if (x != 0 || y != 0)\n"
+    "        sum += texture2D(Texture, TexCoord\n"
+    "                         + vec2(float(x), float(y)) * TexelSize).rgb;\n"
+    "  vec3 diff = clamp(8.0 * c.rgb - sum, -1.0, 1.0);\n"
+    "  gl_FragColor = vec4(clamp(c.rgb + Sigma * diff, 0.0, 1.0), c.a);\n"
+    "}\n";
+
+static int SharpenFetchLocations(struct vlc_gl_filter *filter, GLuint program)
+{
+    struct sharpen_sys *sys = filter->sys;
+
+    sys->Sigma = filter->vt->GetUniformLocation(program, "Sigma");
+    return sys->Sigma != -1 ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static bool SharpenPrepare(struct vlc_gl_filter *filter,
+                           const struct vlc_gl_filter_input *input)
+{
+    struct sharpen_sys *sys = filter->sys;
+
+    filter->vt->Uniform1f(sys->Sigma, sys->sigma);
+    (void) input;
+    return sys->sigma > 0.f;
+}
+
+static int OpenSharpen(struct vlc_gl_filter *filter)
+{
+    struct sharpen_sys *sys = vlc_obj_malloc(VLC_OBJECT(filter), sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    config_ChainParse(filter, SHARPEN_PREFIX, sharpen_options, filter->config);
+    sys->sigma = var_CreateGetFloat(filter, SHARPEN_PREFIX "sigma");
+
+    filter->sys = sys;
+    filter->shader = sharpen_shader;
+    filter->fetch_locations = SharpenFetchLocations;
+    filter->prepare = SharpenPrepare;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Deinterlace
+ *****************************************************************************/
+
+/* Blend each line with the next one, as the "blend" deinterlacing mode */
+static const char deinterlace_shader[] =
+    "void main() {\n"
+    "  vec2 next = TexCoord + vec2(0.0, TexelSize.y);\n"
+    "  gl_FragColor = 0.5 * (texture2D(Texture, TexCoord)\n"
+    "                      + texture2D(Texture, next));\n"
+    "}\n";
+
+static bool DeinterlacePrepare(struct vlc_gl_filter *filter,
+                               const struct vlc_gl_filter_input *input)
+{
+    (void) filter;
+    return !input->progressive;
+}
+
+static int OpenDeinterlace(struct vlc_gl_filter *filter)
+{
+    filter->shader = deinterlace_shader;
+    filter->prepare = DeinterlacePrepare;
+    return VLC_SUCCESS;
+}
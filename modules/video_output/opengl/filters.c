@@ -0,0 +1,453 @@
+/*****************************************************************************
+ * filters.c: OpenGL filter chain
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include "filters.h"
+
+#ifndef GL_FRAMEBUFFER
+# define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+# define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+# define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+# define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+
+struct vlc_gl_filter_priv
+{
+    struct vlc_gl_filter filter;
+    GLuint program;
+    struct {
+        GLint Texture;
+        GLint TexelSize;
+    } uloc;
+    GLint VertexPosition;
+};
+
+struct vlc_gl_filters
+{
+    vlc_gl_t *gl;
+    const opengl_vtable_t *vt;
+
+    struct vlc_gl_filter_priv **filters;
+    size_t count;
+
+    /* Ping-pong buffers: the picture is drawn to the first one, then each
+     * filter reads one and writes to the other */
+    GLuint framebuffers[2];
+    GLuint textures[2];
+    unsigned current;
+
+    struct vlc_gl_filter_input input;
+    unsigned tex_width;
+    unsigned tex_height;
+
+    GLuint vertex_buffer_object; /* quad covering the whole output */
+
+    GLint saved_framebuffer;
+    GLint saved_viewport[4];
+};
+
+static const char vertex_shader_code[] =
+    "attribute vec2 VertexPosition;\n"
+    "varying vec2 TexCoord;\n"
+    "void main() {\n"
+    " TexCoord = (VertexPosition + 1.0) * 0.5;\n"
+    " gl_Position = vec4(VertexPosition, 0.0, 1.0);\n"
+    "}\n";
+
+static const char fragment_shader_header[] =
+    "uniform sampler2D Texture;\n"
+    "uniform vec2 TexelSize;\n"
+    "varying vec2 TexCoord;\n";
+
+static GLuint BuildShader(struct vlc_gl_filters *filters, GLenum type,
+                          const char *code, bool dump)
+{
+    const opengl_vtable_t *vt = filters->vt;
+    GLuint shader = vt->CreateShader(type);
+
+    if (shader == 0)
+        return 0;
+
+    if (dump)
+        msg_Dbg(filters->gl, "\n=== %s shader for filter ===\n%s\n",
+                type == GL_VERTEX_SHADER ? "Vertex" : "Fragment", code);
+
+    vt->ShaderSource(shader, 1, (const char **) &code, NULL);
+    vt->CompileShader(shader);
+
+    int length;
+    vt->GetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    if (length > 1)
+    {
+        char *log = malloc(length);
+        if (log != NULL)
+        {
+            vt->GetShaderInfoLog(shader, length, NULL, log);
+            msg_Err(filters->gl, "filter shader: %s", log);
+            free(log);
+        }
+    }
+
+    GLint status = GL_TRUE;
+    vt->GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+        vt->DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static int LinkFilter(struct vlc_gl_filters *filters,
+                      struct vlc_gl_filter_priv *priv, bool dump)
+{
+    const opengl_vtable_t *vt = filters->vt;
+    struct vlc_gl_filter *filter = &priv->filter;
+    char *vcode, *fcode;
+
+    if (asprintf(&vcode, "#version %u\n%s", filter->glsl_version,
+                 vertex_shader_code) < 0)
+        return VLC_ENOMEM;
+    if (asprintf(&fcode, "#version %u\n%s%s%s", filter->glsl_version,
+                 filter->glsl_precision_header, fragment_shader_header,
+                 filter->shader) < 0)
+    {
+        free(vcode);
+        return VLC_ENOMEM;
+    }
+
+    GLuint vshader = BuildShader(filters, GL_VERTEX_SHADER, vcode, dump);
+    GLuint fshader = BuildShader(filters, GL_FRAGMENT_SHADER, fcode, dump);
+    free(fcode);
+    free(vcode);
+
+    if (vshader == 0 || fshader == 0)
+        goto error;
+
+    priv->program = vt->CreateProgram();
+    vt->AttachShader(priv->program, vshader);
+    vt->AttachShader(priv->program, fshader);
+    vt->LinkProgram(priv->program);
+    vt->DeleteShader(vshader);
+    vt->DeleteShader(fshader);
+
+    GLint status = GL_TRUE;
+    vt->GetProgramiv(priv->program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+        msg_Err(filters->gl, "unable to link filter program");
+        goto error;
+    }
+
+    priv->uloc.Texture = vt->GetUniformLocation(priv->program, "Texture");
+    priv->uloc.TexelSize = vt->GetUniformLocation(priv->program, "TexelSize");
+    priv->VertexPosition = vt->GetAttribLocation(priv->program,
+                                                 "VertexPosition");
+    if (priv->VertexPosition == -1)
+        goto error;
+
+    if (filter->fetch_locations != NULL
+     && filter->fetch_locations(filter, priv->program) != VLC_SUCCESS)
+        goto error;
+
+    return VLC_SUCCESS;
+
+error:
+    if (priv->program != 0)
+        vt->DeleteProgram(priv->program);
+    else
+    {
+        if (vshader != 0)
+            vt->DeleteShader(vshader);
+        if (fshader != 0)
+            vt->DeleteShader(fshader);
+    }
+    priv->program = 0;
+    return VLC_EGENERIC;
+}
+
+static void DeleteFilter(struct vlc_gl_filters *filters,
+                         struct vlc_gl_filter_priv *priv)
+{
+    struct vlc_gl_filter *filter = &priv->filter;
+
+    if (priv->program != 0)
+        filters->vt->DeleteProgram(priv->program);
+    if (filter->close != NULL)
+        filter->close(filter);
+    module_unneed(filter, filter->module);
+    vlc_object_delete(filter);
+}
+
+static struct vlc_gl_filter_priv *
+CreateFilter(struct vlc_gl_filters *filters, const char *name,
+             const config_chain_t *config, unsigned glsl_version,
+             const char *glsl_precision_header, bool dump)
+{
+    struct vlc_gl_filter_priv *priv =
+        vlc_object_create(filters->gl, sizeof (*priv));
+    if (unlikely(priv == NULL))
+        return NULL;
+
+    struct vlc_gl_filter *filter = &priv->filter;
+    filter->vt = filters->vt;
+    filter->glsl_version = glsl_version;
+    filter->glsl_precision_header = glsl_precision_header;
+    filter->config = config;
+    filter->shader = NULL;
+    filter->fetch_locations = NULL;
+    filter->prepare = NULL;
+    filter->close = NULL;
+    filter->sys = NULL;
+    priv->program = 0;
+
+    filter->module = module_need(filter, "opengl filter", name, true);
+    filter->config = NULL;
+    if (filter->module == NULL)
+    {
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    assert(filter->shader != NULL);
+
+    if (LinkFilter(filters, priv, dump) != VLC_SUCCESS)
+    {
+        DeleteFilter(filters, priv);
+        return NULL;
+    }
+    return priv;
+}
+
+struct vlc_gl_filters *
+vlc_gl_filters_New(vlc_gl_t *gl, const opengl_vtable_t *vt,
+                   const char *chain, unsigned glsl_version,
+                   const char *glsl_precision_header, bool dump_shaders)
+{
+    if (vt->GenFramebuffers == NULL || vt->BindFramebuffer == NULL
+     || vt->FramebufferTexture2D == NULL || vt->CheckFramebufferStatus == NULL
+     || vt->DeleteFramebuffers == NULL)
+    {
+        msg_Warn(gl, "framebuffer objects not supported, no filters");
+        return NULL;
+    }
+
+    struct vlc_gl_filters *filters = malloc(sizeof (*filters));
+    if (unlikely(filters == NULL))
+        return NULL;
+
+    filters->gl = gl;
+    filters->vt = vt;
+    filters->filters = NULL;
+    filters->count = 0;
+    filters->tex_width = filters->tex_height = 0;
+
+    char *buf = NULL;
+    const char *str = chain;
+
+    while (str != NULL && str[0] != '\0')
+    {
+        config_chain_t *cfg;
+        char *name;
+        char *next = config_ChainCreate(&name, &cfg, str);
+
+        str = next;
+        free(buf);
+        buf = next;
+
+        struct vlc_gl_filter_priv *priv =
+            CreateFilter(filters, name, cfg, glsl_version,
+                         glsl_precision_header, dump_shaders);
+        if (cfg != NULL)
+            config_ChainDestroy(cfg);
+
+        if (priv == NULL)
+        {
+            msg_Err(gl, "cannot load OpenGL filter \"%s\"", name);
+            free(name);
+            continue;
+        }
+        free(name);
+
+        struct vlc_gl_filter_priv **tab =
+            realloc(filters->filters, (filters->count + 1) * sizeof (*tab));
+        if (unlikely(tab == NULL))
+        {
+            DeleteFilter(filters, priv);
+            break;
+        }
+        tab[filters->count++] = priv;
+        filters->filters = tab;
+    }
+    free(buf);
+
+    if (filters->count == 0)
+    {
+        free(filters->filters);
+        free(filters);
+        return NULL;
+    }
+
+    static const GLfloat quad[] = {
+        -1.f, -1.f,
+         1.f, -1.f,
+        -1.f,  1.f,
+         1.f,  1.f,
+    };
+
+    vt->GenBuffers(1, &filters->vertex_buffer_object);
+    vt->BindBuffer(GL_ARRAY_BUFFER, filters->vertex_buffer_object);
+    vt->BufferData(GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+
+    vt->GenFramebuffers(2, filters->framebuffers);
+    vt->GenTextures(2, filters->textures);
+    for (unsigned i = 0; i < 2; i++)
+    {
+        vt->BindTexture(GL_TEXTURE_2D, filters->textures[i]);
+        vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    msg_Dbg(gl, "%zu OpenGL filter(s) loaded", filters->count);
+    return filters;
+}
+
+void vlc_gl_filters_Delete(struct vlc_gl_filters *filters)
+{
+    const opengl_vtable_t *vt = filters->vt;
+
+    for (size_t i = 0; i < filters->count; i++)
+        DeleteFilter(filters, filters->filters[i]);
+    free(filters->filters);
+
+    vt->DeleteFramebuffers(2, filters->framebuffers);
+    vt->DeleteTextures(2, filters->textures);
+    vt->DeleteBuffers(1, &filters->vertex_buffer_object);
+    free(filters);
+}
+
+static int AllocateTextures(struct vlc_gl_filters *filters,
+                            unsigned width, unsigned height)
+{
+    const opengl_vtable_t *vt = filters->vt;
+    GLint saved;
+
+    vt->GetIntegerv(GL_FRAMEBUFFER_BINDING, &saved);
+
+    for (unsigned i = 0; i < 2; i++)
+    {
+        vt->BindTexture(GL_TEXTURE_2D, filters->textures[i]);
+        vt->TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                       GL_UNSIGNED_BYTE, NULL);
+
+        vt->BindFramebuffer(GL_FRAMEBUFFER, filters->framebuffers[i]);
+        vt->FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                 GL_TEXTURE_2D, filters->textures[i], 0);
+
+        if (vt->CheckFramebufferStatus(GL_FRAMEBUFFER)
+         != GL_FRAMEBUFFER_COMPLETE)
+        {
+            msg_Err(filters->gl, "incomplete filter framebuffer");
+            vt->BindFramebuffer(GL_FRAMEBUFFER, saved);
+            filters->tex_width = filters->tex_height = 0;
+            return VLC_EGENERIC;
+        }
+    }
+
+    vt->BindFramebuffer(GL_FRAMEBUFFER, saved);
+    filters->tex_width = width;
+    filters->tex_height = height;
+    return VLC_SUCCESS;
+}
+
+int vlc_gl_filters_Begin(struct vlc_gl_filters *filters,
+                         const struct vlc_gl_filter_input *input)
+{
+    const opengl_vtable_t *vt = filters->vt;
+
+    if ((input->width != filters->tex_width
+      || input->height != filters->tex_height)
+     && AllocateTextures(filters, input->width, input->height))
+        return VLC_EGENERIC;
+
+    filters->input = *input;
+
+    vt->GetIntegerv(GL_FRAMEBUFFER_BINDING, &filters->saved_framebuffer);
+    vt->GetIntegerv(GL_VIEWPORT, filters->saved_viewport);
+
+    filters->current = 0;
+    vt->BindFramebuffer(GL_FRAMEBUFFER, filters->framebuffers[0]);
+    vt->Viewport(0, 0, input->width, input->height);
+    return VLC_SUCCESS;
+}
+
+GLuint vlc_gl_filters_End(struct vlc_gl_filters *filters)
+{
+    const opengl_vtable_t *vt = filters->vt;
+    const struct vlc_gl_filter_input *input = &filters->input;
+
+    vt->ActiveTexture(GL_TEXTURE0);
+    vt->BindBuffer(GL_ARRAY_BUFFER, filters->vertex_buffer_object);
+
+    for (size_t i = 0; i < filters->count; i++)
+    {
+        struct vlc_gl_filter_priv *priv = filters->filters[i];
+        struct vlc_gl_filter *filter = &priv->filter;
+
+        vt->UseProgram(priv->program);
+        if (filter->prepare != NULL && !filter->prepare(filter, input))
+            continue;
+
+        unsigned next = !filters->current;
+
+        vt->BindFramebuffer(GL_FRAMEBUFFER, filters->framebuffers[next]);
+        vt->BindTexture(GL_TEXTURE_2D, filters->textures[filters->current]);
+        vt->Uniform1i(priv->uloc.Texture, 0);
+        vt->Uniform2f(priv->uloc.TexelSize, 1.f / input->width,
+                      1.f / input->height);
+
+        vt->EnableVertexAttribArray(priv->VertexPosition);
+        vt->VertexAttribPointer(priv->VertexPosition, 2, GL_FLOAT, GL_FALSE,
+                                0, 0);
+        vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        filters->current = next;
+    }
+
+    vt->BindFramebuffer(GL_FRAMEBUFFER, filters->saved_framebuffer);
+    vt->Viewport(filters->saved_viewport[0], filters->saved_viewport[1],
+                 filters->saved_viewport[2], filters->saved_viewport[3]);
+    return filters->textures[filters->current];
+}
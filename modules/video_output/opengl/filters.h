@@ -0,0 +1,58 @@
+/*****************************************************************************
+ * filters.h: OpenGL filter chain
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_OPENGL_FILTERS_H
+#define VLC_OPENGL_FILTERS_H
+
+#include <vlc_opengl.h>
+#include "filter.h"
+
+struct vlc_gl_filters;
+
+/**
+ * Creates a chain of "opengl filter" modules.
+ *
+ * \param chain filters, separated by ':', with their options between braces
+ * (as for the "video-filter" option)
+ * \return the chain, or NULL if no filter could be loaded
+ */
+struct vlc_gl_filters *
+vlc_gl_filters_New(vlc_gl_t *gl, const opengl_vtable_t *vt,
+                   const char *chain, unsigned glsl_version,
+                   const char *glsl_precision_header, bool dump_shaders);
+
+void vlc_gl_filters_Delete(struct vlc_gl_filters *);
+
+/**
+ * Binds the framebuffer the picture must be drawn to, with the top row first,
+ * and sets the viewport to the picture size.
+ */
+int vlc_gl_filters_Begin(struct vlc_gl_filters *,
+                         const struct vlc_gl_filter_input *);
+
+/**
+ * Runs the filters on the drawn picture, then restores the framebuffer and
+ * viewport bound before vlc_gl_filters_Begin().
+ *
+ * \return the GL_TEXTURE_2D RGBA texture containing the filtered picture
+ */
+GLuint vlc_gl_filters_End(struct vlc_gl_filters *);
+
+#endif
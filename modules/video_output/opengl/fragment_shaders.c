@@ -60,6 +60,21 @@
 #ifndef GL_TEXTURE_LUMINANCE_SIZE
 # define GL_TEXTURE_LUMINANCE_SIZE 0x8060
 #endif
+#ifndef GL_RGBA16
+# define GL_RGBA16 0x805B
+#endif
+#ifndef GL_FRAMEBUFFER
+# define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+# define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+# define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+# define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
 
 static int GetTexFormatSize(opengl_tex_converter_t *tc, int target,
                             int tex_format, int tex_internal, int tex_type)
@@ -327,6 +342,43 @@ tc_rgb_base_init(opengl_tex_converter_t *tc, GLenum tex_target,
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_LIBPLACEBO
+static void
+pl_upload_vars(const opengl_vtable_t *vt, const struct pl_shader_res *res,
+               const GLint *locs)
+{
+    for (int i = 0; i < res->num_variables; i++) {
+        GLint loc = locs[i];
+        if (loc == -1) // uniform optimized out
+            continue;
+
+        struct pl_shader_var sv = res->variables[i];
+        struct pl_var var = sv.var;
+        // libplacebo doesn't need anything else anyway
+        if (var.type != PL_VAR_FLOAT)
+            continue;
+        if (var.dim_m > 1 && var.dim_m != var.dim_v)
+            continue;
+
+        const float *f = sv.data;
+        switch (var.dim_m) {
+        case 4: vt->UniformMatrix4fv(loc, 1, GL_FALSE, f); break;
+        case 3: vt->UniformMatrix3fv(loc, 1, GL_FALSE, f); break;
+        case 2: vt->UniformMatrix2fv(loc, 1, GL_FALSE, f); break;
+
+        case 1:
+            switch (var.dim_v) {
+            case 1: vt->Uniform1f(loc, f[0]); break;
+            case 2: vt->Uniform2f(loc, f[0], f[1]); break;
+            case 3: vt->Uniform3f(loc, f[0], f[1], f[2]); break;
+            case 4: vt->Uniform4f(loc, f[0], f[1], f[2], f[3]); break;
+            }
+            break;
+        }
+    }
+}
+#endif
+
 static int
 tc_base_fetch_locations(opengl_tex_converter_t *tc, GLuint program)
 {
@@ -364,6 +416,13 @@ tc_base_fetch_locations(opengl_tex_converter_t *tc, GLuint program)
         struct pl_shader_var sv = res->variables[i];
         tc->uloc.pl_vars[i] = tc->vt->GetUniformLocation(program, sv.var.name);
     }
+
+    if (tc->lut_texture != 0)
+    {
+        tc->uloc.Lut = tc->vt->GetUniformLocation(program, "Lut");
+        if (tc->uloc.Lut == -1)
+            return VLC_EGENERIC;
+    }
 #endif
 
     return VLC_SUCCESS;
@@ -392,36 +451,16 @@ tc_base_prepare_shader(const opengl_tex_converter_t *tc,
     }
 
 #ifdef HAVE_LIBPLACEBO
-    const struct pl_shader_res *res = tc->pl_sh_res;
-    for (int i = 0; res && i < res->num_variables; i++) {
-        GLint loc = tc->uloc.pl_vars[i];
-        if (loc == -1) // uniform optimized out
-            continue;
-
-        struct pl_shader_var sv = res->variables[i];
-        struct pl_var var = sv.var;
-        // libplacebo doesn't need anything else anyway
-        if (var.type != PL_VAR_FLOAT)
-            continue;
-        if (var.dim_m > 1 && var.dim_m != var.dim_v)
-            continue;
-
-        const float *f = sv.data;
-        switch (var.dim_m) {
-        case 4: tc->vt->UniformMatrix4fv(loc, 1, GL_FALSE, f); break;
-        case 3: tc->vt->UniformMatrix3fv(loc, 1, GL_FALSE, f); break;
-        case 2: tc->vt->UniformMatrix2fv(loc, 1, GL_FALSE, f); break;
-
-        case 1:
-            switch (var.dim_v) {
-            case 1: tc->vt->Uniform1f(loc, f[0]); break;
-            case 2: tc->vt->Uniform2f(loc, f[0], f[1]); break;
-            case 3: tc->vt->Uniform3f(loc, f[0], f[1], f[2]); break;
-            case 4: tc->vt->Uniform4f(loc, f[0], f[1], f[2], f[3]); break;
-            }
-            break;
-        }
+    if (tc->lut_texture != 0)
+    {
+        tc->vt->ActiveTexture(GL_TEXTURE0 + tc->tex_count);
+        tc->vt->BindTexture(GL_TEXTURE_2D, tc->lut_texture);
+        tc->vt->Uniform1i(tc->uloc.Lut, tc->tex_count);
+        tc->vt->ActiveTexture(GL_TEXTURE0);
     }
+
+    if (tc->pl_sh_res != NULL)
+        pl_upload_vars(tc->vt, tc->pl_sh_res, tc->uloc.pl_vars);
 #endif
 }
 
@@ -496,6 +535,249 @@ xyz12_shader_init(opengl_tex_converter_t *tc)
     return fragment_shader;
 }
 
+#ifdef HAVE_LIBPLACEBO
+static GLuint
+lut_compile_shader(opengl_tex_converter_t *tc, GLenum type, const char *code)
+{
+    const opengl_vtable_t *vt = tc->vt;
+    GLuint shader = vt->CreateShader(type);
+    if (shader == 0)
+        return 0;
+
+    vt->ShaderSource(shader, 1, (const char **) &code, NULL);
+    vt->CompileShader(shader);
+
+    GLint ok;
+    vt->GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char log[1024];
+        vt->GetShaderInfoLog(shader, sizeof (log), NULL, log);
+        msg_Err(tc->gl, "LUT shader: %s", log);
+        vt->DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint
+lut_link_program(opengl_tex_converter_t *tc, const struct pl_shader_res *res,
+                 unsigned size)
+{
+    const opengl_vtable_t *vt = tc->vt;
+    struct vlc_memstream ms;
+    if (vlc_memstream_open(&ms) != 0)
+        return 0;
+
+    /* Each fragment evaluates the colour mapping for one point of the grid:
+     * red and green along x and y within a slice, blue selects the slice */
+    vlc_memstream_printf(&ms, "#version %u\n%s", tc->glsl_version,
+                         tc->glsl_precision_header);
+    for (int i = 0; i < res->num_variables; i++)
+        vlc_memstream_printf(&ms, "uniform %s %s;\n",
+                             pl_var_glsl_type_name(res->variables[i].var),
+                             res->variables[i].var.name);
+    vlc_memstream_puts(&ms, res->glsl);
+    vlc_memstream_printf(&ms,
+        "void main(void) {\n"
+        " vec2 pos = floor(gl_FragCoord.xy);\n"
+        " float slice = floor(pos.x / %u.0);\n"
+        " vec3 rgb = vec3(pos.x - slice * %u.0, pos.y, slice) / %u.0;\n"
+        " gl_FragColor = %s(vec4(rgb, 1.0));\n"
+        "}\n", size, size, size - 1, res->name);
+    if (vlc_memstream_close(&ms) != 0)
+        return 0;
+
+    static const char vertex_code[] =
+        "#version %u\n"
+        "attribute vec2 VertexPosition;\n"
+        "void main(void) {\n"
+        " gl_Position = vec4(VertexPosition, 0.0, 1.0);\n"
+        "}\n";
+    char vertex[sizeof (vertex_code) + 10];
+    snprintf(vertex, sizeof (vertex), vertex_code, tc->glsl_version);
+
+    if (tc->b_dump_shaders)
+        msg_Dbg(tc->gl, "\n=== LUT fragment shader ===\n%s\n", ms.ptr);
+
+    GLuint shaders[2] = {
+        lut_compile_shader(tc, GL_VERTEX_SHADER, vertex),
+        lut_compile_shader(tc, GL_FRAGMENT_SHADER, ms.ptr),
+    };
+    free(ms.ptr);
+
+    GLuint program = 0;
+    if (shaders[0] != 0 && shaders[1] != 0)
+    {
+        program = vt->CreateProgram();
+        vt->AttachShader(program, shaders[0]);
+        vt->AttachShader(program, shaders[1]);
+        vt->LinkProgram(program);
+
+        GLint ok;
+        vt->GetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok)
+        {
+            char log[1024];
+            vt->GetProgramInfoLog(program, sizeof (log), NULL, log);
+            msg_Err(tc->gl, "LUT program: %s", log);
+            vt->DeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    for (unsigned i = 0; i < 2; i++)
+        if (shaders[i] != 0)
+            vt->DeleteShader(shaders[i]);
+    return program;
+}
+
+static GLuint
+lut_create_texture(opengl_tex_converter_t *tc, unsigned size, GLuint fbo)
+{
+    const opengl_vtable_t *vt = tc->vt;
+    static const GLint internals[] = {
+#if !defined(USE_OPENGL_ES2)
+        GL_RGBA16, /* the mapped colours are not dithered yet */
+#endif
+        GL_RGBA,
+    };
+
+    GLuint texture;
+    vt->GenTextures(1, &texture);
+    vt->BindTexture(GL_TEXTURE_2D, texture);
+    vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    vt->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    vt->BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    for (size_t i = 0; i < ARRAY_SIZE(internals); i++)
+    {
+        vt->TexImage2D(GL_TEXTURE_2D, 0, internals[i], size * size, size, 0,
+                       GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        vt->FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                 GL_TEXTURE_2D, texture, 0);
+        if (vt->CheckFramebufferStatus(GL_FRAMEBUFFER)
+         == GL_FRAMEBUFFER_COMPLETE)
+            return texture;
+    }
+
+    vt->DeleteTextures(1, &texture);
+    return 0;
+}
+
+/**
+ * Renders the colour mapping from the source to the display colour space
+ * into tc->lut_texture, so that the fragment shader only has to look it up.
+ *
+ * The mapping only depends on the source format and on the output options,
+ * which are fixed for the lifetime of the converter: the LUT is computed once.
+ */
+static int
+lut_generate(opengl_tex_converter_t *tc,
+             const struct pl_color_map_params *params,
+             struct pl_color_space dst_space)
+{
+    const opengl_vtable_t *vt = tc->vt;
+
+    /* Only worth it for the expensive conversions */
+    if (tc->fmt.transfer != TRANSFER_FUNC_SMPTE_ST2084
+     && tc->fmt.transfer != TRANSFER_FUNC_HLG
+     && tc->fmt.primaries != COLOR_PRIMARIES_BT2020)
+        return VLC_EGENERIC;
+
+    unsigned size = var_InheritInteger(tc->gl, "tone-mapping-lut");
+    if (size < 2 || vt->GenFramebuffers == NULL)
+        return VLC_EGENERIC;
+
+    GLint max_size;
+    vt->GetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    while (size > 2 && size * size > (unsigned) max_size)
+        size--;
+
+#   if PL_API_VER >= 20
+    struct pl_shader *sh = pl_shader_alloc(tc->pl_ctx, NULL);
+#   elif PL_API_VER >= 6
+    struct pl_shader *sh = pl_shader_alloc(tc->pl_ctx, NULL, 0);
+#   else
+    struct pl_shader *sh = pl_shader_alloc(tc->pl_ctx, NULL, 0, 0);
+#   endif
+    if (sh == NULL)
+        return VLC_EGENERIC;
+
+    pl_shader_color_map(sh, params, vlc_placebo_ColorSpace(&tc->fmt),
+                        dst_space, NULL, false);
+
+    const struct pl_shader_res *res = pl_shader_finalize(sh);
+    GLuint program = 0;
+    GLint *locs = NULL;
+    if (res != NULL && res->num_vertex_attribs == 0
+     && res->num_descriptors == 0)
+    {
+        program = lut_link_program(tc, res, size);
+        locs = vlc_alloc(res->num_variables, sizeof (*locs));
+    }
+    if (program == 0 || (locs == NULL && res->num_variables > 0))
+    {
+        if (program != 0)
+            vt->DeleteProgram(program);
+        free(locs);
+        pl_shader_free(&sh);
+        return VLC_EGENERIC;
+    }
+
+    GLint saved_fbo, saved_viewport[4];
+    vt->GetIntegerv(GL_FRAMEBUFFER_BINDING, &saved_fbo);
+    vt->GetIntegerv(GL_VIEWPORT, saved_viewport);
+
+    GLuint fbo;
+    vt->GenFramebuffers(1, &fbo);
+    GLuint texture = lut_create_texture(tc, size, fbo);
+    if (texture != 0)
+    {
+        static const GLfloat quad[] = {
+            -1.f, -1.f,  1.f, -1.f,  -1.f, 1.f,  1.f, 1.f,
+        };
+        GLuint vbo;
+        vt->GenBuffers(1, &vbo);
+        vt->BindBuffer(GL_ARRAY_BUFFER, vbo);
+        vt->BufferData(GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+
+        vt->UseProgram(program);
+        for (int i = 0; i < res->num_variables; i++)
+            locs[i] = vt->GetUniformLocation(program,
+                                             res->variables[i].var.name);
+        pl_upload_vars(vt, res, locs);
+
+        GLint pos = vt->GetAttribLocation(program, "VertexPosition");
+        vt->EnableVertexAttribArray(pos);
+        vt->VertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+        vt->Viewport(0, 0, size * size, size);
+        vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        vt->DeleteBuffers(1, &vbo);
+    }
+
+    vt->BindFramebuffer(GL_FRAMEBUFFER, saved_fbo);
+    vt->Viewport(saved_viewport[0], saved_viewport[1],
+                 saved_viewport[2], saved_viewport[3]);
+    vt->DeleteFramebuffers(1, &fbo);
+    vt->DeleteProgram(program);
+    free(locs);
+    pl_shader_free(&sh);
+
+    if (texture == 0)
+        return VLC_EGENERIC;
+
+    msg_Dbg(tc->gl, "colour mapping LUT with %u points per axis", size);
+    tc->lut_texture = texture;
+    tc->lut_size = size;
+    return VLC_SUCCESS;
+}
+#endif
+
 GLuint
 opengl_fragment_shader_init_impl(opengl_tex_converter_t *tc, GLenum tex_target,
                                  vlc_fourcc_t chroma, video_color_space_t yuv_space)
@@ -571,9 +853,15 @@ opengl_fragment_shader_init_impl(opengl_tex_converter_t *tc, GLenum tex_target,
         dst_space.primaries = var_InheritInteger(tc->gl, "target-prim");
         dst_space.transfer = var_InheritInteger(tc->gl, "target-trc");
 
-        pl_shader_color_map(sh, &color_params,
-                vlc_placebo_ColorSpace(&tc->fmt),
-                dst_space, NULL, false);
+        if (tc->lut_texture != 0)
+        {
+            tc->vt->DeleteTextures(1, &tc->lut_texture);
+            tc->lut_texture = 0;
+        }
+        if (lut_generate(tc, &color_params, dst_space) != VLC_SUCCESS)
+            pl_shader_color_map(sh, &color_params,
+                    vlc_placebo_ColorSpace(&tc->fmt),
+                    dst_space, NULL, false);
 
         struct pl_shader_obj *dither_state = NULL;
         int method = var_InheritInteger(tc->gl, "dither-algo");
@@ -604,22 +892,31 @@ opengl_fragment_shader_init_impl(opengl_tex_converter_t *tc, GLenum tex_target,
             });
         }
 
-        const struct pl_shader_res *res = tc->pl_sh_res = pl_shader_finalize(sh);
+        if (tc->lut_texture != 0)
+            ADD("uniform sampler2D Lut;\n");
+
+        /* With the LUT and without dithering, there is nothing left to run */
+        const struct pl_shader_res *res = NULL;
+        if (tc->lut_texture == 0 || method >= 0)
+            res = tc->pl_sh_res = pl_shader_finalize(sh);
         pl_shader_obj_destroy(&dither_state);
 
         FREENULL(tc->uloc.pl_vars);
-        tc->uloc.pl_vars = calloc(res->num_variables, sizeof(GLint));
-        for (int i = 0; i < res->num_variables; i++) {
-            struct pl_shader_var sv = res->variables[i];
-            const char *glsl_type_name = pl_var_glsl_type_name(sv.var);
-            ADDF("uniform %s %s;\n", glsl_type_name, sv.var.name);
-        }
+        if (res != NULL)
+        {
+            tc->uloc.pl_vars = calloc(res->num_variables, sizeof(GLint));
+            for (int i = 0; i < res->num_variables; i++) {
+                struct pl_shader_var sv = res->variables[i];
+                const char *glsl_type_name = pl_var_glsl_type_name(sv.var);
+                ADDF("uniform %s %s;\n", glsl_type_name, sv.var.name);
+            }
 
-        // We can't handle these yet, but nothing we use requires them, either
-        assert(res->num_vertex_attribs == 0);
-        assert(res->num_descriptors == 0);
+            // We can't handle these yet, but nothing we use requires them, either
+            assert(res->num_vertex_attribs == 0);
+            assert(res->num_descriptors == 0);
 
-        ADD(res->glsl);
+            ADD(res->glsl);
+        }
     }
 #else
     if (tc->fmt.transfer == TRANSFER_FUNC_SMPTE_ST2084 ||
@@ -702,6 +999,18 @@ opengl_fragment_shader_init_impl(opengl_tex_converter_t *tc, GLenum tex_target,
     }
 
 #ifdef HAVE_LIBPLACEBO
+    if (tc->lut_texture != 0) {
+        /* Trilinear lookup: bilinear within the two nearest blue slices */
+        const unsigned n = tc->lut_size;
+        ADDF(" vec3 lut = clamp(result.rgb, 0.0, 1.0) * %u.0;\n"
+             " float slice = floor(lut.b);\n"
+             " vec2 lut_pos = vec2((lut.r + 0.5) / %u.0, (lut.g + 0.5) / %u.0);\n"
+             " vec4 lut0 = texture2D(Lut, lut_pos + vec2(slice / %u.0, 0.0));\n"
+             " vec4 lut1 = texture2D(Lut, lut_pos + "
+                 "vec2(min(slice + 1.0, %u.0) / %u.0, 0.0));\n"
+             " result.rgb = mix(lut0.rgb, lut1.rgb, lut.b - slice);\n",
+             n - 1, n * n, n, n, n - 1, n);
+    }
     if (tc->pl_sh_res) {
         const struct pl_shader_res *res = tc->pl_sh_res;
         assert(res->input  == PL_SHADER_SIG_COLOR);
@@ -42,6 +42,7 @@
 
 #include "vout_helper.h"
 #include "internal.h"
+#include "filters.h"
 
 #ifndef GL_CLAMP_TO_EDGE
 # define GL_CLAMP_TO_EDGE 0x812F
@@ -90,6 +91,12 @@ typedef struct {
 
     float    tex_width;
     float    tex_height;
+
+    /* Uploaded content, to skip unchanged regions */
+    picture_t *picture;
+    size_t   pixels_offset;
+    unsigned visible_width;
+    unsigned visible_height;
 } gl_region_t;
 
 struct prgm
@@ -147,6 +154,11 @@ struct vout_display_opengl_t {
     GLuint *subpicture_buffer_object;
     int    subpicture_buffer_object_count;
 
+    /* OpenGL filters, run on the picture before display (can be NULL) */
+    struct vlc_gl_filters *filters;
+    GLuint filtered_buffer_object[2];
+    bool   progressive;
+
     struct {
         unsigned int i_x_offset;
         unsigned int i_y_offset;
@@ -511,6 +523,8 @@ opengl_deinit_program(vout_display_opengl_t *vgl, struct prgm *prgm)
 
 #ifdef HAVE_LIBPLACEBO
     FREENULL(tc->uloc.pl_vars);
+    if (tc->lut_texture != 0)
+        vgl->vt.DeleteTextures(1, &tc->lut_texture);
     if (tc->pl_ctx)
         pl_context_destroy(&tc->pl_ctx);
 #endif
@@ -755,6 +769,11 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
     GET_PROC_ADDR(DeleteBuffers);
 
     GET_PROC_ADDR_OPTIONAL(GetFramebufferAttachmentParameteriv);
+    GET_PROC_ADDR_OPTIONAL(GenFramebuffers);
+    GET_PROC_ADDR_OPTIONAL(BindFramebuffer);
+    GET_PROC_ADDR_OPTIONAL(FramebufferTexture2D);
+    GET_PROC_ADDR_OPTIONAL(CheckFramebufferStatus);
+    GET_PROC_ADDR_OPTIONAL(DeleteFramebuffers);
 
     GET_PROC_ADDR_OPTIONAL(BufferSubData);
     GET_PROC_ADDR_OPTIONAL(BufferStorage);
@@ -903,6 +922,24 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
         return NULL;
     }
 
+    char *filters = var_InheritString(gl, "gl-filters");
+    if (filters != NULL)
+    {
+        if (vgl->fmt.projection_mode != PROJECTION_MODE_RECTANGULAR)
+            msg_Warn(gl, "OpenGL filters not supported with 360 video");
+        else if (!vgl->supports_npot)
+            msg_Warn(gl, "OpenGL filters need non-power-of-2 textures");
+        else
+            vgl->filters = vlc_gl_filters_New(gl, &vgl->vt, filters,
+                                              tc->glsl_version,
+                                              tc->glsl_precision_header,
+                                              b_dump_shaders);
+        free(filters);
+
+        if (vgl->filters != NULL)
+            vgl->vt.GenBuffers(2, vgl->filtered_buffer_object);
+    }
+
     *fmt = vgl->fmt;
     if (subpicture_chromas) {
         *subpicture_chromas = gl_subpicture_chromas;
@@ -925,6 +962,11 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
 
     if (vgl->pool)
         picture_pool_Release(vgl->pool);
+    if (vgl->filters != NULL)
+    {
+        vlc_gl_filters_Delete(vgl->filters);
+        vgl->vt.DeleteBuffers(2, vgl->filtered_buffer_object);
+    }
     opengl_deinit_program(vgl, vgl->prgm);
     opengl_deinit_program(vgl, vgl->sub_prgm);
 
@@ -944,6 +986,8 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
     {
         if (vgl->region[i].texture)
             vgl->vt.DeleteTextures(1, &vgl->region[i].texture);
+        if (vgl->region[i].picture)
+            picture_Release(vgl->region[i].picture);
     }
     free(vgl->region);
     GL_ASSERT_NOERROR();
@@ -1064,6 +1108,8 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
     if (ret != VLC_SUCCESS)
         return ret;
 
+    vgl->progressive = picture->b_progressive;
+
     int         last_count = vgl->region_count;
     gl_region_t *last = vgl->region;
 
@@ -1102,22 +1148,49 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
             glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
             glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
+            const size_t pixels_offset =
+                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
+                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
+
             glr->texture = 0;
+            /* Keep the texture of a region showing the same picture than in
+               the previous call: the SPU renders regions from its cache, so
+               unchanged overlays come back with the same picture. */
+            int j;
+            for (j = 0; j < last_count; j++) {
+                if (last[j].texture &&
+                    last[j].picture        == r->p_picture &&
+                    last[j].pixels_offset  == pixels_offset &&
+                    last[j].visible_width  == r->fmt.i_visible_width &&
+                    last[j].visible_height == r->fmt.i_visible_height &&
+                    last[j].width  == glr->width &&
+                    last[j].height == glr->height) {
+                    glr->texture = last[j].texture;
+                    glr->picture = last[j].picture;
+                    glr->pixels_offset  = pixels_offset;
+                    glr->visible_width  = r->fmt.i_visible_width;
+                    glr->visible_height = r->fmt.i_visible_height;
+                    memset(&last[j], 0, sizeof(last[j]));
+                    break;
+                }
+            }
+            if (j < last_count)
+                continue;
+
             /* Try to recycle the textures allocated by the previous
                call to this function. */
-            for (int j = 0; j < last_count; j++) {
+            for (j = 0; j < last_count; j++) {
                 if (last[j].texture &&
                     last[j].width  == glr->width &&
                     last[j].height == glr->height) {
                     glr->texture = last[j].texture;
+                    if (last[j].picture)
+                        picture_Release(last[j].picture);
                     memset(&last[j], 0, sizeof(last[j]));
                     break;
                 }
             }
 
-            const size_t pixels_offset =
-                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
-                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
             if (!glr->texture)
             {
                 /* Could not recycle a previous texture, generate a new one. */
@@ -1130,11 +1203,19 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
                                                * r->p_picture->p[0].i_pixel_pitch;
             ret = tc->pf_update(tc, &glr->texture, &glr->width, &glr->height,
                                 r->p_picture, &pixels_offset);
+            if (ret == VLC_SUCCESS) {
+                glr->picture = picture_Hold(r->p_picture);
+                glr->pixels_offset  = pixels_offset;
+                glr->visible_width  = r->fmt.i_visible_width;
+                glr->visible_height = r->fmt.i_visible_height;
+            }
         }
     }
     for (int i = 0; i < last_count; i++) {
         if (last[i].texture)
             DelTextures(tc, &last[i].texture);
+        if (last[i].picture)
+            picture_Release(last[i].picture);
     }
     free(last);
 
@@ -1510,6 +1591,94 @@ static void DrawWithShaders(vout_display_opengl_t *vgl, struct prgm *prgm)
     vgl->vt.DrawElements(GL_TRIANGLES, vgl->nb_indices, GL_UNSIGNED_SHORT, 0);
 }
 
+static int DrawWithFilters(vout_display_opengl_t *vgl,
+                           const video_format_t *source)
+{
+    struct prgm *prgm = vgl->prgm;
+    const struct vlc_gl_filter_input input = {
+        .width = source->i_visible_width,
+        .height = source->i_visible_height,
+        .progressive = vgl->progressive,
+    };
+
+    if (vlc_gl_filters_Begin(vgl->filters, &input) != VLC_SUCCESS)
+        return VLC_EGENERIC;
+
+    /* Draw the picture top row first and without orientation: the
+     * orientation is applied when drawing the filtered picture. Flipping
+     * the picture reverses the faces. */
+    static const GLfloat flip[] = {
+        1.0f,  0.0f, 0.0f, 0.0f,
+        0.0f, -1.0f, 0.0f, 0.0f,
+        0.0f,  0.0f, 1.0f, 0.0f,
+        0.0f,  0.0f, 0.0f, 1.0f
+    };
+    GLfloat orientation[16], projection[16];
+
+    memcpy(orientation, prgm->var.OrientationMatrix, sizeof (orientation));
+    memcpy(projection, prgm->var.ProjectionMatrix, sizeof (projection));
+    memcpy(prgm->var.OrientationMatrix, identity, sizeof (identity));
+    memcpy(prgm->var.ProjectionMatrix, flip, sizeof (flip));
+    vgl->vt.Disable(GL_CULL_FACE);
+
+    DrawWithShaders(vgl, prgm);
+
+    vgl->vt.Enable(GL_CULL_FACE);
+    memcpy(prgm->var.OrientationMatrix, orientation, sizeof (orientation));
+    memcpy(prgm->var.ProjectionMatrix, projection, sizeof (projection));
+
+    GLuint texture = vlc_gl_filters_End(vgl->filters);
+
+    /* Draw the result with the RGBA program */
+    prgm = vgl->sub_prgm;
+    opengl_tex_converter_t *tc = prgm->tc;
+    GLsizei width = input.width, height = input.height;
+
+    static const GLfloat vertexCoord[] = {
+        -1.0f,  1.0f,
+        -1.0f, -1.0f,
+         1.0f,  1.0f,
+         1.0f, -1.0f,
+    };
+    static const GLfloat textureCoord[] = {
+        0.0f, 0.0f,
+        0.0f, 1.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+    };
+
+    assert(tc->tex_target == GL_TEXTURE_2D);
+    vgl->vt.UseProgram(prgm->id);
+    vgl->vt.ActiveTexture(GL_TEXTURE0);
+    vgl->vt.BindTexture(tc->tex_target, texture);
+    tc->pf_prepare_shader(tc, &width, &height, 1.0f);
+
+    vgl->vt.BindBuffer(GL_ARRAY_BUFFER, vgl->filtered_buffer_object[0]);
+    vgl->vt.BufferData(GL_ARRAY_BUFFER, sizeof (textureCoord), textureCoord,
+                       GL_STATIC_DRAW);
+    vgl->vt.EnableVertexAttribArray(prgm->aloc.MultiTexCoord[0]);
+    vgl->vt.VertexAttribPointer(prgm->aloc.MultiTexCoord[0], 2, GL_FLOAT,
+                                0, 0, 0);
+
+    vgl->vt.BindBuffer(GL_ARRAY_BUFFER, vgl->filtered_buffer_object[1]);
+    vgl->vt.BufferData(GL_ARRAY_BUFFER, sizeof (vertexCoord), vertexCoord,
+                       GL_STATIC_DRAW);
+    vgl->vt.EnableVertexAttribArray(prgm->aloc.VertexPosition);
+    vgl->vt.VertexAttribPointer(prgm->aloc.VertexPosition, 2, GL_FLOAT,
+                                0, 0, 0);
+
+    vgl->vt.UniformMatrix4fv(prgm->uloc.OrientationMatrix, 1, GL_FALSE,
+                             vgl->prgm->var.OrientationMatrix);
+    vgl->vt.UniformMatrix4fv(prgm->uloc.ProjectionMatrix, 1, GL_FALSE,
+                             prgm->var.ProjectionMatrix);
+    vgl->vt.UniformMatrix4fv(prgm->uloc.ViewMatrix, 1, GL_FALSE,
+                             prgm->var.ViewMatrix);
+    vgl->vt.UniformMatrix4fv(prgm->uloc.ZoomMatrix, 1, GL_FALSE,
+                             prgm->var.ZoomMatrix);
+
+    vgl->vt.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    return VLC_SUCCESS;
+}
 
 static void GetTextureCropParamsForStereo(unsigned i_nbTextures,
                                           const float *stereoCoefs,
@@ -1615,7 +1784,9 @@ int vout_display_opengl_Display(vout_display_opengl_t *vgl,
         vgl->last_source.i_visible_width = source->i_visible_width;
         vgl->last_source.i_visible_height = source->i_visible_height;
     }
-    DrawWithShaders(vgl, vgl->prgm);
+
+    if (vgl->filters == NULL || DrawWithFilters(vgl, source) != VLC_SUCCESS)
+        DrawWithShaders(vgl, vgl->prgm);
 
     /* Draw the subpictures */
     // Change the program for overlays
@@ -50,6 +50,12 @@
               TONEMAP_DESAT_TEXT, TONEMAP_DESAT_LONGTEXT, false)
 #endif
 
+#define TONEMAP_LUT_TEXT N_("Tone mapping LUT size")
+#define TONEMAP_LUT_LONGTEXT N_( \
+    "Precompute the conversion of HDR and wide gamut signals into a 3D " \
+    "lookup table with this many points per axis, instead of evaluating " \
+    "it for every pixel. 0 disables the lookup table.")
+
 #define add_glopts_placebo() \
     set_section(N_("Colorspace conversion"), NULL) \
     add_integer("rendering-intent", pl_color_map_default_params.intent, \
@@ -67,6 +73,8 @@
     add_float("tone-mapping-param", pl_color_map_default_params.tone_mapping_param, \
               TONEMAP_PARAM_TEXT, TONEMAP_PARAM_LONGTEXT, true) \
     add_bool("tone-mapping-warn", false, GAMUT_WARN_TEXT, GAMUT_WARN_LONGTEXT, false) \
+    add_integer_with_range("tone-mapping-lut", 33, 0, 64, \
+            TONEMAP_LUT_TEXT, TONEMAP_LUT_LONGTEXT, true) \
     set_section(N_("Dithering"), NULL) \
     add_integer("dither-algo", -1, DITHER_TEXT, DITHER_LONGTEXT, false) \
             change_integer_list(dither_values, dither_text) \
@@ -80,8 +88,14 @@
 #define GLCONV_LONGTEXT N_( \
     "Force a \"glconv\" module.")
 
+#define GLFILTERS_TEXT N_("OpenGL filters")
+#define GLFILTERS_LONGTEXT N_( \
+    "List of \"opengl filter\" modules to run on the GPU, separated by " \
+    "colons, e.g. \"adjust:sharpen\".")
+
 #define add_glopts() \
     add_module("glconv", "glconv", NULL, GLCONV_TEXT, GLCONV_LONGTEXT) \
+    add_string("gl-filters", NULL, GLFILTERS_TEXT, GLFILTERS_LONGTEXT, true) \
     add_glopts_placebo ()
 
 typedef struct vout_display_opengl_t vout_display_opengl_t;
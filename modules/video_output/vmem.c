@@ -83,8 +83,11 @@ vlc_module_end()
 typedef struct
 {
     void *id;
+    struct vout_display_sys_t *owner;
 } picture_sys_t;
 
+#define VMEM_MAX_PICTURES 128
+
 /* NOTE: the callback prototypes must match those of LibVLC */
 struct vout_display_sys_t {
     void *opaque;
@@ -93,6 +96,12 @@ struct vout_display_sys_t {
     void (*unlock)(void *sys, void *id, void *const *plane);
     void (*display)(void *sys, void *id);
     void (*cleanup)(void *sys);
+    void *(*alloc)(void *sys, void **plane);
+    void (*free)(void *sys, void *id);
+
+    picture_pool_t *pool;
+    picture_sys_t pic_sys[VMEM_MAX_PICTURES]; /* application buffers */
+    unsigned pic_count;
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
@@ -101,6 +110,7 @@ struct vout_display_sys_t {
 typedef unsigned (*vlc_format_cb)(void **, char *, unsigned *, unsigned *,
                                   unsigned *, unsigned *);
 
+static picture_pool_t *Pool(vout_display_t *, unsigned);
 static void           Prepare(vout_display_t *, picture_t *, subpicture_t *, vlc_tick_t);
 static void           Display(vout_display_t *, picture_t *);
 static int            Control(vout_display_t *, int, va_list);
@@ -121,7 +131,8 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     vlc_format_cb setup = var_InheritAddress(vd, "vmem-setup");
 
     sys->lock = var_InheritAddress(vd, "vmem-lock");
-    if (sys->lock == NULL) {
+    sys->alloc = var_InheritAddress(vd, "vmem-alloc");
+    if (sys->lock == NULL && sys->alloc == NULL) {
         msg_Err(vd, "missing lock callback");
         free(sys);
         return VLC_EGENERIC;
@@ -130,6 +141,9 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     sys->display = var_InheritAddress(vd, "vmem-display");
     sys->cleanup = var_InheritAddress(vd, "vmem-cleanup");
     sys->opaque = var_InheritAddress(vd, "vmem-data");
+    sys->free = var_InheritAddress(vd, "vmem-free");
+    sys->pool = NULL;
+    sys->pic_count = 0;
 
     /* Define the video format */
     video_format_t fmt;
@@ -216,6 +230,7 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     *fmtp = fmt;
 
     vd->sys     = sys;
+    vd->pool    = sys->alloc != NULL ? Pool : NULL;
     vd->prepare = Prepare;
     vd->display = Display;
     vd->control = Control;
@@ -229,11 +244,90 @@ static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
 
+    if (sys->pool != NULL)
+        picture_pool_Release(sys->pool);
     if (sys->cleanup)
         sys->cleanup(sys->opaque);
     free(sys);
 }
 
+static void DestroyPicture(picture_t *pic)
+{
+    picture_sys_t *p_sys = pic->p_sys;
+    vout_display_sys_t *sys = p_sys->owner;
+
+    if (sys->free != NULL)
+        sys->free(sys->opaque, p_sys->id);
+}
+
+static picture_pool_t *Pool(vout_display_t *vd, unsigned count)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    if (sys->pool != NULL)
+        return sys->pool;
+
+    picture_t *pictures[VMEM_MAX_PICTURES];
+
+    if (count > VMEM_MAX_PICTURES)
+        count = VMEM_MAX_PICTURES;
+
+    while (sys->pic_count < count) {
+        picture_sys_t *p_sys = &sys->pic_sys[sys->pic_count];
+        void *planes[PICTURE_PLANE_MAX] = { NULL };
+
+        p_sys->id = sys->alloc(sys->opaque, planes);
+        if (p_sys->id == NULL)
+            break;
+
+        p_sys->owner = sys;
+
+        picture_resource_t rsc = {
+            .p_sys = p_sys,
+            .pf_destroy = DestroyPicture,
+        };
+        for (unsigned i = 0; i < PICTURE_PLANE_MAX; i++) {
+            rsc.p[i].p_pixels = planes[i];
+            rsc.p[i].i_lines  = sys->lines[i];
+            rsc.p[i].i_pitch  = sys->pitches[i];
+        }
+
+        picture_t *pic = picture_NewFromResource(&vd->fmt, &rsc);
+        if (unlikely(pic == NULL)) {
+            if (sys->free != NULL)
+                sys->free(sys->opaque, p_sys->id);
+            break;
+        }
+        pictures[sys->pic_count++] = pic;
+    }
+
+    if (sys->pic_count > 0)
+        sys->pool = picture_pool_New(sys->pic_count, pictures);
+    if (sys->pool == NULL) {
+        for (unsigned i = 0; i < sys->pic_count; i++)
+            picture_Release(pictures[i]);
+        sys->pic_count = 0;
+        /* Let the core allocate the pictures, and copy them */
+        if (sys->lock != NULL)
+            sys->pool = picture_pool_NewFromFormat(&vd->fmt, count);
+        return sys->pool;
+    }
+
+    msg_Dbg(vd, "decoding directly into %u application buffers",
+            sys->pic_count);
+    return sys->pool;
+}
+
+/* Returns the application buffer of a picture, or NULL if it was allocated
+ * by the core (e.g. by the format converters) */
+static picture_sys_t *GetBuffer(vout_display_sys_t *sys, const picture_t *pic)
+{
+    for (unsigned i = 0; i < sys->pic_count; i++)
+        if (pic->p_sys == &sys->pic_sys[i])
+            return &sys->pic_sys[i];
+    return NULL;
+}
+
 static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
                     vlc_tick_t date)
 {
@@ -242,6 +336,20 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
     picture_resource_t rsc = { .p_sys = NULL };
     void *planes[PICTURE_PLANE_MAX];
 
+    picture_sys_t *buffer = GetBuffer(sys, pic);
+    if (buffer != NULL) {
+        /* Direct rendering: the picture is already in application memory */
+        sys->pic_opaque = buffer->id;
+        (void) subpic;
+        return;
+    }
+
+    if (sys->lock == NULL) {
+        msg_Warn(vd, "cannot copy converted picture without lock callback");
+        sys->pic_opaque = NULL;
+        return;
+    }
+
     sys->pic_opaque = sys->lock(sys->opaque, planes);
 
     for (unsigned i = 0; i < PICTURE_PLANE_MAX; i++) {
@@ -267,7 +375,7 @@ static void Display(vout_display_t *vd, picture_t *pic)
     vout_display_sys_t *sys = vd->sys;
     VLC_UNUSED(pic);
 
-    if (sys->display != NULL)
+    if (sys->display != NULL && sys->pic_opaque != NULL)
         sys->display(sys->opaque, sys->pic_opaque);
 }
 
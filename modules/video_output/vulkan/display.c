@@ -30,6 +30,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_vout_display.h>
+#include <vlc_picture_pool.h>
 
 #include "../placebo_utils.h"
 #include "instance.h"
@@ -45,6 +46,11 @@ struct vout_display_sys_t
     const struct pl_tex *plane_tex[4];
     struct pl_renderer *renderer;
 
+    // Pool of pictures backed by host mapped buffers, for direct rendering
+    picture_pool_t *pool;
+    const struct pl_buf **pool_bufs;
+    unsigned num_pool_bufs;
+
     // Pool of textures for the subpictures
     struct pl_overlay *overlays;
     const struct pl_tex **overlay_tex;
@@ -71,6 +77,7 @@ struct vout_display_sys_t
 };
 
 // Display callbacks
+static picture_pool_t *Pool(vout_display_t *, unsigned);
 static void PictureRender(vout_display_t *, picture_t *, subpicture_t *, mtime_t);
 static void PictureDisplay(vout_display_t *, picture_t *);
 static int Control(vout_display_t *, int, va_list);
@@ -139,6 +146,8 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
 
     vd->info.subpicture_chromas = subfmts;
 
+    if (!var_InheritBool(vd, "vk-disable-dr"))
+        vd->pool = Pool;
     vd->prepare = PictureRender;
     vd->display = PictureDisplay;
     vd->control = Control;
@@ -162,6 +171,13 @@ static void Close(vout_display_t *vd)
 
     for (int i = 0; i < 4; i++)
         pl_tex_destroy(gpu, &sys->plane_tex[i]);
+
+    if (sys->pool)
+        picture_pool_Release(sys->pool);
+    for (unsigned i = 0; i < sys->num_pool_bufs; i++)
+        pl_buf_destroy(gpu, &sys->pool_bufs[i]);
+    free(sys->pool_bufs);
+
     for (int i = 0; i < sys->num_overlays; i++)
         pl_tex_destroy(gpu, &sys->overlay_tex[i]);
 
@@ -175,6 +191,115 @@ static void Close(vout_display_t *vd)
     vlc_vk_Release(sys->vk);
 }
 
+// Allocates the pictures straight into host mapped buffers, so that the
+// decoder writes into memory the GPU can upload from asynchronously, without
+// the intermediate memcpy done by pl_upload_plane() for plain pointers.
+static picture_pool_t *Pool(vout_display_t *vd, unsigned count)
+{
+    vout_display_sys_t *sys = vd->sys;
+    if (sys->pool || sys->pool_bufs)
+        return sys->pool; // already allocated, or failed to
+
+    const struct pl_gpu *gpu = sys->vk->vulkan->gpu;
+    picture_t *pictures[count];
+    unsigned num = 0;
+
+    sys->pool_bufs = calloc(count, sizeof(*sys->pool_bufs));
+    if (unlikely(sys->pool_bufs == NULL))
+        return NULL;
+
+    for (; num < count; num++) {
+        picture_resource_t rsc = { .p_sys = NULL };
+        picture_t *pic = picture_NewFromResource(&vd->fmt, &rsc);
+        if (pic == NULL)
+            break;
+
+        // Compute the plane layout, each plane aligned for the transfers
+        if (picture_Setup(pic, &vd->fmt)) {
+            picture_Release(pic);
+            break;
+        }
+
+        size_t offsets[PICTURE_PLANE_MAX];
+        size_t size = 0;
+        for (int i = 0; i < pic->i_planes; i++) {
+            offsets[i] = size;
+            size += (size_t) pic->p[i].i_pitch * pic->p[i].i_lines;
+            size = (size + 63) & ~(size_t) 63;
+        }
+
+        const struct pl_buf *buf = pl_buf_create(gpu, &(struct pl_buf_params) {
+            .type = PL_BUF_TEX_TRANSFER,
+            .size = size,
+            .host_mapped = true,
+        });
+        if (buf == NULL) {
+            picture_Release(pic);
+            break;
+        }
+
+        for (int i = 0; i < pic->i_planes; i++)
+            pic->p[i].p_pixels = buf->data + offsets[i];
+        pic->p_sys = (void *) buf;
+
+        sys->pool_bufs[num] = buf;
+        pictures[num] = pic;
+    }
+    sys->num_pool_bufs = num;
+
+    if (num == 0) {
+        msg_Warn(vd, "Failed allocating mapped pictures, disabling direct "
+                 "rendering");
+        return NULL;
+    }
+
+    sys->pool = picture_pool_New(num, pictures);
+    if (sys->pool == NULL) {
+        for (unsigned i = 0; i < num; i++)
+            picture_Release(pictures[i]);
+    }
+    return sys->pool;
+}
+
+// Returns the mapped buffer backing the picture, if it comes from our pool
+static const struct pl_buf *PictureBuf(vout_display_sys_t *sys,
+                                       const picture_t *pic)
+{
+    for (unsigned i = 0; i < sys->num_pool_bufs; i++) {
+        if (pic->p_sys == sys->pool_bufs[i])
+            return sys->pool_bufs[i];
+    }
+    return NULL;
+}
+
+#if PL_API_VER >= 72
+// Synthesize the film grain left by the decoder while sampling the image
+static void PictureFilmGrain(struct pl_image *img, const vlc_film_grain_t *fg)
+{
+    struct pl_av1_grain_data *d = &img->av1_grain;
+
+    d->grain_seed = fg->random_seed;
+    d->num_points_y = fg->num_y_points;
+    memcpy(d->points_y, fg->y_points, sizeof (d->points_y));
+    d->chroma_scaling_from_luma = fg->chroma_scaling_from_luma;
+    for (int i = 0; i < 2; i++) {
+        d->num_points_uv[i] = fg->num_uv_points[i];
+        memcpy(d->points_uv[i], fg->uv_points[i], sizeof (d->points_uv[i]));
+        memcpy(d->ar_coeffs_uv[i], fg->ar_coeffs_uv[i],
+               sizeof (d->ar_coeffs_uv[i]));
+        d->uv_mult[i] = fg->uv_mult[i];
+        d->uv_mult_luma[i] = fg->uv_mult_luma[i];
+        d->uv_offset[i] = fg->uv_offset[i];
+    }
+    d->scaling_shift = fg->scaling_shift;
+    d->ar_coeff_lag = fg->ar_coeff_lag;
+    memcpy(d->ar_coeffs_y, fg->ar_coeffs_y, sizeof (d->ar_coeffs_y));
+    d->ar_coeff_shift = fg->ar_coeff_shift;
+    d->grain_scale_shift = fg->grain_scale_shift;
+    d->overlap = fg->overlap;
+}
+#endif
+
 static void PictureRender(vout_display_t *vd, picture_t *pic,
                           subpicture_t *subpicture, mtime_t date)
 {
@@ -202,9 +327,15 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         },
     };
 
-    // Upload the image data for each plane
+#if PL_API_VER >= 72
+    if (pic->film_grain != NULL)
+        PictureFilmGrain(&img, pic->film_grain);
+#endif
+
+    // Upload the image data for each plane, asynchronously from the mapped
+    // buffer when the picture comes from our pool
     struct pl_plane_data data[4];
-    if (!vlc_placebo_PlaneData(pic, data, NULL)) {
+    if (!vlc_placebo_PlaneData(pic, data, PictureBuf(sys, pic))) {
         // This should never happen, in theory
         assert(!"Failed processing the picture_t into pl_plane_data!?");
     }
@@ -330,9 +461,17 @@ done:
 
 static void PictureDisplay(vout_display_t *vd, picture_t *pic)
 {
-    VLC_UNUSED(pic);
     vout_display_sys_t *sys = vd->sys;
     pl_swapchain_swap_buffers(sys->vk->swapchain);
+
+    // The picture is handed back to the decoder once displayed, so make sure
+    // the GPU is done reading from its buffer before it gets overwritten
+    const struct pl_buf *buf = PictureBuf(sys, pic);
+    if (buf) {
+        const struct pl_gpu *gpu = sys->vk->vulkan->gpu;
+        while (pl_buf_poll(gpu, buf, UINT64_MAX))
+            ; // busy
+    }
 }
 
 static int Control(vout_display_t *vd, int query, va_list ap)
@@ -378,6 +517,7 @@ vlc_module_begin ()
     set_callback_display(Open, 0)
     add_shortcut ("vulkan", "vk")
     add_module ("vk", "vulkan", NULL, VK_TEXT, PROVIDER_LONGTEXT)
+    add_bool("vk-disable-dr", false, DISABLE_DR_TEXT, DISABLE_DR_LONGTEXT, true)
 
     set_section("Scaling", NULL)
     add_integer("upscaler-preset", SCALE_BUILTIN,
@@ -0,0 +1,434 @@
+/**
+ * @file dmabuf.c
+ * @brief Wayland DMA-BUF video output module for VLC media player
+ */
+/*****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wayland-client.h>
+#include "viewporter-client-protocol.h"
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_vout_display.h>
+#include <vlc_codec.h>
+
+#include <va/va_drmcommon.h>
+#include "../../hw/vaapi/vlc_vaapi.h"
+#include "presentation.h"
+
+/* Same values as the DRM formats, without requiring libdrm */
+#define WL_DMABUF_FORMAT_NV12 VLC_FOURCC('N','V','1','2')
+#define WL_DMABUF_FORMAT_P010 VLC_FOURCC('P','0','1','0')
+/* Layout implied by the buffer object (DRM_FORMAT_MOD_INVALID) */
+#define WL_DMABUF_MODIFIER_IMPLICIT UINT64_C(0x00ffffffffffffff)
+
+struct buffer_slot
+{
+    struct wl_buffer *buffer; /* NULL until first displayed */
+    picture_t *picture; /* held while the compositor uses the buffer */
+    size_t *counter;
+};
+
+struct vout_display_sys_t
+{
+    vout_window_t *embed; /* VLC window */
+    struct wl_event_queue *eventq;
+    struct zwp_linux_dmabuf_v1 *dmabuf;
+    struct wp_viewporter *viewporter;
+    struct wp_viewport *viewport;
+    struct vlc_wl_presentation presentation;
+
+    VADisplay vadpy;
+    vlc_decoder_device *dec_device;
+    uint32_t format;
+    bool has_format;
+
+    picture_pool_t *pool;
+    VASurfaceID *surface_ids;
+    struct buffer_slot *slots;
+    unsigned count;
+    size_t active_buffers;
+
+    int current; /* slot of the prepared picture */
+    vlc_tick_t date;
+};
+
+static void buffer_release_cb(void *data, struct wl_buffer *buffer)
+{
+    struct buffer_slot *slot = data;
+
+    if (slot->picture != NULL)
+    {
+        picture_Release(slot->picture);
+        slot->picture = NULL;
+        (*(slot->counter))--;
+    }
+    (void) buffer;
+}
+
+static const struct wl_buffer_listener buffer_cbs =
+{
+    buffer_release_cb,
+};
+
+static picture_pool_t *Pool(vout_display_t *vd, unsigned count)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    if (sys->pool != NULL)
+        return sys->pool;
+
+    sys->slots = calloc(count, sizeof (*sys->slots));
+    if (unlikely(sys->slots == NULL))
+        return NULL;
+
+    sys->pool = vlc_vaapi_PoolNew(VLC_OBJECT(vd), sys->dec_device, sys->vadpy,
+                                  count, &sys->surface_ids, &vd->fmt, true);
+    if (sys->pool == NULL)
+    {
+        free(sys->slots);
+        sys->slots = NULL;
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+        sys->slots[i].counter = &sys->active_buffers;
+    sys->count = count;
+    return sys->pool;
+}
+
+/* Shares the DRM PRIME buffer of a decoded surface with the compositor */
+static struct wl_buffer *ImportSurface(vout_display_t *vd, VASurfaceID surface)
+{
+    vout_display_sys_t *sys = vd->sys;
+    vlc_object_t *o = VLC_OBJECT(vd);
+    struct wl_buffer *buf = NULL;
+
+    VAImage va_image;
+    if (vlc_vaapi_DeriveImage(o, sys->vadpy, surface, &va_image))
+        return NULL;
+
+    VABufferInfo va_buffer_info = {
+        .mem_type = VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME
+    };
+    if (vlc_vaapi_AcquireBufferHandle(o, sys->vadpy, va_image.buf,
+                                      &va_buffer_info))
+        goto end;
+
+    struct zwp_linux_buffer_params_v1 *params =
+        zwp_linux_dmabuf_v1_create_params(sys->dmabuf);
+    if (params == NULL)
+        goto release;
+
+    /* The file descriptor is duplicated when the request is marshalled */
+    for (unsigned i = 0; i < va_image.num_planes; i++)
+        zwp_linux_buffer_params_v1_add(params, va_buffer_info.handle, i,
+                                       va_image.offsets[i],
+                                       va_image.pitches[i],
+                                       WL_DMABUF_MODIFIER_IMPLICIT >> 32,
+                                       WL_DMABUF_MODIFIER_IMPLICIT & 0xffffffff);
+
+    buf = zwp_linux_buffer_params_v1_create_immed(params, va_image.width,
+                                                  va_image.height,
+                                                  sys->format, 0);
+    zwp_linux_buffer_params_v1_destroy(params);
+    if (buf == NULL)
+        msg_Err(vd, "cannot share VA surface %u", (unsigned) surface);
+
+release:
+    vlc_vaapi_ReleaseBufferHandle(o, sys->vadpy, va_image.buf);
+end:
+    vlc_vaapi_DestroyImage(o, sys->vadpy, va_image.image_id);
+    return buf;
+}
+
+static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
+                    vlc_tick_t date)
+{
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *surface = sys->embed->handle.wl;
+    VASurfaceID va_surface = vlc_vaapi_PicGetSurface(pic);
+    unsigned idx;
+
+    sys->current = -1;
+    sys->date = date;
+
+    for (idx = 0; idx < sys->count; idx++)
+        if (sys->surface_ids[idx] == va_surface)
+            break;
+    if (idx == sys->count)
+    {
+        msg_Warn(vd, "VA surface %u not from our pool", (unsigned) va_surface);
+        return;
+    }
+
+    struct buffer_slot *slot = &sys->slots[idx];
+    if (slot->buffer == NULL)
+    {
+        slot->buffer = ImportSurface(vd, va_surface);
+        if (slot->buffer == NULL)
+            return;
+        wl_proxy_set_queue((struct wl_proxy *)slot->buffer, sys->eventq);
+        wl_buffer_add_listener(slot->buffer, &buffer_cbs, slot);
+    }
+
+    /* Keep the surface away from the decoder until the compositor is done */
+    if (slot->picture == NULL)
+    {
+        slot->picture = picture_Hold(pic);
+        sys->active_buffers++;
+    }
+
+    wl_surface_attach(surface, slot->buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, INT32_MAX, INT32_MAX);
+    wl_display_flush(display);
+    sys->current = idx;
+
+    (void) subpic;
+}
+
+static void Display(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *surface = sys->embed->handle.wl;
+
+    if (sys->current >= 0)
+    {
+        vlc_wl_presentation_Request(&sys->presentation, surface, sys->date);
+        wl_surface_commit(surface);
+    }
+    wl_display_roundtrip_queue(display, sys->eventq);
+
+    (void) pic;
+}
+
+static void ResetViewport(vout_display_t *vd, const vout_display_cfg_t *cfg)
+{
+    vout_display_sys_t *sys = vd->sys;
+    vout_display_place_t place;
+
+    vout_display_PlacePicture(&place, &vd->source, cfg);
+
+    wp_viewport_set_source(sys->viewport,
+                           wl_fixed_from_int(vd->source.i_x_offset),
+                           wl_fixed_from_int(vd->source.i_y_offset),
+                           wl_fixed_from_int(vd->source.i_visible_width),
+                           wl_fixed_from_int(vd->source.i_visible_height));
+    wp_viewport_set_destination(sys->viewport, place.width, place.height);
+}
+
+static int Control(vout_display_t *vd, int query, va_list ap)
+{
+    switch (query)
+    {
+        case VOUT_DISPLAY_CHANGE_DISPLAY_SIZE:
+        case VOUT_DISPLAY_CHANGE_DISPLAY_FILLED:
+        case VOUT_DISPLAY_CHANGE_ZOOM:
+        case VOUT_DISPLAY_CHANGE_SOURCE_ASPECT:
+        case VOUT_DISPLAY_CHANGE_SOURCE_CROP:
+            ResetViewport(vd, va_arg(ap, const vout_display_cfg_t *));
+            break;
+        default:
+             msg_Err(vd, "unknown request %d", query);
+             return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void dmabuf_format_cb(void *data, struct zwp_linux_dmabuf_v1 *dmabuf,
+                             uint32_t format)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    if (format == sys->format)
+        sys->has_format = true;
+    (void) dmabuf;
+}
+
+static void dmabuf_modifier_cb(void *data, struct zwp_linux_dmabuf_v1 *dmabuf,
+                               uint32_t format, uint32_t modifier_hi,
+                               uint32_t modifier_lo)
+{
+    dmabuf_format_cb(data, dmabuf, format);
+    (void) modifier_hi; (void) modifier_lo;
+}
+
+static const struct zwp_linux_dmabuf_v1_listener dmabuf_cbs =
+{
+    dmabuf_format_cb,
+    dmabuf_modifier_cb,
+};
+
+static void registry_global_cb(void *data, struct wl_registry *registry,
+                               uint32_t name, const char *iface, uint32_t vers)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    if (!strcmp(iface, "zwp_linux_dmabuf_v1"))
+        sys->dmabuf = wl_registry_bind(registry, name,
+                                       &zwp_linux_dmabuf_v1_interface,
+                                       vers < 3 ? vers : 3);
+    else
+    if (!strcmp(iface, "wp_viewporter"))
+        sys->viewporter = wl_registry_bind(registry, name,
+                                           &wp_viewporter_interface, 1);
+    else
+    if (!strcmp(iface, "wp_presentation"))
+        vlc_wl_presentation_Bind(&sys->presentation, registry, name);
+}
+
+static void registry_global_remove_cb(void *data, struct wl_registry *registry,
+                                      uint32_t name)
+{
+    (void) data; (void) registry; (void) name;
+}
+
+static const struct wl_registry_listener registry_cbs =
+{
+    registry_global_cb,
+    registry_global_remove_cb,
+};
+
+static void Close(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *surface = sys->embed->handle.wl;
+
+    wl_surface_attach(surface, NULL, 0, 0);
+    wl_surface_commit(surface);
+
+    /* Wait until all surfaces are released by the server */
+    while (sys->active_buffers > 0 || sys->presentation.pending > 0)
+        wl_display_roundtrip_queue(display, sys->eventq);
+
+    for (unsigned i = 0; i < sys->count; i++)
+        if (sys->slots[i].buffer != NULL)
+            wl_buffer_destroy(sys->slots[i].buffer);
+    free(sys->slots);
+    if (sys->pool != NULL)
+        picture_pool_Release(sys->pool);
+
+    vlc_wl_presentation_Destroy(&sys->presentation);
+    wp_viewport_destroy(sys->viewport);
+    wp_viewporter_destroy(sys->viewporter);
+    zwp_linux_dmabuf_v1_destroy(sys->dmabuf);
+    wl_display_flush(display);
+    wl_event_queue_destroy(sys->eventq);
+    free(sys);
+}
+
+static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
+                video_format_t *fmtp, vlc_video_context *context)
+{
+    if (cfg->window->type != VOUT_WINDOW_TYPE_WAYLAND)
+        return VLC_EGENERIC;
+    if (context == NULL || context->device == NULL
+     || context->device->type != VLC_DECODER_DEVICE_VAAPI
+     || !vlc_vaapi_IsChromaOpaque(fmtp->i_chroma))
+        return VLC_EGENERIC;
+
+    vout_display_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    vd->sys = sys;
+    sys->embed = cfg->window;
+    vlc_wl_presentation_Init(&sys->presentation, vd);
+    sys->vadpy = context->device->opaque;
+    sys->dec_device = context->device;
+    sys->format = fmtp->i_chroma == VLC_CODEC_VAAPI_420_10BPP
+                ? WL_DMABUF_FORMAT_P010 : WL_DMABUF_FORMAT_NV12;
+    sys->current = -1;
+
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *surface = sys->embed->handle.wl;
+
+    sys->eventq = wl_display_create_queue(display);
+    if (sys->eventq == NULL)
+        goto error;
+
+    struct wl_registry *registry = wl_display_get_registry(display);
+    if (registry == NULL)
+        goto error;
+
+    wl_proxy_set_queue((struct wl_proxy *)registry, sys->eventq);
+    wl_registry_add_listener(registry, &registry_cbs, vd);
+    wl_display_roundtrip_queue(display, sys->eventq);
+    wl_registry_destroy(registry);
+
+    /* The surfaces are shown at their native size, scaled by the viewport */
+    if (sys->dmabuf == NULL || sys->viewporter == NULL)
+        goto error;
+
+    zwp_linux_dmabuf_v1_add_listener(sys->dmabuf, &dmabuf_cbs, vd);
+    wl_display_roundtrip_queue(display, sys->eventq);
+
+    if (!sys->has_format)
+    {
+        msg_Dbg(vd, "compositor does not take %4.4s buffers",
+                (const char *)&sys->format);
+        goto error;
+    }
+
+    sys->viewport = wp_viewporter_get_viewport(sys->viewporter, surface);
+    if (sys->viewport == NULL)
+        goto error;
+    ResetViewport(vd, cfg);
+
+    vd->pool = Pool;
+    vd->prepare = Prepare;
+    vd->display = Display;
+    vd->control = Control;
+    vd->close = Close;
+    return VLC_SUCCESS;
+
+error:
+    vlc_wl_presentation_Destroy(&sys->presentation);
+    if (sys->viewporter != NULL)
+        wp_viewporter_destroy(sys->viewporter);
+    if (sys->dmabuf != NULL)
+        zwp_linux_dmabuf_v1_destroy(sys->dmabuf);
+    if (sys->eventq != NULL)
+        wl_event_queue_destroy(sys->eventq);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+vlc_module_begin()
+    set_shortname(N_("WL DMA-BUF"))
+    set_description(N_("Wayland DMA-BUF video output"))
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VOUT)
+    set_callback_display(Open, 180)
+    add_shortcut("wl_dmabuf")
+vlc_module_end()
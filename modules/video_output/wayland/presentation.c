@@ -0,0 +1,158 @@
+/**
+ * @file presentation.c
+ * @brief Wayland presentation time feedback for VLC media player
+ */
+/*****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <wayland-client.h>
+#include "presentation-time-client-protocol.h"
+
+#include <vlc_common.h>
+#include <vlc_vout_display.h>
+
+#include "presentation.h"
+
+struct feedback_data
+{
+    struct vlc_wl_presentation *p;
+    vlc_tick_t date;
+};
+
+static void clock_id_cb(void *data, struct wp_presentation *presentation,
+                        uint32_t clock)
+{
+    struct vlc_wl_presentation *p = data;
+
+    /* vlc_tick_now() runs on the monotonic clock */
+    p->same_clock = clock == CLOCK_MONOTONIC;
+    if (!p->same_clock)
+        msg_Dbg(p->vd, "presentation clock %"PRIu32" not usable", clock);
+    (void) presentation;
+}
+
+static const struct wp_presentation_listener presentation_cbs =
+{
+    clock_id_cb,
+};
+
+static void feedback_sync_output_cb(void *data,
+                                    struct wp_presentation_feedback *fb,
+                                    struct wl_output *output)
+{
+    (void) data; (void) fb; (void) output;
+}
+
+static void feedback_presented_cb(void *data,
+                                  struct wp_presentation_feedback *fb,
+                                  uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                                  uint32_t tv_nsec, uint32_t refresh,
+                                  uint32_t seq_hi, uint32_t seq_lo,
+                                  uint32_t flags)
+{
+    struct feedback_data *d = data;
+    struct vlc_wl_presentation *p = d->p;
+
+    if (p->same_clock)
+    {
+        const uint64_t sec = ((uint64_t)tv_sec_hi << 32) | tv_sec_lo;
+        const vlc_tick_t date = vlc_tick_from_sec(sec)
+                              + VLC_TICK_FROM_NS(tv_nsec);
+
+        vout_display_SendEventPresented(p->vd, d->date, date,
+                                        VLC_TICK_FROM_NS(refresh));
+    }
+
+    p->pending--;
+    free(d);
+    wp_presentation_feedback_destroy(fb);
+    (void) seq_hi; (void) seq_lo; (void) flags;
+}
+
+static void feedback_discarded_cb(void *data,
+                                  struct wp_presentation_feedback *fb)
+{
+    struct feedback_data *d = data;
+
+    d->p->pending--;
+    free(d);
+    wp_presentation_feedback_destroy(fb);
+}
+
+static const struct wp_presentation_feedback_listener feedback_cbs =
+{
+    feedback_sync_output_cb,
+    feedback_presented_cb,
+    feedback_discarded_cb,
+};
+
+void vlc_wl_presentation_Init(struct vlc_wl_presentation *p,
+                              vout_display_t *vd)
+{
+    p->vd = vd;
+    p->presentation = NULL;
+    p->same_clock = false;
+    p->pending = 0;
+}
+
+void vlc_wl_presentation_Bind(struct vlc_wl_presentation *p,
+                              struct wl_registry *registry, uint32_t name)
+{
+    p->presentation = wl_registry_bind(registry, name,
+                                       &wp_presentation_interface, 1);
+    if (p->presentation != NULL)
+        wp_presentation_add_listener(p->presentation, &presentation_cbs, p);
+}
+
+void vlc_wl_presentation_Request(struct vlc_wl_presentation *p,
+                                 struct wl_surface *surface, vlc_tick_t date)
+{
+    if (p->presentation == NULL || !p->same_clock)
+        return;
+
+    struct feedback_data *d = malloc(sizeof (*d));
+    if (unlikely(d == NULL))
+        return;
+
+    d->p = p;
+    d->date = date;
+
+    struct wp_presentation_feedback *fb =
+        wp_presentation_feedback(p->presentation, surface);
+    if (fb == NULL)
+    {
+        free(d);
+        return;
+    }
+
+    wp_presentation_feedback_add_listener(fb, &feedback_cbs, d);
+    p->pending++;
+}
+
+void vlc_wl_presentation_Destroy(struct vlc_wl_presentation *p)
+{
+    if (p->presentation != NULL)
+        wp_presentation_destroy(p->presentation);
+}
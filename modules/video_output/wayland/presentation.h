@@ -0,0 +1,59 @@
+/**
+ * @file presentation.h
+ * @brief Wayland presentation time feedback for VLC media player
+ */
+/*****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+struct wl_registry;
+struct wl_surface;
+struct wp_presentation;
+
+struct vlc_wl_presentation
+{
+    vout_display_t *vd;
+    struct wp_presentation *presentation;
+    bool same_clock; /* compositor clock is the VLC clock */
+    size_t pending; /* feedback not received yet */
+};
+
+void vlc_wl_presentation_Init(struct vlc_wl_presentation *,
+                              vout_display_t *vd);
+
+/**
+ * Binds the presentation global, from the registry global event.
+ */
+void vlc_wl_presentation_Bind(struct vlc_wl_presentation *,
+                              struct wl_registry *, uint32_t name);
+
+/**
+ * Requests feedback for the next commit of the surface.
+ *
+ * The display owner is notified when the surface content is shown.
+ *
+ * @param date date the content is expected to be shown at
+ */
+void vlc_wl_presentation_Request(struct vlc_wl_presentation *,
+                                 struct wl_surface *, vlc_tick_t date);
+
+/**
+ * Releases the presentation global.
+ *
+ * All pending feedback must have been received, or the surface destroyed.
+ */
+void vlc_wl_presentation_Destroy(struct vlc_wl_presentation *);
@@ -41,6 +41,8 @@
 #include <vlc_vout_display.h>
 #include <vlc_fs.h>
 
+#include "presentation.h"
+
 #define MAX_PICTURES 4
 
 struct vout_display_sys_t
@@ -51,6 +53,9 @@ struct vout_display_sys_t
     struct wp_viewporter *viewporter;
     struct wp_viewport *viewport;
 
+    struct vlc_wl_presentation presentation;
+    vlc_tick_t date; /* of the prepared picture */
+
     size_t active_buffers;
 
     unsigned display_width;
@@ -85,12 +90,12 @@ static const struct wl_buffer_listener buffer_cbs =
 static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
                     vlc_tick_t date)
 {
-    VLC_UNUSED(date);
     vout_display_sys_t *sys = vd->sys;
     struct wl_display *display = sys->embed->display.wl;
     struct wl_surface *surface = sys->embed->handle.wl;
     struct picture_buffer_t *picbuf = pic->p_sys;
 
+    sys->date = date;
     if (picbuf->fd == -1)
         return;
 
@@ -146,6 +151,7 @@ static void Display(vout_display_t *vd, picture_t *pic)
     struct wl_display *display = sys->embed->display.wl;
     struct wl_surface *surface = sys->embed->handle.wl;
 
+    vlc_wl_presentation_Request(&sys->presentation, surface, sys->date);
     wl_surface_commit(surface);
     wl_display_roundtrip_queue(display, sys->eventq);
 
@@ -253,6 +259,9 @@ static void registry_global_cb(void *data, struct wl_registry *registry,
         sys->viewporter = wl_registry_bind(registry, name,
                                            &wp_viewporter_interface, 1);
     else
+    if (!strcmp(iface, "wp_presentation"))
+        vlc_wl_presentation_Bind(&sys->presentation, registry, name);
+    else
     if (!strcmp(iface, "wl_compositor"))
         sys->use_buffer_transform = vers >= 2;
 }
@@ -282,12 +291,13 @@ static void Close(vout_display_t *vd)
     wl_surface_commit(surface);
 
     /* Wait until all picture buffers are released by the server */
-    while (sys->active_buffers > 0) {
+    while (sys->active_buffers > 0 || sys->presentation.pending > 0) {
         msg_Dbg(vd, "%zu buffer(s) still active", sys->active_buffers);
         wl_display_roundtrip_queue(display, sys->eventq);
     }
     msg_Dbg(vd, "no active buffers left");
 
+    vlc_wl_presentation_Destroy(&sys->presentation);
     if (sys->viewport != NULL)
         wp_viewport_destroy(sys->viewport);
     if (sys->viewporter != NULL)
@@ -313,6 +323,8 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     sys->eventq = NULL;
     sys->shm = NULL;
     sys->viewporter = NULL;
+    vlc_wl_presentation_Init(&sys->presentation, vd);
+    sys->date = VLC_TICK_INVALID;
     sys->active_buffers = 0;
     sys->display_width = cfg->display.width;
     sys->display_height = cfg->display.height;
@@ -383,6 +395,7 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     return VLC_SUCCESS;
 
 error:
+    vlc_wl_presentation_Destroy(&sys->presentation);
     if (sys->viewporter != NULL)
         wp_viewporter_destroy(sys->viewporter);
 
@@ -57,6 +57,13 @@ typedef picture_sys_d3d11_t VA_PICSYS;
 #include "d3d11_quad.h"
 #include "d3d11_shaders.h"
 #include "d3d11_swapchain.h"
+#include "../../hw/d3d11/d3d11_processor.h"
+
+#ifdef ID3D11VideoContext_VideoProcessorBlt
+#define CAN_PROCESSOR 1
+#else
+#define CAN_PROCESSOR 0
+#endif
 
 #include "common.h"
 #include "../../video_chroma/copy.h"
@@ -69,6 +76,10 @@ static void Close(vout_display_t *);
 #define HW_BLENDING_TEXT N_("Use hardware blending support")
 #define HW_BLENDING_LONGTEXT N_(\
     "Try to use hardware acceleration for subtitle/OSD blending.")
+#define VIDEO_PROCESSOR_TEXT N_("Render with the video processor")
+#define VIDEO_PROCESSOR_LONGTEXT N_(\
+    "Scale, convert and deinterlace hardware decoded SDR pictures into the " \
+    "back buffer with the GPU video processor instead of pixel shaders.")
 
 vlc_module_begin ()
     set_shortname("Direct3D11")
@@ -78,6 +89,9 @@ vlc_module_begin ()
     set_subcategory(SUBCAT_VIDEO_VOUT)
 
     add_bool("direct3d11-hw-blending", true, HW_BLENDING_TEXT, HW_BLENDING_LONGTEXT, true)
+#if CAN_PROCESSOR
+    add_bool("direct3d11-video-processor", false, VIDEO_PROCESSOR_TEXT, VIDEO_PROCESSOR_LONGTEXT, true)
+#endif
 
 #if VLC_WINSTORE_APP
     add_integer("winrt-swapchain",     0x0, NULL, NULL, true) /* IDXGISwapChain1*     */
@@ -114,6 +128,14 @@ struct vout_display_sys_t
      * Uses a Texture2D with slices rather than a Texture2DArray for the decoder */
     bool                     legacy_shader;
 
+#if CAN_PROCESSOR
+    /* VideoProcessorBlt straight into the render target */
+    bool                           use_processor;
+    d3d11_processor_t              processor;
+    ID3D11Resource                 *processorTarget;
+    ID3D11VideoProcessorOutputView *processorOutput;
+#endif
+
     // SPU
     vlc_fourcc_t             pSubpictureChromas[2];
     d3d_quad_t               regionQuad;
@@ -629,6 +651,210 @@ static bool SelectRenderPlane(void *opaque, size_t plane)
     return sys->selectPlaneCb(sys->outside_opaque, plane);
 }
 
+#if CAN_PROCESSOR
+static void ReleaseProcessorOutput(vout_display_sys_t *sys)
+{
+    if (sys->processorOutput)
+    {
+        ID3D11VideoProcessorOutputView_Release(sys->processorOutput);
+        sys->processorOutput = NULL;
+    }
+    if (sys->processorTarget)
+    {
+        ID3D11Resource_Release(sys->processorTarget);
+        sys->processorTarget = NULL;
+    }
+}
+
+static void ReleaseProcessor(vout_display_sys_t *sys)
+{
+    ReleaseProcessorOutput(sys);
+    D3D11_ReleaseProcessor(&sys->processor);
+}
+
+static int SetupProcessor(vout_display_t *vd, DXGI_FORMAT outFormat)
+{
+    vout_display_sys_t *sys = vd->sys;
+    video_format_t fmt_out = vd->source;
+    HRESULT hr;
+
+    fmt_out.i_width  = fmt_out.i_visible_width  = sys->area.vdcfg.display.width;
+    fmt_out.i_height = fmt_out.i_visible_height = sys->area.vdcfg.display.height;
+
+    /* interlaced input also handles progressive pictures */
+    if (D3D11_CreateProcessor(vd, &sys->d3d_dev,
+                              D3D11_VIDEO_FRAME_FORMAT_INTERLACED_TOP_FIELD_FIRST,
+                              &vd->source, &fmt_out, &sys->processor) != VLC_SUCCESS)
+        return VLC_EGENERIC;
+
+    UINT flags;
+    hr = ID3D11VideoProcessorEnumerator_CheckVideoProcessorFormat(sys->processor.procEnumerator,
+                                    sys->picQuad.textureFormat->formatTexture, &flags);
+    if (FAILED(hr) || !(flags & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_INPUT))
+    {
+        msg_Dbg(vd, "processor format %s not supported for input",
+                DxgiFormatToStr(sys->picQuad.textureFormat->formatTexture));
+        goto error;
+    }
+    hr = ID3D11VideoProcessorEnumerator_CheckVideoProcessorFormat(sys->processor.procEnumerator,
+                                                                  outFormat, &flags);
+    if (FAILED(hr) || !(flags & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_OUTPUT))
+    {
+        msg_Dbg(vd, "processor format %s not supported for output",
+                DxgiFormatToStr(outFormat));
+        goto error;
+    }
+
+    /* the first rate conversion is the best deinterlacing available */
+    hr = ID3D11VideoDevice_CreateVideoProcessor(sys->processor.d3dviddev,
+                                                sys->processor.procEnumerator, 0,
+                                                &sys->processor.videoProcessor);
+    if (FAILED(hr))
+    {
+        msg_Dbg(vd, "Failed to create the video processor. (hr=0x%lX)", hr);
+        goto error;
+    }
+
+    D3D11_VIDEO_PROCESSOR_COLOR_SPACE colorspace = {
+        .RGB_Range     = sys->display.b_full_range ? 0 : 1,
+    };
+    ID3D11VideoContext_VideoProcessorSetOutputColorSpace(sys->processor.d3dvidctx,
+                                                         sys->processor.videoProcessor,
+                                                         &colorspace);
+
+    colorspace = (D3D11_VIDEO_PROCESSOR_COLOR_SPACE) {
+        .YCbCr_Matrix  = vd->source.space == COLOR_SPACE_BT601 ? 0 : 1,
+        .Nominal_Range = vd->source.color_range == COLOR_RANGE_FULL ?
+                         D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_0_255 :
+                         D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235,
+    };
+    ID3D11VideoContext_VideoProcessorSetStreamColorSpace(sys->processor.d3dvidctx,
+                                                         sys->processor.videoProcessor,
+                                                         0, &colorspace);
+
+    /* the processor fills around the picture */
+    D3D11_VIDEO_COLOR black = { .RGBA = { .A = 1.f } };
+    ID3D11VideoContext_VideoProcessorSetOutputBackgroundColor(sys->processor.d3dvidctx,
+                                                              sys->processor.videoProcessor,
+                                                              FALSE, &black);
+
+    msg_Dbg(vd, "rendering with the video processor");
+    return VLC_SUCCESS;
+error:
+    D3D11_ReleaseProcessor(&sys->processor);
+    return VLC_EGENERIC;
+}
+
+/* Blits the decoded picture into the current render target, replacing the
+ * pixel shader pass. Returns false to fall back to the shaders. */
+static bool ProcessorRender(vout_display_t *vd, picture_t *picture)
+{
+    vout_display_sys_t *sys = vd->sys;
+    picture_sys_d3d11_t *p_sys = ActivePictureSys(picture);
+    HRESULT hr;
+
+    if (!sys->selectPlaneCb(sys->outside_opaque, 0))
+        return false;
+
+    /* the render target may be ours or the host application one */
+    ID3D11RenderTargetView *rtv = NULL;
+    ID3D11DeviceContext_OMGetRenderTargets(sys->d3d_dev.d3dcontext, 1, &rtv, NULL);
+    if (rtv == NULL)
+        return false;
+
+    ID3D11Resource *target;
+    ID3D11RenderTargetView_GetResource(rtv, &target);
+    ID3D11RenderTargetView_Release(rtv);
+
+    if (target != sys->processorTarget)
+    {
+        ReleaseProcessorOutput(sys);
+        sys->processorTarget = target;
+
+        if (sys->processor.videoProcessor == NULL)
+        {
+            ID3D11Texture2D *texture;
+            hr = ID3D11Resource_QueryInterface(target, &IID_ID3D11Texture2D, (void **)&texture);
+            if (FAILED(hr))
+                goto disable;
+            D3D11_TEXTURE2D_DESC texDesc;
+            ID3D11Texture2D_GetDesc(texture, &texDesc);
+            ID3D11Texture2D_Release(texture);
+
+            if (SetupProcessor(vd, texDesc.Format) != VLC_SUCCESS)
+                goto disable;
+        }
+
+        D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outDesc = {
+            .ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D,
+        };
+        hr = ID3D11VideoDevice_CreateVideoProcessorOutputView(sys->processor.d3dviddev,
+                                                              target,
+                                                              sys->processor.procEnumerator,
+                                                              &outDesc,
+                                                              &sys->processorOutput);
+        if (FAILED(hr))
+        {
+            msg_Err(vd, "Failed to create the processor output. (hr=0x%lX)", hr);
+            goto disable;
+        }
+    }
+    else
+        ID3D11Resource_Release(target);
+
+    if (unlikely(p_sys == NULL) ||
+        FAILED(D3D11_Assert_ProcessorInput(vd, &sys->processor, p_sys)))
+        return false;
+
+    D3D11_VIDEO_FRAME_FORMAT frameFormat = picture->b_progressive ?
+                D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE :
+                picture->b_top_field_first ?
+                D3D11_VIDEO_FRAME_FORMAT_INTERLACED_TOP_FIELD_FIRST :
+                D3D11_VIDEO_FRAME_FORMAT_INTERLACED_BOTTOM_FIELD_FIRST;
+    ID3D11VideoContext_VideoProcessorSetStreamFrameFormat(sys->processor.d3dvidctx,
+                                                          sys->processor.videoProcessor,
+                                                          0, frameFormat);
+
+    RECT srcRect = {
+        .left   = picture->format.i_x_offset,
+        .top    = picture->format.i_y_offset,
+        .right  = picture->format.i_x_offset + picture->format.i_visible_width,
+        .bottom = picture->format.i_y_offset + picture->format.i_visible_height,
+    };
+    RECT dstRect = {
+        .left   = sys->area.place.x,
+        .top    = sys->area.place.y,
+        .right  = sys->area.place.x + sys->area.place.width,
+        .bottom = sys->area.place.y + sys->area.place.height,
+    };
+    ID3D11VideoContext_VideoProcessorSetStreamSourceRect(sys->processor.d3dvidctx,
+                                                         sys->processor.videoProcessor,
+                                                         0, TRUE, &srcRect);
+    ID3D11VideoContext_VideoProcessorSetStreamDestRect(sys->processor.d3dvidctx,
+                                                       sys->processor.videoProcessor,
+                                                       0, TRUE, &dstRect);
+
+    D3D11_VIDEO_PROCESSOR_STREAM stream = {
+        .Enable = TRUE,
+        .pInputSurface = p_sys->processorInput,
+    };
+    hr = ID3D11VideoContext_VideoProcessorBlt(sys->processor.d3dvidctx,
+                                              sys->processor.videoProcessor,
+                                              sys->processorOutput, 0, 1, &stream);
+    if (FAILED(hr))
+    {
+        msg_Err(vd, "Failed to process the video. (hr=0x%lX)", hr);
+        goto disable;
+    }
+    return true;
+
+disable:
+    ReleaseProcessor(sys);
+    sys->use_processor = false;
+    return false;
+}
+#endif
+
 static void PreparePicture(vout_display_t *vd, picture_t *picture, subpicture_t *subpicture)
 {
     vout_display_sys_t *sys = vd->sys;
@@ -756,6 +982,9 @@ static void PreparePicture(vout_display_t *vd, picture_t *picture, subpicture_t
         picture_sys_d3d11_t *p_sys = ActivePictureSys(picture);
         renderSrc = p_sys->renderSrc;
     }
+#if CAN_PROCESSOR
+    if (!sys->use_processor || !ProcessorRender(vd, picture))
+#endif
     D3D11_RenderQuad(&sys->d3d_dev, &sys->picQuad,
                      vd->source.projection_mode == PROJECTION_MODE_RECTANGULAR ? &sys->flatVShader : &sys->projectionVShader,
                      renderSrc, SelectRenderPlane, sys);
@@ -1146,6 +1375,19 @@ static int Direct3D11CreateFormatResources(vout_display_t *vd, const video_forma
     sys->legacy_shader = sys->d3d_dev.feature_level < D3D_FEATURE_LEVEL_10_0 || !CanUseTextureArray(vd) ||
             BogusZeroCopy(vd);
 
+#if CAN_PROCESSOR
+    ReleaseProcessor(sys);
+    /* the processor does not tone map nor project */
+    sys->use_processor = var_InheritBool(vd, "direct3d11-video-processor") &&
+            is_d3d11_opaque(fmt->i_chroma) && !sys->legacy_shader &&
+            vd->source.projection_mode == PROJECTION_MODE_RECTANGULAR &&
+            vd->source.orientation == ORIENT_NORMAL &&
+            fmt->transfer != TRANSFER_FUNC_SMPTE_ST2084 &&
+            fmt->transfer != TRANSFER_FUNC_HLG &&
+            sys->display.transfer != TRANSFER_FUNC_SMPTE_ST2084 &&
+            sys->display.transfer != TRANSFER_FUNC_HLG;
+#endif
+
     hr = D3D11_CompilePixelShader(vd, &sys->hd3d, sys->legacy_shader, &sys->d3d_dev,
                                   &sys->display, fmt->transfer, fmt->primaries,
                                   fmt->color_range == COLOR_RANGE_FULL,
@@ -1307,6 +1549,9 @@ static void Direct3D11DestroyResources(vout_display_t *vd)
 
     Direct3D11DestroyPool(vd);
 
+#if CAN_PROCESSOR
+    ReleaseProcessor(sys);
+#endif
     D3D11_ReleaseQuad(&sys->picQuad);
     Direct3D11DeleteRegions(sys->d3dregion_count, sys->d3dregions);
     sys->d3dregion_count = 0;
@@ -248,16 +248,51 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
-static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
+static void ViewDestroy( picture_t *p_view )
 {
-    video_splitter_sys_t *p_sys = p_splitter->p_sys;
+    picture_Release( p_view->p_sys );
+}
+
+/**
+ * Creates a picture referring to a region of the source picture pixels.
+ * The source is held until the view is released.
+ */
+static picture_t *ViewNew( const video_format_t *p_fmt, picture_t *p_src,
+                           const wall_output_t *p_output )
+{
+    picture_resource_t res = {
+        .p_sys = p_src,
+        .pf_destroy = ViewDestroy,
+    };
+    const plane_t *p0 = &p_src->p[0];
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
+    for( int i = 0; i < p_src->i_planes; i++ )
     {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
+        const plane_t *p = &p_src->p[i];
+        const int i_y = p_output->i_top * p->i_visible_lines / p0->i_visible_lines;
+        const int i_x = p_output->i_left * p->i_visible_pitch
+                        / p0->i_visible_pitch * p0->i_pixel_pitch;
+
+        res.p[i].p_pixels = p->p_pixels + i_y * p->i_pitch
+                          + ( i_x - (i_x % p->i_pixel_pitch) );
+        res.p[i].i_lines = p->i_lines - i_y;
+        res.p[i].i_pitch = p->i_pitch;
     }
 
+    picture_t *p_view = picture_NewFromResource( p_fmt, &res );
+    if( p_view != NULL )
+    {
+        picture_Hold( p_src );
+        picture_CopyProperties( p_view, p_src );
+    }
+    return p_view;
+}
+
+static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
+{
+    video_splitter_sys_t *p_sys = p_splitter->p_sys;
+
+    /* No copy: each output is a view on its region of the source */
     for( int y = 0; y < p_sys->i_row; y++ )
     {
         for( int x = 0; x < p_sys->i_col; x++ )
@@ -266,20 +301,17 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
-            picture_t *p_dst = pp_dst[p_output->i_output];
-
-            /* */
-            picture_t tmp = *p_src;
-            for( int i = 0; i < tmp.i_planes; i++ )
+            const int i_index = p_output->i_output;
+            picture_t *p_dst = ViewNew( &p_splitter->p_output[i_index].fmt,
+                                        p_src, p_output );
+            if( p_dst == NULL )
             {
-                plane_t *p0 = &tmp.p[0];
-                plane_t *p = &tmp.p[i];
-                const int i_y = p_output->i_top  * p->i_visible_pitch / p0->i_visible_pitch;
-                const int i_x = p_output->i_left * p->i_visible_lines / p0->i_visible_lines;
-
-                p->p_pixels += i_y * p->i_pitch + ( i_x - (i_x % p->i_pixel_pitch));
+                for( int i = 0; i < i_index; i++ )
+                    picture_Release( pp_dst[i] );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
             }
-            picture_Copy( p_dst, &tmp );
+            pp_dst[i_index] = p_dst;
         }
     }
 
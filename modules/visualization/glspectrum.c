@@ -42,8 +42,7 @@
 
 #include <math.h>
 
-#include "visual/fft.h"
-#include "visual/window.h"
+#include "visual/spectrum.h"
 
 
 /*****************************************************************************
@@ -83,8 +82,6 @@ typedef struct
     /* Audio data */
     unsigned i_channels;
     block_fifo_t    *fifo;
-    unsigned i_prev_nb_samples;
-    int16_t *p_prev_s16_buff;
 
     /* Opengl */
     vlc_gl_t *gl;
@@ -92,8 +89,8 @@ typedef struct
     float f_rotationAngle;
     float f_rotationIncrement;
 
-    /* FFT window parameters */
-    window_param wind_param;
+    /* Spectrum analysis */
+    visual_spectrum_t *spectrum;
 } filter_sys_t;
 
 
@@ -105,6 +102,9 @@ static void *Thread(void *);
 #define ROTATION_INCREMENT .1f
 #define BAR_DECREMENT .075f
 #define ROTATION_MAX 20
+/* Buffers waiting for the rendering thread, beyond which new buffers are not
+ * visualized, rather than delaying the audio thread */
+#define MAX_QUEUED_BLOCKS 8
 
 const GLfloat lightZeroColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
 const GLfloat lightZeroPosition[] = {0.0f, 3.0f, 10.0f, 0.0f};
@@ -125,19 +125,22 @@ static int Open(vlc_object_t * p_this)
 
     /* Create the object for the thread */
     p_sys->i_channels = aout_FormatNbChannels(&p_filter->fmt_in.audio);
-    p_sys->i_prev_nb_samples = 0;
-    p_sys->p_prev_s16_buff = NULL;
 
     p_sys->f_rotationAngle = 0;
     p_sys->f_rotationIncrement = ROTATION_INCREMENT;
 
-    /* Fetch the FFT window parameters */
-    window_get_param( VLC_OBJECT( p_filter ), &p_sys->wind_param );
+    /* Create the spectrum analyser, with the FFT window parameters */
+    p_sys->spectrum = visual_spectrum_New(p_this);
+    if (p_sys->spectrum == NULL)
+        goto error;
 
     /* Create the FIFO for the audio data. */
     p_sys->fifo = block_FifoNew();
     if (p_sys->fifo == NULL)
+    {
+        visual_spectrum_Delete(p_sys->spectrum);
         goto error;
+    }
 
     /* Create the openGL provider */
     vout_window_cfg_t cfg = {
@@ -149,13 +152,19 @@ static int Open(vlc_object_t * p_this)
     if (p_sys->gl == NULL)
     {
         block_FifoRelease(p_sys->fifo);
+        visual_spectrum_Delete(p_sys->spectrum);
         goto error;
     }
 
     /* Create the thread */
     if (vlc_clone(&p_sys->thread, Thread, p_filter,
                   VLC_THREAD_PRIORITY_VIDEO))
+    {
+        vlc_gl_surface_Destroy(p_sys->gl);
+        block_FifoRelease(p_sys->fifo);
+        visual_spectrum_Delete(p_sys->spectrum);
         goto error;
+    }
 
     p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
@@ -185,7 +194,7 @@ static void Close(vlc_object_t *p_this)
     /* Free the ressources */
     vlc_gl_surface_Destroy(p_sys->gl);
     block_FifoRelease(p_sys->fifo);
-    free(p_sys->p_prev_s16_buff);
+    visual_spectrum_Delete(p_sys->spectrum);
     free(p_sys);
 }
 
@@ -197,10 +206,17 @@ static void Close(vlc_object_t *p_this)
  */
 static block_t *DoWork(filter_t *p_filter, block_t *p_in_buf)
 {
-    block_t *block = block_Duplicate(p_in_buf);
     filter_sys_t *p_sys = p_filter->p_sys;
-    if (likely(block != NULL))
-        block_FifoPut(p_sys->fifo, block);
+
+    /* Never wait for the rendering: skip the buffer if it is late */
+    vlc_fifo_Lock(p_sys->fifo);
+    if (vlc_fifo_GetCount(p_sys->fifo) < MAX_QUEUED_BLOCKS)
+    {
+        block_t *block = block_Duplicate(p_in_buf);
+        if (likely(block != NULL))
+            vlc_fifo_QueueUnlocked(p_sys->fifo, block);
+    }
+    vlc_fifo_Unlock(p_sys->fifo);
     return p_in_buf;
 }
 
@@ -375,77 +391,17 @@ static void *Thread( void *p_data )
         const unsigned xscale[] = {0,1,2,3,4,5,6,7,8,11,15,20,27,
                                    36,47,62,82,107,141,184,255};
 
-        fft_state *p_state = NULL; /* internal FFT data */
-        DEFINE_WIND_CONTEXT(wind_ctx); /* internal window data */
-
         unsigned i, j;
-        float p_output[FFT_BUFFER_SIZE];           /* Raw FFT Result  */
-        int16_t p_buffer1[FFT_BUFFER_SIZE];        /* Buffer on which we perform
-                                                      the FFT (first channel) */
         int16_t p_dest[FFT_BUFFER_SIZE];           /* Adapted FFT result */
-        float *p_buffl = (float*)block->p_buffer;  /* Original buffer */
-
-        int16_t  *p_buffs;                         /* int16_t converted buffer */
-        int16_t  *p_s16_buff;                      /* int16_t converted buffer */
 
-        if (!block->i_nb_samples) {
+        visual_spectrum_Reset(p_sys->spectrum);
+        const float *p_output = visual_spectrum_Get(p_sys->spectrum, block,
+                                                    p_sys->i_channels);
+        if (p_output == NULL) {
             msg_Err(p_filter, "no samples yet");
             goto release;
         }
 
-        /* Allocate the buffer only if the number of samples change */
-        if (block->i_nb_samples != p_sys->i_prev_nb_samples)
-        {
-            free(p_sys->p_prev_s16_buff);
-            p_sys->p_prev_s16_buff = malloc(block->i_nb_samples *
-                                            p_sys->i_channels *
-                                            sizeof(int16_t));
-            if (!p_sys->p_prev_s16_buff)
-                goto release;
-            p_sys->i_prev_nb_samples = block->i_nb_samples;
-        }
-        p_buffs = p_s16_buff = p_sys->p_prev_s16_buff;
-
-        /* Convert the buffer to int16_t
-           Pasted from float32tos16.c */
-        for (i = block->i_nb_samples * p_sys->i_channels; i--;)
-        {
-            union {float f; int32_t i;} u;
-
-            u.f = *p_buffl + 384.f;
-            if (u.i > 0x43c07fff)
-                *p_buffs = 32767;
-            else if (u.i < 0x43bf8000)
-                *p_buffs = -32768;
-            else
-                *p_buffs = u.i - 0x43c00000;
-
-            p_buffl++; p_buffs++;
-        }
-        p_state = visual_fft_init();
-        if (!p_state)
-        {
-            msg_Err(p_filter,"unable to initialize FFT transform");
-            goto release;
-        }
-        if (!window_init(FFT_BUFFER_SIZE, &p_sys->wind_param, &wind_ctx))
-        {
-            msg_Err(p_filter,"unable to initialize FFT window");
-            goto release;
-        }
-        p_buffs = p_s16_buff;
-        for (i = 0 ; i < FFT_BUFFER_SIZE; i++)
-        {
-            p_output[i] = 0;
-            p_buffer1[i] = *p_buffs;
-
-            p_buffs += p_sys->i_channels;
-            if (p_buffs >= &p_s16_buff[block->i_nb_samples * p_sys->i_channels])
-                p_buffs = p_s16_buff;
-        }
-        window_scale_in_place (p_buffer1, &wind_ctx);
-        fft_perform (p_buffer1, p_output, p_state);
-
         for (i = 0; i< FFT_BUFFER_SIZE; ++i)
             p_dest[i] = p_output[i] *  (2 ^ 16)
                         / ((FFT_BUFFER_SIZE / 2 * 32768) ^ 2);
@@ -491,8 +447,6 @@ static void *Thread( void *p_data )
         vlc_gl_Swap(gl);
 
 release:
-        window_close(&wind_ctx);
-        fft_close(p_state);
         vlc_gl_ReleaseCurrent(gl);
         block_Release(block);
         vlc_restorecancel(canc);
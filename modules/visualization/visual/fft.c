@@ -34,14 +34,17 @@
  #endif
 #endif
 
+#define FFT_HALF_SIZE (FFT_BUFFER_SIZE / 2)
+
 /******************************************************************************
  * Local prototypes
  *****************************************************************************/
-static void fft_prepare(const sound_sample *input, float * re, float * im,
+static void fft_prepare(const float *input, float * re, float * im,
                         const unsigned int *bitReverse);
-static void fft_calculate(float * re, float * im,
+static void fft_calculate(float *restrict re, float *restrict im,
                           const float *costable, const float *sintable );
-static void fft_output(const float *re, const float *im, float *output);
+static void fft_output(const float *re, const float *im, float *output,
+                       const float *splitcos, const float *splitsin);
 static int reverseBits(unsigned int initial);
 
 /*****************************************************************************
@@ -57,36 +60,50 @@ static int reverseBits(unsigned int initial);
 fft_state *visual_fft_init(void)
 {
     fft_state *p_state;
-    unsigned int i;
+    unsigned int i, n;
 
     p_state = malloc( sizeof(*p_state) );
     if(! p_state )
         return NULL;
 
-    for(i = 0; i < FFT_BUFFER_SIZE; i++)
+    for(i = 0; i < FFT_HALF_SIZE; i++)
     {
         p_state->bitReverse[i] = reverseBits(i);
     }
-    for(i = 0; i < FFT_BUFFER_SIZE / 2; i++)
+    p_state->costable[0] = 1;
+    p_state->sintable[0] = 0;
+    for(n = 1; n < FFT_HALF_SIZE; n <<= 1)
+    {
+        for(i = 0; i < n; i++)
+        {
+            float j = PI * i / n;
+            p_state->costable[n + i] = cos(j);
+            p_state->sintable[n + i] = sin(j);
+        }
+    }
+    for(i = 0; i <= FFT_HALF_SIZE; i++)
     {
         float j = 2 * PI * i / FFT_BUFFER_SIZE;
-        p_state->costable[i] = cos(j);
-        p_state->sintable[i] = sin(j);
+        p_state->splitcos[i] = cos(j);
+        p_state->splitsin[i] = sin(j);
     }
 
     return p_state;
 }
 
 /*
- * Do all the steps of the FFT, taking as input sound data (as described in
- * sound.h) and returning the intensities of each frequency as floats in the
- * range 0 to ((FFT_BUFFER_SIZE / 2) * 32768) ^ 2
+ * Do all the steps of the FFT, taking as input sound data (floats in the
+ * range of signed 16 bits samples) and returning the intensities of each
+ * frequency as floats in the range 0 to ((FFT_BUFFER_SIZE / 2) * 32768) ^ 2
  *
  * The input array is assumed to have FFT_BUFFER_SIZE elements,
  * and the output array is assumed to have (FFT_BUFFER_SIZE / 2 + 1) elements.
  * state is a (non-NULL) pointer returned by visual_fft_init.
+ *
+ * As the input is real, it is transformed as a complex sequence of half the
+ * size, then split into the spectrum of the input: this halves the work.
  */
-void fft_perform(const sound_sample *input, float *output, fft_state *state) {
+void fft_perform(const float *input, float *output, fft_state *state) {
     /* Convert data from sound format to be ready for FFT */
     fft_prepare(input, state->real, state->imag, state->bitReverse );
 
@@ -94,7 +111,8 @@ void fft_perform(const sound_sample *input, float *output, fft_state *state) {
     fft_calculate(state->real, state->imag, state->costable, state->sintable);
 
     /* Convert the FFT output into intensities */
-    fft_output(state->real, state->imag, output);
+    fft_output(state->real, state->imag, output,
+               state->splitcos, state->splitsin);
 }
 
 /*
@@ -109,19 +127,18 @@ void fft_close(fft_state *state) {
  *****************************************************************************/
 
 /*
- * Prepare data to perform an FFT on
+ * Prepare data to perform an FFT on: even samples are the real parts and
+ * odd samples the imaginary parts
  */
-static void fft_prepare( const sound_sample *input, float * re, float * im,
+static void fft_prepare( const float *input, float * re, float * im,
                          const unsigned int *bitReverse ) {
     unsigned int i;
-    float *p_real = re;
-    float *p_imag = im;
 
     /* Get input, in reverse bit order */
-    for(i = 0; i < FFT_BUFFER_SIZE; i++)
+    for(i = 0; i < FFT_HALF_SIZE; i++)
     {
-        *p_real++ = input[bitReverse[i]];
-        *p_imag++ = 0;
+        re[i] = input[2 * bitReverse[i]];
+        im[i] = input[2 * bitReverse[i] + 1];
     }
 }
 
@@ -129,75 +146,80 @@ static void fft_prepare( const sound_sample *input, float * re, float * im,
  * Take result of an FFT and calculate the intensities of each frequency
  * Note: only produces half as many data points as the input had.
  */
-static void fft_output(const float * re, const float * im, float *output)
+static void fft_output(const float * re, const float * im, float *output,
+                       const float *splitcos, const float *splitsin)
 {
-    float *p_output = output;
-    const float *p_real   = re;
-    const float *p_imag   = im;
-    float *p_end    = output + FFT_BUFFER_SIZE / 2;
+    unsigned int k;
+
+    /* Bins 0 and FFT_BUFFER_SIZE / 2 only depend on the first value */
+    output[0] = (re[0] + im[0]) * (re[0] + im[0]);
+    output[FFT_HALF_SIZE] = (re[0] - im[0]) * (re[0] - im[0]);
 
-    while(p_output <= p_end)
+    for(k = 1; k < FFT_HALF_SIZE; k++)
     {
-        *p_output = (*p_real * *p_real) + (*p_imag * *p_imag);
-        p_output++; p_real++; p_imag++;
+        unsigned int m = FFT_HALF_SIZE - k;
+        /* Spectrum of the even samples */
+        float even_real = (re[k] + re[m]) * 0.5f;
+        float even_imag = (im[k] - im[m]) * 0.5f;
+        /* Spectrum of the odd samples */
+        float odd_real = (im[k] + im[m]) * 0.5f;
+        float odd_imag = (re[m] - re[k]) * 0.5f;
+
+        float out_real = even_real + splitcos[k] * odd_real
+                                   - splitsin[k] * odd_imag;
+        float out_imag = even_imag + splitcos[k] * odd_imag
+                                   + splitsin[k] * odd_real;
+        output[k] = out_real * out_real + out_imag * out_imag;
     }
     /* Do divisions to keep the constant and highest frequency terms in scale
      * with the other terms. */
-    *output /= 4;
-    *p_end /= 4;
+    output[0] /= 4;
+    output[FFT_HALF_SIZE] /= 4;
 }
 
 
 /*
  * Actually perform the FFT
  */
-static void fft_calculate(float * re, float * im, const float *costable, const float *sintable )
+static void fft_calculate(float *restrict re, float *restrict im,
+                          const float *costable, const float *sintable )
 {
-    unsigned int i, j, k;
+    unsigned int j, k;
     unsigned int exchanges;
-    float fact_real, fact_imag;
-    float tmp_real, tmp_imag;
-    unsigned int factfact;
-
-    /* Set up some variables to reduce calculation in the loops */
-    exchanges = 1;
-    factfact = FFT_BUFFER_SIZE / 2;
-
-    /* Loop through the divide and conquer steps */
-    for(i = FFT_BUFFER_SIZE_LOG; i != 0; i--) {
-        /* In this step, we have 2 ^ (i - 1) exchange groups, each with
-         * 2 ^ (FFT_BUFFER_SIZE_LOG - i) exchanges
-         */
-        /* Loop through the exchanges in a group */
-        for(j = 0; j != exchanges; j++) {
-            /* Work out factor for this exchange
+
+    /* Loop through the divide and conquer steps: there are
+     * FFT_HALF_SIZE / (2 * exchanges) groups of 2 * exchanges values. */
+    for(exchanges = 1; exchanges < FFT_HALF_SIZE; exchanges <<= 1) {
+        const float *fact_real = costable + exchanges;
+        const float *fact_imag = sintable + exchanges;
+
+        /* Loop through all the exchange groups */
+        for(k = 0; k < FFT_HALF_SIZE; k += exchanges << 1) {
+            float *re0 = re + k, *re1 = re + k + exchanges;
+            float *im0 = im + k, *im1 = im + k + exchanges;
+
+            /* Loop through the exchanges in a group. The factors are
              * factor ^ (exchanges) = -1
              * So, real = cos(j * PI / exchanges),
              *     imag = sin(j * PI / exchanges)
-             */
-            fact_real = costable[j * factfact];
-            fact_imag = sintable[j * factfact];
-
-            /* Loop through all the exchange groups */
-            for(k = j; k < FFT_BUFFER_SIZE; k += exchanges << 1) {
-                int k1 = k + exchanges;
-                tmp_real = fact_real * re[k1] - fact_imag * im[k1];
-                tmp_imag = fact_real * im[k1] + fact_imag * re[k1];
-                re[k1] = re[k] - tmp_real;
-                im[k1] = im[k] - tmp_imag;
-                re[k]  += tmp_real;
-                im[k]  += tmp_imag;
+             * This loop has no dependency between iterations, so that the
+             * compiler can vectorize it. */
+            for(j = 0; j < exchanges; j++) {
+                float tmp_real = fact_real[j] * re1[j] - fact_imag[j] * im1[j];
+                float tmp_imag = fact_real[j] * im1[j] + fact_imag[j] * re1[j];
+                re1[j] = re0[j] - tmp_real;
+                im1[j] = im0[j] - tmp_imag;
+                re0[j] += tmp_real;
+                im0[j] += tmp_imag;
             }
         }
-        exchanges <<= 1;
-        factfact >>= 1;
     }
 }
 
 static int reverseBits(unsigned int initial)
 {
     unsigned int reversed = 0, loop;
-    for(loop = 0; loop < FFT_BUFFER_SIZE_LOG; loop++) {
+    for(loop = 0; loop < FFT_BUFFER_SIZE_LOG - 1; loop++) {
         reversed <<= 1;
         reversed += (initial & 1);
         initial >>= 1;
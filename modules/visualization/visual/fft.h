@@ -28,27 +28,30 @@
 
 #define FFT_BUFFER_SIZE (1 << FFT_BUFFER_SIZE_LOG)
 
-/* sound sample - should be an signed 16 bit value */
-typedef short int sound_sample;
-
 struct _struct_fft_state {
-     /* Temporary data stores to perform FFT in. */
-     float real[FFT_BUFFER_SIZE];
-     float imag[FFT_BUFFER_SIZE];
+     /* Temporary data stores to perform FFT in: the real input is packed
+      * as FFT_BUFFER_SIZE / 2 complex values (even and odd samples). */
+     float real[FFT_BUFFER_SIZE / 2];
+     float imag[FFT_BUFFER_SIZE / 2];
 
      /* */
-     unsigned int bitReverse[FFT_BUFFER_SIZE];
+     unsigned int bitReverse[FFT_BUFFER_SIZE / 2];
 
-     /* The next two tables could be made to use less space in memory, since they
-      * overlap hugely, but hey. */
-     float sintable[FFT_BUFFER_SIZE / 2];
+     /* Twiddle factors of each pass, the pass with exchange groups of size
+      * 2 * n uses the n values starting at index n, so that the innermost
+      * loop reads them contiguously. */
      float costable[FFT_BUFFER_SIZE / 2];
+     float sintable[FFT_BUFFER_SIZE / 2];
+
+     /* Twiddle factors to split the packed result into the real spectrum */
+     float splitcos[FFT_BUFFER_SIZE / 2 + 1];
+     float splitsin[FFT_BUFFER_SIZE / 2 + 1];
 };
 
 /* FFT prototypes */
 typedef struct _struct_fft_state fft_state;
 fft_state *visual_fft_init (void);
-void fft_perform (const sound_sample *input, float *output, fft_state *state);
+void fft_perform (const float *input, float *output, fft_state *state);
 void fft_close (fft_state *state);
 
 
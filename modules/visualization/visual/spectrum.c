@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * spectrum.c : Spectrum analysis shared by the visualizations
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include "spectrum.h"
+#include "window.h"
+
+struct visual_spectrum_t
+{
+    fft_state      *fft;
+    window_context  window;
+    bool            valid;
+
+    float           input[FFT_BUFFER_SIZE];
+    float           output[FFT_BUFFER_SIZE];
+};
+
+visual_spectrum_t *visual_spectrum_New( vlc_object_t *obj )
+{
+    visual_spectrum_t *spectrum = malloc( sizeof( *spectrum ) );
+    if( unlikely(spectrum == NULL) )
+        return NULL;
+
+    /* The tables only depend on the parameters: compute them once */
+    window_param param;
+    window_get_param( obj, &param );
+    spectrum->window = (window_context){ NULL, 0 };
+    if( !window_init( FFT_BUFFER_SIZE, &param, &spectrum->window ) )
+    {
+        msg_Err( obj, "unable to initialize FFT window" );
+        free( spectrum );
+        return NULL;
+    }
+
+    spectrum->fft = visual_fft_init();
+    if( spectrum->fft == NULL )
+    {
+        msg_Err( obj, "unable to initialize FFT transform" );
+        window_close( &spectrum->window );
+        free( spectrum );
+        return NULL;
+    }
+
+    /* Only the first half of the output is ever written to */
+    memset( spectrum->output, 0, sizeof( spectrum->output ) );
+    spectrum->valid = false;
+    return spectrum;
+}
+
+void visual_spectrum_Delete( visual_spectrum_t *spectrum )
+{
+    fft_close( spectrum->fft );
+    window_close( &spectrum->window );
+    free( spectrum );
+}
+
+void visual_spectrum_Reset( visual_spectrum_t *spectrum )
+{
+    spectrum->valid = false;
+}
+
+const float *visual_spectrum_Get( visual_spectrum_t *spectrum,
+                                  const block_t *block, unsigned i_nb_chans )
+{
+    if( spectrum->valid )
+        return spectrum->output;
+
+    const float *samples = (const float *)block->p_buffer;
+    unsigned i_nb_samples = block->i_nb_samples;
+    if( i_nb_samples == 0 )
+        return NULL;
+
+    /* Take the first channel in the scale of 16-bits samples, repeating the
+     * buffer if it is shorter than the FFT */
+    for( unsigned i = 0, j = 0; i < FFT_BUFFER_SIZE; i++ )
+    {
+        float f = samples[j * i_nb_chans] * 32768.f;
+        spectrum->input[i] = f > 32767.f ? 32767.f
+                           : f < -32768.f ? -32768.f : f;
+        if( ++j == i_nb_samples )
+            j = 0;
+    }
+
+    window_scale_in_place( spectrum->input, &spectrum->window );
+    fft_perform( spectrum->input, spectrum->output, spectrum->fft );
+    spectrum->valid = true;
+    return spectrum->output;
+}
@@ -0,0 +1,55 @@
+/*****************************************************************************
+ * spectrum.h : Spectrum analysis shared by the visualizations
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VISUAL_SPECTRUM_H_
+#define VLC_VISUAL_SPECTRUM_H_
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "fft.h"
+
+typedef struct visual_spectrum_t visual_spectrum_t;
+
+/**
+ * Creates a spectrum analyser, with the FFT window selected by the
+ * "effect-fft-window" and "effect-kaiser-param" options of obj.
+ */
+visual_spectrum_t *visual_spectrum_New( vlc_object_t *obj );
+void visual_spectrum_Delete( visual_spectrum_t * );
+
+/**
+ * Discards the spectrum of the previous audio buffer.
+ *
+ * Call this once per audio buffer, before the visualizations run.
+ */
+void visual_spectrum_Reset( visual_spectrum_t * );
+
+/**
+ * Returns the spectrum of the first channel of an FL32 buffer. It is only
+ * computed by the first call following visual_spectrum_Reset().
+ *
+ * \return FFT_BUFFER_SIZE intensities, as fft_perform() computes them (only
+ * the first FFT_BUFFER_SIZE / 2 + 1 are not zero), or NULL if the buffer is
+ * empty. The values are valid until the next visual_spectrum_Reset().
+ */
+const float *visual_spectrum_Get( visual_spectrum_t *, const block_t *,
+                                  unsigned i_nb_chans );
+
+#endif /* include-guard */
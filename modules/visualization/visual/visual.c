@@ -37,6 +37,7 @@
 #include <vlc_filter.h>
 
 #include "visual.h"
+#include "spectrum.h"
 
 #include "window_presets.h"
 
@@ -177,12 +178,17 @@ static block_t *DoWork( filter_t *, block_t * );
 static void Flush( filter_t * );
 static void *Thread( void *);
 
+/* Buffers waiting for the rendering thread, beyond which new buffers are not
+ * visualized, rather than delaying the audio thread */
+#define MAX_QUEUED_BLOCKS 8
+
 typedef struct
 {
     block_fifo_t    *fifo;
     vout_thread_t   *p_vout;
     visual_effect_t **effect;
     int             i_effect;
+    visual_spectrum_t *spectrum;
     vlc_thread_t    thread;
 } filter_sys_t;
 
@@ -212,6 +218,12 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->i_effect = 0;
     p_sys->effect   = NULL;
+    p_sys->spectrum = visual_spectrum_New( p_this );
+    if( p_sys->spectrum == NULL )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
 
     /* Parse the effect list */
     psz_parser = psz_effects = var_CreateGetString( p_filter, "effect-list" );
@@ -231,6 +243,7 @@ static int Open( vlc_object_t *p_this )
 
         p_effect->p_data   = NULL;
         p_effect->pf_run   = NULL;
+        p_effect->p_spectrum = p_sys->spectrum;
 
         for( unsigned i = 0; i < effectc; i++ )
         {
@@ -334,6 +347,7 @@ error:
     for( int i = 0; i < p_sys->i_effect; i++ )
         free( p_sys->effect[i] );
     free( p_sys->effect );
+    visual_spectrum_Delete( p_sys->spectrum );
     free( p_sys );
     return VLC_EGENERIC;
 }
@@ -355,7 +369,9 @@ static block_t *DoRealWork( filter_t *p_filter, block_t *p_in_buf )
                 p_outpic->p[i].i_visible_lines * p_outpic->p[i].i_pitch );
     }
 
-    /* We can now call our visualization effects */
+    /* We can now call our visualization effects: the spectrum is computed
+     * at most once for all of them */
+    visual_spectrum_Reset( p_sys->spectrum );
     for( int i = 0; i < p_sys->i_effect; i++ )
     {
 #define p_effect p_sys->effect[i]
@@ -391,10 +407,17 @@ static void *Thread( void *data )
 
 static block_t *DoWork( filter_t *p_filter, block_t *p_in_buf )
 {
-    block_t *block = block_Duplicate( p_in_buf );
     filter_sys_t *p_sys = p_filter->p_sys;
-    if( likely(block != NULL) )
-        block_FifoPut( p_sys->fifo, block );
+
+    /* Never wait for the rendering: skip the buffer if it is late */
+    vlc_fifo_Lock( p_sys->fifo );
+    if( vlc_fifo_GetCount( p_sys->fifo ) < MAX_QUEUED_BLOCKS )
+    {
+        block_t *block = block_Duplicate( p_in_buf );
+        if( likely(block != NULL) )
+            vlc_fifo_QueueUnlocked( p_sys->fifo, block );
+    }
+    vlc_fifo_Unlock( p_sys->fifo );
     return p_in_buf;
 }
 
@@ -427,5 +450,6 @@ static void Close( vlc_object_t *p_this )
     }
 
     free( p_sys->effect );
+    visual_spectrum_Delete( p_sys->spectrum );
     free( p_sys );
 }
@@ -37,6 +37,9 @@ struct visual_effect_t
     /* Channels index */
     int        i_idx_left;
     int        i_idx_right;
+
+    /* Spectrum of the current buffer, shared by all the effects */
+    struct visual_spectrum_t *p_spectrum;
 };
 
 extern const struct visual_cb_t
@@ -353,6 +353,9 @@ do { \
     }
 }
 
+/* Samples per channel interleaved at a time */
+#define AOUT_INTERLEAVE_BLOCK 256
+
 /**
  * Interleaves audio samples within a block of samples.
  * \param dst destination buffer for interleaved samples
@@ -366,14 +369,20 @@ do { \
 void aout_Interleave( void *restrict dst, const void *const *srcv,
                       unsigned samples, unsigned chans, vlc_fourcc_t fourcc )
 {
+/* The samples are processed in blocks, so that the interleaved side of a
+ * block stays in the cache while each plane is visited, however many
+ * channels there are. */
 #define INTERLEAVE_TYPE(type) \
 do { \
     type *d = dst; \
-    for( size_t i = 0; i < chans; i++ ) { \
-        const type *s = srcv[i]; \
-        for( size_t j = 0, k = 0; j < samples; j++, k += chans ) \
-            d[k] = *(s++); \
-        d++; \
+    for( size_t b = 0; b < samples; b += AOUT_INTERLEAVE_BLOCK ) { \
+        const size_t n = __MIN( samples - b, AOUT_INTERLEAVE_BLOCK ); \
+        for( size_t i = 0; i < chans; i++ ) { \
+            const type *s = (const type *)srcv[i] + b; \
+            for( size_t j = 0, k = i; j < n; j++, k += chans ) \
+                d[k] = s[j]; \
+        } \
+        d += n * chans; \
     } \
 } while(0)
 
@@ -404,12 +413,15 @@ void aout_Deinterleave( void *restrict dst, const void *restrict src,
 {
 #define DEINTERLEAVE_TYPE(type) \
 do { \
-    type *d = dst; \
     const type *s = src; \
-    for( size_t i = 0; i < chans; i++ ) { \
-        for( size_t j = 0, k = 0; j < samples; j++, k += chans ) \
-            *(d++) = s[k]; \
-        s++; \
+    for( size_t b = 0; b < samples; b += AOUT_INTERLEAVE_BLOCK ) { \
+        const size_t n = __MIN( samples - b, AOUT_INTERLEAVE_BLOCK ); \
+        for( size_t i = 0; i < chans; i++ ) { \
+            type *d = (type *)dst + i * samples + b; \
+            for( size_t j = 0, k = i; j < n; j++, k += chans ) \
+                d[j] = s[k]; \
+        } \
+        s += n * chans; \
     } \
 } while(0)
 
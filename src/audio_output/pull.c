@@ -0,0 +1,267 @@
+/*****************************************************************************
+ * pull.c : sample FIFO for callback-driven audio outputs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_atomic.h>
+
+/* No samples were queued since the creation or the last flush */
+#define PULL_START_NONE INT64_MAX
+
+/**
+ * Single producer, single consumer ring buffer.
+ *
+ * The positions are byte counts since the creation, the size is a power of
+ * two so that they can wrap around freely. The producer (decoder thread)
+ * owns write, flush and start, the consumer (device thread) owns read and end.
+ */
+struct aout_pull
+{
+    audio_output_t *aout;
+    uint8_t *buffer;
+    size_t size;
+    unsigned bytes_per_frame;
+    unsigned rate;
+    int silence;
+
+    atomic_size_t write;
+    atomic_size_t read;
+    atomic_size_t flush; /* samples before this position are discarded */
+    atomic_bool paused;
+    atomic_int_least64_t start; /* due date of the first queued sample */
+    atomic_int_least64_t end; /* date when the rendered samples run out */
+    atomic_size_t underrun; /* frames of silence since the last play */
+
+    bool started; /* producer side, start was set */
+};
+
+static bool aout_PullIsAhead(size_t a, size_t b)
+{
+    return (ssize_t)(a - b) > 0;
+}
+
+/* Read position as seen from the producer, including a pending flush */
+static size_t aout_PullReadPos(aout_pull_t *p)
+{
+    size_t read = atomic_load_explicit(&p->read, memory_order_acquire);
+    size_t flush = atomic_load_explicit(&p->flush, memory_order_relaxed);
+
+    return aout_PullIsAhead(flush, read) ? flush : read;
+}
+
+aout_pull_t *aout_PullNew(audio_output_t *aout,
+                          const audio_sample_format_t *fmt, vlc_tick_t length)
+{
+    if (!AOUT_FMT_LINEAR(fmt) || fmt->i_bytes_per_frame == 0
+     || fmt->i_frame_length != 1 || fmt->i_rate == 0)
+        return NULL;
+
+    size_t bytes = samples_from_vlc_tick(length, fmt->i_rate)
+                 * fmt->i_bytes_per_frame;
+    size_t size = 1;
+    while (size < bytes)
+        size <<= 1;
+
+    aout_pull_t *p = malloc(sizeof (*p));
+    if (unlikely(p == NULL))
+        return NULL;
+
+    p->buffer = malloc(size);
+    if (unlikely(p->buffer == NULL))
+    {
+        free(p);
+        return NULL;
+    }
+
+    p->aout = aout;
+    p->size = size;
+    p->bytes_per_frame = fmt->i_bytes_per_frame;
+    p->rate = fmt->i_rate;
+    p->silence = fmt->i_format == VLC_CODEC_U8 ? 0x80 : 0;
+
+    atomic_init(&p->write, 0);
+    atomic_init(&p->read, 0);
+    atomic_init(&p->flush, 0);
+    atomic_init(&p->paused, false);
+    atomic_init(&p->start, PULL_START_NONE);
+    atomic_init(&p->end, VLC_TICK_INVALID);
+    atomic_init(&p->underrun, 0);
+    p->started = false;
+    return p;
+}
+
+void aout_PullDelete(aout_pull_t *p)
+{
+    free(p->buffer);
+    free(p);
+}
+
+void aout_PullPlay(aout_pull_t *p, block_t *block, vlc_tick_t date)
+{
+    if (!p->started)
+    {
+        atomic_store_explicit(&p->start, date, memory_order_relaxed);
+        p->started = true;
+    }
+
+    const uint8_t *src = block->p_buffer;
+    size_t length = block->i_buffer;
+
+    for (;;)
+    {
+        size_t write = atomic_load_explicit(&p->write, memory_order_relaxed);
+        size_t room = p->size - (write - aout_PullReadPos(p));
+        size_t copy = __MIN(room - room % p->bytes_per_frame, length);
+
+        if (copy > 0)
+        {
+            size_t offset = write & (p->size - 1);
+            size_t first = __MIN(copy, p->size - offset);
+
+            memcpy(p->buffer + offset, src, first);
+            memcpy(p->buffer, src + first, copy - first);
+            atomic_store_explicit(&p->write, write + copy,
+                                  memory_order_release);
+            src += copy;
+            length -= copy;
+        }
+
+        if (length == 0
+         || atomic_load_explicit(&p->paused, memory_order_relaxed))
+            break;
+
+        /* Wait for the device to consume some of the remaining samples */
+        size_t wait = __MIN(length, p->size) / p->bytes_per_frame;
+        vlc_tick_sleep(vlc_tick_from_samples(wait, p->rate) / 2 + 1);
+    }
+    block_Release(block);
+
+    size_t underrun = atomic_exchange_explicit(&p->underrun, 0,
+                                               memory_order_relaxed);
+    if (underrun > 0)
+        msg_Warn(p->aout, "underrun of %zu frames", underrun);
+}
+
+void aout_PullPause(aout_pull_t *p, bool paused)
+{
+    atomic_store_explicit(&p->paused, paused, memory_order_relaxed);
+}
+
+void aout_PullFlush(aout_pull_t *p)
+{
+    atomic_store_explicit(&p->start, PULL_START_NONE, memory_order_relaxed);
+    atomic_store_explicit(&p->flush,
+                          atomic_load_explicit(&p->write, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&p->underrun, 0, memory_order_relaxed);
+    p->started = false;
+}
+
+int aout_PullTimeGet(aout_pull_t *p, vlc_tick_t *restrict delay)
+{
+    vlc_tick_t end = atomic_load_explicit(&p->end, memory_order_relaxed);
+    vlc_tick_t start = atomic_load_explicit(&p->start, memory_order_relaxed);
+
+    /* Not rendering yet, or the first sample is not due yet */
+    if (end == VLC_TICK_INVALID || start != VLC_TICK_INVALID)
+        return -1;
+
+    size_t queued = atomic_load_explicit(&p->write, memory_order_relaxed)
+                  - aout_PullReadPos(p);
+    vlc_tick_t device = end - vlc_tick_now();
+
+    *delay = (device > 0 ? device : 0)
+           + vlc_tick_from_samples(queued / p->bytes_per_frame, p->rate);
+    return 0;
+}
+
+size_t aout_PullRender(aout_pull_t *p, void *buf, size_t frames,
+                       vlc_tick_t date)
+{
+    uint8_t *dst = buf;
+    size_t length = frames * p->bytes_per_frame;
+    size_t copied = 0;
+
+    atomic_store_explicit(&p->end, date + vlc_tick_from_samples(frames, p->rate),
+                          memory_order_relaxed);
+
+    size_t read = atomic_load_explicit(&p->read, memory_order_relaxed);
+    size_t flush = atomic_load_explicit(&p->flush, memory_order_relaxed);
+    if (aout_PullIsAhead(flush, read))
+        read = flush;
+
+    vlc_tick_t start = atomic_load_explicit(&p->start, memory_order_relaxed);
+    if (start == PULL_START_NONE
+     || atomic_load_explicit(&p->paused, memory_order_relaxed))
+        goto out;
+
+    size_t write = atomic_load_explicit(&p->write, memory_order_acquire);
+    size_t queued = write - read;
+    if (queued == 0)
+        goto out;
+
+    if (start != VLC_TICK_INVALID)
+    {
+        /* Deferred start: render silence until the first sample is due */
+        if (start > date)
+        {
+            size_t silence = samples_from_vlc_tick(start - date, p->rate);
+            if (silence >= frames)
+                goto out;
+
+            silence *= p->bytes_per_frame;
+            memset(dst, p->silence, silence);
+            dst += silence;
+            length -= silence;
+        }
+        atomic_compare_exchange_strong_explicit(&p->start, &start,
+                                                VLC_TICK_INVALID,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed);
+    }
+
+    copied = __MIN(queued, length);
+
+    size_t offset = read & (p->size - 1);
+    size_t first = __MIN(copied, p->size - offset);
+
+    memcpy(dst, p->buffer + offset, first);
+    memcpy(dst + first, p->buffer, copied - first);
+    read += copied;
+    dst += copied;
+    length -= copied;
+
+    if (length > 0)
+        atomic_fetch_add_explicit(&p->underrun, length / p->bytes_per_frame,
+                                  memory_order_relaxed);
+out:
+    memset(dst, p->silence, length);
+    atomic_store_explicit(&p->read, read, memory_order_release);
+    return copied / p->bytes_per_frame;
+}
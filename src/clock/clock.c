@@ -41,7 +41,8 @@ struct vlc_clock_main_t
      * system = ts * coeff / rate + offset
      */
     clock_point_t last;
-    average_t coeff_avg; /* Moving average to smooth out the instant coeff */
+    regression_t coeff_fit; /* Robust fit to smooth out the instant coeff */
+    bool coeff_valid; /* The coeff is estimated from the fit */
     double rate;
     double coeff;
     vlc_tick_t offset;
@@ -85,7 +86,8 @@ static vlc_tick_t main_stream_to_system(vlc_clock_main_t *main_clock,
 
 static void vlc_clock_main_reset(vlc_clock_main_t *main_clock)
 {
-    AvgReset(&main_clock->coeff_avg);
+    RegressionReset(&main_clock->coeff_fit);
+    main_clock->coeff_valid = false;
     main_clock->coeff = 1.0f;
     main_clock->rate = 1.0f;
     main_clock->offset = VLC_TICK_INVALID;
@@ -130,18 +132,27 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
          && ts != main_clock->last.stream)
         {
             /* We have a reference so we can update coeff */
-            double instant_coeff = (system_now - main_clock->last.system)
-                                 / (double)(ts - main_clock->last.stream);
-            if (rate == main_clock->rate)
+            if (rate != main_clock->rate)
             {
-                instant_coeff *= rate;
-                AvgUpdate(&main_clock->coeff_avg, instant_coeff);
-                main_clock->coeff = AvgGet(&main_clock->coeff_avg);
+                /* The points of the fit are only valid for one rate */
+                RegressionReset(&main_clock->coeff_fit);
+                RegressionUpdate(&main_clock->coeff_fit, main_clock->last);
             }
+            main_clock->coeff_valid =
+                RegressionUpdate(&main_clock->coeff_fit,
+                                 clock_point_Create(system_now, ts));
+            if (main_clock->coeff_valid)
+                main_clock->coeff =
+                    RegressionGetSlope(&main_clock->coeff_fit) * rate;
         }
         else
+        {
+            RegressionReset(&main_clock->coeff_fit);
+            RegressionUpdate(&main_clock->coeff_fit,
+                             clock_point_Create(system_now, ts));
             main_clock->wait_sync_ref =
                 clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
+        }
 
         main_clock->offset = system_now - ts * main_clock->coeff / rate;
 
@@ -363,7 +374,7 @@ static void vlc_clock_slave_set_dejitter(vlc_clock_t *clock, vlc_tick_t delay)
     VLC_UNUSED(delay);
 }
 
-vlc_clock_main_t *vlc_clock_main_New(void)
+vlc_clock_main_t *vlc_clock_main_New(unsigned drift_window)
 {
     vlc_clock_main_t *main_clock = malloc(sizeof(vlc_clock_main_t));
 
@@ -390,7 +401,8 @@ vlc_clock_main_t *vlc_clock_main_New(void)
     main_clock->output_dejitter = AOUT_MAX_PTS_ADVANCE * 2;
     main_clock->abort = false;
 
-    AvgInit(&main_clock->coeff_avg, 10);
+    RegressionInit(&main_clock->coeff_fit, drift_window);
+    main_clock->coeff_valid = false;
 
     return main_clock;
 }
@@ -434,6 +446,55 @@ void vlc_clock_main_SetInputDejitter(vlc_clock_main_t *main_clock,
     vlc_mutex_unlock(&main_clock->lock);
 }
 
+int vlc_clock_main_GetReference(vlc_clock_main_t *main_clock,
+                                vlc_tick_t *system, vlc_tick_t *ts)
+{
+    int ret = 0;
+
+    vlc_mutex_lock(&main_clock->lock);
+    if (main_clock->pause_date != VLC_TICK_INVALID)
+        ret = -1;
+    else if (main_clock->offset != VLC_TICK_INVALID)
+    {
+        *system = main_clock->last.system;
+        *ts = main_clock->last.stream;
+    }
+    else if (main_clock->wait_sync_ref.system != VLC_TICK_INVALID)
+    {
+        *system = main_clock->wait_sync_ref.system;
+        *ts = main_clock->wait_sync_ref.stream;
+    }
+    else
+        ret = -1;
+    vlc_mutex_unlock(&main_clock->lock);
+    return ret;
+}
+
+void vlc_clock_main_SetReference(vlc_clock_main_t *main_clock,
+                                 vlc_tick_t system, vlc_tick_t ts)
+{
+    vlc_mutex_lock(&main_clock->lock);
+    main_clock->wait_sync_ref = clock_point_Create(system, ts);
+    vlc_cond_broadcast(&main_clock->cond);
+    vlc_mutex_unlock(&main_clock->lock);
+}
+
+int vlc_clock_main_GetDrift(vlc_clock_main_t *main_clock, double *drift,
+                            vlc_tick_t *jitter)
+{
+    int ret = -1;
+
+    vlc_mutex_lock(&main_clock->lock);
+    if (main_clock->offset != VLC_TICK_INVALID && main_clock->coeff_valid)
+    {
+        *drift = (main_clock->coeff - 1.) * 1000000.;
+        *jitter = RegressionGetJitter(&main_clock->coeff_fit);
+        ret = 0;
+    }
+    vlc_mutex_unlock(&main_clock->lock);
+    return ret;
+}
+
 void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
                                 bool paused)
 {
@@ -453,6 +514,7 @@ void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
         {
             main_clock->last.system += delay;
             main_clock->offset += delay;
+            RegressionShift(&main_clock->coeff_fit, delay);
         }
         if (main_clock->first_pcr.system != VLC_TICK_INVALID)
             main_clock->first_pcr.system += delay;
@@ -56,8 +56,11 @@ struct vlc_clock_cbs
 
 /**
  * This function creates the vlc_clock_main_t of the program
+ *
+ * @param drift_window number of master clock points used to estimate the
+ * drift between the stream and system clocks
  */
-vlc_clock_main_t *vlc_clock_main_New(void);
+vlc_clock_main_t *vlc_clock_main_New(unsigned drift_window);
 
 /**
  * Destroy the clock main
@@ -79,6 +82,38 @@ void vlc_clock_main_SetFirstPcr(vlc_clock_main_t *main_clock,
 void vlc_clock_main_SetInputDejitter(vlc_clock_main_t *main_clock,
                                      vlc_tick_t delay);
 
+/**
+ * Get the current conversion point between stream and system timestamps
+ *
+ * \param system pointer to the system date of the point
+ * \param ts pointer to the stream timestamp of the point
+ * \return 0 on success, -1 if the clock has no reference yet
+ */
+int vlc_clock_main_GetReference(vlc_clock_main_t *main_clock,
+                                vlc_tick_t *system, vlc_tick_t *ts);
+
+/**
+ * Force the conversion point between stream and system timestamps
+ *
+ * This allows an external reference, such as a network master, to drive
+ * the clock. The point replaces the one picked at the first conversion when
+ * there is no master clock (see VLC_CLOCK_MASTER_MONOTONIC); a master clock
+ * overrides it with its own updates.
+ */
+void vlc_clock_main_SetReference(vlc_clock_main_t *main_clock,
+                                 vlc_tick_t system, vlc_tick_t ts);
+
+/**
+ * Get the drift estimated from the master clock updates
+ *
+ * \param drift pointer to the drift of the system clock relative to the
+ * stream clock, in parts per million
+ * \param jitter pointer to the jitter of the master clock updates
+ * \return 0 on success, -1 if there is no estimation yet
+ */
+int vlc_clock_main_GetDrift(vlc_clock_main_t *main_clock, double *drift,
+                            vlc_tick_t *jitter);
+
 /**
  * This function allows changing the pause status.
  */
@@ -25,6 +25,9 @@
 # include "config.h"
 #endif
 
+#include <math.h>
+#include <stdlib.h>
+
 #include "clock_internal.h"
 
 /*****************************************************************************
@@ -79,3 +82,156 @@ void AvgRescale(average_t *avg, int range)
     avg->range = range;
     avg->value = tmp / avg->range;
 }
+
+/*****************************************************************************
+ * Windowed linear regression helpers
+ *****************************************************************************/
+/* Minimum number of points to reject outliers and detect discontinuities */
+#define REGRESSION_ROBUST_POINTS 4
+/* Residuals below this are never considered as outliers */
+#define REGRESSION_MIN_THRESHOLD VLC_TICK_FROM_US(500)
+
+void RegressionInit(regression_t *r, unsigned window)
+{
+    if (window < 2)
+        window = 2;
+    if (window > CLOCK_REGRESSION_MAX_POINTS)
+        window = CLOCK_REGRESSION_MAX_POINTS;
+    r->window = window;
+    RegressionReset(r);
+}
+
+void RegressionReset(regression_t *r)
+{
+    r->first = 0;
+    r->count = 0;
+    r->slope = 1.;
+    r->intercept = 0.;
+    r->jitter = 0.;
+}
+
+static clock_point_t RegressionPoint(const regression_t *r, unsigned i)
+{
+    return r->points[(r->first + i) % r->window];
+}
+
+/* Least squares fit of the points whose residual is within threshold, the
+ * residuals are then replaced by the ones of the new fit */
+static bool RegressionFit(regression_t *r, double *residuals, double threshold)
+{
+    const clock_point_t ref = RegressionPoint(r, 0);
+    double mx = 0., my = 0.;
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < r->count; i++)
+        if (fabs(residuals[i]) <= threshold)
+        {
+            const clock_point_t p = RegressionPoint(r, i);
+            mx += p.stream - ref.stream;
+            my += p.system - ref.system;
+            n++;
+        }
+    if (n < 2)
+        return false;
+    mx /= n;
+    my /= n;
+
+    /* Centered sums, to not lose precision on long windows */
+    double sxx = 0., sxy = 0.;
+    for (unsigned i = 0; i < r->count; i++)
+        if (fabs(residuals[i]) <= threshold)
+        {
+            const clock_point_t p = RegressionPoint(r, i);
+            const double dx = p.stream - ref.stream - mx;
+            const double dy = p.system - ref.system - my;
+            sxx += dx * dx;
+            sxy += dx * dy;
+        }
+    if (sxx <= 0.)
+        return false;
+
+    r->slope = sxy / sxx;
+    r->intercept = my - r->slope * mx;
+
+    double sum2 = 0.;
+    for (unsigned i = 0; i < r->count; i++)
+    {
+        const clock_point_t p = RegressionPoint(r, i);
+        const double residual = p.system - ref.system
+            - (r->intercept + r->slope * (p.stream - ref.stream));
+
+        if (fabs(residuals[i]) <= threshold)
+            sum2 += residual * residual;
+        residuals[i] = residual;
+    }
+    r->jitter = sqrt(sum2 / n);
+    return true;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+bool RegressionUpdate(regression_t *r, clock_point_t point)
+{
+    if (r->count >= REGRESSION_ROBUST_POINTS)
+    {
+        const clock_point_t ref = RegressionPoint(r, 0);
+        const double expected = ref.system + r->intercept
+                              + r->slope * (point.stream - ref.stream);
+
+        if (fabs(point.system - expected) > CLOCK_REGRESSION_DISCONTINUITY)
+            RegressionReset(r);
+    }
+
+    if (r->count == r->window)
+    {
+        r->first = (r->first + 1) % r->window;
+        r->count--;
+    }
+    r->points[(r->first + r->count) % r->window] = point;
+    r->count++;
+
+    double residuals[CLOCK_REGRESSION_MAX_POINTS];
+    for (unsigned i = 0; i < r->count; i++)
+        residuals[i] = 0.;
+
+    if (!RegressionFit(r, residuals, INFINITY))
+        return false;
+
+    if (r->count >= REGRESSION_ROBUST_POINTS)
+    {
+        /* The least squares residuals are centered, so the median of their
+         * absolute values is their median absolute deviation */
+        double deviations[CLOCK_REGRESSION_MAX_POINTS];
+        for (unsigned i = 0; i < r->count; i++)
+            deviations[i] = fabs(residuals[i]);
+        qsort(deviations, r->count, sizeof (*deviations), cmp_double);
+
+        const double mad = deviations[r->count / 2];
+        /* 1.4826 scales the MAD to a standard deviation for normal noise */
+        const double threshold = fmax(3. * 1.4826 * mad,
+                                      REGRESSION_MIN_THRESHOLD);
+        RegressionFit(r, residuals, threshold);
+    }
+    return true;
+}
+
+void RegressionShift(regression_t *r, vlc_tick_t system_delay)
+{
+    /* The intercept is relative to the oldest point, it is left as is */
+    for (unsigned i = 0; i < r->count; i++)
+        r->points[(r->first + i) % r->window].system += system_delay;
+}
+
+double RegressionGetSlope(const regression_t *r)
+{
+    return r->slope;
+}
+
+vlc_tick_t RegressionGetJitter(const regression_t *r)
+{
+    return (vlc_tick_t)r->jitter;
+}
@@ -60,3 +60,38 @@ static inline clock_point_t clock_point_Create(vlc_tick_t system, vlc_tick_t str
     return (clock_point_t) { .system = system, .stream = stream };
 }
 
+#define CLOCK_REGRESSION_MAX_POINTS 256
+#define CLOCK_REGRESSION_DISCONTINUITY VLC_TICK_FROM_MS(100)
+
+/**
+ * This structure holds a windowed linear regression of the system dates
+ * against the stream timestamps
+ *
+ * Points too far from the fit (by a multiple of the median absolute
+ * deviation) are not taken into account, and a point off by more than
+ * CLOCK_REGRESSION_DISCONTINUITY restarts the estimation.
+ */
+typedef struct
+{
+    clock_point_t points[CLOCK_REGRESSION_MAX_POINTS];
+    unsigned window; /* The maximum number of points of the fit */
+    unsigned first; /* Index of the oldest point */
+    unsigned count; /* The number of points in the window */
+
+    double slope; /* system duration per stream duration */
+    double intercept; /* system date at the stream timestamp of first */
+    double jitter; /* Root mean square of the inlier residuals */
+} regression_t;
+
+void RegressionInit(regression_t *, unsigned window);
+void RegressionReset(regression_t *);
+
+/* Adds a point and refits, returns false until a slope can be estimated */
+bool RegressionUpdate(regression_t *, clock_point_t point);
+
+/* Moves all the points by a system duration, after a pause for example */
+void RegressionShift(regression_t *, vlc_tick_t system_delay);
+
+double RegressionGetSlope(const regression_t *);
+vlc_tick_t RegressionGetJitter(const regression_t *);
+
@@ -42,12 +42,14 @@
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
 #include <vlc_decoder.h>
+#include <vlc_tracer.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
 #include "../clock/clock.h"
 #include "decoder.h"
 #include "resource.h"
+#include "../misc/block_ring.h"
 
 #include "../video_output/vout_internal.h"
 
@@ -61,6 +63,9 @@ enum reload
     RELOAD_DECODER_AOUT /* Stop the aout and reload the decoder module */
 };
 
+/* Arrival dates of the queued blocks, hashed by address (a power of 2) */
+#define DECODER_ARRIVALS 64
+
 struct decoder_owner
 {
     decoder_t        dec;
@@ -93,6 +98,18 @@ struct decoder_owner
     /* fifo */
     block_fifo_t *p_fifo;
 
+    /* Lock-free input queue (optional). When enabled, the input is queued
+     * into the ring and the FIFO above only receives the overflow; the FIFO
+     * lock and condition variable keep protecting the decoder thread state
+     * and parking. */
+    bool use_ring;
+    struct vlc_block_ring ring;
+    atomic_size_t ring_spilled; /* blocks queued in the FIFO instead */
+    atomic_bool ring_parked; /* the decoder thread waits for input */
+    size_t ring_discard; /* discard ring entries before this position */
+    bool ring_discard_pending;
+    unsigned spin_max, spin_budget;
+
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
     vlc_cond_t  wait_request;
@@ -145,6 +162,8 @@ struct decoder_owner
     bool b_first;
     bool b_has_data;
 
+    bool b_thumbnailing;
+
     /* Flushing */
     bool flushing;
     bool b_draining;
@@ -166,6 +185,20 @@ struct decoder_owner
     vlc_mutex_t     mouse_lock;
     vlc_mouse_event mouse_event;
     void           *mouse_opaque;
+
+    /* Extra decoder instances, owned by the DecoderThread (optional) */
+    struct decoder_mt *mt;
+
+    /* Latency measurements */
+    bool latency;
+    struct
+    {
+        atomic_uintptr_t block;
+        atomic_int_least64_t date;
+    } arrivals[DECODER_ARRIVALS]; /* written by input_DecoderDecode() */
+    vlc_tick_t input_arrival; /* of the block being processed */
+    vlc_tick_t decode_start;
+    bool decode_stalled; /* waited for the buffering to end */
 };
 
 /* Pictures which are DECODER_BOGUS_VIDEO_DELAY or more in advance probably have
@@ -186,15 +219,206 @@ static inline struct decoder_owner *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, struct decoder_owner, dec );
 }
 
+/* Maximum number of blocks and bytes dequeued by the decoder thread per
+ * FIFO lock cycle. A pending flush or pause is only seen between batches,
+ * so keep these small. */
+#define DECODER_BATCH_COUNT 8
+#define DECODER_BATCH_BYTES (256 * 1024)
+
+/* Capacity of the lock-free input ring */
+#define DECODER_RING_SIZE 1024
+
+/* Multi-instance decoding limits: instances, blocks waiting per instance,
+ * and reorder slots (a power of 2, covering every block in flight) */
+#define DECODER_MT_MAX   8
+#define DECODER_MT_QUEUE 1
+#define DECODER_MT_SLOTS 16
+
+static void DecoderMt_Setup( struct decoder_owner *p_owner );
+static void DecoderMt_Delete( struct decoder_mt *mt );
+
+/**
+ * Queues input into the decoder, without pacing.
+ * Thread-safe only from the single producer thread of the decoder.
+ */
+static void DecoderQueueInput( struct decoder_owner *p_owner, block_t *p_block )
+{
+    if( !p_owner->use_ring )
+    {
+        block_FifoPut( p_owner->p_fifo, p_block );
+        return;
+    }
+
+    /* Once anything has spilled into the FIFO, keep queueing there until the
+     * decoder thread has caught up, so that ordering is preserved. */
+    if( atomic_load_explicit( &p_owner->ring_spilled,
+                              memory_order_acquire ) == 0
+     && vlc_block_ring_Push( &p_owner->ring, p_block ) )
+    {
+        /* Pairs with the fence in DecoderThread_Park() */
+        atomic_thread_fence( memory_order_seq_cst );
+        if( atomic_load_explicit( &p_owner->ring_parked,
+                                  memory_order_relaxed ) )
+        {
+            vlc_fifo_Lock( p_owner->p_fifo );
+            vlc_fifo_Signal( p_owner->p_fifo );
+            vlc_fifo_Unlock( p_owner->p_fifo );
+        }
+        return;
+    }
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    atomic_fetch_add_explicit( &p_owner->ring_spilled, 1,
+                               memory_order_relaxed );
+    vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+}
+
+/**
+ * Counts queued input blocks.
+ * The FIFO must be locked.
+ */
+static size_t DecoderQueueCount( struct decoder_owner *p_owner )
+{
+    size_t count = vlc_fifo_GetCount( p_owner->p_fifo );
+
+    if( p_owner->use_ring )
+    {
+        /* Entries pending discard are not consumed, they do not count. The
+         * decoder thread does not dequeue anything before discarding them. */
+        if( p_owner->ring_discard_pending )
+            count += vlc_block_ring_Head( &p_owner->ring )
+                   - p_owner->ring_discard;
+        else
+            count += vlc_block_ring_Count( &p_owner->ring );
+    }
+    return count;
+}
+
+/**
+ * Counts queued input bytes.
+ * The FIFO must be locked.
+ */
+static size_t DecoderQueueBytes( struct decoder_owner *p_owner )
+{
+    size_t bytes = vlc_fifo_GetBytes( p_owner->p_fifo );
+
+    if( p_owner->use_ring )
+        bytes += vlc_block_ring_Bytes( &p_owner->ring );
+    return bytes;
+}
+
+/**
+ * Discards all queued input.
+ * The FIFO must be locked. The ring entries are released by the decoder thread.
+ */
+static void DecoderQueueEmpty( struct decoder_owner *p_owner )
+{
+    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+
+    if( p_owner->use_ring )
+    {
+        atomic_store_explicit( &p_owner->ring_spilled, 0,
+                               memory_order_relaxed );
+        p_owner->ring_discard = vlc_block_ring_Head( &p_owner->ring );
+        p_owner->ring_discard_pending = true;
+    }
+}
+
+/**
+ * Dequeues input for the decoder thread.
+ * The FIFO must be locked.
+ */
+static block_t *DecoderThread_Dequeue( struct decoder_owner *p_owner,
+                                       size_t max_count )
+{
+    if( p_owner->use_ring )
+    {
+        if( p_owner->ring_discard_pending )
+        {
+            vlc_block_ring_DiscardUntil( &p_owner->ring,
+                                         p_owner->ring_discard );
+            p_owner->ring_discard_pending = false;
+        }
+
+        block_t *p_block = vlc_block_ring_Pop( &p_owner->ring );
+        if( p_block != NULL )
+            return p_block;
+
+        /* The ring is drained, continue with the overflow, if any */
+        p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        if( p_block != NULL )
+            atomic_fetch_sub_explicit( &p_owner->ring_spilled, 1,
+                                       memory_order_release );
+        return p_block;
+    }
+
+    return vlc_fifo_DequeueBatchUnlocked( p_owner->p_fifo, max_count,
+                                          DECODER_BATCH_BYTES );
+}
+
+static inline void cpu_relax( void )
+{
+#if defined (__i386__) || defined (__x86_64__)
+    __asm__ volatile ("pause");
+#elif defined (__aarch64__)
+    __asm__ volatile ("yield");
+#endif
+}
+
+/**
+ * Waits for input or for a request to the decoder thread.
+ * The FIFO must be locked.
+ */
+static void DecoderThread_Park( struct decoder_owner *p_owner )
+{
+    if( !p_owner->use_ring )
+    {
+        vlc_fifo_Wait( p_owner->p_fifo );
+        return;
+    }
+
+    /* Adaptive spinning: busy-wait for a little while before sleeping,
+     * as long as spinning tends to pay off. */
+    if( p_owner->spin_budget > 0 )
+    {
+        unsigned budget = p_owner->spin_budget;
+        bool got = false;
+
+        vlc_fifo_Unlock( p_owner->p_fifo );
+        for( unsigned i = 0; i < budget && !got; i++ )
+        {
+            cpu_relax();
+            got = vlc_block_ring_Count( &p_owner->ring ) > 0;
+        }
+        vlc_fifo_Lock( p_owner->p_fifo );
+
+        if( got )
+        {
+            p_owner->spin_budget = __MIN( 2 * budget, p_owner->spin_max );
+            return;
+        }
+        p_owner->spin_budget = budget / 2;
+    }
+
+    atomic_store_explicit( &p_owner->ring_parked, true, memory_order_relaxed );
+    /* Pairs with the fence in DecoderQueueInput() */
+    atomic_thread_fence( memory_order_seq_cst );
+    if( vlc_block_ring_Count( &p_owner->ring ) == 0 )
+        vlc_fifo_Wait( p_owner->p_fifo );
+    atomic_store_explicit( &p_owner->ring_parked, false, memory_order_relaxed );
+}
+
 /**
  * Load a decoder module
  */
-static int LoadDecoder( decoder_t *p_dec, bool b_packetizer,
+static int LoadDecoder( decoder_t *p_dec, bool b_packetizer, bool b_remux,
                         const es_format_t *restrict p_fmt )
 {
     decoder_Init( p_dec, p_fmt );
 
     p_dec->b_frame_drop_allowed = true;
+    p_dec->b_remux = b_remux;
 
     /* Find a suitable decoder/packetizer module */
     if( !b_packetizer )
@@ -231,6 +455,8 @@ static int DecoderThread_Reload( struct decoder_owner *p_owner, bool b_packetize
     }
 
     /* Restart the decoder module */
+    DecoderMt_Delete( p_owner->mt );
+    p_owner->mt = NULL;
     decoder_Clean( p_dec );
     p_owner->error = false;
 
@@ -247,13 +473,15 @@ static int DecoderThread_Reload( struct decoder_owner *p_owner, bool b_packetize
         }
     }
 
-    if( LoadDecoder( p_dec, b_packetizer, &fmt_in ) )
+    if( LoadDecoder( p_dec, b_packetizer, false, &fmt_in ) )
     {
         p_owner->error = true;
         es_format_Clean( &fmt_in );
         return VLC_EGENERIC;
     }
     es_format_Clean( &fmt_in );
+    if( !b_packetizer )
+        DecoderMt_Setup( p_owner );
     return VLC_SUCCESS;
 }
 
@@ -785,10 +1013,65 @@ static void DecoderWaitUnblock( struct decoder_owner *p_owner )
     {
         if( !p_owner->b_waiting || !p_owner->b_has_data )
             break;
+        p_owner->decode_stalled = true;
         vlc_cond_wait( &p_owner->wait_request, &p_owner->lock );
     }
 }
 
+static inline size_t DecoderArrivalSlot( const block_t *p_block )
+{
+    return ( (uintptr_t)p_block / sizeof( block_t ) ) % DECODER_ARRIVALS;
+}
+
+static void DecoderRecordArrival( struct decoder_owner *p_owner,
+                                  const block_t *p_block )
+{
+    size_t i = DecoderArrivalSlot( p_block );
+
+    /* Colliding blocks overwrite each other, losing a sample at worst */
+    atomic_store_explicit( &p_owner->arrivals[i].block, 0,
+                           memory_order_relaxed );
+    atomic_store_explicit( &p_owner->arrivals[i].date, vlc_tick_now(),
+                           memory_order_relaxed );
+    atomic_store_explicit( &p_owner->arrivals[i].block, (uintptr_t)p_block,
+                           memory_order_release );
+}
+
+static vlc_tick_t DecoderGetArrival( struct decoder_owner *p_owner,
+                                     const block_t *p_block )
+{
+    size_t i = DecoderArrivalSlot( p_block );
+
+    if( atomic_load_explicit( &p_owner->arrivals[i].block,
+                              memory_order_acquire ) != (uintptr_t)p_block )
+        return VLC_TICK_INVALID;
+    vlc_tick_t date = atomic_load_explicit( &p_owner->arrivals[i].date,
+                                            memory_order_relaxed );
+    atomic_thread_fence( memory_order_acquire );
+    if( atomic_load_explicit( &p_owner->arrivals[i].block,
+                              memory_order_relaxed ) != (uintptr_t)p_block )
+        return VLC_TICK_INVALID;
+    return date;
+}
+
+static void DecoderNotifyLatency( struct decoder_owner *p_owner,
+                                  enum input_latency_e video,
+                                  enum input_latency_e audio,
+                                  vlc_tick_t latency )
+{
+    switch( p_owner->fmt.i_cat )
+    {
+        case VIDEO_ES:
+            decoder_Notify( p_owner, on_new_latency, video, latency );
+            break;
+        case AUDIO_ES:
+            decoder_Notify( p_owner, on_new_latency, audio, latency );
+            break;
+        default:
+            break;
+    }
+}
+
 static inline void DecoderUpdatePreroll( vlc_tick_t *pi_preroll, const block_t *p )
 {
     if( p->i_flags & BLOCK_FLAG_PREROLL )
@@ -945,11 +1228,13 @@ static void DecoderPlayCc( struct decoder_owner *p_owner, block_t *p_cc,
 
         if( i_bitmap > 1 )
         {
-            block_FifoPut( p_ccowner->p_fifo, block_Duplicate(p_cc) );
+            block_t *p_dup = block_Duplicate( p_cc );
+            if( p_dup != NULL )
+                DecoderQueueInput( p_ccowner, p_dup );
         }
         else
         {
-            block_FifoPut( p_ccowner->p_fifo, p_cc );
+            DecoderQueueInput( p_ccowner, p_cc );
             p_cc = NULL; /* was last dec */
         }
     }
@@ -1061,6 +1346,25 @@ static int ModuleThread_PlayVideo( struct decoder_owner *p_owner, picture_t *p_p
         /* Ensure no earlier higher pts breaks still state */
         vout_Flush( p_vout, p_picture->date );
     }
+
+    if( p_owner->latency )
+    {
+        vlc_tick_t now = vlc_tick_now();
+        vlc_tick_t date = ModuleThread_GetDisplayDate( p_dec, now,
+                                                       p_picture->date );
+        if( date != VLC_TICK_INVALID )
+        {
+            decoder_Notify( p_owner, on_new_latency,
+                            INPUT_LATENCY_VIDEO_DISPLAY, date - now );
+
+            /* Whole pipeline, from the block being decoded to the picture
+             * on screen (late pictures are displayed right away) */
+            if( p_owner->input_arrival != VLC_TICK_INVALID )
+                decoder_Notify( p_owner, on_new_latency,
+                                INPUT_LATENCY_VIDEO_TOTAL,
+                                __MAX( date, now ) - p_owner->input_arrival );
+        }
+    }
     vout_PutPicture( p_vout, p_picture );
 
     return VLC_SUCCESS;
@@ -1109,11 +1413,18 @@ static picture_t *thumbnailer_buffer_new( decoder_t *p_dec )
 static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    if( p_owner->b_first )
-    {
-        decoder_Notify(p_owner, on_thumbnail_ready, p_pic);
-        p_owner->b_first = false;
+    vlc_mutex_lock( &p_owner->lock );
+    bool first = p_owner->b_first;
+    p_owner->b_first = false;
+    if( p_owner->b_waiting )
+    {   /* Nothing more to buffer */
+        p_owner->b_has_data = true;
+        vlc_cond_signal( &p_owner->wait_acknowledge );
     }
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( first )
+        decoder_Notify(p_owner, on_thumbnail_ready, p_pic);
     picture_Release( p_pic );
 
 }
@@ -1173,7 +1484,15 @@ static int ModuleThread_PlayAudio( struct decoder_owner *p_owner, block_t *p_aud
         return VLC_EGENERIC;
     }
 
+    if( p_owner->latency && p_owner->decode_start != VLC_TICK_INVALID
+     && !p_owner->decode_stalled )
+        decoder_Notify( p_owner, on_new_latency, INPUT_LATENCY_AUDIO_PLAY,
+                        vlc_tick_now() - p_owner->decode_start );
+
+    struct vlc_tracer *tracer = vlc_object_get_tracer( p_dec );
+    vlc_tracer_Begin( tracer, "aout", "play" );
     int status = aout_DecPlay( p_aout, p_audio );
+    vlc_tracer_End( tracer, "aout", "play" );
     if( status == AOUT_DEC_CHANGED )
     {
         /* Only reload the decoder */
@@ -1270,12 +1589,497 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
     }
 }
 
+/*****************************************************************************
+ * Multi-instance decoding
+ *****************************************************************************
+ * Intra-only video codecs decode each block on its own. Such blocks can be
+ * spread over several instances of the decoder module, each running on its
+ * own worker thread. The DecoderThread dispatches the blocks round-robin
+ * and queues the pictures to the output in input order, which is also the
+ * presentation order for these codecs.
+ *****************************************************************************/
+struct decoder_mt_worker
+{
+    decoder_t dec;
+    struct decoder_mt *mt;
+    vlc_thread_t thread;
+    vlc_cond_t wait;
+
+    /* -- protected by decoder_mt.lock -- */
+    block_t *queue[DECODER_MT_QUEUE];
+    uint64_t queue_seq[DECODER_MT_QUEUE];
+    unsigned queue_head, queue_count;
+    uint64_t seq; /* sequence number of the block being decoded */
+    bool busy;
+};
+
+struct decoder_mt
+{
+    struct decoder_owner *owner;
+    struct decoder_mt_worker *workers[DECODER_MT_MAX];
+    unsigned count;
+    unsigned next; /* next worker to feed */
+    unsigned max_inflight;
+
+    vlc_mutex_t format_lock; /* serializes the format updates of workers */
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_done;
+    uint64_t seq_in, seq_out; /* next blocks to dispatch and to output */
+    struct
+    {
+        bool done;
+        picture_t *p_pics;
+        picture_t **pp_last;
+    } slots[DECODER_MT_SLOTS];
+    bool error, reload;
+    bool closing;
+};
+
+static inline struct decoder_mt_worker *dec_get_mt_worker( decoder_t *p_dec )
+{
+    return container_of( p_dec, struct decoder_mt_worker, dec );
+}
+
+static bool DecoderMt_IsIntraOnly( vlc_fourcc_t i_codec )
+{
+    switch( i_codec )
+    {
+        case VLC_CODEC_MJPG:
+        case VLC_CODEC_MJPGB:
+        case VLC_CODEC_JPEG:
+        case VLC_CODEC_PNG:
+        case VLC_CODEC_JPEG2000:
+        case VLC_CODEC_PRORES:
+        case VLC_CODEC_DNXHD:
+        case VLC_CODEC_HQX:
+        case VLC_CODEC_CINEFORM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int DecoderMt_UpdateVideoFormat( decoder_t *p_dec )
+{
+    struct decoder_mt *mt = dec_get_mt_worker( p_dec )->mt;
+    decoder_t *p_master = &mt->owner->dec;
+
+    /* The outputs are shared, negotiate them through the main instance */
+    vlc_mutex_lock( &mt->format_lock );
+    video_format_Clean( &p_master->fmt_out.video );
+    int ret = video_format_Copy( &p_master->fmt_out.video, &p_dec->fmt_out.video );
+    if( ret == VLC_SUCCESS )
+    {
+        p_master->fmt_out.i_codec = p_dec->fmt_out.i_codec;
+        ret = ModuleThread_UpdateVideoFormat( p_master );
+    }
+    vlc_mutex_unlock( &mt->format_lock );
+    return ret;
+}
+
+static picture_t *DecoderMt_NewVideoBuffer( decoder_t *p_dec )
+{
+    return ModuleThread_NewVideoBuffer( &dec_get_mt_worker( p_dec )->mt->owner->dec );
+}
+
+static void DecoderMt_AbortPictures( decoder_t *p_dec, bool b_abort )
+{
+    DecoderThread_AbortPictures( &dec_get_mt_worker( p_dec )->mt->owner->dec, b_abort );
+}
+
+static void DecoderMt_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
+{
+    struct decoder_mt_worker *w = dec_get_mt_worker( p_dec );
+    struct decoder_mt *mt = w->mt;
+
+    vlc_mutex_lock( &mt->lock );
+    unsigned slot = w->seq % DECODER_MT_SLOTS;
+    p_pic->p_next = NULL;
+    *mt->slots[slot].pp_last = p_pic;
+    mt->slots[slot].pp_last = &p_pic->p_next;
+    vlc_mutex_unlock( &mt->lock );
+}
+
+static vlc_tick_t DecoderMt_GetDisplayDate( decoder_t *p_dec,
+                                            vlc_tick_t system_now, vlc_tick_t i_ts )
+{
+    return ModuleThread_GetDisplayDate( &dec_get_mt_worker( p_dec )->mt->owner->dec,
+                                        system_now, i_ts );
+}
+
+static float DecoderMt_GetDisplayRate( decoder_t *p_dec )
+{
+    return ModuleThread_GetDisplayRate( &dec_get_mt_worker( p_dec )->mt->owner->dec );
+}
+
+static int DecoderMt_GetInputAttachments( decoder_t *p_dec,
+                                          input_attachment_t ***ppp_attachment,
+                                          int *pi_attachment )
+{
+    return InputThread_GetInputAttachments( &dec_get_mt_worker( p_dec )->mt->owner->dec,
+                                            ppp_attachment, pi_attachment );
+}
+
+static const struct decoder_owner_callbacks dec_mt_cbs =
+{
+    .video = {
+        .format_update = DecoderMt_UpdateVideoFormat,
+        .buffer_new = DecoderMt_NewVideoBuffer,
+        .abort_pictures = DecoderMt_AbortPictures,
+        .queue = DecoderMt_QueueVideo,
+        .get_display_date = DecoderMt_GetDisplayDate,
+        .get_display_rate = DecoderMt_GetDisplayRate,
+    },
+    .get_attachments = DecoderMt_GetInputAttachments,
+};
+
+static void *DecoderMt_Thread( void *data )
+{
+    struct decoder_mt_worker *w = data;
+    struct decoder_mt *mt = w->mt;
+
+    vlc_mutex_lock( &mt->lock );
+    for( ;; )
+    {
+        while( w->queue_count == 0 && !mt->closing )
+            vlc_cond_wait( &w->wait, &mt->lock );
+        if( w->queue_count == 0 )
+            break;
+
+        block_t *p_block = w->queue[w->queue_head];
+        w->seq = w->queue_seq[w->queue_head];
+        w->queue_head = ( w->queue_head + 1 ) % DECODER_MT_QUEUE;
+        w->queue_count--;
+        w->busy = true;
+        vlc_mutex_unlock( &mt->lock );
+
+        struct decoder_owner *p_owner = mt->owner;
+        vlc_tick_t start = p_owner->latency ? vlc_tick_now() : VLC_TICK_INVALID;
+
+        int ret = w->dec.pf_decode( &w->dec, p_block );
+
+        if( start != VLC_TICK_INVALID )
+            decoder_Notify( p_owner, on_new_latency, INPUT_LATENCY_VIDEO_DECODE,
+                            vlc_tick_now() - start );
+
+        vlc_mutex_lock( &mt->lock );
+        if( ret == VLCDEC_ECRITICAL )
+            mt->error = true;
+        else if( ret == VLCDEC_RELOAD )
+            mt->reload = true; /* the block is lost */
+        mt->slots[w->seq % DECODER_MT_SLOTS].done = true;
+        w->busy = false;
+        vlc_cond_signal( &mt->wait_done );
+    }
+    vlc_mutex_unlock( &mt->lock );
+    return NULL;
+}
+
+/* Releases the pictures not yet output, mt->lock must be held */
+static void DecoderMt_ResetSlots( struct decoder_mt *mt )
+{
+    for( unsigned i = 0; i < DECODER_MT_SLOTS; i++ )
+    {
+        for( picture_t *p_pic = mt->slots[i].p_pics; p_pic != NULL; )
+        {
+            picture_t *p_next = p_pic->p_next;
+            picture_Release( p_pic );
+            p_pic = p_next;
+        }
+        mt->slots[i].p_pics = NULL;
+        mt->slots[i].pp_last = &mt->slots[i].p_pics;
+        mt->slots[i].done = false;
+    }
+    mt->seq_in = mt->seq_out = 0;
+}
+
+/* Drops the blocks waiting for a worker, mt->lock must be held */
+static void DecoderMt_DropQueues( struct decoder_mt *mt )
+{
+    for( unsigned i = 0; i < mt->count; i++ )
+    {
+        struct decoder_mt_worker *w = mt->workers[i];
+        for( ; w->queue_count > 0; w->queue_count-- )
+        {
+            block_Release( w->queue[w->queue_head] );
+            w->queue_head = ( w->queue_head + 1 ) % DECODER_MT_QUEUE;
+        }
+    }
+}
+
+/**
+ * Queues the decoded pictures to the output in input order
+ *
+ * \param b_all wait for every dispatched block to be decoded
+ */
+static void DecoderMt_Output( struct decoder_mt *mt, bool b_all )
+{
+    struct decoder_owner *p_owner = mt->owner;
+
+    vlc_mutex_lock( &mt->lock );
+    while( mt->seq_out < mt->seq_in )
+    {
+        unsigned slot = mt->seq_out % DECODER_MT_SLOTS;
+        if( !mt->slots[slot].done )
+        {
+            if( !b_all )
+                break;
+            vlc_cond_wait( &mt->wait_done, &mt->lock );
+            continue;
+        }
+
+        picture_t *p_pic = mt->slots[slot].p_pics;
+        mt->slots[slot].p_pics = NULL;
+        mt->slots[slot].pp_last = &mt->slots[slot].p_pics;
+        mt->slots[slot].done = false;
+        mt->seq_out++;
+        vlc_mutex_unlock( &mt->lock );
+
+        while( p_pic != NULL )
+        {
+            picture_t *p_next = p_pic->p_next;
+            p_pic->p_next = NULL;
+            ModuleThread_QueueVideo( &p_owner->dec, p_pic );
+            p_pic = p_next;
+        }
+
+        vlc_mutex_lock( &mt->lock );
+    }
+    const bool error = mt->error, reload = mt->reload;
+    mt->error = mt->reload = false;
+    vlc_mutex_unlock( &mt->lock );
+
+    if( error )
+        p_owner->error = true;
+    else if( reload )
+        RequestReload( p_owner );
+}
+
+static void DecoderMt_Decode( struct decoder_mt *mt, block_t *p_block )
+{
+    if( p_block == NULL )
+    {   /* Drain: intra-only decoders don't hold back pictures */
+        DecoderMt_Output( mt, true );
+        return;
+    }
+
+    struct decoder_mt_worker *w = mt->workers[mt->next];
+    mt->next = ( mt->next + 1 ) % mt->count;
+
+    vlc_mutex_lock( &mt->lock );
+    while( w->queue_count == DECODER_MT_QUEUE ||
+           mt->seq_in - mt->seq_out >= mt->max_inflight )
+    {
+        vlc_mutex_unlock( &mt->lock );
+        DecoderMt_Output( mt, false );
+        vlc_mutex_lock( &mt->lock );
+        if( w->queue_count == DECODER_MT_QUEUE ||
+            mt->seq_in - mt->seq_out >= mt->max_inflight )
+            vlc_cond_wait( &mt->wait_done, &mt->lock );
+    }
+
+    unsigned tail = ( w->queue_head + w->queue_count ) % DECODER_MT_QUEUE;
+    w->queue[tail] = p_block;
+    w->queue_seq[tail] = mt->seq_in++;
+    w->queue_count++;
+    vlc_cond_signal( &w->wait );
+    vlc_mutex_unlock( &mt->lock );
+
+    DecoderMt_Output( mt, false );
+}
+
+static void DecoderMt_Flush( struct decoder_mt *mt )
+{
+    vlc_mutex_lock( &mt->lock );
+    DecoderMt_DropQueues( mt );
+    for( unsigned i = 0; i < mt->count; )
+    {
+        if( mt->workers[i]->busy )
+        {
+            vlc_cond_wait( &mt->wait_done, &mt->lock );
+            i = 0;
+        }
+        else
+            i++;
+    }
+    DecoderMt_ResetSlots( mt );
+    mt->error = mt->reload = false;
+    vlc_mutex_unlock( &mt->lock );
+
+    /* Workers are idle until the next block */
+    for( unsigned i = 0; i < mt->count; i++ )
+    {
+        decoder_t *p_dec = &mt->workers[i]->dec;
+        if( p_dec->pf_flush != NULL )
+            p_dec->pf_flush( p_dec );
+    }
+    mt->next = 0;
+}
+
+static void DecoderMt_Delete( struct decoder_mt *mt )
+{
+    if( mt == NULL )
+        return;
+
+    vlc_mutex_lock( &mt->lock );
+    DecoderMt_DropQueues( mt );
+    mt->closing = true;
+    for( unsigned i = 0; i < mt->count; i++ )
+        vlc_cond_signal( &mt->workers[i]->wait );
+    vlc_mutex_unlock( &mt->lock );
+
+    for( unsigned i = 0; i < mt->count; i++ )
+    {
+        struct decoder_mt_worker *w = mt->workers[i];
+        vlc_join( w->thread, NULL );
+        vlc_cond_destroy( &w->wait );
+        decoder_Destroy( &w->dec );
+    }
+
+    DecoderMt_ResetSlots( mt );
+    vlc_cond_destroy( &mt->wait_done );
+    vlc_mutex_destroy( &mt->lock );
+    vlc_mutex_destroy( &mt->format_lock );
+    free( mt );
+}
+
+static struct decoder_mt *DecoderMt_New( struct decoder_owner *p_owner, unsigned count )
+{
+    decoder_t *p_master = &p_owner->dec;
+    const char *psz_module = module_get_object( p_master->p_module );
+
+    struct decoder_mt *mt = calloc( 1, sizeof( *mt ) );
+    if( unlikely(mt == NULL) )
+        return NULL;
+
+    mt->owner = p_owner;
+    mt->max_inflight = count * ( DECODER_MT_QUEUE + 1 );
+    static_assert( DECODER_MT_SLOTS >= DECODER_MT_MAX * ( DECODER_MT_QUEUE + 1 ),
+                   "not enough reorder slots" );
+    vlc_mutex_init( &mt->format_lock );
+    vlc_mutex_init( &mt->lock );
+    vlc_cond_init( &mt->wait_done );
+    DecoderMt_ResetSlots( mt );
+
+    for( ; mt->count < count; mt->count++ )
+    {
+        struct decoder_mt_worker *w =
+            vlc_custom_create( VLC_OBJECT(p_master), sizeof( *w ), "decoder" );
+        if( unlikely(w == NULL) )
+            break;
+        w->mt = mt;
+        w->dec.cbs = &dec_mt_cbs;
+        w->queue_head = w->queue_count = 0;
+        w->busy = false;
+        vlc_cond_init( &w->wait );
+
+        /* Only the very same module can share the outputs */
+        if( LoadDecoder( &w->dec, false, false, &p_master->fmt_in ) ||
+            strcmp( module_get_object( w->dec.p_module ), psz_module ) )
+        {
+            vlc_cond_destroy( &w->wait );
+            decoder_Destroy( &w->dec );
+            break;
+        }
+
+        if( vlc_clone( &w->thread, DecoderMt_Thread, w, VLC_THREAD_PRIORITY_VIDEO ) )
+        {
+            vlc_cond_destroy( &w->wait );
+            decoder_Destroy( &w->dec );
+            break;
+        }
+        mt->workers[mt->count] = w;
+    }
+
+    if( mt->count < count )
+    {
+        msg_Warn( p_master, "cannot start %u decoder instances", count );
+        DecoderMt_Delete( mt );
+        return NULL;
+    }
+    return mt;
+}
+
+/* Only one picture is needed per seek: do not decode the frames that cannot
+ * become the thumbnail, nor anything once the thumbnail is out */
+static bool DecoderThread_SkipThumbnail( struct decoder_owner *p_owner,
+                                         const block_t *p_block )
+{
+    if( (p_block->i_flags & (BLOCK_FLAG_PREROLL|BLOCK_FLAG_TYPE_B))
+                         == (BLOCK_FLAG_PREROLL|BLOCK_FLAG_TYPE_B) )
+        return true;
+
+    vlc_mutex_lock( &p_owner->lock );
+    bool done = !p_owner->b_first;
+    vlc_mutex_unlock( &p_owner->lock );
+    return done;
+}
+
+/* The pictures that are neither displayed nor referenced do not need to be
+ * decoded at all: this shortens the preroll of accurate seeks */
+static bool DecoderThread_SkipPreroll( struct decoder_owner *p_owner,
+                                       const block_t *p_block )
+{
+    if( !(p_block->i_flags & BLOCK_FLAG_NON_REFERENCE) )
+        return false;
+    if( p_block->i_flags & BLOCK_FLAG_PREROLL )
+        return true;
+    if( p_block->i_pts == VLC_TICK_INVALID )
+        return false;
+
+    vlc_mutex_lock( &p_owner->lock );
+    bool skip = p_owner->i_preroll_end != PREROLL_NONE
+             && p_block->i_pts < p_owner->i_preroll_end;
+    vlc_mutex_unlock( &p_owner->lock );
+    return skip;
+}
+
 static void DecoderThread_ProcessInput( struct decoder_owner *p_owner, block_t *p_block );
 static void DecoderThread_DecodeBlock( struct decoder_owner *p_owner, block_t *p_block )
 {
     decoder_t *p_dec = &p_owner->dec;
 
+    if( p_owner->b_thumbnailing && p_block != NULL
+     && DecoderThread_SkipThumbnail( p_owner, p_block ) )
+    {
+        block_Release( p_block );
+        return;
+    }
+
+    if( p_block != NULL && p_dec->fmt_in.i_cat == VIDEO_ES
+     && DecoderThread_SkipPreroll( p_owner, p_block ) )
+    {
+        block_Release( p_block );
+        return;
+    }
+
+    if( p_owner->mt != NULL )
+    {
+        DecoderMt_Decode( p_owner->mt, p_block );
+        return;
+    }
+
+    if( p_owner->latency && p_block != NULL )
+    {
+        p_owner->decode_start = vlc_tick_now();
+        p_owner->decode_stalled = false;
+        if( p_owner->input_arrival != VLC_TICK_INVALID )
+            DecoderNotifyLatency( p_owner, INPUT_LATENCY_VIDEO_QUEUE,
+                                  INPUT_LATENCY_AUDIO_QUEUE,
+                                  p_owner->decode_start - p_owner->input_arrival );
+    }
+
     int ret = p_dec->pf_decode( p_dec, p_block );
+
+    if( p_owner->latency && p_block != NULL )
+    {
+        if( !p_owner->decode_stalled )
+            DecoderNotifyLatency( p_owner, INPUT_LATENCY_VIDEO_DECODE,
+                                  INPUT_LATENCY_AUDIO_DECODE,
+                                  vlc_tick_now() - p_owner->decode_start );
+        p_owner->decode_start = VLC_TICK_INVALID;
+    }
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -1333,6 +2137,10 @@ static void DecoderThread_ProcessInput( struct decoder_owner *p_owner, block_t *
         if( p_block->i_buffer <= 0 )
             goto error;
 
+        /* Blocks output by the packetizer inherit the input arrival */
+        if( p_owner->latency )
+            p_owner->input_arrival = DecoderGetArrival( p_owner, p_block );
+
         vlc_mutex_lock( &p_owner->lock );
         DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
         vlc_mutex_unlock( &p_owner->lock );
@@ -1419,6 +2227,9 @@ static void DecoderThread_Flush( struct decoder_owner *p_owner )
     if ( p_dec->pf_flush != NULL )
         p_dec->pf_flush( p_dec );
 
+    if( p_owner->mt != NULL )
+        DecoderMt_Flush( p_owner->mt );
+
     /* flush CC sub decoders */
     if( p_owner->cc.b_supported )
     {
@@ -1456,6 +2267,9 @@ static void DecoderThread_Flush( struct decoder_owner *p_owner )
         }
     }
 
+    /* A seek asks for a new thumbnail */
+    if( p_owner->b_thumbnailing )
+        p_owner->b_first = true;
     p_owner->i_preroll_end = PREROLL_NONE;
     vlc_mutex_unlock( &p_owner->lock );
 }
@@ -1552,6 +2366,7 @@ static void DecoderThread_ChangeDelay( struct decoder_owner *p_owner, vlc_tick_t
     }
 }
 
+
 /**
  * The decoding main loop
  *
@@ -1655,14 +2470,17 @@ static void *DecoderThread( void *p_data )
         vlc_cond_signal( &p_owner->wait_fifo );
         vlc_testcancel(); /* forced expedited cancellation in case of stop */
 
-        block_t *p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        /* Take several blocks per lock cycle while playing. When paused, only
+         * one block at a time so that frame stepping stays accurate. */
+        block_t *p_block = DecoderThread_Dequeue( p_owner,
+                                p_owner->paused ? 1 : DECODER_BATCH_COUNT );
         if( p_block == NULL )
         {
             if( likely(!p_owner->b_draining) )
             {   /* Wait for a block to decode (or a request to drain) */
                 p_owner->b_idle = true;
                 vlc_cond_signal( &p_owner->wait_acknowledge );
-                vlc_fifo_Wait( p_owner->p_fifo );
+                DecoderThread_Park( p_owner );
                 p_owner->b_idle = false;
                 continue;
             }
@@ -1672,10 +2490,26 @@ static void *DecoderThread( void *p_data )
 
         vlc_fifo_Unlock( p_owner->p_fifo );
 
+        const bool drain = p_block == NULL;
         int canc = vlc_savecancel();
-        DecoderThread_ProcessInput( p_owner, p_block );
+        struct vlc_tracer *tracer = vlc_object_get_tracer( &p_owner->dec );
+        do
+        {
+            block_t *p_next = NULL;
+
+            if( p_block != NULL )
+            {
+                p_next = p_block->p_next;
+                p_block->p_next = NULL;
+            }
+            vlc_tracer_Begin( tracer, "decoder", "decode" );
+            DecoderThread_ProcessInput( p_owner, p_block );
+            vlc_tracer_End( tracer, "decoder", "decode" );
+            p_block = p_next;
+        }
+        while( p_block != NULL );
 
-        if( p_block == NULL && p_owner->dec.fmt_out.i_cat == AUDIO_ES )
+        if( drain && p_owner->dec.fmt_out.i_cat == AUDIO_ES )
         {   /* Draining: the decoder is drained and all decoded buffers are
              * queued to the output at this point. Now drain the output. */
             if( p_owner->p_aout != NULL )
@@ -1686,7 +2520,7 @@ static void *DecoderThread( void *p_data )
         /* TODO? Wait for draining instead of polling. */
         vlc_mutex_lock( &p_owner->lock );
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_draining && (p_block == NULL) )
+        if( p_owner->b_draining && drain )
         {
             p_owner->b_draining = false;
             p_owner->drained = true;
@@ -1737,6 +2571,30 @@ static const struct decoder_owner_callbacks dec_spu_cbs =
     .get_attachments = InputThread_GetInputAttachments,
 };
 
+/* Starts extra decoder instances for intra-only video, if requested */
+static void DecoderMt_Setup( struct decoder_owner *p_owner )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    assert( p_owner->mt == NULL );
+    if( p_dec->cbs != &dec_video_cbs || p_owner->p_sout != NULL ||
+        !DecoderMt_IsIntraOnly( p_dec->fmt_in.i_codec ) )
+        return;
+
+    int64_t count = var_InheritInteger( p_dec, "decoder-instances" );
+    if( count <= 1 )
+        return;
+    count = __MIN( count, DECODER_MT_MAX );
+
+    p_owner->mt = DecoderMt_New( p_owner, count );
+    if( p_owner->mt == NULL )
+        return;
+
+    /* Pictures waiting to be output in order */
+    p_dec->i_extra_picture_buffers += p_owner->mt->max_inflight;
+    msg_Dbg( p_dec, "decoding with %u instances", p_owner->mt->count );
+}
+
 /**
  * Create a decoder object
  *
@@ -1788,6 +2646,7 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
     p_owner->b_waiting = false;
     p_owner->b_first = true;
     p_owner->b_has_data = false;
+    p_owner->b_thumbnailing = false;
 
     p_owner->error = false;
 
@@ -1799,6 +2658,17 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
 
     p_owner->mouse_event = NULL;
     p_owner->mouse_opaque = NULL;
+    p_owner->mt = NULL;
+    p_owner->latency = cbs != NULL && cbs->on_new_latency != NULL
+                    && var_InheritBool( p_dec, "stats" );
+    for( size_t i = 0; i < DECODER_ARRIVALS; i++ )
+    {
+        atomic_init( &p_owner->arrivals[i].block, 0 );
+        atomic_init( &p_owner->arrivals[i].date, VLC_TICK_INVALID );
+    }
+    p_owner->input_arrival = VLC_TICK_INVALID;
+    p_owner->decode_start = VLC_TICK_INVALID;
+    p_owner->decode_stalled = false;
 
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
 
@@ -1810,6 +2680,14 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
         return NULL;
     }
 
+    p_owner->use_ring = var_InheritBool( p_dec, "decoder-ring" )
+        && vlc_block_ring_Init( &p_owner->ring, DECODER_RING_SIZE ) == 0;
+    atomic_init( &p_owner->ring_spilled, 0 );
+    atomic_init( &p_owner->ring_parked, false );
+    p_owner->ring_discard_pending = false;
+    p_owner->spin_max = p_owner->spin_budget =
+        var_InheritInteger( p_dec, "decoder-spin" );
+
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
     vlc_cond_init( &p_owner->wait_request );
@@ -1823,7 +2701,7 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
             vlc_custom_create( p_parent, sizeof( decoder_t ), "packetizer" );
         if( p_owner->p_packetizer )
         {
-            if( LoadDecoder( p_owner->p_packetizer, true, fmt ) )
+            if( LoadDecoder( p_owner->p_packetizer, true, false, fmt ) )
             {
                 vlc_object_delete(p_owner->p_packetizer);
                 p_owner->p_packetizer = NULL;
@@ -1842,7 +2720,10 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
             if( !b_thumbnailing )
                 p_dec->cbs = &dec_video_cbs;
             else
+            {
                 p_dec->cbs = &dec_thumbnailer_cbs;
+                p_owner->b_thumbnailing = true;
+            }
             break;
         case AUDIO_ES:
             p_dec->cbs = &dec_audio_cbs;
@@ -1855,8 +2736,11 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
             return p_owner;
     }
 
-    /* Find a suitable decoder/packetizer module */
-    if( LoadDecoder( p_dec, p_sout != NULL, fmt ) )
+    /* Find a suitable decoder/packetizer module. Unless the stream output
+     * also wants the closed captions, a packetizer feeding it only needs the
+     * access unit boundaries and timestamps */
+    if( LoadDecoder( p_dec, p_sout != NULL,
+                     p_sout != NULL && !p_sout->b_wants_substreams, fmt ) )
         return p_owner;
 
     assert( p_dec->fmt_in.i_cat == p_dec->fmt_out.i_cat && fmt->i_cat == p_dec->fmt_in.i_cat);
@@ -1879,6 +2763,8 @@ static struct decoder_owner * CreateDecoder( vlc_object_t *p_parent,
         }
     }
 
+    DecoderMt_Setup( p_owner );
+
     /* */
     p_owner->cc.b_supported = ( p_sout == NULL );
 
@@ -1905,9 +2791,12 @@ static void DeleteDecoder( decoder_t * p_dec )
              (char*)&p_dec->fmt_in.i_codec );
 
     const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
+    DecoderMt_Delete( p_owner->mt );
     decoder_Clean( p_dec );
 
     /* Free all packets still in the decoder fifo. */
+    if( p_owner->use_ring )
+        vlc_block_ring_Destroy( &p_owner->ring );
     block_FifoRelease( p_owner->p_fifo );
 
     /* Cleanup */
@@ -2146,17 +3035,34 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
 
+    if( p_owner->latency )
+        DecoderRecordArrival( p_owner, p_block );
+
+    if( p_owner->use_ring )
+    {   /* Only lock if there is something to wait for */
+        bool b_wait = b_do_pace && !p_owner->b_waiting
+                   && vlc_block_ring_Count( &p_owner->ring ) >= 10;
+        bool b_full = !b_do_pace
+                   && vlc_block_ring_Bytes( &p_owner->ring ) > 400*1024*1024;
+
+        if( !b_wait && !b_full )
+        {
+            DecoderQueueInput( p_owner, p_block );
+            return;
+        }
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
         /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        if( DecoderQueueBytes( p_owner ) > 400*1024*1024 )
         {
             msg_Warn( p_dec, "decoder/packetizer fifo full (data not "
                       "consumed quickly enough), resetting fifo!" );
-            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            DecoderQueueEmpty( p_owner );
             p_block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
     }
@@ -2165,10 +3071,17 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
          * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+        while( DecoderQueueCount( p_owner ) >= 10 )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
+    if( p_owner->use_ring )
+    {
+        vlc_fifo_Unlock( p_owner->p_fifo );
+        DecoderQueueInput( p_owner, p_block );
+        return;
+    }
+
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
@@ -2180,7 +3093,7 @@ bool input_DecoderIsEmpty( decoder_t * p_dec )
     assert( !p_owner->b_waiting );
 
     vlc_fifo_Lock( p_owner->p_fifo );
-    if( !vlc_fifo_IsEmpty( p_owner->p_fifo ) || p_owner->b_draining )
+    if( DecoderQueueCount( p_owner ) > 0 || p_owner->b_draining )
     {
         vlc_fifo_Unlock( p_owner->p_fifo );
         return false;
@@ -2235,7 +3148,7 @@ void input_DecoderFlush( decoder_t *p_dec )
     vlc_fifo_Lock( p_owner->p_fifo );
 
     /* Empty the fifo */
-    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    DecoderQueueEmpty( p_owner );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -2429,7 +3342,7 @@ void input_DecoderWait( decoder_t *p_dec )
         if( p_owner->paused )
             break;
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        if( p_owner->b_idle && DecoderQueueCount( p_owner ) == 0 )
         {
             msg_Err( p_dec, "buffer deadlock prevented" );
             vlc_fifo_Unlock( p_owner->p_fifo );
@@ -2492,7 +3405,10 @@ size_t input_DecoderGetFifoSize( decoder_t *p_dec )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
 
-    return block_FifoSize( p_owner->p_fifo );
+    vlc_fifo_Lock( p_owner->p_fifo );
+    size_t size = DecoderQueueBytes( p_owner );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+    return size;
 }
 
 void input_DecoderSetVoutMouseEvent( decoder_t *dec, vlc_mouse_event mouse_event,
@@ -27,6 +27,7 @@
 #include <vlc_common.h>
 #include <vlc_codec.h>
 #include <vlc_mouse.h>
+#include <vlc_input_item.h>
 
 struct input_decoder_callbacks {
     /* notifications */
@@ -43,6 +44,8 @@ struct input_decoder_callbacks {
                                void *userdata);
     void (*on_new_audio_stats)(decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
+    void (*on_new_latency)(decoder_t *decoder, enum input_latency_e type,
+                           vlc_tick_t latency, void *userdata);
 
     /* requests */
     int (*get_attachments)(decoder_t *decoder,
@@ -35,6 +35,7 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "../modules/modules.h"
 
 typedef const struct
 {
@@ -197,14 +198,12 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     assert(s != NULL);
     priv = vlc_stream_Private(p_demux);
 
+    char *type = NULL;
     if (!strcasecmp( psz_demux, "any" ) || !psz_demux[0])
     {   /* Look up demux by mime-type for hard to detect formats */
-        char *type = stream_MimeType( s );
+        type = stream_MimeType( s );
         if( type != NULL )
-        {
             psz_demux = demux_NameFromMimeType( type );
-            free( type );
-        }
     }
 
     p_demux->p_input_item = p_input ? input_GetItem(p_input) : NULL;
@@ -233,20 +232,26 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     p_demux->p_sys      = NULL;
 
     const char *psz_module = NULL;
+    /* Probe hint: the file extension, else the MIME type */
+    const char *psz_hint = type;
 
     if( !strcmp( p_demux->psz_name, "any" ) && p_demux->psz_filepath )
     {
         char const* psz_ext = strrchr( p_demux->psz_filepath, '.' );
 
-        if( psz_ext )
+        if( psz_ext && strchr( psz_ext, '/' ) == NULL )
+        {
             psz_module = DemuxNameFromExtension( psz_ext + 1, b_preparsing );
+            psz_hint = psz_ext + 1;
+        }
     }
 
     if( psz_module == NULL )
         psz_module = p_demux->psz_name;
 
-    priv->module = vlc_module_load(p_demux, "demux", psz_module,
-        !strcmp(psz_module, p_demux->psz_name), demux_Probe, p_demux);
+    priv->module = vlc_module_load_hinted(vlc_object_logger(p_demux), "demux",
+        psz_module, psz_hint, !strcmp(psz_module, p_demux->psz_name),
+        demux_Probe, p_demux);
 
     if (priv->module == NULL)
     {
@@ -254,8 +259,10 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         goto error;
     }
 
+    free( type );
     return p_demux;
 error:
+    free( type );
     free( p_demux->psz_name );
     stream_CommonDelete( p_demux );
     return NULL;
@@ -121,6 +121,8 @@ struct es_out_id_t
     decoder_t   *p_dec;
     decoder_t   *p_dec_record;
     vlc_clock_t *p_clock;
+    /* p_dec != NULL, can be checked without the lock */
+    atomic_bool decoding;
 
     /* Used by vlc_clock_cbs, need to be const during the lifetime of the clock */
     bool master;
@@ -199,6 +201,11 @@ typedef struct
     int         i_cr_average;
     float       rate;
 
+    /* Fast channel change: live streams start with a shorter caching */
+    bool        b_zapping;
+    vlc_tick_t  i_zap_delay;
+    vlc_tick_t  i_zap_target; /* caching restored on the first late PCR */
+
     /* */
     bool        b_paused;
     vlc_tick_t  i_pause_date;
@@ -384,6 +391,26 @@ decoder_on_new_audio_stats(decoder_t *decoder, unsigned decoded, unsigned lost,
                               memory_order_relaxed);
 }
 
+static void
+decoder_on_new_latency(decoder_t *decoder, enum input_latency_e type,
+                       vlc_tick_t latency, void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if (!stats)
+        return;
+
+    input_latency_Add(&stats->latency[type], latency);
+}
+
 static int
 decoder_get_attachments(decoder_t *decoder,
                         input_attachment_t ***ppp_attachment,
@@ -407,6 +434,7 @@ static const struct input_decoder_callbacks decoder_cbs = {
     .on_thumbnail_ready = decoder_on_thumbnail_ready,
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
+    .on_new_latency = decoder_on_new_latency,
     .get_attachments = decoder_get_attachments,
 };
 
@@ -518,6 +546,11 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, float rate )
 
     p_sys->rate = rate;
 
+    p_sys->i_zap_delay =
+        VLC_TICK_FROM_MS( var_InheritInteger( p_input, "zap-caching" ) );
+    p_sys->b_zapping = p_sys->i_zap_delay > 0;
+    p_sys->i_zap_target = 0;
+
     p_sys->b_buffering = true;
     p_sys->i_preroll_end = -1;
     p_sys->i_prev_stream_level = -1;
@@ -1065,6 +1098,30 @@ static bool EsOutIsExtraBufferingAllowed( es_out_t *out )
     return i_size < i_level_high;
 }
 
+static void EsOutUpdateClockStats( es_out_sys_t *p_sys, es_out_pgrm_t *p_pgrm )
+{
+    if( !p_sys->p_input )
+        return;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if( !stats )
+        return;
+
+    double f_drift;
+    vlc_tick_t i_jitter;
+    if( vlc_clock_main_GetDrift( p_pgrm->p_main_clock, &f_drift, &i_jitter ) )
+    {
+        f_drift = 0.;
+        i_jitter = 0;
+    }
+
+    /* Stored in parts per billion, as there are no atomic floats */
+    atomic_store_explicit( &stats->clock_drift, (intmax_t)(f_drift * 1000.),
+                           memory_order_relaxed );
+    atomic_store_explicit( &stats->clock_jitter, i_jitter,
+                           memory_order_relaxed );
+}
+
 static void EsOutProgramChangePause( es_out_t *out, bool b_paused, vlc_tick_t i_date )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
@@ -1340,7 +1397,8 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, int i_group )
 
     p_pgrm->p_master_clock = NULL;
     p_pgrm->p_input_clock = input_clock_New( p_sys->rate );
-    p_pgrm->p_main_clock = vlc_clock_main_New();
+    p_pgrm->p_main_clock =
+        vlc_clock_main_New( var_InheritInteger( p_input, "clock-drift-window" ) );
     if( !p_pgrm->p_input_clock || !p_pgrm->p_main_clock )
     {
         if( p_pgrm->p_input_clock )
@@ -1949,6 +2007,7 @@ static es_out_id_t *EsOutAddSlaveLocked( es_out_t *out, const es_format_t *fmt,
     es->p_dec = NULL;
     es->p_dec_record = NULL;
     es->p_clock = NULL;
+    atomic_init( &es->decoding, false );
     es->master = false;
     es->cc.type = 0;
     es->cc.i_bitmap = 0;
@@ -2078,6 +2137,8 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         p_es->p_clock = NULL;
     }
     p_es->p_dec = dec;
+    atomic_store_explicit( &p_es->decoding, dec != NULL,
+                           memory_order_relaxed );
 
     EsOutDecoderChangeDelay( out, p_es );
 }
@@ -2088,6 +2149,7 @@ static void EsOutDestroyDecoder( es_out_t *out, es_out_id_t *p_es )
     if( !p_es->p_dec )
         return;
 
+    atomic_store_explicit( &p_es->decoding, false, memory_order_relaxed );
     input_DecoderDelete( p_es->p_dec );
     p_es->p_dec = NULL;
     if( p_es->p_pgrm->p_master_clock == p_es->p_clock )
@@ -2513,6 +2575,14 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
                                       memory_order_relaxed);
     }
 
+    /* Many demuxers do not honour the ES selection: drop the blocks of the
+     * unselected ES without contending for the lock. */
+    if( !atomic_load_explicit( &es->decoding, memory_order_relaxed ) )
+    {
+        block_Release( p_block );
+        return VLC_SUCCESS;
+    }
+
     vlc_mutex_lock( &p_sys->lock );
 
     /* Mark preroll blocks */
@@ -3047,9 +3117,27 @@ static int EsOutVaControlLocked( es_out_t *out, int i_query, va_list args )
         }
         else if( p_pgrm == p_sys->p_pgrm )
         {
+            EsOutUpdateClockStats( p_sys, p_pgrm );
+
             if( b_late && ( !input_priv(p_sys->p_input)->p_sout ||
                             !input_priv(p_sys->p_input)->b_out_pace_control ) )
             {
+                if( p_sys->b_zapping )
+                {
+                    /* The fast start was too short for this stream: rebuffer
+                     * once with the normal caching */
+                    msg_Dbg( p_sys->p_input, "fast start done, caching "
+                             "restored to %d ms",
+                             (int)MS_FROM_VLC_TICK(p_sys->i_zap_target) );
+                    p_sys->b_zapping = false;
+                    EsOutControlLocked( out, ES_OUT_SET_JITTER,
+                                        p_sys->i_zap_target,
+                                        p_sys->i_pts_jitter,
+                                        p_sys->i_cr_average );
+                    EsOutControlLocked( out, ES_OUT_RESET_PCR );
+                    return VLC_SUCCESS;
+                }
+
                 vlc_tick_t i_pts_delay = input_clock_GetJitter( p_pgrm->p_input_clock );
 
                 /* Avoid dangerously high value */
@@ -3352,6 +3440,17 @@ static int EsOutVaControlLocked( es_out_t *out, int i_query, va_list args )
         int     i_cr_average = va_arg( args, int );
         es_out_pgrm_t *pgrm;
 
+        if( p_sys->b_zapping )
+        {
+            if( input_priv(p_sys->p_input)->b_can_pace_control )
+                p_sys->b_zapping = false; /* not a live stream */
+            else
+            {
+                p_sys->i_zap_target = i_pts_delay;
+                i_pts_delay = __MIN( i_pts_delay, p_sys->i_zap_delay );
+            }
+        }
+
         const vlc_tick_t i_tracks_pts_delay = EsOutGetTracksDelay(out);
         bool b_change_clock =
             i_pts_delay != p_sys->i_pts_delay ||
@@ -3408,6 +3507,30 @@ static int EsOutVaControlLocked( es_out_t *out, int i_query, va_list args )
         input_clock_ChangeSystemOrigin( p_pgrm->p_input_clock, b_absolute, i_system );
         return VLC_SUCCESS;
     }
+    case ES_OUT_GET_CLOCK_REFERENCE:
+    {
+        es_out_pgrm_t *p_pgrm = p_sys->p_pgrm;
+        if( p_sys->b_buffering || !p_pgrm )
+            return VLC_EGENERIC;
+
+        vlc_tick_t *pi_system = va_arg( args, vlc_tick_t * );
+        vlc_tick_t *pi_ts = va_arg( args, vlc_tick_t * );
+        if( vlc_clock_main_GetReference( p_pgrm->p_main_clock,
+                                         pi_system, pi_ts ) )
+            return VLC_EGENERIC;
+        return VLC_SUCCESS;
+    }
+    case ES_OUT_SET_CLOCK_REFERENCE:
+    {
+        es_out_pgrm_t *p_pgrm = p_sys->p_pgrm;
+        if( !p_pgrm )
+            return VLC_EGENERIC;
+
+        const vlc_tick_t i_system = va_arg( args, vlc_tick_t );
+        const vlc_tick_t i_ts = va_arg( args, vlc_tick_t );
+        vlc_clock_main_SetReference( p_pgrm->p_main_clock, i_system, i_ts );
+        return VLC_SUCCESS;
+    }
     case ES_OUT_SET_EOS:
     {
         es_out_id_t *id;
@@ -91,7 +91,11 @@ enum es_out_query_private_e
     ES_OUT_SET_VBI_PAGE,                            /* arg1=unsigned res=can fail */
 
     /* Set VBI/Teletext menu transparent */
-    ES_OUT_SET_VBI_TRANSPARENCY                     /* arg1=bool res=can fail */
+    ES_OUT_SET_VBI_TRANSPARENCY,                    /* arg1=bool res=can fail */
+
+    /* Get/set the stream to system conversion point of the output clock */
+    ES_OUT_GET_CLOCK_REFERENCE,                     /* arg1=vlc_tick_t *system arg2=vlc_tick_t *ts res=can fail */
+    ES_OUT_SET_CLOCK_REFERENCE,                     /* arg1=vlc_tick_t system arg2=vlc_tick_t ts res=can fail */
 };
 
 static inline void es_out_SetMode( es_out_t *p_out, int i_mode )
@@ -171,6 +175,16 @@ static inline int es_out_GetGroupForced( es_out_t *p_out )
     assert( !i_ret );
     return i_group;
 }
+static inline int es_out_GetClockReference( es_out_t *p_out,
+                                            vlc_tick_t *pi_system, vlc_tick_t *pi_ts )
+{
+    return es_out_Control( p_out, ES_OUT_GET_CLOCK_REFERENCE, pi_system, pi_ts );
+}
+static inline int es_out_SetClockReference( es_out_t *p_out,
+                                            vlc_tick_t i_system, vlc_tick_t i_ts )
+{
+    return es_out_Control( p_out, ES_OUT_SET_CLOCK_REFERENCE, i_system, i_ts );
+}
 static inline void es_out_Eos( es_out_t *p_out )
 {
     int i_ret = es_out_Control( p_out, ES_OUT_SET_EOS );
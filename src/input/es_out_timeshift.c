@@ -36,6 +36,9 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -160,6 +163,8 @@ typedef struct attribute_packed
     } u;
 } ts_cmd_t;
 
+#define TS_STORAGE_CMD_MAX 30000
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
@@ -173,6 +178,9 @@ struct ts_storage_t
     int64_t i_file_size;/* Current size in bytes */
     FILE    *p_filew;   /* FILE handle for data writing */
     FILE    *p_filer;   /* FILE handle for data reading */
+#ifdef HAVE_MMAP
+    uint8_t *p_map;     /* Read-only mapping of the first i_file_max bytes */
+#endif
 
     /* */
     int      i_cmd_r;
@@ -187,6 +195,7 @@ typedef struct
     input_thread_t *p_input;
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
+    int64_t        i_size_max;
     const char     *psz_tmp_path;
 
     /* Lock for all following fields */
@@ -209,6 +218,8 @@ typedef struct
     /* */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    ts_storage_t   *p_storage_free; /* spare emptied storage */
+    bool           b_discontinuity; /* data was dropped */
 
     vlc_tick_t     i_cmd_delay;
 
@@ -226,6 +237,7 @@ typedef struct
 
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
+    int64_t        i_size_max;        /* Maximal total size in byte (0: none) */
     char           *psz_tmp_path;     /* Path for temporary files */
 
     /* Lock for all following fields */
@@ -265,7 +277,9 @@ static void         *TsRun( void * );
 
 static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
 static void         TsStorageDelete( ts_storage_t * );
+static void         TsStorageReset( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
+static vlc_tick_t   TsStorageDropData( ts_storage_t * );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
@@ -330,6 +344,17 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    /* The data being read and written are never dropped */
+    const int64_t i_size_max = var_CreateGetInteger( p_input, "input-timeshift-size" );
+    if( i_size_max > 0 )
+    {
+        p_sys->i_size_max = __MAX( i_size_max, 2 * p_sys->i_tmp_size_max );
+        msg_Dbg( p_input, "using timeshift maximum size of %"PRId64" MiB",
+                 p_sys->i_size_max/(1024*1024) );
+    }
+    else
+        p_sys->i_size_max = 0;
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !VLC_WINSTORE_APP
     if( p_sys->psz_tmp_path == NULL )
@@ -748,6 +773,8 @@ static int ControlLocked( es_out_t *p_out, int i_query, va_list args )
     case ES_OUT_SET_RECORD_STATE:
     case ES_OUT_SET_VBI_PAGE:
     case ES_OUT_SET_VBI_TRANSPARENCY:
+    case ES_OUT_GET_CLOCK_REFERENCE:
+    case ES_OUT_SET_CLOCK_REFERENCE:
     default:
         vlc_assert_unreachable();
         return VLC_EGENERIC;
@@ -799,6 +826,7 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_size_max = p_sys->i_size_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
@@ -814,6 +842,8 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->p_storage_free = NULL;
+    p_ts->b_discontinuity = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -858,17 +888,73 @@ static void TsStop( ts_thread_t *p_ts )
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
     if( p_ts->p_storage_r )
         TsStorageDelete( p_ts->p_storage_r );
+    if( p_ts->p_storage_free )
+        TsStorageDelete( p_ts->p_storage_free );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
 }
+/* Keeps an emptied storage for reuse, to spare creating a new file */
+static void TsRecycleStorage( ts_thread_t *p_ts, ts_storage_t *p_storage )
+{
+    vlc_mutex_assert( &p_ts->lock );
+
+    if( p_ts->p_storage_free == NULL )
+    {
+        TsStorageReset( p_storage );
+        p_ts->p_storage_free = p_storage;
+    }
+    else
+        TsStorageDelete( p_storage );
+}
+/* Drops the oldest data while over the size limit. Only the blocks are
+ * dropped: the other commands still have to be executed. */
+static void TsTrim( ts_thread_t *p_ts )
+{
+    vlc_mutex_assert( &p_ts->lock );
+
+    int64_t i_size = 0;
+    for( ts_storage_t *p = p_ts->p_storage_r; p != NULL; p = p->p_next )
+        i_size += p->i_file_size;
+
+    ts_storage_t **pp_storage = &p_ts->p_storage_r;
+    while( i_size > p_ts->i_size_max && *pp_storage != p_ts->p_storage_w )
+    {
+        ts_storage_t *p_storage = *pp_storage;
+
+        i_size -= p_storage->i_file_size;
+        if( p_storage->i_file_size > 0 )
+        {
+            const vlc_tick_t i_dropped = TsStorageDropData( p_storage );
+
+            msg_Warn( p_ts->p_input, "es out timeshift: full, dropping %"PRId64" ms",
+                      MS_FROM_VLC_TICK( i_dropped ) );
+            /* Do not wait for the dropped data */
+            p_ts->i_cmd_delay = __MAX( p_ts->i_cmd_delay - i_dropped, 0 );
+            p_ts->b_discontinuity = true;
+        }
+
+        if( TsStorageIsEmpty( p_storage ) )
+        {
+            *pp_storage = p_storage->p_next;
+            TsRecycleStorage( p_ts, p_storage );
+        }
+        else
+            pp_storage = &p_storage->p_next;
+    }
+}
 static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        ts_storage_t *p_storage = p_ts->p_storage_free;
+
+        if( p_storage )
+            p_ts->p_storage_free = NULL;
+        else
+            p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
 
         if( !p_storage )
         {
@@ -887,6 +973,9 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
             TsStoragePack( p_ts->p_storage_w );
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
+
+            if( p_ts->i_size_max > 0 )
+                TsTrim( p_ts );
         }
     }
 
@@ -912,7 +1001,7 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         if( !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
+        TsRecycleStorage( p_ts, p_ts->p_storage_r );
         p_ts->p_storage_r = p_next;
     }
 
@@ -1000,6 +1089,7 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
         bool b_buffering;
+        bool b_discontinuity;
 
         /* Pop a command to execute */
         vlc_mutex_lock( &p_ts->lock );
@@ -1020,6 +1110,10 @@ static void *TsRun( void *p_data )
             vlc_cond_wait( &p_ts->wait, &p_ts->lock );
         }
 
+        b_discontinuity = p_ts->b_discontinuity && cmd.i_type == C_SEND;
+        if( b_discontinuity )
+            p_ts->b_discontinuity = false;
+
         if( b_buffering && i_buffering_date < 0 )
         {
             i_buffering_date = cmd.i_date;
@@ -1089,6 +1183,9 @@ static void *TsRun( void *p_data )
             CmdCleanAdd( &cmd );
             break;
         case C_SEND:
+            /* Do not decode across dropped data */
+            if( b_discontinuity )
+                es_out_Control( p_ts->p_out, ES_OUT_RESET_PCR );
             CmdExecuteSend( p_ts->p_out, &cmd );
             CmdCleanSend( &cmd );
             break;
@@ -1142,6 +1239,15 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         goto error;
     }
 
+#ifdef HAVE_MMAP
+    /* Only the written (and flushed) part of the mapping is ever read, so
+     * it does not matter that it goes past the end of the file. */
+    p_storage->p_map = mmap( NULL, i_tmp_size_max, PROT_READ, MAP_SHARED,
+                             fd, 0 );
+    if( p_storage->p_map == MAP_FAILED )
+        p_storage->p_map = NULL;
+#endif
+
 #ifndef _WIN32
     vlc_unlink( psz_file );
     free( psz_file );
@@ -1157,7 +1263,7 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     /* */
     p_storage->i_cmd_w = 0;
     p_storage->i_cmd_r = 0;
-    p_storage->i_cmd_max = 30000;
+    p_storage->i_cmd_max = TS_STORAGE_CMD_MAX;
     p_storage->p_cmd = vlc_alloc( p_storage->i_cmd_max, sizeof(*p_storage->p_cmd) );
     //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
 
@@ -1185,6 +1291,10 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd );
 
+#ifdef HAVE_MMAP
+    if( p_storage->p_map != NULL )
+        munmap( p_storage->p_map, p_storage->i_file_max );
+#endif
     fclose( p_storage->p_filer );
     fclose( p_storage->p_filew );
 #ifdef _WIN32
@@ -1194,8 +1304,34 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     free( p_storage );
 }
 
+static void TsStorageReset( ts_storage_t *p_storage )
+{
+    assert( TsStorageIsEmpty( p_storage ) );
+
+    /* Overwrite the file from the start */
+    rewind( p_storage->p_filew );
+    p_storage->p_next = NULL;
+    p_storage->i_file_size = 0;
+    p_storage->i_cmd_r = 0;
+    p_storage->i_cmd_w = 0;
+
+    if( p_storage->i_cmd_max < TS_STORAGE_CMD_MAX )
+    {
+        ts_cmd_t *p_new = realloc( p_storage->p_cmd,
+                                   TS_STORAGE_CMD_MAX * sizeof(*p_storage->p_cmd) );
+        if( p_new )
+        {
+            p_storage->p_cmd = p_new;
+            p_storage->i_cmd_max = TS_STORAGE_CMD_MAX;
+        }
+    }
+}
+
 static void TsStoragePack( ts_storage_t *p_storage )
 {
+    /* The storage will not be written anymore, but it will be read */
+    fflush( p_storage->p_filew );
+
     /* Try to release a bit of memory */
     if( p_storage->i_cmd_w >= p_storage->i_cmd_max )
         return;
@@ -1206,6 +1342,25 @@ static void TsStoragePack( ts_storage_t *p_storage )
     if( p_new )
         p_storage->p_cmd = p_new;
 }
+/* Drops the blocks still stored, and returns their duration */
+static vlc_tick_t TsStorageDropData( ts_storage_t *p_storage )
+{
+    if( TsStorageIsEmpty( p_storage ) )
+        return 0;
+
+    const vlc_tick_t i_duration = p_storage->p_cmd[p_storage->i_cmd_w - 1].i_date
+                                - p_storage->p_cmd[p_storage->i_cmd_r].i_date;
+    int i_cmd_w = p_storage->i_cmd_r;
+
+    /* The data is in the file, there is nothing to release */
+    for( int i = p_storage->i_cmd_r; i < p_storage->i_cmd_w; i++ )
+        if( p_storage->p_cmd[i].i_type != C_SEND )
+            p_storage->p_cmd[i_cmd_w++] = p_storage->p_cmd[i];
+    p_storage->i_cmd_w = i_cmd_w;
+    p_storage->i_file_size = 0;
+
+    return i_duration;
+}
 static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     if( p_cmd && p_cmd->i_type == C_SEND && p_storage->i_cmd_w > 0 )
@@ -1256,6 +1411,45 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     }
     p_storage->p_cmd[p_storage->i_cmd_w++] = cmd;
 }
+static int TsStorageReadBlock( ts_storage_t *p_storage, int i_offset,
+                               block_t **pp_block )
+{
+    const size_t i_data = (size_t)i_offset + sizeof(block_t);
+    block_t block;
+    bool b_mapped = false;
+
+#ifdef HAVE_MMAP
+    /* Read from the page cache without any system call, unless the block
+     * went past the mapping (it is the first one of its storage) */
+    if( p_storage->p_map != NULL && i_data <= p_storage->i_file_max )
+    {
+        memcpy( &block, &p_storage->p_map[i_offset], sizeof(block) );
+        b_mapped = block.i_buffer <= p_storage->i_file_max - i_data;
+    }
+#endif
+    if( !b_mapped &&
+        ( fseek( p_storage->p_filer, i_offset, SEEK_SET ) ||
+          fread( &block, sizeof(block), 1, p_storage->p_filer ) != 1 ) )
+        return VLC_EGENERIC;
+
+    block_t *p_block = block_Alloc( block.i_buffer );
+    if( p_block )
+    {
+        p_block->i_dts      = block.i_dts;
+        p_block->i_pts      = block.i_pts;
+        p_block->i_flags    = block.i_flags;
+        p_block->i_length   = block.i_length;
+        p_block->i_nb_samples = block.i_nb_samples;
+#ifdef HAVE_MMAP
+        if( b_mapped )
+            memcpy( p_block->p_buffer, &p_storage->p_map[i_data], block.i_buffer );
+        else
+#endif
+            p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
+    }
+    *pp_block = p_block;
+    return VLC_SUCCESS;
+}
 static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsEmpty( p_storage ) );
@@ -1263,24 +1457,11 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     *p_cmd = p_storage->p_cmd[p_storage->i_cmd_r++];
     if( p_cmd->i_type == C_SEND )
     {
-        block_t block;
+        block_t *p_block;
 
         if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->u.send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
-        {
-            block_t *p_block = block_Alloc( block.i_buffer );
-            if( p_block )
-            {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
-            }
+            !TsStorageReadBlock( p_storage, p_cmd->u.send.i_offset, &p_block ) )
             p_cmd->u.send.p_block = p_block;
-        }
         else
         {
             //perror( "TsStoragePopCmd" );
@@ -54,6 +54,7 @@
 #include <vlc_stream.h>
 #include <vlc_stream_extractor.h>
 #include <vlc_renderer_discovery.h>
+#include <vlc_tracer.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -237,6 +238,20 @@ void input_SetPosition( input_thread_t *p_input, float f_position, bool b_fast )
     input_ControlPush( p_input, INPUT_CONTROL_SET_POSITION, &param );
 }
 
+int input_GetClockReference( input_thread_t *p_input, vlc_tick_t *pi_system,
+                             vlc_tick_t *pi_ts )
+{
+    return es_out_GetClockReference( input_priv(p_input)->p_es_out_display,
+                                     pi_system, pi_ts );
+}
+
+int input_SetClockReference( input_thread_t *p_input, vlc_tick_t i_system,
+                             vlc_tick_t i_ts )
+{
+    return es_out_SetClockReference( input_priv(p_input)->p_es_out_display,
+                                     i_system, i_ts );
+}
+
 /**
  * Get the item from an input thread
  * FIXME it does not increase ref count of the item.
@@ -535,7 +550,13 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     }
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
+    {
+        struct vlc_tracer *tracer = vlc_object_get_tracer( p_input );
+
+        vlc_tracer_Begin( tracer, "demux", "demux" );
         i_ret = demux_Demux( p_demux );
+        vlc_tracer_End( tracer, "demux", "demux" );
+    }
 
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
@@ -1158,7 +1179,7 @@ static void UpdatePtsDelay( input_thread_t *p_input )
     for( int i = 0; i < p_sys->i_slave; i++ )
         i_pts_delay = __MAX( i_pts_delay, p_sys->slave[i]->i_pts_delay );
 
-    if( i_pts_delay < 0 )
+    if( i_pts_delay < 0 || var_InheritBool( p_input, "low-delay" ) )
         i_pts_delay = 0;
 
     /* Update cr_average depending on the caching */
@@ -2052,8 +2073,13 @@ static bool Control( input_thread_t *p_input,
             break;
         }
         case INPUT_CONTROL_UNSET_ES:
-            es_out_Control( input_priv(p_input)->p_es_out_display,
-                            ES_OUT_UNSET_ES, vlc_es_id_get_out(param.id) );
+            if( es_out_Control( input_priv(p_input)->p_es_out_display,
+                                ES_OUT_UNSET_ES, vlc_es_id_get_out(param.id) )
+                                == VLC_SUCCESS )
+                /* Let the demux stop parsing the ES, the remaining selected
+                 * ones can be queried with ES_OUT_GET_ES_STATE */
+                demux_Control( input_priv(p_input)->master->p_demux,
+                               DEMUX_SET_ES_LIST, (size_t)0, NULL );
             break;
         case INPUT_CONTROL_RESTART_ES:
             es_out_Control( input_priv(p_input)->p_es_out_display,
@@ -343,6 +343,22 @@ void input_SetTime( input_thread_t *, vlc_tick_t i_time, bool b_fast );
 
 void input_SetPosition( input_thread_t *, float f_position, bool b_fast );
 
+/**
+ * Get the current stream to system conversion point of the output clock
+ *
+ * This can be called from any thread, while the input is alive.
+ */
+int input_GetClockReference( input_thread_t *, vlc_tick_t *pi_system,
+                             vlc_tick_t *pi_ts );
+
+/**
+ * Force the stream to system conversion point of the output clock
+ *
+ * \see vlc_clock_main_SetReference
+ */
+int input_SetClockReference( input_thread_t *, vlc_tick_t i_system,
+                             vlc_tick_t i_ts );
+
 /**
  * Set the delay of an ES identifier
  */
@@ -674,6 +690,14 @@ typedef struct input_rate_t
     } samples[2];
 } input_rate_t;
 
+typedef struct input_latency_histogram_t
+{
+    atomic_uintmax_t samples;
+    atomic_uintmax_t total;
+    atomic_uintmax_t max;
+    atomic_uintmax_t buckets[INPUT_LATENCY_BUCKETS];
+} input_latency_histogram_t;
+
 struct input_stats {
     input_rate_t input_bitrate;
     input_rate_t demux_bitrate;
@@ -685,11 +709,15 @@ struct input_stats {
     atomic_uintmax_t lost_abuffers;
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t lost_pictures;
+    input_latency_histogram_t latency[INPUT_LATENCY_COUNT];
+    atomic_intmax_t clock_drift; /* parts per billion */
+    atomic_uintmax_t clock_jitter;
 };
 
 struct input_stats *input_stats_Create(void);
 void input_stats_Destroy(struct input_stats *);
 void input_rate_Add(input_rate_t *, uintmax_t);
+void input_latency_Add(input_latency_histogram_t *, vlc_tick_t);
 void input_stats_Compute(struct input_stats *, input_stats_t*);
 
 #endif
@@ -1084,6 +1084,8 @@ input_item_NewExt( const char *psz_uri, const char *psz_name,
     p_input->opaques = NULL;
 
     p_input->i_duration = duration;
+    p_input->i_file_size = -1;
+    p_input->i_file_mtime = -1;
     TAB_INIT( p_input->i_categories, p_input->pp_categories );
     TAB_INIT( p_input->i_es, p_input->es );
     p_input->p_stats = NULL;
@@ -1107,6 +1109,7 @@ input_item_t *input_item_Copy( input_item_t *p_input )
     vlc_meta_t *meta = NULL;
     input_item_t *item;
     bool b_net;
+    int64_t i_file_size, i_file_mtime;
 
     vlc_mutex_lock( &p_input->lock );
 
@@ -1119,6 +1122,8 @@ input_item_t *input_item_Copy( input_item_t *p_input )
         vlc_meta_Merge( meta, p_input->p_meta );
     }
     b_net = p_input->b_net;
+    i_file_size = p_input->i_file_size;
+    i_file_mtime = p_input->i_file_mtime;
     vlc_mutex_unlock( &p_input->lock );
 
     if( likely(item != NULL) )
@@ -1126,6 +1131,8 @@ input_item_t *input_item_Copy( input_item_t *p_input )
         input_item_CopyOptions( item, p_input );
         item->p_meta = meta;
         item->b_net = b_net;
+        item->i_file_size = i_file_size;
+        item->i_file_mtime = i_file_mtime;
     }
 
     return item;
@@ -1286,7 +1293,21 @@ void input_item_node_AppendNode( input_item_node_t *p_parent,
 {
     assert(p_parent != NULL);
     assert(p_child != NULL);
-    TAB_APPEND(p_parent->i_children, p_parent->pp_children, p_child);
+
+    /* Grow the array geometrically: large playlists append children one by
+     * one. The allocated size is not stored, children are only ever removed
+     * without shrinking the array, so it is at least the next power of 2. */
+    int count = p_parent->i_children;
+    if ((count & (count - 1)) == 0)
+    {
+        input_item_node_t **children =
+            vlc_reallocarray(p_parent->pp_children, count > 0 ? 2 * count : 1,
+                             sizeof (*children));
+        if (unlikely(children == NULL))
+            abort();
+        p_parent->pp_children = children;
+    }
+    p_parent->pp_children[p_parent->i_children++] = p_child;
 }
 
 void input_item_node_RemoveNode( input_item_node_t *parent,
@@ -1834,12 +1855,16 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
 
 int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
                                const char *psz_uri, const char *psz_flatpath,
-                               const char *psz_filename, int i_type, int i_net)
+                               const char *psz_filename, int i_type, int i_net,
+                               input_item_t **pp_item)
 {
     enum slave_type i_slave_type;
     struct rdh_slave *p_rdh_slave = NULL;
     assert(psz_flatpath || psz_filename);
 
+    if (pp_item != NULL)
+        *pp_item = NULL;
+
     if (!p_rdh->b_flatten)
     {
         if (psz_filename == NULL)
@@ -1901,6 +1926,8 @@ int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
     input_item_Release(p_item);
     if (p_node == NULL)
         return VLC_ENOMEM;
+    if (pp_item != NULL)
+        *pp_item = p_item;
 
     /* A slave can also be an item. If there is a match, this item will be
      * removed from the parent node. This is not a common case, since most
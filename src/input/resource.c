@@ -223,6 +223,15 @@ audio_output_t *input_resource_GetAout( input_resource_t *p_resource )
         vlc_mutex_lock( &p_resource->lock_hold );
         if( p_resource->p_aout == NULL )
             p_resource->p_aout = p_aout;
+        else
+        {
+            /* Extra output for simultaneous tracks: start at the level of
+             * the main one */
+            float vol = aout_VolumeGet( p_resource->p_aout );
+            if( vol >= 0.f )
+                aout_VolumeSet( p_aout, vol );
+            aout_MuteSet( p_aout, aout_MuteGet( p_resource->p_aout ) > 0 );
+        }
     }
     else
         msg_Dbg( p_resource->p_parent, "reusing audio output" );
@@ -506,6 +515,32 @@ void input_resource_StopFreeVout(input_resource_t *p_resource)
     vlc_mutex_unlock(&p_resource->lock);
 }
 
+int input_resource_PrepareVout(input_resource_t *p_resource)
+{
+    int ret = VLC_SUCCESS;
+
+    vlc_mutex_lock(&p_resource->lock);
+    if (p_resource->i_vout == 0)
+    {
+        assert(p_resource->p_vout_free == NULL);
+
+        /* Same parent as a vout created on demand by input_resource_GetVout */
+        vout_thread_t *vout = vout_Create(VLC_OBJECT(p_resource->p_vout_dummy));
+        if (vout != NULL)
+        {
+            msg_Dbg(p_resource->p_parent, "saving a prepared free vout");
+            vlc_mutex_lock(&p_resource->lock_hold);
+            TAB_APPEND(p_resource->i_vout, p_resource->pp_vout, vout);
+            vlc_mutex_unlock(&p_resource->lock_hold);
+            p_resource->p_vout_free = vout;
+        }
+        else
+            ret = VLC_EGENERIC;
+    }
+    vlc_mutex_unlock(&p_resource->lock);
+    return ret;
+}
+
 /* */
 sout_instance_t *input_resource_RequestSout( input_resource_t *p_resource, sout_instance_t *p_sout, const char *psz_sout )
 {
@@ -63,6 +63,14 @@ void input_resource_HoldVouts( input_resource_t *, vout_thread_t ***, size_t * )
 
 void input_resource_StopFreeVout( input_resource_t * );
 
+/**
+ * This function creates the main vout ahead of playback, if there is none
+ * yet, and keeps it as the free vout.
+ *
+ * The video window is then already open when the first video track starts.
+ */
+int input_resource_PrepareVout( input_resource_t * );
+
 /**
  * This function holds the input_resource_t itself
  */
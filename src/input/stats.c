@@ -67,6 +67,17 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->lost_abuffers, 0);
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    for (size_t i = 0; i < INPUT_LATENCY_COUNT; i++)
+    {
+        input_latency_histogram_t *h = &stats->latency[i];
+        atomic_init(&h->samples, 0);
+        atomic_init(&h->total, 0);
+        atomic_init(&h->max, 0);
+        for (size_t j = 0; j < INPUT_LATENCY_BUCKETS; j++)
+            atomic_init(&h->buckets[j], 0);
+    }
+    atomic_init(&stats->clock_drift, 0);
+    atomic_init(&stats->clock_jitter, 0);
     return stats;
 }
 
@@ -110,6 +121,53 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+
+    /* Decoder latencies */
+    for (size_t i = 0; i < INPUT_LATENCY_COUNT; i++)
+    {
+        input_latency_histogram_t *h = &stats->latency[i];
+        input_latency_t *l = &st->latency[i];
+
+        l->i_samples = atomic_load_explicit(&h->samples, memory_order_relaxed);
+        l->i_total = atomic_load_explicit(&h->total, memory_order_relaxed);
+        l->i_max = atomic_load_explicit(&h->max, memory_order_relaxed);
+        for (size_t j = 0; j < INPUT_LATENCY_BUCKETS; j++)
+            l->pi_buckets[j] = atomic_load_explicit(&h->buckets[j],
+                                                    memory_order_relaxed);
+    }
+
+    /* Clock */
+    st->f_clock_drift = atomic_load_explicit(&stats->clock_drift,
+                                             memory_order_relaxed) / 1000.f;
+    st->i_clock_jitter = atomic_load_explicit(&stats->clock_jitter,
+                                              memory_order_relaxed);
+}
+
+/**
+ * Add a sample to a latency histogram
+ *
+ * This is lock-free, and can be called from any thread. The counters are
+ * updated independently, a concurrent reader may see them slightly off.
+ */
+void input_latency_Add(input_latency_histogram_t *h, vlc_tick_t latency)
+{
+    if (latency < 0)
+        latency = 0;
+
+    uintmax_t us = US_FROM_VLC_TICK(latency);
+    size_t bucket = 0;
+    for (uintmax_t v = us; v > 1 && bucket < INPUT_LATENCY_BUCKETS - 1; v >>= 1)
+        bucket++;
+
+    atomic_fetch_add_explicit(&h->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->total, latency, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->samples, 1, memory_order_relaxed);
+
+    uintmax_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while ((uintmax_t)latency > max
+        && !atomic_compare_exchange_weak_explicit(&h->max, &max, latency,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
 }
 
 /** Update a counter element with new values
@@ -38,6 +38,7 @@
 #include <vlc_charset.h>
 #include <vlc_interrupt.h>
 #include <vlc_stream_extractor.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "stream.h"
@@ -402,7 +403,7 @@ static ssize_t vlc_stream_CopyBlock(block_t **restrict pp,
     return likely(len > 0) ? (ssize_t)len : -1;
 }
 
-static ssize_t vlc_stream_ReadRaw(stream_t *s, void *buf, size_t len)
+static ssize_t vlc_stream_ReadModule(stream_t *s, void *buf, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
     ssize_t ret;
@@ -446,6 +447,16 @@ static ssize_t vlc_stream_ReadRaw(stream_t *s, void *buf, size_t len)
     return 0;
 }
 
+static ssize_t vlc_stream_ReadRaw(stream_t *s, void *buf, size_t len)
+{
+    struct vlc_tracer *tracer = vlc_object_get_tracer(s);
+
+    vlc_tracer_Begin(tracer, "stream", "read");
+    ssize_t ret = vlc_stream_ReadModule(s, buf, len);
+    vlc_tracer_End(tracer, "stream", "read");
+    return ret;
+}
+
 ssize_t vlc_stream_ReadPartial(stream_t *s, void *buf, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
@@ -25,6 +25,9 @@
 #endif
 
 #include <vlc_thumbnailer.h>
+#include <vlc_executor.h>
+#include <vlc_image.h>
+#include <vlc_memstream.h>
 #include "input_internal.h"
 #include "misc/background_worker.h"
 
@@ -54,6 +57,10 @@ typedef struct vlc_thumbnailer_params_t
      */
     vlc_tick_t timeout;
     vlc_thumbnailer_cb cb;
+    /* Batch of times, with fast seeking */
+    const vlc_tick_t *times;
+    size_t count;
+    vlc_thumbnailer_batch_cb batch_cb;
     void* user_data;
 } vlc_thumbnailer_params_t;
 
@@ -66,8 +73,40 @@ struct vlc_thumbnailer_request_t
 
     vlc_mutex_t lock;
     bool done;
+    size_t index; /**< index of the next thumbnail of a batch */
+    vlc_tick_t *times;
 };
 
+/*
+ * Reports the thumbnail (or the failure) of the current seek, with the
+ * request lock held. Returns true if another thumbnail of the batch should
+ * be taken.
+ */
+static bool thumbnailer_request_Notify( vlc_thumbnailer_request_t* request,
+                                        picture_t* pic )
+{
+    vlc_thumbnailer_params_t *params = &request->params;
+
+    if ( params->cb != NULL )
+    {
+        params->cb( params->user_data, pic );
+        params->cb = NULL;
+        return false;
+    }
+    if ( params->batch_cb == NULL )
+        return false;
+
+    params->batch_cb( params->user_data, request->index++, pic );
+    if ( pic == NULL )
+        /* The remaining timestamps cannot be reached either */
+        while ( request->index < params->count )
+            params->batch_cb( params->user_data, request->index++, NULL );
+    if ( request->index < params->count )
+        return true;
+    params->batch_cb = NULL;
+    return false;
+}
+
 static void
 on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
@@ -82,26 +121,30 @@ on_thumbnailer_input_event( input_thread_t *input,
     picture_t *pic = NULL;
 
     if ( event->type == INPUT_EVENT_THUMBNAIL_READY )
-    {
-        /*
-         * Stop the input thread ASAP, delegate its release to
-         * thumbnailer_request_Release
-         */
-        input_Stop( request->input_thread );
         pic = event->thumbnail;
-    }
+
     vlc_mutex_lock( &request->lock );
-    request->done = true;
     /*
      * If the request has not been cancelled, we can invoke the completion
      * callback.
      */
-    if ( request->params.cb )
+    if ( thumbnailer_request_Notify( request, pic ) )
     {
-        request->params.cb( request->params.user_data, pic );
-        request->params.cb = NULL;
+        /* Keep the input open for the next thumbnail of the batch */
+        input_SetTime( request->input_thread,
+                       request->params.times[request->index], true );
+        vlc_mutex_unlock( &request->lock );
+        return;
     }
+    request->done = true;
     vlc_mutex_unlock( &request->lock );
+
+    if ( pic != NULL )
+        /*
+         * Stop the input thread ASAP, delegate its release to
+         * thumbnailer_request_Release
+         */
+        input_Stop( request->input_thread );
     background_worker_RequestProbe( request->thumbnailer->worker );
 }
 
@@ -118,6 +161,7 @@ static void thumbnailer_request_Release( void* data )
 
     input_item_Release( request->params.input_item );
     vlc_mutex_destroy( &request->lock );
+    free( request->times );
     free( request );
 }
 
@@ -131,10 +175,14 @@ static int thumbnailer_request_Start( void* owner, void* entity, void** out )
                                      request->params.input_item );
     if ( unlikely( input == NULL ) )
     {
-        request->params.cb( request->params.user_data, NULL );
+        vlc_mutex_lock( &request->lock );
+        thumbnailer_request_Notify( request, NULL );
+        vlc_mutex_unlock( &request->lock );
         return VLC_EGENERIC;
     }
-    if ( request->params.type == VLC_THUMBNAILER_SEEK_TIME )
+    if ( request->times != NULL )
+        input_SetTime( input, request->times[0], true );
+    else if ( request->params.type == VLC_THUMBNAILER_SEEK_TIME )
     {
         input_SetTime( input, request->params.time,
                        request->params.fast_seek );
@@ -147,7 +195,9 @@ static int thumbnailer_request_Start( void* owner, void* entity, void** out )
     }
     if ( input_Start( input ) != VLC_SUCCESS )
     {
-        request->params.cb( request->params.user_data, NULL );
+        vlc_mutex_lock( &request->lock );
+        thumbnailer_request_Notify( request, NULL );
+        vlc_mutex_unlock( &request->lock );
         return VLC_EGENERIC;
     }
     *out = request;
@@ -164,11 +214,8 @@ static void thumbnailer_request_Stop( void* owner, void* handle )
      * If the callback hasn't been invoked yet, we assume a timeout and
      * signal it back to the user
      */
-    if ( request->params.cb != NULL )
-    {
-        request->params.cb( request->params.user_data, NULL );
-        request->params.cb = NULL;
-    }
+    request->done = true;
+    thumbnailer_request_Notify( request, NULL );
     vlc_mutex_unlock( &request->lock );
     assert( request->input_thread != NULL );
     input_Stop( request->input_thread );
@@ -195,6 +242,20 @@ thumbnailer_RequestCommon( vlc_thumbnailer_t* thumbnailer,
     request->input_thread = NULL;
     request->params = *(vlc_thumbnailer_params_t*)params;
     request->done = false;
+    request->index = 0;
+    request->times = NULL;
+    if ( params->count > 0 )
+    {
+        request->times = vlc_alloc( params->count, sizeof (*request->times) );
+        if ( unlikely( request->times == NULL ) )
+        {
+            free( request );
+            return NULL;
+        }
+        memcpy( request->times, params->times,
+                params->count * sizeof (*request->times) );
+        request->params.times = request->times;
+    }
     input_item_Hold( request->params.input_item );
     vlc_mutex_init( &request->lock );
 
@@ -246,12 +307,35 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
         });
 }
 
+vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              const vlc_tick_t *times, size_t count,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_batch_cb cb, void* user_data )
+{
+    if ( count == 0 )
+        return NULL;
+
+    return thumbnailer_RequestCommon( thumbnailer,
+            &(const vlc_thumbnailer_params_t){
+                .type = VLC_THUMBNAILER_SEEK_TIME,
+                .fast_seek = true,
+                .input_item = input_item,
+                .timeout = timeout,
+                .times = times,
+                .count = count,
+                .batch_cb = cb,
+                .user_data = user_data,
+        });
+}
+
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer,
                              vlc_thumbnailer_request_t* req )
 {
     vlc_mutex_lock( &req->lock );
     /* Ensure we won't invoke the callback if the input was running. */
     req->params.cb = NULL;
+    req->params.batch_cb = NULL;
     vlc_mutex_unlock( &req->lock );
     background_worker_Cancel( thumbnailer->worker, req );
 }
@@ -264,7 +348,8 @@ vlc_thumbnailer_t *vlc_thumbnailer_Create( vlc_object_t* parent)
     thumbnailer->parent = parent;
     struct background_worker_config cfg = {
         .default_timeout = -1,
-        .max_threads = 1,
+        .max_threads = var_InheritInteger( parent, "thumbnailer-threads" ),
+        .executor = vlc_object_executor( parent ),
         .pf_release = thumbnailer_request_Release,
         .pf_hold = thumbnailer_request_Hold,
         .pf_start = thumbnailer_request_Start,
@@ -280,6 +365,226 @@ vlc_thumbnailer_t *vlc_thumbnailer_Create( vlc_object_t* parent)
     return thumbnailer;
 }
 
+/*
+ * Sprite sheets
+ *
+ * The tiles are split in contiguous segments, each taken by a batch request
+ * with its own input, so that the segments are decoded in parallel.
+ */
+struct sheet_segment
+{
+    struct thumbnail_sheet *sheet;
+    size_t first; /**< index of the first tile */
+    size_t count;
+    image_handler_t *image;
+};
+
+struct thumbnail_sheet
+{
+    vlc_mutex_t lock;
+    picture_t *picture;
+    struct vlc_thumbnailer_sheet_params params;
+    vlc_tick_t duration;
+    size_t count;
+    size_t pending; /**< tiles not done yet, plus one for the requester */
+    vlc_thumbnailer_sheet_cb cb;
+    void *user_data;
+    struct sheet_segment segments[];
+};
+
+static void sheet_PrintTime( struct vlc_memstream *ms, vlc_tick_t t )
+{
+    lldiv_t ms_of_sec = lldiv( MS_FROM_VLC_TICK( t ), 1000 );
+    lldiv_t s = lldiv( ms_of_sec.quot, 60 );
+    lldiv_t m = lldiv( s.quot, 60 );
+
+    vlc_memstream_printf( ms, "%02lld:%02lld:%02lld.%03lld",
+                          m.quot, m.rem, s.rem, ms_of_sec.rem );
+}
+
+static char *sheet_Index( const struct thumbnail_sheet *sheet )
+{
+    const struct vlc_thumbnailer_sheet_params *p = &sheet->params;
+    struct vlc_memstream ms;
+
+    if ( vlc_memstream_open( &ms ) )
+        return NULL;
+    vlc_memstream_puts( &ms, "WEBVTT\n" );
+    for ( size_t i = 0; i < sheet->count; i++ )
+    {
+        vlc_tick_t start = i * p->interval;
+        vlc_tick_t end = __MIN( start + p->interval, sheet->duration );
+
+        vlc_memstream_putc( &ms, '\n' );
+        sheet_PrintTime( &ms, start );
+        vlc_memstream_puts( &ms, " --> " );
+        sheet_PrintTime( &ms, end );
+        vlc_memstream_printf( &ms, "\n#xywh=%u,%u,%u,%u\n",
+                              (unsigned)(i % p->columns) * p->tile_width,
+                              (unsigned)(i / p->columns) * p->tile_height,
+                              p->tile_width, p->tile_height );
+    }
+    return vlc_memstream_close( &ms ) ? NULL : ms.ptr;
+}
+
+/* Drops one pending tile; the last one completes the sheet */
+static void sheet_Release( struct thumbnail_sheet *sheet )
+{
+    vlc_mutex_lock( &sheet->lock );
+    bool done = --sheet->pending == 0;
+    vlc_mutex_unlock( &sheet->lock );
+    if ( !done )
+        return;
+
+    char *index = sheet_Index( sheet );
+    if ( index != NULL )
+        sheet->cb( sheet->user_data, sheet->picture, index );
+    else
+        sheet->cb( sheet->user_data, NULL, NULL );
+    free( index );
+
+    picture_Release( sheet->picture );
+    vlc_mutex_destroy( &sheet->lock );
+    free( sheet );
+}
+
+static void sheet_Blit( struct thumbnail_sheet *sheet, size_t tile,
+                        const picture_t *pic )
+{
+    const struct vlc_thumbnailer_sheet_params *p = &sheet->params;
+    const plane_t *src = &pic->p[0];
+    plane_t *dst = &sheet->picture->p[0];
+    const unsigned width = __MIN( p->tile_width,
+                                  (unsigned)src->i_visible_pitch / 4 );
+    const unsigned lines = __MIN( p->tile_height,
+                                  (unsigned)src->i_visible_lines );
+    uint8_t *out = dst->p_pixels
+                 + (tile / p->columns) * p->tile_height * dst->i_pitch
+                 + (tile % p->columns) * p->tile_width * 4;
+
+    /* Tiles do not overlap: no need to lock the sheet */
+    for ( unsigned y = 0; y < lines; y++ )
+        memcpy( out + y * dst->i_pitch, src->p_pixels + y * src->i_pitch,
+                width * 4 );
+}
+
+static void sheet_OnThumbnail( void *data, size_t index, picture_t *pic )
+{
+    struct sheet_segment *seg = data;
+    struct thumbnail_sheet *sheet = seg->sheet;
+
+    if ( pic != NULL && seg->image != NULL )
+    {
+        video_format_t fmt;
+
+        video_format_Init( &fmt, VLC_CODEC_RGBA );
+        fmt.i_width = fmt.i_visible_width = sheet->params.tile_width;
+        fmt.i_height = fmt.i_visible_height = sheet->params.tile_height;
+        fmt.i_sar_num = fmt.i_sar_den = 1;
+
+        picture_t *tile = image_Convert( seg->image, pic, &pic->format, &fmt );
+        if ( tile != NULL )
+        {
+            sheet_Blit( sheet, seg->first + index, tile );
+            picture_Release( tile );
+        }
+    }
+
+    if ( index + 1 == seg->count && seg->image != NULL )
+    {   /* Last tile of the segment */
+        image_HandlerDelete( seg->image );
+        seg->image = NULL;
+    }
+    sheet_Release( sheet );
+}
+
+int vlc_thumbnailer_RequestSheet( vlc_thumbnailer_t *thumbnailer,
+                                  input_item_t *input_item,
+                                  const struct vlc_thumbnailer_sheet_params *params,
+                                  vlc_tick_t timeout,
+                                  vlc_thumbnailer_sheet_cb cb, void *user_data )
+{
+    vlc_tick_t duration = input_item_GetDuration( input_item );
+
+    if ( params->interval <= 0 || params->tile_width == 0
+      || params->tile_height == 0 || params->columns == 0 || duration <= 0 )
+        return VLC_EGENERIC;
+
+    const size_t count = (duration + params->interval - 1) / params->interval;
+    const unsigned rows = (count + params->columns - 1) / params->columns;
+    unsigned segments = params->segments;
+
+    if ( segments == 0 )
+        segments = var_InheritInteger( thumbnailer->parent,
+                                       "thumbnailer-threads" );
+    segments = __MAX( __MIN( segments, count ), 1u );
+
+    if ( (uint64_t)params->tile_width * params->columns > 16384
+      || (uint64_t)params->tile_height * rows > 16384 )
+        return VLC_EGENERIC;
+
+    struct thumbnail_sheet *sheet =
+        malloc( sizeof (*sheet) + segments * sizeof (sheet->segments[0]) );
+    if ( unlikely( sheet == NULL ) )
+        return VLC_ENOMEM;
+
+    video_format_t fmt;
+    video_format_Init( &fmt, VLC_CODEC_RGBA );
+    fmt.i_width = fmt.i_visible_width = params->tile_width * params->columns;
+    fmt.i_height = fmt.i_visible_height = params->tile_height * rows;
+    fmt.i_sar_num = fmt.i_sar_den = 1;
+
+    vlc_tick_t *times = vlc_alloc( count, sizeof (*times) );
+    sheet->picture = picture_NewFromFormat( &fmt );
+    if ( unlikely( times == NULL || sheet->picture == NULL ) )
+    {
+        if ( sheet->picture != NULL )
+            picture_Release( sheet->picture );
+        free( times );
+        free( sheet );
+        return VLC_ENOMEM;
+    }
+    /* Missing tiles are left transparent */
+    memset( sheet->picture->p[0].p_pixels, 0,
+            sheet->picture->p[0].i_pitch * sheet->picture->p[0].i_lines );
+
+    vlc_mutex_init( &sheet->lock );
+    sheet->params = *params;
+    sheet->duration = duration;
+    sheet->count = count;
+    sheet->pending = count + 1;
+    sheet->cb = cb;
+    sheet->user_data = user_data;
+
+    for ( size_t i = 0; i < count; i++ )
+        times[i] = i * params->interval;
+
+    for ( unsigned i = 0; i < segments; i++ )
+    {
+        struct sheet_segment *seg = &sheet->segments[i];
+
+        seg->sheet = sheet;
+        seg->first = count * i / segments;
+        seg->count = count * (i + 1) / segments - seg->first;
+        seg->image = image_HandlerCreate( thumbnailer->parent );
+    }
+
+    for ( unsigned i = 0; i < segments; i++ )
+    {
+        struct sheet_segment *seg = &sheet->segments[i];
+
+        if ( vlc_thumbnailer_RequestBatch( thumbnailer, times + seg->first,
+                                           seg->count, input_item, timeout,
+                                           sheet_OnThumbnail, seg ) == NULL )
+            for ( size_t j = 0; j < seg->count; j++ )
+                sheet_OnThumbnail( seg, j, NULL );
+    }
+    free( times );
+
+    sheet_Release( sheet );
+    return VLC_SUCCESS;
+}
+
 void vlc_thumbnailer_Release( vlc_thumbnailer_t *thumbnailer )
 {
     background_worker_Delete( thumbnailer->worker );
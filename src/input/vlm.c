@@ -85,23 +85,36 @@ static void preparse_on_media_meta_changed(vlc_player_t *player,
 }
 
 
+/* Flags an instance for the management thread and wakes it up */
+static void vlm_InstanceStopped( vlm_t *p_vlm,
+                                 vlm_media_instance_sys_t *p_instance )
+{
+    atomic_store_explicit( &p_instance->b_stopped, true, memory_order_release );
+
+    vlc_mutex_lock( &p_vlm->lock_manage );
+    p_vlm->input_state_changed = true;
+    vlc_cond_signal( &p_vlm->wait_manage );
+    vlc_mutex_unlock( &p_vlm->lock_manage );
+}
+
 static void player_on_state_changed(vlc_player_t *player,
                                     enum vlc_player_state new_state, void *data)
 {
     vlm_media_sys_t *p_media = data;
     vlm_t *p_vlm = libvlc_priv( vlc_object_instance(p_media) )->p_vlm;
     assert( p_vlm );
-    const char *psz_instance_name = NULL;
+    vlm_media_instance_sys_t *p_instance = NULL;
 
     for( int i = 0; i < p_media->i_instance; i++ )
     {
         if( p_media->instance[i]->player == player )
         {
-            psz_instance_name = p_media->instance[i]->psz_name;
+            p_instance = p_media->instance[i];
             break;
         }
     }
-    assert(psz_instance_name);
+    assert(p_instance);
+    const char *psz_instance_name = p_instance->psz_name;
     enum vlm_state_e vlm_state;
     switch (new_state)
     {
@@ -125,10 +138,10 @@ static void player_on_state_changed(vlc_player_t *player,
     }
     vlm_SendEventMediaInstanceState( p_vlm, p_media->cfg.id, p_media->cfg.psz_name, psz_instance_name, vlm_state );
 
-    vlc_mutex_lock( &p_vlm->lock_manage );
-    p_vlm->input_state_changed = true;
-    vlc_cond_signal( &p_vlm->wait_manage );
-    vlc_mutex_unlock( &p_vlm->lock_manage );
+    /* The management thread only acts on players that are not started */
+    if( new_state == VLC_PLAYER_STATE_STOPPING ||
+        new_state == VLC_PLAYER_STATE_STOPPED )
+        vlm_InstanceStopped( p_vlm, p_instance );
 }
 
 static vlc_mutex_t vlm_mutex = VLC_STATIC_MUTEX;
@@ -171,6 +184,7 @@ vlm_t *vlm_New( libvlc_int_t *libvlc, const char *psz_vlmconf )
     p_vlm->input_state_changed = false;
     p_vlm->i_id = 1;
     TAB_INIT( p_vlm->i_media, p_vlm->media );
+    vlc_dictionary_init( &p_vlm->media_by_name, 0 );
     TAB_INIT( p_vlm->i_schedule, p_vlm->schedule );
     p_vlm->p_vod = NULL;
     var_Create( p_vlm, "intf-event", VLC_VAR_ADDRESS );
@@ -234,6 +248,7 @@ void vlm_Delete( vlm_t *p_vlm )
     vlc_mutex_lock( &p_vlm->lock );
     vlm_ControlInternal( p_vlm, VLM_CLEAR_MEDIAS );
     TAB_CLEAN( p_vlm->i_media, p_vlm->media );
+    vlc_dictionary_clear( &p_vlm->media_by_name, NULL, NULL );
 
     vlm_ControlInternal( p_vlm, VLM_CLEAR_SCHEDULES );
     TAB_CLEAN( p_vlm->i_schedule, p_vlm->schedule );
@@ -390,6 +405,19 @@ static int vlm_MediaVodControl( void *p_private, vod_media_t *p_vod_media,
 }
 
 
+/* First occurrence of a schedule after a date */
+time_t vlm_ScheduleNextDate( const vlm_schedule_sys_t *sched, time_t date )
+{
+    if( sched->period <= 0 || sched->date > date )
+        return sched->date;
+
+    time_t i_occurrence = ( date - sched->date ) / sched->period + 1;
+    if( sched->i_repeat >= 0 && i_occurrence > sched->i_repeat )
+        i_occurrence = sched->i_repeat;
+
+    return sched->date + i_occurrence * sched->period;
+}
+
 /*****************************************************************************
  * Manage:
  *****************************************************************************/
@@ -430,6 +458,14 @@ static void* Manage( void* p_object )
             {
                 vlm_media_instance_sys_t *p_instance = p_media->instance[j];
 
+                /* Do not lock the players that did not stop meanwhile */
+                if( !atomic_exchange_explicit( &p_instance->b_stopped, false,
+                                               memory_order_acquire ) )
+                {
+                    j++;
+                    continue;
+                }
+
                 vlc_player_Lock(p_instance->player);
                 if (!vlc_player_IsStarted(p_instance->player))
                 {
@@ -474,20 +510,9 @@ static void* Manage( void* p_object )
                     real_date = now;
                     b_now = true;
                 }
-                else if( vlm->schedule[i]->period != 0 )
-                {
-                    int j = 0;
-                    while( ((vlm->schedule[i]->date + j *
-                             vlm->schedule[i]->period) <= lastcheck) &&
-                           ( vlm->schedule[i]->i_repeat > j ||
-                             vlm->schedule[i]->i_repeat < 0 ) )
-                    {
-                        j++;
-                    }
-
-                    real_date = vlm->schedule[i]->date + j *
-                        vlm->schedule[i]->period;
-                }
+                else
+                    real_date = vlm_ScheduleNextDate( vlm->schedule[i],
+                                                      lastcheck );
 
                 if( real_date <= now )
                 {
@@ -551,23 +576,27 @@ typedef struct
 */
 
 /* */
+/* Ids are allocated in increasing order and the removals keep the order */
 static vlm_media_sys_t *vlm_ControlMediaGetById( vlm_t *p_vlm, int64_t id )
 {
-    for( int i = 0; i < p_vlm->i_media; i++ )
+    int i_min = 0, i_max = p_vlm->i_media;
+
+    while( i_min < i_max )
     {
-        if( p_vlm->media[i]->cfg.id == id )
+        int i = i_min + ( i_max - i_min ) / 2;
+
+        if( p_vlm->media[i]->cfg.id < id )
+            i_min = i + 1;
+        else if( p_vlm->media[i]->cfg.id > id )
+            i_max = i;
+        else
             return p_vlm->media[i];
     }
     return NULL;
 }
 static vlm_media_sys_t *vlm_ControlMediaGetByName( vlm_t *p_vlm, const char *psz_name )
 {
-    for( int i = 0; i < p_vlm->i_media; i++ )
-    {
-        if( !strcmp( p_vlm->media[i]->cfg.psz_name, psz_name ) )
-            return p_vlm->media[i];
-    }
-    return NULL;
+    return vlc_dictionary_value_for_key( &p_vlm->media_by_name, psz_name );
 }
 static int vlm_MediaDescriptionCheck( vlm_t *p_vlm, vlm_media_t *p_cfg )
 {
@@ -575,13 +604,9 @@ static int vlm_MediaDescriptionCheck( vlm_t *p_vlm, vlm_media_t *p_cfg )
         !strcmp( p_cfg->psz_name, "all" ) || !strcmp( p_cfg->psz_name, "media" ) || !strcmp( p_cfg->psz_name, "schedule" ) )
         return VLC_EGENERIC;
 
-    for( int i = 0; i < p_vlm->i_media; i++ )
-    {
-        if( p_vlm->media[i]->cfg.id == p_cfg->id )
-            continue;
-        if( !strcmp( p_vlm->media[i]->cfg.psz_name, p_cfg->psz_name ) )
-            return VLC_EGENERIC;
-    }
+    vlm_media_sys_t *p_media = vlm_ControlMediaGetByName( p_vlm, p_cfg->psz_name );
+    if( p_media && p_media->cfg.id != p_cfg->id )
+        return VLC_EGENERIC;
     return VLC_SUCCESS;
 }
 
@@ -745,8 +770,12 @@ static int vlm_ControlMediaChange( vlm_t *p_vlm, vlm_media_t *p_cfg )
         /* TODO check what are the changes being done (stop instance if needed) */
     }
 
+    vlc_dictionary_remove_value_for_key( &p_vlm->media_by_name,
+                                         p_media->cfg.psz_name, NULL, NULL );
     vlm_media_Clean( &p_media->cfg );
     vlm_media_Copy( &p_media->cfg, p_cfg );
+    vlc_dictionary_insert( &p_vlm->media_by_name, p_media->cfg.psz_name,
+                           p_media );
 
     return vlm_OnMediaUpdate( p_vlm, p_media );
 }
@@ -810,6 +839,8 @@ static int vlm_ControlMediaAdd( vlm_t *p_vlm, vlm_media_t *p_cfg, int64_t *p_id
 
     /* */
     TAB_APPEND( p_vlm->i_media, p_vlm->media, p_media );
+    vlc_dictionary_insert( &p_vlm->media_by_name, p_media->cfg.psz_name,
+                           p_media );
 
     if( p_id )
         *p_id = p_media->cfg.id;
@@ -838,6 +869,8 @@ static int vlm_ControlMediaDel( vlm_t *p_vlm, int64_t id )
     /* */
     vlm_SendEventMediaRemoved( p_vlm, id, p_media->cfg.psz_name );
 
+    vlc_dictionary_remove_value_for_key( &p_vlm->media_by_name,
+                                         p_media->cfg.psz_name, NULL, NULL );
     vlm_media_Clean( &p_media->cfg );
 
     input_item_Release( p_media->vod.p_item );
@@ -922,6 +955,7 @@ static vlm_media_instance_sys_t *vlm_MediaInstanceNew( vlm_media_sys_t *p_media,
         goto error;
 
     p_instance->i_index = 0;
+    atomic_init( &p_instance->b_stopped, false );
     p_instance->p_parent = vlc_object_create( p_media, sizeof (vlc_object_t) );
     if (!p_instance->p_parent)
         goto error;
@@ -1008,6 +1042,12 @@ static int vlm_ControlMediaInstanceStart( vlm_t *p_vlm, int64_t id, const char *
                             p_media->vod.p_media );
             var_Create( p_instance->p_parent, "vod-session", VLC_VAR_STRING );
             var_SetString( p_instance->p_parent, "vod-session", psz_id );
+
+            /* The ES were announced when the media was created: subtitles
+             * found next to the file could not be streamed anyway, so do not
+             * scan its directory for each session. */
+            input_item_AddOption( p_instance->p_item, "no-sub-autodetect-file",
+                                  VLC_INPUT_OPTION_TRUSTED );
         }
 
         if( p_cfg->psz_output != NULL || psz_vod_output != NULL )
@@ -1059,7 +1099,8 @@ static int vlm_ControlMediaInstanceStart( vlm_t *p_vlm, int64_t id, const char *
         input_item_SetURI( p_instance->p_item, p_media->cfg.ppsz_input[p_instance->i_index] ) ;
 
     vlc_player_SetCurrentMedia(player, p_instance->p_item);
-    vlc_player_Start(player);
+    if( vlc_player_Start(player) != VLC_SUCCESS )
+        vlm_InstanceStopped( p_vlm, p_instance );
     vlc_player_Unlock(player);
 
     vlm_SendEventMediaInstanceStarted( p_vlm, id, p_media->cfg.psz_name );
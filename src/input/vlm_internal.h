@@ -23,6 +23,8 @@
 #ifndef LIBVLC_VLM_INTERNAL_H
 #define LIBVLC_VLM_INTERNAL_H 1
 
+#include <stdatomic.h>
+#include <vlc_arrays.h>
 #include <vlc_vlm.h>
 #include <vlc_player.h>
 #include "input_interface.h"
@@ -41,6 +43,9 @@ typedef struct
     vlc_player_t *player;
     vlc_player_listener_id *listener;
 
+    /* set when the player stopped, for the management thread */
+    atomic_bool b_stopped;
+
 } vlm_media_instance_sys_t;
 
 
@@ -98,9 +103,10 @@ struct vlm_t
     /* Vod server (used by media) */
     vod_t          *p_vod;
 
-    /* Media list */
+    /* Media list, sorted by id */
     int                i_media;
     vlm_media_sys_t    **media;
+    vlc_dictionary_t   media_by_name;
 
     /* Schedule list */
     int            i_schedule;
@@ -110,5 +116,6 @@ struct vlm_t
 int vlm_ControlInternal( vlm_t *p_vlm, int i_query, ... );
 int ExecuteCommand( vlm_t *, const char *, vlm_message_t ** );
 void vlm_ScheduleDelete( vlm_t *vlm, vlm_schedule_sys_t *sched );
+time_t vlm_ScheduleNextDate( const vlm_schedule_sys_t *sched, time_t date );
 
 #endif
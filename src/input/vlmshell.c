@@ -1497,19 +1497,7 @@ static vlm_message_t *vlm_Show( vlm_t *vlm, vlm_media_sys_t *media,
 
             /* calculate next date */
             time(&now);
-            next_date = s->date;
-
-            if( s->period != 0 )
-            {
-                int j = 0;
-                while( ((s->date + j * s->period) <= now) &&
-                       ( s->i_repeat > j || s->i_repeat < 0 ) )
-                {
-                    j++;
-                }
-
-                next_date = s->date + j * s->period;
-            }
+            next_date = vlm_ScheduleNextDate( s, now );
 
             if( next_date > now )
             {
@@ -88,6 +88,12 @@ static const char *const ppsz_snap_formats[] =
     "This is the verbosity level (0=only errors and " \
     "standard messages, 1=warnings, 2=debug).")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Formats the messages on the calling thread, but writes them to the " \
+    "log from a dedicated thread, so that slow logs do not stall playback. " \
+    "Messages are dropped if the log cannot keep up.")
+
 #define OPEN_TEXT N_("Default stream")
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
@@ -483,6 +489,17 @@ static const char *const screensaver_texts[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define VIDEO_PACING_TEXT N_("Pace frames on the display refresh")
+#define VIDEO_PACING_LONGTEXT N_( \
+    "This displays pictures on the display refresh preceding their " \
+    "presentation date, which reduces judder when the refresh rate is " \
+    "not a multiple of the video frame rate." )
+
+#define DISPLAY_REFRESH_RATE_TEXT N_("Display refresh rate")
+#define DISPLAY_REFRESH_RATE_LONGTEXT N_( \
+    "Refresh rate of the display in Hz, used to pace frames. " \
+    "0 learns it from the display." )
+
 #define QUIET_SYNCHRO_TEXT N_("Quiet synchro")
 #define QUIET_SYNCHRO_LONGTEXT N_( \
     "This avoids flooding the message log with debug output from the " \
@@ -522,6 +539,12 @@ static const char *const screensaver_texts[] = {
 #define NETWORK_CACHING_LONGTEXT N_( \
     "Caching value for network resources, in milliseconds." )
 
+#define ZAP_CACHING_TEXT N_("Fast start caching (ms)")
+#define ZAP_CACHING_LONGTEXT N_( \
+    "Shorter caching value used to start live streams, for faster channel " \
+    "changes, in milliseconds. The normal caching is restored the first " \
+    "time the stream is late. 0 disables it." )
+
 #define CR_AVERAGE_TEXT N_("Clock reference average counter")
 #define CR_AVERAGE_LONGTEXT N_( \
     "When using the PVR input (or a very irregular source), you should " \
@@ -538,6 +561,12 @@ static const char *const screensaver_texts[] = {
     "This defines the maximum input delay jitter that the synchronization " \
     "algorithms should try to compensate (in milliseconds)." )
 
+#define CLOCK_DRIFT_WINDOW_TEXT N_("Clock drift window")
+#define CLOCK_DRIFT_WINDOW_LONGTEXT N_( \
+    "This defines the number of master clock updates used to estimate the " \
+    "drift between the stream and the system clocks. A larger window gives " \
+    "a steadier estimation, but follows drift changes more slowly." )
+
 #define CLOCK_MASTER_TEXT N_("Clock master source")
 
 static const int pi_clock_master_values[] = {
@@ -614,6 +643,13 @@ static const char *const ppsz_clock_descriptions[] =
     "Language of the audio track you want to use " \
     "(comma separated, two or three letter country code, you may use 'none' to avoid a fallback to another language).")
 
+#define INPUT_AUDIOTRACK_MULTI_TEXT N_("Play multiple audio tracks")
+#define INPUT_AUDIOTRACK_MULTI_LONGTEXT N_( \
+    "Allow several audio tracks to be selected at the same time, such as " \
+    "the tracks of a multitrack recording. They are decoded concurrently " \
+    "and mixed together, each track being played through its own stream " \
+    "of the audio output, in sync with the others.")
+
 #define INPUT_SUBTRACK_LANG_TEXT N_("Subtitle language")
 #define INPUT_SUBTRACK_LANG_LONGTEXT N_( \
     "Language of the subtitle track you want to use " \
@@ -657,9 +693,29 @@ static const char *const ppsz_prefres[] = {
 
 #define INPUT_LOWDELAY_TEXT N_("Low delay mode")
 #define INPUT_LOWDELAY_LONGTEXT N_(\
-    "Try to minimize delay along decoding chain."\
+    "Try to minimize delay along decoding chain: no picture reordering " \
+    "delay, no input clock buffering, as few pictures as possible queued " \
+    "for display, and pictures displayed as soon as they are decoded. " \
     "Might break with non compliant streams.")
 
+#define DECODER_RING_TEXT N_("Lock-free decoder input queue")
+#define DECODER_RING_LONGTEXT N_(\
+    "Feed decoders through a lock-free single-producer single-consumer " \
+    "queue instead of a locked queue. This reduces contention and " \
+    "wake-up latency with many elementary streams.")
+
+#define DECODER_SPIN_TEXT N_("Decoder input spin count")
+#define DECODER_SPIN_LONGTEXT N_(\
+    "Maximum number of polling iterations a decoder thread busy-waits for " \
+    "input before sleeping, when the lock-free queue is used. The actual " \
+    "count adapts to how often spinning succeeds. 0 disables spinning.")
+
+#define DECODER_INSTANCES_TEXT N_("Decoder instances")
+#define DECODER_INSTANCES_LONGTEXT N_(\
+    "Number of decoder module instances decoding intra-only video " \
+    "(MJPEG, PNG, ProRes, DNxHD...) in parallel, each on its own thread. " \
+    "1 disables this.")
+
 #define INPUT_REPEAT_TEXT N_("Input repetitions")
 #define INPUT_REPEAT_LONGTEXT N_( \
     "Number of time the same input will be repeated")
@@ -719,6 +775,11 @@ static const char *const ppsz_prefres[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_SIZE_TEXT N_("Timeshift maximum size")
+#define INPUT_TIMESHIFT_SIZE_LONGTEXT N_( \
+    "This is the maximum size in bytes of the timeshifted streams " \
+    "(0 for unlimited). Once reached, the oldest data is dropped." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -1107,6 +1168,11 @@ static const char *const ppsz_prefres[] = {
     "Scan plugin directories for new plugins at startup. " \
     "This increases the startup time of VLC.")
 
+#define TRACER_TEXT N_("Tracer module")
+#define TRACER_LONGTEXT N_( \
+    "Module writing timeline traces of the processing pipeline " \
+    "(disabled by default).")
+
 #define KEYSTORE_TEXT N_("Preferred keystore list")
 #define KEYSTORE_LONGTEXT N_( \
     "List of keystores that VLC will use in priority." )
@@ -1147,6 +1213,26 @@ static const char *const ppsz_prefres[] = {
     "all the processor time and render the whole system unresponsive which " \
     "might require a reboot of your machine.")
 
+#define FILTER_THREADS_TEXT N_("Filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads processing slices of pictures for the video " \
+    "filters and converters supporting it (0 = one per CPU, 1 = disabled).")
+
+#define EXECUTOR_THREADS_TEXT N_("Background threads")
+#define EXECUTOR_THREADS_LONGTEXT N_( \
+    "Maximum number of threads shared by the background jobs, such as " \
+    "preparsing, art fetching and thumbnailing (0 = automatic).")
+
+#define CPU_BUDGET_TEXT N_("Decoder CPU budget")
+#define CPU_BUDGET_LONGTEXT N_( \
+    "Total number of threads shared by the decoders running at the same " \
+    "time, each one getting an even share (0 = one per CPU).")
+
+#define PICTURE_ARENA_TEXT N_("Picture arena size (MiB)")
+#define PICTURE_ARENA_LONGTEXT N_( \
+    "Large picture buffers are backed by huge pages, and up to this " \
+    "amount of released buffers is kept for reuse (0 = disabled).")
+
 #define CLOCK_SOURCE_TEXT N_("Clock source")
 #ifdef _WIN32
 static const char *const clock_sources[] = {
@@ -1190,6 +1276,13 @@ static const char *const clock_sources_text[] = {
     "Automatically preparse items added to the playlist " \
     "(to retrieve some metadata)." )
 
+#define PLAYLIST_UPDATE_TEXT N_( "Playlist update interval" )
+#define PLAYLIST_UPDATE_LONGTEXT N_( \
+    "Updates of playlist items (such as the metadata retrieved by the " \
+    "preparser) are gathered and reported to the interfaces at most once " \
+    "per interval, in milliseconds, by ranges of items. " \
+    "0 reports every update immediately." )
+
 #define PREPARSE_TIMEOUT_TEXT N_( "Preparsing timeout" )
 #define PREPARSE_TIMEOUT_LONGTEXT N_( \
     "Maximum time allowed to preparse an item, in milliseconds" )
@@ -1202,6 +1295,10 @@ static const char *const clock_sources_text[] = {
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
 
+#define THUMBNAILER_THREADS_TEXT N_( "Thumbnailer threads" )
+#define THUMBNAILER_THREADS_LONGTEXT N_( \
+    "Maximum number of threads used to generate thumbnails" )
+
 #define METADATA_NETWORK_TEXT N_( "Allow metadata network access" )
 
 static const char *const psz_recursive_list[] = {
@@ -1647,6 +1744,10 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", 1, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT, true )
+    add_bool( "video-pacing", false, VIDEO_PACING_TEXT,
+              VIDEO_PACING_LONGTEXT, true )
+    add_float( "display-refresh-rate", 0., DISPLAY_REFRESH_RATE_TEXT,
+               DISPLAY_REFRESH_RATE_LONGTEXT, true )
     /* Used in vout_synchro */
     add_bool( "skip-frames", 1, SKIP_FRAMES_TEXT,
               SKIP_FRAMES_LONGTEXT, true )
@@ -1819,6 +1920,10 @@ vlc_module_begin ()
                  INPUT_AUDIOTRACK_LANG_TEXT, INPUT_AUDIOTRACK_LANG_LONGTEXT,
                   false )
         change_safe ()
+    add_bool( "audio-multitrack", false,
+              INPUT_AUDIOTRACK_MULTI_TEXT, INPUT_AUDIOTRACK_MULTI_LONGTEXT,
+              true )
+        change_safe ()
     add_string( "sub-language", "",
                  INPUT_SUBTRACK_LANG_TEXT, INPUT_SUBTRACK_LANG_LONGTEXT,
                   false )
@@ -1847,6 +1952,14 @@ vlc_module_begin ()
     add_bool( "low-delay", 0, INPUT_LOWDELAY_TEXT,
               INPUT_LOWDELAY_LONGTEXT, true )
         change_safe ()
+    add_bool( "decoder-ring", false, DECODER_RING_TEXT,
+              DECODER_RING_LONGTEXT, true )
+    add_integer( "decoder-spin", 0, DECODER_SPIN_TEXT,
+                 DECODER_SPIN_LONGTEXT, true )
+        change_integer_range( 0, 1000000 )
+    add_integer( "decoder-instances", 1, DECODER_INSTANCES_TEXT,
+                 DECODER_INSTANCES_LONGTEXT, true )
+        change_integer_range( 1, 8 )
 
     set_section( N_( "Playback control" ) , NULL)
     add_integer( "input-repeat", 0,
@@ -2000,6 +2113,10 @@ vlc_module_begin ()
     add_obsolete_integer( "smb-caching" ) /* 2.0.0 */
     add_obsolete_integer( "tcp-caching" ) /* 2.0.0 */
     add_obsolete_integer( "udp-caching" ) /* 2.0.0 */
+    add_integer( "zap-caching", 0,
+                 ZAP_CACHING_TEXT, ZAP_CACHING_LONGTEXT, true )
+        change_integer_range( 0, 60000 )
+        change_safe()
 
     add_integer( "cr-average", 40, CR_AVERAGE_TEXT,
                  CR_AVERAGE_LONGTEXT, true )
@@ -2009,6 +2126,10 @@ vlc_module_begin ()
     add_integer( "clock-jitter", 5000, CLOCK_JITTER_TEXT,
               CLOCK_JITTER_LONGTEXT, true )
         change_safe()
+    add_integer_with_range( "clock-drift-window", 64, 2, 256,
+                            CLOCK_DRIFT_WINDOW_TEXT,
+                            CLOCK_DRIFT_WINDOW_LONGTEXT, true )
+        change_safe()
     add_integer( "clock-master", VLC_CLOCK_MASTER_DEFAULT,
                  CLOCK_MASTER_TEXT, NULL, true )
         change_integer_list( pi_clock_master_values, ppsz_clock_master_descriptions )
@@ -2025,6 +2146,8 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT, true )
+    add_integer( "input-timeshift-size", 0, INPUT_TIMESHIFT_SIZE_TEXT,
+                 INPUT_TIMESHIFT_SIZE_LONGTEXT, true )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT, false );
 
@@ -2124,6 +2247,7 @@ vlc_module_begin ()
     add_category_hint(N_("Miscellaneous"), MISC_CAT_LONGTEXT)
     add_module("vod-server", "vod server", NULL,
                VOD_SERVER_TEXT, VOD_SERVER_LONGTEXT)
+    add_module("tracer", "tracer", NULL, TRACER_TEXT, TRACER_LONGTEXT)
 
     set_section( N_("Plugins" ), NULL )
 #ifdef HAVE_DYNAMIC_PLUGINS
@@ -2141,6 +2265,16 @@ vlc_module_begin ()
 
     set_section( N_("Performance options"), NULL )
 
+    add_integer_with_range( "filter-threads", 0, 0, 64, FILTER_THREADS_TEXT,
+                            FILTER_THREADS_LONGTEXT, true )
+    add_integer_with_range( "executor-threads", 0, 0, 256,
+                            EXECUTOR_THREADS_TEXT, EXECUTOR_THREADS_LONGTEXT,
+                            true )
+    add_integer_with_range( "cpu-budget", 0, 0, 1024, CPU_BUDGET_TEXT,
+                            CPU_BUDGET_LONGTEXT, true )
+    add_integer_with_range( "picture-arena", 0, 0, 4096, PICTURE_ARENA_TEXT,
+                            PICTURE_ARENA_LONGTEXT, true )
+
 #if defined (LIBVLC_USE_PTHREAD)
     add_bool( "rt-priority", false, RT_PRIORITY_TEXT,
               RT_PRIORITY_LONGTEXT, true )
@@ -2207,6 +2341,10 @@ vlc_module_begin ()
     add_bool( "auto-preparse", true, PREPARSE_TEXT,
               PREPARSE_LONGTEXT, false )
 
+    add_integer_with_range( "playlist-update-interval", 100, 0, 1000,
+                            PLAYLIST_UPDATE_TEXT, PLAYLIST_UPDATE_LONGTEXT,
+                            true )
+
     add_integer( "preparse-timeout", 5000, PREPARSE_TIMEOUT_TEXT,
                  PREPARSE_TIMEOUT_LONGTEXT, false )
 
@@ -2216,6 +2354,10 @@ vlc_module_begin ()
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT, false )
 
+    add_integer_with_range( "thumbnailer-threads", 2, 1, 16,
+                            THUMBNAILER_THREADS_TEXT,
+                            THUMBNAILER_THREADS_LONGTEXT, true )
+
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
                  METADATA_NETWORK_TEXT, false )
@@ -2245,6 +2387,7 @@ vlc_module_begin ()
         change_short('v')
         change_volatile ()
     add_obsolete_string( "verbose-objects" ) /* since 2.1.0 */
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT, true )
 #if !defined(_WIN32) && !defined(__OS2__)
     add_bool( "daemon", 0, DAEMON_TEXT, DAEMON_LONGTEXT, true )
         change_short('d')
@@ -63,8 +63,12 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_thumbnailer.h>
+#include <vlc_executor.h>
+#include <vlc_keepalive.h>
 
 #include "libvlc.h"
+#include "misc/slices.h"
+#include "misc/picture.h"
 
 #include <vlc_vlm.h>
 
@@ -95,6 +99,13 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->slices = NULL;
+    priv->executor = NULL;
+    priv->keepalive = NULL;
+    priv->tracer = NULL;
+    priv->picture_arena = 0;
+    priv->cpu_budget = 1;
+    priv->cpu_users = 0;
 
     vlc_ExitInit( &priv->exit );
 
@@ -165,6 +176,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         goto error;
 
     vlc_LogInit(p_libvlc);
+    vlc_TracerInit(p_libvlc);
 
     /*
      * Support for gettext
@@ -220,6 +232,15 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
+    priv->executor = vlc_executor_New( var_InheritInteger( p_libvlc,
+                                                           "executor-threads" ) );
+    if( priv->executor == NULL )
+        msg_Warn( p_libvlc, "cannot create the background jobs executor" );
+
+    priv->keepalive = vlc_keepalive_New( 64 );
+    if( priv->keepalive == NULL )
+        msg_Warn( p_libvlc, "cannot create the idle connections store" );
+
     if( var_InheritBool( p_libvlc, "media-library") )
     {
         priv->p_media_library = libvlc_MlCreate( p_libvlc );
@@ -227,6 +248,17 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
             msg_Warn( p_libvlc, "Media library initialization failed" );
     }
 
+    priv->slices = vlc_slices_New( var_InheritInteger( p_libvlc,
+                                                       "filter-threads" ) );
+
+    priv->cpu_budget = var_InheritInteger( p_libvlc, "cpu-budget" );
+    if( priv->cpu_budget == 0 )
+        priv->cpu_budget = vlc_GetCPUCount();
+
+    priv->picture_arena = var_InheritInteger( p_libvlc, "picture-arena" );
+    if( priv->picture_arena > 0 )
+        picture_ArenaEnable( (size_t)priv->picture_arena << 20 );
+
     priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
     if ( priv->p_thumbnailer == NULL )
         msg_Warn( p_libvlc, "Failed to instantiate VLC thumbnailer" );
@@ -435,6 +467,25 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    vlc_slices_Delete( priv->slices );
+    if( priv->executor != NULL )
+        vlc_executor_Delete( priv->executor );
+    /* After all users, but before their plugins are unloaded */
+    if( priv->keepalive != NULL )
+        vlc_keepalive_Delete( priv->keepalive );
+    vlc_TracerDestroy( p_libvlc );
+
+    if( priv->picture_arena > 0 )
+    {
+        struct picture_arena_stats st;
+
+        picture_ArenaGetStats( &st );
+        msg_Dbg( p_libvlc, "picture arena: %"PRIu64" allocations, %"PRIu64
+                 " reused, %"PRIu64" on reserved huge pages, %zu MiB peak",
+                 st.allocated, st.reused, st.hugetlb, st.peak_bytes >> 20 );
+        picture_ArenaDisable();
+    }
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
@@ -544,6 +595,39 @@ int libvlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
     return vlc_MetadataRequest(libvlc, item, i_options, cbs, cbs_userdata, timeout, id);
 }
 
+/**
+ * Requests extraction of the meta data for several input items at once.
+ *
+ * The callback data of each item is also its cancellation id for
+ * libvlc_MetadataCancel().
+ */
+int libvlc_MetadataRequestBatch(libvlc_int_t *libvlc, input_item_t *const *items,
+                                size_t count,
+                                input_item_meta_request_option_t i_options,
+                                const input_preparser_callbacks_t *cbs,
+                                void *const *cbs_userdata, int timeout)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    assert(i_options & META_REQUEST_OPTION_SCOPE_ANY);
+
+    if (unlikely(priv->parser == NULL))
+        return VLC_ENOMEM;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        input_item_t *item = items[i];
+
+        vlc_mutex_lock( &item->lock );
+        if( item->i_preparse_depth == 0 )
+            item->i_preparse_depth = 1;
+        vlc_mutex_unlock( &item->lock );
+    }
+
+    input_preparser_PushBatch(priv->parser, items, count, i_options, cbs,
+                              cbs_userdata, timeout);
+    return VLC_SUCCESS;
+}
+
 /**
  * Requests retrieving/downloading art for an input item.
  * The retrieval is performed asynchronously.
@@ -77,6 +77,12 @@ typedef struct vlc_logger vlc_logger_t;
 int vlc_LogPreinit(libvlc_int_t *) VLC_USED;
 void vlc_LogInit(libvlc_int_t *);
 
+/*
+ * Tracing
+ */
+void vlc_TracerInit(libvlc_int_t *);
+void vlc_TracerDestroy(libvlc_int_t *);
+
 /*
  * LibVLC exit event handling
  */
@@ -210,6 +216,13 @@ typedef struct libvlc_priv_t
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
+    struct vlc_slices *slices; ///< Filter slices thread pool (or NULL)
+    struct vlc_executor *executor; ///< Background jobs thread pool (or NULL)
+    struct vlc_keepalive *keepalive; ///< Idle connections store (or NULL)
+    struct vlc_tracer *tracer; ///< Timeline tracer (or NULL)
+    int64_t picture_arena; ///< Picture arena cap in MiB (0 if disabled)
+    unsigned cpu_budget; ///< Threads shared by the decoders
+    unsigned cpu_users; ///< Current users of the CPU budget (protected by lock)
 
     /* Exit callback */
     vlc_exit_t       exit;
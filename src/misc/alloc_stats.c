@@ -0,0 +1,292 @@
+/*****************************************************************************
+ * alloc_stats.c: per call site accounting of blocks and pictures
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_DLADDR
+# include <dlfcn.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_alloc_stats.h>
+#include "alloc_stats.h"
+
+/*
+ * The sites are kept in a fixed-size open addressing table per kind of
+ * allocation. Entries are claimed with compare-and-swap and never freed, so
+ * that accounting is lock-free. Past the table capacity, call sites are
+ * merged into a catch-all entry.
+ */
+#define ALLOC_SITES 1024 /* must be a power of two */
+#define ALLOC_PROBES 16
+
+struct vlc_alloc_site
+{
+    atomic_uintptr_t caller;
+    atomic_uintmax_t allocations;
+    atomic_size_t live;
+    atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    enum vlc_alloc_kind kind;
+};
+
+struct vlc_alloc_table
+{
+    struct vlc_alloc_site sites[ALLOC_SITES];
+    struct vlc_alloc_site other;
+    struct vlc_alloc_site total;
+};
+
+static struct
+{
+    bool enabled;
+    struct vlc_alloc_table *tables;
+} alloc_stats;
+
+static vlc_once_t alloc_stats_once = VLC_STATIC_ONCE;
+
+static const char *const alloc_kind_names[VLC_ALLOC_KINDS] = {
+    "block", "picture",
+};
+
+static void vlc_alloc_site_Init(struct vlc_alloc_site *site,
+                                enum vlc_alloc_kind kind)
+{
+    atomic_init(&site->caller, 0);
+    atomic_init(&site->allocations, 0);
+    atomic_init(&site->live, 0);
+    atomic_init(&site->live_bytes, 0);
+    atomic_init(&site->peak_bytes, 0);
+    site->kind = kind;
+}
+
+static void vlc_alloc_stats_Init(void)
+{
+    const char *str = getenv("VLC_ALLOC_STATS");
+    if (str == NULL || atoi(str) <= 0)
+        return;
+
+    struct vlc_alloc_table *tables = malloc(VLC_ALLOC_KINDS * sizeof (*tables));
+    if (unlikely(tables == NULL))
+        return;
+
+    for (unsigned k = 0; k < VLC_ALLOC_KINDS; k++)
+    {
+        for (unsigned i = 0; i < ALLOC_SITES; i++)
+            vlc_alloc_site_Init(&tables[k].sites[i], k);
+        vlc_alloc_site_Init(&tables[k].other, k);
+        vlc_alloc_site_Init(&tables[k].total, k);
+    }
+    alloc_stats.tables = tables;
+    alloc_stats.enabled = true;
+}
+
+bool vlc_alloc_IsTracked(void)
+{
+    vlc_once(&alloc_stats_once, vlc_alloc_stats_Init);
+    return alloc_stats.enabled;
+}
+
+static struct vlc_alloc_site *vlc_alloc_Lookup(struct vlc_alloc_table *table,
+                                               const void *caller)
+{
+    const uintptr_t key = (uintptr_t)caller;
+    if (key == 0)
+        return &table->other;
+
+    size_t i = (size_t)((key >> 2) * UINT64_C(0x9E3779B97F4A7C15) >> 32);
+
+    for (unsigned n = 0; n < ALLOC_PROBES; n++, i++)
+    {
+        struct vlc_alloc_site *site = &table->sites[i & (ALLOC_SITES - 1)];
+        uintptr_t cur = atomic_load_explicit(&site->caller,
+                                             memory_order_relaxed);
+
+        if (cur == 0
+         && atomic_compare_exchange_strong_explicit(&site->caller, &cur, key,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed))
+            return site;
+        if (cur == key)
+            return site;
+    }
+    return &table->other;
+}
+
+static void vlc_alloc_site_Add(struct vlc_alloc_site *site, size_t size)
+{
+    atomic_fetch_add_explicit(&site->allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->live, 1, memory_order_relaxed);
+
+    size_t live = atomic_fetch_add_explicit(&site->live_bytes, size,
+                                            memory_order_relaxed) + size;
+    size_t peak = atomic_load_explicit(&site->peak_bytes,
+                                       memory_order_relaxed);
+
+    while (live > peak
+        && !atomic_compare_exchange_weak_explicit(&site->peak_bytes, &peak,
+                                                  live, memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
+static void vlc_alloc_site_Remove(struct vlc_alloc_site *site, size_t size)
+{
+    atomic_fetch_sub_explicit(&site->live, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&site->live_bytes, size, memory_order_relaxed);
+}
+
+struct vlc_alloc_site *vlc_alloc_Track(enum vlc_alloc_kind kind,
+                                       const void *caller, size_t size)
+{
+    if (!vlc_alloc_IsTracked())
+        return NULL;
+
+    struct vlc_alloc_table *table = &alloc_stats.tables[kind];
+    struct vlc_alloc_site *site = vlc_alloc_Lookup(table, caller);
+
+    vlc_alloc_site_Add(site, size);
+    vlc_alloc_site_Add(&table->total, size);
+    return site;
+}
+
+void vlc_alloc_Untrack(struct vlc_alloc_site *site, size_t size)
+{
+    if (site == NULL)
+        return;
+
+    vlc_alloc_site_Remove(site, size);
+    vlc_alloc_site_Remove(&alloc_stats.tables[site->kind].total, size);
+}
+
+struct vlc_alloc_snapshot
+{
+    const void *caller;
+    uintmax_t allocations;
+    size_t live;
+    size_t live_bytes;
+    size_t peak_bytes;
+};
+
+static void vlc_alloc_site_Read(const struct vlc_alloc_site *site,
+                                struct vlc_alloc_snapshot *snap)
+{
+    snap->caller = (const void *)atomic_load_explicit(&site->caller,
+                                                      memory_order_relaxed);
+    snap->allocations = atomic_load_explicit(&site->allocations,
+                                             memory_order_relaxed);
+    snap->live = atomic_load_explicit(&site->live, memory_order_relaxed);
+    snap->live_bytes = atomic_load_explicit(&site->live_bytes,
+                                            memory_order_relaxed);
+    snap->peak_bytes = atomic_load_explicit(&site->peak_bytes,
+                                            memory_order_relaxed);
+}
+
+static int vlc_alloc_snapshot_Cmp(const void *a, const void *b)
+{
+    const struct vlc_alloc_snapshot *sa = a, *sb = b;
+
+    if (sa->live_bytes != sb->live_bytes)
+        return (sa->live_bytes < sb->live_bytes) ? 1 : -1;
+    if (sa->peak_bytes != sb->peak_bytes)
+        return (sa->peak_bytes < sb->peak_bytes) ? 1 : -1;
+    return 0;
+}
+
+static void vlc_alloc_PrintCaller(FILE *stream, const void *caller)
+{
+    if (caller == NULL)
+    {
+        fputs("(other)", stream);
+        return;
+    }
+#ifdef HAVE_DLADDR
+    Dl_info info;
+
+    if (dladdr(caller, &info) && info.dli_fname != NULL)
+    {
+        const char *name = strrchr(info.dli_fname, '/');
+        name = (name != NULL) ? name + 1 : info.dli_fname;
+
+        if (info.dli_sname != NULL)
+            fprintf(stream, "%s(%s+0x%tx)", name, info.dli_sname,
+                    (const char *)caller - (const char *)info.dli_saddr);
+        else
+            fprintf(stream, "%s+0x%tx", name,
+                    (const char *)caller - (const char *)info.dli_fbase);
+        return;
+    }
+#endif
+    fprintf(stream, "%p", caller);
+}
+
+void vlc_alloc_stats_Print(FILE *stream)
+{
+    if (!vlc_alloc_IsTracked())
+        return;
+
+    struct vlc_alloc_snapshot *snaps = malloc((ALLOC_SITES + 1)
+                                              * sizeof (*snaps));
+    if (unlikely(snaps == NULL))
+        return;
+
+    for (unsigned k = 0; k < VLC_ALLOC_KINDS; k++)
+    {
+        const struct vlc_alloc_table *table = &alloc_stats.tables[k];
+        struct vlc_alloc_snapshot total;
+        size_t count = 0;
+
+        for (size_t i = 0; i < ALLOC_SITES; i++)
+        {
+            vlc_alloc_site_Read(&table->sites[i], &snaps[count]);
+            if (snaps[count].caller != NULL)
+                count++;
+        }
+        vlc_alloc_site_Read(&table->other, &snaps[count]);
+        snaps[count].caller = NULL;
+        if (snaps[count].allocations > 0)
+            count++;
+
+        qsort(snaps, count, sizeof (*snaps), vlc_alloc_snapshot_Cmp);
+
+        vlc_alloc_site_Read(&table->total, &total);
+        fprintf(stream, "%s: %zu live (%zu bytes), peak %zu bytes, "
+                "%ju allocations\n", alloc_kind_names[k], total.live,
+                total.live_bytes, total.peak_bytes, total.allocations);
+        fprintf(stream, "%12s %12s %12s %12s  %s\n", "live", "live bytes",
+                "peak bytes", "allocations", "call site");
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const struct vlc_alloc_snapshot *s = &snaps[i];
+
+            fprintf(stream, "%12zu %12zu %12zu %12ju  ", s->live,
+                    s->live_bytes, s->peak_bytes, s->allocations);
+            vlc_alloc_PrintCaller(stream, s->caller);
+            putc('\n', stream);
+        }
+    }
+    fflush(stream);
+    free(snaps);
+}
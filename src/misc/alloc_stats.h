@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * alloc_stats.h: per call site accounting of blocks and pictures
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_ALLOC_STATS_H
+#define LIBVLC_ALLOC_STATS_H 1
+
+enum vlc_alloc_kind
+{
+    VLC_ALLOC_BLOCK,
+    VLC_ALLOC_PICTURE,
+};
+#define VLC_ALLOC_KINDS 2
+
+struct vlc_alloc_site;
+
+/** Address the calling function will return to, i.e. the call site. */
+#ifdef __GNUC__
+# define vlc_alloc_Caller() __builtin_return_address(0)
+#else
+# define vlc_alloc_Caller() NULL
+#endif
+
+/**
+ * Tells whether the accounting is enabled (VLC_ALLOC_STATS environment
+ * variable set to a positive number). This does not change at run-time.
+ */
+bool vlc_alloc_IsTracked(void);
+
+/**
+ * Accounts for an allocation.
+ *
+ * \param caller call site, as returned by vlc_alloc_Caller()
+ * \return the site to pass to vlc_alloc_Untrack(), or NULL if the accounting
+ * is disabled
+ */
+struct vlc_alloc_site *vlc_alloc_Track(enum vlc_alloc_kind kind,
+                                       const void *caller, size_t size);
+
+/**
+ * Accounts for the release of an allocation.
+ *
+ * \param site site returned by vlc_alloc_Track() (can be NULL)
+ * \param size size passed to vlc_alloc_Track()
+ */
+void vlc_alloc_Untrack(struct vlc_alloc_site *site, size_t size);
+
+#endif
@@ -23,6 +23,7 @@
 #include <assert.h>
 #include <vlc_common.h>
 #include <vlc_atomic.h>
+#include <vlc_executor.h>
 #include <vlc_list.h>
 #include <vlc_threads.h>
 
@@ -45,6 +46,8 @@ struct background_thread {
     bool cancel; /**< true if a cancel is requested */
     struct task *task; /**< current task */
     struct vlc_list node;
+    struct vlc_runnable runnable;
+    bool pooled; /**< true if run by the executor */
 };
 
 struct background_worker {
@@ -212,7 +215,8 @@ static void* Thread( void* data )
     for (;;)
     {
         vlc_mutex_lock(&worker->lock);
-        struct task *task = QueueTake(worker, 5000);
+        /* Executor threads are kept by the executor, do not linger */
+        struct task *task = QueueTake(worker, thread->pooled ? 0 : 5000);
         if (!task)
         {
             vlc_mutex_unlock(&worker->lock);
@@ -266,6 +270,11 @@ static void* Thread( void* data )
     return NULL;
 }
 
+static void RunThread(void *data)
+{
+    Thread(data);
+}
+
 static bool SpawnThread(struct background_worker *worker)
 {
     vlc_mutex_assert(&worker->lock);
@@ -274,7 +283,15 @@ static bool SpawnThread(struct background_worker *worker)
     if (!thread)
         return false;
 
-    if (vlc_clone_detach(NULL, Thread, thread, VLC_THREAD_PRIORITY_LOW))
+    thread->runnable.run = RunThread;
+    thread->runnable.userdata = thread;
+    /* The thread cannot check this before the worker lock is released */
+    thread->pooled = worker->conf.executor != NULL
+        && vlc_executor_Submit(worker->conf.executor, &thread->runnable,
+                               VLC_EXECUTOR_PRIORITY_NORMAL) == VLC_SUCCESS;
+
+    if (!thread->pooled
+     && vlc_clone_detach(NULL, Thread, thread, VLC_THREAD_PRIORITY_LOW))
     {
         free(thread);
         return false;
@@ -308,6 +325,40 @@ int background_worker_Push( struct background_worker* worker, void* entity,
     return VLC_SUCCESS;
 }
 
+int background_worker_PushBatch( struct background_worker* worker,
+    void *const *entities, void *const *ids, size_t count, int timeout )
+{
+    struct task **tasks = vlc_alloc(count, sizeof (*tasks));
+    if (unlikely(!tasks))
+        return VLC_ENOMEM;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        tasks[i] = task_Create(worker, ids ? ids[i] : NULL, entities[i],
+                               timeout);
+        if (unlikely(!tasks[i]))
+        {
+            while (i > 0)
+                task_Destroy(worker, tasks[--i]);
+            free(tasks);
+            return VLC_ENOMEM;
+        }
+    }
+
+    vlc_mutex_lock(&worker->lock);
+    for (size_t i = 0; i < count; i++)
+        QueuePush(worker, tasks[i]);
+    worker->uncompleted += count;
+    while (worker->uncompleted > worker->nthreads
+        && worker->nthreads < worker->conf.max_threads)
+        if (!SpawnThread(worker))
+            break;
+    vlc_mutex_unlock(&worker->lock);
+
+    free(tasks);
+    return VLC_SUCCESS;
+}
+
 static void BackgroundWorkerCancelLocked(struct background_worker *worker,
                                          void *id)
 {
@@ -356,6 +407,19 @@ void background_worker_Delete( struct background_worker* worker )
     /* closing is now true, this will wake up any QueueTake() */
     vlc_cond_broadcast(&worker->queue_wait);
 
+    if (worker->conf.executor != NULL)
+    {   /* Threads waiting for an executor slot will never be needed */
+        struct background_thread *thread;
+        vlc_list_foreach(thread, &worker->threads, node)
+            if (thread->pooled
+             && vlc_executor_Cancel(worker->conf.executor, &thread->runnable))
+            {
+                vlc_list_remove(&thread->node);
+                worker->nthreads--;
+                background_thread_Destroy(thread);
+            }
+    }
+
     while (worker->nthreads)
         vlc_cond_wait(&worker->nothreads_wait, &worker->lock);
 
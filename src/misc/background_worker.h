@@ -34,6 +34,11 @@ struct background_worker_config {
      */
     int max_threads;
 
+    /**
+     * Executor providing the threads, or NULL to start dedicated threads.
+     */
+    struct vlc_executor *executor;
+
     /**
      * Release an entity
      *
@@ -171,6 +176,24 @@ void background_worker_RequestProbe( struct background_worker* worker );
 int background_worker_Push( struct background_worker* worker, void* entity,
     void* id, int timeout );
 
+/**
+ * Push several entities into the background-worker
+ *
+ * This is equivalent to calling \ref background_worker_Push for each entity,
+ * but the queue is locked only once and the threads are started for the whole
+ * batch. Either all the entities are queued, or none.
+ *
+ * \param worker the background-worker
+ * \param entities the entities which are to be queued
+ * \param ids the ids of the entities (or `NULL` for no ids)
+ * \param count the number of entities
+ * \param timeout the timeout of each entity, as in \ref background_worker_Push
+ * \return VLC_SUCCESS if the entities were successfully queued, an error-code
+ *         on failure.
+ **/
+int background_worker_PushBatch( struct background_worker* worker,
+    void *const *entities, void *const *ids, size_t count, int timeout );
+
 /**
  * Remove entities from the background-worker
  *
@@ -34,6 +34,8 @@
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include <vlc_atomic.h>
+#include "alloc_stats.h"
 
 #ifndef NDEBUG
 static void block_Check (block_t *block)
@@ -87,6 +89,39 @@ static const struct vlc_block_callbacks block_generic_cbs =
     block_generic_Release,
 };
 
+/* Blocks accounted for by call site (see alloc_stats.h) */
+typedef struct
+{
+    block_t self;
+    struct vlc_alloc_site *site;
+} block_tracked_t;
+
+static void block_tracked_Release(block_t *block)
+{
+    block_tracked_t *tb = container_of(block, block_tracked_t, self);
+
+    assert(block->p_start == (unsigned char *)(tb + 1));
+    vlc_alloc_Untrack(tb->site, sizeof (*tb) + block->i_size);
+    free(tb);
+}
+
+static const struct vlc_block_callbacks block_tracked_cbs =
+{
+    block_tracked_Release,
+};
+
+static block_t *block_tracked_Alloc(size_t alloc, const void *caller)
+{
+    block_tracked_t *tb = malloc(alloc - sizeof (block_t) + sizeof (*tb));
+    if (unlikely(tb == NULL))
+        return NULL;
+
+    tb->site = vlc_alloc_Track(VLC_ALLOC_BLOCK, caller,
+                               alloc - sizeof (block_t) + sizeof (*tb));
+    return block_Init(&tb->self, &block_tracked_cbs, tb + 1,
+                      alloc - sizeof (block_t));
+}
+
 static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 {
     out->p_next    = in->p_next;
@@ -105,6 +140,289 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*
+ * Block recycling pool
+ *
+ * Blocks allocated with block_Alloc() are rounded up to a power-of-two size
+ * class and recycled instead of being returned to the heap. Each thread owns
+ * a small magazine of free blocks per class, so that allocating and
+ * releasing is lock-free and touches no shared cache line in steady state.
+ *
+ * When a magazine overflows (typically in a consumer thread releasing blocks
+ * allocated by a producer thread), half of it is pushed to a global depot.
+ * When a magazine runs dry, it grabs the whole depot list at once. Since the
+ * depot is only ever popped as a whole, the stack is ABA-safe with plain
+ * compare-and-swap.
+ */
+#if defined (__SANITIZE_ADDRESS__)
+# define BLOCK_POOL 0 /* keep use-after-free detection working */
+#elif defined (__has_feature)
+# if __has_feature(address_sanitizer)
+#  define BLOCK_POOL 0
+# endif
+#endif
+#ifndef BLOCK_POOL
+# define BLOCK_POOL 1
+#endif
+
+/** Smallest size class (total allocation size, including block_t) */
+#define BLOCK_POOL_MIN_SHIFT 9
+/** Number of size classes (512 bytes to 64 KiB) */
+#define BLOCK_POOL_CLASSES   8
+/** Free blocks per class cached in each thread */
+#define BLOCK_POOL_MAGAZINE  16
+/** Soft limit of free bytes per class kept in the global depot */
+#define BLOCK_POOL_DEPOT_MAX (4 << 20)
+
+struct block_pool_depot
+{
+    _Atomic(block_t *) head;
+    atomic_uint count;
+};
+
+struct block_pool_magazine
+{
+    unsigned count[BLOCK_POOL_CLASSES];
+    block_t *slots[BLOCK_POOL_CLASSES][BLOCK_POOL_MAGAZINE];
+    struct block_pool_stats stats;
+};
+
+static struct
+{
+    vlc_threadvar_t key;
+    bool enabled;
+    struct block_pool_depot depots[BLOCK_POOL_CLASSES];
+    atomic_ullong hits;
+    atomic_ullong misses;
+    atomic_ullong recycled;
+    atomic_ullong freed;
+} block_pool;
+
+static vlc_once_t block_pool_once = VLC_STATIC_ONCE;
+
+static size_t block_pool_ClassSize(unsigned c)
+{
+    return ((size_t)1) << (BLOCK_POOL_MIN_SHIFT + c);
+}
+
+/** Finds the smallest class fitting an allocation, or BLOCK_POOL_CLASSES. */
+static unsigned block_pool_ClassOf(size_t alloc)
+{
+    unsigned c = 0;
+
+    while (c < BLOCK_POOL_CLASSES && block_pool_ClassSize(c) < alloc)
+        c++;
+    return c;
+}
+
+static void block_pool_Push(unsigned c, block_t *first, block_t *last,
+                            unsigned n)
+{
+    struct block_pool_depot *depot = &block_pool.depots[c];
+    block_t *head = atomic_load_explicit(&depot->head, memory_order_relaxed);
+
+    do
+        last->p_next = head;
+    while (!atomic_compare_exchange_weak_explicit(&depot->head, &head, first,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+    atomic_fetch_add_explicit(&depot->count, n, memory_order_relaxed);
+}
+
+/** Gives free blocks back, to the depot if it has room, else to the heap. */
+static void block_pool_Flush(struct block_pool_magazine *mag, unsigned c,
+                             unsigned n)
+{
+    struct block_pool_depot *depot = &block_pool.depots[c];
+    block_t **slots = mag->slots[c];
+
+    assert(n <= mag->count[c]);
+    mag->count[c] -= n;
+    slots += mag->count[c];
+
+    if (atomic_load_explicit(&depot->count, memory_order_relaxed)
+                         >= (BLOCK_POOL_DEPOT_MAX >> (BLOCK_POOL_MIN_SHIFT + c)))
+    {
+        for (unsigned i = 0; i < n; i++)
+            free(slots[i]);
+        mag->stats.freed += n;
+        return;
+    }
+
+    for (unsigned i = 1; i < n; i++)
+        slots[i - 1]->p_next = slots[i];
+    block_pool_Push(c, slots[0], slots[n - 1], n);
+}
+
+/** Moves the whole depot of a class into a magazine. */
+static void block_pool_Refill(struct block_pool_magazine *mag, unsigned c)
+{
+    struct block_pool_depot *depot = &block_pool.depots[c];
+    block_t *list;
+    unsigned n = 0;
+
+    if (atomic_load_explicit(&depot->head, memory_order_relaxed) == NULL)
+        return;
+
+    list = atomic_exchange_explicit(&depot->head, NULL, memory_order_acquire);
+    while (list != NULL && mag->count[c] < BLOCK_POOL_MAGAZINE)
+    {
+        mag->slots[c][mag->count[c]++] = list;
+        list = list->p_next;
+        n++;
+    }
+    atomic_fetch_sub_explicit(&depot->count, n, memory_order_relaxed);
+
+    if (list != NULL)
+    {   /* Put back what did not fit */
+        block_t *last = list;
+
+        n = 1;
+        while (last->p_next != NULL)
+        {
+            last = last->p_next;
+            n++;
+        }
+        atomic_fetch_sub_explicit(&depot->count, n, memory_order_relaxed);
+        block_pool_Push(c, list, last, n);
+    }
+}
+
+static void block_pool_CommitStats(struct block_pool_magazine *mag)
+{
+    atomic_fetch_add_explicit(&block_pool.hits, mag->stats.hits,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&block_pool.misses, mag->stats.misses,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&block_pool.recycled, mag->stats.recycled,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&block_pool.freed, mag->stats.freed,
+                              memory_order_relaxed);
+    memset(&mag->stats, 0, sizeof (mag->stats));
+}
+
+/** Thread exit callback: hands the cached blocks over to other threads. */
+static void block_pool_Destroy(void *data)
+{
+    struct block_pool_magazine *mag = data;
+
+    for (unsigned c = 0; c < BLOCK_POOL_CLASSES; c++)
+        if (mag->count[c] > 0)
+            block_pool_Flush(mag, c, mag->count[c]);
+    block_pool_CommitStats(mag);
+    free(mag);
+}
+
+static void block_pool_Init(void)
+{
+    for (unsigned c = 0; c < BLOCK_POOL_CLASSES; c++)
+    {
+        atomic_init(&block_pool.depots[c].head, NULL);
+        atomic_init(&block_pool.depots[c].count, 0);
+    }
+    atomic_init(&block_pool.hits, 0);
+    atomic_init(&block_pool.misses, 0);
+    atomic_init(&block_pool.recycled, 0);
+    atomic_init(&block_pool.freed, 0);
+    block_pool.enabled = BLOCK_POOL
+                      && vlc_threadvar_create(&block_pool.key,
+                                              block_pool_Destroy) == 0;
+}
+
+static struct block_pool_magazine *block_pool_GetMagazine(void)
+{
+    vlc_once(&block_pool_once, block_pool_Init);
+    if (!block_pool.enabled)
+        return NULL;
+
+    struct block_pool_magazine *mag = vlc_threadvar_get(block_pool.key);
+    if (likely(mag != NULL))
+        return mag;
+
+    mag = calloc(1, sizeof (*mag));
+    if (unlikely(mag == NULL))
+        return NULL;
+    if (vlc_threadvar_set(block_pool.key, mag))
+    {
+        free(mag);
+        return NULL;
+    }
+    return mag;
+}
+
+static void block_pool_Release(block_t *block)
+{
+    const size_t alloc = sizeof (*block) + block->i_size;
+    unsigned c = block_pool_ClassOf(alloc);
+
+    assert(block->p_start == (unsigned char *)(block + 1));
+    assert(c < BLOCK_POOL_CLASSES && block_pool_ClassSize(c) == alloc);
+
+    struct block_pool_magazine *mag = block_pool_GetMagazine();
+    if (unlikely(mag == NULL))
+    {
+        free(block);
+        return;
+    }
+
+    if (mag->count[c] >= BLOCK_POOL_MAGAZINE)
+    {
+        block_pool_Flush(mag, c, BLOCK_POOL_MAGAZINE / 2);
+        block_pool_CommitStats(mag);
+    }
+    mag->slots[c][mag->count[c]++] = block;
+    mag->stats.recycled++;
+}
+
+static const struct vlc_block_callbacks block_pool_cbs =
+{
+    block_pool_Release,
+};
+
+/** Allocates a block from the pool, or returns NULL if not applicable. */
+static block_t *block_pool_Alloc(size_t alloc, size_t *restrict sizep)
+{
+    unsigned c = block_pool_ClassOf(alloc);
+    if (c >= BLOCK_POOL_CLASSES)
+        return NULL; /* too big, use the heap directly */
+
+    struct block_pool_magazine *mag = block_pool_GetMagazine();
+    if (unlikely(mag == NULL))
+        return NULL;
+
+    *sizep = block_pool_ClassSize(c);
+
+    if (mag->count[c] == 0)
+    {
+        block_pool_Refill(mag, c);
+        block_pool_CommitStats(mag);
+    }
+
+    if (mag->count[c] > 0)
+    {
+        mag->stats.hits++;
+        return mag->slots[c][--mag->count[c]];
+    }
+
+    mag->stats.misses++;
+    return malloc(*sizep);
+}
+
+void block_PoolStats(struct block_pool_stats *st)
+{
+    struct block_pool_magazine *mag = block_pool_GetMagazine();
+
+    if (mag != NULL)
+        block_pool_CommitStats(mag);
+
+    st->hits = atomic_load_explicit(&block_pool.hits, memory_order_relaxed);
+    st->misses = atomic_load_explicit(&block_pool.misses,
+                                      memory_order_relaxed);
+    st->recycled = atomic_load_explicit(&block_pool.recycled,
+                                        memory_order_relaxed);
+    st->freed = atomic_load_explicit(&block_pool.freed, memory_order_relaxed);
+}
+
 block_t *block_Alloc (size_t size)
 {
     if (unlikely(size >> 27))
@@ -114,16 +432,34 @@ block_t *block_Alloc (size_t size)
     }
 
     /* 2 * BLOCK_PADDING: pre + post padding */
-    const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
-                       + size;
+    size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    block_t *b;
+
+    if (unlikely(vlc_alloc_IsTracked()))
+    {
+        b = block_tracked_Alloc(alloc, vlc_alloc_Caller());
+        if (unlikely(b == NULL))
+            return NULL;
+    }
+    else
+    {
+        const struct vlc_block_callbacks *cbs = &block_pool_cbs;
+
+        b = block_pool_Alloc(alloc, &alloc);
+        if (b == NULL)
+        {
+            cbs = &block_generic_cbs;
+            b = malloc (alloc);
+            if (unlikely(b == NULL))
+                return NULL;
+        }
+        block_Init(b, cbs, b + 1, alloc - sizeof (*b));
+    }
 
-    block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
     static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
                    "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
@@ -199,10 +535,13 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     uint8_t *p_start = p_block->p_start;
     uint8_t *p_end = p_start + p_block->i_size;
 
-    /* Second, reallocate the buffer if we lack space. */
+    /* Second, reallocate the buffer if we lack space, or if the payload is
+     * shared, as growing it in place could overwrite what others see. */
     assert( i_prebody >= 0 );
     if( (size_t)(p_block->p_buffer - p_start) < (size_t)i_prebody
-     || (size_t)(p_end - p_block->p_buffer) < i_body )
+     || (size_t)(p_end - p_block->p_buffer) < i_body
+     || ((i_prebody > 0 || i_body > p_block->i_buffer)
+      && block_IsShared( p_block )) )
     {
         block_t *p_rea = block_Alloc( requested );
         if( p_rea == NULL )
@@ -240,6 +579,136 @@ block_t *block_Realloc (block_t *block, ssize_t prebody, size_t body)
     return rea;
 }
 
+/*
+ * Shared payloads: the first block_Slice() pins the block, by pointing its
+ * callbacks to a reference counter. Each slice is a header-only view of (part
+ * of) the payload of the pinned block, which is really released with the
+ * last reference, be it the pinned block itself or a view.
+ */
+struct block_pin
+{
+    struct vlc_block_callbacks cbs;
+    const struct vlc_block_callbacks *orig_cbs;
+    block_t *block;
+    vlc_atomic_rc_t rc;
+};
+
+struct block_view
+{
+    block_t self;
+    struct block_pin *pin;
+};
+
+static void block_pin_Release(struct block_pin *pin)
+{
+    if (vlc_atomic_rc_dec(&pin->rc))
+    {
+        block_t *block = pin->block;
+
+        block->cbs = pin->orig_cbs;
+        free(pin);
+        block->cbs->free(block);
+    }
+}
+
+static void block_pinned_Release(block_t *block)
+{
+    block_pin_Release(container_of(block->cbs, struct block_pin, cbs));
+}
+
+static void block_view_Release(block_t *block)
+{
+    struct block_view *view = container_of(block, struct block_view, self);
+
+    block_pin_Release(view->pin);
+    free(view);
+}
+
+static const struct vlc_block_callbacks block_view_cbs =
+{
+    block_view_Release,
+};
+
+static struct block_pin *block_GetPin(const block_t *block)
+{
+    if (block->cbs == &block_view_cbs)
+        return container_of(block, const struct block_view, self)->pin;
+    if (block->cbs->free == block_pinned_Release)
+        return container_of(block->cbs, struct block_pin, cbs);
+    return NULL;
+}
+
+block_t *block_Slice(block_t *block, size_t offset, size_t length)
+{
+    assert(offset <= block->i_buffer && length <= block->i_buffer - offset);
+
+    struct block_view *view = malloc(sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    struct block_pin *pin = block_GetPin(block);
+    if (pin == NULL)
+    {
+        pin = malloc(sizeof (*pin));
+        if (unlikely(pin == NULL))
+        {
+            free(view);
+            return NULL;
+        }
+        pin->cbs.free = block_pinned_Release;
+        pin->orig_cbs = block->cbs;
+        pin->block = block;
+        vlc_atomic_rc_init(&pin->rc);
+        block->cbs = &pin->cbs;
+    }
+
+    vlc_atomic_rc_inc(&pin->rc);
+    view->pin = pin;
+    /* No room around the payload: growing the view reallocates it */
+    block_Init(&view->self, &block_view_cbs, block->p_buffer + offset, length);
+    block_CopyProperties(&view->self, block);
+    return &view->self;
+}
+
+block_t *block_ChainJoin(block_t *list)
+{
+    struct block_pin *pin = block_GetPin(list);
+    if (pin == NULL)
+        return NULL;
+
+    const uint8_t *end = list->p_buffer + list->i_buffer;
+    vlc_tick_t length = list->i_length;
+
+    for (const block_t *b = list->p_next; b != NULL; b = b->p_next)
+    {
+        if (block_GetPin(b) != pin || b->p_buffer != end)
+            return NULL;
+        end += b->i_buffer;
+        length += b->i_length;
+    }
+
+    struct block_view *view = malloc(sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    vlc_atomic_rc_inc(&pin->rc);
+    view->pin = pin;
+    block_Init(&view->self, &block_view_cbs, list->p_buffer,
+               end - list->p_buffer);
+    block_CopyProperties(&view->self, list);
+    view->self.i_length = length;
+    block_ChainRelease(list);
+    return &view->self;
+}
+
+bool block_IsShared(const block_t *block)
+{
+    const struct block_pin *pin = block_GetPin(block);
+
+    return pin != NULL
+        && atomic_load_explicit(&pin->rc.refs, memory_order_acquire) > 1;
+}
+
 static void block_heap_Release (block_t *block)
 {
     free (block->p_start);
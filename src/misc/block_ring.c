@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * block_ring.c: single-producer single-consumer block queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "block_ring.h"
+
+static size_t ChainBytes(const block_t *block)
+{
+    size_t bytes = 0;
+
+    for (; block != NULL; block = block->p_next)
+        bytes += block->i_buffer;
+    return bytes;
+}
+
+int vlc_block_ring_Init(struct vlc_block_ring *ring, size_t capacity)
+{
+    size_t size = 1;
+
+    while (size < capacity)
+        size <<= 1;
+
+    ring->slots = vlc_alloc(size, sizeof (*ring->slots));
+    if (unlikely(ring->slots == NULL))
+        return VLC_ENOMEM;
+
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->bytes, 0);
+    return VLC_SUCCESS;
+}
+
+void vlc_block_ring_Destroy(struct vlc_block_ring *ring)
+{
+    block_t *block;
+
+    while ((block = vlc_block_ring_Pop(ring)) != NULL)
+        block_ChainRelease(block);
+    free(ring->slots);
+}
+
+bool vlc_block_ring_Push(struct vlc_block_ring *ring, block_t *block)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    assert(block != NULL);
+    if (head - tail > ring->mask)
+        return false; /* full */
+
+    ring->slots[head & ring->mask] = block;
+    atomic_fetch_add_explicit(&ring->bytes, ChainBytes(block),
+                              memory_order_relaxed);
+    /* Publish the slot content along with the new position */
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+block_t *vlc_block_ring_Pop(struct vlc_block_ring *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail == head)
+        return NULL; /* empty */
+
+    block_t *block = ring->slots[tail & ring->mask];
+
+    atomic_fetch_sub_explicit(&ring->bytes, ChainBytes(block),
+                              memory_order_relaxed);
+    /* Hand the slot back to the producer */
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return block;
+}
+
+void vlc_block_ring_DiscardUntil(struct vlc_block_ring *ring, size_t end)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    /* Positions wrap around; entries may already have been consumed. */
+    while ((ptrdiff_t)(end - tail) > 0)
+    {
+        block_t *block = vlc_block_ring_Pop(ring);
+        if (block == NULL)
+            break;
+        block_ChainRelease(block);
+        tail++;
+    }
+}
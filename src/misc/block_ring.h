@@ -0,0 +1,114 @@
+/*****************************************************************************
+ * block_ring.h: single-producer single-consumer block queue
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_BLOCK_RING_H
+#define LIBVLC_BLOCK_RING_H 1
+
+#include <vlc_atomic.h>
+
+/**
+ * Bounded lock-free queue of blocks.
+ *
+ * Exactly one thread may push (the producer) and exactly one thread may pop
+ * (the consumer) at any given time. Counters can be read from any thread.
+ *
+ * The ring does not provide any wake-up mechanism: the owner is expected to
+ * park the consumer on its own condition variable when the ring is empty.
+ */
+struct vlc_block_ring
+{
+    block_t **slots;
+    size_t mask;
+    _Atomic size_t head; /**< next write position (producer) */
+    _Atomic size_t tail; /**< next read position (consumer) */
+    atomic_size_t bytes;
+};
+
+/**
+ * Initializes a ring.
+ *
+ * @param capacity maximum number of queued entries (rounded up to a power
+ *                 of two)
+ * @return VLC_SUCCESS or VLC_ENOMEM
+ */
+int vlc_block_ring_Init(struct vlc_block_ring *, size_t capacity);
+
+/**
+ * Releases a ring and all blocks still queued in it.
+ */
+void vlc_block_ring_Destroy(struct vlc_block_ring *);
+
+/**
+ * Queues a block or block chain (producer only).
+ *
+ * A chain occupies a single entry.
+ *
+ * @retval true on success
+ * @retval false if the ring is full (the block is not queued)
+ */
+bool vlc_block_ring_Push(struct vlc_block_ring *, block_t *);
+
+/**
+ * Dequeues the oldest entry (consumer only).
+ *
+ * @return a block or block chain, or NULL if the ring is empty
+ */
+block_t *vlc_block_ring_Pop(struct vlc_block_ring *);
+
+/**
+ * Dequeues and releases entries up to a given position (consumer only).
+ *
+ * @param end position, as previously returned by vlc_block_ring_Head()
+ */
+void vlc_block_ring_DiscardUntil(struct vlc_block_ring *, size_t end);
+
+/**
+ * Gets the current write position.
+ *
+ * Everything pushed so far lies before the returned position.
+ */
+static inline size_t vlc_block_ring_Head(struct vlc_block_ring *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+/**
+ * Counts queued entries.
+ *
+ * @note When called from a thread other than the producer or the consumer,
+ * the result is only a snapshot.
+ */
+static inline size_t vlc_block_ring_Count(struct vlc_block_ring *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    return head - tail;
+}
+
+/**
+ * Counts queued payload bytes.
+ */
+static inline size_t vlc_block_ring_Bytes(struct vlc_block_ring *ring)
+{
+    return atomic_load_explicit(&ring->bytes, memory_order_relaxed);
+}
+
+#endif
@@ -262,6 +262,50 @@ VLC_WEAK unsigned vlc_CPU(void)
     return cpu_flags;
 }
 
+static unsigned vlc_CPUBudgetShareLocked(const libvlc_priv_t *priv)
+{
+    assert(priv->cpu_users > 0);
+    return __MAX(priv->cpu_budget / priv->cpu_users, 1u);
+}
+
+#undef vlc_CPUBudgetAcquire
+unsigned vlc_CPUBudgetAcquire(vlc_object_t *obj)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(obj));
+    unsigned share;
+
+    vlc_mutex_lock(&priv->lock);
+    priv->cpu_users++;
+    share = vlc_CPUBudgetShareLocked(priv);
+    vlc_mutex_unlock(&priv->lock);
+
+    msg_Dbg(obj, "CPU budget share: %u thread(s)", share);
+    return share;
+}
+
+#undef vlc_CPUBudgetShare
+unsigned vlc_CPUBudgetShare(vlc_object_t *obj)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(obj));
+    unsigned share;
+
+    vlc_mutex_lock(&priv->lock);
+    share = vlc_CPUBudgetShareLocked(priv);
+    vlc_mutex_unlock(&priv->lock);
+    return share;
+}
+
+#undef vlc_CPUBudgetRelease
+void vlc_CPUBudgetRelease(vlc_object_t *obj)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(obj));
+
+    vlc_mutex_lock(&priv->lock);
+    assert(priv->cpu_users > 0);
+    priv->cpu_users--;
+    vlc_mutex_unlock(&priv->lock);
+}
+
 void vlc_CPU_dump (vlc_object_t *obj)
 {
     struct vlc_memstream stream;
@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * crc.c: cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_crc.h>
+
+/*
+ * Slicing-by-8: table[k][b] is the CRC of the byte b followed by k zero
+ * bytes, so that eight input bytes are folded with eight independent table
+ * lookups instead of a chain of eight dependent ones.
+ */
+static struct
+{
+    uint8_t crc8[8][256];
+    uint16_t crc16[8][256];
+    uint32_t crc32[8][256];
+} crc_tables;
+
+static vlc_once_t crc_once = VLC_STATIC_ONCE;
+
+static void vlc_crc_Init(void)
+{
+    for (unsigned b = 0; b < 256; b++)
+    {
+        uint_fast8_t c8 = b;
+        uint_fast16_t c16 = b << 8;
+        uint_fast32_t c32 = (uint_fast32_t)b << 24;
+
+        for (unsigned i = 0; i < 8; i++)
+        {
+            c8 = (c8 << 1) ^ ((c8 & 0x80) ? 0x07 : 0);
+            c16 = (c16 << 1) ^ ((c16 & 0x8000) ? 0x8005 : 0);
+            c32 = (c32 << 1) ^ ((c32 & 0x80000000) ? 0x04C11DB7 : 0);
+        }
+        crc_tables.crc8[0][b] = c8;
+        crc_tables.crc16[0][b] = c16;
+        crc_tables.crc32[0][b] = c32;
+    }
+
+    for (unsigned k = 1; k < 8; k++)
+        for (unsigned b = 0; b < 256; b++)
+        {
+            uint8_t c8 = crc_tables.crc8[k - 1][b];
+            uint16_t c16 = crc_tables.crc16[k - 1][b];
+            uint32_t c32 = crc_tables.crc32[k - 1][b];
+
+            crc_tables.crc8[k][b] = crc_tables.crc8[0][c8];
+            crc_tables.crc16[k][b] = (c16 << 8)
+                                   ^ crc_tables.crc16[0][c16 >> 8];
+            crc_tables.crc32[k][b] = (c32 << 8)
+                                   ^ crc_tables.crc32[0][c32 >> 24];
+        }
+}
+
+uint8_t vlc_crc8(uint8_t crc, const void *buf, size_t len)
+{
+    const uint8_t (*t)[256] = crc_tables.crc8;
+    const uint8_t *p = buf;
+
+    vlc_once(&crc_once, vlc_crc_Init);
+
+    for (; len >= 8; len -= 8, p += 8)
+        crc = t[7][crc ^ p[0]] ^ t[6][p[1]] ^ t[5][p[2]] ^ t[4][p[3]]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+
+    while (len-- > 0)
+        crc = t[0][crc ^ *(p++)];
+    return crc;
+}
+
+uint16_t vlc_crc16(uint16_t crc, const void *buf, size_t len)
+{
+    const uint16_t (*t)[256] = crc_tables.crc16;
+    const uint8_t *p = buf;
+
+    vlc_once(&crc_once, vlc_crc_Init);
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        crc ^= GetWBE(p);
+        crc = t[7][crc >> 8] ^ t[6][crc & 0xff] ^ t[5][p[2]] ^ t[4][p[3]]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+
+    while (len-- > 0)
+        crc = (crc << 8) ^ t[0][(crc >> 8) ^ *(p++)];
+    return crc;
+}
+
+uint32_t vlc_crc32(uint32_t crc, const void *buf, size_t len)
+{
+    const uint32_t (*t)[256] = crc_tables.crc32;
+    const uint8_t *p = buf;
+
+    vlc_once(&crc_once, vlc_crc_Init);
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        crc ^= GetDWBE(p);
+        crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xff]
+            ^ t[5][(crc >> 8) & 0xff] ^ t[4][crc & 0xff]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+
+    while (len-- > 0)
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *(p++)];
+    return crc;
+}
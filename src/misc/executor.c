@@ -0,0 +1,255 @@
+/*****************************************************************************
+ * executor.c: shared thread pool for background jobs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <assert.h>
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
+#include <vlc_list.h>
+#include <vlc_threads.h>
+
+#include "libvlc.h"
+
+/*
+ * Background jobs are coarse (preparsing, art fetching, thumbnailing,
+ * indexing), so a single lock protects all the queues. Workers still keep
+ * their own queue of the jobs they submit, run in LIFO order while they are
+ * hot in cache, and stolen in FIFO order by idle workers.
+ */
+
+struct vlc_executor_worker
+{
+    vlc_executor_t *owner;
+    vlc_thread_t thread;
+    struct vlc_list deque; /**< normal priority jobs submitted by this worker */
+};
+
+struct vlc_executor
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< signaled on new job or exit */
+    struct vlc_list queues[3]; /**< jobs by priority */
+    bool quit;
+
+    size_t pending; /**< queued jobs */
+    unsigned idle; /**< workers waiting for a job */
+    unsigned steal; /**< next worker to steal from */
+    unsigned count; /**< maximum number of workers */
+    unsigned started;
+    struct vlc_executor_worker workers[];
+};
+
+static thread_local struct vlc_executor_worker *current_worker;
+
+static struct vlc_runnable *ListTake(struct vlc_list *list, bool last)
+{
+    if (vlc_list_is_empty(list))
+        return NULL;
+
+    struct vlc_list *node = last ? list->prev : list->next;
+    vlc_list_remove(node);
+    return container_of(node, struct vlc_runnable, node);
+}
+
+/* Picks the next job, with the lock held */
+static struct vlc_runnable *Take(vlc_executor_t *ex,
+                                 struct vlc_executor_worker *self)
+{
+    struct vlc_runnable *r;
+
+    r = ListTake(&ex->queues[VLC_EXECUTOR_PRIORITY_HIGH], false);
+    if (r != NULL)
+        return r;
+    r = ListTake(&self->deque, true);
+    if (r != NULL)
+        return r;
+    r = ListTake(&ex->queues[VLC_EXECUTOR_PRIORITY_NORMAL], false);
+    if (r != NULL)
+        return r;
+
+    for (unsigned i = 0; i < ex->started; i++)
+    {
+        struct vlc_executor_worker *victim =
+            &ex->workers[(ex->steal + i) % ex->started];
+
+        if (victim == self)
+            continue;
+        r = ListTake(&victim->deque, false);
+        if (r != NULL)
+        {
+            ex->steal = (ex->steal + i + 1) % ex->started;
+            return r;
+        }
+    }
+
+    return ListTake(&ex->queues[VLC_EXECUTOR_PRIORITY_LOW], false);
+}
+
+static void *Thread(void *data)
+{
+    struct vlc_executor_worker *self = data;
+    vlc_executor_t *ex = self->owner;
+
+    current_worker = self;
+
+    vlc_mutex_lock(&ex->lock);
+    while (!ex->quit)
+    {
+        struct vlc_runnable *r = Take(ex, self);
+        if (r == NULL)
+        {
+            ex->idle++;
+            vlc_cond_wait(&ex->wait, &ex->lock);
+            ex->idle--;
+            continue;
+        }
+
+        r->queued = false;
+        ex->pending--;
+        vlc_mutex_unlock(&ex->lock);
+        r->run(r->userdata); /* r may be freed from here */
+        vlc_mutex_lock(&ex->lock);
+    }
+    vlc_mutex_unlock(&ex->lock);
+    return NULL;
+}
+
+vlc_executor_t *vlc_executor_New(unsigned max_threads)
+{
+    if (max_threads == 0)
+        /* Background jobs mostly wait for I/O: do not stop at the CPU count */
+        max_threads = __MAX(vlc_GetCPUCount(), 4);
+
+    vlc_executor_t *ex = malloc(sizeof (*ex)
+                                + max_threads * sizeof (ex->workers[0]));
+    if (unlikely(ex == NULL))
+        return NULL;
+
+    vlc_mutex_init(&ex->lock);
+    vlc_cond_init(&ex->wait);
+    for (size_t i = 0; i < ARRAY_SIZE(ex->queues); i++)
+        vlc_list_init(&ex->queues[i]);
+    ex->quit = false;
+    ex->pending = 0;
+    ex->idle = 0;
+    ex->steal = 0;
+    ex->count = max_threads;
+    ex->started = 0;
+    return ex;
+}
+
+void vlc_executor_Delete(vlc_executor_t *ex)
+{
+    vlc_mutex_lock(&ex->lock);
+    ex->quit = true;
+    vlc_cond_broadcast(&ex->wait);
+    vlc_mutex_unlock(&ex->lock);
+
+    for (unsigned i = 0; i < ex->started; i++)
+        vlc_join(ex->workers[i].thread, NULL);
+
+    vlc_cond_destroy(&ex->wait);
+    vlc_mutex_destroy(&ex->lock);
+    free(ex);
+}
+
+int vlc_executor_Submit(vlc_executor_t *ex, struct vlc_runnable *r,
+                        int priority)
+{
+    struct vlc_executor_worker *self = current_worker;
+
+    assert(priority >= VLC_EXECUTOR_PRIORITY_LOW
+        && priority <= VLC_EXECUTOR_PRIORITY_HIGH);
+
+    vlc_mutex_lock(&ex->lock);
+    assert(!ex->quit);
+    r->queued = true;
+    r->canceled = false;
+
+    if (self != NULL && self->owner == ex
+     && priority == VLC_EXECUTOR_PRIORITY_NORMAL)
+        vlc_list_append(&r->node, &self->deque);
+    else
+        vlc_list_append(&r->node, &ex->queues[priority]);
+    ex->pending++;
+
+    if (ex->idle > 0)
+        vlc_cond_signal(&ex->wait);
+    if (ex->pending > ex->idle && ex->started < ex->count)
+    {
+        struct vlc_executor_worker *w = &ex->workers[ex->started];
+
+        w->owner = ex;
+        vlc_list_init(&w->deque);
+        if (vlc_clone(&w->thread, Thread, w, VLC_THREAD_PRIORITY_LOW) == 0)
+            ex->started++;
+        else
+            ex->count = ex->started;
+    }
+
+    if (unlikely(ex->started == 0))
+    {   /* No threads at all: the job would never run */
+        vlc_list_remove(&r->node);
+        r->queued = false;
+        ex->pending--;
+        vlc_mutex_unlock(&ex->lock);
+        return VLC_EGENERIC;
+    }
+    vlc_mutex_unlock(&ex->lock);
+    return VLC_SUCCESS;
+}
+
+bool vlc_executor_Cancel(vlc_executor_t *ex, struct vlc_runnable *r)
+{
+    bool dequeued;
+
+    vlc_mutex_lock(&ex->lock);
+    dequeued = r->queued;
+    if (dequeued)
+    {
+        vlc_list_remove(&r->node);
+        r->queued = false;
+        ex->pending--;
+    }
+    r->canceled = true;
+    vlc_mutex_unlock(&ex->lock);
+    return dequeued;
+}
+
+bool vlc_executor_IsCanceled(vlc_executor_t *ex,
+                             const struct vlc_runnable *r)
+{
+    bool canceled;
+
+    vlc_mutex_lock(&ex->lock);
+    canceled = r->canceled;
+    vlc_mutex_unlock(&ex->lock);
+    return canceled;
+}
+
+#undef vlc_object_executor
+vlc_executor_t *vlc_object_executor(vlc_object_t *obj)
+{
+    return libvlc_priv(vlc_object_instance(obj))->executor;
+}
@@ -129,6 +129,41 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
     return block;
 }
 
+block_t *vlc_fifo_DequeueBatchUnlocked(block_fifo_t *fifo, size_t max_count,
+                                       size_t max_bytes)
+{
+    vlc_mutex_assert(&fifo->lock);
+
+    block_t *first = fifo->p_first;
+    block_t **pp = &fifo->p_first;
+    size_t count = 0, bytes = 0;
+
+    /* The first block is always dequeued, regardless of its size. */
+    while (*pp != NULL && count < max_count
+        && (count == 0 || bytes + (*pp)->i_buffer <= max_bytes))
+    {
+        bytes += (*pp)->i_buffer;
+        count++;
+        pp = &(*pp)->p_next;
+    }
+
+    if (count == 0)
+        return NULL;
+
+    /* Splice the head of the queue out */
+    fifo->p_first = *pp;
+    if (*pp == NULL)
+        fifo->pp_last = &fifo->p_first;
+    *pp = NULL;
+
+    assert(fifo->i_depth >= count);
+    fifo->i_depth -= count;
+    assert(fifo->i_size >= bytes);
+    fifo->i_size -= bytes;
+
+    return first;
+}
+
 block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
     vlc_mutex_assert(&fifo->lock);
@@ -31,6 +31,7 @@
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 #include "../misc/variables.h"
+#include "../misc/slices.h"
 
 /* */
 
@@ -99,6 +100,14 @@ void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
     free(names);
 }
 
+void filter_RunSlices(filter_t *filter, unsigned lines, unsigned align,
+                      void (*cb)(void *, unsigned, unsigned), void *opaque)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(filter));
+
+    vlc_slices_Run(priv->slices, lines, align, cb, opaque);
+}
+
 /* */
 
 vlc_blender_t *filter_NewBlend( vlc_object_t *p_this,
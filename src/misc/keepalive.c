@@ -0,0 +1,200 @@
+/*****************************************************************************
+ * keepalive.c: store for idle reusable resources
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <vlc_common.h>
+#include <vlc_keepalive.h>
+#include <vlc_list.h>
+
+#include "libvlc.h"
+
+/*
+ * There are few resources, and they are kept for seconds: expiry is checked
+ * lazily on every call, rather than with a timer.
+ */
+
+struct vlc_keepalive_entry
+{
+    struct vlc_list node;
+    void *data;
+    void (*release)(void *);
+    vlc_tick_t deadline;
+    char key[];
+};
+
+struct vlc_keepalive
+{
+    vlc_mutex_t lock;
+    struct vlc_list entries; /**< oldest first */
+    size_t count;
+    size_t max;
+};
+
+vlc_keepalive_t *vlc_keepalive_New(size_t max)
+{
+    vlc_keepalive_t *ka = malloc(sizeof (*ka));
+    if (unlikely(ka == NULL))
+        return NULL;
+
+    vlc_mutex_init(&ka->lock);
+    vlc_list_init(&ka->entries);
+    ka->count = 0;
+    ka->max = max;
+    return ka;
+}
+
+/* Moves an entry to a list of entries to release, with the lock held */
+static void Evict(vlc_keepalive_t *ka, struct vlc_keepalive_entry *entry,
+                  struct vlc_list *garbage)
+{
+    vlc_list_remove(&entry->node);
+    vlc_list_append(&entry->node, garbage);
+    ka->count--;
+}
+
+static void Expire(vlc_keepalive_t *ka, struct vlc_list *garbage)
+{
+    struct vlc_keepalive_entry *entry;
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_list_foreach(entry, &ka->entries, node)
+        if (entry->deadline <= now)
+            Evict(ka, entry, garbage);
+}
+
+/* Releases evicted entries, without the lock as that can be slow */
+static void Release(struct vlc_list *garbage)
+{
+    struct vlc_keepalive_entry *entry;
+
+    vlc_list_foreach(entry, garbage, node)
+    {
+        entry->release(entry->data);
+        free(entry);
+    }
+}
+
+void vlc_keepalive_Delete(vlc_keepalive_t *ka)
+{
+    struct vlc_keepalive_entry *entry;
+
+    vlc_list_foreach(entry, &ka->entries, node)
+    {
+        entry->release(entry->data);
+        free(entry);
+    }
+    vlc_mutex_destroy(&ka->lock);
+    free(ka);
+}
+
+int vlc_keepalive_Put(vlc_keepalive_t *ka, const char *key, void *data,
+                      void (*release)(void *), vlc_tick_t timeout,
+                      unsigned max_per_key)
+{
+    size_t keylen = strlen(key) + 1;
+    struct vlc_keepalive_entry *entry = malloc(sizeof (*entry) + keylen);
+    if (unlikely(entry == NULL))
+    {
+        release(data);
+        return VLC_ENOMEM;
+    }
+
+    entry->data = data;
+    entry->release = release;
+    entry->deadline = vlc_tick_now() + timeout;
+    memcpy(entry->key, key, keylen);
+
+    struct vlc_list garbage;
+    struct vlc_keepalive_entry *e;
+    unsigned same = 0;
+
+    vlc_list_init(&garbage);
+    vlc_mutex_lock(&ka->lock);
+    Expire(ka, &garbage);
+
+    vlc_list_foreach(e, &ka->entries, node)
+        if (strcmp(e->key, key) == 0)
+            same++;
+    /* Oldest first */
+    vlc_list_foreach(e, &ka->entries, node)
+        if (same >= max_per_key && strcmp(e->key, key) == 0)
+        {
+            Evict(ka, e, &garbage);
+            same--;
+        }
+
+    while (ka->count >= ka->max && ka->count > 0)
+        Evict(ka, vlc_list_first_entry_or_null(&ka->entries,
+                                               struct vlc_keepalive_entry,
+                                               node), &garbage);
+
+    if (ka->max > 0)
+    {
+        vlc_list_append(&entry->node, &ka->entries);
+        ka->count++;
+    }
+    else
+        vlc_list_append(&entry->node, &garbage);
+    vlc_mutex_unlock(&ka->lock);
+
+    Release(&garbage);
+    return VLC_SUCCESS;
+}
+
+void *vlc_keepalive_Take(vlc_keepalive_t *ka, const char *key)
+{
+    struct vlc_list garbage;
+    struct vlc_keepalive_entry *entry, *found = NULL;
+
+    vlc_list_init(&garbage);
+    vlc_mutex_lock(&ka->lock);
+    Expire(ka, &garbage);
+
+    /* The most recent one is the least likely to have been closed remotely */
+    vlc_list_foreach(entry, &ka->entries, node)
+        if (strcmp(entry->key, key) == 0)
+            found = entry;
+    if (found != NULL)
+    {
+        vlc_list_remove(&found->node);
+        ka->count--;
+    }
+    vlc_mutex_unlock(&ka->lock);
+
+    Release(&garbage);
+
+    if (found == NULL)
+        return NULL;
+
+    void *data = found->data;
+    free(found);
+    return data;
+}
+
+#undef vlc_object_keepalive
+vlc_keepalive_t *vlc_object_keepalive(vlc_object_t *obj)
+{
+    return libvlc_priv(vlc_object_instance(obj))->keepalive;
+}
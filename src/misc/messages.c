@@ -37,6 +37,7 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
@@ -440,6 +441,191 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * Messages are formatted on the calling thread into the cells of a bounded
+ * lock-free queue (multiple producers, single consumer), and written to the
+ * backend log by a dedicated thread. If the queue is full, messages are
+ * dropped and counted rather than blocking the caller.
+ */
+#define LOG_ASYNC_CELLS 512 /* must be a power of two */
+#define LOG_ASYNC_MODULE_MAX 32
+#define LOG_ASYNC_HEADER_MAX 64
+#define LOG_ASYNC_MSG_MAX 400
+
+struct vlc_log_cell {
+    atomic_size_t seq;
+    int type;
+    vlc_log_t meta;
+    char module[LOG_ASYNC_MODULE_MAX];
+    char header[LOG_ASYNC_HEADER_MAX];
+    char msg[LOG_ASYNC_MSG_MAX];
+};
+
+struct vlc_logger_async {
+    struct vlc_logger frontend;
+    struct vlc_logger *backend;
+    vlc_thread_t thread;
+    vlc_sem_t ready; /**< Posted for each queued message, and to stop */
+    atomic_bool stop;
+    atomic_uint dropped;
+    atomic_size_t head; /**< Next cell to write (producers) */
+    size_t tail; /**< Next cell to read (logger thread) */
+    struct vlc_log_cell cells[LOG_ASYNC_CELLS];
+};
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+    struct vlc_log_cell *cell;
+    size_t pos = atomic_load_explicit(&async->head, memory_order_relaxed);
+
+    /* Claim a cell */
+    for (;;)
+    {
+        cell = &async->cells[pos & (LOG_ASYNC_CELLS - 1)];
+
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&async->head, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {   /* Full: the logger thread is behind */
+            atomic_fetch_add_explicit(&async->dropped, 1,
+                                      memory_order_relaxed);
+            return;
+        }
+        else
+            pos = atomic_load_explicit(&async->head, memory_order_relaxed);
+    }
+
+    /* The module name and header may not outlive the call: copy them. */
+    cell->type = type;
+    cell->meta = *item;
+    strlcpy(cell->module, item->psz_module, sizeof (cell->module));
+    cell->meta.psz_module = cell->module;
+    if (item->psz_header != NULL)
+    {
+        strlcpy(cell->header, item->psz_header, sizeof (cell->header));
+        cell->meta.psz_header = cell->header;
+    }
+    if (vsnprintf(cell->msg, sizeof (cell->msg), format, ap) < 0)
+        strcpy(cell->msg, "message lost");
+
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    vlc_sem_post(&async->ready);
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+    struct vlc_logger *backend = async->backend;
+
+    for (;;)
+    {
+        vlc_sem_wait(&async->ready);
+
+        unsigned dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                                    memory_order_relaxed);
+        if (dropped > 0)
+        {
+            const vlc_log_t meta = {
+                .i_object_id = (uintptr_t)(void *)async,
+                .psz_object_type = "logger",
+                .psz_module = "core",
+                .file = __FILE__,
+                .line = __LINE__,
+                .func = __func__,
+                .tid = vlc_thread_id(),
+            };
+
+            vlc_LogCallback(backend, VLC_MSG_WARN, &meta,
+                            "%u log message(s) dropped", dropped);
+        }
+
+        /* Cells can be published out of order: drain all the ready ones,
+         * then wait for the next post. */
+        for (;;)
+        {
+            struct vlc_log_cell *cell =
+                &async->cells[async->tail & (LOG_ASYNC_CELLS - 1)];
+
+            if (atomic_load_explicit(&cell->seq, memory_order_acquire)
+                 != async->tail + 1)
+                break;
+
+            vlc_LogCallback(backend, cell->type, &cell->meta, "%s",
+                            cell->msg);
+            atomic_store_explicit(&cell->seq, async->tail + LOG_ASYNC_CELLS,
+                                  memory_order_release);
+            async->tail++;
+        }
+
+        if (atomic_load_explicit(&async->stop, memory_order_relaxed))
+            break;
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+    struct vlc_logger *backend = async->backend;
+
+    /* The switch lock is held for writing, so no messages are in flight. */
+    atomic_store_explicit(&async->stop, true, memory_order_relaxed);
+    vlc_sem_post(&async->ready);
+    vlc_join(async->thread, NULL);
+
+    backend->ops->destroy(backend);
+    vlc_sem_destroy(&async->ready);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *backend)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->frontend.ops = &async_ops;
+    async->backend = backend;
+    vlc_sem_init(&async->ready, 0);
+    atomic_init(&async->stop, false);
+    atomic_init(&async->dropped, 0);
+    atomic_init(&async->head, 0);
+    async->tail = 0;
+    for (size_t i = 0; i < LOG_ASYNC_CELLS; i++)
+        atomic_init(&async->cells[i].seq, i);
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_sem_destroy(&async->ready);
+        free(async);
+        return NULL;
+    }
+    return &async->frontend;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -449,6 +635,12 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async"))
+    {
+        struct vlc_logger *async = vlc_LogAsyncCreate(logger);
+        if (async != NULL)
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
@@ -34,10 +34,55 @@
 #include <limits.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include "picture.h"
+#include "alloc_stats.h"
 #include <vlc_image.h>
 #include <vlc_block.h>
 
+struct vlc_film_grain_priv
+{
+    vlc_film_grain_t grain;
+    vlc_atomic_rc_t rc;
+};
+
+vlc_film_grain_t *vlc_film_grain_New(void)
+{
+    struct vlc_film_grain_priv *priv = calloc(1, sizeof (*priv));
+    if (unlikely(priv == NULL))
+        return NULL;
+
+    vlc_atomic_rc_init(&priv->rc);
+    return &priv->grain;
+}
+
+vlc_film_grain_t *vlc_film_grain_Hold(vlc_film_grain_t *grain)
+{
+    struct vlc_film_grain_priv *priv =
+        container_of(grain, struct vlc_film_grain_priv, grain);
+
+    vlc_atomic_rc_inc(&priv->rc);
+    return grain;
+}
+
+void vlc_film_grain_Release(vlc_film_grain_t *grain)
+{
+    struct vlc_film_grain_priv *priv =
+        container_of(grain, struct vlc_film_grain_priv, grain);
+
+    if (vlc_atomic_rc_dec(&priv->rc))
+        free(priv);
+}
+
+static void PictureDestroyFilmGrain( picture_t *p_picture )
+{
+    if (p_picture->film_grain != NULL)
+    {
+        vlc_film_grain_Release(p_picture->film_grain);
+        p_picture->film_grain = NULL;
+    }
+}
+
 static void PictureDestroyContext( picture_t *p_picture )
 {
     picture_context_t *ctx = p_picture->context;
@@ -82,6 +127,21 @@ VLC_WEAK void picture_Deallocate(int fd, void *base, size_t size)
     assert((size % 64) == 0);
 }
 
+/* No arena without memory file descriptors */
+VLC_WEAK void picture_ArenaEnable(size_t max_cached)
+{
+    (void) max_cached;
+}
+
+VLC_WEAK void picture_ArenaDisable(void)
+{
+}
+
+VLC_WEAK void picture_ArenaGetStats(struct picture_arena_stats *stats)
+{
+    *stats = (struct picture_arena_stats) { 0 };
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
@@ -95,6 +155,7 @@ void picture_Reset( picture_t *p_picture )
     p_picture->i_nb_fields = 2;
     p_picture->b_top_field_first = false;
     PictureDestroyContext( p_picture );
+    PictureDestroyFilmGrain( p_picture );
 }
 
 /*****************************************************************************
@@ -215,10 +276,18 @@ static picture_priv_t *picture_NewPrivate(const video_format_t *restrict p_fmt,
 
     atomic_init(&p_picture->refs, 1);
     priv->gc.opaque = NULL;
+    priv->stats.site = NULL;
 
     return priv;
 }
 
+static void picture_Track(picture_priv_t *priv, const void *caller,
+                          size_t size)
+{
+    priv->stats.size = size;
+    priv->stats.site = vlc_alloc_Track(VLC_ALLOC_PICTURE, caller, size);
+}
+
 picture_t *picture_NewFromResource( const video_format_t *p_fmt, const picture_resource_t *p_resource )
 {
     assert(p_resource != NULL);
@@ -243,12 +312,14 @@ picture_t *picture_NewFromResource( const video_format_t *p_fmt, const picture_r
         p_picture->p[i].i_pitch  = p_resource->p[i].i_pitch;
     }
 
+    picture_Track(priv, vlc_alloc_Caller(), sizeof (*priv));
     return p_picture;
 }
 
 #define PICTURE_SW_SIZE_MAX (UINT32_C(1) << 28) /* 256MB: 8K * 8K * 4*/
 
-picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
+static picture_t *picture_NewFromFormatAt(const video_format_t *restrict fmt,
+                                          const void *caller)
 {
     picture_priv_t *priv = picture_NewPrivate(fmt, sizeof (picture_buffer_t));
     if (unlikely(priv == NULL))
@@ -259,6 +330,7 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     picture_t *pic = &priv->picture;
     if (pic->i_planes == 0) {
         pic->p_sys = NULL;
+        picture_Track(priv, caller, sizeof (*priv));
         return pic;
     }
 
@@ -296,12 +368,18 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
         buf += plane_sizes[i];
     }
 
+    picture_Track(priv, caller, sizeof (*priv) + sizeof (*res) + pic_size);
     return pic;
 error:
     free(pic);
     return NULL;
 }
 
+picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
+{
+    return picture_NewFromFormatAt(fmt, vlc_alloc_Caller());
+}
+
 picture_t *picture_New( vlc_fourcc_t i_chroma, int i_width, int i_height, int i_sar_num, int i_sar_den )
 {
     video_format_t fmt;
@@ -310,7 +388,7 @@ picture_t *picture_New( vlc_fourcc_t i_chroma, int i_width, int i_height, int i_
     video_format_Setup( &fmt, i_chroma, i_width, i_height,
                         i_width, i_height, i_sar_num, i_sar_den );
 
-    return picture_NewFromFormat( &fmt );
+    return picture_NewFromFormatAt( &fmt, vlc_alloc_Caller() );
 }
 
 /*****************************************************************************
@@ -324,10 +402,12 @@ void picture_Destroy(picture_t *picture)
     assert(atomic_load_explicit(&picture->refs, memory_order_relaxed) == 0);
 
     PictureDestroyContext(picture);
+    PictureDestroyFilmGrain(picture);
 
     picture_priv_t *priv = container_of(picture, picture_priv_t, picture);
     assert(priv->gc.destroy != NULL);
     priv->gc.destroy(picture);
+    vlc_alloc_Untrack(priv->stats.site, priv->stats.size);
     free(priv);
 }
 
@@ -379,6 +459,10 @@ void picture_CopyProperties( picture_t *p_dst, const picture_t *p_src )
     p_dst->b_progressive = p_src->b_progressive;
     p_dst->i_nb_fields = p_src->i_nb_fields;
     p_dst->b_top_field_first = p_src->b_top_field_first;
+
+    PictureDestroyFilmGrain(p_dst);
+    if (p_src->film_grain != NULL)
+        p_dst->film_grain = vlc_film_grain_Hold(p_src->film_grain);
 }
 
 void picture_CopyPixels( picture_t *p_dst, const picture_t *p_src )
@@ -426,6 +510,8 @@ picture_t *picture_Clone(picture_t *picture)
 
         if (picture->context != NULL)
             clone->context = picture->context->copy(picture->context);
+        if (picture->film_grain != NULL)
+            clone->film_grain = vlc_film_grain_Hold(picture->film_grain);
     }
     return clone;
 }
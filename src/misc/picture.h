@@ -23,6 +23,8 @@
 
 #include <vlc_picture.h>
 
+struct vlc_alloc_site;
+
 typedef struct
 {
     picture_t picture;
@@ -31,9 +33,41 @@ typedef struct
         void (*destroy)(picture_t *);
         void *opaque;
     } gc;
+    struct
+    {
+        struct vlc_alloc_site *site;
+        size_t size;
+    } stats;
 
     max_align_t extra[];
 } picture_priv_t;
 
 void *picture_Allocate(int *, size_t);
 void picture_Deallocate(int, void *, size_t);
+
+struct picture_arena_stats
+{
+    uint64_t allocated; /**< buffers handed out by the arena */
+    uint64_t reused; /**< allocations served from released buffers */
+    uint64_t hugetlb; /**< allocations backed by reserved huge pages */
+    size_t live_bytes; /**< bytes of the buffers in use */
+    size_t peak_bytes; /**< highest live_bytes so far */
+    size_t cached_bytes; /**< bytes of the released buffers kept */
+};
+
+/**
+ * Enables the picture buffer arena for large pictures
+ *
+ * Calls are reference counted, with the largest cap being kept.
+ *
+ * \param max_cached cap on the bytes of released buffers kept for reuse
+ */
+void picture_ArenaEnable(size_t max_cached);
+
+/**
+ * Drops a reference to the arena, releasing the buffers kept for reuse
+ * with the last one
+ */
+void picture_ArenaDisable(void);
+
+void picture_ArenaGetStats(struct picture_arena_stats *);
@@ -44,8 +44,9 @@ struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_ullong      available; /* bitmap of the free pictures */
+    atomic_uint        waiters; /* threads in picture_pool_Wait() */
     atomic_ushort      refs;
     unsigned short     picture_count;
     picture_t  *picture[];
@@ -69,6 +70,46 @@ void picture_pool_Release(picture_pool_t *pool)
     picture_pool_Destroy(pool);
 }
 
+/* Marks a picture as free, and wakes up a waiter if there is one */
+static void picture_pool_PutIndex(picture_pool_t *pool, unsigned offset)
+{
+    unsigned long long old =
+        atomic_fetch_or_explicit(&pool->available, 1ULL << offset,
+                                 memory_order_seq_cst);
+    assert(!(old & (1ULL << offset)));
+    (void) old;
+
+    /* Either the waiter sees the new bit, or this sees the waiter. The
+     * lock ensures the waiter is sleeping or has not checked the bitmap
+     * yet, so that the signal is not lost. */
+    if (atomic_load_explicit(&pool->waiters, memory_order_seq_cst) != 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
+/* Takes the lowest free picture within mask without locking,
+ * returns -1 if none */
+static int picture_pool_GetIndex(picture_pool_t *pool, unsigned long long mask)
+{
+    unsigned long long available =
+        atomic_load_explicit(&pool->available, memory_order_relaxed);
+
+    while ((available & mask) != 0)
+    {
+        int i = ctz(available & mask);
+
+        if (atomic_compare_exchange_weak_explicit(&pool->available, &available,
+                                                  available & ~(1ULL << i),
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed))
+            return i;
+    }
+    return -1;
+}
+
 static void picture_pool_ReleasePicture(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
@@ -81,12 +122,7 @@ static void picture_pool_ReleasePicture(picture_t *clone)
         pool->pic_unlock(picture);
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
-
+    picture_pool_PutIndex(pool, offset);
     picture_pool_Destroy(pool);
 }
 
@@ -132,14 +168,15 @@ picture_pool_t *picture_pool_NewExtended(const picture_pool_configuration_t *cfg
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
     if (cfg->picture_count == POOL_MAX)
-        pool->available = ~0ULL;
+        atomic_init(&pool->available, ~0ULL);
     else
-        pool->available = (1ULL << cfg->picture_count) - 1;
+        atomic_init(&pool->available, (1ULL << cfg->picture_count) - 1);
+    atomic_init(&pool->waiters, 0);
     atomic_init(&pool->refs,  1);
     pool->picture_count = cfg->picture_count;
     memcpy(pool->picture, cfg->picture,
            cfg->picture_count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -200,80 +237,81 @@ error:
     return NULL;
 }
 
-picture_t *picture_pool_Get(picture_pool_t *pool)
+/* Locks and clones the picture at offset, or gives it back on failure */
+static picture_t *picture_pool_Acquire(picture_pool_t *pool, unsigned offset,
+                                       bool *locked)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
-    available = pool->available;
-
-    while (available != 0)
-    {
-        int i = ctz(available);
-
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
-
-        picture_t *picture = pool->picture[i];
-
-        if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-            vlc_mutex_lock(&pool->lock);
-            pool->available |= 1ULL << i;
-            continue;
-        }
+    picture_t *picture = pool->picture[offset];
 
-        picture_t *clone = picture_pool_ClonePicture(pool, i);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-        }
-        return clone;
+    *locked = pool->pic_lock == NULL || pool->pic_lock(picture) == VLC_SUCCESS;
+    if (!*locked) {
+        picture_pool_PutIndex(pool, offset);
+        return NULL;
     }
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    picture_t *clone = picture_pool_ClonePicture(pool, offset);
+    if (clone != NULL) {
+        assert(clone->p_next == NULL);
+        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    }
+    else
+        picture_pool_PutIndex(pool, offset);
+    return clone;
 }
 
-picture_t *picture_pool_Wait(picture_pool_t *pool)
+picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-    while (pool->available == 0)
+    if (unlikely(atomic_load_explicit(&pool->canceled, memory_order_relaxed)))
+        return NULL;
+
+    /* Skip the pictures that cannot be locked */
+    for (unsigned long long mask = ~0ULL;;)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
+        int i = picture_pool_GetIndex(pool, mask);
+        if (i < 0)
             return NULL;
-        }
-        vlc_cond_wait(&pool->wait, &pool->lock);
+
+        bool locked;
+        picture_t *clone = picture_pool_Acquire(pool, i, &locked);
+        if (locked)
+            return clone;
+        mask &= ~(1ULL << i);
     }
+}
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
-    vlc_mutex_unlock(&pool->lock);
+picture_t *picture_pool_Wait(picture_pool_t *pool)
+{
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-    picture_t *picture = pool->picture[i];
+    int i = -1;
+    if (likely(!atomic_load_explicit(&pool->canceled, memory_order_relaxed)))
+        i = picture_pool_GetIndex(pool, ~0ULL);
 
-    if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
+    if (i < 0)
+    {   /* Slow path: the pool is exhausted (or canceled) */
         vlc_mutex_lock(&pool->lock);
-        pool->available |= 1ULL << i;
-        vlc_cond_signal(&pool->wait);
+        atomic_fetch_add_explicit(&pool->waiters, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        for (;;)
+        {
+            if (atomic_load_explicit(&pool->canceled, memory_order_relaxed))
+                break;
+            i = picture_pool_GetIndex(pool, ~0ULL);
+            if (i >= 0)
+                break;
+            vlc_cond_wait(&pool->wait, &pool->lock);
+        }
+        atomic_fetch_sub_explicit(&pool->waiters, 1, memory_order_relaxed);
         vlc_mutex_unlock(&pool->lock);
-        return NULL;
-    }
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+        if (i < 0)
+            return NULL;
     }
-    return clone;
+
+    bool locked;
+    return picture_pool_Acquire(pool, i, &locked);
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
@@ -281,7 +319,7 @@ void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
     vlc_mutex_lock(&pool->lock);
     assert(pool->refs > 0);
 
-    pool->canceled = canceled;
+    atomic_store_explicit(&pool->canceled, canceled, memory_order_relaxed);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
@@ -0,0 +1,192 @@
+/*****************************************************************************
+ * slices.c: picture slices thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <assert.h>
+#include <vlc_common.h>
+#include <vlc_list.h>
+#include <vlc_threads.h>
+
+#include "slices.h"
+
+struct vlc_slice_job
+{
+    struct vlc_list node;
+    void (*cb)(void *, unsigned, unsigned);
+    void *opaque;
+    unsigned lines;
+    unsigned band; /**< lines per band */
+    unsigned bands;
+    unsigned next; /**< first unclaimed band */
+    unsigned finished;
+};
+
+struct vlc_slices
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< signaled on new job or exit */
+    vlc_cond_t done; /**< signaled on job completion */
+    struct vlc_list jobs;
+    bool quit;
+
+    unsigned count; /**< worker threads to start */
+    unsigned started;
+    vlc_thread_t threads[];
+};
+
+/* Runs the next band of a job, with the lock held */
+static void vlc_slices_RunBand(vlc_slices_t *slices, struct vlc_slice_job *job)
+{
+    assert(job->next < job->bands);
+
+    const unsigned i = job->next++;
+    if (job->next == job->bands)
+        vlc_list_remove(&job->node); /* nothing left to claim */
+
+    const unsigned start = i * job->band;
+    const unsigned end = __MIN(start + job->band, job->lines);
+
+    vlc_mutex_unlock(&slices->lock);
+    job->cb(job->opaque, start, end);
+    vlc_mutex_lock(&slices->lock);
+
+    if (++job->finished == job->bands)
+        vlc_cond_broadcast(&slices->done);
+}
+
+static void *vlc_slices_Thread(void *data)
+{
+    vlc_slices_t *slices = data;
+
+    vlc_mutex_lock(&slices->lock);
+    for (;;)
+    {
+        while (!slices->quit && vlc_list_is_empty(&slices->jobs))
+            vlc_cond_wait(&slices->wait, &slices->lock);
+        if (slices->quit)
+            break;
+
+        struct vlc_slice_job *job =
+            vlc_list_first_entry_or_null(&slices->jobs, struct vlc_slice_job,
+                                         node);
+        vlc_slices_RunBand(slices, job);
+    }
+    vlc_mutex_unlock(&slices->lock);
+    return NULL;
+}
+
+vlc_slices_t *vlc_slices_New(unsigned threads)
+{
+    if (threads == 0)
+        threads = vlc_GetCPUCount();
+    if (threads <= 1)
+        return NULL;
+
+    const unsigned count = threads - 1;
+    vlc_slices_t *slices = malloc(sizeof (*slices)
+                                  + count * sizeof (slices->threads[0]));
+    if (unlikely(slices == NULL))
+        return NULL;
+
+    vlc_mutex_init(&slices->lock);
+    vlc_cond_init(&slices->wait);
+    vlc_cond_init(&slices->done);
+    vlc_list_init(&slices->jobs);
+    slices->quit = false;
+    slices->count = count;
+    slices->started = 0;
+    return slices;
+}
+
+void vlc_slices_Delete(vlc_slices_t *slices)
+{
+    if (slices == NULL)
+        return;
+
+    vlc_mutex_lock(&slices->lock);
+    assert(vlc_list_is_empty(&slices->jobs));
+    slices->quit = true;
+    vlc_cond_broadcast(&slices->wait);
+    vlc_mutex_unlock(&slices->lock);
+
+    for (unsigned i = 0; i < slices->started; i++)
+        vlc_join(slices->threads[i], NULL);
+
+    vlc_cond_destroy(&slices->done);
+    vlc_cond_destroy(&slices->wait);
+    vlc_mutex_destroy(&slices->lock);
+    free(slices);
+}
+
+void vlc_slices_Run(vlc_slices_t *slices, unsigned lines, unsigned align,
+                    void (*cb)(void *, unsigned, unsigned), void *opaque)
+{
+    if (align == 0)
+        align = 1;
+
+    const unsigned units = (lines + align - 1) / align;
+    if (slices == NULL || units <= 1)
+        goto inline_run;
+
+    vlc_mutex_lock(&slices->lock);
+    while (slices->started < slices->count)
+    {
+        if (vlc_clone(&slices->threads[slices->started], vlc_slices_Thread,
+                      slices, VLC_THREAD_PRIORITY_VIDEO))
+        {
+            slices->count = slices->started;
+            break;
+        }
+        slices->started++;
+    }
+    if (slices->started == 0)
+    {
+        vlc_mutex_unlock(&slices->lock);
+        goto inline_run;
+    }
+
+    const unsigned bands = __MIN(slices->started + 1, units);
+    struct vlc_slice_job job = {
+        .cb = cb,
+        .opaque = opaque,
+        .lines = lines,
+        .band = ((units + bands - 1) / bands) * align,
+        .next = 0,
+        .finished = 0,
+    };
+    job.bands = (lines + job.band - 1) / job.band;
+
+    vlc_list_append(&job.node, &slices->jobs);
+    vlc_cond_broadcast(&slices->wait);
+
+    while (job.next < job.bands)
+        vlc_slices_RunBand(slices, &job);
+    while (job.finished < job.bands)
+        vlc_cond_wait(&slices->done, &slices->lock);
+    vlc_mutex_unlock(&slices->lock);
+    return;
+
+inline_run:
+    if (lines > 0)
+        cb(opaque, 0, lines);
+}
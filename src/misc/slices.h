@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * slices.h: picture slices thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_SLICES_H
+#define LIBVLC_SLICES_H
+
+typedef struct vlc_slices vlc_slices_t;
+
+/**
+ * Creates a pool of worker threads
+ *
+ * Threads are only started on first use.
+ *
+ * \param threads number of threads running slices, including the caller
+ *                of vlc_slices_Run() (0 for one per CPU)
+ * \return the pool, or NULL if slices are not run concurrently
+ */
+vlc_slices_t *vlc_slices_New(unsigned threads);
+
+void vlc_slices_Delete(vlc_slices_t *);
+
+/**
+ * Splits lines [0, lines) in bands and runs them concurrently
+ *
+ * Bands are multiple of align lines high, but for the last one. The calling
+ * thread participates and the function only returns once all bands have
+ * been processed. Concurrent calls from several threads share the pool.
+ *
+ * \param slices pool (may be NULL to run inline)
+ */
+void vlc_slices_Run(vlc_slices_t *slices, unsigned lines, unsigned align,
+                    void (*cb)(void *opaque, unsigned start, unsigned end),
+                    void *opaque);
+
+#endif
@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,8 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash;     /**< Hash of the name */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -136,23 +134,109 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+/* FNV-1a */
+static uint32_t VarHash( const char *psz_name )
+{
+    uint32_t hash = 2166136261u;
+
+    for( const unsigned char *p = (const unsigned char *)psz_name; *p; p++ )
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+/**
+ * Finds the slot of a variable in the open addressing (linear probing) hash
+ * table of an object. The variable lock must be held.
+ *
+ * 
+eturn the slot index, or SIZE_MAX if there is no such variable
+ */
+static size_t VarFind( const vlc_object_internals_t *priv,
+                       const char *psz_name, uint32_t hash )
+{
+    if( priv->var_table == NULL )
+        return SIZE_MAX;
+
+    for( size_t i = hash & priv->var_mask;; i = (i + 1) & priv->var_mask )
+    {
+        const variable_t *var = priv->var_table[i];
+
+        if( var == NULL )
+            return SIZE_MAX;
+        if( var->hash == hash && strcmp( var->psz_name, psz_name ) == 0 )
+            return i;
+    }
+}
+
+static void VarPut( variable_t **table, size_t mask, variable_t *var )
 {
-    const variable_t *va = a, *vb = b;
+    size_t i = var->hash & mask;
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    while( table[i] != NULL )
+        i = (i + 1) & mask;
+    table[i] = var;
+}
+
+/**
+ * Adds a variable to the hash table of an object, growing it to keep the
+ * load factor under 3/4. The variable lock must be held.
+ */
+static int VarInsert( vlc_object_internals_t *priv, variable_t *var )
+{
+    size_t size = priv->var_table != NULL ? priv->var_mask + 1 : 0;
+
+    if( 4 * (priv->var_count + 1) > 3 * size )
+    {
+        size_t newsize = size ? 2 * size : 16;
+        variable_t **table = calloc( newsize, sizeof (*table) );
+        if( unlikely(table == NULL) )
+            return VLC_ENOMEM;
+
+        for( size_t i = 0; i < size; i++ )
+            if( priv->var_table[i] != NULL )
+                VarPut( table, newsize - 1, priv->var_table[i] );
+        free( priv->var_table );
+        priv->var_table = table;
+        priv->var_mask = newsize - 1;
+    }
+
+    VarPut( priv->var_table, priv->var_mask, var );
+    priv->var_count++;
+    return VLC_SUCCESS;
+}
+
+/**
+ * Removes the variable at a given slot. Following entries are shifted back
+ * so that the probe sequences remain unbroken without tombstones.
+ */
+static void VarRemove( vlc_object_internals_t *priv, size_t i )
+{
+    variable_t **table = priv->var_table;
+    const size_t mask = priv->var_mask;
+
+    for( size_t j = (i + 1) & mask; table[j] != NULL; j = (j + 1) & mask )
+    {
+        const size_t home = table[j]->hash & mask;
+
+        /* Move the entry to the hole, unless its home is after the hole */
+        if( ((j - home) & mask) >= ((j - i) & mask) )
+        {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i] = NULL;
+    priv->var_count--;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    variable_t **pp_var;
+    uint32_t hash = VarHash( psz_name );
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    size_t i = VarFind( priv, psz_name, hash );
+    return (i != SIZE_MAX) ? priv->var_table[i] : NULL;
 }
 
 static void Destroy( variable_t *p_var )
@@ -295,6 +379,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -352,18 +437,21 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    variable_t **pp_var, *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
+    size_t i = VarFind( p_priv, psz_name, p_var->hash );
+    if( i == SIZE_MAX ) /* Variable create */
+    {
+        ret = VarInsert( p_priv, p_var );
+        if( ret == VLC_SUCCESS )
+            p_var = NULL; /* Variable created */
+    }
     else /* Variable already exists */
     {
+        variable_t *p_oldvar = p_priv->var_table[i];
+
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
         p_oldvar->i_usage++;
         p_oldvar->i_type |= i_type & VLC_VAR_ISCOMMAND;
@@ -376,22 +464,18 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
     return ret;
 }
 
-void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
+/**
+ * Drops a reference to a variable, and removes it from the object if it was
+ * the last one. The variable lock must be held; it is released.
+ */
+static void Release( vlc_object_t *p_this, variable_t *p_var )
 {
-    variable_t *p_var;
-
-    assert( p_this );
-
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
 
-    p_var = Lookup( p_this, psz_name );
-    if( p_var == NULL )
-        msg_Dbg( p_this, "attempt to destroy nonexistent variable \"%s\"",
-                 psz_name );
-    else if( --p_var->i_usage == 0 )
+    if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        VarRemove( p_priv, VarFind( p_priv, p_var->psz_name, p_var->hash ) );
     }
     else
     {
@@ -404,17 +488,63 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
+void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
 {
-    Destroy( var );
+    variable_t *p_var;
+
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    p_var = Lookup( p_this, psz_name );
+    if( p_var == NULL )
+    {
+        vlc_mutex_unlock( &p_priv->var_lock );
+        msg_Dbg( p_this, "attempt to destroy nonexistent variable \"%s\"",
+                 psz_name );
+        return;
+    }
+    Release( p_this, p_var );
 }
 
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    if( priv->var_table != NULL )
+    {
+        for( size_t i = 0; i <= priv->var_mask; i++ )
+            if( priv->var_table[i] != NULL )
+                Destroy( priv->var_table[i] );
+        free( priv->var_table );
+    }
+    priv->var_table = NULL;
+    priv->var_mask = 0;
+    priv->var_count = 0;
+}
+
+variable_t *(var_AcquireHandle)(vlc_object_t *p_this, const char *psz_name)
+{
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+    variable_t *p_var = Lookup( p_this, psz_name );
+
+    if( p_var != NULL )
+    {
+        assert(p_var->i_usage != -1u);
+        p_var->i_usage++;
+    }
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return p_var;
+}
+
+void (var_ReleaseHandle)(vlc_object_t *p_this, variable_t *p_var)
+{
+    assert( p_this );
+
+    vlc_mutex_lock( &vlc_internals( p_this )->var_lock );
+    Release( p_this, p_var );
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -670,26 +800,16 @@ int (var_Type)(vlc_object_t *p_this, const char *psz_name)
     return i_type;
 }
 
-int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
-                     int expected_type, vlc_value_t val)
+/* The variable lock must be held */
+static void SetLocked( vlc_object_t *p_this, variable_t *p_var,
+                       int expected_type, vlc_value_t val )
 {
-    variable_t *p_var;
     vlc_value_t oldval;
 
-    assert( p_this );
-
-    vlc_object_internals_t *p_priv = vlc_internals( p_this );
-
-    p_var = Lookup( p_this, psz_name );
-    if( p_var == NULL )
-    {
-        vlc_mutex_unlock( &p_priv->var_lock );
-        return VLC_ENOVAR;
-    }
-
     assert( expected_type == 0 ||
             (p_var->i_type & VLC_VAR_CLASS) == expected_type );
     assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
+    (void) expected_type;
 
     WaitUnused( p_this, p_var );
 
@@ -706,11 +826,42 @@ int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
     p_var->val = val;
 
     /* Deal with callbacks */
-    TriggerCallback( p_this, p_var, psz_name, oldval );
+    TriggerCallback( p_this, p_var, p_var->psz_name, oldval );
 
     /* Free data if needed */
     p_var->ops->pf_free( &oldval );
+}
+
+int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
+                     int expected_type, vlc_value_t val)
+{
+    variable_t *p_var;
+
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    p_var = Lookup( p_this, psz_name );
+    if( p_var == NULL )
+    {
+        vlc_mutex_unlock( &p_priv->var_lock );
+        return VLC_ENOVAR;
+    }
 
+    SetLocked( p_this, p_var, expected_type, val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return VLC_SUCCESS;
+}
+
+int (var_SetHandle)(vlc_object_t *p_this, variable_t *p_var,
+                    int expected_type, vlc_value_t val)
+{
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    SetLocked( p_this, p_var, expected_type, val );
     vlc_mutex_unlock( &p_priv->var_lock );
     return VLC_SUCCESS;
 }
@@ -720,6 +871,22 @@ int (var_Set)(vlc_object_t *p_this, const char *psz_name, vlc_value_t val)
     return var_SetChecked( p_this, psz_name, 0, val );
 }
 
+/* The variable lock must be held */
+static void GetLocked( const variable_t *p_var, int expected_type,
+                       vlc_value_t *p_val )
+{
+    assert( expected_type == 0 ||
+            (p_var->i_type & VLC_VAR_CLASS) == expected_type );
+    assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
+    (void) expected_type;
+
+    /* Really get the variable */
+    *p_val = p_var->val;
+
+    /* Duplicate value if needed */
+    p_var->ops->pf_dup( p_val );
+}
+
 int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
                      int expected_type, vlc_value_t *p_val)
 {
@@ -731,17 +898,7 @@ int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
 
     p_var = Lookup( p_this, psz_name );
     if( p_var != NULL )
-    {
-        assert( expected_type == 0 ||
-                (p_var->i_type & VLC_VAR_CLASS) == expected_type );
-        assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
-
-        /* Really get the variable */
-        *p_val = p_var->val;
-
-        /* Duplicate value if needed */
-        p_var->ops->pf_dup( p_val );
-    }
+        GetLocked( p_var, expected_type, p_val );
     else
         err = VLC_ENOVAR;
 
@@ -749,6 +906,19 @@ int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
     return err;
 }
 
+int (var_GetHandle)(vlc_object_t *p_this, variable_t *p_var,
+                    int expected_type, vlc_value_t *p_val)
+{
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    GetLocked( p_var, expected_type, p_val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return VLC_SUCCESS;
+}
+
 int (var_Get)(vlc_object_t *p_this, const char *psz_name, vlc_value_t *p_val)
 {
     return var_GetChecked( p_this, psz_name, 0, p_val );
@@ -1134,19 +1304,9 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
+static int CmpNames(const void *a, const void *b)
 {
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
+    return strcmp(*(char *const *)a, *(char *const *)b);
 }
 
 char **var_GetAllNames(vlc_object_t *obj)
@@ -1156,13 +1316,24 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    if (priv->var_table != NULL)
+        for (size_t i = 0; i <= priv->var_mask; i++)
+        {
+            const variable_t *var = priv->var_table[i];
+            if (var == NULL)
+                continue;
+
+            char *dup = strdup(var->psz_name);
+            if (dup != NULL)
+                ARRAY_APPEND(names, dup);
+        }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
         return NULL;
+    /* Sorted, as the names were listed from a search tree before */
+    qsort(names.p_elems, names.i_size, sizeof (char *), CmpNames);
     ARRAY_APPEND(names, NULL);
     return names.p_elems;
 }
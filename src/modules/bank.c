@@ -167,6 +167,7 @@ static vlc_plugin_t *module_InitStatic(vlc_plugin_cb entry)
 
 #ifdef HAVE_DYNAMIC_PLUGINS
     atomic_init(&lib->handle, 0);
+    atomic_init(&lib->broken, false);
     lib->unloadable = false;
 #endif
     return lib;
@@ -292,7 +293,7 @@ typedef struct module_bank
 
     size_t        size;
     vlc_plugin_t **plugins;
-    vlc_plugin_t *cache;
+    vlc_plugin_cache_t *cache;
 } module_bank_t;
 
 /**
@@ -304,9 +305,9 @@ static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
     vlc_plugin_t *plugin = NULL;
 
     /* Check our plugins cache first then load plugin if needed */
-    if (bank->mode & CACHE_READ_FILE)
+    if (bank->cache != NULL)
     {
-        plugin = vlc_cache_lookup(&bank->cache, relpath);
+        plugin = vlc_cache_lookup(bank->cache, relpath);
 
         if (plugin != NULL
          && (plugin->mtime != (int64_t)st->st_mtime
@@ -453,15 +454,16 @@ static void AllocatePluginPath(vlc_object_t *obj, const char *path,
     }
 
     /* Deal with unmatched cache entries from cache file */
-    while (bank.cache != NULL)
+    if (bank.cache != NULL)
     {
-        vlc_plugin_t *plugin = bank.cache;
+        if (!(mode & CACHE_SCAN_DIR))
+        {
+            vlc_plugin_t *plugin;
 
-        bank.cache = plugin->next;
-        if (mode & CACHE_SCAN_DIR)
-            vlc_plugin_destroy(plugin);
-        else
-            vlc_plugin_store(plugin);
+            while ((plugin = vlc_cache_next(bank.cache)) != NULL)
+                vlc_plugin_store(plugin);
+        }
+        vlc_cache_release(bank.cache);
     }
 
     if (mode & CACHE_WRITE_FILE)
@@ -540,13 +542,18 @@ int module_Map(struct vlc_logger *log, vlc_plugin_t *plugin)
         return 0; /* static module needs not be mapped */
     if (atomic_load_explicit(&plugin->handle, memory_order_acquire))
         return 0; /* fast path: already loaded */
+    if (atomic_load_explicit(&plugin->broken, memory_order_relaxed))
+        return -1; /* failed before, do not retry for every probe */
 
     /* Try to load the plug-in (without locks, so read-only) */
     assert(plugin->abspath != NULL);
 
     void *handle = module_Open(log, plugin->abspath, false);
     if (handle == NULL)
+    {
+        atomic_store_explicit(&plugin->broken, true, memory_order_relaxed);
         return -1;
+    }
 
     vlc_plugin_cb entry = vlc_dlsym(handle, "vlc_entry");
     if (entry == NULL)
@@ -575,6 +582,7 @@ int module_Map(struct vlc_logger *log, vlc_plugin_t *plugin)
     return 0;
 error:
     vlc_dlclose(handle);
+    atomic_store_explicit(&plugin->broken, true, memory_order_relaxed);
     return -1;
 }
 
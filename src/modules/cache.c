@@ -35,9 +35,13 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <assert.h>
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_memstream.h>
 #include "libvlc.h"
 
 #include <vlc_plugin.h>
@@ -56,15 +60,67 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 38
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
 /* Magic for the cache filename */
 #define CACHE_STRING "cache "PACKAGE_NAME" "PACKAGE_VERSION
 
+/*
+ * After the version header, the cache file contains:
+ *  - the index,
+ *  - one entry per plug-in, sorted by relative path,
+ *  - the string pool, where strings are referred to by their offset,
+ *    offset zero being the NULL string, and where the plug-in paths come
+ *    first so that looking them up touches as few pages as possible,
+ *  - the plug-in records.
+ * The file is mapped in memory and used in place: loading only checks the
+ * index and the entries, and a record is decoded when the directory scan
+ * finds its plug-in, so records of missing plug-ins are never touched.
+ */
+struct cache_index
+{
+    uint32_t plugins; /**< Number of entries */
+    uint32_t strings; /**< Offset of the string pool */
+    uint32_t strings_size; /**< Size of the string pool */
+    uint32_t size; /**< File size */
+};
+
+struct cache_entry
+{
+    uint32_t path; /**< Relative path string */
+    uint32_t offset; /**< Offset of the plug-in record */
+    uint32_t size; /**< Size of the plug-in record */
+    uint32_t reserved;
+};
+
+#define CACHE_INDEX_ALIGN   8
+#define CACHE_RECORDS_ALIGN 16
 
-static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
+struct vlc_plugin_cache
+{
+    vlc_object_t *obj;
+    char *dir;
+    const uint8_t *base;
+    const struct cache_entry *entries;
+    size_t count;
+    const char *strings;
+    size_t strings_size;
+    size_t next; /**< Next entry for vlc_cache_next() */
+    bool used[]; /**< Entries already returned */
+};
+
+/** Decoding cursor within a plug-in record */
+typedef struct
+{
+    const uint8_t *p_buffer;
+    size_t i_buffer;
+    const char *strings;
+    size_t strings_size;
+} cache_reader_t;
+
+static int vlc_cache_load_immediate(void *out, cache_reader_t *in, size_t size)
 {
     if (in->i_buffer < size)
         return -1;
@@ -75,7 +131,7 @@ static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
     return 0;
 }
 
-static int vlc_cache_load_bool(bool *out, block_t *in)
+static int vlc_cache_load_bool(bool *out, cache_reader_t *in)
 {
     unsigned char b;
 
@@ -87,7 +143,7 @@ static int vlc_cache_load_bool(bool *out, block_t *in)
 }
 
 static int vlc_cache_load_array(const void **p, size_t size, size_t n,
-                                block_t *file)
+                                cache_reader_t *file)
 {
     if (n == 0)
     {
@@ -109,31 +165,20 @@ static int vlc_cache_load_array(const void **p, size_t size, size_t n,
     return 0;
 }
 
-static int vlc_cache_load_string(const char **restrict p, block_t *file)
+static int vlc_cache_load_string(const char **restrict p, cache_reader_t *file)
 {
-    uint16_t size;
-
-    if (vlc_cache_load_immediate(&size, file, sizeof (size)) || size > 16384)
-        return -1;
-
-    if (size == 0)
-    {
-        *p = NULL;
-        return 0;
-    }
-
-    const char *str = (char *)file->p_buffer;
+    uint32_t offset;
 
-    if (file->i_buffer < size || str[size - 1] != '\0')
+    /* The pool ends with a nul, so that any offset within it is a string */
+    if (vlc_cache_load_immediate(&offset, file, sizeof (offset))
+     || offset >= file->strings_size)
         return -1;
 
-    file->p_buffer += size;
-    file->i_buffer -= size;
-    *p = str;
+    *p = (offset != 0) ? file->strings + offset : NULL;
     return 0;
 }
 
-static int vlc_cache_load_align(size_t align, block_t *file)
+static int vlc_cache_load_align(size_t align, cache_reader_t *file)
 {
     assert(align > 0);
 
@@ -178,7 +223,7 @@ static int vlc_cache_load_align(size_t align, block_t *file)
     if (vlc_cache_load_align(alignof(t), file)) \
         goto error
 
-static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
+static int vlc_cache_load_config(module_config_t *cfg, cache_reader_t *file)
 {
     LOAD_IMMEDIATE (cfg->i_type);
     LOAD_IMMEDIATE (cfg->i_short);
@@ -238,7 +283,8 @@ error:
     return -1; /* FIXME: leaks */
 }
 
-static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin,
+                                        cache_reader_t *file)
 {
     uint16_t lines;
 
@@ -282,7 +328,7 @@ error:
     return -1; /* FIXME: leaks */
 }
 
-static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_module(vlc_plugin_t *plugin, cache_reader_t *file)
 {
     module_t *module = vlc_module_create(plugin);
     if (unlikely(module == NULL))
@@ -307,12 +353,13 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
     LOAD_STRING(module->deactivate_name);
     LOAD_STRING(module->psz_capability);
     LOAD_IMMEDIATE(module->i_score);
+    LOAD_STRING(module->psz_hints);
     return 0;
 error:
     return -1;
 }
 
-static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
+static vlc_plugin_t *vlc_cache_load_plugin(cache_reader_t *file)
 {
     vlc_plugin_t *plugin = vlc_plugin_create();
     if (unlikely(plugin == NULL))
@@ -353,6 +400,7 @@ error:
     return NULL;
 }
 
+
 /**
  * Loads a plugins cache file.
  *
@@ -360,9 +408,12 @@ error:
  * will in turn be queried by AllocateAllPlugins() to see if it needs to
  * actually load the dynamically loadable module.
  * This allows us to only fully load plugins when they are actually used.
+ *
+ * Only the index of the cache is checked here: plug-ins are decoded by
+ * vlc_cache_lookup() and vlc_cache_next().
  */
-vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
-                             block_t **backingp)
+vlc_plugin_cache_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
+                                   block_t **backingp)
 {
     char *psz_filename;
 
@@ -381,10 +432,15 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     if (file == NULL)
         return NULL;
 
+    cache_reader_t header = {
+        .p_buffer = file->p_buffer,
+        .i_buffer = file->i_buffer,
+    };
+
     /* Check the file is a plugins cache */
     char cachestr[sizeof (CACHE_STRING) - 1];
 
-    if (vlc_cache_load_immediate(cachestr, file, sizeof (cachestr))
+    if (vlc_cache_load_immediate(cachestr, &header, sizeof (cachestr))
      || memcmp(cachestr, CACHE_STRING, sizeof (cachestr)))
     {
         msg_Warn( p_this, "This doesn't look like a valid plugins cache" );
@@ -396,7 +452,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     /* Check for distribution specific version */
     char distrostr[sizeof (DISTRO_VERSION) - 1];
 
-    if (vlc_cache_load_immediate(distrostr, file, sizeof (distrostr))
+    if (vlc_cache_load_immediate(distrostr, &header, sizeof (distrostr))
      || memcmp(distrostr, DISTRO_VERSION, sizeof (distrostr)))
     {
         msg_Warn( p_this, "This doesn't look like a valid plugins cache" );
@@ -408,7 +464,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     /* Check sub-version number */
     uint32_t marker;
 
-    if (vlc_cache_load_immediate(&marker, file, sizeof (marker))
+    if (vlc_cache_load_immediate(&marker, &header, sizeof (marker))
      || marker != CACHE_SUBVERSION_NUM)
     {
         msg_Warn( p_this, "This doesn't look like a valid plugins cache "
@@ -418,7 +474,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     }
 
     /* Check header marker */
-    if (vlc_cache_load_immediate(&marker, file, sizeof (marker))
+    if (vlc_cache_load_immediate(&marker, &header, sizeof (marker))
 #ifdef DISTRO_VERSION
      || marker != (sizeof (cachestr) + sizeof (distrostr) + sizeof (marker))
 #else
@@ -432,81 +488,267 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    /* Check the index */
+    const size_t index_off = (file->i_buffer - header.i_buffer
+                              + CACHE_INDEX_ALIGN - 1) & ~(CACHE_INDEX_ALIGN - 1);
+    const size_t entries_off = index_off + sizeof (struct cache_index);
+    struct cache_index index;
+
+    if (entries_off > file->i_buffer
+     || ((uintptr_t)file->p_buffer % alignof (struct cache_entry)) != 0)
+        goto error;
+
+    memcpy(&index, file->p_buffer + index_off, sizeof (index));
+    if (index.size != file->i_buffer
+     || index.plugins > (file->i_buffer - entries_off)
+                        / sizeof (struct cache_entry)
+     || index.strings < entries_off
+                        + index.plugins * sizeof (struct cache_entry)
+     || index.strings > file->i_buffer
+     || index.strings_size == 0
+     || index.strings_size > file->i_buffer - index.strings
+     || file->p_buffer[index.strings + index.strings_size - 1] != '\0')
+        goto error;
+
+    const struct cache_entry *entries =
+        (const void *)(file->p_buffer + entries_off);
 
-    while (file->i_buffer > 0)
+    for (size_t i = 0; i < index.plugins; i++)
     {
-        vlc_plugin_t *plugin = vlc_cache_load_plugin(file);
-        if (plugin == NULL)
-            goto error;
+        const struct cache_entry *e = entries + i;
 
-        if (unlikely(asprintf(&plugin->abspath, "%s" DIR_SEP "%s", dir,
-                              plugin->path) == -1))
-        {
-            plugin->abspath = NULL;
-            vlc_plugin_destroy(plugin);
+        if (e->path == 0 || e->path >= index.strings_size
+         || e->offset > file->i_buffer || e->size > file->i_buffer - e->offset)
             goto error;
-        }
+    }
 
-        plugin->next = cache;
-        cache = plugin;
+    vlc_plugin_cache_t *cache = malloc(sizeof (*cache) + index.plugins);
+    if (unlikely(cache == NULL))
+    {
+        block_Release(file);
+        return NULL;
     }
 
+    cache->dir = strdup(dir);
+    if (unlikely(cache->dir == NULL))
+    {
+        free(cache);
+        block_Release(file);
+        return NULL;
+    }
+    cache->obj = p_this;
+    cache->base = file->p_buffer;
+    cache->entries = entries;
+    cache->count = index.plugins;
+    cache->strings = (const char *)file->p_buffer + index.strings;
+    cache->strings_size = index.strings_size;
+    cache->next = 0;
+    memset(cache->used, 0, index.plugins);
+
+    /* The plug-ins point into the mapping: keep it until the bank ends. */
     file->p_next = *backingp;
     *backingp = file;
     return cache;
 
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
-
-    /* TODO: cleanup */
     block_Release(file);
     return NULL;
 }
 
-#define SAVE_IMMEDIATE( a ) \
-    if (fwrite (&(a), sizeof(a), 1, file) != 1) \
-        goto error
-#define SAVE_FLAG(a) \
-    do { \
-        char b = (a); \
-        SAVE_IMMEDIATE(b); \
-    } while (0)
-
-static int CacheSaveString (FILE *file, const char *str)
+/**
+ * Decodes the plug-in of a cache entry.
+ */
+static vlc_plugin_t *vlc_cache_load_entry(vlc_plugin_cache_t *cache, size_t i)
 {
-    uint16_t size = (str != NULL) ? (strlen (str) + 1) : 0;
+    const struct cache_entry *e = cache->entries + i;
+    cache_reader_t file = {
+        .p_buffer = cache->base + e->offset,
+        .i_buffer = e->size,
+        .strings = cache->strings,
+        .strings_size = cache->strings_size,
+    };
+
+    assert(!cache->used[i]);
+    cache->used[i] = true;
+
+    vlc_plugin_t *plugin = vlc_cache_load_plugin(&file);
+    if (plugin == NULL || file.i_buffer != 0)
+        goto error;
 
-    SAVE_IMMEDIATE (size);
-    if (size != 0 && fwrite(str, 1, size, file) != size)
+    if (unlikely(asprintf(&plugin->abspath, "%s" DIR_SEP "%s", cache->dir,
+                          plugin->path) == -1))
     {
+        plugin->abspath = NULL;
+        goto error;
+    }
+
+    return plugin;
+
 error:
+    msg_Warn(cache->obj, "plugins cache entry %s corrupted",
+             cache->strings + e->path);
+    if (plugin != NULL)
+        vlc_plugin_destroy(plugin);
+    return NULL;
+}
+
+/**
+ * Looks up a plugin file in a table of cached plugins.
+ *
+ * Each plug-in can only be looked up once.
+ */
+vlc_plugin_t *vlc_cache_lookup(vlc_plugin_cache_t *cache, const char *path)
+{
+    size_t lo = 0, hi = cache->count;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(path, cache->strings + cache->entries[mid].path);
+
+        if (cmp == 0)
+            return cache->used[mid] ? NULL : vlc_cache_load_entry(cache, mid);
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return NULL;
+}
+
+/**
+ * Decodes the next cached plug-in that was not looked up.
+ *
+ * \return a plug-in, or NULL once all the entries were returned
+ */
+vlc_plugin_t *vlc_cache_next(vlc_plugin_cache_t *cache)
+{
+    while (cache->next < cache->count)
+    {
+        size_t i = cache->next++;
+
+        if (cache->used[i])
+            continue;
+
+        vlc_plugin_t *plugin = vlc_cache_load_entry(cache, i);
+        if (plugin != NULL)
+            return plugin;
+    }
+    return NULL;
+}
+
+/**
+ * Releases a cache index.
+ *
+ * The cache mapping itself remains, as the plug-ins refer to it.
+ */
+void vlc_cache_release(vlc_plugin_cache_t *cache)
+{
+    free(cache->dir);
+    free(cache);
+}
+
+/** Cache file being built */
+typedef struct
+{
+    struct vlc_memstream records;
+    size_t records_size;
+    struct vlc_memstream strings;
+    size_t strings_size;
+    void *string_tree; /**< Pooled strings, by value */
+} cache_writer_t;
+
+static void CacheWrite(cache_writer_t *w, const void *data, size_t size)
+{
+    vlc_memstream_write(&w->records, data, size);
+    w->records_size += size;
+}
+
+typedef struct
+{
+    const char *str;
+    uint32_t offset;
+} cache_string_t;
+
+static int CacheCompareString(const void *a, const void *b)
+{
+    const cache_string_t *sa = a, *sb = b;
+    return strcmp(sa->str, sb->str);
+}
+
+/**
+ * Adds a string to the pool, once for all its occurrences.
+ */
+static int CacheSaveString(cache_writer_t *w, const char *str,
+                           uint32_t *offset)
+{
+    if (str == NULL)
+    {
+        *offset = 0;
+        return 0;
+    }
+
+    cache_string_t *node = malloc(sizeof (*node));
+    if (unlikely(node == NULL))
+        return -1;
+    node->str = str;
+    node->offset = w->strings_size;
+
+    cache_string_t **pp = tsearch(node, &w->string_tree, CacheCompareString);
+    if (unlikely(pp == NULL))
+    {
+        free(node);
         return -1;
     }
+
+    if (*pp != node)
+        free(node); /* already pooled */
+    else
+    {
+        const size_t len = strlen(str) + 1;
+
+        if (w->strings_size > UINT32_MAX - len)
+            return -1;
+        vlc_memstream_write(&w->strings, str, len);
+        w->strings_size += len;
+    }
+
+    *offset = (*pp)->offset;
     return 0;
 }
 
+#define SAVE_IMMEDIATE( a ) \
+    CacheWrite(w, &(a), sizeof (a))
+#define SAVE_FLAG(a) \
+    do { \
+        char b = (a); \
+        SAVE_IMMEDIATE(b); \
+    } while (0)
 #define SAVE_STRING( a ) \
-    if (CacheSaveString (file, (a))) \
-        goto error
+    do { \
+        uint32_t offset; \
+        if (CacheSaveString(w, (a), &offset)) \
+            goto error; \
+        SAVE_IMMEDIATE(offset); \
+    } while (0)
 
-static int CacheSaveAlign(FILE *file, size_t align)
+/* The records start aligned within the file, so that aligning them within
+ * the records is enough. */
+static void CacheSaveAlign(cache_writer_t *w, size_t align)
 {
-    assert(align > 0);
+    assert(align > 0 && align <= CACHE_RECORDS_ALIGN);
 
-    size_t skip = (-ftell(file)) % align;
-    if (skip == 0)
-        return 0;
+    static const char zero[CACHE_RECORDS_ALIGN];
 
-    assert(((ftell(file) + skip) % align) == 0);
-    return fseek(file, skip, SEEK_CUR);
+    CacheWrite(w, zero, (-w->records_size) % align);
 }
 
 #define SAVE_ALIGNOF(t) \
-    if (CacheSaveAlign(file, alignof (t))) \
-        goto error
+    CacheSaveAlign(w, alignof (t))
 
-static int CacheSaveConfig (FILE *file, const module_config_t *cfg)
+static int CacheSaveConfig (cache_writer_t *w, const module_config_t *cfg)
 {
     SAVE_IMMEDIATE (cfg->i_type);
     SAVE_IMMEDIATE (cfg->i_short);
@@ -549,14 +791,14 @@ error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModuleConfig(cache_writer_t *w, const vlc_plugin_t *plugin)
 {
     uint16_t lines = plugin->conf.size;
 
     SAVE_IMMEDIATE (lines);
 
     for (size_t i = 0; i < lines; i++)
-        if (CacheSaveConfig(file, plugin->conf.items + i))
+        if (CacheSaveConfig(w, plugin->conf.items + i))
            goto error;
 
     return 0;
@@ -564,7 +806,7 @@ error:
     return -1;
 }
 
-static int CacheSaveModule(FILE *file, const module_t *module)
+static int CacheSaveModule(cache_writer_t *w, const module_t *module)
 {
     SAVE_STRING(module->psz_shortname);
     SAVE_STRING(module->psz_longname);
@@ -578,14 +820,89 @@ static int CacheSaveModule(FILE *file, const module_t *module)
     SAVE_STRING(module->deactivate_name);
     SAVE_STRING(module->psz_capability);
     SAVE_IMMEDIATE(module->i_score);
+    SAVE_STRING(module->psz_hints);
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheSavePlugin(cache_writer_t *w, const vlc_plugin_t *plugin)
+{
+    uint32_t count = plugin->modules_count;
+
+    SAVE_IMMEDIATE(count);
+
+    for (module_t *module = plugin->module;
+         module != NULL;
+         module = module->next)
+        if (CacheSaveModule(w, module))
+            goto error;
+
+    /* Config stuff */
+    if (CacheSaveModuleConfig(w, plugin))
+        goto error;
+
+    /* Save common info */
+    SAVE_STRING(plugin->textdomain);
+    SAVE_STRING(plugin->path);
+    SAVE_FLAG(plugin->unloadable);
+    SAVE_IMMEDIATE(plugin->mtime);
+    SAVE_IMMEDIATE(plugin->size);
     return 0;
 error:
     return -1;
 }
 
+static int CacheComparePlugin(const void *a, const void *b)
+{
+    const vlc_plugin_t *const *pa = a, *const *pb = b;
+    return strcmp((*pa)->path, (*pb)->path);
+}
+
+static int CacheWritePad(FILE *file, size_t align)
+{
+    long pos = ftell(file);
+    if (pos < 0)
+        return -1;
+
+    for (size_t skip = (-(size_t)pos) % align; skip > 0; skip--)
+        if (fputc(0, file) == EOF)
+            return -1;
+    return 0;
+}
+
 static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 {
     uint32_t i_file_size = 0;
+    cache_writer_t w = { .records_size = 0, .strings_size = 1 };
+    vlc_plugin_t **sorted = vlc_alloc(n, sizeof (*sorted));
+    struct cache_entry *entries = vlc_alloc(n, sizeof (*entries));
+    int ret = -1;
+
+    vlc_memstream_open(&w.records);
+    vlc_memstream_open(&w.strings);
+    vlc_memstream_putc(&w.strings, '\0'); /* offset 0 is NULL */
+
+    if (unlikely(sorted == NULL || entries == NULL))
+        goto error;
+
+    /* Entries are sorted for lookup, and their paths pooled first */
+    memcpy(sorted, cache, n * sizeof (*sorted));
+    qsort(sorted, n, sizeof (*sorted), CacheComparePlugin);
+
+    for (size_t i = 0; i < n; i++)
+        if (CacheSaveString(&w, sorted[i]->path, &entries[i].path))
+            goto error;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        CacheSaveAlign(&w, CACHE_RECORDS_ALIGN);
+        entries[i].offset = w.records_size;
+        if (CacheSavePlugin(&w, sorted[i]))
+            goto error;
+        entries[i].size = w.records_size - entries[i].offset;
+        entries[i].reserved = 0;
+    }
 
     /* Contains version number */
     if (fputs (CACHE_STRING, file) == EOF)
@@ -606,37 +923,55 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1)
         goto error;
 
-    for (size_t i = 0; i < n; i++)
-    {
-        const vlc_plugin_t *plugin = cache[i];
-        uint32_t count = plugin->modules_count;
+    if (vlc_memstream_flush(&w.records) || vlc_memstream_flush(&w.strings)
+     || w.records.length != w.records_size
+     || w.strings.length != w.strings_size)
+        goto error;
 
-        SAVE_IMMEDIATE(count);
+    /* Index */
+    if (CacheWritePad(file, CACHE_INDEX_ALIGN))
+        goto error;
 
-        for (module_t *module = plugin->module;
-             module != NULL;
-             module = module->next)
-            if (CacheSaveModule(file, module))
-                goto error;
+    const uint64_t entries_off = ftell(file) + sizeof (struct cache_index);
+    const uint64_t strings_off = entries_off + n * sizeof (*entries);
+    const uint64_t records_off = (strings_off + w.strings.length
+                                  + CACHE_RECORDS_ALIGN - 1)
+                                 & ~(uint64_t)(CACHE_RECORDS_ALIGN - 1);
+    const uint64_t size = records_off + w.records.length;
 
-        /* Config stuff */
-        if (CacheSaveModuleConfig(file, plugin))
-            goto error;
+    if (size > UINT32_MAX)
+        goto error;
 
-        /* Save common info */
-        SAVE_STRING(plugin->textdomain);
-        SAVE_STRING(plugin->path);
-        SAVE_FLAG(plugin->unloadable);
-        SAVE_IMMEDIATE(plugin->mtime);
-        SAVE_IMMEDIATE(plugin->size);
-    }
+    struct cache_index index = {
+        .plugins = n,
+        .strings = strings_off,
+        .strings_size = w.strings.length,
+        .size = size,
+    };
+
+    for (size_t i = 0; i < n; i++)
+        entries[i].offset += records_off;
+
+    if (fwrite(&index, sizeof (index), 1, file) != 1
+     || fwrite(entries, sizeof (*entries), n, file) != n
+     || fwrite(w.strings.ptr, 1, w.strings.length, file) != w.strings.length
+     || CacheWritePad(file, CACHE_RECORDS_ALIGN)
+     || fwrite(w.records.ptr, 1, w.records.length, file) != w.records.length)
+        goto error;
 
     if (fflush (file)) /* flush libc buffers */
         goto error;
-    return 0; /* success! */
+    ret = 0; /* success! */
 
 error:
-    return -1;
+    tdestroy(w.string_tree, free);
+    if (vlc_memstream_close(&w.strings) == 0)
+        free(w.strings.ptr);
+    if (vlc_memstream_close(&w.records) == 0)
+        free(w.records.ptr);
+    free(entries);
+    free(sorted);
+    return ret;
 }
 
 /**
@@ -685,26 +1020,4 @@ out:
     free (filename);
     free (tmpname);
 }
-
-/**
- * Looks up a plugin file in a table of cached plugins.
- */
-vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **cache, const char *path)
-{
-    vlc_plugin_t **pp = cache, *plugin;
-
-    while ((plugin = *pp) != NULL)
-    {
-        if (plugin->path != NULL && !strcmp(plugin->path, path))
-        {
-            *pp = plugin->next;
-            plugin->next = NULL;
-            return plugin;
-        }
-
-        pp = &plugin->next;
-    }
-
-    return NULL;
-}
 #endif /* HAVE_DYNAMIC_PLUGINS */
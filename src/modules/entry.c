@@ -69,6 +69,7 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->i_shortcuts = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
+    module->psz_hints = NULL;
     module->activate_name = NULL;
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
@@ -107,6 +108,7 @@ vlc_plugin_t *vlc_plugin_create(void)
     plugin->abspath = NULL;
     plugin->unloadable = true;
     atomic_init(&plugin->handle, 0);
+    atomic_init(&plugin->broken, false);
     plugin->abspath = NULL;
     plugin->path = NULL;
 #endif
@@ -314,6 +316,10 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             plugin->textdomain = va_arg(ap, const char *);
             break;
 
+        case VLC_MODULE_PROBE_HINTS:
+            module->psz_hints = va_arg (ap, const char *);
+            break;
+
         case VLC_CONFIG_NAME:
         {
             const char *name = va_arg (ap, const char *);
@@ -126,29 +126,54 @@ static int module_load(vlc_logger_t *log, module_t *m,
     return ret;
 }
 
+static bool module_match_hint(const module_t *m, const char *hint)
+{
+    const char *hints = m->psz_hints;
+    size_t len = strlen(hint);
+
+    if (hints == NULL)
+        return false;
+
+    while (*hints)
+    {
+        size_t tlen = strcspn(hints, ",");
+
+        if (tlen == len && strncasecmp(hints, hint, len) == 0)
+            return true;
+        hints += tlen;
+        hints += strspn(hints, ",");
+    }
+    return false;
+}
+
 /**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
- *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
+ * Moves the candidates whose hints match to the front of the list, keeping
+ * the score order otherwise.
  */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+static void module_sort_hint(module_t **mods, size_t total, const char *hint)
+{
+    module_t **sorted = vlc_alloc(total, sizeof (*sorted));
+    if (unlikely(sorted == NULL))
+        return; /* not fatal, only slower */
+
+    size_t n = 0;
+    for (size_t i = 0; i < total; i++)
+        if (module_match_hint(mods[i], hint))
+            sorted[n++] = mods[i];
+    if (n > 0)
+    {
+        for (size_t i = 0; i < total; i++)
+            if (!module_match_hint(mods[i], hint))
+                sorted[n++] = mods[i];
+        memcpy(mods, sorted, total * sizeof (*mods));
+    }
+    free(sorted);
+}
+
+static module_t *vlc_module_vload(struct vlc_logger *log,
+                                  const char *capability, const char *name,
+                                  const char *hint, bool strict,
+                                  vlc_activate_t probe, va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -166,10 +191,11 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
         return NULL;
     }
 
+    if (hint != NULL && hint[0] != '\0')
+        module_sort_hint(mods, total, hint);
+
     module_t *module = NULL;
-    va_list args;
 
-    va_start(args, probe);
     while (*name)
     {
         const char *shortcut = name;
@@ -224,7 +250,6 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
         }
     }
 done:
-    va_end (args);
     module_list_free (mods);
 
     if (module != NULL)
@@ -235,6 +260,61 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vload(log, capability, name, NULL, strict,
+                                        probe, args);
+    va_end(args);
+    return module;
+}
+
+/**
+ * Finds and instantiates the best module of a certain type, as
+ * vlc_module_load(), trying first the modules that declared the given hint
+ * with set_probe_hints(). The hints are read from the plugins cache, so the
+ * plugins that are unlikely to match do not need to be loaded.
+ *
+ * \param hint lower case file extension, MIME type... (or NULL)
+ */
+module_t *vlc_module_load_hinted(struct vlc_logger *log,
+                                 const char *capability, const char *name,
+                                 const char *hint, bool strict,
+                                 vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_vload(log, capability, name, hint, strict,
+                                        probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
@@ -24,6 +24,7 @@
 # define LIBVLC_MODULES_H 1
 
 # include <stdatomic.h>
+# include <vlc_modules.h>
 
 /** VLC plugin */
 typedef struct vlc_plugin_t
@@ -48,6 +49,7 @@ typedef struct vlc_plugin_t
 #ifdef HAVE_DYNAMIC_PLUGINS
     bool unloadable; /**< Whether the plug-in can be unloaded safely */
     atomic_uintptr_t handle; /**< Run-time linker handle (or nul) */
+    atomic_bool broken; /**< Whether loading already failed */
     char *abspath; /**< Absolute path */
 
     char *path; /**< Relative path (within plug-in directory) */
@@ -90,6 +92,7 @@ struct module_t
 
     const char *psz_capability;                              /**< Capability */
     int      i_score;                          /**< Score for the capability */
+    const char *psz_hints;          /**< Probe hints, comma-separated (or NULL) */
 
     /* Callbacks */
     const char *activate_name;
@@ -115,6 +118,10 @@ void *module_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
 
 ssize_t module_list_cap (module_t ***, const char *);
 
+module_t *vlc_module_load_hinted(struct vlc_logger *, const char *cap,
+                                 const char *name, const char *hint,
+                                 bool strict, vlc_activate_t probe, ...);
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
@@ -162,8 +169,12 @@ void *vlc_dlsym(void *handle, const char *) VLC_USED;
 char *vlc_dlerror(void) VLC_USED;
 
 /* Plugins cache */
-vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
-vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
+typedef struct vlc_plugin_cache vlc_plugin_cache_t;
+
+vlc_plugin_cache_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
+vlc_plugin_t *vlc_cache_lookup(vlc_plugin_cache_t *, const char *relpath);
+vlc_plugin_t *vlc_cache_next(vlc_plugin_cache_t *);
+void vlc_cache_release(vlc_plugin_cache_t *);
 
 void CacheSave(vlc_object_t *, const char *, vlc_plugin_t *const *, size_t);
 
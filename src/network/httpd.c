@@ -29,6 +29,7 @@
 #include <stdatomic.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_httpd.h>
 
 #include <assert.h>
@@ -68,8 +69,11 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* maximum number of stream chunks sent at once to a client */
+#define HTTPD_CL_CHUNKS 16
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_AppendData(httpd_stream_t *stream, block_t *p_block);
 
 /* each host run in his own thread */
 struct httpd_host_t
@@ -137,6 +141,24 @@ enum
     HTTPD_CLIENT_TLS_HS_OUT
 };
 
+/* Stream data, shared by all the clients of the stream */
+typedef struct
+{
+    vlc_atomic_rc_t rc;
+    int64_t  i_pos;     /* absolute position of the first byte */
+    size_t   i_size;
+    const uint8_t *p_data;
+    block_t *p_block;   /* owner of the data */
+} httpd_chunk_t;
+
+static void httpd_ChunkRelease(httpd_chunk_t *chunk)
+{
+    if (vlc_atomic_rc_dec(&chunk->rc)) {
+        block_Release(chunk->p_block);
+        free(chunk);
+    }
+}
+
 struct httpd_client_t
 {
     httpd_url_t *url;
@@ -162,6 +184,11 @@ struct httpd_client_t
      */
     int64_t i_keyframe_wait_to_pass;
 
+    /* stream data being sent, see httpd_StreamCallBack() */
+    httpd_chunk_t *chunks[HTTPD_CL_CHUNKS];
+    unsigned i_chunks;
+    size_t   i_chunk_offset; /* bytes of chunks[0] already sent */
+
     /* */
     httpd_message_t query;  /* client -> httpd */
     httpd_message_t answer; /* httpd -> client */
@@ -607,9 +634,15 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* Queue of the last chunks, from the oldest to the newest. The clients
+     * hold the chunks they are sending, so that the data is never copied
+     * per client. */
+    httpd_chunk_t **pp_chunks;      /* circular, i_chunks_alloc entries */
+    size_t      i_chunks_alloc;     /* power of two */
+    size_t      i_chunks_first;
+    size_t      i_chunks;
+    size_t      i_buffer_size;      /* maximum size of the queued chunks */
+    size_t      i_buffer_used;      /* size of the queued chunks */
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -618,6 +651,29 @@ struct httpd_stream_t
     httpd_header * p_http_headers;
 };
 
+static httpd_chunk_t *httpd_StreamChunk(const httpd_stream_t *stream, size_t i)
+{
+    return stream->pp_chunks[(stream->i_chunks_first + i)
+                             & (stream->i_chunks_alloc - 1)];
+}
+
+/* Index of the first chunk ending after pos (i_chunks if none) */
+static size_t httpd_StreamFindChunk(const httpd_stream_t *stream, int64_t pos)
+{
+    size_t lo = 0, hi = stream->i_chunks;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const httpd_chunk_t *chunk = httpd_StreamChunk(stream, mid);
+
+        if (chunk->i_pos + (int64_t)chunk->i_size <= pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -628,45 +684,55 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
-
-        if (answer->i_body_offset >= stream->i_buffer_pos)
+        vlc_mutex_lock(&stream->lock);
+        if (answer->i_body_offset >= stream->i_buffer_pos) {
+            vlc_mutex_unlock(&stream->lock);
             return VLC_EGENERIC;    /* wait, no data available */
+        }
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
-            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass) {
                 /* still waiting for the next keyframe */
+                vlc_mutex_unlock(&stream->lock);
                 return VLC_EGENERIC;
+            }
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
+        if (answer->i_body_offset
+          < stream->i_buffer_pos - (int64_t)stream->i_buffer_used)
             answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
 
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
+        /* Hand the chunks over to the client, see httpd_ClientSendChunks() */
+        assert(cl->i_chunks == 0);
+        for (size_t i = httpd_StreamFindChunk(stream, answer->i_body_offset);
+             i < stream->i_chunks && cl->i_chunks < HTTPD_CL_CHUNKS; i++) {
+            httpd_chunk_t *chunk = httpd_StreamChunk(stream, i);
+
+            vlc_atomic_rc_inc(&chunk->rc);
+            cl->chunks[cl->i_chunks++] = chunk;
+        }
 
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
+        if (cl->i_chunks == 0) {
+            vlc_mutex_unlock(&stream->lock);
             return VLC_EGENERIC;    /* wait, no data available */
+        }
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
+        const httpd_chunk_t *last = cl->chunks[cl->i_chunks - 1];
+        cl->i_chunk_offset = answer->i_body_offset - cl->chunks[0]->i_pos;
+        answer->i_body_offset = last->i_pos + last->i_size;
+        vlc_mutex_unlock(&stream->lock);
 
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
-
-        answer->i_body_offset += i_write;
+        answer->i_body = 0;
+        answer->p_body = NULL;
 
         return VLC_SUCCESS;
     } else {
@@ -765,7 +831,12 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_header = 0;
     stream->p_header = NULL;
     stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
-    stream->p_buffer = xmalloc(stream->i_buffer_size);
+    stream->i_buffer_used = 0;
+    stream->i_chunks_alloc = 64;
+    stream->i_chunks_first = 0;
+    stream->i_chunks = 0;
+    stream->pp_chunks = xmalloc(stream->i_chunks_alloc
+                                * sizeof (*stream->pp_chunks));
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
     stream->i_buffer_pos = 1;
@@ -801,28 +872,64 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+/* Queues a block, without copying its data */
+static void httpd_AppendData(httpd_stream_t *stream, block_t *p_block)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
+    const size_t i_data = p_block->i_buffer;
 
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
+    if (i_data == 0) {
+        block_Release(p_block);
+        return;
+    }
 
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+    httpd_chunk_t *chunk = xmalloc(sizeof (*chunk));
+
+    vlc_atomic_rc_init(&chunk->rc);
+    chunk->i_pos = stream->i_buffer_pos;
+    chunk->i_size = i_data;
+    chunk->p_data = p_block->p_buffer;
+    chunk->p_block = p_block;
+
+    if (stream->i_chunks == stream->i_chunks_alloc) {
+        /* grow and unwrap the queue */
+        size_t alloc = stream->i_chunks_alloc * 2;
+        httpd_chunk_t **pp_chunks = xmalloc(alloc * sizeof (*pp_chunks));
+
+        for (size_t i = 0; i < stream->i_chunks; i++)
+            pp_chunks[i] = httpd_StreamChunk(stream, i);
+        free(stream->pp_chunks);
+        stream->pp_chunks = pp_chunks;
+        stream->i_chunks_alloc = alloc;
+        stream->i_chunks_first = 0;
     }
 
+    stream->pp_chunks[(stream->i_chunks_first + stream->i_chunks++)
+                      & (stream->i_chunks_alloc - 1)] = chunk;
+    stream->i_buffer_used += i_data;
     stream->i_buffer_pos += i_data;
+
+    /* drop the oldest chunks, the clients that still send them hold them */
+    while (stream->i_buffer_used > stream->i_buffer_size
+        && stream->i_chunks > 1) {
+        httpd_chunk_t *oldest = httpd_StreamChunk(stream, 0);
+
+        stream->i_chunks_first = (stream->i_chunks_first + 1)
+                               & (stream->i_chunks_alloc - 1);
+        stream->i_chunks--;
+        stream->i_buffer_used -= oldest->i_size;
+        httpd_ChunkRelease(oldest);
+    }
 }
 
-int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
+int httpd_StreamSendBlock(httpd_stream_t *stream, block_t *p_block)
 {
-    if (!p_block || !p_block->p_buffer)
+    if (!p_block)
+        return VLC_SUCCESS;
+
+    if (!p_block->p_buffer) {
+        block_Release(p_block);
         return VLC_SUCCESS;
+    }
 
     vlc_mutex_lock(&stream->lock);
 
@@ -834,12 +941,26 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
         stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
     }
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+    httpd_AppendData(stream, p_block);
 
     vlc_mutex_unlock(&stream->lock);
     return VLC_SUCCESS;
 }
 
+int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
+{
+    if (!p_block || !p_block->p_buffer)
+        return VLC_SUCCESS;
+
+    block_t *p_copy = block_Alloc(p_block->i_buffer);
+    if (unlikely(p_copy == NULL))
+        return VLC_ENOMEM;
+
+    memcpy(p_copy->p_buffer, p_block->p_buffer, p_block->i_buffer);
+    p_copy->i_flags = p_block->i_flags;
+    return httpd_StreamSendBlock(stream, p_copy);
+}
+
 void httpd_StreamDelete(httpd_stream_t *stream)
 {
     httpd_UrlDelete(stream->url);
@@ -851,7 +972,9 @@ void httpd_StreamDelete(httpd_stream_t *stream)
     vlc_mutex_destroy(&stream->lock);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
+    for (size_t i = 0; i < stream->i_chunks; i++)
+        httpd_ChunkRelease(httpd_StreamChunk(stream, i));
+    free(stream->pp_chunks);
     free(stream);
 }
 
@@ -1174,6 +1297,7 @@ static void httpd_ClientInit(httpd_client_t *cl, vlc_tick_t now)
     cl->i_buffer = 0;
     cl->p_buffer = xmalloc(cl->i_buffer_size);
     cl->i_keyframe_wait_to_pass = -1;
+    cl->i_chunks = 0;
     cl->b_stream_mode = false;
 
     httpd_MsgInit(&cl->query);
@@ -1197,6 +1321,8 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
+    for (unsigned i = 0; i < cl->i_chunks; i++)
+        httpd_ChunkRelease(cl->chunks[i]);
     free(cl->p_buffer);
     free(cl);
 }
@@ -1537,10 +1663,75 @@ static void httpd_ClientRecv(httpd_client_t *cl)
         cl->i_activity_timeout = 0;
 }
 
+static bool httpd_NetWouldBlock(void)
+{
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN;
+#endif
+}
+
+/* Asks the callback for more body data, after the previous was sent */
+static void httpd_ClientCatchBody(httpd_client_t *cl)
+{
+    int     i_msg = cl->query.i_type;
+    int64_t i_offset = cl->answer.i_body_offset;
+
+    httpd_MsgClean(&cl->answer);
+    cl->answer.i_body_offset = i_offset;
+
+    cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
+                              &cl->answer, &cl->query);
+}
+
+/* Sends the shared stream chunks, in a single call */
+static void httpd_ClientSendChunks(httpd_client_t *cl)
+{
+    struct iovec iov[HTTPD_CL_CHUNKS];
+
+    for (unsigned i = 0; i < cl->i_chunks; i++) {
+        size_t offset = i ? 0 : cl->i_chunk_offset;
+
+        iov[i].iov_base = (void *)(cl->chunks[i]->p_data + offset);
+        iov[i].iov_len = cl->chunks[i]->i_size - offset;
+    }
+
+    ssize_t val = cl->sock->ops->writev(cl->sock, iov, cl->i_chunks);
+    if (val <= 0) {
+        if (val == 0 || !httpd_NetWouldBlock())
+            cl->i_state = HTTPD_CLIENT_DEAD; /* error */
+        return;
+    }
+
+    size_t sent = val;
+    unsigned done = 0;
+
+    while (done < cl->i_chunks && sent >= iov[done].iov_len) {
+        sent -= iov[done].iov_len;
+        httpd_ChunkRelease(cl->chunks[done++]);
+    }
+    memmove(cl->chunks, cl->chunks + done,
+            (cl->i_chunks - done) * sizeof (cl->chunks[0]));
+    cl->i_chunks -= done;
+    cl->i_chunk_offset = done ? sent : cl->i_chunk_offset + sent;
+
+    if (cl->i_chunks == 0) {
+        httpd_ClientCatchBody(cl);
+        if (cl->i_chunks == 0)
+            cl->i_state = HTTPD_CLIENT_SEND_DONE;
+    }
+}
+
 static void httpd_ClientSend(httpd_client_t *cl)
 {
     int i_len;
 
+    if (cl->i_chunks > 0) {
+        httpd_ClientSendChunks(cl);
+        return;
+    }
+
     if (cl->i_buffer < 0) {
         /* We need to create the header */
         int i_size = 0;
@@ -1578,17 +1769,9 @@ static void httpd_ClientSend(httpd_client_t *cl)
         cl->i_buffer += i_len;
 
         if (cl->i_buffer >= cl->i_buffer_size) {
-            if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
+            if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0)
                 /* catch more body data */
-                int     i_msg = cl->query.i_type;
-                int64_t i_offset = cl->answer.i_body_offset;
-
-                httpd_MsgClean(&cl->answer);
-                cl->answer.i_body_offset = i_offset;
-
-                cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                                          &cl->answer, &cl->query);
-            }
+                httpd_ClientCatchBody(cl);
 
             if (cl->answer.i_body > 0) {
                 /* send the body data */
@@ -1599,15 +1782,11 @@ static void httpd_ClientSend(httpd_client_t *cl)
 
                 cl->answer.i_body = 0;
                 cl->answer.p_body = NULL;
-            } else /* send finished */
+            } else if (cl->i_chunks == 0) /* send finished */
                 cl->i_state = HTTPD_CLIENT_SEND_DONE;
         }
     } else {
-#if defined(_WIN32)
-        if ((i_len < 0 && WSAGetLastError() != WSAEWOULDBLOCK) || (i_len == 0))
-#else
-        if ((i_len < 0 && errno != EAGAIN) || (i_len == 0))
-#endif
+        if ((i_len < 0 && !httpd_NetWouldBlock()) || (i_len == 0))
         {
             /* error */
             cl->i_state = HTTPD_CLIENT_DEAD;
@@ -92,6 +92,17 @@ vlc_player_input_UpdateTime(struct vlc_player_input *input)
 int
 vlc_player_input_Start(struct vlc_player_input *input)
 {
+    if (input->started)
+    {
+        /* Preloaded input: it is already opened and paused */
+        if (input->player->start_paused)
+            return VLC_SUCCESS;
+
+        vlc_value_t val = { .i_int = PLAYING_S };
+        return input_ControlPushHelper(input->thread, INPUT_CONTROL_SET_STATE,
+                                       &val);
+    }
+
     int ret = input_Start(input->thread);
     if (ret != VLC_SUCCESS)
         return ret;
@@ -437,6 +448,8 @@ vlc_player_input_HandleEsEvent(struct vlc_player_input *input,
             }
             vlc_player_SendEvent(player, on_track_list_changed,
                                  VLC_PLAYER_LIST_ADDED, &trackpriv->t);
+            if (input != player->input)
+                break; /* preloaded input */
             switch (ev->fmt->i_cat)
             {
                 case VIDEO_ES:
@@ -554,7 +567,8 @@ vlc_player_input_HandleTitleEvent(struct vlc_player_input *input,
             {
                 vlc_player_SendEvent(player, on_title_selection_changed,
                                      &input->titles->array[0], 0);
-                if (input->ml.states.current_title >= 0 &&
+                if (input == player->input &&
+                    input->ml.states.current_title >= 0 &&
                     (size_t)input->ml.states.current_title < ev->list.count)
                 {
                     vlc_player_SelectTitleIdx(player, input->ml.states.current_title);
@@ -628,6 +642,7 @@ vlc_player_input_HandleVoutEvent(struct vlc_player_input *input,
     {
         case VLC_INPUT_EVENT_VOUT_ADDED:
             trackpriv->vout = ev->vout;
+            trackpriv->vout_order = ev->order;
             vlc_player_SendEvent(player, on_vout_changed,
                                  VLC_PLAYER_VOUT_STARTED, ev->vout,
                                  ev->order, ev->id);
@@ -646,6 +661,7 @@ vlc_player_input_HandleVoutEvent(struct vlc_player_input *input,
             }
 
             trackpriv->vout = NULL;
+            trackpriv->vout_order = VLC_VOUT_ORDER_NONE;
             vlc_player_SendEvent(player, on_vout_changed,
                                  VLC_PLAYER_VOUT_STOPPED, ev->vout,
                                  VLC_VOUT_ORDER_NONE, ev->id);
@@ -655,6 +671,124 @@ vlc_player_input_HandleVoutEvent(struct vlc_player_input *input,
     }
 }
 
+/* Keep the state of a preloaded input up to date without notifying the
+ * listeners: they are notified when it becomes the current input */
+static void
+vlc_player_input_HandlePreloadEvent(struct vlc_player_input *input,
+                                    const struct vlc_input_event *event)
+{
+    vlc_player_t *player = input->player;
+
+    player->events_muted = true;
+    switch (event->type)
+    {
+        case INPUT_EVENT_RATE:
+            input->rate = event->rate;
+            break;
+        case INPUT_EVENT_CAPABILITIES:
+            input->capabilities = event->capabilities;
+            break;
+        case INPUT_EVENT_TIMES:
+            if (event->times.ms != VLC_TICK_INVALID)
+            {
+                input->time = event->times.ms;
+                input->position = event->times.percentage;
+            }
+            input->length = event->times.length;
+            input->normal_time = event->times.normal_time;
+            break;
+        case INPUT_EVENT_PROGRAM:
+            vlc_player_input_HandleProgramEvent(input, &event->program);
+            break;
+        case INPUT_EVENT_ES:
+            vlc_player_input_HandleEsEvent(input, &event->es);
+            break;
+        case INPUT_EVENT_TITLE:
+            vlc_player_input_HandleTitleEvent(input, &event->title);
+            break;
+        case INPUT_EVENT_CHAPTER:
+            vlc_player_input_HandleChapterEvent(input, &event->chapter);
+            break;
+        case INPUT_EVENT_CACHE:
+            input->cache = event->cache;
+            break;
+        case INPUT_EVENT_VOUT:
+            vlc_player_input_HandleVoutEvent(input, &event->vout);
+            break;
+        case INPUT_EVENT_DEAD:
+            if (input->titles)
+            {
+                vlc_player_title_list_Release(input->titles);
+                input->titles = NULL;
+            }
+            input->state = VLC_PLAYER_STATE_STOPPED;
+            vlc_player_destructor_AddPreloadInput(player, input);
+            break;
+        default:
+            break;
+    }
+    player->events_muted = false;
+}
+
+void
+vlc_player_input_Promote(struct vlc_player_input *input)
+{
+    vlc_player_t *player = input->player;
+
+    assert(input == player->input);
+    atomic_store(&input->preloading, false);
+
+    /* Send the events that were muted while preloading */
+    vlc_player_SendEvent(player, on_capabilities_changed, 0,
+                         input->capabilities);
+    if (input->length != VLC_TICK_INVALID)
+        vlc_player_SendEvent(player, on_length_changed, input->length);
+
+    struct vlc_player_program *prgm;
+    vlc_vector_foreach(prgm, &input->program_vector)
+    {
+        vlc_player_SendEvent(player, on_program_list_changed,
+                             VLC_PLAYER_LIST_ADDED, prgm);
+        if (prgm->selected)
+            vlc_player_SendEvent(player, on_program_selection_changed,
+                                 -1, prgm->group_id);
+    }
+
+    static const enum es_format_category_e cats[] = {
+        VIDEO_ES, AUDIO_ES, SPU_ES
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(cats); ++i)
+    {
+        vlc_player_track_vector *vec =
+            vlc_player_input_GetTrackVector(input, cats[i]);
+        struct vlc_player_track_priv *trackpriv;
+        vlc_vector_foreach(trackpriv, vec)
+        {
+            vlc_player_SendEvent(player, on_track_list_changed,
+                                 VLC_PLAYER_LIST_ADDED, &trackpriv->t);
+            if (trackpriv->t.selected)
+                vlc_player_SendEvent(player, on_track_selection_changed,
+                                     NULL, trackpriv->t.es_id);
+            if (trackpriv->vout)
+                vlc_player_SendEvent(player, on_vout_changed,
+                                     VLC_PLAYER_VOUT_STARTED, trackpriv->vout,
+                                     trackpriv->vout_order,
+                                     trackpriv->t.es_id);
+        }
+    }
+
+    if (input->teletext_menu)
+        vlc_player_SendEvent(player, on_teletext_menu_changed, true);
+
+    if (input->titles)
+    {
+        vlc_player_SendEvent(player, on_titles_changed, input->titles);
+        vlc_player_SendEvent(player, on_title_selection_changed,
+                             &input->titles->array[input->title_selected],
+                             input->title_selected);
+    }
+}
+
 static void
 input_thread_Events(input_thread_t *input_thread,
                     const struct vlc_input_event *event, void *user_data)
@@ -667,6 +801,9 @@ input_thread_Events(input_thread_t *input_thread,
     /* No player lock for this event */
     if (event->type == INPUT_EVENT_OUTPUT_CLOCK)
     {
+        if (atomic_load(&input->preloading))
+            return;
+
         if (event->output_clock.system_ts != VLC_TICK_INVALID)
         {
             const struct vlc_player_timer_point point = {
@@ -693,6 +830,13 @@ input_thread_Events(input_thread_t *input_thread,
 
     vlc_mutex_lock(&player->lock);
 
+    if (atomic_load(&input->preloading))
+    {
+        vlc_player_input_HandlePreloadEvent(input, event);
+        vlc_mutex_unlock(&player->lock);
+        return;
+    }
+
     switch (event->type)
     {
         case INPUT_EVENT_STATE:
@@ -835,6 +979,7 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
 
     input->player = player;
     input->started = false;
+    atomic_init(&input->preloading, false);
 
     input->state = VLC_PLAYER_STATE_STOPPED;
     input->error = VLC_PLAYER_ERROR_NONE;
@@ -65,6 +65,63 @@ vlc_player_PrepareNextMedia(vlc_player_t *player)
     player->next_media_requested = true;
 }
 
+static void
+vlc_player_ReleaseNextMedia(vlc_player_t *player)
+{
+    if (player->next_media)
+    {
+        input_item_Release(player->next_media);
+        player->next_media = NULL;
+    }
+    player->next_media_requested = false;
+}
+
+/* Stop the preloaded input, unless it is the one of the given media */
+static void
+vlc_player_DiscardPreload(vlc_player_t *player, input_item_t *keep)
+{
+    struct vlc_player_input *input = player->preload;
+
+    if (input == NULL || input_GetItem(input->thread) == keep)
+        return;
+
+    input_Stop(input->thread);
+    vlc_player_destructor_AddPreloadInput(player, input);
+}
+
+int
+vlc_player_PreloadNextMedia(vlc_player_t *player)
+{
+    vlc_player_assert_locked(player);
+
+    vlc_player_PrepareNextMedia(player);
+    if (player->next_media == NULL)
+        return VLC_EGENERIC;
+
+    vlc_player_DiscardPreload(player, player->next_media);
+    if (player->preload != NULL)
+        return VLC_SUCCESS;
+
+    struct vlc_player_input *input =
+        vlc_player_input_New(player, player->next_media);
+    if (input == NULL)
+        return VLC_ENOMEM;
+
+    /* Open and buffer the media, but do not play it */
+    atomic_store(&input->preloading, true);
+    var_Create(input->thread, "start-paused", VLC_VAR_BOOL);
+    var_SetBool(input->thread, "start-paused", true);
+
+    if (vlc_player_input_Start(input) != VLC_SUCCESS)
+    {
+        vlc_player_input_Delete(input);
+        return VLC_EGENERIC;
+    }
+    input->state = VLC_PLAYER_STATE_STARTED;
+    player->preload = input;
+    return VLC_SUCCESS;
+}
+
 int
 vlc_player_OpenNextMedia(vlc_player_t *player)
 {
@@ -90,16 +147,30 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
         player->media = player->next_media;
         player->next_media = NULL;
 
-        struct vlc_player_input *input = player->input =
-            vlc_player_input_New(player, player->media);
-        if (!input)
+        struct vlc_player_input *preload = player->preload;
+        if (preload != NULL
+         && input_GetItem(preload->thread) == player->media)
         {
-            input_item_Release(player->media);
-            player->media = NULL;
-            ret = VLC_ENOMEM;
+            /* The input is already opened and buffered */
+            player->preload = NULL;
+            player->input = preload;
+        }
+        else
+        {
+            vlc_player_DiscardPreload(player, NULL);
+
+            player->input = vlc_player_input_New(player, player->media);
+            if (!player->input)
+            {
+                input_item_Release(player->media);
+                player->media = NULL;
+                ret = VLC_ENOMEM;
+            }
         }
     }
     vlc_player_SendEvent(player, on_current_media_changed, player->media);
+    if (player->input && atomic_load(&player->input->preloading))
+        vlc_player_input_Promote(player->input);
     return ret;
 }
 
@@ -175,6 +246,20 @@ vlc_player_destructor_AddJoinableInput(vlc_player_t *player,
     vlc_player_destructor_AddInput(player, input);
 }
 
+void
+vlc_player_destructor_AddPreloadInput(vlc_player_t *player,
+                                      struct vlc_player_input *input)
+{
+    /* The input is deleted by the destructor thread once it is dead */
+    if (player->preload == input)
+    {
+        player->preload = NULL;
+        input->started = false;
+        vlc_list_append(&input->node, &player->destructor.preload_inputs);
+    }
+    vlc_cond_signal(&player->destructor.wait);
+}
+
 static bool vlc_player_destructor_IsEmpty(vlc_player_t *player)
 {
     return vlc_list_is_empty(&player->destructor.inputs)
@@ -192,7 +277,8 @@ vlc_player_destructor_Thread(void *data)
     /* Terminate this thread when the player is deleting (vlc_player_Delete()
      * was called) and when all input_thread_t all stopped and released. */
     while (!player->deleting
-        || !vlc_player_destructor_IsEmpty(player))
+        || !vlc_player_destructor_IsEmpty(player)
+        || !vlc_list_is_empty(&player->destructor.preload_inputs))
     {
         /* Wait for an input to stop or close. No while loop here since we want
          * to leave this code path when the player is deleting. */
@@ -211,6 +297,15 @@ vlc_player_destructor_Thread(void *data)
             input_Stop(input->thread);
         }
 
+        vlc_list_foreach(input, &player->destructor.preload_inputs, node)
+        {
+            if (input->state == VLC_PLAYER_STATE_STOPPED)
+            {
+                vlc_list_remove(&input->node);
+                vlc_player_input_Delete(input);
+            }
+        }
+
         bool keep_sout = true;
         const bool inputs_changed =
             !vlc_list_is_empty(&player->destructor.joinable_inputs);
@@ -448,7 +543,9 @@ vlc_player_SelectEsIdList(vlc_player_t *player,
     if (!input)
         return 0;
 
-    const size_t max_tracks = max_tracks_by_cat[cat];
+    size_t max_tracks = max_tracks_by_cat[cat];
+    if (cat == AUDIO_ES && var_InheritBool(player, "audio-multitrack"))
+        max_tracks = UINT_MAX;
 
     if (max_tracks == 0)
         return 0;
@@ -968,7 +1065,9 @@ vlc_player_SetCurrentMedia(vlc_player_t *player, input_item_t *media)
 
     vlc_player_CancelWaitError(player);
 
-    vlc_player_InvalidateNextMedia(player);
+    /* Keep the preloaded input if it is the one of this media */
+    vlc_player_DiscardPreload(player, media);
+    vlc_player_ReleaseNextMedia(player);
 
     if (media)
     {
@@ -1090,13 +1189,9 @@ void
 vlc_player_InvalidateNextMedia(vlc_player_t *player)
 {
     vlc_player_assert_locked(player);
-    if (player->next_media)
-    {
-        input_item_Release(player->next_media);
-        player->next_media = NULL;
-    }
-    player->next_media_requested = false;
 
+    vlc_player_DiscardPreload(player, NULL);
+    vlc_player_ReleaseNextMedia(player);
 }
 
 int
@@ -1131,9 +1226,8 @@ vlc_player_Start(vlc_player_t *player)
         if (!player->input)
             return VLC_ENOMEM;
     }
-    assert(!player->input->started);
-
-    if (player->start_paused)
+    /* The input can be already started if it was preloaded */
+    if (player->start_paused && !player->input->started)
     {
         var_Create(player->input->thread, "start-paused", VLC_VAR_BOOL);
         var_SetBool(player->input->thread, "start-paused", true);
@@ -1330,6 +1424,30 @@ vlc_player_GetTime(vlc_player_t *player)
     return vlc_player_input_GetTime(input);
 }
 
+int
+vlc_player_GetClockReference(vlc_player_t *player, vlc_tick_t *system,
+                             vlc_tick_t *ts)
+{
+    struct vlc_player_input *input = vlc_player_get_input_locked(player);
+
+    if (!input)
+        return VLC_EGENERIC;
+
+    return input_GetClockReference(input->thread, system, ts);
+}
+
+int
+vlc_player_SetClockReference(vlc_player_t *player, vlc_tick_t system,
+                             vlc_tick_t ts)
+{
+    struct vlc_player_input *input = vlc_player_get_input_locked(player);
+
+    if (!input)
+        return VLC_EGENERIC;
+
+    return input_SetClockReference(input->thread, system, ts);
+}
+
 float
 vlc_player_GetPosition(vlc_player_t *player)
 {
@@ -1437,6 +1555,13 @@ vlc_player_GetRenderer(vlc_player_t *player)
     return player->renderer;
 }
 
+void
+vlc_player_SetStreamOutput(vlc_player_t *player, const char *chain)
+{
+    vlc_player_assert_locked(player);
+    var_SetString(player, "sout", chain != NULL ? chain : "");
+}
+
 int
 vlc_player_SetAtoBLoop(vlc_player_t *player, enum vlc_player_abloop abloop)
 {
@@ -1852,6 +1977,7 @@ vlc_player_Delete(vlc_player_t *player)
 
     if (player->input)
         vlc_player_destructor_AddInput(player, player->input);
+    vlc_player_DiscardPreload(player, NULL);
 
     player->deleting = true;
     vlc_cond_signal(&player->destructor.wait);
@@ -1901,6 +2027,7 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type,
     vlc_list_init(&player->destructor.inputs);
     vlc_list_init(&player->destructor.stopping_inputs);
     vlc_list_init(&player->destructor.joinable_inputs);
+    vlc_list_init(&player->destructor.preload_inputs);
     player->media_stopped_action = VLC_PLAYER_MEDIA_STOPPED_CONTINUE;
     player->start_paused = false;
     player->pause_on_cork = false;
@@ -1918,6 +2045,8 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type,
     player->releasing_media = false;
     player->next_media_requested = false;
     player->next_media = NULL;
+    player->preload = NULL;
+    player->events_muted = false;
 
 #define VAR_CREATE(var, flag) do { \
     if (var_Create(player, var, flag) != VLC_SUCCESS) \
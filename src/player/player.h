@@ -56,6 +56,7 @@ struct vlc_player_input
     input_thread_t *thread;
     vlc_player_t *player;
     bool started;
+    atomic_bool preloading; /* opened before becoming the current input */
 
     enum vlc_player_state state;
     enum vlc_player_error error;
@@ -228,6 +229,8 @@ struct vlc_player_t
     bool releasing_media;
     bool next_media_requested;
     input_item_t *next_media;
+    struct vlc_player_input *preload;
+    bool events_muted;
 
     enum vlc_player_state global_state;
     bool started;
@@ -243,6 +246,7 @@ struct vlc_player_t
         struct vlc_list inputs;
         struct vlc_list stopping_inputs;
         struct vlc_list joinable_inputs;
+        struct vlc_list preload_inputs;
     } destructor;
 
     struct vlc_player_timer timer;
@@ -274,6 +278,8 @@ vlc_player_get_input_locked(vlc_player_t *player)
 
 #define vlc_player_SendEvent(player, event, ...) do { \
     vlc_player_listener_id *listener; \
+    if (player->events_muted) \
+        break; \
     vlc_list_foreach(listener, &player->listeners, node) \
     { \
         if (listener->cbs->event) \
@@ -314,6 +320,10 @@ void
 vlc_player_destructor_AddJoinableInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
 
+void
+vlc_player_destructor_AddPreloadInput(vlc_player_t *player,
+                                      struct vlc_player_input *input);
+
 /*
  * player_track.c
  */
@@ -394,6 +404,9 @@ vlc_player_input_GetPos(struct vlc_player_input *input);
 int
 vlc_player_input_Start(struct vlc_player_input *input);
 
+void
+vlc_player_input_Promote(struct vlc_player_input *input);
+
 void
 vlc_player_input_HandleState(struct vlc_player_input *, enum vlc_player_state,
                              vlc_tick_t state_date);
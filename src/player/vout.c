@@ -64,6 +64,12 @@ vlc_player_vout_HoldAll(vlc_player_t *player, size_t *count)
     return vouts;
 }
 
+int
+vlc_player_vout_Prepare(vlc_player_t *player)
+{
+    return input_resource_PrepareVout(player->resource);
+}
+
 vlc_player_vout_listener_id *
 vlc_player_vout_AddListener(vlc_player_t *player,
                             const struct vlc_player_vout_cbs *cbs,
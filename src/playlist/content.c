@@ -57,7 +57,7 @@ vlc_playlist_ItemsReset(vlc_playlist_t *playlist)
     vlc_playlist_state_NotifyChanges(playlist, &state);
 }
 
-static void
+void
 vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
 {
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
@@ -238,7 +238,7 @@ vlc_playlist_Clear(vlc_playlist_t *playlist)
     vlc_playlist_ItemsReset(playlist);
 }
 
-static int
+int
 vlc_playlist_MediaToItems(vlc_playlist_t *playlist, input_item_t *const media[],
                           size_t count, vlc_playlist_item_t *items[])
 {
@@ -23,11 +23,21 @@
 
 typedef struct vlc_playlist vlc_playlist_t;
 typedef struct input_item_t input_item_t;
+typedef struct vlc_playlist_item vlc_playlist_item_t;
 
 /* called by vlc_playlist_Delete() in playlist.c */
 void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist);
 
+/* called by vlc_playlist_InsertSorted() in sort.c */
+int
+vlc_playlist_MediaToItems(vlc_playlist_t *playlist, input_item_t *const media[],
+                          size_t count, vlc_playlist_item_t *items[]);
+
+/* called by vlc_playlist_InsertSorted() in sort.c (items are in place) */
+void
+vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count);
+
 /* expand an item (replace it by the given media array) */
 int
 vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
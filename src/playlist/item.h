@@ -31,6 +31,7 @@ struct vlc_playlist_item
     input_item_t *media;
     uint64_t id;
     vlc_atomic_rc_t rc;
+    bool update_pending; /**< in vlc_playlist.updated, protected by the lock */
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
@@ -130,6 +130,98 @@ vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media)
         if (index == -1)
             return;
     }
-    vlc_playlist_Notify(playlist, on_items_updated, index,
-                        &playlist->items.data[index], 1);
+    vlc_playlist_NotifyItemUpdated(playlist, index);
+}
+
+void
+vlc_playlist_NotifyItemUpdated(vlc_playlist_t *playlist, size_t index)
+{
+    vlc_playlist_AssertLocked(playlist);
+    assert(index < playlist->items.size);
+
+    vlc_playlist_item_t *item = playlist->items.data[index];
+    if (playlist->update_interval == 0
+     || !vlc_playlist_HasItemUpdatedListeners(playlist))
+    {
+        vlc_playlist_Notify(playlist, on_items_updated, index,
+                            &playlist->items.data[index], 1);
+        return;
+    }
+
+    if (item->update_pending)
+        /* already scheduled */
+        return;
+
+    if (!vlc_vector_push(&playlist->updated, item))
+    {
+        vlc_playlist_Notify(playlist, on_items_updated, index,
+                            &playlist->items.data[index], 1);
+        return;
+    }
+
+    vlc_playlist_item_Hold(item);
+    item->update_pending = true;
+
+    if (playlist->updated.size == 1)
+        vlc_timer_schedule(playlist->update_timer, false,
+                           playlist->update_interval, VLC_TIMER_FIRE_ONCE);
+}
+
+void
+vlc_playlist_FlushUpdates(vlc_playlist_t *playlist)
+{
+    vlc_playlist_AssertLocked(playlist);
+
+    if (!playlist->updated.size)
+        return;
+
+    /* the items may have moved or been removed in the meantime, so locate
+     * them all in a single pass, and report contiguous ranges in order */
+    size_t start = 0;
+    size_t len = 0;
+    for (size_t i = 0; i < playlist->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+        if (item->update_pending)
+        {
+            if (!len)
+                start = i;
+            len++;
+            continue;
+        }
+
+        if (len)
+        {
+            vlc_playlist_Notify(playlist, on_items_updated, start,
+                                &playlist->items.data[start], len);
+            len = 0;
+        }
+    }
+    if (len)
+        vlc_playlist_Notify(playlist, on_items_updated, start,
+                            &playlist->items.data[start], len);
+
+    vlc_playlist_ClearUpdates(playlist);
+}
+
+void
+vlc_playlist_ClearUpdates(vlc_playlist_t *playlist)
+{
+    vlc_playlist_item_t *item;
+    vlc_vector_foreach(item, &playlist->updated)
+    {
+        item->update_pending = false;
+        vlc_playlist_item_Release(item);
+    }
+    vlc_vector_clear(&playlist->updated);
+}
+
+void
+vlc_playlist_UpdateTimerCallback(void *data)
+{
+    vlc_playlist_t *playlist = data;
+
+    vlc_playlist_Lock(playlist);
+    vlc_playlist_FlushUpdates(playlist);
+    vlc_playlist_Unlock(playlist);
 }
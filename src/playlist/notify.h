@@ -67,4 +67,20 @@ vlc_playlist_state_NotifyChanges(vlc_playlist_t *playlist,
 void
 vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media);
 
+/* notify on_items_updated, possibly later and coalesced with other updates,
+ * if "playlist-update-interval" is not 0 */
+void
+vlc_playlist_NotifyItemUpdated(vlc_playlist_t *playlist, size_t index);
+
+/* notify the pending updates now */
+void
+vlc_playlist_FlushUpdates(vlc_playlist_t *playlist);
+
+/* drop the pending updates (called by vlc_playlist_Delete()) */
+void
+vlc_playlist_ClearUpdates(vlc_playlist_t *playlist);
+
+void
+vlc_playlist_UpdateTimerCallback(void *playlist);
+
 #endif
@@ -28,6 +28,7 @@
 
 #include "content.h"
 #include "item.h"
+#include "notify.h"
 #include "player.h"
 
 vlc_playlist_t *
@@ -53,13 +54,21 @@ vlc_playlist_New(vlc_object_t *parent)
     playlist->repeat = VLC_PLAYLIST_PLAYBACK_REPEAT_NONE;
     playlist->order = VLC_PLAYLIST_PLAYBACK_ORDER_NORMAL;
     playlist->idgen = 0;
+    vlc_vector_init(&playlist->updated);
 #ifdef TEST_PLAYLIST
     playlist->libvlc = NULL;
     playlist->auto_preparse = false;
+    playlist->update_interval = 0;
 #else
     assert(parent);
     playlist->libvlc = vlc_object_instance(parent);
     playlist->auto_preparse = var_InheritBool(parent, "auto-preparse");
+    playlist->update_interval = VLC_TICK_FROM_MS(
+            var_InheritInteger(parent, "playlist-update-interval"));
+    if (playlist->update_interval > 0
+     && vlc_timer_create(&playlist->update_timer,
+                         vlc_playlist_UpdateTimerCallback, playlist))
+        playlist->update_interval = 0;
 #endif
 
     return playlist;
@@ -70,6 +79,12 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
 {
     assert(vlc_list_is_empty(&playlist->listeners));
 
+#ifndef TEST_PLAYLIST
+    if (playlist->update_interval > 0)
+        vlc_timer_destroy(playlist->update_timer);
+#endif
+    vlc_playlist_ClearUpdates(playlist);
+
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
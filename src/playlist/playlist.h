@@ -41,6 +41,8 @@ typedef struct input_item_t input_item_t;
 # define vlc_player_SetCurrentMedia(a,b) (VLC_UNUSED(b), VLC_SUCCESS)
 # define vlc_player_InvalidateNextMedia(p) VLC_UNUSED(p)
 # define vlc_player_osd_Message(p, fmt...) VLC_UNUSED(p)
+/* updates are flushed explicitly in tests */
+# define vlc_timer_schedule(t, a, d, i) VLC_UNUSED(t)
 #endif /* TEST_PLAYLIST */
 
 typedef struct VLC_VECTOR(vlc_playlist_item_t *) playlist_item_vector_t;
@@ -61,6 +63,10 @@ struct vlc_playlist
     enum vlc_playlist_playback_repeat repeat;
     enum vlc_playlist_playback_order order;
     uint64_t idgen;
+    /* coalesced on_items_updated, see vlc_playlist_NotifyItemUpdated() */
+    vlc_tick_t update_interval; /**< 0 to notify immediately */
+    vlc_timer_t update_timer;
+    playlist_item_vector_t updated; /**< held items to notify */
 };
 
 /* Also disable vlc_assert_locked in tests since the symbol is not exported */
@@ -524,12 +524,73 @@ randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_RemoveAt(r, index);
 }
 
+/* above this number of items, remove them in a single pass */
+#define BULK_REMOVE_MIN 8
+
+static int
+randomizer_ComparePointers(const void *lhs, const void *rhs)
+{
+    uintptr_t a = (uintptr_t) *(vlc_playlist_item_t *const *) lhs;
+    uintptr_t b = (uintptr_t) *(vlc_playlist_item_t *const *) rhs;
+    return a < b ? -1 : a > b;
+}
+
+static bool
+randomizer_RemoveBulk(struct randomizer *r, vlc_playlist_item_t *const items[],
+                      size_t count)
+{
+    vlc_playlist_item_t **sorted = vlc_alloc(count, sizeof(*sorted));
+    if (unlikely(!sorted))
+        return false;
+
+    memcpy(sorted, items, count * sizeof(*sorted));
+    qsort(sorted, count, sizeof(*sorted), randomizer_ComparePointers);
+
+    /*
+     * Compact the vector, keeping the relative order of all the remaining
+     * items. The ordered parts stay ordered, and the order of the
+     * "determinated" range does not matter, so this is equivalent to removing
+     * the items one by one, in O(size * log(count)) instead of
+     * O(size * count).
+     */
+    size_t head = r->head;
+    size_t next = r->next;
+    size_t history = r->history;
+    size_t kept = 0;
+    for (size_t i = 0; i < r->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = r->items.data[i];
+        if (bsearch(&item, sorted, count, sizeof(*sorted),
+                    randomizer_ComparePointers))
+        {
+            if (i < r->head)
+                head--;
+            if (i < r->next)
+                next--;
+            if (i < r->history)
+                history--;
+        }
+        else
+            r->items.data[kept++] = item;
+    }
+    assert(r->items.size - kept == count); /* items must exist */
+
+    r->items.size = kept;
+    r->head = head;
+    r->next = next;
+    r->history = history;
+
+    free(sorted);
+    return true;
+}
+
 void
 randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
                   size_t count)
 {
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    if (count < BULK_REMOVE_MIN || !randomizer_RemoveBulk(r, items, count))
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveOne(r, items[i]);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -1209,6 +1270,84 @@ test_has_prev_next_empty(void)
     randomizer_Destroy(&randomizer);
 }
 
+static void
+test_bulk_removal_same_as_one_by_one(void)
+{
+    struct randomizer bulk;
+    randomizer_Init(&bulk);
+    randomizer_SetLoop(&bulk, true);
+
+    #define SIZE 100
+    #define REMOVED ((SIZE + 2) / 3) /* one item out of 3 */
+    vlc_playlist_item_t *items[SIZE];
+    ArrayInit(items, SIZE);
+
+    bool ok = randomizer_Add(&bulk, items, SIZE);
+    assert(ok);
+
+    /* complete a cycle and start the next one, so that all the ranges are
+     * populated */
+    for (int i = 0; i < SIZE + 30; ++i)
+    {
+        vlc_playlist_item_t *item = randomizer_Next(&bulk);
+        assert(item);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        vlc_playlist_item_t *item = randomizer_Prev(&bulk);
+        assert(item);
+    }
+
+    struct randomizer one_by_one;
+    randomizer_Init(&one_by_one);
+    randomizer_SetLoop(&one_by_one, true);
+    ok = vlc_vector_push_all(&one_by_one.items, bulk.items.data,
+                             bulk.items.size);
+    assert(ok);
+    one_by_one.head = bulk.head;
+    one_by_one.next = bulk.next;
+    one_by_one.history = bulk.history;
+
+    /* remove items everywhere: selected, not selected and in the history */
+    vlc_playlist_item_t *to_remove[REMOVED];
+    for (int i = 0; i < REMOVED; ++i)
+        to_remove[i] = items[i * 3];
+
+    randomizer_Remove(&bulk, to_remove, REMOVED);
+    for (int i = 0; i < REMOVED; ++i)
+        randomizer_Remove(&one_by_one, &to_remove[i], 1);
+
+    assert(bulk.items.size == SIZE - REMOVED);
+    assert(bulk.items.size == one_by_one.items.size);
+    assert(bulk.head == one_by_one.head);
+    assert(bulk.next == one_by_one.next);
+    assert(bulk.history == one_by_one.history);
+
+    /* the ordered parts must be the same */
+    for (size_t i = 0; i < bulk.head; ++i)
+        assert(bulk.items.data[i] == one_by_one.items.data[i]);
+    for (size_t i = bulk.history; i < bulk.items.size; ++i)
+        assert(bulk.items.data[i] == one_by_one.items.data[i]);
+
+    /* the remaining items must still be selected exactly once */
+    bool selected[SIZE] = {0};
+    randomizer_Reshuffle(&bulk);
+    for (size_t i = 0; i < bulk.items.size; ++i)
+    {
+        vlc_playlist_item_t *item = randomizer_Next(&bulk);
+        assert(item);
+        assert(item->index % 3); /* not removed */
+        assert(!selected[item->index]); /* never selected twice */
+        selected[item->index] = true;
+    }
+
+    ArrayDestroy(items, SIZE);
+    randomizer_Destroy(&one_by_one);
+    randomizer_Destroy(&bulk);
+    #undef REMOVED
+    #undef SIZE
+}
+
 int main(void)
 {
     test_all_items_selected_exactly_once();
@@ -1225,6 +1364,7 @@ int main(void)
     test_loop_respect_not_same_before();
     test_loop_respect_not_same_before_impossible();
     test_has_prev_next_empty();
+    test_bulk_removal_same_as_one_by_one();
 }
 
 #endif
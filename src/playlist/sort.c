@@ -25,6 +25,7 @@
 #include <vlc_common.h>
 #include <vlc_rand.h>
 #include <vlc_sort.h>
+#include "content.h"
 #include "control.h"
 #include "item.h"
 #include "notify.h"
@@ -403,3 +404,129 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
 
     return VLC_SUCCESS;
 }
+
+/* upper bound of meta in the (sorted) playlist items in [from, to) */
+static int
+vlc_playlist_FindSortedIndex(vlc_playlist_t *playlist,
+                             const struct vlc_playlist_item_meta *meta,
+                             struct sort_request *req, size_t from, size_t to,
+                             size_t *index)
+{
+    while (from < to)
+    {
+        size_t mid = from + (to - from) / 2;
+        struct vlc_playlist_item_meta *probe =
+            vlc_playlist_item_meta_New(playlist->items.data[mid],
+                                       req->criteria, req->count);
+        if (unlikely(!probe))
+            return VLC_ENOMEM;
+
+        int cmp = compare_meta(&meta, &probe, req);
+        vlc_playlist_item_meta_Delete(probe);
+
+        if (cmp < 0)
+            to = mid;
+        else
+            from = mid + 1;
+    }
+    *index = from;
+    return VLC_SUCCESS;
+}
+
+int
+vlc_playlist_InsertSorted(vlc_playlist_t *playlist,
+                          const struct vlc_playlist_sort_criterion criteria[],
+                          size_t criteria_count,
+                          input_item_t *const media[], size_t count)
+{
+    assert(criteria_count > 0);
+    vlc_playlist_AssertLocked(playlist);
+
+    if (!count)
+        return VLC_SUCCESS;
+
+    struct sort_request req = { criteria, criteria_count };
+    vlc_playlist_item_t **items = vlc_alloc(count, sizeof(*items));
+    struct vlc_playlist_item_meta **array = vlc_alloc(count, sizeof(*array));
+    size_t *indices = vlc_alloc(count, sizeof(*indices));
+    if (unlikely(!items || !array || !indices))
+        goto error;
+
+    if (vlc_playlist_MediaToItems(playlist, media, count, items)
+            != VLC_SUCCESS)
+        goto error;
+
+    size_t i;
+    for (i = 0; i < count; ++i)
+    {
+        array[i] = vlc_playlist_item_meta_New(items[i], criteria,
+                                              criteria_count);
+        if (unlikely(!array[i]))
+            break;
+    }
+    if (i < count)
+    {
+        vlc_playlist_DeleteMetaArray(array, i);
+        array = NULL;
+        goto error_items;
+    }
+
+    /* sort the new items only, then merge them into the playlist */
+    vlc_qsort(array, count, sizeof(*array), compare_meta, &req);
+    for (i = 0; i < count; ++i)
+        items[i] = array[i]->item;
+
+    /* the new items are sorted, so their indices are not decreasing: each
+     * binary search only needs to look after the previous one */
+    size_t from = 0;
+    for (i = 0; i < count; ++i)
+    {
+        if (vlc_playlist_FindSortedIndex(playlist, array[i], &req, from,
+                                         playlist->items.size, &indices[i])
+                != VLC_SUCCESS)
+            break;
+        from = indices[i];
+    }
+    vlc_playlist_DeleteMetaArray(array, count);
+    array = NULL;
+    if (i < count || !vlc_vector_reserve(&playlist->items,
+                                         playlist->items.size + count))
+        goto error_items;
+
+    /* merge from the end, each existing item is moved at most once */
+    size_t old_size = playlist->items.size;
+    size_t src = old_size;
+    size_t dst = old_size + count;
+    for (i = count; i > 0; --i)
+    {
+        while (src > indices[i - 1])
+            playlist->items.data[--dst] = playlist->items.data[--src];
+        playlist->items.data[--dst] = items[i - 1];
+    }
+    playlist->items.size = old_size + count;
+
+    /* notify by contiguous slices, in order, so that each slice index is
+     * valid when received */
+    for (i = 0; i < count; )
+    {
+        size_t end = i + 1;
+        while (end < count && indices[end] == indices[i])
+            ++end;
+        vlc_playlist_ItemsInserted(playlist, indices[i] + i, end - i);
+        i = end;
+    }
+    vlc_player_InvalidateNextMedia(playlist->player);
+
+    free(indices);
+    free(items);
+    return VLC_SUCCESS;
+
+error_items:
+    for (i = 0; i < count; ++i)
+        vlc_playlist_item_Release(items[i]);
+error:
+    free(array);
+    free(indices);
+    free(items);
+    return VLC_ENOMEM;
+}
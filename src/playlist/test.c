@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 #include "item.h"
+#include "notify.h"
 #include "playlist.h"
 #include "preparse.h"
 
@@ -360,6 +361,12 @@ struct items_removed_report
     struct playlist_state state;
 };
 
+struct items_updated_report
+{
+    size_t index;
+    size_t count;
+};
+
 struct playback_repeat_changed_report
 {
     enum vlc_playlist_playback_repeat repeat;
@@ -391,6 +398,7 @@ struct callback_ctx
     struct VLC_VECTOR(struct items_added_report)           vec_items_added;
     struct VLC_VECTOR(struct items_moved_report)           vec_items_moved;
     struct VLC_VECTOR(struct items_removed_report)         vec_items_removed;
+    struct VLC_VECTOR(struct items_updated_report)         vec_items_updated;
     struct VLC_VECTOR(struct playback_order_changed_report)
                                                   vec_playback_order_changed;
     struct VLC_VECTOR(struct playback_repeat_changed_report)
@@ -412,6 +420,7 @@ struct callback_ctx
     VLC_VECTOR_INITIALIZER, \
     VLC_VECTOR_INITIALIZER, \
     VLC_VECTOR_INITIALIZER, \
+    VLC_VECTOR_INITIALIZER, \
 }
 
 static inline void
@@ -421,6 +430,7 @@ callback_ctx_reset(struct callback_ctx *ctx)
     vlc_vector_clear(&ctx->vec_items_added);
     vlc_vector_clear(&ctx->vec_items_moved);
     vlc_vector_clear(&ctx->vec_items_removed);
+    vlc_vector_clear(&ctx->vec_items_updated);
     vlc_vector_clear(&ctx->vec_playback_repeat_changed);
     vlc_vector_clear(&ctx->vec_playback_order_changed);
     vlc_vector_clear(&ctx->vec_current_index_changed);
@@ -435,6 +445,7 @@ callback_ctx_destroy(struct callback_ctx *ctx)
     vlc_vector_destroy(&ctx->vec_items_added);
     vlc_vector_destroy(&ctx->vec_items_moved);
     vlc_vector_destroy(&ctx->vec_items_removed);
+    vlc_vector_destroy(&ctx->vec_items_updated);
     vlc_vector_destroy(&ctx->vec_playback_repeat_changed);
     vlc_vector_destroy(&ctx->vec_playback_order_changed);
     vlc_vector_destroy(&ctx->vec_current_index_changed);
@@ -498,6 +509,21 @@ callback_on_items_removed(vlc_playlist_t *playlist, size_t index, size_t count,
     vlc_vector_push(&ctx->vec_items_removed, report);
 }
 
+static void
+callback_on_items_updated(vlc_playlist_t *playlist, size_t index,
+                          vlc_playlist_item_t *const items[], size_t count,
+                          void *userdata)
+{
+    VLC_UNUSED(playlist);
+    VLC_UNUSED(items);
+    struct callback_ctx *ctx = userdata;
+
+    struct items_updated_report report;
+    report.index = index;
+    report.count = count;
+    vlc_vector_push(&ctx->vec_items_updated, report);
+}
+
 static void
 callback_on_playback_repeat_changed(vlc_playlist_t *playlist,
                                     enum vlc_playlist_playback_repeat repeat,
@@ -2349,6 +2375,141 @@ test_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_insert_sorted(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[8];
+    CreateDummyMediaArray(media, 8);
+
+    /* initial playlist, sorted by title */
+    input_item_t *initial[] = { media[0], media[2], media[6] };
+    int ret = vlc_playlist_Append(playlist, initial, 3);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_callbacks cbs = {
+        .on_items_added = callback_on_items_added,
+        .on_items_reset = callback_on_items_reset,
+    };
+
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    vlc_playlist_listener_id *listener =
+            vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    assert(listener);
+
+    playlist->current = 2;
+    playlist->has_prev = true;
+    playlist->has_next = false;
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+
+    input_item_t *to_insert[] = { media[5], media[1], media[7], media[4] };
+    ret = vlc_playlist_InsertSorted(playlist, criteria, 1, to_insert, 4);
+    assert(ret == VLC_SUCCESS);
+
+    assert(vlc_playlist_Count(playlist) == 7);
+    EXPECT_AT(0, 0);
+    EXPECT_AT(1, 1);
+    EXPECT_AT(2, 2);
+    EXPECT_AT(3, 4);
+    EXPECT_AT(4, 5);
+    EXPECT_AT(5, 6);
+    EXPECT_AT(6, 7);
+
+    /* the current item has not changed */
+    assert(playlist->current == 5);
+    assert(playlist->has_next);
+
+    /* one notification per contiguous slice, never a reset */
+    assert(ctx.vec_items_reset.size == 0);
+    assert(ctx.vec_items_added.size == 3);
+
+    assert(ctx.vec_items_added.data[0].index == 1);
+    assert(ctx.vec_items_added.data[0].count == 1);
+
+    assert(ctx.vec_items_added.data[1].index == 3);
+    assert(ctx.vec_items_added.data[1].count == 2);
+
+    assert(ctx.vec_items_added.data[2].index == 6);
+    assert(ctx.vec_items_added.data[2].count == 1);
+
+    callback_ctx_destroy(&ctx);
+    vlc_playlist_RemoveListener(playlist, listener);
+    DestroyMediaArray(media, 8);
+    vlc_playlist_Delete(playlist);
+}
+
+static void
+test_items_updated_coalesced(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    int ret = vlc_playlist_Append(playlist, media, 10);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_callbacks cbs = {
+        .on_items_updated = callback_on_items_updated,
+    };
+
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    vlc_playlist_listener_id *listener =
+            vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    assert(listener);
+
+    /* immediate by default */
+    vlc_playlist_NotifyItemUpdated(playlist, 2);
+    assert(ctx.vec_items_updated.size == 1);
+    assert(ctx.vec_items_updated.data[0].index == 2);
+    assert(ctx.vec_items_updated.data[0].count == 1);
+
+    callback_ctx_reset(&ctx);
+
+    /* the timer is not armed in tests, flush explicitly */
+    playlist->update_interval = VLC_TICK_FROM_MS(100);
+
+    vlc_playlist_NotifyItemUpdated(playlist, 5);
+    vlc_playlist_NotifyItemUpdated(playlist, 3);
+    vlc_playlist_NotifyItemUpdated(playlist, 9);
+    vlc_playlist_NotifyItemUpdated(playlist, 4);
+    vlc_playlist_NotifyItemUpdated(playlist, 3);
+    vlc_playlist_NotifyItemUpdated(playlist, 0);
+    assert(ctx.vec_items_updated.size == 0);
+    assert(playlist->updated.size == 5);
+
+    /* the updated items must be located after the changes */
+    vlc_playlist_Remove(playlist, 0, 1);
+
+    vlc_playlist_FlushUpdates(playlist);
+
+    assert(ctx.vec_items_updated.size == 2);
+    assert(ctx.vec_items_updated.data[0].index == 2);
+    assert(ctx.vec_items_updated.data[0].count == 3);
+    assert(ctx.vec_items_updated.data[1].index == 8);
+    assert(ctx.vec_items_updated.data[1].count == 1);
+
+    assert(playlist->updated.size == 0);
+    for (size_t i = 0; i < vlc_playlist_Count(playlist); ++i)
+        assert(!vlc_playlist_Get(playlist, i)->update_pending);
+
+    /* nothing left to report */
+    callback_ctx_reset(&ctx);
+    vlc_playlist_FlushUpdates(playlist);
+    assert(ctx.vec_items_updated.size == 0);
+
+    callback_ctx_destroy(&ctx);
+    vlc_playlist_RemoveListener(playlist, listener);
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 #undef EXPECT_AT
 
 int main(void)
@@ -2384,6 +2545,8 @@ int main(void)
     test_random();
     test_shuffle();
     test_sort();
+    test_insert_sorted();
+    test_items_updated_coalesced();
     return 0;
 }
 
@@ -23,15 +23,236 @@
 #endif
 
 #include <assert.h>
+#include <errno.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
+#include <vlc_list.h>
 #include "misc/picture.h"
 
+/*
+ * Picture arena
+ *
+ * Large picture buffers are rounded up to whole huge pages, backed by
+ * hugetlbfs if pages are reserved, or by transparent huge pages otherwise.
+ * Released buffers are kept (up to a cap) for the next allocation of the
+ * same size, so that picture pools, which are created and destroyed with
+ * each video output, decoder or filter chain, do not go through
+ * mmap/munmap and page faults again. Each buffer keeps its own memory file
+ * descriptor for the displays sharing them.
+ */
+#define ARENA_PAGE_SIZE (UINT32_C(2) << 20)
+#define ARENA_MIN_SIZE  (ARENA_PAGE_SIZE / 2)
+
+struct arena_buffer
+{
+    int fd;
+    void *base;
+    size_t size;
+    bool hugetlb;
+    struct vlc_list node;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned users;
+    size_t max_cached;
+    size_t cached;
+    struct vlc_list live; /**< buffers in use */
+    struct vlc_list free; /**< released buffers, most recent first */
+    struct picture_arena_stats stats;
+} arena = {
+    .lock = VLC_STATIC_MUTEX,
+    .live = VLC_LIST_INITIALIZER(&arena.live),
+    .free = VLC_LIST_INITIALIZER(&arena.free),
+};
+
+static void ArenaUnmap(struct arena_buffer *buf)
+{
+    munmap(buf->base, buf->size);
+    vlc_close(buf->fd);
+    free(buf);
+}
+
+static struct arena_buffer *ArenaMap(size_t size)
+{
+    struct arena_buffer *buf = malloc(sizeof (*buf));
+    if (unlikely(buf == NULL))
+        return NULL;
+
+    buf->size = size;
+    buf->hugetlb = false;
+#if defined (HAVE_MEMFD_CREATE) && defined (MFD_HUGETLB)
+    buf->fd = memfd_create(PACKAGE_NAME"-picture",
+                           MFD_CLOEXEC | MFD_ALLOW_SEALING | MFD_HUGETLB);
+    if (buf->fd != -1) {
+        /* Fails if not enough huge pages are reserved */
+        if (ftruncate(buf->fd, size) == 0) {
+            buf->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                             buf->fd, 0);
+            if (buf->base != MAP_FAILED) {
+                buf->hugetlb = true;
+                return buf;
+            }
+        }
+        vlc_close(buf->fd);
+    }
+#endif
+
+    buf->fd = vlc_memfd();
+    if (buf->fd == -1)
+        goto error;
+    if (ftruncate(buf->fd, size))
+        goto error_fd;
+
+    buf->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     buf->fd, 0);
+    if (buf->base == MAP_FAILED)
+        goto error_fd;
+#ifdef MADV_HUGEPAGE
+    madvise(buf->base, size, MADV_HUGEPAGE);
+#endif
+    return buf;
+
+error_fd:
+    vlc_close(buf->fd);
+error:
+    free(buf);
+    return NULL;
+}
+
+static void *ArenaAllocate(int *restrict fdp, size_t size)
+{
+    struct arena_buffer *buf = NULL, *cand;
+
+    size = (size + ARENA_PAGE_SIZE - 1) & ~(size_t)(ARENA_PAGE_SIZE - 1);
+
+    vlc_mutex_lock(&arena.lock);
+    vlc_list_foreach(cand, &arena.free, node)
+        if (cand->size == size) {
+            vlc_list_remove(&cand->node);
+            arena.cached -= size;
+            arena.stats.reused++;
+            buf = cand;
+            break;
+        }
+    vlc_mutex_unlock(&arena.lock);
+
+    if (buf == NULL) {
+        buf = ArenaMap(size);
+        if (buf == NULL)
+            return NULL;
+    }
+
+    vlc_mutex_lock(&arena.lock);
+    vlc_list_append(&buf->node, &arena.live);
+    arena.stats.allocated++;
+    if (buf->hugetlb)
+        arena.stats.hugetlb++;
+    arena.stats.live_bytes += size;
+    if (arena.stats.live_bytes > arena.stats.peak_bytes)
+        arena.stats.peak_bytes = arena.stats.live_bytes;
+    vlc_mutex_unlock(&arena.lock);
+
+    *fdp = buf->fd;
+    return buf->base;
+}
+
+/* Returns false if the buffer does not belong to the arena */
+static bool ArenaDeallocate(void *base)
+{
+    struct arena_buffer *buf, *found = NULL;
+    struct vlc_list evicted;
+
+    vlc_list_init(&evicted);
+    vlc_mutex_lock(&arena.lock);
+    vlc_list_foreach(buf, &arena.live, node)
+        if (buf->base == base) {
+            found = buf;
+            break;
+        }
+
+    if (found != NULL) {
+        vlc_list_remove(&found->node);
+        arena.stats.live_bytes -= found->size;
+
+        if (arena.users > 0 && found->size <= arena.max_cached) {
+            vlc_list_prepend(&found->node, &arena.free);
+            arena.cached += found->size;
+
+            /* Evict the least recently released buffers over the cap */
+            while (arena.cached > arena.max_cached) {
+                buf = vlc_list_last_entry_or_null(&arena.free,
+                                                  struct arena_buffer, node);
+                vlc_list_remove(&buf->node);
+                arena.cached -= buf->size;
+                vlc_list_append(&buf->node, &evicted);
+            }
+        } else
+            vlc_list_append(&found->node, &evicted);
+    }
+    vlc_mutex_unlock(&arena.lock);
+
+    vlc_list_foreach(buf, &evicted, node)
+        ArenaUnmap(buf);
+    return found != NULL;
+}
+
+void picture_ArenaEnable(size_t max_cached)
+{
+    vlc_mutex_lock(&arena.lock);
+    arena.users++;
+    if (max_cached > arena.max_cached)
+        arena.max_cached = max_cached;
+    vlc_mutex_unlock(&arena.lock);
+}
+
+void picture_ArenaDisable(void)
+{
+    struct arena_buffer *buf;
+    struct vlc_list evicted;
+
+    vlc_list_init(&evicted);
+    vlc_mutex_lock(&arena.lock);
+    assert(arena.users > 0);
+    if (--arena.users == 0) {
+        vlc_list_foreach(buf, &arena.free, node) {
+            vlc_list_remove(&buf->node);
+            vlc_list_append(&buf->node, &evicted);
+        }
+        arena.cached = 0;
+        arena.max_cached = 0;
+    }
+    vlc_mutex_unlock(&arena.lock);
+
+    vlc_list_foreach(buf, &evicted, node)
+        ArenaUnmap(buf);
+}
+
+void picture_ArenaGetStats(struct picture_arena_stats *stats)
+{
+    vlc_mutex_lock(&arena.lock);
+    *stats = arena.stats;
+    stats->cached_bytes = arena.cached;
+    vlc_mutex_unlock(&arena.lock);
+}
+
 void *picture_Allocate(int *restrict fdp, size_t size)
 {
+    vlc_mutex_lock(&arena.lock);
+    bool use_arena = arena.users > 0 && size >= ARENA_MIN_SIZE;
+    vlc_mutex_unlock(&arena.lock);
+
+    if (use_arena) {
+        void *base = ArenaAllocate(fdp, size);
+        if (base != NULL)
+            return base;
+    }
+
     int fd = vlc_memfd();
     if (fd == -1)
         return NULL;
@@ -52,6 +273,9 @@ error:
 
 void picture_Deallocate(int fd, void *base, size_t size)
 {
+    if (size >= ARENA_MIN_SIZE && ArenaDeallocate(base))
+        return;
+
     munmap(base, size);
     vlc_close(fd);
 }
@@ -109,7 +109,11 @@ void vlc_mutex_init( vlc_mutex_t *p_mutex )
 
     if (unlikely(pthread_mutexattr_init (&attr)))
         abort();
-#ifdef NDEBUG
+#if defined (NDEBUG) && defined (PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+    /* Spin briefly before sleeping on the futex when the lock is contended,
+     * as these mutexes are mostly held for short times (e.g. FIFOs). */
+    pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+#elif defined (NDEBUG)
     pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_DEFAULT);
 #else
     pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_ERRORCHECK);
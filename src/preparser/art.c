@@ -34,6 +34,8 @@
 #include <vlc_strings.h>
 #include <vlc_url.h>
 #include <vlc_md5.h>
+#include <vlc_image.h>
+#include <vlc_block.h>
 
 #include "art.h"
 
@@ -360,3 +362,163 @@ end:
     return VLC_SUCCESS;
 }
 
+
+static char *ArtThumbnailName( const char *psz_arturl,
+                               unsigned i_width, unsigned i_height )
+{
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_arturl, strlen( psz_arturl ) );
+    EndMD5( &md5 );
+
+    char *psz_hash = psz_md5_hash( &md5 );
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_filename = NULL;
+
+    if( likely(psz_hash && psz_cachedir) )
+    {
+        char *psz_dir;
+        if( asprintf( &psz_dir, "%s" DIR_SEP "art" DIR_SEP "thumbnails",
+                      psz_cachedir ) != -1 )
+        {
+            ArtCacheCreateDir( psz_dir );
+            if( asprintf( &psz_filename, "%s" DIR_SEP "%s-%ux%u.jpg",
+                          psz_dir, psz_hash, i_width, i_height ) == -1 )
+                psz_filename = NULL;
+            free( psz_dir );
+        }
+    }
+    free( psz_cachedir );
+    free( psz_hash );
+    return psz_filename;
+}
+
+/* Tells whether the cached thumbnail exists and is newer than the artwork */
+static bool ArtThumbnailIsValid( const char *psz_filename,
+                                 const char *psz_arturl )
+{
+    struct stat thumb;
+    if( vlc_stat( psz_filename, &thumb ) )
+        return false;
+
+    /* remote artworks are not refreshed */
+    char *psz_path = vlc_uri2path( psz_arturl );
+    if( !psz_path )
+        return true;
+
+    struct stat art;
+    bool b_valid = vlc_stat( psz_path, &art ) || art.st_mtime <= thumb.st_mtime;
+    free( psz_path );
+    return b_valid;
+}
+
+static int ArtThumbnailSave( vlc_object_t *obj, const char *psz_filename,
+                             const block_t *p_block )
+{
+    char *psz_temp;
+    if( asprintf( &psz_temp, "%s.%lu.part", psz_filename,
+                  vlc_thread_id() ) == -1 )
+        return VLC_ENOMEM;
+
+    int i_ret = VLC_EGENERIC;
+    FILE *f = vlc_fopen( psz_temp, "wb" );
+    if( f )
+    {
+        if( fwrite( p_block->p_buffer, 1, p_block->i_buffer, f )
+                == p_block->i_buffer )
+            i_ret = VLC_SUCCESS;
+        else
+            msg_Err( obj, "%s: %s", psz_temp, vlc_strerror_c(errno) );
+        if( fclose( f ) )
+            i_ret = VLC_EGENERIC;
+    }
+    else
+        msg_Err( obj, "%s: %s", psz_temp, vlc_strerror_c(errno) );
+
+    if( i_ret == VLC_SUCCESS )
+    {
+#if defined (_WIN32) || defined(__OS2__)
+        vlc_unlink( psz_filename );
+#endif
+        if( vlc_rename( psz_temp, psz_filename ) )
+            i_ret = VLC_EGENERIC;
+    }
+    if( i_ret != VLC_SUCCESS )
+        vlc_unlink( psz_temp );
+    free( psz_temp );
+    return i_ret;
+}
+
+#undef vlc_art_GetThumbnail
+char *vlc_art_GetThumbnail( vlc_object_t *obj, const char *psz_arturl,
+                            unsigned i_max_width, unsigned i_max_height )
+{
+    if( EMPTY_STR(psz_arturl) )
+        return NULL;
+    if( i_max_width == 0 && i_max_height == 0 )
+        return strdup( psz_arturl );
+
+    char *psz_filename = ArtThumbnailName( psz_arturl, i_max_width,
+                                           i_max_height );
+    if( !psz_filename )
+        return NULL;
+
+    char *psz_uri = NULL;
+    if( ArtThumbnailIsValid( psz_filename, psz_arturl ) )
+        goto end;
+
+    image_handler_t *p_image = image_HandlerCreate( obj );
+    if( !p_image )
+        goto error;
+
+    video_format_t fmt;
+    video_format_Init( &fmt, 0 );
+    picture_t *p_pic = image_ReadUrl( p_image, psz_arturl, &fmt );
+    image_HandlerDelete( p_image );
+    video_format_Clean( &fmt );
+    if( !p_pic )
+    {
+        msg_Dbg( obj, "cannot decode artwork %s", psz_arturl );
+        goto error;
+    }
+
+    unsigned i_width = p_pic->format.i_visible_width;
+    unsigned i_height = p_pic->format.i_visible_height;
+
+    if( ( i_max_width == 0 || i_width <= i_max_width )
+     && ( i_max_height == 0 || i_height <= i_max_height ) )
+    {
+        /* already small enough, do not bother with a copy */
+        picture_Release( p_pic );
+        free( psz_filename );
+        return strdup( psz_arturl );
+    }
+
+    /* fit into the box, the other dimension follows the aspect ratio */
+    int i_width_out = 0, i_height_out = 0;
+    if( i_max_height == 0
+     || ( i_max_width > 0
+       && (uint64_t)i_width * i_max_height >= (uint64_t)i_height * i_max_width ) )
+        i_width_out = i_max_width;
+    else
+        i_height_out = i_max_height;
+
+    block_t *p_block;
+    int i_ret = picture_Export( obj, &p_block, NULL, p_pic, VLC_CODEC_JPEG,
+                                i_width_out, i_height_out, false );
+    picture_Release( p_pic );
+    if( i_ret != VLC_SUCCESS )
+        goto error;
+
+    i_ret = ArtThumbnailSave( obj, psz_filename, p_block );
+    block_Release( p_block );
+    if( i_ret != VLC_SUCCESS )
+        goto error;
+
+    msg_Dbg( obj, "art thumbnail saved to %s", psz_filename );
+end:
+    psz_uri = vlc_path2uri( psz_filename, "file" );
+error:
+    free( psz_filename );
+    return psz_uri;
+}
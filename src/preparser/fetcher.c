@@ -31,6 +31,7 @@
 #include <vlc_threads.h>
 #include <vlc_memstream.h>
 #include <vlc_meta_fetcher.h>
+#include <vlc_executor.h>
 
 #include "art.h"
 #include "libvlc.h"
@@ -404,6 +405,7 @@ static void WorkerInit( input_fetcher_t* fetcher,
     struct background_worker_config conf = {
         .default_timeout = 0,
         .max_threads = var_InheritInteger( fetcher->owner, "fetch-art-threads" ),
+        .executor = vlc_object_executor( fetcher->owner ),
         .pf_start = starter,
         .pf_probe = ProbeWorker,
         .pf_stop = CloseWorker,
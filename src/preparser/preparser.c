@@ -24,6 +24,7 @@
 
 #include <vlc_common.h>
 #include <vlc_atomic.h>
+#include <vlc_executor.h>
 
 #include "misc/background_worker.h"
 #include "input/input_interface.h"
@@ -230,6 +231,7 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     struct background_worker_config conf = {
         .default_timeout = VLC_TICK_FROM_MS(var_InheritInteger( parent, "preparse-timeout" )),
         .max_threads = var_InheritInteger( parent, "preparse-threads" ),
+        .executor = vlc_object_executor( parent ),
         .pf_start = PreparserOpenInput,
         .pf_probe = PreparserProbeInput,
         .pf_stop = PreparserCloseInput,
@@ -257,14 +259,11 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     return preparser;
 }
 
-void input_preparser_Push( input_preparser_t *preparser,
-    input_item_t *item, input_item_meta_request_option_t i_options,
-    const input_preparser_callbacks_t *cbs, void *cbs_userdata,
-    int timeout, void *id )
+/* Returns the request, or NULL if the item is skipped */
+static input_preparser_req_t *ReqPrepare( input_item_t *item,
+    input_item_meta_request_option_t i_options,
+    const input_preparser_callbacks_t *cbs, void *cbs_userdata )
 {
-    if( atomic_load( &preparser->deactivated ) )
-        return;
-
     vlc_mutex_lock( &item->lock );
     enum input_item_type_e i_type = item->i_type;
     int b_net = item->b_net;
@@ -284,11 +283,26 @@ void input_preparser_Push( input_preparser_t *preparser,
         default:
             if (cbs && cbs->on_preparse_ended)
                 cbs->on_preparse_ended(item, ITEM_PREPARSE_SKIPPED, cbs_userdata);
-            return;
+            return NULL;
     }
 
-    struct input_preparser_req_t *req = ReqCreate(item, i_options,
-                                                  cbs, cbs_userdata);
+    input_preparser_req_t *req = ReqCreate(item, i_options, cbs, cbs_userdata);
+    if (unlikely(req == NULL) && cbs && cbs->on_preparse_ended)
+        cbs->on_preparse_ended(item, ITEM_PREPARSE_FAILED, cbs_userdata);
+    return req;
+}
+
+void input_preparser_Push( input_preparser_t *preparser,
+    input_item_t *item, input_item_meta_request_option_t i_options,
+    const input_preparser_callbacks_t *cbs, void *cbs_userdata,
+    int timeout, void *id )
+{
+    if( atomic_load( &preparser->deactivated ) )
+        return;
+
+    input_preparser_req_t *req = ReqPrepare(item, i_options, cbs, cbs_userdata);
+    if (req == NULL)
+        return;
 
     if (background_worker_Push(preparser->worker, req, id, timeout))
         if (req->cbs && cbs->on_preparse_ended)
@@ -297,6 +311,91 @@ void input_preparser_Push( input_preparser_t *preparser,
     ReqRelease(req);
 }
 
+struct batch_entry
+{
+    input_preparser_req_t *req;
+    void *id;
+    size_t index;
+};
+
+static int BatchCompare(const void *a_, const void *b_)
+{
+    const struct batch_entry *a = a_, *b = b_;
+    const char *ua = a->req->item->psz_uri, *ub = b->req->item->psz_uri;
+    int ret = strcmp(ua ? ua : "", ub ? ub : "");
+
+    if (ret == 0)
+        ret = (a->index > b->index) - (a->index < b->index);
+    return ret;
+}
+
+void input_preparser_PushBatch( input_preparser_t *preparser,
+    input_item_t *const *items, size_t count,
+    input_item_meta_request_option_t i_options,
+    const input_preparser_callbacks_t *cbs, void *const *cbs_userdata,
+    int timeout )
+{
+    if( atomic_load( &preparser->deactivated ) || count == 0 )
+        return;
+
+    struct batch_entry *batch = vlc_alloc(count, sizeof (*batch));
+    if (unlikely(batch == NULL))
+    {   /* Fall back to one request at a time */
+        for (size_t i = 0; i < count; i++)
+            input_preparser_Push(preparser, items[i], i_options, cbs,
+                                 cbs_userdata[i], timeout, cbs_userdata[i]);
+        return;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        input_preparser_req_t *req = ReqPrepare(items[i], i_options, cbs,
+                                                cbs_userdata[i]);
+        if (req == NULL)
+            continue;
+        batch[n].req = req;
+        batch[n].id = cbs_userdata[i];
+        batch[n].index = i;
+        n++;
+    }
+
+    /* Probe the items of a same server and directory one after the other to
+     * make the most of the connections and directory caches of the access.
+     * The URI of an item cannot change once it is created. */
+    qsort(batch, n, sizeof (*batch), BatchCompare);
+
+    void **reqs = vlc_alloc(n, 2 * sizeof (void *));
+    if (likely(reqs != NULL))
+    {
+        void **ids = reqs + n;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            reqs[i] = batch[i].req;
+            ids[i] = batch[i].id;
+        }
+        if (background_worker_PushBatch(preparser->worker, reqs, ids, n,
+                                        timeout) != VLC_SUCCESS)
+        {
+            free(reqs);
+            reqs = NULL;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        input_preparser_req_t *req = batch[i].req;
+
+        if (reqs == NULL && req->cbs && req->cbs->on_preparse_ended)
+            req->cbs->on_preparse_ended(req->item, ITEM_PREPARSE_FAILED,
+                                        req->userdata);
+        ReqRelease(req);
+    }
+    free(reqs);
+    free(batch);
+}
+
 void input_preparser_fetcher_Push( input_preparser_t *preparser,
     input_item_t *item, input_item_meta_request_option_t options,
     const input_fetcher_callbacks_t *cbs, void *cbs_userdata )
@@ -57,6 +57,24 @@ void input_preparser_Push( input_preparser_t *, input_item_t *,
                            void *cbs_userdata,
                            int timeout, void *id );
 
+/**
+ * This function enqueues several items to be preparsed.
+ *
+ * This is equivalent to calling input_preparser_Push() for each item, with
+ * its callback data as id, but the items are queued at once, and ordered by
+ * location to probe the items stored in a same place one after the other.
+ *
+ * @param items the items to preparse
+ * @param count the number of items
+ * @param cbs_userdata the callbacks data and cancellation ids of the items
+ * (count entries)
+ */
+void input_preparser_PushBatch( input_preparser_t *,
+                                input_item_t *const *items, size_t count,
+                                input_item_meta_request_option_t,
+                                const input_preparser_callbacks_t *cbs,
+                                void *const *cbs_userdata, int timeout );
+
 void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
                                    input_item_meta_request_option_t,
                                    const input_fetcher_callbacks_t *cbs,
@@ -46,6 +46,7 @@
 #include <vlc_block.h>
 #include <vlc_codec.h>
 #include <vlc_modules.h>
+#include <vlc_tracer.h>
 
 #include "input/input_interface.h"
 
@@ -587,7 +588,12 @@ int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
             return VLC_SUCCESS;
         p_mux->b_waiting_stream = false;
     }
-    return p_mux->pf_mux( p_mux );
+
+    struct vlc_tracer *tracer = vlc_object_get_tracer( p_mux );
+    vlc_tracer_Begin( tracer, "mux", "mux" );
+    int ret = p_mux->pf_mux( p_mux );
+    vlc_tracer_End( tracer, "mux", "mux" );
+    return ret;
 }
 
 void sout_MuxFlush( sout_mux_t *p_mux, sout_input_t *p_input )
@@ -86,11 +86,188 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_pool (void)
+{
+    struct block_pool_stats before, after;
+    block_t *blocks[64];
+
+    block_PoolStats (&before);
+
+    for (unsigned round = 0; round < 4; round++)
+    {
+        for (unsigned i = 0; i < 64; i++)
+        {
+            blocks[i] = block_Alloc (188 * (i + 1));
+            assert (blocks[i] != NULL);
+            assert (blocks[i]->i_buffer == 188 * (i + 1));
+            assert (((uintptr_t)blocks[i]->p_buffer & 31) == 0);
+            memset (blocks[i]->p_buffer, i, blocks[i]->i_buffer);
+        }
+        for (unsigned i = 0; i < 64; i++)
+            block_Release (blocks[i]);
+    }
+
+    /* Recycled blocks can still be grown in place or moved. */
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block = block_Realloc (block, 100000, sizeof (text) + 100000);
+    assert (block != NULL);
+    assert (!memcmp (block->p_buffer + 100000, text, sizeof (text)));
+    block_Release (block);
+
+    block_PoolStats (&after);
+    assert (after.hits + after.misses >= before.hits + before.misses + 4 * 64);
+    assert (after.recycled > before.recycled);
+}
+
+static void test_block_share (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_dts = 42;
+    assert (!block_IsShared (block));
+
+    block_t *a = block_Share (block);
+    block_t *b = block_Share (a);
+    assert (a != NULL && b != NULL);
+    assert (a->p_buffer == block->p_buffer && b->p_buffer == block->p_buffer);
+    assert (a->i_buffer == sizeof (text) && b->i_dts == 42);
+    assert (block_IsShared (block) && block_IsShared (a));
+
+    /* Writers get a copy, the others keep the payload */
+    a = block_MakeWritable (a);
+    assert (a != NULL && a->p_buffer != block->p_buffer);
+    memset (a->p_buffer, 'A', a->i_buffer);
+    assert (!memcmp (b->p_buffer, text, sizeof (text)));
+    block_Release (a);
+
+    /* So do blocks that grow in place */
+    block = block_Realloc (block, 16, sizeof (text) + 16);
+    assert (block != NULL && block->p_buffer + 16 != b->p_buffer);
+    memset (block->p_buffer, 'B', 16);
+    assert (!memcmp (block->p_buffer + 16, text, sizeof (text)));
+    assert (!memcmp (b->p_buffer, text, sizeof (text)));
+    block_Release (block);
+
+    /* The payload outlives the pinned block */
+    assert (!block_IsShared (b));
+    assert (!memcmp (b->p_buffer, text, sizeof (text)));
+    block_Release (b);
+
+    /* The last reference may be the pinned block itself */
+    block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    a = block_Share (block);
+    assert (a != NULL);
+    block_Release (a);
+    assert (!block_IsShared (block));
+    block = block_MakeWritable (block);
+    assert (block != NULL);
+    block_Release (block);
+
+    /* Slices see part of the payload, and cannot grow over the rest */
+    block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    a = block_Slice (block, 4, 8);
+    b = block_Slice (a, 2, 4);
+    assert (a != NULL && b != NULL);
+    assert (a->p_buffer == block->p_buffer + 4 && a->i_buffer == 8);
+    assert (b->p_buffer == block->p_buffer + 6 && b->i_buffer == 4);
+    block->i_buffer = 4;
+    block = block_Realloc (block, 0, 12);
+    assert (block != NULL);
+    memset (block->p_buffer + 4, 'C', 8);
+    assert (!memcmp (a->p_buffer, text + 4, 8));
+    block_Release (block);
+    block_Release (a);
+    assert (!memcmp (b->p_buffer, text + 6, 4));
+    block_Release (b);
+
+    /* Adjoining slices are joined without copying, others are not */
+    block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    a = block_Slice (block, 0, 4);
+    b = block_Slice (block, 4, 8);
+    assert (a != NULL && b != NULL);
+    a->i_pts = 42;
+    a->p_next = b;
+    a = block_ChainGather (a);
+    assert (a != NULL && a->p_next == NULL);
+    assert (a->p_buffer == block->p_buffer && a->i_buffer == 12);
+    assert (a->i_pts == 42);
+
+    b = block_Slice (block, 13, 4);
+    assert (b != NULL);
+    a->p_next = b;
+    assert (block_ChainJoin (a) == NULL);
+    a = block_ChainGather (a);
+    assert (a != NULL && a->p_buffer != block->p_buffer && a->i_buffer == 16);
+    assert (!memcmp (a->p_buffer, text, 12));
+    assert (!memcmp (a->p_buffer + 12, text + 13, 4));
+    block_Release (block);
+    block_Release (a);
+}
+
+static void test_fifo_batch (void)
+{
+    block_fifo_t *fifo = block_FifoNew ();
+    assert (fifo != NULL);
+
+    for (unsigned i = 0; i < 10; i++)
+    {
+        block_t *block = block_Alloc (100);
+        assert (block != NULL);
+        block->i_dts = i;
+        block_FifoPut (fifo, block);
+    }
+
+    vlc_fifo_Lock (fifo);
+    block_t *chain = vlc_fifo_DequeueBatchUnlocked (fifo, 4, SIZE_MAX);
+    assert (vlc_fifo_GetCount (fifo) == 6);
+    assert (vlc_fifo_GetBytes (fifo) == 600);
+
+    int count;
+    size_t size;
+    block_ChainProperties (chain, &count, &size, NULL);
+    assert (count == 4 && size == 400);
+    assert (chain->i_dts == 0);
+    block_ChainRelease (chain);
+
+    /* Byte limit, but always at least one block */
+    chain = vlc_fifo_DequeueBatchUnlocked (fifo, 10, 50);
+    assert (chain != NULL && chain->p_next == NULL && chain->i_dts == 4);
+    block_Release (chain);
+    chain = vlc_fifo_DequeueBatchUnlocked (fifo, 10, 250);
+    block_ChainProperties (chain, &count, NULL, NULL);
+    assert (count == 2 && chain->i_dts == 5);
+    block_ChainRelease (chain);
+
+    chain = vlc_fifo_DequeueBatchUnlocked (fifo, 10, SIZE_MAX);
+    block_ChainProperties (chain, &count, NULL, NULL);
+    assert (count == 3);
+    block_ChainRelease (chain);
+    assert (vlc_fifo_IsEmpty (fifo));
+    assert (vlc_fifo_DequeueBatchUnlocked (fifo, 10, SIZE_MAX) == NULL);
+
+    /* The FIFO is still usable after being emptied by batches */
+    vlc_fifo_QueueUnlocked (fifo, block_Alloc (10));
+    assert (vlc_fifo_GetCount (fifo) == 1);
+    vlc_fifo_Unlock (fifo);
+    block_FifoRelease (fifo);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_pool ();
+    test_block_share ();
+    test_fifo_batch ();
     return 0;
 }
 
@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * crc.c: test cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_crc.h>
+
+/* Bitwise reference implementation */
+static uint32_t crc_ref(uint32_t crc, unsigned width, uint32_t poly,
+                        const uint8_t *p, size_t len)
+{
+    const uint32_t top = UINT32_C(1) << (width - 1);
+    const uint32_t mask = (top << 1) - 1;
+
+    while (len-- > 0)
+    {
+        crc ^= (uint32_t)*(p++) << (width - 8);
+        for (unsigned i = 0; i < 8; i++)
+            crc = ((crc << 1) ^ ((crc & top) ? poly : 0)) & mask;
+    }
+    return crc;
+}
+
+int main(void)
+{
+    static const char check[] = "123456789";
+
+    /* Standard check values: CRC-8/SMBUS, CRC-16/UMTS, CRC-32/MPEG-2 */
+    assert(vlc_crc8(0, check, 9) == 0xF4);
+    assert(vlc_crc16(0, check, 9) == 0xFEE8);
+    assert(vlc_crc32(0xFFFFFFFF, check, 9) == 0x0376E6E7);
+
+    uint8_t buf[1000];
+
+    srand(0);
+    for (size_t i = 0; i < sizeof (buf); i++)
+        buf[i] = rand();
+
+    /* All lengths and alignments, with chaining */
+    for (size_t len = 0; len < 100; len++)
+        for (size_t off = 0; off < 8; off++)
+        {
+            const uint8_t *p = buf + off;
+            size_t half = len / 3;
+
+            assert(vlc_crc8(vlc_crc8(0x5A, p, half), p + half, len - half)
+                   == crc_ref(0x5A, 8, 0x07, p, len));
+            assert(vlc_crc16(vlc_crc16(0, p, half), p + half, len - half)
+                   == crc_ref(0, 16, 0x8005, p, len));
+            assert(vlc_crc32(vlc_crc32(0xFFFFFFFF, p, half), p + half,
+                             len - half)
+                   == crc_ref(0xFFFFFFFF, 32, 0x04C11DB7, p, len));
+        }
+
+    assert(vlc_crc32(0xFFFFFFFF, buf, sizeof (buf))
+           == crc_ref(0xFFFFFFFF, 32, 0x04C11DB7, buf, sizeof (buf)));
+    return 0;
+}
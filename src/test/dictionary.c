@@ -100,5 +100,50 @@ int main (void)
 
     assert( vlc_dictionary_keys_count( &dict ) == 0 );
     assert( vlc_dictionary_is_empty( &dict ) );
+
+    /* Grow the table, with duplicate keys */
+    vlc_dictionary_init( &dict, 1 );
+    for( i = 0; i < 1000; i++ )
+    {
+        char key[16];
+        sprintf( key, "key%"PRIdPTR, i % 500 );
+        vlc_dictionary_insert( &dict, key, (void *)i );
+    }
+    assert( vlc_dictionary_keys_count( &dict ) == 1000 );
+
+    int count = 0;
+    const vlc_dictionary_entry_t *p_entry;
+    vlc_dictionary_foreach( p_entry, &dict )
+        count++;
+    assert( count == 1000 );
+
+    /* The last inserted value shadows the previous ones */
+    for( i = 0; i < 500; i++ )
+    {
+        char key[16];
+        sprintf( key, "key%"PRIdPTR, i );
+        assert( vlc_dictionary_value_for_key( &dict, key ) == (void *)(i + 500) );
+        vlc_dictionary_remove_value_for_key( &dict, key, NULL, NULL );
+        assert( vlc_dictionary_value_for_key( &dict, key ) == (void *)i );
+    }
+    assert( vlc_dictionary_keys_count( &dict ) == 500 );
+
+    for( i = 0; i < 500; i += 2 )
+    {
+        char key[16];
+        sprintf( key, "key%"PRIdPTR, i );
+        vlc_dictionary_remove_value_for_key( &dict, key, NULL, NULL );
+        assert( !vlc_dictionary_has_key( &dict, key ) );
+    }
+    for( i = 1; i < 500; i += 2 )
+    {
+        char key[16];
+        sprintf( key, "key%"PRIdPTR, i );
+        assert( vlc_dictionary_value_for_key( &dict, key ) == (void *)i );
+    }
+    assert( vlc_dictionary_keys_count( &dict ) == 250 );
+
+    vlc_dictionary_clear( &dict, NULL, NULL );
+    assert( vlc_dictionary_is_empty( &dict ) );
     return 0;
 }
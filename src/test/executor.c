@@ -0,0 +1,191 @@
+/*****************************************************************************
+ * executor.c: test for the background jobs thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_executor.h>
+
+const char vlc_module_name[] = "test_executor";
+
+#define JOBS 1000
+#define CHILDREN 16
+
+struct job
+{
+    struct vlc_runnable runnable;
+    vlc_executor_t *executor;
+    vlc_sem_t *done;
+    atomic_uint *count;
+    struct job *children;
+};
+
+static void count(void *data)
+{
+    struct job *job = data;
+
+    atomic_fetch_add(job->count, 1);
+    vlc_sem_post(job->done);
+}
+
+static void spawn(void *data)
+{
+    struct job *job = data;
+
+    /* Queued on the current worker, and stolen by the others */
+    for (unsigned i = 0; i < CHILDREN; i++)
+        vlc_executor_Submit(job->executor, &job->children[i].runnable,
+                            VLC_EXECUTOR_PRIORITY_NORMAL);
+    vlc_sem_post(job->done);
+}
+
+static void test_many(unsigned threads)
+{
+    vlc_executor_t *ex = vlc_executor_New(threads);
+    assert(ex != NULL);
+
+    struct job *jobs = malloc(JOBS * (CHILDREN + 1) * sizeof (*jobs));
+    assert(jobs != NULL);
+
+    atomic_uint n;
+    vlc_sem_t done;
+
+    atomic_init(&n, 0);
+    vlc_sem_init(&done, 0);
+
+    for (unsigned i = 0; i < JOBS; i++)
+    {
+        struct job *job = &jobs[i * (CHILDREN + 1)];
+
+        job->children = job + 1;
+        for (unsigned j = 0; j <= CHILDREN; j++)
+        {
+            job[j].runnable.run = j ? count : spawn;
+            job[j].runnable.userdata = &job[j];
+            job[j].executor = ex;
+            job[j].done = &done;
+            job[j].count = &n;
+        }
+        vlc_executor_Submit(ex, &job->runnable, i % 3);
+    }
+
+    for (unsigned i = 0; i < JOBS * (CHILDREN + 1); i++)
+        vlc_sem_wait(&done);
+    assert(atomic_load(&n) == JOBS * CHILDREN);
+
+    vlc_executor_Delete(ex);
+    free(jobs);
+}
+
+struct ordered
+{
+    struct vlc_runnable runnable;
+    vlc_sem_t *started;
+    vlc_sem_t *gate;
+    vlc_sem_t *done;
+    int *order;
+    int *last;
+    int priority;
+};
+
+static void wait_gate(void *data)
+{
+    struct ordered *job = data;
+
+    vlc_sem_post(job->started);
+    vlc_sem_wait(job->gate);
+    vlc_sem_post(job->done);
+}
+
+static void record(void *data)
+{
+    struct ordered *job = data;
+
+    job->order[(*job->last)++] = job->priority;
+    vlc_sem_post(job->done);
+}
+
+static void test_order_cancel(void)
+{
+    vlc_executor_t *ex = vlc_executor_New(1);
+    assert(ex != NULL);
+
+    vlc_sem_t started, gate, done;
+    int order[3], last = 0;
+    struct ordered blocker, jobs[4];
+
+    vlc_sem_init(&started, 0);
+    vlc_sem_init(&gate, 0);
+    vlc_sem_init(&done, 0);
+
+    /* Keep the only worker busy */
+    blocker.runnable.run = wait_gate;
+    blocker.runnable.userdata = &blocker;
+    blocker.started = &started;
+    blocker.gate = &gate;
+    blocker.done = &done;
+    vlc_executor_Submit(ex, &blocker.runnable, VLC_EXECUTOR_PRIORITY_LOW);
+    vlc_sem_wait(&started);
+
+    for (int i = 0; i < 4; i++)
+    {
+        jobs[i].runnable.run = record;
+        jobs[i].runnable.userdata = &jobs[i];
+        jobs[i].done = &done;
+        jobs[i].order = order;
+        jobs[i].last = &last;
+        jobs[i].priority = i % 3;
+        vlc_executor_Submit(ex, &jobs[i].runnable, jobs[i].priority);
+    }
+
+    /* Queued jobs are removed, running ones are only flagged */
+    assert(vlc_executor_Cancel(ex, &jobs[3].runnable));
+    assert(vlc_executor_IsCanceled(ex, &jobs[3].runnable));
+    assert(!vlc_executor_Cancel(ex, &blocker.runnable));
+    assert(vlc_executor_IsCanceled(ex, &blocker.runnable));
+    assert(!vlc_executor_IsCanceled(ex, &jobs[0].runnable));
+
+    vlc_sem_post(&gate);
+    for (int i = 0; i < 4; i++)
+        vlc_sem_wait(&done);
+
+    assert(last == 3);
+    assert(order[0] == VLC_EXECUTOR_PRIORITY_HIGH);
+    assert(order[1] == VLC_EXECUTOR_PRIORITY_NORMAL);
+    assert(order[2] == VLC_EXECUTOR_PRIORITY_LOW);
+
+    vlc_executor_Delete(ex);
+}
+
+int main(void)
+{
+    test_many(1);
+    test_many(4);
+    test_many(0);
+    test_order_cancel();
+    return 0;
+}
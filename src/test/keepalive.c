@@ -0,0 +1,99 @@
+/*****************************************************************************
+ * keepalive.c: test for the idle resources store
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_keepalive.h>
+
+const char vlc_module_name[] = "test_keepalive";
+
+static unsigned released;
+
+static void release(void *data)
+{
+    (void) data;
+    released++;
+}
+
+static int res[8];
+
+static void test_take(void)
+{
+    vlc_keepalive_t *ka = vlc_keepalive_New(8);
+    assert(ka != NULL);
+
+    assert(vlc_keepalive_Take(ka, "a") == NULL);
+    assert(vlc_keepalive_Put(ka, "a", &res[0], release, VLC_TICK_FROM_SEC(60),
+                             4) == VLC_SUCCESS);
+    assert(vlc_keepalive_Put(ka, "a", &res[1], release, VLC_TICK_FROM_SEC(60),
+                             4) == VLC_SUCCESS);
+    assert(vlc_keepalive_Put(ka, "b", &res[2], release, VLC_TICK_FROM_SEC(60),
+                             4) == VLC_SUCCESS);
+
+    /* Most recent first, and only with the same key */
+    assert(vlc_keepalive_Take(ka, "a") == &res[1]);
+    assert(vlc_keepalive_Take(ka, "a") == &res[0]);
+    assert(vlc_keepalive_Take(ka, "a") == NULL);
+    assert(released == 0);
+
+    released = 0;
+    vlc_keepalive_Delete(ka);
+    assert(released == 1);
+}
+
+static void test_limits(void)
+{
+    vlc_keepalive_t *ka = vlc_keepalive_New(3);
+    assert(ka != NULL);
+
+    /* Per key: the oldest is evicted */
+    released = 0;
+    for (int i = 0; i < 3; i++)
+        vlc_keepalive_Put(ka, "a", &res[i], release, VLC_TICK_FROM_SEC(60), 2);
+    assert(released == 1);
+
+    /* Total: the oldest of any key is evicted */
+    vlc_keepalive_Put(ka, "b", &res[3], release, VLC_TICK_FROM_SEC(60), 2);
+    vlc_keepalive_Put(ka, "c", &res[4], release, VLC_TICK_FROM_SEC(60), 2);
+    assert(released == 2);
+    assert(vlc_keepalive_Take(ka, "a") == &res[2]);
+    assert(vlc_keepalive_Take(ka, "a") == NULL);
+
+    /* Expired */
+    vlc_keepalive_Put(ka, "d", &res[5], release, 0, 2);
+    assert(vlc_keepalive_Take(ka, "d") == NULL);
+    assert(released == 3);
+
+    vlc_keepalive_Delete(ka);
+    assert(released == 5);
+}
+
+int main(void)
+{
+    test_take();
+    test_limits();
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*****************************************************************************
+ * mutex.c: lock contention benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_GETRUSAGE
+# include <sys/resource.h>
+#endif
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+
+const char vlc_module_name[] = "test_mutex";
+
+#define THREADS 8
+#define LOOPS 20000
+#define QUEUE_SIZE 16
+
+/* Contention statistics, counted outside of the locks */
+struct stats
+{
+    atomic_ulong acquired;
+    atomic_ulong contended;
+};
+
+static void stats_lock(struct stats *stats, vlc_mutex_t *lock)
+{
+    if (vlc_mutex_trylock(lock) != 0)
+    {
+        atomic_fetch_add_explicit(&stats->contended, 1, memory_order_relaxed);
+        vlc_mutex_lock(lock);
+    }
+    atomic_fetch_add_explicit(&stats->acquired, 1, memory_order_relaxed);
+}
+
+static long context_switches(void)
+{
+#ifdef HAVE_GETRUSAGE
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+    return -1;
+}
+
+static void report(const char *name, const struct stats *stats,
+                   vlc_tick_t start, long switches)
+{
+    vlc_tick_t duration = vlc_tick_now() - start;
+    unsigned long acquired = atomic_load(&stats->acquired);
+    unsigned long contended = atomic_load(&stats->contended);
+
+    printf("%s: %lu locks in %"PRId64" us, %lu contended (%.1f%%)",
+           name, acquired, US_FROM_VLC_TICK(duration), contended,
+           acquired ? 100. * contended / acquired : 0.);
+    if (switches >= 0)
+        printf(", %ld context switches", context_switches() - switches);
+    putchar('\n');
+}
+
+/*** Short critical sections ***/
+
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned long counter;
+    struct stats stats;
+} counter;
+
+static void *counter_thread(void *data)
+{
+    (void) data;
+
+    for (unsigned i = 0; i < LOOPS; i++)
+    {
+        stats_lock(&counter.stats, &counter.lock);
+        counter.counter++;
+        vlc_mutex_unlock(&counter.lock);
+    }
+    return NULL;
+}
+
+static void test_counter(void)
+{
+    vlc_thread_t th[THREADS];
+
+    vlc_mutex_init(&counter.lock);
+    counter.counter = 0;
+    atomic_init(&counter.stats.acquired, 0);
+    atomic_init(&counter.stats.contended, 0);
+
+    long switches = context_switches();
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(!vlc_clone(&th[i], counter_thread, NULL,
+                          VLC_THREAD_PRIORITY_LOW));
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+
+    report("counter", &counter.stats, start, switches);
+    assert(counter.counter == THREADS * LOOPS);
+    vlc_mutex_destroy(&counter.lock);
+}
+
+/*** Many producers, one consumer, as decoder and stream output FIFOs ***/
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data;
+    vlc_cond_t wait_space;
+    unsigned items[QUEUE_SIZE];
+    unsigned count;
+    unsigned head;
+    struct stats stats;
+} queue;
+
+static void *producer_thread(void *data)
+{
+    (void) data;
+
+    for (unsigned i = 0; i < LOOPS; i++)
+    {
+        stats_lock(&queue.stats, &queue.lock);
+        while (queue.count == QUEUE_SIZE)
+            vlc_cond_wait(&queue.wait_space, &queue.lock);
+        queue.items[(queue.head + queue.count++) % QUEUE_SIZE] = i;
+        vlc_cond_signal(&queue.wait_data);
+        vlc_mutex_unlock(&queue.lock);
+    }
+    return NULL;
+}
+
+static void test_queue(void)
+{
+    vlc_thread_t th[THREADS];
+    unsigned long received = 0, sum = 0;
+
+    vlc_mutex_init(&queue.lock);
+    vlc_cond_init(&queue.wait_data);
+    vlc_cond_init(&queue.wait_space);
+    queue.count = 0;
+    queue.head = 0;
+    atomic_init(&queue.stats.acquired, 0);
+    atomic_init(&queue.stats.contended, 0);
+
+    long switches = context_switches();
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(!vlc_clone(&th[i], producer_thread, NULL,
+                          VLC_THREAD_PRIORITY_LOW));
+
+    while (received < THREADS * LOOPS)
+    {
+        stats_lock(&queue.stats, &queue.lock);
+        while (queue.count == 0)
+            vlc_cond_wait(&queue.wait_data, &queue.lock);
+        while (queue.count > 0)
+        {
+            sum += queue.items[queue.head];
+            queue.head = (queue.head + 1) % QUEUE_SIZE;
+            queue.count--;
+            received++;
+        }
+        vlc_cond_broadcast(&queue.wait_space);
+        vlc_mutex_unlock(&queue.lock);
+    }
+
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+
+    report("queue", &queue.stats, start, switches);
+    assert(sum == THREADS * ((unsigned long)LOOPS * (LOOPS - 1) / 2));
+    vlc_cond_destroy(&queue.wait_space);
+    vlc_cond_destroy(&queue.wait_data);
+    vlc_mutex_destroy(&queue.lock);
+}
+
+int main(void)
+{
+    test_counter();
+    test_queue();
+    return 0;
+}
@@ -23,14 +23,19 @@
 #endif
 
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #undef NDEBUG
 #include <assert.h>
 
 #include <vlc_common.h>
 #include <vlc_es.h>
 #include <vlc_picture_pool.h>
+#include <vlc_threads.h>
 
 #define PICTURES 10
+#define THREADS 4
+#define ITERATIONS 20000
 
 const char vlc_module_name[] = "test_picture_pool";
 
@@ -108,6 +113,60 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static atomic_uint misses;
+
+static void *test_thread(void *data)
+{
+    picture_pool_t *p = data;
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        picture_t *pic = picture_pool_Get(p);
+        if (pic == NULL) {
+            /* Contended: all pictures are held by the other threads */
+            atomic_fetch_add_explicit(&misses, 1, memory_order_relaxed);
+            pic = picture_pool_Wait(p);
+        }
+        assert(pic != NULL);
+        picture_Release(pic);
+    }
+    return NULL;
+}
+
+static void test_threads(unsigned count)
+{
+    vlc_thread_t th[THREADS];
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+    atomic_init(&misses, 0);
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(!vlc_clone(&th[i], test_thread, pool, VLC_THREAD_PRIORITY_LOW));
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+
+    printf("%u pictures, %u threads: %u/%u contended gets\n", count, THREADS,
+           atomic_load(&misses), THREADS * ITERATIONS);
+
+    /* Every picture must be back */
+    picture_t *pics[PICTURES];
+    for (unsigned i = 0; i < count; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+    for (unsigned i = 0; i < count; i++)
+        picture_Release(pics[i]);
+
+    /* Canceled pools never return pictures */
+    picture_pool_Cancel(pool, true);
+    assert(picture_pool_Get(pool) == NULL);
+    assert(picture_pool_Wait(pool) == NULL);
+    picture_pool_Cancel(pool, false);
+
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -124,6 +183,8 @@ int main(void)
 
     test(false);
     test(true);
+    test_threads(PICTURES);
+    test_threads(THREADS - 1); /* exhausted */
 
     return 0;
 }
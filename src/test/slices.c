@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * slices.c: test for the picture slices thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+
+#include "../misc/slices.h"
+
+const char vlc_module_name[] = "test_slices";
+
+#define LINES 1081
+
+struct slice_data
+{
+    atomic_uint hits[LINES];
+    unsigned align;
+    unsigned lines;
+};
+
+static void callback(void *opaque, unsigned start, unsigned end)
+{
+    struct slice_data *data = opaque;
+
+    assert(start < end);
+    assert(end <= data->lines);
+    assert(start % data->align == 0);
+    assert(end % data->align == 0 || end == data->lines);
+
+    for (unsigned i = start; i < end; i++)
+        atomic_fetch_add(&data->hits[i], 1);
+}
+
+static void test_run(vlc_slices_t *slices, unsigned lines, unsigned align)
+{
+    struct slice_data data;
+
+    for (unsigned i = 0; i < LINES; i++)
+        atomic_init(&data.hits[i], 0);
+    data.align = align ? align : 1;
+    data.lines = lines;
+
+    vlc_slices_Run(slices, lines, align, callback, &data);
+
+    for (unsigned i = 0; i < LINES; i++)
+        assert(atomic_load(&data.hits[i]) == (i < lines ? 1 : 0));
+}
+
+static void *thread(void *data)
+{
+    vlc_slices_t *slices = data;
+
+    for (unsigned i = 0; i < 100; i++)
+        test_run(slices, LINES - i, 2);
+    return NULL;
+}
+
+int main(void)
+{
+    static const unsigned threads[] = { 1, 2, 3, 8 };
+    static const unsigned lines[] = { 0, 1, 2, 3, 17, 480, LINES };
+
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++)
+    {
+        vlc_slices_t *slices = vlc_slices_New(threads[t]);
+        assert((slices == NULL) == (threads[t] == 1));
+
+        for (size_t l = 0; l < ARRAY_SIZE(lines); l++)
+            for (unsigned align = 0; align <= 4; align++)
+                test_run(slices, lines[l], align);
+
+        /* Concurrent callers sharing the pool */
+        vlc_thread_t th[4];
+        for (size_t i = 0; i < ARRAY_SIZE(th); i++)
+            assert(vlc_clone(&th[i], thread, slices,
+                             VLC_THREAD_PRIORITY_LOW) == 0);
+        for (size_t i = 0; i < ARRAY_SIZE(th); i++)
+            vlc_join(th[i], NULL);
+
+        vlc_slices_Delete(slices);
+    }
+    return 0;
+}
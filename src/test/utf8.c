@@ -122,6 +122,19 @@ static void test_strcasestr (const char *h, const char *n, ssize_t offset)
     }
 }
 
+static void test_fromcharset(const char *charset, const char *in, size_t len,
+                             const char *out)
+{
+    printf("\"%s\" from %s should be \"%s\"...\n", in, charset, out);
+
+    char *str = FromCharset(charset, in, len);
+    if (str == NULL || strcmp(str, out))
+    {
+        printf(" ERROR: got \"%s\"\n", str ? str : "(null)");
+        exit(20);
+    }
+    free(str);
+}
 
 int main (void)
 {
@@ -189,5 +202,17 @@ int main (void)
     test_strcasestr ("Télé", "élé", 1);
     test_strcasestr ("Télé", "léé", -1);
 
+    test_fromcharset("UTF-8", "", 0, "");
+    test_fromcharset("UTF-8", "Télévision €", strlen("Télévision €"),
+                     "Télévision €");
+    test_fromcharset("ISO-8859-1", "T\xE9l\xE9vision", 10, "Télévision");
+    test_fromcharset("ISO-8859-1", "this_is_a_long_enough_ascii_string_"
+                     "to_be_checked_in_words_not_bytes_0123456789", 78,
+                     "this_is_a_long_enough_ascii_string_"
+                     "to_be_checked_in_words_not_bytes_0123456789");
+    test_fromcharset("CP1252", "ascii_until_the_end_of_the_first_64_bytes_"
+                     "block_then_non_ascii_\x80", 64, "ascii_until_the_end_of"
+                     "_the_first_64_bytes_block_then_non_ascii_€");
+
     return 0;
 }
@@ -228,6 +228,53 @@ char *vlc_strcasestr (const char *haystack, const char *needle)
     return NULL;
 }
 
+/**
+ * Checks that a buffer only contains 7-bit ASCII bytes.
+ */
+static bool IsASCIIBuffer(const unsigned char *p, size_t size)
+{
+    uint64_t acc = 0;
+
+    /* Mask whole words, so the compiler can vectorize the loop */
+    for (; size >= 64; p += 64, size -= 64)
+    {
+        for (unsigned i = 0; i < 64; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, p + i, 8);
+            acc |= word;
+        }
+        if (acc & UINT64_C(0x8080808080808080))
+            return false;
+    }
+    for (; size >= 8; p += 8, size -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        acc |= word;
+    }
+    while (size-- > 0)
+        acc |= *(p++);
+    return (acc & UINT64_C(0x8080808080808080)) == 0;
+}
+
+/**
+ * Checks whether a character encoding maps 7-bit ASCII to itself,
+ * as the encodings of most subtitles, playlists and meta data.
+ */
+static bool IsASCIICompatible(const char *charset)
+{
+    static const char prefixes[][8] = {
+        "ASCII", "US-ASCII", "ISO-8859", "ISO8859",
+        "CP125", "WINDOWS", "LATIN", "KOI8",
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(prefixes); i++)
+        if (!strncasecmp(charset, prefixes[i], strlen(prefixes[i])))
+            return true;
+    return false;
+}
+
 /**
  * Converts a string from the given character encoding to utf-8.
  *
@@ -236,6 +283,22 @@ char *vlc_strcasestr (const char *haystack, const char *needle)
  */
 char *FromCharset(const char *charset, const void *data, size_t data_size)
 {
+    /* ASCII, or UTF-8 to UTF-8: nothing to convert */
+    bool utf8 = !strcasecmp(charset, "UTF-8") || !strcasecmp(charset, "UTF8");
+    if (utf8 || (IsASCIICompatible(charset) && IsASCIIBuffer(data, data_size)))
+    {
+        char *out = malloc(data_size + 1);
+        if (unlikely(out == NULL))
+            return NULL;
+        memcpy(out, data, data_size);
+        out[data_size] = '\0';
+
+        /* Embedded nul or invalid UTF-8 are left to iconv */
+        if (IsUTF8(out) == out + data_size)
+            return out;
+        free(out);
+    }
+
     vlc_iconv_t handle = vlc_iconv_open ("UTF-8", charset);
     if (handle == (vlc_iconv_t)(-1))
         return NULL;
@@ -730,11 +730,12 @@ void vout_SetDisplayViewpoint(vout_display_t *vd,
     }
 }
 
-vout_display_t *vout_display_New(vlc_object_t *parent,
-                                 const video_format_t *source,
-                                 const vout_display_cfg_t *cfg,
-                                 const char *module,
-                                 const vout_display_owner_t *owner)
+vout_display_t *vout_display_NewWithDevice(vlc_object_t *parent,
+                                           const video_format_t *source,
+                                           const vout_display_cfg_t *cfg,
+                                           const char *module,
+                                           const vout_display_owner_t *owner,
+                                           vlc_decoder_device *device)
 {
     vout_display_priv_t *osys = vlc_custom_create(parent, sizeof (*osys),
                                                   "vout display");
@@ -772,7 +773,9 @@ vout_display_t *vout_display_New(vlc_object_t *parent,
     if (owner)
         vd->owner = *owner;
 
-    osys->video_context.device = vlc_decoder_device_Create(osys->cfg.window);
+    osys->video_context.device = (device != NULL)
+        ? vlc_decoder_device_Hold(device)
+        : vlc_decoder_device_Create(osys->cfg.window);
     vlc_video_context *video_context = osys->video_context.device ?
         &osys->video_context : NULL;
 
@@ -809,6 +812,16 @@ error:
     return NULL;
 }
 
+vout_display_t *vout_display_New(vlc_object_t *parent,
+                                 const video_format_t *source,
+                                 const vout_display_cfg_t *cfg,
+                                 const char *module,
+                                 const vout_display_owner_t *owner)
+{
+    return vout_display_NewWithDevice(parent, source, cfg, module, owner,
+                                      NULL);
+}
+
 void vout_display_Delete(vout_display_t *vd)
 {
     vout_display_priv_t *osys = container_of(vd, vout_display_priv_t, display);
@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * pacing.h: vout frame pacing on the display refresh
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_PACING_H
+#define LIBVLC_VOUT_PACING_H
+
+/* Displays blocking on the vertical sync return from vout_display_Display()
+ * on refresh boundaries: the refresh period is the smallest interval, or
+ * difference between consecutive intervals, between those returns. Once it
+ * is known, pictures are displayed in the middle of the refresh interval
+ * preceding their presentation date, so that judder does not depend on the
+ * alignment of the clock with the refresh.
+ *
+ * Displays getting presentation feedback from the compositor or the driver
+ * report the actual refresh dates and period instead, which then replace the
+ * learnt ones. */
+
+#define VOUT_PACING_MIN_PERIOD VLC_TICK_FROM_MS(4)  /* 250 Hz */
+#define VOUT_PACING_MAX_PERIOD VLC_TICK_FROM_MS(50) /* 20 Hz */
+#define VOUT_PACING_LEARN 16 /* samples before locking on a period */
+#define VOUT_PACING_UNLOCK 32 /* mismatching samples before relearning */
+
+typedef struct {
+    vlc_tick_t period; /* VLC_TICK_INVALID until learnt, unless forced */
+    bool       forced;
+    vlc_tick_t phase; /* date of a refresh */
+
+    /* Learning */
+    vlc_tick_t last;
+    vlc_tick_t last_interval;
+    vlc_tick_t candidate;
+    unsigned   samples;
+    unsigned   mismatches;
+    bool       feedback; /* refreshes reported by the display */
+
+    /* Statistics */
+    unsigned   late;     /* displayed after their refresh */
+    unsigned   repeated; /* redisplayed pictures */
+    unsigned   dropped;  /* replaced before being displayed */
+    unsigned   presented;
+    vlc_tick_t latency;  /* average presentation delay */
+} vout_pacing_t;
+
+static inline void vout_pacing_Reset(vout_pacing_t *pacing)
+{
+    if (!pacing->forced)
+        pacing->period = VLC_TICK_INVALID;
+    pacing->phase         = VLC_TICK_INVALID;
+    pacing->last          = VLC_TICK_INVALID;
+    pacing->last_interval = 0;
+    pacing->candidate     = INT64_MAX;
+    pacing->samples       = 0;
+    pacing->mismatches    = 0;
+}
+
+/**
+ * \param refresh_rate forced display refresh rate in Hz, 0 to learn it
+ */
+static inline void vout_pacing_Init(vout_pacing_t *pacing, float refresh_rate)
+{
+    pacing->forced = refresh_rate > 0.f;
+    pacing->period = pacing->forced
+                   ? (vlc_tick_t)(CLOCK_FREQ / refresh_rate) : VLC_TICK_INVALID;
+    vout_pacing_Reset(pacing);
+    pacing->late = pacing->repeated = pacing->dropped = 0;
+    pacing->feedback = false;
+    pacing->presented = 0;
+    pacing->latency = 0;
+}
+
+static inline bool vout_pacing_IsLocked(const vout_pacing_t *pacing)
+{
+    return pacing->period != VLC_TICK_INVALID;
+}
+
+/**
+ * Reports that vout_display_Display() returned at the given date
+ */
+static inline void vout_pacing_Displayed(vout_pacing_t *pacing, vlc_tick_t now)
+{
+    const vlc_tick_t interval = pacing->last != VLC_TICK_INVALID
+                              ? now - pacing->last : 0;
+    pacing->last = now;
+    if (interval <= 0 || pacing->feedback)
+        return;
+
+    if (pacing->period == VLC_TICK_INVALID) {
+        /* Intervals are multiples of the period, and so are their variations
+         * (jitter aside) */
+        if (interval >= VOUT_PACING_MIN_PERIOD)
+            pacing->candidate = __MIN(pacing->candidate, interval);
+        const vlc_tick_t diff = interval > pacing->last_interval
+                              ? interval - pacing->last_interval
+                              : pacing->last_interval - interval;
+        if (pacing->last_interval != 0 && diff >= VOUT_PACING_MIN_PERIOD)
+            pacing->candidate = __MIN(pacing->candidate, diff);
+        pacing->last_interval = interval;
+
+        if (++pacing->samples >= VOUT_PACING_LEARN) {
+            if (pacing->candidate <= VOUT_PACING_MAX_PERIOD)
+                pacing->period = pacing->candidate;
+            else
+                vout_pacing_Reset(pacing);
+        }
+        pacing->phase = now;
+        return;
+    }
+
+    /* Refine the period and the phase */
+    const vlc_tick_t count = (interval + pacing->period / 2) / pacing->period;
+    if (count > 0) {
+        const vlc_tick_t error = interval - count * pacing->period;
+        if (error < pacing->period / 8 && error > -pacing->period / 8) {
+            if (!pacing->forced)
+                pacing->period += error / count / 16;
+            pacing->mismatches = 0;
+        }
+        else if (!pacing->forced && ++pacing->mismatches >= VOUT_PACING_UNLOCK)
+            vout_pacing_Reset(pacing);
+    }
+    pacing->phase = now;
+}
+
+/**
+ * Reports presentation feedback from the display
+ *
+ * \param expected date the picture was meant to be shown at
+ * \param presented date the picture was shown at
+ * \param refresh refresh period, or 0 if unknown
+ */
+static inline void vout_pacing_Presented(vout_pacing_t *pacing,
+                                         vlc_tick_t expected,
+                                         vlc_tick_t presented,
+                                         vlc_tick_t refresh)
+{
+    pacing->feedback = true;
+    pacing->phase = presented;
+    if (!pacing->forced && refresh >= VOUT_PACING_MIN_PERIOD
+     && refresh <= VOUT_PACING_MAX_PERIOD)
+        pacing->period = refresh;
+
+    if (expected != VLC_TICK_INVALID && expected != INT64_MAX) {
+        const vlc_tick_t delay = presented - expected;
+        pacing->latency = pacing->presented++ == 0 ? delay
+                        : pacing->latency + (delay - pacing->latency) / 16;
+    }
+}
+
+/**
+ * Returns the date to display a picture to be presented at the given date
+ *
+ * \param system_pts presentation date of the picture
+ */
+static inline vlc_tick_t vout_pacing_GetDisplayDate(const vout_pacing_t *pacing,
+                                                    vlc_tick_t system_pts)
+{
+    if (!vout_pacing_IsLocked(pacing) || pacing->phase == VLC_TICK_INVALID)
+        return system_pts;
+
+    /* Refresh nearest to the presentation date */
+    const vlc_tick_t period = pacing->period;
+    vlc_tick_t offset = system_pts - pacing->phase;
+    vlc_tick_t count = (offset >= 0 ? offset + period / 2
+                                    : offset - period / 2) / period;
+    vlc_tick_t refresh = pacing->phase + count * period;
+
+    /* Display it during the previous refresh interval */
+    return refresh - period / 2;
+}
+
+#endif
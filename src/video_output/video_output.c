@@ -44,11 +44,13 @@
 
 #include <vlc_vout.h>
 
+#include <vlc_codec.h>
 #include <vlc_filter.h>
 #include <vlc_spu.h>
 #include <vlc_vout_osd.h>
 #include <vlc_image.h>
 #include <vlc_plugin.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "vout_internal.h"
@@ -343,6 +345,19 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
 {
     assert(!vout->p->dummy);
     picture->p_next = NULL;
+    if (vout->p->low_delay) {
+        /* Only the latest decoded picture is worth displaying */
+        picture_t *old;
+        unsigned lost = 0;
+
+        while ((old = picture_fifo_Pop(vout->p->decoder_fifo)) != NULL) {
+            picture_Release(old);
+            lost++;
+        }
+        if (lost > 0)
+            vout_statistic_AddLost(&vout->p->statistic, lost);
+        picture->b_force = true;
+    }
     picture_fifo_Push(vout->p->decoder_fifo, picture);
     vout_control_Wake(&vout->p->control);
 }
@@ -1195,16 +1210,28 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     system_now = vlc_tick_now();
     if (!is_forced)
     {
-        if (unlikely(system_now > system_pts))
+        /* Snap the display date on the refresh preceding system_pts */
+        vlc_tick_t system_wait = system_pts;
+        vlc_tick_t wait_pts = pts;
+        if (sys->pacing_enabled && vout_pacing_IsLocked(&sys->pacing))
+        {
+            system_wait = vout_pacing_GetDisplayDate(&sys->pacing, system_pts);
+            wait_pts = pts + (vlc_tick_t)((system_wait - system_pts) * sys->rate);
+            if (system_now > system_wait + sys->pacing.period)
+                sys->pacing.late++;
+        }
+
+        if (unlikely(system_now > system_wait))
         {
             /* vd->prepare took too much time. Tell the clock that the pts was
              * rendered late. */
-            system_pts = system_now;
+            if (system_now > system_pts)
+                system_pts = system_now;
         }
         else
         {
             /* Wait to reach system_pts */
-            vlc_clock_Wait(sys->clock, system_now, pts, sys->rate,
+            vlc_clock_Wait(sys->clock, system_now, wait_pts, sys->rate,
                            VOUT_REDISPLAY_DELAY);
 
             /* Don't touch system_pts. Tell the clock that the pts was rendered
@@ -1223,6 +1250,14 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout_display_Display(vd, todisplay);
+    if (sys->pacing_enabled)
+    {
+        const bool locked = vout_pacing_IsLocked(&sys->pacing);
+        vout_pacing_Displayed(&sys->pacing, vlc_tick_now());
+        if (!locked && vout_pacing_IsLocked(&sys->pacing))
+            msg_Dbg(vout, "display refresh period locked at %"PRId64" us",
+                    sys->pacing.period);
+    }
     vlc_mutex_unlock(&sys->display_lock);
 
     if (subpic)
@@ -1267,6 +1302,13 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
              * the current one). */
             paused = true;
         }
+        else if (sys->low_delay)
+        {
+            /* Do not wait for the clock, show the picture right away */
+            date_next = system_now;
+            drop_next_frame = true;
+        }
+        else
         {
             date_next = next_system_pts - render_delay;
             if (date_next <= system_now)
@@ -1304,6 +1346,8 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
     }
 
     if (drop_next_frame) {
+        if (first && !frame_by_frame)
+            sys->pacing.dropped++;
         picture_Release(sys->displayed.current);
         sys->displayed.current = sys->displayed.next;
         sys->displayed.next    = NULL;
@@ -1312,6 +1356,9 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
     if (!sys->displayed.current)
         return VLC_EGENERIC;
 
+    if (force_refresh)
+        sys->pacing.repeated++;
+
     /* display the picture immediately */
     bool is_forced = frame_by_frame || force_refresh || sys->displayed.current->b_force;
     int ret = ThreadDisplayRenderPicture(vout, is_forced);
@@ -1466,16 +1513,16 @@ static void ThreadProcessMouseState(vout_thread_t *vout,
     vlc_mutex_unlock(&vout->p->filter.lock);
 
     if (vlc_mouse_HasMoved(&vout->p->mouse, m))
-        var_SetCoords(vout, "mouse-moved", m->i_x, m->i_y);
+        var_SetHandleCoords(vout, vout->p->mouse_moved, m->i_x, m->i_y);
 
     if (vlc_mouse_HasButton(&vout->p->mouse, m)) {
-        var_SetInteger(vout, "mouse-button-down", m->i_pressed);
+        var_SetHandleInteger(vout, vout->p->mouse_button_down, m->i_pressed);
 
         if (vlc_mouse_HasPressed(&vout->p->mouse, m, MOUSE_BUTTON_LEFT)) {
             /* FIXME? */
             int x, y;
 
-            var_GetCoords(vout, "mouse-moved", &x, &y);
+            var_GetHandleCoords(vout, vout->p->mouse_moved, &x, &y);
             var_SetCoords(vout, "mouse-clicked", x, y);
         }
     }
@@ -1645,6 +1692,7 @@ noreturn static void *Thread(void *object)
 {
     vout_thread_t *vout = object;
     vout_thread_sys_t *sys = vout->p;
+    struct vlc_tracer *tracer = vlc_object_get_tracer(vout);
 
     vlc_tick_t deadline = VLC_TICK_INVALID;
     bool wait = false;
@@ -1667,7 +1715,9 @@ noreturn static void *Thread(void *object)
 
         int canc = vlc_savecancel();
         deadline = VLC_TICK_INVALID;
+        vlc_tracer_Begin(tracer, "vout", "display");
         wait = ThreadDisplayPicture(vout, &deadline) != VLC_SUCCESS;
+        vlc_tracer_End(tracer, "vout", "display");
 
         const bool picture_interlaced = sys->displayed.is_interlaced;
 
@@ -1719,6 +1769,16 @@ void vout_StopDisplay(vout_thread_t *vout)
     video_format_Clean(&sys->original);
 }
 
+static void vout_ReleaseDevice(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = vout->p;
+
+    if (sys->dec_device != NULL) {
+        vlc_decoder_device_Release(sys->dec_device);
+        sys->dec_device = NULL;
+    }
+}
+
 void vout_Stop(vout_thread_t *vout)
 {
     vout_thread_sys_t *sys = vout->p;
@@ -1729,6 +1789,7 @@ void vout_Stop(vout_thread_t *vout)
 
     vlc_mutex_lock(&sys->window_lock);
     if (sys->window_enabled) {
+        vout_ReleaseDevice(vout);
         vout_window_Disable(sys->display_cfg.window);
         sys->window_enabled = false;
     }
@@ -1742,14 +1803,22 @@ void vout_Close(vout_thread_t *vout)
     vout_thread_sys_t *sys = vout->p;
     assert(!sys->dummy);
 
-    if (sys->display != NULL)
-        vout_Stop(vout);
+    /* Also disables the window (and releases its decoder device) if the
+     * display was already stopped */
+    vout_Stop(vout);
 
     vout_IntfDeinit(VLC_OBJECT(vout));
     vout_snapshot_End(sys->snapshot);
     vout_control_Dead(&sys->control);
     vout_chrono_Clean(&sys->render);
 
+    if (sys->pacing_enabled)
+        msg_Dbg(vout, "pacing: %u late, %u repeated, %u dropped pictures",
+                sys->pacing.late, sys->pacing.repeated, sys->pacing.dropped);
+    if (sys->pacing_enabled && sys->pacing.presented > 0)
+        msg_Dbg(vout, "pacing: %u pictures presented, %"PRId64" us latency",
+                sys->pacing.presented, US_FROM_VLC_TICK(sys->pacing.latency));
+
     if (sys->spu)
         spu_Destroy(sys->spu);
 
@@ -1770,12 +1839,15 @@ void vout_Release(vout_thread_t *vout)
     }
 
     free(vout->p->splitter_name);
+    var_ReleaseHandle(vout, sys->mouse_button_down);
+    var_ReleaseHandle(vout, sys->mouse_moved);
 
     /* Destroy the locks */
     vlc_mutex_destroy(&vout->p->window_lock);
     vlc_mutex_destroy(&vout->p->filter.lock);
 
     assert(!sys->window_enabled);
+    assert(sys->dec_device == NULL);
     vout_display_window_Delete(sys->display_cfg.window);
 
     vout_control_Clean(&vout->p->control);
@@ -1834,6 +1906,10 @@ vout_thread_t *vout_Create(vlc_object_t *object)
      * fully initialized object to its caller.
      */
     vout_IntfInit(vout);
+    /* Mouse events are frequent, skip the look-ups by name */
+    sys->mouse_moved = var_AcquireHandle(vout, "mouse-moved");
+    sys->mouse_button_down = var_AcquireHandle(vout, "mouse-button-down");
+    assert(sys->mouse_moved != NULL && sys->mouse_button_down != NULL);
 
     /* Get splitter name if present */
     sys->splitter_name = config_GetType("video-splitter") ?
@@ -1863,6 +1939,10 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     vout_InitInterlacingSupport(vout);
 
     sys->is_late_dropped = var_InheritBool(vout, "drop-late-frames");
+    sys->low_delay = var_InheritBool(vout, "low-delay");
+    sys->pacing_enabled = var_InheritBool(vout, "video-pacing");
+    vout_pacing_Init(&sys->pacing,
+                     var_InheritFloat(vout, "display-refresh-rate"));
 
     vlc_mutex_init(&sys->filter.lock);
 
@@ -1882,6 +1962,7 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     if (sys->splitter_name != NULL)
         var_Destroy(vout, "window");
     sys->window_enabled = false;
+    sys->dec_device = NULL;
     vlc_mutex_init(&sys->window_lock);
 
     /* Arbitrary initial time */
@@ -1974,6 +2055,7 @@ int vout_Request(const vout_configuration_t *cfg, input_thread_t *input)
     if (vout_Start(vout, cfg))
     {
         vlc_mutex_lock(&sys->window_lock);
+        vout_ReleaseDevice(vout);
         vout_window_Disable(sys->display_cfg.window);
         sys->window_enabled = false;
         vlc_mutex_unlock(&sys->window_lock);
@@ -32,6 +32,7 @@
 #include "vout_wrapper.h"
 #include "statistic.h"
 #include "chrono.h"
+#include "pacing.h"
 #include "../clock/clock.h"
 #include "../input/input_internal.h"
 
@@ -111,6 +112,10 @@ struct vout_thread_sys_t
     /* Statistics */
     vout_statistic_t statistic;
 
+    /* Frame pacing */
+    bool            pacing_enabled;
+    vout_pacing_t   pacing;
+
     /* Subpicture unit */
     vlc_mutex_t     spu_lock;
     spu_t           *spu;
@@ -154,6 +159,7 @@ struct vout_thread_sys_t
 
     /* */
     bool            is_late_dropped;
+    bool            low_delay; /* display pictures as soon as decoded */
 
     /* Video filter2 chain */
     struct {
@@ -169,10 +175,15 @@ struct vout_thread_sys_t
     vlc_mouse_t     mouse;
     vlc_mouse_event mouse_event;
     void            *mouse_opaque;
+    struct variable_t *mouse_moved; /* handles of the mouse variables */
+    struct variable_t *mouse_button_down;
 
     /* Video output window */
     bool            window_enabled;
     vlc_mutex_t     window_lock;
+    /* Decoder device of the window, kept while the window is enabled so
+     * that it is not created again for each display */
+    vlc_decoder_device *dec_device;
 
     /* Video output display */
     vout_display_cfg_t display_cfg;
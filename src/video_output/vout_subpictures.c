@@ -124,6 +124,10 @@ struct spu_private_t {
         video_format_t  fmtsrc;
         video_format_t  fmtdst;
         vlc_fourcc_t    chroma_list[SPU_CHROMALIST_COUNT+1];
+        bool            external_scale;
+        bool            force_palette;
+        filter_t       *scale_yuvp;     /**< prerendering thread scalers */
+        filter_t       *scale;
     } prerender;
 
     /* */
@@ -777,6 +781,78 @@ spu_SelectSubpictures(spu_t *spu, vlc_tick_t system_now,
 /**
  * It will transform the provided region into another region suitable for rendering.
  */
+/**
+ * Converts and scales a region picture into its cache (region->p_private)
+ */
+static void SpuRegionScale(spu_t *spu, filter_t *scale_yuvp, filter_t *scale,
+                           subpicture_region_t *region,
+                           const spu_scale_t scale_size,
+                           unsigned dst_width, unsigned dst_height,
+                           bool convert_chroma,
+                           const vlc_fourcc_t *chroma_list)
+{
+    const bool using_palette = region->fmt.i_chroma == VLC_CODEC_YUVP;
+    picture_t *picture = region->p_picture;
+    picture_Hold(picture);
+
+    /* Convert YUVP to YUVA/RGBA first for better scaling quality */
+    if (using_palette) {
+        scale_yuvp->fmt_in.video = region->fmt;
+
+        scale_yuvp->fmt_out.video = region->fmt;
+        scale_yuvp->fmt_out.video.i_chroma = chroma_list[0];
+
+        picture = scale_yuvp->pf_video_filter(scale_yuvp, picture);
+        if (!picture) {
+            /* Well we will try conversion+scaling */
+            msg_Warn(spu, "%4.4s to %4.4s conversion failed",
+                     (const char*)&scale_yuvp->fmt_in.video.i_chroma,
+                     (const char*)&scale_yuvp->fmt_out.video.i_chroma);
+        }
+    }
+
+    /* Conversion(except from YUVP)/Scaling */
+    if (picture &&
+        (picture->format.i_visible_width  != dst_width ||
+         picture->format.i_visible_height != dst_height ||
+         (convert_chroma && !using_palette)))
+    {
+        scale->fmt_in.video  = picture->format;
+        scale->fmt_out.video = picture->format;
+        if (using_palette)
+            scale->fmt_in.video.i_chroma = chroma_list[0];
+        if (convert_chroma)
+            scale->fmt_out.i_codec        =
+            scale->fmt_out.video.i_chroma = chroma_list[0];
+
+        scale->fmt_out.video.i_width  = dst_width;
+        scale->fmt_out.video.i_height = dst_height;
+
+        scale->fmt_out.video.i_visible_width =
+            spu_scale_w(region->fmt.i_visible_width, scale_size);
+        scale->fmt_out.video.i_visible_height =
+            spu_scale_h(region->fmt.i_visible_height, scale_size);
+
+        picture = scale->pf_video_filter(scale, picture);
+        if (!picture)
+            msg_Err(spu, "scaling failed");
+    }
+
+    /* */
+    if (picture) {
+        region->p_private = subpicture_region_private_New(&picture->format);
+        if (region->p_private) {
+            region->p_private->p_picture = picture;
+            if (!region->p_private->p_picture) {
+                subpicture_region_private_Delete(region->p_private);
+                region->p_private = NULL;
+            }
+        } else {
+            picture_Release(picture);
+        }
+    }
+}
+
 static void SpuRenderRegion(spu_t *spu,
                             subpicture_region_t **dst_ptr, spu_area_t *dst_area,
                             const spu_render_entry_t *entry, subpicture_region_t *region,
@@ -976,71 +1052,10 @@ static void SpuRenderRegion(spu_t *spu,
         }
 
         /* Scale if needed into cache */
-        if (!region->p_private && dst_width > 0 && dst_height > 0) {
-            filter_t *scale = sys->scale;
-
-            picture_t *picture = region->p_picture;
-            picture_Hold(picture);
-
-            /* Convert YUVP to YUVA/RGBA first for better scaling quality */
-            if (using_palette) {
-                filter_t *scale_yuvp = sys->scale_yuvp;
-
-                scale_yuvp->fmt_in.video = region->fmt;
-
-                scale_yuvp->fmt_out.video = region->fmt;
-                scale_yuvp->fmt_out.video.i_chroma = chroma_list[0];
-
-                picture = scale_yuvp->pf_video_filter(scale_yuvp, picture);
-                if (!picture) {
-                    /* Well we will try conversion+scaling */
-                    msg_Warn(spu, "%4.4s to %4.4s conversion failed",
-                             (const char*)&scale_yuvp->fmt_in.video.i_chroma,
-                             (const char*)&scale_yuvp->fmt_out.video.i_chroma);
-                }
-            }
-
-            /* Conversion(except from YUVP)/Scaling */
-            if (picture &&
-                (picture->format.i_visible_width  != dst_width ||
-                 picture->format.i_visible_height != dst_height ||
-                 (convert_chroma && !using_palette)))
-            {
-                scale->fmt_in.video  = picture->format;
-                scale->fmt_out.video = picture->format;
-                if (using_palette)
-                    scale->fmt_in.video.i_chroma = chroma_list[0];
-                if (convert_chroma)
-                    scale->fmt_out.i_codec        =
-                    scale->fmt_out.video.i_chroma = chroma_list[0];
-
-                scale->fmt_out.video.i_width  = dst_width;
-                scale->fmt_out.video.i_height = dst_height;
-
-                scale->fmt_out.video.i_visible_width =
-                    spu_scale_w(region->fmt.i_visible_width, scale_size);
-                scale->fmt_out.video.i_visible_height =
-                    spu_scale_h(region->fmt.i_visible_height, scale_size);
-
-                picture = scale->pf_video_filter(scale, picture);
-                if (!picture)
-                    msg_Err(spu, "scaling failed");
-            }
-
-            /* */
-            if (picture) {
-                region->p_private = subpicture_region_private_New(&picture->format);
-                if (region->p_private) {
-                    region->p_private->p_picture = picture;
-                    if (!region->p_private->p_picture) {
-                        subpicture_region_private_Delete(region->p_private);
-                        region->p_private = NULL;
-                    }
-                } else {
-                    picture_Release(picture);
-                }
-            }
-        }
+        if (!region->p_private && dst_width > 0 && dst_height > 0)
+            SpuRegionScale(spu, sys->scale_yuvp, sys->scale, region,
+                           scale_size, dst_width, dst_height,
+                           convert_chroma, chroma_list);
 
         /* And use the scaled picture */
         if (region->p_private) {
@@ -1401,9 +1416,12 @@ static int SubSourceDelProxyCallbacks(filter_t *filter, void *opaque)
 static void spu_PrerenderWake(spu_private_t *sys,
                               const video_format_t *fmt_dst,
                               const video_format_t *fmt_src,
-                              const vlc_fourcc_t *chroma_list)
+                              const vlc_fourcc_t *chroma_list,
+                              bool external_scale, bool force_palette)
 {
     vlc_mutex_lock(&sys->prerender.lock);
+    sys->prerender.external_scale = external_scale;
+    sys->prerender.force_palette = force_palette;
     if(!video_format_IsSimilar(fmt_dst, &sys->prerender.fmtdst))
     {
         video_format_Clean(&sys->prerender.fmtdst);
@@ -1504,11 +1522,75 @@ static void spu_PrerenderText(spu_t *spu, subpicture_t *p_subpic,
     }
 }
 
+/* Converts and scales the regions to the output size ahead of
+ * SpuRenderRegion(), which then finds them in the region cache */
+static void spu_PrerenderScale(spu_t *spu, subpicture_t *p_subpic,
+                               const video_format_t *fmtdst,
+                               const vlc_fourcc_t *chroma_list,
+                               bool external_scale, bool force_palette)
+{
+    spu_private_t *sys = spu->p;
+
+    if (!sys->prerender.scale || !sys->prerender.scale_yuvp ||
+        p_subpic->i_original_picture_height <= 0)
+        return;
+
+    subpicture_region_t *region;
+    for (region = p_subpic->p_region; region != NULL; region = region->p_next)
+    {
+        /* Skip failed text renderings, cached regions, and palettes forced
+         * at rendering time */
+        if (region->fmt.i_chroma == VLC_CODEC_TEXT || region->p_private ||
+            region->p_picture == NULL ||
+            (force_palette && region->fmt.i_chroma == VLC_CODEC_YUVP))
+            continue;
+
+        video_format_AdjustColorSpace(&region->fmt);
+
+        video_format_t region_fmt = region->fmt;
+        if (region_fmt.i_sar_num <= 0 || region_fmt.i_sar_den <= 0) {
+            const uint64_t i_sar_num = (uint64_t)fmtdst->i_visible_width  *
+                                       fmtdst->i_sar_num * p_subpic->i_original_picture_height;
+            const uint64_t i_sar_den = (uint64_t)fmtdst->i_visible_height *
+                                       fmtdst->i_sar_den * p_subpic->i_original_picture_width;
+
+            vlc_ureduce(&region_fmt.i_sar_num, &region_fmt.i_sar_den,
+                        i_sar_num, i_sar_den, 65536);
+        }
+
+        /* Same scale as SpuRenderSubpictures() */
+        spu_scale_t scale = external_scale ? spu_scale_unit() :
+            spu_scale_createq((int64_t)fmtdst->i_visible_height * fmtdst->i_sar_den * region_fmt.i_sar_num,
+                              (int64_t)p_subpic->i_original_picture_height * fmtdst->i_sar_num * region_fmt.i_sar_den,
+                              fmtdst->i_visible_height,
+                              p_subpic->i_original_picture_height);
+        if (scale.w <= 0 || scale.h <= 0)
+            continue;
+
+        bool convert_chroma = true;
+        for (int i = 0; chroma_list[i] && convert_chroma; i++) {
+            if (region->fmt.i_chroma == chroma_list[i])
+                convert_chroma = false;
+        }
+        if (scale.w == SCALE_UNIT && scale.h == SCALE_UNIT && !convert_chroma)
+            continue;
+
+        const unsigned dst_width  = spu_scale_w(region->fmt.i_visible_width,  scale);
+        const unsigned dst_height = spu_scale_h(region->fmt.i_visible_height, scale);
+        if (dst_width > 0 && dst_height > 0)
+            SpuRegionScale(spu, sys->prerender.scale_yuvp, sys->prerender.scale,
+                           region, scale, dst_width, dst_height,
+                           convert_chroma, chroma_list);
+    }
+}
+
 struct spu_prerender_ctx_s
 {
     video_format_t fmtsrc;
     video_format_t fmtdst;
     vlc_fourcc_t chroma_list[SPU_CHROMALIST_COUNT+1];
+    bool external_scale;
+    bool force_palette;
     vlc_mutex_t *cleanuplock;
     subpicture_t **pp_processed;
 };
@@ -1552,7 +1634,10 @@ static void * spu_PrerenderThread(void *priv)
              }
         }
         vlc_vector_remove(&sys->prerender.vector, i_idx);
-        memcpy(&ctx.chroma_list, sys->prerender.chroma_list, SPU_CHROMALIST_COUNT);
+        memcpy(&ctx.chroma_list, sys->prerender.chroma_list,
+               SPU_CHROMALIST_COUNT * sizeof(*ctx.chroma_list));
+        ctx.external_scale = sys->prerender.external_scale;
+        ctx.force_palette = sys->prerender.force_palette;
         video_format_Clean(&ctx.fmtdst);
         video_format_Clean(&ctx.fmtsrc);
         video_format_Copy(&ctx.fmtdst, &sys->prerender.fmtdst);
@@ -1564,6 +1649,9 @@ static void * spu_PrerenderThread(void *priv)
         int canc = vlc_savecancel();
         spu_PrerenderText(spu, sys->prerender.p_processed,
                           &ctx.fmtsrc, &ctx.fmtdst, ctx.chroma_list);
+        spu_PrerenderScale(spu, sys->prerender.p_processed,
+                           &ctx.fmtdst, ctx.chroma_list,
+                           ctx.external_scale, ctx.force_palette);
         vlc_restorecancel(canc);
 
         vlc_mutex_lock(&sys->prerender.lock);
@@ -1592,6 +1680,12 @@ static void spu_Cleanup(spu_t *spu)
     if (sys->scale)
         FilterRelease(sys->scale);
 
+    if (sys->prerender.scale_yuvp)
+        FilterRelease(sys->prerender.scale_yuvp);
+
+    if (sys->prerender.scale)
+        FilterRelease(sys->prerender.scale);
+
     filter_chain_ForEach(sys->source_chain, SubSourceClean, spu);
     if (sys->vout)
         filter_chain_ForEach(sys->source_chain,
@@ -1698,6 +1792,13 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->scale_yuvp = SpuRenderCreateAndLoadScale(VLC_OBJECT(spu),
                                                   VLC_CODEC_YUVP, VLC_CODEC_YUVA, false);
 
+    /* Private instances for the prerendering thread, which goes without
+     * prescaled regions if they can't be loaded */
+    sys->prerender.scale = SpuRenderCreateAndLoadScale(VLC_OBJECT(spu),
+                                                       VLC_CODEC_YUVA, VLC_CODEC_RGBA, true);
+    sys->prerender.scale_yuvp = SpuRenderCreateAndLoadScale(VLC_OBJECT(spu),
+                                                            VLC_CODEC_YUVP, VLC_CODEC_YUVA, false);
+
 
     if (!sys->source_chain || !sys->filter_chain || !sys->text || !sys->scale
      || !sys->scale_yuvp)
@@ -1952,8 +2053,13 @@ subpicture_t *spu_Render(spu_t *spu,
         chroma_list = vlc_fourcc_IsYUV(fmt_dst->i_chroma) ? chroma_list_default_yuv
                                                           : chroma_list_default_rgb;
 
+    vlc_mutex_lock(&sys->lock);
+    const bool force_palette = sys->palette.i_entries > 0;
+    vlc_mutex_unlock(&sys->lock);
+
     /* wake up prerenderer, we have some video size and chroma */
-    spu_PrerenderWake(sys, fmt_dst, fmt_src, chroma_list);
+    spu_PrerenderWake(sys, fmt_dst, fmt_src, chroma_list,
+                      external_scale, force_palette);
 
     vlc_mutex_lock(&sys->lock);
 
@@ -30,6 +30,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_vout.h>
+#include <vlc_codec.h>
 #include <assert.h>
 #include "vout_internal.h"
 #include "display.h"
@@ -48,6 +49,16 @@ static void VoutViewpointMoved(void *sys, const vlc_viewpoint_t *vp)
     var_SetAddress(vout, "viewpoint-moved", (void*)vp);
 }
 
+static void VoutPresented(void *sys, vlc_tick_t expected, vlc_tick_t presented,
+                          vlc_tick_t refresh)
+{
+    vout_thread_t *vout = sys;
+
+    /* Sent from the display callbacks, under the display lock */
+    if (vout->p->pacing_enabled)
+        vout_pacing_Presented(&vout->p->pacing, expected, presented, refresh);
+}
+
 /* Minimum number of display picture */
 #define DISPLAY_PICTURE_COUNT (1)
 
@@ -60,7 +71,8 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout,
     vout_thread_sys_t *sys = vout->p;
     vout_display_t *vd;
     vout_display_owner_t owner = {
-        .viewpoint_moved = VoutViewpointMoved, .sys = vout,
+        .viewpoint_moved = VoutViewpointMoved, .presented = VoutPresented,
+        .sys = vout,
     };
     const char *modlist;
     char *modlistbuf = NULL;
@@ -72,8 +84,13 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout,
     else
         modlist = "splitter,none";
 
-    vd = vout_display_New(VLC_OBJECT(vout), &sys->original, cfg, modlist,
-                          &owner);
+    /* The decoder device only depends on the window: keep it across
+     * displays, as creating it can be expensive (e.g. hardware contexts). */
+    if (sys->dec_device == NULL)
+        sys->dec_device = vlc_decoder_device_Create(cfg->window);
+
+    vd = vout_display_NewWithDevice(VLC_OBJECT(vout), &sys->original, cfg,
+                                    modlist, &owner, sys->dec_device);
     free(modlistbuf);
 
     if (vd == NULL)
@@ -90,7 +107,9 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout,
     const unsigned reserved_picture = DISPLAY_PICTURE_COUNT +
                                       private_picture +
                                       kept_picture;
-    const unsigned display_pool_size = allow_dr ? __MAX(VOUT_MAX_PICTURES,
+    /* In low delay mode, do not allocate more than the decoder needs */
+    const unsigned min_pictures = sys->low_delay ? 0 : VOUT_MAX_PICTURES;
+    const unsigned display_pool_size = allow_dr ? __MAX(min_pictures,
                                                         reserved_picture + decoder_picture) : 3;
     picture_pool_t *display_pool = vout_GetPool(vd, display_pool_size);
     if (display_pool == NULL)
@@ -111,7 +130,7 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout,
     } else {
         sys->decoder_pool = decoder_pool =
             picture_pool_NewFromFormat(&vd->source,
-                                       __MAX(VOUT_MAX_PICTURES,
+                                       __MAX(min_pictures,
                                              reserved_picture + decoder_picture - DISPLAY_PICTURE_COUNT));
         if (!sys->decoder_pool)
             goto error;
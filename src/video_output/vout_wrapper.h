@@ -29,6 +29,17 @@
 
 picture_pool_t *vout_GetPool(vout_display_t *vd, unsigned count);
 
+/**
+ * Creates a display like vout_display_New(), but with an existing decoder
+ * device (if not NULL) rather than a new one created from the window.
+ */
+vout_display_t *vout_display_NewWithDevice(vlc_object_t *,
+                                           const video_format_t *,
+                                           const vout_display_cfg_t *,
+                                           const char *module,
+                                           const vout_display_owner_t *,
+                                           vlc_decoder_device *);
+
 /**
  * It destroy a vout managed display.
  */
@@ -126,6 +126,54 @@ static void test_media_preparsed(libvlc_instance_t *vlc, const char *path,
     libvlc_media_release (media);
 }
 
+static void test_media_preparsed_batch(libvlc_instance_t *vlc)
+{
+    test_log ("test_media_preparsed_batch\n");
+
+    static const char *const locations[] = {
+        "http://parsing_should_be_skipped.org/b.mp4",
+        "unknown://parsing_should_be_skipped.org/video.mp4",
+        "http://parsing_should_be_skipped.org/a.mp4",
+    };
+    const size_t count = ARRAY_SIZE(locations) + 1;
+    libvlc_media_t *medias[ARRAY_SIZE(locations) + 1];
+    vlc_sem_t sem;
+
+    vlc_sem_init (&sem, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i < ARRAY_SIZE(locations))
+            medias[i] = libvlc_media_new_location (vlc, locations[i]);
+        else
+            medias[i] = libvlc_media_new_path (vlc, SRCDIR"/samples/image.jpg");
+        assert (medias[i] != NULL);
+
+        libvlc_event_manager_t *em = libvlc_media_event_manager (medias[i]);
+        libvlc_event_attach (em, libvlc_MediaParsedChanged, media_parse_ended,
+                             &sem);
+    }
+
+    int i_ret = libvlc_media_parse_batch (medias, count,
+                                          libvlc_media_parse_local, -1);
+    assert (i_ret == (int)count);
+    for (size_t i = 0; i < count; i++)
+        vlc_sem_wait (&sem);
+    vlc_sem_destroy (&sem);
+
+    /* Already parsed */
+    assert (libvlc_media_parse_batch (medias, count,
+                                      libvlc_media_parse_local, -1) == 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        assert (libvlc_media_get_parsed_status (medias[i])
+                == (i < ARRAY_SIZE(locations)
+                    ? libvlc_media_parsed_status_skipped
+                    : libvlc_media_parsed_status_done));
+        libvlc_media_release (medias[i]);
+    }
+}
+
 static void input_item_preparse_timeout( input_item_t *item,
                                          enum input_item_preparse_status status,
                                          void *user_data )
@@ -368,6 +416,7 @@ int main(int i_argc, char *ppsz_argv[])
     test_media_preparsed (vlc, NULL, "unknown://parsing_should_be_skipped.org/video.mp4",
                           libvlc_media_parse_local,
                           libvlc_media_parsed_status_skipped);
+    test_media_preparsed_batch (vlc);
     test_media_subitems (vlc);
 
     /* Testing libvlc_MetadataRequest timeout and libvlc_MetadataCancel. For
@@ -0,0 +1,163 @@
+/*****************************************************************************
+ * scaletempo.c: Scaletempo benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs stereo and 5.1 speech-like signals through the scaletempo filter at
+ * playback rates from 0.5x to 4x, checks that the output duration matches
+ * the rate, and prints one JSON result per rate.
+ *
+ * Usage: test_modules_audio_filter_scaletempo [seconds]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include "../../../lib/libvlc_internal.h"
+#include <vlc/vlc.h>
+
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_tick.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RATE  48000
+#define BLOCK 1024 /* frames per input block */
+
+static const double rates[] = { 0.5, 0.75, 1.25, 1.5, 2., 3., 4. };
+
+static const uint16_t layouts[] = { AOUT_CHANS_STEREO, AOUT_CHANS_5_1 };
+
+static int Bench(vlc_object_t *obj, uint16_t layout, double rate,
+                 unsigned seconds)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    if (filter == NULL)
+        return 1;
+
+    audio_format_t fmt = {
+        .i_format = VLC_CODEC_FL32,
+        .i_rate = RATE,
+        .i_physical_channels = layout,
+    };
+    aout_FormatPrepare(&fmt);
+    filter->fmt_in.i_codec = filter->fmt_out.i_codec = VLC_CODEC_FL32;
+    filter->fmt_in.audio = filter->fmt_out.audio = fmt;
+
+    filter->p_module = module_need(filter, "audio filter", "scaletempo", true);
+    if (filter->p_module == NULL)
+    {
+        fprintf(stderr, "can't load scaletempo\n");
+        vlc_object_delete(filter);
+        return 1;
+    }
+
+    /* The input rate is scaled by the playback rate, as in the output */
+    filter->fmt_in.audio.i_rate = lround(RATE * rate);
+
+    const unsigned channels = fmt.i_channels;
+    const size_t blocks = (size_t)seconds * RATE / BLOCK;
+    size_t frames_in = 0, frames_out = 0;
+    vlc_tick_t elapsed = 0;
+    int ret = 0;
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        block_t *in = block_Alloc(BLOCK * channels * sizeof (float));
+        if (in == NULL)
+        {
+            ret = 1;
+            break;
+        }
+        in->i_nb_samples = BLOCK;
+        in->i_pts = VLC_TICK_0 + vlc_tick_from_samples(frames_in, RATE);
+
+        /* Voiced fundamental with harmonics and a slow vibrato */
+        float *p = (float *)in->p_buffer;
+        for (unsigned i = 0; i < BLOCK; i++)
+        {
+            double t = (double)(frames_in + i) / RATE;
+            double f0 = 140. + 20. * sin(2. * M_PI * 3. * t);
+            float v = .3 * sin(2. * M_PI * f0 * t)
+                    + .2 * sin(4. * M_PI * f0 * t)
+                    + .1 * sin(6. * M_PI * f0 * t);
+            for (unsigned c = 0; c < channels; c++)
+                *p++ = v * (1.f - .1f * c);
+        }
+        frames_in += BLOCK;
+
+        vlc_tick_t start = vlc_tick_now();
+        block_t *out = filter->pf_audio_filter(filter, in);
+        elapsed += vlc_tick_now() - start;
+
+        if (out != NULL)
+        {
+            frames_out += out->i_nb_samples;
+            block_Release(out);
+        }
+    }
+
+    /* The filter holds back up to its queue, search window and stride */
+    const double expected = frames_in / rate;
+    if (ret == 0 && fabs(frames_out - expected) > .2 * RATE)
+    {
+        fprintf(stderr, "%.2fx: %zu frames out, expected about %.0f\n",
+                rate, frames_out, expected);
+        ret = 1;
+    }
+
+    const double secs = (double)US_FROM_VLC_TICK(elapsed) / 1000000.;
+    printf("{\"channels\":%u,\"rate\":%.2f,\"seconds\":%u,"
+           "\"ms_total\":%.1f,\"realtime_factor\":%.1f}\n",
+           channels, rate, seconds, secs * 1000.,
+           secs > 0. ? frames_in / (double)RATE / secs : 0.);
+
+    module_unneed(filter, filter->p_module);
+    vlc_object_delete(filter);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 20;
+    if (seconds == 0)
+        seconds = 1;
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 77;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    int ret = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(layouts); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(rates); j++)
+            ret |= Bench(obj, layouts[i], rates[j], seconds);
+
+    libvlc_release(vlc);
+    return ret;
+}
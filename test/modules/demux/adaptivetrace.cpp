@@ -0,0 +1,330 @@
+/*****************************************************************************
+ * adaptivetrace.cpp: adaptive logics network trace replay
+ *****************************************************************************
+ * Copyright (C) 2019 VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Replays bandwidth/latency traces against the adaptation logics, with
+ * a simulated player buffer, and prints one JSON summary per run.
+ *
+ * Usage: test_modules_demux_adaptivetrace [logic trace_file]
+ *
+ * Trace files have one "duration_ms bandwidth_kbps latency_ms" step
+ * per line, looped when the session outlasts the trace. Without
+ * arguments, every logic is run against the builtin traces.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include "../../../lib/libvlc_internal.h"
+#include <vlc/vlc.h>
+
+#include "logic/AbstractAdaptationLogic.h"
+#include "logic/RateBasedAdaptationLogic.h"
+#include "logic/PredictiveAdaptationLogic.hpp"
+#include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/BufferBasedAdaptationLogic.hpp"
+#include "playlist/BaseAdaptationSet.h"
+#include "playlist/BaseRepresentation.h"
+#include "SegmentTracker.hpp"
+#include "ID.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::logic;
+using namespace adaptive::playlist;
+
+#define SEGMENT_DURATION VLC_TICK_FROM_SEC(2)
+#define SEGMENT_COUNT    150
+#define BUFFERING_MIN    VLC_TICK_FROM_SEC(6)
+#define BUFFERING_MAX    VLC_TICK_FROM_SEC(30)
+
+static const uint64_t bitrates[] = {
+    400000, 800000, 1500000, 3000000, 6000000,
+};
+
+struct TraceStep
+{
+    vlc_tick_t duration;
+    uint64_t   bps;
+    vlc_tick_t latency;
+};
+
+struct Summary
+{
+    unsigned   segments;
+    unsigned   rebuffers;
+    unsigned   switches;
+    vlc_tick_t startup;
+    vlc_tick_t stalled;
+    uint64_t   bitrate; /* average */
+};
+
+static const char *const logics[] = {
+    "rate", "predictive", "nearoptimal", "buffer",
+};
+
+static AbstractAdaptationLogic *CreateLogic(vlc_object_t *obj, const char *name)
+{
+    if(!strcmp(name, "rate"))
+        return new RateBasedAdaptationLogic(obj);
+    if(!strcmp(name, "predictive"))
+        return new PredictiveAdaptationLogic(obj);
+    if(!strcmp(name, "nearoptimal"))
+        return new NearOptimalAdaptationLogic(obj);
+    if(!strcmp(name, "buffer"))
+        return new BufferBasedAdaptationLogic(obj);
+    return NULL;
+}
+
+static bool LoadTrace(const char *path, std::vector<TraceStep> &trace)
+{
+    std::ifstream in(path);
+    if(!in.is_open())
+        return false;
+
+    unsigned duration, kbps, latency;
+    while(in >> duration >> kbps >> latency)
+    {
+        TraceStep step = { VLC_TICK_FROM_MS(duration), (uint64_t)kbps * 1000,
+                           VLC_TICK_FROM_MS(latency) };
+        if(step.duration > 0 && step.bps > 0)
+            trace.push_back(step);
+    }
+    return !trace.empty();
+}
+
+static void BuiltinTraces(std::vector< std::vector<TraceStep> > &traces,
+                          std::vector<const char *> &names)
+{
+    /* stable broadband */
+    std::vector<TraceStep> stable;
+    TraceStep s = { VLC_TICK_FROM_SEC(60), 8000000, VLC_TICK_FROM_MS(20) };
+    stable.push_back(s);
+    traces.push_back(stable);
+    names.push_back("stable");
+
+    /* flaky mobile, fast alternating capacity */
+    std::vector<TraceStep> mobile;
+    const unsigned kbps[] = { 4000, 600, 2500, 300, 1800, 900, 5000, 400 };
+    for(int i = 0; i < (int)ARRAY_SIZE(kbps); i++)
+    {
+        TraceStep m = { VLC_TICK_FROM_SEC(3 + i % 3), (uint64_t)kbps[i] * 1000,
+                        VLC_TICK_FROM_MS(80 + 40 * (i % 4)) };
+        mobile.push_back(m);
+    }
+    traces.push_back(mobile);
+    names.push_back("mobile");
+
+    /* sustained drop */
+    std::vector<TraceStep> drop;
+    TraceStep d1 = { VLC_TICK_FROM_SEC(60), 6000000, VLC_TICK_FROM_MS(30) };
+    TraceStep d2 = { VLC_TICK_FROM_SEC(90), 700000, VLC_TICK_FROM_MS(150) };
+    drop.push_back(d1);
+    drop.push_back(d2);
+    traces.push_back(drop);
+    names.push_back("drop");
+}
+
+/* Time to transfer size bytes starting at now, following the trace */
+static vlc_tick_t TransferTime(const std::vector<TraceStep> &trace,
+                               vlc_tick_t now, uint64_t size)
+{
+    vlc_tick_t total = 0;
+    for(size_t i = 0; i < trace.size(); i++)
+        total += trace[i].duration;
+
+    /* locate current step */
+    vlc_tick_t offset = now % total;
+    size_t i = 0;
+    while(offset >= trace[i].duration)
+        offset -= trace[i++].duration;
+
+    vlc_tick_t elapsed = trace[i].latency;
+    double bits = size * 8.0;
+    for(;;)
+    {
+        const TraceStep &step = trace[i];
+        const vlc_tick_t remain = step.duration - offset;
+        const double capacity = (double)step.bps * remain / CLOCK_FREQ;
+        if(bits <= capacity)
+            return elapsed + (vlc_tick_t)(bits * CLOCK_FREQ / step.bps);
+        bits -= capacity;
+        elapsed += remain;
+        offset = 0;
+        i = (i + 1) % trace.size();
+    }
+}
+
+static Summary Replay(AbstractAdaptationLogic *logic, BaseAdaptationSet *set,
+                      const std::vector<TraceStep> &trace)
+{
+    Summary sum;
+    memset(&sum, 0, sizeof(sum));
+    sum.startup = -1;
+
+    const ID &id = set->getID();
+    vlc_tick_t now = 0;
+    vlc_tick_t buffering = 0;
+    bool playing = false;
+    uint64_t totalbitrate = 0;
+    BaseRepresentation *prev = NULL;
+
+    logic->trackerEvent(SegmentTrackerEvent(id, true));
+
+    for(unsigned n = 0; n < SEGMENT_COUNT; n++)
+    {
+        /* Buffer full: wait for playback to drain it */
+        if(playing && buffering + SEGMENT_DURATION > BUFFERING_MAX)
+        {
+            const vlc_tick_t wait = buffering + SEGMENT_DURATION - BUFFERING_MAX;
+            now += wait;
+            buffering -= wait;
+        }
+
+        BaseRepresentation *rep = logic->getNextRepresentation(set, prev);
+        assert(rep);
+        if(rep != prev)
+        {
+            if(prev)
+                sum.switches++;
+            logic->trackerEvent(SegmentTrackerEvent(prev, rep));
+        }
+
+        const uint64_t size = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ / 8;
+        const vlc_tick_t transfer = TransferTime(trace, now, size);
+        now += transfer;
+        logic->updateDownloadRate(id, size, transfer);
+
+        if(playing)
+        {
+            buffering -= transfer;
+            if(buffering < 0)
+            {
+                sum.rebuffers++;
+                sum.stalled -= buffering;
+                buffering = 0;
+                playing = false;
+            }
+        }
+
+        buffering += SEGMENT_DURATION;
+        if(!playing && buffering >= BUFFERING_MIN)
+        {
+            playing = true;
+            if(sum.startup < 0)
+                sum.startup = now;
+        }
+
+        logic->trackerEvent(SegmentTrackerEvent(id, BUFFERING_MIN, buffering,
+                                                BUFFERING_MAX));
+        totalbitrate += rep->getBandwidth();
+        sum.segments++;
+        prev = rep;
+    }
+
+    logic->trackerEvent(SegmentTrackerEvent(prev, NULL));
+    logic->trackerEvent(SegmentTrackerEvent(id, false));
+
+    sum.bitrate = totalbitrate / sum.segments;
+    return sum;
+}
+
+static void PrintSummary(const char *logic, const char *trace, const Summary &sum)
+{
+    printf("{\"logic\":\"%s\",\"trace\":\"%s\",\"segments\":%u,"
+           "\"startup_ms\":%" PRId64 ",\"rebuffers\":%u,\"rebuffer_ms\":%" PRId64 ","
+           "\"avg_bitrate\":%" PRIu64 ",\"switches\":%u}\n",
+           logic, trace, sum.segments, MS_FROM_VLC_TICK(sum.startup),
+           sum.rebuffers, MS_FROM_VLC_TICK(sum.stalled), sum.bitrate, sum.switches);
+}
+
+static int RunOne(vlc_object_t *obj, const char *logicname, const char *tracename,
+                  const std::vector<TraceStep> &trace)
+{
+    BaseAdaptationSet *set = new BaseAdaptationSet(NULL);
+    set->setID(ID("video"));
+    for(size_t i = 0; i < ARRAY_SIZE(bitrates); i++)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setBandwidth(bitrates[i]);
+        set->addRepresentation(rep);
+    }
+
+    AbstractAdaptationLogic *logic = CreateLogic(obj, logicname);
+    if(!logic)
+    {
+        fprintf(stderr, "unknown logic %s\n", logicname);
+        delete set;
+        return 1;
+    }
+
+    Summary sum = Replay(logic, set, trace);
+    PrintSummary(logicname, tracename, sum);
+
+    assert(sum.segments == SEGMENT_COUNT);
+    assert(sum.startup >= 0);
+    assert(sum.bitrate >= bitrates[0]);
+    assert(sum.bitrate <= bitrates[ARRAY_SIZE(bitrates) - 1]);
+
+    delete logic;
+    delete set;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if(!vlc)
+        return 77;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    int ret = 0;
+    if(argc == 3)
+    {
+        std::vector<TraceStep> trace;
+        if(!LoadTrace(argv[2], trace))
+        {
+            fprintf(stderr, "can't load trace %s\n", argv[2]);
+            ret = 1;
+        }
+        else ret = RunOne(obj, argv[1], argv[2], trace);
+    }
+    else
+    {
+        std::vector< std::vector<TraceStep> > traces;
+        std::vector<const char *> names;
+        BuiltinTraces(traces, names);
+        for(size_t i = 0; i < traces.size() && !ret; i++)
+            for(size_t j = 0; j < ARRAY_SIZE(logics) && !ret; j++)
+                ret = RunOne(obj, logics[j], names[i], traces[i]);
+    }
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -64,32 +64,156 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+static const uint8_t * find_sse2( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find_SSE2( p, end, 0x01 );
+}
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+static const uint8_t * find_avx2( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find_AVX2( p, end, 0x01 );
+}
+#endif
+#ifdef HAVE_STARTCODE_NEON
+static const uint8_t * find_neon( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find_NEON( p, end, 0x01 );
+}
+#endif
+
+static const struct
+{
+    const char *psz_name;
+    const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *);
+    unsigned i_cpu;
+} finders[] = {
+    { "bits", startcode_FindAnnexB_Bits, 0 },
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    { "sse2", find_sse2, VLC_CPU_SSE2 },
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    { "avx2", find_avx2, VLC_CPU_AVX2 },
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    { "neon", find_neon, VLC_CPU_ARM_NEON },
+#endif
+};
+
+static bool finder_supported( size_t i )
+{
+    return (vlc_CPU() & finders[i].i_cpu) == finders[i].i_cpu;
+}
+
+/* Returns the first 00 00 <c> byte by byte, as reference */
+static const uint8_t * find_ref( const uint8_t *p, const uint8_t *end, uint8_t c )
+{
+    for( ; end - p >= 3; p++ )
+        if( p[0] == 0 && p[1] == 0 && p[2] == c )
+            return p;
+    return NULL;
+}
+
 static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
                             const struct results_s *p_results, size_t i_results,
                             ssize_t i_results_offset )
 {
-    int i_ret;
-
-    printf("checking bits code:\n");
-    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                       startcode_FindAnnexB_Bits );
-    if( i_ret != 0 )
-        return i_ret;
-
-    /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
     {
-        printf("checking asm:\n");
-        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+        if( !finder_supported( i ) )
+        {
+            printf("%s not supported, skipping test:\n", finders[i].psz_name);
+            continue;
+        }
+
+        printf("checking %s code:\n", finders[i].psz_name);
+        int i_ret = check_set( p_set, p_end, p_results, i_results,
+                               i_results_offset, finders[i].pf_find );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
 
     return 0;
 }
 
+/* Compares every variant with the reference, at all alignments and lengths */
+static int run_random_sets( void )
+{
+    uint8_t *p_data = malloc( 512 );
+    if( p_data == NULL )
+        return 0;
+
+    srand( 0 );
+    for( unsigned i_run = 0; i_run < 20000; i_run++ )
+    {
+        size_t i_offset = rand() % 64;
+        size_t i_size = rand() % (512 - 64);
+        uint8_t *p = &p_data[i_offset];
+
+        for( size_t i = 0; i < i_size; i++ )
+        {
+            int r = rand() % 8;
+            p[i] = (r < 4) ? 0 : (r == 4) ? 1 : (r == 5) ? 3 : rand();
+        }
+
+        const uint8_t *p_ref = find_ref( p, p + i_size, 0x01 );
+        for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
+            if( finder_supported( i )
+             && finders[i].pf_find( p, p + i_size ) != p_ref )
+            {
+                printf("%s mismatch at run %u\n", finders[i].psz_name, i_run);
+                free( p_data );
+                return 1;
+            }
+
+        if( startcode_FindEP3B( p, p + i_size ) != find_ref( p, p + i_size, 0x03 ) )
+        {
+            printf("emulation prevention mismatch at run %u\n", i_run);
+            free( p_data );
+            return 1;
+        }
+    }
+
+    free( p_data );
+    return 0;
+}
+
+/* Times each variant over entropy coded like data */
+static void run_benchmark( void )
+{
+    const size_t i_size = 4 << 20;
+    uint8_t *p_data = malloc( i_size );
+    if( p_data == NULL )
+        return;
+
+    srand( 0 );
+    for( size_t i = 0; i < i_size; i++ )
+    {
+        p_data[i] = rand();
+        /* Escape as an encoder would */
+        if( i >= 2 && p_data[i - 2] == 0 && p_data[i - 1] == 0 && p_data[i] <= 3 )
+            p_data[i] = 3;
+    }
+
+    printf("* Benchmarking:\n");
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
+    {
+        if( !finder_supported( i ) )
+            continue;
+
+        vlc_tick_t start = vlc_tick_now();
+        for( unsigned j = 0; j < 8; j++ )
+            if( finders[i].pf_find( p_data, p_data + i_size ) != NULL )
+                abort();
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        printf("%s: %"PRId64" MiB/s\n", finders[i].psz_name,
+               elapsed > 0 ? (CLOCK_FREQ * 8 * (int64_t)(i_size >> 20)) / elapsed : 0);
+    }
+    free( p_data );
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -134,5 +258,12 @@ int main( void )
             return i_ret;
     }
 
+    printf("* Running tests on random sets:\n");
+    i_ret = run_random_sets();
+    if( i_ret != 0 )
+        return i_ret;
+
+    run_benchmark();
+
     return 0;
 }
@@ -31,6 +31,7 @@
 #include <vlc_block.h>
 #include "../modules/packetizer/hxxx_nal.h"
 #include "../modules/packetizer/hxxx_nal.c"
+#include "../modules/packetizer/hxxx_ep3b.h"
 
 static void test_iterators( const uint8_t *p_ab, size_t i_ab, /* AnnexB */
                             const uint8_t **pp_prefix, size_t *pi_prefix /* Prefixed */ )
@@ -213,9 +214,46 @@ static void test_annexb()
     test_iterators( NULL, 0, p_res, rgi_res );
 }
 
+/* Unescaped size, byte by byte, as reference */
+static size_t ep3b_total_size_ref( const uint8_t *p, const uint8_t *p_end )
+{
+    unsigned i_prev = 0;
+    size_t i = 0;
+    while( p < p_end )
+    {
+        uint8_t *n = hxxx_ep3b_to_rbsp( (uint8_t *)p, (uint8_t *)p_end, &i_prev, 1 );
+        if( n > p )
+            ++i;
+        p = n;
+    }
+    return i;
+}
+
+static void test_ep3b( void )
+{
+    const uint8_t test1[] = { 0x42, 0, 0, 3, 1, 0, 0, 3, 0, 3, 0x42, 0, 0, 3 };
+    assert( hxxx_ep3b_total_size( test1, test1 + sizeof(test1) ) ==
+            sizeof(test1) - 3 );
+
+    uint8_t data[300];
+    srand( 0 );
+    for( unsigned i_run = 0; i_run < 20000; i_run++ )
+    {
+        size_t i_size = rand() % sizeof(data);
+        for( size_t i = 0; i < i_size; i++ )
+        {
+            int r = rand() % 8;
+            data[i] = (r < 4) ? 0 : (r < 6) ? 3 : rand();
+        }
+        assert( hxxx_ep3b_total_size( data, data + i_size ) ==
+                ep3b_total_size_ref( data, data + i_size ) );
+    }
+}
+
 int main( void )
 {
     test_annexb();
+    test_ep3b();
 
     return 0;
 }
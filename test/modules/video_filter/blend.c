@@ -0,0 +1,154 @@
+/*****************************************************************************
+ * blend.c: video blending benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Blends a subtitle sized picture onto a full HD picture for each
+ * supported source and destination chroma, and prints one JSON result
+ * per combination.
+ *
+ * Usage: test_modules_video_filter_blend [loops]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include "../../../lib/libvlc_internal.h"
+#include <vlc/vlc.h>
+
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DST_WIDTH  1920
+#define DST_HEIGHT 1080
+#define SRC_WIDTH  1280
+#define SRC_HEIGHT 200
+
+static const vlc_fourcc_t dst_chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_NV12, VLC_CODEC_NV21,
+    VLC_CODEC_I422, VLC_CODEC_I444, VLC_CODEC_YUYV, VLC_CODEC_UYVY,
+    VLC_CODEC_RGB32, VLC_CODEC_RGBA, VLC_CODEC_BGRA,
+};
+
+static const vlc_fourcc_t src_chromas[] = {
+    VLC_CODEC_YUVA, VLC_CODEC_RGBA,
+};
+
+static picture_t *NewPicture(vlc_fourcc_t chroma, unsigned width,
+                             unsigned height, bool subtitle)
+{
+    video_format_t fmt;
+    video_format_Init(&fmt, chroma);
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    if (pic == NULL)
+        return NULL;
+
+    for (int i = 0; i < pic->i_planes; i++) {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+                p->p_pixels[y * p->i_pitch + x] = rand();
+    }
+
+    if (subtitle) {
+        /* Mostly transparent, with opaque glyphs and antialiased edges */
+        const bool packed = chroma == VLC_CODEC_RGBA;
+        plane_t *p = &pic->p[packed ? 0 : 3];
+        for (int y = 0; y < p->i_lines; y++)
+            for (unsigned x = 0; x < width; x++) {
+                int r = rand() % 8;
+                uint8_t a = r < 5 ? 0 : r < 7 ? 255 : rand();
+                p->p_pixels[y * p->i_pitch + (packed ? 4 * x + 3 : x)] = a;
+            }
+    }
+    return pic;
+}
+
+static int Bench(vlc_object_t *obj, vlc_fourcc_t dst_chroma,
+                 vlc_fourcc_t src_chroma, unsigned loops)
+{
+    int ret = 0;
+    picture_t *dst = NewPicture(dst_chroma, DST_WIDTH, DST_HEIGHT, false);
+    picture_t *src = NewPicture(src_chroma, SRC_WIDTH, SRC_HEIGHT, true);
+    vlc_blender_t *blend = dst ? filter_NewBlend(obj, &dst->format) : NULL;
+    if (blend == NULL || src == NULL
+     || filter_ConfigureBlend(blend, DST_WIDTH, DST_HEIGHT, &src->format)) {
+        fprintf(stderr, "can't blend %4.4s onto %4.4s\n",
+                (const char *)&src_chroma, (const char *)&dst_chroma);
+        ret = 1;
+        goto end;
+    }
+
+    const int x = (DST_WIDTH - SRC_WIDTH) / 2 + 1; /* odd, as it happens */
+    const int y = DST_HEIGHT - SRC_HEIGHT - 51;
+
+    /* Warm up */
+    filter_Blend(blend, dst, x, y, src, 255);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < loops; i++)
+        filter_Blend(blend, dst, x, y, src, 255 - i % 64);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    const double us = (double)US_FROM_VLC_TICK(elapsed) / loops;
+    printf("{\"dst\":\"%4.4s\",\"src\":\"%4.4s\",\"loops\":%u,"
+           "\"us_per_blend\":%.1f,\"mpixels_per_s\":%.1f}\n",
+           (const char *)&dst_chroma, (const char *)&src_chroma, loops,
+           us, us > 0 ? SRC_WIDTH * SRC_HEIGHT / us : 0.);
+
+end:
+    if (blend != NULL)
+        filter_DeleteBlend(blend);
+    if (src != NULL)
+        picture_Release(src);
+    if (dst != NULL)
+        picture_Release(dst);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned loops = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    if (loops == 0)
+        loops = 1;
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 77;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    srand(0);
+    int ret = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(dst_chromas); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(src_chromas); j++)
+            ret |= Bench(obj, dst_chromas[i], src_chromas[j], loops);
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,184 @@
+/*****************************************************************************
+ * yadif.c: Yadif line filters check and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks that the SIMD Yadif line filters match the C ones on 8-bit and
+ * 10-bit lines, and prints one JSON result per kernel.
+ *
+ * Usage: test_modules_video_filter_yadif [loops]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_tick.h>
+
+#include "../modules/video_filter/deinterlace/yadif_avx2.c"
+#ifndef HAVE_AVX2_INTRINSICS
+# include "../modules/video_filter/deinterlace/common.h"
+# include "../modules/video_filter/deinterlace/yadif.h"
+#endif
+
+#define WIDTH 1920
+#define LINES 7 /* 2 lines of context above and below the filtered line */
+#define MARGIN 32
+
+typedef void (*line_filter)(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                            int, int, int, int, int);
+
+struct kernel
+{
+    const char *name;
+    unsigned pixel_size;
+    line_filter filter;
+    line_filter reference;
+    bool (*supported)(void);
+};
+
+static bool Always(void)
+{
+    return true;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+static bool HasAVX2(void)
+{
+    return vlc_CPU_AVX2();
+}
+#endif
+
+static const struct kernel kernels[] = {
+    { "c", 1, yadif_filter_line_c, yadif_filter_line_c, Always },
+    { "c", 2, yadif_filter_line_c_16bit, yadif_filter_line_c_16bit, Always },
+#ifdef HAVE_AVX2_INTRINSICS
+    { "avx2", 1, yadif_filter_line_avx2, yadif_filter_line_c, HasAVX2 },
+    { "avx2", 2, yadif_filter_line_16bit_avx2, yadif_filter_line_c_16bit,
+      HasAVX2 },
+#endif
+};
+
+struct frames
+{
+    size_t pitch;
+    uint8_t *prev, *cur, *next;
+    uint8_t *buf;
+};
+
+static void Fill(uint8_t *p, size_t size, unsigned pixel_size)
+{
+    /* Smooth gradients with noise, so that every branch gets taken */
+    for (size_t i = 0; i < size / pixel_size; i++)
+    {
+        unsigned v = (i * 3 + (rand() % 48)) & 0xff;
+        if (rand() % 16 == 0)
+            v = rand() & 0xff;
+        if (pixel_size == 2)
+            ((uint16_t *)p)[i] = (v << 2) | (rand() & 3); /* 10-bit */
+        else
+            p[i] = v;
+    }
+}
+
+static bool FramesInit(struct frames *f, unsigned pixel_size)
+{
+    f->pitch = WIDTH * pixel_size + 2 * MARGIN;
+    const size_t size = f->pitch * LINES;
+
+    f->buf = malloc(3 * size);
+    if (f->buf == NULL)
+        return false;
+    Fill(f->buf, 3 * size, pixel_size);
+    f->prev = f->buf + MARGIN + 3 * f->pitch;
+    f->cur  = f->prev + size;
+    f->next = f->cur + size;
+    return true;
+}
+
+static int Run(const struct kernel *k, unsigned loops)
+{
+    struct frames f;
+    if (!FramesInit(&f, k->pixel_size))
+        return 1;
+
+    const size_t row = WIDTH * k->pixel_size;
+    uint8_t *out = malloc(row + MARGIN);
+    uint8_t *ref = malloc(row + MARGIN);
+    if (out == NULL || ref == NULL)
+    {
+        free(out);
+        free(ref);
+        free(f.buf);
+        return 1;
+    }
+
+    /* Check every parity and mode, with odd widths for the tails */
+    for (int parity = 0; parity < 2; parity++)
+        for (int mode = 0; mode <= 2; mode += 2)
+            for (int w = WIDTH - 17; w <= WIDTH; w += 17)
+            {
+                memset(out, 0, row + MARGIN);
+                memset(ref, 0, row + MARGIN);
+                k->reference(ref, f.prev, f.cur, f.next, w, f.pitch,
+                             -(int)f.pitch, parity, mode);
+                k->filter(out, f.prev, f.cur, f.next, w, f.pitch,
+                          -(int)f.pitch, parity, mode);
+                assert(memcmp(out, ref, row + MARGIN) == 0);
+            }
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < loops; i++)
+        k->filter(out, f.prev, f.cur, f.next, WIDTH, f.pitch, -(int)f.pitch,
+                  i & 1, 0);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("{\"kernel\":\"%s\",\"bits\":%u,\"width\":%d,\"loops\":%u,"
+           "\"ns_per_line\":%.1f}\n", k->name, k->pixel_size == 2 ? 10 : 8,
+           WIDTH, loops,
+           loops ? (double)NS_FROM_VLC_TICK(elapsed) / loops : 0.);
+
+    free(ref);
+    free(out);
+    free(f.buf);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned loops = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000;
+    int ret = 0;
+
+    srand(0);
+    for (size_t i = 0; i < ARRAY_SIZE(kernels) && ret == 0; i++)
+        if (kernels[i].supported())
+            ret = Run(&kernels[i], loops);
+    return ret;
+}
@@ -32,6 +32,7 @@
 #include <vlc_meta.h>
 #include <vlc_block.h>
 #include <vlc_url.h>
+#include <vlc_atomic.h>
 
 #include <vlc/libvlc.h>
 #include "../../lib/libvlc_internal.h"
@@ -43,6 +44,7 @@ struct decoder_owner
 {
     decoder_t dec;
     decoder_t *packetizer;
+    struct test_decoder_stats *stats;
 };
 
 static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
@@ -59,13 +61,16 @@ static subpicture_t *spu_new_buffer_decoder(decoder_t *dec,
 
 static void queue_video(decoder_t *dec, picture_t *pic)
 {
-    (void) dec;
+    /* Outputs can be queued from decoder threads */
+    atomic_fetch_add_explicit(&dec_get_owner(dec)->stats->pictures, 1,
+                              memory_order_relaxed);
     picture_Release(pic);
 }
 
 static void queue_audio(decoder_t *dec, block_t *p_block)
 {
-    (void) dec;
+    atomic_fetch_add_explicit(&dec_get_owner(dec)->stats->samples,
+                              p_block->i_nb_samples, memory_order_relaxed);
     block_Release(p_block);
 }
 static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *desc)
@@ -115,7 +120,8 @@ void test_decoder_destroy(decoder_t *decoder)
     decoder_Destroy(decoder);
 }
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               struct test_decoder_stats *stats)
 {
     assert(parent && fmt);
     decoder_t *packetizer = NULL;
@@ -132,6 +138,7 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     }
     decoder = &owner->dec;
     owner->packetizer = packetizer;
+    owner->stats = stats;
 
     static const struct decoder_owner_callbacks dec_video_cbs =
     {
@@ -20,6 +20,13 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt);
+struct test_decoder_stats
+{
+    atomic_uintmax_t pictures;
+    atomic_uintmax_t samples;
+};
+
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               struct test_decoder_stats *stats);
 void test_decoder_destroy(decoder_t *decoder);
 int test_decoder_process(decoder_t *decoder, block_t *block);
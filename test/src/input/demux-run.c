@@ -33,6 +33,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#ifdef HAVE_GETRUSAGE
+# include <sys/resource.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_access.h>
@@ -42,6 +45,7 @@
 #include <vlc_meta.h>
 #include <vlc_es_out.h>
 #include <vlc_url.h>
+#include <vlc_atomic.h>
 #include "../lib/libvlc_internal.h"
 
 #include <vlc/vlc.h>
@@ -53,8 +57,11 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    uintmax_t blocks;
+    uintmax_t bytes;
 #ifdef HAVE_DECODERS
     vlc_object_t *parent;
+    struct test_decoder_stats stats;
 #endif
 };
 
@@ -82,7 +89,7 @@ static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
     ctx->ids = id;
 #ifdef HAVE_DECODERS
     es_format_Copy(&id->fmt, fmt);
-    id->decoder = test_decoder_create(ctx->parent, &id->fmt);
+    id->decoder = test_decoder_create(ctx->parent, &id->fmt, &ctx->stats);
     if (id->decoder == NULL)
         es_format_Clean(&id->fmt);
 #endif
@@ -106,6 +113,11 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    for (const block_t *b = block; b != NULL; b = b->p_next)
+    {
+        ctx->blocks++;
+        ctx->bytes += b->i_buffer;
+    }
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -160,7 +172,8 @@ static int EsOutControl(es_out_t *out, int query, va_list args)
             es_out_id_t* id = va_arg(args, es_out_id_t*);
             EsOutCheckId(ctx, id);
             test_decoder_destroy(id->decoder);
-            test_decoder_create(ctx->parent, &id->fmt);
+            id->decoder = test_decoder_create(ctx->parent, &id->fmt,
+                                              &ctx->stats);
 #endif
             break;
         }
@@ -230,11 +243,15 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->blocks = 0;
+    ctx->bytes = 0;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
 #ifdef HAVE_DECODERS
     ctx->parent = parent;
+    atomic_init(&ctx->stats.pictures, 0);
+    atomic_init(&ctx->stats.samples, 0);
 #else
     (void) parent;
 #endif
@@ -279,6 +296,60 @@ static void demux_get_meta(demux_t *demux)
     vlc_meta_Delete(p_meta);
 }
 
+static void print_json_string(const char *str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+static void demux_print_bench(const char *name, const char *url,
+                              const struct test_es_out_t *ctx,
+                              uint64_t input, vlc_tick_t duration)
+{
+    double secs = secf_from_vlc_tick(duration > 0 ? duration : 1);
+
+    printf("{\"demux\": ");
+    print_json_string(name);
+    printf(", \"url\": ");
+    print_json_string(url != NULL ? url : "");
+    printf(", \"input_bytes\": %"PRIu64", \"blocks\": %"PRIuMAX
+           ", \"block_bytes\": %"PRIuMAX", \"seconds\": %f"
+           ", \"mb_per_s\": %f, \"blocks_per_s\": %f",
+           input, ctx->blocks, ctx->bytes, secs,
+           input / 1000000. / secs, ctx->blocks / secs);
+#ifdef HAVE_DECODERS
+    uintmax_t pictures = atomic_load(&ctx->stats.pictures);
+
+    printf(", \"pictures\": %"PRIuMAX", \"fps\": %f"
+           ", \"audio_samples\": %"PRIuMAX,
+           pictures, pictures / secs, atomic_load(&ctx->stats.samples));
+#endif
+#ifdef HAVE_GETRUSAGE
+    /* For the whole process, including the previous inputs */
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        printf(", \"user_seconds\": %ld.%06ld, \"system_seconds\": %ld.%06ld"
+               ", \"max_rss_kb\": %ld",
+               (long)ru.ru_utime.tv_sec, (long)ru.ru_utime.tv_usec,
+               (long)ru.ru_stime.tv_sec, (long)ru.ru_stime.tv_usec,
+               ru.ru_maxrss);
+#endif
+    puts("}");
+    fflush(stdout);
+}
+
 static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
 {
     const char *name = args->name;
@@ -303,6 +374,7 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
 
     uintmax_t i = 0;
     int val;
+    vlc_tick_t start = vlc_tick_now();
 
     while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
     {
@@ -328,6 +400,10 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    if (args->bench)
+        demux_print_bench(name, s->psz_url, (struct test_es_out_t *)out,
+                          vlc_stream_Tell(s), vlc_tick_now() - start);
+
     demux_Delete(demux);
     es_out_Delete(out);
 
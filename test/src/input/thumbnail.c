@@ -163,6 +163,143 @@ static void test_thumbnails( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+struct batch_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t count;
+    size_t received;
+};
+
+static void thumbnailer_callback_batch( void* data, size_t index,
+                                        picture_t* thumbnail )
+{
+    struct batch_ctx* p_ctx = data;
+    vlc_mutex_lock( &p_ctx->lock );
+
+    assert( index == p_ctx->received && "Unexpected thumbnail order" );
+    assert( thumbnail != NULL && "Expected a thumbnail but got a failure" );
+    assert( thumbnail->format.i_chroma == VLC_CODEC_ARGB );
+
+    p_ctx->received++;
+    vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void test_thumbnail_batch( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    static const vlc_tick_t times[] = {
+        VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 60 ),
+        VLC_TICK_FROM_SEC( 30 ), VLC_TICK_FROM_SEC( 240 ),
+    };
+    struct batch_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+    ctx.count = ARRAY_SIZE( times );
+    ctx.received = 0;
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;audio_track_count=1"
+                   ";length=%" PRId64 ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    vlc_mutex_lock( &ctx.lock );
+    vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestBatch(
+        p_thumbnailer, times, ARRAY_SIZE( times ), p_item,
+        VLC_TICK_FROM_SEC( 5 ), thumbnailer_callback_batch, &ctx );
+    assert( p_req != NULL );
+
+    while ( ctx.received < ctx.count )
+    {
+        vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 2 );
+        int res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+        assert( res != ETIMEDOUT );
+    }
+    vlc_mutex_unlock( &ctx.lock );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
+struct sheet_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    bool b_done;
+};
+
+static void thumbnailer_callback_sheet( void* data, picture_t* sheet,
+                                        const char* index )
+{
+    struct sheet_ctx* p_ctx = data;
+
+    /* 5 minutes at 1 tile per 30 seconds: 10 tiles on 3 rows */
+    assert( sheet != NULL && index != NULL );
+    assert( sheet->format.i_chroma == VLC_CODEC_RGBA );
+    assert( sheet->format.i_visible_width == 4 * 32 );
+    assert( sheet->format.i_visible_height == 3 * 18 );
+    assert( strncmp( index, "WEBVTT\n", 7 ) == 0 );
+    assert( strstr( index, "\n00:04:30.000 --> 00:05:00.000\n"
+                           "#xywh=32,36,32,18\n" ) != NULL );
+
+    vlc_mutex_lock( &p_ctx->lock );
+    p_ctx->b_done = true;
+    vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void test_thumbnail_sheet( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    struct sheet_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+    ctx.b_done = false;
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;audio_track_count=0"
+                   ";length=%" PRId64 ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+    input_item_SetDuration( p_item, MOCK_DURATION );
+
+    const struct vlc_thumbnailer_sheet_params params = {
+        .interval = VLC_TICK_FROM_SEC( 30 ),
+        .tile_width = 32,
+        .tile_height = 18,
+        .columns = 4,
+        .segments = 3,
+    };
+
+    vlc_mutex_lock( &ctx.lock );
+    int res = vlc_thumbnailer_RequestSheet( p_thumbnailer, p_item, &params,
+                                            VLC_TICK_FROM_SEC( 5 ),
+                                            thumbnailer_callback_sheet, &ctx );
+    assert( res == VLC_SUCCESS );
+    while ( ctx.b_done == false )
+    {
+        vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 5 );
+        res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+        assert( res != ETIMEDOUT );
+    }
+    vlc_mutex_unlock( &ctx.lock );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 static void thumbnailer_callback_cancel( void* data, picture_t* p_thumbnail )
 {
     struct test_ctx* p_ctx = data;
@@ -219,6 +356,8 @@ int main()
     assert(vlc);
 
     test_thumbnails( vlc );
+    test_thumbnail_batch( vlc );
+    test_thumbnail_sheet( vlc );
     test_cancel_thumbnail( vlc );
 
     libvlc_release( vlc );
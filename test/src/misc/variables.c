@@ -444,6 +444,53 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOVAR );
 }
 
+static void test_handles( libvlc_int_t *p_libvlc )
+{
+    char name[16];
+
+    /* Enough variables to resize the table a few times */
+    for( unsigned i = 0; i < 1000; i++ )
+    {
+        sprintf( name, "handle-%u", i );
+        var_Create( p_libvlc, name, VLC_VAR_INTEGER );
+        var_SetInteger( p_libvlc, name, i );
+    }
+
+    /* Remove every other one, the others must still be found */
+    for( unsigned i = 0; i < 1000; i += 2 )
+    {
+        sprintf( name, "handle-%u", i );
+        var_Destroy( p_libvlc, name );
+    }
+    for( unsigned i = 0; i < 1000; i++ )
+    {
+        sprintf( name, "handle-%u", i );
+        assert( var_Type( p_libvlc, name ) == ((i & 1) ? VLC_VAR_INTEGER : 0) );
+        if( i & 1 )
+            assert( var_GetInteger( p_libvlc, name ) == i );
+    }
+
+    assert( var_AcquireHandle( p_libvlc, "handle-0" ) == NULL );
+
+    struct variable_t *var = var_AcquireHandle( p_libvlc, "handle-1" );
+    assert( var != NULL );
+    assert( var_GetHandleInteger( p_libvlc, var ) == 1 );
+    var_SetHandleInteger( p_libvlc, var, 4212 );
+    assert( var_GetInteger( p_libvlc, "handle-1" ) == 4212 );
+
+    /* The handle keeps the variable alive */
+    var_Destroy( p_libvlc, "handle-1" );
+    assert( var_GetInteger( p_libvlc, "handle-1" ) == 4212 );
+    var_ReleaseHandle( p_libvlc, var );
+    assert( var_Type( p_libvlc, "handle-1" ) == 0 );
+
+    for( unsigned i = 3; i < 1000; i += 2 )
+    {
+        sprintf( name, "handle-%u", i );
+        var_Destroy( p_libvlc, name );
+    }
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -481,6 +528,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     test_log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    test_log( "Testing handles\n" );
+    test_handles( p_libvlc );
 }
 
 
@@ -1638,6 +1638,45 @@ test_next_media(struct ctx *ctx)
     test_end(ctx);
 }
 
+static void
+test_preload_next_media(struct ctx *ctx)
+{
+    test_log("preload_next_media\n");
+    const char *media_names[] = { "media1", "media2" };
+    const size_t media_count = ARRAY_SIZE(media_names);
+
+    vlc_player_t *player = ctx->player;
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(100));
+
+    for (size_t i = 0; i < media_count; ++i)
+        player_set_next_mock_media(ctx, media_names[i], &params);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_PLAYING);
+
+    /* The second media is opened while the first one is playing */
+    int ret = vlc_player_PreloadNextMedia(player);
+    assert(ret == VLC_SUCCESS);
+    assert(ctx->next_medias.size == 0);
+
+    /* Already preloaded */
+    ret = vlc_player_PreloadNextMedia(player);
+    assert(ret == VLC_SUCCESS);
+
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+    assert_normal_state(ctx);
+
+    {
+        vec_on_current_media_changed *vec = &ctx->report.on_current_media_changed;
+
+        assert(vec->size == media_count);
+        for (size_t i = 0; i < ctx->played_medias.size; ++i)
+            assert_media_name(vec->data[i], media_names[i]);
+    }
+
+    test_end(ctx);
+}
+
 static void
 test_set_current_media(struct ctx *ctx)
 {
@@ -2245,6 +2284,7 @@ main(void)
 
     test_set_current_media(&ctx);
     test_next_media(&ctx);
+    test_preload_next_media(&ctx);
     test_seeks(&ctx);
     test_pause(&ctx);
     test_capabilities_pause(&ctx);
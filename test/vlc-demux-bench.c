@@ -0,0 +1,51 @@
+/**
+ * @file vlc-demux-bench.c
+ */
+/*****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include "src/input/demux-run.h"
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    vlc_run_args_init(&args);
+    args.bench = true;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: [VLC_TARGET=demux] %s <filename>...\n"
+                "Prints one JSON object per file on the standard output.\n",
+                argv[0]);
+        return 1;
+    }
+
+    int ret = 0;
+    for (int i = 1; i < argc; i++)
+        if (vlc_demux_process_path(&args, argv[i]))
+        {
+            fprintf(stderr, "Error: cannot process %s\n", argv[i]);
+            ret = 1;
+        }
+    return ret;
+}